@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+# SPDX-License-Identifier: MIT
+
+"""
+Print a binary execution trace written by the heavy debugger's LOGB command
+(LOGCPU.TRC) as text, one instruction per line, in the same layout as the
+registers of the LOG command's LOGCPU.TXT so the two can be diffed.
+
+The format is described in src/debugger/trace_recorder.h.
+
+Usage: dump-trace.py LOGCPU.TRC [--limit N]
+"""
+
+# pylint: disable=invalid-name
+# pylint: disable=missing-docstring
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = b"DBXTRC01"
+
+FIELDS = ["CS", "EIP", "CODE", "EAX", "EBX", "ECX", "EDX", "ESI", "EDI",
+          "EBP", "ESP", "DS", "ES", "SS", "FLAGS"]
+
+EIP = FIELDS.index("EIP")
+CODE = FIELDS.index("CODE")
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7f) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+
+
+def decode_block(raw):
+    previous = [0] * len(FIELDS)
+    pos = 0
+    while pos < len(raw):
+        changed, pos = read_varint(raw, pos)
+        record = list(previous)
+        for field in range(len(FIELDS)):
+            if not changed & (1 << field):
+                continue
+            if field == EIP:
+                zigzag, pos = read_varint(raw, pos)
+                delta = (zigzag >> 1) ^ -(zigzag & 1)
+                record[field] = (previous[field] + delta) & 0xffffffff
+            elif field == CODE:
+                record[field] = struct.unpack_from("<I", raw, pos)[0]
+                pos += 4
+            else:
+                value, pos = read_varint(raw, pos)
+                record[field] = previous[field] ^ value
+        yield record
+        previous = record
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:len(MAGIC)] != MAGIC:
+        sys.exit(f"{path}: not an execution trace")
+    pos = len(MAGIC)
+    while pos + 8 <= len(data):
+        raw_size, compressed_size = struct.unpack_from("<II", data, pos)
+        pos += 8
+        raw = zlib.decompress(data[pos:pos + compressed_size])
+        if len(raw) != raw_size:
+            sys.exit(f"{path}: corrupt block at offset {pos - 8}")
+        pos += compressed_size
+        yield from decode_block(raw)
+
+
+def format_record(r):
+    code = " ".join(f"{(r[CODE] >> shift) & 0xff:02X}"
+                    for shift in (0, 8, 16, 24))
+    return (f"{r[0]:04X}:{r[1]:08X}  {code}  "
+            f"EAX:{r[3]:08X} EBX:{r[4]:08X} ECX:{r[5]:08X} EDX:{r[6]:08X} "
+            f"ESI:{r[7]:08X} EDI:{r[8]:08X} EBP:{r[9]:08X} ESP:{r[10]:08X} "
+            f"DS:{r[11]:04X} ES:{r[12]:04X} SS:{r[13]:04X} FLG:{r[14]:08X}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().split("\n")[0])
+    parser.add_argument("trace", help="trace file written by LOGB")
+    parser.add_argument("--limit", type=int, default=0,
+                        help="stop after this many instructions")
+    args = parser.parse_args()
+
+    for num, record in enumerate(read_trace(args.trace), 1):
+        print(format_record(record))
+        if num == args.limit:
+            break
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+
+# SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+# SPDX-License-Identifier: MIT
+
+"""
+Regenerate src/cpu/core_normal/dispatch_table.h, the computed-goto table of
+the normal core, from the CASE_* labels in the core_normal/prefix_*.h files.
+Run it after adding or removing an opcode; the build fails on labels that
+are missing from the table or not defined, so a stale table never compiles.
+"""
+
+# pylint: disable=invalid-name
+# pylint: disable=missing-docstring
+
+import os
+import re
+import sys
+
+SOURCE_DIR = os.path.join(os.path.dirname(__file__), "..", "..", "src", "cpu",
+                          "core_normal")
+
+PREFIX_FILES = ["prefix_none.h", "prefix_0f.h", "prefix_0f_mmx.h",
+                "prefix_66.h", "prefix_66_0f.h"]
+
+# Opcode table planes (matching OPCODE_NONE, OPCODE_0F and OPCODE_SIZE in
+# core_normal.cpp) and the label prefixes that the CASE_* macros in
+# helpers.h use for them
+PLANES = {
+    "CASE_W":      [(0x000, "op_w_")],
+    "CASE_D":      [(0x200, "op_d_")],
+    "CASE_B":      [(0x000, "op_w_"), (0x200, "op_d_")],
+    "CASE_0F_W":   [(0x100, "op_0fw_")],
+    "CASE_0F_D":   [(0x300, "op_0fd_")],
+    "CASE_0F_B":   [(0x100, "op_0fw_"), (0x300, "op_0fd_")],
+    # prefix_0f_mmx.h is included once as CASE_0F_W and once as CASE_0F_D
+    "CASE_0F_MMX": [(0x100, "op_0fw_"), (0x300, "op_0fd_")],
+}
+
+CASE_RE = re.compile(r"\b(CASE_[A-Z0-9_]+)\((0x[0-9a-fA-F]{2})\)")
+
+HEADER = """\
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Generated by scripts/tools/gen-core-normal-dispatch.py from the CASE_*
+// labels in prefix_*.h; don't edit by hand. Included inside the normal
+// core's run function, indexed by opcode_index plus the opcode byte.
+
+"""
+
+
+def collect_labels():
+    table = {}
+    for name in PREFIX_FILES:
+        with open(os.path.join(SOURCE_DIR, name), encoding="utf-8") as f:
+            for line in f:
+                if line.lstrip().startswith("#define"):
+                    continue
+                for macro, opcode in CASE_RE.findall(line):
+                    if macro not in PLANES:
+                        sys.exit(f"{name}: unknown macro {macro}")
+                    for base, prefix in PLANES[macro]:
+                        index = base + int(opcode, 16)
+                        label = prefix + opcode
+                        if table.get(index, label) != label:
+                            sys.exit(f"{name}: opcode {index:#05x} defined twice")
+                        table[index] = label
+    return table
+
+
+def main():
+    table = collect_labels()
+    lines = [HEADER]
+    for row in range(0, 0x400, 4):
+        entries = [f"&&{table.get(i, 'illegal_opcode')}," for i in
+                   range(row, row + 4)]
+        lines.append(f"/* {row:#05x} */ " + " ".join(entries) + "\n")
+    path = os.path.join(SOURCE_DIR, "dispatch_table.h")
+    with open(path, "w", encoding="utf-8") as f:
+        f.writelines(lines)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "audio/integer_decimator.h"
+
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+#include "utils/checks.h"
+
+CHECK_NARROWING();
+
+template <typename Sample>
+void IntegerDecimator<Sample>::Configure(const int new_ratio)
+{
+	assert(new_ratio >= 2 && new_ratio <= MaxRatio);
+
+	if (new_ratio == ratio && !taps.empty()) {
+		return;
+	}
+	ratio = new_ratio;
+
+	// A Blackman-windowed sinc cutting off at the output's Nyquist
+	// frequency. Its transition band straddles the cutoff, so what it lets
+	// through mostly folds back into the top quarter of the output band;
+	// below that, aliases are down by 48 dB or more.
+	const auto num_taps = 2 * TapsPerRatio * ratio;
+	const auto centre   = (num_taps - 1) / 2.0;
+	const auto cutoff   = 0.5 / ratio;
+
+	std::vector<double> design(static_cast<size_t>(num_taps));
+	double sum = 0.0;
+	for (auto m = 0; m < num_taps; ++m) {
+		const auto x    = m - centre;
+		const auto sinc = std::sin(2.0 * std::numbers::pi * cutoff * x) /
+		                  (std::numbers::pi * x);
+
+		const auto w      = 2.0 * std::numbers::pi * m / (num_taps - 1);
+		const auto window = 0.42 - 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+
+		design[static_cast<size_t>(m)] = sinc * window;
+		sum += sinc * window;
+	}
+
+	// Unity gain at DC, so a constant input gives the same constant out
+	taps.resize(design.size());
+	for (size_t i = 0; i < design.size(); ++i) {
+		taps[i] = static_cast<float>(design[i] / sum);
+	}
+
+	Reset();
+}
+
+template <typename Sample>
+void IntegerDecimator<Sample>::Reset()
+{
+	history.assign(taps.size() * 2, Sample{});
+	history_pos = 0;
+	phase       = 0;
+}
+
+template <typename Sample>
+void IntegerDecimator<Sample>::Process(const Sample* const in, const size_t num_frames,
+                                       std::vector<Sample>& out)
+{
+	assert(ratio > 0);
+
+	const auto num_taps = taps.size();
+	const auto step     = static_cast<size_t>(ratio);
+
+	for (size_t i = 0; i < num_frames; ++i) {
+		history[history_pos]            = in[i];
+		history[history_pos + num_taps] = in[i];
+		history_pos                     = (history_pos + 1) % num_taps;
+
+		if (++phase < step) {
+			continue;
+		}
+		phase = 0;
+
+		// The last `num_taps` frames, oldest first; the taps are
+		// symmetric so their order doesn't matter
+		const auto window = &history[history_pos];
+
+		Sample sum = {};
+		for (size_t t = 0; t < num_taps; ++t) {
+			sum += window[t] * taps[t];
+		}
+		out.push_back(sum);
+	}
+}
+
+template class IntegerDecimator<float>;
+template class IntegerDecimator<AudioFrame>;
@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_INTEGER_DECIMATOR_H
+#define DOSBOX_INTEGER_DECIMATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "audio/audio_frame.h"
+
+// Integer-ratio decimator
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// The PSG and CMS chips are rendered at a few hundred kHz so their square
+// waves and noise keep their timing, far above what any listener needs.
+// Handing that rate to the mixer makes its resampler do the downsampling,
+// at a cost that grows with the input rate. Decimating by an integer ratio
+// first is much cheaper: a windowed-sinc lowpass at the output rate's
+// Nyquist frequency, of which only every `ratio`-th output is computed, so
+// each output frame is one dot product of the recent input frames with the
+// taps.
+//
+// The taps are symmetric, so the filter's phase is linear and its delay is
+// a fixed half of its length, well under a millisecond at these rates.
+//
+// Works on mono (float) or stereo (AudioFrame) samples.
+template <typename Sample>
+class IntegerDecimator {
+public:
+	static constexpr int MaxRatio = 8;
+
+	// The filter's taps on each side of its centre, per unit of ratio
+	static constexpr int TapsPerRatio = 8;
+
+	// Resets the decimator if the ratio changes
+	void Configure(const int ratio);
+
+	// Clears the input history
+	void Reset();
+
+	// Appends one output frame per `ratio` input frames
+	void Process(const Sample* in, const size_t num_frames,
+	             std::vector<Sample>& out);
+
+	// How many more input frames make the next `num_out` output frames
+	size_t GetInputFramesFor(const size_t num_out) const
+	{
+		return num_out ? num_out * static_cast<size_t>(ratio) - phase : 0;
+	}
+
+	int GetRatio() const
+	{
+		return ratio;
+	}
+
+	const std::vector<float>& GetTaps() const
+	{
+		return taps;
+	}
+
+private:
+	int ratio = 0;
+
+	std::vector<float> taps = {};
+
+	// The last `taps.size()` input frames, stored twice in a row so the
+	// window ending at any position is contiguous
+	std::vector<Sample> history = {};
+	size_t history_pos          = 0;
+
+	// Input frames taken since the last output frame
+	size_t phase = 0;
+};
+
+extern template class IntegerDecimator<float>;
+extern template class IntegerDecimator<AudioFrame>;
+
+#endif // DOSBOX_INTEGER_DECIMATOR_H
@@ -0,0 +1,262 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "private/integer_upsampler.h"
+
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+#include "misc/support.h"
+#include "simde/x86/sse2.h"
+#include "utils/checks.h"
+
+CHECK_NARROWING();
+
+namespace {
+
+struct FilterDesign {
+	int taps_per_phase = 0;
+
+	// Fraction of the input's Nyquist frequency where the passband ends
+	double cutoff = 0.0;
+
+	// Kaiser window shape; higher attenuates the images more but widens
+	// the transition band
+	double kaiser_beta = 0.0;
+};
+
+// Roughly follows Speex's quality 3, 5 and 8 settings, which the mixer uses
+// for arbitrary ratios
+FilterDesign get_filter_design(const ResampleQuality quality)
+{
+	switch (quality) {
+	case ResampleQuality::Low: return {24, 0.85, 6.0};
+	case ResampleQuality::Medium: return {48, 0.9, 8.0};
+	case ResampleQuality::High: return {96, 0.95, 10.0};
+	}
+	assertm(false, "Invalid ResampleQuality");
+	return {};
+}
+
+// Zeroth-order modified Bessel function of the first kind
+double bessel_i0(const double x)
+{
+	double sum  = 1.0;
+	double term = 1.0;
+	for (auto k = 1; k < 50; ++k) {
+		const auto t = x / (2.0 * k);
+		term *= t * t;
+		sum += term;
+		if (term < sum * 1e-12) {
+			break;
+		}
+	}
+	return sum;
+}
+
+} // namespace
+
+void IntegerUpsampler::Configure(const int new_ratio, const ResampleQuality quality)
+{
+	assert(new_ratio >= 2 && new_ratio <= MaxRatio);
+
+	if (new_ratio == ratio && quality == current_quality && !phase_coeffs.empty()) {
+		return;
+	}
+
+	const auto design = get_filter_design(quality);
+	ratio             = new_ratio;
+	taps_per_phase    = design.taps_per_phase;
+	current_quality   = quality;
+
+	// A windowed-sinc lowpass at the output rate, cutting off below the
+	// input's Nyquist frequency. It's centred on a whole output frame, so
+	// once the delay is skipped every `ratio`-th output frame lines up
+	// with an input frame; the one tap left over past the window is zero.
+	const auto num_taps = taps_per_phase * ratio;
+	const auto centre   = num_taps / 2 - 1;
+	const auto cutoff   = design.cutoff * 0.5 / ratio;
+	const auto window_scale = 1.0 / bessel_i0(design.kaiser_beta);
+
+	std::vector<double> taps(static_cast<size_t>(num_taps));
+	for (auto m = 0; m <= 2 * centre; ++m) {
+		const auto x    = static_cast<double>(m - centre);
+		const auto sinc = (m == centre)
+		                        ? 2.0 * cutoff
+		                        : std::sin(2.0 * std::numbers::pi * cutoff * x) /
+		                                  (std::numbers::pi * x);
+
+		const auto r      = x / (centre + 1);
+		const auto window = bessel_i0(design.kaiser_beta * std::sqrt(1.0 - r * r)) *
+		                    window_scale;
+
+		taps[static_cast<size_t>(m)] = sinc * window;
+	}
+
+	// Output frame n * ratio + p is the sum over k of
+	// taps[k * ratio + p] * in[n - k]. Each phase is normalised to unity
+	// gain on its own, so a constant input gives a constant output.
+	std::vector<double> phase_sums(static_cast<size_t>(ratio));
+	for (auto p = 0; p < ratio; ++p) {
+		for (auto k = 0; k < taps_per_phase; ++k) {
+			phase_sums[static_cast<size_t>(p)] += taps[static_cast<size_t>(k * ratio + p)];
+		}
+	}
+
+	// Oldest input frame first, in pairs of taps, with all the phases of
+	// a pair next to each other so one load of the input serves them all
+	phase_coeffs.assign(static_cast<size_t>(num_taps) * 2, 0.0f);
+
+	for (auto t = 0; t < taps_per_phase; ++t) {
+		const auto k = taps_per_phase - 1 - t;
+		for (auto p = 0; p < ratio; ++p) {
+			const auto c = static_cast<float>(taps[static_cast<size_t>(k * ratio + p)] /
+			                                  phase_sums[static_cast<size_t>(p)]);
+
+			const auto pos = static_cast<size_t>(((t / 2) * ratio + p) * 4 + (t % 2) * 2);
+			phase_coeffs[pos]     = c;
+			phase_coeffs[pos + 1] = c;
+		}
+	}
+
+	Reset();
+}
+
+void IntegerUpsampler::Reset()
+{
+	history.assign(static_cast<size_t>(taps_per_phase) * 2, AudioFrame{});
+	history_pos = 0;
+
+	// The filter's delay at the output rate
+	frames_to_skip = taps_per_phase * ratio / 2 - 1;
+}
+
+template <bool UseSimd, int Ratio>
+void IntegerUpsampler::ProcessFrames(const AudioFrame* const in,
+                                     const size_t num_frames,
+                                     std::vector<AudioFrame>& out)
+{
+	assert(ratio == Ratio);
+	assert(taps_per_phase % 8 == 0);
+
+	// Low ratios add a second running sum per phase, so there are always
+	// enough independent additions in flight. Each sum takes every
+	// Chains-th pair of taps, the even tap of the pair in its low lanes
+	// and the odd one in its high lanes.
+	constexpr auto Chains = (Ratio < 3) ? 2 : 1;
+
+	const auto taps = static_cast<size_t>(taps_per_phase);
+
+	const auto out_start = out.size();
+	out.resize(out_start + num_frames * Ratio);
+	auto out_pos = out_start;
+
+	for (size_t i = 0; i < num_frames; ++i) {
+		history[history_pos]        = in[i];
+		history[history_pos + taps] = in[i];
+
+		// The last `taps` frames, oldest first
+		const auto window = &history[history_pos + 1];
+
+		history_pos = (history_pos + 1) % taps;
+
+		float sums[Ratio][4] = {};
+
+		if constexpr (UseSimd) {
+			simde__m128 acc[Ratio][Chains] = {};
+			for (auto& phase_acc : acc) {
+				for (auto& chain_acc : phase_acc) {
+					chain_acc = simde_mm_setzero_ps();
+				}
+			}
+			for (size_t t = 0; t < taps; t += 2 * Chains) {
+				for (size_t j = 0; j < Chains; ++j) {
+					const auto pair = t / 2 + j;
+					const auto frames = simde_mm_loadu_ps(
+					        &window[2 * pair].left);
+					const auto coeffs = phase_coeffs.data() + pair * Ratio * 4;
+
+					for (size_t p = 0; p < Ratio; ++p) {
+						const auto c = simde_mm_loadu_ps(coeffs + p * 4);
+						acc[p][j] = simde_mm_add_ps(acc[p][j],
+						                            simde_mm_mul_ps(frames, c));
+					}
+				}
+			}
+			for (size_t p = 0; p < Ratio; ++p) {
+				auto total = acc[p][0];
+				if constexpr (Chains == 2) {
+					total = simde_mm_add_ps(total, acc[p][1]);
+				}
+				simde_mm_storeu_ps(sums[p], total);
+			}
+		} else {
+			float acc[Ratio][Chains][4] = {};
+			for (size_t t = 0; t < taps; t += 2 * Chains) {
+				for (size_t j = 0; j < Chains; ++j) {
+					const auto pair = t / 2 + j;
+					const auto w    = &window[2 * pair];
+					const auto coeffs = phase_coeffs.data() + pair * Ratio * 4;
+
+					for (size_t p = 0; p < Ratio; ++p) {
+						const auto c = coeffs + p * 4;
+						acc[p][j][0] += w[0].left * c[0];
+						acc[p][j][1] += w[0].right * c[1];
+						acc[p][j][2] += w[1].left * c[2];
+						acc[p][j][3] += w[1].right * c[3];
+					}
+				}
+			}
+			for (size_t p = 0; p < Ratio; ++p) {
+				for (size_t lane = 0; lane < 4; ++lane) {
+					sums[p][lane] = acc[p][0][lane];
+					if constexpr (Chains == 2) {
+						sums[p][lane] += acc[p][1][lane];
+					}
+				}
+			}
+		}
+
+		for (size_t p = 0; p < Ratio; ++p) {
+			if (frames_to_skip > 0) {
+				--frames_to_skip;
+				continue;
+			}
+			out[out_pos++] = {sums[p][0] + sums[p][2], sums[p][1] + sums[p][3]};
+		}
+	}
+	out.resize(out_pos);
+}
+
+template <bool UseSimd>
+void IntegerUpsampler::ProcessAnyRatio(const AudioFrame* const in,
+                                       const size_t num_frames,
+                                       std::vector<AudioFrame>& out)
+{
+	static_assert(MaxRatio == 8);
+
+	switch (ratio) {
+	case 2: ProcessFrames<UseSimd, 2>(in, num_frames, out); break;
+	case 3: ProcessFrames<UseSimd, 3>(in, num_frames, out); break;
+	case 4: ProcessFrames<UseSimd, 4>(in, num_frames, out); break;
+	case 5: ProcessFrames<UseSimd, 5>(in, num_frames, out); break;
+	case 6: ProcessFrames<UseSimd, 6>(in, num_frames, out); break;
+	case 7: ProcessFrames<UseSimd, 7>(in, num_frames, out); break;
+	case 8: ProcessFrames<UseSimd, 8>(in, num_frames, out); break;
+	default: assertm(false, "Unconfigured IntegerUpsampler"); break;
+	}
+}
+
+void IntegerUpsampler::Process(const AudioFrame* const in,
+                               const size_t num_frames, std::vector<AudioFrame>& out)
+{
+	ProcessAnyRatio<true>(in, num_frames, out);
+}
+
+void IntegerUpsampler::ProcessScalar(const AudioFrame* const in,
+                                     const size_t num_frames,
+                                     std::vector<AudioFrame>& out)
+{
+	ProcessAnyRatio<false>(in, num_frames, out);
+}
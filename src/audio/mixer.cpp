@@ -5,12 +5,16 @@
 #include "mixer.h"
 
 #include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cinttypes>
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <optional>
 #include <sys/types.h>
+#include <thread>
 
 #include <SDL.h>
 #include <speex/speex_resampler.h>
@@ -19,6 +23,8 @@
 #include "tal-chorus/ChorusEngine.h"
 
 #include "private/compressor.h"
+#include "private/mix_kernels.h"
+#include "private/render_workers.h"
 
 #include "capture/capture.h"
 #include "channel_names.h"
@@ -31,6 +37,8 @@
 #include "hardware/timer.h"
 #include "midi/midi.h"
 #include "misc/cross.h"
+#include "misc/health_counters.h"
+#include "misc/perf_counters.h"
 #include "misc/notifications.h"
 #include "misc/tracy.h"
 #include "misc/video.h"
@@ -67,9 +75,73 @@ struct CrossfeedSettings {
 	float global_strength  = 0.0f;
 };
 
+// Effect bypass
+// ~~~~~~~~~~~~~
+// Most of the time nothing reaches the reverb and chorus: every send level
+// is zero, or the channels sending are silent or asleep. Rather than run
+// the effects on silence, each one stops once its input has been silent
+// for longer than its tail and its own output has died down as well, and
+// starts again with the first block that has anything in it. The effect's
+// state is left as it was, which by then holds nothing audible.
+
+// Half the smallest step of 16-bit audio
+constexpr auto EffectSilencePeak = 0.5f;
+
+constexpr auto ReverbTailMs = 500;
+constexpr auto ChorusTailMs = 50;
+
+static PerfCounter mixer_effect_bypassed_blocks(
+        "mixer_effect_bypassed_blocks",
+        "Reverb and chorus blocks skipped as nothing was sent to them.");
+
+class EffectBypass {
+public:
+	void Reset(const int sample_rate_hz, const int tail_ms)
+	{
+		tail_frames   = sample_rate_hz * tail_ms / 1000;
+		silent_frames = 0;
+		is_bypassed   = false;
+	}
+
+	// Takes the block to be sent to the effect, and returns whether the
+	// effect needs to process it
+	bool ShouldProcess(const std::vector<AudioFrame>& input)
+	{
+		if (peak_frames(input.data(), input.size()) > EffectSilencePeak) {
+			silent_frames = 0;
+			is_bypassed   = false;
+			return true;
+		}
+		silent_frames = std::min(silent_frames + check_cast<int>(input.size()),
+		                         tail_frames);
+		if (is_bypassed) {
+			mixer_effect_bypassed_blocks.Add();
+		}
+		return !is_bypassed;
+	}
+
+	// Takes the effect's output for the block it was given
+	void TrackOutput(const AudioFrame* const output, const size_t num_frames)
+	{
+		is_bypassed = silent_frames >= tail_frames &&
+		              peak_frames(output, num_frames) <= EffectSilencePeak;
+	}
+
+private:
+	int tail_frames   = 0;
+	int silent_frames = 0;
+	bool is_bypassed  = false;
+};
+
 struct ReverbSettings {
 	EmVerb mverb = {};
 
+	EffectBypass bypass = {};
+
+	// MVerb works on separate left and right streams, a block at a time
+	std::vector<float> left  = {};
+	std::vector<float> right = {};
+
 	// MVerb does not have an integrated high-pass filter to shape
 	// the low-end response like other reverbs. So we're adding one
 	// here. This helps take control over low-frequency build-up,
@@ -113,12 +185,16 @@ struct ReverbSettings {
 		for (auto& f : highpass_filter) {
 			f.setup(sample_rate_hz, highpass_freq_hz);
 		}
+
+		bypass.Reset(sample_rate_hz, ReverbTailMs);
 	}
 };
 
 struct ChorusSettings {
 	ChorusEngine chorus_engine = ChorusEngine(DefaultSampleRateHz);
 
+	EffectBypass bypass = {};
+
 	ChorusPreset preset            = ChorusPreset::None;
 	float synthesizer_send_level   = 0.0f;
 	float digital_audio_send_level = 0.0f;
@@ -137,6 +213,8 @@ struct ChorusSettings {
 		constexpr auto Chorus2Disabled = false;
 		chorus_engine.setEnablesChorus(Chorus1Enabled, Chorus2Disabled);
 
+		bypass.Reset(sample_rate_hz, ChorusTailMs);
+
 		// The chorus effect can only operates in 100% wet output mode,
 		// so we don't need to configure it for that.
 	}
@@ -145,6 +223,21 @@ struct ChorusSettings {
 // This shows up nicely as 50% and -6.00 dB in the MIXER command's output
 constexpr auto Minus6db = 0.501f;
 
+// Where the mixed audio goes
+enum class MixerOutput {
+	// Played on the host's audio device by the SDL callback, fed by the
+	// real-time mixer thread
+	Sdl,
+
+	// No device and no mixer thread; mixed from emulated time on the
+	// emulation thread and discarded (but still captured)
+	Null,
+
+	// Like Null, but the channels are only rendered, not mixed, while
+	// nothing is being captured
+	None,
+};
+
 struct MixerSettings {
 	RWQueue<AudioFrame> final_output{1};
 	RWQueue<int16_t> capture_queue{1};
@@ -182,6 +275,14 @@ struct MixerSettings {
 
 	std::atomic<MixerState> state = MixerState::Uninitialized;
 
+	MixerOutput output = MixerOutput::Sdl;
+
+	// Given to channels as they're added, and to all of them on changes
+	ResampleQuality resample_quality = ResampleQuality::Medium;
+
+	// Emulated time not yet mixed by the Null and None outputs, in frames
+	float emulated_frames_due = 0.0f;
+
 	HighpassFilter highpass_filter = {};
 	Compressor compressor          = {};
 	bool do_compressor             = false;
@@ -268,7 +369,7 @@ bool MIXER_FastForwardModeEnabled()
 // (mostly on device init/destroy and in the MIXER command line program).
 // Individual channels also have a mutex which can be safely aquired without
 // stopping these queues.
-void MIXER_LockMixerThread()
+static void stop_device_queues()
 {
 	PCSPEAKER_NotifyLockMixer();
 	TANDYDAC_NotifyLockMixer();
@@ -277,11 +378,9 @@ void MIXER_LockMixerThread()
 	GUS_NotifyLockMixer();
 	REELMAGIC_NotifyLockMixer();
 	SBLASTER_NotifyLockMixer();
-
-	mixer.mutex.lock();
 }
 
-void MIXER_UnlockMixerThread()
+static void start_device_queues()
 {
 	PCSPEAKER_NotifyUnlockMixer();
 	TANDYDAC_NotifyUnlockMixer();
@@ -290,19 +389,47 @@ void MIXER_UnlockMixerThread()
 	GUS_NotifyUnlockMixer();
 	REELMAGIC_NotifyUnlockMixer();
 	SBLASTER_NotifyUnlockMixer();
+}
 
+void MIXER_LockMixerThread()
+{
+	stop_device_queues();
+	mixer.mutex.lock();
+}
+
+void MIXER_UnlockMixerThread()
+{
+	start_device_queues();
 	mixer.mutex.unlock();
 }
 
+// Metric names are lower case with underscores
+static std::string make_resample_metric_name(const std::string& channel_name)
+{
+	std::string metric_name = "mixer_resample_ns_";
+	for (const auto c : channel_name) {
+		metric_name += std::isalnum(static_cast<unsigned char>(c))
+		                     ? static_cast<char>(
+		                               std::tolower(static_cast<unsigned char>(c)))
+		                     : '_';
+	}
+	return metric_name;
+}
+
 MixerChannel::MixerChannel(MIXER_Handler _handler, const char* _name,
                            const std::set<ChannelFeature>& _features)
         : sleeper(*this),
           name(_name),
+          resample_metric_name(make_resample_metric_name(_name)),
+          resample_metric_help(format_str("Nanoseconds the %s channel spent resampling.",
+                                          _name)),
+          resample_ns(resample_metric_name.c_str(), resample_metric_help.c_str()),
           envelope(_name),
           handler(_handler),
           features(_features)
 {
-	do_sleep = HasFeature(ChannelFeature::Sleep);
+	do_sleep         = HasFeature(ChannelFeature::Sleep);
+	resample_quality = mixer.resample_quality;
 }
 
 bool MixerChannel::HasFeature(const ChannelFeature feature)
@@ -581,6 +708,18 @@ static ChorusPreset chorus_pref_to_preset(const std::string& pref)
 	return ChorusPreset::None;
 }
 
+static ResampleQuality resample_quality_pref_to_quality(const std::string& pref)
+{
+	// The conf system programmatically guarantees only these prefs are used
+	if (pref == "low") {
+		return ResampleQuality::Low;
+	}
+	if (pref == "high") {
+		return ResampleQuality::High;
+	}
+	return ResampleQuality::Medium;
+}
+
 static const char* to_string(const ChorusPreset preset)
 {
 	switch (preset) {
@@ -932,14 +1071,39 @@ void MixerChannel::ConfigureResampler()
 	const auto channel_rate_hz = sample_rate_hz.load();
 	const auto mixer_rate_hz   = mixer.sample_rate_hz.load();
 
-	do_lerp_upsample = false;
-	do_zoh_upsample  = false;
-	do_resample      = false;
+	do_lerp_upsample    = false;
+	do_zoh_upsample     = false;
+	do_resample         = false;
+	do_integer_upsample = false;
 
 	auto configure_speex_resampler = [&](const int _in_rate_hz) {
+		// Exact integer ratios don't need Speex's arbitrary-ratio
+		// machinery
+		if (IntegerUpsampler::CanUpsample(_in_rate_hz, mixer_rate_hz)) {
+			do_integer_upsample = true;
+			integer_upsampler.Configure(mixer_rate_hz / _in_rate_hz,
+			                            resample_quality);
+
+			LOG_DEBUG("%s: Integer upsampler is on, input rate: %d Hz, output rate: %d Hz",
+			          name.c_str(),
+			          _in_rate_hz,
+			          mixer_rate_hz);
+			return;
+		}
+
 		const spx_uint32_t in_rate_hz  = _in_rate_hz;
 		const spx_uint32_t out_rate_hz = mixer_rate_hz;
 
+		// See the comment on the quality below
+		const auto speex_quality = [&] {
+			switch (resample_quality) {
+			case ResampleQuality::Low: return 3;
+			case ResampleQuality::Medium: return 5;
+			case ResampleQuality::High: return 8;
+			}
+			return 5;
+		}();
+
 		// Only init the resampler once
 		if (!speex_resampler.state) {
 
@@ -970,13 +1134,16 @@ void MixerChannel::ConfigureResampler()
 			// Source:
 			// https://hydrogenaud.io/index.php/topic,113655.msg935704.html#msg935704
 			//
-			constexpr auto ResampleQuality = 5;
-
+			// That's the 'medium' resample quality; 'low' and
+			// 'high' use 3 and 8.
+			//
 			speex_resampler.state = speex_resampler_init(NumChannels,
 			                                             in_rate_hz,
 			                                             out_rate_hz,
-			                                             ResampleQuality,
+			                                             speex_quality,
 			                                             nullptr);
+		} else {
+			speex_resampler_set_quality(speex_resampler.state, speex_quality);
 		}
 
 		speex_resampler_set_rate(speex_resampler.state, in_rate_hz, out_rate_hz);
@@ -1051,7 +1218,10 @@ void MixerChannel::ClearResampler()
 	if (do_zoh_upsample) {
 		InitZohUpsamplerState();
 	}
-	if (do_resample) {
+	if (do_resample && do_integer_upsample) {
+		integer_upsampler.Reset();
+
+	} else if (do_resample) {
 		assert(speex_resampler.state);
 		speex_resampler_reset_mem(speex_resampler.state);
 		speex_resampler_skip_zeros(speex_resampler.state);
@@ -1117,9 +1287,12 @@ const std::string& MixerChannel::GetName()
 	return name;
 }
 
+// The timing getters below are called by devices on every tick, so they
+// read the atomic rates rather than wait on the channel's lock while the
+// mixer thread is rendering into it
+
 int MixerChannel::GetSampleRate()
 {
-	std::lock_guard lock(mutex);
 	return sample_rate_hz;
 }
 
@@ -1130,8 +1303,6 @@ static float get_mixer_frames_per_tick()
 
 float MixerChannel::GetFramesPerTick()
 {
-	std::lock_guard lock(mutex);
-
 	const float stretch_factor = static_cast<float>(sample_rate_hz) /
 	                             static_cast<float>(mixer.sample_rate_hz);
 
@@ -1140,8 +1311,6 @@ float MixerChannel::GetFramesPerTick()
 
 float MixerChannel::GetFramesPerBlock()
 {
-	std::lock_guard lock(mutex);
-
 	const float stretch_factor = static_cast<float>(sample_rate_hz) /
 	                             static_cast<float>(mixer.sample_rate_hz);
 
@@ -1150,8 +1319,6 @@ float MixerChannel::GetFramesPerBlock()
 
 double MixerChannel::GetMillisPerFrame()
 {
-	std::lock_guard lock(mutex);
-
 	// Note: the double return value is used for PIC timing (which uses
 	// doubles)
 
@@ -1169,14 +1336,24 @@ void MixerChannel::SetPeakAmplitude(const int peak)
 	                EnvelopeExpiresAfterSeconds);
 }
 
+static int elapsed_us(const std::chrono::steady_clock::time_point since)
+{
+	return check_cast<int>(std::chrono::duration_cast<std::chrono::microseconds>(
+	                               std::chrono::steady_clock::now() - since)
+	                               .count());
+}
+
 void MixerChannel::Mix(const int frames_requested)
 {
 	assert(frames_requested > 0);
 
 	if (!is_enabled) {
+		render_time_us = 0;
 		return;
 	}
 
+	const auto start = std::chrono::steady_clock::now();
+
 	frames_needed = frames_requested;
 
 	while (frames_needed > audio_frames.size()) {
@@ -1197,6 +1374,13 @@ void MixerChannel::Mix(const int frames_requested)
 		lock.unlock();
 		handler(frames_remaining);
 	}
+
+	render_time_us = elapsed_us(start);
+}
+
+int MixerChannel::GetRenderTimeUs() const
+{
+	return render_time_us;
 }
 
 void MixerChannel::AddSilence()
@@ -1603,6 +1787,18 @@ void MixerChannel::SetResampleMethod(const ResampleMethod method)
 	ConfigureResampler();
 }
 
+void MixerChannel::SetResampleQuality(const ResampleQuality quality)
+{
+	std::lock_guard lock(mutex);
+
+	if (resample_quality == quality) {
+		return;
+	}
+	resample_quality = quality;
+
+	ConfigureResampler();
+}
+
 void MixerChannel::SetCrossfeedStrength(const float strength)
 {
 	std::lock_guard lock(mutex);
@@ -2059,6 +2255,20 @@ AudioFrame MixerChannel::Sleeper::MaybeFadeOrListen(const AudioFrame& frame)
 	return frame;
 }
 
+// The same for a block of frames: returns the gain to mix them with, and
+// only inspects them until the first signal is heard.
+float MixerChannel::Sleeper::MaybeFadeOrListen(const AudioFrame* const frames,
+                                               const size_t num_frames)
+{
+	if (wants_fadeout) {
+		return fadeout_level;
+	}
+	for (size_t i = 0; i < num_frames && !had_signal; ++i) {
+		MaybeFadeOrListen(frames[i]);
+	}
+	return 1.0f;
+}
+
 void MixerChannel::Sleeper::MaybeSleep()
 {
 	// A signed integer can a durration of ~24 days in milliseconds, which
@@ -2083,7 +2293,31 @@ void MixerChannel::Sleeper::MaybeSleep()
 	if (channel.is_enabled) {
 		channel.Enable(false);
 		// LOG_INFO("MIXER: %s fell asleep", channel.name.c_str());
+
+		// A device may have seen the channel still awake and only
+		// requested a wake-up just before it was disabled
+		if (TakeWakeUpRequest()) {
+			WakeUp();
+		}
+	}
+}
+
+void MixerChannel::Sleeper::RequestWakeUp()
+{
+	// Never 0, which means no request
+	wake_requested_at_ms = std::max<int64_t>(GetTicks(), 1);
+}
+
+bool MixerChannel::Sleeper::TakeWakeUpRequest()
+{
+	const auto requested_at_ms = wake_requested_at_ms.exchange(0);
+	if (requested_at_ms == 0) {
+		return false;
 	}
+	woken_at_ms   = requested_at_ms;
+	fadeout_level = 1.0f;
+	had_signal    = false;
+	return true;
 }
 
 // Returns true when actually awoken otherwise false if already awake.
@@ -2105,9 +2339,20 @@ bool MixerChannel::Sleeper::WakeUp()
 // Audio devices that use the sleep feature need to wake up the channel whenever
 // they might prepare new samples for it. Typically this is on IO port
 // writes into the card.
+//
+// Port writes are frequent, so an awake channel is only handed a wake-up
+// request for the mixer thread to apply, and the writes never wait on the
+// channel's lock while the mixer thread renders into it. Sleeping channels
+// are woken under the lock as before.
 bool MixerChannel::WakeUp()
 {
 	assert(do_sleep);
+
+	// Published before checking the state, for MaybeSleep() to catch
+	sleeper.RequestWakeUp();
+	if (is_enabled) {
+		return false;
+	}
 	std::lock_guard lock(mutex);
 	return sleeper.WakeUp();
 }
@@ -2151,6 +2396,11 @@ void MixerChannel::AddSamples(const int num_frames, const Type* data)
 	// The audio_frames vector can contain previously converted/resampled audio
 	const size_t audio_frames_starting_size = audio_frames.size();
 
+	using Clock = std::chrono::steady_clock;
+
+	const bool is_resampling  = do_lerp_upsample || do_resample;
+	const auto resample_start = is_resampling ? Clock::now() : Clock::time_point{};
+
 	if (do_lerp_upsample) {
 		assert(!do_resample);
 
@@ -2194,6 +2444,11 @@ void MixerChannel::AddSamples(const int num_frames, const Type* data)
 				i += 1;
 			}
 		}
+	} else if (do_resample && do_integer_upsample) {
+		integer_upsampler.Process(convert_buffer.data(),
+		                          convert_buffer.size(),
+		                          audio_frames);
+
 	} else if (do_resample) {
 		auto in_frames = check_cast<spx_uint32_t>(convert_buffer.size());
 
@@ -2231,6 +2486,12 @@ void MixerChannel::AddSamples(const int num_frames, const Type* data)
 		                    convert_buffer.end());
 	}
 
+	if (is_resampling) {
+		const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+		        Clock::now() - resample_start);
+		resample_ns.Add(static_cast<uint64_t>(elapsed.count()));
+	}
+
 	// Optionally gate, filter, and apply crossfeed.
 	// Runs in-place over newly added frames.
 	for (size_t i = audio_frames_starting_size; i < audio_frames.size(); ++i) {
@@ -2376,16 +2637,96 @@ MixerChannel::~MixerChannel()
 // It might be better for us to use normalized floats elsewhere in the future.
 // For now, that probably breaks some assumptions elsewhere in the mixer.
 // So just normalize as a final step before sending the data to SDL.
-static float normalize_sample(float sample)
-{
-	return sample / 32768.0f;
+//
+// The divisor is a power of two, so multiplying by its reciprocal gives
+// exactly the same result as dividing.
+constexpr auto NormalizeGain = 1.0f / 32768.0f;
+
+// Parallel channel rendering
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Rendering a channel runs its device's handler, which synthesizes (or
+// waits for) the audio, then converts, resamples and filters it. The
+// software MIDI synths are the heavy ones, and their handlers only take
+// what their own render threads queued, so channels created with
+// ChannelFeature::ParallelRender are rendered on a small pool of worker
+// threads. The mixer thread renders every other channel meanwhile, as
+// their handlers share state with the emulated hardware (DMA, the PIC,
+// other channels) and only ever ran one at a time, then it pitches in.
+// The results are summed into the master bus afterwards in the channels'
+// usual order, so the output is bit-identical to rendering them one after
+// the other.
+
+constexpr int MaxRenderThreads    = 3;
+constexpr int MinParallelChannels = 2;
+
+static PerfCounter mixer_parallel_blocks("mixer_parallel_blocks",
+                                         "Mixer blocks whose channels were rendered in parallel.");
+
+// The emulation and mixer threads are busy already
+static RenderWorkers render_workers(
+        std::clamp(static_cast<int>(std::thread::hardware_concurrency()) - 2,
+                   0,
+                   MaxRenderThreads),
+        "dosbox:mixwork");
+
+static void render_channels(const int frames_requested)
+{
+	// Disabled channels stay in the parallel list, as their devices can
+	// wake them while the others render
+	static std::vector<MixerChannel*> parallel_channels = {};
+	parallel_channels.clear();
+
+	int num_enabled = 0;
+	for (const auto& [_, channel] : mixer.channels) {
+		if (channel->HasFeature(ChannelFeature::ParallelRender)) {
+			parallel_channels.push_back(channel.get());
+		}
+		if (channel->is_enabled.load()) {
+			++num_enabled;
+		}
+	}
+
+	const auto render_serial_channels = [&](const bool skip_parallel) {
+		for (const auto& [_, channel] : mixer.channels) {
+			if (!skip_parallel ||
+			    !channel->HasFeature(ChannelFeature::ParallelRender)) {
+				channel->Mix(frames_requested);
+			}
+		}
+	};
+
+	if (render_workers.NumThreads() == 0 || parallel_channels.empty() ||
+	    num_enabled < MinParallelChannels) {
+		render_serial_channels(false);
+		return;
+	}
+
+	render_workers.Run(
+	        parallel_channels.size(),
+	        [&](const size_t i) { parallel_channels[i]->Mix(frames_requested); },
+	        [&] { render_serial_channels(true); });
+
+	mixer_parallel_blocks.Add();
 }
 
+static PerfGauge mixer_block_us("mixer_block_us",
+                                "Time taken to mix the last block, in microseconds.");
+
+static PerfCounter mixer_mix_us("mixer_mix_us",
+                                "Time spent mixing blocks, in microseconds.");
+
+static PerfGauge mixer_render_us("mixer_render_us",
+                                 "Time spent rendering the channels for the last block, in microseconds.");
+
 // Mix a certain amount of new sample frames
 static void mix_samples(const int frames_requested)
 {
 	assert(frames_requested > 0);
 
+	ZoneScoped;
+
+	const auto start = std::chrono::steady_clock::now();
+
 	mixer.output_buffer.clear();
 	mixer.output_buffer.resize(frames_requested);
 
@@ -2395,32 +2736,53 @@ static void mix_samples(const int frames_requested)
 	mixer.chorus_aux_buffer.clear();
 	mixer.chorus_aux_buffer.resize(frames_requested);
 
-	// Render all channels and accumulate results in the master mixbuffer
-	for (const auto& [_, channel] : mixer.channels) {
-		channel->Mix(frames_requested);
+	// Render all channels, then accumulate the results in the master
+	// mixbuffer in the channels' order
+	render_channels(frames_requested);
 
+	const auto render_us = elapsed_us(start);
+	mixer_render_us.Set(render_us);
+	TracyPlot("Mixer render us", static_cast<int64_t>(render_us));
+
+	for (const auto& [_, channel] : mixer.channels) {
 		std::lock_guard lock(channel->mutex);
 
+		if (channel->do_sleep) {
+			channel->sleeper.TakeWakeUpRequest();
+		}
+
 		const size_t num_frames = std::min(mixer.output_buffer.size(),
 		                                   channel->audio_frames.size());
 
-		for (size_t i = 0; i < num_frames; ++i) {
-			if (channel->do_sleep) {
-				mixer.output_buffer[i] += channel->sleeper.MaybeFadeOrListen(
-				        channel->audio_frames[i]);
+		const auto frames = channel->audio_frames.data();
+
+		if (channel->do_sleep) {
+			const auto gain = channel->sleeper.MaybeFadeOrListen(frames,
+			                                                     num_frames);
+			if (gain == 1.0f) {
+				mix_frames(mixer.output_buffer.data(), frames, num_frames);
 			} else {
-				mixer.output_buffer[i] += channel->audio_frames[i];
+				mix_scaled_frames(mixer.output_buffer.data(),
+				                  frames,
+				                  num_frames,
+				                  gain);
 			}
+		} else {
+			mix_frames(mixer.output_buffer.data(), frames, num_frames);
+		}
 
-			if (mixer.do_reverb && channel->do_reverb_send) {
-				mixer.reverb_aux_buffer[i] += channel->audio_frames[i] *
-				                              channel->reverb.send_gain;
-			}
+		if (mixer.do_reverb && channel->do_reverb_send) {
+			mix_scaled_frames(mixer.reverb_aux_buffer.data(),
+			                  frames,
+			                  num_frames,
+			                  channel->reverb.send_gain);
+		}
 
-			if (mixer.do_chorus && channel->do_chorus_send) {
-				mixer.chorus_aux_buffer[i] += channel->audio_frames[i] *
-				                              channel->chorus.send_gain;
-			}
+		if (mixer.do_chorus && channel->do_chorus_send) {
+			mix_scaled_frames(mixer.chorus_aux_buffer.data(),
+			                  frames,
+			                  num_frames,
+			                  channel->chorus.send_gain);
 		}
 
 		channel->audio_frames.erase(channel->audio_frames.begin(),
@@ -2431,40 +2793,53 @@ static void mix_samples(const int frames_requested)
 		}
 	}
 
-	if (mixer.do_reverb) {
+	if (mixer.do_reverb && mixer.reverb.bypass.ShouldProcess(mixer.reverb_aux_buffer)) {
 		// Apply reverb effect to the reverb aux buffer, then mix the
 		// results to the master output.
 		//
-		for (size_t i = 0; i < mixer.reverb_aux_buffer.size(); ++i) {
-			// High-pass filter the reverb input
-			auto& hpf = mixer.reverb.highpass_filter;
+		auto& reverb = mixer.reverb;
 
-			// MVerb operates on two non-interleaved sample streams
-			AudioFrame in_frame = mixer.reverb_aux_buffer[i];
-			in_frame.left       = hpf[0].filter(in_frame.left);
-			in_frame.right      = hpf[1].filter(in_frame.right);
+		const auto num_frames = mixer.reverb_aux_buffer.size();
+		reverb.left.resize(num_frames);
+		reverb.right.resize(num_frames);
 
-			float* in_buf[2] = {&in_frame.left, &in_frame.right};
+		for (size_t i = 0; i < num_frames; ++i) {
+			// High-pass filter the reverb input
+			auto& hpf = reverb.highpass_filter;
 
-			AudioFrame out_frame = {};
-			float* out_buf[2] = {&out_frame.left, &out_frame.right};
+			const auto& in_frame = mixer.reverb_aux_buffer[i];
+			reverb.left[i]       = hpf[0].filter(in_frame.left);
+			reverb.right[i]      = hpf[1].filter(in_frame.right);
+		}
 
-			constexpr auto NumFrames = 1;
-			mixer.reverb.mverb.process(in_buf, out_buf, NumFrames);
+		// MVerb reads each frame before writing it, so it can work in
+		// place
+		float* buffers[2] = {reverb.left.data(), reverb.right.data()};
+		reverb.mverb.process(buffers, buffers, check_cast<int>(num_frames));
 
-			mixer.output_buffer[i] += out_frame;
+		for (size_t i = 0; i < num_frames; ++i) {
+			mixer.reverb_aux_buffer[i] = {reverb.left[i], reverb.right[i]};
 		}
+		reverb.bypass.TrackOutput(mixer.reverb_aux_buffer.data(), num_frames);
+
+		mix_frames(mixer.output_buffer.data(),
+		           mixer.reverb_aux_buffer.data(),
+		           num_frames);
 	}
 
-	if (mixer.do_chorus) {
+	if (mixer.do_chorus && mixer.chorus.bypass.ShouldProcess(mixer.chorus_aux_buffer)) {
 		// Apply chorus effect to the chorus aux buffer, then mix the
 		// results to the master output.
 		//
-		for (size_t i = 0; i < mixer.chorus_aux_buffer.size(); ++i) {
-			auto frame = mixer.chorus_aux_buffer[i];
+		for (auto& frame : mixer.chorus_aux_buffer) {
 			mixer.chorus.chorus_engine.process(&frame.left, &frame.right);
-			mixer.output_buffer[i] += frame;
 		}
+		mixer.chorus.bypass.TrackOutput(mixer.chorus_aux_buffer.data(),
+		                                mixer.chorus_aux_buffer.size());
+
+		mix_frames(mixer.output_buffer.data(),
+		           mixer.chorus_aux_buffer.data(),
+		           mixer.chorus_aux_buffer.size());
 	}
 
 	// Apply high-pass filter to the master output
@@ -2474,10 +2849,9 @@ static void mix_samples(const int frames_requested)
 	}
 
 	// Apply master gain
-	const auto gain = mixer.master_gain.load(std::memory_order_relaxed);
-	for (auto& frame : mixer.output_buffer) {
-		frame *= gain;
-	}
+	scale_frames(mixer.output_buffer.data(),
+	             mixer.output_buffer.size(),
+	             mixer.master_gain.load(std::memory_order_relaxed));
 
 	if (mixer.do_compressor) {
 		// Apply compressor to the master output as the very last step
@@ -2522,10 +2896,14 @@ static void mix_samples(const int frames_requested)
 	}
 
 	// Normalize the final output before sending to SDL
-	for (auto& frame : mixer.output_buffer) {
-		frame.left  = normalize_sample(frame.left);
-		frame.right = normalize_sample(frame.right);
-	}
+	scale_frames(mixer.output_buffer.data(),
+	             mixer.output_buffer.size(),
+	             AudioFrame(NormalizeGain, NormalizeGain));
+
+	const auto block_us = elapsed_us(start);
+	mixer_block_us.Set(block_us);
+	mixer_mix_us.Add(static_cast<uint64_t>(block_us));
+	TracyPlot("Mixer block us", static_cast<int64_t>(block_us));
 }
 
 // Run in the main thread by a PIC Callback
@@ -2534,6 +2912,7 @@ static void capture_callback()
 	if (!(CAPTURE_IsCapturingAudio() || CAPTURE_IsCapturingVideo())) {
 		return;
 	}
+	ZoneScoped;
 
 	static float frame_counter = 0.0f;
 	frame_counter += get_mixer_frames_per_tick();
@@ -2566,6 +2945,88 @@ static void capture_callback()
 	CAPTURE_AddAudioData(mixer.sample_rate_hz, num_frames, frames.data());
 }
 
+static PerfGauge mixer_queue_frames("mixer_queue_frames",
+                                    "Mixed frames waiting for the audio device.");
+
+static PerfCounter mixer_overruns("mixer_overruns",
+                                  "Mixed blocks that waited for room in the audio device queue.");
+
+static PerfGauge mixer_latency_us("mixer_latency_us",
+                                  "Host time from mixing a block to the audio device taking it, in microseconds.");
+
+static PerfGauge mixer_emulated_latency_us("mixer_emulated_latency_us",
+                                           "Emulated time from mixing a block to the audio device taking it, in microseconds.");
+
+// Output latency
+// ~~~~~~~~~~~~~~
+// Each block queued for the audio device remembers the host and emulated
+// time it was mixed at. Once the callback has taken all its frames, the
+// time passed since then on both clocks is the latency from the emulation
+// producing the audio to it reaching the device (before the device's own
+// buffer).
+struct OutputBlock {
+	int num_frames                                 = 0;
+	double mixed_at_emulated_ms                    = 0.0;
+	std::chrono::steady_clock::time_point mixed_at = {};
+};
+
+static struct {
+	std::mutex mutex               = {};
+	std::deque<OutputBlock> blocks = {};
+	size_t num_frames              = 0;
+} output_blocks = {};
+
+// Blocks until the audio device queue has room for the frames
+static void enqueue_output(std::vector<AudioFrame>& frames,
+                           const double mixed_at_emulated_ms,
+                           const std::chrono::steady_clock::time_point mixed_at)
+{
+	if (mixer.final_output.Size() + frames.size() > mixer.final_output.MaxCapacity()) {
+		mixer_overruns.Add();
+	}
+	mixer.final_output.BulkEnqueue(frames);
+
+	std::lock_guard lock(output_blocks.mutex);
+	output_blocks.blocks.push_back(
+	        {check_cast<int>(frames.size()), mixed_at_emulated_ms, mixed_at});
+	output_blocks.num_frames += frames.size();
+}
+
+// Drops the blocks the callback has taken, which leaves as many frames as
+// are queued, and measures the latency of the last one dropped. Frames
+// cleared from the queue are dropped the same way. Skipped if the mixer
+// thread holds the lock, as the callback must not block.
+static void take_output_blocks(const size_t frames_queued)
+{
+	std::unique_lock lock(output_blocks.mutex, std::try_to_lock);
+	if (!lock.owns_lock()) {
+		return;
+	}
+
+	auto& blocks = output_blocks.blocks;
+
+	std::optional<OutputBlock> taken = {};
+	while (!blocks.empty() &&
+	       output_blocks.num_frames - check_cast<size_t>(blocks.front().num_frames) >=
+	               frames_queued) {
+		output_blocks.num_frames -= check_cast<size_t>(blocks.front().num_frames);
+		taken = blocks.front();
+		blocks.pop_front();
+	}
+	if (!taken) {
+		return;
+	}
+
+	const auto host_us = elapsed_us(taken->mixed_at);
+	const auto emulated_us = iround(
+	        (PIC_AtomicIndex() - taken->mixed_at_emulated_ms) * 1000.0);
+
+	mixer_latency_us.Set(host_us);
+	mixer_emulated_latency_us.Set(emulated_us);
+	TracyPlot("Mixer latency us", static_cast<int64_t>(host_us));
+	TracyPlot("Mixer emulated latency us", static_cast<int64_t>(emulated_us));
+}
+
 static void SDLCALL mixer_callback([[maybe_unused]] void* userdata,
                                    Uint8* stream, int bytes_requested)
 {
@@ -2589,6 +3050,15 @@ static void SDLCALL mixer_callback([[maybe_unused]] void* userdata,
 
 	const auto frames_received = mixer.final_output.BulkDequeue(frame_stream,
 	                                                            frames_to_dequeue);
+	if (frames_received < frames_requested) {
+		health_counters.mixer_underruns.Add();
+	}
+	const auto frames_queued = mixer.final_output.Size();
+	take_output_blocks(frames_queued);
+
+	const auto queued = static_cast<int64_t>(frames_queued);
+	mixer_queue_frames.Set(queued);
+	TracyPlot("Mixer queue depth", queued);
 	// Satisfy any shortfall with silence
 	std::fill(frame_stream + frames_received,
 	          frame_stream + frames_requested,
@@ -2599,11 +3069,15 @@ static void mixer_thread_loop()
 {
 	double last_mixed = 0.0;
 	while (!mixer.thread_should_quit) {
+		// One mixer frame per blocksize, alongside the video frames
+		FrameMarkNamed("Mixer");
+
 		std::unique_lock lock(mixer.mutex);
 		assert(mixer.state != MixerState::Uninitialized);
 
 		// This code is mostly for the fast-forward button (hold Alt + F12)
 		const double now         = PIC_AtomicIndex();
+		const auto mixed_at      = std::chrono::steady_clock::now();
 		const double actual_time = now - last_mixed;
 		const double expected_time = (static_cast<double>(mixer.blocksize) /
 		                              static_cast<double>(mixer.sample_rate_hz)) *
@@ -2651,7 +3125,7 @@ static void mixer_thread_loop()
 			mixer.output_buffer.clear();
 			mixer.output_buffer.resize(mixer.blocksize);
 
-			mixer.final_output.BulkEnqueue(mixer.output_buffer);
+			enqueue_output(mixer.output_buffer, now, mixed_at);
 			continue;
 		}
 
@@ -2691,10 +3165,135 @@ static void mixer_thread_loop()
 		}
 
 		assert(to_mix.size() == static_cast<size_t>(mixer.blocksize));
-		mixer.final_output.BulkEnqueue(to_mix);
+		enqueue_output(to_mix, now, mixed_at);
 	}
 }
 
+// Renders the channels so their devices stay paced and their queues
+// drained, then drops the frames without mixing them. Idle channels still
+// fall asleep, so they stop rendering altogether.
+static void discard_samples(const int frames_requested)
+{
+	render_channels(frames_requested);
+
+	for (const auto& [_, channel] : mixer.channels) {
+		std::lock_guard lock(channel->mutex);
+
+		if (channel->do_sleep) {
+			channel->sleeper.TakeWakeUpRequest();
+		}
+
+		const size_t num_frames = std::min(check_cast<size_t>(frames_requested),
+		                                   channel->audio_frames.size());
+
+		if (channel->do_sleep) {
+			channel->sleeper.MaybeFadeOrListen(channel->audio_frames.data(),
+			                                   num_frames);
+		}
+
+		channel->audio_frames.erase(channel->audio_frames.begin(),
+		                            channel->audio_frames.begin() + num_frames);
+
+		if (channel->do_sleep) {
+			channel->sleeper.MaybeSleep();
+		}
+	}
+}
+
+// Run in the main thread by a PIC Callback for the Null and None outputs,
+// in place of the mixer thread. Mixes a block as soon as emulated time
+// reaches it, so the capture (run after us in the same tick) never waits.
+static void mix_in_emulated_time()
+{
+	mixer.emulated_frames_due += get_mixer_frames_per_tick();
+
+	while (mixer.emulated_frames_due > 0.0f) {
+		ZoneScoped;
+
+		// Nothing waits on this thread's device queues while it's
+		// mixing, so stop them and let the channels take what's there
+		MIXER_LockMixerThread();
+
+		const bool is_capturing = CAPTURE_IsCapturingAudio() ||
+		                          CAPTURE_IsCapturingVideo();
+
+		if (mixer.output == MixerOutput::None && !is_capturing) {
+			discard_samples(mixer.blocksize);
+		} else {
+			mix_samples(mixer.blocksize);
+		}
+
+		MIXER_UnlockMixerThread();
+
+		mixer.emulated_frames_due -= static_cast<float>(mixer.blocksize);
+	}
+}
+
+static bool is_thread_suspended      = false;
+static bool was_final_output_running = false;
+
+void MIXER_SuspendThread()
+{
+	if (!mixer.thread.joinable()) {
+		// Mixing in emulated time; this thread isn't mixing right now
+		render_workers.StopThreads();
+		return;
+	}
+
+	// The device queues stay stopped until the thread is gone so its last
+	// pass cannot block waiting for audio from this thread
+	stop_device_queues();
+	mixer.thread_should_quit = true;
+	was_final_output_running = mixer.final_output.IsRunning();
+	mixer.final_output.Stop();
+	mixer.thread.join();
+	render_workers.StopThreads();
+	start_device_queues();
+
+	is_thread_suspended = true;
+}
+
+void MIXER_ResumeThread()
+{
+	if (!is_thread_suspended) {
+		return;
+	}
+	is_thread_suspended = false;
+
+	mixer.thread_should_quit = false;
+	if (was_final_output_running) {
+		mixer.final_output.Start();
+	}
+	mixer.thread = std::thread(mixer_thread_loop);
+	set_thread_name(mixer.thread, "dosbox:mixer");
+}
+
+MixerStats MIXER_GetStats()
+{
+	MixerStats stats = {};
+
+	stats.sample_rate_hz = mixer.sample_rate_hz;
+	stats.blocksize      = mixer.blocksize;
+	stats.queued_frames  = check_cast<int>(mixer.final_output.Size());
+
+	stats.underruns = health_counters.mixer_underruns.Value();
+	stats.overruns  = mixer_overruns.Value();
+
+	stats.mix_time_us    = check_cast<int>(mixer_block_us.Sample());
+	stats.render_time_us = check_cast<int>(mixer_render_us.Sample());
+
+	stats.host_latency_us     = check_cast<int>(mixer_latency_us.Sample());
+	stats.emulated_latency_us = check_cast<int>(
+	        mixer_emulated_latency_us.Sample());
+
+	return stats;
+}
+
+bool MIXER_HasAudioDevice()
+{
+	return mixer.sdl_device > 0;
+}
+
 static void stop_mixer([[maybe_unused]] Section* sec)
 {
 	MIXER_CloseAudioDevice();
@@ -2745,6 +3344,7 @@ static void set_mixer_state(const MixerState new_state)
 void MIXER_CloseAudioDevice()
 {
 	TIMER_DelTickHandler(capture_callback);
+	TIMER_DelTickHandler(mix_in_emulated_time);
 
 	if (mixer.thread.joinable()) {
 		mixer.thread_should_quit = true;
@@ -2909,14 +3509,27 @@ void MIXER_Init(Section* sec)
 		// Initialize the 8-bit to 16-bit lookup table
 		fill_8to16_lut();
 
-		const auto mixer_state = secprop->GetBool("nosound")
+		const auto output_pref = secprop->GetString("output");
+
+		mixer.output = (output_pref == "null")   ? MixerOutput::Null
+		             : (output_pref == "none") ? MixerOutput::None
+		                                       : MixerOutput::Sdl;
+
+		const auto mixer_state = (mixer.output != MixerOutput::Sdl ||
+		                          secprop->GetBool("nosound"))
 		                               ? MixerState::NoSound
 		                               : MixerState::On;
 
 		auto set_no_sound = [&] {
 			assert(mixer.sdl_device == 0);
 
-			LOG_MSG("MIXER: Sound output disabled ('nosound' mode)");
+			if (mixer.output == MixerOutput::Sdl) {
+				LOG_MSG("MIXER: Sound output disabled ('nosound' mode)");
+			} else {
+				LOG_MSG("MIXER: Sound output disabled, mixing in "
+				        "emulated time ('%s' output)",
+				        output_pref.c_str());
+			}
 
 			mixer.state = MixerState::NoSound;
 		};
@@ -2954,10 +3567,34 @@ void MIXER_Init(Section* sec)
 		// One second of audio
 		mixer.capture_queue.Resize(mixer.sample_rate_hz * 2);
 
-		mixer.thread = std::thread(mixer_thread_loop);
-		set_thread_name(mixer.thread, "dosbox:mixer");
-
 		TIMER_AddTickHandler(capture_callback);
+
+		if (mixer.output == MixerOutput::Sdl) {
+			mixer.thread = std::thread(mixer_thread_loop);
+			set_thread_name(mixer.thread, "dosbox:mixer");
+		} else {
+			// Tick handlers run newest first, so this mixes ahead
+			// of the capture in every tick
+			mixer.emulated_frames_due = 0.0f;
+			TIMER_AddTickHandler(mix_in_emulated_time);
+		}
+	} else {
+		// Changed at runtime. The output queue's capacity can change
+		// while both sides use it: a smaller one drains down to the
+		// new depth, and a larger one fills up on the next passes.
+		const auto prebuffer_ms = clamp(secprop->GetInt("prebuffer"),
+		                                1,
+		                                MaxPrebufferMs);
+		if (prebuffer_ms != mixer.prebuffer_ms) {
+			mixer.prebuffer_ms = prebuffer_ms;
+
+			const auto prebuffer_frames = (mixer.sample_rate_hz *
+			                               mixer.prebuffer_ms) /
+			                              1000;
+			mixer.final_output.Resize(mixer.blocksize + prebuffer_frames);
+
+			LOG_MSG("MIXER: Prebuffer set to %d ms", mixer.prebuffer_ms);
+		}
 	}
 
 	// Initialise crossfeed
@@ -2984,6 +3621,17 @@ void MIXER_Init(Section* sec)
 		MIXER_SetChorusPreset(new_chorus_preset);
 	}
 
+	// Initialise the resampling quality
+	const auto new_resample_quality = resample_quality_pref_to_quality(
+	        secprop->GetString("resample_quality"));
+
+	if (mixer.resample_quality != new_resample_quality) {
+		mixer.resample_quality = new_resample_quality;
+		for (const auto& [_, channel] : mixer.channels) {
+			channel->SetResampleQuality(new_resample_quality);
+		}
+	}
+
 	// Init per-channel denoisers
 	init_denoiser(secprop->GetBool("denoiser"));
 
@@ -3075,6 +3723,19 @@ static void init_mixer_dosbox_settings(SectionProp& sec_prop)
 	        "Sound is still emulated in silent mode, but DOSBox outputs no sound to the host.\n"
 	        "Capturing the emulated audio output to a WAV file works in silent mode.");
 
+	auto string_prop = sec_prop.AddString("output", OnlyAtStart, "sdl");
+	string_prop->SetHelp(
+	        "Where the mixed audio goes ('sdl' by default):\n"
+	        "  sdl:   Play it on the host's audio device (default). 'nosound' keeps the\n"
+	        "         real-time mixer running without a device.\n"
+	        "  null:  Open no audio device and run no mixer thread; mix on the emulation\n"
+	        "         thread as emulated time passes, and discard the result. Audio\n"
+	        "         timing and capturing to WAV or video stay correct.\n"
+	        "  none:  Like 'null', but only render the devices' audio, without mixing it,\n"
+	        "         while nothing is being captured.\n"
+	        "'--headless' selects 'null'.");
+	string_prop->SetValues({"sdl", "null", "none"});
+
 	auto int_prop = sec_prop.AddInt("rate", OnlyAtStart, DefaultSampleRateHz);
 	assert(int_prop);
 	int_prop->SetMinMax(8000, 96000);
@@ -3093,12 +3754,12 @@ static void init_mixer_dosbox_settings(SectionProp& sec_prop)
 	        "512, 1024, etc.) Larger values might help with sound stuttering but will\n"
 	        "introduce more latency. Also see 'negotiate'.");
 
-	int_prop = sec_prop.AddInt("prebuffer", OnlyAtStart, DefaultPrebufferMs);
+	int_prop = sec_prop.AddInt("prebuffer", WhenIdle, DefaultPrebufferMs);
 	int_prop->SetMinMax(0, MaxPrebufferMs);
 	int_prop->SetHelp(
 	        "How many milliseconds of sound to render in advance on top of 'blocksize'\n"
 	        "(%s by default). Larger values might help with sound stuttering but will\n"
-	        "introduce more latency.");
+	        "introduce more latency. Can be changed while running.");
 
 	bool_prop = sec_prop.AddBool("negotiate", OnlyAtStart, DefaultAllowNegotiate);
 	bool_prop->SetHelp(
@@ -3106,6 +3767,19 @@ static void init_mixer_dosbox_settings(SectionProp& sec_prop)
 	        "Enable it if you're not getting audio or the sound is stuttering with your\n"
 	        "'blocksize' setting. Disable it to force the manually set 'blocksize' value.");
 
+	string_prop = sec_prop.AddString("resample_quality", WhenIdle, "medium");
+	string_prop->SetHelp(
+	        "Quality of resampling the audio channels to the mixer's 'rate', trading\n"
+	        "fidelity for CPU time ('medium' by default):\n"
+	        "  low:     Shortest filters; audible artifacts are possible on bright\n"
+	        "           material.\n"
+	        "  medium:  Indistinguishable from 'high' on virtually all DOS audio (default).\n"
+	        "  high:    Longest filters, mostly for spectrograms.\n"
+	        "Channels running at an exact fraction of the mixer rate (e.g., 22050 Hz into\n"
+	        "44100 Hz, or 24000, 16000 and 8000 Hz into 48000 Hz) use a dedicated\n"
+	        "integer-ratio upsampler; all other rates use Speex.");
+	string_prop->SetValues({"low", "medium", "high"});
+
 	constexpr auto DefaultOn = true;
 	bool_prop = sec_prop.AddBool("compressor", WhenIdle, DefaultOn);
 	bool_prop->SetHelp(
@@ -3114,7 +3788,7 @@ static void init_mixer_dosbox_settings(SectionProp& sec_prop)
 	        "  off:  Disable compressor.\n"
 	        "  on:   Enable compressor (default).");
 
-	auto string_prop = sec_prop.AddString("crossfeed", WhenIdle, "off");
+	string_prop = sec_prop.AddString("crossfeed", WhenIdle, "off");
 	string_prop->SetHelp(
 	        "Set crossfeed on the OPL and CMS (Gameblaster) mixer channels. Many games pan\n"
 	        "the instruments 100%% left and 100%% right in the stereo field on these audio\n"
@@ -21,11 +21,13 @@
 #include <Iir.h>
 
 #include "private/envelope.h"
+#include "private/integer_upsampler.h"
 #include "private/noise_gate.h"
 
 #include "audio/audio_frame.h"
 #include "config/config.h"
 #include "gui/titlebar.h"
+#include "misc/perf_counters.h"
 #include "utils/math_utils.h"
 
 // The mixer callback can accept a static function or a member function
@@ -103,6 +105,9 @@ enum class ChannelFeature {
 	DigitalAudio,
 	FadeOut,
 	NoiseGate,
+	// The channel's handler shares no state with other devices or the
+	// emulation thread, so it may render alongside other channels
+	ParallelRender,
 	ReverbSend,
 	Sleep,
 	Stereo,
@@ -221,6 +226,7 @@ public:
 	bool ConfigureFadeOut(const std::string& fadeout_prefs);
 
 	void SetResampleMethod(const ResampleMethod method);
+	void SetResampleQuality(const ResampleQuality quality);
 	void SetZeroOrderHoldUpsamplerTargetRate(const int target_rate_hz);
 
 	// The crossfeed strength is a perceptually linear scale from 0.0
@@ -255,6 +261,10 @@ public:
 	// Pass-through to the sleeper
 	bool WakeUp();
 
+	// How long the channel took to render its part of the last mixer
+	// block, including waiting on its device
+	int GetRenderTimeUs() const;
+
 	std::vector<AudioFrame> audio_frames = {};
 	std::recursive_mutex mutex           = {};
 
@@ -278,9 +288,18 @@ public:
 		Sleeper(MixerChannel& c, const int sleep_after_ms = DefaultWaitMs);
 		bool ConfigureFadeOut(const std::string& prefs);
 		AudioFrame MaybeFadeOrListen(const AudioFrame& frame);
+		float MaybeFadeOrListen(const AudioFrame* frames, size_t num_frames);
 		void MaybeSleep();
 		bool WakeUp();
 
+		// Asks the mixer thread to restart the awake period without
+		// taking the channel's lock; safe to call from any thread
+		void RequestWakeUp();
+
+		// Applies a pending wake-up request; run by the mixer thread
+		// with the channel locked. Returns whether there was one.
+		bool TakeWakeUpRequest();
+
 	private:
 		void DecrementFadeLevel(const int awake_for_ms);
 
@@ -299,6 +318,9 @@ public:
 
 		bool wants_fadeout = false;
 		bool had_signal    = false;
+
+		// When the last unapplied wake-up was requested, or 0
+		std::atomic<int64_t> wake_requested_at_ms = 0;
 	};
 
 	Sleeper sleeper;
@@ -328,6 +350,13 @@ private:
 	AudioFrame ApplyCrossfeed(const AudioFrame frame);
 
 	std::string name = {};
+
+	// Time spent resampling, in the METRICS and STATS replies as
+	// 'mixer_resample_ns_<channel name>'
+	std::string resample_metric_name = {};
+	std::string resample_metric_help = {};
+	PerfCounter resample_ns;
+
 	Envelope envelope;
 	MIXER_Handler handler = nullptr;
 
@@ -338,6 +367,8 @@ private:
 	// Timing on how many samples were needed by the mixer
 	size_t frames_needed = 0;
 
+	std::atomic<int> render_time_us = 0;
+
 	// Previous and next sample fames
 	AudioFrame prev_frame = {};
 	AudioFrame next_frame = {};
@@ -391,12 +422,17 @@ private:
 	bool last_samples_were_stereo  = false;
 	bool last_samples_were_silence = true;
 
-	ResampleMethod resample_method = ResampleMethod::Resample;
+	ResampleMethod resample_method   = ResampleMethod::Resample;
+	ResampleQuality resample_quality = ResampleQuality::Medium;
 
 	bool do_lerp_upsample = false;
 	bool do_zoh_upsample  = false;
 	bool do_resample      = false;
 
+	// Resample exact integer ratios with the integer upsampler rather
+	// than Speex
+	bool do_integer_upsample = false;
+
 	struct {
 		float pos             = 0.0f;
 		float step            = 0.0f;
@@ -409,6 +445,8 @@ private:
 		float step         = 0.0f;
 	} zoh_upsampler = {};
 
+	IntegerUpsampler integer_upsampler = {};
+
 	struct {
 		SpeexResamplerState* state = nullptr;
 	} speex_resampler = {};
@@ -476,6 +514,42 @@ void MIXER_LockMixerThread();
 void MIXER_UnlockMixerThread();
 void MIXER_CloseAudioDevice();
 
+// Stops the mixer thread and starts it again, keeping all mixer state. Used
+// around fork(), which only carries the calling thread into the child.
+void MIXER_SuspendThread();
+void MIXER_ResumeThread();
+
+// Audio output timing, as shown by MIXER /STATS
+struct MixerStats {
+	int sample_rate_hz = 0;
+	int blocksize      = 0;
+
+	// Mixed frames waiting for the audio device
+	int queued_frames = 0;
+
+	// Audio callbacks padded with silence, and mixed blocks that waited
+	// for room in the audio device queue
+	uint64_t underruns = 0;
+	uint64_t overruns  = 0;
+
+	// Time taken to mix the last block, and the part of it spent rendering
+	// the channels
+	int mix_time_us    = 0;
+	int render_time_us = 0;
+
+	// From the last played block being mixed to the audio device taking
+	// it, in host and in emulated time. They drift apart when the
+	// emulation runs slower or faster than real time.
+	int host_latency_us     = 0;
+	int emulated_latency_us = 0;
+};
+
+MixerStats MIXER_GetStats();
+
+// True if mixed audio is played through an SDL audio device, as opposed to
+// being discarded because sound is disabled
+bool MIXER_HasAudioDevice();
+
 // Return true if the mixer was explicitly muted by the user (as opposed to
 // auto-muted when `mute_when_inactive` is enabled).
 bool MIXER_IsManuallyMuted();
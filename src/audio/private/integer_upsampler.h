@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_INTEGER_UPSAMPLER_H
+#define DOSBOX_INTEGER_UPSAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "audio/audio_frame.h"
+
+// Trades resampling quality for CPU time, both for Speex and for the
+// integer-ratio upsampler
+enum class ResampleQuality { Low, Medium, High };
+
+// Integer-ratio upsampler
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// Many channels run at an exact fraction of the mixer rate: 22050 or
+// 11025 Hz into 44100 Hz, 24000, 16000 or 8000 Hz into 48000 Hz. For those,
+// every output frame falls on one of `ratio` fixed positions between two
+// input frames, so a windowed-sinc lowpass splits into `ratio` short
+// polyphase filters computed once up front. Each output frame is then a
+// single dot product of the recent input frames with one phase, with no
+// rate tracking or filter interpolation per frame as Speex does for
+// arbitrary ratios.
+//
+// The frames are interleaved left/right pairs, so the dot products take two
+// input frames per SSE2 register (NEON via simde on ARM), against each
+// coefficient stored once per side. The scalar version is the reference
+// it's tested against, and sums in the same order so the two agree
+// exactly.
+//
+// Like a Speex resampler primed with speex_resampler_skip_zeros(), the
+// output starts after the filter's delay, so it lines up with the input.
+class IntegerUpsampler {
+public:
+	static constexpr int MaxRatio = 8;
+
+	// Whether an exact integer-ratio upsampler exists for the rates
+	static constexpr bool CanUpsample(const int in_rate_hz, const int out_rate_hz)
+	{
+		return in_rate_hz > 0 && out_rate_hz > in_rate_hz &&
+		       out_rate_hz % in_rate_hz == 0 &&
+		       out_rate_hz / in_rate_hz <= MaxRatio;
+	}
+
+	// Resets the upsampler if the ratio or quality changes
+	void Configure(const int ratio, const ResampleQuality quality);
+
+	// Clears the input history and skips the filter's delay again
+	void Reset();
+
+	// Appends `ratio` output frames per input frame (fewer while the
+	// filter's delay is being skipped)
+	void Process(const AudioFrame* in, const size_t num_frames,
+	             std::vector<AudioFrame>& out);
+
+	// The reference: one coefficient at a time
+	void ProcessScalar(const AudioFrame* in, const size_t num_frames,
+	                   std::vector<AudioFrame>& out);
+
+	int GetRatio() const
+	{
+		return ratio;
+	}
+
+	int GetTapsPerPhase() const
+	{
+		return taps_per_phase;
+	}
+
+private:
+	template <bool UseSimd>
+	void ProcessAnyRatio(const AudioFrame* in, const size_t num_frames,
+	                     std::vector<AudioFrame>& out);
+
+	template <bool UseSimd, int Ratio>
+	void ProcessFrames(const AudioFrame* in, const size_t num_frames,
+	                   std::vector<AudioFrame>& out);
+
+	int ratio                       = 0;
+	int taps_per_phase              = 0;
+	ResampleQuality current_quality = ResampleQuality::Medium;
+
+	// Pairs of taps, oldest input frame first, with each phase's two
+	// coefficients of the pair stored twice (once for each side)
+	std::vector<float> phase_coeffs = {};
+
+	// The last `taps_per_phase` input frames, stored twice in a row so the
+	// window ending at any position is contiguous
+	std::vector<AudioFrame> history = {};
+	size_t history_pos              = 0;
+
+	int frames_to_skip = 0;
+};
+
+#endif // DOSBOX_INTEGER_UPSAMPLER_H
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_MIX_KERNELS_H
+#define DOSBOX_MIX_KERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "audio/audio_frame.h"
+#include "simde/x86/sse2.h"
+
+// Master bus kernels
+// ~~~~~~~~~~~~~~~~~~
+// Accumulates channels and effect sends into the mixer's buffers and
+// applies gains to them. AudioFrames are left/right float pairs packed back
+// to back, so an SSE2 register holds two of them and a block of frames is
+// processed two at a time:
+//
+//   - Channels are added to the master and aux buffers, optionally scaled
+//     by a send or fade-out gain first.
+//
+//   - The master gain (and, as the very last step, the normalization to
+//     +/-1.0) scales whole buffers by a left/right gain.
+//
+// Each lane does exactly the float operations the one-frame-at-a-time code
+// did, in the same order, so the output is bit-identical. simde maps the
+// SSE2 intrinsics to NEON on ARM hosts. The scalar versions are the
+// references they're tested against, and also process the odd frame at the
+// end of each block.
+
+static_assert(sizeof(AudioFrame) == 2 * sizeof(float));
+
+static inline simde__m128 load_frames(const AudioFrame* const frames)
+{
+	return simde_mm_loadu_ps(&frames->left);
+}
+
+static inline void store_frames(AudioFrame* const frames, const simde__m128 v)
+{
+	simde_mm_storeu_ps(&frames->left, v);
+}
+
+// dst[i] += src[i]
+static inline void mix_frames(AudioFrame* const dst, const AudioFrame* const src,
+                              const size_t num_frames)
+{
+	size_t i = 0;
+	for (; i + 2 <= num_frames; i += 2) {
+		store_frames(dst + i,
+		             simde_mm_add_ps(load_frames(dst + i), load_frames(src + i)));
+	}
+	for (; i < num_frames; ++i) {
+		dst[i] += src[i];
+	}
+}
+
+// dst[i] += src[i] * gain
+static inline void mix_scaled_frames(AudioFrame* const dst,
+                                     const AudioFrame* const src,
+                                     const size_t num_frames, const float gain)
+{
+	const auto g = simde_mm_set1_ps(gain);
+
+	size_t i = 0;
+	for (; i + 2 <= num_frames; i += 2) {
+		const auto scaled = simde_mm_mul_ps(load_frames(src + i), g);
+		store_frames(dst + i, simde_mm_add_ps(load_frames(dst + i), scaled));
+	}
+	for (; i < num_frames; ++i) {
+		dst[i] += src[i] * gain;
+	}
+}
+
+// frames[i] *= gain, per side
+static inline void scale_frames(AudioFrame* const frames, const size_t num_frames,
+                                const AudioFrame gain)
+{
+	const auto g = simde_mm_setr_ps(gain.left, gain.right, gain.left, gain.right);
+
+	size_t i = 0;
+	for (; i + 2 <= num_frames; i += 2) {
+		store_frames(frames + i, simde_mm_mul_ps(load_frames(frames + i), g));
+	}
+	for (; i < num_frames; ++i) {
+		frames[i] *= gain;
+	}
+}
+
+// The largest absolute sample value in the frames, on either side
+static inline float peak_frames(const AudioFrame* const frames, const size_t num_frames)
+{
+	const auto sign_bit = simde_mm_set1_ps(-0.0f);
+
+	auto peaks = simde_mm_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 2 <= num_frames; i += 2) {
+		peaks = simde_mm_max_ps(peaks,
+		                        simde_mm_andnot_ps(sign_bit, load_frames(frames + i)));
+	}
+	// Fold the four lanes into the first
+	peaks = simde_mm_max_ps(peaks, simde_mm_movehl_ps(peaks, peaks));
+	peaks = simde_mm_max_ps(peaks, simde_mm_shuffle_ps(peaks, peaks, 1));
+
+	auto peak = simde_mm_cvtss_f32(peaks);
+	for (; i < num_frames; ++i) {
+		peak = std::max({peak, std::fabs(frames[i].left), std::fabs(frames[i].right)});
+	}
+	return peak;
+}
+
+// The references: one frame at a time
+static inline void mix_frames_scalar(AudioFrame* const dst,
+                                     const AudioFrame* const src,
+                                     const size_t num_frames)
+{
+	for (size_t i = 0; i < num_frames; ++i) {
+		dst[i] += src[i];
+	}
+}
+
+static inline void mix_scaled_frames_scalar(AudioFrame* const dst,
+                                            const AudioFrame* const src,
+                                            const size_t num_frames,
+                                            const float gain)
+{
+	for (size_t i = 0; i < num_frames; ++i) {
+		dst[i] += src[i] * gain;
+	}
+}
+
+static inline void scale_frames_scalar(AudioFrame* const frames,
+                                       const size_t num_frames,
+                                       const AudioFrame gain)
+{
+	for (size_t i = 0; i < num_frames; ++i) {
+		frames[i] *= gain;
+	}
+}
+
+static inline float peak_frames_scalar(const AudioFrame* const frames,
+                                       const size_t num_frames)
+{
+	auto peak = 0.0f;
+	for (size_t i = 0; i < num_frames; ++i) {
+		peak = std::max({peak, std::fabs(frames[i].left), std::fabs(frames[i].right)});
+	}
+	return peak;
+}
+
+#endif // DOSBOX_MIX_KERNELS_H
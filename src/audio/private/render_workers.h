@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_RENDER_WORKERS_H
+#define DOSBOX_RENDER_WORKERS_H
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Render workers
+// ~~~~~~~~~~~~~~
+// A small pool of threads that renders a batch of independent items, with
+// the calling thread pitching in once it has done its own share of the
+// work. Work is handed out the same lock-free way as in the Voodoo's
+// triangle worker: a fixed number of work units, each covering every
+// NumWorkUnits-th item, claimed by bumping a shared index.
+//
+// The threads start on the first batch and keep waiting for the next one
+// until StopThreads(), as CLONE can't fork with other threads running. The
+// next batch starts them again.
+class RenderWorkers {
+public:
+	using RenderFunction = std::function<void(size_t item)>;
+
+	static constexpr int NumWorkUnits = 16;
+
+	RenderWorkers(int num_threads, const char* thread_name);
+	~RenderWorkers();
+
+	RenderWorkers(const RenderWorkers&)            = delete;
+	RenderWorkers& operator=(const RenderWorkers&) = delete;
+
+	int NumThreads() const
+	{
+		return num_threads;
+	}
+
+	// Calls 'render' once for each item below 'num_items', spread over
+	// the workers and the calling thread, which runs 'own_work' first.
+	// Returns once every item is rendered.
+	void Run(size_t num_items, const RenderFunction& render,
+	         const std::function<void()>& own_work);
+
+	void StopThreads();
+
+private:
+	int DoWork();
+	void ThreadFunc();
+
+	const int num_threads   = 0;
+	const char* thread_name = nullptr;
+
+	std::vector<std::thread> threads = {};
+	std::atomic_bool threads_active  = {};
+
+	const RenderFunction* render = nullptr;
+	size_t num_items             = 0;
+
+	// Worker threads start working when this gets reset to 0
+	std::atomic<int> work_index = INT_MAX;
+
+	std::atomic<int> done_count = 0;
+};
+
+#endif
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "private/render_workers.h"
+
+#include <cassert>
+
+#include "misc/support.h"
+
+RenderWorkers::RenderWorkers(const int _num_threads, const char* _thread_name)
+        : num_threads(_num_threads),
+          thread_name(_thread_name),
+          threads(static_cast<size_t>(_num_threads))
+{
+	assert(num_threads >= 0);
+}
+
+RenderWorkers::~RenderWorkers()
+{
+	StopThreads();
+}
+
+void RenderWorkers::StopThreads()
+{
+	if (!threads_active.load(std::memory_order_acquire)) {
+		return;
+	}
+	threads_active.store(false, std::memory_order_release);
+
+	// Wakes the workers without handing out any work; they only ever
+	// wait on INT_MAX or a value just past the last unit
+	work_index.store(INT_MAX - 1, std::memory_order_release);
+	work_index.notify_all();
+
+	for (auto& thread : threads) {
+		if (thread.joinable()) {
+			thread.join();
+		}
+	}
+	work_index.store(INT_MAX, std::memory_order_release);
+}
+
+int RenderWorkers::DoWork()
+{
+	int i = work_index.load(std::memory_order_acquire);
+	if (i >= NumWorkUnits) {
+		return i;
+	}
+
+	i = work_index.fetch_add(1, std::memory_order_acq_rel);
+	if (i < NumWorkUnits) {
+		for (auto item = static_cast<size_t>(i); item < num_items;
+		     item += NumWorkUnits) {
+			(*render)(item);
+		}
+		const auto done = done_count.fetch_add(1, std::memory_order_acq_rel) + 1;
+		if (done >= NumWorkUnits) {
+			done_count.notify_all();
+		}
+	}
+	return i + 1;
+}
+
+void RenderWorkers::ThreadFunc()
+{
+	while (threads_active.load(std::memory_order_acquire)) {
+		const auto i = DoWork();
+		if (i >= NumWorkUnits) {
+			work_index.wait(i, std::memory_order_acquire);
+		}
+	}
+}
+
+void RenderWorkers::Run(const size_t _num_items, const RenderFunction& _render,
+                        const std::function<void()>& own_work)
+{
+	assert(num_threads > 0);
+
+	// Only one thread runs batches, so there's no race
+	if (!threads_active.load(std::memory_order_acquire)) {
+		threads_active.store(true, std::memory_order_release);
+		for (auto& thread : threads) {
+			thread = std::thread(&RenderWorkers::ThreadFunc, this);
+			set_thread_name(thread, thread_name);
+		}
+	}
+
+	render    = &_render;
+	num_items = _num_items;
+	done_count.store(0, std::memory_order_release);
+
+	// Resetting this index triggers the worker threads to start working
+	work_index.store(0, std::memory_order_release);
+	work_index.notify_all();
+
+	own_work();
+
+	while (DoWork() < NumWorkUnits) {
+	}
+
+	int i = 0;
+	while ((i = done_count.load(std::memory_order_acquire)) < NumWorkUnits) {
+		done_count.wait(i, std::memory_order_acquire);
+	}
+}
@@ -0,0 +1,539 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "flac_encoder.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "misc/support.h"
+#include "utils/checks.h"
+
+CHECK_NARROWING();
+
+static constexpr int NumChannels   = 2;
+static constexpr int BitsPerSample = 16;
+
+// The predictors of order 0 to 4 are the fixed polynomial ones
+static constexpr int MaxFixedOrder = 4;
+
+// Partitions of 64 samples and up; smaller ones rarely pay for their
+// parameters
+static constexpr int MaxPartitionOrder = 6;
+
+// The largest parameter of the 4-bit Rice coding method; 15 is the escape
+// code for unencoded partitions
+static constexpr int MaxRiceParameter = 14;
+
+// Channel assignments of the frame header
+static constexpr uint32_t IndependentChannels = 0b0001;
+static constexpr uint32_t LeftSideChannels    = 0b1000;
+static constexpr uint32_t SideRightChannels   = 0b1001;
+static constexpr uint32_t MidSideChannels     = 0b1010;
+
+static constexpr auto Crc8Table = [] {
+	std::array<uint8_t, 256> table = {};
+	for (size_t i = 0; i < table.size(); ++i) {
+		auto crc = static_cast<uint8_t>(i);
+		for (auto bit = 0; bit < 8; ++bit) {
+			crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07
+			                                        : (crc << 1));
+		}
+		table[i] = crc;
+	}
+	return table;
+}();
+
+static constexpr auto Crc16Table = [] {
+	std::array<uint16_t, 256> table = {};
+	for (size_t i = 0; i < table.size(); ++i) {
+		auto crc = static_cast<uint16_t>(i << 8);
+		for (auto bit = 0; bit < 8; ++bit) {
+			crc = static_cast<uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x8005
+			                                           : (crc << 1));
+		}
+		table[i] = crc;
+	}
+	return table;
+}();
+
+static uint8_t crc8(const std::vector<uint8_t>& bytes)
+{
+	uint8_t crc = 0;
+	for (const auto byte : bytes) {
+		crc = Crc8Table[crc ^ byte];
+	}
+	return crc;
+}
+
+static uint16_t crc16(const std::vector<uint8_t>& bytes)
+{
+	uint16_t crc = 0;
+	for (const auto byte : bytes) {
+		crc = static_cast<uint16_t>((crc << 8) ^ Crc16Table[(crc >> 8) ^ byte]);
+	}
+	return crc;
+}
+
+void FlacEncoder::BitWriter::Clear()
+{
+	buf.clear();
+	pending          = 0;
+	num_pending_bits = 0;
+}
+
+void FlacEncoder::BitWriter::Write(const uint32_t value, const int num_bits)
+{
+	assert(num_bits >= 0 && num_bits <= 32);
+	if (num_bits == 0) {
+		return;
+	}
+
+	// Fewer than 8 bits are pending, so 32 more always fit. The bits
+	// already written out are left above them and eventually shifted out.
+	const auto mask = (num_bits == 32) ? UINT32_MAX : (1u << num_bits) - 1;
+
+	pending = (pending << num_bits) | (value & mask);
+	num_pending_bits += num_bits;
+
+	while (num_pending_bits >= 8) {
+		num_pending_bits -= 8;
+		buf.push_back(static_cast<uint8_t>(pending >> num_pending_bits));
+	}
+}
+
+void FlacEncoder::BitWriter::WriteUnary(uint32_t num_zeros)
+{
+	while (num_zeros >= 32) {
+		Write(0, 32);
+		num_zeros -= 32;
+	}
+	Write(1, check_cast<int>(num_zeros + 1));
+}
+
+void FlacEncoder::BitWriter::AlignToByte()
+{
+	if (num_pending_bits > 0) {
+		Write(0, 8 - num_pending_bits);
+	}
+}
+
+FlacEncoder::~FlacEncoder()
+{
+	if (outfile) {
+		Finalise();
+	}
+}
+
+bool FlacEncoder::Init(FILE* fp, const uint32_t _sample_rate_hz)
+{
+	assert(fp);
+	assert(!outfile);
+
+	outfile        = fp;
+	sample_rate_hz = _sample_rate_hz;
+
+	total_frames    = 0;
+	frame_number    = 0;
+	min_frame_bytes = 0;
+	max_frame_bytes = 0;
+
+	for (auto& channel : block) {
+		channel.clear();
+		channel.reserve(BlockSize);
+	}
+
+	constexpr char Magic[] = {'f', 'L', 'a', 'C'};
+	if (fwrite(Magic, 1, sizeof(Magic), outfile) != sizeof(Magic)) {
+		return false;
+	}
+
+	// Written again with the final sizes when finalising
+	WriteStreamInfo();
+	return true;
+}
+
+void FlacEncoder::WriteStreamInfo()
+{
+	constexpr auto IsLastMetadataBlock = 1;
+	constexpr auto StreamInfoType      = 0;
+	constexpr auto StreamInfoSize      = 34;
+
+	bits.Clear();
+	bits.Write(IsLastMetadataBlock, 1);
+	bits.Write(StreamInfoType, 7);
+	bits.Write(StreamInfoSize, 24);
+
+	// The last block may be shorter
+	bits.Write(BlockSize, 16);
+	bits.Write(BlockSize, 16);
+
+	bits.Write(min_frame_bytes, 24);
+	bits.Write(max_frame_bytes, 24);
+
+	bits.Write(sample_rate_hz, 20);
+	bits.Write(NumChannels - 1, 3);
+	bits.Write(BitsPerSample - 1, 5);
+
+	bits.Write(static_cast<uint32_t>(total_frames >> 32), 4);
+	bits.Write(static_cast<uint32_t>(total_frames), 32);
+
+	// Unset MD5 signature
+	for (auto i = 0; i < 4; ++i) {
+		bits.Write(0, 32);
+	}
+
+	const auto& bytes = bits.Bytes();
+	fwrite(bytes.data(), 1, bytes.size(), outfile);
+}
+
+void FlacEncoder::AddFrames(const int16_t* frames, const size_t num_frames)
+{
+	assert(outfile);
+	assert(frames || num_frames == 0);
+
+	for (size_t i = 0; i < num_frames; ++i) {
+		block[0].push_back(frames[i * 2 + 0]);
+		block[1].push_back(frames[i * 2 + 1]);
+
+		if (block[0].size() == BlockSize) {
+			EncodeBlock();
+		}
+	}
+}
+
+void FlacEncoder::Finalise()
+{
+	assert(outfile);
+
+	if (!block[0].empty()) {
+		EncodeBlock();
+	}
+
+	constexpr auto StreamInfoOffset = 4;
+	fseek(outfile, StreamInfoOffset, SEEK_SET);
+	WriteStreamInfo();
+	fseek(outfile, 0, SEEK_END);
+
+	outfile = nullptr;
+}
+
+static uint32_t zigzag(const int32_t value)
+{
+	return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+void FlacEncoder::ComputeResidual(const std::vector<int32_t>& samples, const int order)
+{
+	const auto n = samples.size();
+	const auto s = samples.data();
+
+	residual.assign(n, 0);
+	auto r = residual.data();
+
+	switch (order) {
+	case 0:
+		for (size_t i = 0; i < n; ++i) {
+			r[i] = zigzag(s[i]);
+		}
+		break;
+	case 1:
+		for (size_t i = 1; i < n; ++i) {
+			r[i] = zigzag(s[i] - s[i - 1]);
+		}
+		break;
+	case 2:
+		for (size_t i = 2; i < n; ++i) {
+			r[i] = zigzag(s[i] - 2 * s[i - 1] + s[i - 2]);
+		}
+		break;
+	case 3:
+		for (size_t i = 3; i < n; ++i) {
+			r[i] = zigzag(s[i] - 3 * s[i - 1] + 3 * s[i - 2] - s[i - 3]);
+		}
+		break;
+	case 4:
+		for (size_t i = 4; i < n; ++i) {
+			r[i] = zigzag(s[i] - 4 * s[i - 1] + 6 * s[i - 2] -
+			              4 * s[i - 3] + s[i - 4]);
+		}
+		break;
+	default: assertm(false, "Invalid fixed predictor order"); break;
+	}
+
+	residual_sum.resize(n + 1);
+	residual_sum[0] = 0;
+	for (size_t i = 0; i < n; ++i) {
+		residual_sum[i + 1] = residual_sum[i] + r[i];
+	}
+}
+
+// The parameter that about minimises the coded size of the given number
+// of folded residuals adding up to the given sum
+static int rice_parameter(const uint64_t count, const uint64_t sum)
+{
+	auto k = 0;
+	while (k < MaxRiceParameter && (count << (k + 1)) < sum) {
+		++k;
+	}
+	return k;
+}
+
+static uint64_t rice_bits(const uint64_t count, const uint64_t sum, const int k)
+{
+	return count * static_cast<uint64_t>(k + 1) + (sum >> k);
+}
+
+FlacEncoder::Subframe FlacEncoder::PlanSubframe(const std::vector<int32_t>& samples,
+                                                const int bits_per_sample)
+{
+	const auto n = samples.size();
+	assert(n > 0);
+
+	// Subframe header
+	constexpr uint64_t HeaderBits = 8;
+
+	const auto is_constant = std::all_of(samples.begin(),
+	                                     samples.end(),
+	                                     [&](const auto s) {
+		                                     return s == samples[0];
+	                                     });
+	if (is_constant) {
+		Subframe constant    = {};
+		constant.is_constant = true;
+		constant.num_bits    = HeaderBits +
+		                    static_cast<uint64_t>(bits_per_sample);
+		return constant;
+	}
+
+	Subframe best    = {};
+	best.is_verbatim = true;
+	best.num_bits    = HeaderBits + n * static_cast<uint64_t>(bits_per_sample);
+
+	const auto max_order = std::min(MaxFixedOrder, static_cast<int>(n) - 1);
+
+	for (auto order = 0; order <= max_order; ++order) {
+		ComputeResidual(samples, order);
+
+		for (auto p = 0; p <= MaxPartitionOrder; ++p) {
+			const auto partition_size = n >> p;
+			if ((n % (size_t{1} << p)) != 0 ||
+			    partition_size <= static_cast<size_t>(order)) {
+				break;
+			}
+
+			// Warm-up samples, the coding method and partition order
+			auto num_bits = HeaderBits +
+			                static_cast<uint64_t>(order * bits_per_sample) +
+			                2 + 4;
+
+			for (size_t start = 0; start < n; start += partition_size) {
+				const auto end   = start + partition_size;
+				const auto first = std::max(start,
+				                            static_cast<size_t>(order));
+
+				const uint64_t count = end - first;
+				const auto sum = residual_sum[end] - residual_sum[first];
+
+				const auto k = rice_parameter(count, sum);
+				num_bits += 4 + rice_bits(count, sum, k);
+			}
+
+			if (num_bits < best.num_bits) {
+				best                 = {};
+				best.order           = order;
+				best.partition_order = p;
+				best.num_bits        = num_bits;
+			}
+		}
+	}
+	return best;
+}
+
+void FlacEncoder::WriteSubframe(const std::vector<int32_t>& samples,
+                                const int bits_per_sample, const Subframe& subframe)
+{
+	constexpr auto ConstantType = 0b000000;
+	constexpr auto VerbatimType = 0b000001;
+	constexpr auto FixedType    = 0b001000;
+
+	constexpr auto ZeroPadding  = 0;
+	constexpr auto NoWastedBits = 0;
+	constexpr auto RiceMethod   = 0b00;
+
+	bits.Write(ZeroPadding, 1);
+
+	if (subframe.is_constant) {
+		bits.Write(ConstantType, 6);
+		bits.Write(NoWastedBits, 1);
+		bits.Write(static_cast<uint32_t>(samples[0]), bits_per_sample);
+		return;
+	}
+
+	if (subframe.is_verbatim) {
+		bits.Write(VerbatimType, 6);
+		bits.Write(NoWastedBits, 1);
+		for (const auto s : samples) {
+			bits.Write(static_cast<uint32_t>(s), bits_per_sample);
+		}
+		return;
+	}
+
+	const auto order = subframe.order;
+
+	bits.Write(static_cast<uint32_t>(FixedType | order), 6);
+	bits.Write(NoWastedBits, 1);
+
+	for (auto i = 0; i < order; ++i) {
+		bits.Write(static_cast<uint32_t>(samples[i]), bits_per_sample);
+	}
+
+	ComputeResidual(samples, order);
+
+	bits.Write(RiceMethod, 2);
+	bits.Write(static_cast<uint32_t>(subframe.partition_order), 4);
+
+	const auto n              = samples.size();
+	const auto partition_size = n >> subframe.partition_order;
+
+	for (size_t start = 0; start < n; start += partition_size) {
+		const auto first = std::max(start, static_cast<size_t>(order));
+		const auto end   = start + partition_size;
+
+		const auto k = rice_parameter(end - first,
+		                              residual_sum[end] - residual_sum[first]);
+
+		const auto low_bits_mask = (1u << k) - 1;
+
+		bits.Write(static_cast<uint32_t>(k), 4);
+		for (auto i = first; i < end; ++i) {
+			const auto value = residual[i];
+			bits.WriteUnary(value >> k);
+			bits.Write(value & low_bits_mask, k);
+		}
+	}
+}
+
+// Frame numbers are coded like UTF-8 characters, extended to 31 bits
+static void write_frame_number(std::vector<uint8_t>& out, const uint32_t number)
+{
+	if (number < 0x80) {
+		out.push_back(static_cast<uint8_t>(number));
+		return;
+	}
+
+	auto num_bytes = 2;
+	while (num_bytes < 6 && number >= (1u << (5 * num_bytes + 1))) {
+		++num_bytes;
+	}
+
+	const auto lead = static_cast<uint8_t>(0xff << (8 - num_bytes));
+	out.push_back(static_cast<uint8_t>(lead | (number >> (6 * (num_bytes - 1)))));
+
+	for (auto i = num_bytes - 2; i >= 0; --i) {
+		out.push_back(static_cast<uint8_t>(0x80 | ((number >> (6 * i)) & 0x3f)));
+	}
+}
+
+void FlacEncoder::EncodeBlock()
+{
+	auto& left  = block[0];
+	auto& right = block[1];
+
+	const auto n = left.size();
+	assert(n > 0 && n <= BlockSize && right.size() == n);
+
+	mid.resize(n);
+	side.resize(n);
+	for (size_t i = 0; i < n; ++i) {
+		mid[i]  = (left[i] + right[i]) >> 1;
+		side[i] = left[i] - right[i];
+	}
+
+	// The side channel needs an extra bit
+	constexpr auto SideBitsPerSample = BitsPerSample + 1;
+
+	const auto left_plan  = PlanSubframe(left, BitsPerSample);
+	const auto right_plan = PlanSubframe(right, BitsPerSample);
+	const auto mid_plan   = PlanSubframe(mid, BitsPerSample);
+	const auto side_plan  = PlanSubframe(side, SideBitsPerSample);
+
+	const std::array<uint64_t, 4> sizes = {
+	        left_plan.num_bits + right_plan.num_bits,
+	        left_plan.num_bits + side_plan.num_bits,
+	        side_plan.num_bits + right_plan.num_bits,
+	        mid_plan.num_bits + side_plan.num_bits};
+
+	const auto smallest = std::min_element(sizes.begin(), sizes.end()) -
+	                      sizes.begin();
+
+	constexpr std::array<uint32_t, 4> ChannelAssignments = {IndependentChannels,
+	                                                        LeftSideChannels,
+	                                                        SideRightChannels,
+	                                                        MidSideChannels};
+
+	// Frame header
+	static_assert(BlockSize == 4096);
+	constexpr auto FixedBlockSizeSync = 0xfff8;
+	constexpr auto BlockSize4096      = 0b1100;
+	constexpr auto BlockSizeFollows   = 0b0111;
+	constexpr auto StreamSampleRate   = 0b0000;
+	constexpr auto SixteenBitSamples  = 0b100;
+
+	const auto is_full_block = (n == BlockSize);
+
+	bits.Clear();
+	bits.Write(FixedBlockSizeSync, 16);
+	bits.Write(is_full_block ? BlockSize4096 : BlockSizeFollows, 4);
+	bits.Write(StreamSampleRate, 4);
+	bits.Write(ChannelAssignments[static_cast<size_t>(smallest)], 4);
+	bits.Write(SixteenBitSamples, 3);
+	bits.Write(0, 1);
+
+	std::vector<uint8_t> frame_number_bytes = {};
+	write_frame_number(frame_number_bytes, frame_number);
+	for (const auto byte : frame_number_bytes) {
+		bits.Write(byte, 8);
+	}
+	if (!is_full_block) {
+		bits.Write(static_cast<uint32_t>(n - 1), 16);
+	}
+	bits.Write(crc8(bits.Bytes()), 8);
+
+	switch (ChannelAssignments[static_cast<size_t>(smallest)]) {
+	case IndependentChannels:
+		WriteSubframe(left, BitsPerSample, left_plan);
+		WriteSubframe(right, BitsPerSample, right_plan);
+		break;
+	case LeftSideChannels:
+		WriteSubframe(left, BitsPerSample, left_plan);
+		WriteSubframe(side, SideBitsPerSample, side_plan);
+		break;
+	case SideRightChannels:
+		WriteSubframe(side, SideBitsPerSample, side_plan);
+		WriteSubframe(right, BitsPerSample, right_plan);
+		break;
+	case MidSideChannels:
+		WriteSubframe(mid, BitsPerSample, mid_plan);
+		WriteSubframe(side, SideBitsPerSample, side_plan);
+		break;
+	}
+
+	// Frame footer
+	bits.AlignToByte();
+	bits.Write(crc16(bits.Bytes()), 16);
+
+	const auto& bytes = bits.Bytes();
+	fwrite(bytes.data(), 1, bytes.size(), outfile);
+
+	const auto frame_bytes = static_cast<uint32_t>(bytes.size());
+	min_frame_bytes = (frame_number == 0) ? frame_bytes
+	                                      : std::min(min_frame_bytes, frame_bytes);
+	max_frame_bytes = std::max(max_frame_bytes, frame_bytes);
+
+	total_frames += n;
+	++frame_number;
+
+	left.clear();
+	right.clear();
+}
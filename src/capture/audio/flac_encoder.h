@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_FLAC_ENCODER_H
+#define DOSBOX_FLAC_ENCODER_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Writes 16-bit stereo audio as a FLAC stream.
+//
+// Each block is predicted with the best of the fixed polynomial predictors
+// and the residual is Rice coded, after picking the cheapest of the
+// independent, left/side, side/right and mid/side channel pairings. That's
+// roughly what 'flac -1' does, which on game audio gives files around half
+// the size of WAV at a fraction of the cost of the LPC search of the
+// higher levels. The MD5 signature of the stream is left unset, which the
+// format permits.
+//
+// Specification: https://www.rfc-editor.org/rfc/rfc9639
+//
+class FlacEncoder {
+public:
+	static constexpr int BlockSize = 4096;
+
+	FlacEncoder() = default;
+	~FlacEncoder();
+
+	// Writes the stream header
+	bool Init(FILE* fp, const uint32_t sample_rate_hz);
+
+	// Interleaved left and right samples
+	void AddFrames(const int16_t* frames, const size_t num_frames);
+
+	// Writes the last short block and completes the stream header. Must be
+	// called before closing the file.
+	void Finalise();
+
+	// prevent copying
+	FlacEncoder(const FlacEncoder&) = delete;
+	// prevent assignment
+	FlacEncoder& operator=(const FlacEncoder&) = delete;
+
+private:
+	class BitWriter {
+	public:
+		void Clear();
+		void Write(const uint32_t value, const int num_bits);
+		void WriteUnary(uint32_t num_zeros);
+		void AlignToByte();
+
+		const std::vector<uint8_t>& Bytes() const
+		{
+			return buf;
+		}
+
+	private:
+		std::vector<uint8_t> buf = {};
+
+		uint64_t pending     = 0;
+		int num_pending_bits = 0;
+	};
+
+	struct Subframe {
+		bool is_constant    = false;
+		bool is_verbatim    = false;
+		int order           = 0;
+		int partition_order = 0;
+		uint64_t num_bits   = 0;
+	};
+
+	void EncodeBlock();
+
+	Subframe PlanSubframe(const std::vector<int32_t>& samples,
+	                      const int bits_per_sample);
+
+	void WriteSubframe(const std::vector<int32_t>& samples,
+	                   const int bits_per_sample, const Subframe& subframe);
+
+	void ComputeResidual(const std::vector<int32_t>& samples, const int order);
+
+	void WriteStreamInfo();
+
+	FILE* outfile = nullptr;
+
+	uint32_t sample_rate_hz = 0;
+	uint64_t total_frames   = 0;
+	uint32_t frame_number   = 0;
+
+	uint32_t min_frame_bytes = 0;
+	uint32_t max_frame_bytes = 0;
+
+	// The block being collected, as left and right channels
+	std::array<std::vector<int32_t>, 2> block = {};
+
+	std::vector<int32_t> mid  = {};
+	std::vector<int32_t> side = {};
+
+	// The zigzag-folded residual of the current prediction, and its
+	// running sums for sizing the Rice partitions
+	std::vector<uint32_t> residual     = {};
+	std::vector<uint64_t> residual_sum = {};
+
+	BitWriter bits = {};
+};
+
+#endif // DOSBOX_FLAC_ENCODER_H
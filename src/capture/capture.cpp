@@ -19,10 +19,13 @@
 #include "gui/titlebar.h"
 #include "image/image_capturer.h"
 #include "misc/support.h"
+#include "misc/tracy.h"
 #include "utils/checks.h"
 #include "utils/fs_utils.h"
 #include "utils/string_utils.h"
 
+#include "zmbv/zmbv.h"
+
 #include <SDL.h>
 
 CHECK_NARROWING();
@@ -60,6 +63,11 @@ static struct {
 
 static std::unique_ptr<ImageCapturer> image_capturer = {};
 
+// Kept so the image capturer can be recreated after a suspend
+static std::string image_capture_prefs          = {};
+static ImageWriterSettings image_writer_settings = {};
+static bool is_image_capturer_suspended        = false;
+
 bool CAPTURE_IsCapturingAudio()
 {
 	return capture.state.audio != CaptureState::Off;
@@ -91,6 +99,26 @@ bool CAPTURE_IsCapturingVideo()
 	return capture.state.video != CaptureState::Off;
 }
 
+void CAPTURE_SuspendImageSavers()
+{
+	if (!image_capturer) {
+		return;
+	}
+	// Blocks until the pending images are written out
+	image_capturer = {};
+	is_image_capturer_suspended = true;
+}
+
+void CAPTURE_ResumeImageSavers()
+{
+	if (!is_image_capturer_suspended) {
+		return;
+	}
+	is_image_capturer_suspended = false;
+	image_capturer = std::make_unique<ImageCapturer>(image_capture_prefs,
+	                                                 image_writer_settings);
+}
+
 static const char* capture_type_to_string(const CaptureType type)
 {
 	switch (type) {
@@ -134,7 +162,7 @@ static const char* capture_type_to_basename(const CaptureType type)
 static const char* capture_type_to_extension(const CaptureType type)
 {
 	switch (type) {
-	case CaptureType::Audio: return ".wav";
+	case CaptureType::Audio: return capture_audio_get_file_extension();
 	case CaptureType::Midi: return ".mid";
 	case CaptureType::RawOplStream: return ".dro";
 	case CaptureType::RadOplInstruments: return ".rad";
@@ -143,7 +171,10 @@ static const char* capture_type_to_extension(const CaptureType type)
 
 	case CaptureType::RawImage:
 	case CaptureType::UpscaledImage:
-	case CaptureType::RenderedImage: return ".png";
+	case CaptureType::RenderedImage:
+		return (image_writer_settings.file_format == ImageFileFormat::Qoi)
+		             ? ".qoi"
+		             : ".png";
 
 	case CaptureType::SerialLog: return ".serlog";
 
@@ -382,10 +413,14 @@ void CAPTURE_StopVideoCapture()
 	}
 }
 
-void CAPTURE_AddFrame(const RenderedImage& image, const float frames_per_second)
+void CAPTURE_AddFrame(const RenderedImage& image,
+                      const SharedRenderedImage& shared_image,
+                      const float frames_per_second)
 {
-	if (image_capturer) {
-		image_capturer->MaybeCaptureImage(image);
+	ZoneScoped;
+
+	if (image_capturer && shared_image) {
+		image_capturer->MaybeCaptureImage(shared_image);
 	}
 
 	switch (capture.state.video) {
@@ -575,6 +610,19 @@ static void capture_destroy(Section* /*sec*/)
 	capture.reset();
 }
 
+static PngCompressionStrategy to_png_compression_strategy(const std::string& pref)
+{
+	if (pref == "filtered") {
+		return PngCompressionStrategy::Filtered;
+	} else if (pref == "rle") {
+		return PngCompressionStrategy::Rle;
+	} else if (pref == "huffman") {
+		return PngCompressionStrategy::HuffmanOnly;
+	} else {
+		return PngCompressionStrategy::Default;
+	}
+}
+
 static void capture_init(Section* sec)
 {
 	assert(sec);
@@ -595,9 +643,40 @@ static void capture_init(Section* sec)
 		capture.path = "capture";
 	}
 
-	const std::string prefs = secprop->GetString("default_image_capture_formats");
+	image_capture_prefs = secprop->GetString("default_image_capture_formats");
+
+	const auto image_file_format = secprop->GetString("image_file_format");
+
+	image_writer_settings.file_format = (image_file_format == "qoi")
+	                                          ? ImageFileFormat::Qoi
+	                                          : ImageFileFormat::Png;
 
-	image_capturer = std::make_unique<ImageCapturer>(prefs);
+	image_writer_settings.png_compression_level = secprop->GetInt(
+	        "png_compression_level");
+
+	image_writer_settings.png_compression_strategy = to_png_compression_strategy(
+	        secprop->GetString("png_compression_strategy"));
+
+	image_capturer = std::make_unique<ImageCapturer>(image_capture_prefs,
+	                                                 image_writer_settings);
+	is_image_capturer_suspended = false;
+
+	capture_audio_set_format((secprop->GetString("audio_capture_format") == "flac")
+	                                 ? AudioCaptureFormat::Flac
+	                                 : AudioCaptureFormat::Wav);
+
+	capture_video_set_compression_level(
+	        secprop->GetInt("video_compression_level"));
+
+	std::string pipe_command = {};
+	if (secprop->GetString("capture_format") == "pipe") {
+		pipe_command = secprop->GetString("pipe_command");
+		if (pipe_command.empty()) {
+			LOG_WARNING("CAPTURE: No 'pipe_command' set for the 'pipe' "
+			            "capture format; using 'zmbv'");
+		}
+	}
+	capture_video_set_pipe_command(pipe_command);
 
 	constexpr auto changeable_at_runtime = true;
 	sec->AddDestroyFunction(&capture_destroy, changeable_at_runtime);
@@ -684,6 +763,90 @@ static void init_capture_dosbox_settings(SectionProp& secprop)
 	        "Keybindings for taking single screenshots in specific formats are also\n"
 	        "available.");
 	assert(str_prop);
+
+	str_prop = secprop.AddString("image_file_format", when_idle, "png");
+	str_prop->SetValues({"png", "qoi"});
+	str_prop->SetHelp(
+	        "File format of screenshots ('png' by default):\n"
+	        "  png:  Compressed PNG files that preserve the palette and pixel aspect\n"
+	        "        ratio of raw screenshots.\n"
+	        "  qoi:  Lossless QOI (\"Quite OK Image\") files, several times faster to\n"
+	        "        write than PNG, at the cost of somewhat larger files. Useful for\n"
+	        "        capturing many high resolution screenshots in quick succession.");
+	assert(str_prop);
+
+	auto* int_prop = secprop.AddInt("png_compression_level", when_idle, 6);
+	int_prop->SetMinMax(0, 9);
+	int_prop->SetHelp(
+	        "Compression level of PNG screenshots, from 0 (uncompressed, fastest) to 9\n"
+	        "(smallest files, slowest). Levels 1 and below also use the cheapest row\n"
+	        "filter (6 by default).");
+	assert(int_prop);
+
+	str_prop = secprop.AddString("png_compression_strategy", when_idle, "default");
+	str_prop->SetValues({"default", "filtered", "rle", "huffman"});
+	str_prop->SetHelp(
+	        "zlib compression strategy of PNG screenshots ('default' by default):\n"
+	        "  default:   Best for most images.\n"
+	        "  filtered:  Can be smaller for photo-like true color images.\n"
+	        "  rle:       Only finds runs of identical bytes; much faster at a given\n"
+	        "             level, and still effective on flat-colored DOS graphics.\n"
+	        "  huffman:   No matching at all; fastest but largest.");
+	assert(str_prop);
+
+	str_prop = secprop.AddString("audio_capture_format", when_idle, "wav");
+	str_prop->SetValues({"wav", "flac"});
+	str_prop->SetHelp(
+	        "File format of audio output captures ('wav' by default):\n"
+	        "  wav:   Uncompressed 16-bit PCM WAV files (about 10 MB per minute).\n"
+	        "  flac:  Lossless FLAC files, typically half the size of WAV or less,\n"
+	        "         encoded on a separate thread.");
+	assert(str_prop);
+
+	int_prop = secprop.AddInt("video_compression_level",
+	                          when_idle,
+	                          ZMBV_DefaultCompressionLevel);
+	int_prop->SetMinMax(ZMBV_MinCompressionLevel, ZMBV_MaxCompressionLevel);
+	int_prop->SetHelp(
+	        "Compression level of video captures, from 1 (fastest, largest files) to 9\n"
+	        "(slowest, smallest files). Try a lower level if the emulation slows down or\n"
+	        "frames are dropped while capturing at high resolutions (6 by default).");
+	assert(int_prop);
+
+	str_prop = secprop.AddString("capture_format", when_idle, "zmbv");
+	str_prop->SetValues({"zmbv", "pipe"});
+	str_prop->SetHelp(
+	        "Format of video captures ('zmbv' by default):\n"
+	        "  zmbv:  Lossless ZMBV video and PCM audio in AVI files.\n"
+	        "  pipe:  Stream the raw frames and audio to the external encoder set by\n"
+	        "         'pipe_command', such as FFmpeg, to encode them straight to any\n"
+	        "         format it supports without re-encoding ZMBV files later.");
+	assert(str_prop);
+
+	str_prop = secprop.AddString(
+	        "pipe_command",
+	        when_idle,
+	        "ffmpeg -hide_banner -loglevel error -y "
+	        "-f rawvideo -pixel_format bgr0 -video_size {width}x{height} "
+	        "-framerate {fps} -i - "
+	        "-f s16le -ar {sample_rate} -ac 2 -i {audio} "
+	        "-c:v libx264 -preset veryfast -crf 18 -pix_fmt yuv420p "
+	        "-c:a aac -b:a 192k {output}.mp4");
+	str_prop->SetHelp(
+	        "Command to run for each video capture with the 'pipe' capture format.\n"
+	        "It reads the frames on its standard input as raw 32-bit BGRX pixels\n"
+	        "('bgr0' in FFmpeg) at a constant frame rate, and the audio as 16-bit\n"
+	        "little-endian stereo PCM from a FIFO (not available on Windows). These\n"
+	        "placeholders are replaced before the command is run:\n"
+	        "  {width}, {height}:  The size of the frames.\n"
+	        "  {fps}:              The frame rate.\n"
+	        "  {sample_rate}:      The audio sample rate.\n"
+	        "  {audio}:            The path of the audio FIFO.\n"
+	        "  {output}:           The capture path without an extension\n"
+	        "                      (e.g. 'capture/video0001').\n"
+	        "A new command is started if the video mode changes. The default encodes\n"
+	        "H.264 and AAC into MP4 files.");
+	assert(str_prop);
 }
 
 void CAPTURE_AddConfigSection(const ConfigPtr& conf)
@@ -37,8 +37,12 @@ FILE* CAPTURE_CreateFile(const CaptureType type,
                          const std::optional<std_fs::path>& path = {});
 
 // Used to add the last rendered frame to be captured either as a screenshot
-// or as a video recording (or both).
-void CAPTURE_AddFrame(const RenderedImage& image, const float frames_per_second);
+// or as a video recording (or both). Screenshots keep `shared_image`, a
+// copy of the frame that's only needed while CAPTURE_IsCapturingImage();
+// video recordings convert `image` right away.
+void CAPTURE_AddFrame(const RenderedImage& image,
+                      const SharedRenderedImage& shared_image,
+                      const float frames_per_second);
 
 void CAPTURE_AddPostRenderImage([[maybe_unused]] const RenderedImage& image);
 
@@ -58,6 +62,12 @@ bool CAPTURE_IsCapturingPostRenderImage();
 bool CAPTURE_IsCapturingMidi();
 bool CAPTURE_IsCapturingVideo();
 
+// Stops the image saver threads after they have written every queued image,
+// and starts them again. Used around fork(), which only carries the calling
+// thread into the child.
+void CAPTURE_SuspendImageSavers();
+void CAPTURE_ResumeImageSavers();
+
 // Only used internally in the capture module
 int32_t get_next_capture_index(const CaptureType type);
 
@@ -6,11 +6,19 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <thread>
+#include <vector>
 
+#include "private/capture_audio.h"
+
+#include "audio/flac_encoder.h"
 #include "config/setup.h"
 #include "gui/titlebar.h"
 #include "hardware/memory.h"
+#include "misc/support.h"
 #include "misc/video.h"
+#include "utils/byteorder.h"
+#include "utils/rwqueue.h"
 
 static constexpr auto SampleFrameSize   = 4;
 static constexpr auto NumFramesInBuffer = 16 * 1024;
@@ -39,6 +47,29 @@ static struct {
 	uint32_t data_bytes_written = 0;
 } wave = {};
 
+// FLAC captures are encoded on their own thread, so the main thread only
+// collects the samples until they fill a block. Queuing only waits if
+// the encoder falls several seconds behind.
+static constexpr auto MaxQueuedFlacBlocks = 64;
+
+static struct {
+	FILE* handle = nullptr;
+
+	RWQueue<std::vector<int16_t>> queue{MaxQueuedFlacBlocks};
+	std::thread thread = {};
+
+	// Only used by the encoder thread while it's running
+	FlacEncoder encoder = {};
+
+	std::vector<int16_t> samples = {};
+} flac = {};
+
+// Set from the [capture] section, read when a capture is started
+static AudioCaptureFormat next_format = AudioCaptureFormat::Wav;
+
+// Of the capture in progress
+static AudioCaptureFormat format = AudioCaptureFormat::Wav;
+
 // clang-format off
 static uint8_t wav_header[] = {
 	'R',  'I',  'F',  'F',   // uint32 - RIFF chunk ID
@@ -71,19 +102,9 @@ static void create_wave_file(const uint32_t sample_rate_hz)
 	fwrite(wav_header, 1, sizeof(wav_header), wave.handle);
 }
 
-void capture_audio_add_data(const uint32_t sample_rate_hz,
-                            const uint32_t num_sample_frames,
-                            const int16_t* sample_frames)
+static void add_wave_data(const uint32_t num_sample_frames,
+                          const int16_t* sample_frames)
 {
-	if (!wave.handle) {
-		TITLEBAR_NotifyAudioCaptureStatus(true);
-		create_wave_file(sample_rate_hz);
-	}
-	if (!wave.handle) {
-		TITLEBAR_NotifyAudioCaptureStatus(false);
-		return;
-	}
-
 	const int16_t* data   = sample_frames;
 	auto remaining_frames = num_sample_frames;
 
@@ -113,12 +134,117 @@ void capture_audio_add_data(const uint32_t sample_rate_hz,
 	}
 }
 
-void capture_audio_finalise()
+static void encode_queued_flac_samples()
 {
-	if (!wave.handle) {
+	while (auto samples = flac.queue.Dequeue()) {
+		flac.encoder.AddFrames(samples->data(), samples->size() / NumChannels);
+	}
+}
+
+static void create_flac_file(const uint32_t sample_rate_hz)
+{
+	flac.handle = CAPTURE_CreateFile(CaptureType::Audio);
+	if (!flac.handle) {
+		return;
+	}
+
+	if (!flac.encoder.Init(flac.handle, sample_rate_hz)) {
+		LOG_WARNING("CAPTURE: Failed to write FLAC header");
+		fclose(flac.handle);
+		flac.handle = nullptr;
+		return;
+	}
+
+	flac.samples.clear();
+	flac.samples.reserve(FlacEncoder::BlockSize * NumChannels);
+
+	flac.queue.Start();
+	flac.thread = std::thread(encode_queued_flac_samples);
+	set_thread_name(flac.thread, "dosbox:audcap");
+}
+
+static void add_flac_data(const uint32_t num_sample_frames,
+                          const int16_t* sample_frames)
+{
+	// The mixer hands over little-endian samples, as written to WAV files
+	const auto num_samples = num_sample_frames * NumChannels;
+	for (uint32_t i = 0; i < num_samples; ++i) {
+		const auto sample = le16_to_host(static_cast<uint16_t>(sample_frames[i]));
+		flac.samples.push_back(static_cast<int16_t>(sample));
+	}
+
+	if (flac.samples.size() >= FlacEncoder::BlockSize * NumChannels) {
+		flac.queue.Enqueue(std::move(flac.samples));
+
+		flac.samples = {};
+		flac.samples.reserve(FlacEncoder::BlockSize * NumChannels);
+	}
+}
+
+static bool is_capturing()
+{
+	return wave.handle || flac.handle;
+}
+
+void capture_audio_set_format(const AudioCaptureFormat new_format)
+{
+	next_format = new_format;
+}
+
+const char* capture_audio_get_file_extension()
+{
+	const auto current = is_capturing() ? format : next_format;
+	return (current == AudioCaptureFormat::Flac) ? ".flac" : ".wav";
+}
+
+void capture_audio_add_data(const uint32_t sample_rate_hz,
+                            const uint32_t num_sample_frames,
+                            const int16_t* sample_frames)
+{
+	if (!is_capturing()) {
+		TITLEBAR_NotifyAudioCaptureStatus(true);
+
+		format = next_format;
+		switch (format) {
+		case AudioCaptureFormat::Wav: create_wave_file(sample_rate_hz); break;
+		case AudioCaptureFormat::Flac: create_flac_file(sample_rate_hz); break;
+		}
+	}
+	if (!is_capturing()) {
+		TITLEBAR_NotifyAudioCaptureStatus(false);
 		return;
 	}
 
+	switch (format) {
+	case AudioCaptureFormat::Wav:
+		add_wave_data(num_sample_frames, sample_frames);
+		break;
+	case AudioCaptureFormat::Flac:
+		add_flac_data(num_sample_frames, sample_frames);
+		break;
+	}
+}
+
+static void finalise_flac_file()
+{
+	if (!flac.samples.empty()) {
+		flac.queue.Enqueue(std::move(flac.samples));
+		flac.samples = {};
+	}
+
+	// Let the encoder write out the queued samples
+	flac.queue.Stop();
+	if (flac.thread.joinable()) {
+		flac.thread.join();
+	}
+
+	flac.encoder.Finalise();
+	fclose(flac.handle);
+	flac.handle = nullptr;
+}
+
+static void finalise_wave_file()
+{
 	// Flush audio buffer
 	const auto bytes_to_write = wave.buf_frames_used * SampleFrameSize;
 	fwrite(wave.buf, 1, bytes_to_write, wave.handle);
@@ -148,6 +274,18 @@ void capture_audio_finalise()
 	fclose(wave.handle);
 
 	wave = {};
+}
+
+void capture_audio_finalise()
+{
+	if (!is_capturing()) {
+		return;
+	}
+
+	switch (format) {
+	case AudioCaptureFormat::Wav: finalise_wave_file(); break;
+	case AudioCaptureFormat::Flac: finalise_flac_file(); break;
+	}
 
 	TITLEBAR_NotifyAudioCaptureStatus(false);
 }
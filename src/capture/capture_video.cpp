@@ -4,13 +4,23 @@
 
 #include "capture.h"
 
+#include "private/capture_video.h"
+#include "private/capture_video_pipe.h"
+
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
+#include <mutex>
+#include <optional>
+#include <thread>
 
 #include "gui/render.h"
 #include "hardware/memory.h"
+#include "misc/perf_counters.h"
 #include "misc/support.h"
 #include "utils/math_utils.h"
+#include "utils/rwqueue.h"
 
 #include "zmbv/zmbv.h"
 
@@ -21,6 +31,58 @@ static constexpr auto NumAudioChannels = 2;
 
 static constexpr auto AviHeaderSize = 500;
 
+// Off-thread encoding
+// ~~~~~~~~~~~~~~~~~~~
+// Compressing a frame with ZMBV and writing the AVI chunks takes long
+// enough at high resolutions to slow the emulation down, so it's done on
+// an encoder thread instead, like the image savers do. The rendering path
+// only copies the raw rows into one of a small pool of reusable buffers
+// and queues them with the audio captured since the previous frame.
+//
+// If the encoder falls behind and every buffer is still queued, the frame
+// is dropped rather than making the emulation wait. A dropped frame is
+// written as an empty chunk, which players show as a repeat of the
+// previous frame, so the video stays in sync with the audio. The frame
+// after it is a keyframe.
+
+// The encoder owns the buffers of the frames it's yet to write
+static constexpr auto MaxQueuedFrames = 8;
+
+// Frames dropped while the encoder catches up queue without buffers
+static constexpr auto MaxQueuedTasks = MaxQueuedFrames * 8;
+
+// The ZMBV encoder compresses bands of block rows on up to this many of its
+// own threads; the rest of the cores are left to the emulation
+static constexpr auto MaxCompressionThreads = 4;
+
+// Set from the [capture] section, read when a new file is started
+static std::atomic<int> compression_level = ZMBV_DefaultCompressionLevel;
+
+// Set from the [capture] section, read when a capture is started. Frames
+// go to ZMBV AVI files if it's empty.
+static std::string pipe_command = {};
+
+static PerfCounter video_capture_dropped_frames(
+        "video_capture_dropped_frames",
+        "Captured video frames dropped because the encoder fell behind.");
+
+static struct {
+	RWQueue<VideoCaptureTask> queue{MaxQueuedTasks};
+	std::thread thread = {};
+
+	std::mutex pool_mutex                       = {};
+	std::vector<std::vector<uint8_t>> free_pool = {};
+	int num_buffers                             = 0;
+
+	// Captured since the last queued frame
+	std::vector<int16_t> audio = {};
+	uint32_t audio_sample_rate = 0;
+
+	// Of the capture in progress
+	std::string pipe_command = {};
+} encoder = {};
+
+// Only used by the encoder thread while it's running
 static struct {
 	FILE* handle = nullptr;
 
@@ -37,6 +99,8 @@ static struct {
 	std::vector<uint8_t> index = {};
 	uint32_t index_used        = 0;
 
+	bool force_keyframe = false;
+
 	struct {
 		int16_t buf[NumSampleFramesInBuffer][NumAudioChannels] = {};
 
@@ -97,7 +161,9 @@ static void add_avi_chunk(const char* tag, const uint32_t size,
 	fwrite(chunk, 1, 8, video.handle);
 
 	auto writesize = (size + 1) & ~1;
-	fwrite(data, 1, writesize, video.handle);
+	if (writesize > 0) {
+		fwrite(data, 1, writesize, video.handle);
+	}
 
 	auto pos = video.written + 4;
 	video.written += writesize + 8;
@@ -119,7 +185,7 @@ static void add_avi_chunk(const char* tag, const uint32_t size,
 	host_writed(index + 12, size);
 }
 
-void capture_video_finalise()
+static void close_avi_file()
 {
 	if (!video.handle) {
 		return;
@@ -281,6 +347,7 @@ void capture_video_finalise()
 
 	fclose(video.handle);
 	delete video.codec;
+	video.codec  = nullptr;
 	video.handle = nullptr;
 }
 
@@ -288,20 +355,22 @@ void capture_video_add_audio_data(const uint32_t sample_rate,
                                   const uint32_t num_sample_frames,
                                   const int16_t* sample_frames)
 {
-	if (!video.handle) {
+	if (!encoder.thread.joinable()) {
 		return;
 	}
-	auto frames_left = NumSampleFramesInBuffer - video.audio.buf_frames_used;
+	const auto frames_used = check_cast<uint32_t>(encoder.audio.size() /
+	                                              NumAudioChannels);
+
+	auto frames_left = NumSampleFramesInBuffer - frames_used;
 	if (frames_left > num_sample_frames) {
 		frames_left = num_sample_frames;
 	}
 
-	memcpy(&video.audio.buf[video.audio.buf_frames_used],
-	       sample_frames,
-	       frames_left * SampleFrameSize);
+	encoder.audio.insert(encoder.audio.end(),
+	                     sample_frames,
+	                     sample_frames + frames_left * NumAudioChannels);
 
-	video.audio.buf_frames_used += frames_left;
-	video.audio.sample_rate = sample_rate;
+	encoder.audio_sample_rate = sample_rate;
 }
 
 static void create_avi_file(const uint16_t width, const uint16_t height,
@@ -312,8 +381,13 @@ static void create_avi_file(const uint16_t width, const uint16_t height,
 	if (!video.handle) {
 		return;
 	}
+	const auto num_threads = std::clamp(static_cast<int>(
+	                                            std::thread::hardware_concurrency() / 2),
+	                                    1,
+	                                    MaxCompressionThreads);
+
 	video.codec = new VideoCodec();
-	if (!video.codec->SetupCompress(width, height)) {
+	if (!video.codec->SetupCompress(width, height, compression_level, num_threads)) {
 		return;
 	}
 
@@ -336,11 +410,12 @@ static void create_avi_file(const uint16_t width, const uint16_t height,
 	video.written               = 0;
 	video.audio.buf_frames_used = 0;
 	video.audio.bytes_written   = 0;
+	video.force_keyframe        = false;
 }
 
 // Performs some transforms on the passed down rendered image to make sure
-// we're capturing the raw output, then passes the result in the same
-// byte-order to the encoder. Endianness varies per pixel format (see
+// we're capturing the raw output, then copies the result in the same
+// byte-order for the encoder. Endianness varies per pixel format (see
 // PixelFormat in video.h for details); the ZMBV encoder handles all that
 // detail.
 //
@@ -362,112 +437,131 @@ static void create_avi_file(const uint16_t width, const uint16_t height,
 // artifacts (so 320x200 is rendered as 640x200, and 640x200 as 1280x200).
 // These are written as-is, otherwise we'd be losing information.
 //
-static void compress_raw_frame(const RenderedImage& image)
+static void copy_raw_frame(const RenderedImage& image, const int raw_width,
+                           const int raw_height, std::vector<uint8_t>& pixels)
 {
 	const auto& src = image.params;
 	auto src_row    = image.image_data;
 
 	// To reconstruct the raw image, we must skip every second row
 	// when dealing with "baked-in" double scanning.
-	const auto raw_height = (src.height / (src.rendered_double_scan ? 2 : 1));
 	const auto src_pitch = (image.pitch * (src.rendered_double_scan ? 2 : 1));
 
-	// To reconstruct the raw image, we must skip every second pixel
-	// when dealing with "baked-in" pixel doubling.
-	const auto raw_width = (src.width / (src.rendered_pixel_doubling ? 2 : 1));
-
 	const auto pixel_skip_count = (src.rendered_pixel_doubling ? 1 : 0);
 
-	auto compress_row = [&](const uint8_t* row_buffer) {
-		video.codec->CompressLines(1, &row_buffer);
-	};
-
 	const auto src_bpp = to_bytes_per_pixel(src.pixel_format);
 	const auto dest_bpp = to_bytes_per_pixel(to_zmbv_format(src.pixel_format));
 
-	// Maybe compress the source rows straight away without copying. Note
-	// that this is a shortcut scenario; hard-code it to false to exercise
-	// the rote version below.
+	const auto dest_row_bytes = check_cast<size_t>(raw_width * dest_bpp);
+	pixels.resize(dest_row_bytes * check_cast<size_t>(raw_height));
 
+	auto dest_row = pixels.data();
+
+	// Copy the source rows straight away if they're already in the right
+	// layout
 	const auto can_use_src_directly = (src_bpp == dest_bpp &&
 	                                   pixel_skip_count == 0);
 	if (can_use_src_directly) {
-		for (auto i = 0; i < raw_height; ++i, src_row += src_pitch) {
-			compress_row(src_row);
+		for (auto i = 0; i < raw_height;
+		     ++i, src_row += src_pitch, dest_row += dest_row_bytes) {
+			std::memcpy(dest_row, src_row, dest_row_bytes);
 		}
 		return;
 	}
 
-	// Otherwise we need to arrange the source bytes before compressing
-	assert(!can_use_src_directly);
-
-	// Grow the target row buffer if needed
-	const auto dest_row_bytes = check_cast<uint16_t>(src.width * dest_bpp);
-	static std::vector<uint8_t> dest_row = {};
-	if (dest_row.size() < dest_row_bytes) {
-		dest_row.resize(dest_row_bytes, 0);
-	}
-
+	// Otherwise we need to arrange the source bytes
 	const auto src_advance = src_bpp * (pixel_skip_count + 1);
 
-	for (auto i = 0; i < raw_height; ++i, src_row += src_pitch) {
+	for (auto i = 0; i < raw_height;
+	     ++i, src_row += src_pitch, dest_row += dest_row_bytes) {
 		auto src_pixel  = src_row;
-		auto dest_pixel = dest_row.data();
+		auto dest_pixel = dest_row;
 
 		for (auto j = 0; j < raw_width; ++j, src_pixel += src_advance) {
 			std::memcpy(dest_pixel, src_pixel, src_bpp);
 			dest_pixel += dest_bpp;
 		}
-		compress_row(dest_row.data());
 	}
 }
 
-void capture_video_add_frame(const RenderedImage& image, const float frames_per_second)
+static void write_audio_chunk()
 {
-	const auto& src = image.params;
-	assert(src.width <= SCALER_MAXWIDTH);
-
-	// To reconstruct the raw image, we must skip every second row when
-	// dealing with "baked-in" double scanning.
-	const auto raw_width = check_cast<uint16_t>(
-	        src.width / (src.rendered_pixel_doubling ? 2 : 1));
+	if (!video.audio.buf_frames_used) {
+		return;
+	}
+	add_avi_chunk("01wb",
+	              video.audio.buf_frames_used * SampleFrameSize,
+	              video.audio.buf,
+	              0);
 
-	// To reconstruct the raw image, we must skip every second pixel
-	// when dealing with "baked-in" pixel doubling.
-	const auto raw_height = check_cast<uint16_t>(
-	        src.height / (src.rendered_double_scan ? 2 : 1));
+	video.audio.bytes_written += video.audio.buf_frames_used * SampleFrameSize;
+	video.audio.buf_frames_used = 0;
+}
 
-	// Disable capturing if any of the test fails
-	if (video.handle && (video.width != raw_width || video.height != raw_height ||
-	                     video.pixel_format != src.pixel_format ||
-	                     video.frames_per_second != frames_per_second)) {
-		capture_video_finalise();
+// Runs on the encoder thread
+static void encode_frame(const VideoCaptureTask& task)
+{
+	// Start a new file if the format changed
+	if (video.handle && (video.width != task.width || video.height != task.height ||
+	                     video.pixel_format != task.pixel_format ||
+	                     video.frames_per_second != task.frames_per_second)) {
+		close_avi_file();
 	}
 
-	const auto zmbv_format = to_zmbv_format(src.pixel_format);
+	const auto zmbv_format = to_zmbv_format(task.pixel_format);
 
 	if (!video.handle) {
-		create_avi_file(raw_width,
-		                raw_height,
-		                src.pixel_format,
-		                frames_per_second,
+		create_avi_file(task.width,
+		                task.height,
+		                task.pixel_format,
+		                task.frames_per_second,
 		                zmbv_format);
 	}
 	if (!video.handle) {
 		return;
 	}
 
-	const auto codec_flags = (video.frames % 300 == 0) ? 1 : 0;
+	// Audio that doesn't fit is dropped, as before it was queued
+	const auto frames_left = NumSampleFramesInBuffer - video.audio.buf_frames_used;
+	const auto num_frames  = std::min(check_cast<uint32_t>(task.audio.size() /
+	                                                       NumAudioChannels),
+	                                  frames_left);
+	std::memcpy(&video.audio.buf[video.audio.buf_frames_used],
+	            task.audio.data(),
+	            num_frames * SampleFrameSize);
+	video.audio.buf_frames_used += num_frames;
+	if (task.audio_sample_rate) {
+		video.audio.sample_rate = task.audio_sample_rate;
+	}
+
+	if (task.pixels.empty()) {
+		// A dropped frame; an empty chunk repeats the previous frame
+		add_avi_chunk("00dc", 0, nullptr, 0x0);
+		video.frames++;
+		video.force_keyframe = true;
+
+		write_audio_chunk();
+		return;
+	}
+
+	const auto is_keyframe = (video.frames % 300 == 0) || video.force_keyframe;
+	const auto codec_flags = is_keyframe ? 1 : 0;
 
 	if (!video.codec->PrepareCompressFrame(codec_flags,
 	                                       zmbv_format,
-	                                       image.palette_data,
+	                                       task.palette.data(),
 	                                       video.buf.data(),
 	                                       video.buf_size)) {
 		return;
 	}
 
-	compress_raw_frame(image);
+	const auto row_bytes = task.pixels.size() / task.height;
+
+	auto row = task.pixels.data();
+	for (auto i = 0; i < task.height; ++i, row += row_bytes) {
+		const uint8_t* row_buffer = row;
+		video.codec->CompressLines(1, &row_buffer);
+	}
 
 	const auto written = video.codec->FinishCompressFrame();
 	if (written < 0) {
@@ -476,17 +570,147 @@ void capture_video_add_frame(const RenderedImage& image, const float frames_per_
 
 	add_avi_chunk("00dc", written, video.buf.data(), codec_flags & 1 ? 0x10 : 0x0);
 	video.frames++;
+	video.force_keyframe = false;
+
+	write_audio_chunk();
+}
+
+static void return_buffer(std::vector<uint8_t>&& buffer)
+{
+	std::lock_guard lock(encoder.pool_mutex);
+	encoder.free_pool.push_back(std::move(buffer));
+}
 
-	//		LOG_MSG("CAPTURE: Frame %d video %d audio
-	//%d",video.frames, written, video.audio_buf_frames_used *4 );
-	if (video.audio.buf_frames_used) {
-		add_avi_chunk("01wb",
-		              video.audio.buf_frames_used * SampleFrameSize,
-		              video.audio.buf,
-		              0);
-
-		video.audio.bytes_written = video.audio.buf_frames_used *
-		                            SampleFrameSize;
-		video.audio.buf_frames_used = 0;
+static std::optional<std::vector<uint8_t>> take_buffer()
+{
+	std::lock_guard lock(encoder.pool_mutex);
+	if (!encoder.free_pool.empty()) {
+		auto buffer = std::move(encoder.free_pool.back());
+		encoder.free_pool.pop_back();
+		return buffer;
+	}
+	if (encoder.num_buffers < MaxQueuedFrames) {
+		++encoder.num_buffers;
+		return std::vector<uint8_t>();
+	}
+	return {};
+}
+
+static void close_pipe()
+{
+	if (auto buffer = video_pipe_close(); !buffer.empty()) {
+		return_buffer(std::move(buffer));
+	}
+}
+
+// Runs on the encoder thread
+static void pipe_frame(VideoCaptureTask& task)
+{
+	// Start a new encoder if the format changed
+	if (video_pipe_is_open() && !video_pipe_accepts(task)) {
+		close_pipe();
+	}
+	if (!video_pipe_is_open() && !video_pipe_open(encoder.pipe_command, task)) {
+		return;
+	}
+	video_pipe_add_audio(task.audio);
+	video_pipe_add_frame(task);
+}
+
+static void encode_queued_frames()
+{
+	while (auto task = encoder.queue.Dequeue()) {
+		if (encoder.pipe_command.empty()) {
+			encode_frame(*task);
+		} else {
+			pipe_frame(*task);
+		}
+		if (!task->pixels.empty()) {
+			return_buffer(std::move(task->pixels));
+		}
+	}
+}
+
+static void start_encoder()
+{
+	encoder.audio.clear();
+	encoder.audio_sample_rate = 0;
+	encoder.pipe_command      = pipe_command;
+
+	encoder.queue.Start();
+	encoder.thread = std::thread(encode_queued_frames);
+	set_thread_name(encoder.thread, "dosbox:vidcap");
+}
+
+void capture_video_set_compression_level(const int level)
+{
+	compression_level = std::clamp(level,
+	                               ZMBV_MinCompressionLevel,
+	                               ZMBV_MaxCompressionLevel);
+}
+
+void capture_video_set_pipe_command(const std::string& command)
+{
+	pipe_command = command;
+}
+
+void capture_video_finalise()
+{
+	if (encoder.thread.joinable()) {
+		// Let the encoder write out the queued frames
+		encoder.queue.Stop();
+		encoder.thread.join();
+	}
+	close_avi_file();
+	close_pipe();
+
+	std::lock_guard lock(encoder.pool_mutex);
+	encoder.free_pool.clear();
+	encoder.num_buffers = 0;
+}
+
+void capture_video_add_frame(const RenderedImage& image, const float frames_per_second)
+{
+	const auto& src = image.params;
+	assert(src.width <= SCALER_MAXWIDTH);
+
+	// To reconstruct the raw image, we must skip every second row when
+	// dealing with "baked-in" double scanning.
+	const auto raw_width = check_cast<uint16_t>(
+	        src.width / (src.rendered_pixel_doubling ? 2 : 1));
+
+	// To reconstruct the raw image, we must skip every second pixel
+	// when dealing with "baked-in" pixel doubling.
+	const auto raw_height = check_cast<uint16_t>(
+	        src.height / (src.rendered_double_scan ? 2 : 1));
+
+	if (!encoder.thread.joinable()) {
+		start_encoder();
 	}
+
+	VideoCaptureTask task = {};
+
+	task.width             = raw_width;
+	task.height            = raw_height;
+	task.pixel_format      = src.pixel_format;
+	task.frames_per_second = frames_per_second;
+
+	if (auto buffer = take_buffer(); buffer) {
+		task.pixels = std::move(*buffer);
+		copy_raw_frame(image, raw_width, raw_height, task.pixels);
+
+		if (image.palette_data) {
+			std::memcpy(task.palette.data(),
+			            image.palette_data,
+			            task.palette.size());
+		}
+	} else {
+		video_capture_dropped_frames.Add();
+	}
+
+	task.audio             = std::move(encoder.audio);
+	task.audio_sample_rate = encoder.audio_sample_rate;
+	encoder.audio          = {};
+
+	encoder.queue.Enqueue(std::move(task));
 }
@@ -0,0 +1,485 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "private/capture_video_pipe.h"
+
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+#if !defined(WIN32)
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "audio/mixer.h"
+#include "capture.h"
+#include "misc/logging.h"
+#include "misc/std_filesystem.h"
+#include "utils/bgrx8888.h"
+#include "utils/checks.h"
+#include "utils/rgb555.h"
+#include "utils/rgb565.h"
+#include "utils/string_utils.h"
+
+CHECK_NARROWING();
+
+#if defined(WIN32)
+#define popen  _popen
+#define pclose _pclose
+static constexpr auto PipeMode = "wb";
+#else
+static constexpr auto PipeMode = "w";
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr auto BytesPerPixel = 4;
+
+// Gives up on an encoder that stops reading for this long, so stopping
+// the capture can't hang
+static constexpr auto StallTimeout = std::chrono::seconds(10);
+
+// About 20 seconds at 48 kHz, held while the encoder is yet to open the
+// audio FIFO
+static constexpr size_t MaxPendingAudioBytes = 4 * 1024 * 1024;
+
+// Avoiding deadlocks
+// ~~~~~~~~~~~~~~~~~~
+// The encoder reads its two inputs in whatever order it likes. FFmpeg, for
+// one, opens and probes its inputs one after the other, so it may not open
+// the audio FIFO before it has read the first frames, and may then wait
+// for audio before reading more frames. Both pipes are written without
+// blocking: the audio is queued, the FIFO is opened once the encoder opens
+// its end, and the frames and the queued audio are written as fast as the
+// encoder takes each.
+
+static struct {
+	FILE* process = nullptr;
+	int video_fd  = -1;
+	int audio_fd  = -1;
+
+	// Until the encoder opens its end of the FIFO
+	std_fs::path fifo_path = {};
+
+	std::vector<uint8_t> pending_audio = {};
+
+	uint16_t width           = 0;
+	uint16_t height          = 0;
+	PixelFormat pixel_format = {};
+	float frames_per_second  = 0.0f;
+
+	// Set when the encoder went away, so it's not started again for
+	// every frame until the capture is stopped
+	bool has_failed = false;
+
+	// The previous frame, to repeat it when a frame was dropped. Frames
+	// already in the pipe's pixel format are written as they were queued,
+	// so the buffer is swapped out of the task instead.
+	std::vector<uint8_t> last_frame = {};
+
+	// Paletted and high colour frames are converted into this one
+	std::vector<uint8_t> converted = {};
+} encoder_pipe = {};
+
+static bool is_written_as_queued(const PixelFormat format)
+{
+	// The raw frame copy pads 24-bit pixels to 32 bits, like ZMBV does
+	return format == PixelFormat::BGR24_ByteArray ||
+	       format == PixelFormat::BGRX32_ByteArray;
+}
+
+static std::string quote(const std::string& str)
+{
+#if defined(WIN32)
+	return "\"" + str + "\"";
+#else
+	return "'" + replace_all(str, "'", "'\\''") + "'";
+#endif
+}
+
+#if !defined(WIN32)
+
+static std_fs::path make_fifo_path()
+{
+	static int num_fifos = 0;
+
+	std::error_code ec = {};
+	return std_fs::temp_directory_path(ec) /
+	       format_str("dosbox-audio-%d-%d.pcm", getpid(), num_fifos++);
+}
+
+static void set_non_blocking(const int fd)
+{
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+// Opening the FIFO for writing only succeeds once the encoder has opened
+// it for reading
+static void maybe_open_fifo()
+{
+	if (encoder_pipe.audio_fd >= 0 || encoder_pipe.fifo_path.empty()) {
+		return;
+	}
+	encoder_pipe.audio_fd = open(encoder_pipe.fifo_path.c_str(),
+	                             O_WRONLY | O_NONBLOCK);
+	if (encoder_pipe.audio_fd >= 0) {
+		unlink(encoder_pipe.fifo_path.c_str());
+		encoder_pipe.fifo_path.clear();
+	}
+}
+
+// A write to an encoder that exited should fail rather than raise SIGPIPE.
+// The signal goes to the thread that wrote, so only this one blocks it.
+static void block_sigpipe()
+{
+	sigset_t set = {};
+	sigemptyset(&set);
+	sigaddset(&set, SIGPIPE);
+	pthread_sigmask(SIG_BLOCK, &set, nullptr);
+}
+
+// Returns the number of bytes written, or none if the encoder went away
+static std::optional<size_t> write_some(const int fd, const uint8_t* data,
+                                        const size_t num_bytes)
+{
+	const auto written = write(fd, data, num_bytes);
+	if (written >= 0) {
+		return static_cast<size_t>(written);
+	}
+	if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+		return 0;
+	}
+	return {};
+}
+
+static std::optional<size_t> write_pending_audio()
+{
+	auto& audio        = encoder_pipe.pending_audio;
+	const auto written = write_some(encoder_pipe.audio_fd,
+	                                audio.data(),
+	                                audio.size());
+	if (written) {
+		audio.erase(audio.begin(),
+		            audio.begin() + static_cast<ptrdiff_t>(*written));
+	}
+	return written;
+}
+
+// Writes the data to the video pipe, and the queued audio as the encoder
+// takes it. When draining, also waits for the audio to be written.
+static bool write_video(const uint8_t* data, size_t num_bytes, const bool drain)
+{
+	auto last_progress = Clock::now();
+
+	auto has_audio_to_write = [&] {
+		return !encoder_pipe.pending_audio.empty() &&
+		       (encoder_pipe.audio_fd >= 0 || !encoder_pipe.fifo_path.empty());
+	};
+
+	while (num_bytes > 0 || (drain && has_audio_to_write())) {
+		maybe_open_fifo();
+
+		std::array<pollfd, 2> fds = {};
+		nfds_t num_fds            = 0;
+
+		if (num_bytes > 0) {
+			fds[num_fds++] = {encoder_pipe.video_fd, POLLOUT, 0};
+		}
+		const auto audio_index = num_fds;
+		if (encoder_pipe.audio_fd >= 0 && !encoder_pipe.pending_audio.empty()) {
+			fds[num_fds++] = {encoder_pipe.audio_fd, POLLOUT, 0};
+		}
+
+		// Wakes up now and then to try opening the FIFO again
+		constexpr auto PollTimeoutMs = 10;
+		if (poll(fds.data(), num_fds, PollTimeoutMs) < 0 && errno != EINTR) {
+			return false;
+		}
+
+		auto made_progress = false;
+
+		for (nfds_t i = 0; i < num_fds; ++i) {
+			if (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+				return false;
+			}
+			if (!(fds[i].revents & POLLOUT)) {
+				continue;
+			}
+			if (i == audio_index) {
+				const auto written = write_pending_audio();
+				if (!written) {
+					return false;
+				}
+				made_progress |= (*written > 0);
+			} else {
+				const auto written = write_some(encoder_pipe.video_fd,
+				                                data,
+				                                num_bytes);
+				if (!written) {
+					return false;
+				}
+				data += *written;
+				num_bytes -= *written;
+				made_progress |= (*written > 0);
+			}
+		}
+
+		if (made_progress) {
+			last_progress = Clock::now();
+		} else if (Clock::now() - last_progress > StallTimeout) {
+			return false;
+		}
+	}
+
+	// Whatever audio the encoder takes right away, the rest waits for
+	// the next frame
+	if (encoder_pipe.audio_fd >= 0 && !encoder_pipe.pending_audio.empty()) {
+		return write_pending_audio().has_value();
+	}
+	return true;
+}
+
+#else
+
+static bool write_video(const uint8_t* data, const size_t num_bytes,
+                        const bool /*drain*/)
+{
+	return fwrite(data, 1, num_bytes, encoder_pipe.process) == num_bytes;
+}
+
+#endif
+
+static void shut_down()
+{
+#if !defined(WIN32)
+	if (encoder_pipe.audio_fd >= 0) {
+		close(encoder_pipe.audio_fd);
+		encoder_pipe.audio_fd = -1;
+	}
+	if (!encoder_pipe.fifo_path.empty()) {
+		unlink(encoder_pipe.fifo_path.c_str());
+		encoder_pipe.fifo_path.clear();
+	}
+#endif
+	// The encoder sees the end of both streams before it's waited for
+	if (encoder_pipe.process) {
+		const auto status = pclose(encoder_pipe.process);
+		if (status != 0) {
+			LOG_WARNING("CAPTURE: The video encoder exited with status %d",
+			            status);
+		}
+	}
+	encoder_pipe.process  = nullptr;
+	encoder_pipe.video_fd = -1;
+
+	encoder_pipe.pending_audio = {};
+	encoder_pipe.converted     = {};
+}
+
+static void fail(const char* what)
+{
+	LOG_WARNING("CAPTURE: Stopped piping video output, %s", what);
+	shut_down();
+	encoder_pipe.has_failed = true;
+}
+
+bool video_pipe_open(const std::string& command_template,
+                     const VideoCaptureTask& first_task)
+{
+	assert(!encoder_pipe.process);
+	if (encoder_pipe.has_failed) {
+		return false;
+	}
+
+	const auto sample_rate = first_task.audio_sample_rate
+	                               ? first_task.audio_sample_rate
+	                               : check_cast<uint32_t>(MIXER_GetSampleRate());
+
+	const auto index = get_next_capture_index(CaptureType::Video);
+
+	auto output = generate_capture_filename(CaptureType::Video, index);
+	output.replace_extension();
+
+	auto command = command_template;
+	command = replace_all(command, "{width}", std::to_string(first_task.width));
+	command = replace_all(command, "{height}", std::to_string(first_task.height));
+	command = replace_all(command,
+	                      "{fps}",
+	                      format_str("%.6f", first_task.frames_per_second));
+	command = replace_all(command, "{sample_rate}", std::to_string(sample_rate));
+	command = replace_all(command, "{output}", quote(output.string()));
+
+	const auto wants_audio = (command.find("{audio}") != std::string::npos);
+
+#if defined(WIN32)
+	if (wants_audio) {
+		LOG_WARNING("CAPTURE: The {audio} FIFO of 'pipe_command' is not "
+		            "available on Windows");
+		encoder_pipe.has_failed = true;
+		return false;
+	}
+#else
+	block_sigpipe();
+
+	if (wants_audio) {
+		const auto fifo_path = make_fifo_path();
+		if (mkfifo(fifo_path.c_str(), 0600) != 0) {
+			LOG_WARNING("CAPTURE: Failed to create the audio FIFO '%s': %s",
+			            fifo_path.string().c_str(),
+			            strerror(errno));
+			encoder_pipe.has_failed = true;
+			return false;
+		}
+		encoder_pipe.fifo_path = fifo_path;
+		command = replace_all(command, "{audio}", quote(fifo_path.string()));
+	}
+#endif
+
+	encoder_pipe.process = popen(command.c_str(), PipeMode);
+	if (!encoder_pipe.process) {
+		LOG_WARNING("CAPTURE: Failed to run '%s': %s",
+		            command.c_str(),
+		            strerror(errno));
+		fail("the encoder couldn't be started");
+		return false;
+	}
+	LOG_MSG("CAPTURE: Piping video output to '%s'", command.c_str());
+
+#if !defined(WIN32)
+	// Written to directly, without the stdio buffering
+	encoder_pipe.video_fd = fileno(encoder_pipe.process);
+	set_non_blocking(encoder_pipe.video_fd);
+#endif
+
+	encoder_pipe.width             = first_task.width;
+	encoder_pipe.height            = first_task.height;
+	encoder_pipe.pixel_format      = first_task.pixel_format;
+	encoder_pipe.frames_per_second = first_task.frames_per_second;
+	return true;
+}
+
+bool video_pipe_is_open()
+{
+	return encoder_pipe.process;
+}
+
+bool video_pipe_accepts(const VideoCaptureTask& task)
+{
+	return task.width == encoder_pipe.width && task.height == encoder_pipe.height &&
+	       task.pixel_format == encoder_pipe.pixel_format &&
+	       task.frames_per_second == encoder_pipe.frames_per_second;
+}
+
+static void convert_frame(const VideoCaptureTask& task)
+{
+	const auto num_pixels = static_cast<size_t>(task.width) * task.height;
+	encoder_pipe.converted.resize(num_pixels * BytesPerPixel);
+
+	auto dest = encoder_pipe.converted.data();
+
+	auto write_pixel = [&](const Bgrx8888 pixel) {
+		const uint32_t value = pixel;
+		std::memcpy(dest, &value, BytesPerPixel);
+		dest += BytesPerPixel;
+	};
+
+	switch (task.pixel_format) {
+	case PixelFormat::Indexed8: {
+		// The palette holds RGBX entries; look each one up only once
+		std::array<Bgrx8888, 256> colours = {};
+		for (size_t i = 0; i < colours.size(); ++i) {
+			const auto entry = &task.palette[i * 4];
+			colours[i]       = Bgrx8888(entry[2], entry[1], entry[0]);
+		}
+		for (size_t i = 0; i < num_pixels; ++i) {
+			write_pixel(colours[task.pixels[i]]);
+		}
+	} break;
+
+	case PixelFormat::RGB555_Packed16:
+	case PixelFormat::RGB565_Packed16: {
+		const auto is_555 = (task.pixel_format == PixelFormat::RGB555_Packed16);
+		for (size_t i = 0; i < num_pixels; ++i) {
+			uint16_t value = 0;
+			std::memcpy(&value, &task.pixels[i * 2], sizeof(value));
+
+			const auto rgb = is_555 ? Rgb555(value).ToRgb888()
+			                        : Rgb565(value).ToRgb888();
+			write_pixel(Bgrx8888(rgb.blue, rgb.green, rgb.red));
+		}
+	} break;
+
+	default: assertm(false, "Unexpected pixel format"); break;
+	}
+}
+
+void video_pipe_add_frame(VideoCaptureTask& task)
+{
+	if (!encoder_pipe.process) {
+		return;
+	}
+
+	const auto is_repeat = task.pixels.empty();
+
+	auto frame = &encoder_pipe.converted;
+	if (is_written_as_queued(encoder_pipe.pixel_format)) {
+		if (!is_repeat) {
+			std::swap(encoder_pipe.last_frame, task.pixels);
+		}
+		frame = &encoder_pipe.last_frame;
+	} else if (!is_repeat) {
+		convert_frame(task);
+	}
+
+	// Nothing to repeat before the first frame
+	if (frame->empty()) {
+		return;
+	}
+	if (!write_video(frame->data(), frame->size(), false)) {
+		fail("the encoder stopped reading");
+	}
+}
+
+void video_pipe_add_audio(const std::vector<int16_t>& samples)
+{
+#if !defined(WIN32)
+	const auto has_fifo = (encoder_pipe.audio_fd >= 0 ||
+	                       !encoder_pipe.fifo_path.empty());
+	if (!encoder_pipe.process || !has_fifo) {
+		return;
+	}
+	if (encoder_pipe.pending_audio.size() > MaxPendingAudioBytes) {
+		fail("the encoder isn't reading the audio");
+		return;
+	}
+	const auto data = reinterpret_cast<const uint8_t*>(samples.data());
+	encoder_pipe.pending_audio.insert(encoder_pipe.pending_audio.end(),
+	                          data,
+	                          data + samples.size() * sizeof(int16_t));
+#else
+	(void)samples;
+#endif
+}
+
+std::vector<uint8_t> video_pipe_close()
+{
+	if (encoder_pipe.process && !write_video(nullptr, 0, true)) {
+		LOG_WARNING("CAPTURE: The video encoder stopped reading before "
+		            "the end of the audio");
+	}
+	shut_down();
+	encoder_pipe.has_failed = false;
+
+	return std::exchange(encoder_pipe.last_frame, {});
+}
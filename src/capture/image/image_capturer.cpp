@@ -3,8 +3,10 @@
 
 #include "image_capturer.h"
 
+#include <algorithm>
 #include <cassert>
 #include <string>
+#include <thread>
 
 #include "config/setup.h"
 #include "misc/std_filesystem.h"
@@ -13,12 +15,23 @@
 
 CHECK_NARROWING();
 
-ImageCapturer::ImageCapturer(const std::string& grouped_mode_prefs)
+ImageCapturer::ImageCapturer(const std::string& grouped_mode_prefs,
+                             const ImageWriterSettings& writer_settings)
 {
 	ConfigureGroupedMode(grouped_mode_prefs);
 
-	for (auto& image_saver : image_savers) {
-		image_saver.Open();
+	// Each image is encoded on a single thread, so bursts of captures
+	// (e.g. grouped captures) are spread over the cores instead
+	const auto num_cores = static_cast<int>(std::thread::hardware_concurrency());
+
+	const auto num_image_savers = std::clamp(num_cores,
+	                                         MinImageSavers,
+	                                         MaxImageSavers);
+
+	for (auto i = 0; i < num_image_savers; ++i) {
+		auto image_saver = std::make_unique<ImageSaver>();
+		image_saver->Open(writer_settings);
+		image_savers.emplace_back(std::move(image_saver));
 	}
 
 	LOG_MSG("CAPTURE: Image capturer started");
@@ -84,7 +97,7 @@ void ImageCapturer::ConfigureGroupedMode(const std::string& prefs)
 ImageCapturer::~ImageCapturer()
 {
 	for (auto& image_saver : image_savers) {
-		image_saver.Close();
+		image_saver->Close();
 	}
 
 	LOG_MSG("CAPTURE: Image capturer shutting down");
@@ -104,7 +117,7 @@ bool ImageCapturer::IsRenderedCaptureRequested() const
 	       (state.grouped != CaptureState::Off && grouped_mode.wants_rendered);
 }
 
-void ImageCapturer::MaybeCaptureImage(const RenderedImage& image)
+void ImageCapturer::MaybeCaptureImage(const SharedRenderedImage& image)
 {
 	// No new image capture requests until we finish queuing the current
 	// grouped capture request, otherwise we can get into all sorts of race
@@ -159,13 +172,13 @@ void ImageCapturer::MaybeCaptureImage(const RenderedImage& image)
 	}
 	if (do_raw) {
 		GetNextImageSaver().QueueImage(
-		        image.deep_copy(),
+		        image,
 		        CapturedImageType::Raw,
 		        generate_capture_filename(CaptureType::RawImage, index));
 	}
 	if (do_upscaled) {
 		GetNextImageSaver().QueueImage(
-		        image.deep_copy(),
+		        image,
 		        CapturedImageType::Upscaled,
 		        generate_capture_filename(CaptureType::UpscaledImage, index));
 	}
@@ -178,7 +191,10 @@ void ImageCapturer::MaybeCaptureImage(const RenderedImage& image)
 
 void ImageCapturer::CapturePostRenderImage(const RenderedImage& image)
 {
-	GetNextImageSaver().QueueImage(image, CapturedImageType::Rendered, rendered_path);
+	// Read back from the frame buffer just for us, so it's ours to free
+	GetNextImageSaver().QueueImage(RENDER_AdoptImage(image),
+	                               CapturedImageType::Rendered,
+	                               rendered_path);
 
 	state.rendered = CaptureState::Off;
 
@@ -189,9 +205,15 @@ void ImageCapturer::CapturePostRenderImage(const RenderedImage& image)
 
 ImageSaver& ImageCapturer::GetNextImageSaver()
 {
-	++current_image_saver_index;
-	current_image_saver_index %= NumImageSavers;
-	return image_savers[current_image_saver_index];
+	// Queuing blocks while the saver's queue is full, so pick the one with
+	// the least work waiting rather than taking turns
+	const auto least_busy = std::min_element(
+	        image_savers.begin(), image_savers.end(), [](auto& a, auto& b) {
+		        return a->NumQueuedImages() < b->NumQueuedImages();
+	        });
+
+	assert(least_busy != image_savers.end());
+	return **least_busy;
 }
 
 void ImageCapturer::RequestRawCapture()
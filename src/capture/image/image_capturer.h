@@ -4,12 +4,14 @@
 #ifndef DOSBOX_IMAGE_CAPTURER_H
 #define DOSBOX_IMAGE_CAPTURER_H
 
-#include <array>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "capture/capture.h"
 #include "gui/render.h"
 #include "image_saver.h"
+#include "image_writer.h"
 #include "misc/std_filesystem.h"
 
 // Image capturing works in a rather roundabout fashion... If capturing the
@@ -40,7 +42,8 @@
 class ImageCapturer {
 public:
 	ImageCapturer() = default;
-	ImageCapturer(const std::string& grouped_mode_prefs);
+	ImageCapturer(const std::string& grouped_mode_prefs,
+	              const ImageWriterSettings& writer_settings);
 
 	~ImageCapturer();
 
@@ -52,7 +55,7 @@ public:
 	bool IsCaptureRequested() const;
 	bool IsRenderedCaptureRequested() const;
 
-	void MaybeCaptureImage(const RenderedImage& image);
+	void MaybeCaptureImage(const SharedRenderedImage& image);
 	void CapturePostRenderImage(const RenderedImage& image);
 
 	// prevent copying
@@ -78,9 +81,11 @@ private:
 
 	std_fs::path rendered_path    = {};
 
-	static constexpr auto NumImageSavers                = 3;
-	size_t current_image_saver_index                    = 0;
-	std::array<ImageSaver, NumImageSavers> image_savers = {};
+	// One saver per core for the encoding, within these limits
+	static constexpr auto MinImageSavers = 3;
+	static constexpr auto MaxImageSavers = 8;
+
+	std::vector<std::unique_ptr<ImageSaver>> image_savers = {};
 
 	void ConfigureGroupedMode(const std::string& prefs);
 
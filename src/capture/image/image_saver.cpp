@@ -11,6 +11,7 @@
 #include "capture/capture.h"
 #include "misc/support.h"
 #include "png_writer.h"
+#include "qoi_writer.h"
 #include "utils/checks.h"
 
 CHECK_NARROWING();
@@ -20,11 +21,12 @@ ImageSaver::~ImageSaver()
 	Close();
 }
 
-void ImageSaver::Open()
+void ImageSaver::Open(const ImageWriterSettings& writer_settings)
 {
 	if (is_open) {
 		Close();
 	}
+	settings = writer_settings;
 
 	const auto worker_function = std::bind(&ImageSaver::SaveQueuedImages, this);
 	renderer = std::thread(worker_function);
@@ -50,7 +52,13 @@ void ImageSaver::Close()
 	is_open = false;
 }
 
-void ImageSaver::QueueImage(const RenderedImage& image, const CapturedImageType type,
+size_t ImageSaver::NumQueuedImages()
+{
+	return image_fifo.Size();
+}
+
+void ImageSaver::QueueImage(const SharedRenderedImage& image,
+                            const CapturedImageType type,
                             const std::optional<std_fs::path>& path)
 {
 	if (!image_fifo.IsRunning()) {
@@ -67,7 +75,6 @@ void ImageSaver::SaveQueuedImages()
 {
 	while (auto task = image_fifo.Dequeue()) {
 		SaveImage(*task);
-		task->image.free();
 	}
 }
 
@@ -90,36 +97,58 @@ void ImageSaver::SaveImage(const SaveImageTask& task)
 		return;
 	}
 
-	switch (task.image_type) {
-	case CapturedImageType::Raw: SaveRawImage(task.image); break;
-	case CapturedImageType::Upscaled: SaveUpscaledImage(task.image); break;
-	case CapturedImageType::Rendered: SaveRenderedImage(task.image); break;
+	// The writer must finish the file before it's closed
+	{
+		const auto image_writer = CreateImageWriter();
+
+		switch (task.image_type) {
+		case CapturedImageType::Raw:
+			SaveRawImage(*task.image, *image_writer);
+			break;
+		case CapturedImageType::Upscaled:
+			SaveUpscaledImage(*task.image, *image_writer);
+			break;
+		case CapturedImageType::Rendered:
+			SaveRenderedImage(*task.image, *image_writer);
+			break;
+		}
 	}
 
 	CloseOutFile();
 }
 
-static void write_upscaled_png(FILE* outfile, PngWriter& png_writer,
-                               ImageScaler& image_scaler, const uint16_t width,
-                               const uint16_t height,
-                               const Fraction& pixel_aspect_ratio,
-                               const VideoMode& video_mode,
-                               const uint8_t* palette_data)
+std::unique_ptr<ImageWriter> ImageSaver::CreateImageWriter() const
+{
+	switch (settings.file_format) {
+	case ImageFileFormat::Qoi: return std::make_unique<QoiWriter>();
+	case ImageFileFormat::Png:
+	default:
+		return std::make_unique<PngWriter>(settings.png_compression_level,
+		                                   settings.png_compression_strategy);
+	}
+}
+
+static void write_upscaled_image(FILE* outfile, ImageWriter& image_writer,
+                                 ImageScaler& image_scaler, const uint16_t width,
+                                 const uint16_t height,
+                                 const Fraction& pixel_aspect_ratio,
+                                 const VideoMode& video_mode,
+                                 const uint8_t* palette_data)
 {
 	switch (image_scaler.GetOutputPixelFormat()) {
 	case OutputPixelFormat::Indexed8:
-		if (!png_writer.InitIndexed8(outfile,
-		                             width,
-		                             height,
-		                             pixel_aspect_ratio,
-		                             video_mode,
-		                             palette_data)) {
+		if (!image_writer.InitIndexed8(outfile,
+		                               width,
+		                               height,
+		                               pixel_aspect_ratio,
+		                               video_mode,
+		                               palette_data)) {
 			return;
 		}
 		break;
 
 	case OutputPixelFormat::Rgb888:
-		if (!png_writer.InitRgb888(
+		if (!image_writer.InitRgb888(
 		            outfile, width, height, pixel_aspect_ratio, video_mode)) {
 			return;
 		}
@@ -129,14 +158,13 @@ static void write_upscaled_png(FILE* outfile, PngWriter& png_writer,
 	auto rows_to_write = image_scaler.GetOutputHeight();
 	while (rows_to_write--) {
 		auto row = image_scaler.GetNextOutputRow();
-		png_writer.WriteRow(row);
+		image_writer.WriteRow(row);
 	}
 }
 
-void ImageSaver::SaveRawImage(const RenderedImage& image)
+void ImageSaver::SaveRawImage(const RenderedImage& image,
+                              ImageWriter& image_writer)
 {
-	PngWriter png_writer = {};
-
 	const auto& src = image.params;
 
 	// To reconstruct the raw image, we must skip every second row when
@@ -160,20 +188,20 @@ void ImageSaver::SaveRawImage(const RenderedImage& image)
 	const auto pixel_aspect_ratio = src.video_mode.pixel_aspect_ratio;
 
 	if (image.is_paletted()) {
-		if (!png_writer.InitIndexed8(outfile,
-		                             output_width,
-		                             output_height,
-		                             pixel_aspect_ratio,
-		                             src.video_mode,
-		                             image.palette_data)) {
+		if (!image_writer.InitIndexed8(outfile,
+		                               output_width,
+		                               output_height,
+		                               pixel_aspect_ratio,
+		                               src.video_mode,
+		                               image.palette_data)) {
 			return;
 		}
 	} else {
-		if (!png_writer.InitRgb888(outfile,
-		                           output_width,
-		                           output_height,
-		                           pixel_aspect_ratio,
-		                           src.video_mode)) {
+		if (!image_writer.InitRgb888(outfile,
+		                             output_width,
+		                             output_height,
+		                             pixel_aspect_ratio,
+		                             src.video_mode)) {
 			return;
 		}
 	}
@@ -202,46 +230,44 @@ void ImageSaver::SaveRawImage(const RenderedImage& image)
 				*out++ = pixel.blue;
 			}
 		}
-		png_writer.WriteRow(row_buf.begin());
+		image_writer.WriteRow(row_buf.begin());
 		image_decoder.AdvanceRow();
 	}
 }
 
 static constexpr auto square_pixel_aspect_ratio = Fraction{1};
 
-void ImageSaver::SaveUpscaledImage(const RenderedImage& image)
+void ImageSaver::SaveUpscaledImage(const RenderedImage& image,
+                                   ImageWriter& image_writer)
 {
-	PngWriter png_writer = {};
-
 	image_scaler.Init(image);
 
 	// Always write 1:1 pixel aspect ratio into the PNG pHYs chunk for
 	// upscaled images as the "non-squaredness" is "baked into" the image
 	// data.
-	write_upscaled_png(outfile,
-	                   png_writer,
-	                   image_scaler,
-	                   image_scaler.GetOutputWidth(),
-	                   image_scaler.GetOutputHeight(),
-	                   square_pixel_aspect_ratio,
-	                   image.params.video_mode,
-	                   image.palette_data);
+	write_upscaled_image(outfile,
+	                     image_writer,
+	                     image_scaler,
+	                     image_scaler.GetOutputWidth(),
+	                     image_scaler.GetOutputHeight(),
+	                     square_pixel_aspect_ratio,
+	                     image.params.video_mode,
+	                     image.palette_data);
 }
 
-void ImageSaver::SaveRenderedImage(const RenderedImage& image)
+void ImageSaver::SaveRenderedImage(const RenderedImage& image,
+                                   ImageWriter& image_writer)
 {
-	PngWriter png_writer = {};
-
 	const auto& src = image.params;
 
 	// Always write 1:1 pixel aspect ratio into the PNG pHYs chunk for
 	// rendered images as the "non-squaredness" is "baked into" the image
 	// data.
-	if (!png_writer.InitRgb888(outfile,
-	                           check_cast<uint16_t>(src.width),
-	                           check_cast<uint16_t>(src.height),
-	                           square_pixel_aspect_ratio,
-	                           src.video_mode)) {
+	if (!image_writer.InitRgb888(outfile,
+	                             check_cast<uint16_t>(src.width),
+	                             check_cast<uint16_t>(src.height),
+	                             square_pixel_aspect_ratio,
+	                             src.video_mode)) {
 		return;
 	}
 
@@ -267,7 +293,7 @@ void ImageSaver::SaveRenderedImage(const RenderedImage& image)
 			*out++ = pixel.green;
 			*out++ = pixel.blue;
 		}
-		png_writer.WriteRow(row_buf.begin());
+		image_writer.WriteRow(row_buf.begin());
 		image_decoder.AdvanceRow();
 	}
 }
@@ -5,6 +5,7 @@
 #define DOSBOX_IMAGE_SAVER_H
 
 #include <atomic>
+#include <memory>
 #include <optional>
 #include <thread>
 #include <vector>
@@ -12,13 +13,14 @@
 #include "gui/render.h"
 #include "image_decoder.h"
 #include "image_scaler.h"
+#include "image_writer.h"
 #include "misc/std_filesystem.h"
 #include "utils/rwqueue.h"
 
 enum class CapturedImageType { Raw, Upscaled, Rendered };
 
 struct SaveImageTask {
-	RenderedImage image              = {};
+	SharedRenderedImage image        = {};
 	CapturedImageType image_type     = {};
 	std::optional<std_fs::path> path = {};
 };
@@ -26,21 +28,12 @@ struct SaveImageTask {
 // Threaded image capturer; capture requests are placed in a FIFO queue then
 // are processed in order.
 //
-// The image capturer _frees_ the passed in RenderedImage after the image was
-// saved. Therefore, you might need to pass in deep-copied RenderedImage
-// instances (with the pixel and palette data deep-copied) to avoid freeing
-// the internal render buffers.
-//
-// We could make the image capturer 100% safe by always making a deep-copy of
-// the passed in RenderedImage before storing it in the work queue. But this
-// would not allow for an important optimisation step: post-render/post-shader
-// images (which can get very large at 4K resolutions; ~24 MB for a fullscreen
-// 4K capture) would always need to be copied as well.
-//
-// For post-render/post-shader images, a copy is actually not needed, and for
-// the rest of the cases the copy is generally cheap because we're only copying
-// the contents of the interal render buffer (64K for 320x200/256, 300K for
-// 640x480/256, and ~1.2MB for 640x480 true-colour).
+// The queued images are shared, not copied: the raw and upscaled captures
+// of a frame, and anyone else holding it, such as the text-mode server,
+// read the same copy of the internal render buffer. Post-render/post-shader
+// images (which can get very large at 4K resolutions; ~24 MB for a
+// fullscreen 4K capture) are read back from the frame buffer for the
+// capture alone, so they're never copied at all.
 //
 // All downstream processing is row-based, meaning the image scaler and the
 // image writer are operating in row-sized chunks. This is crucial to keep the
@@ -58,14 +51,14 @@ public:
 	ImageSaver() = default;
 	~ImageSaver();
 
-	void Open();
+	void Open(const ImageWriterSettings& writer_settings);
 	void Close();
 
-	// IMPORTANT: The capturer _frees_ the passed in RenderedImage after the
-	// image was saved. Consider the implications carefully; you might need
-	// to pass in a deep-copied copy of the RenderedImage instance, because
-	// you cannot know when exactly in the future will it be freed.
-	void QueueImage(const RenderedImage& image,
+	// The number of images waiting to be saved
+	size_t NumQueuedImages();
+
+	// The image is let go of once it's saved
+	void QueueImage(const SharedRenderedImage& image,
 	                const CapturedImageType type,
 	                const std::optional<std_fs::path>& path);
 
@@ -80,9 +73,11 @@ private:
 	void SaveQueuedImages();
 	void SaveImage(const SaveImageTask& task);
 
-	void SaveRawImage(const RenderedImage& image);
-	void SaveUpscaledImage(const RenderedImage& image);
-	void SaveRenderedImage(const RenderedImage& image);
+	std::unique_ptr<ImageWriter> CreateImageWriter() const;
+
+	void SaveRawImage(const RenderedImage& image, ImageWriter& image_writer);
+	void SaveUpscaledImage(const RenderedImage& image, ImageWriter& image_writer);
+	void SaveRenderedImage(const RenderedImage& image, ImageWriter& image_writer);
 
 	void CloseOutFile();
 
@@ -90,6 +85,8 @@ private:
 	std::thread renderer = {};
 	bool is_open         = false;
 
+	ImageWriterSettings settings = {};
+
 	ImageScaler image_scaler = {};
 
 	ImageDecoder image_decoder   = {};
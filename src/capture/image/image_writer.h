@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_IMAGE_WRITER_H
+#define DOSBOX_IMAGE_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "misc/video.h"
+#include "utils/fraction.h"
+
+enum class ImageFileFormat { Png, Qoi };
+
+enum class PngCompressionStrategy { Default, Filtered, Rle, HuffmanOnly };
+
+struct ImageWriterSettings {
+	ImageFileFormat file_format = ImageFileFormat::Png;
+
+	// zlib levels from 0 (stored) to 9 (smallest)
+	int png_compression_level                       = 6;
+	PngCompressionStrategy png_compression_strategy = PngCompressionStrategy::Default;
+};
+
+// A row-based image file writer. RGB888 rows hold three bytes per pixel in
+// R, G, B order; Indexed8 rows one palette index per pixel.
+class ImageWriter {
+public:
+	virtual ~ImageWriter() = default;
+
+	virtual bool InitRgb888(FILE* fp, const uint16_t width,
+	                        const uint16_t height,
+	                        const Fraction& pixel_aspect_ratio,
+	                        const VideoMode& video_mode) = 0;
+
+	// The palette holds 256 RGBX entries
+	virtual bool InitIndexed8(FILE* fp, const uint16_t width,
+	                          const uint16_t height,
+	                          const Fraction& pixel_aspect_ratio,
+	                          const VideoMode& video_mode,
+	                          const uint8_t* palette_data) = 0;
+
+	virtual void WriteRow(std::vector<uint8_t>::const_iterator row) = 0;
+};
+
+#endif // DOSBOX_IMAGE_WRITER_H
@@ -14,9 +14,20 @@
 
 CHECK_NARROWING();
 
+PngWriter::PngWriter(const int _compression_level,
+                     const PngCompressionStrategy _compression_strategy)
+        : compression_level(_compression_level),
+          compression_strategy(_compression_strategy)
+{
+	assert(compression_level >= Z_NO_COMPRESSION &&
+	       compression_level <= Z_BEST_COMPRESSION);
+}
+
 PngWriter::~PngWriter()
 {
-	FinalisePng();
+	if (png_ptr) {
+		FinalisePng();
+	}
 
 	if (png_ptr && png_info_ptr) {
 		png_destroy_write_struct(&png_ptr, &png_info_ptr);
@@ -82,15 +93,27 @@ bool PngWriter::Init(FILE* fp)
 	return true;
 }
 
+static int to_zlib_strategy(const PngCompressionStrategy strategy)
+{
+	switch (strategy) {
+	case PngCompressionStrategy::Default: return Z_DEFAULT_STRATEGY;
+	case PngCompressionStrategy::Filtered: return Z_FILTERED;
+	case PngCompressionStrategy::Rle: return Z_RLE;
+	case PngCompressionStrategy::HuffmanOnly: return Z_HUFFMAN_ONLY;
+	default: assertm(false, "Invalid PngCompressionStrategy"); return {};
+	}
+}
+
 void PngWriter::SetPngCompressionsParams()
 {
 	assert(png_ptr);
 
-	// Default compression (equal to level 6) is the sweet spot between
-	// speed and compression. Z_BEST_COMPRESSION (level 9) rarely results in
-	// smaller file sizes, but makes the compression significantly slower
-	// (by several folds).
-	png_set_compression_level(png_ptr, Z_DEFAULT_COMPRESSION);
+	// The default level 6 is the sweet spot between speed and compression.
+	// Z_BEST_COMPRESSION (level 9) rarely results in smaller file sizes,
+	// but makes the compression significantly slower (by several folds).
+	// The lowest levels, and the RLE or Huffman-only strategies, are
+	// several times faster for a somewhat larger file.
+	png_set_compression_level(png_ptr, compression_level);
 
 	// Larger buffer sizes (e.g. 64K or 128K) could significantly speed up
 	// decompression, but not compression.
@@ -98,9 +121,15 @@ void PngWriter::SetPngCompressionsParams()
 	png_set_compression_buffer_size(png_ptr, default_buffer_size);
 
 	// The "fast" filters are not only the fastest, but also result in the
-	// best compression ratios on average.
+	// best compression ratios on average. Trying every filter on every
+	// row is wasted effort at the fastest levels; the "up" filter alone
+	// handles the large flat areas of DOS screens well.
 	constexpr auto default_filter_method = 0;
-	png_set_filter(png_ptr, default_filter_method, PNG_ALL_FILTERS);
+	constexpr auto FastestLevel          = 1;
+	png_set_filter(png_ptr,
+	               default_filter_method,
+	               compression_level <= FastestLevel ? PNG_FILTER_UP
+	                                                 : PNG_ALL_FILTERS);
 
 	// Do not change the below settings; they are parameters for the zlib
 	// compression library and changing them might result in invalid PNG
@@ -111,7 +140,7 @@ void PngWriter::SetPngCompressionsParams()
 	constexpr auto default_window_bits = 15;
 	png_set_compression_window_bits(png_ptr, default_window_bits);
 
-	png_set_compression_strategy(png_ptr, Z_DEFAULT_STRATEGY);
+	png_set_compression_strategy(png_ptr, to_zlib_strategy(compression_strategy));
 	png_set_compression_method(png_ptr, Z_DEFLATED);
 }
 
@@ -11,25 +11,26 @@
 #include <png.h>
 
 #include "gui/render.h"
-#include "image_saver.h"
-
+#include "image_writer.h"
 
 // A row-based PNG writer that also writes the pixel aspect ratio of the image
 // into the standard pHYs PNG chunk.
-class PngWriter {
+class PngWriter final : public ImageWriter {
 public:
-	PngWriter() = default;
-	~PngWriter();
+	PngWriter(const int compression_level,
+	          const PngCompressionStrategy compression_strategy);
+	~PngWriter() override;
 
 	bool InitRgb888(FILE* fp, const uint16_t width, const uint16_t height,
 	                const Fraction& pixel_aspect_ratio,
-	                const VideoMode& video_mode);
+	                const VideoMode& video_mode) override;
 
 	bool InitIndexed8(FILE* fp, const uint16_t width, const uint16_t height,
 	                  const Fraction& pixel_aspect_ratio,
-	                  const VideoMode& video_mode, const uint8_t* palette_data);
+	                  const VideoMode& video_mode,
+	                  const uint8_t* palette_data) override;
 
-	void WriteRow(std::vector<uint8_t>::const_iterator row);
+	void WriteRow(std::vector<uint8_t>::const_iterator row) override;
 
 	// prevent copying
 	PngWriter(const PngWriter&) = delete;
@@ -47,6 +48,9 @@ private:
 
 	void FinalisePng();
 
+	int compression_level                       = 0;
+	PngCompressionStrategy compression_strategy = {};
+
 	png_structp png_ptr    = nullptr;
 	png_infop png_info_ptr = nullptr;
 };
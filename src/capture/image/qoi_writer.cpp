@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "qoi_writer.h"
+
+#include <cassert>
+
+#include "utils/checks.h"
+
+CHECK_NARROWING();
+
+// The chunk tags
+static constexpr uint8_t OpIndex = 0x00;
+static constexpr uint8_t OpDiff  = 0x40;
+static constexpr uint8_t OpLuma  = 0x80;
+static constexpr uint8_t OpRun   = 0xc0;
+static constexpr uint8_t OpRgb   = 0xfe;
+
+static constexpr uint8_t MaxRunLength = 62;
+
+static constexpr uint8_t NumChannels = 3;
+static constexpr uint8_t SrgbColorSpace = 0;
+
+// Every pixel is opaque
+static constexpr uint8_t Alpha = 255;
+
+QoiWriter::~QoiWriter()
+{
+	if (outfile) {
+		Finalise();
+	}
+}
+
+static void append_u32_be(std::vector<uint8_t>& out, const uint32_t value)
+{
+	out.push_back(static_cast<uint8_t>(value >> 24));
+	out.push_back(static_cast<uint8_t>(value >> 16));
+	out.push_back(static_cast<uint8_t>(value >> 8));
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+bool QoiWriter::InitRgb888(FILE* fp, const uint16_t _width, const uint16_t height,
+                           const Fraction& /*pixel_aspect_ratio*/,
+                           const VideoMode& /*video_mode*/)
+{
+	is_paletted = false;
+	return Init(fp, _width, height);
+}
+
+bool QoiWriter::InitIndexed8(FILE* fp, const uint16_t _width, const uint16_t height,
+                             const Fraction& /*pixel_aspect_ratio*/,
+                             const VideoMode& /*video_mode*/,
+                             const uint8_t* palette_data)
+{
+	assert(palette_data);
+
+	is_paletted = true;
+	for (size_t i = 0; i < palette.size(); ++i) {
+		palette[i] = {palette_data[i * 4 + 0],
+		              palette_data[i * 4 + 1],
+		              palette_data[i * 4 + 2]};
+	}
+	return Init(fp, _width, height);
+}
+
+bool QoiWriter::Init(FILE* fp, const uint16_t _width, const uint16_t height)
+{
+	assert(fp);
+	assert(!outfile);
+
+	outfile     = fp;
+	width       = _width;
+	pixels_left = static_cast<uint32_t>(_width) * height;
+
+	out_buf.clear();
+	out_buf.insert(out_buf.end(), {'q', 'o', 'i', 'f'});
+	append_u32_be(out_buf, _width);
+	append_u32_be(out_buf, height);
+	out_buf.push_back(NumChannels);
+	out_buf.push_back(SrgbColorSpace);
+
+	return fwrite(out_buf.data(), 1, out_buf.size(), outfile) == out_buf.size();
+}
+
+void QoiWriter::FlushRun()
+{
+	if (run_length > 0) {
+		out_buf.push_back(static_cast<uint8_t>(OpRun | (run_length - 1)));
+		run_length = 0;
+	}
+}
+
+void QoiWriter::EncodePixel(const Pixel pixel)
+{
+	--pixels_left;
+
+	if (pixel == previous) {
+		++run_length;
+		if (run_length == MaxRunLength || pixels_left == 0) {
+			FlushRun();
+		}
+		return;
+	}
+	FlushRun();
+
+	const auto hash = (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + Alpha * 11) % 64;
+
+	if (seen_used[hash] && seen[hash] == pixel) {
+		out_buf.push_back(static_cast<uint8_t>(OpIndex | hash));
+		previous = pixel;
+		return;
+	}
+	seen[hash]      = pixel;
+	seen_used[hash] = true;
+
+	// The differences wrap around
+	const auto dr = static_cast<int8_t>(pixel.r - previous.r);
+	const auto dg = static_cast<int8_t>(pixel.g - previous.g);
+	const auto db = static_cast<int8_t>(pixel.b - previous.b);
+
+	const auto dr_dg = dr - dg;
+	const auto db_dg = db - dg;
+
+	if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+		out_buf.push_back(static_cast<uint8_t>(
+		        OpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+
+	} else if (dr_dg >= -8 && dr_dg <= 7 && dg >= -32 && dg <= 31 &&
+	           db_dg >= -8 && db_dg <= 7) {
+		out_buf.push_back(static_cast<uint8_t>(OpLuma | (dg + 32)));
+		out_buf.push_back(static_cast<uint8_t>((dr_dg + 8) << 4 | (db_dg + 8)));
+
+	} else {
+		out_buf.insert(out_buf.end(), {OpRgb, pixel.r, pixel.g, pixel.b});
+	}
+	previous = pixel;
+}
+
+void QoiWriter::WriteRow(std::vector<uint8_t>::const_iterator row)
+{
+	assert(outfile);
+
+	out_buf.clear();
+
+	if (is_paletted) {
+		for (auto x = 0; x < width; ++x) {
+			EncodePixel(palette[*row++]);
+		}
+	} else {
+		for (auto x = 0; x < width; ++x) {
+			const auto r = *row++;
+			const auto g = *row++;
+			const auto b = *row++;
+			EncodePixel({r, g, b});
+		}
+	}
+	fwrite(out_buf.data(), 1, out_buf.size(), outfile);
+}
+
+void QoiWriter::Finalise()
+{
+	assert(outfile);
+
+	constexpr uint8_t EndMarker[] = {0, 0, 0, 0, 0, 0, 0, 1};
+	fwrite(EndMarker, 1, sizeof(EndMarker), outfile);
+
+	outfile = nullptr;
+}
@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_QOI_WRITER_H
+#define DOSBOX_QOI_WRITER_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "image_writer.h"
+
+// A row-based writer of the "Quite OK Image" format, a lossless RGB format
+// that's several times faster to encode than PNG, for files not much
+// larger than PNG's at its default level. Paletted images are written as
+// RGB, and the pixel aspect ratio isn't stored.
+//
+// Specification: https://qoiformat.org/qoi-specification.pdf
+//
+class QoiWriter final : public ImageWriter {
+public:
+	QoiWriter() = default;
+	~QoiWriter() override;
+
+	bool InitRgb888(FILE* fp, const uint16_t width, const uint16_t height,
+	                const Fraction& pixel_aspect_ratio,
+	                const VideoMode& video_mode) override;
+
+	bool InitIndexed8(FILE* fp, const uint16_t width, const uint16_t height,
+	                  const Fraction& pixel_aspect_ratio,
+	                  const VideoMode& video_mode,
+	                  const uint8_t* palette_data) override;
+
+	void WriteRow(std::vector<uint8_t>::const_iterator row) override;
+
+	// prevent copying
+	QoiWriter(const QoiWriter&) = delete;
+	// prevent assignment
+	QoiWriter& operator=(const QoiWriter&) = delete;
+
+private:
+	struct Pixel {
+		uint8_t r = 0;
+		uint8_t g = 0;
+		uint8_t b = 0;
+
+		constexpr bool operator==(const Pixel&) const = default;
+	};
+
+	bool Init(FILE* fp, const uint16_t width, const uint16_t height);
+	void EncodePixel(const Pixel pixel);
+	void FlushRun();
+	void Finalise();
+
+	FILE* outfile = nullptr;
+
+	uint16_t width       = 0;
+	uint32_t pixels_left = 0;
+
+	bool is_paletted               = false;
+	std::array<Pixel, 256> palette = {};
+
+	// The encoder state; the previous pixel starts out opaque black and
+	// none of the recently seen pixels are set
+	Pixel previous                 = {};
+	uint8_t run_length             = 0;
+	std::array<Pixel, 64> seen     = {};
+	std::array<bool, 64> seen_used = {};
+
+	std::vector<uint8_t> out_buf = {};
+};
+
+#endif // DOSBOX_QOI_WRITER_H
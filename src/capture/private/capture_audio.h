@@ -5,6 +5,16 @@
 #ifndef DOSBOX_CAPTURE_AUDIO_H
 #define DOSBOX_CAPTURE_AUDIO_H
 
+#include <cstdint>
+
+enum class AudioCaptureFormat { Wav, Flac };
+
+// Applies to the next audio capture
+void capture_audio_set_format(const AudioCaptureFormat format);
+
+// Of the audio capture in progress, or the next one
+const char* capture_audio_get_file_extension();
+
 void capture_audio_add_data(uint32_t sample_rate_hz, uint32_t num_sample_frames,
                             const int16_t* sample_frames);
 
@@ -5,8 +5,32 @@
 #ifndef DOSBOX_CAPTURE_VIDEO_H
 #define DOSBOX_CAPTURE_VIDEO_H
 
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
 #include "gui/render.h"
 
+// A frame queued for the video encoder thread, along with the audio
+// captured since the previous frame
+struct VideoCaptureTask {
+	uint16_t width           = 0;
+	uint16_t height          = 0;
+	PixelFormat pixel_format = {};
+	float frames_per_second  = 0.0f;
+
+	// Raw rows with the double scanning and pixel doubling taken out, in
+	// the encoder's pixel format. Empty if the frame was dropped because
+	// the encoder fell behind.
+	std::vector<uint8_t> pixels = {};
+
+	std::array<uint8_t, 256 * 4> palette = {};
+
+	std::vector<int16_t> audio = {};
+	uint32_t audio_sample_rate = 0;
+};
+
 void capture_video_add_frame(const RenderedImage& image,
                              const float frames_per_second);
 
@@ -14,6 +38,15 @@ void capture_video_add_audio_data(const uint32_t sample_rate,
                                   const uint32_t num_sample_frames,
                                   const int16_t* sample_frames);
 
+// Takes effect from the next video capture
+void capture_video_set_compression_level(const int level);
+
+// Takes effect from the next video capture. Frames are piped to the
+// command instead of being written to ZMBV AVI files, unless it's empty.
+void capture_video_set_pipe_command(const std::string& command);
+
+// Waits for the encoder thread to write out the queued frames, then
+// finishes the file
 void capture_video_finalise();
 
 #endif
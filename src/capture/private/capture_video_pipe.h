@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_CAPTURE_VIDEO_PIPE_H
+#define DOSBOX_CAPTURE_VIDEO_PIPE_H
+
+#include <string>
+#include <vector>
+
+#include "capture_video.h"
+
+// Streams video captures to an external encoder, such as FFmpeg, instead of
+// writing ZMBV AVI files. The encoder reads the raw frames on its standard
+// input as 32-bit BGRX pixels at a constant frame rate, whatever the
+// emulated video mode, and the audio as 16-bit little-endian stereo PCM
+// from a named FIFO (not available on Windows).
+//
+// The command is run by the shell after these placeholders are replaced:
+//
+//   {width} {height}  the size of the raw frames
+//   {fps}             the frame rate
+//   {sample_rate}     the audio sample rate
+//   {audio}           the path of the audio FIFO, quoted
+//   {output}          the capture path without an extension, quoted
+//
+// Only used on the video encoder thread.
+
+// Starts the encoder for frames like the given one. Gives up until the
+// pipe is closed if the encoder can't be started or goes away.
+bool video_pipe_open(const std::string& command_template,
+                     const VideoCaptureTask& first_task);
+
+bool video_pipe_is_open();
+
+// Whether the task's frame can go to the running encoder, which can't
+// change the size, pixel format or frame rate
+bool video_pipe_accepts(const VideoCaptureTask& task);
+
+// Frames in the pipe's pixel format are written without copying. The
+// task's buffer is held on to for repeating the frame, and the task is
+// given the previous frame's buffer in return. A task without pixels
+// repeats the previous frame.
+void video_pipe_add_frame(VideoCaptureTask& task);
+
+void video_pipe_add_audio(const std::vector<int16_t>& samples);
+
+// Waits for the encoder to exit. Returns the buffer held on to from the
+// last frame, if any.
+std::vector<uint8_t> video_pipe_close();
+
+#endif
@@ -44,9 +44,13 @@ struct CommandLineArguments {
 	bool exit;
 	bool securemode;
 	bool noautoexec;
+	bool headless;
+	bool startup_profile;
 	std::string working_dir;
 	std::string lang;
 	std::string machine;
+	std::string replay;
+	std::string benchmark;
 	std::vector<std::string> conf;
 	std::vector<std::string> set;
 	std::optional<std::vector<std::string>> editconf;
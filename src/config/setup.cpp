@@ -5,7 +5,9 @@
 #include "config/setup.h"
 
 #include <algorithm>
+#include <chrono>
 #include <climits>
+#include <cstring>
 #include <cstdlib>
 #include <fstream>
 #include <limits>
@@ -21,6 +23,7 @@
 #include "misc/cross.h"
 #include "misc/notifications.h"
 #include "misc/support.h"
+#include "misc/tracy.h"
 #include "utils/fs_utils.h"
 #include "utils/string_utils.h"
 
@@ -179,24 +182,30 @@ void Value::SetString(const std::string& _value)
 
 std::string Value::ToString() const
 {
-	std::ostringstream oss;
+	// Validating a setting compares its value as a string against each of
+	// the property's valid values, so only use a stream where the format
+	// needs one
 	switch (type) {
-	case V_HEX:
+	case V_HEX: {
+		std::ostringstream oss;
 		oss.flags(std::ios::hex);
 		oss << _hex;
-		break;
-	case V_INT: oss << _int; break;
-	case V_BOOL: oss << (_bool ? "on" : "off"); break;
-	case V_STRING: oss << _string; break;
-	case V_DOUBLE:
+		return oss.str();
+	}
+	case V_INT: return std::to_string(_int);
+	case V_BOOL: return _bool ? "on" : "off";
+	case V_STRING: return _string;
+	case V_DOUBLE: {
+		std::ostringstream oss;
 		oss.precision(2);
 		oss << std::fixed << _double;
-		break;
+		return oss.str();
+	}
 	case V_NONE:
 	case V_CURRENT:
 	default: E_Exit("ToString messed up ?"); break;
 	}
-	return oss.str();
+	return {};
 }
 
 Property::Property(const std::string& name, Changeable::Value when)
@@ -1381,8 +1390,40 @@ Config::Config(Config&& source) noexcept
 
 void Config::Init() const
 {
+	using namespace std::chrono;
+
+	struct Timing {
+		const char* section = nullptr;
+		steady_clock::duration elapsed = {};
+	};
+	std::vector<Timing> timings = {};
+
+	const auto started = steady_clock::now();
 	for (const auto& sec : sectionlist) {
+		ZoneScopedN("Section init");
+		ZoneText(sec->GetName(), std::strlen(sec->GetName()));
+
+		const auto section_started = steady_clock::now();
 		sec->ExecuteInit();
+		timings.push_back({sec->GetName(), steady_clock::now() - section_started});
+	}
+
+	if (!arguments.startup_profile) {
+		return;
+	}
+
+	// Slowest first, so the devices worth deferring or trimming stand out
+	std::sort(timings.begin(), timings.end(), [](const Timing& a, const Timing& b) {
+		return a.elapsed > b.elapsed;
+	});
+	const auto to_ms = [](const steady_clock::duration elapsed) {
+		return duration_cast<duration<double, std::milli>>(elapsed).count();
+	};
+	LOG_MSG("STARTUP: Initialized %zu config sections in %.1f ms",
+	        timings.size(),
+	        to_ms(steady_clock::now() - started));
+	for (const auto& timing : timings) {
+		LOG_MSG("STARTUP:   %-16s %8.1f ms", timing.section, to_ms(timing.elapsed));
 	}
 }
 
@@ -1977,6 +2018,8 @@ void Config::ParseArguments()
 	arguments.exit        = cmdline->FindRemoveBoolArgument("exit");
 	arguments.securemode  = cmdline->FindRemoveBoolArgument("securemode");
 	arguments.noautoexec  = cmdline->FindRemoveBoolArgument("noautoexec");
+	arguments.headless    = cmdline->FindRemoveBoolArgument("headless");
+	arguments.startup_profile = cmdline->FindRemoveBoolArgument("startup-profile");
 
 	arguments.eraseconf = cmdline->FindRemoveBoolArgument("eraseconf") ||
 	                      cmdline->FindRemoveBoolArgument("resetconf");
@@ -1990,6 +2033,8 @@ void Config::ParseArguments()
 	arguments.working_dir = cmdline->FindRemoveStringArgument("working-dir");
 	arguments.lang    = cmdline->FindRemoveStringArgument("lang");
 	arguments.machine = cmdline->FindRemoveStringArgument("machine");
+	arguments.replay  = cmdline->FindRemoveStringArgument("replay");
+	arguments.benchmark = cmdline->FindRemoveStringArgument("benchmark");
 
 	arguments.socket   = cmdline->FindRemoveIntArgument("socket");
 	arguments.wait_pid = cmdline->FindRemoveIntArgument("waitpid");
@@ -1998,6 +2043,14 @@ void Config::ParseArguments()
 	arguments.set  = cmdline->FindRemoveVectorArgument("set");
 
 	arguments.editconf = cmdline->FindRemoveOptionalArgument("editconf");
+
+	// A benchmark brings its own settings and needs no window or sound
+	// device
+	if (!arguments.benchmark.empty()) {
+		arguments.headless      = true;
+		arguments.noprimaryconf = true;
+		arguments.nolocalconf   = true;
+	}
 }
 
 // Only checks if config file exists and is not empty
@@ -2,6 +2,7 @@
 // SPDX-FileCopyrightText:  2002-2021 The DOSBox Team
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <limits>
@@ -12,6 +13,8 @@
 #include "dosbox.h"
 #include "utils/math_utils.h"
 #include "hardware/memory.h"
+#include "hardware/pic.h"
+#include "misc/perf_counters.h"
 
 /* Callback are located at 0xF000:0x1000  (see CB_SEG and CB_SOFFSET in callback.h)
    And they are 16 bytes each and you can define them to behave in certain ways like a
@@ -20,6 +23,11 @@
 
 Callback_Handler Callback_Handlers[CB_MAX];
 std::string Callback_Description[CB_MAX];
+bool Callback_Inline[CB_MAX];
+
+static PerfCounter callbacks_run_inline("callbacks_run_inline",
+                                        "Callback handlers the CPU cores ran "
+                                        "without returning to the main loop.");
 
 static callback_number_t call_stop    = 0;
 static callback_number_t call_idle    = 0;
@@ -40,6 +48,7 @@ callback_number_t CALLBACK_Allocate()
 	for (callback_number_t i = 1; i < CB_MAX; ++i) {
 		if (Callback_Handlers[i] == &illegal_handler) {
 			Callback_Handlers[i] = nullptr;
+			Callback_Inline[i]   = false;
 			return i;
 		}
 	}
@@ -52,6 +61,28 @@ void CALLBACK_DeAllocate(callback_number_t cb_num)
 	Callback_Handlers[cb_num] = &illegal_handler;
 }
 
+void CALLBACK_SetInline(const callback_number_t cb_num, const bool is_inline)
+{
+	assert(cb_num < CB_MAX);
+	Callback_Inline[cb_num] = is_inline;
+}
+
+bool CALLBACK_RunInline(const Bitu cb_num)
+{
+	assert(CALLBACK_IsInline(cb_num));
+	callbacks_run_inline.Add();
+
+	const auto decoder = cpudecoder;
+
+	[[maybe_unused]] const auto result = Callback_Handlers[cb_num]();
+	assert(result == CBRET_NONE);
+
+	if (cpudecoder != decoder || CPU_Cycles <= 0) {
+		return false;
+	}
+	return !(GETFLAG(IF) && PIC_IRQCheck);
+}
+
 void CALLBACK_Idle() {
 /* this makes the cpu execute instructions to handle irq's and then come back */
 	const auto oldIF = GETFLAG(IF);
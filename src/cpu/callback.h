@@ -82,6 +82,31 @@ callback_number_t CALLBACK_Setup(callback_number_t cb_number, Callback_Handler h
 
 const char* CALLBACK_GetDescription(callback_number_t cb_number);
 
+// In-line callbacks
+// ~~~~~~~~~~~~~~~~~
+// A callback's handler normally runs from the main loop, so every BIOS or
+// DOS service call costs the core an exit and a re-entry, and the dynamic
+// core a block lookup on top. The cores run the handlers of callbacks
+// marked in-line straight from the callback opcode instead. Such a handler
+// must return CBRET_NONE. It may still switch the CPU mode or the core,
+// set the interrupt flag or run guest code in a nested loop: the cores
+// rebuild their state from the registers after it, and return to the main
+// loop when it switched the core, an interrupt is due or the cycles ran
+// out. Allocating a callback clears its mark.
+
+extern bool Callback_Inline[CB_MAX];
+
+void CALLBACK_SetInline(callback_number_t cb_number, bool is_inline);
+
+static inline bool CALLBACK_IsInline(const Bitu cb_number)
+{
+	return cb_number < CB_MAX && Callback_Inline[cb_number];
+}
+
+// Runs an in-line callback's handler, and returns whether the core can
+// carry on with the next instruction rather than return to the main loop
+bool CALLBACK_RunInline(Bitu cb_number);
+
 void CALLBACK_SCF(bool val);
 void CALLBACK_SZF(bool val);
 void CALLBACK_SIF(bool val);
@@ -120,5 +145,10 @@ public:
 		return CALLBACK_RealPointer(m_cb_number);
 	}
 	void Set_RealVec(uint8_t vec);
+
+	void SetInline(const bool is_inline)
+	{
+		CALLBACK_SetInline(m_cb_number, is_inline);
+	}
 };
 #endif
@@ -306,6 +306,10 @@ Bits CPU_Core_Dyn_X86_Run() noexcept
 	HostFpuToDhCopier host_fpu_to_dh_copier;
 #	endif
 
+	if (CPU_AutoCoreUsesNormal) {
+		return sync_dh_fpu_and_run_normal_core();
+	}
+
 	/* Determine the linear address of CS:EIP */
 restart_core:
 	PhysPt ip_point=SegPhys(cs)+reg_eip;
@@ -319,7 +323,7 @@ restart_core:
 		CPU_Exception(cpu.exception.which,cpu.exception.error);
 		goto restart_core;
 	}
-	if (!chandler) {
+	if (!chandler || chandler->IsInterpreted()) {
 		return sync_dh_fpu_and_run_normal_core();
 	}
 	/* Find correct Dynamic Block to run */
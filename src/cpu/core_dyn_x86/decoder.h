@@ -82,7 +82,9 @@ static bool MakeCodePage(Bitu lin_addr,CodePageHandler * &cph) {
 		return false;
 	}
 	/* Find a free CodePage */
+	cache_make_free_page();
 	if (!cache.free_pages && cache.used_pages) {
+		dynrec_pages_evicted.Add();
 		if (cache.used_pages != decode.page.code)
 			cache.used_pages->ClearRelease();
 		else {
@@ -38,6 +38,29 @@ static void FPU_FFREE(Bitu st) {
 #include "fpu/fpu_instructions.h"
 #endif
 
+// Pops the stack after running the given instruction, so the translated
+// code of the popping forms makes a single call rather than two
+template <void (*Op)(Bitu, Bitu)>
+static void dyn_fpu_op_pop(Bitu st, Bitu other)
+{
+	Op(st, other);
+	FPU_FPOP();
+}
+
+template <void (*Op)(Bitu)>
+static void dyn_fpu_reg_pop(Bitu st)
+{
+	Op(st);
+	FPU_FPOP();
+}
+
+template <void (*Op)(PhysPt)>
+static void dyn_fpu_store_pop(PhysPt addr)
+{
+	Op(addr);
+	FPU_FPOP();
+}
+
 
 #define dyn_fpu_top() {				\
 	gen_protectflags();				\
@@ -61,8 +84,7 @@ static void dyn_eatree()
 		gen_call_function((void*)&FPU_FCOM_EA,"%Drd",DREG(TMPB));
 		break;
 	case 0x03:		/* FCOMP STi */
-		gen_call_function((void*)&FPU_FCOM_EA,"%Drd",DREG(TMPB));
-		gen_call_function((void*)&FPU_FPOP,"");
+		gen_call_function((void*)&dyn_fpu_reg_pop<FPU_FCOM_EA>,"%Drd",DREG(TMPB));
 		break;
 	case 0x04:		/* FSUB  ST,STi */
 		gen_call_function((void*)&FPU_FSUB_EA,"%Drd",DREG(TMPB));
@@ -98,8 +120,7 @@ static void dyn_fpu_esc0()
 			gen_call_function((void*)&FPU_FCOM,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;
 		case 0x03:		// FCOMP STi /
-			gen_call_function((void*)&FPU_FCOM,"%Drd%Drd",DREG(TMPB),DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FCOM>,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;
 		case 0x04:		// FSUB  ST,STi /
 			gen_call_function((void*)&FPU_FSUB,"%Drd%Drd",DREG(TMPB),DREG(EA));
@@ -149,8 +170,7 @@ static void dyn_fpu_esc1()
 			break;
 		case 0x03: /* FSTP STi */
 			dyn_fpu_top();
-			gen_call_function((void*)&FPU_FST,"%Drd%Drd",DREG(TMPB),DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FST>,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;   
 		case 0x04:
 			switch(sub){
@@ -286,8 +306,7 @@ static void dyn_fpu_esc1()
 			gen_call_function((void*)&FPU_FST_F32,"%Drd",DREG(EA));
 			break;
 		case 0x03: /* FSTP float*/
-			gen_call_function((void*)&FPU_FST_F32,"%Drd",DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_store_pop<FPU_FST_F32>,"%Drd",DREG(EA));
 			break;
 		case 0x04: /* FLDENV */
 			gen_call_function((void*)&FPU_FLDENV,"%Drd",DREG(EA));
@@ -323,8 +342,7 @@ static void dyn_fpu_esc2()
 				gen_dop_word_imm(DOP_ADD,true,DREG(EA),1); 
 				gen_dop_word_imm(DOP_AND,true,DREG(EA),7); 
 				gen_load_host(&TOP,DREG(TMPB),4); 
-				gen_call_function((void *)&FPU_FUCOM,"%Drd%Drd",DREG(TMPB),DREG(EA));
-				gen_call_function((void *)&FPU_FPOP,"");
+				gen_call_function((void*)&dyn_fpu_op_pop<FPU_FUCOM>,"%Drd%Drd",DREG(TMPB),DREG(EA));
 				gen_call_function((void *)&FPU_FPOP,"");
 				break;
 			default:
@@ -391,16 +409,14 @@ static void dyn_fpu_esc3()
 			gen_call_function((void*)&FPU_FST_I32,"%Drd",DREG(EA));
 			break;
 		case 0x03:	/* FISTP */
-			gen_call_function((void*)&FPU_FST_I32,"%Drd",DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_store_pop<FPU_FST_I32>,"%Drd",DREG(EA));
 			break;
 		case 0x05:	/* FLD 80 Bits Real */
 			gen_call_function((void*)&FPU_PREP_PUSH,"");
 			gen_call_function((void*)&FPU_FLD_F80,"%Drd",DREG(EA));
 			break;
 		case 0x07:	/* FSTP 80 Bits Real */
-			gen_call_function((void*)&FPU_FST_F80,"%Drd",DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_store_pop<FPU_FST_F80>,"%Drd",DREG(EA));
 			break;
 		default:
 			FPU_LOG_WARN(3, true, group, sub);
@@ -426,8 +442,7 @@ static void dyn_fpu_esc4()
 			gen_call_function((void*)&FPU_FCOM,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;
 		case 0x03:  /* FCOMP*/
-			gen_call_function((void*)&FPU_FCOM,"%Drd%Drd",DREG(TMPB),DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FCOM>,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;
 		case 0x04:  /* FSUBR STi,ST*/
 			gen_call_function((void*)&FPU_FSUBR,"%Drd%Drd",DREG(EA),DREG(TMPB));
@@ -470,15 +485,13 @@ static void dyn_fpu_esc5()
 			gen_call_function((void*)&FPU_FST,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;
 		case 0x03:  /* FSTP STi*/
-			gen_call_function((void*)&FPU_FST,"%Drd%Drd",DREG(TMPB),DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FST>,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;
 		case 0x04:	/* FUCOM STi */
 			gen_call_function((void*)&FPU_FUCOM,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;
 		case 0x05:	/*FUCOMP STi */
-			gen_call_function((void*)&FPU_FUCOM,"%Drd%Drd",DREG(TMPB),DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FUCOM>,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;
 		default:
 			FPU_LOG_WARN(5,false,group,sub);
@@ -502,8 +515,7 @@ static void dyn_fpu_esc5()
 			gen_call_function((void*)&FPU_FST_F64,"%Drd",DREG(EA));
 			break;
 		case 0x03:	/* FSTP double real*/
-			gen_call_function((void*)&FPU_FST_F64,"%Drd",DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_store_pop<FPU_FST_F64>,"%Drd",DREG(EA));
 			break;
 		case 0x04:	/* FRSTOR */
 			gen_call_function((void*)&FPU_FRSTOR,"%Drd",DREG(EA));
@@ -534,13 +546,13 @@ static void dyn_fpu_esc6()
 		dyn_fpu_top();
 		switch (group) {
 		case 0x00:	/*FADDP STi,ST*/
-			gen_call_function((void*)&FPU_FADD,"%Drd%Drd",DREG(EA),DREG(TMPB));
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FADD>,"%Drd%Drd",DREG(EA),DREG(TMPB));
 			break;
 		case 0x01:	/* FMULP STi,ST*/
-			gen_call_function((void*)&FPU_FMUL,"%Drd%Drd",DREG(EA),DREG(TMPB));
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FMUL>,"%Drd%Drd",DREG(EA),DREG(TMPB));
 			break;
 		case 0x02:  /* FCOMP5*/
-			gen_call_function((void*)&FPU_FCOM,"%Drd%Drd",DREG(TMPB),DREG(EA));
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FCOM>,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;	/* TODO IS THIS ALLRIGHT ????????? */
 		case 0x03:  /*FCOMPP*/
 			if(sub != 1) {
@@ -550,25 +562,24 @@ static void dyn_fpu_esc6()
 			gen_load_host(&TOP,DREG(EA),4); 
 			gen_dop_word_imm(DOP_ADD,true,DREG(EA),1);
 			gen_dop_word_imm(DOP_AND,true,DREG(EA),7);
-			gen_call_function((void*)&FPU_FCOM,"%Drd%Drd",DREG(TMPB),DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,""); /* extra pop at the bottom*/
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FCOM>,"%Drd%Drd",DREG(TMPB),DREG(EA));
+			gen_call_function((void*)&FPU_FPOP,"");
 			break;
 		case 0x04:  /* FSUBRP STi,ST*/
-			gen_call_function((void*)&FPU_FSUBR,"%Drd%Drd",DREG(EA),DREG(TMPB));
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FSUBR>,"%Drd%Drd",DREG(EA),DREG(TMPB));
 			break;
 		case 0x05:  /* FSUBP  STi,ST*/
-			gen_call_function((void*)&FPU_FSUB,"%Drd%Drd",DREG(EA),DREG(TMPB));
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FSUB>,"%Drd%Drd",DREG(EA),DREG(TMPB));
 			break;
 		case 0x06:	/* FDIVRP STi,ST*/
-			gen_call_function((void*)&FPU_FDIVR,"%Drd%Drd",DREG(EA),DREG(TMPB));
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FDIVR>,"%Drd%Drd",DREG(EA),DREG(TMPB));
 			break;
 		case 0x07:  /* FDIVP STi,ST*/
-			gen_call_function((void*)&FPU_FDIV,"%Drd%Drd",DREG(EA),DREG(TMPB));
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FDIV>,"%Drd%Drd",DREG(EA),DREG(TMPB));
 			break;
 		default:
 			break;
 		}
-		gen_call_function((void *)&FPU_FPOP, "");
 	} else {
 		dyn_fill_ea();
 		gen_call_function((void*)&FPU_FLD_I16_EA,"%Drd",DREG(EA)); 
@@ -586,8 +597,7 @@ static void dyn_fpu_esc7()
 		switch (group) {
 		case 0x00: /* FFREEP STi*/
 			dyn_fpu_top();
-			gen_call_function((void*)&FPU_FFREE,"%Drd",DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_reg_pop<FPU_FFREE>,"%Drd",DREG(EA));
 			break;
 		case 0x01: /* FXCH STi*/
 			dyn_fpu_top();
@@ -596,8 +606,7 @@ static void dyn_fpu_esc7()
 		case 0x02:  /* FSTP STi*/
 		case 0x03:  /* FSTP STi*/
 			dyn_fpu_top();
-			gen_call_function((void*)&FPU_FST,"%Drd%Drd",DREG(TMPB),DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_op_pop<FPU_FST>,"%Drd%Drd",DREG(TMPB),DREG(EA));
 			break;
 		case 0x04:
 			switch(sub){
@@ -630,8 +639,7 @@ static void dyn_fpu_esc7()
 			gen_call_function((void*)&FPU_FST_I16,"%Drd",DREG(EA));
 			break;
 		case 0x03:	/* FISTP int16_t */
-			gen_call_function((void*)&FPU_FST_I16,"%Drd",DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_store_pop<FPU_FST_I16>,"%Drd",DREG(EA));
 			break;
 		case 0x04:   /* FBLD packed BCD */
 			gen_call_function((void*)&FPU_PREP_PUSH,"");
@@ -644,12 +652,10 @@ static void dyn_fpu_esc7()
 			gen_call_function((void*)&FPU_FLD_I64,"%Drd%Drd",DREG(EA),DREG(TMPB));
 			break;
 		case 0x06:	/* FBSTP packed BCD */
-			gen_call_function((void*)&FPU_FBST,"%Drd",DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_store_pop<FPU_FBST>,"%Drd",DREG(EA));
 			break;
 		case 0x07:  /* FISTP int64_t */
-			gen_call_function((void*)&FPU_FST_I64,"%Drd",DREG(EA));
-			gen_call_function((void*)&FPU_FPOP,"");
+			gen_call_function((void*)&dyn_fpu_store_pop<FPU_FST_I64>,"%Drd",DREG(EA));
 			break;
 		default:
 			FPU_LOG_WARN(7,true,group,sub);
@@ -206,6 +206,44 @@ CacheBlock *LinkBlocks(BlockReturn ret)
 	return cache_block;
 }
 
+static PerfCounter dynrec_indirect_hits("dynrec_indirect_hits",
+                                        "Indirect branches whose target block "
+                                        "was predicted without a lookup.");
+
+// A block that left through an indirect jump, call or return usually
+// goes to the same place next time (a return to the one caller, a
+// virtual call site that always sees the same type), so it remembers its
+// last target. Reusing that skips MakeCodePage and the page's hash map.
+// The guess is checked the same way LinkBlocks checks a link target: the
+// block must still be live, start at CS:EIP in the page that is mapped
+// there now, and that page must hold code of the current size.
+static CacheBlock *FindIndirectTarget(const CacheBlock *from)
+{
+	CacheBlock *target = from->indirect_target;
+	if (!target || !target->page.handler || !target->hash.index) {
+		return nullptr;
+	}
+
+	const auto ip_point = SegPhys(cs) + reg_eip;
+	if (target->page.start != (ip_point & 4095)) {
+		return nullptr;
+	}
+
+	const auto read_handler = get_tlb_readhandler(ip_point);
+	if (read_handler != target->page.handler) {
+		return nullptr;
+	}
+
+	const bool cp_has_code = read_handler->flags &
+	                         (cpu.code.big ? PFLAG_HASCODE32 : PFLAG_HASCODE16);
+	if (!cp_has_code || target->page.handler->IsInterpreted()) {
+		return nullptr;
+	}
+
+	dynrec_indirect_hits.Add();
+	return target;
+}
+
 /*
 	The core tries to find the block that should be executed next.
 	If such a block is found, it is run, otherwise the instruction
@@ -221,6 +259,11 @@ CacheBlock *LinkBlocks(BlockReturn ret)
 Bits CPU_Core_Dynrec_Run() noexcept
 {
 	ZoneScoped;
+	if (CPU_AutoCoreUsesNormal) {
+		return CPU_Core_Normal_Run();
+	}
+	// the block that just left through an indirect branch, if any
+	CacheBlock *indirect_from = nullptr;
 	for (;;) {
 		// Determine the linear address of CS:EIP
 		PhysPt ip_point=SegPhys(cs)+reg_eip;
@@ -229,40 +272,50 @@ Bits CPU_Core_Dynrec_Run() noexcept
 			return debugCallback;
 #endif
 
-		CodePageHandler *chandler = nullptr;
-		// see if the current page is present and contains code
-		if (MakeCodePage(ip_point, chandler)) {
-			// page not present, throw the exception
-			CPU_Exception(cpu.exception.which,cpu.exception.error);
-			continue;
-		}
+		// try where the last indirect branch went before looking up
+		CacheBlock *block = indirect_from ? FindIndirectTarget(indirect_from)
+		                                  : nullptr;
+		if (!block) {
+			CodePageHandler *chandler = nullptr;
+			// see if the current page is present and contains code
+			if (MakeCodePage(ip_point, chandler)) {
+				// page not present, throw the exception
+				CPU_Exception(cpu.exception.which,cpu.exception.error);
+				continue;
+			}
 
-		// page doesn't contain code or is special
-		if (!chandler) {
-			return CPU_Core_Normal_Run();
-		}
+			// page doesn't contain code, is special or keeps
+			// rewriting its code
+			if (!chandler || chandler->IsInterpreted()) {
+				return CPU_Core_Normal_Run();
+			}
 
-		// find correct Dynamic Block to run
-		CacheBlock *block = chandler->FindCacheBlock(ip_point & 4095);
-		if (!block) {
-			// no block found, thus translate the instruction stream
-			// unless the instruction is known to be modified
-			if (!chandler->invalidation_map || (chandler->invalidation_map[ip_point&4095]<4)) {
-				// translate up to 32 instructions
-				block=CreateCacheBlock(chandler,ip_point,32);
-			} else {
-				// let the normal core handle this instruction to avoid zero-sized blocks
-				Bitu old_cycles=CPU_Cycles;
-				CPU_Cycles=1;
-				Bits nc_retcode=CPU_Core_Normal_Run();
-				if (!nc_retcode) {
-					CPU_Cycles=old_cycles-1;
-					continue;
+			// find correct Dynamic Block to run
+			block = chandler->FindCacheBlock(ip_point & 4095);
+			if (!block) {
+				// no block found, thus translate the instruction stream
+				// unless the instruction is known to be modified
+				if (!chandler->invalidation_map || (chandler->invalidation_map[ip_point&4095]<4)) {
+					// translate up to 32 instructions
+					block=CreateCacheBlock(chandler,ip_point,32);
+				} else {
+					// let the normal core handle this instruction to avoid zero-sized blocks
+					Bitu old_cycles=CPU_Cycles;
+					CPU_Cycles=1;
+					Bits nc_retcode=CPU_Core_Normal_Run();
+					if (!nc_retcode) {
+						CPU_Cycles=old_cycles-1;
+						continue;
+					}
+					CPU_CycleLeft+=old_cycles;
+					return nc_retcode;
 				}
-				CPU_CycleLeft+=old_cycles;
-				return nc_retcode;
+			}
+			if (indirect_from) {
+				indirect_from->indirect_target = block;
 			}
 		}
+		indirect_from = nullptr;
 
 run_block:
 		cache.block.running=nullptr;
@@ -295,6 +348,7 @@ run_block:
 			if (DEBUG_HeavyIsBreakpoint()) return debugCallback;
 #endif
 #endif
+			indirect_from = cache.block.running;
 			break;
 
 		case BR_Cycles:
@@ -310,7 +364,14 @@ run_block:
 		case BR_Callback:
 			// the callback code is executed in dosbox.conf, return the callback number
 			FillFlags();
-			return core_dynrec.callback;
+			if (!CALLBACK_IsInline(core_dynrec.callback)) {
+				return core_dynrec.callback;
+			}
+			// or run in-line, and go on with a fresh block lookup
+			if (CALLBACK_RunInline(core_dynrec.callback)) {
+				continue;
+			}
+			return CBRET_NONE;
 
 		case BR_SMCBlock:
 //			LOG_MSG("selfmodification of running block at %x:%x",SegValue(cs),reg_eip);
@@ -36,6 +36,7 @@ static CacheBlock *CreateCacheBlock(CodePageHandler *codepage, PhysPt start, Bit
 	dyn_mem_write(cache_addr, cache_bytes);
 
 	InitFlagsOptimization();
+	dyn_forget_known_regs();
 
 	// every codeblock that is run sets cache.block.running to itself
 	// so the block linking knows the last executed block
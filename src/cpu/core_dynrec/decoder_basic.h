@@ -149,7 +149,9 @@ static bool MakeCodePage(Bitu lin_addr, CodePageHandler *&cph)
 		return false;
 	}
 	// find a free CodePage
+	cache_make_free_page();
 	if (!cache.free_pages) {
+		dynrec_pages_evicted.Add();
 		if (cache.used_pages!=decode.page.code) cache.used_pages->ClearRelease();
 		else {
 			// try another page to avoid clearing our source-crosspage
@@ -352,12 +354,12 @@ static inline void dyn_get_modrm()
 #define ADD_REG_VAL_TO_HOST_REG(host_reg, reg_index) gen_add_regval32_to_reg(host_reg,(Bitu)(DRCD_REG_VAL(reg_index)) - (Bitu)(&cpu_regs))
 
 #define MOV_REG_WORD16_TO_HOST_REG(host_reg, reg_index) gen_mov_regval16_to_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,false)) - (Bitu)(&cpu_regs))
-#define MOV_REG_WORD32_TO_HOST_REG(host_reg, reg_index) gen_mov_regval32_to_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,true)) - (Bitu)(&cpu_regs))
-#define MOV_REG_WORD_TO_HOST_REG(host_reg, reg_index, dword) gen_mov_regword_to_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,dword)) - (Bitu)(&cpu_regs), dword)
+#define MOV_REG_WORD32_TO_HOST_REG_UNCACHED(host_reg, reg_index) gen_mov_regval32_to_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,true)) - (Bitu)(&cpu_regs))
+#define MOV_REG_WORD_TO_HOST_REG_UNCACHED(host_reg, reg_index, dword) gen_mov_regword_to_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,dword)) - (Bitu)(&cpu_regs), dword)
 
 #define MOV_REG_WORD16_FROM_HOST_REG(host_reg, reg_index) gen_mov_regval16_from_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,false)) - (Bitu)(&cpu_regs))
-#define MOV_REG_WORD32_FROM_HOST_REG(host_reg, reg_index) gen_mov_regval32_from_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,true)) - (Bitu)(&cpu_regs))
-#define MOV_REG_WORD_FROM_HOST_REG(host_reg, reg_index, dword) gen_mov_regword_from_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,dword)) - (Bitu)(&cpu_regs), dword)
+#define MOV_REG_WORD32_FROM_HOST_REG_UNCACHED(host_reg, reg_index) gen_mov_regval32_from_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,true)) - (Bitu)(&cpu_regs))
+#define MOV_REG_WORD_FROM_HOST_REG_UNCACHED(host_reg, reg_index, dword) gen_mov_regword_from_reg(host_reg,(Bitu)(DRCD_REG_WORD(reg_index,dword)) - (Bitu)(&cpu_regs), dword)
 
 #define MOV_REG_BYTE_TO_HOST_REG_LOW(host_reg, reg_index, high_byte) gen_mov_regbyte_to_reg_low(host_reg,(Bitu)(DRCD_REG_BYTE(reg_index,high_byte)) - (Bitu)(&cpu_regs))
 #define MOV_REG_BYTE_TO_HOST_REG_LOW_CANUSEWORD(host_reg, reg_index, high_byte) gen_mov_regbyte_to_reg_low_canuseword(host_reg,(Bitu)(DRCD_REG_BYTE(reg_index,high_byte)) - (Bitu)(&cpu_regs))
@@ -369,12 +371,12 @@ static inline void dyn_get_modrm()
 #define ADD_REG_VAL_TO_HOST_REG(host_reg, reg_index) gen_add(host_reg,DRCD_REG_VAL(reg_index))
 
 #define MOV_REG_WORD16_TO_HOST_REG(host_reg, reg_index) gen_mov_word_to_reg(host_reg,DRCD_REG_WORD(reg_index,false),false)
-#define MOV_REG_WORD32_TO_HOST_REG(host_reg, reg_index) gen_mov_word_to_reg(host_reg,DRCD_REG_WORD(reg_index,true),true)
-#define MOV_REG_WORD_TO_HOST_REG(host_reg, reg_index, dword) gen_mov_word_to_reg(host_reg,DRCD_REG_WORD(reg_index,dword),dword)
+#define MOV_REG_WORD32_TO_HOST_REG_UNCACHED(host_reg, reg_index) gen_mov_word_to_reg(host_reg,DRCD_REG_WORD(reg_index,true),true)
+#define MOV_REG_WORD_TO_HOST_REG_UNCACHED(host_reg, reg_index, dword) gen_mov_word_to_reg(host_reg,DRCD_REG_WORD(reg_index,dword),dword)
 
 #define MOV_REG_WORD16_FROM_HOST_REG(host_reg, reg_index) gen_mov_word_from_reg(host_reg,DRCD_REG_WORD(reg_index,false),false)
-#define MOV_REG_WORD32_FROM_HOST_REG(host_reg, reg_index) gen_mov_word_from_reg(host_reg,DRCD_REG_WORD(reg_index,true),true)
-#define MOV_REG_WORD_FROM_HOST_REG(host_reg, reg_index, dword) gen_mov_word_from_reg(host_reg,DRCD_REG_WORD(reg_index,dword),dword)
+#define MOV_REG_WORD32_FROM_HOST_REG_UNCACHED(host_reg, reg_index) gen_mov_word_from_reg(host_reg,DRCD_REG_WORD(reg_index,true),true)
+#define MOV_REG_WORD_FROM_HOST_REG_UNCACHED(host_reg, reg_index, dword) gen_mov_word_from_reg(host_reg,DRCD_REG_WORD(reg_index,dword),dword)
 
 #define MOV_REG_BYTE_TO_HOST_REG_LOW(host_reg, reg_index, high_byte) gen_mov_byte_to_reg_low(host_reg,DRCD_REG_BYTE(reg_index,high_byte))
 #define MOV_REG_BYTE_TO_HOST_REG_LOW_CANUSEWORD(host_reg, reg_index, high_byte) gen_mov_byte_to_reg_low_canuseword(host_reg,DRCD_REG_BYTE(reg_index,high_byte))
@@ -382,6 +384,115 @@ static inline void dyn_get_modrm()
 
 #endif
 
+#ifdef DRC_REUSE_LOADED_REGS
+
+// Guest registers still held in host registers
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Translated instructions load their operands from cpu_regs and store
+// their results back, so an instruction often loads a register that the
+// one before it just stored or loaded. If only those loads and stores
+// were emitted since, what runs in between is just them, and the host
+// register they used still holds the value; a register move replaces the
+// load. Emitting anything else moves the cache position on, which forgets
+// what's known, and so does a branch landing at the current position.
+// Only 32-bit accesses take part, as 16-bit loads zero-extend.
+
+static struct {
+	// The cache position what's known holds at
+	const uint8_t* pos = nullptr;
+
+	struct {
+		HostReg host_reg  = 0;
+		uint8_t reg_index = 0;
+	} regs[4] = {};
+
+	uint8_t num_regs = 0;
+} dyn_known_regs = {};
+
+static void dyn_forget_known_regs()
+{
+	dyn_known_regs.pos      = nullptr;
+	dyn_known_regs.num_regs = 0;
+}
+
+// Records that host_reg holds the guest register once the code emitted
+// from emit_start on runs
+static void dyn_learn_known_reg(const uint8_t* emit_start, const HostReg host_reg,
+                                const uint8_t reg_index, const bool is_store)
+{
+	auto& known = dyn_known_regs;
+	if (known.pos != emit_start) {
+		known.num_regs = 0;
+	}
+
+	// A load overwrites the host register; a store leaves it alone but
+	// changes the guest register
+	uint8_t num_kept = 0;
+	for (uint8_t i = 0; i < known.num_regs; ++i) {
+		const auto& reg    = known.regs[i];
+		const bool is_kept = is_store ? reg.reg_index != reg_index
+		                              : reg.host_reg != host_reg;
+		if (is_kept) {
+			known.regs[num_kept++] = reg;
+		}
+	}
+	known.num_regs = num_kept;
+
+	if (known.num_regs < std::size(known.regs)) {
+		known.regs[known.num_regs++] = {host_reg, reg_index};
+	}
+	known.pos = cache.pos;
+}
+
+static void dyn_load_reg32(const HostReg host_reg, const uint8_t reg_index)
+{
+	const auto emit_start = cache.pos;
+
+	bool is_known = false;
+	if (dyn_known_regs.pos == emit_start) {
+		for (uint8_t i = 0; i < dyn_known_regs.num_regs; ++i) {
+			const auto& reg = dyn_known_regs.regs[i];
+			if (reg.reg_index == reg_index) {
+				gen_mov_regs(host_reg, reg.host_reg);
+				is_known = true;
+				break;
+			}
+		}
+	}
+	if (!is_known) {
+		MOV_REG_WORD32_TO_HOST_REG_UNCACHED(host_reg, reg_index);
+	}
+	dyn_learn_known_reg(emit_start, host_reg, reg_index, false);
+}
+
+static void dyn_store_reg32(const HostReg host_reg, const uint8_t reg_index)
+{
+	const auto emit_start = cache.pos;
+	MOV_REG_WORD32_FROM_HOST_REG_UNCACHED(host_reg, reg_index);
+	dyn_learn_known_reg(emit_start, host_reg, reg_index, true);
+}
+
+#define MOV_REG_WORD32_TO_HOST_REG(host_reg, reg_index) dyn_load_reg32(host_reg, reg_index)
+#define MOV_REG_WORD32_FROM_HOST_REG(host_reg, reg_index) dyn_store_reg32(host_reg, reg_index)
+
+#define MOV_REG_WORD_TO_HOST_REG(host_reg, reg_index, dword) \
+	((dword) ? dyn_load_reg32(host_reg, reg_index) \
+	         : MOV_REG_WORD_TO_HOST_REG_UNCACHED(host_reg, reg_index, false))
+#define MOV_REG_WORD_FROM_HOST_REG(host_reg, reg_index, dword) \
+	((dword) ? dyn_store_reg32(host_reg, reg_index) \
+	         : MOV_REG_WORD_FROM_HOST_REG_UNCACHED(host_reg, reg_index, false))
+
+#else
+
+static void dyn_forget_known_regs() {}
+
+#define MOV_REG_WORD32_TO_HOST_REG(host_reg, reg_index) MOV_REG_WORD32_TO_HOST_REG_UNCACHED(host_reg, reg_index)
+#define MOV_REG_WORD32_FROM_HOST_REG(host_reg, reg_index) MOV_REG_WORD32_FROM_HOST_REG_UNCACHED(host_reg, reg_index)
+#define MOV_REG_WORD_TO_HOST_REG(host_reg, reg_index, dword) MOV_REG_WORD_TO_HOST_REG_UNCACHED(host_reg, reg_index, dword)
+#define MOV_REG_WORD_FROM_HOST_REG(host_reg, reg_index, dword) MOV_REG_WORD_FROM_HOST_REG_UNCACHED(host_reg, reg_index, dword)
+
+#endif
+
 
 #define DYN_LEA_MEM_MEM(ea_reg, op1, op2, scale, imm) dyn_lea_mem_mem(ea_reg,op1,op2,scale,imm)
 
@@ -591,6 +702,7 @@ static void dyn_run_code(void) {
 static void dyn_fill_blocks(void) {
 	for (Bitu sct=0; sct<used_save_info_dynrec; sct++) {
 		gen_fill_branch_long(save_info_dynrec[sct].branch_pos);
+		dyn_forget_known_regs();
 		switch (save_info_dynrec[sct].type) {
 			case db_exception:
 				// code for exception handling, load cycles and call DynRunException
@@ -623,8 +735,12 @@ static void dyn_closeblock(void) {
 }
 
 
+static void AcquireFlags(Bitu flags_mask);
+
 // add a check that can branch to the exception handling
 static void dyn_check_exception(HostReg reg) {
+	// the exception handler sees the flags as they are at this point
+	AcquireFlags(FMASK_TEST);
 	save_info_dynrec[used_save_info_dynrec].branch_pos=gen_create_branch_long_nonzero(reg,false);
 	if (!decode.cycles) {
 		++decode.cycles;
@@ -1134,72 +1250,113 @@ static void gen_restore_reg(HostReg reg,HostReg dest_reg) {
 // flags optimization functions
 // they try to find out if a function can be replaced by another
 // one that does not generate any flags at all
+//
+// Every queued function remembers the flags it generates that no later
+// instruction has overwritten yet. Once all of them are overwritten before
+// anything reads them it's replaced by its simpler variant; as soon as one
+// of them is read it's dropped from the queue and keeps generating flags.
+// Anything that can leave the block halfway (an exception, a string
+// instruction running out of cycles) counts as reading all of them, and
+// whatever is still queued at the end of the block is left alone.
+
+// INC and DEC keep the carry, the rotates only change the carry and overflow
+constexpr Bitu FMASK_INCDEC = FMASK_TEST & ~FLAG_CF;
+constexpr Bitu FMASK_ROTATE = FLAG_CF | FLAG_OF;
 
 static Bitu mf_functions_num=0;
 static struct {
 	const uint8_t* pos;
 	void* fct_ptr;
 	Bitu ftype;
+	Bitu flags_pending;
 } mf_functions[64];
 
 static void InitFlagsOptimization(void) {
 	mf_functions_num=0;
 }
 
-// replace all queued functions with their simpler variants
-// because the current instruction destroys all condition flags and
-// the flags are not required before
-static void InvalidateFlags(void) {
+// replace the queued functions whose flags the current instruction
+// overwrites (without reading them first) with their simpler variants
+static void KillFlags([[maybe_unused]] Bitu flags_mask) {
 #ifdef DRC_FLAGS_INVALIDATION
+	Bitu num_kept=0;
 	for (Bitu ct=0; ct<mf_functions_num; ct++) {
-		gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
+		mf_functions[ct].flags_pending&=~flags_mask;
+		if (mf_functions[ct].flags_pending) {
+			mf_functions[num_kept++]=mf_functions[ct];
+		} else {
+			gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
+		}
 	}
-	mf_functions_num=0;
+	mf_functions_num=num_kept;
 #endif
 }
 
+[[maybe_unused]] static void QueueFlagsFunction(void* current_simple_function,
+                                                const uint8_t* cpos,
+                                                Bitu flags_type,
+                                                Bitu flags_generated) {
+	assert(mf_functions_num < std::size(mf_functions));
+	mf_functions[mf_functions_num].pos=cpos;
+	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
+	mf_functions[mf_functions_num].ftype=flags_type;
+	mf_functions[mf_functions_num].flags_pending=flags_generated;
+	++mf_functions_num;
+}
+
 // replace all queued functions with their simpler variants
 // because the current instruction destroys all condition flags and
 // the flags are not required before
-static void InvalidateFlags(void* current_simple_function,Bitu flags_type) {
+static void InvalidateFlags(void) {
+	KillFlags(FMASK_TEST);
+}
+
+// replace all queued functions with their simpler variants
+// because the current instruction destroys all condition flags and
+// the flags are not required before
+static void InvalidateFlags([[maybe_unused]] void* current_simple_function,
+                            [[maybe_unused]] Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	for (Bitu ct=0; ct<mf_functions_num; ct++) {
-		gen_fill_function_ptr(mf_functions[ct].pos,mf_functions[ct].fct_ptr,mf_functions[ct].ftype);
-	}
-	mf_functions_num=1;
-	mf_functions[0].pos=cache.pos;
-	mf_functions[0].fct_ptr=current_simple_function;
-	mf_functions[0].ftype=flags_type;
+	KillFlags(FMASK_TEST);
+	QueueFlagsFunction(current_simple_function,cache.pos,flags_type,FMASK_TEST);
 #endif
 }
 
-// enqueue this instruction, if later an instruction is encountered that
-// destroys all condition flags and the flags weren't needed in-between
-// this function can be replaced by a simpler one as well
-static void InvalidateFlagsPartially(void* current_simple_function,Bitu flags_type) {
+// enqueue this instruction, if later instructions are encountered that
+// destroy all the flags it generates and the flags weren't needed
+// in-between this function can be replaced by a simpler one as well;
+// the flags in 'flags_written' are destroyed by the current instruction
+static void InvalidateFlagsPartially([[maybe_unused]] void* current_simple_function,
+                                     [[maybe_unused]] Bitu flags_type,
+                                     [[maybe_unused]] Bitu flags_written = 0,
+                                     [[maybe_unused]] Bitu flags_generated = FMASK_TEST) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions[mf_functions_num].pos=cache.pos;
-	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
-	mf_functions[mf_functions_num].ftype=flags_type;
-	++mf_functions_num;
+	KillFlags(flags_written);
+	QueueFlagsFunction(current_simple_function,cache.pos,flags_type,flags_generated);
 #endif
 }
 
 // enqueue this instruction, if later an instruction is encountered that
 // destroys all condition flags and the flags weren't needed in-between
 // this function can be replaced by a simpler one as well
-static void InvalidateFlagsPartially(void* current_simple_function,const uint8_t* cpos,Bitu flags_type) {
+static void InvalidateFlagsPartially([[maybe_unused]] void* current_simple_function,
+                                     [[maybe_unused]] const uint8_t* cpos,
+                                     [[maybe_unused]] Bitu flags_type) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions[mf_functions_num].pos=cpos;
-	mf_functions[mf_functions_num].fct_ptr=current_simple_function;
-	mf_functions[mf_functions_num].ftype=flags_type;
-	++mf_functions_num;
+	QueueFlagsFunction(current_simple_function,cpos,flags_type,FMASK_TEST);
 #endif
 }
 
-// the current function needs the condition flags thus reset the queue
+// the current function needs the condition flags in 'flags_mask', thus
+// the queued functions generating any of them have to stay as they are
 static void AcquireFlags([[maybe_unused]] Bitu flags_mask) {
 #ifdef DRC_FLAGS_INVALIDATION
-	mf_functions_num=0;
+	Bitu num_kept=0;
+	for (Bitu ct=0; ct<mf_functions_num; ct++) {
+		if (!(mf_functions[ct].flags_pending & flags_mask)) {
+			mf_functions[num_kept++]=mf_functions[ct];
+		}
+	}
+	mf_functions_num=num_kept;
 #endif
 }
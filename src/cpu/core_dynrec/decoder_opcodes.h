@@ -448,6 +448,7 @@ static void dyn_pop_ev(void) {
 		MOV_REG_WORD32_FROM_HOST_REG(FC_OP2,DRC_REG_ESP);
 		dyn_check_exception(FC_RETOP);
 		gen_fill_branch(no_fault);
+		dyn_forget_known_regs();
 	} else {
 		if (decode.big_op) gen_call_function_raw((void*)&dynrec_pop_dword);
 		else gen_call_function_raw((void*)&dynrec_pop_word);
@@ -987,7 +988,8 @@ static bool dyn_grp7(void) {
 			case 0x07:	// INVLPG
 //				if (cpu.pmode && cpu.cpl) EXCEPTION(EXCEPTION_GP);
 				if (cpu.pmode && cpu.cpl) IllegalOptionDynrec("invlpg nonpriviledged");
-				gen_call_function_raw((void*)PAGING_ClearTLB);
+				dyn_fill_ea(FC_ADDR);
+				gen_call_function_R((void*)PAGING_InvalidatePage,FC_ADDR);
 				break;
 			default: IllegalOptionDynrec("dyn_grp7_1");
 		}
@@ -1029,6 +1031,7 @@ static void dyn_larlsl(bool is_lar) {
 	gen_mov_word_to_reg(FC_OP2,&core_dynrec.readdata,true);
 	MOV_REG_WORD_FROM_HOST_REG(FC_OP2,decode.modrm.reg,decode.big_op);
 	gen_fill_branch(brnz);
+	dyn_forget_known_regs();
 }
 */
 
@@ -1078,6 +1081,8 @@ static void dyn_cwd(void) {
 
 static void dyn_sahf(void) {
 	MOV_REG_WORD16_TO_HOST_REG(FC_OP1,DRC_REG_EAX);
+	// AH doesn't hold the overflow flag, so it's kept from before
+	AcquireFlags(FLAG_OF);
 	gen_call_function_raw((void *)&dynrec_sahf);
 	InvalidateFlags();
 }
@@ -1093,15 +1098,17 @@ static void dyn_exit_link(Bits eip_change) {
 
 static void dyn_branched_exit(BranchTypes btype,int32_t eip_add) {
 	Bitu eip_base=decode.code-decode.code_start;
+	const auto flags_type=dyn_take_host_flags();
 	dyn_reduce_cycles();
 
-	dyn_branchflag_to_reg(btype);
+	dyn_branchflag_to_reg(btype,flags_type);
 	const uint8_t* data=gen_create_branch_on_nonzero(FC_RETOP,true);
 
  	// Branch not taken
 	gen_add_direct_word(&reg_eip,eip_base,decode.big_op);
 	gen_jmp_ptr(&decode.block->link[0].to, offsetof(CacheBlock, cache.start));
 	gen_fill_branch(data);
+	dyn_forget_known_regs();
 
  	// Branch taken
 	gen_add_direct_word(&reg_eip,eip_base+eip_add,decode.big_op);
@@ -1160,12 +1167,14 @@ static void dyn_loop(LoopTypes type) {
 	gen_jmp_ptr(&decode.block->link[0].to, offsetof(CacheBlock, cache.start));
 	if (branch1) {
 		gen_fill_branch(branch1);
+		dyn_forget_known_regs();
 		MOV_REG_WORD_TO_HOST_REG(FC_OP1,DRC_REG_ECX,decode.big_addr);
 		gen_add_imm(FC_OP1,(uint32_t)(-1));
 		MOV_REG_WORD_FROM_HOST_REG(FC_OP1,DRC_REG_ECX,decode.big_addr);
 	}
 	// Branch taken
 	gen_fill_branch(branch2);
+	dyn_forget_known_regs();
 	gen_add_direct_word(&reg_eip,eip_base,decode.big_op);
 	gen_jmp_ptr(&decode.block->link[1].to, offsetof(CacheBlock, cache.start));
 	dyn_closeblock();
@@ -1298,6 +1307,7 @@ static void dyn_string(STRING_OP op) {
 	if (op<R_SCASB) {
 		// those string operations are allowed for premature termination
 		// when not enough cycles left
+		AcquireFlags(FMASK_TEST);
 		if (!decode.big_addr) gen_extend_word(false,FC_RETOP);
 		save_info_dynrec[used_save_info_dynrec].branch_pos=gen_create_branch_long_nonzero(FC_RETOP,true);
 		save_info_dynrec[used_save_info_dynrec].eip_change=decode.op_start-decode.code_start;
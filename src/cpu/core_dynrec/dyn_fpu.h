@@ -33,6 +33,29 @@ static void FPU_FFREE(Bitu st) {
 		#include "fpu/fpu_instructions.h"
 	#endif
 
+// Pops the stack after running the given instruction, so the translated
+// code of the popping forms makes a single call rather than two
+template <void (*Op)(Bitu, Bitu)>
+static void dyn_fpu_op_pop(Bitu st, Bitu other)
+{
+	Op(st, other);
+	FPU_FPOP();
+}
+
+template <void (*Op)(Bitu)>
+static void dyn_fpu_reg_pop(Bitu st)
+{
+	Op(st);
+	FPU_FPOP();
+}
+
+template <void (*Op)(PhysPt)>
+static void dyn_fpu_store_pop(PhysPt addr)
+{
+	Op(addr);
+	FPU_FPOP();
+}
+
 static inline void dyn_fpu_top() {
 	gen_mov_word_to_reg(FC_OP2,(void*)(&TOP),true);
 	gen_add_imm(FC_OP2,decode.modrm.rm);
@@ -61,8 +84,7 @@ static void dyn_eatree() {
 		gen_call_function_R((void*)&FPU_FCOM_EA,FC_OP1);
 		break;
 	case 0x03:		// FCOMP STi
-		gen_call_function_R((void*)&FPU_FCOM_EA,FC_OP1);
-		gen_call_function_raw((void*)&FPU_FPOP);
+		gen_call_function_R((void*)&dyn_fpu_reg_pop<FPU_FCOM_EA>,FC_OP1);
 		break;
 	case 0x04:		// FSUB  ST,STi
 		gen_call_function_R((void*)&FPU_FSUB_EA,FC_OP1);
@@ -97,8 +119,7 @@ static void dyn_fpu_esc0(){
 			gen_call_function_RR((void*)&FPU_FCOM,FC_OP1,FC_OP2);
 			break;
 		case 0x03:		// FCOMP STi
-			gen_call_function_RR((void*)&FPU_FCOM,FC_OP1,FC_OP2);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FCOM>,FC_OP1,FC_OP2);
 			break;
 		case 0x04:		// FSUB  ST,STi
 			gen_call_function_RR((void*)&FPU_FSUB,FC_OP1,FC_OP2);
@@ -148,8 +169,7 @@ static void dyn_fpu_esc1(){
 			break;
 		case 0x03: /* FSTP STi */
 			dyn_fpu_top();
-			gen_call_function_RR((void*)&FPU_FST,FC_OP1,FC_OP2);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FST>,FC_OP1,FC_OP2);
 			break;   
 		case 0x04:
 			switch(decode.modrm.rm){
@@ -286,8 +306,7 @@ static void dyn_fpu_esc1(){
 			break;
 		case 0x03: /* FSTP float*/
 			dyn_fill_ea(FC_ADDR);
-			gen_call_function_R((void*)&FPU_FST_F32,FC_ADDR);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_R((void*)&dyn_fpu_store_pop<FPU_FST_F32>,FC_ADDR);
 			break;
 		case 0x04: /* FLDENV */
 			dyn_fill_ea(FC_ADDR);
@@ -324,8 +343,7 @@ static void dyn_fpu_esc2(){
 				gen_add_imm(FC_OP2,1);
 				gen_and_imm(FC_OP2,7);
 				gen_mov_word_to_reg(FC_OP1,(void*)(&TOP),true);
-				gen_call_function_RR((void *)&FPU_FUCOM,FC_OP1,FC_OP2);
-				gen_call_function_raw((void *)&FPU_FPOP);
+				gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FUCOM>,FC_OP1,FC_OP2);
 				gen_call_function_raw((void *)&FPU_FPOP);
 				break;
 			default:
@@ -394,8 +412,7 @@ static void dyn_fpu_esc3()
 			break;
 		case 0x03:	/* FISTP */
 			dyn_fill_ea(FC_ADDR); 
-			gen_call_function_R((void*)&FPU_FST_I32,FC_ADDR);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_R((void*)&dyn_fpu_store_pop<FPU_FST_I32>,FC_ADDR);
 			break;
 		case 0x05:	/* FLD 80 Bits Real */
 			gen_call_function_raw((void*)&FPU_PREP_PUSH);
@@ -404,8 +421,7 @@ static void dyn_fpu_esc3()
 			break;
 		case 0x07:	/* FSTP 80 Bits Real */
 			dyn_fill_ea(FC_ADDR); 
-			gen_call_function_R((void*)&FPU_FST_F80,FC_ADDR);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_R((void*)&dyn_fpu_store_pop<FPU_FST_F80>,FC_ADDR);
 			break;
 		default:
 			FPU_LOG_WARN(3, true, decode.modrm.reg, decode.modrm.rm);
@@ -432,8 +448,7 @@ static void dyn_fpu_esc4(){
 			break;
 		case 0x03:  /* FCOMP*/
 			dyn_fpu_top();
-			gen_call_function_RR((void*)&FPU_FCOM,FC_OP1,FC_OP2);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FCOM>,FC_OP1,FC_OP2);
 			break;
 		case 0x04:  /* FSUBR STi,ST*/
 			dyn_fpu_top_swapped();
@@ -478,15 +493,13 @@ static void dyn_fpu_esc5(){
 			gen_call_function_RR((void*)&FPU_FST,FC_OP1,FC_OP2);
 			break;
 		case 0x03:  /* FSTP STi*/
-			gen_call_function_RR((void*)&FPU_FST,FC_OP1,FC_OP2);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FST>,FC_OP1,FC_OP2);
 			break;
 		case 0x04:	/* FUCOM STi */
 			gen_call_function_RR((void*)&FPU_FUCOM,FC_OP1,FC_OP2);
 			break;
 		case 0x05:	/*FUCOMP STi */
-			gen_call_function_RR((void*)&FPU_FUCOM,FC_OP1,FC_OP2);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FUCOM>,FC_OP1,FC_OP2);
 			break;
 		default:
 			LOG(LOG_FPU,LOG_WARN)("ESC 5:Unhandled group %X subfunction %X",static_cast<uint32_t>(decode.modrm.reg),static_cast<uint32_t>(decode.modrm.rm));
@@ -509,8 +522,7 @@ static void dyn_fpu_esc5(){
 			break;
 		case 0x03:	/* FSTP double real*/
 			dyn_fill_ea(FC_ADDR); 
-			gen_call_function_R((void*)&FPU_FST_F64,FC_ADDR);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_R((void*)&dyn_fpu_store_pop<FPU_FST_F64>,FC_ADDR);
 			break;
 		case 0x04:	/* FRSTOR */
 			dyn_fill_ea(FC_ADDR); 
@@ -540,15 +552,15 @@ static void dyn_fpu_esc6(){
 		switch(decode.modrm.reg){
 		case 0x00:	/*FADDP STi,ST*/
 			dyn_fpu_top_swapped();
-			gen_call_function_RR((void*)&FPU_FADD,FC_OP1,FC_OP2);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FADD>,FC_OP1,FC_OP2);
 			break;
 		case 0x01:	/* FMULP STi,ST*/
 			dyn_fpu_top_swapped();
-			gen_call_function_RR((void*)&FPU_FMUL,FC_OP1,FC_OP2);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FMUL>,FC_OP1,FC_OP2);
 			break;
 		case 0x02:  /* FCOMP5*/
 			dyn_fpu_top();
-			gen_call_function_RR((void*)&FPU_FCOM,FC_OP1,FC_OP2);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FCOM>,FC_OP1,FC_OP2);
 			break;	/* TODO IS THIS ALLRIGHT ????????? */
 		case 0x03:  /*FCOMPP*/
 			if(decode.modrm.rm != 1) {
@@ -559,29 +571,28 @@ static void dyn_fpu_esc6(){
 			gen_add_imm(FC_OP2,1);
 			gen_and_imm(FC_OP2,7);
 			gen_mov_word_to_reg(FC_OP1,(void*)(&TOP),true);
-			gen_call_function_RR((void*)&FPU_FCOM,FC_OP1,FC_OP2);
-			gen_call_function_raw((void*)&FPU_FPOP); /* extra pop at the bottom*/
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FCOM>,FC_OP1,FC_OP2);
+			gen_call_function_raw((void*)&FPU_FPOP);
 			break;
 		case 0x04:  /* FSUBRP STi,ST*/
 			dyn_fpu_top_swapped();
-			gen_call_function_RR((void*)&FPU_FSUBR,FC_OP1,FC_OP2);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FSUBR>,FC_OP1,FC_OP2);
 			break;
 		case 0x05:  /* FSUBP  STi,ST*/
 			dyn_fpu_top_swapped();
-			gen_call_function_RR((void*)&FPU_FSUB,FC_OP1,FC_OP2);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FSUB>,FC_OP1,FC_OP2);
 			break;
 		case 0x06:	/* FDIVRP STi,ST*/
 			dyn_fpu_top_swapped();
-			gen_call_function_RR((void*)&FPU_FDIVR,FC_OP1,FC_OP2);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FDIVR>,FC_OP1,FC_OP2);
 			break;
 		case 0x07:  /* FDIVP STi,ST*/
 			dyn_fpu_top_swapped();
-			gen_call_function_RR((void*)&FPU_FDIV,FC_OP1,FC_OP2);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FDIV>,FC_OP1,FC_OP2);
 			break;
 		default:
 			break;
 		}
-		gen_call_function_raw((void*)&FPU_FPOP);		
 	} else {
 		dyn_fill_ea(FC_ADDR);
 		gen_call_function_R((void*)&FPU_FLD_I16_EA,FC_ADDR); 
@@ -597,8 +608,7 @@ static void dyn_fpu_esc7(){
 		switch (decode.modrm.reg){
 		case 0x00: /* FFREEP STi */
 			dyn_fpu_top();
-			gen_call_function_R((void*)&FPU_FFREE,FC_OP2);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_R((void*)&dyn_fpu_reg_pop<FPU_FFREE>,FC_OP2);
 			break;
 		case 0x01: /* FXCH STi*/
 			dyn_fpu_top();
@@ -607,8 +617,7 @@ static void dyn_fpu_esc7(){
 		case 0x02:  /* FSTP STi*/
 		case 0x03:  /* FSTP STi*/
 			dyn_fpu_top();
-			gen_call_function_RR((void*)&FPU_FST,FC_OP1,FC_OP2);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_RR((void*)&dyn_fpu_op_pop<FPU_FST>,FC_OP1,FC_OP2);
 			break;
 		case 0x04:
 			switch(decode.modrm.rm){
@@ -644,8 +653,7 @@ static void dyn_fpu_esc7(){
 			break;
 		case 0x03:	/* FISTP int16_t */
 			dyn_fill_ea(FC_ADDR); 
-			gen_call_function_R((void*)&FPU_FST_I16,FC_ADDR);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_R((void*)&dyn_fpu_store_pop<FPU_FST_I16>,FC_ADDR);
 			break;
 		case 0x04:   /* FBLD packed BCD */
 			gen_call_function_raw((void*)&FPU_PREP_PUSH);
@@ -661,13 +669,11 @@ static void dyn_fpu_esc7(){
 			break;
 		case 0x06:	/* FBSTP packed BCD */
 			dyn_fill_ea(FC_ADDR); 
-			gen_call_function_R((void*)&FPU_FBST,FC_ADDR);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_R((void*)&dyn_fpu_store_pop<FPU_FBST>,FC_ADDR);
 			break;
 		case 0x07:  /* FISTP int64_t */
 			dyn_fill_ea(FC_ADDR); 
-			gen_call_function_R((void*)&FPU_FST_I64,FC_ADDR);
-			gen_call_function_raw((void*)&FPU_FPOP);
+			gen_call_function_R((void*)&dyn_fpu_store_pop<FPU_FST_I64>,FC_ADDR);
 			break;
 		default:
 			LOG(LOG_FPU,LOG_WARN)("ESC 7 EA:Unhandled group %X subfunction %X",static_cast<uint32_t>(decode.modrm.reg),static_cast<uint32_t>(decode.modrm.rm));
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "cpu/flags.h"
+#include "cpu/string_bulk.h"
 #include "utils/math_utils.h"
 
 static uint8_t DRC_CALL_CONV dynrec_add_byte(uint8_t op1,uint8_t op2) DRC_FC;
@@ -385,7 +386,7 @@ static void dyn_dop_byte_gencall(DualOps op) {
 			break;
 		case DOP_ADC:
 			AcquireFlags(FLAG_CF);
-			InvalidateFlagsPartially((void*)&dynrec_adc_byte_simple,t_ADCb);
+			InvalidateFlags((void*)&dynrec_adc_byte_simple,t_ADCb);
 			gen_call_function_raw((void*)&dynrec_adc_byte);
 			break;
 		case DOP_SUB:
@@ -394,7 +395,7 @@ static void dyn_dop_byte_gencall(DualOps op) {
 			break;
 		case DOP_SBB:
 			AcquireFlags(FLAG_CF);
-			InvalidateFlagsPartially((void*)&dynrec_sbb_byte_simple,t_SBBb);
+			InvalidateFlags((void*)&dynrec_sbb_byte_simple,t_SBBb);
 			gen_call_function_raw((void*)&dynrec_sbb_byte);
 			break;
 		case DOP_CMP:
@@ -421,6 +422,39 @@ static void dyn_dop_byte_gencall(DualOps op) {
 	}
 }
 
+#ifdef DRC_USE_HOST_FLAGS
+
+// The last 32bit compare or test, if nothing has been emitted since
+static struct {
+	const uint8_t* pos = nullptr;
+	Bitu flags_type    = t_UNKNOWN;
+} dyn_host_flags = {};
+
+static void dyn_note_host_flags(Bitu flags_type) {
+	dyn_host_flags.pos        = cache.pos;
+	dyn_host_flags.flags_type = flags_type;
+}
+
+// Returns the type of the compare or test that directly precedes the
+// current position, or t_UNKNOWN
+static Bitu dyn_take_host_flags(void) {
+	const auto flags_type = (dyn_host_flags.pos == cache.pos)
+	                              ? dyn_host_flags.flags_type
+	                              : static_cast<Bitu>(t_UNKNOWN);
+	dyn_host_flags.pos = nullptr;
+	return flags_type;
+}
+
+#else
+
+static void dyn_note_host_flags(Bitu) {}
+
+static Bitu dyn_take_host_flags(void) {
+	return t_UNKNOWN;
+}
+
+#endif
+
 static void dyn_dop_word_gencall(DualOps op,bool dword) {
 	if (dword) {
 		switch (op) {
@@ -430,7 +464,7 @@ static void dyn_dop_word_gencall(DualOps op,bool dword) {
 				break;
 			case DOP_ADC:
 				AcquireFlags(FLAG_CF);
-				InvalidateFlagsPartially((void*)&dynrec_adc_dword_simple,t_ADCd);
+				InvalidateFlags((void*)&dynrec_adc_dword_simple,t_ADCd);
 				gen_call_function_raw((void*)&dynrec_adc_dword);
 				break;
 			case DOP_SUB:
@@ -439,12 +473,13 @@ static void dyn_dop_word_gencall(DualOps op,bool dword) {
 				break;
 			case DOP_SBB:
 				AcquireFlags(FLAG_CF);
-				InvalidateFlagsPartially((void*)&dynrec_sbb_dword_simple,t_SBBd);
+				InvalidateFlags((void*)&dynrec_sbb_dword_simple,t_SBBd);
 				gen_call_function_raw((void*)&dynrec_sbb_dword);
 				break;
 			case DOP_CMP:
 				InvalidateFlags((void*)&dynrec_cmp_dword_simple,t_CMPd);
 				gen_call_function_raw((void*)&dynrec_cmp_dword);
+				dyn_note_host_flags(t_CMPd);
 				break;
 			case DOP_XOR:
 				InvalidateFlags((void*)&dynrec_xor_dword_simple,t_XORd);
@@ -461,6 +496,7 @@ static void dyn_dop_word_gencall(DualOps op,bool dword) {
 			case DOP_TEST:
 				InvalidateFlags((void*)&dynrec_test_dword_simple,t_TESTd);
 				gen_call_function_raw((void*)&dynrec_test_dword);
+				dyn_note_host_flags(t_TESTd);
 				break;
 			default: IllegalOptionDynrec("dyn_dop_dword_gencall");
 		}
@@ -472,7 +508,7 @@ static void dyn_dop_word_gencall(DualOps op,bool dword) {
 				break;
 			case DOP_ADC:
 				AcquireFlags(FLAG_CF);
-				InvalidateFlagsPartially((void*)&dynrec_adc_word_simple,t_ADCw);
+				InvalidateFlags((void*)&dynrec_adc_word_simple,t_ADCw);
 				gen_call_function_raw((void*)&dynrec_adc_word);
 				break;
 			case DOP_SUB:
@@ -481,7 +517,7 @@ static void dyn_dop_word_gencall(DualOps op,bool dword) {
 				break;
 			case DOP_SBB:
 				AcquireFlags(FLAG_CF);
-				InvalidateFlagsPartially((void*)&dynrec_sbb_word_simple,t_SBBw);
+				InvalidateFlags((void*)&dynrec_sbb_word_simple,t_SBBw);
 				gen_call_function_raw((void*)&dynrec_sbb_word);
 				break;
 			case DOP_CMP:
@@ -652,11 +688,11 @@ static uint32_t DRC_CALL_CONV dynrec_neg_dword_simple(uint32_t op) {
 static void dyn_sop_byte_gencall(SingleOps op) {
 	switch (op) {
 		case SOP_INC:
-			InvalidateFlagsPartially((void*)&dynrec_inc_byte_simple,t_INCb);
+			InvalidateFlagsPartially((void*)&dynrec_inc_byte_simple,t_INCb,FMASK_INCDEC,FMASK_INCDEC);
 			gen_call_function_raw((void*)&dynrec_inc_byte);
 			break;
 		case SOP_DEC:
-			InvalidateFlagsPartially((void*)&dynrec_dec_byte_simple,t_DECb);
+			InvalidateFlagsPartially((void*)&dynrec_dec_byte_simple,t_DECb,FMASK_INCDEC,FMASK_INCDEC);
 			gen_call_function_raw((void*)&dynrec_dec_byte);
 			break;
 		case SOP_NOT:
@@ -674,11 +710,11 @@ static void dyn_sop_word_gencall(SingleOps op,bool dword) {
 	if (dword) {
 		switch (op) {
 			case SOP_INC:
-				InvalidateFlagsPartially((void*)&dynrec_inc_dword_simple,t_INCd);
+				InvalidateFlagsPartially((void*)&dynrec_inc_dword_simple,t_INCd,FMASK_INCDEC,FMASK_INCDEC);
 				gen_call_function_raw((void*)&dynrec_inc_dword);
 				break;
 			case SOP_DEC:
-				InvalidateFlagsPartially((void*)&dynrec_dec_dword_simple,t_DECd);
+				InvalidateFlagsPartially((void*)&dynrec_dec_dword_simple,t_DECd,FMASK_INCDEC,FMASK_INCDEC);
 				gen_call_function_raw((void*)&dynrec_dec_dword);
 				break;
 			case SOP_NOT:
@@ -693,11 +729,11 @@ static void dyn_sop_word_gencall(SingleOps op,bool dword) {
 	} else {
 		switch (op) {
 			case SOP_INC:
-				InvalidateFlagsPartially((void*)&dynrec_inc_word_simple,t_INCw);
+				InvalidateFlagsPartially((void*)&dynrec_inc_word_simple,t_INCw,FMASK_INCDEC,FMASK_INCDEC);
 				gen_call_function_raw((void*)&dynrec_inc_word);
 				break;
 			case SOP_DEC:
-				InvalidateFlagsPartially((void*)&dynrec_dec_word_simple,t_DECw);
+				InvalidateFlagsPartially((void*)&dynrec_dec_word_simple,t_DECw,FMASK_INCDEC,FMASK_INCDEC);
 				gen_call_function_raw((void*)&dynrec_dec_word);
 				break;
 			case SOP_NOT:
@@ -1101,11 +1137,11 @@ static uint32_t DRC_CALL_CONV dynrec_sar_dword_simple(uint32_t op1,uint8_t op2)
 static void dyn_shift_byte_gencall(ShiftOps op) {
 	switch (op) {
 		case SHIFT_ROL:
-			InvalidateFlagsPartially((void*)&dynrec_rol_byte_simple,t_ROLb);
+			InvalidateFlagsPartially((void*)&dynrec_rol_byte_simple,t_ROLb,0,FMASK_ROTATE);
 			gen_call_function_raw((void*)&dynrec_rol_byte);
 			break;
 		case SHIFT_ROR:
-			InvalidateFlagsPartially((void*)&dynrec_ror_byte_simple,t_RORb);
+			InvalidateFlagsPartially((void*)&dynrec_ror_byte_simple,t_RORb,0,FMASK_ROTATE);
 			gen_call_function_raw((void*)&dynrec_ror_byte);
 			break;
 		case SHIFT_RCL:
@@ -1137,11 +1173,11 @@ static void dyn_shift_word_gencall(ShiftOps op,bool dword) {
 	if (dword) {
 		switch (op) {
 			case SHIFT_ROL:
-				InvalidateFlagsPartially((void*)&dynrec_rol_dword_simple,t_ROLd);
+				InvalidateFlagsPartially((void*)&dynrec_rol_dword_simple,t_ROLd,0,FMASK_ROTATE);
 				gen_call_function_raw((void*)&dynrec_rol_dword);
 				break;
 			case SHIFT_ROR:
-				InvalidateFlagsPartially((void*)&dynrec_ror_dword_simple,t_RORd);
+				InvalidateFlagsPartially((void*)&dynrec_ror_dword_simple,t_RORd,0,FMASK_ROTATE);
 				gen_call_function_raw((void*)&dynrec_ror_dword);
 				break;
 			case SHIFT_RCL:
@@ -1170,11 +1206,11 @@ static void dyn_shift_word_gencall(ShiftOps op,bool dword) {
 	} else {
 		switch (op) {
 			case SHIFT_ROL:
-				InvalidateFlagsPartially((void*)&dynrec_rol_word_simple,t_ROLw);
+				InvalidateFlagsPartially((void*)&dynrec_rol_word_simple,t_ROLw,0,FMASK_ROTATE);
 				gen_call_function_raw((void*)&dynrec_rol_word);
 				break;
 			case SHIFT_ROR:
-				InvalidateFlagsPartially((void*)&dynrec_ror_word_simple,t_RORw);
+				InvalidateFlagsPartially((void*)&dynrec_ror_word_simple,t_RORw,0,FMASK_ROTATE);
 				gen_call_function_raw((void*)&dynrec_ror_word);
 				break;
 			case SHIFT_RCL:
@@ -1340,7 +1376,27 @@ static uint32_t DRC_CALL_CONV dynrec_get_nzf_and_sf_eq_of(void)	DRC_FC;
 static uint32_t DRC_CALL_CONV dynrec_get_nzf_and_sf_eq_of(void)	{ return TFLG_NLE; }
 
 
-static void dyn_branchflag_to_reg(BranchTypes btype) {
+// flags_type gives the instruction that set the lazy flags if it is known
+// at translation time; the conditions of 32bit compares and tests are then
+// evaluated by the host with the operands or the result they left behind
+static void dyn_branchflag_to_reg(BranchTypes btype,
+                                  [[maybe_unused]] Bitu flags_type = t_UNKNOWN) {
+#ifdef DRC_USE_HOST_FLAGS
+	const bool has_host_flag = (btype != BR_P) && (btype != BR_NP);
+	if (has_host_flag && flags_type == t_CMPd) {
+		gen_mov_word_to_reg(FC_OP1,(void*)&lf_var1d,true);
+		gen_mov_word_to_reg(FC_OP2,(void*)&lf_var2d,true);
+		gen_set_reg_on_compare(FC_RETOP,FC_OP1,FC_OP2,btype);
+		return;
+	}
+	if (has_host_flag && flags_type == t_TESTd) {
+		// like a compare of the result against zero: no carry or overflow
+		gen_mov_word_to_reg(FC_OP1,(void*)&lf_resd,true);
+		gen_mov_dword_to_reg_imm(FC_OP2,0);
+		gen_set_reg_on_compare(FC_RETOP,FC_OP1,FC_OP2,btype);
+		return;
+	}
+#endif
 	switch (btype) {
 		case BR_O:gen_call_function_raw((void*)&dynrec_get_of);break;
 		case BR_NO:gen_call_function_raw((void*)&dynrec_get_nof);break;
@@ -1643,11 +1699,14 @@ static uint16_t DRC_CALL_CONV dynrec_movsb_word(uint16_t count,int16_t add_index
 		count=(uint16_t)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		mem_writeb(di_base+reg_di,mem_readb(si_base+reg_si));
-		reg_si+=add_index;
-		reg_di+=add_index;
-	}
+	uint32_t si_index = reg_si;
+	uint32_t di_index = reg_di;
+	STRING_RepMove(si_base, si_index, di_base, di_index, 0xffff, add_index, count,
+	               [](const PhysPt src, const PhysPt dst) {
+		               mem_writeb(dst, mem_readb(src));
+	               });
+	reg_si = static_cast<uint16_t>(si_index);
+	reg_di = static_cast<uint16_t>(di_index);
 	return count_left;
 }
 
@@ -1661,11 +1720,14 @@ static uint32_t DRC_CALL_CONV dynrec_movsb_dword(uint32_t count,int32_t add_inde
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		mem_writeb(di_base+reg_edi,mem_readb(si_base+reg_esi));
-		reg_esi+=add_index;
-		reg_edi+=add_index;
-	}
+	uint32_t si_index = reg_esi;
+	uint32_t di_index = reg_edi;
+	STRING_RepMove(si_base, si_index, di_base, di_index, 0xffffffff, add_index, count,
+	               [](const PhysPt src, const PhysPt dst) {
+		               mem_writeb(dst, mem_readb(src));
+	               });
+	reg_esi = static_cast<uint32_t>(si_index);
+	reg_edi = static_cast<uint32_t>(di_index);
 	return count_left;
 }
 
@@ -1680,11 +1742,14 @@ static uint16_t DRC_CALL_CONV dynrec_movsw_word(uint16_t count,int16_t add_index
 		CPU_Cycles=0;
 	}
 	add_index<<=1;
-	for (;count>0;count--) {
-		mem_writew(di_base+reg_di,mem_readw(si_base+reg_si));
-		reg_si+=add_index;
-		reg_di+=add_index;
-	}
+	uint32_t si_index = reg_si;
+	uint32_t di_index = reg_di;
+	STRING_RepMove(si_base, si_index, di_base, di_index, 0xffff, add_index, count,
+	               [](const PhysPt src, const PhysPt dst) {
+		               mem_writew(dst, mem_readw(src));
+	               });
+	reg_si = static_cast<uint16_t>(si_index);
+	reg_di = static_cast<uint16_t>(di_index);
 	return count_left;
 }
 
@@ -1699,11 +1764,14 @@ static uint32_t DRC_CALL_CONV dynrec_movsw_dword(uint32_t count,int32_t add_inde
 		CPU_Cycles=0;
 	}
 	add_index = left_shift_signed(add_index, 1);
-	for (;count>0;count--) {
-		mem_writew(di_base+reg_edi,mem_readw(si_base+reg_esi));
-		reg_esi+=add_index;
-		reg_edi+=add_index;
-	}
+	uint32_t si_index = reg_esi;
+	uint32_t di_index = reg_edi;
+	STRING_RepMove(si_base, si_index, di_base, di_index, 0xffffffff, add_index, count,
+	               [](const PhysPt src, const PhysPt dst) {
+		               mem_writew(dst, mem_readw(src));
+	               });
+	reg_esi = static_cast<uint32_t>(si_index);
+	reg_edi = static_cast<uint32_t>(di_index);
 	return count_left;
 }
 
@@ -1718,11 +1786,14 @@ static uint16_t DRC_CALL_CONV dynrec_movsd_word(uint16_t count,int16_t add_index
 		CPU_Cycles=0;
 	}
 	add_index = left_shift_signed(add_index, 2);
-	for (;count>0;count--) {
-		mem_writed(di_base+reg_di,mem_readd(si_base+reg_si));
-		reg_si+=add_index;
-		reg_di+=add_index;
-	}
+	uint32_t si_index = reg_si;
+	uint32_t di_index = reg_di;
+	STRING_RepMove(si_base, si_index, di_base, di_index, 0xffff, add_index, count,
+	               [](const PhysPt src, const PhysPt dst) {
+		               mem_writed(dst, mem_readd(src));
+	               });
+	reg_si = static_cast<uint16_t>(si_index);
+	reg_di = static_cast<uint16_t>(di_index);
 	return count_left;
 }
 
@@ -1737,11 +1808,14 @@ static uint32_t DRC_CALL_CONV dynrec_movsd_dword(uint32_t count,int32_t add_inde
 		CPU_Cycles=0;
 	}
 	add_index = left_shift_signed(add_index, 2);
-	for (;count>0;count--) {
-		mem_writed(di_base+reg_edi,mem_readd(si_base+reg_esi));
-		reg_esi+=add_index;
-		reg_edi+=add_index;
-	}
+	uint32_t si_index = reg_esi;
+	uint32_t di_index = reg_edi;
+	STRING_RepMove(si_base, si_index, di_base, di_index, 0xffffffff, add_index, count,
+	               [](const PhysPt src, const PhysPt dst) {
+		               mem_writed(dst, mem_readd(src));
+	               });
+	reg_esi = static_cast<uint32_t>(si_index);
+	reg_edi = static_cast<uint32_t>(di_index);
 	return count_left;
 }
 
@@ -1863,10 +1937,12 @@ static uint16_t DRC_CALL_CONV dynrec_stosb_word(uint16_t count,int16_t add_index
 		count=(uint16_t)CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		mem_writeb(di_base+reg_di,reg_al);
-		reg_di+=add_index;
-	}
+	uint32_t di_index = reg_di;
+	STRING_RepStore(di_base, di_index, 0xffff, add_index, count, reg_al,
+	                [](const PhysPt dst, const uint8_t val) {
+		                mem_writeb(dst, val);
+	                });
+	reg_di = static_cast<uint16_t>(di_index);
 	return count_left;
 }
 
@@ -1880,10 +1956,12 @@ static uint32_t DRC_CALL_CONV dynrec_stosb_dword(uint32_t count,int32_t add_inde
 		count=CPU_Cycles;
 		CPU_Cycles=0;
 	}
-	for (;count>0;count--) {
-		mem_writeb(di_base+reg_edi,reg_al);
-		reg_edi+=add_index;
-	}
+	uint32_t di_index = reg_edi;
+	STRING_RepStore(di_base, di_index, 0xffffffff, add_index, count, reg_al,
+	                [](const PhysPt dst, const uint8_t val) {
+		                mem_writeb(dst, val);
+	                });
+	reg_edi = static_cast<uint32_t>(di_index);
 	return count_left;
 }
 
@@ -1898,10 +1976,12 @@ static uint16_t DRC_CALL_CONV dynrec_stosw_word(uint16_t count,int16_t add_index
 		CPU_Cycles=0;
 	}
 	add_index = left_shift_signed(add_index, 1);
-	for (;count>0;count--) {
-		mem_writew(di_base+reg_di,reg_ax);
-		reg_di+=add_index;
-	}
+	uint32_t di_index = reg_di;
+	STRING_RepStore(di_base, di_index, 0xffff, add_index, count, reg_ax,
+	                [](const PhysPt dst, const uint16_t val) {
+		                mem_writew(dst, val);
+	                });
+	reg_di = static_cast<uint16_t>(di_index);
 	return count_left;
 }
 
@@ -1916,10 +1996,12 @@ static uint32_t DRC_CALL_CONV dynrec_stosw_dword(uint32_t count,int32_t add_inde
 		CPU_Cycles=0;
 	}
 	add_index = left_shift_signed(add_index, 1);
-	for (;count>0;count--) {
-		mem_writew(di_base+reg_edi,reg_ax);
-		reg_edi+=add_index;
-	}
+	uint32_t di_index = reg_edi;
+	STRING_RepStore(di_base, di_index, 0xffffffff, add_index, count, reg_ax,
+	                [](const PhysPt dst, const uint16_t val) {
+		                mem_writew(dst, val);
+	                });
+	reg_edi = static_cast<uint32_t>(di_index);
 	return count_left;
 }
 
@@ -1934,10 +2016,12 @@ static uint16_t DRC_CALL_CONV dynrec_stosd_word(uint16_t count,int16_t add_index
 		CPU_Cycles=0;
 	}
 	add_index = left_shift_signed(add_index, 2);
-	for (;count>0;count--) {
-		mem_writed(di_base+reg_di,reg_eax);
-		reg_di+=add_index;
-	}
+	uint32_t di_index = reg_di;
+	STRING_RepStore(di_base, di_index, 0xffff, add_index, count, reg_eax,
+	                [](const PhysPt dst, const uint32_t val) {
+		                mem_writed(dst, val);
+	                });
+	reg_di = static_cast<uint16_t>(di_index);
 	return count_left;
 }
 
@@ -1952,10 +2036,12 @@ static uint32_t DRC_CALL_CONV dynrec_stosd_dword(uint32_t count,int32_t add_inde
 		CPU_Cycles=0;
 	}
 	add_index = left_shift_signed(add_index, 2);
-	for (;count>0;count--) {
-		mem_writed(di_base+reg_edi,reg_eax);
-		reg_edi+=add_index;
-	}
+	uint32_t di_index = reg_edi;
+	STRING_RepStore(di_base, di_index, 0xffffffff, add_index, count, reg_eax,
+	                [](const PhysPt dst, const uint32_t val) {
+		                mem_writed(dst, val);
+	                });
+	reg_edi = static_cast<uint32_t>(di_index);
 	return count_left;
 }
 
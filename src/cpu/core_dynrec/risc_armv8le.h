@@ -14,6 +14,11 @@
 // try to replace _simple functions by code
 #define DRC_FLAGS_INVALIDATION_DCODE
 
+// reuse guest registers left in host registers by the preceding loads and stores
+#define DRC_REUSE_LOADED_REGS
+// evaluate branch conditions of compares with host flags instead of helpers
+#define DRC_USE_HOST_FLAGS
+
 // calling convention modifier
 #define DRC_CALL_CONV	/* nothing */
 #define DRC_FC			/* nothing */
@@ -214,10 +219,14 @@ typedef uint8_t HostReg;
 #define SUB_IMM(dst, src, imm, simm) (0x51000000 + (dst) + ((src) << 5) + ((imm) << 10) + ((simm)?0x00400000:0) )
 // sub dst, src1, src2, lsl #imm
 #define SUB_REG_LSL_IMM(dst, src1, src2, imm) (0x4b000000 + (dst) + ((src1) << 5) + ((src2) << 16) + ((imm) << 10) )
+// cmp src1, src2, lsl #imm
+#define CMP_REG_LSL_IMM(src1, src2, imm) (0x6b00001f + ((src1) << 5) + ((src2) << 16) + ((imm) << 10) )
 // cmp src, #(imm lsl simm)		@	0 <= imm <= 4095	&	simm = 0/12
 #define CMP_IMM(src, imm, simm) (0x7100001f + ((src) << 5) + ((imm) << 10) + ((simm)?0x00400000:0) )
 // nop
 #define NOP (0xd503201f)
+// cset dst, cond
+#define CSET(dst, cond) (0x1a9f07e0 + (dst) + (((cond) ^ 1) << 12) )
 
 // logical
 // and dst, src1, src2, lsl #imm		@	0 <= imm <= 31
@@ -850,6 +859,30 @@ static const uint8_t* gen_create_branch_long_leqzero(HostReg reg) {
 	return (cache.pos-4);
 }
 
+// x86 condition codes (the low nibble of Jcc) and the ARM conditions
+// that test them after a "cmp src1, src2"; sign, zero and overflow agree,
+// but ARM sets the carry flag when the subtraction doesn't borrow
+static constexpr int8_t arm_conditions[16] = {
+	0x6, 0x7,	// o: vs	no: vc
+	0x3, 0x2,	// b: lo	nb: hs
+	0x0, 0x1,	// z: eq	nz: ne
+	0x9, 0x8,	// be: ls	nbe: hi
+	0x4, 0x5,	// s: mi	ns: pl
+	-1, -1,		// p, np: no host flag
+	0xb, 0xa,	// l: lt	nl: ge
+	0xd, 0xc,	// le: le	nle: gt
+};
+
+// set dest_reg to 1 if the x86 condition x86_cond holds after comparing
+// the 32bit registers src1 and src2, and to 0 otherwise
+static void gen_set_reg_on_compare(HostReg dest_reg, HostReg src1, HostReg src2,
+                                   Bitu x86_cond) {
+	const auto cond = arm_conditions[x86_cond & 0xf];
+	assert(cond >= 0);
+	cache_addd( CMP_REG_LSL_IMM(src1, src2, 0) );     // cmp src1, src2
+	cache_addd( CSET(dest_reg, cond) );               // cset dest_reg, cond
+}
+
 // calculate long relative offset and fill it into the location pointed to by data
 static void inline gen_fill_branch_long(const uint8_t* data) {
 	// optimize for shorter branches ?
@@ -14,6 +14,9 @@
 // try to replace _simple functions by code
 #define DRC_FLAGS_INVALIDATION_DCODE
 
+// reuse guest registers left in host registers by the preceding loads and stores
+#define DRC_REUSE_LOADED_REGS
+
 // calling convention modifier
 #define DRC_CALL_CONV	/* nothing */
 #define DRC_FC			/* nothing */
@@ -54,6 +54,15 @@ extern Bitu cycle_count;
 
 #define CPU_TRAP_DECODER	CPU_Core_Normal_Trap_Run
 
+// Jump straight to each opcode's handler through a table of label
+// addresses rather than through a switch. Needs the labels-as-values
+// extension, so other compilers always get the switch.
+#if C_CORE_THREADED && (defined(__GNUC__) || defined(__clang__))
+#define CPU_THREADED_DISPATCH 1
+#else
+#define CPU_THREADED_DISPATCH 0
+#endif
+
 #define OPCODE_NONE			0x000
 #define OPCODE_0F			0x100
 #define OPCODE_SIZE			0x200
@@ -132,9 +141,22 @@ static inline uint32_t Fetchd() {
 
 #define EALookupTable (core.ea_table)
 
+#if CPU_THREADED_DISPATCH
+// A handler missing from the table is an unused label and an entry without
+// a handler an undefined one, so a stale table breaks the build
+#pragma GCC diagnostic push
+#pragma GCC diagnostic error "-Wunused-label"
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
 Bits CPU_Core_Normal_Run() noexcept
 {
 	ZoneScoped;
+#if CPU_THREADED_DISPATCH
+	static const void* const dispatch_table[0x400] = {
+#include "core_normal/dispatch_table.h"
+	};
+#endif
 	while (CPU_Cycles-->0) {
 		LOADIP;
 		core.opcode_index=cpu.code.big*0x200;
@@ -153,12 +175,21 @@ Bits CPU_Core_Normal_Run() noexcept
 		cycle_count++;
 #endif
 restart_opcode:
+#if CPU_THREADED_DISPATCH
+		// the switch only gives the handlers' breaks somewhere to go
+		switch (0) {
+		default:
+			goto *dispatch_table[core.opcode_index + Fetchb()];
+#else
 		switch (core.opcode_index+Fetchb()) {
+#endif
 		#include "core_normal/prefix_none.h"
 		#include "core_normal/prefix_0f.h"
 		#include "core_normal/prefix_66.h"
 		#include "core_normal/prefix_66_0f.h"
+#if !CPU_THREADED_DISPATCH
 		default:
+#endif
 		illegal_opcode:
 #if C_DEBUGGER	
 			{
@@ -186,6 +217,10 @@ decode_end:
 	return CBRET_NONE;
 }
 
+#if CPU_THREADED_DISPATCH
+#pragma GCC diagnostic pop
+#endif
+
 Bits CPU_Core_Normal_Trap_Run() noexcept
 {
 	Bits oldCycles = CPU_Cycles;
@@ -0,0 +1,263 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Generated by scripts/tools/gen-core-normal-dispatch.py from the CASE_*
+// labels in prefix_*.h; don't edit by hand. Included inside the normal
+// core's run function, indexed by opcode_index plus the opcode byte.
+
+/* 0x000 */ &&op_w_0x00, &&op_w_0x01, &&op_w_0x02, &&op_w_0x03,
+/* 0x004 */ &&op_w_0x04, &&op_w_0x05, &&op_w_0x06, &&op_w_0x07,
+/* 0x008 */ &&op_w_0x08, &&op_w_0x09, &&op_w_0x0a, &&op_w_0x0b,
+/* 0x00c */ &&op_w_0x0c, &&op_w_0x0d, &&op_w_0x0e, &&op_w_0x0f,
+/* 0x010 */ &&op_w_0x10, &&op_w_0x11, &&op_w_0x12, &&op_w_0x13,
+/* 0x014 */ &&op_w_0x14, &&op_w_0x15, &&op_w_0x16, &&op_w_0x17,
+/* 0x018 */ &&op_w_0x18, &&op_w_0x19, &&op_w_0x1a, &&op_w_0x1b,
+/* 0x01c */ &&op_w_0x1c, &&op_w_0x1d, &&op_w_0x1e, &&op_w_0x1f,
+/* 0x020 */ &&op_w_0x20, &&op_w_0x21, &&op_w_0x22, &&op_w_0x23,
+/* 0x024 */ &&op_w_0x24, &&op_w_0x25, &&op_w_0x26, &&op_w_0x27,
+/* 0x028 */ &&op_w_0x28, &&op_w_0x29, &&op_w_0x2a, &&op_w_0x2b,
+/* 0x02c */ &&op_w_0x2c, &&op_w_0x2d, &&op_w_0x2e, &&op_w_0x2f,
+/* 0x030 */ &&op_w_0x30, &&op_w_0x31, &&op_w_0x32, &&op_w_0x33,
+/* 0x034 */ &&op_w_0x34, &&op_w_0x35, &&op_w_0x36, &&op_w_0x37,
+/* 0x038 */ &&op_w_0x38, &&op_w_0x39, &&op_w_0x3a, &&op_w_0x3b,
+/* 0x03c */ &&op_w_0x3c, &&op_w_0x3d, &&op_w_0x3e, &&op_w_0x3f,
+/* 0x040 */ &&op_w_0x40, &&op_w_0x41, &&op_w_0x42, &&op_w_0x43,
+/* 0x044 */ &&op_w_0x44, &&op_w_0x45, &&op_w_0x46, &&op_w_0x47,
+/* 0x048 */ &&op_w_0x48, &&op_w_0x49, &&op_w_0x4a, &&op_w_0x4b,
+/* 0x04c */ &&op_w_0x4c, &&op_w_0x4d, &&op_w_0x4e, &&op_w_0x4f,
+/* 0x050 */ &&op_w_0x50, &&op_w_0x51, &&op_w_0x52, &&op_w_0x53,
+/* 0x054 */ &&op_w_0x54, &&op_w_0x55, &&op_w_0x56, &&op_w_0x57,
+/* 0x058 */ &&op_w_0x58, &&op_w_0x59, &&op_w_0x5a, &&op_w_0x5b,
+/* 0x05c */ &&op_w_0x5c, &&op_w_0x5d, &&op_w_0x5e, &&op_w_0x5f,
+/* 0x060 */ &&op_w_0x60, &&op_w_0x61, &&op_w_0x62, &&op_w_0x63,
+/* 0x064 */ &&op_w_0x64, &&op_w_0x65, &&op_w_0x66, &&op_w_0x67,
+/* 0x068 */ &&op_w_0x68, &&op_w_0x69, &&op_w_0x6a, &&op_w_0x6b,
+/* 0x06c */ &&op_w_0x6c, &&op_w_0x6d, &&op_w_0x6e, &&op_w_0x6f,
+/* 0x070 */ &&op_w_0x70, &&op_w_0x71, &&op_w_0x72, &&op_w_0x73,
+/* 0x074 */ &&op_w_0x74, &&op_w_0x75, &&op_w_0x76, &&op_w_0x77,
+/* 0x078 */ &&op_w_0x78, &&op_w_0x79, &&op_w_0x7a, &&op_w_0x7b,
+/* 0x07c */ &&op_w_0x7c, &&op_w_0x7d, &&op_w_0x7e, &&op_w_0x7f,
+/* 0x080 */ &&op_w_0x80, &&op_w_0x81, &&op_w_0x82, &&op_w_0x83,
+/* 0x084 */ &&op_w_0x84, &&op_w_0x85, &&op_w_0x86, &&op_w_0x87,
+/* 0x088 */ &&op_w_0x88, &&op_w_0x89, &&op_w_0x8a, &&op_w_0x8b,
+/* 0x08c */ &&op_w_0x8c, &&op_w_0x8d, &&op_w_0x8e, &&op_w_0x8f,
+/* 0x090 */ &&op_w_0x90, &&op_w_0x91, &&op_w_0x92, &&op_w_0x93,
+/* 0x094 */ &&op_w_0x94, &&op_w_0x95, &&op_w_0x96, &&op_w_0x97,
+/* 0x098 */ &&op_w_0x98, &&op_w_0x99, &&op_w_0x9a, &&op_w_0x9b,
+/* 0x09c */ &&op_w_0x9c, &&op_w_0x9d, &&op_w_0x9e, &&op_w_0x9f,
+/* 0x0a0 */ &&op_w_0xa0, &&op_w_0xa1, &&op_w_0xa2, &&op_w_0xa3,
+/* 0x0a4 */ &&op_w_0xa4, &&op_w_0xa5, &&op_w_0xa6, &&op_w_0xa7,
+/* 0x0a8 */ &&op_w_0xa8, &&op_w_0xa9, &&op_w_0xaa, &&op_w_0xab,
+/* 0x0ac */ &&op_w_0xac, &&op_w_0xad, &&op_w_0xae, &&op_w_0xaf,
+/* 0x0b0 */ &&op_w_0xb0, &&op_w_0xb1, &&op_w_0xb2, &&op_w_0xb3,
+/* 0x0b4 */ &&op_w_0xb4, &&op_w_0xb5, &&op_w_0xb6, &&op_w_0xb7,
+/* 0x0b8 */ &&op_w_0xb8, &&op_w_0xb9, &&op_w_0xba, &&op_w_0xbb,
+/* 0x0bc */ &&op_w_0xbc, &&op_w_0xbd, &&op_w_0xbe, &&op_w_0xbf,
+/* 0x0c0 */ &&op_w_0xc0, &&op_w_0xc1, &&op_w_0xc2, &&op_w_0xc3,
+/* 0x0c4 */ &&op_w_0xc4, &&op_w_0xc5, &&op_w_0xc6, &&op_w_0xc7,
+/* 0x0c8 */ &&op_w_0xc8, &&op_w_0xc9, &&op_w_0xca, &&op_w_0xcb,
+/* 0x0cc */ &&op_w_0xcc, &&op_w_0xcd, &&op_w_0xce, &&op_w_0xcf,
+/* 0x0d0 */ &&op_w_0xd0, &&op_w_0xd1, &&op_w_0xd2, &&op_w_0xd3,
+/* 0x0d4 */ &&op_w_0xd4, &&op_w_0xd5, &&op_w_0xd6, &&op_w_0xd7,
+/* 0x0d8 */ &&op_w_0xd8, &&op_w_0xd9, &&op_w_0xda, &&op_w_0xdb,
+/* 0x0dc */ &&op_w_0xdc, &&op_w_0xdd, &&op_w_0xde, &&op_w_0xdf,
+/* 0x0e0 */ &&op_w_0xe0, &&op_w_0xe1, &&op_w_0xe2, &&op_w_0xe3,
+/* 0x0e4 */ &&op_w_0xe4, &&op_w_0xe5, &&op_w_0xe6, &&op_w_0xe7,
+/* 0x0e8 */ &&op_w_0xe8, &&op_w_0xe9, &&op_w_0xea, &&op_w_0xeb,
+/* 0x0ec */ &&op_w_0xec, &&op_w_0xed, &&op_w_0xee, &&op_w_0xef,
+/* 0x0f0 */ &&op_w_0xf0, &&op_w_0xf1, &&op_w_0xf2, &&op_w_0xf3,
+/* 0x0f4 */ &&op_w_0xf4, &&op_w_0xf5, &&op_w_0xf6, &&op_w_0xf7,
+/* 0x0f8 */ &&op_w_0xf8, &&op_w_0xf9, &&op_w_0xfa, &&op_w_0xfb,
+/* 0x0fc */ &&op_w_0xfc, &&op_w_0xfd, &&op_w_0xfe, &&op_w_0xff,
+/* 0x100 */ &&op_0fw_0x00, &&op_0fw_0x01, &&op_0fw_0x02, &&op_0fw_0x03,
+/* 0x104 */ &&illegal_opcode, &&illegal_opcode, &&op_0fw_0x06, &&illegal_opcode,
+/* 0x108 */ &&op_0fw_0x08, &&op_0fw_0x09, &&illegal_opcode, &&illegal_opcode,
+/* 0x10c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x110 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x114 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x118 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x11c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x120 */ &&op_0fw_0x20, &&op_0fw_0x21, &&op_0fw_0x22, &&op_0fw_0x23,
+/* 0x124 */ &&op_0fw_0x24, &&illegal_opcode, &&op_0fw_0x26, &&illegal_opcode,
+/* 0x128 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x12c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x130 */ &&illegal_opcode, &&op_0fw_0x31, &&illegal_opcode, &&illegal_opcode,
+/* 0x134 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x138 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x13c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x140 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x144 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x148 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x14c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x150 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x154 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x158 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x15c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x160 */ &&op_0fw_0x60, &&op_0fw_0x61, &&op_0fw_0x62, &&op_0fw_0x63,
+/* 0x164 */ &&op_0fw_0x64, &&op_0fw_0x65, &&op_0fw_0x66, &&op_0fw_0x67,
+/* 0x168 */ &&op_0fw_0x68, &&op_0fw_0x69, &&op_0fw_0x6A, &&op_0fw_0x6B,
+/* 0x16c */ &&illegal_opcode, &&illegal_opcode, &&op_0fw_0x6e, &&op_0fw_0x6f,
+/* 0x170 */ &&illegal_opcode, &&op_0fw_0x71, &&op_0fw_0x72, &&op_0fw_0x73,
+/* 0x174 */ &&op_0fw_0x74, &&op_0fw_0x75, &&op_0fw_0x76, &&op_0fw_0x77,
+/* 0x178 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x17c */ &&illegal_opcode, &&illegal_opcode, &&op_0fw_0x7e, &&op_0fw_0x7f,
+/* 0x180 */ &&op_0fw_0x80, &&op_0fw_0x81, &&op_0fw_0x82, &&op_0fw_0x83,
+/* 0x184 */ &&op_0fw_0x84, &&op_0fw_0x85, &&op_0fw_0x86, &&op_0fw_0x87,
+/* 0x188 */ &&op_0fw_0x88, &&op_0fw_0x89, &&op_0fw_0x8a, &&op_0fw_0x8b,
+/* 0x18c */ &&op_0fw_0x8c, &&op_0fw_0x8d, &&op_0fw_0x8e, &&op_0fw_0x8f,
+/* 0x190 */ &&op_0fw_0x90, &&op_0fw_0x91, &&op_0fw_0x92, &&op_0fw_0x93,
+/* 0x194 */ &&op_0fw_0x94, &&op_0fw_0x95, &&op_0fw_0x96, &&op_0fw_0x97,
+/* 0x198 */ &&op_0fw_0x98, &&op_0fw_0x99, &&op_0fw_0x9a, &&op_0fw_0x9b,
+/* 0x19c */ &&op_0fw_0x9c, &&op_0fw_0x9d, &&op_0fw_0x9e, &&op_0fw_0x9f,
+/* 0x1a0 */ &&op_0fw_0xa0, &&op_0fw_0xa1, &&op_0fw_0xa2, &&op_0fw_0xa3,
+/* 0x1a4 */ &&op_0fw_0xa4, &&op_0fw_0xa5, &&illegal_opcode, &&illegal_opcode,
+/* 0x1a8 */ &&op_0fw_0xa8, &&op_0fw_0xa9, &&illegal_opcode, &&op_0fw_0xab,
+/* 0x1ac */ &&op_0fw_0xac, &&op_0fw_0xad, &&illegal_opcode, &&op_0fw_0xaf,
+/* 0x1b0 */ &&op_0fw_0xb0, &&op_0fw_0xb1, &&op_0fw_0xb2, &&op_0fw_0xb3,
+/* 0x1b4 */ &&op_0fw_0xb4, &&op_0fw_0xb5, &&op_0fw_0xb6, &&op_0fw_0xb7,
+/* 0x1b8 */ &&illegal_opcode, &&illegal_opcode, &&op_0fw_0xba, &&op_0fw_0xbb,
+/* 0x1bc */ &&op_0fw_0xbc, &&op_0fw_0xbd, &&op_0fw_0xbe, &&op_0fw_0xbf,
+/* 0x1c0 */ &&op_0fw_0xc0, &&op_0fw_0xc1, &&illegal_opcode, &&illegal_opcode,
+/* 0x1c4 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x1c8 */ &&op_0fw_0xc8, &&op_0fw_0xc9, &&op_0fw_0xca, &&op_0fw_0xcb,
+/* 0x1cc */ &&op_0fw_0xcc, &&op_0fw_0xcd, &&op_0fw_0xce, &&op_0fw_0xcf,
+/* 0x1d0 */ &&illegal_opcode, &&op_0fw_0xd1, &&op_0fw_0xd2, &&op_0fw_0xd3,
+/* 0x1d4 */ &&illegal_opcode, &&op_0fw_0xD5, &&illegal_opcode, &&illegal_opcode,
+/* 0x1d8 */ &&op_0fw_0xD8, &&op_0fw_0xD9, &&illegal_opcode, &&op_0fw_0xdb,
+/* 0x1dc */ &&op_0fw_0xDC, &&op_0fw_0xDD, &&illegal_opcode, &&op_0fw_0xdf,
+/* 0x1e0 */ &&illegal_opcode, &&op_0fw_0xe1, &&op_0fw_0xe2, &&illegal_opcode,
+/* 0x1e4 */ &&illegal_opcode, &&op_0fw_0xE5, &&illegal_opcode, &&illegal_opcode,
+/* 0x1e8 */ &&op_0fw_0xE8, &&op_0fw_0xE9, &&illegal_opcode, &&op_0fw_0xeb,
+/* 0x1ec */ &&op_0fw_0xEC, &&op_0fw_0xED, &&illegal_opcode, &&op_0fw_0xef,
+/* 0x1f0 */ &&illegal_opcode, &&op_0fw_0xf1, &&op_0fw_0xf2, &&op_0fw_0xf3,
+/* 0x1f4 */ &&illegal_opcode, &&op_0fw_0xF5, &&illegal_opcode, &&illegal_opcode,
+/* 0x1f8 */ &&op_0fw_0xF8, &&op_0fw_0xF9, &&op_0fw_0xFA, &&illegal_opcode,
+/* 0x1fc */ &&op_0fw_0xFC, &&op_0fw_0xFD, &&op_0fw_0xFE, &&illegal_opcode,
+/* 0x200 */ &&op_d_0x00, &&op_d_0x01, &&op_d_0x02, &&op_d_0x03,
+/* 0x204 */ &&op_d_0x04, &&op_d_0x05, &&op_d_0x06, &&op_d_0x07,
+/* 0x208 */ &&op_d_0x08, &&op_d_0x09, &&op_d_0x0a, &&op_d_0x0b,
+/* 0x20c */ &&op_d_0x0c, &&op_d_0x0d, &&op_d_0x0e, &&op_d_0x0f,
+/* 0x210 */ &&op_d_0x10, &&op_d_0x11, &&op_d_0x12, &&op_d_0x13,
+/* 0x214 */ &&op_d_0x14, &&op_d_0x15, &&op_d_0x16, &&op_d_0x17,
+/* 0x218 */ &&op_d_0x18, &&op_d_0x19, &&op_d_0x1a, &&op_d_0x1b,
+/* 0x21c */ &&op_d_0x1c, &&op_d_0x1d, &&op_d_0x1e, &&op_d_0x1f,
+/* 0x220 */ &&op_d_0x20, &&op_d_0x21, &&op_d_0x22, &&op_d_0x23,
+/* 0x224 */ &&op_d_0x24, &&op_d_0x25, &&op_d_0x26, &&op_d_0x27,
+/* 0x228 */ &&op_d_0x28, &&op_d_0x29, &&op_d_0x2a, &&op_d_0x2b,
+/* 0x22c */ &&op_d_0x2c, &&op_d_0x2d, &&op_d_0x2e, &&op_d_0x2f,
+/* 0x230 */ &&op_d_0x30, &&op_d_0x31, &&op_d_0x32, &&op_d_0x33,
+/* 0x234 */ &&op_d_0x34, &&op_d_0x35, &&op_d_0x36, &&op_d_0x37,
+/* 0x238 */ &&op_d_0x38, &&op_d_0x39, &&op_d_0x3a, &&op_d_0x3b,
+/* 0x23c */ &&op_d_0x3c, &&op_d_0x3d, &&op_d_0x3e, &&op_d_0x3f,
+/* 0x240 */ &&op_d_0x40, &&op_d_0x41, &&op_d_0x42, &&op_d_0x43,
+/* 0x244 */ &&op_d_0x44, &&op_d_0x45, &&op_d_0x46, &&op_d_0x47,
+/* 0x248 */ &&op_d_0x48, &&op_d_0x49, &&op_d_0x4a, &&op_d_0x4b,
+/* 0x24c */ &&op_d_0x4c, &&op_d_0x4d, &&op_d_0x4e, &&op_d_0x4f,
+/* 0x250 */ &&op_d_0x50, &&op_d_0x51, &&op_d_0x52, &&op_d_0x53,
+/* 0x254 */ &&op_d_0x54, &&op_d_0x55, &&op_d_0x56, &&op_d_0x57,
+/* 0x258 */ &&op_d_0x58, &&op_d_0x59, &&op_d_0x5a, &&op_d_0x5b,
+/* 0x25c */ &&op_d_0x5c, &&op_d_0x5d, &&op_d_0x5e, &&op_d_0x5f,
+/* 0x260 */ &&op_d_0x60, &&op_d_0x61, &&op_d_0x62, &&op_d_0x63,
+/* 0x264 */ &&op_d_0x64, &&op_d_0x65, &&op_d_0x66, &&op_d_0x67,
+/* 0x268 */ &&op_d_0x68, &&op_d_0x69, &&op_d_0x6a, &&op_d_0x6b,
+/* 0x26c */ &&op_d_0x6c, &&op_d_0x6d, &&op_d_0x6e, &&op_d_0x6f,
+/* 0x270 */ &&op_d_0x70, &&op_d_0x71, &&op_d_0x72, &&op_d_0x73,
+/* 0x274 */ &&op_d_0x74, &&op_d_0x75, &&op_d_0x76, &&op_d_0x77,
+/* 0x278 */ &&op_d_0x78, &&op_d_0x79, &&op_d_0x7a, &&op_d_0x7b,
+/* 0x27c */ &&op_d_0x7c, &&op_d_0x7d, &&op_d_0x7e, &&op_d_0x7f,
+/* 0x280 */ &&op_d_0x80, &&op_d_0x81, &&op_d_0x82, &&op_d_0x83,
+/* 0x284 */ &&op_d_0x84, &&op_d_0x85, &&op_d_0x86, &&op_d_0x87,
+/* 0x288 */ &&op_d_0x88, &&op_d_0x89, &&op_d_0x8a, &&op_d_0x8b,
+/* 0x28c */ &&op_d_0x8c, &&op_d_0x8d, &&op_d_0x8e, &&op_d_0x8f,
+/* 0x290 */ &&op_d_0x90, &&op_d_0x91, &&op_d_0x92, &&op_d_0x93,
+/* 0x294 */ &&op_d_0x94, &&op_d_0x95, &&op_d_0x96, &&op_d_0x97,
+/* 0x298 */ &&op_d_0x98, &&op_d_0x99, &&op_d_0x9a, &&op_d_0x9b,
+/* 0x29c */ &&op_d_0x9c, &&op_d_0x9d, &&op_d_0x9e, &&op_d_0x9f,
+/* 0x2a0 */ &&op_d_0xa0, &&op_d_0xa1, &&op_d_0xa2, &&op_d_0xa3,
+/* 0x2a4 */ &&op_d_0xa4, &&op_d_0xa5, &&op_d_0xa6, &&op_d_0xa7,
+/* 0x2a8 */ &&op_d_0xa8, &&op_d_0xa9, &&op_d_0xaa, &&op_d_0xab,
+/* 0x2ac */ &&op_d_0xac, &&op_d_0xad, &&op_d_0xae, &&op_d_0xaf,
+/* 0x2b0 */ &&op_d_0xb0, &&op_d_0xb1, &&op_d_0xb2, &&op_d_0xb3,
+/* 0x2b4 */ &&op_d_0xb4, &&op_d_0xb5, &&op_d_0xb6, &&op_d_0xb7,
+/* 0x2b8 */ &&op_d_0xb8, &&op_d_0xb9, &&op_d_0xba, &&op_d_0xbb,
+/* 0x2bc */ &&op_d_0xbc, &&op_d_0xbd, &&op_d_0xbe, &&op_d_0xbf,
+/* 0x2c0 */ &&op_d_0xc0, &&op_d_0xc1, &&op_d_0xc2, &&op_d_0xc3,
+/* 0x2c4 */ &&op_d_0xc4, &&op_d_0xc5, &&op_d_0xc6, &&op_d_0xc7,
+/* 0x2c8 */ &&op_d_0xc8, &&op_d_0xc9, &&op_d_0xca, &&op_d_0xcb,
+/* 0x2cc */ &&op_d_0xcc, &&op_d_0xcd, &&op_d_0xce, &&op_d_0xcf,
+/* 0x2d0 */ &&op_d_0xd0, &&op_d_0xd1, &&op_d_0xd2, &&op_d_0xd3,
+/* 0x2d4 */ &&op_d_0xd4, &&op_d_0xd5, &&op_d_0xd6, &&op_d_0xd7,
+/* 0x2d8 */ &&op_d_0xd8, &&op_d_0xd9, &&op_d_0xda, &&op_d_0xdb,
+/* 0x2dc */ &&op_d_0xdc, &&op_d_0xdd, &&op_d_0xde, &&op_d_0xdf,
+/* 0x2e0 */ &&op_d_0xe0, &&op_d_0xe1, &&op_d_0xe2, &&op_d_0xe3,
+/* 0x2e4 */ &&op_d_0xe4, &&op_d_0xe5, &&op_d_0xe6, &&op_d_0xe7,
+/* 0x2e8 */ &&op_d_0xe8, &&op_d_0xe9, &&op_d_0xea, &&op_d_0xeb,
+/* 0x2ec */ &&op_d_0xec, &&op_d_0xed, &&op_d_0xee, &&op_d_0xef,
+/* 0x2f0 */ &&op_d_0xf0, &&op_d_0xf1, &&op_d_0xf2, &&op_d_0xf3,
+/* 0x2f4 */ &&op_d_0xf4, &&op_d_0xf5, &&op_d_0xf6, &&op_d_0xf7,
+/* 0x2f8 */ &&op_d_0xf8, &&op_d_0xf9, &&op_d_0xfa, &&op_d_0xfb,
+/* 0x2fc */ &&op_d_0xfc, &&op_d_0xfd, &&op_d_0xfe, &&op_d_0xff,
+/* 0x300 */ &&op_0fd_0x00, &&op_0fd_0x01, &&op_0fd_0x02, &&op_0fd_0x03,
+/* 0x304 */ &&illegal_opcode, &&illegal_opcode, &&op_0fd_0x06, &&illegal_opcode,
+/* 0x308 */ &&op_0fd_0x08, &&op_0fd_0x09, &&illegal_opcode, &&illegal_opcode,
+/* 0x30c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x310 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x314 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x318 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x31c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x320 */ &&op_0fd_0x20, &&op_0fd_0x21, &&op_0fd_0x22, &&op_0fd_0x23,
+/* 0x324 */ &&op_0fd_0x24, &&illegal_opcode, &&op_0fd_0x26, &&illegal_opcode,
+/* 0x328 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x32c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x330 */ &&illegal_opcode, &&op_0fd_0x31, &&illegal_opcode, &&illegal_opcode,
+/* 0x334 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x338 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x33c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x340 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x344 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x348 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x34c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x350 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x354 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x358 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x35c */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x360 */ &&op_0fd_0x60, &&op_0fd_0x61, &&op_0fd_0x62, &&op_0fd_0x63,
+/* 0x364 */ &&op_0fd_0x64, &&op_0fd_0x65, &&op_0fd_0x66, &&op_0fd_0x67,
+/* 0x368 */ &&op_0fd_0x68, &&op_0fd_0x69, &&op_0fd_0x6A, &&op_0fd_0x6B,
+/* 0x36c */ &&illegal_opcode, &&illegal_opcode, &&op_0fd_0x6e, &&op_0fd_0x6f,
+/* 0x370 */ &&illegal_opcode, &&op_0fd_0x71, &&op_0fd_0x72, &&op_0fd_0x73,
+/* 0x374 */ &&op_0fd_0x74, &&op_0fd_0x75, &&op_0fd_0x76, &&op_0fd_0x77,
+/* 0x378 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x37c */ &&illegal_opcode, &&illegal_opcode, &&op_0fd_0x7e, &&op_0fd_0x7f,
+/* 0x380 */ &&op_0fd_0x80, &&op_0fd_0x81, &&op_0fd_0x82, &&op_0fd_0x83,
+/* 0x384 */ &&op_0fd_0x84, &&op_0fd_0x85, &&op_0fd_0x86, &&op_0fd_0x87,
+/* 0x388 */ &&op_0fd_0x88, &&op_0fd_0x89, &&op_0fd_0x8a, &&op_0fd_0x8b,
+/* 0x38c */ &&op_0fd_0x8c, &&op_0fd_0x8d, &&op_0fd_0x8e, &&op_0fd_0x8f,
+/* 0x390 */ &&op_0fd_0x90, &&op_0fd_0x91, &&op_0fd_0x92, &&op_0fd_0x93,
+/* 0x394 */ &&op_0fd_0x94, &&op_0fd_0x95, &&op_0fd_0x96, &&op_0fd_0x97,
+/* 0x398 */ &&op_0fd_0x98, &&op_0fd_0x99, &&op_0fd_0x9a, &&op_0fd_0x9b,
+/* 0x39c */ &&op_0fd_0x9c, &&op_0fd_0x9d, &&op_0fd_0x9e, &&op_0fd_0x9f,
+/* 0x3a0 */ &&op_0fd_0xa0, &&op_0fd_0xa1, &&op_0fd_0xa2, &&op_0fd_0xa3,
+/* 0x3a4 */ &&op_0fd_0xa4, &&op_0fd_0xa5, &&illegal_opcode, &&illegal_opcode,
+/* 0x3a8 */ &&op_0fd_0xa8, &&op_0fd_0xa9, &&illegal_opcode, &&op_0fd_0xab,
+/* 0x3ac */ &&op_0fd_0xac, &&op_0fd_0xad, &&illegal_opcode, &&op_0fd_0xaf,
+/* 0x3b0 */ &&op_0fd_0xb0, &&op_0fd_0xb1, &&op_0fd_0xb2, &&op_0fd_0xb3,
+/* 0x3b4 */ &&op_0fd_0xb4, &&op_0fd_0xb5, &&op_0fd_0xb6, &&op_0fd_0xb7,
+/* 0x3b8 */ &&illegal_opcode, &&illegal_opcode, &&op_0fd_0xba, &&op_0fd_0xbb,
+/* 0x3bc */ &&op_0fd_0xbc, &&op_0fd_0xbd, &&op_0fd_0xbe, &&op_0fd_0xbf,
+/* 0x3c0 */ &&op_0fd_0xc0, &&op_0fd_0xc1, &&illegal_opcode, &&illegal_opcode,
+/* 0x3c4 */ &&illegal_opcode, &&illegal_opcode, &&illegal_opcode, &&illegal_opcode,
+/* 0x3c8 */ &&op_0fd_0xc8, &&op_0fd_0xc9, &&op_0fd_0xca, &&op_0fd_0xcb,
+/* 0x3cc */ &&op_0fd_0xcc, &&op_0fd_0xcd, &&op_0fd_0xce, &&op_0fd_0xcf,
+/* 0x3d0 */ &&illegal_opcode, &&op_0fd_0xd1, &&op_0fd_0xd2, &&op_0fd_0xd3,
+/* 0x3d4 */ &&illegal_opcode, &&op_0fd_0xD5, &&illegal_opcode, &&illegal_opcode,
+/* 0x3d8 */ &&op_0fd_0xD8, &&op_0fd_0xD9, &&illegal_opcode, &&op_0fd_0xdb,
+/* 0x3dc */ &&op_0fd_0xDC, &&op_0fd_0xDD, &&illegal_opcode, &&op_0fd_0xdf,
+/* 0x3e0 */ &&illegal_opcode, &&op_0fd_0xe1, &&op_0fd_0xe2, &&illegal_opcode,
+/* 0x3e4 */ &&illegal_opcode, &&op_0fd_0xE5, &&illegal_opcode, &&illegal_opcode,
+/* 0x3e8 */ &&op_0fd_0xE8, &&op_0fd_0xE9, &&illegal_opcode, &&op_0fd_0xeb,
+/* 0x3ec */ &&op_0fd_0xEC, &&op_0fd_0xED, &&illegal_opcode, &&op_0fd_0xef,
+/* 0x3f0 */ &&illegal_opcode, &&op_0fd_0xf1, &&op_0fd_0xf2, &&op_0fd_0xf3,
+/* 0x3f4 */ &&illegal_opcode, &&op_0fd_0xF5, &&illegal_opcode, &&illegal_opcode,
+/* 0x3f8 */ &&op_0fd_0xF8, &&op_0fd_0xF9, &&op_0fd_0xFA, &&illegal_opcode,
+/* 0x3fc */ &&op_0fd_0xFC, &&op_0fd_0xFD, &&op_0fd_0xFE, &&illegal_opcode,
@@ -125,21 +125,38 @@
 	}																		\
 }
 
+#if CPU_THREADED_DISPATCH
+// Labels for the computed-goto table in core_normal/dispatch_table.h
+#define CASE_W(_WHICH)							\
+	op_w_ ## _WHICH:
+
+#define CASE_D(_WHICH)							\
+	op_d_ ## _WHICH:
+#else
 #define CASE_W(_WHICH)							\
 	case (OPCODE_NONE+_WHICH):
 
 #define CASE_D(_WHICH)							\
 	case (OPCODE_SIZE+_WHICH):
+#endif
 
 #define CASE_B(_WHICH)							\
 	CASE_W(_WHICH)								\
 	CASE_D(_WHICH)
 
+#if CPU_THREADED_DISPATCH
+#define CASE_0F_W(_WHICH)						\
+	op_0fw_ ## _WHICH:
+
+#define CASE_0F_D(_WHICH)						\
+	op_0fd_ ## _WHICH:
+#else
 #define CASE_0F_W(_WHICH)						\
 	case ((OPCODE_0F|OPCODE_NONE)+_WHICH):
 
 #define CASE_0F_D(_WHICH)						\
 	case ((OPCODE_0F|OPCODE_SIZE)+_WHICH):
+#endif
 
 #define CASE_0F_B(_WHICH)						\
 	CASE_0F_W(_WHICH)							\
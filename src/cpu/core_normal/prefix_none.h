@@ -866,6 +866,7 @@
 			const auto port = Fetchb();
 			if (CPU_IO_Exception(port,1)) RUNEXCEPTION();
 			reg_al=IO_ReadB(port);
+			CPU_SkipPollingLoop(SegBase(cs) + reg_eip, SegBase(cs) + GETIP, port, reg_al);
 			break;
 		}
 	CASE_W(0xe5)												/* IN AX,Ib */
@@ -928,6 +929,7 @@
 	CASE_B(0xec)												/* IN AL,DX */
 		if (CPU_IO_Exception(reg_dx,1)) RUNEXCEPTION();
 		reg_al=IO_ReadB(reg_dx);
+		CPU_SkipPollingLoop(SegBase(cs) + reg_eip, SegBase(cs) + GETIP, reg_dx, reg_al);
 		break;
 	CASE_W(0xed)												/* IN AX,DX */
 		if (CPU_IO_Exception(reg_dx,2)) RUNEXCEPTION();
@@ -1092,7 +1094,14 @@
 				{
 					Bitu cb=Fetchw();
 					FillFlags();SAVEIP;
-					return cb;
+					if (!CALLBACK_IsInline(cb)) {
+						return cb;
+					}
+					// The next instruction reloads the registers
+					if (CALLBACK_RunInline(cb)) {
+						continue;
+					}
+					return CBRET_NONE;
 				}
 			default:
 				E_Exit("Illegal GRP4 Call %d",(rm>>3) & 7);
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText:  2002-2021 The DOSBox Team
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "cpu/string_bulk.h"
 #include "cpu/string_ops.h"
 
 #define LoadD(_BLAH) _BLAH
@@ -64,10 +65,10 @@ static void DoString(STRING_OP type) {
 		break;
 	case R_INSW:
 		add_index *= 2;
-		for (;count>0;count--) {
-			SaveMw(di_base+di_index,IO_ReadW(reg_dx));
-			di_index=(di_index+add_index) & add_mask;
-		}
+		STRING_RepIn(reg_dx, di_base, di_index, add_mask,
+		             static_cast<int32_t>(add_index), count,
+		             [](const PhysPt dst) { SaveMw(dst, IO_ReadW(reg_dx)); });
+		count = 0;
 		break;
 	case R_INSD:
 		add_index *= 4;
@@ -77,47 +78,53 @@ static void DoString(STRING_OP type) {
 		}
 		break;
 	case R_STOSB:
-		for (;count>0;count--) {
-			SaveMb(di_base+di_index,reg_al);
-			di_index=(di_index+add_index) & add_mask;
-		}
+		STRING_RepStore(di_base, di_index, add_mask, static_cast<int32_t>(add_index),
+		                count, reg_al, [](const PhysPt dst, const uint8_t val) {
+			                SaveMb(dst, val);
+		                });
+		count = 0;
 		break;
 	case R_STOSW:
 		add_index *= 2;
-		for (;count>0;count--) {
-			SaveMw(di_base+di_index,reg_ax);
-			di_index=(di_index+add_index) & add_mask;
-		}
+		STRING_RepStore(di_base, di_index, add_mask, static_cast<int32_t>(add_index),
+		                count, reg_ax, [](const PhysPt dst, const uint16_t val) {
+			                SaveMw(dst, val);
+		                });
+		count = 0;
 		break;
 	case R_STOSD:
 		add_index *= 4;
-		for (;count>0;count--) {
-			SaveMd(di_base+di_index,reg_eax);
-			di_index=(di_index+add_index) & add_mask;
-		}
+		STRING_RepStore(di_base, di_index, add_mask, static_cast<int32_t>(add_index),
+		                count, reg_eax, [](const PhysPt dst, const uint32_t val) {
+			                SaveMd(dst, val);
+		                });
+		count = 0;
 		break;
 	case R_MOVSB:
-		for (;count>0;count--) {
-			SaveMb(di_base+di_index,LoadMb(si_base+si_index));
-			di_index=(di_index+add_index) & add_mask;
-			si_index=(si_index+add_index) & add_mask;
-		}
+		STRING_RepMove(si_base, si_index, di_base, di_index, add_mask,
+		               static_cast<int32_t>(add_index), count,
+		               [](const PhysPt src, const PhysPt dst) {
+			               SaveMb(dst, LoadMb(src));
+		               });
+		count = 0;
 		break;
 	case R_MOVSW:
 		add_index *= 2;
-		for (;count>0;count--) {
-			SaveMw(di_base+di_index,LoadMw(si_base+si_index));
-			di_index=(di_index+add_index) & add_mask;
-			si_index=(si_index+add_index) & add_mask;
-		}
+		STRING_RepMove(si_base, si_index, di_base, di_index, add_mask,
+		               static_cast<int32_t>(add_index), count,
+		               [](const PhysPt src, const PhysPt dst) {
+			               SaveMw(dst, LoadMw(src));
+		               });
+		count = 0;
 		break;
 	case R_MOVSD:
 		add_index *= 4;
-		for (;count>0;count--) {
-			SaveMd(di_base+di_index,LoadMd(si_base+si_index));
-			di_index=(di_index+add_index) & add_mask;
-			si_index=(si_index+add_index) & add_mask;
-		}
+		STRING_RepMove(si_base, si_index, di_base, di_index, add_mask,
+		               static_cast<int32_t>(add_index), count,
+		               [](const PhysPt src, const PhysPt dst) {
+			               SaveMd(dst, LoadMd(src));
+		               });
+		count = 0;
 		break;
 	case R_LODSB:
 		for (;count>0;count--) {
@@ -181,14 +188,14 @@ static void DoString(STRING_OP type) {
 		{
 			uint8_t val1 = 0;
 			uint8_t val2 = 0;
-			for (;count>0;) {
-				count--;CPU_Cycles--;
-				val1=LoadMb(si_base+si_index);
-				val2=LoadMb(di_base+di_index);
-				si_index=(si_index+add_index) & add_mask;
-				di_index=(di_index+add_index) & add_mask;
-				if ((val1==val2)!=core.rep_zero) break;
-			}
+			const auto compared = STRING_RepCompare(
+			        si_base, si_index, di_base, di_index, add_mask,
+			        static_cast<int32_t>(add_index), count, core.rep_zero,
+			        val1, val2, [](const PhysPt address) {
+				        return LoadMb(address);
+			        });
+			count -= compared;
+			CPU_Cycles -= static_cast<int32_t>(compared);
 			CMPB(val1,val2,LoadD,0);
 		}
 		break;
@@ -197,14 +204,14 @@ static void DoString(STRING_OP type) {
 			add_index *= 2;
 			uint16_t val1 = 0;
 			uint16_t val2 = 0;
-			for (;count>0;) {
-				count--;CPU_Cycles--;
-				val1=LoadMw(si_base+si_index);
-				val2=LoadMw(di_base+di_index);
-				si_index=(si_index+add_index) & add_mask;
-				di_index=(di_index+add_index) & add_mask;
-				if ((val1==val2)!=core.rep_zero) break;
-			}
+			const auto compared = STRING_RepCompare(
+			        si_base, si_index, di_base, di_index, add_mask,
+			        static_cast<int32_t>(add_index), count, core.rep_zero,
+			        val1, val2, [](const PhysPt address) {
+				        return LoadMw(address);
+			        });
+			count -= compared;
+			CPU_Cycles -= static_cast<int32_t>(compared);
 			CMPW(val1,val2,LoadD,0);
 		}
 		break;
@@ -213,14 +220,14 @@ static void DoString(STRING_OP type) {
 			add_index *= 4;
 			uint32_t val1 = 0;
 			uint32_t val2 = 0;
-			for (;count>0;) {
-				count--;CPU_Cycles--;
-				val1=LoadMd(si_base+si_index);
-				val2=LoadMd(di_base+di_index);
-				si_index=(si_index+add_index) & add_mask;
-				di_index=(di_index+add_index) & add_mask;
-				if ((val1==val2)!=core.rep_zero) break;
-			}
+			const auto compared = STRING_RepCompare(
+			        si_base, si_index, di_base, di_index, add_mask,
+			        static_cast<int32_t>(add_index), count, core.rep_zero,
+			        val1, val2, [](const PhysPt address) {
+				        return LoadMd(address);
+			        });
+			count -= compared;
+			CPU_Cycles -= static_cast<int32_t>(compared);
 			CMPD(val1,val2,LoadD,0);
 		}
 		break;
@@ -4,8 +4,11 @@
 
 #include "cpu/cpu.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
+#include <cstring>
 #include <sstream>
 #include <memory>
 
@@ -14,10 +17,15 @@
 #include "cpu/paging.h"
 #include "debugger/debugger.h"
 #include "dos/programs.h"
+#include "fpu/fpu.h"
 #include "gui/mapper.h"
 #include "gui/titlebar.h"
 #include "hardware/pic.h"
+#include "hardware/timer.h"
 #include "lazyflags.h"
+#include "misc/health_counters.h"
+#include "misc/perf_counters.h"
+#include "misc/savestate.h"
 #include "misc/support.h"
 #include "misc/video.h"
 #include "shell/command_line.h"
@@ -46,8 +54,11 @@ int CPU_CycleLeft = CpuCyclesRealModeDefault;
 // Cycles settings for both "legacy" and "modern" modes
 int CPU_CycleMax      = CpuCyclesRealModeDefault;
 int CPU_CyclePercUsed = 100;
+int CPU_CycleHeadroom = 0;
 int CPU_CycleLimit    = -1;
 
+bool CPU_IdleOnKeyboardPolling = true;
+
 static int old_cycle_max       = CpuCyclesRealModeDefault;
 static bool legacy_cycles_mode = false;
 
@@ -84,6 +95,21 @@ int64_t CPU_IODelayRemoved = 0;
 
 CPU_Decoder* cpudecoder;
 
+int CPU_DynamicCacheSizeMb = 8;
+
+static PerfCounter cpu_core_switches("cpu_core_switches",
+                                     "Automatic switches to the dynamic core.");
+
+bool CPU_AutoCoreUsesNormal = false;
+
+static PerfCounter cpu_auto_core_fallbacks("cpu_auto_core_fallbacks",
+                                           "Times 'core = auto' moved a program "
+                                           "from the dynamic to the normal core "
+                                           "for self-modifying code.");
+static PerfGauge cpu_auto_core_on_normal("cpu_auto_core_on_normal",
+                                         "1 while 'core = auto' runs a protected "
+                                         "mode program on the normal core.");
+
 bool CPU_CycleAutoAdjust = false;
 
 CpuAutoDetermineMode auto_determine_mode      = {};
@@ -241,6 +267,129 @@ static void set_modern_cycles_config(const CpuMode mode)
 
 static bool is_protected_mode_program = false;
 
+// Automatic core profiling
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// With 'core = auto' the dynamic core takes over once a program enters
+// protected mode. A few programs patch their inner loops so often that
+// the dynamic core mostly retranslates what they just rewrote, which is
+// slower than interpreting. Every emulated second, the dynamic core's
+// translation and self-modifying-code counts over that second decide
+// whether the program is better off on the normal core. It then stays
+// there for a while before the dynamic core gets another go; a program
+// that falls back again right away waits twice as long next time.
+//
+// Cycles need no profiling of their own: 'max' and throttled cycles
+// already follow what the host sustains (see increase_ticks()).
+
+namespace {
+
+constexpr int ProfileWindowMs = 1000;
+
+// Per window: translating this many blocks while this many writes hit
+// translated code counts as retranslating self-modifying code
+constexpr uint64_t MinBlocksCompiled = 10'000;
+constexpr uint64_t MinCodeWrites     = 2'000;
+
+// Windows spent on the normal core before retrying the dynamic core
+constexpr int InitialBackoffWindows = 5;
+constexpr int MaxBackoffWindows     = 160;
+
+struct {
+	int window_ms = 0;
+
+	uint64_t blocks_compiled = 0;
+	uint64_t code_writes     = 0;
+
+	// Windows left on the normal core, and since the last retry
+	int fallback_windows    = 0;
+	int windows_since_retry = 0;
+	int backoff_windows     = InitialBackoffWindows;
+	bool has_retried        = false;
+} auto_core_profile = {};
+
+} // namespace
+
+static void set_auto_core_uses_normal(const bool uses_normal)
+{
+	CPU_AutoCoreUsesNormal = uses_normal;
+	cpu_auto_core_on_normal.Set(uses_normal ? 1 : 0);
+}
+
+static void reset_auto_core_profile()
+{
+	set_auto_core_uses_normal(false);
+	auto_core_profile = {};
+}
+
+static void auto_core_profile_tick()
+{
+#if C_DYNAMIC_X86 || C_DYNREC
+	auto& profile = auto_core_profile;
+
+	const bool is_auto_dynamic_core = cpu.pmode &&
+	                                  last_auto_determine_mode.auto_core;
+	if (!is_auto_dynamic_core) {
+		if (CPU_AutoCoreUsesNormal || profile.window_ms) {
+			reset_auto_core_profile();
+		}
+		return;
+	}
+
+	if (++profile.window_ms < ProfileWindowMs) {
+		return;
+	}
+	profile.window_ms = 0;
+
+	const auto blocks_compiled = health_counters.dynrec_blocks_compiled.Value();
+	const auto code_writes = health_counters.dynrec_code_writes.Value();
+
+	const auto window_blocks_compiled = blocks_compiled - profile.blocks_compiled;
+	const auto window_code_writes = code_writes - profile.code_writes;
+
+	profile.blocks_compiled = blocks_compiled;
+	profile.code_writes     = code_writes;
+
+	if (CPU_AutoCoreUsesNormal) {
+		if (--profile.fallback_windows > 0) {
+			return;
+		}
+		set_auto_core_uses_normal(false);
+		profile.windows_since_retry = 0;
+		profile.has_retried         = true;
+		LOG_MSG("CPU: Retrying the dynamic core");
+		return;
+	}
+
+	++profile.windows_since_retry;
+
+	const bool is_retranslating = window_blocks_compiled >= MinBlocksCompiled &&
+	                              window_code_writes >= MinCodeWrites;
+	if (!is_retranslating) {
+		if (profile.windows_since_retry > profile.backoff_windows) {
+			profile.backoff_windows = InitialBackoffWindows;
+		}
+		return;
+	}
+
+	// Falling back within the first windows after a retry means the
+	// program hasn't changed its ways; back off for longer
+	if (profile.has_retried && profile.windows_since_retry <= 2) {
+		profile.backoff_windows = std::min(profile.backoff_windows * 2,
+		                                   MaxBackoffWindows);
+	}
+	profile.fallback_windows = profile.backoff_windows;
+
+	set_auto_core_uses_normal(true);
+	cpu_auto_core_fallbacks.Add();
+
+	LOG_MSG("CPU: %llu blocks translated and %llu writes to translated code "
+	        "in the last second, running the normal core for %d seconds",
+	        static_cast<unsigned long long>(window_blocks_compiled),
+	        static_cast<unsigned long long>(window_code_writes),
+	        profile.fallback_windows * ProfileWindowMs / 1000);
+#endif
+}
+
 void CPU_RestoreRealModeCyclesConfig()
 {
 	if (cpu.pmode || (!last_auto_determine_mode.auto_core &&
@@ -290,6 +439,113 @@ void Descriptor::Save(PhysPt address) {
 	cpu.mpl=03;
 }
 
+// Segment descriptor cache
+// ~~~~~~~~~~~~~~~~~~~~~~~~
+// DOS extenders and Windows reload the segment registers all the time, and
+// each protected-mode load fetches its descriptor from the GDT or LDT
+// through the paging layer. The cache keeps the raw descriptors last
+// fetched by their linear address, which stands for the table's base plus
+// the selector, and watches the pages they were read from. Writing those
+// pages, changing the paging mappings and loading the GDTR or LDTR empty
+// it. Only the fetch is cached: the checks of a load depend on the CPL and
+// the selector's RPL, and still run every time.
+//
+// A guest that keeps writing its descriptor tables would pay for setting
+// up the watches over and over, so after a run of flushes that came before
+// the cache paid off, it stays off until the next GDTR or LDTR load.
+
+static PerfCounter descriptor_cache_hits("descriptor_cache_hits",
+                                         "GDT and LDT descriptors found in the "
+                                         "descriptor cache.");
+static PerfCounter descriptor_cache_misses("descriptor_cache_misses",
+                                           "GDT and LDT descriptors fetched from "
+                                           "guest memory.");
+
+static struct {
+	struct Entry {
+		PhysPt address   = 0;
+		bool is_valid    = false;
+		uint32_t data[2] = {};
+	};
+	// Direct-mapped by the descriptor's index in its table
+	std::array<Entry, 64> entries = {};
+
+	// Of the write watches the entries were filled under
+	uint32_t watch_generation = 0;
+
+	int hits_since_flush   = 0;
+	int num_unpaid_flushes = 0;
+	bool is_enabled        = true;
+} descriptor_cache = {};
+
+// Counted as paying off once it saved as many fetches as it has entries
+constexpr int DescriptorCacheMinHits          = 64;
+constexpr int DescriptorCacheMaxUnpaidFlushes = 16;
+
+static void empty_descriptor_cache()
+{
+	for (auto& entry : descriptor_cache.entries) {
+		entry.is_valid = false;
+	}
+	descriptor_cache.hits_since_flush = 0;
+}
+
+void CPU_FlushDescriptorCache()
+{
+	empty_descriptor_cache();
+	descriptor_cache.num_unpaid_flushes = 0;
+	descriptor_cache.is_enabled         = true;
+}
+
+// A descriptor straddling two pages or read from anything but plain RAM
+// isn't cached
+static bool can_cache_descriptor(const PhysPt address)
+{
+	constexpr auto DescriptorSize = 8;
+	if (address / MemPageSize != (address + DescriptorSize - 1) / MemPageSize) {
+		return false;
+	}
+	// The fetch just linked the page, unless a handler serves it
+	if (!get_tlb_read(address)) {
+		return false;
+	}
+	return MEM_WatchPageWrites(PAGING_GetPhysicalPage(address) / MemPageSize);
+}
+
+void CPU_FetchDescriptor(const PhysPt address, Descriptor& desc)
+{
+	auto& cache = descriptor_cache;
+	if (cache.watch_generation != mem_write_watches.generation) {
+		cache.watch_generation = mem_write_watches.generation;
+		if (cache.hits_since_flush < DescriptorCacheMinHits &&
+		    ++cache.num_unpaid_flushes >= DescriptorCacheMaxUnpaidFlushes) {
+			cache.is_enabled = false;
+		}
+		empty_descriptor_cache();
+	}
+
+	auto& entry = cache.entries[(address / 8) % cache.entries.size()];
+	if (entry.is_valid && entry.address == address) {
+		static_assert(sizeof(desc.saved) == sizeof(entry.data));
+		std::memcpy(&desc.saved, entry.data, sizeof(entry.data));
+		++cache.hits_since_flush;
+		descriptor_cache_hits.Add();
+		return;
+	}
+
+	desc.Load(address);
+	descriptor_cache_misses.Add();
+
+	// The fetch can fault, and the guest's handler change the mappings
+	if (!cache.is_enabled || !can_cache_descriptor(address) ||
+	    cache.watch_generation != mem_write_watches.generation) {
+		return;
+	}
+	entry.address  = address;
+	entry.is_valid = true;
+	std::memcpy(entry.data, &desc.saved, sizeof(entry.data));
+}
+
 void CPU_Push16(const uint16_t value)
 {
 	const uint32_t new_esp = (reg_esp & cpu.stack.notmask) |
@@ -1716,6 +1972,7 @@ void CPU_LGDT(Bitu limit,Bitu base) {
 	LOG(LOG_CPU,LOG_NORMAL)("GDT Set to base:%X limit:%X",base,limit);
 	cpu.gdt.SetLimit(limit);
 	cpu.gdt.SetBase(base);
+	CPU_FlushDescriptorCache();
 }
 
 void CPU_LIDT(Bitu limit,Bitu base) {
@@ -1767,11 +2024,13 @@ void CPU_SET_CRX(Bitu cr, Bitu value)
 			if (auto_determine_mode.auto_core) {
 				CPU_Core_Dyn_X86_Cache_Init(true);
 				cpudecoder = &CPU_Core_Dyn_X86_Run;
+				cpu_core_switches.Add();
 			}
 #elif C_DYNREC
 			if (auto_determine_mode.auto_core) {
 				CPU_Core_Dynrec_Cache_Init(true);
 				cpudecoder = &CPU_Core_Dynrec_Run;
+				cpu_core_switches.Add();
 			}
 #endif
 			if (legacy_cycles_mode) {
@@ -3148,12 +3407,18 @@ public:
 		// CPU_CycleLeft = 0;
 		CPU_Cycles          = 0;
 		auto_determine_mode = {};
+		reset_auto_core_profile();
 
 		SectionProp* secprop = static_cast<SectionProp*>(sec);
 
 		const std::string cpu_core = secprop->GetString("core");
 		const std::string cpu_type = secprop->GetString("cputype");
 
+#if C_DYNAMIC_X86 || C_DYNREC
+		// Must be set before ConfigureCpuCore() first sets up the cache
+		CPU_DynamicCacheSizeMb = secprop->GetInt("dynamic_cache_size");
+#endif
+
 		ConfigureCpuCore(cpu_core);
 		ConfigureCpuType(cpu_core, cpu_type);
 
@@ -3189,6 +3454,10 @@ public:
 		cpu_cycle_up   = secprop->GetInt("cycleup");
 		cpu_cycle_down = secprop->GetInt("cycledown");
 
+		CPU_CycleHeadroom = secprop->GetInt("cpu_cycles_headroom");
+
+		CPU_IdleOnKeyboardPolling = secprop->GetBool("cpu_idle_keyboard_polling");
+
 		TITLEBAR_NotifyCyclesChanged();
 
 		return true;
@@ -3208,6 +3477,8 @@ static void cpu_shutdown([[maybe_unused]] Section* sec)
 	CPU_Core_Dynrec_Cache_Close();
 #endif
 
+	TIMER_DelTickHandler(auto_core_profile_tick);
+
 	cpu_instance.reset();
 }
 
@@ -3215,6 +3486,7 @@ static void cpu_init(Section* sec)
 {
 	assert(sec);
 	cpu_instance = std::make_unique<Cpu>(sec);
+	TIMER_AddTickHandler(auto_core_profile_tick);
 
 	constexpr auto ChangeableAtRuntime = true;
 	sec->AddDestroyFunction(&cpu_shutdown, ChangeableAtRuntime);
@@ -3238,8 +3510,9 @@ void init_cpu_dosbox_settings(SectionProp& secprop)
 	pstring->SetHelp(
 	        "Type of CPU emulation core to use ('auto' by default).\n"
 	        "  auto:     'normal' core for real mode programs, 'dynamic' core for protected\n"
-	        "            mode programs (default). Most programs will run correctly with this\n"
-	        "            setting.\n"
+	        "            mode programs (default). Protected mode programs that keep\n"
+	        "            rewriting their own code are moved to the 'normal' core for a\n"
+	        "            while. Most programs will run correctly with this setting.\n"
 	        "  normal:   The DOS program is interpreted instruction by instruction. This\n"
 	        "            yields the most accurate timings, but puts 3-5 times more load on\n"
 	        "            the host CPU compared to the 'dynamic' core. Therefore, it's\n"
@@ -3257,6 +3530,23 @@ void init_cpu_dosbox_settings(SectionProp& secprop)
 	        "            Programs that self-modify their code might misbehave or crash on\n"
 	        "            the 'dynamic' core; use the 'normal' core for such programs.");
 
+#if C_DYNAMIC_X86 || C_DYNREC
+	constexpr auto OnlyAtStart          = Property::Changeable::OnlyAtStart;
+	constexpr bool is_64bit_host        = sizeof(void*) == 8;
+	constexpr int MaxDynamicCacheSizeMb = is_64bit_host ? 512 : 64;
+
+	auto pcache = secprop.AddInt("dynamic_cache_size", OnlyAtStart, 8);
+	pcache->SetMinMax(8, MaxDynamicCacheSizeMb);
+	pcache->SetHelp(format_str(
+	        "Size of the 'dynamic' core's translated code cache in MB (8 by default).\n"
+	        "Valid range is from 8 to %d. Large protected mode programs (e.g., Windows 3.x\n"
+	        "and DOS4GW games) that keep retranslating their code may stutter less with a\n"
+	        "bigger cache. When the cache is full, the least recently used code pages are\n"
+	        "dropped first. Every 8 MB of cache costs about 28 MB of host memory in total,\n"
+	        "including the bookkeeping. Rounded down to a multiple of 8.",
+	        MaxDynamicCacheSizeMb));
+#endif
+
 	pstring = secprop.AddString("cputype", Always, "auto");
 	pstring->SetValues(
 	        {"auto", "386", "386_fast", "386_prefetch", "486", "pentium", "pentium_mmx"});
@@ -3366,7 +3656,27 @@ void init_cpu_dosbox_settings(SectionProp& secprop)
 	        "millisecond can vary; this might cause issues in some DOS programs.",
 	        (CpuThrottleDefault ? "'on'" : "'off'")));
 
-	auto pint = secprop.AddInt("cycleup", Always, DefaultCpuCycleUp);
+	constexpr auto DefaultCpuCycleHeadroom = 0;
+	constexpr auto MaxCpuCycleHeadroom     = 50;
+
+	auto pint = secprop.AddInt("cpu_cycles_headroom", Always, DefaultCpuCycleHeadroom);
+	pint->SetMinMax(0, MaxCpuCycleHeadroom);
+	pint->SetHelp(format_str(
+	        "Percentage of host time to leave unused when the emulated CPU cycles adjust\n"
+	        "to the host, with 'max' or throttled cycles (%d by default). A little\n"
+	        "headroom trades some speed for fewer audio dropouts when other programs or\n"
+	        "other DOSBox instances compete for the host CPU.",
+	        DefaultCpuCycleHeadroom));
+
+	pbool = secprop.AddBool("cpu_idle_keyboard_polling", Always, true);
+	pbool->SetHelp(
+	        "Idle the emulated CPU when a program spins on the BIOS keyboard check\n"
+	        "('on' by default). More than 16 checks without a key in one emulated\n"
+	        "millisecond give up the rest of it, as waiting for a key already does. Turn\n"
+	        "this off if a program that polls the keyboard in a tight loop runs too\n"
+	        "slowly.");
+
+	pint = secprop.AddInt("cycleup", Always, DefaultCpuCycleUp);
 	pint->SetMinMax(CpuCycleStepMin, CpuCycleStepMax);
 	pint->SetHelp(
 	        format_str("Number of cycles to add with the 'Inc Cycles' hotkey (%d by default).\n"
@@ -3381,6 +3691,76 @@ void init_cpu_dosbox_settings(SectionProp& secprop)
 	                   DefaultCpuCycleDown));
 }
 
+// The dynamic cores keep translated code and their own page handlers that
+// a restored RAM image would silently invalidate
+void CPU_SaveState(SaveStateWriter& out)
+{
+	if (is_dynamic_core_active()) {
+		out.Fail("not supported with the dynamic core");
+		return;
+	}
+	out.Write(cpu_regs);
+	out.Write(Segs);
+	out.Write(cpu);
+	out.Write(cpu_tss);
+	out.Write(lflags);
+#if C_FPU
+	out.Write(fpu);
+#endif
+	out.Write(CPU_Cycles);
+	out.Write(CPU_CycleLeft);
+	out.Write(cpudecoder);
+}
+
+bool CPU_LoadState(SaveStateReader& in, const bool apply)
+{
+	if (is_dynamic_core_active()) {
+		return in.Fail("not supported with the dynamic core");
+	}
+
+	CPU_Regs regs        = {};
+	Segments segs        = {};
+	CPUBlock block       = {};
+	TaskStateSegment tss = {};
+	LazyFlags flags      = {};
+	int cycles           = 0;
+	int cycle_left       = 0;
+	CPU_Decoder* decoder = nullptr;
+#if C_FPU
+	FPU_rec fpu_state = {};
+#endif
+	if (!in.Read(regs) || !in.Read(segs) || !in.Read(block) || !in.Read(tss) ||
+	    !in.Read(flags)) {
+		return false;
+	}
+#if C_FPU
+	if (!in.Read(fpu_state)) {
+		return false;
+	}
+#endif
+	if (!in.Read(cycles) || !in.Read(cycle_left) || !in.Read(decoder)) {
+		return false;
+	}
+	if (!apply) {
+		return true;
+	}
+
+	cpu_regs = regs;
+	Segs     = segs;
+	cpu      = block;
+	cpu_tss  = tss;
+	lflags   = flags;
+#if C_FPU
+	fpu = fpu_state;
+#endif
+	CPU_Cycles    = cycles;
+	CPU_CycleLeft = cycle_left;
+	cpudecoder    = decoder;
+
+	CPU_FlushDescriptorCache();
+	return true;
+}
+
 void CPU_AddConfigSection(const ConfigPtr& conf)
 {
 	assert(conf);
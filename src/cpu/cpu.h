@@ -45,6 +45,11 @@ extern int CPU_CycleLeft;
 extern bool CPU_CycleAutoAdjust;
 extern int CPU_CycleMax;
 extern int CPU_CyclePercUsed;
+// Percentage of host time the auto cycles adjustment leaves unused
+extern int CPU_CycleHeadroom;
+// Whether programs spinning on the BIOS keyboard check give up their time
+// slice the way a program waiting for a key does
+extern bool CPU_IdleOnKeyboardPolling;
 extern int CPU_CycleLimit;
 
 extern int64_t CPU_IODelayRemoved;
@@ -70,6 +75,15 @@ typedef Bits(CPU_Decoder)();
 
 extern CPU_Decoder* cpudecoder;
 
+// Size of the dynamic core's translated code cache in MB, from the
+// 'dynamic_cache_size' setting
+extern int CPU_DynamicCacheSizeMb;
+
+// Set while 'core = auto' has the dynamic core hand a protected mode
+// program over to the normal core because it rewrites its own code too
+// often to be worth translating
+extern bool CPU_AutoCoreUsesNormal;
+
 constexpr bool CPU_ReuseCodepages = true;
 #if defined(WIN32)
 constexpr bool CPU_UseRwxMemProtect = true;
@@ -130,6 +144,13 @@ void CPU_RET(bool use32, Bitu bytes, Bitu oldeip);
 void CPU_IRET(bool use32, Bitu oldeip);
 void CPU_HLT(Bitu oldeip);
 
+// Called by the cores after an 'IN AL' at linear address 'in_address' read
+// 'value' from 'port', with the next instruction at 'next_address'. Skips
+// ahead in emulated time if the IN is the start of a loop spinning on the
+// port.
+void CPU_SkipPollingLoop(PhysPt in_address, PhysPt next_address,
+                         uint16_t port, uint8_t value);
+
 bool CPU_POPF(Bitu use32);
 bool CPU_PUSHF(Bitu use32);
 bool CPU_CLI();
@@ -445,6 +466,13 @@ protected:
 	Bitu table_limit;
 };
 
+// Loads the GDT or LDT descriptor at the linear address, from the
+// descriptor cache when it's there
+void CPU_FetchDescriptor(PhysPt address, Descriptor& desc);
+
+// Empties the descriptor cache; the GDT and LDT reloads do this
+void CPU_FlushDescriptorCache();
+
 class GDTDescriptorTable final : public DescriptorTable {
 public:
 	bool GetDescriptor(Bitu selector, Descriptor& desc)
@@ -455,13 +483,13 @@ public:
 			if (address >= ldt_limit) {
 				return false;
 			}
-			desc.Load(ldt_base + nonbitu_address);
+			CPU_FetchDescriptor(ldt_base + nonbitu_address, desc);
 			return true;
 		} else {
 			if (address >= table_limit) {
 				return false;
 			}
-			desc.Load(table_base + nonbitu_address);
+			CPU_FetchDescriptor(table_base + nonbitu_address, desc);
 			return true;
 		}
 	}
@@ -489,6 +517,7 @@ public:
 	}
 	bool LLDT(Bitu value)
 	{
+		CPU_FlushDescriptorCache();
 		if ((value & 0xfffc) == 0) {
 			ldt_value = 0;
 			ldt_base  = 0;
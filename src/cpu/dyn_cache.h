@@ -2,13 +2,19 @@
 // SPDX-FileCopyrightText:  2002-2021 The DOSBox Team
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <new>
 #include <type_traits>
+#include <vector>
 
 #include "utils/mem_unaligned.h"
 #include "cpu/paging.h"
+#include "hardware/pic.h"
+#include "misc/footprint.h"
+#include "misc/health_counters.h"
+#include "misc/perf_counters.h"
 #include "misc/types.h"
 
 #if defined(HAVE_MMAP)
@@ -99,6 +105,10 @@ public:
 	} link[2] = {};                // maximum two links (conditional jumps)
 
 	CacheBlock* crossblock = {};
+
+	// where control went the last time this block ended in an indirect
+	// jump, call or return; only a guess, checked before it's used
+	CacheBlock* indirect_target = {};
 };
 
 static_assert(std::is_standard_layout_v<CacheBlock::Page>, "standard-layout is required for offsetof");
@@ -134,9 +144,27 @@ static uint8_t* cache_code_start_ptr   = {};
 static uint8_t* cache_code             = {};
 static uint8_t* cache_code_link_blocks = {};
 
-static std::vector<CacheBlock> cache_blocks(CACHE_BLOCKS);
+// The core's CACHE_TOTAL, CACHE_BLOCKS and CACHE_PAGES are the sizes at the
+// smallest 'dynamic_cache_size'; larger settings scale all three by the
+// same factor. Fixed the first time the cache is initialised.
+static struct {
+	size_t code_bytes = CACHE_TOTAL;
+	size_t num_blocks = CACHE_BLOCKS;
+	size_t num_pages  = CACHE_PAGES;
+} cache_size = {};
+
+// Blocks and code page handlers are made as the cache first needs them, up
+// to the sizes above, so the host only commits what the guest's code has
+// ever used
+static FootprintBuffer cache_block_storage = {};
+static size_t num_cache_blocks_made        = 0;
+static size_t num_code_pages_made          = 0;
 static CacheBlock link_blocks[2] = {}; // default linking (specially marked)
 
+inline PerfCounter dynrec_pages_demoted("dynrec_pages_demoted",
+                                        "Code pages handed to the normal core "
+                                        "because their code kept being rewritten.");
+
 // the CodePageHandler class provides access to the contained
 // cache blocks and intercepts writes to the code for special treatment
 class CodePageHandler final : public PageHandler {
@@ -160,6 +188,10 @@ public:
 		active_blocks=0;
 		active_count=16;
 
+		churn              = 0;
+		churn_window_start = PIC_Ticks;
+		is_demoted         = false;
+
 		// initialize the maps with zero (no cache blocks as well as
 		// code present)
 		memset(&hash_map,0,sizeof(hash_map));
@@ -182,12 +214,13 @@ public:
 		ip_point = (PAGING_GetPhysicalPage(ip_point) -
 		            check_cast<uint32_t>(phys_page << 12)) +
 		           (ip_point & 0xfff);
+		bool is_code_modified = false;
 		while (index >= 0) {
 			Bitu map=0;
 			// see if there is still some code in the range
 			for (Bitu count=start;count<=end;count++) map+=write_map[count];
 			if (!map)
-				return is_current_block; // no more code, finished
+				break; // no more code, finished
 
 			CacheBlock *block = hash_map[index];
 			while (block) {
@@ -198,14 +231,45 @@ public:
 					block->Clear(); // clear the block,
 					                // decrements the
 					                // write_map accordingly
+					is_code_modified = true;
 				}
 				block=nextblock;
 			}
 			index--;
 		}
+		if (is_code_modified) {
+			CountCodeWrite();
+		}
 		return is_current_block;
 	}
 
+	// Whether the dispatcher should leave this page to the normal core.
+	// Writes that land between translated instructions never invalidate
+	// anything, but a page whose code is rewritten over and over costs a
+	// retranslation each time, more than interpreting it. Such a page
+	// drops its blocks and runs interpreted for a while before the core
+	// gives translating it another go.
+	bool IsInterpreted()
+	{
+		if (is_demoted) {
+			if (IsDemotionPending()) {
+				return true;
+			}
+			is_demoted         = false;
+			churn              = 0;
+			churn_window_start = PIC_Ticks;
+			return false;
+		}
+		if (churn < DemoteAfterCodeWrites) {
+			return false;
+		}
+		ClearBlocks();
+		is_demoted    = true;
+		demoted_until = PIC_Ticks + DemotionMs;
+		dynrec_pages_demoted.Add();
+		return true;
+	}
+
 	uint8_t *alloc_invalidation_map() const
 	{
 		constexpr size_t map_size = 4096;
@@ -231,15 +295,13 @@ public:
 		addr&=4095;
 		if (host_readb(hostmem + addr) == val)
 			return;
+		MEM_MarkPageDirty(phys_page);
 		host_writeb(hostmem + addr, val);
 		// see if there's code where we are writing to
 		if (!write_map[addr]) {
-			if (active_blocks)
-				return; // still some blocks in this page
-			active_count--;
-			if (!active_count)
-				Release(); // delay page releasing until
-				           // active_count is zero
+			if (!active_blocks) {
+				CountIdleWrite();
+			}
 			return;
 		} else if (!invalidation_map) {
 			invalidation_map = alloc_invalidation_map();
@@ -259,15 +321,13 @@ public:
 		addr&=4095;
 		if (host_readw(hostmem + addr) == val)
 			return;
+		MEM_MarkPageDirty(phys_page);
 		host_writew(hostmem + addr, val);
 		// see if there's code where we are writing to
 		if (!read_unaligned_uint16(&write_map[addr])) {
-			if (active_blocks)
-				return; // still some blocks in this page
-			active_count--;
-			if (!active_count)
-				Release(); // delay page releasing until
-				           // active_count is zero
+			if (!active_blocks) {
+				CountIdleWrite();
+			}
 			return;
 		} else if (!invalidation_map) {
 			invalidation_map = alloc_invalidation_map();
@@ -287,15 +347,13 @@ public:
 		addr&=4095;
 		if (host_readd(hostmem + addr) == val)
 			return;
+		MEM_MarkPageDirty(phys_page);
 		host_writed(hostmem + addr, val);
 		// see if there's code where we are writing to
 		if (!read_unaligned_uint32(&write_map[addr])) {
-			if (active_blocks)
-				return; // still some blocks in this page
-			active_count--;
-			if (!active_count)
-				Release(); // delay page releasing until
-				           // active_count is zero
+			if (!active_blocks) {
+				CountIdleWrite();
+			}
 			return;
 		} else if (!invalidation_map) {
 			invalidation_map = alloc_invalidation_map();
@@ -318,10 +376,7 @@ public:
 		// see if there's code where we are writing to
 		if (!write_map[addr]) {
 			if (!active_blocks) {
-				// no blocks left in this page, still delay
-				// the page releasing a bit
-				active_count--;
-				if (!active_count) Release();
+				CountIdleWrite();
 			}
 		} else {
 			if (!invalidation_map)
@@ -333,6 +388,7 @@ public:
 				return true;
 			}
 		}
+		MEM_MarkPageDirty(phys_page);
 		host_writeb(hostmem+addr,val);
 		return false;
 	}
@@ -351,10 +407,7 @@ public:
 		// see if there's code where we are writing to
 		if (!read_unaligned_uint16(&write_map[addr])) {
 			if (!active_blocks) {
-				// no blocks left in this page, still delay
-				// the page releasing a bit
-				active_count--;
-				if (!active_count) Release();
+				CountIdleWrite();
 			}
 		} else {
 			if (!invalidation_map)
@@ -366,6 +419,7 @@ public:
 				return true;
 			}
 		}
+		MEM_MarkPageDirty(phys_page);
 		host_writew(hostmem+addr,val);
 		return false;
 	}
@@ -384,10 +438,7 @@ public:
 		// see if there's code where we are writing to
 		if (!read_unaligned_uint32(&write_map[addr])) {
 			if (!active_blocks) {
-				// no blocks left in this page, still delay
-				// the page releasing a bit
-				active_count--;
-				if (!active_count) Release();
+				CountIdleWrite();
 			}
 		} else {
 			if (!invalidation_map)
@@ -399,6 +450,7 @@ public:
 				return true;
 			}
 		}
+		MEM_MarkPageDirty(phys_page);
 		host_writed(hostmem+addr,val);
 		return false;
 	}
@@ -487,22 +539,13 @@ public:
 
 	void ClearRelease()
 	{
-		// clear out all cache blocks in this page
-		Bitu count=active_blocks;
-		CacheBlock **map=hash_map;
-		for (CacheBlock * block=*map;count;count--) {
-			while (block==nullptr)
-				block=*++map;
-			CacheBlock * nextblock=block->hash.next;
-			block->page.handler=nullptr;			// no need, full clear
-			block->Clear();
-			block=nextblock;
-		}
+		ClearBlocks();
 		Release(); // now can release this page
 	}
 
 	CacheBlock *FindCacheBlock(Bitu start)
 	{
+		MarkUsed();
 		CacheBlock *block = hash_map[1 + (start >> DYN_HASH_SHIFT)];
 		// see if there's a cache block present at the start address
 		while (block) {
@@ -534,6 +577,80 @@ public:
 	CodePageHandler *next = nullptr;
 
 private:
+	// Invalidating writes within one window that demote the page, and how
+	// long it then stays with the normal core, in emulated milliseconds
+	static constexpr uint16_t DemoteAfterCodeWrites = 64;
+	static constexpr uint32_t ChurnWindowMs         = 10;
+	static constexpr uint32_t DemotionMs            = 500;
+
+	// clear out all cache blocks in this page
+	void ClearBlocks()
+	{
+		Bitu count=active_blocks;
+		CacheBlock **map=hash_map;
+		for (CacheBlock * block=*map;count;count--) {
+			while (block==nullptr)
+				block=*++map;
+			CacheBlock * nextblock=block->hash.next;
+			block->page.handler=nullptr;			// no need, full clear
+			block->Clear();
+			block=nextblock;
+		}
+	}
+
+	void CountCodeWrite()
+	{
+		health_counters.dynrec_code_writes.Add();
+		if (PIC_Ticks - churn_window_start >= ChurnWindowMs) {
+			churn_window_start = PIC_Ticks;
+			churn              = 0;
+		}
+		if (churn < DemoteAfterCodeWrites) {
+			++churn;
+		}
+	}
+
+	bool IsDemotionPending() const
+	{
+		return is_demoted &&
+		       static_cast<int32_t>(demoted_until - PIC_Ticks) > 0;
+	}
+
+	// A write that hit no code while no blocks are left in this page;
+	// release the page after a few of those, unless it's demoted and
+	// must stay put to remember that
+	void CountIdleWrite()
+	{
+		if (active_count) {
+			--active_count;
+		}
+		if (!active_count && !IsDemotionPending()) {
+			Release();
+		}
+	}
+
+	// Keep the used-page list in least-recently-used order: looking up a
+	// block moves its page to the back, so when code pages run out the
+	// one evicted from the front is the coldest rather than the oldest.
+	void MarkUsed()
+	{
+		const bool is_used = prev || cache.used_pages == this;
+		if (!is_used || cache.last_page == this) {
+			return;
+		}
+		if (prev) {
+			prev->next = next;
+		} else {
+			cache.used_pages = next;
+		}
+		next->prev = prev;
+
+		prev = cache.last_page;
+		next = nullptr;
+		cache.last_page->next = this;
+		cache.last_page       = this;
+	}
+
 	PageHandler *old_pagehandler = nullptr;
 
 	// hash map to quickly find the cache blocks in this page
@@ -544,6 +661,12 @@ private:
 	                        // a page
 	HostPt hostmem = nullptr;
 	Bitu phys_page = 0;
+
+	// invalidating writes seen since churn_window_start
+	uint16_t churn              = 0;
+	uint32_t churn_window_start = 0;
+	bool is_demoted             = false;
+	uint32_t demoted_until      = 0;
 };
 
 static inline void cache_add_unused_block(CacheBlock *block)
@@ -557,13 +680,37 @@ static CacheBlock *cache_getblock()
 {
 	// get a free cache block and advance the free pointer
 	CacheBlock *ret = cache.block.free;
-	if (!ret)
-		E_Exit("Ran out of CacheBlocks");
+	if (!ret) {
+		if (num_cache_blocks_made == cache_size.num_blocks)
+			E_Exit("Ran out of CacheBlocks");
+		auto storage = cache_block_storage.data() +
+		               num_cache_blocks_made * sizeof(CacheBlock);
+		++num_cache_blocks_made;
+		ret = new (storage) CacheBlock();
+		ret->link[0].to = (CacheBlock *)1;
+		ret->link[1].to = (CacheBlock *)1;
+		return ret;
+	}
 	cache.block.free=ret->cache.next;
 	ret->cache.next=nullptr;
 	return ret;
 }
 
+// Makes a code page handler when none is free and the cache has fewer than
+// it's sized for
+static void cache_make_free_page()
+{
+	if (cache.free_pages || num_code_pages_made == cache_size.num_pages) {
+		return;
+	}
+	auto newpage = new (std::nothrow) CodePageHandler();
+	if (!newpage) {
+		E_Exit("DYN_CACHE: Failed to allocate code-page handler");
+	}
+	++num_code_pages_made;
+	cache.free_pages = newpage;
+}
+
 CacheBlock::~CacheBlock() {
 	cache.DeleteWriteMask();
 }
@@ -643,6 +790,8 @@ inline void CacheBlock::Cache::AddDwordToWriteMaskAt(const size_t page_index)
 
 void CacheBlock::Clear()
 {
+	health_counters.dynrec_blocks_invalidated.Add();
+	indirect_target = nullptr;
 	Bitu ind;
 	// check if this is not a cross page block
 	if (hash.index) for (ind=0;ind<2;ind++) {
@@ -687,8 +836,16 @@ void CacheBlock::Clear()
 	cache.DeleteWriteMask();
 }
 
+inline PerfCounter dynrec_cache_wraps("dynrec_cache_wraps",
+                                      "Times the dynamic core's code cache filled up and "
+                                      "started overwriting its oldest blocks.");
+inline PerfCounter dynrec_pages_evicted("dynrec_pages_evicted",
+                                        "Least recently used code pages dropped "
+                                        "to make room for new ones.");
+
 static CacheBlock *cache_openblock()
 {
+	health_counters.dynrec_blocks_compiled.Add();
 	CacheBlock *block = cache.block.active;
 	// check for enough space in this block
 	Bitu size=block->cache.size;
@@ -756,12 +913,13 @@ static void cache_closeblock()
 #if (C_DYNAMIC_X86)
 	const bool cache_is_full = !block->cache.next;
 #elif (C_DYNREC)
-	const uint8_t *limit = (cache_code_start_ptr + CACHE_TOTAL - CACHE_MAXSIZE);
+	const uint8_t *limit = (cache_code_start_ptr + cache_size.code_bytes - CACHE_MAXSIZE);
 	const bool cache_is_full = (!block->cache.next ||
 	                            (block->cache.next->cache.start > limit));
 #endif
 	if (cache_is_full) {
 		// LOG_DEBUG("Cache full; restarting");
+		dynrec_cache_wraps.Add();
 		cache.block.active=cache.block.first;
 	} else {
 		cache.block.active=block->cache.next;
@@ -840,9 +998,26 @@ static void cache_block_before_close();
 static void cache_block_closing(const uint8_t *block_start, Bitu block_size);
 #endif
 
-static constexpr size_t cache_code_size = CACHE_TOTAL + CACHE_MAXSIZE + HostPageSize - 1 + HostPageSize;
 constexpr bool is_64bit_platform = sizeof(void *) == 8;
 
+static size_t cache_code_size()
+{
+	return cache_size.code_bytes + CACHE_MAXSIZE + HostPageSize - 1 + HostPageSize;
+}
+
+static void cache_set_size(const int megabytes)
+{
+	constexpr size_t Megabyte = 1024 * 1024;
+
+	const auto factor = std::max(static_cast<size_t>(std::max(megabytes, 0)) *
+	                                     Megabyte / CACHE_TOTAL,
+	                             size_t{1});
+
+	cache_size.code_bytes = CACHE_TOTAL * factor;
+	cache_size.num_blocks = CACHE_BLOCKS * factor;
+	cache_size.num_pages  = CACHE_PAGES * factor;
+}
+
 static inline void dyn_mem_adjust(void *&ptr, size_t &size)
 {
 #if (HostPageSize == 65536)
@@ -950,6 +1125,34 @@ static inline void dyn_cache_invalidate([[maybe_unused]] void *ptr,
 
 static bool cache_initialized = false;
 
+// Drops all translated code, frees the code page handlers and hands the
+// code cache's pages back to the host. Only called between CPU slices,
+// when no translated code is running.
+static void cache_trim()
+{
+	if (!cache_initialized) {
+		return;
+	}
+	while (cache.used_pages) {
+		cache.used_pages->ClearRelease();
+	}
+	while (cache.free_pages) {
+		const auto page  = cache.free_pages;
+		cache.free_pages = page->next;
+		delete[] page->invalidation_map;
+		delete page;
+	}
+	num_code_pages_made = 0;
+
+	FOOTPRINT_ReleasePages(cache_code, cache_size.code_bytes);
+}
+
+static FootprintRegion cache_code_region("dynrec_code_cache",
+                                         "Code translated by the dynamic core.",
+                                         cache_trim);
+static FootprintRegion cache_blocks_region("dynrec_cache_blocks",
+                                           "The dynamic core's translated blocks.");
+
 static void cache_init(bool enable) {
 	if (enable) {
 		// see if cache is already initialized
@@ -957,23 +1160,23 @@ static void cache_init(bool enable) {
 			return;
 		}
 		cache_initialized = true;
-		cache.block.free = &cache_blocks[0];
-		// initialize the cache blocks
-		for (int i=0;i<CACHE_BLOCKS-1;i++) {
-			cache_blocks[i].link[0].to = (CacheBlock *)1;
-			cache_blocks[i].link[1].to = (CacheBlock *)1;
-			cache_blocks[i].cache.next = &cache_blocks[i + 1];
+		if (!cache_block_storage.data()) {
+			cache_set_size(CPU_DynamicCacheSizeMb);
+			cache_block_storage = FootprintBuffer(cache_size.num_blocks *
+			                                      sizeof(CacheBlock));
+			cache_blocks_region.Track(cache_block_storage.data(),
+			                          cache_block_storage.size());
 		}
 		if (cache_code_start_ptr == nullptr) {
 			// allocate the code cache memory
 #if defined (WIN32)
 			LPVOID lp_vmem = nullptr;
 			if (CPU_UseRwxMemProtect) {
-				lp_vmem = VirtualAlloc(nullptr, cache_code_size,
+				lp_vmem = VirtualAlloc(nullptr, cache_code_size(),
 				                       MEM_COMMIT,
 				                       PAGE_EXECUTE_READWRITE); // all operations allowed
 			} else {
-				lp_vmem = VirtualAlloc(nullptr, cache_code_size,
+				lp_vmem = VirtualAlloc(nullptr, cache_code_size(),
 				                       MEM_COMMIT | MEM_RESERVE,
 				                       PAGE_READWRITE); // needs on-going management
 			}
@@ -985,12 +1188,12 @@ static void cache_init(bool enable) {
 #if defined(HAVE_MAP_JIT)
 			map_flags |= MAP_JIT;
 #endif
-			cache_code_start_ptr=static_cast<uint8_t *>(mmap(nullptr, cache_code_size, prot_flags, map_flags, -1, 0));
+			cache_code_start_ptr=static_cast<uint8_t *>(mmap(nullptr, cache_code_size(), prot_flags, map_flags, -1, 0));
 			if (cache_code_start_ptr == MAP_FAILED) {
 				E_Exit("DYNCACHE: Failed memory-mapping cache memory because: %s", strerror(errno));
 			}
 #else
-			cache_code_start_ptr=static_cast<uint8_t *>(malloc(cache_code_size));
+			cache_code_start_ptr=static_cast<uint8_t *>(malloc(cache_code_size()));
 			if (!cache_code_start_ptr) {
 				E_Exit("DYNCACHE: Failed allocating cache memory because: %s", strerror(errno));
 			}
@@ -1006,8 +1209,10 @@ static void cache_init(bool enable) {
 			cache.block.first=block;
 			cache.block.active=block;
 			block->cache.start=&cache_code[0];
-			block->cache.size=CACHE_TOTAL;
+			block->cache.size=cache_size.code_bytes;
 			block->cache.next = nullptr; // last block in the list
+
+			cache_code_region.Track(cache_code_start_ptr, cache_code_size());
 		}
 
 		auto cache_addr = static_cast<void *>(cache_code);
@@ -1055,15 +1260,6 @@ static void cache_init(bool enable) {
 		cache.free_pages=nullptr;
 		cache.last_page=nullptr;
 		cache.used_pages=nullptr;
-		// setup the code pages
-		for (int i=0;i<CACHE_PAGES;i++) {
-			auto newpage = new (std::nothrow) CodePageHandler();
-			if (!newpage) {
-				E_Exit("DYN_CACHE: Failed to allocate code-page handler");
-			}
-			newpage->next = cache.free_pages;
-			cache.free_pages=newpage;
-		}
 	}
 }
 
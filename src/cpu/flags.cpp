@@ -8,6 +8,10 @@
 
 #include "dosbox.h"
 
+#include <array>
+#include <cassert>
+#include <utility>
+
 #include "cpu/cpu.h"
 #include "hardware/pic.h"
 #include "lazyflags.h"
@@ -17,8 +21,9 @@ LazyFlags lflags;
 /* CF     Carry Flag -- Set on high-order bit carry or borrow; cleared
           otherwise.
 */
-uint32_t get_CF(void) {
-	switch (lflags.type) {
+template <uint_fast8_t Type>
+static uint32_t get_CF_for_type() {
+	switch (Type) {
 	case t_UNKNOWN:
 	case t_INCb:
 	case t_INCw:
@@ -106,8 +111,9 @@ uint32_t get_CF(void) {
             four bits of   AL; cleared otherwise. Used for decimal
             arithmetic.
 */
-uint32_t get_AF(void) {
-	switch (lflags.type) {
+template <uint_fast8_t Type>
+static uint32_t get_AF_for_type() {
+	switch (Type) {
 	case t_UNKNOWN:
 		return GETFLAG(AF);
 	case t_ADDb:	
@@ -186,8 +192,9 @@ uint32_t get_AF(void) {
 /* ZF     Zero Flag -- Set if result is zero; cleared otherwise.
 */
 
-uint32_t get_ZF(void) {
-	switch (lflags.type) {
+template <uint_fast8_t Type>
+static uint32_t get_ZF_for_type() {
+	switch (Type) {
 	case t_UNKNOWN:
 		return GETFLAG(ZF);
 	case t_ADDb:	
@@ -253,8 +260,9 @@ uint32_t get_ZF(void) {
 /* SF     Sign Flag -- Set equal to high-order bit of result (0 is
             positive, 1 if negative).
 */
-uint32_t get_SF(void) {
-	switch (lflags.type) {
+template <uint_fast8_t Type>
+static uint32_t get_SF_for_type() {
+	switch (Type) {
 	case t_UNKNOWN:
 		return GETFLAG(SF);
 	case t_ADDb:
@@ -318,8 +326,9 @@ uint32_t get_SF(void) {
 	return false;
 
 }
-uint32_t get_OF(void) {
-	switch (lflags.type) {
+template <uint_fast8_t Type>
+static uint32_t get_OF_for_type() {
+	switch (Type) {
 	case t_UNKNOWN:
 	case t_MUL:
 		return GETFLAG(OF);
@@ -424,8 +433,9 @@ uint16_t parity_lookup[256] = {
   FLAG_PF, 0, 0, FLAG_PF, 0, FLAG_PF, FLAG_PF, 0, 0, FLAG_PF, FLAG_PF, 0, FLAG_PF, 0, 0, FLAG_PF
   };
 
-uint32_t get_PF(void) {
-	switch (lflags.type) {
+template <uint_fast8_t Type>
+static uint32_t get_PF_for_type() {
+	switch (Type) {
 	case t_UNKNOWN:
 		return GETFLAG(PF);
 	default:
@@ -434,6 +444,102 @@ uint32_t get_PF(void) {
 	return 0;
 }
 
+/*
+	Every query indexes a table of evaluators by the lazy flag type instead
+	of switching on it; each entry is one of the functions above with its
+	switch resolved at compile time. The conditions of Jcc, SETcc and
+	CMOVcc get fused evaluators of their own, so testing one costs a single
+	indirect call however many flags it combines.
+*/
+
+constexpr size_t NumLazyFlagTypes = t_LASTFLAG + 1;
+
+#define LAZY_FLAG_TYPE_TABLE(EVALUATOR) \
+	[]<size_t... Types>(std::index_sequence<Types...>) { \
+		return std::array{&EVALUATOR<static_cast<uint_fast8_t>(Types)>...}; \
+	}(std::make_index_sequence<NumLazyFlagTypes>{})
+
+static constexpr auto cf_evaluators = LAZY_FLAG_TYPE_TABLE(get_CF_for_type);
+static constexpr auto af_evaluators = LAZY_FLAG_TYPE_TABLE(get_AF_for_type);
+static constexpr auto zf_evaluators = LAZY_FLAG_TYPE_TABLE(get_ZF_for_type);
+static constexpr auto sf_evaluators = LAZY_FLAG_TYPE_TABLE(get_SF_for_type);
+static constexpr auto of_evaluators = LAZY_FLAG_TYPE_TABLE(get_OF_for_type);
+static constexpr auto pf_evaluators = LAZY_FLAG_TYPE_TABLE(get_PF_for_type);
+
+static uint_fast8_t checked_lazy_flag_type()
+{
+	assert(lflags.type < NumLazyFlagTypes);
+	return lflags.type;
+}
+
+uint32_t get_CF(void) {
+	return cf_evaluators[checked_lazy_flag_type()]();
+}
+
+uint32_t get_AF(void) {
+	return af_evaluators[checked_lazy_flag_type()]();
+}
+
+uint32_t get_ZF(void) {
+	return zf_evaluators[checked_lazy_flag_type()]();
+}
+
+uint32_t get_SF(void) {
+	return sf_evaluators[checked_lazy_flag_type()]();
+}
+
+uint32_t get_OF(void) {
+	return of_evaluators[checked_lazy_flag_type()]();
+}
+
+uint32_t get_PF(void) {
+	return pf_evaluators[checked_lazy_flag_type()]();
+}
+
+template <FlagCondition Condition, uint_fast8_t Type>
+static bool test_condition_for_type()
+{
+	const auto sf_is_not_of = [] {
+		return (get_SF_for_type<Type>() != 0) != (get_OF_for_type<Type>() != 0);
+	};
+	switch (Condition) {
+	case FlagCondition::O: return get_OF_for_type<Type>();
+	case FlagCondition::NO: return !get_OF_for_type<Type>();
+	case FlagCondition::B: return get_CF_for_type<Type>();
+	case FlagCondition::NB: return !get_CF_for_type<Type>();
+	case FlagCondition::Z: return get_ZF_for_type<Type>();
+	case FlagCondition::NZ: return !get_ZF_for_type<Type>();
+	case FlagCondition::BE:
+		return get_CF_for_type<Type>() || get_ZF_for_type<Type>();
+	case FlagCondition::NBE:
+		return !get_CF_for_type<Type>() && !get_ZF_for_type<Type>();
+	case FlagCondition::S: return get_SF_for_type<Type>();
+	case FlagCondition::NS: return !get_SF_for_type<Type>();
+	case FlagCondition::P: return get_PF_for_type<Type>();
+	case FlagCondition::NP: return !get_PF_for_type<Type>();
+	case FlagCondition::L: return sf_is_not_of();
+	case FlagCondition::NL: return !sf_is_not_of();
+	case FlagCondition::LE: return get_ZF_for_type<Type>() || sf_is_not_of();
+	case FlagCondition::NLE: return !get_ZF_for_type<Type>() && !sf_is_not_of();
+	}
+	return false;
+}
+
+template <size_t Condition>
+static constexpr auto condition_row()
+{
+	return []<size_t... Types>(std::index_sequence<Types...>) {
+		return std::array<FlagConditionTest, NumLazyFlagTypes>{
+		        &test_condition_for_type<static_cast<FlagCondition>(Condition),
+		                                 static_cast<uint_fast8_t>(Types)>...};
+	}(std::make_index_sequence<NumLazyFlagTypes>{});
+}
+
+constinit const FlagConditionTests flag_condition_tests =
+        []<size_t... Conditions>(std::index_sequence<Conditions...>) {
+	        return std::array{condition_row<Conditions>()...};
+        }(std::make_index_sequence<NumFlagConditions>{});
+
 
 #if 0
 
@@ -469,8 +575,9 @@ uint32_t FillFlags(void) {
 
 #define SET_FLAG SETFLAGBIT
 
-uint32_t FillFlags(void) {
-	switch (lflags.type) {
+template <uint_fast8_t Type>
+static uint32_t fill_flags_for_type() {
+	switch (Type) {
 	case t_UNKNOWN:
 		break;
 	case t_ADDb:	
@@ -809,8 +916,9 @@ uint32_t FillFlags(void) {
 	return reg_flags;
 }
 
-void FillFlagsNoCFOF(void) {
-	switch (lflags.type) {
+template <uint_fast8_t Type>
+static void fill_flags_no_cf_of_for_type() {
+	switch (Type) {
 	case t_UNKNOWN:
 		return;
 	case t_ADDb:	
@@ -1033,6 +1141,18 @@ void FillFlagsNoCFOF(void) {
 	lflags.type=t_UNKNOWN;
 }
 
+static constexpr auto fill_flags_evaluators = LAZY_FLAG_TYPE_TABLE(fill_flags_for_type);
+static constexpr auto fill_flags_no_cf_of_evaluators = LAZY_FLAG_TYPE_TABLE(
+        fill_flags_no_cf_of_for_type);
+
+uint32_t FillFlags(void) {
+	return fill_flags_evaluators[checked_lazy_flag_type()]();
+}
+
+void FillFlagsNoCFOF(void) {
+	fill_flags_no_cf_of_evaluators[checked_lazy_flag_type()]();
+}
+
 // Helper function to assess a value for the parity flag, which indicates
 // whether the modulo 2 sum of the low-order eight bits of the result is even
 // (PF=O) or odd (PF=1).
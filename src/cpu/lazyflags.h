@@ -6,7 +6,10 @@
 
 #include "cpu/cpu.h"
 
+#include <array>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 
 // Flag Handling
 uint32_t get_CF();
@@ -109,21 +112,41 @@ inline void SETFLAGSd(const uint32_t FLAGD)
 #define LoadOF SETFLAGBIT(OF, get_OF());
 #define LoadAF SETFLAGBIT(AF, get_AF());
 
-#define TFLG_O   (get_OF())
-#define TFLG_NO  (!get_OF())
-#define TFLG_B   (get_CF())
-#define TFLG_NB  (!get_CF())
-#define TFLG_Z   (get_ZF())
-#define TFLG_NZ  (!get_ZF())
-#define TFLG_BE  (get_CF() || get_ZF())
-#define TFLG_NBE (!get_CF() && !get_ZF())
-#define TFLG_S   (get_SF())
-#define TFLG_NS  (!get_SF())
-#define TFLG_P   (get_PF())
-#define TFLG_NP  (!get_PF())
-#define TFLG_L   ((get_SF() != 0) != (get_OF() != 0))
-#define TFLG_NL  ((get_SF() != 0) == (get_OF() != 0))
-#define TFLG_LE  (get_ZF() || ((get_SF() != 0) != (get_OF() != 0)))
-#define TFLG_NLE (!get_ZF() && ((get_SF() != 0) == (get_OF() != 0)))
+// The conditions of Jcc, SETcc and CMOVcc, in the order of their encoding
+enum class FlagCondition : uint8_t {
+	O, NO, B, NB, Z, NZ, BE, NBE, S, NS, P, NP, L, NL, LE, NLE
+};
+constexpr size_t NumFlagConditions = 16;
+
+using FlagConditionTest = bool (*)();
+
+using FlagConditionTests = std::array<std::array<FlagConditionTest, t_LASTFLAG + 1>,
+                                      NumFlagConditions>;
+
+// Fused evaluators of each condition for each type of lazy flags
+extern const FlagConditionTests flag_condition_tests;
+
+inline bool TestFlagCondition(const FlagCondition condition)
+{
+	assert(lflags.type <= t_LASTFLAG);
+	return flag_condition_tests[static_cast<size_t>(condition)][lflags.type]();
+}
+
+#define TFLG_O   (TestFlagCondition(FlagCondition::O))
+#define TFLG_NO  (TestFlagCondition(FlagCondition::NO))
+#define TFLG_B   (TestFlagCondition(FlagCondition::B))
+#define TFLG_NB  (TestFlagCondition(FlagCondition::NB))
+#define TFLG_Z   (TestFlagCondition(FlagCondition::Z))
+#define TFLG_NZ  (TestFlagCondition(FlagCondition::NZ))
+#define TFLG_BE  (TestFlagCondition(FlagCondition::BE))
+#define TFLG_NBE (TestFlagCondition(FlagCondition::NBE))
+#define TFLG_S   (TestFlagCondition(FlagCondition::S))
+#define TFLG_NS  (TestFlagCondition(FlagCondition::NS))
+#define TFLG_P   (TestFlagCondition(FlagCondition::P))
+#define TFLG_NP  (TestFlagCondition(FlagCondition::NP))
+#define TFLG_L   (TestFlagCondition(FlagCondition::L))
+#define TFLG_NL  (TestFlagCondition(FlagCondition::NL))
+#define TFLG_LE  (TestFlagCondition(FlagCondition::LE))
+#define TFLG_NLE (TestFlagCondition(FlagCondition::NLE))
 
 #endif
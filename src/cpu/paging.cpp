@@ -4,6 +4,7 @@
 
 #include "cpu/paging.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
@@ -15,6 +16,10 @@
 #include "debugger/debugger.h"
 #include "hardware/memory.h"
 #include "lazyflags.h"
+#include "misc/footprint.h"
+#include "misc/health_counters.h"
+#include "misc/perf_counters.h"
+#include "misc/savestate.h"
 
 #define LINK_TOTAL		(64*1024)
 
@@ -23,6 +28,12 @@
 
 PagingBlock paging;
 
+static PerfCounter tlb_flushes("tlb_flushes", "Times the whole TLB was flushed.");
+static PerfCounter tlb_flushed_entries("tlb_flushed_entries",
+                                       "TLB entries dropped by whole-TLB flushes.");
+static PerfCounter tlb_page_invalidations("tlb_page_invalidations",
+                                          "Single TLB entries dropped by INVLPG.");
+
 uint8_t PageHandler::readb(PhysPt addr)
 {
 	E_Exit("No byte handler for read from %d",addr);	
@@ -120,6 +131,18 @@ bool PageHandler::writeq_checked(PhysPt addr, uint64_t val)
 	return false;
 }
 
+bool PageHandler::fillb(PhysPt /*addr*/, uint8_t /*val*/,
+                        uint32_t /*num_bytes*/, uint32_t /*num_writes*/)
+{
+	return false;
+}
+
+bool PageHandler::writeblock(PhysPt /*addr*/, const uint8_t* /*src*/,
+                             uint32_t /*num_bytes*/, uint32_t /*num_writes*/)
+{
+	return false;
+}
+
 struct PF_Entry {
 	uint32_t cs;
 	uint32_t eip;
@@ -378,6 +401,8 @@ public:
 	}
 	uint32_t InitPage(uint32_t lin_addr, bool writing)
 	{
+		health_counters.tlb_misses.Add();
+
 		const auto lin_page = lin_addr >> 12;
 		uint32_t phys_page;
 		if (paging.enabled) {
@@ -557,6 +582,14 @@ public:
 	}
 };
 
+// Writes let through to a page linked read-only land behind its read
+// pointer, out of sight of the dirty page tracking, so they mark the page
+static inline HostPt read_link_write_pt(const PhysPt addr)
+{
+	MEM_MarkPageDirty(PAGING_GetPhysicalPage(addr) / MemPageSize);
+	return get_tlb_read(addr) + addr;
+}
+
 class InitPageUserROHandler final : public PageHandler {
 public:
 	InitPageUserROHandler() {
@@ -565,26 +598,34 @@ public:
 	void writeb(PhysPt addr, uint8_t val) override
 	{
 		InitPage(addr, val);
-		host_writeb(get_tlb_read(addr) + addr, val);
+		host_writeb(read_link_write_pt(addr), val);
 	}
 	void writew(PhysPt addr, uint16_t val) override
 	{
 		InitPage(addr, val);
-		host_writew(get_tlb_read(addr) + addr, val);
+		host_writew(read_link_write_pt(addr), val);
 	}
 	void writed(PhysPt addr, uint32_t val) override
 	{
 		InitPage(addr, val);
-		host_writed(get_tlb_read(addr) + addr, val);
+		host_writed(read_link_write_pt(addr), val);
 	}
 	bool writeb_checked(PhysPt addr, uint8_t val) override
 	{
 		const auto writecode = InitPageCheckOnly(addr, val);
+		if (writecode > 1) {
+			host_writeb(read_link_write_pt(addr), val);
+			return false;
+		}
 		if (writecode) {
-			HostPt tlb_addr;
-			if (writecode>1) tlb_addr=get_tlb_read(addr);
-			else tlb_addr=get_tlb_write(addr);
-			host_writeb(tlb_addr + addr, val);
+			// Without a write pointer, such as for pages the dirty page
+			// tracking still considers clean, the handler takes it
+			const auto tlb_addr = get_tlb_write(addr);
+			if (tlb_addr) {
+				host_writeb(tlb_addr + addr, val);
+			} else {
+				get_tlb_writehandler(addr)->writeb(addr, val);
+			}
 			return false;
 		}
 		return true;
@@ -592,11 +633,19 @@ public:
 	bool writew_checked(PhysPt addr, uint16_t val) override
 	{
 		const auto writecode = InitPageCheckOnly(addr, val);
+		if (writecode > 1) {
+			host_writew(read_link_write_pt(addr), val);
+			return false;
+		}
 		if (writecode) {
-			HostPt tlb_addr;
-			if (writecode>1) tlb_addr=get_tlb_read(addr);
-			else tlb_addr=get_tlb_write(addr);
-			host_writew(tlb_addr + addr, val);
+			// Without a write pointer, such as for pages the dirty page
+			// tracking still considers clean, the handler takes it
+			const auto tlb_addr = get_tlb_write(addr);
+			if (tlb_addr) {
+				host_writew(tlb_addr + addr, val);
+			} else {
+				get_tlb_writehandler(addr)->writew(addr, val);
+			}
 			return false;
 		}
 		return true;
@@ -604,11 +653,19 @@ public:
 	bool writed_checked(PhysPt addr, uint32_t val) override
 	{
 		const auto writecode = InitPageCheckOnly(addr, val);
+		if (writecode > 1) {
+			host_writed(read_link_write_pt(addr), val);
+			return false;
+		}
 		if (writecode) {
-			HostPt tlb_addr;
-			if (writecode>1) tlb_addr=get_tlb_read(addr);
-			else tlb_addr=get_tlb_write(addr);
-			host_writed(tlb_addr + addr, val);
+			// Without a write pointer, such as for pages the dirty page
+			// tracking still considers clean, the handler takes it
+			const auto tlb_addr = get_tlb_write(addr);
+			if (tlb_addr) {
+				host_writed(tlb_addr + addr, val);
+			} else {
+				get_tlb_writehandler(addr)->writed(addr, val);
+			}
 			return false;
 		}
 		return true;
@@ -761,27 +818,89 @@ bool PAGING_ForcePageInit(Bitu lin_addr) {
 	return false;
 }
 
+static void count_flush()
+{
+	if (paging.links.used > 0) {
+		tlb_flushes.Add();
+		tlb_flushed_entries.Add(paging.links.used);
+	}
+}
+
+// Grows the list of linked pages before it resets the whole TLB. The
+// list can hold a page more than once, after INVLPG or a page being
+// relinked on a write, so leave room for all of RAM twice over. Guests
+// with a lot of memory then no longer flush just for having touched it.
+static void make_room_for_link()
+{
+	auto& entries = paging.links.entries;
+	if (paging.links.used < entries.size()) {
+		return;
+	}
+	const size_t max_links = std::max<size_t>(PAGING_LINKS,
+	                                          size_t{MEM_TotalPages()} * 2);
+	if (entries.size() < max_links) {
+		entries.resize(std::min(entries.size() * 2, max_links));
+		return;
+	}
+	LOG(LOG_PAGING,LOG_NORMAL)("Not enough paging links, resetting cache");
+	PAGING_ClearTLB();
+	assert(paging.links.used == 0);
+}
+
+void PAGING_InvalidatePage(const Bitu lin_addr)
+{
+	tlb_page_invalidations.Add();
+	MEM_DropWriteWatches();
+	PAGING_UnlinkPages(lin_addr >> 12, 1);
+}
+
+// The list can hold pages that were unlinked since, which are harmless to
+// unlink again
+void PAGING_UnlinkPhysicalPage(const uint32_t phys_page)
+{
+	for (uint32_t i = 0; i < paging.links.used; ++i) {
+		const auto lin_page = paging.links.entries[i];
+		if (PAGING_GetPhysicalPage(lin_page << 12) >> 12 == phys_page) {
+			PAGING_UnlinkPages(lin_page, 1);
+		}
+	}
+}
+
 #if defined(USE_FULL_TLB)
+PageHandler* PAGING_GetInitPageHandler()
+{
+	return &init_page_handler;
+}
+
+// With no pages linked the TLB is all zeros, so trimming unlinks them all
+// and hands the pages back to the host
+static FootprintRegion tlb_region("paging_tlb",
+                                  "The TLB's host pointers and page handlers.",
+                                  [] {
+	                                  PAGING_ClearTLB();
+	                                  FOOTPRINT_ReleasePages(&paging.tlb,
+	                                                         sizeof(paging.tlb));
+                                  });
+
 void PAGING_InitTLB()
 {
-	for (auto i=0;i<TLB_SIZE;i++) {
-		paging.tlb.read[i]=nullptr;
-		paging.tlb.write[i]=nullptr;
-		paging.tlb.readhandler[i]=&init_page_handler;
-		paging.tlb.writehandler[i]=&init_page_handler;
-	}
+	// The low memory profile releases the pages rather than writing
+	// 40 MB of zeros, and only the pages the guest touches come back
+	FOOTPRINT_ZeroPages(&paging.tlb, sizeof(paging.tlb));
 	paging.links.used=0;
 }
 
 void PAGING_ClearTLB()
 {
+	count_flush();
+	MEM_DropWriteWatches();
 	uint32_t * entries=&paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		const auto page=*entries++;
 		paging.tlb.read[page]=nullptr;
 		paging.tlb.write[page]=nullptr;
-		paging.tlb.readhandler[page]=&init_page_handler;
-		paging.tlb.writehandler[page]=&init_page_handler;
+		paging.tlb.readhandler[page]=nullptr;
+		paging.tlb.writehandler[page]=nullptr;
 	}
 	paging.links.used=0;
 }
@@ -790,19 +909,20 @@ void PAGING_UnlinkPages(Bitu lin_page,Bitu pages) {
 	for (;pages>0;pages--) {
 		paging.tlb.read[lin_page]=nullptr;
 		paging.tlb.write[lin_page]=nullptr;
-		paging.tlb.readhandler[lin_page]=&init_page_handler;
-		paging.tlb.writehandler[lin_page]=&init_page_handler;
+		paging.tlb.readhandler[lin_page]=nullptr;
+		paging.tlb.writehandler[lin_page]=nullptr;
 		lin_page++;
 	}
 }
 
 void PAGING_MapPage(Bitu lin_page,Bitu phys_page) {
+	MEM_DropWriteWatches();
 	if (lin_page<LINK_START) {
 		paging.firstmb[lin_page]=phys_page;
 		paging.tlb.read[lin_page]=nullptr;
 		paging.tlb.write[lin_page]=nullptr;
-		paging.tlb.readhandler[lin_page]=&init_page_handler;
-		paging.tlb.writehandler[lin_page]=&init_page_handler;
+		paging.tlb.readhandler[lin_page]=nullptr;
+		paging.tlb.writehandler[lin_page]=nullptr;
 	} else {
 		PAGING_LinkPage(lin_page,phys_page);
 	}
@@ -814,17 +934,17 @@ void PAGING_LinkPage(uint32_t lin_page,uint32_t phys_page) {
 	if (lin_page>=TLB_SIZE || phys_page>=TLB_SIZE) 
 		E_Exit("Illegal page");
 
-	if (paging.links.used >= PAGING_LINKS) {
-		LOG(LOG_PAGING,LOG_NORMAL)("Not enough paging links, resetting cache");
-		PAGING_ClearTLB();
-		assert(paging.links.used == 0);
-	}
+	make_room_for_link();
 
 	paging.tlb.phys_page[lin_page]=phys_page;
 	if (handler->flags & PFLAG_READABLE) paging.tlb.read[lin_page]=handler->GetHostReadPt(phys_page)-lin_base;
 	else paging.tlb.read[lin_page]=nullptr;
-	if (handler->flags & PFLAG_WRITEABLE) paging.tlb.write[lin_page]=handler->GetHostWritePt(phys_page)-lin_base;
-	else paging.tlb.write[lin_page]=nullptr;
+	// A writeable handler may still want to see the writes to some of
+	// its pages, and hands out no write pointer for those
+	const auto write_pt = (handler->flags & PFLAG_WRITEABLE)
+	                            ? handler->GetHostWritePt(phys_page)
+	                            : nullptr;
+	paging.tlb.write[lin_page] = write_pt ? write_pt - lin_base : nullptr;
 
 	paging.links.entries[paging.links.used++]=lin_page;
 	paging.tlb.readhandler[lin_page]=handler;
@@ -837,11 +957,7 @@ void PAGING_LinkPage_ReadOnly(uint32_t lin_page,uint32_t phys_page) {
 	if (lin_page>=TLB_SIZE || phys_page>=TLB_SIZE) 
 		E_Exit("Illegal page");
 
-	if (paging.links.used >= PAGING_LINKS) {
-		LOG(LOG_PAGING,LOG_NORMAL)("Not enough paging links, resetting cache");
-		PAGING_ClearTLB();
-		assert(paging.links.used == 0);
-	}
+	make_room_for_link();
 
 	paging.tlb.phys_page[lin_page]=phys_page;
 	if (handler->flags & PFLAG_READABLE) paging.tlb.read[lin_page]=handler->GetHostReadPt(phys_page)-lin_base;
@@ -878,6 +994,8 @@ void PAGING_InitTLB()
 
 void PAGING_ClearTLB()
 {
+	count_flush();
+	MEM_DropWriteWatches();
 	uint32_t* entries = &paging.links.entries[0];
 	for (;paging.links.used>0;paging.links.used--) {
 		Bitu page=*entries++;
@@ -902,6 +1020,7 @@ void PAGING_UnlinkPages(Bitu lin_page,Bitu pages) {
 }
 
 void PAGING_MapPage(Bitu lin_page,Bitu phys_page) {
+	MEM_DropWriteWatches();
 	if (lin_page<LINK_START) {
 		paging.firstmb[lin_page]=phys_page;
 		paging.tlbh[lin_page].read=0;
@@ -920,17 +1039,18 @@ void PAGING_LinkPage(uint32_t lin_page, uint32_t phys_page)
 	if (lin_page>=(TLB_SIZE*(TLB_BANKS+1)) || phys_page>=(TLB_SIZE*(TLB_BANKS+1))) 
 		E_Exit("Illegal page");
 
-	if (paging.links.used>=PAGING_LINKS) {
-		LOG(LOG_PAGING,LOG_NORMAL)("Not enough paging links, resetting cache");
-		PAGING_ClearTLB();
-	}
+	make_room_for_link();
 
 	tlb_entry *entry = get_tlb_entry(lin_base);
 	entry->phys_page=phys_page;
 	if (handler->flags & PFLAG_READABLE) entry->read=handler->GetHostReadPt(phys_page)-lin_base;
 	else entry->read=0;
-	if (handler->flags & PFLAG_WRITEABLE) entry->write=handler->GetHostWritePt(phys_page)-lin_base;
-	else entry->write=0;
+	// A writeable handler may still want to see the writes to some of
+	// its pages, and hands out no write pointer for those
+	const auto write_pt = (handler->flags & PFLAG_WRITEABLE)
+	                            ? handler->GetHostWritePt(phys_page)
+	                            : nullptr;
+	entry->write = write_pt ? write_pt - lin_base : nullptr;
 
  	paging.links.entries[paging.links.used++]=lin_page;
 	entry->readhandler=handler;
@@ -944,10 +1064,7 @@ void PAGING_LinkPage_ReadOnly(uint32_t lin_page, uint32_t phys_page)
 	if (lin_page>=(TLB_SIZE*(TLB_BANKS+1)) || phys_page>=(TLB_SIZE*(TLB_BANKS+1))) 
 		E_Exit("Illegal page");
 
-	if (paging.links.used>=PAGING_LINKS) {
-		LOG(LOG_PAGING,LOG_NORMAL)("Not enough paging links, resetting cache");
-		PAGING_ClearTLB();
-	}
+	make_room_for_link();
 
 	tlb_entry *entry = get_tlb_entry(lin_base);
 	entry->phys_page=phys_page;
@@ -998,12 +1115,50 @@ bool PAGING_Enabled()
 	return paging.enabled;
 }
 
+// The TLB only caches what the page tables and the first-megabyte map say,
+// so it is rebuilt on demand rather than saved
+void PAGING_SaveState(SaveStateWriter& out)
+{
+	out.Write(paging.cr3);
+	out.Write(paging.cr2);
+	out.Write(paging.enabled);
+	out.WriteBytes(paging.firstmb.data(), paging.firstmb.size() * sizeof(uint32_t));
+}
+
+bool PAGING_LoadState(SaveStateReader& in, const bool apply)
+{
+	uint32_t cr3 = 0;
+	uint32_t cr2 = 0;
+	bool enabled = false;
+	if (!in.Read(cr3) || !in.Read(cr2) || !in.Read(enabled)) {
+		return false;
+	}
+	const auto firstmb = in.Take(paging.firstmb.size() * sizeof(uint32_t));
+	if (!firstmb) {
+		return false;
+	}
+	if (!apply) {
+		return true;
+	}
+
+	PAGING_ClearTLB();
+	PAGING_InitTLB();
+	std::memcpy(paging.firstmb.data(), firstmb, paging.firstmb.size() * sizeof(uint32_t));
+	paging.cr2     = cr2;
+	paging.enabled = enabled;
+	PAGING_SetDirBase(cr3);
+	return true;
+}
+
 class PAGING final : public ModuleBase{
 public:
 	PAGING(Section* configuration):ModuleBase(configuration){
 		/* Setup default Page Directory, force it to update */
 		paging.enabled=false;
 		PAGING_InitTLB();
+#if defined(USE_FULL_TLB)
+		tlb_region.Track(&paging.tlb, sizeof(paging.tlb));
+#endif
 		for (auto i=0;i<LINK_START;i++) {
 			paging.firstmb[i]=i;
 		}
@@ -65,6 +65,18 @@ public:
 	virtual bool writed_checked(PhysPt addr, uint32_t val);
 	virtual bool writeq_checked(PhysPt addr, uint64_t val);
 
+	// Span writes for REP STOS and MOVS: 'num_bytes' bytes at ascending
+	// addresses from 'addr', all in one page, that the string operation
+	// would have done as 'num_writes' equally sized writes. fillb writes
+	// 'val' to every byte and writeblock copies the bytes from 'src'.
+	// Handlers that can do a whole span faster than one write at a time,
+	// and don't care about the order of the writes, override them; the
+	// default returns false to have the caller write element by element.
+	virtual bool fillb(PhysPt addr, uint8_t val, uint32_t num_bytes,
+	                   uint32_t num_writes);
+	virtual bool writeblock(PhysPt addr, const uint8_t* src,
+	                        uint32_t num_bytes, uint32_t num_writes);
+
 	uint_fast8_t flags = 0x0;
 };
 
@@ -76,10 +88,15 @@ Bitu PAGING_GetDirBase();
 void PAGING_SetDirBase(Bitu cr3);
 void PAGING_InitTLB();
 void PAGING_ClearTLB();
+// Drops the TLB entry of the page holding the linear address, for INVLPG
+void PAGING_InvalidatePage(Bitu lin_addr);
 
 void PAGING_LinkPage(uint32_t lin_page,uint32_t phys_page);
 void PAGING_LinkPage_ReadOnly(uint32_t lin_page,uint32_t phys_page);
 void PAGING_UnlinkPages(Bitu lin_page,Bitu pages);
+
+// Unlinks every linear page the TLB has linked to the physical page
+void PAGING_UnlinkPhysicalPage(uint32_t phys_page);
 /* This maps the page directly, only use when paging is disabled */
 void PAGING_MapPage(Bitu lin_page,Bitu phys_page);
 bool PAGING_MakePhysPage(Bitu & page);
@@ -197,15 +214,19 @@ struct PagingBlock {
 		PhysPt addr   = {};
 	} base = {};
 #if defined(USE_FULL_TLB)
+	// About 40 MB, left without initializers: the block has static
+	// storage, so it starts out zeroed, and its constructor doesn't
+	// touch, and thereby commit, every page. A null handler is a page
+	// that isn't linked, which the init page handler serves.
 	struct {
-		HostPt read[TLB_SIZE]  = {};
-		HostPt write[TLB_SIZE] = {};
+		HostPt read[TLB_SIZE];
+		HostPt write[TLB_SIZE];
 
-		std::vector<PageHandler*> readhandler  = std::vector<PageHandler*>(TLB_SIZE);
-		std::vector<PageHandler*> writehandler = std::vector<PageHandler*>(TLB_SIZE);
+		PageHandler* readhandler[TLB_SIZE];
+		PageHandler* writehandler[TLB_SIZE];
 
-		std::vector<uint32_t> phys_page = std::vector<uint32_t>(TLB_SIZE);
-	} tlb = {};
+		uint32_t phys_page[TLB_SIZE];
+	} tlb;
 #else
 	std::vector<tlb_entry> tlbh        = std::vector<tlb_entry>(TLB_SIZE);
 	std::vector<tlb_entry*> tlbh_banks = std::vector<tlb_entry*>(TLB_BANKS);
@@ -260,11 +281,15 @@ static inline HostPt get_tlb_read(PhysPt address)
 static inline HostPt get_tlb_write(PhysPt address) {
 	return paging.tlb.write[address>>12];
 }
+PageHandler* PAGING_GetInitPageHandler();
+
 static inline PageHandler* get_tlb_readhandler(PhysPt address) {
-	return paging.tlb.readhandler[address>>12];
+	const auto handler = paging.tlb.readhandler[address >> 12];
+	return handler ? handler : PAGING_GetInitPageHandler();
 }
 static inline PageHandler* get_tlb_writehandler(PhysPt address) {
-	return paging.tlb.writehandler[address>>12];
+	const auto handler = paging.tlb.writehandler[address >> 12];
+	return handler ? handler : PAGING_GetInitPageHandler();
 }
 
 /* Use these helper functions to access linear addresses in readX/writeX functions */
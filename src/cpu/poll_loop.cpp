@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cpu/cpu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+#include "cpu/paging.h"
+#include "hardware/pic.h"
+#include "hardware/port.h"
+#include "misc/perf_counters.h"
+
+// Polling loop acceleration
+// ~~~~~~~~~~~~~~~~~~~~~~~~~
+// Programs wait for the VGA retrace, the keyboard controller or the Sound
+// Blaster DSP by spinning on a status port:
+//
+//   wait: in   al,dx         (or in al,imm8)
+//         test al,imm8       (or and al,imm8)
+//         jz   wait          (or jnz, js, jns)
+//
+// Every pass runs the same three instructions and reads the same value
+// until the device changes state, and nothing but AL and the flags is
+// touched, so the passes in between make no difference. Once the same IN
+// has read the same value twice in a row and its code matches the loop
+// above, the port's polling hint tells how long the tested bits will stay
+// that way. The rest of that time is taken out of the cycles left before
+// the next PIC event, the way HLT does, and the loop carries on polling
+// from there.
+//
+// Only byte reads are matched, which is what status ports are, and only
+// when the loop's code lies in RAM with a direct TLB mapping, so looking
+// at it never faults.
+
+static PerfCounter cpu_poll_cycles_skipped("cpu_poll_cycles_skipped",
+                                           "Cycles skipped in loops spinning on a status port.");
+
+namespace {
+
+struct LastRead {
+	PhysPt in_address = 0;
+	uint16_t port     = 0;
+	uint8_t value     = 0;
+};
+
+LastRead last_read = {};
+
+std::optional<uint8_t> read_code_byte(const PhysPt address)
+{
+	const auto host = get_tlb_read(address);
+	if (!host) {
+		return {};
+	}
+	return host_readb(host + address);
+}
+
+// Whether the flags a TEST or AND of the value with the mask leaves make
+// the conditional jump take the branch
+bool is_taken(const uint8_t jcc, const uint8_t result)
+{
+	switch (jcc) {
+	case 0x74: return result == 0;           // jz
+	case 0x75: return result != 0;           // jnz
+	case 0x78: return (result & 0x80) != 0;  // js
+	case 0x79: return (result & 0x80) == 0;  // jns
+	default: return false;
+	}
+}
+
+} // namespace
+
+void CPU_SkipPollingLoop(const PhysPt in_address, const PhysPt next_address,
+                         const uint16_t port, const uint8_t value)
+{
+	const auto is_repeat = in_address == last_read.in_address &&
+	                       port == last_read.port && value == last_read.value;
+	last_read = {in_address, port, value};
+	if (!is_repeat || CPU_Cycles <= 0) {
+		return;
+	}
+
+	uint8_t code[4] = {};
+	for (PhysPt i = 0; i < 4; ++i) {
+		const auto byte = read_code_byte(next_address + i);
+		if (!byte) {
+			return;
+		}
+		code[i] = *byte;
+	}
+	const auto [alu, mask, jcc, displacement] = code;
+
+	constexpr uint8_t TestAlImm = 0xa8;
+	constexpr uint8_t AndAlImm  = 0x24;
+	if (alu != TestAlImm && alu != AndAlImm) {
+		return;
+	}
+	const auto loop_start = next_address + 4 + static_cast<int8_t>(displacement);
+	if (loop_start != in_address || !is_taken(jcc, value & mask)) {
+		return;
+	}
+
+	const auto stable_until = IO_GetPollHint(port, mask);
+	const auto now          = PIC_FullIndex();
+	if (!(stable_until > now)) {
+		return;
+	}
+
+	auto cycles = CPU_Cycles;
+	if (stable_until != IO_StableUntilEvent) {
+		const auto until_change = std::ceil((stable_until - now) *
+		                                    static_cast<double>(CPU_CycleMax));
+		cycles = static_cast<int>(
+		        std::min(until_change, static_cast<double>(CPU_Cycles)));
+	}
+	CPU_Cycles -= cycles;
+	CPU_IODelayRemoved += cycles;
+	cpu_poll_cycles_skipped.Add(static_cast<uint64_t>(cycles));
+}
@@ -0,0 +1,343 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_STRING_BULK_H
+#define DOSBOX_STRING_BULK_H
+
+#include "dosbox.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "cpu/paging.h"
+#include "hardware/memory.h"
+#include "hardware/port.h"
+#include "misc/perf_counters.h"
+
+// Bulk string operations
+// ~~~~~~~~~~~~~~~~~~~~~~
+// REP MOVS, STOS, CMPS and INS over plain RAM, done directly in host memory a
+// run of elements at a time instead of through the memory handlers one
+// element at a time.
+//
+// A run starts at the current element and ends at the first page
+// boundary or index wrap-around on either side, so it lies in a single
+// page whose TLB entry maps it straight to host memory. Pages without
+// such a mapping (video memory, ROM, the dynamic core's code pages, pages
+// not looked up in the page tables yet) have no host pointer in the TLB,
+// so their elements go through the caller's per-element function
+// instead, which also takes page faults and elements straddling a page as
+// before. The effects, including the order in which overlapping
+// elements are copied, are exactly those of the element-by-element loop.
+//
+// A REP INS from a port with a block reader, such as the NE2000's data
+// port, has the device copy runs going up in RAM straight from its buffer.
+//
+// A MOVS from RAM or a STOS of a uniform byte pattern into a page without
+// a host mapping is offered to the page handler's span writes first, so
+// handlers like planar video memory can take a whole run at once.
+//
+// The heavy debugger's memory read breakpoints need to see every access,
+// so it always takes the per-element path.
+
+inline PerfCounter cpu_string_bulk_bytes = {
+        "cpu_string_bulk_bytes",
+        "Bytes that REP string instructions handled directly in host memory."};
+
+#if C_HEAVY_DEBUGGER
+constexpr bool StringBulkEnabled = false;
+#else
+constexpr bool StringBulkEnabled = true;
+#endif
+
+// Elements of 'size' bytes, from 'index' in the direction of 'step', that
+// stay in the page of the first one and before the index wraps around
+static inline uint32_t string_run_length(const PhysPt base, const uint32_t index,
+                                         const uint32_t add_mask, const int32_t step)
+{
+	const auto size   = static_cast<uint32_t>(step > 0 ? step : -step);
+	const auto offset = (base + index) & (MemPageSize - 1);
+
+	if (offset + size > MemPageSize || index > add_mask - (size - 1)) {
+		return 0;
+	}
+	if (step > 0) {
+		const auto in_page = (MemPageSize - offset) / size;
+		const auto in_mask = (uint64_t{add_mask} - index + 1) / size;
+		return static_cast<uint32_t>(std::min<uint64_t>(in_page, in_mask));
+	}
+	return std::min(offset, index) / size + 1;
+}
+
+static inline uint32_t string_advance(const uint32_t index, const uint32_t elements,
+                                      const int32_t step, const uint32_t add_mask)
+{
+	const auto delta = static_cast<int64_t>(elements) * step;
+	return static_cast<uint32_t>(index + static_cast<uint32_t>(delta)) & add_mask;
+}
+
+template <typename T>
+static inline T string_host_read(const uint8_t* const ptr)
+{
+	if constexpr (sizeof(T) == 1) {
+		return host_readb(ptr);
+	} else if constexpr (sizeof(T) == 2) {
+		return host_readw(ptr);
+	} else {
+		return host_readd(ptr);
+	}
+}
+
+// Moves a run of elements of 'step' bytes (negative when the direction
+// flag is set) between the host pointers to its first elements, with the
+// result of moving them one by one in that order
+static inline void string_move_direct(uint8_t* src_ptr, uint8_t* dst_ptr,
+                                      const uint32_t bytes, const int32_t step)
+{
+	const auto size = static_cast<uint32_t>(step > 0 ? step : -step);
+
+	// Lowest addresses of the run, whatever the direction
+	if (step < 0) {
+		src_ptr -= bytes - size;
+		dst_ptr -= bytes - size;
+	}
+
+	// Copying in the direction of the string operation gives the same
+	// result as memmove unless the destination overlaps the part of the
+	// source that hasn't been read yet, which is how programs replicate
+	// a pattern with REP MOVS
+	const auto overlaps_unread = step > 0
+	                                   ? (dst_ptr > src_ptr && dst_ptr < src_ptr + bytes)
+	                                   : (dst_ptr < src_ptr && dst_ptr + bytes > src_ptr);
+	if (!overlaps_unread) {
+		std::memmove(dst_ptr, src_ptr, bytes);
+	} else if (step > 0) {
+		for (uint32_t i = 0; i < bytes; i += size) {
+			std::memmove(dst_ptr + i, src_ptr + i, size);
+		}
+	} else {
+		for (auto i = bytes; i > 0; i -= size) {
+			std::memmove(dst_ptr + i - size, src_ptr + i - size, size);
+		}
+	}
+}
+
+// Runs 'count' iterations of a REP MOVS with elements of 'step' bytes.
+// 'move_one' moves a single element between two linear addresses the
+// usual way.
+template <typename MoveOne>
+static inline void STRING_RepMove(const PhysPt si_base, uint32_t& si_index,
+                                  const PhysPt di_base, uint32_t& di_index,
+                                  const uint32_t add_mask, const int32_t step,
+                                  uint32_t count, MoveOne move_one)
+{
+	const auto size = static_cast<uint32_t>(step > 0 ? step : -step);
+
+	while (count > 0) {
+		const auto src = si_base + si_index;
+		const auto dst = di_base + di_index;
+
+		const auto src_tlb = StringBulkEnabled ? get_tlb_read(src) : nullptr;
+		const auto dst_tlb = StringBulkEnabled ? get_tlb_write(dst) : nullptr;
+
+		auto run = uint32_t{0};
+		if (src_tlb) {
+			run = std::min({count,
+			                string_run_length(si_base, si_index, add_mask, step),
+			                string_run_length(di_base, di_index, add_mask, step)});
+		}
+		const auto bytes = run * size;
+
+		if (run > 0 && dst_tlb) {
+			string_move_direct(src_tlb + src, dst_tlb + dst, bytes, step);
+			cpu_string_bulk_bytes.Add(bytes);
+		} else if (run > 0) {
+			// From RAM into a page whose handler can take the whole
+			// run, such as planar video memory
+			if (step < 0 || !get_tlb_writehandler(dst)->writeblock(
+			                        dst, src_tlb + src, bytes, run)) {
+				run = 0;
+			}
+		}
+
+		if (run == 0) {
+			move_one(src, dst);
+			run = 1;
+		}
+		si_index = string_advance(si_index, run, step, add_mask);
+		di_index = string_advance(di_index, run, step, add_mask);
+		count -= run;
+	}
+}
+
+// Runs 'count' iterations of a REP STOS of 'value', with 'step' as for
+// STRING_RepMove. 'store_one' stores a single element at a linear address
+// the usual way.
+template <typename T, typename StoreOne>
+static inline void STRING_RepStore(const PhysPt di_base, uint32_t& di_index,
+                                   const uint32_t add_mask, const int32_t step,
+                                   uint32_t count, const T value, StoreOne store_one)
+{
+	static_assert(std::is_unsigned_v<T>);
+	constexpr auto size = static_cast<uint32_t>(sizeof(T));
+
+	// The element as it's laid out in guest memory
+	uint8_t pattern[sizeof(T)] = {};
+	for (uint32_t i = 0; i < size; ++i) {
+		pattern[i] = static_cast<uint8_t>(value >> (i * 8));
+	}
+	const auto is_uniform = std::all_of(pattern, pattern + size, [&](const auto b) {
+		return b == pattern[0];
+	});
+
+	while (count > 0) {
+		const auto dst     = di_base + di_index;
+		const auto dst_tlb = StringBulkEnabled ? get_tlb_write(dst) : nullptr;
+
+		auto run = uint32_t{0};
+		if (StringBulkEnabled) {
+			run = std::min(count,
+			               string_run_length(di_base, di_index, add_mask, step));
+		}
+
+		// Every element holds the same value, so only the extent of the
+		// run depends on the direction
+		const auto bytes  = run * size;
+		const auto lowest = step > 0 ? dst : dst - (bytes - size);
+
+		if (run > 0 && dst_tlb) {
+			const auto dst_ptr = dst_tlb + lowest;
+			if (is_uniform) {
+				std::memset(dst_ptr, pattern[0], bytes);
+			} else {
+				for (uint32_t i = 0; i < bytes; i += size) {
+					std::memcpy(dst_ptr + i, pattern, size);
+				}
+			}
+			cpu_string_bulk_bytes.Add(bytes);
+		} else if (run > 0) {
+			// A page whose handler can take the whole run, such as
+			// planar video memory
+			if (!is_uniform || !get_tlb_writehandler(dst)->fillb(
+			                           lowest, pattern[0], bytes, run)) {
+				run = 0;
+			}
+		}
+
+		if (run == 0) {
+			store_one(dst, value);
+			run = 1;
+		}
+		di_index = string_advance(di_index, run, step, add_mask);
+		count -= run;
+	}
+}
+
+// Runs 'count' iterations of a REP INS of elements of 'step' bytes from
+// 'port', with 'step' as for STRING_RepMove. 'in_one' reads the port once
+// and stores the element at a linear address the usual way; the elements
+// the port's block reader doesn't take go through it from then on.
+template <typename InOne>
+static inline void STRING_RepIn(const io_port_t port, const PhysPt di_base,
+                                uint32_t& di_index, const uint32_t add_mask,
+                                const int32_t step, uint32_t count, InOne in_one)
+{
+	const auto size  = static_cast<uint32_t>(step > 0 ? step : -step);
+	const auto width = static_cast<io_width_t>(size);
+
+	auto is_block_read = StringBulkEnabled && step > 0 && IO_HasBlockReader(port);
+
+	while (count > 0) {
+		const auto dst = di_base + di_index;
+
+		auto run = uint32_t{0};
+		if (is_block_read) {
+			const auto dst_tlb = get_tlb_write(dst);
+			run = std::min(count, string_run_length(di_base, di_index,
+			                                        add_mask, step));
+			if (run > 0 && dst_tlb) {
+				run = IO_ReadBlock(port, width, dst_tlb + dst, run);
+				cpu_string_bulk_bytes.Add(run * size);
+				is_block_read = run > 0;
+			} else {
+				run = 0;
+			}
+		}
+
+		if (run == 0) {
+			in_one(dst);
+			run = 1;
+		}
+		di_index = string_advance(di_index, run, step, add_mask);
+		count -= run;
+	}
+}
+
+// Runs up to 'count' iterations of a REPE ('rep_zero' set) or REPNE CMPS,
+// stopping after the element whose comparison ends the repeat. Returns
+// the number of elements compared and leaves the last pair in 'val1' and
+// 'val2' for the flags. 'load_one' reads a single element from a linear
+// address the usual way.
+template <typename T, typename LoadOne>
+static inline uint32_t STRING_RepCompare(const PhysPt si_base, uint32_t& si_index,
+                                         const PhysPt di_base, uint32_t& di_index,
+                                         const uint32_t add_mask, const int32_t step,
+                                         const uint32_t count, const bool rep_zero,
+                                         T& val1, T& val2, LoadOne load_one)
+{
+	static_assert(std::is_unsigned_v<T>);
+
+	uint32_t compared = 0;
+	while (compared < count) {
+		const auto src = si_base + si_index;
+		const auto dst = di_base + di_index;
+
+		const auto src_tlb = StringBulkEnabled ? get_tlb_read(src) : nullptr;
+		const auto dst_tlb = StringBulkEnabled ? get_tlb_read(dst) : nullptr;
+
+		auto run = uint32_t{0};
+		if (src_tlb && dst_tlb) {
+			run = std::min({count - compared,
+			                string_run_length(si_base, si_index, add_mask, step),
+			                string_run_length(di_base, di_index, add_mask, step)});
+		}
+		if (run == 0) {
+			val1 = load_one(src);
+			val2 = load_one(dst);
+			si_index = string_advance(si_index, 1, step, add_mask);
+			di_index = string_advance(di_index, 1, step, add_mask);
+			++compared;
+			if ((val1 == val2) != rep_zero) {
+				break;
+			}
+			continue;
+		}
+
+		const uint8_t* src_ptr = src_tlb + src;
+		const uint8_t* dst_ptr = dst_tlb + dst;
+
+		uint32_t done = 0;
+		bool is_ended = false;
+		while (done < run && !is_ended) {
+			val1 = string_host_read<T>(src_ptr);
+			val2 = string_host_read<T>(dst_ptr);
+			src_ptr += step;
+			dst_ptr += step;
+			++done;
+			is_ended = (val1 == val2) != rep_zero;
+		}
+
+		cpu_string_bulk_bytes.Add(done * sizeof(T));
+		si_index = string_advance(si_index, done, step, add_mask);
+		di_index = string_advance(di_index, done, step, add_mask);
+		compared += done;
+		if (is_ended) {
+			break;
+		}
+	}
+	return compared;
+}
+
+#endif // DOSBOX_STRING_BULK_H
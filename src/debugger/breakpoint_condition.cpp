@@ -0,0 +1,395 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "breakpoint_condition.h"
+
+#include <array>
+#include <cassert>
+#include <cctype>
+
+#include "utils/checks.h"
+
+CHECK_NARROWING();
+
+using Op          = BreakpointCondition::Op;
+using Instruction = BreakpointCondition::Instruction;
+using Register    = BreakpointCondition::Register;
+
+namespace {
+
+struct RegisterName {
+	std::string_view name = {};
+	Register reg          = Register::Eax;
+	uint8_t shift         = 0;
+	uint32_t mask         = 0;
+};
+
+// Longer names first, so EAX isn't taken for AX
+constexpr std::array<RegisterName, 34> RegisterNames = {{
+        {"EFLAGS", Register::Flags, 0, 0xffff'ffff},
+        {"FLAGS", Register::Flags, 0, 0xffff},
+        {"EAX", Register::Eax, 0, 0xffff'ffff},
+        {"EBX", Register::Ebx, 0, 0xffff'ffff},
+        {"ECX", Register::Ecx, 0, 0xffff'ffff},
+        {"EDX", Register::Edx, 0, 0xffff'ffff},
+        {"ESI", Register::Esi, 0, 0xffff'ffff},
+        {"EDI", Register::Edi, 0, 0xffff'ffff},
+        {"EBP", Register::Ebp, 0, 0xffff'ffff},
+        {"ESP", Register::Esp, 0, 0xffff'ffff},
+        {"EIP", Register::Eip, 0, 0xffff'ffff},
+        {"AX", Register::Eax, 0, 0xffff},
+        {"BX", Register::Ebx, 0, 0xffff},
+        {"CX", Register::Ecx, 0, 0xffff},
+        {"DX", Register::Edx, 0, 0xffff},
+        {"SI", Register::Esi, 0, 0xffff},
+        {"DI", Register::Edi, 0, 0xffff},
+        {"BP", Register::Ebp, 0, 0xffff},
+        {"SP", Register::Esp, 0, 0xffff},
+        {"IP", Register::Eip, 0, 0xffff},
+        {"AL", Register::Eax, 0, 0xff},
+        {"BL", Register::Ebx, 0, 0xff},
+        {"CL", Register::Ecx, 0, 0xff},
+        {"DL", Register::Edx, 0, 0xff},
+        {"AH", Register::Eax, 8, 0xff},
+        {"BH", Register::Ebx, 8, 0xff},
+        {"CH", Register::Ecx, 8, 0xff},
+        {"DH", Register::Edx, 8, 0xff},
+        {"CS", Register::Cs, 0, 0xffff},
+        {"DS", Register::Ds, 0, 0xffff},
+        {"ES", Register::Es, 0, 0xffff},
+        {"FS", Register::Fs, 0, 0xffff},
+        {"GS", Register::Gs, 0, 0xffff},
+        {"SS", Register::Ss, 0, 0xffff},
+}};
+
+struct BinaryOperator {
+	std::string_view symbol = {};
+	Op op                   = Op::Or;
+};
+
+// From the loosest binding to the tightest; within a level, longer
+// symbols come first so '<=' isn't read as '<'
+const std::vector<std::vector<BinaryOperator>> BinaryOperators = {
+        {{"||", Op::Or}},
+        {{"&&", Op::And}},
+        {{"|", Op::BitOr}},
+        {{"^", Op::BitXor}},
+        {{"&", Op::BitAnd}},
+        {{"==", Op::Equal}, {"!=", Op::NotEqual}},
+        {{"<=", Op::LessEqual},
+         {">=", Op::GreaterEqual},
+         {"<", Op::Less},
+         {">", Op::Greater}},
+        {{"+", Op::Add}, {"-", Op::Subtract}},
+};
+
+class Parser {
+public:
+	Parser(const std::string_view _text) : text(_text) {}
+
+	bool Parse(std::vector<Instruction>& _program, std::string& _error)
+	{
+		ParseBinary(0);
+		SkipSpaces();
+		if (error.empty() && pos != text.size()) {
+			Fail("Unexpected text");
+		}
+		if (!error.empty()) {
+			_error = error;
+			return false;
+		}
+		assert(depth == 1);
+		_program = std::move(program);
+		return true;
+	}
+
+private:
+	void Fail(const std::string_view what)
+	{
+		if (error.empty()) {
+			error = std::string(what) + " at column " + std::to_string(pos + 1);
+		}
+	}
+
+	void Emit(const Instruction& instruction, const int stack_change)
+	{
+		program.push_back(instruction);
+		depth += stack_change;
+		if (depth > BreakpointCondition::MaxDepth) {
+			Fail("Condition too deeply nested");
+		}
+	}
+
+	void SkipSpaces()
+	{
+		while (pos < text.size() && text[pos] == ' ') {
+			++pos;
+		}
+	}
+
+	bool Accept(const std::string_view symbol)
+	{
+		SkipSpaces();
+		if (text.substr(pos, symbol.size()) != symbol) {
+			return false;
+		}
+		pos += symbol.size();
+		return true;
+	}
+
+	void Expect(const char symbol)
+	{
+		if (!Accept(std::string_view(&symbol, 1))) {
+			Fail(std::string("Expected '") + symbol + "'");
+		}
+	}
+
+	void ParseBinary(const size_t level)
+	{
+		if (level == BinaryOperators.size()) {
+			ParseUnary();
+			return;
+		}
+		ParseBinary(level + 1);
+
+		while (error.empty()) {
+			SkipSpaces();
+			const BinaryOperator* found = nullptr;
+			for (const auto& candidate : BinaryOperators[level]) {
+				if (text.substr(pos, candidate.symbol.size()) != candidate.symbol) {
+					continue;
+				}
+				// Don't take the first half of '||' or '&&' for '|'
+				// or '&'
+				const auto after = pos + candidate.symbol.size();
+				if ((candidate.op == Op::BitOr || candidate.op == Op::BitAnd) &&
+				    after < text.size() && text[after] == candidate.symbol[0]) {
+					continue;
+				}
+				pos   = after;
+				found = &candidate;
+				break;
+			}
+			if (!found) {
+				return;
+			}
+			ParseBinary(level + 1);
+			Emit({found->op}, -1);
+		}
+	}
+
+	void ParseUnary()
+	{
+		if (Accept("!")) {
+			ParseUnary();
+			Emit({Op::Not}, 0);
+			return;
+		}
+		if (Accept("~")) {
+			ParseUnary();
+			Emit({Op::Complement}, 0);
+			return;
+		}
+		if (Accept("-")) {
+			ParseUnary();
+			Emit({Op::Negate}, 0);
+			return;
+		}
+		ParsePrimary();
+	}
+
+	void ParseMemory(const Op load_op)
+	{
+		// The segment goes on the stack first, so if there turns out to
+		// be none, DS is slotted in ahead of the offset. Room for it is
+		// kept on the stack from the start in case.
+		const auto start       = program.size();
+		const auto start_depth = depth;
+
+		depth += 1;
+		ParseBinary(0);
+		if (Accept(":")) {
+			depth -= 1;
+			ParseBinary(0);
+		} else if (error.empty()) {
+			program.insert(program.begin() + static_cast<ptrdiff_t>(start),
+			               Instruction{Op::PushRegister, Register::Ds, 0, 0xffff});
+		}
+		Expect(']');
+
+		if (error.empty()) {
+			assert(depth == start_depth + 2);
+			Emit({load_op}, -1);
+		}
+	}
+
+	void ParsePrimary()
+	{
+		SkipSpaces();
+		if (Accept("(")) {
+			ParseBinary(0);
+			Expect(')');
+			return;
+		}
+		if (Accept("[")) {
+			ParseMemory(Op::LoadByte);
+			return;
+		}
+		if (Accept("B[")) {
+			ParseMemory(Op::LoadByte);
+			return;
+		}
+		if (Accept("W[")) {
+			ParseMemory(Op::LoadWord);
+			return;
+		}
+		if (Accept("D[")) {
+			ParseMemory(Op::LoadDword);
+			return;
+		}
+
+		const auto start = pos;
+		std::string word = {};
+		while (pos < text.size() && std::isalnum(static_cast<unsigned char>(text[pos]))) {
+			word += text[pos++];
+		}
+		if (word.empty()) {
+			Fail("Expected a value");
+			return;
+		}
+
+		for (const auto& reg : RegisterNames) {
+			if (word == reg.name) {
+				Emit({Op::PushRegister, reg.reg, reg.shift, reg.mask}, 1);
+				return;
+			}
+		}
+
+		auto digits = std::string_view(word);
+		if (digits.size() > 2 && digits.starts_with("0X")) {
+			digits.remove_prefix(2);
+		}
+		uint64_t value = 0;
+		for (const auto c : digits) {
+			if (!std::isxdigit(static_cast<unsigned char>(c)) || value > 0xfff'ffff) {
+				pos = start;
+				Fail("Invalid value '" + word + "'");
+				return;
+			}
+			const auto digit = std::isdigit(static_cast<unsigned char>(c))
+			                         ? c - '0'
+			                         : c - 'A' + 10;
+			value = value * 16 + static_cast<uint64_t>(digit);
+		}
+		Emit({Op::PushConst, Register::Eax, 0, static_cast<uint32_t>(value)}, 1);
+	}
+
+	std::string_view text = {};
+	size_t pos            = 0;
+
+	std::vector<Instruction> program = {};
+	int depth                        = 0;
+
+	std::string error = {};
+};
+
+} // namespace
+
+std::optional<BreakpointCondition> BreakpointCondition::Compile(const std::string_view text,
+                                                                std::string& error)
+{
+	BreakpointCondition condition = {};
+
+	std::string upper_text(text);
+	for (auto& c : upper_text) {
+		c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+	}
+
+	Parser parser(upper_text);
+	if (!parser.Parse(condition.program, error)) {
+		return {};
+	}
+	condition.text = text;
+	return condition;
+}
+
+bool BreakpointCondition::Evaluate(const Machine& machine) const
+{
+	std::array<uint32_t, MaxDepth> stack = {};
+
+	// Points past the top of the stack; the compiler has checked the
+	// program never under- or overflows it
+	int top = 0;
+
+	auto binary = [&](auto operation) {
+		--top;
+		stack[top - 1] = static_cast<uint32_t>(operation(stack[top - 1], stack[top]));
+	};
+
+	for (const auto& instruction : program) {
+		switch (instruction.op) {
+		case Op::PushConst: stack[top++] = instruction.value; break;
+		case Op::PushRegister:
+			stack[top++] = (machine.ReadRegister(instruction.reg) >>
+			                instruction.shift) &
+			               instruction.value;
+			break;
+		case Op::LoadByte:
+		case Op::LoadWord:
+		case Op::LoadDword: {
+			const auto num_bytes = instruction.op == Op::LoadByte ? 1
+			                     : instruction.op == Op::LoadWord ? 2
+			                                                      : 4;
+			--top;
+			stack[top - 1] = machine.ReadMemory(static_cast<uint16_t>(
+			                                            stack[top - 1]),
+			                                    stack[top],
+			                                    num_bytes);
+		} break;
+		case Op::Not: stack[top - 1] = (stack[top - 1] == 0); break;
+		case Op::Complement: stack[top - 1] = ~stack[top - 1]; break;
+		case Op::Negate: stack[top - 1] = 0 - stack[top - 1]; break;
+		case Op::Or:
+			binary([](uint32_t a, uint32_t b) { return a || b; });
+			break;
+		case Op::And:
+			binary([](uint32_t a, uint32_t b) { return a && b; });
+			break;
+		case Op::BitOr:
+			binary([](uint32_t a, uint32_t b) { return a | b; });
+			break;
+		case Op::BitXor:
+			binary([](uint32_t a, uint32_t b) { return a ^ b; });
+			break;
+		case Op::BitAnd:
+			binary([](uint32_t a, uint32_t b) { return a & b; });
+			break;
+		case Op::Equal:
+			binary([](uint32_t a, uint32_t b) { return a == b; });
+			break;
+		case Op::NotEqual:
+			binary([](uint32_t a, uint32_t b) { return a != b; });
+			break;
+		case Op::Less:
+			binary([](uint32_t a, uint32_t b) { return a < b; });
+			break;
+		case Op::LessEqual:
+			binary([](uint32_t a, uint32_t b) { return a <= b; });
+			break;
+		case Op::Greater:
+			binary([](uint32_t a, uint32_t b) { return a > b; });
+			break;
+		case Op::GreaterEqual:
+			binary([](uint32_t a, uint32_t b) { return a >= b; });
+			break;
+		case Op::Add:
+			binary([](uint32_t a, uint32_t b) { return a + b; });
+			break;
+		case Op::Subtract:
+			binary([](uint32_t a, uint32_t b) { return a - b; });
+			break;
+		}
+	}
+	assert(top == 1);
+	return stack[0] != 0;
+}
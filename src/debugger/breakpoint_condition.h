@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_BREAKPOINT_CONDITION_H
+#define DOSBOX_BREAKPOINT_CONDITION_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The condition of a conditional breakpoint or tracepoint, such as
+//
+//   AX==3 && [DS:SI]==42
+//
+// It's compiled once into a small stack program, so checking it on every
+// hit costs a few table-driven steps rather than a parse.
+//
+// Numbers are hex, as everywhere else in the debugger, with an optional 0x
+// prefix. The operands are the 8, 16 and 32-bit general registers, IP and
+// EIP, FLAGS and EFLAGS, the segment registers, and memory: [seg:off] reads
+// a byte, W[seg:off] a word and D[seg:off] a dword, and DS is used when the
+// segment is left out. The C operators || && | ^ & == != < <= > >= + - and
+// the unary ! ~ - work on unsigned 32-bit values with the usual precedence.
+//
+class BreakpointCondition {
+public:
+	enum class Register : uint8_t {
+		Eax,
+		Ebx,
+		Ecx,
+		Edx,
+		Esi,
+		Edi,
+		Ebp,
+		Esp,
+		Eip,
+		Flags,
+		Cs,
+		Ds,
+		Es,
+		Fs,
+		Gs,
+		Ss,
+	};
+
+	// Where a condition reads its operands from
+	class Machine {
+	public:
+		virtual ~Machine() = default;
+
+		virtual uint32_t ReadRegister(const Register reg) const = 0;
+
+		virtual uint32_t ReadMemory(const uint16_t seg, const uint32_t offset,
+		                            const int num_bytes) const = 0;
+	};
+
+	// Returns nothing and describes the problem in 'error' if the text
+	// isn't a valid condition
+	static std::optional<BreakpointCondition> Compile(const std::string_view text,
+	                                                  std::string& error);
+
+	bool Evaluate(const Machine& machine) const;
+
+	const std::string& Text() const
+	{
+		return text;
+	}
+
+	// The deepest the evaluation stack may get
+	static constexpr int MaxDepth = 32;
+
+	enum class Op : uint8_t {
+		PushConst,
+		PushRegister,
+		LoadByte,
+		LoadWord,
+		LoadDword,
+		Not,
+		Complement,
+		Negate,
+		Or,
+		And,
+		BitOr,
+		BitXor,
+		BitAnd,
+		Equal,
+		NotEqual,
+		Less,
+		LessEqual,
+		Greater,
+		GreaterEqual,
+		Add,
+		Subtract,
+	};
+
+	struct Instruction {
+		Op op = Op::PushConst;
+
+		// Registers are read as (reg >> shift) & value; constants are
+		// just the value
+		Register reg  = Register::Eax;
+		uint8_t shift = 0;
+
+		uint32_t value = 0;
+	};
+
+private:
+	std::vector<Instruction> program = {};
+	std::string text                 = {};
+};
+
+#endif // DOSBOX_BREAKPOINT_CONDITION_H
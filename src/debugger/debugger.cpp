@@ -6,13 +6,17 @@
 
 #if C_DEBUGGER
 
+#include <algorithm>
+#include <array>
 #include <cctype>
 #include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <list>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "audio/mixer.h"
@@ -20,9 +24,11 @@
 #include "cpu/callback.h"
 #include "cpu/cpu.h"
 #include "cpu/lazyflags.h"
+#include "breakpoint_condition.h"
 #include "cpu/paging.h"
 #include "debugger.h"
 #include "debugger_inc.h"
+#include "trace_recorder.h"
 #include "dos/programs.h"
 #include "gui/common.h"
 #include "gui/mapper.h"
@@ -31,6 +37,7 @@
 #include "hardware/port.h"
 #include "hardware/timer.h"
 #include "misc/cross.h" //snprintf
+#include "misc/profiler.h"
 #include "misc/std_filesystem.h"
 #include "misc/support.h"
 #include "misc/video.h"
@@ -89,6 +96,11 @@ static int		cpuLogCounter	= 0;
 static int		cpuLogType		= 1;	// log detail
 static bool zeroProtect = false;
 bool	logHeavy	= false;
+
+// The binary execution trace of LOGB, stopped after the given number of
+// instructions if that's not zero
+static TraceRecorder trace_recorder = {};
+static uint32_t trace_countdown     = 0;
 #endif
 
 static struct  {
@@ -293,7 +305,7 @@ public:
 	void					SetAddress		(PhysPt adr)				{ location = adr; type = BKPNT_PHYSICAL; }
 	void					SetInt			(uint8_t _intNr, uint16_t ah, uint16_t al)	{ intNr = _intNr, ahValue = ah; alValue = al; type = BKPNT_INTERRUPT; }
 	void					SetOnce			(bool _once)				{ once = _once; }
-	void					SetType			(EBreakpoint _type)			{ type = _type; }
+	void					SetType			(EBreakpoint _type);
 	void					SetValue		(uint8_t value)				{ ahValue = value; }
 	void					SetOther		(uint8_t other)				{ alValue = other; }
 
@@ -308,6 +320,22 @@ public:
 	uint8_t GetIntNr() const noexcept { return intNr; }
 	uint16_t GetValue() const noexcept { return ahValue; }
 	uint16_t GetOther() const noexcept { return alValue; }
+
+	// Conditional breakpoints only count as hit when their condition
+	// holds; tracepoints (log-only breakpoints) record the hit and carry on
+	void SetCondition(std::optional<BreakpointCondition> _condition)
+	{
+		condition = std::move(_condition);
+	}
+	const std::optional<BreakpointCondition>& GetCondition() const noexcept
+	{
+		return condition;
+	}
+	void SetLogOnly(bool _log_only) { log_only = _log_only; }
+	bool IsLogOnly() const noexcept { return log_only; }
+
+	void CountHit() { ++hit_count; }
+	uint32_t GetHitCount() const noexcept { return hit_count; }
 #if C_HEAVY_DEBUGGER
 	void FlagMemoryAsRead()
 	{
@@ -358,6 +386,10 @@ private:
 	// Shared
 	bool active = 0;
 	bool once   = 0;
+	// Conditional and tracepoints
+	std::optional<BreakpointCondition> condition = {};
+	bool log_only      = false;
+	uint32_t hit_count = 0;
 #if C_HEAVY_DEBUGGER
 	bool memory_was_read = false;
 
@@ -414,6 +446,168 @@ void CBreakpoint::Activate(bool _active)
 // Statics
 static std::list<CBreakpoint *> BPoints = {};
 
+// Where the breakpoints are, so the per-instruction and per-read checks of
+// the heavy debugger can turn down the common case of no breakpoint at the
+// address without walking the list. Anything that changes the list, or the
+// type of a breakpoint in it, marks the index stale and the next check
+// rebuilds it.
+static struct {
+	std::unordered_set<PhysPt> code_locations = {};
+	std::unordered_set<PhysPt> read_pages     = {};
+	bool has_memory_watches                   = false;
+	bool is_stale                             = true;
+} bp_index;
+
+static void update_breakpoint_index()
+{
+	if (!bp_index.is_stale) {
+		return;
+	}
+	bp_index.code_locations.clear();
+	bp_index.read_pages.clear();
+	bp_index.has_memory_watches = false;
+
+	for (const auto bp : BPoints) {
+		switch (bp->GetType()) {
+		case BKPNT_PHYSICAL:
+			bp_index.code_locations.insert(bp->GetLocation());
+			break;
+		case BKPNT_MEMORY_READ:
+			// Reads of up to 8 bytes starting below the location
+			// can reach it, so a page either side may be hit
+			bp_index.read_pages.insert(bp->GetLocation() / MemPageSize);
+			bp_index.read_pages.insert((bp->GetLocation() + 7) / MemPageSize);
+			bp_index.has_memory_watches = true;
+			break;
+		case BKPNT_MEMORY:
+		case BKPNT_MEMORY_PROT:
+		case BKPNT_MEMORY_LINEAR:
+			bp_index.has_memory_watches = true;
+			break;
+		default: break;
+		}
+	}
+	bp_index.is_stale = false;
+}
+
+void CBreakpoint::SetType(EBreakpoint _type)
+{
+	type              = _type;
+	bp_index.is_stale = true;
+}
+
+#if C_HEAVY_DEBUGGER
+// Breakpoint conditions read the live registers and memory
+class DebuggerMachine final : public BreakpointCondition::Machine {
+public:
+	uint32_t ReadRegister(const BreakpointCondition::Register reg) const override
+	{
+		using Register = BreakpointCondition::Register;
+		switch (reg) {
+		case Register::Eax: return reg_eax;
+		case Register::Ebx: return reg_ebx;
+		case Register::Ecx: return reg_ecx;
+		case Register::Edx: return reg_edx;
+		case Register::Esi: return reg_esi;
+		case Register::Edi: return reg_edi;
+		case Register::Ebp: return reg_ebp;
+		case Register::Esp: return reg_esp;
+		case Register::Eip: return reg_eip;
+		case Register::Flags: return static_cast<uint32_t>(reg_flags);
+		case Register::Cs: return SegValue(cs);
+		case Register::Ds: return SegValue(ds);
+		case Register::Es: return SegValue(es);
+		case Register::Fs: return SegValue(fs);
+		case Register::Gs: return SegValue(gs);
+		case Register::Ss: return SegValue(ss);
+		}
+		return 0;
+	}
+
+	// Memory that would fault reads as zero
+	uint32_t ReadMemory(const uint16_t seg, const uint32_t offset,
+	                    const int num_bytes) const override
+	{
+		const auto address = GetAddress(seg, offset);
+
+		uint32_t value = 0;
+		for (auto i = num_bytes - 1; i >= 0; --i) {
+			uint8_t byte = 0;
+			const auto byte_address = address + static_cast<uint32_t>(i);
+			if (mem_readb_checked(byte_address, &byte)) {
+				return 0;
+			}
+			value = (value << 8) | byte;
+		}
+		return value;
+	}
+};
+
+static const DebuggerMachine debugger_machine = {};
+
+// The registers at the most recent tracepoint hits, oldest overwritten first
+struct TraceSnapshot {
+	uint32_t hit   = 0;
+	uint16_t cs    = 0;
+	uint32_t eip   = 0;
+	uint32_t eax   = 0;
+	uint32_t ebx   = 0;
+	uint32_t ecx   = 0;
+	uint32_t edx   = 0;
+	uint32_t esi   = 0;
+	uint32_t edi   = 0;
+	uint32_t ebp   = 0;
+	uint32_t esp   = 0;
+	uint16_t ds    = 0;
+	uint16_t es    = 0;
+	uint16_t ss    = 0;
+	uint32_t flags = 0;
+};
+
+static std::array<TraceSnapshot, 256> trace_snapshots = {};
+static uint32_t num_trace_snapshots = 0;
+
+static void record_trace_snapshot(const uint32_t hit)
+{
+	auto& snapshot = trace_snapshots[num_trace_snapshots++ % trace_snapshots.size()];
+
+	snapshot = {hit,
+	            SegValue(cs),
+	            reg_eip,
+	            reg_eax,
+	            reg_ebx,
+	            reg_ecx,
+	            reg_edx,
+	            reg_esi,
+	            reg_edi,
+	            reg_ebp,
+	            reg_esp,
+	            SegValue(ds),
+	            SegValue(es),
+	            SegValue(ss),
+	            static_cast<uint32_t>(reg_flags)};
+}
+
+static void show_trace_snapshots(const uint32_t num_wanted)
+{
+	const auto num_kept = std::min<uint32_t>(num_trace_snapshots,
+	                                         trace_snapshots.size());
+	const auto num = std::min(num_wanted, num_kept);
+	if (num == 0) {
+		DEBUG_ShowMsg("DEBUG: No tracepoint hits recorded.\n");
+		return;
+	}
+	for (auto i = num_trace_snapshots - num; i != num_trace_snapshots; ++i) {
+		const auto& t = trace_snapshots[i % trace_snapshots.size()];
+		DEBUG_ShowMsg("%04X:%08X hit %X: EAX=%08X EBX=%08X ECX=%08X EDX=%08X "
+		              "ESI=%08X EDI=%08X EBP=%08X ESP=%08X DS=%04X ES=%04X "
+		              "SS=%04X FL=%08X\n",
+		              t.cs, t.eip, t.hit, t.eax, t.ebx, t.ecx, t.edx,
+		              t.esi, t.edi, t.ebp, t.esp, t.ds, t.es, t.ss, t.flags);
+	}
+}
+#endif
+
 #if C_HEAVY_DEBUGGER
 template <typename T>
 void DEBUG_UpdateMemoryReadBreakpoints(const PhysPt addr)
@@ -421,6 +615,11 @@ void DEBUG_UpdateMemoryReadBreakpoints(const PhysPt addr)
 	static_assert(std::is_unsigned_v<T>);
 	static_assert(std::is_integral_v<T>);
 
+	update_breakpoint_index();
+	if (!bp_index.read_pages.contains(addr / MemPageSize)) {
+		return;
+	}
+
 	for (CBreakpoint* bp : BPoints) {
 		if (bp->GetType() == BKPNT_MEMORY_READ) {
 			const PhysPt location_begin = bp->GetLocation();
@@ -449,6 +648,7 @@ CBreakpoint* CBreakpoint::AddBreakpoint(uint16_t seg, uint32_t off, bool once)
 	bp->SetAddress		(seg,off);
 	bp->SetOnce			(once);
 	BPoints.push_front	(bp);
+	bp_index.is_stale = true;
 	return bp;
 }
 
@@ -458,6 +658,7 @@ CBreakpoint* CBreakpoint::AddIntBreakpoint(uint8_t intNum, uint16_t ah, uint16_t
 	bp->SetInt			(intNum,ah,al);
 	bp->SetOnce			(once);
 	BPoints.push_front	(bp);
+	bp_index.is_stale = true;
 	return bp;
 }
 
@@ -468,6 +669,7 @@ CBreakpoint* CBreakpoint::AddMemBreakpoint(uint16_t seg, uint32_t off)
 	bp->SetOnce			(false);
 	bp->SetType			(BKPNT_MEMORY);
 	BPoints.push_front	(bp);
+	bp_index.is_stale = true;
 	return bp;
 }
 
@@ -504,16 +706,37 @@ bool CBreakpoint::CheckBreakpoint(Bitu seg, Bitu off)
 	// Quick exit if there are no breakpoints
 	if (BPoints.empty()) return false;
 
+	// Nothing to check unless there's a breakpoint here or memory to watch
+	update_breakpoint_index();
+	if (!bp_index.has_memory_watches &&
+	    !bp_index.code_locations.contains(GetAddress(seg, off))) {
+		return false;
+	}
+
 	// Search matching breakpoint
 	for (auto i = BPoints.begin(); i != BPoints.end(); ++i) {
 		auto bp = (*i);
 
 		if ((bp->GetType() == BKPNT_PHYSICAL) && bp->IsActive() &&
 		    (bp->GetLocation() == GetAddress(seg, off))) {
+#if C_HEAVY_DEBUGGER
+			const auto& condition = bp->GetCondition();
+			if (condition && !condition->Evaluate(debugger_machine)) {
+				continue;
+			}
+			bp->CountHit();
+			if (bp->IsLogOnly()) {
+				record_trace_snapshot(bp->GetHitCount());
+				continue;
+			}
+#else
+			bp->CountHit();
+#endif
 			// Found
 			if (bp->GetOnce()) {
 				// delete it, if it should only be used once
 				BPoints.erase(i);
+				bp_index.is_stale = true;
 				bp->Activate(false);
 				delete bp;
 			} else {
@@ -521,6 +744,7 @@ bool CBreakpoint::CheckBreakpoint(Bitu seg, Bitu off)
 				bp = FindPhysBreakpoint(seg, off, true);
 				if (bp) {
 					BPoints.remove(bp);
+					bp_index.is_stale = true;
 					bp->Activate(false);
 					delete bp;
 				}
@@ -587,6 +811,7 @@ bool CBreakpoint::CheckIntBreakpoint([[maybe_unused]] PhysPt adr, uint8_t intNr,
 				if (bp->GetOnce()) {
 					// delete it, if it should only be used once
 					BPoints.erase(i);
+					bp_index.is_stale = true;
 					bp->Activate(false);
 					delete bp;
 				}
@@ -604,6 +829,7 @@ void CBreakpoint::DeleteAll()
 		delete bp;
 	}
 	BPoints.clear();
+	bp_index.is_stale = true;
 }
 
 bool CBreakpoint::DeleteByIndex(uint16_t index)
@@ -617,6 +843,7 @@ bool CBreakpoint::DeleteByIndex(uint16_t index)
 	auto bp = *it;
 
 	BPoints.erase(it);
+	bp_index.is_stale = true;
 	bp->Activate(false);
 	delete bp;
 	return true;
@@ -664,6 +891,7 @@ bool CBreakpoint::DeleteBreakpoint(uint16_t seg, uint32_t off)
 	CBreakpoint* bp = FindPhysBreakpoint(seg, off, false);
 	if (bp) {
 		BPoints.remove(bp);
+		bp_index.is_stale = true;
 		delete bp;
 		return true;
 	}
@@ -678,7 +906,15 @@ void CBreakpoint::ShowList(void)
 	int nr = 0;
 	for (auto &bp : BPoints) {
 		if (bp->GetType()==BKPNT_PHYSICAL) {
-			DEBUG_ShowMsg("%02X. BP %04X:%04X\n",nr,bp->GetSegment(),bp->GetOffset());
+			const auto& condition = bp->GetCondition();
+			DEBUG_ShowMsg("%02X. %s %04X:%04X%s%s (%u hits)\n",
+			              nr,
+			              bp->IsLogOnly() ? "BPLOG" : "BP",
+			              bp->GetSegment(),
+			              bp->GetOffset(),
+			              condition ? " IF " : "",
+			              condition ? condition->Text().c_str() : "",
+			              bp->GetHitCount());
 		} else if (bp->GetType()==BKPNT_INTERRUPT) {
 			if (bp->GetValue()==BPINT_ALL) DEBUG_ShowMsg("%02X. BPINT %02X\n",nr,bp->GetIntNr());
 			else if (bp->GetOther()==BPINT_ALL) DEBUG_ShowMsg("%02X. BPINT %02X AH=%02X\n",nr,bp->GetIntNr(),bp->GetValue());
@@ -1059,6 +1295,30 @@ bool ChangeRegister(char* str)
 	return true;
 }
 
+// Parses the optional 'IF [condition]' after a breakpoint address. Returns
+// false, having said why, if there's a condition that doesn't compile.
+static bool parse_breakpoint_condition(const char* text,
+                                       std::optional<BreakpointCondition>& condition)
+{
+	while (*text == ' ') {
+		++text;
+	}
+	if (strncmp(text, "IF", 2) != 0) {
+		return true;
+	}
+	text += 2;
+	while (*text == ' ') {
+		++text;
+	}
+	std::string error = {};
+	condition = BreakpointCondition::Compile(text, error);
+	if (!condition) {
+		DEBUG_ShowMsg("DEBUG: Invalid breakpoint condition: %s\n", error.c_str());
+		return false;
+	}
+	return true;
+}
+
 bool ParseCommand(char* str) {
 	char* found = str;
 	for(char* idx = found;*idx != 0; idx++)
@@ -1162,6 +1422,23 @@ bool ParseCommand(char* str) {
 	if (command == "BP") { // Add new breakpoint
 		uint16_t seg = (uint16_t)GetHexValue(found,found);found++; // skip ":"
 		uint32_t ofs = GetHexValue(found,found);
+		std::optional<BreakpointCondition> condition = {};
+		if (!parse_breakpoint_condition(found, condition)) {
+			return true;
+		}
+		if (condition) {
+#if C_HEAVY_DEBUGGER
+			DEBUG_ShowMsg("DEBUG: Set breakpoint at %04X:%04X if %s\n",
+			              seg,
+			              ofs,
+			              condition->Text().c_str());
+			auto bp = CBreakpoint::AddBreakpoint(seg, ofs, false);
+			bp->SetCondition(std::move(condition));
+#else
+			DEBUG_ShowMsg("DEBUG: Conditional breakpoints need the heavy debugger.\n");
+#endif
+			return true;
+		}
 		CBreakpoint::AddBreakpoint(seg,ofs,false);
 		DEBUG_ShowMsg("DEBUG: Set breakpoint at %04X:%04X\n",seg,ofs);
 		return true;
@@ -1169,6 +1446,31 @@ bool ParseCommand(char* str) {
 
 #if C_HEAVY_DEBUGGER
 
+	if (command == "BPLOG") { // Add new tracepoint
+		uint16_t seg = (uint16_t)GetHexValue(found, found);
+		found++; // skip ":"
+		uint32_t ofs = GetHexValue(found, found);
+		std::optional<BreakpointCondition> condition = {};
+		if (!parse_breakpoint_condition(found, condition)) {
+			return true;
+		}
+		DEBUG_ShowMsg("DEBUG: Set tracepoint at %04X:%04X%s%s\n",
+		              seg,
+		              ofs,
+		              condition ? " if " : "",
+		              condition ? condition->Text().c_str() : "");
+		auto bp = CBreakpoint::AddBreakpoint(seg, ofs, false);
+		bp->SetLogOnly(true);
+		bp->SetCondition(std::move(condition));
+		return true;
+	}
+
+	if (command == "BPTRACE") { // Show the latest tracepoint hits
+		uint32_t num = GetHexValue(found, found);
+		show_trace_snapshots(num ? num : 0x10);
+		return true;
+	}
+
 	if (command == "BPM") { // Add new breakpoint
 		uint16_t seg = (uint16_t)GetHexValue(found,found);found++; // skip ":"
 		uint32_t ofs = GetHexValue(found,found);
@@ -1290,6 +1592,37 @@ bool ParseCommand(char* str) {
 		command = "logcode";
 	}
 
+	if (command == "LOGB") { // Create binary execution trace
+		if (trace_recorder.IsOpen()) {
+			trace_recorder.Close();
+		}
+		const std_fs::path log_cpu_trc = "LOGCPU.TRC";
+		if (!trace_recorder.Open(log_cpu_trc.string())) {
+			DEBUG_ShowMsg("DEBUG: Trace file couldn't be created.\n");
+			return false;
+		}
+		DEBUG_ShowMsg("DEBUG: Trace file '%s' created.\n",
+		              std_fs::absolute(log_cpu_trc).string().c_str());
+		trace_countdown = GetHexValue(found, found);
+
+		debugging = false;
+		CBreakpoint::ActivateBreakpointsExceptAt(SegPhys(cs)+reg_eip);
+		DOSBOX_SetNormalLoop();
+		return true;
+	}
+
+	if (command == "LOGBEND") { // Finish binary execution trace
+		if (!trace_recorder.IsOpen()) {
+			DEBUG_ShowMsg("DEBUG: No trace is being recorded.\n");
+			return true;
+		}
+		const auto num_records = trace_recorder.NumRecords();
+		trace_recorder.Close();
+		DEBUG_ShowMsg("DEBUG: Trace of %llu instructions written.\n",
+		              static_cast<unsigned long long>(num_records));
+		return true;
+	}
+
 	if (command == "logcode") { //Shared code between all logs
 		DEBUG_ShowMsg("DEBUG: Starting log\n");
 		const std_fs::path log_cpu_txt = "LOGCPU.TXT";
@@ -1348,6 +1681,37 @@ bool ParseCommand(char* str) {
 		return true;
 	}
 
+	if (command == "PROFILE") {
+		stream >> command;
+		if (command == "START") {
+			if (!PROFILER_Start()) {
+				DEBUG_ShowMsg("DEBUG: The profiler is already running.\n");
+			} else {
+				DEBUG_ShowMsg("DEBUG: Profiler started.\n");
+			}
+			return true;
+		}
+		if (command == "STOP") {
+			if (!PROFILER_IsRunning()) {
+				DEBUG_ShowMsg("DEBUG: The profiler isn't running.\n");
+				return true;
+			}
+			const auto num_samples = PROFILER_NumSamples();
+			const std_fs::path profile_txt = "PROFILE.TXT";
+			std::ofstream out(profile_txt);
+			out << PROFILER_Stop();
+			if (!out) {
+				DEBUG_ShowMsg("DEBUG: Profile file couldn't be written.\n");
+				return false;
+			}
+			DEBUG_ShowMsg("DEBUG: Profile of %llu samples written to '%s'.\n",
+			              static_cast<unsigned long long>(num_samples),
+			              std_fs::absolute(profile_txt).string().c_str());
+			return true;
+		}
+		return false;
+	}
+
 	if (command == "GDT") {LogGDT(); return true;}
 
 	if (command == "LDT") {LogLDT(); return true;}
@@ -1414,15 +1778,20 @@ bool ParseCommand(char* str) {
 		DEBUG_ShowMsg("BPMR   [segment]:[offset] - Set memory breakpoint (memory read).\n");
 		DEBUG_ShowMsg("BPPM   [selector]:[offset]- Set pmode-memory breakpoint (memory change).\n");
 		DEBUG_ShowMsg("BPLM   [linear address]   - Set linear memory breakpoint (memory change).\n");
+		DEBUG_ShowMsg("BP     [seg]:[off] IF [condition] - Set conditional breakpoint.\n");
+		DEBUG_ShowMsg("BPLOG  [seg]:[off] [IF condition] - Set tracepoint (records registers).\n");
+		DEBUG_ShowMsg("BPTRACE [num]             - Show the last num tracepoint hits.\n");
 #endif
 		DEBUG_ShowMsg("BPLIST                    - List breakpoints.\n");
 		DEBUG_ShowMsg("BPDEL  [bpNr] / *         - Delete breakpoint nr / all.\n");
 		DEBUG_ShowMsg("C / D  [segment]:[offset] - Set code / data view address.\n");
 		DEBUG_ShowMsg("DOS MCBS                  - Show Memory Control Block chain.\n");
+		DEBUG_ShowMsg("PROFILE START / STOP      - Sample guest code / write PROFILE.TXT.\n");
 		DEBUG_ShowMsg("INT [nr] / INTT [nr]      - Execute / Trace into interrupt.\n");
 #if C_HEAVY_DEBUGGER
 		DEBUG_ShowMsg("LOG [num]                 - Write cpu log file.\n");
 		DEBUG_ShowMsg("LOGS/LOGL/LOGC [num]      - Write short/long/cs:ip-only cpu log file.\n");
+		DEBUG_ShowMsg("LOGB [num] / LOGBEND      - Start / finish binary trace file (0 = no limit).\n");
 		DEBUG_ShowMsg("HEAVYLOG                  - Enable/Disable automatic cpu log when DOSBox exits.\n");
 		DEBUG_ShowMsg("ZEROPROTECT               - Enable/Disable zero code execution detection.\n");
 #endif
@@ -2346,6 +2715,11 @@ Bitu DEBUG_EnableDebugger()
 }
 
 void DEBUG_ShutDown(Section * /*sec*/) {
+#if C_HEAVY_DEBUGGER
+	if (trace_recorder.IsOpen()) {
+		trace_recorder.Close();
+	}
+#endif
 	CBreakpoint::DeleteAll();
 	CDebugVar::DeleteAll();
 	curs_set(old_cursor_state);
@@ -2735,6 +3109,33 @@ bool DEBUG_HeavyIsBreakpoint(void) {
 			return true;
 		}
 	}
+	if (trace_recorder.IsOpen()) {
+		uint32_t code = 0;
+		mem_readd_checked(SegPhys(cs) + reg_eip, &code);
+
+		trace_recorder.Add({SegValue(cs),
+		                    reg_eip,
+		                    code,
+		                    reg_eax,
+		                    reg_ebx,
+		                    reg_ecx,
+		                    reg_edx,
+		                    reg_esi,
+		                    reg_edi,
+		                    reg_ebp,
+		                    reg_esp,
+		                    SegValue(ds),
+		                    SegValue(es),
+		                    SegValue(ss),
+		                    static_cast<uint32_t>(reg_flags)});
+
+		if (trace_countdown && --trace_countdown == 0) {
+			trace_recorder.Close();
+			DEBUG_ShowMsg("DEBUG: cpu trace LOGCPU.TRC created\n");
+			DEBUG_EnableDebugger();
+			return true;
+		}
+	}
 	// LogInstruction
 	if (logHeavy) DEBUG_HeavyLogInstruction();
 	if (zeroProtect) {
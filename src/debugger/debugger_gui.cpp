@@ -109,14 +109,16 @@ void DEBUG_RefreshPage(int scroll) {
 
 void LOG::operator()(const char* format, ...)
 {
+	// Disabled groups skip the formatting altogether
+	if (d_type>=LOG_MAX) return;
+	if ((d_severity!=LOG_ERROR) && (!loggrp[d_type].enabled)) return;
+
 	char buf[512];
 	va_list msg;
 	va_start(msg,format);
-	vsprintf(buf,format,msg);
+	vsnprintf(buf,sizeof(buf),format,msg);
 	va_end(msg);
 
-	if (d_type>=LOG_MAX) return;
-	if ((d_severity!=LOG_ERROR) && (!loggrp[d_type].enabled)) return;
 	DEBUG_ShowMsg("%10u: %s:%s\n",static_cast<uint32_t>(cycle_count),loggrp[d_type].front,buf);
 }
 
@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "trace_recorder.h"
+
+#include <cassert>
+
+#include <zlib.h>
+
+#include "misc/logging.h"
+#include "utils/checks.h"
+
+CHECK_NARROWING();
+
+static constexpr char Magic[8] = {'D', 'B', 'X', 'T', 'R', 'C', '0', '1'};
+
+TraceRecorder::~TraceRecorder()
+{
+	if (outfile) {
+		Close();
+	}
+}
+
+bool TraceRecorder::Open(const std::string& path)
+{
+	assert(!outfile);
+
+	outfile = fopen(path.c_str(), "wb");
+	if (!outfile) {
+		return false;
+	}
+	if (fwrite(Magic, 1, sizeof(Magic), outfile) != sizeof(Magic)) {
+		fclose(outfile);
+		outfile = nullptr;
+		return false;
+	}
+
+	previous    = {};
+	num_records = 0;
+
+	block.clear();
+	block.reserve(BlockSize + 128);
+
+	queued_blocks.Start();
+	writer = std::thread(&TraceRecorder::WriteBlocks, this);
+	return true;
+}
+
+static void append_varint(std::vector<uint8_t>& out, uint32_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+void TraceRecorder::Add(const Record& record)
+{
+	assert(outfile);
+
+	uint32_t changed = 0;
+	for (size_t i = 0; i < NumFields; ++i) {
+		if (record[i] != previous[i]) {
+			changed |= 1u << i;
+		}
+	}
+	append_varint(block, changed);
+
+	for (size_t i = 0; i < NumFields; ++i) {
+		if (!(changed & (1u << i))) {
+			continue;
+		}
+		if (i == Eip) {
+			// Mostly a small step forwards; zigzag keeps short
+			// jumps backwards short too
+			const auto delta = static_cast<int32_t>(record[i] - previous[i]);
+			append_varint(block,
+			              static_cast<uint32_t>(delta) << 1 ^
+			                      static_cast<uint32_t>(delta >> 31));
+		} else if (i == Code) {
+			for (auto shift = 0; shift < 32; shift += 8) {
+				block.push_back(static_cast<uint8_t>(record[i] >> shift));
+			}
+		} else {
+			append_varint(block, record[i] ^ previous[i]);
+		}
+	}
+	previous = record;
+	++num_records;
+
+	if (block.size() >= BlockSize) {
+		queued_blocks.Enqueue(std::move(block));
+		block.clear();
+		block.reserve(BlockSize + 128);
+		previous = {};
+	}
+}
+
+static void write_u32_le(FILE* fp, const uint32_t value)
+{
+	const uint8_t bytes[4] = {static_cast<uint8_t>(value),
+	                          static_cast<uint8_t>(value >> 8),
+	                          static_cast<uint8_t>(value >> 16),
+	                          static_cast<uint8_t>(value >> 24)};
+	fwrite(bytes, 1, sizeof(bytes), fp);
+}
+
+void TraceRecorder::WriteBlocks()
+{
+	std::vector<uint8_t> compressed = {};
+
+	while (auto raw = queued_blocks.Dequeue()) {
+		auto compressed_size = compressBound(static_cast<uLong>(raw->size()));
+		compressed.resize(compressed_size);
+
+		if (compress2(compressed.data(),
+		              &compressed_size,
+		              raw->data(),
+		              static_cast<uLong>(raw->size()),
+		              Z_BEST_SPEED) != Z_OK) {
+			LOG_WARNING("DEBUG: Failed to compress a block of the execution trace");
+			continue;
+		}
+		write_u32_le(outfile, static_cast<uint32_t>(raw->size()));
+		write_u32_le(outfile, static_cast<uint32_t>(compressed_size));
+		fwrite(compressed.data(), 1, compressed_size, outfile);
+	}
+}
+
+void TraceRecorder::Close()
+{
+	assert(outfile);
+
+	if (!block.empty()) {
+		queued_blocks.Enqueue(std::move(block));
+		block.clear();
+	}
+	queued_blocks.Stop();
+	writer.join();
+
+	fclose(outfile);
+	outfile = nullptr;
+}
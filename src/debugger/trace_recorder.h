@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TRACE_RECORDER_H
+#define DOSBOX_TRACE_RECORDER_H
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/rwqueue.h"
+
+// Records an execution trace (one record per instruction) as a compact
+// binary file, for the heavy debugger's LOGB command.
+//
+// Each record is delta-encoded against the one before: a varint mask of
+// the fields that changed, then the EIP as a zigzag varint of the change,
+// the code bytes as they are, and the other fields as varints of their XOR
+// with the previous value. Straight-line code with few register changes
+// comes to a handful of bytes per instruction. Each 1 MB of records is
+// zlib-compressed on a background thread, so the emulation thread only
+// pays for the encoding.
+//
+// The file starts with the 8 bytes "DBXTRC01", followed by blocks of a
+// little-endian 32-bit raw size, 32-bit compressed size and the zlib data.
+// Every block starts over from an all-zero previous record, so blocks can
+// be decoded independently. 'scripts/tools/dump-trace.py' turns a trace
+// back into text.
+//
+class TraceRecorder {
+public:
+	enum Field : uint8_t {
+		Cs,
+		Eip,
+		// The first four bytes at CS:EIP, first byte lowest
+		Code,
+		Eax,
+		Ebx,
+		Ecx,
+		Edx,
+		Esi,
+		Edi,
+		Ebp,
+		Esp,
+		Ds,
+		Es,
+		Ss,
+		Flags,
+		NumFields,
+	};
+
+	using Record = std::array<uint32_t, NumFields>;
+
+	static constexpr size_t BlockSize = 1024 * 1024;
+
+	TraceRecorder() = default;
+	~TraceRecorder();
+
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const
+	{
+		return outfile != nullptr;
+	}
+
+	void Add(const Record& record);
+
+	uint64_t NumRecords() const
+	{
+		return num_records;
+	}
+
+	// prevent copying
+	TraceRecorder(const TraceRecorder&) = delete;
+	// prevent assignment
+	TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+private:
+	void WriteBlocks();
+
+	FILE* outfile = nullptr;
+
+	Record previous      = {};
+	uint64_t num_records = 0;
+
+	std::vector<uint8_t> block = {};
+
+	RWQueue<std::vector<uint8_t>> queued_blocks{4};
+	std::thread writer = {};
+};
+
+#endif // DOSBOX_TRACE_RECORDER_H
@@ -7,13 +7,17 @@
 
 #include "dosbox.h"
 
+#include <condition_variable>
 #include <cstring>
 #include <fstream>
 #include <iostream>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "audio/mixer.h"
@@ -239,7 +243,14 @@ private:
 		}
 
 	private:
+		// Expects the mutex to be held
+		bool reposition(const uint32_t offset);
+
 		std::ifstream* file;
+
+		// Data reads come from the emulation thread and the IDE read
+		// worker, audio from the decoder thread
+		std::mutex mutex = {};
 	};
 
 	class AudioFile final : public TrackFile {
@@ -266,7 +277,59 @@ private:
 		void setAudioPosition([[maybe_unused]] uint32_t pos) override {}
 
 	private:
+		// The track is decoded by a worker thread, so neither the
+		// mixer nor a seek waits on the codec. Right after loading it
+		// decodes the start of the track, which is kept, so playback
+		// from the start of a track begins at once. Once the track is
+		// played it keeps decoding a little ahead of the play
+		// position. A seek outside of what's decoded moves the worker
+		// there; reads wait for it only if they get there first.
+		void DecodeLoop();
+
+		// Copies up to 'frames' frames from the play position on,
+		// waiting for the worker where needed. Returns fewer at the
+		// end of the track.
+		uint32_t Pull(void* buffer, uint32_t frames);
+
+		// Moves the worker to the play position unless it's already
+		// decoding towards it. Expects the mutex to be held.
+		void Reposition();
+
+		uint64_t HeadEnd() const
+		{
+			return head.size() / channels;
+		}
+		uint64_t AheadEnd() const
+		{
+			return ahead_first + ahead.size() / channels;
+		}
+
 		Sound_Sample* sample = nullptr;
+
+		std::thread decoder              = {};
+		std::mutex mutex                 = {};
+		std::condition_variable wake     = {};
+		std::condition_variable progress = {};
+
+		// Frames are in the track's own format; positions count them
+		// from the start of the track
+		uint8_t channels        = 0;
+		uint64_t head_frames    = 0;
+		uint64_t ahead_frames   = 0;
+		std::vector<int16_t> head  = {};
+		std::vector<int16_t> ahead = {};
+		uint64_t ahead_first   = 0;
+		uint64_t play_frame    = 0;
+
+		// Where the worker decodes next, unless it's asked to seek
+		std::optional<uint64_t> seek_to = {};
+		uint64_t generation = 0;
+
+		bool is_head_done = false;
+		bool is_played    = false;
+		bool is_eof       = false;
+		bool is_error     = false;
+		bool should_stop  = false;
 	};
 
 public:
@@ -6,6 +6,7 @@
 
 #include "cdrom.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <chrono>
@@ -43,6 +44,12 @@ using tracks_size_t    = std::vector<CDROM_Interface_Image::Track>::size_type;
 // Ensure the maximum allowed redbook bytes stays within the API type sizes
 static_assert(MAX_REDBOOK_BYTES <= UINT32_MAX);
 
+// Audio tracks are decoded this many frames at a time, keeping the start of
+// each track and, once it's played, what follows the play position decoded
+constexpr uint32_t DecodeChunkFrames = 4096;
+constexpr uint32_t DecodedHeadMs     = 1000;
+constexpr uint32_t DecodedAheadMs    = 1000;
+
 // Report bad seeks that would go beyond the end of the track
 bool CDROM_Interface_Image::TrackFile::offsetInsideTrack(const uint32_t offset)
 {
@@ -108,12 +115,14 @@ bool CDROM_Interface_Image::BinaryFile::read(uint8_t *buffer,
 	assertm(offset <= MAX_REDBOOK_BYTES, "Requested offset exceeds CDROM size");
 	assertm(requested_bytes <= MAX_REDBOOK_BYTES, "Requested bytes exceeds CDROM size");
 
+	std::lock_guard lock(mutex);
+
 	const uint32_t adjusted_bytes = adjustOverRead(offset, requested_bytes);
 	if (adjusted_bytes == 0) // no work to do!
 		return true;
 
 	// Reposition if needed
-	if (!seek(offset))
+	if (!reposition(offset))
 		return false;
 
 	file->read((char *)buffer, adjusted_bytes);
@@ -150,6 +159,12 @@ uint16_t CDROM_Interface_Image::BinaryFile::getEndian()
 }
 
 bool CDROM_Interface_Image::BinaryFile::seek(const uint32_t offset)
+{
+	std::lock_guard lock(mutex);
+	return reposition(offset);
+}
+
+bool CDROM_Interface_Image::BinaryFile::reposition(const uint32_t offset)
 {
 	// Check for logic bugs and illegal values
 	assertm(file, "The file pointer needs to be valid, but is the nullptr");
@@ -182,9 +197,11 @@ uint32_t CDROM_Interface_Image::BinaryFile::decode(int16_t *buffer,
 	assertm(audio_pos < MAX_REDBOOK_BYTES,
 	        "Tried to decode audio before the playback position was set");
 
+	std::lock_guard lock(mutex);
+
 	// Reposition against our last audio position if needed
 	if (static_cast<uint32_t>(file->tellg()) != audio_pos)
-		if (!seek(audio_pos))
+		if (!reposition(audio_pos))
 			return 0;
 
 	file->read((char*)buffer, desired_track_frames * BYTES_PER_REDBOOK_PCM_FRAME);
@@ -214,6 +231,12 @@ CDROM_Interface_Image::AudioFile::AudioFile(const char *filename, bool &error)
 		LOG_MSG("CDROM: Loaded %s [%d Hz, %d-channel, %2.1f minutes]",
 		        filename_only.c_str(), getRate(), getChannels(),
 		        getLength() / static_cast<double>(REDBOOK_PCM_BYTES_PER_MIN));
+
+		channels     = getChannels();
+		head_frames  = uint64_t{getRate()} * DecodedHeadMs / 1000;
+		ahead_frames = uint64_t{getRate()} * DecodedAheadMs / 1000;
+		decoder      = std::thread(&AudioFile::DecodeLoop, this);
+		set_thread_name(decoder, "dosbox:cdaudio");
 	} else {
 		LOG_MSG("CDROM: Failed adding '%s' as CDDA track!", filename_only.c_str());
 		error = true;
@@ -226,6 +249,14 @@ CDROM_Interface_Image::AudioFile::~AudioFile()
 	if (sample == nullptr)
 		return;
 
+	if (decoder.joinable()) {
+		{
+			std::lock_guard lock(mutex);
+			should_stop = true;
+		}
+		wake.notify_one();
+		decoder.join();
+	}
 	Sound_FreeSample(sample);
 	sample = nullptr;
 }
@@ -263,43 +294,155 @@ bool CDROM_Interface_Image::AudioFile::seek(const uint32_t requested_pos)
 	const uint32_t pos_in_frames = ceil_udivide(requested_pos, BYTES_PER_RAW_REDBOOK_FRAME);
 	const uint32_t pos_in_ms = ceil_udivide(pos_in_frames * ms_per_s, REDBOOK_FRAMES_PER_SECOND);
 
+	// Hand the seek to the decoder, unless what's decoded already covers it
+	{
+		std::lock_guard lock(mutex);
+		play_frame = uint64_t{pos_in_ms} * getRate() / ms_per_s;
+		Reposition();
+	}
+	audio_pos = requested_pos;
+
 #ifdef DEBUG
-	/**
-	 *  In DEBUG mode, we additionally measure the seek latency, which can
-	 *  be an issue for some codecs. 
-	 */
-	using namespace std::chrono;
-	using clock = std::chrono::steady_clock;
-	clock::time_point begin = clock::now(); // start the timer
+	const double pos_in_min = static_cast<double>(pos_in_ms) / 60000.0;
+	LOG_MSG("CDROM: seeked to byte %u (frame %u at %.2f min)",
+	        requested_pos, pos_in_frames, pos_in_min);
 #endif
 
-	// Perform the seek and update our position
-	const bool result = Sound_Seek(sample, pos_in_ms);
-	audio_pos = result ? requested_pos : std::numeric_limits<uint32_t>::max();
+	return true;
+}
 
-#ifdef DEBUG
-	clock::time_point end = clock::now(); // stop the timer
-	const int32_t elapsed_ms = static_cast<int32_t>
-	    (duration_cast<milliseconds>(end - begin).count());
+void CDROM_Interface_Image::AudioFile::Reposition()
+{
+	// What the head holds needs no decoding
+	const auto from = play_frame < HeadEnd() ? HeadEnd() : play_frame;
 
-	// Report general seek diagnostics
-	const double pos_in_min = static_cast<double>(pos_in_ms) / 60000.0;
-	LOG_MSG("CDROM: seeked to byte %u (frame %u at %.2f min), and took %u ms",
-	        requested_pos, pos_in_frames, pos_in_min, elapsed_ms);
+	// Either the head is still being decoded up to there, or the
+	// ahead buffer holds it or is about to
+	if (!is_head_done && from == HeadEnd()) {
+		return;
+	}
+	if (from >= ahead_first && from <= AheadEnd()) {
+		return;
+	}
 
-	/**
-	 *  Inform the user if the seek took longer than that of a physical
-	 *  CDROM drive, which might have caused in-game symptoms like pauses
-	 *  or stuttering.
-	 */
-	const int32_t average_cdrom_seek_ms = 200;
-	if (elapsed_ms > average_cdrom_seek_ms)
-		LOG_MSG("CDROM: seek took %d ms, which is slower than an average "
-		        "physical CDROM drive's seek time of %d ms.",
-		        elapsed_ms, average_cdrom_seek_ms);
-#endif
+	is_head_done = true;
+	seek_to      = from;
+	++generation;
+	ahead.clear();
+	ahead_first = from;
+	is_eof      = false;
+	wake.notify_one();
+}
 
-	return result;
+uint32_t CDROM_Interface_Image::AudioFile::Pull(void* buffer, const uint32_t frames)
+{
+	auto out = static_cast<int16_t*>(buffer);
+
+	std::unique_lock lock(mutex);
+	is_played = true;
+
+	uint32_t pulled = 0;
+	while (pulled < frames) {
+		const int16_t* source = nullptr;
+		uint64_t available    = 0;
+		if (play_frame < HeadEnd()) {
+			source    = head.data() + play_frame * channels;
+			available = HeadEnd() - play_frame;
+		} else if (play_frame >= ahead_first && play_frame < AheadEnd()) {
+			source    = ahead.data() + (play_frame - ahead_first) * channels;
+			available = AheadEnd() - play_frame;
+		} else if (is_eof && play_frame >= ahead_first) {
+			break;
+		} else {
+			Reposition();
+			progress.wait(lock);
+			continue;
+		}
+		const auto count = static_cast<uint32_t>(
+		        std::min(available, uint64_t{frames - pulled}));
+		std::copy_n(source, count * channels, out + pulled * channels);
+		pulled += count;
+		play_frame += count;
+	}
+
+	// Drop what's been played once it adds up
+	if (play_frame > ahead_first) {
+		const auto played = std::min(play_frame, AheadEnd()) - ahead_first;
+		if (played >= ahead_frames / 2) {
+			ahead.erase(ahead.begin(),
+			            ahead.begin() + static_cast<std::ptrdiff_t>(played * channels));
+			ahead_first += played;
+		}
+	}
+	wake.notify_one();
+	return pulled;
+}
+
+void CDROM_Interface_Image::AudioFile::DecodeLoop()
+{
+	const auto rate = getRate();
+	std::vector<int16_t> chunk(DecodeChunkFrames * channels);
+
+	std::unique_lock lock(mutex);
+	while (!should_stop) {
+		const auto current_generation = generation;
+
+		if (seek_to) {
+			const auto frame = *seek_to;
+			seek_to.reset();
+			lock.unlock();
+			const auto ms = static_cast<uint32_t>(frame * 1000 / rate);
+			const bool is_seeked = Sound_Seek(sample, ms) != 0;
+			lock.lock();
+			if (generation == current_generation) {
+				// The codec seeks to the millisecond
+				ahead_first = is_seeked ? uint64_t{ms} * rate / 1000 : frame;
+				is_eof = !is_seeked;
+				progress.notify_all();
+			}
+			continue;
+		}
+
+		const auto base = play_frame < HeadEnd() ? HeadEnd() : play_frame;
+		const bool fills_head  = !is_head_done;
+		const bool fills_ahead = is_head_done && is_played && !is_eof &&
+		                         AheadEnd() < base + ahead_frames;
+		if (!fills_head && !fills_ahead) {
+			wake.wait(lock);
+			continue;
+		}
+
+		auto frames = DecodeChunkFrames;
+		if (fills_head) {
+			frames = static_cast<uint32_t>(
+			        std::min(uint64_t{frames}, head_frames - HeadEnd()));
+		}
+		lock.unlock();
+		const auto decoded = Sound_Decode_Direct(sample, chunk.data(), frames);
+		const auto flags   = sample->flags;
+		lock.lock();
+
+		// Anything decoded before a seek is of no use
+		if (generation != current_generation) {
+			continue;
+		}
+		auto& decoded_to = fills_head ? head : ahead;
+		decoded_to.insert(decoded_to.end(),
+		                  chunk.begin(),
+		                  chunk.begin() + decoded * channels);
+
+		const bool is_end = !decoded || (flags & (SOUND_SAMPLEFLAG_ERROR |
+		                                          SOUND_SAMPLEFLAG_EOF));
+		if (fills_head && (is_end || HeadEnd() >= head_frames)) {
+			is_head_done = true;
+			ahead_first  = HeadEnd();
+		}
+		if (is_end) {
+			is_eof   = true;
+			is_error = (flags & SOUND_SAMPLEFLAG_ERROR);
+		}
+		progress.notify_all();
+	}
 }
 
 bool CDROM_Interface_Image::AudioFile::read(uint8_t *buffer,
@@ -344,17 +487,8 @@ bool CDROM_Interface_Image::AudioFile::read(uint8_t *buffer,
 	const uint32_t requested_frames = ceil_udivide(adjusted_bytes,
 	                                               BYTES_PER_REDBOOK_PCM_FRAME);
 
-	uint32_t decoded_bytes = 0;
-	uint32_t decoded_frames = 0;
-	while (decoded_frames < requested_frames) {
-		const uint32_t decoded = Sound_Decode_Direct(sample,
-		                                             buffer + decoded_bytes,
-		                                             requested_frames - decoded_frames);
-		if (sample->flags & (SOUND_SAMPLEFLAG_ERROR | SOUND_SAMPLEFLAG_EOF) || !decoded)
-			break;
-		decoded_frames += decoded;
-		decoded_bytes = decoded_frames * bytes_per_frame;
-	}
+	const uint32_t decoded_frames = Pull(buffer, requested_frames);
+	uint32_t decoded_bytes = decoded_frames * bytes_per_frame;
 	// Zero out any remainining frames that we didn't fill
 	if (decoded_frames < requested_frames)
 		memset(buffer + decoded_bytes, 0, adjusted_bytes - decoded_bytes);
@@ -405,7 +539,9 @@ bool CDROM_Interface_Image::AudioFile::read(uint8_t *buffer,
 	}
 	// reading DAE is an audio-task, so update our audio position
 	audio_pos += decoded_bytes;
-	return !(sample->flags & SOUND_SAMPLEFLAG_ERROR);
+
+	std::lock_guard lock(mutex);
+	return !is_error;
 }
 
 uint32_t CDROM_Interface_Image::AudioFile::decode(int16_t *buffer,
@@ -414,9 +550,8 @@ uint32_t CDROM_Interface_Image::AudioFile::decode(int16_t *buffer,
 	assertm(audio_pos < MAX_REDBOOK_BYTES,
 	        "Tried to decode audio before the playback position was set");
 
-	// Sound_Decode_Direct returns frames (agnostic of bitrate and channels)
-	const uint32_t frames_decoded =
-	    Sound_Decode_Direct(sample, (void*)buffer, desired_track_frames);
+	// Frames are agnostic of bitrate and channels
+	const uint32_t frames_decoded = Pull(buffer, desired_track_frames);
 
 	// decoding is an audio-task, so update our audio position
 	// in terms of Redbook-equivalent bytes
@@ -989,6 +1124,23 @@ bool CDROM_Interface_Image::ReadSector(uint8_t *buffer, const bool raw, const ui
 bool CDROM_Interface_Image::ReadSectorsHost(void *buffer, bool raw, unsigned long sector, unsigned long num)
 {
 	unsigned int sectorSize = raw ? BYTES_PER_RAW_REDBOOK_FRAME : BYTES_PER_COOKED_REDBOOK_FRAME;
+
+	// A run of plain data sectors within one track is read in one go
+	if (num > 1 && !raw && sector <= MAX_REDBOOK_SECTOR) {
+		const auto first = static_cast<uint32_t>(sector);
+		const track_const_iter track = GetTrack(first);
+		if (track != tracks.end() && track->file &&
+		    track->sectorSize == BYTES_PER_COOKED_REDBOOK_FRAME &&
+		    !track->mode2 && first >= track->start &&
+		    sector + num <= track->start + track->length) {
+			const uint32_t offset = track->skip + (first - track->start) *
+			                                              track->sectorSize;
+			return track->file->read(static_cast<uint8_t*>(buffer),
+			                         offset,
+			                         static_cast<uint32_t>(num * sectorSize));
+		}
+	}
+
 	bool success = true; //Gobliiins reads 0 sectors
 	for(unsigned long i = 0; i < num; i++) {
 		success = ReadSector((uint8_t*)buffer + (i * (Bitu)sectorSize), raw, sector + i);
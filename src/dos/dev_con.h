@@ -38,6 +38,8 @@ public:
 private:
 	void ClearAnsi();
 	void Output(uint8_t chr);
+	bool OutputRun(const uint8_t* chars, const uint16_t num_chars);
+	uint16_t GetTeletypeRunLength(const uint8_t* chars, const uint16_t size) const;
 
 	uint8_t readcache = 0;
 	struct ansi {
@@ -172,6 +174,15 @@ bool device_CON::Write(uint8_t* data, uint16_t* size)
 				count++;
 				continue;
 			} else {
+				// Printable characters go out in runs where possible
+				const auto run_length = GetTeletypeRunLength(
+				        &data[count],
+				        static_cast<uint16_t>(*size - count));
+				if (run_length > 0 &&
+				    OutputRun(&data[count], run_length)) {
+					count += run_length;
+					continue;
+				}
 				Output(data[count]);
 				count++;
 				continue;
@@ -505,6 +516,40 @@ uint16_t device_CON::GetInformation()
 	return 0x80D3;
 }
 
+// The number of characters from the start that the BIOS teletype just
+// prints, up to the first one it or the ANSI parser treats specially
+uint16_t device_CON::GetTeletypeRunLength(const uint8_t* chars,
+                                          const uint16_t size) const
+{
+	uint16_t length = 0;
+	for (; length < size; ++length) {
+		switch (chars[length]) {
+		case Ascii::Bell:
+		case Ascii::Backspace:
+		case Ascii::Tab:
+		case Ascii::LineFeed:
+		case Ascii::CarriageReturn:
+		case Ascii::Escape: return length;
+		}
+	}
+	return length;
+}
+
+// Writes a run of printable characters straight into the text plane.
+// Returns false if they have to go through Output() one at a time.
+bool device_CON::OutputRun(const uint8_t* chars, const uint16_t num_chars)
+{
+	if (dos.internal_output || ansi.enabled) {
+		constexpr auto use_attribute = true;
+		return INT10_TeletypeOutputRun(chars,
+		                               num_chars,
+		                               ansi.attr,
+		                               use_attribute);
+	}
+	constexpr auto use_attribute = false;
+	return INT10_TeletypeOutputRun(chars, num_chars, 7, use_attribute);
+}
+
 void device_CON::Output(uint8_t chr)
 {
 	if (dos.internal_output || ansi.enabled) {
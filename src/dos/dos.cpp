@@ -25,7 +25,9 @@
 #include "cpu/registers.h"
 #include "config/setup.h"
 #include "utils/string_utils.h"
+#include "misc/savestate.h"
 #include "misc/support.h"
+#include "textmode_server/textmode_server.h"
 
 #if defined(WIN32)
 #include <winsock2.h> // for gethostname
@@ -68,6 +70,7 @@ uint8_t dos_copybuf[DOS_COPYBUFSIZE];
 
 void DOS_SetError(uint16_t code) {
 	dos.errorcode=code;
+	TEXTMODESERVER_OnDosError(code);
 }
 
 uint16_t DOS_GetBiosTimePacked()
@@ -278,6 +281,18 @@ static void DOS_PerformDiskIoDelayByHandle(uint16_t data_transferred_bytes,
 	}
 }
 
+// Files are read and written straight from and to guest memory. Devices
+// go through the copy buffer: they may run guest code while they wait or
+// print, which could remap or change the memory underneath them.
+static bool can_transfer_in_place(const uint16_t reg_handle)
+{
+	constexpr uint16_t IsDevice = 1 << 7;
+
+	const auto handle = RealHandle(reg_handle);
+	return handle < DOS_FILES && Files[handle] &&
+	       !(Files[handle]->GetInformation() & IsDevice);
+}
+
 void DOS_PerformHardDiskIoDelay(uint16_t data_transferred_bytes)
 {
 	constexpr auto HardDiskSpeedFastKbPerSec   = 15000;
@@ -1020,9 +1035,16 @@ static Bitu DOS_21Handler(void) {
 		{ 
 			uint16_t toread=DOS_GetAmount();
 			dos.echo=true;
-			if (DOS_ReadFile(reg_bx,dos_copybuf,&toread)) {
+			const auto dest = SegPhys(ds) + reg_dx;
+			const auto host_dest = can_transfer_in_place(reg_bx)
+			                             ? MEM_GetHostWriteSpan(dest, toread)
+			                             : nullptr;
+			const auto buffer = host_dest ? host_dest : dos_copybuf;
+			if (DOS_ReadFile(reg_bx, buffer, &toread)) {
 			        DOS_PerformDiskIoDelayByHandle(toread, reg_bx);
-			        MEM_BlockWrite(SegPhys(ds)+reg_dx,dos_copybuf,toread);
+				if (!host_dest) {
+					MEM_BlockWrite(dest, dos_copybuf, toread);
+				}
 				reg_ax=toread;
 				CALLBACK_SCF(false);
 			} else {
@@ -1036,8 +1058,15 @@ static Bitu DOS_21Handler(void) {
 	case 0x40:					/* WRITE Write to file or device */
 		{
 			uint16_t towrite=DOS_GetAmount();
-			MEM_BlockRead(SegPhys(ds)+reg_dx,dos_copybuf,towrite);
-			if (DOS_WriteFile(reg_bx,dos_copybuf,&towrite)) {
+			const auto src = SegPhys(ds) + reg_dx;
+			auto host_src = can_transfer_in_place(reg_bx)
+			                      ? MEM_GetHostReadSpan(src, towrite)
+			                      : nullptr;
+			if (!host_src) {
+				MEM_BlockRead(src, dos_copybuf, towrite);
+				host_src = dos_copybuf;
+			}
+			if (DOS_WriteFile(reg_bx, host_src, &towrite)) {
 			        DOS_ExecuteRegisteredCallbacksByHandle(reg_bx);
 			        DOS_PerformDiskIoDelayByHandle(towrite, reg_bx);
 			        reg_ax = towrite;
@@ -1749,6 +1778,8 @@ public:
 
 		callback[1].Install(DOS_21Handler,CB_INT21,"DOS Int 21");
 		callback[1].Set_RealVec(0x21);
+		// Compilers and file tools call it thousands of times a second
+		callback[1].SetInline(true);
 	//Pseudo code for int 21
 	// sti
 	// callback 
@@ -1823,6 +1854,118 @@ public:
 	}
 };
 
+// The DOS kernel's own variables; everything else it keeps lives in guest
+// RAM and is covered by the memory section
+struct DosKernelState {
+	DOS_Date date             = {};
+	DOS_Version version       = {};
+	uint16_t first_mcb        = 0;
+	uint16_t error_code       = 0;
+	uint16_t env              = 0;
+	RealPt cpm_entry          = 0;
+	uint8_t return_code       = 0;
+	DosReturnMode return_mode = {};
+	uint8_t current_drive     = 0;
+	bool verify               = false;
+	bool break_check          = false;
+	bool echo                 = false;
+	bool direct_output        = false;
+	bool internal_output      = false;
+};
+
+// Open files are host objects, so they can't be recreated from a blob; the
+// same files must still be open and only their positions are restored
+constexpr uint32_t UnseekablePosition = UINT32_MAX;
+
+static uint32_t get_file_position(DOS_File& file)
+{
+	constexpr uint16_t IsDevice = 1 << 7;
+	if (file.GetInformation() & IsDevice) {
+		return UnseekablePosition;
+	}
+	uint32_t position = 0;
+	return file.Seek(&position, DOS_SEEK_CUR) ? position : UnseekablePosition;
+}
+
+void DOS_SaveState(SaveStateWriter& out)
+{
+	DosKernelState state = {};
+
+	state.date            = dos.date;
+	state.version         = dos.version;
+	state.first_mcb       = dos.firstMCB;
+	state.error_code      = dos.errorcode;
+	state.env             = dos.env;
+	state.cpm_entry       = dos.cpmentry;
+	state.return_code     = dos.return_code;
+	state.return_mode     = dos.return_mode;
+	state.current_drive   = dos.current_drive;
+	state.verify          = dos.verify;
+	state.break_check     = dos.breakcheck;
+	state.echo            = dos.echo;
+	state.direct_output   = dos.direct_output;
+	state.internal_output = dos.internal_output;
+	out.Write(state);
+
+	for (const auto& file : Files) {
+		out.Write(static_cast<uint8_t>(file ? 1 : 0));
+		if (file) {
+			out.WriteString(file->name);
+			out.Write(get_file_position(*file));
+		}
+	}
+}
+
+bool DOS_LoadState(SaveStateReader& in, const bool apply)
+{
+	DosKernelState state = {};
+	if (!in.Read(state)) {
+		return false;
+	}
+
+	std::array<uint32_t, DOS_FILES> positions = {};
+	for (size_t i = 0; i < Files.size(); ++i) {
+		uint8_t is_open = 0;
+		std::string name = {};
+		if (!in.Read(is_open)) {
+			return false;
+		}
+		if (is_open && (!in.ReadString(name) || !in.Read(positions[i]))) {
+			return false;
+		}
+		const auto& file = Files[i];
+		if ((is_open != 0) != (file != nullptr) || (file && file->name != name)) {
+			return in.Fail("open DOS files differ");
+		}
+	}
+	if (!apply) {
+		return true;
+	}
+
+	dos.date            = state.date;
+	dos.version         = state.version;
+	dos.firstMCB        = state.first_mcb;
+	dos.errorcode       = state.error_code;
+	dos.env             = state.env;
+	dos.cpmentry        = state.cpm_entry;
+	dos.return_code     = state.return_code;
+	dos.return_mode     = state.return_mode;
+	dos.current_drive   = state.current_drive;
+	dos.verify          = state.verify;
+	dos.breakcheck      = state.break_check;
+	dos.echo            = state.echo;
+	dos.direct_output   = state.direct_output;
+	dos.internal_output = state.internal_output;
+
+	for (size_t i = 0; i < Files.size(); ++i) {
+		if (Files[i] && positions[i] != UnseekablePosition) {
+			auto position = positions[i];
+			Files[i]->Seek(&position, DOS_SEEK_SET);
+		}
+	}
+	return true;
+}
+
 static DOS* test;
 
 void DOS_ShutDown(Section* /*sec*/) {
@@ -4,8 +4,12 @@
 
 #include "dosbox.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "cpu/callback.h"
 #include "cpu/cpu.h"
@@ -17,8 +21,11 @@
 #include "gui/titlebar.h"
 #include "hardware/memory.h"
 #include "hardware/vmware.h"
+#include "misc/benchmark.h"
+#include "misc/perf_counters.h"
 #include "misc/video.h"
 #include "programs/setver.h"
+#include "textmode_server/textmode_server.h"
 #include "utils/string_utils.h"
 
 #ifdef _MSC_VER
@@ -126,6 +133,14 @@ void DOS_Terminate(const uint16_t psp_seg, const bool is_terminate_and_stay_resi
 		return;
 	}
 
+	char name[9];
+	DOS_MCB(psp_seg - 1).GetFileName(name);
+	TEXTMODESERVER_OnProgramExited(psp_seg,
+	                               name,
+	                               exit_code,
+	                               is_terminate_and_stay_resident);
+	BENCHMARK_OnProgramExited(psp_seg, exit_code);
+
 	// Free files owned by process
 	if (!is_terminate_and_stay_resident) {
 		curpsp.CloseFiles();
@@ -281,10 +296,115 @@ static void setup_command_line(const uint16_t pspseg, const DOS_ParamBlock& bloc
 	psp.SetCommandTail(block.exec.cmdtail);
 }
 
+// ***************************************************************************
+// Executable image cache
+// ***************************************************************************
+
+// The parts of recently executed files that loading them needs, so running
+// the same programs over and over doesn't read them through the DOS file
+// layer every time. Entries are only used while the file's size, date and
+// time stay the same, and changes made through DOS drop them right away;
+// a file changed on the host within the two seconds a DOS time tells apart
+// without changing its size is the only one missed.
+
+struct ExecImage {
+	uint8_t drive             = 0;
+	std::string name          = {};
+	uint32_t file_size        = 0;
+	uint16_t time             = 0;
+	uint16_t date             = 0;
+	std::vector<uint8_t> data = {};
+};
+
+constexpr size_t ExecImageCacheSize = 16;
+
+// Bigger files are read every time
+constexpr uint32_t ExecImageMaxFileSize = 1024 * 1024;
+
+// Least recently executed first
+static std::vector<std::shared_ptr<const ExecImage>> exec_images = {};
+
+static PerfCounter dos_exec_image_hits("dos_exec_image_hits",
+                                       "Programs loaded from the cache of executed images.");
+
+void DOS_ForgetExecImage(const uint8_t drive, const char* const fullname)
+{
+	std::erase_if(exec_images, [&](const auto& image) {
+		return image->drive == drive && iequals(image->name, fullname);
+	});
+}
+
+// The first 'num_bytes' of the file, or all of it if it's shorter
+static std::vector<uint8_t> read_exec_image(const uint16_t fhandle, const uint32_t num_bytes)
+{
+	std::vector<uint8_t> data(num_bytes);
+
+	uint32_t pos = 0;
+	DOS_SeekFile(fhandle, &pos, DOS_SEEK_SET);
+
+	size_t total = 0;
+	while (total < data.size()) {
+		auto amount = static_cast<uint16_t>(
+		        std::min<size_t>(data.size() - total, 0x8000));
+		if (!DOS_ReadFile(fhandle, data.data() + total, &amount) || amount == 0) {
+			break;
+		}
+		total += amount;
+	}
+	data.resize(total);
+	return data;
+}
+
+static std::shared_ptr<const ExecImage> load_exec_image(const char* const name,
+                                                        const uint16_t fhandle,
+                                                        uint32_t num_bytes)
+{
+	auto image = std::make_shared<ExecImage>();
+
+	char fullname[DOS_PATHLENGTH];
+	const bool is_cacheable = DOS_FindDevice(name) == DOS_DEVICES &&
+	                          DOS_MakeName(name, fullname, &image->drive) &&
+	                          DOS_SeekFile(fhandle, &image->file_size, DOS_SEEK_END) &&
+	                          DOS_GetFileDate(fhandle, &image->time, &image->date) &&
+	                          image->file_size <= ExecImageMaxFileSize;
+	if (is_cacheable) {
+		num_bytes = std::min(num_bytes, image->file_size);
+
+		const auto it = std::find_if(exec_images.begin(),
+		                             exec_images.end(),
+		                             [&](const auto& cached) {
+			                             return cached->drive == image->drive &&
+			                                    cached->file_size == image->file_size &&
+			                                    cached->time == image->time &&
+			                                    cached->date == image->date &&
+			                                    cached->data.size() >= num_bytes &&
+			                                    iequals(cached->name, fullname);
+		                             });
+		if (it != exec_images.end()) {
+			const auto cached = *it;
+			exec_images.erase(it);
+			exec_images.push_back(cached);
+			dos_exec_image_hits.Add();
+			return cached;
+		}
+	}
+
+	image->data = read_exec_image(fhandle, num_bytes);
+	if (is_cacheable) {
+		image->name = fullname;
+		DOS_ForgetExecImage(image->drive, fullname);
+		exec_images.push_back(image);
+		if (exec_images.size() > ExecImageCacheSize) {
+			exec_images.erase(exec_images.begin());
+		}
+	}
+	return image;
+}
+
 bool DOS_Execute(char * name,PhysPt block_pt,uint8_t flags) {
 	EXE_Header head;Bitu i;
-	uint16_t fhandle;uint16_t len;uint32_t pos;
-	uint16_t pspseg,envseg,loadseg,memsize,readsize;
+	uint16_t fhandle;uint16_t len;
+	uint16_t pspseg,envseg,loadseg,memsize;
 	PhysPt loadaddress;RealPt relocpt;
 	Bitu headersize=0,imagesize=0;
 	DOS_ParamBlock block(block_pt);
@@ -335,13 +455,21 @@ bool DOS_Execute(char * name,PhysPt block_pt,uint8_t flags) {
 			if (imagesize+headersize<512) imagesize = 512-headersize;
 		}
 	}
-	uint8_t *loadbuf = new uint8_t[0x10000];
+	/* Read what loading needs in one go: COM files up to 64k - 256
+	 * bytes, EXE files up to the end of the image or relocation table */
+	uint32_t image_bytes = 0xffff - 256;
+	if (!iscom) {
+		image_bytes = std::max<uint32_t>(static_cast<uint32_t>(headersize + imagesize),
+		                                 head.reloctable + head.relocations * 4u);
+	}
+	const auto image = load_exec_image(name, fhandle, image_bytes);
+	const auto& image_data = image->data;
+
 	if (flags!=OVERLAY) {
 		/* Create an environment block */
 		envseg=block.exec.envseg;
 		if (!MakeEnv(name,&envseg)) {
 			DOS_CloseFile(fhandle);
-			delete [] loadbuf;
 			return false;
 		}
 		/* Get Memory */		
@@ -350,9 +478,8 @@ bool DOS_Execute(char * name,PhysPt block_pt,uint8_t flags) {
 			minsize=0x1000;maxsize=0xffff;
 			if (is_machine_pcjr()) {
 				/* try to load file into memory below 96k */ 
-				pos=0;DOS_SeekFile(fhandle,&pos,DOS_SEEK_SET);	
-				uint16_t dataread=0x1800;
-				DOS_ReadFile(fhandle,loadbuf,&dataread);
+				const auto dataread = static_cast<uint16_t>(
+				        std::min<size_t>(image_data.size(), 0x1800));
 				if (dataread<0x1800) maxsize=((dataread+0x10)>>4)+0x20;
 				if (minsize>maxsize) minsize=maxsize;
 			}
@@ -364,16 +491,14 @@ bool DOS_Execute(char * name,PhysPt block_pt,uint8_t flags) {
 		if (maxfree<minsize) {
 			if (iscom) {
 				/* Reduce minimum of needed memory size to filesize */
-				pos=0;DOS_SeekFile(fhandle,&pos,DOS_SEEK_SET);	
-				uint16_t dataread=0xf800;
-				DOS_ReadFile(fhandle,loadbuf,&dataread);
+				const auto dataread = static_cast<uint16_t>(
+				        std::min<size_t>(image_data.size(), 0xf800));
 				if (dataread<0xf800) minsize=((dataread+0x10)>>4)+0x20;
 			}
 			if (maxfree<minsize) {
 				DOS_CloseFile(fhandle);
 				DOS_SetError(DOSERR_INSUFFICIENT_MEMORY);
 				DOS_FreeMemory(envseg);
-				delete [] loadbuf;
 				return false;
 			}
 		}
@@ -397,36 +522,25 @@ bool DOS_Execute(char * name,PhysPt block_pt,uint8_t flags) {
 	loadaddress=PhysicalMake(loadseg,0);
 
 	if (iscom) {	/* COM Load 64k - 256 bytes max */
-		pos=0;DOS_SeekFile(fhandle,&pos,DOS_SEEK_SET);	
-		readsize=0xffff-256;
-		DOS_ReadFile(fhandle,loadbuf,&readsize);
-		MEM_BlockWrite(loadaddress,loadbuf,readsize);
-	} else {	/* EXE Load in 32kb blocks and then relocate */
-		pos=headersize;DOS_SeekFile(fhandle,&pos,DOS_SEEK_SET);	
-		while (imagesize>0x7FFF) {
-			readsize=0x8000;DOS_ReadFile(fhandle,loadbuf,&readsize);
-			MEM_BlockWrite(loadaddress,loadbuf,readsize);
-//			if (readsize!=0x8000) LOG(LOG_EXEC,LOG_NORMAL)("Illegal header");
-			loadaddress+=0x8000;imagesize-=0x8000;
-		}
-		if (imagesize>0) {
-			readsize=(uint16_t)imagesize;DOS_ReadFile(fhandle,loadbuf,&readsize);
-			MEM_BlockWrite(loadaddress,loadbuf,readsize);
-//			if (readsize!=imagesize) LOG(LOG_EXEC,LOG_NORMAL)("Illegal header");
+		MEM_BlockWrite(loadaddress,image_data.data(),image_data.size());
+	} else {	/* EXE Load and then relocate */
+		if (image_data.size()>headersize) {
+			const auto loadsize=std::min<size_t>(imagesize,image_data.size()-headersize);
+//			if (loadsize!=imagesize) LOG(LOG_EXEC,LOG_NORMAL)("Illegal header");
+			MEM_BlockWrite(loadaddress,image_data.data()+headersize,loadsize);
 		}
-		/* Relocate the exe image */
+		/* Relocate the exe image, straight from the table read above */
 		uint16_t relocate;
 		if (flags==OVERLAY) relocate=block.overlay.relocation;
 		else relocate=loadseg;
-		pos=head.reloctable;DOS_SeekFile(fhandle,&pos,0);
 		for (i=0;i<head.relocations;i++) {
-			readsize=4;DOS_ReadFile(fhandle,(uint8_t *)&relocpt,&readsize);
-			relocpt=host_readd((HostPt)&relocpt);		//Endianize
+			const size_t entry=head.reloctable+i*4;
+			if (entry+4>image_data.size()) break;
+			relocpt=host_readd(&image_data[entry]);
 			PhysPt address=PhysicalMake(RealSegment(relocpt)+loadseg,RealOffset(relocpt));
 			mem_writew(address,mem_readw(address)+relocate);
 		}
 	}
-	delete [] loadbuf;
 	DOS_CloseFile(fhandle);
 
 	/* Setup a psp */
@@ -489,6 +603,8 @@ bool DOS_Execute(char * name,PhysPt block_pt,uint8_t flags) {
 			SETVER::OverrideVersion(canonical_name, newpsp);
 			// Store canonical name for display/debug purposes
 			add_canonical_name(dos.psp(), canonical_name);
+			TEXTMODESERVER_OnProgramStarted(dos.psp(), canonical_name);
+			BENCHMARK_OnProgramStarted(dos.psp(), canonical_name);
 		}
 
 		/* Setup bx, contains a 0xff in bl and bh if the drive in the fcb is not valid */
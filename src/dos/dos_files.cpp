@@ -19,10 +19,14 @@
 #include "misc/cross.h"
 #include "config/setup.h"
 #include "utils/string_utils.h"
+#include "misc/perf_counters.h"
 #include "misc/support.h"
+#include "misc/tracy.h"
 
 #define DOS_FILESTART 4
 
+static PerfCounter dos_file_opens("dos_file_opens", "Files opened or created through DOS.");
+
 #define FCB_SUCCESS     0
 #define FCB_READ_NODATA	1
 #define FCB_READ_PARTIAL 3
@@ -34,6 +38,31 @@ std::array<std::unique_ptr<DOS_File>, DOS_FILES> Files = {};
 
 std::array<std::shared_ptr<DOS_Drive>, DOS_DRIVES> Drives = {};
 
+static std::array<uint32_t, 256> file_change_counts = {};
+
+static size_t file_change_bucket(const uint8_t drive, const char* fullname)
+{
+	// FNV-1a over the drive and the upper-cased name
+	uint32_t hash = (0x811c'9dc5 ^ drive) * 0x0100'0193;
+	for (; *fullname; ++fullname) {
+		const auto c = static_cast<uint8_t>(toupper(static_cast<uint8_t>(*fullname)));
+		hash = (hash ^ c) * 0x0100'0193;
+	}
+	return hash % file_change_counts.size();
+}
+
+uint32_t DOS_GetFileChangeCount(const uint8_t drive, const char* const fullname)
+{
+	return file_change_counts[file_change_bucket(drive, fullname)];
+}
+
+// Lets whatever keeps a file's contents know they changed
+static void note_file_change(const uint8_t drive, const char* const fullname)
+{
+	++file_change_counts[file_change_bucket(drive, fullname)];
+	DOS_ForgetExecImage(drive, fullname);
+}
+
 // Set by "file_locking" config
 static bool emulate_file_locking = true;
 
@@ -559,6 +588,8 @@ bool DOS_Rename(const char* const oldname, const char* const newname)
 	}
 
 	if (new_ptr->Rename(fullold, fullnew)) {
+		note_file_change(driveold, fullold);
+		note_file_change(drivenew, fullnew);
 		return true;
 	}
 	/* Rename failed despite checks => no access */
@@ -633,6 +664,7 @@ bool DOS_FindNext(void) {
 
 
 bool DOS_ReadFile(uint16_t entry,uint8_t * data,uint16_t * amount,bool fcb) {
+	ZoneScoped;
 	uint32_t handle = fcb?entry:RealHandle(entry);
 	if (handle>=DOS_FILES) {
 		DOS_SetError(DOSERR_INVALID_HANDLE);
@@ -665,6 +697,7 @@ bool DOS_ReadFile(uint16_t entry,uint8_t * data,uint16_t * amount,bool fcb) {
 }
 
 bool DOS_WriteFile(uint16_t entry,uint8_t * data,uint16_t * amount,bool fcb) {
+	ZoneScoped;
 	uint32_t handle = fcb?entry:RealHandle(entry);
 	if (handle>=DOS_FILES) {
 		DOS_SetError(DOSERR_INVALID_HANDLE);
@@ -701,11 +734,13 @@ bool DOS_WriteFile(uint16_t entry,uint8_t * data,uint16_t * amount,bool fcb) {
 		// are set on file open and only get changed by a call to DOS_SetFileDate()
 		// This matches the behavior as tested on MS-DOS 6.22
 		Files[handle]->flush_time_on_close = FlushTimeOnClose::CurrentTime;
+		note_file_change(Files[handle]->GetDrive(), Files[handle]->GetName());
 	}
 	return ret;
 }
 
 bool DOS_SeekFile(uint16_t entry,uint32_t * pos,uint32_t type,bool fcb) {
+	ZoneScoped;
 	if (type > DOS_SEEK_END) {
 		DOS_SetError(DOSERR_FUNCTION_NUMBER_INVALID);
 		return false;
@@ -733,6 +768,7 @@ bool DOS_CloseFile(uint16_t entry, bool fcb, uint8_t * refcnt) {
 		return false;
 	};
 	Files[handle]->Close();
+	const auto write_failed = Files[handle]->TakeWriteError();
 
 	if (!fcb) {
 		DOS_PSP psp(dos.psp());
@@ -745,6 +781,10 @@ bool DOS_CloseFile(uint16_t entry, bool fcb, uint8_t * refcnt) {
 		refs=0;
 	}
 	if (refcnt!=nullptr) *refcnt=static_cast<uint8_t>(refs+1);
+	if (write_failed) {
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
 	return true;
 }
 
@@ -759,12 +799,20 @@ bool DOS_FlushFile(uint16_t entry) {
 		return false;
 	};
 	LOG(LOG_DOSMISC,LOG_NORMAL)("FFlush used.");
+	Files[handle]->Flush();
+	if (Files[handle]->TakeWriteError()) {
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
 	return true;
 }
 
 bool DOS_CreateFile(const char* name, FatAttributeFlags attributes,
                     uint16_t* entry, bool fcb)
 {
+	ZoneScoped;
+	dos_file_opens.Add();
+
 	// Creation of a device is the same as opening it
 	// Tc201 installer
 	if (DOS_FindDevice(name) != DOS_DEVICES)
@@ -808,6 +856,7 @@ bool DOS_CreateFile(const char* name, FatAttributeFlags attributes,
 		DOS_SetError(DOSERR_ACCESS_DENIED);
 		return false;
 	}
+	note_file_change(drive, fullname);
 	Files[handle] = Drives.at(drive)->FileCreate(fullname, attributes);
 	if (Files[handle]) {
 		Files[handle]->SetDrive(drive);
@@ -823,6 +872,8 @@ bool DOS_CreateFile(const char* name, FatAttributeFlags attributes,
 
 bool DOS_OpenFile(const char* name, uint8_t flags, uint16_t* entry, bool fcb)
 {
+	ZoneScoped;
+	dos_file_opens.Add();
 	/* First check for devices */
 	if (flags>2) LOG(LOG_FILES,LOG_ERROR)("Special file open command %X file %s",flags,name);
 	else LOG(LOG_FILES,LOG_NORMAL)("file open command %X file %s",flags,name);
@@ -976,6 +1027,7 @@ bool DOS_UnlinkFile(const char* const name)
 		return false;
 	}
 
+	note_file_change(drive, fullname);
 	return Drives.at(drive)->FileUnlink(fullname);
 }
 
@@ -1830,6 +1882,9 @@ bool DOS_LockFile(const uint16_t entry, const uint32_t pos, const uint32_t len)
 		DOS_SetError(DOSERR_LOCK_VIOLATION);
 		return false;
 	}
+	// Locked files are read and written directly, so others sharing
+	// them see every change
+	Files[handle]->Flush();
 	FileRegionLock lock = {};
 	lock.pos = pos;
 	lock.len = len;
@@ -1856,6 +1911,7 @@ bool DOS_UnlockFile(const uint16_t entry, const uint32_t pos, const uint32_t len
 	const auto last = Files[handle]->region_locks.end();
 	for (auto it = Files[handle]->region_locks.begin(); it != last; ++it) {
 		if (it->pos == pos && it->len == len) {
+			Files[handle]->Flush();
 			Files[handle]->region_locks.erase(it);
 			return true;
 		}
@@ -227,6 +227,12 @@ bool DOS_IsFileLocking();
 /* Helper Functions */
 bool DOS_MakeName(const char* const name, char* const fullname, uint8_t* drive);
 
+// How often files were changed through DOS, counted in a few hundred
+// buckets by drive and full name, so readers that keep a file's contents
+// can tell when to read it again. Files sharing a bucket only cause
+// extra reads.
+uint32_t DOS_GetFileChangeCount(uint8_t drive, const char* fullname);
+
 /* Drive Handing Routines */
 uint8_t DOS_GetDefaultDrive(void);
 void DOS_SetDefaultDrive(uint8_t drive);
@@ -253,6 +259,9 @@ bool DOS_NewPSP(uint16_t pspseg,uint16_t size);
 bool DOS_ChildPSP(uint16_t pspseg,uint16_t size);
 bool DOS_Execute(char * name,PhysPt block,uint8_t flags);
 
+// Drops what DOS_Execute() kept of the file, when it's changed
+void DOS_ForgetExecImage(uint8_t drive, const char* fullname);
+
 void DOS_Terminate(const uint16_t psp_seg, const bool is_terminate_and_stay_resident,
                    const uint8_t exit_code);
 
@@ -22,6 +22,7 @@
 #include "ints/bios_disk.h"
 #include "cpu/cpu.h"
 #include "cdrom.h"
+#include "hardware/ide.h"
 #include "utils/math_utils.h"
 #include "utils/string_utils.h"
 
@@ -235,6 +236,7 @@ int CMscdex::RemoveDrive(uint16_t _drive)
 	}
 
 	if (idx == MSCDEX_MAX_DRIVES || (idx!=0 && idx!=GetNumDrives()-1)) return 0;
+	IDE_CDROM_FinishReads();
 	CDROM::cdroms[idx].reset();
 	if (idx==0) {
 		for (uint16_t i=0; i<GetNumDrives(); i++) {
@@ -405,6 +407,7 @@ void CMscdex::ReplaceDrive(std::unique_ptr<CDROM_Interface> newCdrom, uint8_t su
 	if (CDROM::cdroms[subUnit] != nullptr) {
 		StopAudio(subUnit);
 	}
+	IDE_CDROM_FinishReads();
 	CDROM::cdroms[subUnit] = std::move(newCdrom);
 }
 
@@ -1440,6 +1443,7 @@ bool MSCDEX_HasMediaChanged(uint8_t subUnit)
 }
 
 void MSCDEX_ShutDown(Section* /*sec*/) {
+	IDE_CDROM_FinishReads();
 	std::for_each(CDROM::cdroms.begin(),
 	              CDROM::cdroms.end(),
 	              [](auto& cdrom_ptr) { cdrom_ptr.reset(); });
@@ -5,6 +5,7 @@
 #include "dos/programs.h"
 
 #include "shell/autoexec.h"
+#include "misc/benchmark.h"
 #include "programs/attrib.h"
 #include "programs/autotype.h"
 #include "programs/boot.h"
@@ -25,6 +26,7 @@
 #include "programs/mouse.h"
 #include "programs/mousectl.h"
 #include "programs/move.h"
+#include "programs/perf.h"
 #include "programs/placeholder.h"
 #include "programs/rescan.h"
 #include "programs/serial.h"
@@ -83,6 +85,7 @@ void Add_VFiles()
 	PROGRAMS_MakeFile("MOUSE.COM", ProgramCreate<MOUSE>);
 	PROGRAMS_MakeFile("MOUSECTL.COM", ProgramCreate<MOUSECTL>);
 	PROGRAMS_MakeFile("MOVE.EXE", ProgramCreate<MOVE>);
+	PROGRAMS_MakeFile("PERF.COM", ProgramCreate<PERF>);
 	PROGRAMS_MakeFile("RESCAN.COM", ProgramCreate<RESCAN>);
 	PROGRAMS_MakeFile("SERIAL.COM", ProgramCreate<SERIAL>);
 	PROGRAMS_MakeFile("SETVER.EXE", ProgramCreate<SETVER>);
@@ -90,6 +93,7 @@ void Add_VFiles()
 	PROGRAMS_MakeFile("TREE.COM", ProgramCreate<TREE>);
 
 	REELMAGIC_MaybeCreateFmpdrvExecutable();
+	BENCHMARK_MaybeRegisterWorkloads();
 
 	AUTOEXEC_RefreshFile();
 }
@@ -7,11 +7,14 @@
 
 #include "dosbox.h"
 
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "utils/bit_view.h"
 #include "misc/cross.h"
+#include "misc/host_dir_watcher.h"
 #include "utils/fs_utils.h"
 #include "hardware/memory.h"
 #include "misc/support.h"
@@ -116,6 +119,11 @@ public:
 	virtual bool	Write(uint8_t * data,uint16_t * size)=0;
 	virtual bool	Seek(uint32_t * pos,uint32_t type)=0;
 	virtual void	Close()=0;
+	// Writes out whatever the file holds back
+	virtual void	Flush() {}
+	// Whether writing out what was held back has failed since this was
+	// last asked, so the error reaches DOS after all
+	virtual bool	TakeWriteError() { return false; }
 	virtual uint16_t	GetInformation(void)=0;
 	virtual bool IsOnReadOnlyMedium() const = 0;
 
@@ -210,6 +218,16 @@ public:
 	void  DeleteEntry          (const char* path, bool ignoreLastDir = false);
 	void  EmptyCache           (void);
 
+	// Follows additions and removals made on the host in the cached
+	// directories, where the host can tell about them
+	void SetWatchHostChanges(bool watch);
+	// True while every cached directory is watched
+	bool IsWatchingHostChanges() const;
+
+	// Reads and stores directory listings through the shared mount
+	// cache, for drives whose host directories aren't written to
+	void SetShareListings(bool share) { shareListings = share; }
+
 	void SetLabel(const char *name, bool cdrom, bool allowupdate);
 	const char *GetLabel() const { return label; }
 
@@ -223,6 +241,7 @@ public:
 		          id(MAX_OPENDIRS),
 		          nextEntry(0),
 		          shortNr(0),
+		          watch(-1),
 		          fileList(0),
 		          longNameList(0)
 		{}
@@ -234,6 +253,8 @@ public:
 			}
 			fileList.clear();
 			longNameList.clear();
+			shortNameIndex.clear();
+			longNameIndex.clear();
 		}
 
 		char        orgname[CROSS_LEN];
@@ -243,9 +264,16 @@ public:
 		uint16_t      id;
 		Bitu        nextEntry;
 		unsigned    shortNr;
+		int         watch;
 		// contents
+		// Both sorted by short name, fileList for enumeration and
+		// longNameList for numbering generated short names
 		std::vector<CFileInfo*> fileList;
 		std::vector<CFileInfo*> longNameList;
+		// Lookups by name: every entry by its short name, and the
+		// entries of longNameList by their host name
+		std::unordered_map<std::string, CFileInfo*> shortNameIndex;
+		std::unordered_map<std::string, CFileInfo*> longNameIndex;
 	};
 
 private:
@@ -262,8 +290,17 @@ private:
 	CFileInfo*	FindDirInfo		(const char* path, char* expandedPath);
 	bool		RemoveSpaces		(char* str);
 	bool		OpenDir			(CFileInfo* dir, const char* path, uint16_t& id);
-	void		CreateEntry		(CFileInfo* dir, const char* name, bool is_directory);
+	CFileInfo*	CreateEntry		(CFileInfo* dir, const char* name, bool is_directory);
+	void		RemoveEntry		(CFileInfo* dir, CFileInfo* info);
+	Bits		IndexOf			(CFileInfo* dir, CFileInfo* info);
+	CFileInfo*	FindHostEntry		(CFileInfo* dir, const char* name);
+	void		CacheOutDir		(CFileInfo* dir);
+	void		WatchDir		(CFileInfo* dir, const char* path);
+	void		UnwatchDir		(CFileInfo* dir);
+	void		ApplyHostChanges	(void);
 	void		CopyEntry		(CFileInfo* dir, CFileInfo* from);
+	static std::string LongNameKey		(const char* name);
+	static void	InsertSorted		(std::vector<CFileInfo*>& list, CFileInfo* info);
 	uint16_t		GetFreeID		(CFileInfo* dir);
 	void		Clear			(void);
 
@@ -282,6 +319,13 @@ private:
 
 	char		label				[CROSS_LEN];
 	bool		updatelabel;
+
+	std::unique_ptr<HostDirWatcher> watcher = {};
+	// Directories by their watch; more than one if they're the same
+	// directory on the host
+	std::unordered_map<int, std::vector<CFileInfo*>> watchedDirs = {};
+	bool		missedWatch = false;
+	bool		shareListings = false;
 };
 
 enum class DosDriveType : uint16_t {
@@ -291,6 +335,7 @@ enum class DosDriveType : uint16_t {
 	Fat     = 3,
 	Iso     = 4,
 	Virtual = 5,
+	Archive = 6,
 };
 
 class DOS_Drive {
@@ -345,6 +390,8 @@ public:
 		case DosDriveType::Iso:
 			return MSG_Get("MOUNT_TYPE_ISO") + std::string(" ") + info;
 		case DosDriveType::Virtual: return MSG_Get("MOUNT_TYPE_VIRTUAL");
+		case DosDriveType::Archive:
+			return MSG_Get("MOUNT_TYPE_ARCHIVE") + std::string(" ") + info;
 		default: return MSG_Get("MOUNT_TYPE_UNKNOWN");
 		}
 	}
@@ -6,12 +6,15 @@
 #include <algorithm>
 #include <cassert>
 #include <iterator>
+#include <optional>
 #include <vector>
 
 #include "misc/cross.h"
 #include "dos_inc.h"
 #include "dos/drives.h"
+#include "dos/shared_mount_cache.h"
 #include "utils/string_utils.h"
+#include "misc/perf_counters.h"
 #include "misc/support.h"
 
 int fileInfoCounter = 0;
@@ -101,9 +104,38 @@ void DOS_Drive_Cache::EmptyCache(void) {
 	dirBase		= new CFileInfo;
 	save_dir	= nullptr;
 	srchNr		= 0;
+	missedWatch	= false;
 	if (basePath[0] != 0) SetBaseDir(basePath);
 }
 
+void DOS_Drive_Cache::SetWatchHostChanges(bool watch)
+{
+	if (!watch) {
+		for (const auto& [id, dirs] : watchedDirs) {
+			for (const auto dir : dirs) {
+				dir->watch = -1;
+			}
+		}
+		watchedDirs.clear();
+		watcher.reset();
+		return;
+	}
+	if (!watcher) {
+		watcher = std::make_unique<HostDirWatcher>();
+		if (!watcher->IsAvailable()) {
+			watcher.reset();
+			return;
+		}
+		// Whatever is cached in already isn't watched
+		missedWatch = dirBase && IsCachedIn(dirBase);
+	}
+}
+
+bool DOS_Drive_Cache::IsWatchingHostChanges() const
+{
+	return watcher && !missedWatch;
+}
+
 void DOS_Drive_Cache::SetLabel(const char* vname,bool cdrom,bool allowupdate) {
 /* allowupdate defaults to true. if mount sets a label then allowupdate is 
  * false and will this function return at once after the first call.
@@ -169,6 +201,8 @@ char* DOS_Drive_Cache::GetExpandNameAndNormaliseCase(const char* path)
 	static char work [CROSS_LEN] = { 0 };
 	char dir [CROSS_LEN];
 
+	ApplyHostChanges();
+
 	work[0] = 0;
 	safe_strcpy (dir, path);
 
@@ -202,6 +236,8 @@ void DOS_Drive_Cache::AddEntry(const char* path, bool checkExists) {
 	char file	[CROSS_LEN];
 	char expand	[CROSS_LEN];
 
+	ApplyHostChanges();
+
 	CFileInfo* dir = FindDirInfo(path,expand);
 	const char* pos = strrchr(path,CROSS_FILESPLIT);
 
@@ -239,6 +275,8 @@ void DOS_Drive_Cache::AddEntryDirOverlay(const char* path, bool checkExists) {
 	char expand	[CROSS_LEN];
 	char dironly[CROSS_LEN + 1];
 
+	ApplyHostChanges();
+
 	//When adding a directory, the directory we want to operate inside in is the above it. (which can go wrong if the directory already exists.)
 	safe_strcpy(dironly, path);
 	char* post = strrchr(dironly,CROSS_FILESPLIT);
@@ -304,6 +342,7 @@ void DOS_Drive_Cache::AddEntryDirOverlay(const char* path, bool checkExists) {
 }
 
 void DOS_Drive_Cache::DeleteEntry(const char* path, bool ignoreLastDir) {
+	ApplyHostChanges();
 	CacheOut(path,ignoreLastDir);
 	if (dirSearch[srchNr] && (dirSearch[srchNr]->nextEntry>0)) dirSearch[srchNr]->nextEntry--;
 
@@ -322,7 +361,9 @@ void DOS_Drive_Cache::DeleteEntry(const char* path, bool ignoreLastDir) {
 void DOS_Drive_Cache::CacheOut(const char* path, bool ignoreLastDir) {
 	char expand[CROSS_LEN] = { 0 };
 	CFileInfo* dir;
-	
+
+	ApplyHostChanges();
+
 	if (ignoreLastDir) {
 		char tmp[CROSS_LEN] = { 0 };
 		int32_t len=0;
@@ -340,6 +381,10 @@ void DOS_Drive_Cache::CacheOut(const char* path, bool ignoreLastDir) {
 	}
 
 //	LOG_DEBUG("DIR: Caching out %s : dir %s",expand,dir->orgname);
+	CacheOutDir(dir);
+}
+
+void DOS_Drive_Cache::CacheOutDir(CFileInfo* dir) {
 	// delete file objects...
 	//Maybe check if it is a file and then only delete the file and possibly the long name. instead of all objects in the dir.
 	for(uint32_t i=0; i<dir->fileList.size(); i++) {
@@ -351,6 +396,8 @@ void DOS_Drive_Cache::CacheOut(const char* path, bool ignoreLastDir) {
 	// clear lists
 	dir->fileList.clear();
 	dir->longNameList.clear();
+	dir->shortNameIndex.clear();
+	dir->longNameIndex.clear();
 	save_dir = nullptr;
 }
 
@@ -361,6 +408,8 @@ bool DOS_Drive_Cache::IsCachedIn(CFileInfo* curDir)
 
 
 bool DOS_Drive_Cache::GetShortName(const char* fullname, char* shortname) {
+	ApplyHostChanges();
+
 	// Get Dir Info
 	char expand[CROSS_LEN] = {0};
 	CFileInfo* curDir = FindDirInfo(fullname,expand);
@@ -371,23 +420,12 @@ bool DOS_Drive_Cache::GetShortName(const char* fullname, char* shortname) {
 	else
 		return false;
 
-	std::vector<CFileInfo*>::size_type filelist_size = curDir->longNameList.size();
-	if (filelist_size <= 0) {
+	const auto it = curDir->longNameIndex.find(LongNameKey(pos));
+	if (it == curDir->longNameIndex.end()) {
 		return false;
 	}
-
-	// The orgname part of the list is not sorted (shortname is)! So we can only walk through it.
-	for(Bitu i = 0; i < filelist_size; i++) {
-#if defined (WIN32)
-		if (strcasecmp(pos,curDir->longNameList[i]->orgname) == 0) {
-#else
-		if (strcmp(pos,curDir->longNameList[i]->orgname) == 0) {
-#endif
-			safe_strncpy(shortname, curDir->longNameList[i]->shortname, DOS_NAMELENGTH_ASCII);
-			return true;
-		}
-	}
-	return false;
+	safe_strncpy(shortname, it->second->shortname, DOS_NAMELENGTH_ASCII);
+	return true;
 }
 
 int DOS_Drive_Cache::CompareShortname(const char* compareName, const char* shortName) {
@@ -552,18 +590,12 @@ Bits DOS_Drive_Cache::GetLongName(CFileInfo* curDir, char* shortName, const size
 	// Remove dot, if no extension...
 	RemoveTrailingDot(shortName);
 	// Search long name and return array number of element
-	Bits low	= 0;
-	Bits high	= (Bits)(filelist_size-1);
-	Bits mid,res;
-	while (low<=high) {
-		mid = (low+high)/2;
-		res = strcmp(shortName,curDir->fileList[mid]->shortname);
-		if (res>0)	low  = mid+1; else
-		if (res<0)	high = mid-1; else
-		{	// Found
-			safe_strncpy(shortName, curDir->fileList[mid]->orgname, shortName_len);
-			return mid;
-		};
+	if (const auto it = curDir->shortNameIndex.find(shortName);
+	    it != curDir->shortNameIndex.end()) {
+		const auto index = IndexOf(curDir, it->second);
+		assert(index >= 0);
+		safe_strncpy(shortName, it->second->orgname, shortName_len);
+		return index;
 	}
 #ifdef WINE_DRIVE_SUPPORT
 	if (strlen(shortName) < 8 || shortName[4] != '~' || shortName[5] == '.' || shortName[6] == '.' || shortName[7] == '.') return -1; // not available
@@ -571,7 +603,7 @@ Bits DOS_Drive_Cache::GetLongName(CFileInfo* curDir, char* shortName, const size
 	// The above test is rather strict as the following loop can be really slow if filelist_size is large.
 	char buff[CROSS_LEN];
 	for (Bitu i = 0; i < filelist_size; i++) {
-		res = wine_hash_short_file_name(curDir->fileList[i]->orgname,buff);
+		const auto res = wine_hash_short_file_name(curDir->fileList[i]->orgname,buff);
 		buff[res] = 0;
 		if (!strcmp(shortName,buff)) {	
 			// Found
@@ -674,34 +706,19 @@ void DOS_Drive_Cache::CreateShortName(CFileInfo* curDir, CFileInfo* info) {
 		}
 
 		// keep list sorted for CreateShortNameID to work correctly
-		if (!curDir->longNameList.empty()) {
-			if (!(strcmp(info->shortname,curDir->longNameList.back()->shortname)<0)) {
-				// append at end of list
-				curDir->longNameList.push_back(info);
-			} else {
-				// look for position where to insert this element
-				bool found=false;
-				std::vector<CFileInfo*>::iterator it;
-				for (it=curDir->longNameList.begin(); it!=curDir->longNameList.end(); ++it) {
-					if (strcmp(info->shortname,(*it)->shortname)<0) {
-						found = true;
-						break;
-					}
-				}
-				// Put it in longname list...
-				if (found) curDir->longNameList.insert(it,info);
-				else curDir->longNameList.push_back(info);
-			}
-		} else {
-			// empty file list, append
-			curDir->longNameList.push_back(info);
-		}
+		InsertSorted(curDir->longNameList, info);
+		curDir->longNameIndex.emplace(LongNameKey(info->orgname), info);
 	} else {
 		safe_strcpy(info->shortname, tmpName);
 	}
 	RemoveTrailingDot(info->shortname);
 }
 
+static PerfCounter drive_cache_hits("drive_cache_hits",
+                                    "Host directory lookups answered from the last result.");
+static PerfCounter drive_cache_misses("drive_cache_misses",
+                                      "Host directory lookups that walked the cache.");
+
 DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindDirInfo(const char* path, char* expandedPath) {
 	// statics
 	static char	split[2] = { CROSS_FILESPLIT,0 };
@@ -715,8 +732,10 @@ DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindDirInfo(const char* path, char*
 
 	if (save_dir && (strcmp(path,save_path)==0)) {
 		safe_strncpy(expandedPath, save_expanded, CROSS_LEN);
+		drive_cache_hits.Add();
 		return save_dir;
 	};
+	drive_cache_misses.Add();
 
 //	LOG_DEBUG("DIR: Find %s",path);
 
@@ -792,6 +811,8 @@ DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindDirInfo(const char* path, char*
 }
 
 bool DOS_Drive_Cache::OpenDir(const char* path, uint16_t& id) {
+	ApplyHostChanges();
+
 	char expand[CROSS_LEN] = {0};
 	CFileInfo* dir = FindDirInfo(path,expand);
 	if (OpenDir(dir,expand,id)) {
@@ -830,7 +851,7 @@ bool DOS_Drive_Cache::OpenDir(CFileInfo* dir, const char* expand, uint16_t& id)
 	return false;
 }
 
-void DOS_Drive_Cache::CreateEntry(CFileInfo* dir, const char* name, bool is_directory) {
+DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::CreateEntry(CFileInfo* dir, const char* name, bool is_directory) {
 	CFileInfo* info = new CFileInfo;
 	safe_strcpy(info->orgname, name);
 	info->shortNr = 0;
@@ -839,32 +860,165 @@ void DOS_Drive_Cache::CreateEntry(CFileInfo* dir, const char* name, bool is_dire
 	// Check for long filenames...
 	CreateShortName(dir, info);		
 
-	bool found = false;
-
-	// keep list sorted (so GetLongName works correctly, used by CreateShortName in this routine)
-	if (!dir->fileList.empty()) {
-		if (!(strcmp(info->shortname,dir->fileList.back()->shortname)<0)) {
-			// append at end of list
-			dir->fileList.push_back(info);
-		} else {
-			// look for position where to insert this element
-			std::vector<CFileInfo*>::iterator it;
-			for (it=dir->fileList.begin(); it!=dir->fileList.end(); ++it) {
-				if (strcmp(info->shortname,(*it)->shortname)<0) {
-					found = true;
+	// keep list sorted for enumeration
+	InsertSorted(dir->fileList, info);
+	dir->shortNameIndex.emplace(info->shortname, info);
+	return info;
+}
+
+void DOS_Drive_Cache::RemoveEntry(CFileInfo* dir, CFileInfo* info) {
+	const auto index = IndexOf(dir, info);
+	if (index < 0)
+		return;
+	dir->fileList.erase(dir->fileList.begin() + index);
+
+	const auto pos = std::find(dir->longNameList.begin(), dir->longNameList.end(), info);
+	if (pos != dir->longNameList.end()) {
+		dir->longNameList.erase(pos);
+		dir->longNameIndex.erase(LongNameKey(info->orgname));
+	}
+	if (const auto it = dir->shortNameIndex.find(info->shortname);
+	    it != dir->shortNameIndex.end() && it->second == info) {
+		dir->shortNameIndex.erase(it);
+		// another entry of the same short name takes its place
+		const auto next = std::lower_bound(dir->fileList.begin(), dir->fileList.end(), info, SortByName);
+		if (next != dir->fileList.end() && strcmp((*next)->shortname, info->shortname) == 0)
+			dir->shortNameIndex.emplace((*next)->shortname, *next);
+	}
+
+	// Open searches of the directory move back past it
+	for (uint32_t i=0; i<MAX_OPENDIRS; i++) {
+		if ((dirSearch[i]==dir) && (dirSearch[i]->nextEntry > static_cast<Bitu>(index)))
+			dirSearch[i]->nextEntry--;
+	}
+	save_dir = nullptr;
+	DeleteFileInfo(info);
+}
+
+Bits DOS_Drive_Cache::IndexOf(CFileInfo* dir, CFileInfo* info) {
+	auto pos = std::lower_bound(dir->fileList.begin(), dir->fileList.end(), info, SortByName);
+	while (pos != dir->fileList.end() && *pos != info) {
+		if (strcmp((*pos)->shortname, info->shortname) != 0)
+			return -1;
+		++pos;
+	}
+	if (pos == dir->fileList.end())
+		return -1;
+	return std::distance(dir->fileList.begin(), pos);
+}
+
+DOS_Drive_Cache::CFileInfo* DOS_Drive_Cache::FindHostEntry(CFileInfo* dir, const char* name) {
+	const auto key = LongNameKey(name);
+	if (const auto it = dir->longNameIndex.find(key); it != dir->longNameIndex.end())
+		return it->second;
+
+	// Without a generated short name, the short name is the host name
+	char shortname[CROSS_LEN];
+	safe_strcpy(shortname, name);
+	upcase(shortname);
+	RemoveTrailingDot(shortname);
+	if (const auto it = dir->shortNameIndex.find(shortname);
+	    it != dir->shortNameIndex.end() && LongNameKey(it->second->orgname) == key)
+		return it->second;
+	return nullptr;
+}
+
+void DOS_Drive_Cache::WatchDir(CFileInfo* dir, const char* path) {
+	if (!watcher || dir->watch >= 0)
+		return;
+	const auto watch = watcher->Watch(path);
+	if (watch < 0) {
+		missedWatch = true;
+		return;
+	}
+	dir->watch = watch;
+	watchedDirs[watch].push_back(dir);
+}
+
+void DOS_Drive_Cache::UnwatchDir(CFileInfo* dir) {
+	if (dir->watch < 0)
+		return;
+	if (const auto it = watchedDirs.find(dir->watch); it != watchedDirs.end()) {
+		auto& dirs = it->second;
+		dirs.erase(std::remove(dirs.begin(), dirs.end(), dir), dirs.end());
+		if (dirs.empty()) {
+			watchedDirs.erase(it);
+			if (watcher)
+				watcher->Unwatch(dir->watch);
+		}
+	}
+	dir->watch = -1;
+}
+
+static PerfCounter drive_cache_host_changes("drive_cache_host_changes",
+                                            "Host directory changes applied to the cache.");
+
+void DOS_Drive_Cache::ApplyHostChanges(void) {
+	if (!watcher || watchedDirs.empty())
+		return;
+
+	for (const auto& change : watcher->TakeChanges()) {
+		if (change.type == HostDirWatcher::ChangeType::Overflow) {
+			LOG(LOG_MISC,LOG_WARN)("DIRCACHE: Lost track of host changes, rescanning");
+			EmptyCache();
+			return;
+		}
+		const auto it = watchedDirs.find(change.watch);
+		if (it == watchedDirs.end())
+			continue;
+		drive_cache_host_changes.Add();
+
+		// Removing entries can unwatch directories
+		const auto dirs = it->second;
+		for (const auto dir : dirs) {
+			const auto current = watchedDirs.find(change.watch);
+			if (current == watchedDirs.end() ||
+			    std::find(current->second.begin(), current->second.end(), dir) == current->second.end())
+				continue;
+			switch (change.type) {
+			case HostDirWatcher::ChangeType::Added: {
+				if (!IsCachedIn(dir) || FindHostEntry(dir, change.name.c_str()))
 					break;
+				const auto info = CreateEntry(dir, change.name.c_str(), change.is_dir);
+				const auto index = static_cast<Bitu>(IndexOf(dir, info));
+				// Check if there are any open search dir that are affected by this...
+				for (uint32_t i=0; i<MAX_OPENDIRS; i++) {
+					if ((dirSearch[i]==dir) && (index <= dirSearch[i]->nextEntry))
+						dirSearch[i]->nextEntry++;
 				}
+				break;
+			}
+			case HostDirWatcher::ChangeType::Removed:
+				if (const auto info = FindHostEntry(dir, change.name.c_str()))
+					RemoveEntry(dir, info);
+				break;
+			case HostDirWatcher::ChangeType::Gone:
+				// Scanned again, and watched again, if it's used again
+				UnwatchDir(dir);
+				CacheOutDir(dir);
+				break;
+			case HostDirWatcher::ChangeType::Overflow: break;
 			}
-			// Put file in lists
-			if (found) dir->fileList.insert(it,info);
-			else dir->fileList.push_back(info);
 		}
-	} else {
-		// empty file list, append
-		dir->fileList.push_back(info);
 	}
 }
 
+std::string DOS_Drive_Cache::LongNameKey(const char* name)
+{
+	std::string key = name;
+#if defined(WIN32)
+	// Host names are matched regardless of case here
+	upcase(key);
+#endif
+	return key;
+}
+
+void DOS_Drive_Cache::InsertSorted(std::vector<CFileInfo*>& list, CFileInfo* info)
+{
+	// after any entries of the same short name, as they were added first
+	list.insert(std::upper_bound(list.begin(), list.end(), info, SortByName), info);
+}
+
 void DOS_Drive_Cache::CopyEntry(CFileInfo* dir, CFileInfo* from) {
 	CFileInfo* info = new CFileInfo;
 	// just copy things into new fileinfo
@@ -881,6 +1035,15 @@ bool DOS_Drive_Cache::ReadDir(uint16_t id, char* &result) {
 	if (id >= MAX_OPENDIRS)
 		return false;
 
+	// A listing another instance stored is as good as reading it
+	std::optional<std::vector<SharedDirEntry>> listing = {};
+	if (!IsCachedIn(dirSearch[id]) && shareListings &&
+	    (listing = DOS_LoadSharedDirListing(dirPath))) {
+		WatchDir(dirSearch[id], dirPath);
+		for (const auto& entry : *listing) {
+			CreateEntry(dirSearch[id], entry.name.c_str(), entry.is_directory);
+		}
+	}
 	if (!IsCachedIn(dirSearch[id])) {
 		// Try to open directory
 		dir_information* dirp = open_directory(dirPath);
@@ -891,18 +1054,27 @@ bool DOS_Drive_Cache::ReadDir(uint16_t id, char* &result) {
 			}
 			return false;
 		}
+		// Watched first, so nothing added meanwhile is missed
+		WatchDir(dirSearch[id], dirPath);
+
 		// Read complete directory
 		char dir_name[CROSS_LEN];
 		bool is_directory;
+		std::vector<SharedDirEntry> entries = {};
 		if (read_directory_first(dirp, dir_name, is_directory)) {
-			CreateEntry(dirSearch[id], dir_name, is_directory);
-			while (read_directory_next(dirp, dir_name, is_directory)) {
+			do {
 				CreateEntry(dirSearch[id], dir_name, is_directory);
-			}
+				if (shareListings) {
+					entries.push_back({dir_name, is_directory});
+				}
+			} while (read_directory_next(dirp, dir_name, is_directory));
 		}
 
 		// close dir
 		close_directory(dirp);
+		if (shareListings && !entries.empty()) {
+			DOS_StoreSharedDirListing(dirPath, entries);
+		}
 
 		// Info
 /*		if (!dirp) {
@@ -940,6 +1112,7 @@ bool DOS_Drive_Cache::SetResult(CFileInfo* dir, char* &result, Bitu entryNr)
 // FindFirst / FindNext
 bool DOS_Drive_Cache::FindFirst(char* path, uint16_t& id) {
 	uint16_t	dirID;
+	ApplyHostChanges();
 	// Cache directory in 
 	if (!OpenDir(path,dirID)) return false;
 
@@ -1015,6 +1188,7 @@ void DOS_Drive_Cache::ClearFileInfo(CFileInfo *dir) {
 		dirSearch[dir->id] = nullptr;
 		dir->id = MAX_OPENDIRS;
 	}
+	UnwatchDir(dir);
 }
 
 void DOS_Drive_Cache::DeleteFileInfo(CFileInfo *dir) {
@@ -314,8 +314,6 @@ uint32_t fatDrive::getClustFirstSect(uint32_t clustNum) {
 
 uint32_t fatDrive::getClusterValue(uint32_t clustNum) {
 	uint32_t fatoffset=0;
-	uint32_t fatsectnum;
-	uint32_t fatentoff;
 	uint32_t clustValue=0;
 
 	switch(fattype) {
@@ -329,31 +327,29 @@ uint32_t fatDrive::getClusterValue(uint32_t clustNum) {
 			fatoffset = clustNum * 4;
 			break;
 	}
-	fatsectnum = bootbuffer.reservedsectors + (fatoffset / bootbuffer.bytespersector) + partSectOff;
-	fatentoff = fatoffset % bootbuffer.bytespersector;
-
-	if(curFatSect != fatsectnum) {
-		/* Load two sectors at once for FAT12 */
-		readSector(fatsectnum, &fatSectBuffer[0]);
-		if (fattype==FAT12)
-			readSector(fatsectnum + 1, &fatSectBuffer[BytePerSector]);
-		curFatSect = fatsectnum;
-	}
+	const uint32_t fatsectidx = fatoffset / bootbuffer.bytespersector;
+	const uint32_t fatentoff = fatoffset % bootbuffer.bytespersector;
+	uint8_t *fatsect = fatCacheSector(fatsectidx);
 
 	switch(fattype) {
-		case FAT12:
-			clustValue = var_read((uint16_t *)&fatSectBuffer[fatentoff]);
+		case FAT12: {
+			/* the entry may straddle two sectors */
+			const uint8_t hibyte = (fatentoff + 1 < bootbuffer.bytespersector)
+			                               ? fatsect[fatentoff + 1]
+			                               : fatCacheSector(fatsectidx + 1)[0];
+			clustValue = fatsect[fatentoff] | (hibyte << 8);
 			if(clustNum & 0x1) {
 				clustValue >>= 4;
 			} else {
 				clustValue &= 0xfff;
 			}
 			break;
+		}
 		case FAT16:
-			clustValue = var_read((uint16_t *)&fatSectBuffer[fatentoff]);
+			clustValue = var_read((uint16_t *)&fatsect[fatentoff]);
 			break;
 		case FAT32:
-			clustValue = var_read((uint32_t *)&fatSectBuffer[fatentoff]);
+			clustValue = var_read((uint32_t *)&fatsect[fatentoff]);
 			break;
 	}
 
@@ -362,8 +358,13 @@ uint32_t fatDrive::getClusterValue(uint32_t clustNum) {
 
 void fatDrive::setClusterValue(uint32_t clustNum, uint32_t clustValue) {
 	uint32_t fatoffset=0;
-	uint32_t fatsectnum;
-	uint32_t fatentoff;
+
+	/* chains we know of are only cut or rerouted by changing a link, not by
+	   extending an end of chain or taking a free cluster */
+	const uint32_t oldValue = getClusterValue(clustNum);
+	const uint32_t eofValue = (fattype == FAT12) ? 0xff8 : (fattype == FAT16) ? 0xfff8 : 0xfffffff8;
+	if (oldValue != 0 && oldValue < eofValue)
+		chainCache.clear();
 
 	switch(fattype) {
 		case FAT12:
@@ -376,21 +377,17 @@ void fatDrive::setClusterValue(uint32_t clustNum, uint32_t clustValue) {
 			fatoffset = clustNum * 4;
 			break;
 	}
-	fatsectnum = bootbuffer.reservedsectors + (fatoffset / bootbuffer.bytespersector) + partSectOff;
-	fatentoff = fatoffset % bootbuffer.bytespersector;
-
-	if(curFatSect != fatsectnum) {
-		/* Load two sectors at once for FAT12 */
-		readSector(fatsectnum, &fatSectBuffer[0]);
-		if (fattype==FAT12)
-			        readSector(fatsectnum + 1,
-			                   &fatSectBuffer[BytePerSector]);
-		curFatSect = fatsectnum;
-	}
+	const uint32_t fatsectidx = fatoffset / bootbuffer.bytespersector;
+	const uint32_t fatentoff = fatoffset % bootbuffer.bytespersector;
+	uint8_t *fatsect = fatCacheSector(fatsectidx);
+	const bool straddles = (fattype == FAT12) && (fatentoff + 1 >= bootbuffer.bytespersector);
 
 	switch(fattype) {
 		case FAT12: {
-			uint16_t tmpValue = var_read((uint16_t *)&fatSectBuffer[fatentoff]);
+			uint8_t &lobyte = fatsect[fatentoff];
+			uint8_t &hibyte = straddles ? fatCacheSector(fatsectidx + 1)[0]
+			                            : fatsect[fatentoff + 1];
+			uint16_t tmpValue = lobyte | (hibyte << 8);
 			if(clustNum & 0x1) {
 				clustValue &= 0xfff;
 				clustValue <<= 4;
@@ -402,23 +399,23 @@ void fatDrive::setClusterValue(uint32_t clustNum, uint32_t clustValue) {
 				tmpValue &= 0xf000;
 				tmpValue |= (uint16_t)clustValue;
 			}
-			var_write((uint16_t *)&fatSectBuffer[fatentoff], tmpValue);
+			lobyte = (uint8_t)(tmpValue & 0xff);
+			hibyte = (uint8_t)(tmpValue >> 8);
 			break;
 			}
 		case FAT16:
-			var_write((uint16_t *)&fatSectBuffer[fatentoff], (uint16_t)clustValue);
+			var_write((uint16_t *)&fatsect[fatentoff], (uint16_t)clustValue);
 			break;
 		case FAT32:
-			var_write((uint32_t *)&fatSectBuffer[fatentoff], clustValue);
+			var_write((uint32_t *)&fatsect[fatentoff], clustValue);
 			break;
 	}
+	const uint32_t fatsectnum = bootbuffer.reservedsectors + fatsectidx + partSectOff;
 	for(int fc=0;fc<bootbuffer.fatcopies;fc++) {
-		writeSector(fatsectnum + (fc * bootbuffer.sectorsperfat), &fatSectBuffer[0]);
-		if (fattype==FAT12) {
-			if (fatentoff>=511)
-				writeSector(fatsectnum + 1 +
-				                    (fc * bootbuffer.sectorsperfat),
-				            &fatSectBuffer[BytePerSector]);
+		writeSector(fatsectnum + (fc * bootbuffer.sectorsperfat), fatsect);
+		if (straddles) {
+			writeSector(fatsectnum + 1 + (fc * bootbuffer.sectorsperfat),
+			            fatCacheSector(fatsectidx + 1));
 		}
 	}
 }
@@ -550,6 +547,65 @@ bool fatDrive::getDirClustNum(const char* dir, uint32_t* clustNum, bool parDir)
 	return true;
 }
 
+void fatDrive::checkCaches() {
+	if (loadedDisk && loadedDisk->num_writes != knownDiskWrites) {
+		clearCaches();
+		knownDiskWrites = loadedDisk->num_writes;
+	}
+}
+
+void fatDrive::clearCaches() {
+	fatCache.clear();
+	chainCache.clear();
+	dirSectorCache.clear();
+}
+
+uint8_t *fatDrive::fatCacheSector(uint32_t index) {
+	/* FAT sectors read at once, as neighbouring clusters are used together */
+	constexpr uint32_t FatReadAhead = 8;
+
+	checkCaches();
+	if (index >= fatCache.size())
+		fatCache.resize(index + 1);
+	if (!fatCache[index].empty())
+		return fatCache[index].data();
+
+	uint32_t count = 1;
+	while (count < FatReadAhead && index + count < bootbuffer.sectorsperfat &&
+	       (index + count >= fatCache.size() || fatCache[index + count].empty()))
+		++count;
+	if (index + count > fatCache.size())
+		fatCache.resize(index + count);
+
+	std::vector<uint8_t> sectors(count * bootbuffer.bytespersector, 0);
+	readSectors(bootbuffer.reservedsectors + index + partSectOff, count, sectors.data());
+	for (uint32_t i = 0; i < count; ++i) {
+		const auto first = sectors.begin() + i * bootbuffer.bytespersector;
+		fatCache[index + i].assign(first, first + bootbuffer.bytespersector);
+	}
+	return fatCache[index].data();
+}
+
+uint8_t fatDrive::readDirSector(uint32_t sectnum, direntry *data) {
+	/* directories of a few thousand entries at most */
+	constexpr size_t MaxDirSectors = 1024;
+
+	checkCaches();
+	const auto cached = dirSectorCache.find(sectnum);
+	if (cached != dirSectorCache.end()) {
+		memcpy(data, cached->second.data(), cached->second.size());
+		return 0;
+	}
+	const uint8_t ret = readSector(sectnum, data);
+	if (ret == 0) {
+		if (dirSectorCache.size() >= MaxDirSectors)
+			dirSectorCache.clear();
+		const auto bytes = reinterpret_cast<const uint8_t *>(data);
+		dirSectorCache.emplace(sectnum, std::vector<uint8_t>(bytes, bytes + BytePerSector));
+	}
+	return ret;
+}
+
 uint8_t fatDrive::readSector(uint32_t sectnum, void * data) {
 	// Guard
 	if (!loadedDisk) {
@@ -567,12 +623,41 @@ uint8_t fatDrive::readSector(uint32_t sectnum, void * data) {
 	return loadedDisk->Read_Sector(head, cylinder, sector, data);
 }
 
+uint8_t fatDrive::readSectors(uint32_t sectnum, uint32_t count, void * data) {
+	// Guard
+	if (!loadedDisk) {
+		return 0;
+	}
+
+	if (absolute) {
+		return loadedDisk->Read_AbsoluteSectors(sectnum, count, data);
+	}
+	// C/H/S addresses of the partition's geometry needn't follow each
+	// other on the image
+	auto sector_data = static_cast<uint8_t *>(data);
+	for (uint32_t i = 0; i < count; ++i) {
+		const auto ret = readSector(sectnum + i, sector_data);
+		if (ret != 0) {
+			return ret;
+		}
+		sector_data += loadedDisk->getSectSize();
+	}
+	return 0;
+}
+
 uint8_t fatDrive::writeSector(uint32_t sectnum, void * data) {
 	// Guard
 	if (!loadedDisk) {
 		return 0;
 	}
 
+	checkCaches();
+	const auto dir_sector = dirSectorCache.find(sectnum);
+	if (dir_sector != dirSectorCache.end()) {
+		memcpy(dir_sector->second.data(), data, dir_sector->second.size());
+	}
+	++knownDiskWrites;
+
 	if (absolute) {
 		return loadedDisk->Write_AbsoluteSector(sectnum, data);
 	}
@@ -606,15 +691,27 @@ uint32_t fatDrive::getAbsoluteSectFromBytePos(uint32_t startClustNum, uint32_t b
 }
 
 uint32_t fatDrive::getAbsoluteSectFromChain(uint32_t startClustNum, uint32_t logicalSector) {
-	int32_t skipClust = logicalSector / bootbuffer.sectorspercluster;
+	/* chains of this many files and directories at most */
+	constexpr size_t MaxChains = 256;
+
+	uint32_t skipClust = logicalSector / bootbuffer.sectorspercluster;
 	uint32_t sectClust = logicalSector % bootbuffer.sectorspercluster;
 
-	uint32_t currentClust = startClustNum;
+	/* walk the chain only as far as it hasn't been walked before, so files
+	   read or seeked through cost one step per cluster once. Nothing below
+	   writes to the image, so the caches stay as checked here */
+	checkCaches();
+	if (chainCache.size() >= MaxChains && !chainCache.count(startClustNum))
+		chainCache.clear();
+	auto &chain = chainCache[startClustNum];
+	if (chain.empty())
+		chain.push_back(startClustNum);
+
 	uint32_t testvalue;
 
-	while(skipClust!=0) {
+	while(chain.size() <= skipClust) {
 		bool isEOF = false;
-		testvalue = getClusterValue(currentClust);
+		testvalue = getClusterValue(chain.back());
 		switch(fattype) {
 			case FAT12:
 				if(testvalue >= 0xff8) isEOF = true;
@@ -626,19 +723,18 @@ uint32_t fatDrive::getAbsoluteSectFromChain(uint32_t startClustNum, uint32_t log
 				if(testvalue >= 0xfffffff8) isEOF = true;
 				break;
 		}
-		if((isEOF) && (skipClust>=1)) {
+		if(isEOF) {
 			//LOG_MSG("End of cluster chain reached before end of logical sector seek!");
-			if (skipClust == 1 && fattype == FAT12) {
+			if (skipClust == chain.size() && fattype == FAT12) {
 				//break;
 				LOG(LOG_DOSMISC, LOG_ERROR)("End of cluster chain reached, but maybe good after all ?");
 			}
 			return 0;
 		}
-		currentClust = testvalue;
-		--skipClust;
+		chain.push_back(testvalue);
 	}
 
-	return (getClustFirstSect(currentClust) + sectClust);
+	return (getClustFirstSect(chain[skipClust]) + sectClust);
 }
 
 void fatDrive::deleteClustChain(uint32_t startCluster, uint32_t bytePos) {
@@ -777,8 +873,7 @@ fatDrive::fatDrive(const char *sysFilename,
 	  firstDataSector(0),
 	  firstRootDirSect(0),
 	  cwdDirCluster(0),
-	  fatSectBuffer{0},
-	  curFatSect(0)
+	  knownDiskWrites(0)
 {
 	FILE *diskfile;
 	uint32_t filesize;
@@ -969,8 +1064,7 @@ fatDrive::fatDrive(const char *sysFilename,
 	/* There is no cluster 0, this means we are in the root directory */
 	cwdDirCluster = 0;
 
-	memset(fatSectBuffer,0,1024);
-	curFatSect = 0xffffffff;
+	knownDiskWrites = loadedDisk->num_writes;
 
 	type = DosDriveType::Fat;
 	safe_strcpy(info, sysFilename);
@@ -1287,7 +1381,7 @@ nextfile:
 			DOS_SetError(DOSERR_NO_MORE_FILES);
 			return false;
 		}
-		readSector(firstRootDirSect+logentsector,sectbuf);
+		readDirSector(firstRootDirSect+logentsector,sectbuf);
 	} else {
 		tmpsector = getAbsoluteSectFromChain(dirClustNumber, logentsector);
 		/* A zero sector number can't happen */
@@ -1295,7 +1389,7 @@ nextfile:
 			DOS_SetError(DOSERR_NO_MORE_FILES);
 			return false;
 		}
-		readSector(tmpsector,sectbuf);
+		readDirSector(tmpsector,sectbuf);
 	}
 	dirPos++;
 	dta.SetDirID(dirPos);
@@ -1422,12 +1516,12 @@ bool fatDrive::directoryBrowse(uint32_t dirClustNumber, direntry *useEntry, int3
 		if(dirClustNumber==0) {
 			if(dirPos >= bootbuffer.rootdirentries) return false;
 			tmpsector = firstRootDirSect+logentsector;
-			readSector(tmpsector,sectbuf);
+			readDirSector(tmpsector,sectbuf);
 		} else {
 			tmpsector = getAbsoluteSectFromChain(dirClustNumber, logentsector);
 			/* A zero sector number can't happen */
 			if(tmpsector == 0) return false;
-			readSector(tmpsector,sectbuf);
+			readDirSector(tmpsector,sectbuf);
 		}
 		dirPos++;
 
@@ -1456,12 +1550,12 @@ bool fatDrive::directoryChange(uint32_t dirClustNumber, direntry *useEntry, int3
 		if(dirClustNumber==0) {
 			if(dirPos >= bootbuffer.rootdirentries) return false;
 			tmpsector = firstRootDirSect+logentsector;
-			readSector(tmpsector,sectbuf);
+			readDirSector(tmpsector,sectbuf);
 		} else {
 			tmpsector = getAbsoluteSectFromChain(dirClustNumber, logentsector);
 			/* A zero sector number can't happen */
 			if(tmpsector == 0) return false;
-			readSector(tmpsector,sectbuf);
+			readDirSector(tmpsector,sectbuf);
 		}
 		dirPos++;
 
@@ -1494,7 +1588,7 @@ bool fatDrive::addDirectoryEntry(uint32_t dirClustNumber, direntry useEntry) {
 		if(dirClustNumber==0) {
 			if(dirPos >= bootbuffer.rootdirentries) return false;
 			tmpsector = firstRootDirSect+logentsector;
-			readSector(tmpsector,sectbuf);
+			readDirSector(tmpsector,sectbuf);
 		} else {
 			tmpsector = getAbsoluteSectFromChain(dirClustNumber, logentsector);
 			/* A zero sector number can't happen - we need to allocate more room for this directory*/
@@ -1506,7 +1600,7 @@ bool fatDrive::addDirectoryEntry(uint32_t dirClustNumber, direntry useEntry) {
 				tmpsector = getAbsoluteSectFromChain(dirClustNumber, logentsector);
 				if(tmpsector == 0) return false; /* Give up if still can't get more room for directory */
 			}
-			readSector(tmpsector,sectbuf);
+			readDirSector(tmpsector,sectbuf);
 		}
 		dirPos++;
 
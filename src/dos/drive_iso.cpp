@@ -3,8 +3,10 @@
 
 #include "dos/drives.h"
 
+#include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <vector>
 
 #include "cdrom.h"
 #include "dos_mscdex.h"
@@ -15,6 +17,10 @@
 #define FLAGS1	((iso) ? de.fileFlags : de.timeZone)
 #define FLAGS2	((iso) ? de->fileFlags : de->timeZone)
 
+// Sectors read at once when a file is read on from where the last read
+// ended, or when a single read spans them
+constexpr uint32_t ReadAheadSectors = 16;
+
 class isoFile final : public DOS_File {
 public:
 	isoFile(std::shared_ptr<isoDrive> drive, const char *name, FileStat_Block *stat, uint32_t offset);
@@ -29,12 +35,18 @@ public:
 	bool IsOnReadOnlyMedium() const override;
 
 private:
+	// Makes the buffer hold the sector, reading up to 'wanted' sectors
+	bool LoadSector(uint32_t sector, uint32_t wanted);
+
 	std::shared_ptr<isoDrive> drive = nullptr;
-	int cachedSector = -1;
 	uint32_t fileBegin = 0;
 	uint32_t filePos = 0;
 	uint32_t fileEnd = 0;
-	uint8_t buffer[ISO_FRAMESIZE] = {{}};
+
+	// Holds 'bufferCount' sectors from 'bufferSector' on
+	std::vector<uint8_t> buffer = {};
+	uint32_t bufferSector = 0;
+	uint32_t bufferCount = 0;
 };
 
 isoFile::isoFile(std::shared_ptr<isoDrive> iso_drive, const char *name, FileStat_Block *stat, uint32_t offset)
@@ -57,43 +69,54 @@ bool isoFile::Read(uint8_t *data, uint16_t *size) {
 		*size = (uint16_t)(fileEnd - filePos);
 
 	uint16_t nowSize = 0;
-	uint32_t sector = filePos / ISO_FRAMESIZE;
-
-	if (static_cast<int>(sector) != cachedSector) {
-		if (drive->readSector(buffer, sector)) {
-			cachedSector = static_cast<int>(sector);
-		} else {
-			*size = 0;
-			cachedSector = -1;
-		}
-	}
-
-	static_assert(ISO_FRAMESIZE <= UINT16_MAX);
-	auto sectorPos = static_cast<uint16_t>(filePos % ISO_FRAMESIZE);
-
+	uint32_t pos = filePos;
 	while (nowSize < *size) {
-		uint16_t remSector = ISO_FRAMESIZE - sectorPos;
-		uint16_t remSize = *size - nowSize;
-		if(remSector < remSize) {
-			memcpy(&data[nowSize], &buffer[sectorPos], remSector);
-			nowSize += remSector;
-			sectorPos = 0;
-			sector++;
-			cachedSector++;
-			if (!drive->readSector(buffer, sector)) {
-				*size = nowSize;
-				cachedSector = -1;
-			}
-		} else {
-			memcpy(&data[nowSize], &buffer[sectorPos], remSize);
-			nowSize += remSize;
+		const uint32_t sector = pos / ISO_FRAMESIZE;
+		const uint32_t lastSector = (pos + (*size - nowSize) - 1) / ISO_FRAMESIZE;
+		if (!LoadSector(sector, lastSector - sector + 1)) {
+			break;
 		}
+		const uint32_t offset = (sector - bufferSector) * ISO_FRAMESIZE +
+		                        pos % ISO_FRAMESIZE;
+		const auto chunk = static_cast<uint16_t>(
+		        std::min(bufferCount * ISO_FRAMESIZE - offset,
+		                 static_cast<uint32_t>(*size - nowSize)));
+		memcpy(&data[nowSize], &buffer[offset], chunk);
+		nowSize += chunk;
+		pos += chunk;
 	}
 	*size = nowSize;
 	filePos += *size;
 	return true;
 }
 
+bool isoFile::LoadSector(const uint32_t sector, const uint32_t wanted)
+{
+	if (bufferCount && sector >= bufferSector &&
+	    sector < bufferSector + bufferCount) {
+		return true;
+	}
+
+	const bool isSequential = bufferCount && sector == bufferSector + bufferCount;
+	const uint32_t fileSectors = (fileEnd - 1) / ISO_FRAMESIZE - sector + 1;
+
+	uint32_t count = std::max(wanted, isSequential ? ReadAheadSectors : 1);
+	count = std::min({count, ReadAheadSectors, fileSectors});
+
+	buffer.resize(std::max(buffer.size(), size_t{count} * ISO_FRAMESIZE));
+	bufferSector = sector;
+	bufferCount  = count;
+	if (count > 1 && drive->readSectors(buffer.data(), sector, count)) {
+		return true;
+	}
+	bufferCount = 1;
+	if (drive->readSector(buffer.data(), sector)) {
+		return true;
+	}
+	bufferCount = 0;
+	return false;
+}
+
 bool isoFile::Write(uint8_t* /*data*/, uint16_t* /*size*/) {
 	return false;
 }
@@ -143,7 +166,6 @@ isoDrive::isoDrive(char driveLetter, const char *fileName, uint8_t mediaid, int
 	this->fileName[0]  = '\0';
 	this->discLabel[0] = '\0';
 	memset(dirIterators, 0, sizeof(dirIterators));
-	memset(sectorHashEntries, 0, sizeof(sectorHashEntries));
 	memset(&rootEntry, 0, sizeof(isoDirEntry));
 
 	safe_strcpy(this->fileName, fileName);
@@ -454,20 +476,29 @@ void isoDrive::FreeDirIterator(const int dirIterator) {
 }
 
 bool isoDrive::ReadCachedSector(uint8_t** buffer, const uint32_t sector) {
-	// get hash table entry
-	int pos = sector % ISO_MAX_HASH_TABLE_SIZE;
-	SectorHashEntry& he = sectorHashEntries[pos];
+	const auto it = sectorCacheIndex.find(sector);
+	if (it != sectorCacheIndex.end()) {
+		sectorCache.splice(sectorCache.begin(), sectorCache, it->second);
+		*buffer = it->second->data.data();
+		return true;
+	}
 
-	// check if the entry is valid and contains the correct sector
-	if (!he.valid || he.sector != sector) {
-		if (!CDROM::cdroms[subUnit]->ReadSector(he.data, false, sector)) {
-			return false;
-		}
-		he.valid = true;
-		he.sector = sector;
+	// Reuse the least recently used entry once the cache is full
+	if (sectorCache.size() >= SectorCacheSize) {
+		sectorCacheIndex.erase(sectorCache.back().sector);
+		sectorCache.splice(sectorCache.begin(), sectorCache, std::prev(sectorCache.end()));
+	} else {
+		sectorCache.emplace_front();
 	}
+	auto& entry = sectorCache.front();
+	if (!CDROM::cdroms[subUnit]->ReadSector(entry.data.data(), false, sector)) {
+		sectorCache.pop_front();
+		return false;
+	}
+	entry.sector = sector;
+	sectorCacheIndex[sector] = sectorCache.begin();
 
-	*buffer = he.data;
+	*buffer = entry.data.data();
 	return true;
 }
 
@@ -475,6 +506,11 @@ inline bool isoDrive::readSector(uint8_t *buffer, uint32_t sector) {
 	return CDROM::cdroms[subUnit]->ReadSector(buffer, false, sector);
 }
 
+bool isoDrive::readSectors(uint8_t* buffer, const uint32_t sector, const uint32_t count)
+{
+	return CDROM::cdroms[subUnit]->ReadSectorsHost(buffer, false, sector, count);
+}
+
 int isoDrive :: readDirEntry(isoDirEntry *de, uint8_t *data) {
 	// copy data into isoDirEntry struct, data[0] = length of DirEntry
 //	if (data[0] > sizeof(isoDirEntry)) return -1;//check disabled as isoDirentry is currently 258 bytes large. So it always fits
@@ -535,6 +571,33 @@ bool isoDrive :: loadImage() {
 	return false;
 }
 
+const isoDrive::DirIndex& isoDrive::GetDirIndex(const isoDirEntry& dir)
+{
+	const auto sector = EXTENT_LOCATION(dir);
+	if (const auto it = dirIndexes.find(sector); it != dirIndexes.end()) {
+		return it->second;
+	}
+	if (dirIndexes.size() >= MaxDirIndexes) {
+		dirIndexes.clear();
+	}
+
+	auto& index = dirIndexes[sector];
+	isoDirEntry entry;
+	isoDirEntry* de = &entry;
+	const int dirIterator = GetDirIterator(&dir);
+	while (GetNextDirEntry(dirIterator, de)) {
+		if (IS_ASSOC(FLAGS2)) {
+			continue;
+		}
+		std::string name = reinterpret_cast<const char*>(de->ident);
+		upcase(name);
+		index.byName.try_emplace(std::move(name), index.entries.size());
+		index.entries.push_back(entry);
+	}
+	FreeDirIterator(dirIterator);
+	return index;
+}
+
 bool isoDrive :: lookup(isoDirEntry *de, const char *path) {
 	if (!dataCD) return false;
 	*de = this->rootEntry;
@@ -547,26 +610,28 @@ bool isoDrive :: lookup(isoDirEntry *de, const char *path) {
 	// iterate over all path elements (name), and search each of them in the current de
 	for(char* name = strtok(isoPath, "/"); nullptr != name; name = strtok(nullptr, "/")) {
 
-		bool found = false;
 		// current entry must be a directory, abort otherwise
-		if (IS_DIR(FLAGS2)) {
+		if (!IS_DIR(FLAGS2)) return false;
 
-			// remove the trailing dot if present
-			size_t nameLength = strlen(name);
-			if (nameLength > 0) {
-				if (name[nameLength - 1] == '.') name[nameLength - 1] = 0;
-			}
+		// remove the trailing dot if present
+		size_t nameLength = strlen(name);
+		if (nameLength > 0) {
+			if (name[nameLength - 1] == '.') name[nameLength - 1] = 0;
+		}
 
-			// look for the current path element
-			int dirIterator = GetDirIterator(de);
-			while (!found && GetNextDirEntry(dirIterator, de)) {
-				if (!IS_ASSOC(FLAGS2) && (0 == strncasecmp((char*) de->ident, name, ISO_MAX_FILENAME_LENGTH))) {
-					found = true;
-				}
-			}
-			FreeDirIterator(dirIterator);
+		// look for the current path element, an empty one matches
+		// whatever entry comes first
+		const auto& index = GetDirIndex(*de);
+		std::string key = name;
+		upcase(key);
+		if (key.empty()) {
+			if (index.entries.empty()) return false;
+			*de = index.entries.front();
+			continue;
 		}
-		if (!found) return false;
+		const auto it = index.byName.find(key);
+		if (it == index.byName.end()) return false;
+		*de = index.entries[it->second];
 	}
 	return true;
 }
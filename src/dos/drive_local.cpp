@@ -16,13 +16,16 @@
 #include <ctime>
 #include <limits>
 #include <sys/types.h>
+#include <unordered_map>
 
 #include "audio/disk_noise.h"
 #include "misc/cross.h"
 #include "dos_inc.h"
 #include "dos_mscdex.h"
 #include "utils/fs_utils.h"
+#include "hardware/pic.h"
 #include "hardware/port.h"
+#include "misc/perf_counters.h"
 #include "utils/string_utils.h"
 
 bool localDrive::FileIsReadOnly(const char* name)
@@ -259,7 +262,10 @@ bool localDrive::FindFirst(const char* _dir, DOS_DTA& dta, bool fcb_findfirst)
 	safe_strcat(tempDir, _dir);
 	CROSS_FILENAME(tempDir);
 
-	if (allocation.mediaid == 0xF0) {
+	// So the sizes found include what's still pending
+	localFile::FlushAll();
+
+	if (allocation.mediaid == 0xF0 && !dirCache.IsWatchingHostChanges()) {
 		EmptyCache(); //rescan floppie-content on each findfirst
 	}
 
@@ -549,9 +555,154 @@ localDrive::localDrive(const char* startdir, uint16_t _bytes_sector,
 	type = DosDriveType::Local;
 	safe_strcpy(basedir, startdir);
 	safe_strcpy(info, startdir);
+	dirCache.SetWatchHostChanges(true);
+	dirCache.SetShareListings(readonly && DOS_IsSharedMountCacheEnabled());
 	dirCache.SetBaseDir(basedir);
 }
 
+static PerfCounter local_file_buffered_reads("local_file_buffered_reads",
+                                             "Local file reads served from the read-ahead buffer.");
+static PerfCounter local_file_host_reads("local_file_host_reads",
+                                         "Host reads of local files.");
+static PerfCounter local_file_host_writes("local_file_host_writes",
+                                          "Host writes of local files.");
+
+// Open local files by host path
+static std::unordered_map<std::string, std::vector<localFile*>> open_local_files = {};
+
+static bool is_write_back_pending = false;
+
+static void write_back_local_files(uint32_t /*val*/)
+{
+	is_write_back_pending = false;
+	localFile::FlushAll();
+}
+
+void localFile::FlushAll()
+{
+	for (const auto& [path_key, files] : open_local_files) {
+		for (const auto file : files) {
+			file->FlushWrites();
+		}
+	}
+}
+
+void localFile::Register()
+{
+	auto& files = open_local_files[path_key];
+	files.push_back(this);
+	if (files.size() > 1) {
+		for (const auto file : files) {
+			file->Flush();
+			file->is_shared = true;
+		}
+	}
+}
+
+void localFile::Unregister()
+{
+	const auto it = open_local_files.find(path_key);
+	if (it == open_local_files.end()) {
+		return;
+	}
+	auto& files = it->second;
+	files.erase(std::remove(files.begin(), files.end(), this), files.end());
+	if (files.empty()) {
+		open_local_files.erase(it);
+	} else if (files.size() == 1) {
+		files.front()->is_shared = false;
+	}
+}
+
+bool localFile::IsBuffered() const
+{
+	return !is_shared && region_locks.empty();
+}
+
+bool localFile::SeekNative(const uint32_t pos)
+{
+	if (native_pos == pos) {
+		return true;
+	}
+	if (seek_native_file(file_handle, pos, NativeSeek::Set) == NativeSeekFailed) {
+		native_pos = -1;
+		return false;
+	}
+	native_pos = pos;
+	return true;
+}
+
+NativeIoResult localFile::ReadNative(const uint32_t pos, uint8_t* data,
+                                     const uint32_t size)
+{
+	if (!SeekNative(pos)) {
+		return {0, true};
+	}
+	local_file_host_reads.Add();
+	const auto ret = read_native_file(file_handle, data, size);
+	native_pos     = ret.error ? -1 : pos + ret.num_bytes;
+	return ret;
+}
+
+NativeIoResult localFile::WriteNative(const uint32_t pos, const uint8_t* data,
+                                      const uint32_t size)
+{
+	if (!SeekNative(pos)) {
+		return {0, true};
+	}
+	local_file_host_writes.Add();
+	const auto ret = write_native_file(file_handle, data, size);
+	native_pos     = ret.error ? -1 : pos + ret.num_bytes;
+	return ret;
+}
+
+bool localFile::FlushWrites()
+{
+	if (!is_buffer_dirty || file_handle == InvalidNativeFileHandle) {
+		return true;
+	}
+	is_buffer_dirty = false;
+
+	const auto size = check_cast<uint32_t>(buffer.size());
+	const auto ret  = WriteNative(buffer_pos, buffer.data(), size);
+	buffer.clear();
+	if (ret.error || ret.num_bytes != size) {
+		LOG_WARNING("FS: Failed writing %u bytes to file '%s'",
+		            size,
+		            path.string().c_str());
+		has_failed_flush = true;
+		writes_through   = true;
+		return false;
+	}
+	return true;
+}
+
+void localFile::DropBuffer()
+{
+	FlushWrites();
+	buffer.clear();
+}
+
+void localFile::Flush()
+{
+	DropBuffer();
+}
+
+bool localFile::TakeWriteError()
+{
+	const auto failed = has_failed_flush;
+	has_failed_flush  = false;
+	return failed;
+}
+
+void localFile::SyncNativeFile()
+{
+	DropBuffer();
+	seek_native_file(file_handle, position, NativeSeek::Set);
+	// Whatever uses the handle next moves it elsewhere
+	native_pos = -1;
+}
+
 bool localFile::Read(uint8_t* data, uint16_t* num_bytes)
 {
 	assert(file_handle != InvalidNativeFileHandle);
@@ -571,12 +722,63 @@ bool localFile::Read(uint8_t* data, uint16_t* num_bytes)
 		                                   local_drive.lock()->GetMediaByte()));
 	}
 
-	const auto ret = read_native_file(file_handle, data, *num_bytes);
-	*num_bytes     = check_cast<uint16_t>(ret.num_bytes);
-	if (ret.error) {
-		DOS_SetError(DOSERR_ACCESS_DENIED);
-		return false;
+	// Pending writes first, so they're read back
+	FlushWrites();
+
+	const uint32_t requested = *num_bytes;
+	uint32_t done            = 0;
+	bool is_done             = false;
+
+	if (shared_view) {
+		// Copied out of the contents shared through the mount cache
+		const auto size = shared_view->Size();
+		if (position < size) {
+			done = check_cast<uint32_t>(
+			        std::min<size_t>(requested, size - position));
+			std::memcpy(data, shared_view->Data() + position, done);
+		}
+		is_done = true;
+	} else if (IsBuffered()) {
+		const auto buffer_end = buffer_pos + buffer.size();
+		if (position >= buffer_pos && position < buffer_end) {
+			done = std::min(requested,
+			                check_cast<uint32_t>(buffer_end - position));
+			std::memcpy(data, buffer.data() + (position - buffer_pos), done);
+			local_file_buffered_reads.Add();
+		}
+		// Whatever's left is read ahead, unless it's a large read
+		const auto left = requested - done;
+		if (left > 0 && left < BufferSize) {
+			buffer.resize(BufferSize);
+			const auto ret = ReadNative(position + done, buffer.data(), BufferSize);
+			if (ret.error) {
+				buffer.clear();
+				*num_bytes = check_cast<uint16_t>(done);
+				position += done;
+				DOS_SetError(DOSERR_ACCESS_DENIED);
+				return false;
+			}
+			buffer.resize(static_cast<size_t>(ret.num_bytes));
+			buffer_pos = position + done;
+
+			const auto size = std::min(left, check_cast<uint32_t>(buffer.size()));
+			std::memcpy(data + done, buffer.data(), size);
+			done += size;
+		}
+		is_done = (done == requested) || (left > 0 && left < BufferSize);
+	}
+	if (!is_done) {
+		const auto ret = ReadNative(position + done, data + done, requested - done);
+		done += check_cast<uint32_t>(ret.num_bytes);
+		if (ret.error) {
+			*num_bytes = check_cast<uint16_t>(done);
+			position += done;
+			DOS_SetError(DOSERR_ACCESS_DENIED);
+			return false;
+		}
 	}
+	*num_bytes = check_cast<uint16_t>(done);
+	position += done;
 
 	/* Fake harddrive motion. Inspector Gadget with Sound Blaster compatible */
 	/* Same for Igor */
@@ -601,11 +803,20 @@ bool localFile::Write(uint8_t* data, uint16_t* num_bytes)
 	// File should always be opened in read-only mode if on read-only drive
 	assert(!IsOnReadOnlyMedium());
 
+	// Earlier writes that were reported done didn't make it to the file
+	if (TakeWriteError()) {
+		*num_bytes = 0;
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
+
 	set_archive_on_close = true;
 
 	// Truncate the file
 	if (*num_bytes == 0) {
-		if (!truncate_native_file(file_handle)) {
+		DropBuffer();
+		if (TakeWriteError() || !SeekNative(position) ||
+		    !truncate_native_file(file_handle)) {
 			LOG_DEBUG("FS: Failed truncating file '%s'", name.c_str());
 			return false;
 		}
@@ -623,9 +834,44 @@ bool localFile::Write(uint8_t* data, uint16_t* num_bytes)
 		                                   local_drive.lock()->GetMediaByte()));
 	}
 
+	const uint32_t size = *num_bytes;
+
+	// Small writes are collected while they follow each other
+	if (IsBuffered() && !writes_through && size < BufferSize) {
+		if (!is_buffer_dirty) {
+			// whatever was read ahead is out of date now
+			buffer.clear();
+		} else if ((position != buffer_pos + buffer.size() ||
+		            buffer.size() + size > BufferSize) &&
+		           !FlushWrites()) {
+			TakeWriteError();
+			*num_bytes = 0;
+			DOS_SetError(DOSERR_ACCESS_DENIED);
+			return false;
+		}
+		if (!is_buffer_dirty) {
+			buffer_pos      = position;
+			is_buffer_dirty = true;
+			if (!is_write_back_pending) {
+				PIC_AddEvent(write_back_local_files, WriteBackDelayMs);
+				is_write_back_pending = true;
+			}
+		}
+		buffer.insert(buffer.end(), data, data + size);
+		position += size;
+		return true;
+	}
+
 	// Otherwise we have some data to write
-	const auto ret = write_native_file(file_handle, data, *num_bytes);
+	DropBuffer();
+	if (TakeWriteError()) {
+		*num_bytes = 0;
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
+	const auto ret = WriteNative(position, data, size);
 	*num_bytes     = check_cast<uint16_t>(ret.num_bytes);
+	position += *num_bytes;
 	if (ret.error) {
 		DOS_SetError(DOSERR_ACCESS_DENIED);
 		return false;
@@ -638,6 +884,11 @@ bool localFile::Seek(uint32_t *pos_addr, uint32_t type)
 {
 	assert(file_handle != InvalidNativeFileHandle);
 
+	if (TakeWriteError()) {
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return false;
+	}
+
 	// Tested this interrupt on MS-DOS 6.22
 	// The values for SEEK_CUR and SEEK_END can be negative
 	// But some games/programs depend on the wrapping behavior of a 32-bit integer
@@ -651,17 +902,18 @@ bool localFile::Seek(uint32_t *pos_addr, uint32_t type)
 			break;
 		}
 		case DOS_SEEK_CUR: {
-			const auto current_pos = get_native_file_position(file_handle);
-			if (current_pos == NativeSeekFailed) {
-				LOG_WARNING("FS: File seek failed for '%s'", path.string().c_str());
-				DOS_SetError(DOSERR_ACCESS_DENIED);
-				return false;
-			}
-			seek_to = check_cast<uint32_t>(current_pos) + *pos_addr;
+			seek_to = position + *pos_addr;
 			break;
 		}
 		case DOS_SEEK_END: {
+			// The end includes what's pending
+			if (!FlushWrites()) {
+				TakeWriteError();
+				DOS_SetError(DOSERR_ACCESS_DENIED);
+				return false;
+			}
 			const auto end_pos = seek_native_file(file_handle, 0, NativeSeek::End);
+			native_pos = end_pos;
 			if (end_pos == NativeSeekFailed) {
 				LOG_WARNING("FS: File seek failed for '%s'", path.string().c_str());
 				DOS_SetError(DOSERR_ACCESS_DENIED);
@@ -678,18 +930,11 @@ bool localFile::Seek(uint32_t *pos_addr, uint32_t type)
 		}
 	}
 
-	// Always use NativeSeek::Set set since we calculate the absolute value above
-	auto returned_pos = seek_native_file(file_handle, seek_to, NativeSeek::Set);
-
-	if (returned_pos == NativeSeekFailed) {
-		LOG_WARNING("FS: File seek failed for '%s'", path.string().c_str());
-		DOS_SetError(DOSERR_ACCESS_DENIED);
-		return false;
-	}
-
-	// The returned value is always positive.
-	// It can exceed 32-bit signed max (ex. Blackthorne)
-	*pos_addr = check_cast<uint32_t>(returned_pos);
+	// The host file position follows on the next read or write. The
+	// value is always positive. It can exceed 32-bit signed max (ex.
+	// Blackthorne)
+	position  = seek_to;
+	*pos_addr = seek_to;
 
 	return true;
 }
@@ -734,6 +979,9 @@ void localFile::Close()
 {
 	assert(file_handle != InvalidNativeFileHandle);
 
+	// Written out before the attributes and times are set
+	Flush();
+
 	// only close if one reference left
 	if (refCtr == 1) {
 		if (set_archive_on_close) {
@@ -754,6 +1002,7 @@ void localFile::Close()
 
 		close_native_file(file_handle);
 		file_handle = InvalidNativeFileHandle;
+		Unregister();
 	} else {
 		MaybeFlushTime();
 	}
@@ -772,6 +1021,7 @@ localFile::localFile(const char* _name, const std_fs::path& path,
         : local_drive(drive),
           file_handle(handle),
           path(path),
+          path_key(path.string()),
           basedir(_basedir),
           read_only_medium(_read_only_medium)
 {
@@ -784,6 +1034,11 @@ localFile::localFile(const char* _name, const std_fs::path& path,
 	attr = FatAttributeFlags::Archive;
 
 	SetName(_name);
+	Register();
+
+	if (read_only_medium) {
+		shared_view = DOS_MapSharedFile(path);
+	}
 }
 
 localFile::~localFile()
@@ -798,6 +1053,7 @@ localFile::~localFile()
 		// Make sure to avoid virtual dispatch inside a destructor
 		localFile::Close();
 	}
+	Unregister();
 }
 
 // ********************************************
@@ -7,7 +7,22 @@
 
 #include "dos/dos_system.h"
 #include "dos/drives.h"
+#include "dos/shared_mount_cache.h"
 
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Reads are served from a read-ahead buffer and small sequential writes
+// are collected into one host write, so DOS programs reading and writing
+// a few bytes at a time don't make a host call for each. Pending writes
+// go out a tenth of an emulated second after the first of them, and on
+// reads, commits, locks, directory searches and closing. Files opened
+// more than once at the same time, or with locked regions, are read and
+// written directly, so every handle sees the others' writes right away.
+// If writing out pending writes fails, the next write, seek, commit or
+// close on the file fails with it, and later writes aren't held back.
 class localFile : public DOS_File {
 public:
 	localFile(const char* name, const std_fs::path& path,
@@ -21,6 +36,8 @@ public:
 	bool Write(uint8_t* data, uint16_t* size) override;
 	bool Seek(uint32_t* pos, uint32_t type) override;
 	void Close() override;
+	void Flush() override;
+	bool TakeWriteError() override;
 	uint16_t GetInformation() override;
 	bool IsOnReadOnlyMedium() const override { return read_only_medium; }
 	const char* GetBaseDir() const
@@ -34,13 +51,59 @@ public:
 	const std::weak_ptr<localDrive> local_drive = {};
 	NativeFileHandle file_handle = InvalidNativeFileHandle;
 
+	// Writes out every file's pending writes
+	static void FlushAll();
+
+	// Bytes read ahead, and pending writes collected, at most
+	static constexpr uint32_t BufferSize = 32 * 1024;
+
+	// Pending writes wait for more to come at most this long
+	static constexpr double WriteBackDelayMs = 100.0;
+
+protected:
+	// Flushes and moves the host file position to where DOS has it, for
+	// code that uses 'file_handle' directly
+	void SyncNativeFile();
+
 private:
 	void MaybeFlushTime();
+	bool IsBuffered() const;
+	bool FlushWrites();
+	void DropBuffer();
+	bool SeekNative(uint32_t pos);
+	NativeIoResult ReadNative(uint32_t pos, uint8_t* data, uint32_t size);
+	NativeIoResult WriteNative(uint32_t pos, const uint8_t* data, uint32_t size);
+	void Register();
+	void Unregister();
+
 	const std_fs::path path = {};
+	const std::string path_key = {};
 	const char* basedir     = nullptr;
 
 	const bool read_only_medium = false;
 	bool set_archive_on_close   = false;
+
+	// Where DOS has the file position, and where the host has it, or -1
+	// if that's not known
+	uint32_t position  = 0;
+	int64_t native_pos = -1;
+
+	// Either bytes read ahead or pending writes, from 'buffer_pos'
+	std::vector<uint8_t> buffer = {};
+	uint32_t buffer_pos  = 0;
+	bool is_buffer_dirty = false;
+
+	// Writing out pending writes failed, and DOS hasn't been told yet.
+	// Writes go straight to the file from then on.
+	bool has_failed_flush = false;
+	bool writes_through   = false;
+
+	// Another handle has the file open as well
+	bool is_shared = false;
+
+	// Contents of files on read-only drives, when the shared mount
+	// cache has them
+	std::shared_ptr<const SharedFileView> shared_view = nullptr;
 };
 
 #endif
@@ -6,11 +6,14 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <charconv>
 #include <cinttypes>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <fstream>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -25,6 +28,10 @@
 #define OVERLAY_DIR 1
 bool logoverlay = false;
 
+// Starts like the special files, which makes older versions ignore it
+static constexpr auto IndexName = "DBOVERLAY_INDEX";
+static constexpr auto IndexHeader = "DBOVERLAY INDEX 1";
+
 #if defined (WIN32)
 #define CROSS_DOSFILENAME(blah)
 #else
@@ -271,23 +278,6 @@ std::pair<NativeFileHandle, std_fs::path> Overlay_Drive::create_file_in_overlay(
 	return {file_handle, newname};
 }
 
-#ifndef BUFSIZ
-#define BUFSIZ 2048
-#endif
-
-static void copy_file_contents(const NativeFileHandle src, const NativeFileHandle dst)
-{
-	uint8_t buffer[BUFSIZ] = {};
-	while (true) {
-		const auto ret = read_native_file(src, buffer, BUFSIZ);
-		if (ret.num_bytes > 0) {
-			write_native_file(dst, buffer, ret.num_bytes);
-		} else {
-			break;
-		}
-	}
-}
-
 bool OverlayFile::create_copy()
 {
 	//test if open/valid/etc
@@ -295,6 +285,7 @@ bool OverlayFile::create_copy()
 	if (logoverlay) LOG_MSG("create_copy called %s",GetName());
 
 	assert(file_handle != InvalidNativeFileHandle);
+	SyncNativeFile();
 
 	const auto location_in_old_file = get_native_file_position(file_handle);
 	if (location_in_old_file == NativeSeekFailed) {
@@ -311,14 +302,14 @@ bool OverlayFile::create_copy()
 	}
 
 	NativeFileHandle newhandle = InvalidNativeFileHandle;
+	std_fs::path newpath       = {};
+	std::shared_ptr<Overlay_Drive> od = {};
 	uint8_t drive_set = GetDrive();
 	if (drive_set != 0xff && drive_set < DOS_DRIVES && Drives[drive_set]){
-		const auto od = std::dynamic_pointer_cast<Overlay_Drive>(
-		        Drives[drive_set]);
+		od = std::dynamic_pointer_cast<Overlay_Drive>(Drives[drive_set]);
 		if (od) {
 			FatAttributeFlags attributes = {};
 			local_drive_get_attributes(GetPath(), attributes);
-			std_fs::path newpath = {};
 			std::tie(newhandle,
 			         newpath) = od->create_file_in_overlay(GetName(),
 			                                               attributes);
@@ -329,7 +320,15 @@ bool OverlayFile::create_copy()
 		return false;
 	}
 
-	copy_file_contents(file_handle, newhandle);
+	if (!copy_native_file(file_handle, newhandle)) {
+		LOG_ERR("OVERLAY: Failed copying file '%s' into the overlay: %s",
+		        GetName(),
+		        strerror(errno));
+		close_native_file(newhandle);
+		// A partial copy would hide the original
+		delete_native_file(newpath);
+		return false;
+	}
 
 	//Set copied file handle to position of the old one
 	if (seek_native_file(newhandle, location_in_old_file, NativeSeek::Set) ==
@@ -343,6 +342,7 @@ bool OverlayFile::create_copy()
 	}
 	close_native_file(file_handle);
 	file_handle = newhandle;
+	od->add_DOSname_to_cache(GetName());
 	// Flags ?
 	if (logoverlay) LOG_MSG("success");
 	return true;
@@ -370,6 +370,10 @@ Overlay_Drive::Overlay_Drive(const char *startdir,
           DOSdirs_cache{},
           special_prefix("DBOVERLAY")
 {
+	// The cache merges the overlay with the base directory, which host
+	// changes in either of them alone don't account for
+	dirCache.SetWatchHostChanges(false);
+
 	//Currently this flag does nothing, as the current behavior is to not reread due to caching everything.
 #if defined (WIN32)	
 	if (strcasecmp(startdir,overlay) == 0) {
@@ -400,7 +404,162 @@ Overlay_Drive::Overlay_Drive(const char *startdir,
 	//add_deleted_path(dirname); //update_cache will add the overlap_folder
 	overlap_folder = dirname;
 
-	update_cache(true);
+	update_cache(!load_index());
+}
+
+Overlay_Drive::~Overlay_Drive()
+{
+	if (is_index_dirty) {
+		save_index();
+	}
+}
+
+static std::optional<int64_t> get_dir_time(const std_fs::path& path)
+{
+	std::error_code ec = {};
+	if (!std_fs::is_directory(path, ec)) {
+		return {};
+	}
+	const auto time = std_fs::last_write_time(path, ec);
+	if (ec) {
+		return {};
+	}
+	return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+bool Overlay_Drive::load_index()
+{
+	std::ifstream in(std::string(overlaydir) + IndexName);
+	std::string line = {};
+	if (!std::getline(in, line) || line != IndexHeader) {
+		return false;
+	}
+
+	std::map<std::string, int64_t> dir_times = {};
+	std::vector<std::string> names = {};
+	std::vector<std::string> dirs = {};
+	std::vector<std::string> deleted_files = {};
+	std::vector<std::string> deleted_paths = {};
+	bool is_complete = false;
+
+	while (std::getline(in, line)) {
+		if (!line.empty() && line.back() == '\r') {
+			line.pop_back();
+		}
+		if (line == "END") {
+			is_complete = true;
+			break;
+		}
+		if (line.size() < 2 || line[1] != ' ') {
+			return false;
+		}
+		auto value = line.substr(2);
+		switch (line[0]) {
+		case 'T': {
+			// The time, then the directory relative to the overlay
+			const auto split = value.find(' ');
+			if (split == std::string::npos) {
+				return false;
+			}
+			int64_t time = 0;
+			const auto end = value.data() + split;
+			const auto [ptr, ec] = std::from_chars(value.data(), end, time);
+			if (ec != std::errc() || ptr != end) {
+				return false;
+			}
+			dir_times[value.substr(split + 1)] = time;
+			break;
+		}
+		case 'F': names.emplace_back(std::move(value)); break;
+		case 'D': dirs.emplace_back(std::move(value)); break;
+		case 'X': deleted_files.emplace_back(std::move(value)); break;
+		case 'P': deleted_paths.emplace_back(std::move(value)); break;
+		default: return false;
+		}
+	}
+	if (!is_complete || !dir_times.contains("")) {
+		return false;
+	}
+
+	// Anything added to or removed from the overlay behind our back
+	// changed the time of its directory
+	for (const auto& [dir, time] : dir_times) {
+		if (get_dir_time(std::string(overlaydir) + dir) != time) {
+			if (logoverlay) {
+				LOG_MSG("Overlay: index is out of date at '%s'", dir.c_str());
+			}
+			return false;
+		}
+	}
+
+	overlay_dir_times     = std::move(dir_times);
+	DOSnames_cache        = std::move(names);
+	DOSdirs_cache         = std::move(dirs);
+	deleted_files_in_base = std::move(deleted_files);
+	deleted_paths_in_base = std::move(deleted_paths);
+	add_deleted_path(overlap_folder.c_str(), false);
+	is_index_dirty = false;
+	return true;
+}
+
+void Overlay_Drive::save_index()
+{
+	const std::string path = std::string(overlaydir) + IndexName;
+
+	// Rewriting an existing index leaves the time of the overlay root
+	// alone, only creating it changes that
+	std::error_code ec = {};
+	if (!std_fs::exists(path, ec)) {
+		std::ofstream(path).close();
+		note_overlay_change("");
+	}
+
+	std::ofstream out(path, std::ios::trunc);
+	if (!out) {
+		return;
+	}
+	out << IndexHeader << '\n';
+	for (const auto& [dir, time] : overlay_dir_times) {
+		out << "T " << time << ' ' << dir << '\n';
+	}
+	auto write_list = [&](const char type, const std::vector<std::string>& list) {
+		for (const auto& name : list) {
+			out << type << ' ' << name << '\n';
+		}
+	};
+	write_list('F', DOSnames_cache);
+	write_list('D', DOSdirs_cache);
+	write_list('X', deleted_files_in_base);
+	write_list('P', deleted_paths_in_base);
+	out << "END\n";
+	out.close();
+
+	is_index_dirty = !out;
+}
+
+void Overlay_Drive::note_overlay_change(const char* dos_name)
+{
+	is_index_dirty = true;
+
+	auto note = [&](const std::string& dir) {
+		const auto time = get_dir_time(std::string(overlaydir) + dir);
+		if (time) {
+			overlay_dir_times[dir] = *time;
+		} else {
+			overlay_dir_times.erase(dir);
+		}
+	};
+	note("");
+
+	std::string name = dos_name;
+	std::replace(name.begin(), name.end(), '\\', CROSS_FILESPLIT);
+	for (auto split = name.find(CROSS_FILESPLIT); split != std::string::npos;
+	     split = name.find(CROSS_FILESPLIT, split + 1)) {
+		note(name.substr(0, split));
+	}
+	if (!name.empty()) {
+		note(name);
+	}
 }
 
 void Overlay_Drive::convert_overlay_to_DOSname_in_base(char* dirname ) 
@@ -583,11 +742,16 @@ void Overlay_Drive::add_DOSname_to_cache(const char* name) {
 		if (name == (*itc)) return;
 	}
 	DOSnames_cache.push_back(name);
+	note_overlay_change(name);
 }
 
 void Overlay_Drive::remove_DOSname_from_cache(const char* name) {
 	for (std::vector<std::string>::iterator it = DOSnames_cache.begin(); it != DOSnames_cache.end(); ++it) {
-		if (name == (*it)) { DOSnames_cache.erase(it); return;}
+		if (name == (*it)) {
+			DOSnames_cache.erase(it);
+			note_overlay_change(name);
+			return;
+		}
 	}
 
 }
@@ -650,6 +814,7 @@ void Overlay_Drive::update_cache(bool read_directory_contents) {
 		DOSdirs_cache.clear();
 		deleted_files_in_base.clear();
 		deleted_paths_in_base.clear();
+		overlay_dir_times.clear();
 		//Ensure hiding of the folder that contains the overlay, if it is part of the base folder.
 		add_deleted_path(overlap_folder.c_str(), false);
 	}
@@ -676,6 +841,14 @@ void Overlay_Drive::update_cache(bool read_directory_contents) {
 	std::vector<std::string>::iterator i;
 	std::string::size_type const prefix_lengh = special_prefix.length();
 	if (read_directory_contents) {
+		// Taken before reading, so a change made while reading still
+		// shows in the index as one
+		auto note_dir_time = [&](const std::string& dir) {
+			if (const auto time = get_dir_time(std::string(overlaydir) + dir)) {
+				overlay_dir_times[dir] = *time;
+			}
+		};
+		note_dir_time("");
 		dir_information* dirp = open_directory(overlaydir);
 		if (dirp == nullptr) return;
 		// Read complete directory
@@ -720,6 +893,7 @@ void Overlay_Drive::update_cache(bool read_directory_contents) {
 			safe_strcat(dirpush, end); // Linux ?
 
 			assert(dirp == nullptr);
+			note_dir_time(*i);
 			dirp = open_directory(dir);
 			if (dirp == nullptr) continue;
 
@@ -834,6 +1008,9 @@ void Overlay_Drive::update_cache(bool read_directory_contents) {
 
 		}
 	}
+	if (read_directory_contents) {
+		save_index();
+	}
 	if (logoverlay) {
 		LOG_MSG("OPTIMISE: update cache took %" PRId64, GetTicksSince(a));
 	}
@@ -1061,7 +1238,7 @@ void Overlay_Drive::add_deleted_file(const char* name,bool create_on_disk) {
 	if (!is_deleted_file(name)) {
 		deleted_files_in_base.push_back(name);
 		if (create_on_disk) add_special_file_to_disk(name, "DEL");
-
+		note_overlay_change(name);
 	}
 }
 
@@ -1128,6 +1305,7 @@ void Overlay_Drive::add_DOSdir_to_cache(const char* name) {
 	LOG_MSG("Adding name to overlay_only_dir_cache %s",name);
 	if (!is_dir_only_in_overlay(name)) {
 		DOSdirs_cache.push_back(name); 
+		note_overlay_change(name);
 	}
 }
 
@@ -1135,6 +1313,7 @@ void Overlay_Drive::remove_DOSdir_from_cache(const char* name) {
 	for(std::vector<std::string>::iterator it = DOSdirs_cache.begin(); it != DOSdirs_cache.end(); ++it) {
 		if ( *it == name) {
 			DOSdirs_cache.erase(it);
+			note_overlay_change(name);
 			return;
 		}
 	}
@@ -1145,6 +1324,7 @@ void Overlay_Drive::remove_deleted_file(const char* name,bool create_on_disk) {
 		if (*it == name) {
 			deleted_files_in_base.erase(it);
 			if (create_on_disk) remove_special_file_from_disk(name, "DEL");
+			note_overlay_change(name);
 			return;
 		}
 	}
@@ -1181,6 +1361,7 @@ void Overlay_Drive::remove_deleted_path(const char* name, bool create_on_disk) {
 			deleted_paths_in_base.erase(it);
 			remove_deleted_file(name,false); //Rethink maybe.
 			if (create_on_disk) remove_special_file_from_disk(name,"RMD");
+			note_overlay_change(name);
 			break;
 		}
 	}
@@ -1260,6 +1441,8 @@ bool Overlay_Drive::Rename(const char * oldname, const char * newname) {
 
 		if (success) {
 			timestamp_cache.erase(overlaynameold);
+			remove_DOSname_from_cache(oldname);
+			add_DOSname_to_cache(newname);
 		}
 
 		// Overlay file renamed: mark the old base file as deleted.
@@ -1283,11 +1466,17 @@ bool Overlay_Drive::Rename(const char * oldname, const char * newname) {
 			close_native_file(o);
 			return false;
 		}
-		copy_file_contents(o, n);
+		const auto copied = copy_native_file(o, n);
 		close_native_file(o);
 		close_native_file(n);
+		if (!copied) {
+			LOG_ERR("OVERLAY: Failed copying file '%s' into the overlay", newold);
+			delete_native_file(path);
+			return false;
+		}
 
 		//File copied.
+		add_DOSname_to_cache(newname);
 		//Mark old file as deleted
 		add_deleted_file(oldname,true);
 		timestamp_cache.erase(newold);
@@ -1302,7 +1491,8 @@ bool Overlay_Drive::Rename(const char * oldname, const char * newname) {
 		//Ensure that the file is not marked as deleted anymore.
 		if (is_deleted_file(newname)) remove_deleted_file(newname,true);
 		dirCache.EmptyCache();
-		update_cache(true);
+		// The lists already account for the rename
+		update_cache(false);
 		if (logoverlay) {
 			LOG_MSG("OPTIMISE: rename took %" PRId64, GetTicksSince(a));
 		}
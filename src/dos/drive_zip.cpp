@@ -0,0 +1,897 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "dos/drives.h"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <optional>
+#include <utility>
+
+#include <zlib.h>
+
+#include "dos/dos_system.h"
+#include "misc/unicode.h"
+#include "utils/fs_utils.h"
+#include "utils/string_utils.h"
+
+// Archive layout, see the PKWARE APPNOTE
+constexpr uint32_t EndOfCentralDirSignature   = 0x06054b50;
+constexpr uint32_t Zip64EndLocatorSignature   = 0x07064b50;
+constexpr uint32_t Zip64EndOfCentralSignature = 0x06064b50;
+constexpr uint32_t CentralHeaderSignature     = 0x02014b50;
+constexpr uint32_t LocalHeaderSignature       = 0x04034b50;
+
+constexpr size_t EndOfCentralDirSize = 22;
+constexpr size_t Zip64EndLocatorSize = 20;
+constexpr size_t Zip64EndOfCentralSize = 56;
+constexpr size_t CentralHeaderSize   = 46;
+constexpr size_t LocalHeaderSize     = 30;
+constexpr size_t MaxCommentSize      = UINT16_MAX;
+
+constexpr uint16_t MethodStored   = 0;
+constexpr uint16_t MethodDeflated = 8;
+
+constexpr uint16_t FlagEncrypted = 1 << 0;
+constexpr uint16_t FlagUtf8Names = 1 << 11;
+
+// Central directories larger than this aren't indexed
+constexpr uint64_t MaxCentralDirSize = 256 * 1024 * 1024;
+
+static uint16_t get_u16(const uint8_t* data)
+{
+	return static_cast<uint16_t>(data[0] | data[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t* data)
+{
+	return static_cast<uint32_t>(get_u16(data)) |
+	       static_cast<uint32_t>(get_u16(data + 2)) << 16;
+}
+
+static uint64_t get_u64(const uint8_t* data)
+{
+	return static_cast<uint64_t>(get_u32(data)) |
+	       static_cast<uint64_t>(get_u32(data + 4)) << 32;
+}
+
+// Decompressed blocks of deflated entries, shared by all mounted archives
+// and dropped least recently used first once they take up too much memory
+class ZipBlockCache {
+public:
+	static constexpr size_t BlockSize = 64 * 1024;
+	static constexpr size_t MaxBytes  = 32 * 1024 * 1024;
+
+	using Block = std::shared_ptr<const std::vector<uint8_t>>;
+
+	Block Find(const uint64_t archive, const size_t entry, const uint64_t block)
+	{
+		const auto it = blocks.find({archive, entry, block});
+		if (it == blocks.end()) {
+			return nullptr;
+		}
+		lru.splice(lru.begin(), lru, it->second.lru);
+		return it->second.data;
+	}
+
+	Block Insert(const uint64_t archive, const size_t entry,
+	             const uint64_t block, std::vector<uint8_t>&& data)
+	{
+		const Key key = {archive, entry, block};
+		if (const auto it = blocks.find(key); it != blocks.end()) {
+			return it->second.data;
+		}
+		cached_bytes += data.size();
+		while (cached_bytes > MaxBytes && !lru.empty()) {
+			Erase(lru.back());
+		}
+		lru.push_front(key);
+		auto& cached = blocks[key];
+		cached.data = std::make_shared<const std::vector<uint8_t>>(std::move(data));
+		cached.lru  = lru.begin();
+		return cached.data;
+	}
+
+	void Drop(const uint64_t archive)
+	{
+		for (auto it = lru.begin(); it != lru.end();) {
+			const auto key = *it++;
+			if (key.archive == archive) {
+				Erase(key);
+			}
+		}
+	}
+
+private:
+	struct Key {
+		uint64_t archive = 0;
+		size_t entry     = 0;
+		uint64_t block   = 0;
+
+		bool operator==(const Key& other) const = default;
+	};
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const
+		{
+			auto hash = std::hash<uint64_t>()(key.archive);
+			hash = hash * 31 + std::hash<size_t>()(key.entry);
+			return hash * 31 + std::hash<uint64_t>()(key.block);
+		}
+	};
+
+	struct Cached {
+		Block data = nullptr;
+		std::list<Key>::iterator lru = {};
+	};
+
+	void Erase(const Key key)
+	{
+		const auto it = blocks.find(key);
+		cached_bytes -= it->second.data->size();
+		lru.erase(it->second.lru);
+		blocks.erase(it);
+	}
+
+	std::unordered_map<Key, Cached, KeyHash> blocks = {};
+	std::list<Key> lru = {};
+	size_t cached_bytes = 0;
+};
+
+static ZipBlockCache& block_cache()
+{
+	static ZipBlockCache cache = {};
+	return cache;
+}
+
+class zipFile final : public DOS_File {
+public:
+	zipFile(std::shared_ptr<zipDrive> drive, const char* name, size_t index);
+	~zipFile() override;
+	zipFile(const zipFile&)            = delete;
+	zipFile& operator=(const zipFile&) = delete;
+
+	bool Read(uint8_t* data, uint16_t* size) override;
+	bool Write(uint8_t* data, uint16_t* size) override;
+	bool Seek(uint32_t* pos, uint32_t type) override;
+	void Close() override;
+	uint16_t GetInformation() override;
+	bool IsOnReadOnlyMedium() const override;
+
+private:
+	// The decompressed block, inflating up to it if it isn't cached
+	ZipBlockCache::Block GetBlock(uint64_t block);
+
+	bool Rewind();
+	void EndInflate();
+
+	std::shared_ptr<zipDrive> drive = nullptr;
+	size_t index      = 0;
+	uint64_t data_offset = 0;
+	uint32_t file_pos = 0;
+	uint32_t file_size = 0;
+
+	// Deflated entries are inflated from the start, so the stream is
+	// kept to carry on from the last block it produced
+	std::unique_ptr<z_stream> stream = nullptr;
+	std::vector<uint8_t> input       = {};
+	uint64_t consumed = 0;
+	uint64_t inflated = 0;
+	bool is_error     = false;
+};
+
+zipFile::zipFile(std::shared_ptr<zipDrive> zip_drive, const char* name,
+                 const size_t entry_index)
+        : drive(std::move(zip_drive)),
+          index(entry_index)
+{
+	SetName(name);
+
+	const auto& entry = drive->GetEntry(index);
+	data_offset = drive->GetDataOffset(index);
+	file_size   = static_cast<uint32_t>(std::min<uint64_t>(entry.size, UINT32_MAX));
+	time        = entry.time;
+	date        = entry.date;
+	attr        = entry.attr;
+}
+
+zipFile::~zipFile()
+{
+	EndInflate();
+}
+
+bool zipFile::Read(uint8_t* data, uint16_t* size)
+{
+	const auto& entry = drive->GetEntry(index);
+	const auto wanted = static_cast<uint16_t>(
+	        std::min<uint32_t>(*size, file_size - std::min(file_pos, file_size)));
+
+	uint16_t done = 0;
+	if (entry.method == MethodStored) {
+		if (wanted && drive->ReadArchive(data_offset + file_pos, data, wanted)) {
+			done = wanted;
+		}
+	} else {
+		while (done < wanted) {
+			const uint64_t pos = file_pos + done;
+			const auto block = GetBlock(pos / ZipBlockCache::BlockSize);
+			const auto offset = pos % ZipBlockCache::BlockSize;
+			if (!block || offset >= block->size()) {
+				break;
+			}
+			const auto chunk = static_cast<uint16_t>(
+			        std::min<uint64_t>(block->size() - offset, wanted - done));
+			memcpy(data + done, block->data() + offset, chunk);
+			done += chunk;
+		}
+	}
+	if (done < wanted && !is_error) {
+		LOG_WARNING("DOS: Failed reading '%s' from ZIP archive '%s'",
+		            GetName(),
+		            drive->GetInfo());
+		is_error = true;
+	}
+	*size = done;
+	file_pos += done;
+	return true;
+}
+
+ZipBlockCache::Block zipFile::GetBlock(const uint64_t block)
+{
+	auto& cache = block_cache();
+	if (auto cached = cache.Find(drive->GetCacheId(), index, block)) {
+		return cached;
+	}
+
+	const auto& entry = drive->GetEntry(index);
+	const auto start  = block * ZipBlockCache::BlockSize;
+	if (!stream || inflated > start) {
+		if (!Rewind()) {
+			return nullptr;
+		}
+	}
+
+	// Every block passed on the way is cached as well, so reading the
+	// file in order inflates it only once
+	while (inflated <= start) {
+		const auto block_size = static_cast<size_t>(std::min<uint64_t>(
+		        ZipBlockCache::BlockSize, entry.size - inflated));
+		std::vector<uint8_t> output(block_size);
+		stream->next_out  = output.data();
+		stream->avail_out = static_cast<uInt>(output.size());
+
+		while (stream->avail_out) {
+			if (!stream->avail_in) {
+				const auto remaining = entry.compressed_size - consumed;
+				const auto chunk = static_cast<size_t>(
+				        std::min<uint64_t>(input.size(), remaining));
+				if (!chunk || !drive->ReadArchive(data_offset + consumed,
+				                                  input.data(),
+				                                  chunk)) {
+					EndInflate();
+					return nullptr;
+				}
+				consumed += chunk;
+				stream->next_in  = input.data();
+				stream->avail_in = static_cast<uInt>(chunk);
+			}
+			const auto result = inflate(stream.get(), Z_NO_FLUSH);
+			if (result == Z_STREAM_END) {
+				break;
+			}
+			if (result != Z_OK) {
+				EndInflate();
+				return nullptr;
+			}
+		}
+		if (stream->avail_out) {
+			// The stream ended before the size the archive gives
+			EndInflate();
+			return nullptr;
+		}
+
+		const auto produced = inflated / ZipBlockCache::BlockSize;
+		inflated += output.size();
+		auto data = cache.Insert(drive->GetCacheId(), index, produced, std::move(output));
+		if (produced == block) {
+			return data;
+		}
+	}
+	return nullptr;
+}
+
+bool zipFile::Rewind()
+{
+	EndInflate();
+	if (data_offset == UINT64_MAX) {
+		return false;
+	}
+	stream = std::make_unique<z_stream>();
+	// zlib selects raw streams through negative window sizes
+	if (inflateInit2(stream.get(), -MAX_WBITS) != Z_OK) {
+		stream.reset();
+		return false;
+	}
+	input.resize(ZipBlockCache::BlockSize);
+	consumed = 0;
+	inflated = 0;
+	return true;
+}
+
+void zipFile::EndInflate()
+{
+	if (stream) {
+		inflateEnd(stream.get());
+		stream.reset();
+	}
+}
+
+bool zipFile::Write(uint8_t* /*data*/, uint16_t* /*size*/)
+{
+	DOS_SetError(DOSERR_ACCESS_DENIED);
+	return false;
+}
+
+bool zipFile::Seek(uint32_t* pos, uint32_t type)
+{
+	switch (type) {
+	case DOS_SEEK_SET: file_pos = *pos; break;
+	case DOS_SEEK_CUR: file_pos += *pos; break;
+	case DOS_SEEK_END: file_pos = file_size + *pos; break;
+	default: return false;
+	}
+	if (file_pos > file_size) {
+		file_pos = file_size;
+	}
+	*pos = file_pos;
+	return true;
+}
+
+void zipFile::Close()
+{
+	// Give the memory back once the last handle is closed
+	if (refCtr == 1) {
+		EndInflate();
+		input = {};
+	}
+}
+
+uint16_t zipFile::GetInformation()
+{
+	return 0x40; // read-only drive
+}
+
+bool zipFile::IsOnReadOnlyMedium() const
+{
+	return true;
+}
+
+zipDrive::zipDrive(const char* archive_path, const uint8_t media_id, bool& is_error)
+        : mediaid(media_id)
+{
+	static uint64_t next_cache_id = 0;
+	cache_id = ++next_cache_id;
+
+	type = DosDriveType::Archive;
+	safe_strcpy(info, archive_path);
+
+	entries.emplace_back();
+	entries.front().is_dir = true;
+	archive_names.emplace_back();
+	long_names.emplace_back();
+
+	file = open_native_file(archive_path, false);
+	is_error = file == InvalidNativeFileHandle || !ReadCentralDirectory();
+	if (is_error) {
+		LOG_WARNING("DOS: Failed reading the central directory of ZIP archive '%s'",
+		            archive_path);
+		return;
+	}
+
+	for (size_t dir = 0; dir < entries.size(); ++dir) {
+		if (entries[dir].is_dir) {
+			AssignNames(dir);
+		}
+	}
+	archive_names = {};
+	long_names    = {};
+
+	LOG_MSG("DOS: Indexed %zu entries of ZIP archive '%s'",
+	        entries.size() - 1,
+	        archive_path);
+}
+
+zipDrive::~zipDrive()
+{
+	block_cache().Drop(cache_id);
+	if (file != InvalidNativeFileHandle) {
+		close_native_file(file);
+	}
+}
+
+bool zipDrive::IsArchive(const std::string& path)
+{
+	const auto extension = std_fs::path(path).extension().string();
+	return iequals(extension, ".zip");
+}
+
+bool zipDrive::ReadArchive(const uint64_t offset, uint8_t* data, const size_t bytes)
+{
+	if (offset > file_size || bytes > file_size - offset) {
+		return false;
+	}
+	if (seek_native_file(file, static_cast<int64_t>(offset), NativeSeek::Set) < 0) {
+		return false;
+	}
+	const auto result = read_native_file(file, data, static_cast<int64_t>(bytes));
+	return !result.error && result.num_bytes == static_cast<int64_t>(bytes);
+}
+
+uint64_t zipDrive::GetDataOffset(const size_t index)
+{
+	auto& entry = entries[index];
+	if (entry.data_offset != UINT64_MAX) {
+		return entry.data_offset;
+	}
+	uint8_t header[LocalHeaderSize];
+	if (!ReadArchive(entry.header_offset, header, sizeof(header)) ||
+	    get_u32(header) != LocalHeaderSignature) {
+		return UINT64_MAX;
+	}
+	const auto name_length  = get_u16(header + 26);
+	const auto extra_length = get_u16(header + 28);
+	const auto offset = entry.header_offset + LocalHeaderSize + name_length +
+	                    extra_length;
+	if (offset > file_size || entry.compressed_size > file_size - offset) {
+		return UINT64_MAX;
+	}
+	entry.data_offset = offset;
+	return offset;
+}
+
+bool zipDrive::ReadCentralDirectory()
+{
+	const auto end = seek_native_file(file, 0, NativeSeek::End);
+	if (end < static_cast<int64_t>(EndOfCentralDirSize)) {
+		return false;
+	}
+	file_size = static_cast<uint64_t>(end);
+
+	// The end record sits behind the archive comment, so look for it from
+	// the end backwards
+	const auto tail_size = static_cast<size_t>(
+	        std::min<uint64_t>(file_size, EndOfCentralDirSize + MaxCommentSize));
+	std::vector<uint8_t> tail(tail_size);
+	const auto tail_offset = file_size - tail_size;
+	if (!ReadArchive(tail_offset, tail.data(), tail.size())) {
+		return false;
+	}
+	std::optional<size_t> end_pos = {};
+	for (size_t pos = tail_size - EndOfCentralDirSize + 1; pos-- > 0;) {
+		if (get_u32(&tail[pos]) == EndOfCentralDirSignature &&
+		    pos + EndOfCentralDirSize + get_u16(&tail[pos + 20]) <= tail_size) {
+			end_pos = pos;
+			break;
+		}
+	}
+	if (!end_pos) {
+		return false;
+	}
+
+	const uint8_t* end_record = &tail[*end_pos];
+	if (get_u16(end_record + 4) != 0 || get_u16(end_record + 6) != 0) {
+		LOG_WARNING("DOS: Archives split across disks aren't supported");
+		return false;
+	}
+	uint64_t num_entries = get_u16(end_record + 10);
+	uint64_t dir_size    = get_u32(end_record + 12);
+	uint64_t dir_offset  = get_u32(end_record + 16);
+
+	const auto end_offset = tail_offset + *end_pos;
+	if ((num_entries == UINT16_MAX || dir_size == UINT32_MAX ||
+	     dir_offset == UINT32_MAX) &&
+	    end_offset >= Zip64EndLocatorSize) {
+		uint8_t locator[Zip64EndLocatorSize];
+		uint8_t record[Zip64EndOfCentralSize];
+		if (ReadArchive(end_offset - Zip64EndLocatorSize, locator, sizeof(locator)) &&
+		    get_u32(locator) == Zip64EndLocatorSignature &&
+		    ReadArchive(get_u64(locator + 8), record, sizeof(record)) &&
+		    get_u32(record) == Zip64EndOfCentralSignature) {
+			num_entries = get_u64(record + 32);
+			dir_size    = get_u64(record + 40);
+			dir_offset  = get_u64(record + 48);
+		}
+	}
+	if (dir_size > MaxCentralDirSize || dir_offset > file_size ||
+	    dir_size > file_size - dir_offset) {
+		return false;
+	}
+
+	std::vector<uint8_t> dir(static_cast<size_t>(dir_size));
+	if (!ReadArchive(dir_offset, dir.data(), dir.size())) {
+		return false;
+	}
+
+	size_t pos = 0;
+	for (uint64_t i = 0; i < num_entries; ++i) {
+		if (pos + CentralHeaderSize > dir.size()) {
+			return false;
+		}
+		const uint8_t* header = &dir[pos];
+		if (get_u32(header) != CentralHeaderSignature) {
+			return false;
+		}
+		const auto made_by        = static_cast<uint8_t>(get_u16(header + 4) >> 8);
+		const auto flags          = get_u16(header + 8);
+		const auto name_length    = get_u16(header + 28);
+		const auto extra_length   = get_u16(header + 30);
+		const auto comment_length = get_u16(header + 32);
+		const auto next = pos + CentralHeaderSize + name_length + extra_length +
+		                  comment_length;
+		if (next > dir.size()) {
+			return false;
+		}
+
+		std::string name(reinterpret_cast<const char*>(header + CentralHeaderSize),
+		                 name_length);
+		if (flags & FlagUtf8Names) {
+			name = fs_utf8_to_dos_437(name);
+		}
+		std::replace(name.begin(), name.end(), '\\', '/');
+		const bool is_dir = !name.empty() && name.back() == '/';
+
+		const auto index = AddPath(name, is_dir);
+		if (index == 0 || (is_dir != entries[index].is_dir)) {
+			pos = next;
+			continue;
+		}
+		auto& entry = entries[index];
+		entry.time  = get_u16(header + 12);
+		entry.date  = get_u16(header + 14);
+
+		// Archives made on DOS, OS/2 and Windows keep the DOS attributes
+		const auto external = get_u32(header + 38);
+		if (made_by == 0 || made_by == 6 || made_by == 10 || made_by == 11) {
+			entry.attr.hidden  = (external & 0x02) != 0;
+			entry.attr.system  = (external & 0x04) != 0;
+			entry.attr.archive = (external & 0x20) != 0;
+		}
+		entry.attr.read_only = true;
+		entry.attr.directory = is_dir;
+		if (is_dir) {
+			pos = next;
+			continue;
+		}
+
+		entry.method          = get_u16(header + 10);
+		entry.is_encrypted    = (flags & FlagEncrypted) != 0;
+		entry.compressed_size = get_u32(header + 20);
+		entry.size            = get_u32(header + 24);
+		entry.header_offset   = get_u32(header + 42);
+
+		// Sizes and offsets too large for the header are in the
+		// Zip64 extra field, in this order
+		const uint8_t* extra = header + CentralHeaderSize + name_length;
+		for (size_t extra_pos = 0; extra_pos + 4 <= extra_length;) {
+			const auto id   = get_u16(extra + extra_pos);
+			const auto size = get_u16(extra + extra_pos + 2);
+			if (extra_pos + 4 + size > extra_length) {
+				break;
+			}
+			if (id == 0x0001) {
+				const uint8_t* field = extra + extra_pos + 4;
+				const uint8_t* field_end = field + size;
+				for (auto value : {&entry.size,
+				                   &entry.compressed_size,
+				                   &entry.header_offset}) {
+					if (*value == UINT32_MAX && field + 8 <= field_end) {
+						*value = get_u64(field);
+						field += 8;
+					}
+				}
+			}
+			extra_pos += 4 + size;
+		}
+		total_size += entry.size;
+		pos = next;
+	}
+	return true;
+}
+
+size_t zipDrive::AddPath(const std::string& path, const bool is_dir)
+{
+	size_t dir = 0;
+	const auto components = split(path, "/");
+	for (size_t i = 0; i < components.size(); ++i) {
+		const auto& component = components[i];
+		if (component == "." || component == "..") {
+			continue;
+		}
+		const bool is_last = (i + 1 == components.size());
+		const bool wants_dir = !is_last || is_dir;
+
+		auto key = component;
+		upcase(key);
+		if (const auto it = archive_names[dir].find(key);
+		    it != archive_names[dir].end()) {
+			if (!is_last && !entries[it->second].is_dir) {
+				// A file and a directory of the same name
+				return 0;
+			}
+			dir = it->second;
+			continue;
+		}
+
+		const auto index = entries.size();
+		entries.emplace_back();
+		entries.back().parent         = dir;
+		entries.back().is_dir         = wants_dir;
+		entries.back().attr.directory = wants_dir;
+		entries.back().attr.read_only = true;
+		entries[dir].children.push_back(index);
+		archive_names[dir].emplace(std::move(key), index);
+		archive_names.emplace_back();
+		long_names.emplace_back(component);
+		dir = index;
+	}
+	return dir;
+}
+
+void zipDrive::AssignNames(const size_t dir)
+{
+	auto& by_name = entries[dir].by_name;
+
+	// Names that are valid 8.3 names already keep them, the others get
+	// numbered short names like on a FAT drive
+	std::vector<size_t> long_named = {};
+	for (const auto index : entries[dir].children) {
+		auto name = long_names[index];
+		if (filename_not_8x3(name.c_str())) {
+			long_named.push_back(index);
+			continue;
+		}
+		upcase(name);
+		if (by_name.try_emplace(name, index).second) {
+			entries[index].name = std::move(name);
+		} else {
+			long_named.push_back(index);
+		}
+	}
+	for (const auto index : long_named) {
+		for (unsigned int num = 1;; ++num) {
+			const auto name = generate_8x3(long_names[index].c_str(), num);
+			if (name.empty() || name.size() >= DOS_NAMELENGTH_ASCII) {
+				break;
+			}
+			if (by_name.try_emplace(name, index).second) {
+				entries[index].name = name;
+				break;
+			}
+		}
+	}
+
+	// Entries that couldn't be named are left out
+	auto& children = entries[dir].children;
+	children.erase(std::remove_if(children.begin(),
+	                              children.end(),
+	                              [&](const size_t index) {
+		                              return entries[index].name.empty();
+	                              }),
+	               children.end());
+}
+
+std::optional<size_t> zipDrive::Lookup(const char* path) const
+{
+	size_t index = 0;
+	for (auto& component : split(path, "\\")) {
+		if (!entries[index].is_dir) {
+			return {};
+		}
+		// A trailing dot means no extension
+		if (component.back() == '.') {
+			component.pop_back();
+		}
+		upcase(component);
+		const auto& by_name = entries[index].by_name;
+		const auto it       = by_name.find(component);
+		if (it == by_name.end()) {
+			return {};
+		}
+		index = it->second;
+	}
+	return index;
+}
+
+std::unique_ptr<DOS_File> zipDrive::FileOpen(const char* name, uint8_t flags)
+{
+	if ((flags & 0x0f) == OPEN_WRITE || (flags & 0x0f) == OPEN_READWRITE) {
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return nullptr;
+	}
+	const auto index = Lookup(name);
+	if (!index || entries[*index].is_dir) {
+		DOS_SetError(DOSERR_FILE_NOT_FOUND);
+		return nullptr;
+	}
+	const auto& entry = entries[*index];
+	if (entry.is_encrypted ||
+	    (entry.method != MethodStored && entry.method != MethodDeflated)) {
+		LOG_WARNING("DOS: '%s' in ZIP archive '%s' is encrypted or compressed with an unsupported method",
+		            name,
+		            info);
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return nullptr;
+	}
+	if (GetDataOffset(*index) == UINT64_MAX) {
+		LOG_WARNING("DOS: '%s' in ZIP archive '%s' is damaged", name, info);
+		DOS_SetError(DOSERR_ACCESS_DENIED);
+		return nullptr;
+	}
+
+	auto file   = std::make_unique<zipFile>(shared_from_this(), name, *index);
+	file->flags = flags;
+	return file;
+}
+
+std::unique_ptr<DOS_File> zipDrive::FileCreate(const char* /*name*/,
+                                               FatAttributeFlags /*attributes*/)
+{
+	DOS_SetError(DOSERR_ACCESS_DENIED);
+	return nullptr;
+}
+
+bool zipDrive::FileUnlink(const char* /*name*/)
+{
+	DOS_SetError(DOSERR_ACCESS_DENIED);
+	return false;
+}
+
+bool zipDrive::RemoveDir(const char* /*dir*/)
+{
+	DOS_SetError(DOSERR_ACCESS_DENIED);
+	return false;
+}
+
+bool zipDrive::MakeDir(const char* /*dir*/)
+{
+	DOS_SetError(DOSERR_ACCESS_DENIED);
+	return false;
+}
+
+bool zipDrive::TestDir(const char* dir)
+{
+	const auto index = Lookup(dir);
+	return index && entries[*index].is_dir;
+}
+
+bool zipDrive::FindFirst(const char* dir, DOS_DTA& dta, bool fcb_findfirst)
+{
+	const auto index = Lookup(dir);
+	if (!index || !entries[*index].is_dir) {
+		DOS_SetError(DOSERR_PATH_NOT_FOUND);
+		return false;
+	}
+
+	const auto id = next_search;
+	next_search   = static_cast<uint16_t>((next_search + 1) % MAX_OPENDIRS);
+	searches[id]  = {*index, 0, *index == 0};
+	dta.SetDirID(id);
+
+	FatAttributeFlags attr = {};
+	char pattern[DOS_NAMELENGTH_ASCII];
+	dta.GetSearchParams(attr, pattern);
+
+	const auto label = GetLabel();
+	if (attr == FatAttributeFlags::Volume) {
+		dta.SetResult(label, 0, 0, 0, FatAttributeFlags::Volume);
+		return true;
+	} else if (attr.volume && *index == 0 && !fcb_findfirst) {
+		if (WildFileCmp(label, pattern)) {
+			dta.SetResult(label, 0, 0, 0, FatAttributeFlags::Volume);
+			return true;
+		}
+	}
+	return FindNext(dta);
+}
+
+bool zipDrive::FindNext(DOS_DTA& dta)
+{
+	FatAttributeFlags attr = {};
+	char pattern[DOS_NAMELENGTH_ASCII];
+	dta.GetSearchParams(attr, pattern);
+
+	FatAttributeFlags attr_mask = {};
+	attr_mask.directory         = true;
+	attr_mask.hidden            = true;
+	attr_mask.system            = true;
+
+	auto& search = searches[dta.GetDirID() % MAX_OPENDIRS];
+	const auto& dir = entries[search.dir];
+
+	// Directories other than the root start with their dot entries
+	const size_t num_dots = search.is_root ? 0 : 2;
+	while (search.next < num_dots + dir.children.size()) {
+		const auto pos = search.next++;
+		const char* name = nullptr;
+		const Entry* found = nullptr;
+		if (pos < num_dots) {
+			name  = pos == 0 ? "." : "..";
+			found = &dir;
+		} else {
+			found = &entries[dir.children[pos - num_dots]];
+			name  = found->name.c_str();
+		}
+		if (!WildFileCmp(name, pattern) ||
+		    (~(attr._data) & found->attr._data & attr_mask._data)) {
+			continue;
+		}
+		const auto size = static_cast<uint32_t>(
+		        found->is_dir ? 0 : std::min<uint64_t>(found->size, UINT32_MAX));
+		dta.SetResult(name, size, found->date, found->time, found->attr);
+		return true;
+	}
+	DOS_SetError(DOSERR_NO_MORE_FILES);
+	return false;
+}
+
+bool zipDrive::GetFileAttr(const char* name, FatAttributeFlags* attr)
+{
+	const auto index = Lookup(name);
+	if (!index) {
+		return false;
+	}
+	*attr = entries[*index].attr;
+	return true;
+}
+
+bool zipDrive::SetFileAttr(const char* name, [[maybe_unused]] const FatAttributeFlags attr)
+{
+	DOS_SetError(Lookup(name) ? DOSERR_ACCESS_DENIED : DOSERR_FILE_NOT_FOUND);
+	return false;
+}
+
+bool zipDrive::Rename(const char* /*oldname*/, const char* /*newname*/)
+{
+	DOS_SetError(DOSERR_ACCESS_DENIED);
+	return false;
+}
+
+bool zipDrive::AllocationInfo(uint16_t* bytes_sector, uint8_t* sectors_cluster,
+                              uint16_t* total_clusters, uint16_t* free_clusters)
+{
+	// Large enough clusters that the decompressed contents fit
+	constexpr uint64_t ClusterBytes = 512 * 32;
+	*bytes_sector    = 512;
+	*sectors_cluster = 32;
+	*total_clusters  = static_cast<uint16_t>(std::clamp<uint64_t>(
+                (total_size + ClusterBytes - 1) / ClusterBytes, 1, UINT16_MAX));
+	*free_clusters   = 0;
+	return true;
+}
+
+bool zipDrive::FileExists(const char* name)
+{
+	const auto index = Lookup(name);
+	return index && !entries[*index].is_dir;
+}
+
+uint8_t zipDrive::GetMediaByte()
+{
+	return mediaid;
+}
+
+bool zipDrive::IsRemote()
+{
+	return false;
+}
+
+bool zipDrive::IsRemovable()
+{
+	return false;
+}
+
+Bits zipDrive::UnMount()
+{
+	return 0;
+}
@@ -6,7 +6,11 @@
 
 #include "dosbox.h"
 
+#include <array>
+#include <list>
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -206,10 +210,11 @@ public:
 	bool IsRemote(void) override;
 	bool IsRemovable(void) override;
 	Bits UnMount(void) override;
-	void EmptyCache(void) override {}
+	void EmptyCache(void) override { clearCaches(); }
 
 public:
 	uint8_t readSector(uint32_t sectnum, void * data);
+	uint8_t readSectors(uint32_t sectnum, uint32_t count, void * data);
 	uint8_t writeSector(uint32_t sectnum, void * data);
 	uint32_t getAbsoluteSectFromBytePos(uint32_t startClustNum, uint32_t bytePos);
 	uint32_t getSectorCount();
@@ -249,8 +254,21 @@ private:
 
 	uint32_t cwdDirCluster;
 
-	uint8_t fatSectBuffer[1024];
-	uint32_t curFatSect;
+	/* Caches of the file system structures. Every write fatDrive makes goes
+	   through writeSector(), which keeps them current, and writes to the
+	   image from anywhere else, such as INT 13h, drop them. */
+	void checkCaches();
+	void clearCaches();
+	uint8_t *fatCacheSector(uint32_t index);
+	uint8_t readDirSector(uint32_t sectnum, direntry *data);
+
+	/* sectors of the first FAT, empty until they're read */
+	std::vector<std::vector<uint8_t>> fatCache;
+	/* clusters of the chains walked so far, by their first cluster */
+	std::unordered_map<uint32_t, std::vector<uint32_t>> chainCache;
+	/* directory sectors read so far, by absolute sector */
+	std::unordered_map<uint32_t, std::vector<uint8_t>> dirSectorCache;
+	uint64_t knownDiskWrites;
 };
 
 class cdromDrive final : public localDrive
@@ -354,7 +372,6 @@ struct isoDirEntry {
 #define IS_ASSOC(fileFlags)	(!!(fileFlags & ISO_ASSOCIATED))
 #define IS_DIR(fileFlags)	(!!(fileFlags & ISO_DIRECTORY))
 #define IS_HIDDEN(fileFlags)	(!!(fileFlags & ISO_HIDDEN))
-#define ISO_MAX_HASH_TABLE_SIZE 	100
 
 // Must be constructed with a shared_ptr or it will throw an exception on internal call to shared_from_this()
 class isoDrive final : public DOS_Drive, public std::enable_shared_from_this<isoDrive> {
@@ -385,6 +402,7 @@ public:
 	bool IsRemovable(void) override;
 	Bits UnMount(void) override;
 	bool readSector(uint8_t* buffer, uint32_t sector);
+	bool readSectors(uint8_t* buffer, uint32_t sector, uint32_t count);
 	const char* GetLabel() override
 	{
 		return discLabel;
@@ -401,6 +419,15 @@ private:
 	bool GetNextDirEntry(const int dirIterator, isoDirEntry* de);
 	void FreeDirIterator(const int dirIterator);
 	bool ReadCachedSector(uint8_t** buffer, const uint32_t sector);
+
+	// The entries of a directory, parsed when it's first looked in
+	struct DirIndex {
+		std::vector<isoDirEntry> entries = {};
+
+		// Upper-cased names to their first entry
+		std::unordered_map<std::string, size_t> byName = {};
+	};
+	const DirIndex& GetDirIndex(const isoDirEntry& de);
 	
 	struct DirIterator {
 		bool valid;
@@ -412,11 +439,19 @@ private:
 	
 	int nextFreeDirIterator;
 	
-	struct SectorHashEntry {
-		bool valid;
-		uint32_t sector;
-		uint8_t data[ISO_FRAMESIZE];
-	} sectorHashEntries[ISO_MAX_HASH_TABLE_SIZE];
+	// Directory sectors, least recently used ones dropped first
+	static constexpr size_t SectorCacheSize = 1024;
+	struct CachedSector {
+		uint32_t sector = 0;
+		std::array<uint8_t, ISO_FRAMESIZE> data = {};
+	};
+	std::list<CachedSector> sectorCache = {};
+	std::unordered_map<uint32_t, std::list<CachedSector>::iterator> sectorCacheIndex = {};
+
+	// By the sector each directory starts at. Dropped as a whole once
+	// this many directories are indexed.
+	static constexpr size_t MaxDirIndexes = 256;
+	std::unordered_map<uint32_t, DirIndex> dirIndexes = {};
 
 	bool iso;
 	bool dataCD;
@@ -428,6 +463,116 @@ private:
 	char discLabel[32];
 };
 
+// Read-only drive backed by a ZIP archive. The central directory is
+// indexed when the drive is mounted; stored entries are read straight
+// from the archive, deflated ones through a cache of decompressed blocks
+// shared by every mounted archive.
+class zipDrive final : public DOS_Drive, public std::enable_shared_from_this<zipDrive> {
+public:
+	zipDrive(const char* archive_path, uint8_t mediaid, bool& is_error);
+	~zipDrive() override;
+	zipDrive(const zipDrive&)            = delete;
+	zipDrive& operator=(const zipDrive&) = delete;
+
+	std::unique_ptr<DOS_File> FileOpen(const char* name, uint8_t flags) override;
+	std::unique_ptr<DOS_File> FileCreate(const char* name,
+	                                     FatAttributeFlags attributes) override;
+	bool FileUnlink(const char* name) override;
+	bool RemoveDir(const char* dir) override;
+	bool MakeDir(const char* dir) override;
+	bool TestDir(const char* dir) override;
+	bool FindFirst(const char* _dir, DOS_DTA& dta, bool fcb_findfirst) override;
+	bool FindNext(DOS_DTA& dta) override;
+	bool GetFileAttr(const char* name, FatAttributeFlags* attr) override;
+	bool SetFileAttr(const char* name, const FatAttributeFlags attr) override;
+	bool Rename(const char* oldname, const char* newname) override;
+	bool AllocationInfo(uint16_t* bytes_sector, uint8_t* sectors_cluster,
+	                    uint16_t* total_clusters,
+	                    uint16_t* free_clusters) override;
+	bool FileExists(const char* name) override;
+	uint8_t GetMediaByte() override;
+	void EmptyCache() override {}
+	bool IsReadOnly() const override { return true; }
+	bool IsRemote() override;
+	bool IsRemovable() override;
+	Bits UnMount() override;
+
+	// True if the file is named like an archive this drive can mount
+	static bool IsArchive(const std::string& path);
+
+	struct Entry {
+		// The 8.3 name the entry goes by in DOS
+		std::string name = {};
+		size_t parent    = 0;
+		bool is_dir      = false;
+
+		uint16_t method          = 0;
+		bool is_encrypted        = false;
+		uint64_t compressed_size = 0;
+		uint64_t size            = 0;
+		uint64_t header_offset   = 0;
+
+		// Found from the local header when the entry is first opened
+		uint64_t data_offset = UINT64_MAX;
+
+		uint16_t date          = 0;
+		uint16_t time          = 0;
+		FatAttributeFlags attr = {};
+
+		// Directories only, children in archive order
+		std::vector<size_t> children = {};
+		std::unordered_map<std::string, size_t> by_name = {};
+	};
+
+	const Entry& GetEntry(const size_t index) const
+	{
+		return entries[index];
+	}
+
+	// Identifies the archive's blocks in the shared cache
+	uint64_t GetCacheId() const
+	{
+		return cache_id;
+	}
+
+	// Reads raw archive bytes, false on a short read
+	bool ReadArchive(uint64_t offset, uint8_t* data, size_t bytes);
+
+	// Where the entry's data starts, or UINT64_MAX if that can't be told
+	uint64_t GetDataOffset(size_t index);
+
+private:
+	bool ReadCentralDirectory();
+	size_t AddPath(const std::string& path, bool is_dir);
+	void AssignNames(size_t dir);
+
+	// The entry the DOS path names, or nothing
+	std::optional<size_t> Lookup(const char* path) const;
+
+	NativeFileHandle file = InvalidNativeFileHandle;
+	uint64_t file_size    = 0;
+	uint64_t cache_id     = 0;
+	uint64_t total_size   = 0;
+
+	// The root directory comes first
+	std::vector<Entry> entries = {};
+
+	// Upper-cased archive names of each directory's children, while the
+	// index is built
+	std::vector<std::unordered_map<std::string, size_t>> archive_names = {};
+	std::vector<std::string> long_names = {};
+
+	struct Search {
+		size_t dir  = 0;
+		size_t next = 0;
+		bool is_root = false;
+	};
+	std::array<Search, MAX_OPENDIRS> searches = {};
+	uint16_t next_search = 0;
+
+	uint8_t mediaid = 0;
+};
+
 class VFILE_Block;
 using vfile_block_t = std::shared_ptr<VFILE_Block>;
 
@@ -480,6 +625,7 @@ public:
 	              uint16_t _free_clusters,
 	              uint8_t _mediaid,
 	              uint8_t &error);
+	~Overlay_Drive() override;
 
 	std::unique_ptr<DOS_File> FileOpen(const char* name, uint8_t flags) override;
 	std::unique_ptr<DOS_File> FileCreate(const char* name,
@@ -495,6 +641,7 @@ public:
 
 	std::pair<NativeFileHandle, std_fs::path> create_file_in_overlay(
 	        const char* dos_filename, const FatAttributeFlags attributes);
+	void add_DOSname_to_cache(const char* name);
 
 	Bits UnMount(void) override;
 	bool TestDir(const char* dir) override;
@@ -504,7 +651,6 @@ public:
 private:
 	char overlaydir[CROSS_LEN];
 	bool Sync_leading_dirs(const char* dos_filename);
-	void add_DOSname_to_cache(const char* name);
 	void remove_DOSname_from_cache(const char* name);
 	void add_DOSdir_to_cache(const char* name);
 	void remove_DOSdir_from_cache(const char* name);
@@ -532,6 +678,20 @@ private:
 	std::vector<std::string> DOSnames_cache; //Also set is probably better.
 	std::vector<std::string> DOSdirs_cache; //Can not blindly change its type. it is important that subdirs come after the parent directory.
 	const std::string special_prefix;
+
+	// The lists above are kept in an index file in the overlay root, so
+	// mounting doesn't have to walk the whole overlay. Along with them it
+	// holds the modification time of every overlay directory; the index
+	// is only used if none of them changed since.
+	bool load_index();
+	void save_index();
+
+	// Records the times of the overlay directories leading to, and
+	// including, a path that was just changed in the overlay
+	void note_overlay_change(const char* dos_name);
+
+	std::map<std::string, int64_t> overlay_dir_times = {};
+	bool is_index_dirty = false;
 };
 
 #pragma GCC diagnostic pop
@@ -753,6 +753,10 @@ void MIXER::Run()
 		MIDI_ListDevices(this);
 		return;
 	}
+	if (cmd->FindExist("/STATS")) {
+		ShowMixerStats();
+		return;
+	}
 
 	constexpr auto remove = true;
 
@@ -793,6 +797,7 @@ void MIXER::AddMessages()
 	        "Usage:\n"
 	        "  [color=light-green]mixer[reset] [color=light-cyan][CHANNEL][reset] [color=white]COMMANDS[reset] [/noshow]\n"
 	        "  [color=light-green]mixer[reset] [/listmidi]\n"
+	        "  [color=light-green]mixer[reset] [/stats]\n"
 	        "\n"
 	        "Parameters:\n"
 	        "  [color=light-cyan]CHANNEL[reset]   mixer channel to change the settings of\n"
@@ -808,6 +813,7 @@ void MIXER::AddMessages()
 	        "Notes:\n"
 	        "  - Run [color=light-green]mixer[reset] without arguments to view the current settings.\n"
 	        "  - Run [color=light-green]mixer[reset] /listmidi to list all available MIDI devices.\n"
+	        "  - Run [color=light-green]mixer[reset] /stats to show the audio latency and mixing times.\n"
 	        "  - You may change the settings of more than one channel in a single command.\n"
 	        "  - If no channel is specified, you can set crossfeed, reverb, or chorus\n"
 	        "    of all channels globally.\n"
@@ -828,6 +834,20 @@ void MIXER::AddMessages()
 	MSG_Add("SHELL_CMD_MIXER_CHANNEL_REVERSE", "Reverse");
 	MSG_Add("SHELL_CMD_MIXER_CHANNEL_MONO", "Mono");
 
+	MSG_Add("SHELL_CMD_MIXER_STATS",
+	        "[color=white]Audio output[reset]\n"
+	        "  Queued:            %d frames (%.1f ms)\n"
+	        "  Underruns:         %llu\n"
+	        "  Overruns:          %llu\n"
+	        "  Block mix time:    %d us of %.0f us (channels %d us)\n"
+	        "  Latency, host:     %.1f ms\n"
+	        "  Latency, emulated: %.1f ms\n");
+
+	MSG_Add("SHELL_CMD_MIXER_STATS_CHANNEL_LABELS",
+	        "[color=white]Channel      Render time[reset]");
+
+	MSG_Add("SHELL_CMD_MIXER_STATS_CHANNEL_LAYOUT", "%-22s %6d us");
+
 	MSG_Add("SHELL_CMD_MIXER_INACTIVE_CHANNEL",
 	        "Channel [color=light-cyan]%s[reset] is not active");
 
@@ -989,3 +1009,43 @@ void MIXER::ShowMixerStatus()
 
 	WriteOut("\n");
 }
+
+void MIXER::ShowMixerStats()
+{
+	const auto stats = MIXER_GetStats();
+
+	const auto frames_to_ms = [&](const int num_frames) {
+		return stats.sample_rate_hz > 0
+		             ? num_frames * 1000.0 / stats.sample_rate_hz
+		             : 0.0;
+	};
+
+	WriteOut(MSG_Get("SHELL_CMD_MIXER_STATS"),
+	         stats.queued_frames,
+	         frames_to_ms(stats.queued_frames),
+	         static_cast<unsigned long long>(stats.underruns),
+	         static_cast<unsigned long long>(stats.overruns),
+	         stats.mix_time_us,
+	         frames_to_ms(stats.blocksize) * 1000.0,
+	         stats.render_time_us,
+	         stats.host_latency_us / 1000.0,
+	         stats.emulated_latency_us / 1000.0);
+	WriteOut("\n");
+
+	std::string column_layout = MSG_Get("SHELL_CMD_MIXER_STATS_CHANNEL_LAYOUT");
+	column_layout.append({'\n'});
+
+	WriteOut(MSG_Get("SHELL_CMD_MIXER_STATS_CHANNEL_LABELS"));
+	WriteOut("\n");
+
+	for (auto& [name, chan] : MIXER_GetChannels()) {
+		auto channel_name = std::string("[color=light-cyan]") + name +
+		                    std::string("[reset]");
+
+		WriteOut(column_layout,
+		         convert_ansi_markup(channel_name).c_str(),
+		         chan->GetRenderTimeUs());
+	}
+
+	WriteOut("\n");
+}
@@ -255,16 +255,32 @@ void MOUNT::Run(void) {
 			WriteOut(MSG_Get("PROGRAM_MOUNT_ERROR_1"),temp_line.c_str());
 			return;
 		}
-		/* Not a switch so a normal directory/file */
-		if (!S_ISDIR(test.st_mode)) {
+		// ZIP archives are mounted read-only in place of a directory
+		if (type == "dir" && !S_ISDIR(test.st_mode) &&
+		    zipDrive::IsArchive(temp_line)) {
+			bool is_error = false;
+			newdrive = std::make_shared<zipDrive>(temp_line.c_str(),
+			                                      mediaid,
+			                                      is_error);
+			if (is_error) {
+				WriteOut(MSG_Get("PROGRAM_MOUNT_ERROR_ARCHIVE"),
+				         temp_line.c_str());
+				return;
+			}
+		} else if (!S_ISDIR(test.st_mode)) {
+			/* Not a switch so a normal directory/file */
 			WriteOut(MSG_Get("PROGRAM_MOUNT_ERROR_2"),temp_line.c_str());
 			return;
 		}
 
-		if (temp_line[temp_line.size() - 1] != CROSS_FILESPLIT) temp_line += CROSS_FILESPLIT;
+		if (!newdrive && temp_line.back() != CROSS_FILESPLIT) {
+			temp_line += CROSS_FILESPLIT;
+		}
 		uint8_t int8_tize = (uint8_t)sizes[1];
 
-		if (type == "cdrom") {
+		if (newdrive) {
+			// Already mounted as an archive
+		} else if (type == "cdrom") {
 			// Following options were relevant only for physical CD-ROM support:
 			for (auto opt : {"-noioctl", "-ioctl", "-ioctl_dx", "-ioctl_mci", "-ioctl_dio"}) {
 				if (cmd->FindExist(opt, false))
@@ -416,6 +432,7 @@ void MOUNT::AddMessages() {
 	        "Notes:\n"
 	        "  - '-t overlay' redirects writes for mounted drive to another directory.\n"
 	        "  - '-ro' mounts the drive as read-only.\n"
+	        "  - A ZIP archive given in place of the DIRECTORY is mounted read-only.\n"
 	        "\n"
 	        "Examples:\n");
 	MSG_Add("PROGRAM_MOUNT_HELP_LONG_WIN32",
@@ -434,6 +451,7 @@ void MOUNT::AddMessages() {
 	MSG_Add("PROGRAM_MOUNT_CDROMS_FOUND","CD-ROMs found: %d\n");
 	MSG_Add("PROGRAM_MOUNT_ERROR_1","Directory %s doesn't exist.\n");
 	MSG_Add("PROGRAM_MOUNT_ERROR_2","%s isn't a directory.\n");
+	MSG_Add("PROGRAM_MOUNT_ERROR_ARCHIVE", "%s isn't a ZIP archive that can be mounted.\n");
 	MSG_Add("PROGRAM_MOUNT_ILL_TYPE","Illegal type %s\n");
 	MSG_Add("PROGRAM_MOUNT_ALREADY_MOUNTED","Drive %c already mounted with %s\n");
 	MSG_Add("PROGRAM_MOUNT_UMOUNT_NOT_MOUNTED","Drive %c isn't mounted.\n");
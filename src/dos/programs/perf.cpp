@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "perf.h"
+
+#include <string>
+
+#include "hardware/port.h"
+#include "misc/footprint.h"
+#include "misc/perf_counters.h"
+#include "more_output.h"
+#include "utils/string_utils.h"
+
+void PERF::Run()
+{
+	if (HelpRequested()) {
+		MoreOutputStrings output(*this);
+		output.AddString(MSG_Get("PROGRAM_PERF_HELP_LONG"));
+		output.Display();
+		return;
+	}
+
+	constexpr bool RemoveIfFound = true;
+	if (cmd->FindExist("/ports", RemoveIfFound)) {
+		ShowBusiestPorts();
+		return;
+	}
+	if (cmd->FindExist("/memory", RemoveIfFound)) {
+		ShowMemory();
+		return;
+	}
+	if (cmd->FindExist("/trim", RemoveIfFound)) {
+		Trim();
+		return;
+	}
+
+	// An optional argument narrows the list to names containing it
+	std::string filter = {};
+	cmd->FindCommand(1, filter);
+	lowcase(filter);
+
+	MoreOutputStrings output(*this);
+	output.AddString(MSG_Get("PROGRAM_PERF_HEADER"));
+	for (const auto& sample : PERF_Sample()) {
+		if (!filter.empty() && sample.name.find(filter) == std::string::npos) {
+			continue;
+		}
+		output.AddString("%-32s %20s\n",
+		                 sample.name.c_str(),
+		                 std::to_string(sample.value).c_str());
+	}
+	output.Display();
+}
+
+void PERF::ShowBusiestPorts()
+{
+	constexpr size_t MaxPorts = 20;
+
+	MoreOutputStrings output(*this);
+	output.AddString(MSG_Get("PROGRAM_PERF_PORTS_HEADER"));
+	for (const auto& port : IO_GetBusiestPorts(MaxPorts)) {
+		output.AddString("%04Xh %20s %20s\n",
+		                 port.port,
+		                 std::to_string(port.reads).c_str(),
+		                 std::to_string(port.writes).c_str());
+	}
+	output.Display();
+}
+
+static std::string to_kilobytes(const size_t num_bytes)
+{
+	return std::to_string(num_bytes / 1024);
+}
+
+void PERF::ShowMemory()
+{
+	MoreOutputStrings output(*this);
+	output.AddString(MSG_Get("PROGRAM_PERF_MEMORY_HEADER"));
+
+	size_t reserved = 0;
+	size_t resident = 0;
+	for (const auto& region : FOOTPRINT_Sample()) {
+		output.AddString("%-24s %16s %16s\n",
+		                 region.name.c_str(),
+		                 to_kilobytes(region.reserved_bytes).c_str(),
+		                 to_kilobytes(region.resident_bytes).c_str());
+		reserved += region.reserved_bytes;
+		resident += region.resident_bytes;
+	}
+	output.AddString("%-24s %16s %16s\n",
+	                 MSG_Get("PROGRAM_PERF_MEMORY_TOTAL").c_str(),
+	                 to_kilobytes(reserved).c_str(),
+	                 to_kilobytes(resident).c_str());
+
+	output.AddString("\n");
+	if (const auto rss = FOOTPRINT_GetProcessResidentBytes()) {
+		output.AddString(MSG_Get("PROGRAM_PERF_MEMORY_PROCESS"),
+		                 to_kilobytes(*rss).c_str(),
+		                 FOOTPRINT_GetProfileName());
+	} else {
+		output.AddString(MSG_Get("PROGRAM_PERF_MEMORY_PROFILE"),
+		                 FOOTPRINT_GetProfileName());
+	}
+	output.Display();
+}
+
+void PERF::Trim()
+{
+	const auto released = FOOTPRINT_Trim();
+	WriteOut(MSG_Get("PROGRAM_PERF_TRIMMED"), to_kilobytes(released).c_str());
+}
+
+void PERF::AddMessages()
+{
+	MSG_Add("PROGRAM_PERF_HELP_LONG",
+	        "Display the emulator's internal performance counters.\n"
+	        "\n"
+	        "Usage:\n"
+	        "  [color=light-green]perf[reset]\n"
+	        "  [color=light-green]perf[reset] [color=light-cyan]FILTER[reset]\n"
+	        "  [color=light-green]perf[reset] /ports\n"
+	        "  [color=light-green]perf[reset] /memory\n"
+	        "  [color=light-green]perf[reset] /trim\n"
+	        "\n"
+	        "Parameters:\n"
+	        "  [color=light-cyan]FILTER[reset]  only show counters whose name contains this text\n"
+	        "  /ports   show the I/O ports accessed most often, to find polling loops\n"
+	        "  /memory  show how much host memory the emulator's large allocations hold\n"
+	        "  /trim    drop the caches that can be rebuilt and give their memory back\n"
+	        "\n"
+	        "Notes:\n"
+	        "  - Counters count up from startup; gauges show the current value.\n"
+	        "  - The text-mode server's METRICS and STATS JSON replies report the same\n"
+	        "    counters, and its MEMORY command the same allocations.\n"
+	        "  - Resident memory is what the host currently keeps in RAM. Only Linux\n"
+	        "    takes memory back on /trim.\n"
+	        "\n"
+	        "Examples:\n"
+	        "  [color=light-green]perf[reset]\n"
+	        "  [color=light-green]perf[reset] [color=light-cyan]dynrec[reset]\n"
+	        "  [color=light-green]perf[reset] /ports\n"
+	        "  [color=light-green]perf[reset] /memory\n");
+	MSG_Add("PROGRAM_PERF_HEADER",
+	        "[color=white]Counter                                         Value[reset]\n");
+	MSG_Add("PROGRAM_PERF_PORTS_HEADER",
+	        "[color=white]Port                 Reads               Writes[reset]\n");
+	MSG_Add("PROGRAM_PERF_MEMORY_HEADER",
+	        "[color=white]Region                        Reserved KB      Resident KB[reset]\n");
+	MSG_Add("PROGRAM_PERF_MEMORY_TOTAL", "Total");
+	MSG_Add("PROGRAM_PERF_MEMORY_PROCESS",
+	        "The whole process has %s KB resident, using the '%s' memory profile.\n");
+	MSG_Add("PROGRAM_PERF_MEMORY_PROFILE", "Using the '%s' memory profile.\n");
+	MSG_Add("PROGRAM_PERF_TRIMMED", "Gave %s KB back to the host.\n");
+}
@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_PROGRAM_PERF_H
+#define DOSBOX_PROGRAM_PERF_H
+
+#include "dos/programs.h"
+
+class PERF final : public Program {
+public:
+	PERF()
+	{
+		AddMessages();
+		help_detail = {HELP_Filter::All,
+		               HELP_Category::Dosbox,
+		               HELP_CmdType::Program,
+		               "PERF"};
+	}
+	void Run() override;
+
+private:
+	void ShowBusiestPorts();
+	void ShowMemory();
+	void Trim();
+	static void AddMessages();
+};
+
+#endif // DOSBOX_PROGRAM_PERF_H
@@ -0,0 +1,353 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "shared_mount_cache.h"
+
+#include "dosbox.h"
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "dos/dos_system.h"
+#include "misc/cross.h"
+#include "utils/fs_utils.h"
+
+static std_fs::path cache_dir = {};
+
+// Mappings of this instance by content, so every handle of the same
+// content shares one
+static std::unordered_map<std::string, std::weak_ptr<const SharedFileView>> mapped_files = {};
+
+void DOS_SetSharedMountCache(const std::string& dir)
+{
+	cache_dir.clear();
+	if (dir.empty()) {
+		return;
+	}
+	const auto path = resolve_home(dir);
+	std::error_code ec = {};
+	for (const auto subdir : {"listings", "files", "contents"}) {
+		std_fs::create_directories(path / subdir, ec);
+		if (ec) {
+			LOG_WARNING("DOS: Can't use '%s' as the shared mount cache: %s",
+			            path.string().c_str(),
+			            ec.message().c_str());
+			return;
+		}
+	}
+	cache_dir = path;
+	LOG_MSG("DOS: Sharing the cache of read-only mounts in '%s'",
+	        cache_dir.string().c_str());
+}
+
+bool DOS_IsSharedMountCacheEnabled()
+{
+	return !cache_dir.empty();
+}
+
+static std::string to_hex(const uint64_t value)
+{
+	char buffer[17];
+	snprintf(buffer, sizeof(buffer), "%016" PRIx64, value);
+	return buffer;
+}
+
+static std::string hash_path(const std_fs::path& path)
+{
+	// FNV-1a
+	uint64_t hash = 0xcbf2'9ce4'8422'2325;
+	for (const auto c : path.string()) {
+		hash = (hash ^ static_cast<uint8_t>(c)) * 0x100'0000'01b3;
+	}
+	return to_hex(hash);
+}
+
+static std::optional<int64_t> get_write_time(const std_fs::path& path)
+{
+	std::error_code ec = {};
+	const auto time = std_fs::last_write_time(path, ec);
+	if (ec) {
+		return {};
+	}
+	return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+// Where to write a file before it's renamed into place. Unique enough that
+// instances don't write to the same one.
+static std_fs::path temp_path_for(const std_fs::path& path)
+{
+	const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+	const auto id = std::hash<std::thread::id>()(std::this_thread::get_id()) ^
+	                static_cast<size_t>(now) ^
+	                reinterpret_cast<uintptr_t>(&cache_dir);
+	auto temp = path;
+	temp += "." + to_hex(id) + ".tmp";
+	return temp;
+}
+
+static bool move_into_place(const std_fs::path& temp, const std_fs::path& path)
+{
+	std::error_code ec = {};
+	std_fs::rename(temp, path, ec);
+	if (ec) {
+		std_fs::remove(temp, ec);
+		return false;
+	}
+	return true;
+}
+
+// Listings
+// ~~~~~~~~
+// A header line, the directory's path and write time, then one line per
+// entry starting with 'D' or 'F', and a closing line so truncated files
+// are told apart.
+
+constexpr auto ListingHeader = "DBLISTING 1";
+constexpr auto ListingEnd    = "END";
+
+std::optional<std::vector<SharedDirEntry>> DOS_LoadSharedDirListing(const std_fs::path& dir)
+{
+	if (!DOS_IsSharedMountCacheEnabled()) {
+		return {};
+	}
+	const auto write_time = get_write_time(dir);
+	if (!write_time) {
+		return {};
+	}
+	std::ifstream file(cache_dir / "listings" / hash_path(dir));
+	std::string line = {};
+	if (!std::getline(file, line) || line != ListingHeader ||
+	    !std::getline(file, line) || line != dir.string() ||
+	    !std::getline(file, line) || line != std::to_string(*write_time)) {
+		return {};
+	}
+
+	std::vector<SharedDirEntry> entries = {};
+	while (std::getline(file, line)) {
+		if (line == ListingEnd) {
+			return entries;
+		}
+		if (line.size() < 3 || (line[0] != 'D' && line[0] != 'F') || line[1] != ' ') {
+			break;
+		}
+		entries.push_back({line.substr(2), line[0] == 'D'});
+	}
+	return {};
+}
+
+void DOS_StoreSharedDirListing(const std_fs::path& dir,
+                               const std::vector<SharedDirEntry>& entries)
+{
+	if (!DOS_IsSharedMountCacheEnabled()) {
+		return;
+	}
+	const auto write_time = get_write_time(dir);
+	const auto dir_string = dir.string();
+	if (!write_time || dir_string.find('\n') != std::string::npos) {
+		return;
+	}
+	const auto path = cache_dir / "listings" / hash_path(dir);
+	const auto temp = temp_path_for(path);
+	{
+		std::ofstream file(temp, std::ios::trunc);
+		file << ListingHeader << '\n' << dir_string << '\n' << *write_time << '\n';
+		for (const auto& entry : entries) {
+			if (entry.name.find('\n') != std::string::npos) {
+				file.close();
+				std::error_code ec = {};
+				std_fs::remove(temp, ec);
+				return;
+			}
+			file << (entry.is_directory ? "D " : "F ") << entry.name << '\n';
+		}
+		file << ListingEnd << '\n';
+		if (!file.flush()) {
+			file.close();
+			std::error_code ec = {};
+			std_fs::remove(temp, ec);
+			return;
+		}
+	}
+	move_into_place(temp, path);
+}
+
+// Contents
+// ~~~~~~~~
+// Named by their size and a 128-bit hash made of two independent 64-bit
+// lanes. It isn't cryptographic, which is fine for telling apart the
+// files of game installs.
+
+static std::optional<std::string> hash_contents(const std_fs::path& path, const uint64_t size)
+{
+	const auto handle = open_native_file(path, false);
+	if (handle == InvalidNativeFileHandle) {
+		return {};
+	}
+	uint64_t lane_a = 0xcbf2'9ce4'8422'2325;
+	uint64_t lane_b = 0x9e37'79b9'7f4a'7c15;
+	std::vector<uint8_t> buffer(1024 * 1024);
+	uint64_t total = 0;
+	for (;;) {
+		const auto ret = read_native_file(handle,
+		                                  buffer.data(),
+		                                  static_cast<int64_t>(buffer.size()));
+		if (ret.error) {
+			close_native_file(handle);
+			return {};
+		}
+		if (ret.num_bytes == 0) {
+			break;
+		}
+		for (int64_t i = 0; i < ret.num_bytes; ++i) {
+			const auto byte = buffer[static_cast<size_t>(i)];
+			lane_a = (lane_a ^ byte) * 0x100'0000'01b3;
+			lane_b = (lane_b + byte) * 0xff51'afd7'ed55'8ccd;
+			lane_b ^= lane_b >> 29;
+		}
+		total += static_cast<uint64_t>(ret.num_bytes);
+	}
+	close_native_file(handle);
+	if (total != size) {
+		// Changed while it was read
+		return {};
+	}
+	return std::to_string(size) + "-" + to_hex(lane_a) + to_hex(lane_b);
+}
+
+// Which content the file holds, from what an instance found before or by
+// hashing it now
+static std::optional<std::string> find_contents(const std_fs::path& path,
+                                                const uint64_t size,
+                                                const int64_t write_time)
+{
+	const auto index_path = cache_dir / "files" / hash_path(path);
+	const auto key = path.string() + '\n' + std::to_string(size) + ' ' +
+	                 std::to_string(write_time);
+	{
+		std::ifstream file(index_path);
+		std::string path_line = {};
+		std::string stat_line = {};
+		std::string name      = {};
+		if (std::getline(file, path_line) && std::getline(file, stat_line) &&
+		    std::getline(file, name) && path_line + '\n' + stat_line == key &&
+		    !name.empty()) {
+			return name;
+		}
+	}
+
+	const auto name = hash_contents(path, size);
+	if (!name || path.string().find('\n') != std::string::npos) {
+		return name;
+	}
+	const auto temp = temp_path_for(index_path);
+	{
+		std::ofstream file(temp, std::ios::trunc);
+		file << key << '\n' << *name << '\n';
+		if (!file.flush()) {
+			file.close();
+			std::error_code ec = {};
+			std_fs::remove(temp, ec);
+			return name;
+		}
+	}
+	move_into_place(temp, index_path);
+	return name;
+}
+
+static bool add_contents(const std_fs::path& path, const std_fs::path& contents_path)
+{
+	const auto temp = temp_path_for(contents_path);
+	const auto src  = open_native_file(path, false);
+	if (src == InvalidNativeFileHandle) {
+		return false;
+	}
+	const auto dst = create_native_file(temp, {});
+	if (dst == InvalidNativeFileHandle) {
+		close_native_file(src);
+		return false;
+	}
+	const bool is_copied = copy_native_file(src, dst);
+	close_native_file(src);
+	close_native_file(dst);
+	if (!is_copied) {
+		std::error_code ec = {};
+		std_fs::remove(temp, ec);
+		return false;
+	}
+	// Another instance adding the same content first is just as good
+	return move_into_place(temp, contents_path) || std_fs::exists(contents_path);
+}
+
+SharedFileView::SharedFileView(const uint8_t* view_data, const size_t view_size)
+        : data(view_data),
+          size(view_size)
+{}
+
+SharedFileView::~SharedFileView()
+{
+#if !defined(WIN32)
+	munmap(const_cast<uint8_t*>(data), size);
+#endif
+}
+
+std::shared_ptr<const SharedFileView> DOS_MapSharedFile(const std_fs::path& path)
+{
+#if defined(WIN32)
+	(void)path;
+	return nullptr;
+#else
+	if (!DOS_IsSharedMountCacheEnabled()) {
+		return nullptr;
+	}
+	std::error_code ec = {};
+	const auto size = std_fs::file_size(path, ec);
+	const auto write_time = get_write_time(path);
+	if (ec || !write_time || size < SharedFileMinSize || size > UINT32_MAX) {
+		return nullptr;
+	}
+
+	const auto name = find_contents(path, size, *write_time);
+	if (!name) {
+		return nullptr;
+	}
+	if (const auto it = mapped_files.find(*name); it != mapped_files.end()) {
+		if (auto view = it->second.lock()) {
+			return view;
+		}
+	}
+
+	const auto contents_path = cache_dir / "contents" / *name;
+	if (std_fs::file_size(contents_path, ec) != size || ec) {
+		if (!add_contents(path, contents_path)) {
+			LOG_WARNING("DOS: Failed adding '%s' to the shared mount cache",
+			            path.string().c_str());
+			return nullptr;
+		}
+	}
+
+	const auto fd = open(contents_path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return nullptr;
+	}
+	const auto ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (ptr == MAP_FAILED) {
+		return nullptr;
+	}
+	auto view = std::make_shared<const SharedFileView>(static_cast<const uint8_t*>(ptr),
+	                                                   static_cast<size_t>(size));
+	mapped_files[*name] = view;
+	return view;
+#endif
+}
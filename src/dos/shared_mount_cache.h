@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_SHARED_MOUNT_CACHE_H
+#define DOSBOX_SHARED_MOUNT_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "misc/std_filesystem.h"
+
+// Shared mount cache
+// ~~~~~~~~~~~~~~~~~~
+// An on-host cache for read-only mounts that every instance pointed at the
+// same cache directory shares, so instances mounting the same game start
+// warm and hold its files in memory once.
+//
+// Directory listings are kept by the directory's path and modification
+// time. Larger files are kept once per content, named by a hash of it,
+// and mapped read-only, so instances reading the same content share the
+// pages even when they mount different copies of it. Which content a file
+// holds is remembered by its path, size and modification time, so only
+// the first instance hashes it.
+//
+// Everything is written to temporary files that are renamed into place,
+// so instances can fill the cache at the same time. Nothing is ever
+// evicted; the cache directory can be cleared whenever no instance runs.
+
+// An empty directory disables the cache
+void DOS_SetSharedMountCache(const std::string& dir);
+bool DOS_IsSharedMountCacheEnabled();
+
+struct SharedDirEntry {
+	std::string name  = {};
+	bool is_directory = false;
+};
+
+// The listing stored for the host directory, if it hasn't changed since
+std::optional<std::vector<SharedDirEntry>> DOS_LoadSharedDirListing(const std_fs::path& dir);
+
+void DOS_StoreSharedDirListing(const std_fs::path& dir,
+                               const std::vector<SharedDirEntry>& entries);
+
+// Read-only contents of a file, shared with other instances
+class SharedFileView {
+public:
+	SharedFileView(const uint8_t* data, size_t size);
+	~SharedFileView();
+
+	SharedFileView(const SharedFileView&)            = delete;
+	SharedFileView& operator=(const SharedFileView&) = delete;
+
+	const uint8_t* Data() const
+	{
+		return data;
+	}
+	size_t Size() const
+	{
+		return size;
+	}
+
+private:
+	const uint8_t* data = nullptr;
+	size_t size         = 0;
+};
+
+// Files smaller than this are read as usual
+constexpr size_t SharedFileMinSize = 64 * 1024;
+
+// Nothing if the file is too small, the host can't map files, or the
+// content couldn't be added to the cache
+std::shared_ptr<const SharedFileView> DOS_MapSharedFile(const std_fs::path& path);
+
+#endif // DOSBOX_SHARED_MOUNT_CACHE_H
@@ -4,7 +4,9 @@
 
 #include "dosbox.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
@@ -24,6 +26,7 @@
 #include "dos/dos_inc.h"
 #include "dos/dos_locale.h"
 #include "dos/programs.h"
+#include "dos/shared_mount_cache.h"
 #include "gui/common.h"
 #include "gui/mapper.h"
 #include "gui/render.h"
@@ -40,6 +43,8 @@
 #include "midi/midi.h"
 #include "textmode_server/textmode_server.h"
 #include "misc/cross.h"
+#include "misc/footprint.h"
+#include "misc/health_counters.h"
 #include "misc/support.h"
 #include "misc/tracy.h"
 #include "misc/video.h"
@@ -119,13 +124,32 @@ static struct {
 	int64_t done      = {};
 	int64_t scheduled = {};
 	bool locked       = {};
+
+	// Milliseconds of real time the emulation has fallen behind by since
+	// it last had time to spare
+	int64_t behind = {};
 } ticks = {};
 
+static struct {
+	bool enabled     = false;
+	uint64_t elapsed = 0;
+} lockstep = {};
+
 int64_t DOSBOX_GetTicksDone()
 {
 	return ticks.done;
 }
 
+int64_t DOSBOX_GetTicksScheduled()
+{
+	return ticks.scheduled;
+}
+
+int64_t DOSBOX_GetTicksBehind()
+{
+	return ticks.behind;
+}
+
 void DOSBOX_SetTicksDone(const int64_t ticks_done)
 {
 	ticks.done = ticks_done;
@@ -136,6 +160,56 @@ void DOSBOX_SetTicksScheduled(const int64_t ticks_scheduled)
 	ticks.scheduled = ticks_scheduled;
 }
 
+void DOSBOX_ResetTickBase()
+{
+	// Granted ticks are owed to the client regardless of wall-clock time
+	if (!lockstep.enabled) {
+		ticks.remain = 0;
+	}
+	ticks.last      = GetTicks();
+	ticks.added     = 0;
+	ticks.done      = 0;
+	ticks.scheduled = 0;
+	ticks.behind    = 0;
+}
+
+void DOSBOX_SetLockstep(const bool enabled)
+{
+	if (lockstep.enabled == enabled) {
+		return;
+	}
+	lockstep.enabled = enabled;
+	ticks.remain     = 0;
+	ticks.locked     = false;
+
+	// The mixer then consumes audio at the rate emulated time passes
+	// instead of draining it at the audio device's wall-clock rate
+	if (enabled) {
+		LOG_MSG("DOSBOX: Lockstep timing enabled");
+		MIXER_EnableFastForwardMode();
+	} else {
+		MIXER_DisableFastForwardMode();
+	}
+}
+
+bool DOSBOX_IsLockstep()
+{
+	return lockstep.enabled;
+}
+
+uint64_t DOSBOX_GrantTicks(const uint32_t num_ticks)
+{
+	if (lockstep.enabled) {
+		ticks.remain += num_ticks;
+	}
+	return lockstep.elapsed + static_cast<uint64_t>(ticks.remain);
+}
+
+uint64_t DOSBOX_GetLockstepTicks()
+{
+	return lockstep.elapsed;
+}
+
 void Null_Init([[maybe_unused]] Section *sec) {
 	// do nothing
 }
@@ -193,6 +267,9 @@ static Bitu normal_loop()
 			if (ticks.remain > 0) {
 				TIMER_AddTick();
 				--ticks.remain;
+				if (lockstep.enabled) {
+					++lockstep.elapsed;
+				}
 			} else {
 				increase_ticks();
 				return 0;
@@ -203,11 +280,168 @@ static Bitu normal_loop()
 
 constexpr auto auto_cpu_cycles_min = 200;
 
+// Machine-wide counters, plotted per batch of emulated ticks. The event
+// counts are plotted as the number of events since the previous batch.
+static void plot_machine_counters()
+{
+#if C_TRACY
+	static uint64_t last_dynrec_flushes = 0;
+	static uint64_t last_tlb_misses     = 0;
+
+	const auto plot_delta = [](const char* name,
+	                           const PerfCounter& counter,
+	                           uint64_t& last) {
+		const auto value = counter.Value();
+		TracyPlot(name, static_cast<int64_t>(value - last));
+		last = value;
+	};
+	plot_delta("Dynrec blocks invalidated",
+	           health_counters.dynrec_blocks_invalidated,
+	           last_dynrec_flushes);
+	plot_delta("TLB misses", health_counters.tlb_misses, last_tlb_misses);
+
+	TracyPlot("CPU cycles per ms", static_cast<int64_t>(CPU_CycleMax));
+#endif
+}
+
+// Auto cycles controller
+// ~~~~~~~~~~~~~~~~~~~~~~
+// A PI controller on the logarithm of CPU_CycleMax, so that its steps
+// are proportional whatever the current cycles. Each adjustment measures
+// the fraction of the host's time that emulation took over the window
+// (ticks.done, working time with the sleeps subtracted, against
+// ticks.scheduled) and compares it with the target. The target is the
+// 'max' percentage minus 'cpu_cycles_headroom'. The integral term alone
+// would jump straight to the cycles that hit the target, as the old
+// ratio heuristics did. Its gain below 1, plus the damping proportional
+// term, keeps measurement noise from other processes from making the
+// cycles oscillate.
+
+static PerfGauge cycles_utilization("cpu_cycles_utilization_permille",
+                                    "Host time the CPU emulation took over the "
+                                    "last cycles adjustment, in permille.");
+static PerfGauge cycles_error("cpu_cycles_error_permille",
+                              "Cycles controller error (log of target over "
+                              "measured utilization), in permille.");
+
+static double cycles_previous_error = 0.0;
+
+// What the controller regulates towards. The previous error only means
+// something while this stays the same.
+struct AutoCyclesMode {
+	bool auto_adjust = false;
+	int percentage   = 0;
+	int headroom     = 0;
+	int limit        = 0;
+
+	bool operator==(const AutoCyclesMode&) const = default;
+};
+
+// Starts the controller afresh when auto cycles are (re-)enabled, such as
+// after fast-forwarding, or their mode changes, so an error measured
+// against the old target doesn't skew the first adjustment.
+static void maybe_reset_auto_cycles()
+{
+	static AutoCyclesMode last_mode = {};
+
+	const AutoCyclesMode mode = {CPU_CycleAutoAdjust,
+	                             CPU_CyclePercUsed,
+	                             CPU_CycleHeadroom,
+	                             CPU_CycleLimit};
+	if (mode != last_mode) {
+		cycles_previous_error = 0.0;
+		last_mode             = mode;
+	}
+}
+
+static void adjust_auto_cycles()
+{
+	constexpr auto ProportionalGain = 0.3;
+	constexpr auto IntegralGain     = 0.6;
+
+	const auto scheduled = std::max<int64_t>(ticks.scheduled, 1);
+	const auto done      = std::max<int64_t>(ticks.done, 1);
+
+	const auto target = CPU_CyclePercUsed * (100 - CPU_CycleHeadroom) / 1e4;
+	const auto measured = static_cast<double>(done) / static_cast<double>(scheduled);
+
+	// Ignore the cycles added due to the IO delay code in order to have
+	// smoother auto cycle adjustments
+	const auto cproc = static_cast<int64_t>(CPU_CycleMax) * ticks.scheduled;
+	const auto ratio_removed = cproc > 0 ? static_cast<double>(CPU_IODelayRemoved) /
+	                                               static_cast<double>(cproc)
+	                                     : 0.0;
+	if (ratio_removed >= 1.0) {
+		return;
+	}
+	const auto ratio_not_removed = 1.0 - ratio_removed;
+
+	// Spare capacity as a ratio; 1.0 means on target
+	const auto capacity = target * ratio_not_removed / measured;
+
+	// Below 1% means a dropout from a temporary load imbalance, and below
+	// 12% over a long window most likely heavy load from another
+	// application; neither says anything about our own cost
+	if (capacity <= 0.01 || (capacity <= 0.12 && ticks.done >= 700)) {
+		return;
+	}
+
+	// Short windows with very little work done are dominated by timer
+	// resolution, so cap how far those can raise the cycles. When
+	// falling behind repeatedly, make sure the cycles drop noticeably.
+	auto max_capacity = 16.0;
+	if (ticks.scheduled >= 100 && ticks.done < 10 && CPU_CycleMax > 50000) {
+		max_capacity = 5.0;
+	}
+	auto min_capacity = 1.0 / 16;
+	if (ticks.added > 15 && ticks.scheduled >= 5 && ticks.scheduled <= 20) {
+		max_capacity = std::min(max_capacity, 800.0 / 1024);
+	}
+
+	const auto error = std::log(std::clamp(capacity, min_capacity, max_capacity));
+	const auto step = ProportionalGain * (error - cycles_previous_error) +
+	                  IntegralGain * error;
+	cycles_previous_error = error;
+
+	auto new_cycle_max = static_cast<int64_t>(CPU_CycleMax * std::exp(step)) + 1;
+
+	if (CPU_CycleLimit > 0) {
+		new_cycle_max = std::min<int64_t>(new_cycle_max, CPU_CycleLimit);
+	} else {
+		// Hardcoded limit if the limit wasn't explicitly specified
+		new_cycle_max = std::min<int64_t>(new_cycle_max, CpuCyclesMax);
+	}
+	new_cycle_max = std::max<int64_t>(new_cycle_max, auto_cpu_cycles_min);
+
+	cycles_utilization.Set(static_cast<int64_t>(measured * 1000));
+	cycles_error.Set(static_cast<int64_t>(error * 1000));
+	TracyPlot("Cycles controller error", error);
+
+	CPU_CycleMax = static_cast<int>(new_cycle_max);
+}
+
 static void increase_ticks()
 {
 	// Make it return ticks.remain and set it in the function above to
 	// remove the global variable.
 	ZoneScoped;
+	plot_machine_counters();
+	maybe_reset_auto_cycles();
+
+	// In lockstep mode every tick is granted explicitly, so running out
+	// means waiting for the next grant
+	if (lockstep.enabled) {
+		constexpr auto idle_duration = std::chrono::microseconds(1000);
+		std::this_thread::sleep_for(idle_duration);
+
+		// Keep the cycle auto-adjust from reacting to the idle time
+		ticks.last      = GetTicks();
+		ticks.added     = 0;
+		ticks.done      = 0;
+		ticks.scheduled = 0;
+		ticks.behind    = 0;
+		return;
+	}
 
 	// For fast-forward mode
 	if (ticks.locked) {
@@ -218,6 +452,7 @@ static void increase_ticks()
 		ticks.added     = 0;
 		ticks.done      = 0;
 		ticks.scheduled = 0;
+		ticks.behind    = 0;
 		return;
 	}
 
@@ -230,6 +465,9 @@ static void increase_ticks()
 	if (ticks_new <= ticks.last) {
 		ticks.added = 0;
 
+		// Time to spare, so the emulation has caught up
+		ticks.behind = 0;
+
 		static int64_t cumulative_time_slept_us = 0;
 
 		constexpr auto sleep_duration = std::chrono::microseconds(1000);
@@ -271,6 +509,14 @@ static void increase_ticks()
 	ticks.last   = ticks_new;
 	ticks.done += ticks.remain;
 
+	// Emulating the last batch's ticks took this much longer in real time.
+	// Ticks beyond the cap below are never caught up on, so it's bounded
+	// to a second to recover quickly once the load passes.
+	constexpr int64_t MaxTicksBehind = 1000;
+	ticks.behind = std::clamp<int64_t>(ticks.behind + ticks.remain - ticks.added,
+	                                   0,
+	                                   MaxTicksBehind);
+
 	if (ticks.remain > 20) {
 #if 0
 		LOG(LOG_MISC,LOG_ERROR)("large remain %d", ticks.remain);
@@ -288,125 +534,7 @@ static void increase_ticks()
 	if (ticks.scheduled >= 100 || ticks.done >= 100 ||
 	    (ticks.added > 15 && ticks.scheduled >= 5)) {
 
-		if (ticks.done < 1) {
-			// Protect against division by zero.
-			ticks.done = 1;
-		}
-
-		// Ratio we are aiming for is 100% usage
-		auto ratio = (ticks.scheduled * (CPU_CyclePercUsed * 1024 / 100)) /
-		             ticks.done;
-
-		auto new_cycle_max = CPU_CycleMax;
-
-		auto cproc = static_cast<int64_t>(CPU_CycleMax) *
-		             static_cast<int64_t>(ticks.scheduled);
-
-		// Increase scope for logging
-		auto ratio_removed = 0.0;
-
-		// TODO This is full of magic constants with zero explanation.
-		// Where are they coming from, what do the signify, why these
-		// numbers and not some other numbers, etc.--there's lots of
-		// explaining to do here.
-
-		if (cproc > 0) {
-			// Ignore the cycles added due to the IO delay code in
-			// order to have smoother auto cycle adjustments.
-			ratio_removed = static_cast<double>(CPU_IODelayRemoved) /
-			                static_cast<double>(cproc);
-
-			if (ratio_removed < 1.0) {
-				double ratio_not_removed = 1 - ratio_removed;
-				ratio = ifloor(static_cast<double>(ratio) *
-				               ratio_not_removed);
-
-				// Don't allow very high ratios; they can cause
-				// locking as we don't scale down for very low
-				// ratios. High ratios might be the result of
-				// timing resolution.
-				if (ticks.scheduled >= 100 && ticks.done < 10 &&
-				    ratio > 16384) {
-					ratio = 16384;
-				}
-
-				// Limit the ratio even more when the cycles are
-				// already way above the realmode default.
-				if (ticks.scheduled >= 100 && ticks.done < 10 &&
-				    ratio > 5120 && CPU_CycleMax > 50000) {
-					ratio = 5120;
-				}
-
-				// When downscaling multiple times in a row,
-				// ensure a minimum amount of downscaling
-				if (ticks.added > 15 && ticks.scheduled >= 5 &&
-				    ticks.scheduled <= 20 && ratio > 800) {
-					ratio = 800;
-				}
-
-				if (ratio <= 1024) {
-					// Uncommenting the below line restores
-					// the old formula: ratio_not_removed
-					// = 1.0;
-
-					auto r = (1.0 + ratio_not_removed) /
-					         (ratio_not_removed +
-					          1024.0 / (static_cast<double>(ratio)));
-
-					new_cycle_max = static_cast<int>(CPU_CycleMax * r + 1);
-				} else {
-					auto ratio_with_removed = static_cast<int64_t>(
-					        ((static_cast<double>(ratio) - 1024.0) *
-					         ratio_not_removed) +
-					        1024.0);
-
-					auto cmax_scaled = check_cast<int64_t>(
-					        CPU_CycleMax * ratio_with_removed);
-
-					new_cycle_max = static_cast<int>(
-					        1 + (CPU_CycleMax / 2) +
-					        cmax_scaled / 2048LL);
-				}
-			}
-		}
-
-		if (new_cycle_max < auto_cpu_cycles_min) {
-			new_cycle_max = auto_cpu_cycles_min;
-		}
-
-#if 0
-		LOG_INFO("CPU: cycles: curr %7d | new %7d | ratio %5d | done %3d | sched %3d | add %3d | rem %4.2f",
-		         CPU_CycleMax,
-		         new_cycle_max,
-		         ratio,
-		         ticks.done,
-		         ticks.scheduled,
-		         ticks.added,
-		         ratio_removed);
-#endif
-
-		// Ratios below 1% are considered to be dropouts due to
-		// temporary load imbalance, the cycles adjusting is skipped.
-		if (ratio > 10) {
-
-			// Ratios below 12% along with a large time since the
-			// last update has taken place are most likely caused by
-			// heavy load through a different application, the
-			// cycles adjusting is skipped as well.
-			if ((ratio > 120) || (ticks.done < 700)) {
-				CPU_CycleMax = new_cycle_max;
-
-				if (CPU_CycleLimit > 0) {
-					if (CPU_CycleMax > CPU_CycleLimit) {
-						CPU_CycleMax = CPU_CycleLimit;
-					}
-				} else if (CPU_CycleMax > CpuCyclesMax) {
-					// Hardcoded limit if the limit wasn't
-					// explicitly specified.
-					CPU_CycleMax = CpuCyclesMax;
-				}
-			}
-		}
+		adjust_auto_cycles();
 
 		// Reset cycle guessing parameters.
 		CPU_IODelayRemoved = 0;
@@ -447,15 +575,29 @@ void DOSBOX_SetNormalLoop()
 	loop = normal_loop;
 }
 
+static uint32_t run_machine_depth = 0;
+
 void DOSBOX_RunMachine()
 {
+	++run_machine_depth;
 	while ((*loop)() == 0 && !shutdown_requested)
 		;
+	--run_machine_depth;
+}
+
+uint32_t DOSBOX_GetRunMachineDepth()
+{
+	return run_machine_depth;
 }
 
 static void DOSBOX_UnlockSpeed( bool pressed ) {
 	static bool autoadjust = false;
 
+	// Lockstep already runs as fast as the host allows
+	if (lockstep.enabled) {
+		return;
+	}
+
 	if (pressed) {
 		LOG_MSG("Fast Forward ON");
 		ticks.locked = true;
@@ -479,6 +621,19 @@ static void DOSBOX_UnlockSpeed( bool pressed ) {
 	}
 }
 
+bool DOSBOX_SetFastForward(const bool enabled)
+{
+	if (ticks.locked != enabled) {
+		DOSBOX_UnlockSpeed(enabled);
+	}
+	return ticks.locked == enabled;
+}
+
+bool DOSBOX_IsFastForward()
+{
+	return ticks.locked;
+}
+
 void DOSBOX_SetMachineTypeFromConfig(SectionProp* section)
 {
 	const auto arguments = &control->arguments;
@@ -546,6 +701,12 @@ static void DOSBOX_RealInit(Section* sec)
 
 	DOSBOX_SetMachineTypeFromConfig(section);
 
+	// Read before the memory-hungry modules set up
+	if (section->GetString("memory_profile") == "lowmem") {
+		FOOTPRINT_SetProfile(MemoryProfile::Low);
+		LOG_MSG("MEMORY: Using the low memory profile");
+	}
+
 	// Set the user's prefered MCB fault handling strategy
 	DOS_SetMcbFaultStrategy(section->GetString("mcb_fault_strategy").c_str());
 
@@ -571,6 +732,8 @@ static void DOSBOX_RealInit(Section* sec)
 
 	VGA_SetRefreshRateMode(section->GetString("dos_rate"));
 
+	DOS_SetSharedMountCache(section->GetString("shared_mount_cache"));
+
 	// Set the disk IO data rate
 	const auto hdd_io_speed = section->GetString("hard_disk_speed");
 	if (hdd_io_speed == "fast") {
@@ -709,6 +872,32 @@ void DOSBOX_InitAllModuleConfigsAndMessages()
 	        "though a few games might require a higher value.\n"
 	        "There is generally no speed advantage when raising this value.");
 
+	pstring = secprop->AddString("memsize_hugepages", only_at_start, "auto");
+	pstring->SetValues({"auto", "on", "off"});
+	pstring->SetHelp(
+	        "Back the emulated machine's memory with huge host pages ('auto' by default).\n"
+	        "This eases the load on the host's TLB with larger 'memsize' settings.\n"
+	        "  auto:  Ask for transparent huge pages on Linux and large pages on Windows,\n"
+	        "         falling back to normal pages quietly (default).\n"
+	        "  on:    Also try the reserved huge page pool on Linux, and warn if no\n"
+	        "         huge pages could be had.\n"
+	        "  off:   Use normal pages.\n"
+	        "Note: Windows only grants large pages to accounts with the 'Lock pages in\n"
+	        "      memory' privilege. The log reports which kind of pages were used.");
+
+	pstring = secprop->AddString("memory_profile", only_at_start, "normal");
+	pstring->SetValues({"normal", "lowmem"});
+	pstring->SetHelp(
+	        "How to trade speed for host memory ('normal' by default).\n"
+	        "  normal:  Clear large buffers, like the TLB when paging is reset and video\n"
+	        "           memory on a mode change, by writing zeros over them (default).\n"
+	        "  lowmem:  Hand those buffers' pages back to the host instead, so only the\n"
+	        "           pages used since are resident; costs a page fault on each page\n"
+	        "           touched again. Useful when many instances share a host.\n"
+	        "Note: The text-mode server's MEMORY command and 'perf /memory' show where\n"
+	        "      the host memory goes; 'MEMORY TRIM' and 'perf /trim' shrink the caches.\n"
+	        "      Pages are only handed back on Linux.");
+
 	pstring = secprop->AddString("mcb_fault_strategy", only_at_start, "repair");
 	pstring->SetHelp(
 	        "How software-corrupted memory chain blocks should be handled:\n"
@@ -857,6 +1046,16 @@ void DOSBOX_InitAllModuleConfigsAndMessages()
 	        "using a copy-on-write or network-based filesystem, this setting avoids\n"
 	        "triggering write operations for these write-protected files.");
 
+	pstring = secprop->AddString("shared_mount_cache", only_at_start, "");
+	pstring->SetHelp(
+	        "Directory of a cache that instances on this host share for their read-only\n"
+	        "mounts, such as 'mount -ro' directories and CD-ROM directories (unset by\n"
+	        "default). Instances pointed at the same directory keep directory listings\n"
+	        "there, and larger files once per content, mapped into memory read-only, so\n"
+	        "instances mounting the same game start warm and share its memory. The\n"
+	        "directory is created if it doesn't exist, and can be cleared whenever no\n"
+	        "instance is running.");
+
 	pbool = secprop->AddBool("shell_config_shortcuts", when_idle, true);
 	pbool->SetHelp(
 	        "Allow shortcuts for simpler configuration management ('on' by default).\n"
@@ -1182,7 +1381,8 @@ void DOSBOX_InitAllModuleConfigsAndMessages()
 	        "                      (e.g., realport:COM1, realport:ttyS0).\n"
 	        "  - for 'modem':      listenport, sock, bps (all optional).\n"
 	        "  - for 'nullmodem':  server, rxdelay, txdelay, telnet, usedtr,\n"
-	        "                      transparent, port, inhsocket, sock (all optional).\n"
+	        "                      transparent, port, inhsocket, sock, nodelay\n"
+	        "                      (all optional).\n"
 	        "The 'sock' parameter specifies the protocol to use at both sides of the\n"
 	        "connection. Valid values are 0 for TCP, and 1 for ENet reliable UDP.\n"
 	        "Example: serial1=modem listenport:5000 sock:1");
@@ -52,6 +52,11 @@ const char* DOSBOX_GetDetailedVersion() noexcept;
 double DOSBOX_GetUptime();
 
 void DOSBOX_RunMachine();
+
+// How many DOSBOX_RunMachine() calls are active on the host stack. Host-side
+// code such as the shell or a BIOS wait loop nests a machine loop, so two
+// points with different depths have different host frames beneath them.
+uint32_t DOSBOX_GetRunMachineDepth();
 void DOSBOX_SetLoop(LoopHandler * handler);
 void DOSBOX_SetNormalLoop();
 
@@ -60,9 +65,39 @@ void DOSBOX_InitAllModuleConfigsAndMessages(void);
 void DOSBOX_SetMachineTypeFromConfig(SectionProp* section);
 
 int64_t DOSBOX_GetTicksDone();
+int64_t DOSBOX_GetTicksScheduled();
+
+// Milliseconds of real time the emulation has fallen behind by, reset
+// whenever it has time to spare
+int64_t DOSBOX_GetTicksBehind();
 void DOSBOX_SetTicksDone(const int64_t ticks_done);
 void DOSBOX_SetTicksScheduled(const int64_t ticks_scheduled);
 
+// Restarts wall-clock pacing from now, so time spent outside the emulation
+// loop is neither caught up on nor counted against the cycle auto-adjust
+void DOSBOX_ResetTickBase();
+
+// Fast-forward, as toggled by the speed-lock hotkey: emulation runs as fast
+// as the host allows and the mixer squashes the audio to keep up. Returns
+// whether the requested state is in effect; lockstep timing refuses it.
+bool DOSBOX_SetFastForward(bool enabled);
+bool DOSBOX_IsFastForward();
+
+// Lockstep timing
+// ~~~~~~~~~~~~~~~
+// Emulated time stops following the host clock: the machine only runs the
+// ticks granted to it, back to back and as fast as the host allows, and
+// idles between grants. Runs are then reproducible regardless of host load.
+void DOSBOX_SetLockstep(bool enabled);
+bool DOSBOX_IsLockstep();
+
+// Hands the machine another 'num_ticks' milliseconds to run. Returns the
+// DOSBOX_GetLockstepTicks() value at which all granted ticks will have run.
+uint64_t DOSBOX_GrantTicks(uint32_t num_ticks);
+
+// Ticks run in lockstep so far
+uint64_t DOSBOX_GetLockstepTicks();
+
 enum class MachineType {
 	// Value not set yet
 	None,
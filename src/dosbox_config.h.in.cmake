@@ -61,6 +61,10 @@
 // TODO Define to 1 to use inlined memory functions in cpu core
 #define C_CORE_INLINE 1
 
+// Define to 1 to dispatch the normal core's opcodes through a computed-goto
+// table instead of a switch (ignored by compilers without labels as values)
+#cmakedefine01 C_CORE_THREADED
+
 
 // Emulator features
 //
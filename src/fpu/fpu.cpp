@@ -18,11 +18,33 @@ void FPU_FLDCW(PhysPt addr){
 	FPU_SetCW(temp);
 }
 
+#if !C_FPU_X86
+// The instructions only keep track of which registers are empty; whether a
+// register holds zero or a special value is worked out from its contents
+// when the guest actually reads the tag word.
+static FPU_Tag classify_register(const uint8_t reg)
+{
+	if (fpu.tags[reg] == TAG_Empty) {
+		return TAG_Empty;
+	}
+	switch (std::fpclassify(fpu.regs[reg].d)) {
+	case FP_ZERO: return TAG_Zero;
+	case FP_NORMAL: return TAG_Valid;
+	default: return TAG_Weird;
+	}
+}
+#endif
+
 uint16_t FPU_GetTag()
 {
 	uint16_t tag = 0;
-	for (int i = 0; i < 8; i++) {
-		tag |= ((fpu.tags[i] & 3) << (2 * i));
+	for (uint8_t i = 0; i < 8; i++) {
+#if C_FPU_X86
+		const auto reg_tag = fpu.tags[i];
+#else
+		const auto reg_tag = classify_register(i);
+#endif
+		tag |= ((reg_tag & 3) << (2 * i));
 	}
 	return tag;
 }
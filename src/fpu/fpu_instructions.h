@@ -433,18 +433,25 @@ static void FPU_FST(Bitu st, Bitu other){
 }
 
 static void FPU_FCOM(Bitu st, Bitu other){
-	if(((fpu.tags[st] != TAG_Valid) && (fpu.tags[st] != TAG_Zero)) || 
-		((fpu.tags[other] != TAG_Valid) && (fpu.tags[other] != TAG_Zero))){
-		FPU_SET_C3(1);FPU_SET_C2(1);FPU_SET_C0(1);return;
+	constexpr uint16_t C0 = 0x0100;
+	constexpr uint16_t C2 = 0x0400;
+	constexpr uint16_t C3 = 0x4000;
+
+	const auto a = fpu.regs[st].d;
+	const auto b = fpu.regs[other].d;
+
+	// Set all three condition codes with a single update of the status
+	// word; empty registers and NaNs compare as unordered
+	uint16_t codes = 0;
+	if (fpu.tags[st] == TAG_Empty || fpu.tags[other] == TAG_Empty ||
+	    std::isunordered(a, b)) {
+		codes = C3 | C2 | C0;
+	} else if (a == b) {
+		codes = C3;
+	} else if (a < b) {
+		codes = C0;
 	}
-	if(fpu.regs[st].d == fpu.regs[other].d){
-		FPU_SET_C3(1);FPU_SET_C2(0);FPU_SET_C0(0);return;
-	}
-	if(fpu.regs[st].d < fpu.regs[other].d){
-		FPU_SET_C3(0);FPU_SET_C2(0);FPU_SET_C0(1);return;
-	}
-	// st > other
-	FPU_SET_C3(0);FPU_SET_C2(0);FPU_SET_C0(0);return;
+	fpu.sw = static_cast<uint16_t>((fpu.sw & ~(C3 | C2 | C0)) | codes);
 }
 
 static void FPU_FUCOM(Bitu st, Bitu other){
@@ -651,7 +658,6 @@ static void FPU_FLDLN2(void){
 static void FPU_FLDZ(void){
 	FPU_PREP_PUSH();
 	fpu.regs[TOP].d = 0.0;
-	fpu.tags[TOP]   = TAG_Zero;
 }
 
 
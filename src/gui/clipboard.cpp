@@ -3,7 +3,10 @@
 
 #include "gui/clipboard.h"
 
+#include <vector>
+
 #include "config/config.h"
+#include "ints/bios.h"
 #include "misc/logging.h"
 #include "misc/unicode.h"
 #include "utils/checks.h"
@@ -146,3 +149,39 @@ std::string CLIPBOARD_PasteText(const uint16_t code_page)
 	                   UnicodeFallback::Simple,
 	                   code_page);
 }
+
+bool CLIPBOARD_PasteIntoGuest()
+{
+	if (!CLIPBOARD_HasText()) {
+		return false;
+	}
+	if (BIOS_IsKeyboardIrqHooked()) {
+		// The program reads the keyboard port itself and would never
+		// see the buffer
+		LOG_WARNING("CLIPBOARD: The program reads the keyboard directly, can't paste");
+		return false;
+	}
+
+	// Converted to the current code page once, as a whole
+	const auto text = replace_eol(CLIPBOARD_PasteText(), "\n");
+
+	std::vector<uint16_t> codes = {};
+	codes.reserve(text.size());
+	for (const auto character : text) {
+		const auto byte = static_cast<uint8_t>(character);
+		if (const auto code = BIOS_GetKeyCodeForChar(character); code != 0) {
+			codes.push_back(code);
+		} else if (byte >= 0x80) {
+			// National characters have no key on the US layout; pass
+			// them without a scan code, as typing them with Alt and the
+			// numeric keypad does
+			codes.push_back(byte);
+		}
+	}
+
+	if (!BIOS_QueueKeys(codes)) {
+		LOG_WARNING("CLIPBOARD: Too much text queued to paste");
+		return false;
+	}
+	return true;
+}
@@ -17,4 +17,9 @@ void CLIPBOARD_CopyText(const std::string& content, const uint16_t code_page);
 std::string CLIPBOARD_PasteText();
 std::string CLIPBOARD_PasteText(const uint16_t code_page);
 
+// Types the text into the guest through the BIOS keyboard buffer, as fast as
+// the running program reads it; returns false if there was nothing to paste
+// or it couldn't be queued
+bool CLIPBOARD_PasteIntoGuest();
+
 #endif // DOSBOX_CLIPBOARD_H
@@ -34,6 +34,9 @@ double GFX_GetHostRefreshRate();
 
 PresentationMode GFX_GetPresentationMode();
 
+// Whether DOSBox was started with --headless
+bool GFX_IsHeadless();
+
 void GFX_MaybePresentFrame();
 
 bool DOSBOX_PollAndHandleEvents();
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText:  2002-2021 The DOSBox Team
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "gui/private/scaler_pixels.h"
 #include "utils/mem_unaligned.h"
 
 #if SCALER_MAX_MUL_HEIGHT < SCALERHEIGHT
@@ -70,6 +71,19 @@ static void conc4d(SCALERNAME,SBPP,DBPP,R)(const void *s) {
 #endif
 #endif //defined(SCALERLINEAR)
 			hadChange = 1;
+#if defined(PRUN)
+			const auto run = static_cast<size_t>(x > 32 ? 32 : x);
+			std::memcpy(cache, src, run * sizeof(SRCTYPE));
+			PRUN(reinterpret_cast<uint8_t*>(line0), src, run);
+#if (SCALERHEIGHT > 1)
+			std::memcpy(line1, line0, run * SCALERWIDTH * PSIZE);
+			line1 += run * SCALERWIDTH;
+#endif
+			src += run;
+			cache += run;
+			line0 += run * SCALERWIDTH;
+			x -= static_cast<Bits>(run);
+#else
 			for (Bitu i = x > 32 ? 32 : x;i>0;i--,x--) {
 				const SRCTYPE S = *src;
 				*cache = S;
@@ -81,6 +95,7 @@ static void conc4d(SCALERNAME,SBPP,DBPP,R)(const void *s) {
 				line1 += SCALERWIDTH;
 #endif
 			}
+#endif // defined(PRUN)
 #if defined(SCALERLINEAR)
 #if (SCALERHEIGHT > 1)
 			Bitu copyLen = (Bitu)((uint8_t*)line1 - (uint8_t*)WC[0]);
@@ -188,6 +188,23 @@
 #	define SRCTYPE uint32_t
 #endif
 
+// Changed runs of the common sources are drawn to 32-bit output by the
+// kernels in scaler_pixels.h rather than a pixel at a time through PMAKE
+#if DBPP == 32 && !defined(WORDS_BIGENDIAN)
+#	if SBPP == 8 || SBPP == 9
+#		define PRUN(_DST, _SRC, _NUM) \
+			scale_indexed_to_32<SCALERWIDTH>(_DST, _SRC, _NUM, render.pal.lut.b32)
+#	elif SBPP == 15
+#		define PRUN(_DST, _SRC, _NUM) \
+			scale_packed16_to_32<SCALERWIDTH, false>(_DST, _SRC, _NUM)
+#	elif SBPP == 16
+#		define PRUN(_DST, _SRC, _NUM) \
+			scale_packed16_to_32<SCALERWIDTH, true>(_DST, _SRC, _NUM)
+#	elif SBPP == 32
+#		define PRUN(_DST, _SRC, _NUM) scale_32_to_32<SCALERWIDTH>(_DST, _SRC, _NUM)
+#	endif
+#endif
+
 //  C0 C1 C2 D3
 //  C3 C4 C5 D4
 //  C6 C7 C8 D5
@@ -270,6 +287,7 @@
 #undef PSIZE
 #undef PTYPE
 #undef PMAKE
+#undef PRUN
 #undef WC
 #undef LC
 #undef FC
@@ -0,0 +1,198 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_SCALER_PIXELS_H
+#define DOSBOX_SCALER_PIXELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "simde/x86/sse2.h"
+#include "utils/mem_unaligned.h"
+
+// Scaler pixel runs
+// ~~~~~~~~~~~~~~~~~
+// Turns a run of changed source pixels into 32-bit output pixels, drawing
+// each one once or, for double-wide modes, twice. These are the paths
+// nearly every frame takes, as the output is 32-bit on all backends:
+//
+//   - Indexed 8-bit pixels are looked up in the palette one at a time, as
+//     SSE2 has no gather, but stored (and doubled) four at a time.
+//
+//   - RGB555 and RGB565 pixels are widened eight at a time, replicating
+//     the top bits of each channel into the bottom ones exactly like the
+//     scalers' PMAKE macros.
+//
+//   - 32-bit pixels are copied, or doubled four at a time.
+//
+// simde maps the SSE2 intrinsics to NEON on ARM hosts. The scalar versions
+// are the references they're tested against, and also draw the odd pixels
+// at the end of each run.
+
+template <int Width>
+static inline void store_scaled_pixel(uint8_t* const dst, const uint32_t pixel)
+{
+	static_assert(Width == 1 || Width == 2);
+	for (auto i = 0; i < Width; ++i) {
+		write_unaligned_uint32_at(dst, i, pixel);
+	}
+}
+
+template <int Width>
+static inline void store_scaled_pixels(uint8_t* const dst, const simde__m128i pixels)
+{
+	static_assert(Width == 1 || Width == 2);
+	if constexpr (Width == 1) {
+		simde_mm_storeu_si128(reinterpret_cast<simde__m128i*>(dst), pixels);
+	} else {
+		simde_mm_storeu_si128(reinterpret_cast<simde__m128i*>(dst),
+		                      simde_mm_unpacklo_epi32(pixels, pixels));
+		simde_mm_storeu_si128(reinterpret_cast<simde__m128i*>(dst + 16),
+		                      simde_mm_unpackhi_epi32(pixels, pixels));
+	}
+}
+
+// xRRRrrGGGggBBBbb -> RRRrrRRRGGGggGGGBBBbbBBB
+constexpr uint32_t rgb555_to_32(const uint32_t v)
+{
+	return ((v & (31 << 10)) << 9) | ((v & (31 << 5)) << 6) | ((v & 31) << 3) |
+	       ((v & (7 << 12)) << 4) | ((v & (7 << 7)) << 1) | ((v & (7 << 2)) >> 2);
+}
+
+// RRRrrGGggggBBBbb -> RRRrrRRRGGggggGGBBBbbBBB
+constexpr uint32_t rgb565_to_32(const uint32_t v)
+{
+	return ((v & (31 << 11)) << 8) | ((v & (63 << 5)) << 5) | ((v & 0xe01f) << 3) |
+	       ((v & (3 << 9)) >> 1) | ((v & (7 << 2)) >> 2);
+}
+
+// The same, on four pixels held in the low half of each 32-bit lane
+static inline simde__m128i rgb555_to_32(const simde__m128i v)
+{
+	const auto bits = [&](const int32_t mask) {
+		return simde_mm_and_si128(v, simde_mm_set1_epi32(mask));
+	};
+	auto p = simde_mm_slli_epi32(bits(31 << 10), 9);
+	p = simde_mm_or_si128(p, simde_mm_slli_epi32(bits(31 << 5), 6));
+	p = simde_mm_or_si128(p, simde_mm_slli_epi32(bits(31), 3));
+	p = simde_mm_or_si128(p, simde_mm_slli_epi32(bits(7 << 12), 4));
+	p = simde_mm_or_si128(p, simde_mm_slli_epi32(bits(7 << 7), 1));
+	return simde_mm_or_si128(p, simde_mm_srli_epi32(bits(7 << 2), 2));
+}
+
+static inline simde__m128i rgb565_to_32(const simde__m128i v)
+{
+	const auto bits = [&](const int32_t mask) {
+		return simde_mm_and_si128(v, simde_mm_set1_epi32(mask));
+	};
+	auto p = simde_mm_slli_epi32(bits(31 << 11), 8);
+	p = simde_mm_or_si128(p, simde_mm_slli_epi32(bits(63 << 5), 5));
+	p = simde_mm_or_si128(p, simde_mm_slli_epi32(bits(0xe01f), 3));
+	p = simde_mm_or_si128(p, simde_mm_srli_epi32(bits(3 << 9), 1));
+	return simde_mm_or_si128(p, simde_mm_srli_epi32(bits(7 << 2), 2));
+}
+
+template <int Width>
+static inline void scale_indexed_to_32(uint8_t* dst, const uint8_t* src,
+                                       const size_t num_pixels,
+                                       const uint32_t* const palette)
+{
+	constexpr auto StepBytes = 4 * Width * sizeof(uint32_t);
+
+	size_t i = 0;
+	for (; i + 4 <= num_pixels; i += 4, dst += StepBytes) {
+		const auto pixels = simde_mm_set_epi32(static_cast<int32_t>(palette[src[i + 3]]),
+		                                       static_cast<int32_t>(palette[src[i + 2]]),
+		                                       static_cast<int32_t>(palette[src[i + 1]]),
+		                                       static_cast<int32_t>(palette[src[i]]));
+		store_scaled_pixels<Width>(dst, pixels);
+	}
+	for (; i < num_pixels; ++i, dst += Width * sizeof(uint32_t)) {
+		store_scaled_pixel<Width>(dst, palette[src[i]]);
+	}
+}
+
+template <int Width, bool IsRgb565>
+static inline void scale_packed16_to_32(uint8_t* dst, const uint16_t* src,
+                                        const size_t num_pixels)
+{
+	constexpr auto StepBytes = 8 * Width * sizeof(uint32_t);
+
+	const auto to_32 = [](const auto v) {
+		if constexpr (IsRgb565) {
+			return rgb565_to_32(v);
+		} else {
+			return rgb555_to_32(v);
+		}
+	};
+
+	const auto zero = simde_mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 8 <= num_pixels; i += 8, dst += StepBytes) {
+		const auto v = simde_mm_loadu_si128(
+		        reinterpret_cast<const simde__m128i*>(src + i));
+		store_scaled_pixels<Width>(dst, to_32(simde_mm_unpacklo_epi16(v, zero)));
+		store_scaled_pixels<Width>(dst + StepBytes / 2,
+		                           to_32(simde_mm_unpackhi_epi16(v, zero)));
+	}
+	for (; i < num_pixels; ++i, dst += Width * sizeof(uint32_t)) {
+		store_scaled_pixel<Width>(dst, to_32(static_cast<uint32_t>(src[i])));
+	}
+}
+
+template <int Width>
+static inline void scale_32_to_32(uint8_t* dst, const uint32_t* src,
+                                  const size_t num_pixels)
+{
+	if constexpr (Width == 1) {
+		std::memcpy(dst, src, num_pixels * sizeof(uint32_t));
+	} else {
+		constexpr auto StepBytes = 4 * Width * sizeof(uint32_t);
+
+		size_t i = 0;
+		for (; i + 4 <= num_pixels; i += 4, dst += StepBytes) {
+			store_scaled_pixels<Width>(dst,
+			                           simde_mm_loadu_si128(
+			                                   reinterpret_cast<const simde__m128i*>(
+			                                           src + i)));
+		}
+		for (; i < num_pixels; ++i, dst += Width * sizeof(uint32_t)) {
+			store_scaled_pixel<Width>(dst, src[i]);
+		}
+	}
+}
+
+// The references: one pixel at a time
+template <int Width>
+static inline void scale_indexed_to_32_scalar(uint8_t* dst, const uint8_t* src,
+                                              const size_t num_pixels,
+                                              const uint32_t* const palette)
+{
+	for (size_t i = 0; i < num_pixels; ++i, dst += Width * sizeof(uint32_t)) {
+		store_scaled_pixel<Width>(dst, palette[src[i]]);
+	}
+}
+
+template <int Width, bool IsRgb565>
+static inline void scale_packed16_to_32_scalar(uint8_t* dst, const uint16_t* src,
+                                               const size_t num_pixels)
+{
+	for (size_t i = 0; i < num_pixels; ++i, dst += Width * sizeof(uint32_t)) {
+		store_scaled_pixel<Width>(dst,
+		                          IsRgb565 ? rgb565_to_32(src[i])
+		                                   : rgb555_to_32(src[i]));
+	}
+}
+
+template <int Width>
+static inline void scale_32_to_32_scalar(uint8_t* dst, const uint32_t* src,
+                                         const size_t num_pixels)
+{
+	for (size_t i = 0; i < num_pixels; ++i, dst += Width * sizeof(uint32_t)) {
+		store_scaled_pixel<Width>(dst, src[i]);
+	}
+}
+
+#endif // DOSBOX_SCALER_PIXELS_H
@@ -8,6 +8,7 @@
 
 #include "SDL.h"
 
+#include <array>
 #include <cstring>
 #include <optional>
 #include <string>
@@ -131,6 +132,11 @@ struct SDL_Block {
 	bool resizing_window = false;
 	bool wait_on_error   = false;
 
+	// Started with --headless: the window lives on SDL's 'dummy' driver,
+	// frames are only rendered when a capture or GETIMG asks for one, and
+	// nothing is ever presented
+	bool headless = false;
+
 	uint32_t start_event_id = UINT32_MAX;
 
 #ifdef WIN32
@@ -151,6 +157,11 @@ struct SDL_Block {
 		GFX_Callback_t callback = nullptr;
 		bool width_was_doubled  = false;
 		bool height_was_doubled = false;
+
+		// Rows of the last frame the texture hasn't been updated with
+		// yet, as a half-open range that's empty when first >= last
+		int first_dirty_row = 0;
+		int last_dirty_row  = 0;
 	} draw = {};
 
 	// The DOS video mode is populated after we set up the SDL window.
@@ -230,6 +241,13 @@ struct SDL_Block {
 		int texture_width_px  = 0;
 		int texture_height_px = 0;
 
+		// Pixel unpack buffers the dirty rows are streamed through, used
+		// round-robin so the driver can still be reading from the
+		// previous frames' while the next one is being written
+		std::array<GLuint, 3> pixel_buffers = {};
+		size_t next_pixel_buffer            = 0;
+		size_t pixel_buffer_bytes           = 0;
+
 		ShaderInfo shader_info    = {};
 		std::string shader_source = {};
 
@@ -253,6 +271,11 @@ struct SDL_Block {
 	bool mute_when_inactive  = false;
 	bool pause_when_inactive = false;
 
+	// The host's events are pumped at most this often, unless some are
+	// already queued; zero pumps them on every pass of the main loop
+	int64_t event_poll_interval_us = 0;
+	int64_t last_event_poll_us     = 0;
+
 	SDL_Rect draw_rect_px     = {};
 	SDL_Window* window        = nullptr;
 	SDL_Renderer* renderer    = nullptr;
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_SHADER_CACHE_H
+#define DOSBOX_SHADER_CACHE_H
+
+#include "dosbox.h"
+
+#if C_OPENGL
+
+#include "glad/gl.h"
+
+#include <string>
+
+// Persistent shader program cache
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Keeps the driver's linked program binaries (GL_ARB_get_program_binary)
+// under 'shader-cache' in the config directory, named after a hash of the
+// shader source and the GL vendor, renderer and version strings. A driver
+// update changes the key, and anything the driver refuses to load is
+// deleted and rebuilt from source. Without the extension every call is a
+// no-op and programs are always compiled.
+//
+// All functions need the GL context the program belongs to to be current.
+
+// A linked program for 'source' from the cache, or 0 if none is usable
+GLuint SHADERCACHE_LoadProgram(const std::string& source);
+
+// Asks the driver to keep the binary retrievable; call before linking
+void SHADERCACHE_PrepareProgram(GLuint program);
+
+// Saves a successfully linked program for the next run
+void SHADERCACHE_StoreProgram(const std::string& source, GLuint program);
+
+#endif // C_OPENGL
+
+#endif // DOSBOX_SHADER_CACHE_H
@@ -9,8 +9,10 @@
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "capture/capture.h"
 #include "config/config.h"
@@ -19,9 +21,13 @@
 #include "gui/mapper.h"
 #include "gui/render.h"
 #include "hardware/video/vga.h"
+#include "misc/footprint.h"
+#include "misc/health_counters.h"
 #include "misc/support.h"
+#include "misc/tracy.h"
 #include "misc/video.h"
 #include "shell/shell.h"
+#include "textmode_server/textmode_server.h"
 #include "utils/fraction.h"
 #include "utils/math_utils.h"
 #include "utils/string_utils.h"
@@ -29,6 +35,18 @@
 Render render;
 ScalerLineHandler_t RENDER_DrawLine;
 
+// The scalers keep the last frame's source lines to find the changed ones.
+// A trimmed cache is rebuilt by the next frame, which is drawn in full.
+static void trim_scaler_cache()
+{
+	FOOTPRINT_ReleasePages(&scalerSourceCache, sizeof(scalerSourceCache));
+	render.scale.clearCache = true;
+}
+
+static FootprintRegion scaler_cache_region("scaler_source_cache",
+                                           "The scalers' copy of the last frame.",
+                                           trim_scaler_cache);
+
 static void render_callback(GFX_CallbackFunctions_t function);
 
 static void check_palette()
@@ -98,6 +116,43 @@ void RENDER_SetPalette(const uint8_t entry, const uint8_t red,
 
 static void empty_line_handler(const void*) {}
 
+// Set while the last frame started didn't reach the screen in full
+static bool is_frame_incomplete = true;
+
+// Adaptive frame skipping
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// With 'auto_frameskip' on, whole frames aren't drawn while the emulation
+// is behind real time by more than the threshold, so the host's time goes
+// to the CPU emulation and audio instead. The VGA keeps its retrace timing
+// and the text-mode server keeps latching its snapshots; only the line
+// drawing, scaling and presenting of the frame are skipped. Every few
+// frames one is drawn regardless to keep the picture moving, and frames
+// someone waits for (captures and rendered screenshots) are never skipped.
+
+constexpr int64_t FrameSkipTicksBehind = 50;
+constexpr int MaxFramesSkippedInRow    = 4;
+
+static struct {
+	bool enabled              = false;
+	int frames_skipped_in_row = 0;
+} frame_skip = {};
+
+static bool is_frame_skipped()
+{
+	if (!frame_skip.enabled || CAPTURE_IsCapturingImage() ||
+	    CAPTURE_IsCapturingVideo() || TEXTMODESERVER_IsRenderedFrameRequested()) {
+		frame_skip.frames_skipped_in_row = 0;
+		return false;
+	}
+	if (DOSBOX_GetTicksBehind() <= FrameSkipTicksBehind ||
+	    frame_skip.frames_skipped_in_row >= MaxFramesSkippedInRow) {
+		frame_skip.frames_skipped_in_row = 0;
+		return false;
+	}
+	++frame_skip.frames_skipped_in_row;
+	return true;
+}
+
 static void start_line_handler(const void* s)
 {
 	if (s) {
@@ -109,7 +164,8 @@ static void start_line_handler(const void* s)
 			if (src_val != cache[0]) {
 				if (!GFX_StartUpdate(render.scale.outWrite,
 				                     render.scale.outPitch)) {
-					RENDER_DrawLine = empty_line_handler;
+					RENDER_DrawLine     = empty_line_handler;
+					is_frame_incomplete = true;
 					return;
 				}
 				render.scale.outWrite += render.scale.outPitch *
@@ -157,12 +213,34 @@ static void clear_cache_handler(const void* src)
 
 bool RENDER_StartUpdate()
 {
+	ZoneScoped;
+
 	if (render.updating) {
+		health_counters.frames_dropped.Add();
+		is_frame_incomplete = true;
 		return false;
 	}
 	if (!render.active) {
+		is_frame_incomplete = true;
+		return false;
+	}
+	if (is_frame_skipped()) {
+		health_counters.frames_skipped.Add();
+		is_frame_incomplete = true;
 		return false;
 	}
+	is_frame_incomplete = false;
+	if (GFX_IsHeadless() && !CAPTURE_IsCapturingImage() &&
+	    !CAPTURE_IsCapturingVideo() && !TEXTMODESERVER_IsRenderedFrameRequested()) {
+		// Nobody will look at this frame. Let the VGA walk its lines so
+		// its per-frame state stays current, but skip the scalers, and
+		// rebuild the whole cache for the next frame someone does want.
+		RENDER_DrawLine         = empty_line_handler;
+		render.scale.outWrite   = nullptr;
+		render.scale.clearCache = true;
+		render.updating         = true;
+		return true;
+	}
 	if (render.scale.inMode == scalerMode8) {
 		check_palette();
 	}
@@ -182,6 +260,8 @@ bool RENDER_StartUpdate()
 		// Will always have to update the screen with this one anyway,
 		// so let's update already
 		if (!GFX_StartUpdate(render.scale.outWrite, render.scale.outPitch)) {
+			health_counters.frames_dropped.Add();
+			is_frame_incomplete = true;
 			return false;
 		}
 		render.fullFrame        = true;
@@ -193,6 +273,8 @@ bool RENDER_StartUpdate()
 			// anyway
 			if (!GFX_StartUpdate(render.scale.outWrite,
 			                     render.scale.outPitch)) {
+				health_counters.frames_dropped.Add();
+				is_frame_incomplete = true;
 				return false;
 			}
 			RENDER_DrawLine  = render.scale.linePalHandler;
@@ -200,7 +282,8 @@ bool RENDER_StartUpdate()
 		} else {
 			RENDER_DrawLine = start_line_handler;
 			if (CAPTURE_IsCapturingImage() ||
-			    CAPTURE_IsCapturingVideo()) {
+			    CAPTURE_IsCapturingVideo() ||
+			    TEXTMODESERVER_IsRenderedFrameRequested()) {
 				render.fullFrame = true;
 			} else {
 				render.fullFrame = false;
@@ -211,6 +294,20 @@ bool RENDER_StartUpdate()
 	return true;
 }
 
+bool RENDER_IsNextFrameNeeded()
+{
+	if (is_frame_incomplete || CAPTURE_IsCapturingImage() ||
+	    CAPTURE_IsCapturingVideo() || TEXTMODESERVER_IsRenderedFrameRequested()) {
+		return true;
+	}
+	// Headless frames nobody asked for are never shown; they leave the
+	// cache and palette updates to the next frame that's wanted
+	if (GFX_IsHeadless()) {
+		return false;
+	}
+	return render.scale.clearCache || render.pal.changed;
+}
+
 static void halt_render()
 {
 	RENDER_DrawLine = empty_line_handler;
@@ -219,15 +316,99 @@ static void halt_render()
 	render.active   = false;
 }
 
+namespace {
+
+// A shared image's pixel and palette data live in one pooled buffer
+struct SharedImage {
+	RenderedImage image = {};
+
+	std::vector<uint8_t> bytes = {};
+};
+
+// Held by a shared pointer, so the last holder of an image can still
+// return its buffer during shutdown
+struct SharedImagePool {
+	std::mutex mutex = {};
+
+	std::vector<std::vector<uint8_t>> free_buffers = {};
+};
+
+} // namespace
+
+// Enough for a few frames held by each consumer
+constexpr size_t MaxPooledImageBuffers = 8;
+
+static const auto shared_image_pool = std::make_shared<SharedImagePool>();
+
+SharedRenderedImage RENDER_ShareImage(const RenderedImage& image)
+{
+	assert(image.image_data);
+
+	const auto image_num_bytes = static_cast<size_t>(image.params.height) *
+	                             image.pitch;
+
+	// TODO it's bad that we need to make this assumption downstream on
+	// the size and alignment of the palette...
+	constexpr size_t PaletteNumBytes = 256 * 4;
+	const auto palette_num_bytes = image.palette_data ? PaletteNumBytes : 0;
+
+	auto shared = std::make_unique<SharedImage>();
+	{
+		std::lock_guard lock(shared_image_pool->mutex);
+		auto& free_buffers = shared_image_pool->free_buffers;
+		if (!free_buffers.empty()) {
+			shared->bytes = std::move(free_buffers.back());
+			free_buffers.pop_back();
+		}
+	}
+	shared->bytes.resize(image_num_bytes + palette_num_bytes);
+
+	shared->image            = image;
+	shared->image.image_data = shared->bytes.data();
+	std::memcpy(shared->image.image_data, image.image_data, image_num_bytes);
+
+	if (image.palette_data) {
+		shared->image.palette_data = shared->bytes.data() + image_num_bytes;
+		std::memcpy(shared->image.palette_data,
+		            image.palette_data,
+		            palette_num_bytes);
+	}
+
+	const auto recycle = [pool = shared_image_pool](SharedImage* released) {
+		{
+			std::lock_guard lock(pool->mutex);
+			if (pool->free_buffers.size() < MaxPooledImageBuffers) {
+				pool->free_buffers.push_back(std::move(released->bytes));
+			}
+		}
+		delete released;
+	};
+	const auto image_pt = &shared->image;
+	return {std::shared_ptr<SharedImage>(shared.release(), recycle), image_pt};
+}
+
+SharedRenderedImage RENDER_AdoptImage(const RenderedImage& image)
+{
+	return std::shared_ptr<RenderedImage>(new RenderedImage(image),
+	                                      [](RenderedImage* adopted) {
+		                                      adopted->free();
+		                                      delete adopted;
+	                                      });
+}
+
 void RENDER_EndUpdate(bool abort)
 {
 	if (!render.updating) {
 		return;
 	}
+	ZoneScoped;
 
 	RENDER_DrawLine = empty_line_handler;
 
-	if (CAPTURE_IsCapturingImage() || CAPTURE_IsCapturingVideo()) {
+	const bool is_capturing = CAPTURE_IsCapturingImage() || CAPTURE_IsCapturingVideo();
+	const bool is_frame_requested = TEXTMODESERVER_IsRenderedFrameRequested();
+
+	if (is_capturing || is_frame_requested) {
 		bool double_width  = false;
 		bool double_height = false;
 		if (render.src.double_width != render.src.double_height) {
@@ -250,11 +431,27 @@ void RENDER_EndUpdate(bool abort)
 
 		const auto frames_per_second = static_cast<float>(render.fps);
 
-		CAPTURE_AddFrame(image, frames_per_second);
+		// The frame's consumers that keep it all share one copy
+		const bool is_image_kept = CAPTURE_IsCapturingImage() ||
+		                           (is_frame_requested && !abort);
+		const auto shared_image = is_image_kept ? RENDER_ShareImage(image)
+		                                        : SharedRenderedImage{};
+		if (is_capturing) {
+			CAPTURE_AddFrame(image, shared_image, frames_per_second);
+		}
+		if (is_frame_requested && !abort) {
+			TEXTMODESERVER_OnRenderedFrame(shared_image);
+		}
 	}
 
+	if (abort) {
+		is_frame_incomplete = true;
+	}
 	if (render.scale.outWrite) {
 		GFX_EndUpdate(abort ? nullptr : Scaler_ChangedLines);
+		if (!abort && !GFX_IsHeadless()) {
+			health_counters.frames_presented.Add();
+		}
 	} else {
 		// If we made it here, then there's nothing new to render.
 		GFX_EndUpdate(nullptr);
@@ -1092,7 +1289,15 @@ static void init_render_settings(SectionProp& secprop)
 
 	auto* int_prop = secprop.AddInt("frameskip", Deprecated, 0);
 	int_prop->SetHelp(
-	        "Consider capping frame rates using the 'host_rate' setting.");
+	        "Consider capping frame rates using the 'host_rate' setting, or\n"
+	        "'auto_frameskip' on hosts that can't keep up.");
+
+	auto* bool_prop = secprop.AddBool("auto_frameskip", Always, false);
+	bool_prop->SetHelp(
+	        "Skip drawing whole frames while the emulation falls behind real time\n"
+	        "('off' by default). This keeps the CPU emulation and audio running\n"
+	        "smoothly on hosts that can't keep up, at the cost of a choppier picture.\n"
+	        "Skipped frames are counted as 'frames_skipped' in the statistics.");
 
 	auto* string_prop = secprop.AddString("glshader", Always, "crt-auto");
 	string_prop->SetOptionHelp(
@@ -1447,6 +1652,8 @@ static void render_init(Section* sec)
 	render.pal.first = 256;
 	render.pal.last  = 0;
 
+	scaler_cache_region.Track(&scalerSourceCache, sizeof(scalerSourceCache));
+
 	// Get aspect ratio correction mode & force square pixels if requested
 	aspect_ratio_correction_mode = get_aspect_ratio_correction_mode_setting();
 
@@ -1467,6 +1674,8 @@ static void render_init(Section* sec)
 	// Only use the default 1x rendering scaler
 	render.scale.size = 1;
 
+	frame_skip.enabled = section->GetBool("auto_frameskip");
+
 	auto shader_changed = handle_shader_changes();
 
 	setup_scan_and_pixel_doubling();
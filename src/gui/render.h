@@ -6,6 +6,7 @@
 
 #include <cstring>
 #include <deque>
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -157,30 +158,6 @@ struct RenderedImage {
 		return (params.pixel_format == PixelFormat::Indexed8);
 	}
 
-	RenderedImage deep_copy() const
-	{
-		RenderedImage copy = *this;
-
-		// Deep-copy image and palette data
-		const auto image_data_num_bytes = static_cast<uint32_t>(
-		        params.height * pitch);
-
-		copy.image_data = new uint8_t[image_data_num_bytes];
-
-		assert(image_data);
-		std::memcpy(copy.image_data, image_data, image_data_num_bytes);
-
-		// TODO it's bad that we need to make this assumption downstream
-		// on the size and alignment of the palette...
-		if (palette_data) {
-			constexpr uint16_t PaletteNumBytes = 256 * 4;
-			copy.palette_data = new uint8_t[PaletteNumBytes];
-
-			std::memcpy(copy.palette_data, palette_data, PaletteNumBytes);
-		}
-		return copy;
-	}
-
 	void free()
 	{
 		delete[] image_data;
@@ -191,6 +168,18 @@ struct RenderedImage {
 	}
 };
 
+// A rendered frame held beyond the frame it was rendered in, by as many
+// consumers as need it (the image capturer and the text-mode server)
+using SharedRenderedImage = std::shared_ptr<const RenderedImage>;
+
+// Copies the image and its palette into a pooled buffer; the buffer goes
+// back to the pool when the last holder lets go, on whatever thread
+SharedRenderedImage RENDER_ShareImage(const RenderedImage& image);
+
+// Takes over an image whose pixel and palette data were allocated with
+// new[]; they're freed along with the last holder
+SharedRenderedImage RENDER_AdoptImage(const RenderedImage& image);
+
 extern Render render;
 extern ScalerLineHandler_t RENDER_DrawLine;
 
@@ -217,6 +206,12 @@ void RENDER_SetSize(const ImageInfo& image_info, const double frames_per_second)
 bool RENDER_StartUpdate();
 void RENDER_EndUpdate(bool abort);
 
+// Whether the next frame has to be drawn even if the VGA would draw the
+// same image as last time: the previous one didn't make it to the screen,
+// the palette or scaler cache changed, or the frame is captured or asked
+// for by the text-mode server
+bool RENDER_IsNextFrameNeeded();
+
 void RENDER_SetPalette(const uint8_t entry, const uint8_t red,
                        const uint8_t green, const uint8_t blue);
 
@@ -38,6 +38,7 @@
 
 #include "private/common.h"
 #include "private/sdlmain.h"
+#include "private/shader_cache.h"
 
 #include "audio/mixer.h"
 #include "capture/capture.h"
@@ -46,6 +47,7 @@
 #include "cpu/cpu.h"
 #include "debugger/debugger.h"
 #include "dos/dos_locale.h"
+#include "gui/clipboard.h"
 #include "gui/mapper.h"
 #include "gui/render.h"
 #include "gui/titlebar.h"
@@ -56,6 +58,7 @@
 #include "hardware/timer.h"
 #include "hardware/video/vga.h"
 #include "ints/int10.h"
+#include "misc/benchmark.h"
 #include "misc/cross.h"
 #include "misc/notifications.h"
 #include "misc/tracy.h"
@@ -222,20 +225,12 @@ static GLuint build_shader_gl(GLenum type, const std::string& source)
 	}
 }
 
-// Build a OpenGL shader program.
+// Compile both stages of a shader program and link them.
 //
-// Input GLSL source must contain both vertex and fragment stages inside their
-// respective preprocessor definitions.
-//
-// Returns a ready to use OpenGL shader program, or zero on failure.
+// Returns the linked program, or zero on failure.
 //
-static GLuint build_shader_program(const std::string& source)
+static GLuint link_shader_program_gl(const std::string& source)
 {
-	if (source.empty()) {
-		LOG_ERR("OPENGL: No shader source present");
-		return 0;
-	}
-
 	auto vertex_shader = build_shader_gl(GL_VERTEX_SHADER, source);
 	if (!vertex_shader) {
 		LOG_ERR("OPENGL: Failed compiling vertex shader");
@@ -261,6 +256,7 @@ static GLuint build_shader_program(const std::string& source)
 	glAttachShader(shader_program, vertex_shader);
 	glAttachShader(shader_program, fragment_shader);
 
+	SHADERCACHE_PrepareProgram(shader_program);
 	glLinkProgram(shader_program);
 
 	glDeleteShader(vertex_shader);
@@ -297,6 +293,34 @@ static GLuint build_shader_program(const std::string& source)
 		return 0;
 	}
 
+	return shader_program;
+}
+
+// Build a OpenGL shader program.
+//
+// Input GLSL source must contain both vertex and fragment stages inside their
+// respective preprocessor definitions.
+//
+// Returns a ready to use OpenGL shader program, or zero on failure.
+//
+static GLuint build_shader_program(const std::string& source)
+{
+	if (source.empty()) {
+		LOG_ERR("OPENGL: No shader source present");
+		return 0;
+	}
+
+	// Linking can take a noticeable moment, so reuse the driver's binary
+	// from an earlier run when there is one
+	GLuint shader_program = SHADERCACHE_LoadProgram(source);
+	if (!shader_program) {
+		shader_program = link_shader_program_gl(source);
+		if (!shader_program) {
+			return 0;
+		}
+		SHADERCACHE_StoreProgram(source, shader_program);
+	}
+
 	glUseProgram(shader_program);
 
 	// Set vertex data. Vertices in counter-clockwise order.
@@ -1602,15 +1626,93 @@ static void initialize_sdl_window_size(SDL_Window* sdl_window,
 	}
 }
 
+// Changed rows
+// ~~~~~~~~~~~~
+// Only the rows a frame changed are copied to the last framebuffer, and
+// only the rows changed since the texture was last updated are uploaded.
+// The scalers report the changed rows as runs of lines, alternately
+// unchanged and changed, starting with the unchanged ones.
+
+static void mark_rows_dirty(const int first_row, const int last_row)
+{
+	auto& draw = sdl.draw;
+	if (draw.first_dirty_row >= draw.last_dirty_row) {
+		draw.first_dirty_row = first_row;
+		draw.last_dirty_row  = last_row;
+	} else {
+		draw.first_dirty_row = std::min(draw.first_dirty_row, first_row);
+		draw.last_dirty_row  = std::max(draw.last_dirty_row, last_row);
+	}
+}
+
+static void mark_all_rows_dirty()
+{
+	mark_rows_dirty(0, sdl.draw.render_height_px);
+}
+
+static bool take_dirty_rows(int& first_row, int& num_rows)
+{
+	auto& draw = sdl.draw;
+	first_row  = draw.first_dirty_row;
+	num_rows   = std::min(draw.last_dirty_row, draw.render_height_px) - first_row;
+
+	draw.first_dirty_row = 0;
+	draw.last_dirty_row  = 0;
+	return num_rows > 0;
+}
+
+// Copies the rows the frame changed into the last framebuffer, or all of
+// them when the changes weren't reported
+static void take_changed_rows(uint8_t* last_framebuf, const uint8_t* curr_framebuf,
+                              const int pitch, const uint16_t* num_changed_lines)
+{
+	const auto height = sdl.draw.render_height_px;
+
+	const auto take_rows = [&](const int first_row, const int last_row) {
+		const auto offset = static_cast<size_t>(first_row) * pitch;
+		std::memcpy(last_framebuf + offset,
+		            curr_framebuf + offset,
+		            static_cast<size_t>(last_row - first_row) * pitch);
+		mark_rows_dirty(first_row, last_row);
+	};
+
+	if (!num_changed_lines) {
+		take_rows(0, height);
+		return;
+	}
+
+	// Every run but the first is at least a line, so a frame has no more
+	// runs than lines plus one
+	int row = 0;
+	for (int i = 0; row < height && i <= height; ++i) {
+		const auto num_rows = std::min(static_cast<int>(num_changed_lines[i]),
+		                               height - row);
+		const bool is_changed = (i % 2) == 1;
+		if (is_changed && num_rows > 0) {
+			take_rows(row, row + num_rows);
+		}
+		row += num_rows;
+	}
+}
+
 // Texture update and presentation
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 static void update_frame_texture()
 {
+	int first_row = 0;
+	int num_rows  = 0;
+	if (!take_dirty_rows(first_row, num_rows)) {
+		return;
+	}
+	const SDL_Rect rows = {0, first_row, sdl.draw.render_width_px, num_rows};
+
+	const auto pitch = sdl.texture.last_framebuf->pitch;
 	SDL_UpdateTexture(sdl.texture.texture,
-	                  nullptr, // entire texture
-	                  sdl.texture.last_framebuf->pixels,
-	                  sdl.texture.last_framebuf->pitch);
+	                  &rows,
+	                  static_cast<uint8_t*>(sdl.texture.last_framebuf->pixels) +
+	                          static_cast<size_t>(first_row) * pitch,
+	                  pitch);
 }
 
 static std::optional<RenderedImage> get_rendered_output_from_backbuffer()
@@ -1754,17 +1856,107 @@ static void present_frame_texture()
 
 // OpenGL frame-based update and presentation
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+static void delete_pixel_buffers_gl()
+{
+	auto& buffers = sdl.opengl.pixel_buffers;
+	if (buffers[0] > 0) {
+		glDeleteBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+	}
+	buffers.fill(0);
+
+	sdl.opengl.next_pixel_buffer  = 0;
+	sdl.opengl.pixel_buffer_bytes = 0;
+}
+
+// Pixel buffer objects are core since OpenGL 2.1; the texture is then
+// updated straight from the last framebuffer instead
+static void create_pixel_buffers_gl(const size_t num_bytes)
+{
+	delete_pixel_buffers_gl();
+	if (!GLAD_GL_VERSION_2_1) {
+		return;
+	}
+
+	auto& buffers = sdl.opengl.pixel_buffers;
+	glGenBuffers(static_cast<GLsizei>(buffers.size()), buffers.data());
+	for (const auto buffer : buffers) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+		glBufferData(GL_PIXEL_UNPACK_BUFFER,
+		             static_cast<GLsizeiptr>(num_bytes),
+		             nullptr,
+		             GL_STREAM_DRAW);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	sdl.opengl.pixel_buffer_bytes = num_bytes;
+}
+
+// Stages the rows in the next pixel buffer, at the same offset as in the
+// framebuffer, and returns that offset for the texture update to source
+// them from; or nothing if they have to be uploaded directly
+static std::optional<size_t> stage_rows_gl(const size_t offset, const size_t num_bytes)
+{
+	if (sdl.opengl.pixel_buffer_bytes == 0) {
+		return {};
+	}
+	assert(offset + num_bytes <= sdl.opengl.pixel_buffer_bytes);
+
+	auto& next = sdl.opengl.next_pixel_buffer;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, sdl.opengl.pixel_buffers[next]);
+	next = (next + 1) % sdl.opengl.pixel_buffers.size();
+
+	// Orphaning the storage first lets the driver hand out fresh memory
+	// rather than wait for pending reads of the old contents
+	glBufferData(GL_PIXEL_UNPACK_BUFFER,
+	             static_cast<GLsizeiptr>(sdl.opengl.pixel_buffer_bytes),
+	             nullptr,
+	             GL_STREAM_DRAW);
+
+	auto mapped = static_cast<uint8_t*>(
+	        glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY));
+	if (!mapped) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return {};
+	}
+	std::memcpy(mapped + offset, sdl.opengl.last_framebuf.data() + offset, num_bytes);
+
+	if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+		// The contents were lost, such as to a mode switch
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return {};
+	}
+	return offset;
+}
+
 static void update_frame_gl()
 {
-	glTexSubImage2D(GL_TEXTURE_2D,
-	                0,
-	                0,
-	                0,
-	                sdl.draw.render_width_px,
-	                sdl.draw.render_height_px,
-	                GL_BGRA_EXT,
-	                GL_UNSIGNED_INT_8_8_8_8_REV,
-	                sdl.opengl.last_framebuf.data());
+	int first_row = 0;
+	int num_rows  = 0;
+	if (take_dirty_rows(first_row, num_rows)) {
+		const auto pitch     = static_cast<size_t>(sdl.opengl.pitch);
+		const auto offset    = static_cast<size_t>(first_row) * pitch;
+		const auto num_bytes = static_cast<size_t>(num_rows) * pitch;
+
+		// With a pixel buffer bound, the texture update only queues a
+		// copy from it and the pointer is an offset into it
+		const auto staged  = stage_rows_gl(offset, num_bytes);
+		const auto* pixels = staged ? reinterpret_cast<const uint8_t*>(*staged)
+		                            : sdl.opengl.last_framebuf.data() + offset;
+
+		glTexSubImage2D(GL_TEXTURE_2D,
+		                0,
+		                0,
+		                first_row,
+		                sdl.draw.render_width_px,
+		                num_rows,
+		                GL_BGRA_EXT,
+		                GL_UNSIGNED_INT_8_8_8_8_REV,
+		                pixels);
+
+		if (staged) {
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		}
+	}
 
 	++sdl.opengl.actual_frame_count;
 }
@@ -1862,6 +2054,8 @@ std::optional<uint8_t> init_gl_renderer(const uint8_t flags, const int render_wi
 
 	sdl.opengl.pitch = render_width_px * MaxBytesPerPixel;
 
+	create_pixel_buffers_gl(framebuf_bytes);
+
 	// One-time initialize the window size
 	if (!sdl.desktop.window.adjusted_initial_size) {
 		initialize_sdl_window_size(sdl.window,
@@ -1974,6 +2168,9 @@ std::optional<uint8_t> init_gl_renderer(const uint8_t flags, const int render_wi
 
 	delete[] emptytex;
 
+	// The new texture starts out empty
+	mark_all_rows_dirty();
+
 	if (use_srgb_framebuffer) {
 		glEnable(GL_FRAMEBUFFER_SRGB);
 #if 0
@@ -2075,6 +2272,9 @@ uint8_t init_sdl_texture_renderer()
 		E_Exit("SDL: Error creating surface");
 	}
 
+	// The new texture starts out empty
+	mark_all_rows_dirty();
+
 	SDL_SetRenderDrawColor(sdl.renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
 
 	uint32_t pixel_format;
@@ -2428,8 +2628,14 @@ bool GFX_StartUpdate(uint8_t*& pixels, int& pitch)
 	return false;
 }
 
-void GFX_EndUpdate([[maybe_unused]] const uint16_t* num_changed_lines)
+void GFX_EndUpdate(const uint16_t* num_changed_lines)
 {
+	if (sdl.headless) {
+		// Nothing is presented, so there's no frame to hold on to
+		sdl.updating = false;
+		return;
+	}
+
 	if (sdl.updating) {
 		// `sdl.updating` is true when the contents of the framebuffer
 		// has been changed in the current frame.
@@ -2445,19 +2651,22 @@ void GFX_EndUpdate([[maybe_unused]] const uint16_t* num_changed_lines)
 		//
 		switch (sdl.rendering_backend) {
 		case RenderingBackend::OpenGl:
-			sdl.opengl.last_framebuf = sdl.opengl.curr_framebuf;
+#if C_OPENGL
+			take_changed_rows(sdl.opengl.last_framebuf.data(),
+			                  sdl.opengl.curr_framebuf.data(),
+			                  sdl.opengl.pitch,
+			                  num_changed_lines);
+#endif
 			break;
 
-		case RenderingBackend::Texture: {
-			// TODO Couldn't get SDL_BlitSurface to work... If you
-			// can, feel free to use that here, but this works
-			// perfectly fine.
-			std::memcpy(sdl.texture.last_framebuf->pixels,
-			            sdl.texture.curr_framebuf->pixels,
-			            (sdl.texture.curr_framebuf->h *
-			             sdl.texture.curr_framebuf->pitch));
-
-		} break;
+		case RenderingBackend::Texture:
+			take_changed_rows(static_cast<uint8_t*>(
+			                          sdl.texture.last_framebuf->pixels),
+			                  static_cast<const uint8_t*>(
+			                          sdl.texture.curr_framebuf->pixels),
+			                  sdl.texture.curr_framebuf->pitch,
+			                  num_changed_lines);
+			break;
 
 		default: assertm(false, "Invalid RenderingBackend");
 		}
@@ -3045,6 +3254,8 @@ static void set_output(Section* sec, const bool wants_aspect_ratio_correction)
 			glGetIntegerv(GL_MAX_TEXTURE_SIZE, &sdl.opengl.max_texsize);
 
 			sdl.opengl.texture = 0;
+			sdl.opengl.pixel_buffers.fill(0);
+			sdl.opengl.pixel_buffer_bytes = 0;
 		}
 	}
 #endif // OPENGL
@@ -3129,6 +3340,13 @@ static void restart_hotkey_handler([[maybe_unused]] bool pressed)
 	DOSBOX_Restart();
 }
 
+static void paste_clipboard_handler(bool pressed)
+{
+	if (pressed) {
+		CLIPBOARD_PasteIntoGuest();
+	}
+}
+
 static void set_fullscreen_mode()
 {
 	const auto fullscreen_mode_pref = [] {
@@ -3193,6 +3411,11 @@ static void sdl_section_init(Section* sec)
 	sdl.mute_when_inactive = (!sdl.pause_when_inactive) &&
 	                         section->GetBool("mute_when_inactive");
 
+	const auto event_poll_rate = section->GetInt("event_poll_rate");
+
+	sdl.event_poll_interval_us = event_poll_rate > 0 ? 1'000'000 / event_poll_rate
+	                                                 : 0;
+
 	// Assume focus on startup
 	apply_active_settings();
 
@@ -3241,6 +3464,12 @@ static void sdl_section_init(Section* sec)
 	                  "capmouse",
 	                  "Cap Mouse");
 
+	MAPPER_AddHandler(paste_clipboard_handler,
+	                  SDL_SCANCODE_V,
+	                  PRIMARY_MOD | MMOD2,
+	                  "paste",
+	                  "Paste Text");
+
 #if C_DEBUGGER
 // Pause binds with activate-debugger
 
@@ -3268,12 +3497,40 @@ static void sdl_section_init(Section* sec)
 	TITLEBAR_ReadConfig(*conf);
 }
 
+// Host mice polling at 1000 Hz or more send an event per report, several
+// between two of our polls. The emulated mice report at most a few hundred
+// times a second and sum up the movement in between anyway, so the events
+// are summed here and passed on once per poll, sparing the mouse
+// interfaces most of the calls. Any other event flushes the sum first, so
+// clicks still land where the pointer was.
+static struct {
+	bool has_moved = false;
+
+	int x_rel = 0;
+	int y_rel = 0;
+	int x_abs = 0;
+	int y_abs = 0;
+} pending_motion = {};
+
 static void handle_mouse_motion(SDL_MouseMotionEvent* motion)
 {
-	MOUSE_EventMoved(static_cast<float>(motion->xrel),
-	                 static_cast<float>(motion->yrel),
-	                 static_cast<float>(motion->x),
-	                 static_cast<float>(motion->y));
+	pending_motion.has_moved = true;
+	pending_motion.x_rel += motion->xrel;
+	pending_motion.y_rel += motion->yrel;
+	pending_motion.x_abs = motion->x;
+	pending_motion.y_abs = motion->y;
+}
+
+static void flush_mouse_motion()
+{
+	if (!pending_motion.has_moved) {
+		return;
+	}
+	MOUSE_EventMoved(static_cast<float>(pending_motion.x_rel),
+	                 static_cast<float>(pending_motion.y_rel),
+	                 static_cast<float>(pending_motion.x_abs),
+	                 static_cast<float>(pending_motion.y_abs));
+	pending_motion = {};
 }
 
 static void handle_mouse_wheel(SDL_MouseWheelEvent* wheel)
@@ -3757,8 +4014,17 @@ static void adjust_ticks_after_present_frame(int64_t elapsed_us)
 	}
 }
 
+bool GFX_IsHeadless()
+{
+	return sdl.headless;
+}
+
 void GFX_MaybePresentFrame()
 {
+	if (sdl.headless) {
+		return;
+	}
+
 	const auto start_us = GetTicksUs();
 
 	// Always present the frame if we want to capture the next
@@ -3805,6 +4071,20 @@ void GFX_MaybePresentFrame()
 //   false - event loop wants to quit
 bool DOSBOX_PollAndHandleEvents()
 {
+	// The main loop gets here once per emulated millisecond, which is
+	// far more often than that when fast-forwarding or with many idle
+	// instances, and pumping the host's events mostly finds none. Events
+	// already in the queue, such as the ones other threads push, don't
+	// wait for the next due poll.
+	const auto now_us = GetTicksUs();
+	if (GetTicksDiff(now_us, sdl.last_event_poll_us) < sdl.event_poll_interval_us &&
+	    !SDL_HasEvents(SDL_FIRSTEVENT, SDL_LASTEVENT)) {
+		textmode::Poll();
+		BENCHMARK_Poll();
+		return !shutdown_requested;
+	}
+	sdl.last_event_poll_us = now_us;
+
 	SDL_Event event;
 
 	static auto last_check_joystick = GetTicks();
@@ -3820,6 +4100,9 @@ bool DOSBOX_PollAndHandleEvents()
 	}
 
 	while (SDL_PollEvent(&event)) {
+		if (event.type != SDL_MOUSEMOTION) {
+			flush_mouse_motion();
+		}
 #if C_DEBUGGER
 		if (is_debugger_event(event)) {
 			pdc_event_queue.push(event);
@@ -3904,8 +4187,10 @@ bool DOSBOX_PollAndHandleEvents()
 		default: MAPPER_CheckEvent(&event);
 		}
 	}
+	flush_mouse_motion();
 
 	textmode::Poll();
+	BENCHMARK_Poll();
 	return !shutdown_requested;
 }
 
@@ -4039,6 +4324,22 @@ static void register_command_line_help_message()
 	        "\n"
 	        "  --socket <num>           Run nullmodem on the specified socket number.\n"
 	        "\n"
+	        "  --startup-profile        Log how long each config section took to initialize,\n"
+	        "                           slowest first.\n"
+	        "\n"
+	        "  --headless               Run without a visible window or sound output: SDL's\n"
+	        "                           'dummy' video driver, no presentation, and no audio\n"
+	        "                           device. Frames are only rendered for captures and the\n"
+	        "                           text-mode server's GETIMG.\n"
+	        "\n"
+	        "  --replay <journal>       Replay a text-mode server session journal in lockstep\n"
+	        "                           at maximum speed, then exit. The exit code is non-zero\n"
+	        "                           if any frame differs from the recording.\n"
+	        "\n"
+	        "  --benchmark <suite>      Run a suite of built-in workloads headless and in\n"
+	        "                           lockstep with fixed settings, print the results as\n"
+	        "                           JSON and exit. Suites: all, cpu, video, audio, io.\n"
+	        "\n"
 	        "  -h, -?, --help           Print help message and exit.\n"
 	        "\n"
 	        "  -V, --version            Print version information and exit.\n");
@@ -4293,6 +4594,14 @@ static void init_sdl_config_section()
 	pbool = sdl_sec->AddBool("pause_when_inactive", OnlyAtStart, false);
 	pbool->SetHelp("Pause emulation when the window is inactive ('off' by default).");
 
+	pint = sdl_sec->AddInt("event_poll_rate", OnlyAtStart, 1000);
+	pint->SetMinMax(0, 10000);
+	pint->SetHelp(
+	        "How many times per second to check for keyboard, mouse and window events\n"
+	        "(1000 by default). Events that are already waiting are handled right away.\n"
+	        "Lower values save host CPU time, most of all when running many instances;\n"
+	        "0 checks on every emulated millisecond.");
+
 	pbool = sdl_sec->AddBool("keyboard_capture", Always, false);
 	pbool->SetHelp(
 	        "Capture system keyboard shortcuts ('off' by default).\n"
@@ -4621,6 +4930,8 @@ static void init_logger(const CommandLineArguments& args, int argc, char* argv[]
 	}
 
 	loguru::init(argc, argv);
+
+	LOG_StartAsyncWriter();
 }
 
 static void maybe_write_primary_config(const CommandLineArguments& args)
@@ -5023,12 +5334,42 @@ int sdl_main(int argc, char* argv[])
 		SetConsoleCtrlHandler((PHANDLER_ROUTINE)console_event_handler, TRUE);
 #endif
 
+		if (!arguments->benchmark.empty() &&
+		    !BENCHMARK_Select(arguments->benchmark)) {
+			const auto suites = join_with_commas(BENCHMARK_GetSuiteNames(),
+			                                     "or");
+			LOG_ERR("BENCHMARK: Unknown suite '%s', choose one of: %s",
+			        arguments->benchmark.c_str(),
+			        suites.c_str());
+			return 1;
+		}
+
+		if (arguments->headless) {
+			// Must be in place before SDL_Init() picks the drivers
+			SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+			SDL_setenv("SDL_AUDIODRIVER", "dummy", 1);
+			sdl.headless = true;
+		}
+
 		init_sdl();
 
+		// A benchmark's fixed settings come first, so `--set` can still
+		// override them
+		if (BENCHMARK_IsActive()) {
+			handle_cli_set_commands(BENCHMARK_GetSettings());
+		}
+
 		// Handle configuration settings passed with `--set` commands
 		// from the CLI.
 		handle_cli_set_commands(arguments->set);
 
+		if (arguments->headless) {
+			// The texture backend needs no GL context, and the mixer
+			// runs in emulated time without a device or its thread
+			set_section_property_value("sdl", "output", "texture");
+			set_section_property_value("mixer", "output", "null");
+		}
+
 		maybe_create_resource_directories();
 
 		control->ParseEnv();
@@ -5048,9 +5389,17 @@ int sdl_main(int argc, char* argv[])
 		// Start emulation and run it until shutdown
 		control->StartUp();
 
+		if (!BENCHMARK_Finish()) {
+			return_code = 1;
+		}
+
 		// Shutdown and release
 		control.reset();
 
+		if (TEXTMODESERVER_ReplayFailed()) {
+			return_code = 1;
+		}
+
 	} catch (char* error) {
 		return_code = 1;
 
@@ -0,0 +1,226 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "private/shader_cache.h"
+
+#if C_OPENGL
+
+#include <SDL.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "misc/cross.h"
+#include "misc/logging.h"
+#include "misc/std_filesystem.h"
+
+namespace {
+
+// From GL_ARB_get_program_binary, which the bundled GL 2.1 loader lacks
+constexpr GLenum ProgramBinaryRetrievableHint = 0x8257;
+constexpr GLenum ProgramBinaryLength          = 0x8741;
+constexpr GLenum NumProgramBinaryFormats      = 0x87fe;
+
+using GetProgramBinaryProc   = void(GLAD_API_PTR*)(GLuint, GLsizei, GLsizei*,
+                                                 GLenum*, void*);
+using ProgramBinaryProc      = void(GLAD_API_PTR*)(GLuint, GLenum, const void*, GLsizei);
+using ProgramParameteriProc  = void(GLAD_API_PTR*)(GLuint, GLenum, GLint);
+
+// Ahead of the binary in each cache file; bump the version if the layout
+// ever changes
+constexpr std::string_view FileMagic = "DBSC\1";
+
+struct {
+	bool probed    = false;
+	bool available = false;
+
+	GetProgramBinaryProc get_program_binary   = nullptr;
+	ProgramBinaryProc program_binary          = nullptr;
+	ProgramParameteriProc program_parameteri = nullptr;
+
+	// Folded into every key, so a driver update never loads stale binaries
+	std::string driver = {};
+	std_fs::path directory = {};
+} cache;
+
+bool is_cache_available()
+{
+	if (cache.probed) {
+		return cache.available;
+	}
+	cache.probed = true;
+
+	if (!SDL_GL_ExtensionSupported("GL_ARB_get_program_binary")) {
+		return false;
+	}
+	cache.get_program_binary = reinterpret_cast<GetProgramBinaryProc>(
+	        SDL_GL_GetProcAddress("glGetProgramBinary"));
+	cache.program_binary = reinterpret_cast<ProgramBinaryProc>(
+	        SDL_GL_GetProcAddress("glProgramBinary"));
+	cache.program_parameteri = reinterpret_cast<ProgramParameteriProc>(
+	        SDL_GL_GetProcAddress("glProgramParameteri"));
+	if (!cache.get_program_binary || !cache.program_binary ||
+	    !cache.program_parameteri) {
+		return false;
+	}
+
+	// Some drivers advertise the extension but support no formats
+	GLint num_formats = 0;
+	glGetIntegerv(NumProgramBinaryFormats, &num_formats);
+	if (num_formats <= 0) {
+		return false;
+	}
+
+	for (const auto name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+		if (const auto value = glGetString(name); value) {
+			cache.driver.append(reinterpret_cast<const char*>(value));
+		}
+		cache.driver.push_back('\n');
+	}
+	cache.directory = GetConfigDir() / "shader-cache";
+	cache.available = true;
+	return true;
+}
+
+// FNV-1a, continued across several strings
+uint64_t hash_append(uint64_t hash, const std::string_view data)
+{
+	for (const auto byte : data) {
+		hash ^= static_cast<uint8_t>(byte);
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+std_fs::path path_for(const std::string& source)
+{
+	constexpr uint64_t FnvOffsetBasis = 0xcbf29ce484222325;
+
+	const auto hash = hash_append(hash_append(FnvOffsetBasis, cache.driver), source);
+
+	char name[32] = {};
+	std::snprintf(name, sizeof(name), "%016" PRIx64 ".bin", hash);
+	return cache.directory / name;
+}
+
+void discard(const std_fs::path& path)
+{
+	std::error_code ec = {};
+	std_fs::remove(path, ec);
+}
+
+} // namespace
+
+GLuint SHADERCACHE_LoadProgram(const std::string& source)
+{
+	if (!is_cache_available()) {
+		return 0;
+	}
+
+	const auto path = path_for(source);
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		return 0;
+	}
+	const std::vector<char> contents(std::istreambuf_iterator<char>(file), {});
+
+	constexpr auto HeaderSize = FileMagic.size() + sizeof(uint32_t);
+	if (contents.size() <= HeaderSize ||
+	    std::string_view(contents.data(), FileMagic.size()) != FileMagic) {
+		discard(path);
+		return 0;
+	}
+
+	uint32_t format = 0;
+	for (size_t i = 0; i < sizeof(format); ++i) {
+		format |= static_cast<uint32_t>(static_cast<uint8_t>(
+		                  contents[FileMagic.size() + i]))
+		       << (8 * i);
+	}
+
+	const auto program = glCreateProgram();
+	if (!program) {
+		return 0;
+	}
+	cache.program_binary(program,
+	                     static_cast<GLenum>(format),
+	                     contents.data() + HeaderSize,
+	                     static_cast<GLsizei>(contents.size() - HeaderSize));
+
+	// Drivers may reject binaries from another driver build even with the
+	// same version string; that's a cache miss, not an error
+	GLint is_program_linked = GL_FALSE;
+	glGetProgramiv(program, GL_LINK_STATUS, &is_program_linked);
+	if (!is_program_linked) {
+		glDeleteProgram(program);
+		discard(path);
+		return 0;
+	}
+	return program;
+}
+
+void SHADERCACHE_PrepareProgram(const GLuint program)
+{
+	if (is_cache_available()) {
+		cache.program_parameteri(program, ProgramBinaryRetrievableHint, GL_TRUE);
+	}
+}
+
+void SHADERCACHE_StoreProgram(const std::string& source, const GLuint program)
+{
+	if (!is_cache_available()) {
+		return;
+	}
+
+	GLint length = 0;
+	glGetProgramiv(program, ProgramBinaryLength, &length);
+	if (length <= 0) {
+		return;
+	}
+
+	std::vector<char> binary(static_cast<size_t>(length));
+	GLenum format = 0;
+	GLsizei written = 0;
+	cache.get_program_binary(program, length, &written, &format, binary.data());
+	if (written <= 0) {
+		return;
+	}
+
+	std::error_code ec = {};
+	std_fs::create_directories(cache.directory, ec);
+	if (ec) {
+		LOG_WARNING("OPENGL: Can't create shader cache directory '%s': %s",
+		            cache.directory.string().c_str(),
+		            ec.message().c_str());
+		return;
+	}
+
+	// Written aside and renamed into place, so a concurrent instance never
+	// sees a partial file
+	const auto path      = path_for(source);
+	auto temporary_path  = path;
+	temporary_path      += ".tmp";
+	{
+		std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+		file.write(FileMagic.data(), static_cast<std::streamsize>(FileMagic.size()));
+		for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+			file.put(static_cast<char>((format >> (8 * i)) & 0xff));
+		}
+		file.write(binary.data(), written);
+		if (!file) {
+			discard(temporary_path);
+			return;
+		}
+	}
+	std_fs::rename(temporary_path, path, ec);
+	if (ec) {
+		discard(temporary_path);
+	}
+}
+
+#endif // C_OPENGL
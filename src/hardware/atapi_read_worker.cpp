@@ -0,0 +1,148 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/atapi_read_worker.h"
+
+#include <algorithm>
+#include <utility>
+
+bool AtapiReadWorker::Extent::Covers(const Extent& other) const
+{
+	return source == other.source && other.lba >= lba &&
+	       other.lba + other.num_sectors <= lba + num_sectors;
+}
+
+AtapiReadWorker::~AtapiReadWorker()
+{
+	{
+		std::lock_guard lock(mutex);
+		quit = true;
+	}
+	wake.notify_one();
+	if (thread.joinable()) {
+		thread.join();
+	}
+}
+
+bool AtapiReadWorker::Submit(const void* source, ReadFunction read_sectors,
+                             const uint32_t lba, const uint32_t num_sectors)
+{
+	std::lock_guard lock(mutex);
+
+	// Another disc: nothing read so far applies
+	if (buffered && buffered->source != source) {
+		buffered.reset();
+		buffer.clear();
+	}
+	if (ahead && ahead->source != source) {
+		ahead.reset();
+	}
+
+	read         = std::move(read_sectors);
+	request      = Extent{source, lba, num_sectors};
+	request_done = false;
+	request_ok   = false;
+	data.clear();
+
+	AnswerFromBuffer();
+
+	if (!thread.joinable()) {
+		thread = std::thread(&AtapiReadWorker::Run, this);
+	}
+	wake.notify_one();
+	return request_done;
+}
+
+bool AtapiReadWorker::IsDone()
+{
+	std::lock_guard lock(mutex);
+	return !request || request_done;
+}
+
+bool AtapiReadWorker::Take(uint8_t* out)
+{
+	std::unique_lock lock(mutex);
+	if (!request) {
+		return false;
+	}
+	read_done.wait(lock, [this] { return request_done; });
+
+	std::copy(data.begin(), data.end(), out);
+	const auto ok = request_ok;
+	request.reset();
+	return ok;
+}
+
+void AtapiReadWorker::Finish()
+{
+	std::unique_lock lock(mutex);
+	request.reset();
+	ahead.reset();
+	read = {};
+	read_done.wait(lock, [this] { return !reading; });
+
+	buffered.reset();
+	buffer.clear();
+}
+
+void AtapiReadWorker::AnswerFromBuffer()
+{
+	if (!request || request_done || !buffered || !buffered->Covers(*request)) {
+		return;
+	}
+	const auto first = buffer.begin() + (request->lba - buffered->lba) * BytesPerSector;
+	data.assign(first, first + request->num_sectors * BytesPerSector);
+	request_done = true;
+	request_ok   = true;
+
+	// The guest is likely to want what follows next
+	const Extent next = {request->source,
+	                     request->lba + request->num_sectors,
+	                     request->num_sectors};
+	if (!buffered->Covers(next)) {
+		ahead = next;
+	}
+	read_done.notify_all();
+}
+
+void AtapiReadWorker::Run()
+{
+	std::unique_lock lock(mutex);
+	while (true) {
+		wake.wait(lock, [this] {
+			return quit || (request && !request_done) || ahead;
+		});
+		if (quit) {
+			break;
+		}
+
+		// The guest's read goes first, then reading ahead
+		const bool for_request = request && !request_done;
+		const Extent next      = for_request ? *request : *ahead;
+		if (!for_request) {
+			ahead.reset();
+		}
+		reading           = next;
+		auto read_sectors = read;
+
+		lock.unlock();
+		std::vector<uint8_t> sectors(next.num_sectors * BytesPerSector);
+		const auto ok = read_sectors &&
+		                read_sectors(sectors.data(), next.lba, next.num_sectors);
+		lock.lock();
+
+		reading.reset();
+		if (ok) {
+			buffered = next;
+			buffer   = std::move(sectors);
+			AnswerFromBuffer();
+		} else if (for_request && request && !request_done &&
+		           request->Covers(next) && next.Covers(*request)) {
+			// A failed read ahead leaves the guest's read to be tried
+			// on its own, but a failed read of its own fails it
+			request_done = true;
+			request_ok   = false;
+		}
+		read_done.notify_all();
+	}
+}
@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_ATAPI_READ_WORKER_H
+#define DOSBOX_ATAPI_READ_WORKER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+// ATAPI read worker
+// ~~~~~~~~~~~~~~~~~
+// Carries out an ATAPI CD-ROM drive's sector reads on a thread of its own,
+// so a large read from a disc image doesn't stall emulation while the guest
+// waits on the busy drive. Once a read completes, the sectors that follow
+// it are read ahead, and a request they cover is answered from them, which
+// keeps sequential streaming (installers, FMV) off the disk entirely.
+//
+// A read is tied to the disc it came from by an opaque 'source'; a request
+// for another source drops what was read ahead. Finish() must be called
+// before a source is destroyed.
+
+class AtapiReadWorker {
+public:
+	static constexpr uint32_t BytesPerSector = 2048;
+
+	// Reads 'num_sectors' from 'lba' on into the buffer; runs on the worker
+	using ReadFunction = std::function<bool(uint8_t* buffer, uint32_t lba,
+	                                        uint32_t num_sectors)>;
+
+	AtapiReadWorker() = default;
+	~AtapiReadWorker();
+
+	AtapiReadWorker(const AtapiReadWorker&)            = delete;
+	AtapiReadWorker& operator=(const AtapiReadWorker&) = delete;
+
+	// Starts the guest's read, replacing any still in progress. Returns
+	// true if it's already done, having been read ahead.
+	bool Submit(const void* source, ReadFunction read, uint32_t lba,
+	            uint32_t num_sectors);
+
+	bool IsDone();
+
+	// Waits for the submitted read and copies its sectors out; false if
+	// the read failed or nothing was submitted
+	bool Take(uint8_t* buffer);
+
+	// Waits for the read in progress and forgets everything read ahead
+	void Finish();
+
+private:
+	struct Extent {
+		const void* source   = nullptr;
+		uint32_t lba         = 0;
+		uint32_t num_sectors = 0;
+
+		bool Covers(const Extent& other) const;
+	};
+
+	void Run();
+
+	// Answers the guest's read from the buffer if it's there. Expects the
+	// mutex to be held.
+	void AnswerFromBuffer();
+
+	std::mutex mutex                   = {};
+	std::condition_variable wake       = {};
+	std::condition_variable read_done  = {};
+	std::thread thread                 = {};
+	bool quit                          = false;
+	ReadFunction read                  = {};
+
+	// The guest's read, and whether and how it completed
+	std::optional<Extent> request = {};
+	bool request_done             = false;
+	bool request_ok               = false;
+	std::vector<uint8_t> data     = {};
+
+	// What the worker is reading now, and what it's to read ahead next
+	std::optional<Extent> reading = {};
+	std::optional<Extent> ahead   = {};
+
+	// The last successful read
+	std::optional<Extent> buffered = {};
+	std::vector<uint8_t> buffer    = {};
+};
+
+#endif // DOSBOX_ATAPI_READ_WORKER_H
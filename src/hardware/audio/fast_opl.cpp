@@ -0,0 +1,634 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "private/fast_opl.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+#include "utils/checks.h"
+
+CHECK_NARROWING();
+
+namespace {
+
+// Attenuation is kept with 15 fractional bits, so the slowest envelope
+// rates still advance every sample
+constexpr auto LevelFractionBits = 15;
+constexpr uint32_t LevelOne      = 1u << LevelFractionBits;
+constexpr uint32_t MaxLevel      = 0x1ffu << LevelFractionBits;
+
+// Past this attenuation the chip treats the envelope as finished
+constexpr uint32_t OffLevel = 0x1f8u << LevelFractionBits;
+
+constexpr uint32_t MaxAttenuation = 0x1ff;
+
+// Frequency multipliers doubled: 1/2, 1, 2, 3, ... 10, 10, 12, 12, 15, 15
+constexpr uint8_t Multipliers[16] = {
+        1, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 20, 24, 24, 30, 30};
+
+constexpr uint8_t KeyScaleLevels[16] = {
+        0, 32, 40, 45, 48, 51, 53, 55, 56, 58, 59, 60, 61, 62, 63, 64};
+
+constexpr uint8_t KeyScaleShifts[4] = {8, 1, 2, 0};
+
+// Maps the 0x20-0x35 register offsets to operators, and channels to their
+// first operator (the second is three further on)
+constexpr int8_t OperatorOfOffset[0x20] = {
+        0,  1,  2,  3,  4,  5,  -1, -1, 6,  7,  8,  9,  10, 11, -1, -1,
+        12, 13, 14, 15, 16, 17, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1};
+
+constexpr uint8_t FirstOperatorOfChannel[18] = {
+        0, 1, 2, 6, 7, 8, 12, 13, 14, 18, 19, 20, 24, 25, 26, 30, 31, 32};
+
+// The envelope generator's average step per sample for each effective rate.
+// The chip adds 1 << (shift - 1) on a subset of its envelope clocks; over
+// time that comes to (4 + rate_lo) << rate_hi fractional units per sample,
+// topping out at four whole steps for rates 60 to 63.
+constexpr std::array<uint32_t, 64> make_rate_increments()
+{
+	std::array<uint32_t, 64> increments = {};
+	for (uint32_t rate = 0; rate < 64; ++rate) {
+		const auto rate_hi = rate >> 2;
+		const auto rate_lo = rate & 3;
+		increments[rate]   = std::min((4 + rate_lo) << rate_hi, 4 * LevelOne);
+	}
+	return increments;
+}
+
+constexpr auto RateIncrements = make_rate_increments();
+
+// Each waveform as a log-attenuation per phase step, with the sign in the
+// top bit; 0x1000 is far enough down to come out as silence
+constexpr uint16_t NegativeBit = 0x8000;
+constexpr uint16_t SilentLog   = 0x1000;
+
+struct Tables {
+	uint16_t exponent[256]      = {};
+	uint16_t waveforms[8][1024] = {};
+
+	Tables()
+	{
+		uint16_t log_sine[256] = {};
+		for (auto i = 0; i < 256; ++i) {
+			const auto x = (i + 0.5) * std::numbers::pi / 512.0;
+			log_sine[i] = static_cast<uint16_t>(
+			        std::lround(-std::log2(std::sin(x)) * 256.0));
+
+			exponent[i] = static_cast<uint16_t>(
+			        std::lround(std::exp2((255 - i) / 256.0) * 1024.0));
+		}
+
+		for (uint16_t phase = 0; phase < 1024; ++phase) {
+			const auto low  = phase & 0xff;
+			const auto sine = (phase & 0x100) ? log_sine[low ^ 0xff]
+			                                  : log_sine[low];
+
+			const auto double_speed = (phase & 0x80)
+			                                ? log_sine[((phase ^ 0xff) << 1) & 0xff]
+			                                : log_sine[(phase << 1) & 0xff];
+
+			const bool second_half = phase & 0x200;
+
+			const uint16_t sign = second_half ? NegativeBit : 0;
+
+			// Sine, half-sine, absolute sine, pulse sine
+			waveforms[0][phase] = sine | sign;
+			waveforms[1][phase] = second_half ? SilentLog : sine;
+			waveforms[2][phase] = sine;
+			waveforms[3][phase] = (phase & 0x100) ? SilentLog : log_sine[low];
+
+			// Alternating sine, camel sine, square, derived square
+			const uint16_t alt_sign = ((phase & 0x300) == 0x100) ? NegativeBit : 0;
+
+			waveforms[4][phase] = second_half ? alt_sign | SilentLog
+			                                  : alt_sign | double_speed;
+			waveforms[5][phase] = second_half ? SilentLog : double_speed;
+			waveforms[6][phase] = sign;
+
+			const auto saw = second_half ? (phase & 0x1ff) ^ 0x1ff : phase;
+			waveforms[7][phase] = static_cast<uint16_t>((saw << 3) | sign);
+		}
+	}
+};
+
+const Tables tables = {};
+
+int16_t clip_sample(const int32_t sample)
+{
+	return static_cast<int16_t>(std::clamp(sample, -32768, 32767));
+}
+
+} // namespace
+
+bool FastOpl::Operator::IsSilent() const
+{
+	return level >= MaxLevel && stage != EnvelopeStage::Attack;
+}
+
+FastOpl::FastOpl()
+{
+	Reset();
+}
+
+void FastOpl::Reset()
+{
+	operators = {};
+	for (auto& op : operators) {
+		op.level = MaxLevel;
+	}
+	channels = {};
+	lfo      = {};
+	rhythm   = {};
+
+	note_select  = false;
+	four_op_mask = 0;
+	opl3_mode    = false;
+}
+
+FastOpl::Operator& FastOpl::OperatorOf(const int channel, const int index)
+{
+	assert(channel >= 0 && channel < 18);
+	const auto bank = (channel / 9) * 18;
+	return operators[static_cast<size_t>(
+	        bank + FirstOperatorOfChannel[channel % 9] + index * 3)];
+}
+
+void FastOpl::SetKey(Operator& op, const uint8_t key_bit, const bool key_on)
+{
+	const auto was_on = op.key != 0;
+	if (key_on) {
+		op.key |= key_bit;
+	} else {
+		op.key &= static_cast<uint8_t>(~key_bit);
+	}
+
+	if (!was_on && op.key) {
+		op.stage = EnvelopeStage::Attack;
+		op.phase = 0;
+	} else if (was_on && !op.key) {
+		op.stage = EnvelopeStage::Release;
+	}
+}
+
+void FastOpl::KeyChannel(const int channel, const bool key_on)
+{
+	constexpr uint8_t ChannelKey = 1;
+
+	switch (channels[static_cast<size_t>(channel)].type) {
+	case ChannelType::FourOpSecond:
+		// Keyed with the first channel of the pair
+		return;
+
+	case ChannelType::FourOpFirst:
+		SetKey(OperatorOf(channel + 3, 0), ChannelKey, key_on);
+		SetKey(OperatorOf(channel + 3, 1), ChannelKey, key_on);
+		[[fallthrough]];
+
+	case ChannelType::TwoOp:
+	case ChannelType::Drum:
+		SetKey(OperatorOf(channel, 0), ChannelKey, key_on);
+		SetKey(OperatorOf(channel, 1), ChannelKey, key_on);
+		break;
+	}
+}
+
+void FastOpl::UpdateChannelTypes()
+{
+	for (auto& channel : channels) {
+		channel.type = ChannelType::TwoOp;
+	}
+	if (opl3_mode) {
+		for (auto bit = 0; bit < 6; ++bit) {
+			if (four_op_mask & (1 << bit)) {
+				const auto first = (bit < 3) ? bit : bit + 6;
+				channels[static_cast<size_t>(first)].type = ChannelType::FourOpFirst;
+				channels[static_cast<size_t>(first + 3)].type = ChannelType::FourOpSecond;
+			}
+		}
+	}
+	if (rhythm.reg & 0x20) {
+		for (auto channel = 6; channel < 9; ++channel) {
+			channels[static_cast<size_t>(channel)].type = ChannelType::Drum;
+		}
+	}
+}
+
+void FastOpl::WriteReg(const uint16_t reg, const uint8_t val)
+{
+	const auto bank = (reg & 0x100) ? 1 : 0;
+	const auto addr = reg & 0xff;
+
+	auto op_at = [&]() -> Operator* {
+		const auto index = OperatorOfOffset[addr & 0x1f];
+		if (index < 0) {
+			return nullptr;
+		}
+		return &operators[static_cast<size_t>(bank * 18 + index)];
+	};
+
+	auto channel_at = [&]() -> int {
+		const auto index = addr & 0x0f;
+		return (index < 9) ? bank * 9 + index : -1;
+	};
+
+	switch (addr & 0xf0) {
+	case 0x00:
+		if (bank == 1 && addr == 0x04) {
+			four_op_mask = val & 0x3f;
+			UpdateChannelTypes();
+		} else if (bank == 1 && addr == 0x05) {
+			opl3_mode = val & 0x01;
+			UpdateChannelTypes();
+		} else if (bank == 0 && addr == 0x08) {
+			note_select = (val >> 6) & 0x01;
+		}
+		break;
+
+	case 0x20:
+	case 0x30:
+		if (auto op = op_at()) {
+			op->tremolo        = val & 0x80;
+			op->vibrato        = val & 0x40;
+			op->sustain        = val & 0x20;
+			op->key_scale_rate = val & 0x10;
+			op->multiplier     = val & 0x0f;
+		}
+		break;
+
+	case 0x40:
+	case 0x50:
+		if (auto op = op_at()) {
+			op->key_scale   = static_cast<uint8_t>(val >> 6);
+			op->total_level = val & 0x3f;
+		}
+		break;
+
+	case 0x60:
+	case 0x70:
+		if (auto op = op_at()) {
+			op->attack_rate = static_cast<uint8_t>(val >> 4);
+			op->decay_rate  = val & 0x0f;
+		}
+		break;
+
+	case 0x80:
+	case 0x90:
+		if (auto op = op_at()) {
+			const auto sustain_level = static_cast<uint8_t>(val >> 4);
+			op->sustain_level = (sustain_level == 0x0f) ? 0x1f : sustain_level;
+			op->release_rate  = val & 0x0f;
+		}
+		break;
+
+	case 0xe0:
+	case 0xf0:
+		if (auto op = op_at()) {
+			op->waveform = val & (opl3_mode ? 0x07 : 0x03);
+		}
+		break;
+
+	case 0xa0:
+		if (const auto channel = channel_at(); channel >= 0) {
+			auto& ch = channels[static_cast<size_t>(channel)];
+			ch.fnum  = static_cast<uint16_t>((ch.fnum & 0x300) | val);
+		}
+		break;
+
+	case 0xb0:
+		if (bank == 0 && addr == 0xbd) {
+			lfo.tremolo_shift = static_cast<uint8_t>((((val >> 7) ^ 1) << 1) + 2);
+			lfo.vibrato_shift = ((val >> 6) & 0x01) ^ 1;
+
+			rhythm.reg = val & 0x3f;
+			UpdateChannelTypes();
+
+			constexpr uint8_t DrumKey = 2;
+
+			const auto on = rhythm.reg & 0x20;
+			SetKey(OperatorOf(7, 0), DrumKey, on && (val & 0x01)); // hi-hat
+			SetKey(OperatorOf(8, 1), DrumKey, on && (val & 0x02)); // cymbal
+			SetKey(OperatorOf(8, 0), DrumKey, on && (val & 0x04)); // tom
+			SetKey(OperatorOf(7, 1), DrumKey, on && (val & 0x08)); // snare
+			SetKey(OperatorOf(6, 0), DrumKey, on && (val & 0x10)); // bass
+			SetKey(OperatorOf(6, 1), DrumKey, on && (val & 0x10));
+
+		} else if (const auto channel = channel_at(); channel >= 0) {
+			auto& ch = channels[static_cast<size_t>(channel)];
+			ch.fnum  = static_cast<uint16_t>((ch.fnum & 0xff) | ((val & 0x03) << 8));
+			ch.block = (val >> 2) & 0x07;
+			KeyChannel(channel, val & 0x20);
+		}
+		break;
+
+	case 0xc0:
+		if (const auto channel = channel_at(); channel >= 0) {
+			auto& ch    = channels[static_cast<size_t>(channel)];
+			ch.feedback = (val >> 1) & 0x07;
+			ch.additive = val & 0x01;
+			ch.left     = !opl3_mode || (val & 0x10);
+			ch.right    = !opl3_mode || (val & 0x20);
+		}
+		break;
+	}
+}
+
+uint32_t FastOpl::AdvanceEnvelope(Operator& op, const Channel& freq) const
+{
+	int32_t key_scale = (KeyScaleLevels[freq.fnum >> 6] << 2) -
+	                    ((8 - freq.block) << 5);
+	key_scale = std::max(key_scale, 0) >> KeyScaleShifts[op.key_scale];
+
+	const auto attenuation = std::min(
+	        (op.level >> LevelFractionBits) + (op.total_level << 2u) +
+	                static_cast<uint32_t>(key_scale) +
+	                (op.tremolo ? lfo.tremolo : 0u),
+	        MaxAttenuation);
+
+	const auto key_code = (freq.block << 1) |
+	                      ((freq.fnum >> (note_select ? 8 : 9)) & 1);
+
+	const auto key_rate = op.key_scale_rate ? key_code : key_code >> 2;
+
+	auto rate_of = [key_rate](const uint8_t reg_rate) -> int {
+		return reg_rate ? std::min(reg_rate * 4 + key_rate, 63) : 0;
+	};
+
+	auto increment_of = [&](const uint8_t reg_rate) -> uint32_t {
+		return reg_rate ? RateIncrements[static_cast<size_t>(rate_of(reg_rate))]
+		                : 0;
+	};
+
+	switch (op.stage) {
+	case EnvelopeStage::Attack:
+		if (op.level == 0) {
+			op.stage = EnvelopeStage::Decay;
+		} else if (rate_of(op.attack_rate) >= 60) {
+			op.level = 0;
+		} else {
+			// Exponential: each step closes part of the remaining gap
+			const auto step = (static_cast<uint64_t>(op.level + LevelOne) *
+			                   increment_of(op.attack_rate)) >>
+			                  (LevelFractionBits + 3);
+			op.level = (step >= op.level)
+			                 ? 0
+			                 : op.level - static_cast<uint32_t>(step);
+		}
+		break;
+
+	case EnvelopeStage::Decay:
+		if ((op.level >> LevelFractionBits >> 4) >= op.sustain_level) {
+			op.stage = EnvelopeStage::Sustain;
+		} else {
+			op.level += increment_of(op.decay_rate);
+		}
+		break;
+
+	case EnvelopeStage::Sustain:
+		if (!op.sustain) {
+			op.level += increment_of(op.release_rate);
+		}
+		break;
+
+	case EnvelopeStage::Release:
+		op.level += increment_of(op.release_rate);
+		break;
+	}
+
+	if (op.stage != EnvelopeStage::Attack && op.level >= OffLevel) {
+		op.level = MaxLevel;
+	}
+	return attenuation;
+}
+
+uint32_t FastOpl::AdvancePhase(Operator& op, const Channel& freq) const
+{
+	int32_t fnum = freq.fnum;
+	if (op.vibrato) {
+		int32_t range  = (fnum >> 7) & 7;
+		const auto pos = lfo.vibrato_pos;
+		if (!(pos & 3)) {
+			range = 0;
+		} else if (pos & 1) {
+			range >>= 1;
+		}
+		range >>= lfo.vibrato_shift;
+		fnum += (pos & 4) ? -range : range;
+	}
+	const auto base = static_cast<uint32_t>(fnum << freq.block) >> 1;
+
+	const auto phase = (op.phase >> 9) & 0x3ff;
+	op.phase += (base * Multipliers[op.multiplier]) >> 1;
+	return phase;
+}
+
+static int16_t operator_output(const uint8_t waveform, const uint32_t phase,
+                               const uint32_t attenuation)
+{
+	const auto entry = tables.waveforms[waveform][phase & 0x3ff];
+
+	const auto level = std::min((entry & 0x1fffu) + (attenuation << 3), 0x1fffu);
+	const auto out = static_cast<int16_t>((tables.exponent[level & 0xff] << 1) >>
+	                                      (level >> 8));
+
+	// The chip negates by inverting the bits
+	return (entry & NegativeBit) ? static_cast<int16_t>(~out) : out;
+}
+
+int16_t FastOpl::RunOperator(Operator& op, const Channel& freq, const int32_t mod,
+                             const uint32_t phase_override)
+{
+	const auto attenuation = AdvanceEnvelope(op, freq);
+	auto phase             = AdvancePhase(op, freq);
+	if (phase_override != UINT32_MAX) {
+		phase = phase_override;
+	}
+	op.prev_out = op.out;
+	op.out = operator_output(op.waveform, phase + static_cast<uint32_t>(mod),
+	                         attenuation);
+	return op.out;
+}
+
+int16_t FastOpl::RunModulator(Operator& op, const Channel& freq)
+{
+	const auto mod = freq.feedback ? (op.prev_out + op.out) >> (9 - freq.feedback)
+	                               : 0;
+	return RunOperator(op, freq, mod);
+}
+
+int32_t FastOpl::RenderTwoOp(const int channel)
+{
+	const auto& ch = channels[static_cast<size_t>(channel)];
+	auto& op1      = OperatorOf(channel, 0);
+	auto& op2      = OperatorOf(channel, 1);
+
+	if (op1.IsSilent() && op2.IsSilent()) {
+		op1.out = op1.prev_out = 0;
+		return 0;
+	}
+	const auto m = RunModulator(op1, ch);
+	if (ch.additive) {
+		return m + RunOperator(op2, ch, 0);
+	}
+	return RunOperator(op2, ch, m);
+}
+
+int32_t FastOpl::RenderFourOp(const int first_channel)
+{
+	// All four operators play at the first channel's frequency
+	const auto& first  = channels[static_cast<size_t>(first_channel)];
+	const auto& second = channels[static_cast<size_t>(first_channel + 3)];
+
+	auto& a = OperatorOf(first_channel, 0);
+	auto& b = OperatorOf(first_channel, 1);
+	auto& c = OperatorOf(first_channel + 3, 0);
+	auto& d = OperatorOf(first_channel + 3, 1);
+
+	if (a.IsSilent() && b.IsSilent() && c.IsSilent() && d.IsSilent()) {
+		a.out = a.prev_out = 0;
+		return 0;
+	}
+	const auto out_a = RunModulator(a, first);
+
+	switch ((first.additive ? 2 : 0) | (second.additive ? 1 : 0)) {
+	case 0: {
+		// A -> B -> C -> D
+		const auto out_b = RunOperator(b, first, out_a);
+		const auto out_c = RunOperator(c, first, out_b);
+		return RunOperator(d, first, out_c);
+	}
+	case 1: {
+		// (A -> B) + (C -> D)
+		const auto out_b = RunOperator(b, first, out_a);
+		const auto out_c = RunOperator(c, first, 0);
+		return out_b + RunOperator(d, first, out_c);
+	}
+	case 2: {
+		// A + (B -> C -> D)
+		const auto out_b = RunOperator(b, first, 0);
+		const auto out_c = RunOperator(c, first, out_b);
+		return out_a + RunOperator(d, first, out_c);
+	}
+	default: {
+		// A + (B -> C) + D
+		const auto out_b = RunOperator(b, first, 0);
+		const auto out_c = RunOperator(c, first, out_b);
+		return out_a + out_c + RunOperator(d, first, 0);
+	}
+	}
+}
+
+int32_t FastOpl::RenderDrums(const int channel)
+{
+	const auto& ch = channels[static_cast<size_t>(channel)];
+	auto& op1      = OperatorOf(channel, 0);
+	auto& op2      = OperatorOf(channel, 1);
+
+	// The percussion voices are louder than the melodic ones
+	if (channel == 6) {
+		// Bass drum: a regular 2-op voice where only the carrier sounds
+		const auto m = RunModulator(op1, ch);
+		return 2 * RunOperator(op2, ch, ch.additive ? 0 : m);
+	}
+
+	// The noisy voices take their phase from a mix of the hi-hat's and the
+	// top cymbal's phase bits and the noise generator. Nuked steps the
+	// noise once per operator, so the hi-hat sees the state 13 steps into
+	// the sample and the snare 16 steps in.
+	const auto bit = [](const uint32_t value, const int n) {
+		return (value >> n) & 1;
+	};
+	auto rhythm_xor = [&]() {
+		return (bit(rhythm.hh_phase, 2) ^ bit(rhythm.hh_phase, 7)) |
+		       (bit(rhythm.hh_phase, 3) ^ bit(rhythm.tc_phase, 5)) |
+		       (bit(rhythm.tc_phase, 3) ^ bit(rhythm.tc_phase, 5));
+	};
+
+	if (channel == 7) {
+		// Hi-hat and snare
+		const auto hh_attenuation = AdvanceEnvelope(op1, ch);
+		rhythm.hh_phase           = AdvancePhase(op1, ch);
+
+		const auto hh_xor   = rhythm_xor();
+		const auto hh_noise = bit(rhythm.noise, 13);
+		const auto hh_phase = (hh_xor << 9) | ((hh_xor ^ hh_noise) ? 0xd0 : 0x34);
+
+		op1.prev_out = op1.out;
+		op1.out      = operator_output(op1.waveform, hh_phase, hh_attenuation);
+
+		const auto hh_bit8  = bit(rhythm.hh_phase, 8);
+		const auto sd_noise = bit(rhythm.noise, 16);
+		const auto sd_phase = (hh_bit8 << 9) | ((hh_bit8 ^ sd_noise) << 8);
+
+		return 2 * (op1.out + RunOperator(op2, ch, 0, sd_phase));
+	}
+
+	// Tom-tom and top cymbal
+	const auto tom = RunOperator(op1, ch, 0);
+
+	const auto tc_attenuation = AdvanceEnvelope(op2, ch);
+	rhythm.tc_phase           = AdvancePhase(op2, ch);
+
+	const auto tc_phase = (rhythm_xor() << 9) | 0x80;
+
+	op2.prev_out = op2.out;
+	op2.out      = operator_output(op2.waveform, tc_phase, tc_attenuation);
+	return 2 * (tom + op2.out);
+}
+
+void FastOpl::AdvanceLfo()
+{
+	if ((lfo.timer & 0x3f) == 0x3f) {
+		lfo.tremolo_pos = static_cast<uint8_t>((lfo.tremolo_pos + 1) % 210);
+	}
+	const auto tremolo = (lfo.tremolo_pos < 105) ? lfo.tremolo_pos
+	                                             : 210 - lfo.tremolo_pos;
+	lfo.tremolo = static_cast<uint8_t>(tremolo >> lfo.tremolo_shift);
+
+	if ((lfo.timer & 0x3ff) == 0x3ff) {
+		lfo.vibrato_pos = (lfo.vibrato_pos + 1) & 7;
+	}
+	++lfo.timer;
+}
+
+void FastOpl::Generate(int16_t* frames, const size_t num_frames)
+{
+	for (size_t i = 0; i < num_frames; ++i) {
+		int32_t left  = 0;
+		int32_t right = 0;
+
+		for (auto channel = 0; channel < 18; ++channel) {
+			const auto& ch = channels[static_cast<size_t>(channel)];
+
+			int32_t out = 0;
+			switch (ch.type) {
+			case ChannelType::TwoOp: out = RenderTwoOp(channel); break;
+			case ChannelType::FourOpFirst: continue;
+			case ChannelType::FourOpSecond:
+				out = RenderFourOp(channel - 3);
+				break;
+			case ChannelType::Drum: out = RenderDrums(channel); break;
+			}
+			if (ch.left) {
+				left += out;
+			}
+			if (ch.right) {
+				right += out;
+			}
+		}
+
+		if (rhythm.reg & 0x20) {
+			// 23-bit LFSR, stepped once for each of the 36 operators
+			for (auto step = 0; step < 36; ++step) {
+				const auto n_bit = ((rhythm.noise >> 14) ^ rhythm.noise) & 1;
+				rhythm.noise = (rhythm.noise >> 1) | (n_bit << 22);
+			}
+		}
+		AdvanceLfo();
+
+		frames[i * 2]     = clip_sample(left);
+		frames[i * 2 + 1] = clip_sample(right);
+	}
+}
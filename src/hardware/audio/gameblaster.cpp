@@ -94,7 +94,7 @@ void GameBlaster::Open(const int port_choice, const std::string& card_choice,
 	const auto audio_callback = std::bind(&GameBlaster::AudioCallback, this, _1);
 
 	channel = MIXER_AddChannel(audio_callback,
-	                           RenderRateHz,
+	                           OutputRateHz,
 	                           ChannelName::Cms,
 	                           {ChannelFeature::Sleep,
 	                            ChannelFeature::Stereo,
@@ -139,33 +139,40 @@ void GameBlaster::Open(const int port_choice, const std::string& card_choice,
 	assert(devices[0]);
 	assert(devices[1]);
 
+	decimator.Configure(DecimationRatio);
+	decimator.Reset();
+	fifo.clear();
+
 	is_open = true;
 
 	MIXER_UnlockMixerThread();
 }
 
-AudioFrame GameBlaster::RenderFrame()
+// Renders the frames in one block, queueing the decimated ones
+void GameBlaster::RenderFrames(const int num_frames)
 {
-	// left and right
-	static std::array<int16_t, 2> buf = {};
+	assert(num_frames >= 0);
 
 	static device_sound_interface::sound_stream stream;
 
-	int16_t* p_buf[] = {&buf[0], &buf[1]};
+	const auto num_samples = static_cast<size_t>(num_frames);
+	for (auto& buffer : render_buffers) {
+		buffer.resize(num_samples);
+	}
+	int16_t* p_buf[] = {render_buffers[0].data(), render_buffers[1].data()};
 
 	// Accumulate the samples from both SAA-1099 devices
-	devices[0]->sound_stream_update(stream, nullptr, p_buf, 1);
-	int left_accum  = buf[0];
-	int right_accum = buf[1];
+	decimator_input.assign(num_samples, AudioFrame{});
 
-	devices[1]->sound_stream_update(stream, nullptr, p_buf, 1);
-	left_accum += buf[0];
-	right_accum += buf[1];
-
-	// Increment our time datum up to which the device has rendered
-	last_rendered_ms += MsPerRender;
+	for (const auto& device : devices) {
+		device->sound_stream_update(stream, nullptr, p_buf, num_frames);
+		for (size_t i = 0; i < num_samples; ++i) {
+			decimator_input[i] += AudioFrame(render_buffers[0][i],
+			                                 render_buffers[1][i]);
+		}
+	}
 
-	return {static_cast<float>(left_accum), static_cast<float>(right_accum)};
+	decimator.Process(decimator_input.data(), decimator_input.size(), fifo);
 }
 
 void GameBlaster::RenderUpToNow()
@@ -180,10 +187,11 @@ void GameBlaster::RenderUpToNow()
 		last_rendered_ms = now;
 		return;
 	}
-	// Keep rendering until we're current
-	while (last_rendered_ms < now) {
-		last_rendered_ms += MsPerRender;
-		fifo.emplace(RenderFrame());
+	// Render the frames up to now in one go
+	if (last_rendered_ms < now) {
+		const auto num_frames = iceil((now - last_rendered_ms) / MsPerRender);
+		last_rendered_ms += num_frames * MsPerRender;
+		RenderFrames(num_frames);
 	}
 }
 
@@ -223,20 +231,20 @@ void GameBlaster::AudioCallback(const int requested_frames)
 	}
 #endif
 
-	auto frames_remaining = requested_frames;
+	const auto num_requested = static_cast<size_t>(requested_frames);
 
-	// First, add any frames we've queued since the last callback
-	while (frames_remaining && fifo.size()) {
-		channel->AddSamples_sfloat(1, &fifo.front()[0]);
-		fifo.pop();
-		--frames_remaining;
-	}
-	// If the queue's run dry, render the remainder and sync-up our time datum
-	while (frames_remaining) {
-		auto frame = RenderFrame();
-		channel->AddSamples_sfloat(1, &frame[0]);
-		--frames_remaining;
+	// If the frames we've queued since the last callback fall short,
+	// render the remainder
+	if (fifo.size() < num_requested) {
+		const auto num_missing = num_requested - fifo.size();
+		RenderFrames(check_cast<int>(decimator.GetInputFramesFor(num_missing)));
 	}
+	assert(fifo.size() >= num_requested);
+
+	channel->AddSamples_sfloat(requested_frames, &fifo[0][0]);
+	fifo.erase(fifo.begin(), fifo.begin() + requested_frames);
+
+	// Sync-up our time datum
 	last_rendered_ms = PIC_AtomicIndex();
 }
 
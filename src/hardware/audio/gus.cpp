@@ -22,6 +22,7 @@
 #include "misc/notifications.h"
 #include "shell/autoexec.h"
 #include "shell/shell.h"
+#include "simde/x86/sse2.h"
 #include "utils/bit_view.h"
 #include "utils/math_utils.h"
 #include "utils/string_utils.h"
@@ -142,6 +143,113 @@ float Voice::GetSample(const ram_array_t& ram) noexcept
 	return sample;
 }
 
+// The number of upcoming steps that only move the control's position, short
+// of the boundary where IncrementCtrlPos() raises the IRQ, loops, or stops
+int Voice::CountLinearSteps(const VoiceCtrl& ctrl, const bool dont_loop_or_restart,
+                            const int max_steps) const noexcept
+{
+	if (ctrl.state & CTRL::DISABLED) {
+		return max_steps;
+	}
+	const auto distance = (ctrl.state & CTRL::DECREASING) ? ctrl.pos - ctrl.start
+	                                                      : ctrl.end - ctrl.pos;
+	if (distance <= 0) {
+		// Already past the boundary. Rolling over only re-raises the IRQ,
+		// so once it's raised the position just keeps moving.
+		const auto irq_is_raised = !(ctrl.state & CTRL::RAISEIRQ) ||
+		                           (ctrl.irq_state & irq_mask);
+		return (dont_loop_or_restart && irq_is_raised) ? max_steps : 0;
+	}
+	if (ctrl.inc == 0) {
+		return max_steps;
+	}
+	return std::min((distance - 1) / ctrl.inc, max_steps);
+}
+
+// Looks up the run's samples from the current wave position onwards, and the
+// next ones to interpolate towards
+template <SampleSize sample_size>
+void Voice::GatherSamples(const ram_array_t& ram, const int32_t wave_step,
+                          const bool interpolate, const int num_frames,
+                          RunBuffer& samples, RunBuffer& next_samples,
+                          RunBuffer& fractions) const noexcept
+{
+	auto read_sample = [&](const int32_t addr) {
+		return sample_size == SampleSize::Bits16 ? Read16BitSample(ram, addr)
+		                                         : Read8BitSample(ram, addr);
+	};
+
+	// Without interpolation, the next sample is the sample itself. With a
+	// zero fraction the interpolation adds zero, so it needn't be skipped.
+	const auto next_offset   = interpolate ? 1 : 0;
+	const auto fraction_mask = interpolate ? WAVE_WIDTH - 1 : 0;
+
+	auto wave_pos = wave_ctrl.pos;
+	for (auto i = 0; i < num_frames; ++i) {
+		const auto addr = wave_pos / WAVE_WIDTH;
+
+		samples[i]      = read_sample(addr);
+		next_samples[i] = read_sample(addr + next_offset);
+		fractions[i]    = static_cast<float>(wave_pos & fraction_mask);
+
+		wave_pos += wave_step;
+	}
+}
+
+// Interpolates, scales, pans and sums a run of samples into the frames, four
+// at a time. Each lane does the float operations of the frame-at-a-time
+// reference in the same order, so the two agree exactly.
+static void mix_voice_run(AudioFrame* const frames, const float* const samples,
+                          const float* const next_samples,
+                          const float* const fractions, const float* const volumes,
+                          const int num_frames, const AudioFrame pan_scalar)
+{
+	constexpr float WaveWidthInv = 1.0 / WAVE_WIDTH;
+
+	const auto wave_width_inv = simde_mm_set1_ps(WaveWidthInv);
+	const auto pan = simde_mm_setr_ps(pan_scalar.left,
+	                                  pan_scalar.right,
+	                                  pan_scalar.left,
+	                                  pan_scalar.right);
+	int i = 0;
+	for (; i + 4 <= num_frames; i += 4) {
+		const auto sample   = simde_mm_loadu_ps(samples + i);
+		const auto next     = simde_mm_loadu_ps(next_samples + i);
+		const auto fraction = simde_mm_loadu_ps(fractions + i);
+		const auto volume   = simde_mm_loadu_ps(volumes + i);
+
+		const auto delta = simde_mm_mul_ps(simde_mm_sub_ps(next, sample),
+		                                   fraction);
+		const auto step  = simde_mm_mul_ps(delta, wave_width_inv);
+
+		const auto scaled = simde_mm_mul_ps(simde_mm_add_ps(sample, step),
+		                                    volume);
+
+		// Two frames per register, each sample going to both sides
+		auto out = &frames[i].left;
+		const auto lo = simde_mm_unpacklo_ps(scaled, scaled);
+		const auto hi = simde_mm_unpackhi_ps(scaled, scaled);
+		simde_mm_storeu_ps(out,
+		                   simde_mm_add_ps(simde_mm_loadu_ps(out),
+		                                   simde_mm_mul_ps(lo, pan)));
+		simde_mm_storeu_ps(out + 4,
+		                   simde_mm_add_ps(simde_mm_loadu_ps(out + 4),
+		                                   simde_mm_mul_ps(hi, pan)));
+	}
+	for (; i < num_frames; ++i) {
+		auto sample = samples[i];
+		sample += (next_samples[i] - sample) * fractions[i] * WaveWidthInv;
+		sample *= volumes[i];
+		frames[i].left += sample * pan_scalar.left;
+		frames[i].right += sample * pan_scalar.right;
+	}
+}
+
+// Renders the frames a run at a time. Until the wave or volume control reaches
+// its boundary the positions only step by their increments, so the run's
+// samples and volume scalars are looked up without going through
+// IncrementCtrlPos() for every frame, and then mixed four frames at a time.
+// The step onto the boundary goes through IncrementCtrlPos() as before.
 void Voice::RenderFrames(const ram_array_t& ram,
                          const vol_scalars_array_t& vol_scalars,
                          const pan_scalars_array_t& pan_scalars,
@@ -153,6 +261,89 @@ void Voice::RenderFrames(const ram_array_t& ram,
 
 	const auto pan_scalar = pan_scalars.at(pan_position);
 
+	const auto is_16bit    = Is16Bit();
+	const auto rollover    = CheckWaveRolloverCondition();
+	const auto interpolate = wave_ctrl.inc < WAVE_WIDTH;
+
+	// The per-step change of a control's position, zero while it's disabled
+	auto step_of = [](const VoiceCtrl& ctrl) {
+		if (ctrl.state & CTRL::DISABLED) {
+			return 0;
+		}
+		return (ctrl.state & CTRL::DECREASING) ? -ctrl.inc : ctrl.inc;
+	};
+
+	RunBuffer samples      = {};
+	RunBuffer next_samples = {};
+	RunBuffer fractions    = {};
+	RunBuffer volumes      = {};
+
+	auto frame       = frames.data();
+	auto frames_left = check_cast<int>(frames.size());
+
+	while (frames_left > 0) {
+		// All but the run's last step stay short of the boundaries
+		const auto max_steps = std::min(frames_left, MaxRunFrames) - 1;
+
+		const auto run = 1 + std::min(CountLinearSteps(wave_ctrl, rollover, max_steps),
+		                              CountLinearSteps(vol_ctrl, false, max_steps));
+
+		const auto wave_step = step_of(wave_ctrl);
+		const auto vol_step  = step_of(vol_ctrl);
+
+		if (is_16bit) {
+			GatherSamples<SampleSize::Bits16>(
+			        ram, wave_step, interpolate, run, samples, next_samples, fractions);
+		} else {
+			GatherSamples<SampleSize::Bits8>(
+			        ram, wave_step, interpolate, run, samples, next_samples, fractions);
+		}
+
+		if (vol_step == 0) {
+			const auto vol_index = ceil_sdivide(vol_ctrl.pos, VOLUME_INC_SCALAR);
+			volumes.fill(vol_scalars.at(static_cast<size_t>(vol_index)));
+		} else {
+			auto vol_pos = vol_ctrl.pos;
+			for (auto i = 0; i < run; ++i) {
+				const auto vol_index = ceil_sdivide(vol_pos, VOLUME_INC_SCALAR);
+				volumes[i] = vol_scalars.at(static_cast<size_t>(vol_index));
+				vol_pos += vol_step;
+			}
+		}
+
+		mix_voice_run(frame,
+		              samples.data(),
+		              next_samples.data(),
+		              fractions.data(),
+		              volumes.data(),
+		              run,
+		              pan_scalar);
+
+		// Take the linear steps, then the last one as usual
+		wave_ctrl.pos += wave_step * (run - 1);
+		vol_ctrl.pos += vol_step * (run - 1);
+		IncrementCtrlPos(wave_ctrl, rollover);
+		IncrementCtrlPos(vol_ctrl, false);
+
+		frame += run;
+		frames_left -= run;
+	}
+	// Keep track of how many ms this voice has generated
+	is_16bit ? generated_16bit_ms++ : generated_8bit_ms++;
+}
+
+// The reference: one frame at a time
+void Voice::RenderFramesScalar(const ram_array_t& ram,
+                               const vol_scalars_array_t& vol_scalars,
+                               const pan_scalars_array_t& pan_scalars,
+                               std::vector<AudioFrame>& frames)
+{
+	if (vol_ctrl.state & wave_ctrl.state & CTRL::DISABLED) {
+		return;
+	}
+
+	const auto pan_scalar = pan_scalars.at(pan_position);
+
 	// Sum the voice's samples into the exising frames, angled in L-R space
 	for (auto& frame : frames) {
 		float sample = GetSample(ram);
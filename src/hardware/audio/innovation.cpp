@@ -4,17 +4,39 @@
 
 #include "private/innovation.h"
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
 #include "audio/channel_names.h"
 #include "config/config.h"
 #include "hardware/pic.h"
 #include "misc/notifications.h"
 #include "misc/support.h"
 #include "utils/checks.h"
+#include "utils/math_utils.h"
 
 CHECK_NARROWING();
 
+// Top up the FIFO in blocks of up to this many frames while there's no
+// register write waiting, so its lock is taken once per block
+constexpr int MaxIdleRenderFrames = 64;
+
+// How many chip cycles the renderer clocks in one go; reSIDfp produces at
+// most one sample per cycle, which bounds the render buffer
+constexpr uint32_t MaxCyclesPerRender = 4096;
+
+// Register writes come in bursts at the game's music tick, or steadily when
+// it plays samples through the volume register
+constexpr size_t MaxSidWriteFifoSize = 8192;
+
+// How long a port read waits for the renderer to apply the writes queued
+// before it, once the renderer stalls (such as while the mixer is locked)
+constexpr auto MaxReadWait = std::chrono::milliseconds(100);
+
 void Innovation::Open(const std::string_view model_choice,
                       const std::string_view clock_choice,
+                      const std::string_view sampling_choice,
                       const int filter_strength_6581,
                       const int filter_strength_8580, const int port_choice,
                       const std::string& channel_filter_choice)
@@ -62,6 +84,13 @@ void Innovation::Open(const std::string_view model_choice,
 
 	ms_per_clock = MillisInSecond / chip_clock;
 
+	// Resampling band-limits the chip's output with a two-pass sinc filter;
+	// decimation just holds the latest chip output, which is much cheaper
+	// but lets some of the chip's overtones alias
+	const auto sampling_method = (sampling_choice == "fast")
+	                                   ? reSIDfp::DECIMATE
+	                                   : reSIDfp::RESAMPLE;
+
 	MIXER_LockMixerThread();
 
 	// Setup the mixer and get it's sampling rate
@@ -101,10 +130,23 @@ void Innovation::Open(const std::string_view model_choice,
 
 	// Assign the sampling parameters
 	sid_service->setSamplingParameters(chip_clock,
-	                                   reSIDfp::RESAMPLE,
+	                                   sampling_method,
 	                                   sample_rate_hz,
 	                                   passband);
 
+	cycles_per_frame = chip_clock / sample_rate_hz;
+
+	// Render ahead of playback by the mixer's prebuffer
+	const auto audio_frames_per_ms = iround(sample_rate_hz / MillisInSecond);
+	audio_frame_fifo.Resize(
+	        check_cast<size_t>(MIXER_GetPreBufferMs() * audio_frames_per_ms));
+	audio_frame_fifo.Start();
+
+	write_fifo.Resize(MaxSidWriteFifoSize);
+	write_fifo.Start();
+
+	render_buffer.resize(MaxCyclesPerRender);
+
 	// Setup and assign the port address
 	const auto read_from = std::bind(&Innovation::ReadFromPort, this, _1, _2);
 	const auto write_to = std::bind(&Innovation::WriteToPort, this, _1, _2, _3);
@@ -117,21 +159,33 @@ void Innovation::Open(const std::string_view model_choice,
 	channel = std::move(mixer_channel);
 
 	// Ready state-values for rendering
-	last_rendered_ms = 0.0;
+	last_rendered_ms   = 0.0;
+	num_writes_queued  = 0;
+	num_writes_applied = 0;
+
+	// Start rendering audio
+	const auto render = std::bind(&Innovation::Render, this);
+	renderer          = std::thread(render);
+	set_thread_name(renderer, "dosbox:sid");
 
 	// Variable model_name is only used for logging, so use a const char* here
 	const char* model_name = model_choice == "8580" ? "8580" : "6581";
+	const char* sampling_name = sampling_method == reSIDfp::DECIMATE
+	                                  ? "decimated"
+	                                  : "resampled";
 	constexpr auto us_per_s = 1'000'000.0;
 	if (filter_strength == 0)
-		LOG_MSG("INNOVATION: Running on port %xh with a SID %s at %0.3f MHz",
+		LOG_MSG("INNOVATION: Running on port %xh with a SID %s at %0.3f MHz, %s",
 		        base_port,
 		        model_name,
-		        chip_clock / us_per_s);
+		        chip_clock / us_per_s,
+		        sampling_name);
 	else
-		LOG_MSG("INNOVATION: Running on port %xh with a SID %s at %0.3f MHz filtering at %d%%",
+		LOG_MSG("INNOVATION: Running on port %xh with a SID %s at %0.3f MHz, %s, filtering at %d%%",
 		        base_port,
 		        model_name,
 		        chip_clock / us_per_s,
+		        sampling_name,
 		        filter_strength);
 
 	is_open = true;
@@ -156,6 +210,15 @@ void Innovation::Close()
 	read_handler.Uninstall();
 	write_handler.Uninstall();
 
+	// Stop queueing new writes and audio frames
+	write_fifo.Stop();
+	audio_frame_fifo.Stop();
+
+	// Wait for the rendering thread to finish
+	if (renderer.joinable()) {
+		renderer.join();
+	}
+
 	// Deregister the mixer channel and remove it
 	assert(channel);
 	MIXER_DeregisterChannel(channel);
@@ -171,80 +234,149 @@ void Innovation::Close()
 
 uint8_t Innovation::ReadFromPort(io_port_t port, io_width_t)
 {
-	std::lock_guard lock(mutex);
+	// The voice 3 oscillator and envelope registers follow the chip's
+	// state, so programs that write and then read back (such as to detect
+	// the card) need to see their writes applied
+	const auto num_queued = num_writes_queued.load(std::memory_order_relaxed);
+	if (num_writes_applied.load(std::memory_order_acquire) < num_queued) {
+		assert(channel);
+		channel->WakeUp();
+
+		const auto deadline = std::chrono::steady_clock::now() + MaxReadWait;
+		while (num_writes_applied.load(std::memory_order_acquire) < num_queued &&
+		       std::chrono::steady_clock::now() < deadline) {
+			std::this_thread::yield();
+		}
+	}
+
 	const auto sid_port = static_cast<io_port_t>(port - base_port);
+
+	std::lock_guard lock(service_mutex);
 	return service->read(sid_port);
 }
 
 void Innovation::WriteToPort(io_port_t port, io_val_t value, io_width_t)
 {
-	std::lock_guard lock(mutex);
+	const auto sid_port = static_cast<io_port_t>(port - base_port);
 
-	RenderUpToNow();
+	SidWrite write = {GetNumPendingCycles(),
+	                  static_cast<uint8_t>(sid_port),
+	                  check_cast<uint8_t>(value)};
 
-	const auto data = check_cast<uint8_t>(value);
-	const auto sid_port = static_cast<io_port_t>(port - base_port);
-	service->write(sid_port, data);
+	++num_writes_queued;
+	write_fifo.Enqueue(std::move(write));
 }
 
-void Innovation::RenderUpToNow()
+uint32_t Innovation::GetNumPendingCycles()
 {
 	const auto now = PIC_FullIndex();
 
+	std::lock_guard lock(time_mutex);
+
 	// Wake up the channel and update the last rendered time datum.
 	assert(channel);
 	if (channel->WakeUp()) {
 		last_rendered_ms = now;
-		return;
+		return 0;
 	}
-	// Keep rendering until we're current
-	while (last_rendered_ms < now) {
-		last_rendered_ms += ms_per_clock;
-		if (float frame = 0.0f; MaybeRenderFrame(frame))
-			fifo.emplace(frame);
+	if (last_rendered_ms >= now) {
+		return 0;
 	}
+
+	// Return the number of chip cycles needed to get current again
+	assert(ms_per_clock > 0.0);
+
+	const auto elapsed_ms = now - last_rendered_ms;
+	const auto num_cycles = iceil(elapsed_ms / ms_per_clock);
+	last_rendered_ms += num_cycles * ms_per_clock;
+
+	return check_cast<uint32_t>(num_cycles);
 }
 
-bool Innovation::MaybeRenderFrame(float &frame)
+// The callback takes the frames the renderer has queued, waiting for it to
+// catch up if the FIFO has run dry
+void Innovation::AudioCallback(const int requested_frames)
 {
-	assert(service);
+	assert(channel);
+
+	const auto num_requested = check_cast<size_t>(requested_frames);
+
+	const auto num_dequeued = audio_frame_fifo.BulkDequeue(playback_buffer,
+	                                                       num_requested);
+	if (num_dequeued == num_requested) {
+		channel->AddSamples_mfloat(requested_frames, playback_buffer.data());
+	} else {
+		assert(!audio_frame_fifo.IsRunning());
+		channel->AddSilence();
+	}
+
+	std::lock_guard lock(time_mutex);
+	last_rendered_ms = PIC_AtomicIndex();
+}
 
-	int16_t sample = {0};
+void Innovation::RenderCyclesToFifo(uint32_t num_cycles)
+{
+	assert(service);
 
-	const auto frame_is_ready = service->clock(1, &sample);
+	while (num_cycles > 0) {
+		const auto cycles = std::min(num_cycles, MaxCyclesPerRender);
+		num_cycles -= cycles;
 
-	// Get the frame
-	if (frame_is_ready)
-		frame = static_cast<float>(sample * 2);
+		std::unique_lock lock(service_mutex);
+		const auto num_samples = service->clock(cycles, render_buffer.data());
+		lock.unlock();
 
-	return frame_is_ready;
+		if (num_samples <= 0) {
+			continue;
+		}
+		frame_buffer.resize(check_cast<size_t>(num_samples));
+		for (size_t i = 0; i < frame_buffer.size(); ++i) {
+			frame_buffer[i] = static_cast<float>(render_buffer[i] * 2);
+		}
+		audio_frame_fifo.BulkEnqueue(frame_buffer);
+	}
 }
 
-void Innovation::AudioCallback(const int requested_frames)
+// Tops up the FIFO while there's no register write waiting
+void Innovation::RenderIdleFrames()
 {
-	assert(channel);
+	const auto fifo_room = audio_frame_fifo.MaxCapacity() -
+	                       audio_frame_fifo.Size();
 
-	std::lock_guard lock(mutex);
+	// With the FIFO full, render a single frame and wait for room
+	const auto num_frames = std::clamp(static_cast<int>(fifo_room),
+	                                   1,
+	                                   MaxIdleRenderFrames);
 
-	//if (fifo.size())
-	//	LOG_MSG("INNOVATION: Queued %2lu cycle-accurate frames", fifo.size());
+	RenderCyclesToFifo(check_cast<uint32_t>(iceil(num_frames * cycles_per_frame)));
+}
 
-	auto frames_remaining = requested_frames;
+// The next register write is applied after rendering the audio leading up
+// to it
+void Innovation::ProcessWriteFromFifo()
+{
+	const auto write = write_fifo.Dequeue();
+	if (!write) {
+		return;
+	}
 
-	// First, send any frames we've queued since the last callback
-	while (frames_remaining && fifo.size()) {
-		channel->AddSamples_mfloat(1, &fifo.front());
-		fifo.pop();
-		--frames_remaining;
+	if (write->cycles_before > 0) {
+		RenderCyclesToFifo(write->cycles_before);
 	}
-	// If the queue's run dry, render the remainder and sync-up our time datum
-	while (frames_remaining) {
-		if (float frame = 0.0f; MaybeRenderFrame(frame)) {
-			channel->AddSamples_mfloat(1, &frame);
-		}
-		--frames_remaining;
+
+	std::unique_lock lock(service_mutex);
+	service->write(write->reg, write->value);
+	lock.unlock();
+
+	num_writes_applied.fetch_add(1, std::memory_order_release);
+}
+
+// Keep the FIFO populated with freshly rendered frames
+void Innovation::Render()
+{
+	while (write_fifo.IsRunning()) {
+		write_fifo.IsEmpty() ? RenderIdleFrames() : ProcessWriteFromFifo();
 	}
-	last_rendered_ms = PIC_AtomicIndex();
 }
 
 Innovation innovation;
@@ -260,6 +392,7 @@ static void innovation_init(Section *sec)
 
 	const auto model_choice          = conf->GetString("sidmodel");
 	const auto clock_choice          = conf->GetString("sidclock");
+	const auto sampling_choice       = conf->GetString("sidsampling");
 	const auto port_choice           = conf->GetHex("sidport");
 	const auto filter_strength_6581  = conf->GetInt("6581filter");
 	const auto filter_strength_8580  = conf->GetInt("8580filter");
@@ -267,6 +400,7 @@ static void innovation_init(Section *sec)
 
 	innovation.Open(model_choice,
 	                clock_choice,
+	                sampling_choice,
 	                filter_strength_6581,
 	                filter_strength_8580,
 	                port_choice,
@@ -302,6 +436,15 @@ static void init_innovation_dosbox_settings(SectionProp& sec_prop)
 	        "  c64pal:   0.985 MHz, per PAL Commodore PCs and the DuoSID.\n"
 	        "  hardsid:  1.000 MHz, available on the DuoSID.");
 
+	// Sampling method
+	str_prop = sec_prop.AddString("sidsampling", when_idle, "accurate");
+	str_prop->SetValues({"accurate", "fast"});
+	str_prop->SetHelp(
+	        "How the SID chip's output is brought down to the mixer's sample rate:\n"
+	        "  accurate:  Band-limit it with a two-pass resampler (default).\n"
+	        "  fast:      Sample the chip's latest output. Much cheaper on the CPU,\n"
+	        "             at the cost of some aliasing in the treble.");
+
 	// IO Address
 	auto* hex_prop          = sec_prop.AddHex("sidport", when_idle, 0x280);
 	hex_prop->SetValues({"240", "260", "280", "2a0", "2c0"});
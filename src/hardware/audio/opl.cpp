@@ -92,6 +92,26 @@ static constexpr void initialize_opl_tone_generators(opl3_chip& chip)
 	}
 }
 
+// The same settings for the fast core, as the register writes that produce
+// them
+static void initialize_opl_tone_generators(FastOpl& chip)
+{
+	auto write = [&](const int reg, const uint8_t val) {
+		chip.WriteReg(check_cast<uint16_t>(reg), val);
+	};
+	for (auto offset : {0x00, 0x01, 0x02, 0x08, 0x09, 0x0a, 0x10, 0x11, 0x12}) {
+		write(0x20 + offset, 0x01); // multiplier 1
+		write(0x40 + offset, 0x4f); // key scale 1, total level 15
+		write(0x60 + offset, 0xf1); // attack 15, decay 1
+		write(0x80 + offset, 0x53); // sustain 5, release 3
+	}
+	for (auto offset : {0x03, 0x04, 0x05, 0x0b, 0x0c, 0x0d, 0x13, 0x14, 0x15}) {
+		write(0x20 + offset, 0x11); // key scale rate, multiplier 1
+		write(0x60 + offset, 0xf2); // attack 15, decay 2
+		write(0x80 + offset, 0x74); // sustain 7, release 4
+	}
+}
+
 Timer::Timer(const int micros)
         : clock_interval(micros * 0.001) // interval in milliseconds
 {
@@ -259,6 +279,10 @@ void Opl::Init()
 
 	if (opl.mode == OplMode::Esfm) {
 		ESFM_init(&esfm.chip);
+	} else if (opl.core == OplCore::Fast) {
+		opl.fast.Reset();
+
+		initialize_opl_tone_generators(opl.fast);
 	} else {
 		OPL3_Reset(&opl.chip, OplSampleRateHz);
 
@@ -267,6 +291,11 @@ void Opl::Init()
 
 	ms_per_frame = MillisInSecond / OplSampleRateHz;
 
+	queued_writes.clear();
+	rendered_frames.clear();
+	frames_rendered = 0;
+	frames_elapsed  = 0;
+
 	memset(cache, 0, ARRAY_LEN(cache));
 
 	switch (opl.mode) {
@@ -295,16 +324,30 @@ void Opl::Init()
 }
 
 void Opl::WriteReg(const io_port_t selected_reg, const uint8_t val)
+{
+	if (opl.mode != OplMode::Esfm && selected_reg == 0x105) {
+		opl.newm = selected_reg & 0x01;
+	}
+
+	// The guest can read back the ESFM's native mode registers, so those
+	// writes can't wait
+	if (opl.mode == OplMode::Esfm && esfm.mode == EsfmMode::Native) {
+		ApplyWrite(selected_reg, val);
+		return;
+	}
+	queued_writes.push_back({frames_elapsed, selected_reg, val});
+}
+
+void Opl::ApplyWrite(const uint16_t reg, const uint8_t val)
 {
 	if (opl.mode == OplMode::Esfm) {
-		ESFM_write_reg_buffered_fast(&esfm.chip, selected_reg, val);
+		ESFM_write_reg_buffered_fast(&esfm.chip, reg, val);
 
+	} else if (opl.core == OplCore::Fast) {
+		opl.fast.WriteReg(reg, val);
 
-	} else { // OPL
-		OPL3_WriteRegBuffered(&opl.chip, selected_reg, val);
-		if (selected_reg == 0x105) {
-			opl.newm = selected_reg & 0x01;
-		}
+	} else { // Nuked OPL
+		OPL3_WriteRegBuffered(&opl.chip, reg, val);
 	}
 }
 
@@ -376,54 +419,91 @@ int16_t remove_dc_bias(const int16_t back_sample)
 	return static_cast<int16_t>(front_sample - average);
 }
 
-AudioFrame Opl::RenderFrame()
+void Opl::RenderBlock(const int num_frames, std::vector<AudioFrame>& out)
 {
-	static int16_t buf[2] = {};
+	assert(num_frames > 0);
 
+	render_buf.resize(static_cast<size_t>(num_frames) * 2);
+	auto buf = render_buf.data();
+
+	const auto n = static_cast<uint32_t>(num_frames);
 	if (opl.mode == OplMode::Esfm) {
-		ESFM_generate_stream(&esfm.chip, buf, 1);
+		ESFM_generate_stream(&esfm.chip, buf, n);
+	} else if (opl.core == OplCore::Fast) {
+		opl.fast.Generate(buf, n);
+	} else {
+		OPL3_GenerateStream(&opl.chip, buf, n);
+	}
 
-		if (ctrl.wants_dc_bias_removed) {
-			buf[0] = remove_dc_bias<Left>(buf[0]);
-			buf[1] = remove_dc_bias<Right>(buf[1]);
+	if (ctrl.wants_dc_bias_removed) {
+		for (size_t i = 0; i < render_buf.size(); i += 2) {
+			buf[i]     = remove_dc_bias<Left>(buf[i]);
+			buf[i + 1] = remove_dc_bias<Right>(buf[i + 1]);
 		}
+	}
 
-		AudioFrame frame = {buf[0], buf[1]};
-		return frame;
+	const auto out_start = out.size();
+	out.resize(out_start + n);
+	auto frames = &out[out_start];
 
-	} else { // OPL
-		OPL3_GenerateStream(&opl.chip, buf, 1);
+	if (adlib_gold) {
+		assert(opl.mode == OplMode::Opl3Gold);
+		adlib_gold->Process(buf, num_frames, &frames[0][0]);
+	} else {
+		for (size_t i = 0; i < n; ++i) {
+			frames[i] = {buf[i * 2], buf[i * 2 + 1]};
+		}
+	}
+}
 
-		if (ctrl.wants_dc_bias_removed) {
-			buf[0] = remove_dc_bias<Left>(buf[0]);
-			buf[1] = remove_dc_bias<Right>(buf[1]);
+void Opl::RenderFrames(const uint64_t end_frame, std::vector<AudioFrame>& out)
+{
+	// Render in blocks between the writes that fall before the end frame
+	while (frames_rendered < end_frame) {
+		while (!queued_writes.empty() &&
+		       queued_writes.front().frame <= frames_rendered) {
+			const auto& write = queued_writes.front();
+			ApplyWrite(write.reg, write.val);
+			queued_writes.pop_front();
 		}
 
-		AudioFrame frame = {};
-		if (adlib_gold) {
-			adlib_gold->Process(buf, 1, &frame[0]);
-		} else {
-			frame.left  = buf[0];
-			frame.right = buf[1];
+		auto block_end = end_frame;
+		if (!queued_writes.empty()) {
+			block_end = std::min(block_end, queued_writes.front().frame);
 		}
-		return frame;
+		RenderBlock(check_cast<int>(block_end - frames_rendered), out);
+		frames_rendered = block_end;
 	}
 }
 
-void Opl::RenderUpToNow()
+void Opl::RenderQueuedFrames()
+{
+	RenderFrames(frames_elapsed, rendered_frames);
+
+	// Also apply the writes due right now
+	while (!queued_writes.empty()) {
+		const auto& write = queued_writes.front();
+		ApplyWrite(write.reg, write.val);
+		queued_writes.pop_front();
+	}
+}
+
+void Opl::AdvanceToNow()
 {
 	const auto now = PIC_FullIndex();
 
-	// Wake up the channel and update the last rendered time datum.
+	// Wake up the channel and update the last queued time datum.
 	assert(channel);
 	if (channel->WakeUp()) {
-		last_rendered_ms = now;
+		last_queued_ms = now;
 		return;
 	}
-	// Keep rendering until we're current
-	while (last_rendered_ms < now) {
-		last_rendered_ms += ms_per_frame;
-		fifo.emplace(RenderFrame());
+	// Count the frames up to now; they're rendered when the mixer asks
+	if (last_queued_ms < now) {
+		const auto num_frames = std::ceil((now - last_queued_ms) / ms_per_frame);
+
+		last_queued_ms += num_frames * ms_per_frame;
+		frames_elapsed += static_cast<uint64_t>(num_frames);
 	}
 }
 
@@ -432,27 +512,36 @@ void Opl::AudioCallback(const int requested_frames)
 	std::lock_guard lock(mutex);
 	assert(channel);
 #if 0
-	if (fifo.size()) {
-		LOG_MSG("%s: Queued %2lu cycle-accurate frames",
+	if (frames_elapsed > frames_rendered) {
+		LOG_MSG("%s: Queued %2llu cycle-accurate frames",
 		        channel->GetName().c_str(),
-		        fifo.size());
+		        frames_elapsed - frames_rendered);
 	}
 #endif
 	auto frames_remaining = requested_frames;
 
-	// First, send any frames we've queued since the last callback
-	while (frames_remaining && fifo.size()) {
-		channel->AddSamples_sfloat(1, &fifo.front()[0]);
-		fifo.pop();
-		--frames_remaining;
+	// First, send any frames we had to render since the last callback
+	const auto num_rendered = std::min(check_cast<int>(rendered_frames.size()),
+	                                   frames_remaining);
+	if (num_rendered > 0) {
+		channel->AddSamples_sfloat(num_rendered, &rendered_frames[0][0]);
+		rendered_frames.erase(rendered_frames.begin(),
+		                      rendered_frames.begin() + num_rendered);
+		frames_remaining -= num_rendered;
 	}
-	// If the queue's run dry, render the remainder and sync-up our time datum
-	while (frames_remaining) {
-		const auto frame = RenderFrame();
-		channel->AddSamples_sfloat(1, &frame[0]);
-		--frames_remaining;
+
+	// Then render the rest, applying the queued writes as their frames come
+	// up. Writes further ahead wait for the next callback.
+	if (frames_remaining > 0) {
+		callback_frames.clear();
+		RenderFrames(frames_rendered + static_cast<uint64_t>(frames_remaining),
+		             callback_frames);
+		channel->AddSamples_sfloat(frames_remaining, &callback_frames[0][0]);
 	}
-	last_rendered_ms = PIC_AtomicIndex();
+
+	// If the queue's run dry, sync-up our time datum
+	frames_elapsed = std::max(frames_elapsed, frames_rendered);
+	last_queued_ms = PIC_AtomicIndex();
 }
 
 void Opl::CacheWrite(const io_port_t port, const uint8_t val)
@@ -566,11 +655,14 @@ uint8_t Opl::AdlibGoldControlRead()
 void Opl::PortWrite(const io_port_t port, const io_val_t value, const io_width_t)
 {
 	std::lock_guard lock(mutex);
-	RenderUpToNow();
+	AdvanceToNow();
 
 	const auto val = check_cast<uint8_t>(value);
 
 	if (opl.mode == OplMode::Esfm && esfm.mode == EsfmMode::Native) {
+		// Native mode writes go straight to the chip
+		RenderQueuedFrames();
+
 		switch (port & 3) {
 		case 0:
 			// Disable native mode
@@ -604,6 +696,7 @@ void Opl::PortWrite(const io_port_t port, const io_val_t value, const io_width_t
 		case OplMode::Opl3Gold:
 			if (port == 0x38b) {
 				if (ctrl.active) {
+					RenderQueuedFrames();
 					AdlibGoldControlWrite(val);
 					break;
 				}
@@ -633,6 +726,7 @@ void Opl::PortWrite(const io_port_t port, const io_val_t value, const io_width_t
 		case OplMode::Esfm:
 			if (!chip[0].Write(reg.normal, val)) {
 				if (reg.normal == 0x105 && (val & 0x80)) {
+					RenderQueuedFrames();
 					esfm.mode = EsfmMode::Native;
 
 					if (capture) {
@@ -816,6 +910,14 @@ Opl::Opl(Section* configuration, const OplMode _opl_mode)
 	SectionProp* section = static_cast<SectionProp*>(configuration);
 	const auto base = static_cast<uint16_t>(section->GetHex("sbbase"));
 
+	if (section->GetString("oplemu") == "fast") {
+		if (opl.mode == OplMode::Esfm) {
+			LOG_WARNING("OPL: The fast OPL core can't emulate the ESFM, using ESFMu");
+		} else {
+			opl.core = OplCore::Fast;
+		}
+	}
+
 	ctrl.mixer_enabled = section->GetBool("sbmixer");
 
 	std::set channel_features = {ChannelFeature::Sleep,
@@ -928,9 +1030,10 @@ Opl::Opl(Section* configuration, const OplMode _opl_mode)
 
 	MAPPER_AddHandler(OPL_SaveRawEvent, SDL_SCANCODE_UNKNOWN, 0, "caprawopl", "Rec. OPL");
 
-	LOG_MSG("%s: Running %s on ports %xh and %xh",
+	LOG_MSG("%s: Running %s%s on ports %xh and %xh",
 	        channel->GetName().c_str(),
 	        to_string(opl.mode),
+	        (opl.core == OplCore::Fast) ? " with the fast core" : "",
 	        base,
 	        Port::AdLib::Command);
 
@@ -1013,8 +1116,15 @@ static void init_opl_dosbox_settings(SectionProp& secprop)
 	        "(1990), and Wizardry 7 (1992). Please open an issue ticket if you find other\n"
 	        "affected games.");
 
-	pstring = secprop.AddString("oplemu", deprecated, "");
-	pstring->SetHelp("Only 'nuked' OPL emulation is supported now.");
+	pstring = secprop.AddString("oplemu", when_idle, "nuked");
+	pstring->SetValues({"nuked", "fast"});
+	pstring->SetHelp(
+	        "OPL synth core to use ('nuked' by default).\n"
+	        "  nuked:  Cycle-accurate Nuked OPL3 emulation (default).\n"
+	        "  fast:   Table-driven emulation using a fraction of the CPU time, for headless\n"
+	        "          or low-power hosts. It follows Nuked closely but not exactly;\n"
+	        "          envelopes are smoothed and writes skip the chip's write buffer.\n"
+	        "Note: 'oplmode = esfm' always uses the ESFMu core.");
 
 	pstring = secprop.AddString("opl_filter", when_idle, "auto");
 	pstring->SetHelp(
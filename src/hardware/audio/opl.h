@@ -7,13 +7,15 @@
 #include "dosbox.h"
 
 #include <cmath>
+#include <deque>
 #include <memory>
-#include <queue>
+#include <vector>
 
 #include "ESFMu/esfm.h"
 #include "nuked/opl3.h"
 
 #include "private/adlib_gold.h"
+#include "private/fast_opl.h"
 
 #include "audio/mixer.h"
 #include "config/setup.h"
@@ -83,6 +85,9 @@ class OplCapture;
 
 enum class EsfmMode { Legacy, Native };
 
+// The synth core rendering the OPL modes; ESFM always uses ESFMu
+enum class OplCore { Nuked, Fast };
+
 class Opl {
 public:
 	MixerChannelPtr channel = {};
@@ -104,14 +109,15 @@ private:
 	IO_ReadHandleObject ReadHandler[3];
 	IO_WriteHandleObject WriteHandler[3];
 
-	std::queue<AudioFrame> fifo = {};
 	std::mutex mutex = {};
 
 	OplChip chip[2]  = {};
 
 	struct {
 		OplMode mode   = OplMode::None;
+		OplCore core   = OplCore::Nuked;
 		opl3_chip chip = {};
+		FastOpl fast   = {};
 		uint8_t newm   = 0;
 	} opl = {};
 
@@ -123,8 +129,31 @@ private:
 	} esfm = {};
 
 	// Playback related
-	double last_rendered_ms = 0.0;
-	double ms_per_frame     = 0.0;
+	//
+	// Register writes are queued with the emulated time they happened at,
+	// counted in frames, and played back when the mixer asks for audio. The
+	// chip then renders in blocks, only stopping at the frames where a
+	// write is due. Writes whose effects the guest can read back (ESFM
+	// native mode) or that change the post-processing (AdLib Gold) render
+	// the queue up to the present first, into `rendered_frames`.
+	struct QueuedWrite {
+		uint64_t frame = 0;
+		uint16_t reg   = 0;
+		uint8_t val    = 0;
+	};
+	std::deque<QueuedWrite> queued_writes = {};
+
+	std::vector<AudioFrame> rendered_frames = {};
+	std::vector<AudioFrame> callback_frames = {};
+	std::vector<int16_t> render_buf         = {};
+
+	// Frames the chip has rendered, and frames of emulated time as of the
+	// last register write
+	uint64_t frames_rendered = 0;
+	uint64_t frames_elapsed  = 0;
+
+	double last_queued_ms = 0.0;
+	double ms_per_frame   = 0.0;
 
 	// Last selected address in the chip for the different modes
 	union {
@@ -147,8 +176,11 @@ private:
 	void Init();
 
 	void AudioCallback(const int frames);
-	AudioFrame RenderFrame();
-	void RenderUpToNow();
+	void AdvanceToNow();
+	void RenderQueuedFrames();
+	void RenderFrames(const uint64_t end_frame, std::vector<AudioFrame>& out);
+	void RenderBlock(const int num_frames, std::vector<AudioFrame>& out);
+	void ApplyWrite(const uint16_t reg, const uint8_t val);
 
 	void PortWrite(const io_port_t port, const io_val_t value,
 	               const io_width_t width);
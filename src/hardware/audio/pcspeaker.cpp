@@ -7,6 +7,7 @@
 #include "private/pcspeaker_discrete.h"
 #include "private/pcspeaker_impulse.h"
 
+#include "textmode_server/textmode_server.h"
 #include "utils/math_utils.h"
 
 // The PC speaker managed pointer
@@ -91,21 +92,46 @@ void PCSPEAKER_Init(Section *section)
 	MIXER_UnlockMixerThread();
 }
 
+// What PIT channel 2 last played, to report beeps whether or not the
+// speaker is emulated
+static int beep_counter      = 0;
+static PitMode beep_pit_mode = PitMode::Inactive;
+static bool is_beeping       = false;
+
+// A square wave through the opened gate and data line is a tone; toggling
+// the data line by hand (digitized sound) isn't
+static void notify_beep(const PpiPortB& port_b)
+{
+	const auto is_square_wave = (beep_pit_mode == PitMode::SquareWave ||
+	                             beep_pit_mode == PitMode::SquareWaveAlias);
+
+	const auto was_beeping = is_beeping;
+	is_beeping = port_b.timer2_gating_and_speaker_out.all() && is_square_wave;
+	if (is_beeping && !was_beeping) {
+		const auto divisor = (beep_counter > 0) ? beep_counter : 0x10000;
+		TEXTMODESERVER_OnBeep(PIT_TICK_RATE / divisor);
+	}
+}
+
 // PC speaker external API, used by the PIT timer and keyboard
 void PCSPEAKER_SetCounter(const int counter, const PitMode pit_mode)
 {
+	beep_counter  = counter;
+	beep_pit_mode = pit_mode;
 	if (pc_speaker)
 		pc_speaker->SetCounter(counter, pit_mode);
 }
 
 void PCSPEAKER_SetPITControl(const PitMode pit_mode)
 {
+	beep_pit_mode = pit_mode;
 	if (pc_speaker)
 		pc_speaker->SetPITControl(pit_mode);
 }
 
 void PCSPEAKER_SetType(const PpiPortB &port_b)
 {
+	notify_beep(port_b);
 	if (pc_speaker)
 		pc_speaker->SetType(port_b);
 }
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_FAST_OPL_H
+#define DOSBOX_FAST_OPL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Fast OPL2/OPL3 synth
+// ~~~~~~~~~~~~~~~~~~~~
+// A table-driven alternative to the Nuked OPL3 core for hosts where the
+// cycle-accurate emulation is too costly, such as headless servers running
+// many instances or low-power ARM boards. It uses Nuked's register map,
+// waveforms, log-sine and exponent tables and output levels, so instruments
+// sound the same to most ears, but cuts corners where the cost hides:
+//
+//   - The envelopes advance by their average per-sample step in fixed
+//     point instead of stepping on the chip's envelope clock, so the
+//     attack, decay and release times match but not their stair-steps.
+//
+//   - Operators that are keyed off and fully attenuated are skipped, and
+//     so are whole channels of them. Most music keeps fewer than half of
+//     the 36 operators sounding at once.
+//
+//   - Register writes take effect on the next sample rather than going
+//     through Nuked's two-sample write buffer.
+//
+// The register map and the rhythm, 4-op and stereo modes are those of the
+// YMF262. The OPL2 and dual-OPL2 modes are the subsets the Opl device
+// already writes for them. The timers aren't part of the synth; they're
+// emulated by OplChip either way.
+class FastOpl {
+public:
+	FastOpl();
+
+	void Reset();
+
+	// Takes the OPL3 register address, 0x000 to 0x1ff
+	void WriteReg(const uint16_t reg, const uint8_t val);
+
+	// Renders interleaved left/right frames at the chip's 49716 Hz rate
+	void Generate(int16_t* frames, const size_t num_frames);
+
+private:
+	enum class EnvelopeStage : uint8_t { Attack, Decay, Sustain, Release };
+
+	enum class ChannelType : uint8_t {
+		TwoOp,
+		// The lower channel of a 4-op pair holds the first two operators
+		FourOpFirst,
+		// The upper channel holds the last two, and its output enables
+		FourOpSecond,
+		Drum,
+	};
+
+	struct Operator {
+		// 0x20: tremolo, vibrato, sustain, key scale rate, multiplier
+		bool tremolo        = false;
+		bool vibrato        = false;
+		bool sustain        = false;
+		bool key_scale_rate = false;
+		uint8_t multiplier  = 0;
+
+		// 0x40: key scale level, total level
+		uint8_t key_scale   = 0;
+		uint8_t total_level = 0;
+
+		// 0x60, 0x80: attack, decay, sustain level, release
+		uint8_t attack_rate   = 0;
+		uint8_t decay_rate    = 0;
+		uint8_t sustain_level = 0;
+		uint8_t release_rate  = 0;
+
+		// 0xe0
+		uint8_t waveform = 0;
+
+		// Bit 0 is the channel's key-on, bit 1 the rhythm section's
+		uint8_t key = 0;
+
+		EnvelopeStage stage = EnvelopeStage::Release;
+
+		// Attenuation in 0.1875 dB steps, with 15 fractional bits
+		uint32_t level = 0;
+
+		uint32_t phase = 0;
+
+		int16_t out      = 0;
+		int16_t prev_out = 0;
+
+		bool IsSilent() const;
+	};
+
+	struct Channel {
+		uint16_t fnum    = 0;
+		uint8_t block    = 0;
+		uint8_t feedback = 0;
+		bool additive    = false;
+		bool left        = true;
+		bool right       = true;
+
+		ChannelType type = ChannelType::TwoOp;
+	};
+
+	struct Lfo {
+		uint32_t timer        = 0;
+		uint8_t tremolo_pos   = 0;
+		uint8_t tremolo       = 0;
+		uint8_t tremolo_shift = 4;
+		uint8_t vibrato_pos   = 0;
+		uint8_t vibrato_shift = 1;
+	};
+
+	struct Rhythm {
+		uint8_t reg    = 0;
+		uint32_t noise = 1;
+
+		// The hi-hat's and top cymbal's own phases, whose bits make up
+		// the noisy percussion
+		uint32_t hh_phase = 0;
+		uint32_t tc_phase = 0;
+	};
+
+	Operator& OperatorOf(const int channel, const int index);
+
+	void KeyChannel(const int channel, const bool key_on);
+	void SetKey(Operator& op, const uint8_t key_bit, const bool key_on);
+	void UpdateChannelTypes();
+
+	int16_t RunOperator(Operator& op, const Channel& freq, const int32_t mod,
+	                    const uint32_t phase_override = UINT32_MAX);
+	int16_t RunModulator(Operator& op, const Channel& freq);
+	uint32_t AdvancePhase(Operator& op, const Channel& freq) const;
+	uint32_t AdvanceEnvelope(Operator& op, const Channel& freq) const;
+
+	int32_t RenderTwoOp(const int channel);
+	int32_t RenderFourOp(const int first_channel);
+	int32_t RenderDrums(const int channel);
+	void AdvanceLfo();
+
+	std::array<Operator, 36> operators = {};
+	std::array<Channel, 18> channels   = {};
+
+	Lfo lfo       = {};
+	Rhythm rhythm = {};
+
+	// 0x08 note select, 0x104 4-op connections, 0x105 OPL3 mode
+	bool note_select     = false;
+	uint8_t four_op_mask = 0;
+	bool opl3_mode       = false;
+};
+
+#endif // DOSBOX_FAST_OPL_H
@@ -8,11 +8,11 @@
 
 #include <array>
 #include <memory>
-#include <queue>
 #include <string>
 #include <vector>
 
 #include "audio/audio_frame.h"
+#include "audio/integer_decimator.h"
 #include "audio/mixer.h"
 #include "hardware/port.h"
 #include "misc/support.h"
@@ -32,7 +32,7 @@ public:
 
 private:
 	// Audio rendering
-	AudioFrame RenderFrame();
+	void RenderFrames(const int num_frames);
 	void AudioCallback(const int requested_frames);
 	void RenderUpToNow();
 
@@ -61,15 +61,22 @@ private:
 
 	std::unique_ptr<saa1099_device> devices[2] = {};
 
-	std::queue<AudioFrame> fifo = {};
+	IntegerDecimator<AudioFrame> decimator = {};
+
+	std::array<std::vector<int16_t>, 2> render_buffers = {};
+	std::vector<AudioFrame> decimator_input            = {};
+	std::vector<AudioFrame> fifo                       = {};
 
 	std::mutex mutex = {};
 
-	// Static rate-related configuration
+	// Static rate-related configuration. The chips are rendered at a high
+	// rate for accurate timing, and decimated for the mixer.
 	static constexpr auto ChipClockHz   = 14318180 / 2;
 	static constexpr auto RenderDivisor = 32;
 	static constexpr auto RenderRateHz = ceil_sdivide(ChipClockHz, RenderDivisor);
 	static constexpr auto MsPerRender = MillisInSecond / RenderRateHz;
+	static constexpr auto DecimationRatio = 4;
+	static constexpr auto OutputRateHz    = RenderRateHz / DecimationRatio;
 
 	// Runtime states
 	double last_rendered_ms        = 0;
@@ -112,6 +112,12 @@ public:
 	                  const pan_scalars_array_t& pan_scalars,
 	                  std::vector<AudioFrame>& frames);
 
+	// The reference: one frame at a time through IncrementCtrlPos()
+	void RenderFramesScalar(const ram_array_t& ram,
+	                        const vol_scalars_array_t& vol_scalars,
+	                        const pan_scalars_array_t& pan_scalars,
+	                        std::vector<AudioFrame>& frames);
+
 	uint8_t ReadVolState() const noexcept;
 	uint8_t ReadWaveState() const noexcept;
 	void ResetCtrls() noexcept;
@@ -132,6 +138,18 @@ private:
 	Voice(const Voice&)            = delete; // prevent copying
 	Voice& operator=(const Voice&) = delete; // prevent assignment
 	bool CheckWaveRolloverCondition() noexcept;
+	int CountLinearSteps(const VoiceCtrl& ctrl, const bool dont_loop_or_restart,
+	                     const int max_steps) const noexcept;
+
+	// RenderFrames() works through runs of up to this many frames
+	static constexpr int MaxRunFrames = 128;
+	using RunBuffer = std::array<float, MaxRunFrames>;
+
+	template <SampleSize sample_size>
+	void GatherSamples(const ram_array_t& ram, const int32_t wave_step,
+	                   const bool interpolate, const int num_frames,
+	                   RunBuffer& samples, RunBuffer& next_samples,
+	                   RunBuffer& fractions) const noexcept;
 	bool Is16Bit() const noexcept;
 	float GetVolScalar(const vol_scalars_array_t& vol_scalars);
 	float GetSample(const ram_array_t& ram) noexcept;
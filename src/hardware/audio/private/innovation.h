@@ -6,19 +6,32 @@
 
 #include "dosbox.h"
 
+#include <atomic>
 #include <memory>
-#include <queue>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "residfp/SID.h"
 
 #include "audio/mixer.h"
 #include "hardware/port.h"
+#include "utils/spsc_queue.h"
+
+// A register write, stamped with the chip cycles that elapsed since the
+// previous one so the renderer can clock the SID up to it before applying it
+struct SidWrite {
+	uint32_t cycles_before = 0;
+	uint8_t reg            = 0;
+	uint8_t value          = 0;
+};
 
 class Innovation {
 public:
 	void Open(const std::string_view model_choice,
-	          const std::string_view clock_choice, int filter_strength_6581,
+	          const std::string_view clock_choice,
+	          const std::string_view sampling_choice, int filter_strength_6581,
 	          int filter_strength_8580, int port_choice,
 	          const std::string& channel_filter_choice);
 
@@ -29,30 +42,50 @@ public:
 	}
 
 private:
-	bool MaybeRenderFrame(float &frame);
 	void AudioCallback(const int requested_frames);
+	uint32_t GetNumPendingCycles();
 	uint8_t ReadFromPort(io_port_t port, io_width_t width);
-	void RenderUpToNow();
-	int16_t TallySilence(const int16_t sample);
 	void WriteToPort(io_port_t port, io_val_t value, io_width_t width);
 
+	void ProcessWriteFromFifo();
+	void RenderCyclesToFifo(const uint32_t num_cycles);
+	void RenderIdleFrames();
+	void Render();
+
 	// Managed objects
 	MixerChannelPtr channel               = nullptr;
 	IO_ReadHandleObject read_handler      = {};
 	IO_WriteHandleObject write_handler    = {};
 	std::unique_ptr<reSIDfp::SID> service = {};
-	std::queue<float> fifo                = {};
-	std::mutex mutex                      = {};
+	std::mutex service_mutex              = {};
+	std::thread renderer                  = {};
+
+	SpscQueue<float> audio_frame_fifo{1};
+	SpscQueue<SidWrite> write_fifo{1};
+
+	// Only touched by the renderer
+	std::vector<int16_t> render_buffer = {};
+	std::vector<float> frame_buffer    = {};
+
+	// Only touched by the mixer callback
+	std::vector<float> playback_buffer = {};
 
 	// Initial configuration
-	double chip_clock            = 0.0;
-	double ms_per_clock          = 0.0;
-	io_port_t base_port          = 0;
-	int idle_after_silent_frames = 0;
+	double chip_clock       = 0.0;
+	double ms_per_clock     = 0.0;
+	double cycles_per_frame = 0.0;
+	io_port_t base_port     = 0;
 
-	// Runtime states
+	// Runtime states. The mixer thread resets the time datum after each
+	// callback, so it's guarded by its own lock.
+	std::mutex time_mutex   = {};
 	double last_rendered_ms = 0.0;
-	bool is_open            = false;
+
+	// Reads wait for the renderer to apply every write queued before them
+	std::atomic<uint64_t> num_writes_queued  = 0;
+	std::atomic<uint64_t> num_writes_applied = 0;
+
+	bool is_open = false;
 };
 
 #endif
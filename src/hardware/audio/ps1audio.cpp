@@ -10,9 +10,10 @@
 #include <cassert>
 #include <cstring>
 #include <memory>
-#include <queue>
+#include <vector>
 
 #include "audio/channel_names.h"
+#include "audio/integer_decimator.h"
 #include "config/config.h"
 #include "config/setup.h"
 #include "dosbox.h"
@@ -381,7 +382,7 @@ private:
 	Ps1Synth& operator=(const Ps1Synth&) = delete;
 
 	void AudioCallback(const int requested_frames);
-	float RenderSample();
+	void RenderFrames(const int num_frames);
 	void RenderUpToNow();
 
 	void WriteSoundGeneratorPort205(io_port_t port, io_val_t, io_width_t);
@@ -389,16 +390,22 @@ private:
 	// Managed objects
 	MixerChannelPtr channel            = nullptr;
 	IO_WriteHandleObject write_handler = {};
-	std::queue<float> fifo             = {};
+	IntegerDecimator<float> decimator  = {};
+	std::vector<int16_t> render_buffer = {};
+	std::vector<float> decimator_input = {};
+	std::vector<float> fifo            = {};
 	std::mutex mutex                   = {};
 	sn76496_device device;
 
-	// Static rate-related configuration
-	static constexpr auto Ps1PsgClockHz = 4'000'000;
-	static constexpr auto RenderDivisor = 16;
-	static constexpr auto RenderRateHz  = ceil_sdivide(Ps1PsgClockHz,
+	// Static rate-related configuration. The chip is rendered at a high
+	// rate for accurate timing, and decimated for the mixer.
+	static constexpr auto Ps1PsgClockHz   = 4'000'000;
+	static constexpr auto RenderDivisor   = 16;
+	static constexpr auto RenderRateHz    = ceil_sdivide(Ps1PsgClockHz,
                                                           RenderDivisor);
-	static constexpr auto MsPerRender   = MillisInSecond / RenderRateHz;
+	static constexpr auto MsPerRender     = MillisInSecond / RenderRateHz;
+	static constexpr auto DecimationRatio = 4;
+	static constexpr auto OutputRateHz    = RenderRateHz / DecimationRatio;
 
 	// Runtime states
 	device_sound_interface* dsi = static_cast<sn76496_base_device*>(&device);
@@ -417,7 +424,7 @@ Ps1Synth::Ps1Synth(const std::string& filter_choice)
 	const auto callback = std::bind(&Ps1Synth::AudioCallback, this, _1);
 
 	channel = MIXER_AddChannel(callback,
-	                           RenderRateHz,
+	                           OutputRateHz,
 	                           ChannelName::Ps1AudioCardPsg,
 	                           {ChannelFeature::Sleep,
 	                            ChannelFeature::ReverbSend,
@@ -449,23 +456,28 @@ Ps1Synth::Ps1Synth(const std::string& filter_choice)
 	write_handler.Install(0x205, generate_sound, io_width_t::byte);
 	static_cast<device_t&>(device).device_start();
 	device.convert_samplerate(RenderRateHz);
+	decimator.Configure(DecimationRatio);
 
 	MIXER_UnlockMixerThread();
 }
 
-float Ps1Synth::RenderSample()
+// Renders the frames in one block, queueing the decimated ones
+void Ps1Synth::RenderFrames(const int num_frames)
 {
 	assert(dsi);
+	assert(num_frames >= 0);
 
 	static device_sound_interface::sound_stream ss;
 
-	// Request a mono sample from the audio device
-	int16_t sample;
-	int16_t* buf[] = {&sample, nullptr};
+	render_buffer.resize(static_cast<size_t>(num_frames));
 
-	dsi->sound_stream_update(ss, nullptr, buf, 1);
+	// Request mono frames from the audio device
+	int16_t* buf[] = {render_buffer.data(), nullptr};
 
-	return static_cast<float>(sample);
+	dsi->sound_stream_update(ss, nullptr, buf, num_frames);
+
+	decimator_input.assign(render_buffer.begin(), render_buffer.end());
+	decimator.Process(decimator_input.data(), decimator_input.size(), fifo);
 }
 
 void Ps1Synth::RenderUpToNow()
@@ -477,10 +489,11 @@ void Ps1Synth::RenderUpToNow()
 		last_rendered_ms = now;
 		return;
 	}
-	// Keep rendering until we're current
-	while (last_rendered_ms < now) {
-		last_rendered_ms += MsPerRender;
-		fifo.emplace(RenderSample());
+	// Render the frames up to now in one go
+	if (last_rendered_ms < now) {
+		const auto num_frames = iceil((now - last_rendered_ms) / MsPerRender);
+		last_rendered_ms += num_frames * MsPerRender;
+		RenderFrames(num_frames);
 	}
 }
 
@@ -503,20 +516,20 @@ void Ps1Synth::AudioCallback(const int requested_frames)
 	// if (fifo.size())
 	//	LOG_MSG("PS1: Queued %2lu cycle-accurate frames", fifo.size());
 
-	auto frames_remaining = requested_frames;
+	const auto num_requested = static_cast<size_t>(requested_frames);
 
-	// First, send any frames we've queued since the last callback
-	while (frames_remaining && fifo.size()) {
-		channel->AddSamples_mfloat(1, &fifo.front());
-		fifo.pop();
-		--frames_remaining;
-	}
-	// If the queue's run dry, render the remainder and sync-up our time datum
-	while (frames_remaining) {
-		float sample = RenderSample();
-		channel->AddSamples_mfloat(1, &sample);
-		--frames_remaining;
+	// If the frames we've queued since the last callback fall short,
+	// render the remainder
+	if (fifo.size() < num_requested) {
+		const auto num_missing = num_requested - fifo.size();
+		RenderFrames(check_cast<int>(decimator.GetInputFramesFor(num_missing)));
 	}
+	assert(fifo.size() >= num_requested);
+
+	channel->AddSamples_mfloat(requested_frames, fifo.data());
+	fifo.erase(fifo.begin(), fifo.begin() + requested_frames);
+
+	// Sync-up our time datum
 	last_rendered_ms = PIC_AtomicIndex();
 }
 
@@ -858,12 +858,20 @@ static void dsp_dma_callback(const DmaChannel* chan, const DmaEvent event)
 	};
 }
 
+// The decoder's running state, kept in locals while a block of DMA bytes is
+// decoded and written back to 'sb.adpcm' afterwards
+struct AdpcmState {
+	uint8_t reference = 0;
+	uint16_t stepsize = 0;
+};
+
 static uint8_t decode_adpcm_portion(const int bit_portion,
                                     const uint8_t adjust_map[],
-                                    const int8_t scale_map[], const int last_index)
+                                    const int8_t scale_map[],
+                                    const int last_index, AdpcmState& state)
 {
-	auto& scale  = sb.adpcm.stepsize;
-	auto& sample = sb.adpcm.reference;
+	auto& scale  = state.stepsize;
+	auto& sample = state.reference;
 
 	const auto i = std::clamp(bit_portion + scale, 0, last_index);
 
@@ -873,7 +881,8 @@ static uint8_t decode_adpcm_portion(const int bit_portion,
 	return sample;
 }
 
-static std::array<uint8_t, 4> decode_adpcm_2bit(const uint8_t data)
+static std::array<uint8_t, 4> decode_adpcm_2bit(const uint8_t data,
+                                                AdpcmState& state)
 {
 	// clang-format off
 	constexpr int8_t ScaleMap[] = {
@@ -893,13 +902,19 @@ static std::array<uint8_t, 4> decode_adpcm_2bit(const uint8_t data)
 	static_assert(ARRAY_LEN(ScaleMap) == ARRAY_LEN(AdjustMap));
 	constexpr auto LastIndex = static_cast<uint8_t>(sizeof(ScaleMap) - 1);
 
-	return {decode_adpcm_portion((data >> 6) & 0x3, AdjustMap, ScaleMap, LastIndex),
-	        decode_adpcm_portion((data >> 4) & 0x3, AdjustMap, ScaleMap, LastIndex),
-	        decode_adpcm_portion((data >> 2) & 0x3, AdjustMap, ScaleMap, LastIndex),
-	        decode_adpcm_portion((data >> 0) & 0x3, AdjustMap, ScaleMap, LastIndex)};
+	const auto decode = [&](const int bit_portion) {
+		return decode_adpcm_portion(
+		        bit_portion, AdjustMap, ScaleMap, LastIndex, state);
+	};
+
+	return {decode((data >> 6) & 0x3),
+	        decode((data >> 4) & 0x3),
+	        decode((data >> 2) & 0x3),
+	        decode((data >> 0) & 0x3)};
 }
 
-static std::array<uint8_t, 3> decode_adpcm_3bit(const uint8_t data)
+static std::array<uint8_t, 3> decode_adpcm_3bit(const uint8_t data,
+                                                AdpcmState& state)
 {
 	// clang-format off
 	constexpr int8_t ScaleMap[40] = {
@@ -922,12 +937,18 @@ static std::array<uint8_t, 3> decode_adpcm_3bit(const uint8_t data)
 	static_assert(ARRAY_LEN(ScaleMap) == ARRAY_LEN(AdjustMap));
 	constexpr auto LastIndex = static_cast<uint8_t>(sizeof(ScaleMap) - 1);
 
-	return {decode_adpcm_portion((data >> 5) & 0x7, AdjustMap, ScaleMap, LastIndex),
-	        decode_adpcm_portion((data >> 2) & 0x7, AdjustMap, ScaleMap, LastIndex),
-	        decode_adpcm_portion((data & 0x3) << 1, AdjustMap, ScaleMap, LastIndex)};
+	const auto decode = [&](const int bit_portion) {
+		return decode_adpcm_portion(
+		        bit_portion, AdjustMap, ScaleMap, LastIndex, state);
+	};
+
+	return {decode((data >> 5) & 0x7),
+	        decode((data >> 2) & 0x7),
+	        decode((data & 0x3) << 1)};
 }
 
-static std::array<uint8_t, 2> decode_adpcm_4bit(const uint8_t data)
+static std::array<uint8_t, 2> decode_adpcm_4bit(const uint8_t data,
+                                                AdpcmState& state)
 {
 	// clang-format off
 	constexpr int8_t ScaleMap[64] = {
@@ -952,8 +973,12 @@ static std::array<uint8_t, 2> decode_adpcm_4bit(const uint8_t data)
 	static_assert(ARRAY_LEN(ScaleMap) == ARRAY_LEN(AdjustMap));
 	constexpr auto LastIndex = static_cast<uint8_t>(sizeof(ScaleMap) - 1);
 
-	return {decode_adpcm_portion(data >> 4, AdjustMap, ScaleMap, LastIndex),
-	        decode_adpcm_portion(data & 0xf, AdjustMap, ScaleMap, LastIndex)};
+	const auto decode = [&](const int bit_portion) {
+		return decode_adpcm_portion(
+		        bit_portion, AdjustMap, ScaleMap, LastIndex, state);
+	};
+
+	return {decode(data >> 4), decode(data & 0xf)};
 }
 
 // Convert sample to float based on type
@@ -1123,13 +1148,11 @@ static void play_dma_transfer(const uint32_t bytes_requested)
 
 	last_dma_callback = PIC_FullIndex();
 
-	// Temporary counter for ADPCM modes
-
+	// ADPCM spans are decoded in one go and sent to the mixer as a single
+	// block, rather than a few samples per DMA byte
 	auto decode_adpcm_dma =
 	        [&](auto decode_adpcm_fn) -> std::tuple<uint32_t, uint32_t, uint16_t> {
 		const uint32_t num_bytes = read_dma_8bit(bytes_to_read);
-		uint32_t num_samples     = 0;
-		uint16_t num_frames      = 0;
 
 		// Parse the reference ADPCM byte, if provided
 		uint32_t i = 0;
@@ -1139,19 +1162,37 @@ static void play_dma_transfer(const uint32_t bytes_requested)
 			sb.adpcm.stepsize  = MinAdaptiveStepSize;
 			++i;
 		}
+
+		// The largest span decodes four 2-bit samples per byte
+		constexpr auto MaxSamplesPerByte = 4;
+		static std::array<uint8_t, DmaBufSize * MaxSamplesPerByte>
+		        decoded_samples = {};
+
 		// Decode the remaining DMA buffer into samples using the
 		// provided function
-		while (i < num_bytes) {
-			const auto decoded = decode_adpcm_fn(sb.dma.buf.b8[i]);
-			constexpr auto NumDecoded = check_cast<uint8_t>(
-			        decoded.size());
+		AdpcmState state = {sb.adpcm.reference, sb.adpcm.stepsize};
+
+		uint32_t num_samples = 0;
+		for (; i < num_bytes; ++i) {
+			const auto decoded = decode_adpcm_fn(sb.dma.buf.b8[i], state);
+			static_assert(decoded.size() <= MaxSamplesPerByte);
 
-			enqueue_frames(maybe_silence<FrameType::Mono>(decoded.data(), NumDecoded));
-			num_samples += NumDecoded;
-			i++;
+			std::copy(decoded.begin(),
+			          decoded.end(),
+			          decoded_samples.begin() + num_samples);
+			num_samples += check_cast<uint32_t>(decoded.size());
 		}
+		sb.adpcm.reference = state.reference;
+		sb.adpcm.stepsize  = state.stepsize;
+
+		if (num_samples > 0) {
+			const auto samples_start = decoded_samples.data();
+			enqueue_frames(maybe_silence<FrameType::Mono>(samples_start,
+			                                              num_samples));
+		}
+
 		// ADPCM is mono
-		num_frames = check_cast<uint16_t>(num_samples);
+		const auto num_frames = check_cast<uint16_t>(num_samples);
 		return {num_bytes, num_samples, num_frames};
 	};
 
@@ -3620,6 +3661,13 @@ SBLASTER::SBLASTER(Section* conf)
 
 		write_handlers[i].Install(sb.hw.base + i, write_sb, io_width_t::byte);
 	}
+
+	// Data only arrives in the read buffer on port writes and in the reset
+	// event, so loops waiting for it can skip ahead. The write status
+	// can't have a hint: it reports room in the buffer every 8th read.
+	IO_RegisterPollHint(sb.hw.base + DspReadStatus, [](io_port_t, uint8_t) {
+		return IO_StableUntilEvent;
+	});
 	for (uint16_t i = 0; i < 256; ++i) {
 		asp_regs[i] = 0;
 	}
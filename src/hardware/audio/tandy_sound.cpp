@@ -28,10 +28,11 @@
 
 #include <algorithm>
 #include <array>
-#include <queue>
 #include <string_view>
+#include <vector>
 
 #include "audio/channel_names.h"
+#include "audio/integer_decimator.h"
 #include "config/setup.h"
 #include "dosbox.h"
 #include "hardware/dma.h"
@@ -66,7 +67,7 @@ private:
 	TandyPSG& operator=(const TandyPSG&) = delete;
 
 	void AudioCallback(const int requested_frames);
-	float RenderSample();
+	void RenderFrames(const int num_frames);
 	void RenderUpToNow();
 	void WriteToPort(io_port_t, io_val_t value, io_width_t);
 
@@ -74,14 +75,20 @@ private:
 	MixerChannelPtr channel                     = nullptr;
 	IO_WriteHandleObject write_handlers[2]      = {};
 	std::unique_ptr<sn76496_base_device> device = {};
-	std::queue<float> fifo                      = {};
+	IntegerDecimator<float> decimator           = {};
+	std::vector<int16_t> render_buffer          = {};
+	std::vector<float> decimator_input          = {};
+	std::vector<float> fifo                     = {};
 	std::mutex mutex                            = {};
 
-	// Static rate-related configuration
-	static constexpr auto RenderDivisor = 16;
-	static constexpr auto RenderRateHz  = ceil_sdivide(TandyPsgClockHz,
+	// Static rate-related configuration. The chip is rendered at a high
+	// rate for accurate timing, and decimated for the mixer.
+	static constexpr auto RenderDivisor   = 16;
+	static constexpr auto RenderRateHz    = ceil_sdivide(TandyPsgClockHz,
                                                           RenderDivisor);
-	static constexpr auto MsPerRender   = MillisInSecond / RenderRateHz;
+	static constexpr auto MsPerRender     = MillisInSecond / RenderRateHz;
+	static constexpr auto DecimationRatio = 4;
+	static constexpr auto OutputRateHz    = RenderRateHz / DecimationRatio;
 
 	// Runtime states
 	device_sound_interface* dsi = nullptr;
@@ -443,7 +450,7 @@ TandyPSG::TandyPSG(const ConfigProfile config_profile,
 	const auto callback = std::bind(&TandyPSG::AudioCallback, this, _1);
 
 	channel = MIXER_AddChannel(callback,
-	                           RenderRateHz,
+	                           OutputRateHz,
 	                           ChannelName::TandyPsg,
 	                           {ChannelFeature::Sleep,
 	                            ChannelFeature::FadeOut,
@@ -479,6 +486,7 @@ TandyPSG::TandyPSG(const ConfigProfile config_profile,
 	base_device->device_start();
 
 	device->convert_samplerate(RenderRateHz);
+	decimator.Configure(DecimationRatio);
 
 	LOG_MSG("TANDY: Initialised audio card with a TI %s PSG",
 	        base_device->shortName);
@@ -506,19 +514,23 @@ TandyPSG::~TandyPSG()
 	MIXER_UnlockMixerThread();
 }
 
-float TandyPSG::RenderSample()
+// Renders the frames in one block, queueing the decimated ones
+void TandyPSG::RenderFrames(const int num_frames)
 {
 	assert(dsi);
+	assert(num_frames >= 0);
 
 	static device_sound_interface::sound_stream ss;
 
-	// Request a mono frame from the audio device
-	int16_t sample;
-	int16_t* buf[] = {&sample, nullptr};
+	render_buffer.resize(static_cast<size_t>(num_frames));
 
-	dsi->sound_stream_update(ss, nullptr, buf, 1);
+	// Request mono frames from the audio device
+	int16_t* buf[] = {render_buffer.data(), nullptr};
 
-	return static_cast<float>(sample);
+	dsi->sound_stream_update(ss, nullptr, buf, num_frames);
+
+	decimator_input.assign(render_buffer.begin(), render_buffer.end());
+	decimator.Process(decimator_input.data(), decimator_input.size(), fifo);
 }
 
 void TandyPSG::RenderUpToNow()
@@ -531,10 +543,11 @@ void TandyPSG::RenderUpToNow()
 		last_rendered_ms = now;
 		return;
 	}
-	// Keep rendering until we're current
-	while (last_rendered_ms < now) {
-		last_rendered_ms += MsPerRender;
-		fifo.emplace(RenderSample());
+	// Render the frames up to now in one go
+	if (last_rendered_ms < now) {
+		const auto num_frames = iceil((now - last_rendered_ms) / MsPerRender);
+		last_rendered_ms += num_frames * MsPerRender;
+		RenderFrames(num_frames);
 	}
 }
 
@@ -559,20 +572,20 @@ void TandyPSG::AudioCallback(const int requested_frames)
 	}
 #endif
 
-	auto frames_remaining = requested_frames;
+	const auto num_requested = static_cast<size_t>(requested_frames);
 
-	// First, send any frames we've queued since the last callback
-	while (frames_remaining && fifo.size()) {
-		channel->AddSamples_mfloat(1, &fifo.front());
-		fifo.pop();
-		--frames_remaining;
-	}
-	// If the queue's run dry, render the remainder and sync-up our time datum
-	while (frames_remaining) {
-		float sample = RenderSample();
-		channel->AddSamples_mfloat(1, &sample);
-		--frames_remaining;
+	// If the frames we've queued since the last callback fall short,
+	// render the remainder
+	if (fifo.size() < num_requested) {
+		const auto num_missing = num_requested - fifo.size();
+		RenderFrames(check_cast<int>(decimator.GetInputFramesFor(num_missing)));
 	}
+	assert(fifo.size() >= num_requested);
+
+	channel->AddSamples_mfloat(requested_frames, fifo.data());
+	fifo.erase(fifo.begin(), fifo.begin() + requested_frames);
+
+	// Sync-up our time datum
 	last_rendered_ms = PIC_AtomicIndex();
 }
 
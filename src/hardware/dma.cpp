@@ -13,6 +13,7 @@
 #include "hardware/memory.h"
 #include "hardware/pic.h"
 #include "hardware/port.h"
+#include "misc/perf_counters.h"
 
 std::unique_ptr<DmaController> primary   = {};
 std::unique_ptr<DmaController> secondary = {};
@@ -76,18 +77,24 @@ static void perform_dma_io(const DmaDirection direction, const PhysPt spage,
 		// Determine how many bytes to transfer within this page
 		const auto chunk_bytes = std::min(remaining_bytes, bytes_to_page_end);
 
+		// The chunk lies in a single page, so it's one contiguous run
+		// of host memory. Pages past the end of RAM read as open bus
+		// and ignore writes.
+		const auto is_in_ram = page < MEM_TotalPages();
+
 		// Copy the data from the page address into the data pointer
 		if (direction == DmaDirection::Read) {
-			for (auto i = 0; i < chunk_bytes; ++i) {
-				data_pt[i] = phys_readb(chunk_start + i);
+			if (is_in_ram) {
+				std::memcpy(data_pt, MemBase + chunk_start, chunk_bytes);
+			} else {
+				std::memset(data_pt, 0xff, chunk_bytes);
 			}
 		}
 
 		// Copy the data from the data pointer into the page address
-		else if (direction == DmaDirection::Write) {
-			for (auto i = 0; i < chunk_bytes; ++i) {
-				phys_writeb(chunk_start + i, data_pt[i]);
-			}
+		else if (direction == DmaDirection::Write && is_in_ram) {
+			MEM_MarkRangeDirty(chunk_start, chunk_bytes);
+			std::memcpy(MemBase + chunk_start, data_pt, chunk_bytes);
 		}
 
 		mem_address += chunk_bytes;
@@ -96,6 +103,17 @@ static void perform_dma_io(const DmaDirection direction, const PhysPt spage,
 	} while (remaining_bytes);
 }
 
+static PerfCounter dma_channel_bytes[] = {
+        {"dma_channel0_bytes", "Bytes moved by 8-bit DMA channel 0."},
+        {"dma_channel1_bytes", "Bytes moved by 8-bit DMA channel 1."},
+        {"dma_channel2_bytes", "Bytes moved by 8-bit DMA channel 2."},
+        {"dma_channel3_bytes", "Bytes moved by 8-bit DMA channel 3."},
+        {"dma_channel4_bytes", "Bytes moved by 16-bit DMA channel 4."},
+        {"dma_channel5_bytes", "Bytes moved by 16-bit DMA channel 5."},
+        {"dma_channel6_bytes", "Bytes moved by 16-bit DMA channel 6."},
+        {"dma_channel7_bytes", "Bytes moved by 16-bit DMA channel 7."},
+};
+
 void TANDYSOUND_ShutDown(Section* = nullptr);
 
 static bool activate_primary()
@@ -452,6 +470,7 @@ again:
 			DoCallback(DmaEvent::IsMasked);
 		}
 	}
+	dma_channel_bytes[chan_num].Add(static_cast<uint64_t>(done) << is_16bit);
 	return done;
 }
 
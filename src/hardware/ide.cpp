@@ -19,6 +19,7 @@
 #include "cpu/callback.h"
 #include "cpu/cpu.h"
 #include "dos/cdrom.h"
+#include "hardware/atapi_read_worker.h"
 #include "hardware/pic.h"
 #include "hardware/port.h"
 #include "hardware/timer.h"
@@ -57,6 +58,9 @@ enum {
 
 class IDEController;
 
+/* the CD-ROM drive reports, and reads at, this multiple of single speed */
+constexpr uint32_t atapi_drive_speed = 8;
+
 #if 0 // unused
 static inline bool drivehead_is_lba48(uint8_t val) {
     return (val&0xE0) == 0x40;
@@ -178,6 +182,7 @@ public:
 	virtual void prepare_write(uint32_t offset, uint32_t size);
 	virtual void io_completion();
 	virtual bool increment_current_address(uint32_t count = 1);
+	void prefetch_from_biosdisk();
 
 public:
 	uint8_t sector[512 * 128] = {};
@@ -249,6 +254,8 @@ public:
 	virtual void play_audio10();
 	virtual void mode_sense();
 	virtual void read_toc();
+	/* start READ(10)/READ(12) on the read worker, returning the emulated time it takes */
+	double submit_read();
 
 public:
 	/* if set, PACKET data transfer is to be read by host */
@@ -284,6 +291,9 @@ public:
 	uint8_t sector[512 * 128] = {};
 	uint32_t sector_i = 0;
 	uint32_t sector_total = 0;
+
+	/* sector reads run here, so the host read doesn't stall emulation */
+	AtapiReadWorker read_worker = {};
 };
 
 class IDEController {
@@ -656,7 +666,7 @@ void IDEATAPICDROMDevice::mode_sense()
 		*write++ = 0x03; /* +7 Reserved       |Reserved     |R-W in leadin|Side chg cap |S/W slot sel
 		                    |Changer disc pr|Sep. ch. mute |Sep. volume levels */
 
-		x = 176 * 8; /* +8 maximum speed supported in kB: 8X  (obsolete in MMC-3) */
+		x = 176 * atapi_drive_speed; /* +8 maximum speed supported in kB: 8X  (obsolete in MMC-3) */
 		*write++ = check_cast<uint8_t>(x >> 8);
 		*write++ = check_cast<uint8_t>(x & 0xff);
 
@@ -668,7 +678,7 @@ void IDEATAPICDROMDevice::mode_sense()
 		*write++ = check_cast<uint8_t>(x >> 8);
 		*write++ = check_cast<uint8_t>(x & 0xff);
 
-		x = 176 * 8; /* +14 current read speed selected in kB: 8X  (obsolete in MMC-3) */
+		x = 176 * atapi_drive_speed; /* +14 current read speed selected in kB: 8X  (obsolete in MMC-3) */
 		*write++ = check_cast<uint8_t>(x >> 8);
 		*write++ = check_cast<uint8_t>(x & 0xff);
 
@@ -959,6 +969,30 @@ void IDEATAPICDROMDevice::read_toc()
 	prepare_read(0, std::min(std::min((uint32_t)(write - sector), host_maximum_byte_count), AllocationLength));
 }
 
+double IDEATAPICDROMDevice::submit_read()
+{
+	/* seeking to the data, unless the drive has read it ahead already */
+	constexpr double seek_time = 3; /*ms*/
+	/* data sectors per millisecond at the drive's speed: 75 per second at 1X */
+	constexpr double sectors_per_ms = 75.0 * atapi_drive_speed / 1000.0;
+
+	if (TransferLength == 0)
+		return seek_time;
+
+	/* without a disc the read fails, as the read worker reports */
+	CDROM_Interface *cdrom = getMSCDEXDrive();
+	AtapiReadWorker::ReadFunction read = {};
+	if (cdrom != nullptr) {
+		read = [cdrom](uint8_t *buffer, const uint32_t lba, const uint32_t num_sectors) {
+			return cdrom->ReadSectorsHost(buffer, false, lba, num_sectors);
+		};
+	}
+	const bool read_ahead = read_worker.Submit(cdrom, std::move(read), LBA, TransferLength);
+
+	const double transfer_time = TransferLength / sectors_per_ms;
+	return read_ahead ? transfer_time : seek_time + transfer_time;
+}
+
 /* when the ATAPI command has been accepted, and the timeout has passed */
 void IDEATAPICDROMDevice::on_atapi_busy_time()
 {
@@ -1117,11 +1151,13 @@ void IDEATAPICDROMDevice::on_atapi_busy_time()
 			sector_total = 0; /*nothing to transfer */
 			state = IDE_DEV_READY;
 			status = IDE_STATUS_DRIVE_READY;
+		} else if (!faked_command && !read_worker.IsDone()) {
+			/* the host hasn't finished reading yet: the drive stays busy */
+			PIC_AddEvent(IDE_DelayedCommand, 0.1 /*ms*/, controller->interface_index);
+			return;
 		} else {
-			/* OK, try to read */
-			CDROM_Interface *cdrom = getMSCDEXDrive();
-			bool res = (cdrom != nullptr ? cdrom->ReadSectorsHost(/*buffer*/ sector, false, LBA, TransferLength)
-			                          : false);
+			/* the read worker has the sectors, or the reason it couldn't read them */
+			bool res = read_worker.Take(sector);
 			if (res) {
 				prepare_read(0, std::min((TransferLength * 2048), host_maximum_byte_count));
 				feature = 0x00;
@@ -1431,6 +1467,30 @@ bool IDEATADevice::increment_current_address(uint32_t n)
 	return true;
 }
 
+/* let the disk image start reading the sectors of a read command while the
+   drive is busy. IDE_DelayedCommand validates the address, so an invalid one
+   simply goes without a hint */
+void IDEATADevice::prefetch_from_biosdisk()
+{
+	const auto disk = getBIOSdisk();
+	if (!disk)
+		return;
+
+	uint32_t sectorn = 0;
+	if (drivehead_is_lba(drivehead)) {
+		sectorn = (((uint32_t)drivehead & 0xFu) << 24u) | (uint32_t)lba[0] |
+		          ((uint32_t)lba[1] << 8u) | ((uint32_t)lba[2] << 16u);
+	} else {
+		const uint32_t cyl = lba[1] | ((uint32_t)lba[2] << 8u);
+		if (lba[0] == 0 || (uint32_t)(drivehead & 0xF) >= heads ||
+		    (uint32_t)lba[0] > sects || cyl >= cyls)
+			return;
+		sectorn = ((drivehead & 0xFu) * sects) + (cyl * sects * heads) +
+		          ((uint32_t)lba[0] - 1u);
+	}
+	disk->Prefetch(sectorn, count == 0 ? 256u : count);
+}
+
 void IDEATADevice::io_completion()
 {
 	/* lower DRQ */
@@ -1643,8 +1703,9 @@ void IDEATAPICDROMDevice::atapi_cmd_completion()
 			count = 0x02;
 			state = IDE_DEV_ATAPI_BUSY;
 			status = IDE_STATUS_BUSY;
-			/* TBD: Emulate CD-ROM spin-up delay, and seek delay */
-			PIC_AddEvent(IDE_DelayedCommand, (faked_command ? 0.000001 : 3) /*ms*/,
+			/* TBD: Emulate CD-ROM spin-up delay */
+			const double read_time = submit_read();
+			PIC_AddEvent(IDE_DelayedCommand, (faked_command ? 0.000001 : read_time) /*ms*/,
 			             controller->interface_index);
 		} else {
 			count = 0x03;
@@ -1681,8 +1742,9 @@ void IDEATAPICDROMDevice::atapi_cmd_completion()
 			count = 0x02;
 			state = IDE_DEV_ATAPI_BUSY;
 			status = IDE_STATUS_BUSY;
-			/* TBD: Emulate CD-ROM spin-up delay, and seek delay */
-			PIC_AddEvent(IDE_DelayedCommand, (faked_command ? 0.000001 : 3) /*ms*/,
+			/* TBD: Emulate CD-ROM spin-up delay */
+			const double read_time = submit_read();
+			PIC_AddEvent(IDE_DelayedCommand, (faked_command ? 0.000001 : read_time) /*ms*/,
 			             controller->interface_index);
 		} else {
 			count = 0x03;
@@ -2346,6 +2408,19 @@ void IDE_CDROM_Detach(const int8_t requested_drive_index)
 	}
 }
 
+void IDE_CDROM_FinishReads()
+{
+	for (uint8_t index = 0; index < MAX_IDE_CONTROLLERS; index++) {
+		IDEController *c = idecontroller[index];
+		if (c)
+			for (int slave = 0; slave < 2; slave++) {
+				auto dev = dynamic_cast<IDEATAPICDROMDevice *>(c->device[slave]);
+				if (dev)
+					dev->read_worker.Finish();
+			}
+	}
+}
+
 void IDE_CDROM_Detach_Ret(int8_t &indexret,bool &slaveret,int8_t drive_index) {
     indexret = -1;
     for (uint8_t index = 0; index < MAX_IDE_CONTROLLERS; index++) {
@@ -3672,6 +3747,8 @@ void IDEATADevice::writecommand(uint8_t cmd)
 		progress_count = 0;
 		state = IDE_DEV_BUSY;
 		status = IDE_STATUS_BUSY;
+		/* the emulated busy time stays as it was, the host read overlaps it */
+		prefetch_from_biosdisk();
 		PIC_AddEvent(IDE_DelayedCommand, (faked_command ? 0.000001 : 0.1) /*ms*/,
 		             controller->interface_index);
 		break;
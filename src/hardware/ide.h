@@ -19,6 +19,9 @@ void IDE_Get_Next_Cable_Slot(int8_t &index,bool &slave);
 void IDE_CDROM_Attach(int8_t index, bool slave, int8_t drive_index);
 void IDE_CDROM_Detach(int8_t drive_index);
 void IDE_CDROM_Detach_Ret(int8_t &indexret, bool &slaveret, int8_t drive_index);
+// Waits for the ATAPI drives' background reads; call before a CD-ROM
+// interface they may be reading from goes away
+void IDE_CDROM_FinishReads();
 void IDE_Hard_Disk_Attach(int8_t index, bool slave, uint8_t bios_disk_index);
 void IDE_Hard_Disk_Detach(uint8_t bios_disk_index);
 void IDE_ResetDiskByBIOS(uint8_t disk);
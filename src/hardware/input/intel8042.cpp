@@ -4,12 +4,16 @@
 
 #include "private/intel8042.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "config/config.h"
 #include "dosbox.h"
 #include "dosbox_config.h"
 #include "hardware/memory.h"
 #include "hardware/pic.h"
 #include "hardware/port.h"
+#include "misc/savestate.h"
 #include "utils/bit_view.h"
 #include "utils/bitops.h"
 #include "utils/checks.h"
@@ -1096,6 +1100,80 @@ bool I8042_IsReadyForKbdFrame()
 	return !waiting_bytes_from_kbd && !is_disabled_kbd && !is_diagnostic_dump;
 }
 
+// ***************************************************************************
+// Save-states
+// ***************************************************************************
+
+// The keyboard and mouse devices behind the controller keep their own
+// buffers, which are not part of the state
+void I8042_SaveState(SaveStateWriter& out)
+{
+	out.Write(config_byte);
+	out.Write(status_byte);
+	out.Write(is_diagnostic_dump);
+	out.Write(data_byte);
+	out.Write(is_data_from_kbd);
+	out.Write(buffer);
+	out.Write(buffer_start_idx);
+	out.Write(buffer_num_used);
+	out.Write(waiting_bytes_from_aux);
+	out.Write(waiting_bytes_from_kbd);
+	out.Write(delay_running);
+	out.Write(delay_expired);
+	out.Write(should_skip_device_notify);
+	out.Write(current_command);
+}
+
+bool I8042_LoadState(SaveStateReader& in, const bool apply)
+{
+	decltype(config_byte) config = {};
+	decltype(status_byte) status = {};
+	decltype(buffer) buffered    = {};
+
+	bool diagnostic_dump = false;
+	uint8_t data         = 0;
+	bool data_from_kbd   = false;
+	size_t start_idx     = 0;
+	size_t num_used      = 0;
+	size_t waiting_aux   = 0;
+	size_t waiting_kbd   = 0;
+	bool running         = false;
+	bool expired         = false;
+	bool skip_notify     = false;
+	Command command      = Command::None;
+
+	if (!in.Read(config) || !in.Read(status) || !in.Read(diagnostic_dump) ||
+	    !in.Read(data) || !in.Read(data_from_kbd) || !in.Read(buffered) ||
+	    !in.Read(start_idx) || !in.Read(num_used) || !in.Read(waiting_aux) ||
+	    !in.Read(waiting_kbd) || !in.Read(running) || !in.Read(expired) ||
+	    !in.Read(skip_notify) || !in.Read(command)) {
+		return false;
+	}
+	if (start_idx >= BufferSize || num_used > BufferSize) {
+		return in.Fail("buffer indices out of range");
+	}
+	if (!apply) {
+		return true;
+	}
+
+	config_byte.data = config.data;
+	status_byte.data = status.data;
+	std::copy(std::begin(buffered), std::end(buffered), std::begin(buffer));
+
+	is_diagnostic_dump        = diagnostic_dump;
+	data_byte                 = data;
+	is_data_from_kbd          = data_from_kbd;
+	buffer_start_idx          = start_idx;
+	buffer_num_used           = num_used;
+	waiting_bytes_from_aux    = waiting_aux;
+	waiting_bytes_from_kbd    = waiting_kbd;
+	delay_running             = running;
+	delay_expired             = expired;
+	should_skip_device_notify = skip_notify;
+	current_command           = command;
+	return true;
+}
+
 // ***************************************************************************
 // Initialization
 // ***************************************************************************
@@ -1110,6 +1188,11 @@ void I8042_Init()
 	IO_RegisterReadHandler(port_num_i8042_status,
 	                       read_status_register,
 	                       io_width_t::byte);
+	// The status only changes on port accesses, in the delay timer's
+	// event, and when host input arrives between time slices
+	IO_RegisterPollHint(port_num_i8042_status, [](io_port_t, uint8_t) {
+		return IO_StableUntilEvent;
+	});
 	IO_RegisterWriteHandler(port_num_i8042_data,
 	                        write_data_port,
 	                        io_width_t::byte);
@@ -3,6 +3,7 @@
 
 #include "joystick.h"
 
+#include <algorithm>
 #include <cfloat>
 #include <cmath>
 #include <cstring>
@@ -227,6 +228,26 @@ static uint8_t read_p201_timed(io_port_t, io_width_t)
 	return ret;
 }
 
+// The axis bits of the timed port clear when their ticks pass and are set
+// again by a port write; the buttons change with host input between time
+// slices
+static double poll_hint_p201_timed(io_port_t, const uint8_t mask)
+{
+	const auto now   = PIC_FullIndex();
+	auto next_change = IO_StableUntilEvent;
+
+	auto axis_change = [&](const bool is_enabled, const uint8_t bit, const double tick) {
+		if (is_enabled && (mask & bit) && tick >= now) {
+			next_change = std::min(next_change, tick);
+		}
+	};
+	axis_change(stick[0].enabled, 1, stick[0].xtick);
+	axis_change(stick[0].enabled, 2, stick[0].ytick);
+	axis_change(stick[1].enabled, 4, stick[1].xtick);
+	axis_change(stick[1].enabled, 8, stick[1].ytick);
+	return next_change;
+}
+
 static void write_p201(io_port_t, io_val_t, io_width_t)
 {
 	/* Store writetime index */
@@ -587,6 +608,11 @@ public:
 			WriteHandler.Install(0x201,
 			                     wants_timed ? write_p201_timed : write_p201,
 			                     io_width_t::byte);
+			// The untimed port counts reads, so only the timed one
+			// can have a hint
+			if (wants_timed) {
+				IO_RegisterPollHint(0x201, poll_hint_p201_timed);
+			}
 		}
 	}
 	~JOYSTICK() {
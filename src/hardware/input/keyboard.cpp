@@ -690,6 +690,11 @@ uint8_t KEYBOARD_GetLedState()
 	return (leds_all_on ? 0xff : led_state) & 0b0000'0111;
 }
 
+bool KEYBOARD_IsIdle()
+{
+	return !buffer_num_used && I8042_IsReadyForKbdFrame();
+}
+
 void KEYBOARD_ClrBuffer()
 {
 	// Sometimes the GUI part wants us to clear the buffer. Original code
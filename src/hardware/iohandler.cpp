@@ -2,24 +2,22 @@
 // SPDX-FileCopyrightText:  2002-2021 The DOSBox Team
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <limits>
 #include <cstring>
-#include <unordered_map>
 
 #include "config/setup.h"
 #include "cpu/callback.h"
 #include "cpu/cpu.h"
 #include "cpu/lazyflags.h"
+#include "hardware/iohandler_containers.h"
 #include "hardware/port.h"
 
 
 //#define ENABLE_PORTLOG
 
-// type-sized IO handler containers
-extern std::unordered_map<io_port_t, io_read_f> io_read_handlers[io_widths];
-extern std::unordered_map<io_port_t, io_write_f> io_write_handlers[io_widths];
-
 // type-sized IO handler API
 uint8_t read_byte_from_port(const io_port_t port);
 uint16_t read_word_from_port(const io_port_t port);
@@ -29,6 +27,30 @@ void write_word_to_port(const io_port_t port, const uint16_t val);
 void write_dword_to_port(const io_port_t port, const uint32_t val);
 
 
+// Guest accesses per port since startup, whatever their width, to find
+// the ports that polling loops hammer
+static std::array<uint64_t, UINT16_MAX + 1> port_reads  = {};
+static std::array<uint64_t, UINT16_MAX + 1> port_writes = {};
+
+std::vector<IO_PortAccesses> IO_GetBusiestPorts(const size_t max_ports)
+{
+	std::vector<IO_PortAccesses> ports = {};
+	for (size_t port = 0; port < port_reads.size(); ++port) {
+		if (port_reads[port] || port_writes[port]) {
+			ports.push_back({static_cast<io_port_t>(port),
+			                 port_reads[port],
+			                 port_writes[port]});
+		}
+	}
+	const auto busier = [](const IO_PortAccesses& a, const IO_PortAccesses& b) {
+		return a.reads + a.writes > b.reads + b.writes;
+	};
+	const auto num_ports = std::min(max_ports, ports.size());
+	std::partial_sort(ports.begin(), ports.begin() + num_ports, ports.end(), busier);
+	ports.resize(num_ports);
+	return ports;
+}
+
 struct IOF_Entry {
 	Bitu cs;
 	Bitu eip;
@@ -150,6 +172,7 @@ void log_io(io_width_t width, bool write, io_port_t port, io_val_t val)
 
 void IO_WriteB(io_port_t port, uint8_t val)
 {
+	++port_writes[port];
 	log_io(io_width_t::byte, true, port, val);
 	if (GETFLAG(VM) && (CPU_IO_Exception(port, 1))) {
 		const auto old_lflags = lflags;
@@ -184,6 +207,7 @@ void IO_WriteB(io_port_t port, uint8_t val)
 
 void IO_WriteW(io_port_t port, uint16_t val)
 {
+	++port_writes[port];
 	log_io(io_width_t::word, true, port, val);
 	if (GETFLAG(VM) && (CPU_IO_Exception(port, 2))) {
 		const auto old_lflags = lflags;
@@ -218,6 +242,7 @@ void IO_WriteW(io_port_t port, uint16_t val)
 
 void IO_WriteD(io_port_t port, uint32_t val)
 {
+	++port_writes[port];
 	log_io(io_width_t::dword, true, port, val);
 	if (GETFLAG(VM) && (CPU_IO_Exception(port, 4))) {
 		const auto old_lflags = lflags;
@@ -251,6 +276,7 @@ void IO_WriteD(io_port_t port, uint32_t val)
 
 uint8_t IO_ReadB(io_port_t port)
 {
+	++port_reads[port];
 	uint8_t retval;
 	if (GETFLAG(VM) && (CPU_IO_Exception(port, 1))) {
 		const auto old_lflags = lflags;
@@ -288,6 +314,7 @@ uint8_t IO_ReadB(io_port_t port)
 
 uint16_t IO_ReadW(io_port_t port)
 {
+	++port_reads[port];
 	uint16_t retval;
 	if (GETFLAG(VM) && (CPU_IO_Exception(port, 2))) {
 		const auto old_lflags = lflags;
@@ -324,6 +351,7 @@ uint16_t IO_ReadW(io_port_t port)
 
 uint32_t IO_ReadD(io_port_t port)
 {
+	++port_reads[port];
 	uint32_t retval;
 	if (GETFLAG(VM) && (CPU_IO_Exception(port, 4))) {
 		const auto old_lflags = lflags;
@@ -358,6 +386,30 @@ uint32_t IO_ReadD(io_port_t port)
 	return retval;
 }
 
+uint32_t IO_ReadBlock(io_port_t port, io_width_t width, uint8_t* dst, uint32_t num)
+{
+	// Virtual 8086 mode monitors can trap each access, and the port log
+	// wants to see every one
+#ifdef ENABLE_PORTLOG
+	constexpr bool is_logging = true;
+#else
+	constexpr bool is_logging = false;
+#endif
+	if (GETFLAG(VM) || is_logging) {
+		return 0;
+	}
+	const auto num_read = read_block_from_port(port, width, dst, num);
+	port_reads[port] += num_read;
+
+	// Dword reads take no delay, as in IO_ReadD
+	if (width != io_width_t::dword) {
+		for (uint32_t i = 0; i < num_read && CPU_Cycles > 0; ++i) {
+			IO_USEC_read_delay();
+		}
+	}
+	return num_read;
+}
+
 
 class IO final : public ModuleBase {
 public:
@@ -375,11 +427,13 @@ public:
 			          static_cast<int>(writers),
 			          8 << i);
 
-			total_bytes += readers * sizeof(io_read_f) + sizeof(io_read_handlers[i]);
-			total_bytes += writers * sizeof(io_write_f) + sizeof(io_write_handlers[i]);
+			total_bytes += io_read_handlers[i].AllocatedBytes();
+			total_bytes += io_write_handlers[i].AllocatedBytes();
 			io_read_handlers[i].clear();
 			io_write_handlers[i].clear();
 		}
+		total_bytes += io_poll_hints.AllocatedBytes();
+		io_poll_hints.clear();
 		LOG_DEBUG("IOBUS: Handlers consumed %d total bytes",
 		          static_cast<int>(total_bytes));
 	}
@@ -4,11 +4,12 @@
 
 #include "dosbox.h"
 
+#include "iohandler_containers.h"
+
 #include <cassert>
 #include <cstring>
 #include <functional>
 #include <limits>
-#include <unordered_map>
 
 #include "hardware/port.h"
 #include "misc/support.h"
@@ -38,16 +39,20 @@ IO_WriteHandleObject::~IO_WriteHandleObject(){
 }
 
 // type-sized IO handlers
-std::unordered_map<io_port_t, io_read_f> io_read_handlers[io_widths] = {};
+IO_HandlerTable<io_read_f> io_read_handlers[io_widths] = {};
 constexpr auto &io_read_byte_handler = io_read_handlers[0];
 constexpr auto &io_read_word_handler = io_read_handlers[1];
 constexpr auto &io_read_dword_handler = io_read_handlers[2];
 
-std::unordered_map<io_port_t, io_write_f> io_write_handlers[io_widths] = {};
+IO_HandlerTable<io_write_f> io_write_handlers[io_widths] = {};
 constexpr auto &io_write_byte_handler = io_write_handlers[0];
 constexpr auto &io_write_word_handler = io_write_handlers[1];
 constexpr auto &io_write_dword_handler = io_write_handlers[2];
 
+IO_HandlerTable<io_poll_hint_f> io_poll_hints = {};
+
+IO_HandlerTable<io_read_block_f> io_block_readers = {};
+
 constexpr io_val_t blocked_read(const io_port_t, const io_width_t)
 {
 	return 0xff;
@@ -56,31 +61,31 @@ constexpr io_val_t blocked_read(const io_port_t, const io_width_t)
 // type-sized IO handler API
 uint8_t read_byte_from_port(const io_port_t port)
 {
-	const auto [it, was_blocked] = io_read_byte_handler.try_emplace(port, blocked_read);
-	if (was_blocked)
+	auto reader = io_read_byte_handler.Find(port);
+	if (!reader) {
 		LOG(LOG_IO, LOG_WARN)("Unhandled read from port %04Xh; blocking", port);
-	return it->second(port, io_width_t::byte) & 0xff;
+		reader = &io_read_byte_handler.Set(port, blocked_read);
+	}
+	return (*reader)(port, io_width_t::byte) & 0xff;
 }
 
 uint16_t read_word_from_port(const io_port_t port)
 {
-	const auto reader = io_read_word_handler.find(port);
-	const auto value = reader != io_read_word_handler.end()
-	                           ? (reader->second(port, io_width_t::word) & 0xffff)
-	                           : static_cast<io_val_t>(
-	                                     read_byte_from_port(port) |
-	                                     (read_byte_from_port(port + 1) << 8));
+	const auto reader = io_read_word_handler.Find(port);
+	const auto value = reader ? ((*reader)(port, io_width_t::word) & 0xffff)
+	                          : static_cast<io_val_t>(
+	                                    read_byte_from_port(port) |
+	                                    (read_byte_from_port(port + 1) << 8));
 	return check_cast<uint16_t>(value);
 }
 
 uint32_t read_dword_from_port(const io_port_t port)
 {
-	const auto reader = io_read_dword_handler.find(port);
-	const auto value = reader != io_read_dword_handler.end()
-	                           ? reader->second(port, io_width_t::dword)
-	                           : static_cast<io_val_t>(
-	                                     read_word_from_port(port) |
-	                                     (read_word_from_port(port + 2) << 16));
+	const auto reader = io_read_dword_handler.Find(port);
+	const auto value = reader ? (*reader)(port, io_width_t::dword)
+	                          : static_cast<io_val_t>(
+	                                    read_word_from_port(port) |
+	                                    (read_word_from_port(port + 2) << 16));
 	assert(value <= UINT32_MAX);
 	return static_cast<uint32_t>(value);
 }
@@ -92,19 +97,21 @@ constexpr void blocked_write(const io_port_t, const io_val_t, const io_width_t)
 
 void write_byte_to_port(const io_port_t port, const uint8_t val)
 {
-	const auto [it, was_blocked] = io_write_byte_handler.try_emplace(port, blocked_write);
-	if (was_blocked)
+	auto writer = io_write_byte_handler.Find(port);
+	if (!writer) {
 		LOG(LOG_IO, LOG_WARN)("Unhandled write of value 0x%02x"
 		                      " (%u) to port %04Xh; blocking",
 		                      val, val, port);
-	it->second(port, val, io_width_t::byte);
+		writer = &io_write_byte_handler.Set(port, blocked_write);
+	}
+	(*writer)(port, val, io_width_t::byte);
 }
 
 void write_word_to_port(const io_port_t port, const uint16_t val)
 {
-	const auto writer = io_write_word_handler.find(port);
-	if (writer != io_write_word_handler.end()) {
-		writer->second(port, val, io_width_t::word);
+	const auto writer = io_write_word_handler.Find(port);
+	if (writer) {
+		(*writer)(port, val, io_width_t::word);
 	} else {
 		write_byte_to_port(port, static_cast<uint8_t>(val & 0xff));
 		write_byte_to_port(port + 1, static_cast<uint8_t>(val >> 8));
@@ -113,26 +120,59 @@ void write_word_to_port(const io_port_t port, const uint16_t val)
 
 void write_dword_to_port(const io_port_t port, const uint32_t val)
 {
-	const auto writer = io_write_dword_handler.find(port);
-	if (writer != io_write_dword_handler.end()) {
-		writer->second(port, val, io_width_t::dword);
+	const auto writer = io_write_dword_handler.Find(port);
+	if (writer) {
+		(*writer)(port, val, io_width_t::dword);
 	} else {
 		write_word_to_port(port, static_cast<uint16_t>(val & 0xffff));
 		write_word_to_port(port + 2, static_cast<uint16_t>(val >> 16));
 	}
 }
 
+void IO_RegisterPollHint(const io_port_t port, const io_poll_hint_f hint)
+{
+	io_poll_hints.Set(port, hint);
+}
+
+double IO_GetPollHint(const io_port_t port, const uint8_t mask)
+{
+	const auto hint = io_poll_hints.Find(port);
+	return hint ? (*hint)(port, mask) : 0.0;
+}
+
+void IO_RegisterBlockReader(const io_port_t port, const io_read_block_f reader)
+{
+	io_block_readers.Set(port, reader);
+}
+
+bool IO_HasBlockReader(const io_port_t port)
+{
+	return io_block_readers.Find(port) != nullptr;
+}
+
+uint32_t read_block_from_port(const io_port_t port, const io_width_t width,
+                              uint8_t* dst, const uint32_t num)
+{
+	const auto reader = io_block_readers.Find(port);
+	if (!reader) {
+		return 0;
+	}
+	const auto num_read = (*reader)(port, width, dst, num);
+	assert(num_read <= num);
+	return num_read;
+}
+
 void IO_RegisterReadHandler(io_port_t port,
                             const io_read_f handler,
                             const io_width_t max_width,
                             io_port_t range)
 {
 	while (range--) {
-		io_read_byte_handler[port] = handler;
+		io_read_byte_handler.Set(port, handler);
 		if (max_width == io_width_t::word || max_width == io_width_t::dword)
-			io_read_word_handler[port] = handler;
+			io_read_word_handler.Set(port, handler);
 		if (max_width == io_width_t::dword)
-			io_read_dword_handler[port] = handler;
+			io_read_dword_handler.Set(port, handler);
 		++port;
 	}
 }
@@ -143,11 +183,11 @@ void IO_RegisterWriteHandler(io_port_t port,
                              io_port_t range)
 {
 	while (range--) {
-		io_write_byte_handler[port] = handler;
+		io_write_byte_handler.Set(port, handler);
 		if (max_width == io_width_t::word || max_width == io_width_t::dword)
-			io_write_word_handler[port] = handler;
+			io_write_word_handler.Set(port, handler);
 		if (max_width == io_width_t::dword)
-			io_write_dword_handler[port] = handler;
+			io_write_dword_handler.Set(port, handler);
 		++port;
 	}
 }
@@ -157,11 +197,13 @@ void IO_FreeReadHandler(io_port_t port,
                         io_port_t range)
 {
 	while (range--) {
-		io_read_byte_handler.erase(port);
+		io_poll_hints.Erase(port);
+		io_block_readers.Erase(port);
+		io_read_byte_handler.Erase(port);
 		if (max_width == io_width_t::word || max_width == io_width_t::dword)
-			io_read_word_handler.erase(port);
+			io_read_word_handler.Erase(port);
 		if (max_width == io_width_t::dword)
-			io_read_dword_handler.erase(port);
+			io_read_dword_handler.Erase(port);
 		++port;
 	}
 }
@@ -171,11 +213,11 @@ void IO_FreeWriteHandler(io_port_t port,
                          io_port_t range)
 {
 	while (range--) {
-		io_write_byte_handler.erase(port);
+		io_write_byte_handler.Erase(port);
 		if (width == io_width_t::word || width == io_width_t::dword)
-			io_write_word_handler.erase(port);
+			io_write_word_handler.Erase(port);
 		if (width == io_width_t::dword)
-			io_write_dword_handler.erase(port);
+			io_write_dword_handler.Erase(port);
 		++port;
 	}
 }
@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_IOHANDLER_CONTAINERS_H
+#define DOSBOX_IOHANDLER_CONTAINERS_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+
+#include "hardware/port.h"
+
+// Handlers for every port of one access width, looked up by indexing
+// rather than hashing. The port space is split into pages of 256 ports,
+// allocated when the first handler in them is registered, so a lookup is
+// two array reads while the table only holds memory for the few ranges
+// that devices actually use.
+template <typename Handler>
+class IO_HandlerTable {
+public:
+	// The handler registered for the port, or null if there's none
+	const Handler* Find(const io_port_t port) const
+	{
+		const auto& page = pages[port >> PageBits];
+		if (!page) {
+			return nullptr;
+		}
+		const auto& handler = (*page)[port & PageMask];
+		return handler ? &handler : nullptr;
+	}
+
+	const Handler& Set(const io_port_t port, const Handler& handler)
+	{
+		auto& page = pages[port >> PageBits];
+		if (!page) {
+			page = std::make_unique<Page>();
+		}
+		auto& entry = (*page)[port & PageMask];
+		if (!entry) {
+			++num_handlers;
+		}
+		entry = handler;
+		return entry;
+	}
+
+	void Erase(const io_port_t port)
+	{
+		const auto& page = pages[port >> PageBits];
+		if (!page) {
+			return;
+		}
+		auto& entry = (*page)[port & PageMask];
+		if (entry) {
+			entry = nullptr;
+			--num_handlers;
+		}
+	}
+
+	size_t size() const
+	{
+		return num_handlers;
+	}
+
+	size_t AllocatedBytes() const
+	{
+		size_t num_pages = 0;
+		for (const auto& page : pages) {
+			num_pages += page ? 1 : 0;
+		}
+		return sizeof(*this) + num_pages * sizeof(Page);
+	}
+
+	void clear()
+	{
+		for (auto& page : pages) {
+			page.reset();
+		}
+		num_handlers = 0;
+	}
+
+private:
+	static constexpr int PageBits      = 8;
+	static constexpr size_t PageSize   = size_t{1} << PageBits;
+	static constexpr io_port_t PageMask = PageSize - 1;
+	static constexpr size_t NumPages   = (size_t{UINT16_MAX} + 1) / PageSize;
+
+	using Page = std::array<Handler, PageSize>;
+
+	std::array<std::unique_ptr<Page>, NumPages> pages = {};
+	size_t num_handlers = 0;
+};
+
+// type-sized IO handler containers, indexed by width: byte, word, dword
+extern IO_HandlerTable<io_read_f> io_read_handlers[io_widths];
+extern IO_HandlerTable<io_write_f> io_write_handlers[io_widths];
+
+// Polling hints of the byte ports, dropped with their read handlers
+extern IO_HandlerTable<io_poll_hint_f> io_poll_hints;
+
+// Block readers of the ports, dropped with their read handlers
+extern IO_HandlerTable<io_read_block_f> io_block_readers;
+
+// The number of elements the port's block reader copied, or 0 if it has none
+uint32_t read_block_from_port(io_port_t port, io_width_t width, uint8_t* dst,
+                              uint32_t num);
+
+#endif // DOSBOX_IOHANDLER_CONTAINERS_H
@@ -4,13 +4,26 @@
 
 #include "memory.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
 #include <cstring>
+#include <string_view>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 
 #include "config/setup.h"
 #include "cpu/paging.h"
 #include "cpu/registers.h"
+#include "hardware/page_extents.h"
 #include "hardware/pci_bus.h"
 #include "hardware/port.h"
+#include "misc/footprint.h"
+#include "misc/savestate.h"
 #include "misc/support.h"
 
 constexpr auto Megabyte = 1024 * 1024;
@@ -24,13 +37,174 @@ constexpr auto SafeMegabytesDos   = 31;
 constexpr auto SafeMegabytesWin95 = 480;
 constexpr auto SafeMegabytesWin98 = 512;
 
+struct DosPage {
+	uint8_t bytes[DosPageSize] = {};
+};
+
+enum class HugePages { Off, Auto, On };
+
+// Guest RAM
+// ~~~~~~~~~
+// One zeroed host allocation for all of the guest's memory. Unless huge
+// pages are turned off, it's aligned to 2 MB and asks the host to back it
+// with 2 MB (or, on Windows, large) pages, which takes a lot of pressure
+// off the host TLB when a big guest touches its memory all over. 'on'
+// also tries the reserved huge page pool on Linux first.
+class GuestRam {
+public:
+	GuestRam() = default;
+	GuestRam(const GuestRam&)            = delete;
+	GuestRam& operator=(const GuestRam&) = delete;
+
+	~GuestRam()
+	{
+		Release();
+	}
+
+	void Allocate(size_t num_pages, HugePages huge_pages);
+
+	DosPage* data() const
+	{
+		return pages;
+	}
+	size_t size() const
+	{
+		return num_pages;
+	}
+	DosPage& operator[](const size_t index) const
+	{
+		return pages[index];
+	}
+
+	// The kind of host pages backing the allocation, for the log
+	const char* Backing() const
+	{
+		return backing;
+	}
+
+private:
+	void Release();
+
+	DosPage* pages      = nullptr;
+	size_t num_pages    = 0;
+	size_t mapped_bytes = 0;
+	const char* backing = "";
+};
+
+constexpr size_t HugePageSize = 2 * Megabyte;
+
+static size_t round_up(const size_t bytes, const size_t alignment)
+{
+	return (bytes + alignment - 1) / alignment * alignment;
+}
+
+void GuestRam::Allocate(const size_t new_num_pages, const HugePages huge_pages)
+{
+	Release();
+
+	const auto bytes = new_num_pages * DosPageSize;
+	void* block      = nullptr;
+	backing          = "normal pages";
+
+#if defined(WIN32)
+	const auto large_page_size = GetLargePageMinimum();
+	if (huge_pages != HugePages::Off && large_page_size) {
+		// Needs the 'Lock pages in memory' privilege, which most
+		// accounts don't have
+		mapped_bytes = round_up(bytes, large_page_size);
+		block        = VirtualAlloc(nullptr,
+                                     mapped_bytes,
+                                     MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                                     PAGE_READWRITE);
+		backing      = "large pages";
+	}
+	if (!block) {
+		mapped_bytes = bytes;
+		block   = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		backing = "normal pages";
+	}
+	if (!block) {
+		E_Exit("MEMORY: Failed to allocate %u MB of guest memory",
+		       static_cast<unsigned>(bytes / Megabyte));
+	}
+#else
+	mapped_bytes = round_up(bytes, HugePageSize);
+
+#if defined(MAP_HUGETLB)
+	if (huge_pages == HugePages::On) {
+		block = mmap(nullptr,
+		             mapped_bytes,
+		             PROT_READ | PROT_WRITE,
+		             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+		             -1,
+		             0);
+		if (block == MAP_FAILED) {
+			block = nullptr;
+		} else {
+			backing = "reserved huge pages";
+		}
+	}
+#endif
+	if (!block) {
+		// Map 2 MB more than needed, then unmap what lies outside the
+		// aligned block in the middle
+		const auto raw_bytes = mapped_bytes + HugePageSize;
+		const auto raw       = mmap(nullptr,
+                                  raw_bytes,
+                                  PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS,
+                                  -1,
+                                  0);
+		if (raw == MAP_FAILED) {
+			E_Exit("MEMORY: Failed to allocate %u MB of guest memory",
+			       static_cast<unsigned>(bytes / Megabyte));
+		}
+		const auto raw_start = reinterpret_cast<uintptr_t>(raw);
+		const auto start     = round_up(raw_start, HugePageSize);
+		const auto head      = start - raw_start;
+		const auto tail      = raw_bytes - head - mapped_bytes;
+		if (head) {
+			munmap(raw, head);
+		}
+		if (tail) {
+			munmap(reinterpret_cast<void*>(start + mapped_bytes), tail);
+		}
+		block = reinterpret_cast<void*>(start);
+
+#if defined(MADV_HUGEPAGE)
+		if (huge_pages != HugePages::Off &&
+		    madvise(block, mapped_bytes, MADV_HUGEPAGE) == 0) {
+			backing = "transparent huge pages";
+		}
+#endif
+	}
+#endif
+	pages     = static_cast<DosPage*>(block);
+	num_pages = new_num_pages;
+}
+
+void GuestRam::Release()
+{
+	if (!pages) {
+		return;
+	}
+#if defined(WIN32)
+	VirtualFree(pages, 0, MEM_RELEASE);
+#else
+	munmap(pages, mapped_bytes);
+#endif
+	pages     = nullptr;
+	num_pages = 0;
+}
+
 static struct MemoryBlock {
-	struct page_t {
-		uint8_t bytes[DosPageSize] = {};
-	};
-	std::vector<page_t> pages           = {};
+	using page_t = DosPage;
+
+	GuestRam pages                      = {};
 	std::vector<PageHandler*> phandlers = {};
 	std::vector<MemHandle> mhandles     = {};
+	// The pages from XMS_START on whose handle is 0
+	FreePageExtents free_pages = {};
 	struct {
 		Bitu start_page = 0;
 		Bitu end_page   = 0;
@@ -49,6 +223,8 @@ static struct MemoryBlock {
 // Points to the first byte of the first DOS memory page
 HostPt MemBase = {};
 
+static FootprintRegion guest_ram_region("guest_ram", "The emulated machine's memory.");
+
 class IllegalPageHandler final : public PageHandler {
 public:
 	IllegalPageHandler() {
@@ -94,8 +270,44 @@ public:
 	}
 	HostPt GetHostWritePt(const size_t phys_page) override
 	{
+		// Clean and watched pages are written through the handler, see
+		// below
+		if (!MEM_IsPageDirty(phys_page) || MEM_IsPageWatched(phys_page)) {
+			return nullptr;
+		}
 		return GetHostReadPt(phys_page); // same
 	}
+
+	// Only the first write to a page that's clean for the dirty page
+	// tracking or watched lands here. The page is linked again on the
+	// next access, with a direct write pointer now that it's dirty and
+	// the watches are dropped.
+	void writeb(PhysPt addr, uint8_t val) override
+	{
+		host_writeb(TrackedWritePt(addr), val);
+	}
+	void writew(PhysPt addr, uint16_t val) override
+	{
+		host_writew(TrackedWritePt(addr), val);
+	}
+	void writed(PhysPt addr, uint32_t val) override
+	{
+		host_writed(TrackedWritePt(addr), val);
+	}
+	void writeq(PhysPt addr, uint64_t val) override
+	{
+		host_writeq(TrackedWritePt(addr), val);
+	}
+
+private:
+	HostPt TrackedWritePt(const PhysPt lin_addr)
+	{
+		const auto phys_addr = PAGING_GetPhysicalAddress(lin_addr);
+		const auto phys_page = phys_addr / DosPageSize;
+		MEM_MarkPageDirty(phys_page);
+		PAGING_UnlinkPages(lin_addr / DosPageSize, 1);
+		return GetHostReadPt(phys_page) + (phys_addr % DosPageSize);
+	}
 };
 
 class ROMPageHandler final : public RAMPageHandler {
@@ -112,6 +324,12 @@ public:
 	void writed(PhysPt addr,uint32_t val) override{
 		LOG(LOG_CPU, LOG_ERROR)("Write 0x%x to rom at %x", val, addr);
 	}
+	void writeq(PhysPt addr, uint64_t val) override
+	{
+		LOG(LOG_CPU, LOG_ERROR)("Write 0x%llx to rom at %x",
+		                        static_cast<unsigned long long>(val),
+		                        addr);
+	}
 };
 
 uint16_t MEM_GetMinMegabytes()
@@ -192,26 +410,159 @@ void mem_strcpy(PhysPt dest,PhysPt src) {
 }
 
 void mem_memcpy(PhysPt dest,PhysPt src,Bitu size) {
-	while (size--) mem_writeb_inline(dest++,mem_readb_inline(src++));
+	// Copies forwards like the byte loop it replaced, overlaps included
+	MEM_BlockCopy(dest, src, size);
+}
+
+static size_t bytes_left_in_page(const PhysPt pt, const size_t size)
+{
+	return std::min<size_t>(size, MemPageSize - (pt & (MemPageSize - 1)));
 }
 
 void MEM_BlockRead(PhysPt pt,void * data,Bitu size) {
-	uint8_t * write=reinterpret_cast<uint8_t *>(data);
-	while (size--) {
-		*write++=mem_readb_inline(pt++);
+	uint8_t* write = static_cast<uint8_t*>(data);
+	while (size) {
+		// A page at a time, like MEM_BlockWrite()
+		auto in_page  = bytes_left_in_page(pt, size);
+		auto tlb_addr = get_tlb_read(pt);
+		if (!tlb_addr) {
+			// The first access to a page may map it, so the rest of
+			// it can still be copied in one go
+			*write++ = mem_readb_inline(pt++);
+			--size;
+			--in_page;
+			tlb_addr = get_tlb_read(pt);
+		}
+		if (tlb_addr) {
+			memcpy(write, tlb_addr + pt, in_page);
+			pt += static_cast<PhysPt>(in_page);
+			write += in_page;
+		} else {
+			for (size_t i = 0; i < in_page; ++i) {
+				*write++ = mem_readb_inline(pt++);
+			}
+		}
+		size -= in_page;
 	}
 }
 
 void MEM_BlockWrite(PhysPt pt, const void *data, size_t size)
 {
 	const uint8_t *read = static_cast<const uint8_t *>(data);
-	while (size--) {
-		mem_writeb_inline(pt++,*read++);
+	while (size) {
+		// A page at a time; pages the TLB maps straight to host memory
+		// are copied in one go, the others go through their handlers
+		auto in_page  = bytes_left_in_page(pt, size);
+		auto tlb_addr = get_tlb_write(pt);
+		if (!tlb_addr) {
+			mem_writeb_inline(pt++, *read++);
+			--size;
+			--in_page;
+			tlb_addr = get_tlb_write(pt);
+		}
+		if (tlb_addr) {
+			memcpy(tlb_addr + pt, read, in_page);
+			pt += static_cast<PhysPt>(in_page);
+			read += in_page;
+		} else {
+			for (size_t i = 0; i < in_page; ++i) {
+				mem_writeb_inline(pt++, *read++);
+			}
+		}
+		size -= in_page;
 	}
 }
 
-void MEM_BlockCopy(PhysPt dest,PhysPt src,Bitu size) {
-	mem_memcpy(dest,src,size);
+void MEM_BlockCopy(PhysPt dest, PhysPt src, Bitu size)
+{
+	while (size) {
+		// A page at a time on both sides; where the TLB maps both
+		// straight to host memory they're copied in one go, else through
+		// the handlers
+		const auto chunk = std::min<size_t>(
+		        {size,
+		         MemPageSize - (src & (MemPageSize - 1)),
+		         MemPageSize - (dest & (MemPageSize - 1))});
+
+		// Copying forwards byte by byte repeats the start of the source
+		// when the destination overlaps it from above
+		const bool is_smearing = dest > src && dest - src < chunk;
+
+		const auto read_pt  = get_tlb_read(src);
+		const auto write_pt = get_tlb_write(dest);
+		if (read_pt && write_pt && !is_smearing) {
+			memmove(write_pt + dest, read_pt + src, chunk);
+			dest += static_cast<PhysPt>(chunk);
+			src += static_cast<PhysPt>(chunk);
+		} else {
+			for (size_t i = 0; i < chunk; ++i) {
+				mem_writeb_inline(dest++, mem_readb_inline(src++));
+			}
+		}
+		size -= chunk;
+	}
+}
+
+HostPt MEM_GetHostReadSpan(const PhysPt pt, const size_t size)
+{
+	if (size == 0) {
+		return nullptr;
+	}
+	const auto tlb_addr = get_tlb_read(pt);
+	if (!tlb_addr) {
+		return nullptr;
+	}
+	const auto host_pt = tlb_addr + pt;
+
+	// Every further page must follow on from the first in host memory
+	const auto last = pt + static_cast<PhysPt>(size - 1);
+	for (auto page = (pt & ~(MemPageSize - 1)) + MemPageSize;
+	     page != 0 && page <= last;
+	     page += MemPageSize) {
+		const auto page_addr = get_tlb_read(page);
+		if (!page_addr || page_addr + page != host_pt + (page - pt)) {
+			return nullptr;
+		}
+	}
+	return host_pt;
+}
+
+// Clean or watched RAM pages have no direct write pointer until they're
+// first written; rewriting a byte of a readable page with its own value
+// goes through the handler, which maps the page if it's RAM
+static HostPt get_or_map_tlb_write(const PhysPt pt)
+{
+	if (const auto tlb_addr = get_tlb_write(pt); tlb_addr) {
+		return tlb_addr;
+	}
+	if (!get_tlb_read(pt)) {
+		return nullptr;
+	}
+	mem_writeb_inline(pt, mem_readb_inline(pt));
+	return get_tlb_write(pt);
+}
+
+HostPt MEM_GetHostWriteSpan(const PhysPt pt, const size_t size)
+{
+	if (size == 0) {
+		return nullptr;
+	}
+	const auto tlb_addr = get_or_map_tlb_write(pt);
+	if (!tlb_addr) {
+		return nullptr;
+	}
+	const auto host_pt = tlb_addr + pt;
+
+	const auto last = pt + static_cast<PhysPt>(size - 1);
+	for (auto page = (pt & ~(MemPageSize - 1)) + MemPageSize;
+	     page != 0 && page <= last;
+	     page += MemPageSize) {
+		const auto page_addr = get_or_map_tlb_write(page);
+		if (!page_addr || page_addr + page != host_pt + (page - pt)) {
+			return nullptr;
+		}
+	}
+	return host_pt;
 }
 
 void MEM_StrCopy(PhysPt pt,char * data,Bitu size) {
@@ -223,6 +574,106 @@ void MEM_StrCopy(PhysPt pt,char * data,Bitu size) {
 	*data=0;
 }
 
+MemDirtyPages mem_dirty_pages = {};
+
+static std::vector<uint64_t> dirty_page_bits = {};
+
+void MEM_MarkRangeDirty(const PhysPt addr, const size_t num_bytes)
+{
+	if (num_bytes == 0) {
+		return;
+	}
+	const auto first_page = addr / DosPageSize;
+	const auto last_page  = (addr + num_bytes - 1) / DosPageSize;
+	for (auto page = first_page; page <= last_page; ++page) {
+		MEM_MarkPageDirty(page);
+	}
+}
+
+void MEM_EnableDirtyTracking(const bool enable)
+{
+	if (enable == MEM_IsDirtyTrackingEnabled()) {
+		return;
+	}
+	if (enable) {
+		const auto num_pages = memory.pages.size();
+		dirty_page_bits.assign((num_pages + 63) / 64, ~uint64_t{0});
+		mem_dirty_pages = {dirty_page_bits.data(), num_pages};
+	} else {
+		mem_dirty_pages = {};
+		dirty_page_bits.clear();
+		// Pages linked while clean still lack a direct write pointer
+		PAGING_ClearTLB();
+	}
+}
+
+MemWriteWatches mem_write_watches = {};
+
+static std::vector<uint64_t> watched_page_bits = {};
+
+static std::vector<size_t> watched_pages = {};
+
+bool MEM_WatchPageWrites(const size_t phys_page)
+{
+	if (phys_page >= memory.pages.size() ||
+	    memory.phandlers[phys_page] != &ram_page_handler) {
+		return false;
+	}
+	if (MEM_IsPageWatched(phys_page)) {
+		return true;
+	}
+	if (watched_page_bits.empty()) {
+		const auto num_pages = memory.pages.size();
+		watched_page_bits.assign((num_pages + 63) / 64, 0);
+		mem_write_watches.bits      = watched_page_bits.data();
+		mem_write_watches.num_pages = num_pages;
+	}
+	watched_page_bits[phys_page / 64] |= uint64_t{1} << (phys_page % 64);
+	watched_pages.push_back(phys_page);
+
+	// The page may already be linked for direct writes, under any number
+	// of linear addresses
+	PAGING_UnlinkPhysicalPage(check_cast<uint32_t>(phys_page));
+	return true;
+}
+
+void MEM_DropWriteWatches()
+{
+	if (watched_pages.empty()) {
+		return;
+	}
+	for (const auto page : watched_pages) {
+		watched_page_bits[page / 64] &= ~(uint64_t{1} << (page % 64));
+	}
+	watched_pages.clear();
+	++mem_write_watches.generation;
+}
+
+bool MEM_IsDirtyTrackingEnabled()
+{
+	return mem_dirty_pages.num_pages != 0;
+}
+
+std::vector<uint32_t> MEM_TakeDirtyPages()
+{
+	std::vector<uint32_t> pages = {};
+	for (size_t word = 0; word < dirty_page_bits.size(); ++word) {
+		for (auto bits = dirty_page_bits[word]; bits; bits &= bits - 1) {
+			const auto bit  = static_cast<size_t>(std::countr_zero(bits));
+			const auto page = word * 64 + bit;
+			if (page < mem_dirty_pages.num_pages) {
+				pages.push_back(check_cast<uint32_t>(page));
+			}
+		}
+		dirty_page_bits[word] = 0;
+	}
+	// Every write pointer in the TLB belongs to a page that's clean now
+	if (!pages.empty()) {
+		PAGING_ClearTLB();
+	}
+	return pages;
+}
+
 uint32_t MEM_TotalPages(void)
 {
 	return check_cast<uint32_t>(memory.pages.size());
@@ -230,33 +681,40 @@ uint32_t MEM_TotalPages(void)
 
 uint32_t MEM_FreeLargest()
 {
-	uint32_t size    = 0;
-	uint32_t largest = 0;
-	size_t   index   = XMS_START;
-	while (index < memory.pages.size()) {
-		if (!memory.mhandles[index]) {
-			++size;
-		} else {
-			largest = std::max(size, largest);
-			size = 0;
-		}
-		++index;
-	}
-	largest = std::max(size, largest);
-	return largest;
+	return memory.free_pages.Largest();
 }
 
 uint32_t MEM_FreeTotal()
 {
-	uint32_t free  = 0;
-	size_t   index = XMS_START;
-	while (index < memory.pages.size()) {
-		if (!memory.mhandles[index]) {
-			++free;
+	return memory.free_pages.Total();
+}
+
+// Rebuilds the free page index from the handle table, which a restored
+// save-state replaces wholesale
+static void rebuild_free_pages()
+{
+	memory.free_pages.Clear();
+
+	const auto end = memory.mhandles.size();
+	auto index     = static_cast<size_t>(XMS_START);
+	while (index < end) {
+		if (memory.mhandles[index]) {
+			++index;
+			continue;
 		}
-		++index;
+		const auto first = index;
+		while (index < end && !memory.mhandles[index]) {
+			++index;
+		}
+		memory.free_pages.Free(check_cast<uint32_t>(first),
+		                       check_cast<uint32_t>(index - first));
 	}
-	return free;
+}
+
+static void release_page(const MemHandle page)
+{
+	memory.mhandles[page] = 0;
+	memory.free_pages.Free(check_cast<uint32_t>(page));
 }
 
 uint32_t MEM_AllocatedPages(MemHandle handle) 
@@ -272,40 +730,10 @@ uint32_t MEM_AllocatedPages(MemHandle handle)
 
 //TODO Maybe some protection for this whole allocation scheme
 
+// The smallest free run that fits, the lowest of equally small ones, as
+// the linear scan this replaced picked
 inline Bitu BestMatch(Bitu size) {
-	Bitu index=XMS_START;	
-	Bitu first=0;
-	Bitu best=0xfffffff;
-	Bitu best_first=0;
-	while (index < memory.pages.size()) {
-		/* Check if we are searching for first free page */
-		if (!first) {
-			/* Check if this is a free page */
-			if (!memory.mhandles[index]) {
-				first=index;	
-			}
-		} else {
-			/* Check if this still is used page */
-			if (memory.mhandles[index]) {
-				Bitu pages=index-first;
-				if (pages==size) {
-					return first;
-				} else if (pages>size) {
-					if (pages<best) {
-						best=pages;
-						best_first=first;
-					}
-				}
-				first=0;			//Always reset for new search
-			}
-		}
-		index++;
-	}
-	/* Check for the final block if we can */
-	if (first && (index-first>=size) && (index-first<best)) {
-		return first;
-	}
-	return best_first;
+	return memory.free_pages.BestFit(check_cast<uint32_t>(size));
 }
 
 MemHandle MEM_AllocatePages(Bitu pages,bool sequence) {
@@ -314,6 +742,7 @@ MemHandle MEM_AllocatePages(Bitu pages,bool sequence) {
 	if (sequence) {
 		Bitu index=BestMatch(pages);
 		if (!index) return 0;
+		memory.free_pages.Allocate(check_cast<uint32_t>(index), check_cast<uint32_t>(pages));
 		MemHandle * next=&ret;
 		while (pages) {
 			*next=index;
@@ -327,7 +756,10 @@ MemHandle MEM_AllocatePages(Bitu pages,bool sequence) {
 		while (pages) {
 			Bitu index=BestMatch(1);
 			if (!index) E_Exit("MEM:corruption during allocate");
-			while (pages && (!memory.mhandles[index])) {
+			const auto start = check_cast<uint32_t>(index);
+			const auto run   = std::min<Bitu>(pages, memory.free_pages.RunAt(start));
+			memory.free_pages.Allocate(start, check_cast<uint32_t>(run));
+			for (Bitu i = 0; i < run; ++i) {
 				*next=index;
 				next=&memory.mhandles[index];
 				index++;pages--;
@@ -345,7 +777,7 @@ MemHandle MEM_GetNextFreePage(void) {
 void MEM_ReleasePages(MemHandle handle) {
 	while (handle>0) {
 		MemHandle next=memory.mhandles[handle];
-		memory.mhandles[handle]=0;
+		release_page(handle);
 		handle=next;
 	}
 }
@@ -381,7 +813,7 @@ bool MEM_ReAllocatePages(MemHandle & handle,Bitu pages,bool sequence) {
 		index=next;
 		while (old_pages) {
 			next=memory.mhandles[index];
-			memory.mhandles[index]=0;
+			release_page(index);
 			index=next;
 			old_pages--;
 		}
@@ -390,15 +822,10 @@ bool MEM_ReAllocatePages(MemHandle & handle,Bitu pages,bool sequence) {
 		/* Increase size, check for enough free space */
 		Bitu need=pages-old_pages;
 		if (sequence) {
-			index=last+1;
-			Bitu free=0;
-			while (static_cast<uint32_t>(index) < memory.pages.size() &&
-			       !memory.mhandles[index]) {
-				index++;
-				free++;
-			}
-			if (free>=need) {
+			const auto first_free = check_cast<uint32_t>(last + 1);
+			if (memory.free_pages.RunAt(first_free) >= need) {
 				/* Enough space allocate more pages */
+				memory.free_pages.Allocate(first_free, check_cast<uint32_t>(need));
 				index=last;
 				while (need) {
 					memory.mhandles[index]=index+1;
@@ -698,6 +1125,72 @@ static void check_num_megabytes(const int num_megabytes)
 	}
 }
 
+// Page handlers are left alone: they are set up from the configuration and,
+// under the dynamic core, by the code cache, neither of which a restore
+// should touch. The handle chains track XMS and EMS allocations.
+void MEM_SaveState(SaveStateWriter& out)
+{
+	out.Write(static_cast<uint32_t>(memory.pages.size()));
+	out.WriteBytes(memory.pages.data(),
+	               memory.pages.size() * sizeof(MemoryBlock::page_t));
+	out.WriteBytes(memory.mhandles.data(), memory.mhandles.size() * sizeof(MemHandle));
+	out.Write(memory.a20);
+}
+
+void MEM_SaveStateWithoutPages(SaveStateWriter& out)
+{
+	out.Write(static_cast<uint32_t>(memory.pages.size()));
+	out.WriteBytes(memory.mhandles.data(), memory.mhandles.size() * sizeof(MemHandle));
+	out.Write(memory.a20);
+}
+
+// Restores the memory section, with the page contents taken from 'image'
+// if the section doesn't carry them
+static bool load_memory_state(SaveStateReader& in, const bool apply,
+                              const std::vector<uint8_t>* image)
+{
+	uint32_t num_pages = 0;
+	if (!in.Read(num_pages)) {
+		return false;
+	}
+	if (num_pages != memory.pages.size()) {
+		return in.Fail("memsize differs");
+	}
+	const auto num_bytes = num_pages * sizeof(MemoryBlock::page_t);
+	if (image && image->size() != num_bytes) {
+		return in.Fail("memory image size differs");
+	}
+	const auto pages    = image ? image->data() : in.Take(num_bytes);
+	const auto mhandles = in.Take(num_pages * sizeof(MemHandle));
+	decltype(memory.a20) a20 = {};
+	if (!pages || !mhandles || !in.Read(a20)) {
+		return false;
+	}
+	if (!apply) {
+		return true;
+	}
+
+	std::memcpy(memory.pages.data(), pages, num_bytes);
+	std::memcpy(memory.mhandles.data(), mhandles, num_pages * sizeof(MemHandle));
+	rebuild_free_pages();
+	memory.a20 = a20;
+
+	// Every page was just written
+	MEM_MarkRangeDirty(0, num_bytes);
+	return true;
+}
+
+bool MEM_LoadState(SaveStateReader& in, const bool apply)
+{
+	return load_memory_state(in, apply, nullptr);
+}
+
+bool MEM_LoadStateWithPages(SaveStateReader& in, const bool apply,
+                            const std::vector<uint8_t>& image)
+{
+	return load_memory_state(in, apply, &image);
+}
+
 HostPt GetMemBase(void)
 {
 	return MemBase;
@@ -718,17 +1211,39 @@ public:
 
 		const auto num_pages = num_megabytes * PagesPerMegabyte;
 
-		// Size the actual memory pages
-		memory.pages.resize(num_pages);
+		const std::string huge_pages_pref = section->GetString("memsize_hugepages");
+		const auto huge_pages = huge_pages_pref == "on"    ? HugePages::On
+		                        : huge_pages_pref == "off" ? HugePages::Off
+		                                                   : HugePages::Auto;
+
+		// Tracking starts over with the next checkpoint
+		mem_dirty_pages = {};
+		dirty_page_bits.clear();
+
+		// The watches are sized to the memory
+		MEM_DropWriteWatches();
+		mem_write_watches.bits      = nullptr;
+		mem_write_watches.num_pages = 0;
+		watched_page_bits.clear();
+
+		// Allocate the actual memory pages
+		memory.pages.Allocate(num_pages, huge_pages);
 
 		// The MemBase is address of the first page's first byte
 		MemBase = &(memory.pages[0].bytes[0]);
+		guest_ram_region.Track(MemBase, num_pages * DosPageSize);
 
-		LOG_MSG("MEMORY: Using %d DOS memory pages (%u MB) at address: %p",
+		LOG_MSG("MEMORY: Using %d DOS memory pages (%u MB) backed by %s at address: %p",
 		        static_cast<int>(memory.pages.size()),
 		        num_megabytes,
+		        memory.pages.Backing(),
 		        static_cast<void*>(MemBase));
 
+		if (huge_pages == HugePages::On &&
+		    memory.pages.Backing() == std::string_view("normal pages")) {
+			LOG_WARNING("MEMORY: Huge pages aren't available on this host; using normal pages");
+		}
+
 		// Setup the page handlers, defaulting to the RAM handler
 		memory.phandlers.clear();
 		memory.phandlers.resize(num_pages, &ram_page_handler);
@@ -737,6 +1252,7 @@ public:
 		// memory-allocation
 		memory.mhandles.clear();
 		memory.mhandles.resize(num_pages, 0);
+		memory.free_pages.Reset(XMS_START, check_cast<uint32_t>(num_pages));
 
 		using page_range_t = std::pair<uint16_t, uint16_t>;
 		auto install_rom_page_handlers = [&](const page_range_t& page_range) {
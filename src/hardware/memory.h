@@ -7,6 +7,8 @@
 
 #include "dosbox.h"
 
+#include <vector>
+
 #include "utils/mem_host.h"
 #include "utils/mem_unaligned.h"
 #include "misc/types.h"
@@ -61,6 +63,82 @@ void MEM_PreparePCJRCartRom();
 MemHandle MEM_NextHandle(MemHandle handle);
 MemHandle MEM_NextHandleAt(MemHandle handle, Bitu where);
 
+// Dirty page tracking
+// ~~~~~~~~~~~~~~~~~~~
+// While enabled, guest RAM keeps a bit per page telling whether it was
+// written since the last MEM_TakeDirtyPages(), so incremental save-states
+// only copy the pages that changed. Clean pages are linked into the TLB
+// without a direct write pointer, which sends the first write to each of
+// them through the RAM page handler to mark it; the pages are linked for
+// direct writes again from then on. Host code writing guest RAM behind
+// the TLB's back (phys_write*, DMA, the dynamic core's code pages) marks
+// the pages itself.
+
+struct MemDirtyPages {
+	uint64_t* bits   = nullptr;
+	size_t num_pages = 0;
+};
+
+// Zero pages while tracking is off
+extern MemDirtyPages mem_dirty_pages;
+
+// Page write watches
+// ~~~~~~~~~~~~~~~~~~
+// Host code that keeps what it read from guest RAM, such as the CPU's
+// segment descriptor cache, watches the pages it read. Watched pages are
+// linked into the TLB without a direct write pointer, like clean ones, so
+// every write to them reaches MEM_MarkPageDirty(). The first write to any
+// of them drops all the watches and bumps the generation, which tells the
+// owners their copies are stale. Changing the linear to physical mappings
+// (flushing the TLB, INVLPG, remapping a page) drops them as well, as the
+// owners found the pages through those.
+
+struct MemWriteWatches {
+	uint64_t* bits      = nullptr;
+	size_t num_pages    = 0;
+	uint32_t generation = 0;
+};
+
+// Zero pages until the first watch
+extern MemWriteWatches mem_write_watches;
+
+static inline bool MEM_IsPageWatched(const size_t phys_page)
+{
+	return phys_page < mem_write_watches.num_pages &&
+	       (mem_write_watches.bits[phys_page / 64] >> (phys_page % 64)) & 1;
+}
+
+// Returns false if the page isn't plain RAM, which can't be watched
+bool MEM_WatchPageWrites(size_t phys_page);
+
+void MEM_DropWriteWatches();
+
+static inline void MEM_MarkPageDirty(const size_t phys_page)
+{
+	if (phys_page < mem_dirty_pages.num_pages) {
+		mem_dirty_pages.bits[phys_page / 64] |= uint64_t{1} << (phys_page % 64);
+	}
+	if (MEM_IsPageWatched(phys_page)) {
+		MEM_DropWriteWatches();
+	}
+}
+
+static inline bool MEM_IsPageDirty(const size_t phys_page)
+{
+	return phys_page >= mem_dirty_pages.num_pages ||
+	       (mem_dirty_pages.bits[phys_page / 64] >> (phys_page % 64)) & 1;
+}
+
+void MEM_MarkRangeDirty(PhysPt addr, size_t num_bytes);
+
+// Turning tracking on marks every page dirty
+void MEM_EnableDirtyTracking(bool enable);
+bool MEM_IsDirtyTrackingEnabled();
+
+// The pages written since the previous call, in ascending order; they're
+// clean again afterwards
+std::vector<uint32_t> MEM_TakeDirtyPages();
+
 static inline void var_write(uint8_t *var, uint8_t val)
 {
 	host_writeb(var, val);
@@ -123,26 +201,34 @@ void mem_writeq(PhysPt pt, uint64_t val);
 
 static inline void phys_writeb(PhysPt addr, uint8_t val)
 {
+	MEM_MarkPageDirty(addr / MemPageSize);
 	host_writeb(MemBase + addr, val);
 }
 
 static inline void phys_writew(PhysPt addr, uint16_t val)
 {
+	MEM_MarkPageDirty(addr / MemPageSize);
+	MEM_MarkPageDirty((addr + 1) / MemPageSize);
 	host_writew(MemBase + addr, val);
 }
 
 static inline void phys_writed(PhysPt addr, uint32_t val)
 {
+	MEM_MarkPageDirty(addr / MemPageSize);
+	MEM_MarkPageDirty((addr + 3) / MemPageSize);
 	host_writed(MemBase + addr, val);
 }
 
 static inline void phys_writeq(PhysPt addr, uint64_t val)
 {
+	MEM_MarkPageDirty(addr / MemPageSize);
+	MEM_MarkPageDirty((addr + 7) / MemPageSize);
 	host_writeq(MemBase + addr, val);
 }
 
 static inline void phys_writes(PhysPt addr, const std::string& string)
 {
+	MEM_MarkRangeDirty(addr, string.size());
 	auto destination = MemBase + addr;
 	for (auto character : string) {
 		host_writeb(destination++, character);
@@ -174,6 +260,13 @@ static inline uint64_t phys_readq(PhysPt addr)
 void MEM_BlockWrite(PhysPt pt, const void *data, size_t size);
 void MEM_BlockRead(PhysPt pt, void *data, Bitu size);
 void MEM_BlockCopy(PhysPt dest, PhysPt src, Bitu size);
+
+// The host memory behind a span of guest memory if all of its pages map
+// straight to host memory, one after the other, or nullptr. Only valid
+// until the guest runs again, as it may remap the pages.
+HostPt MEM_GetHostReadSpan(PhysPt pt, size_t size);
+HostPt MEM_GetHostWriteSpan(PhysPt pt, size_t size);
+
 void MEM_StrCopy(PhysPt pt, char *data, Bitu size);
 
 void mem_memcpy(PhysPt dest, PhysPt src, Bitu size);
@@ -1016,7 +1016,15 @@ public:
 					IPaddress *ptrAddr;
 					for(i=0;i<SOCKETTABLESIZE;i++) {
 						if(IPX_isConnectedToServer(i,&ptrAddr)) {
-							WriteOut("     %d.%d.%d.%d from port %d\n", CONVIP(ptrAddr->host), SDLNet_Read16(&ptrAddr->port));
+							uint64_t packets_from = 0;
+							uint64_t packets_to   = 0;
+							IPX_GetServerPeerCounters(i, packets_from, packets_to);
+							WriteOut("     %d.%d.%d.%d from port %d, "
+							         "%llu packets sent, %llu received\n",
+							         CONVIP(ptrAddr->host),
+							         SDLNet_Read16(&ptrAddr->port),
+							         static_cast<unsigned long long>(packets_from),
+							         static_cast<unsigned long long>(packets_to));
 						}
 					}
 					WriteOut("\n");
@@ -7,11 +7,14 @@
 
 #include "hardware/network/ipxserver.h"
 
+#include <array>
 #include <atomic>
 #include <thread>
+#include <unordered_map>
 
 #include "hardware/network/ipx.h"
 #include "hardware/timer.h"
+#include "misc/perf_counters.h"
 
 static constexpr int UDP_UNICAST = -1; // SDLNet magic number
 
@@ -19,10 +22,38 @@ static IPaddress ipxServerIp;     // IPAddress for server's listening port
 static UDPsocket ipxServerSocket; // Listening server socket
 static SDLNet_SocketSet socket_set = nullptr;
 
-static packetBuffer connBuffer[SOCKETTABLESIZE];
-
 static uint8_t inBuffer[IPXBUFFERSIZE];
-static IPaddress ipconn[SOCKETTABLESIZE]; // Active TCP/IP connection
+
+// A registered client, with what the server relayed from and to it. The
+// counters are read by the IPXNET command while the server thread runs.
+struct IpxPeer {
+	IPaddress address = {}; // Active UDP connection
+	bool connected    = false;
+
+	std::atomic<uint64_t> packets_from = 0;
+	std::atomic<uint64_t> bytes_from   = 0;
+	std::atomic<uint64_t> packets_to   = 0;
+	std::atomic<uint64_t> bytes_to     = 0;
+};
+
+static std::array<IpxPeer, SOCKETTABLESIZE> peers = {};
+
+// The registered peers' indexes by address, so relaying a packet doesn't
+// scan the whole table
+static std::unordered_map<uint64_t, size_t> peer_indexes = {};
+
+// A broadcast is sent to every other peer in one go
+static std::array<UDPpacket, SOCKETTABLESIZE> broadcast_packets = {};
+static std::array<UDPpacket*, SOCKETTABLESIZE> broadcast_packet_ptrs = {};
+
+static PerfCounter ipxserver_packets_relayed(
+        "ipxserver_packets_relayed",
+        "IPX packets the IPX server received from its clients to relay.");
+
+static PerfCounter ipxserver_packets_sent(
+        "ipxserver_packets_sent",
+        "IPX packets the IPX server sent to its clients, counting each "
+        "recipient of a broadcast.");
 
 static std::thread ipx_server_thread;
 static std::atomic_bool ipx_server_running = false;
@@ -38,28 +69,32 @@ uint8_t packetCRC(uint8_t* buffer, uint16_t bufSize)
 	return tmpCRC;
 }
 
-/*
-static void closeSocket(uint16_t sockidx) {
-	uint32_t host;
+static uint64_t to_peer_key(const uint32_t host, const uint16_t port)
+{
+	return (uint64_t{host} << 16) | port;
+}
+
+static uint64_t to_peer_key(const IPaddress& address)
+{
+	return to_peer_key(address.host, address.port);
+}
 
-	host = ipconn[sockidx].host;
-	LOG_MSG("IPXSERVER: %d.%d.%d.%d disconnected", CONVIP(host));
+static IpxPeer* find_peer(const uint32_t host, const uint16_t port)
+{
+	const auto it = peer_indexes.find(to_peer_key(host, port));
+	return (it != peer_indexes.end()) ? &peers[it->second] : nullptr;
+}
 
-	SDLNet_TCP_DelSocket(serverSocketSet,tcpconn[sockidx]);
-	SDLNet_TCP_Close(tcpconn[sockidx]);
-	connBuffer[sockidx].connected = false;
-	connBuffer[sockidx].waitsize = false;
+static void count_sent(IpxPeer& peer, const int bytes)
+{
+	++peer.packets_to;
+	peer.bytes_to += static_cast<uint64_t>(bytes);
+	ipxserver_packets_sent.Add();
 }
-*/
 
 static void sendIPXPacket(uint8_t *buffer, int16_t bufSize) {
 	uint16_t srcport, destport;
 	uint32_t srchost, desthost;
-	UDPpacket outPacket;
-	outPacket.channel = -1;
-	outPacket.data = buffer;
-	outPacket.len = bufSize;
-	outPacket.maxlen = bufSize;
 	IPXHeader *tmpHeader;
 	tmpHeader = (IPXHeader *)buffer;
 
@@ -69,43 +104,86 @@ static void sendIPXPacket(uint8_t *buffer, int16_t bufSize) {
 	srcport = tmpHeader->src.addr.byIP.port;
 	destport = tmpHeader->dest.addr.byIP.port;
 
+	if (auto sender = find_peer(srchost, srcport)) {
+		++sender->packets_from;
+		sender->bytes_from += static_cast<uint64_t>(bufSize);
+	}
+	ipxserver_packets_relayed.Add();
+
 	if(desthost == 0xffffffff) {
 		// Broadcast
-		for (uint16_t i = 0; i < SOCKETTABLESIZE; ++i) {
-			if(connBuffer[i].connected && ((ipconn[i].host != srchost)||(ipconn[i].port!=srcport))) {
-				outPacket.address = ipconn[i];
-				const int result = SDLNet_UDP_Send(ipxServerSocket,
-				                                   UDP_UNICAST,
-				                                   &outPacket);
-				if (result == 0) {
-					LOG_MSG("IPXSERVER: %s", SDLNet_GetError());
-					continue;
-				}
-				//LOG_MSG("IPXSERVER: Packet of %d bytes sent from %d.%d.%d.%d to %d.%d.%d.%d (BROADCAST) (%x CRC)", bufSize, CONVIP(srchost), CONVIP(ipconn[i].host), packetCRC(&buffer[30], bufSize-30));
+		std::array<IpxPeer*, SOCKETTABLESIZE> recipients = {};
+		int num_packets = 0;
+		for (auto& peer : peers) {
+			if (peer.connected && ((peer.address.host != srchost) ||
+			                       (peer.address.port != srcport))) {
+				auto& packet   = broadcast_packets[num_packets];
+				packet.channel = UDP_UNICAST;
+				packet.data    = buffer;
+				packet.len     = bufSize;
+				packet.maxlen  = bufSize;
+				packet.address = peer.address;
+
+				broadcast_packet_ptrs[num_packets] = &packet;
+				recipients[num_packets]            = &peer;
+				++num_packets;
 			}
 		}
+		if (num_packets == 0) {
+			return;
+		}
+		const int num_sent = SDLNet_UDP_SendV(ipxServerSocket,
+		                                      broadcast_packet_ptrs.data(),
+		                                      num_packets);
+		if (num_sent < num_packets) {
+			LOG_MSG("IPXSERVER: %s", SDLNet_GetError());
+		}
+		for (int i = 0; i < num_packets; ++i) {
+			if (broadcast_packets[i].status > 0) {
+				count_sent(*recipients[i], bufSize);
+			}
+		}
+		//LOG_MSG("IPXSERVER: Packet of %d bytes sent from %d.%d.%d.%d to %d peers (BROADCAST) (%x CRC)", bufSize, CONVIP(srchost), num_packets, packetCRC(&buffer[30], bufSize-30));
 	} else {
 		// Specific address
-		for (uint16_t i = 0; i < SOCKETTABLESIZE; ++i) {
-			if((connBuffer[i].connected) && (ipconn[i].host == desthost) && (ipconn[i].port == destport)) {
-				outPacket.address = ipconn[i];
-				const int result = SDLNet_UDP_Send(ipxServerSocket,
-				                                   UDP_UNICAST,
-				                                   &outPacket);
-				if (result == 0) {
-					LOG_MSG("IPXSERVER: %s", SDLNet_GetError());
-					continue;
-				}
-				//LOG_MSG("IPXSERVER: Packet sent from %d.%d.%d.%d to %d.%d.%d.%d", CONVIP(srchost), CONVIP(desthost));
-			}
+		auto peer = find_peer(desthost, destport);
+		if (!peer) {
+			return;
+		}
+		UDPpacket outPacket;
+		outPacket.channel = UDP_UNICAST;
+		outPacket.data    = buffer;
+		outPacket.len     = bufSize;
+		outPacket.maxlen  = bufSize;
+		outPacket.address = peer->address;
+
+		const int result = SDLNet_UDP_Send(ipxServerSocket,
+		                                   UDP_UNICAST,
+		                                   &outPacket);
+		if (result == 0) {
+			LOG_MSG("IPXSERVER: %s", SDLNet_GetError());
+			return;
 		}
+		count_sent(*peer, bufSize);
+		//LOG_MSG("IPXSERVER: Packet sent from %d.%d.%d.%d to %d.%d.%d.%d", CONVIP(srchost), CONVIP(desthost));
 	}
 }
 
 bool IPX_isConnectedToServer(Bits tableNum, IPaddress ** ptrAddr) {
 	if(tableNum >= SOCKETTABLESIZE) return false;
-	*ptrAddr = &ipconn[tableNum];
-	return connBuffer[tableNum].connected;
+	*ptrAddr = &peers[tableNum].address;
+	return peers[tableNum].connected;
+}
+
+bool IPX_GetServerPeerCounters(const Bits tableNum, uint64_t& packets_from,
+                               uint64_t& packets_to)
+{
+	if (tableNum >= SOCKETTABLESIZE || !peers[tableNum].connected) {
+		return false;
+	}
+	packets_from = peers[tableNum].packets_from;
+	packets_to   = peers[tableNum].packets_to;
+	return true;
 }
 
 static void ackClient(IPaddress clientAddr) {
@@ -135,20 +213,63 @@ static void ackClient(IPaddress clientAddr) {
 		        SDLNet_GetError());
 }
 
+static void registerClient(const IPaddress& reported_addr, const IPaddress& source_addr)
+{
+	// A client registering again keeps its entry, with the port number
+	// it sends from now
+	auto it = peer_indexes.find(to_peer_key(reported_addr));
+	if (it == peer_indexes.end()) {
+		it = peer_indexes.find(to_peer_key(source_addr));
+	}
+	if (it != peer_indexes.end()) {
+		auto& peer = peers[it->second];
+		LOG_MSG("IPXSERVER: Reconnect from %d.%d.%d.%d",
+		        CONVIP(reported_addr.host));
+
+		const auto index = it->second;
+		peer_indexes.erase(it);
+		peer.address.port = source_addr.port;
+		peer_indexes[to_peer_key(peer.address)] = index;
+
+		ackClient(source_addr);
+		return;
+	}
+
+	for (size_t i = 0; i < peers.size(); ++i) {
+		auto& peer = peers[i];
+		if (peer.connected) {
+			continue;
+		}
+		// Use prefered host IP rather than the reported source IP
+		// It may be better to use the reported source
+		peer.address   = source_addr;
+		peer.connected = true;
+		peer_indexes[to_peer_key(peer.address)] = i;
+
+		const auto host = peer.address.host;
+		LOG_MSG("IPXSERVER: Connect from %d.%d.%d.%d", CONVIP(host));
+		ackClient(source_addr);
+		return;
+	}
+	LOG_MSG("IPXSERVER: Connection from %d.%d.%d.%d refused, all %d "
+	        "connections are in use",
+	        CONVIP(source_addr.host),
+	        SOCKETTABLESIZE);
+}
+
+// Relays every packet that has arrived since the last call
 static void IPX_ServerLoop() {
 	UDPpacket inPacket;
 	IPaddress tmpAddr;
 
 	//char regString[] = "IPX Register\0";
 
-	uint32_t host;
-
 	inPacket.channel = -1;
 	inPacket.data = &inBuffer[0];
 	inPacket.maxlen = IPXBUFFERSIZE;
 
-	const int result = SDLNet_UDP_Recv(ipxServerSocket, &inPacket);
-	if (result != 0) {
+	while (ipx_server_running &&
+	       SDLNet_UDP_Recv(ipxServerSocket, &inPacket) > 0) {
 		// Check to see if incoming packet is a registration packet
 		// For this, I just spoofed the echo protocol packet designation 0x02
 		IPXHeader *tmpHeader;
@@ -159,28 +280,8 @@ static void IPX_ServerLoop() {
 			// Null destination node means its a server registration packet
 			if(tmpHeader->dest.addr.byIP.host == 0x0) {
 				UnpackIP(tmpHeader->src.addr.byIP, &tmpAddr);
-				for (uint16_t i = 0; i < SOCKETTABLESIZE; ++i) {
-					if(!connBuffer[i].connected) {
-						// Use prefered host IP rather than the reported source IP
-						// It may be better to use the reported source
-						ipconn[i] = inPacket.address;
-
-						connBuffer[i].connected = true;
-						host = ipconn[i].host;
-						LOG_MSG("IPXSERVER: Connect from %d.%d.%d.%d", CONVIP(host));
-						ackClient(inPacket.address);
-						return;
-					} else {
-						if((ipconn[i].host == tmpAddr.host) && (ipconn[i].port == tmpAddr.port)) {
-
-							LOG_MSG("IPXSERVER: Reconnect from %d.%d.%d.%d", CONVIP(tmpAddr.host));
-							// Update anonymous port number if changed
-							ipconn[i].port = inPacket.address.port;
-							ackClient(inPacket.address);
-							return;
-						}
-					}
-				}
+				registerClient(tmpAddr, inPacket.address);
+				continue;
 			}
 		}
 
@@ -190,12 +291,43 @@ static void IPX_ServerLoop() {
 	}
 }
 
+static void log_peer_counters()
+{
+	for (const auto& peer : peers) {
+		if (!peer.connected) {
+			continue;
+		}
+		const auto host = peer.address.host;
+		LOG_MSG("IPXSERVER: %d.%d.%d.%d sent %llu packets (%llu bytes) and "
+		        "received %llu packets (%llu bytes)",
+		        CONVIP(host),
+		        static_cast<unsigned long long>(peer.packets_from),
+		        static_cast<unsigned long long>(peer.bytes_from),
+		        static_cast<unsigned long long>(peer.packets_to),
+		        static_cast<unsigned long long>(peer.bytes_to));
+	}
+}
+
+static void reset_peers()
+{
+	peer_indexes.clear();
+	for (auto& peer : peers) {
+		peer.address      = {};
+		peer.connected    = false;
+		peer.packets_from = 0;
+		peer.bytes_from   = 0;
+		peer.packets_to   = 0;
+		peer.bytes_to     = 0;
+	}
+}
+
 void IPX_StopServer() {
 	ipx_server_running = false;
 
 	if (ipx_server_thread.joinable()) {
 		ipx_server_thread.join();
 	}
+	log_peer_counters();
 
 	SDLNet_FreeSocketSet(socket_set);
 	SDLNet_UDP_Close(ipxServerSocket);
@@ -209,9 +341,7 @@ bool IPX_StartServer(uint16_t portnum)
 		ipxServerSocket = SDLNet_UDP_Open(portnum);
 		if(!ipxServerSocket) return false;
 
-		for (auto& i : connBuffer) {
-			i.connected = false;
-		}
+		reset_peers();
 
 		if (!socket_set) {
 			socket_set = SDLNet_AllocSocketSet(1);
@@ -17,7 +17,7 @@ struct packetBuffer {
 	bool waitsize;
 };
 
-#define SOCKETTABLESIZE 16
+#define SOCKETTABLESIZE 64
 #define CONVIP(hostvar) hostvar & 0xff, (hostvar >> 8) & 0xff, (hostvar >> 16) & 0xff, (hostvar >> 24) & 0xff
 #define CONVIPX(hostvar) hostvar[0], hostvar[1], hostvar[2], hostvar[3], hostvar[4], hostvar[5]
 
@@ -26,6 +26,10 @@ void IPX_StopServer();
 bool IPX_StartServer(uint16_t portnum);
 bool IPX_isConnectedToServer(Bits tableNum, IPaddress ** ptrAddr);
 
+// The packets the server relayed from and to a connected client
+bool IPX_GetServerPeerCounters(Bits tableNum, uint64_t& packets_from,
+                               uint64_t& packets_to);
+
 uint8_t packetCRC(uint8_t *buffer, uint16_t bufSize);
 
 #endif
@@ -7,6 +7,7 @@
 
 #include "hardware/network/ne2000.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
 #include <cstring>
@@ -17,6 +18,7 @@
 #include "hardware/pic.h"
 #include "hardware/port.h"
 #include "hardware/timer.h"
+#include "misc/perf_counters.h"
 #include "misc/support.h"
 #include "network/ethernet.h"
 #include "utils/string_utils.h"
@@ -404,6 +406,56 @@ bx_ne2k_c::asic_read(io_port_t offset, io_width_t io_len)
   return (retval);
 }
 
+//
+// asic_read_block - The data register reads of a REP INSW, as many as
+// can be copied straight from the buffer memory with the same effect as
+// reading them one by one through asic_read. That's word-wide transfers
+// within the buffer memory; the MAC address ROM, byte-wide transfers and
+// the odd last byte of a transfer are left to asic_read.
+//
+static PerfCounter ne2000_rdma_block_bytes(
+        "ne2000_rdma_block_bytes",
+        "Bytes of remote-DMA reads copied straight into guest memory.");
+
+uint32_t bx_ne2k_c::asic_read_block(uint8_t* dst, uint32_t num_words)
+{
+  if (!s.DCR.wdsize || (s.remote_dma & 0x1))
+    return 0;
+
+  const uint32_t ring_end = s.page_stop << 8;
+
+  uint32_t words_read = 0;
+  while (words_read < num_words && s.remote_bytes >= 2) {
+    const uint32_t address = s.remote_dma;
+    if (address < BX_NE2K_MEMSTART || address >= BX_NE2K_MEMEND)
+      break;
+
+    // Up to the end of the ring (or of the memory) and of the transfer
+    uint32_t end = BX_NE2K_MEMEND;
+    if (address < ring_end)
+      end = std::min(end, ring_end);
+    const auto words = std::min({num_words - words_read,
+                                 (end - address) / 2,
+                                 uint32_t{s.remote_bytes} / 2});
+
+    memcpy(dst + words_read * 2, &s.mem[address - BX_NE2K_MEMSTART], words * 2);
+    words_read += words;
+
+    s.remote_dma = static_cast<uint16_t>(address + words * 2);
+    if (s.remote_dma == ring_end)
+      s.remote_dma = check_cast<uint16_t>(s.page_start << 8);
+    s.remote_bytes = static_cast<uint16_t>(s.remote_bytes - words * 2);
+  }
+
+  if (words_read > 0 && s.remote_bytes == 0) {
+    s.ISR.rdma_done = 1;
+    if (s.IMR.rdma_inte)
+      PIC_ActivateIRQ(s.base_irq);
+  }
+  ne2000_rdma_block_bytes.Add(words_read * 2);
+  return words_read;
+}
+
 void
 bx_ne2k_c::asic_write(io_port_t offset, io_val_t value, io_width_t io_len)
 {
@@ -1202,7 +1254,7 @@ bx_ne2k_c::rx_handler(void *arg, const void *buf, unsigned len)
  * rx ring has enough room, it is copied into it and
  * the receive process is updated
  */
-int bx_ne2k_c::rx_frame(const void *buf, unsigned io_len)
+int bx_ne2k_c::rx_frame(const void *buf, unsigned io_len, bool raise_irq)
 {
   int pages;
   int avail;
@@ -1257,6 +1309,7 @@ int bx_ne2k_c::rx_frame(const void *buf, unsigned io_len)
     return -1;
   }
   // some computers don't care...
+  const auto frame_len = io_len;
   if (io_len < 60) io_len=60;
 
   // Do address filtering if not in promiscuous mode
@@ -1280,7 +1333,7 @@ int bx_ne2k_c::rx_frame(const void *buf, unsigned io_len)
       BX_DEBUG(("rx_frame promiscuous receive"));
   }
 
-    BX_INFO("rx_frame %d to %x:%x:%x:%x:%x:%x from %x:%x:%x:%x:%x:%x",
+    BX_DEBUG("rx_frame %d to %x:%x:%x:%x:%x:%x from %x:%x:%x:%x:%x:%x",
   	   io_len,
   	   pktbuf[0], pktbuf[1], pktbuf[2], pktbuf[3], pktbuf[4], pktbuf[5],
   	   pktbuf[6], pktbuf[7], pktbuf[8], pktbuf[9], pktbuf[10], pktbuf[11]);
@@ -1307,7 +1360,9 @@ int bx_ne2k_c::rx_frame(const void *buf, unsigned io_len)
   if ((nextpage > BX_NE2K_THIS s.curr_page) ||
       ((BX_NE2K_THIS s.curr_page + pages) == BX_NE2K_THIS s.page_stop)) {
     memcpy(startptr, pkthdr, 4);
-    memcpy(startptr + 4, buf, io_len);
+    memcpy(startptr + 4, buf, frame_len);
+    // pad runts to the minimum frame size
+    memset(startptr + 4 + frame_len, 0, io_len - frame_len);
     BX_NE2K_THIS s.curr_page = nextpage;
   } else {
     unsigned int endbytes = (unsigned int)(BX_NE2K_THIS s.page_stop - BX_NE2K_THIS s.curr_page)
@@ -1316,8 +1371,9 @@ int bx_ne2k_c::rx_frame(const void *buf, unsigned io_len)
     memcpy(startptr + 4, buf, (size_t)(endbytes - 4u));
     startptr = & BX_NE2K_THIS s.mem[BX_NE2K_THIS s.page_start * 256u -
 				 BX_NE2K_MEMSTART];
+    // the rest of the frame, which ends within the buffer as it's not a runt
     memcpy(startptr, (const void *)(pktbuf + endbytes - 4u),
-	   io_len - endbytes + 8u);
+	   io_len - (endbytes - 4u));
     BX_NE2K_THIS s.curr_page = nextpage;
   }
 
@@ -1328,7 +1384,7 @@ int bx_ne2k_c::rx_frame(const void *buf, unsigned io_len)
 
   BX_NE2K_THIS s.ISR.pkt_rx = 1;
 
-  if (BX_NE2K_THIS s.IMR.rx_inte) {
+  if (raise_irq && BX_NE2K_THIS s.IMR.rx_inte) {
 	//LOG_MSG("packet rx interrupt");
 	  PIC_ActivateIRQ(s.base_irq);
     //DEV_pic_raise_irq(BX_NE2K_THIS s.base_irq);
@@ -1345,6 +1401,14 @@ io_val_t dosbox_read(io_port_t port, io_width_t width)
 	//	port, retval, len, theNE2kDevice->s.CR.pgsel,SegValue(cs),reg_eip);
 	return retval;
 }
+static uint32_t dosbox_read_block(io_port_t, io_width_t width, uint8_t* dst,
+                                  uint32_t num)
+{
+	if (width != io_width_t::word) {
+		return 0;
+	}
+	return theNE2kDevice->asic_read_block(dst, num);
+}
 void dosbox_write(io_port_t port, io_val_t value, io_width_t width)
 {
   const auto val = check_cast<uint16_t>(value);
@@ -1410,15 +1474,44 @@ static void NE2000_TX_Event([[maybe_unused]] uint32_t val)
 	theNE2kDevice->tx_timer();
 }
 
+static PerfCounter ne2000_rx_packets(
+        "ne2000_rx_packets", "Packets the NE2000 accepted into its receive ring.");
+
+static PerfCounter ne2000_rx_rejected(
+        "ne2000_rx_rejected",
+        "Packets the NE2000 turned away, because its receive ring was full, "
+        "it was stopped or in loopback mode, or they were for another address.");
+
+// Delivers everything received since the last tick, with one interrupt
+// for the lot
 static void NE2000_Poller(void) {
-	ethernet->GetPackets([](const uint8_t *packet, int len) {
+	bool received = false;
+
+	ethernet->GetPackets([&](const uint8_t *packet, int len) {
 		//LOG_MSG("NE2000: Received %d bytes", header->len);
 
 		// don't receive in loopback modes
-		if((theNE2kDevice->s.DCR.loop == 0) || (theNE2kDevice->s.TCR.loop_cntl != 0))
+		if((theNE2kDevice->s.DCR.loop == 0) || (theNE2kDevice->s.TCR.loop_cntl != 0)) {
+			ne2000_rx_rejected.Add();
 			return -1;
-		return theNE2kDevice->rx_frame(packet, check_cast<uint16_t>(len));
+		}
+
+		constexpr auto raise_irq = false;
+		const auto result = theNE2kDevice->rx_frame(packet,
+		                                            check_cast<uint16_t>(len),
+		                                            raise_irq);
+		if (result < 0) {
+			ne2000_rx_rejected.Add();
+		} else {
+			ne2000_rx_packets.Add();
+			received = true;
+		}
+		return result;
 	});
+
+	if (received && theNE2kDevice->s.IMR.rx_inte) {
+		PIC_ActivateIRQ(theNE2kDevice->s.base_irq);
+	}
 }
 
 class NE2K final : public ModuleBase {
@@ -1497,6 +1590,9 @@ public:
 			ReadHandler8[i].Install(port_num, dosbox_read, io_width_t::word);
 			WriteHandler8[i].Install(port_num, dosbox_write, io_width_t::word);
 		}
+		// The data port of the ASIC, for REP INSW remote-DMA reads
+		IO_RegisterBlockReader(static_cast<io_port_t>(base + 0x10),
+		                       dosbox_read_block);
 		TIMER_AddTickHandler(NE2000_Poller);
 	}
 
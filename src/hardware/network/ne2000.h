@@ -197,6 +197,8 @@ public:
 
 	BX_NE2K_SMF uint32_t chipmem_read(io_port_t address, io_width_t io_len);
 	BX_NE2K_SMF uint32_t asic_read(io_port_t offset, io_width_t io_len);
+	// Copies up to 'num_words' words of a remote-DMA read into 'dst' at once
+	BX_NE2K_SMF uint32_t asic_read_block(uint8_t* dst, uint32_t num_words);
 	BX_NE2K_SMF uint32_t page0_read(io_port_t offset, io_width_t io_len);
 	BX_NE2K_SMF uint32_t page1_read(io_port_t offset, io_width_t io_len);
 	BX_NE2K_SMF uint32_t page2_read(io_port_t offset, io_width_t io_len);
@@ -215,7 +217,9 @@ public:
 
   //static void rx_handler(void *arg, const void *buf, unsigned len);
   BX_NE2K_SMF unsigned mcast_index(const void *dst);
-  BX_NE2K_SMF int rx_frame(const void *buf, unsigned bytes);
+  // Leaves raising the receive interrupt to the caller when delivering
+  // several frames at once
+  BX_NE2K_SMF int rx_frame(const void *buf, unsigned bytes, bool raise_irq = true);
 
   static uint32_t read_handler(void *this_ptr, io_port_t address, io_width_t io_len);
   static void   write_handler(void *this_ptr, io_port_t address, io_val_t value, io_width_t io_len);
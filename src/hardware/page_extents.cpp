@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/page_extents.h"
+
+#include <cassert>
+
+void FreePageExtents::Reset(const uint32_t first_page, const uint32_t end_page)
+{
+	Clear();
+	if (end_page > first_page) {
+		Insert(first_page, end_page - first_page);
+	}
+}
+
+void FreePageExtents::Clear()
+{
+	by_start.clear();
+	by_length.clear();
+	total = 0;
+}
+
+uint32_t FreePageExtents::BestFit(const uint32_t num_pages) const
+{
+	const auto fit = by_length.lower_bound({num_pages, 0});
+	return fit == by_length.end() ? 0 : fit->second;
+}
+
+uint32_t FreePageExtents::RunAt(const uint32_t page) const
+{
+	const auto run = by_start.find(page);
+	return run == by_start.end() ? 0 : run->second;
+}
+
+void FreePageExtents::Allocate(const uint32_t start, const uint32_t num_pages)
+{
+	if (!num_pages) {
+		return;
+	}
+	// The run holding 'start' is the last one to begin at or before it
+	auto run = by_start.upper_bound(start);
+	assert(run != by_start.begin());
+	--run;
+
+	const auto run_start = run->first;
+	const auto run_end   = run->first + run->second;
+	assert(start >= run_start && start + num_pages <= run_end);
+
+	Erase(run);
+	if (start > run_start) {
+		Insert(run_start, start - run_start);
+	}
+	if (run_end > start + num_pages) {
+		Insert(start + num_pages, run_end - start - num_pages);
+	}
+}
+
+void FreePageExtents::Free(const uint32_t page, const uint32_t num_pages)
+{
+	if (!num_pages) {
+		return;
+	}
+	auto start  = page;
+	auto length = num_pages;
+
+	const auto next = by_start.find(page + num_pages);
+	if (next != by_start.end()) {
+		length += next->second;
+		Erase(next);
+	}
+	if (auto previous = by_start.lower_bound(page); previous != by_start.begin()) {
+		--previous;
+		assert(previous->first + previous->second <= page);
+		if (previous->first + previous->second == page) {
+			start = previous->first;
+			length += previous->second;
+			Erase(previous);
+		}
+	}
+	assert(by_start.lower_bound(page) == by_start.end() ||
+	       by_start.lower_bound(page)->first >= page + num_pages);
+	Insert(start, length);
+}
+
+uint32_t FreePageExtents::Largest() const
+{
+	return by_length.empty() ? 0 : by_length.rbegin()->first;
+}
+
+void FreePageExtents::Insert(const uint32_t start, const uint32_t num_pages)
+{
+	by_start.emplace(start, num_pages);
+	by_length.emplace(num_pages, start);
+	total += num_pages;
+}
+
+void FreePageExtents::Erase(const std::map<uint32_t, uint32_t>::iterator run)
+{
+	by_length.erase({run->second, run->first});
+	total -= run->second;
+	by_start.erase(run);
+}
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_PAGE_EXTENTS_H
+#define DOSBOX_PAGE_EXTENTS_H
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <utility>
+
+// Free page extents
+// ~~~~~~~~~~~~~~~~~
+// The runs of free pages in the XMS/EMS pool, indexed both by where they
+// start and by their length. The memory handle table stays the record of
+// which pages are in use; this only spares the allocator from scanning it,
+// so allocating, releasing, and asking for the free totals are O(log n) in
+// the number of runs rather than linear in the pages of RAM.
+
+class FreePageExtents {
+public:
+	// Every page in [first_page, end_page) becomes free
+	void Reset(uint32_t first_page, uint32_t end_page);
+
+	// Nothing is free
+	void Clear();
+
+	// The start of the smallest run of at least 'num_pages', the lowest
+	// of equally small ones, or 0 if none is long enough
+	uint32_t BestFit(uint32_t num_pages) const;
+
+	// The length of the free run that starts at 'page', or 0
+	uint32_t RunAt(uint32_t page) const;
+
+	// Takes 'num_pages' from 'start' on, which must all be free
+	void Allocate(uint32_t start, uint32_t num_pages);
+
+	// Returns the pages from 'page' on, which must all be in use, joining
+	// them with the runs on either side
+	void Free(uint32_t page, uint32_t num_pages = 1);
+
+	uint32_t Largest() const;
+	uint32_t Total() const
+	{
+		return total;
+	}
+
+private:
+	void Insert(uint32_t start, uint32_t num_pages);
+	void Erase(std::map<uint32_t, uint32_t>::iterator run);
+
+	// Run lengths by start page, and (length, start) pairs in best-fit order
+	std::map<uint32_t, uint32_t> by_start             = {};
+	std::set<std::pair<uint32_t, uint32_t>> by_length = {};
+	uint32_t total                                    = 0;
+};
+
+#endif // DOSBOX_PAGE_EXTENTS_H
@@ -3,12 +3,20 @@
 
 #include "pic.h"
 
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <vector>
+
 #include "config/setup.h"
 #include "cpu/callback.h"
 #include "cpu/cpu.h"
 #include "hardware/pic.h"
 #include "hardware/port.h"
 #include "hardware/timer.h"
+#include "misc/perf_counters.h"
+#include "misc/savestate.h"
+#include "misc/tracy.h"
 
 // PIC Controllers
 // ~~~~~~~~~~~~~~~
@@ -24,8 +32,6 @@
 // "master-slave" relationship, which is misleading given that fact that the
 // primary has no control over the secondary.
 
-#define PIC_QUEUESIZE 512
-
 struct PIC_Controller {
 	Bitu icw_words;
 	Bitu icw_index;
@@ -178,19 +184,160 @@ void PIC_Controller::start_irq(uint8_t val) {
 }
 
 
+// Event queue
+// ~~~~~~~~~~~
+// Scheduled events live in a pool of entries that grows as needed, and a
+// binary min-heap of pool slots orders them by when they're due. Events
+// due at the same index run in the order they were added, as they did
+// when the queue was a sorted list. Adding an event and taking the next
+// one are O(log n); cancelling an event through the id PIC_AddEvent
+// returned finds its heap position in O(1). Slots are reused, so each
+// carries a generation that goes into the id and moves on when the slot
+// is freed, which makes an id stale once its event has run or been
+// removed.
+
 struct PICEntry {
 	double index;
-	Bitu value;
+	uint64_t order;
 	PIC_EventHandler pic_event;
-	PICEntry * next;
+	uint32_t value;
+	uint32_t generation;
+	uint32_t heap_pos;
 };
 
 static struct {
-	PICEntry entries[PIC_QUEUESIZE];
-	PICEntry * free_entry;
-	PICEntry * next_entry;
+	std::vector<PICEntry> entries = {};
+	std::vector<uint32_t> free_slots = {};
+	std::vector<uint32_t> heap = {};
+	uint64_t next_order = 0;
 } pic_queue;
 
+static PerfGauge pic_events_pending("pic_events_pending",
+                                    "PIC events scheduled and not yet serviced.");
+
+static bool is_due_before(const uint32_t a, const uint32_t b)
+{
+	const auto& entry_a = pic_queue.entries[a];
+	const auto& entry_b = pic_queue.entries[b];
+	if (entry_a.index != entry_b.index) {
+		return entry_a.index < entry_b.index;
+	}
+	return entry_a.order < entry_b.order;
+}
+
+static void place_in_heap(const uint32_t pos, const uint32_t slot)
+{
+	pic_queue.heap[pos]               = slot;
+	pic_queue.entries[slot].heap_pos = pos;
+}
+
+static void sift_up(uint32_t pos)
+{
+	const auto slot = pic_queue.heap[pos];
+	while (pos > 0) {
+		const auto parent = (pos - 1) / 2;
+		if (!is_due_before(slot, pic_queue.heap[parent])) {
+			break;
+		}
+		place_in_heap(pos, pic_queue.heap[parent]);
+		pos = parent;
+	}
+	place_in_heap(pos, slot);
+}
+
+static void sift_down(uint32_t pos)
+{
+	const auto size = static_cast<uint32_t>(pic_queue.heap.size());
+	const auto slot = pic_queue.heap[pos];
+	while (true) {
+		auto child = pos * 2 + 1;
+		if (child >= size) {
+			break;
+		}
+		if (child + 1 < size &&
+		    is_due_before(pic_queue.heap[child + 1], pic_queue.heap[child])) {
+			++child;
+		}
+		if (!is_due_before(pic_queue.heap[child], slot)) {
+			break;
+		}
+		place_in_heap(pos, pic_queue.heap[child]);
+		pos = child;
+	}
+	place_in_heap(pos, slot);
+}
+
+static uint32_t allocate_entry()
+{
+	if (pic_queue.free_slots.empty()) {
+		pic_queue.entries.push_back({});
+		pic_queue.entries.back().generation = 1;
+		return static_cast<uint32_t>(pic_queue.entries.size() - 1);
+	}
+	const auto slot = pic_queue.free_slots.back();
+	pic_queue.free_slots.pop_back();
+	return slot;
+}
+
+static void free_entry(const uint32_t slot)
+{
+	++pic_queue.entries[slot].generation;
+	pic_queue.free_slots.push_back(slot);
+}
+
+// Takes the entry at a heap position out of the heap and frees its slot
+static void remove_at(const uint32_t pos)
+{
+	free_entry(pic_queue.heap[pos]);
+
+	const auto last = pic_queue.heap.back();
+	pic_queue.heap.pop_back();
+	if (pos == pic_queue.heap.size()) {
+		return;
+	}
+	place_in_heap(pos, last);
+	if (pos > 0 && is_due_before(last, pic_queue.heap[(pos - 1) / 2])) {
+		sift_up(pos);
+	} else {
+		sift_down(pos);
+	}
+}
+
+// Drops every entry the predicate matches, then rebuilds the heap from
+// the rest in linear time
+template <typename Matches>
+static void remove_matching(Matches matches)
+{
+	auto& heap = pic_queue.heap;
+	const auto kept = std::remove_if(heap.begin(), heap.end(), [&](const uint32_t slot) {
+		if (!matches(pic_queue.entries[slot])) {
+			return false;
+		}
+		free_entry(slot);
+		return true;
+	});
+	if (kept == heap.end()) {
+		return;
+	}
+	heap.erase(kept, heap.end());
+
+	const auto size = static_cast<uint32_t>(heap.size());
+	for (uint32_t pos = 0; pos < size; ++pos) {
+		place_in_heap(pos, heap[pos]);
+	}
+	for (auto pos = size / 2; pos-- > 0;) {
+		sift_down(pos);
+	}
+}
+
+static const PICEntry* next_entry()
+{
+	if (pic_queue.heap.empty()) {
+		return nullptr;
+	}
+	return &pic_queue.entries[pic_queue.heap.front()];
+}
+
 static void write_command(io_port_t port, io_val_t value, io_width_t)
 {
 	const auto val = check_cast<uint8_t>(value);
@@ -421,107 +568,95 @@ void PIC_SetIRQMask(uint32_t irq, bool masked)
 	pic->set_imr(newmask);
 }
 
-static void AddEntry(PICEntry * entry) {
-	PICEntry * find_entry=pic_queue.next_entry;
-	if (find_entry == nullptr) {
-		entry->next=nullptr;
-		pic_queue.next_entry=entry;
-	} else if (find_entry->index > entry->index) {
-		pic_queue.next_entry=entry;
-		entry->next=find_entry;
-	} else {
-		while (find_entry) {
-			if (find_entry->next) {
-				/* See if the next index comes later than this
-				 * one */
-				if (find_entry->next->index > entry->index) {
-					entry->next      = find_entry->next;
-					find_entry->next = entry;
-					break;
-				} else {
-					find_entry = find_entry->next;
-				}
-			} else {
-				entry->next      = find_entry->next;
-				find_entry->next = entry;
-				break;
-			}
-		}
-	}
-	Bits cycles=PIC_MakeCycles(pic_queue.next_entry->index-PIC_TickIndex());
+static PIC_EventId AddEntry(const double index, PIC_EventHandler handler,
+                           const uint32_t val)
+{
+	const auto slot = allocate_entry();
+	auto& entry     = pic_queue.entries[slot];
+	entry.index     = index;
+	entry.order     = pic_queue.next_order++;
+	entry.pic_event = handler;
+	entry.value     = val;
+
+	pic_queue.heap.push_back(slot);
+	sift_up(static_cast<uint32_t>(pic_queue.heap.size() - 1));
+
+	Bits cycles=PIC_MakeCycles(next_entry()->index-PIC_TickIndex());
 	if (cycles<CPU_Cycles) {
 		CPU_CycleLeft+=CPU_Cycles;
 		CPU_Cycles=0;
 	}
+	return (static_cast<PIC_EventId>(entry.generation) << 32) | slot;
 }
 static bool InEventService = false;
+
+// The entry of the event the queue is running: it stays queued while its
+// handler runs, so that PIC_RepeatEvent() can move it rather than free it
+// and queue a new one
+static struct {
+	uint32_t slot              = 0;
+	uint32_t generation        = 0;
+	PIC_EventHandler pic_event = nullptr;
+	uint32_t value             = 0;
+	bool is_repeated           = false;
+	double repeat_index        = 0.0;
+} serviced_event = {};
+
+static bool is_serviced_entry_queued()
+{
+	return pic_queue.entries[serviced_event.slot].generation ==
+	       serviced_event.generation;
+}
+
+static PerfCounter pic_events("pic_events", "PIC events serviced.");
+static PerfCounter repeated_events("pic_repeated_events",
+                                   "PIC events rescheduled in place by their "
+                                   "handlers.");
+static PerfCounter cpu_cycles("cpu_cycles",
+                              "Cycles granted to the CPU, about one per instruction.");
 static double srv_lag = 0.0;
 
-void PIC_AddEvent(PIC_EventHandler handler, double delay, uint32_t val)
+PIC_EventId PIC_AddEvent(PIC_EventHandler handler, double delay, uint32_t val)
+{
+	const auto index = InEventService ? delay + srv_lag : delay + PIC_TickIndex();
+	return AddEntry(index, handler, val);
+}
+
+void PIC_RepeatEvent(const double delay)
 {
-	if (!pic_queue.free_entry) {
-		LOG(LOG_PIC,LOG_ERROR)("Event queue full");
+	assert(InEventService);
+	const auto index = srv_lag + delay;
+	if (!is_serviced_entry_queued()) {
+		// The handler removed its own event before repeating it
+		AddEntry(index, serviced_event.pic_event, serviced_event.value);
 		return;
 	}
-	PICEntry * entry=pic_queue.free_entry;
-	if(InEventService) entry->index = delay + srv_lag;
-	else entry->index = delay + PIC_TickIndex();
+	serviced_event.is_repeated  = true;
+	serviced_event.repeat_index = index;
+}
 
-	entry->pic_event=handler;
-	entry->value=val;
-	pic_queue.free_entry=pic_queue.free_entry->next;
-	AddEntry(entry);
+void PIC_CancelEvent(const PIC_EventId id)
+{
+	const auto slot       = static_cast<uint32_t>(id);
+	const auto generation = static_cast<uint32_t>(id >> 32);
+	if (slot >= pic_queue.entries.size() ||
+	    pic_queue.entries[slot].generation != generation) {
+		return;
+	}
+	remove_at(pic_queue.entries[slot].heap_pos);
 }
 
 void PIC_RemoveSpecificEvents(PIC_EventHandler handler, uint32_t val)
 {
-	PICEntry *entry = pic_queue.next_entry;
-	PICEntry *prev_entry;
-	prev_entry = nullptr;
-	while (entry) {
-		if ((entry->pic_event == handler) && (entry->value == val)) {
-			if (prev_entry) {
-				prev_entry->next=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=prev_entry->next;
-				continue;
-			} else {
-				pic_queue.next_entry=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=pic_queue.next_entry;
-				continue;
-			}
-		}
-		prev_entry=entry;
-		entry=entry->next;
-	}
+	remove_matching([&](const PICEntry& entry) {
+		return entry.pic_event == handler && entry.value == val;
+	});
 }
 
 void PIC_RemoveEvents(PIC_EventHandler handler) {
-	PICEntry * entry=pic_queue.next_entry;
-	PICEntry * prev_entry;
-	prev_entry=nullptr;
-	while (entry) {
-		if (entry->pic_event == handler) {
-			if (prev_entry) {
-				prev_entry->next=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=prev_entry->next;
-				continue;
-			} else {
-				pic_queue.next_entry=entry->next;
-				entry->next=pic_queue.free_entry;
-				pic_queue.free_entry=entry;
-				entry=pic_queue.next_entry;
-				continue;
-			}
-		}
-		prev_entry=entry;
-		entry=entry->next;
-	}
+	remove_matching([&](const PICEntry& entry) {
+		return entry.pic_event == handler;
+	});
 }
 
 
@@ -534,29 +669,44 @@ bool PIC_RunQueue(void) {
 	if (CPU_CycleLeft<=0) {
 		return false;
 	}
+	ZoneScoped;
 
 	const auto index_nd_f = static_cast<double>(PIC_TickIndexND());
 
 	/* Check the queue for an entry */
 	InEventService = true;
-	while (pic_queue.next_entry &&
-	       (pic_queue.next_entry->index * static_cast<double>(CPU_CycleMax) <= index_nd_f)) {
-		PICEntry *entry = pic_queue.next_entry;
-		pic_queue.next_entry = entry->next;
-
-		srv_lag = entry->index;
-		(entry->pic_event)(entry->value); // call the event handler
-
-		/* Put the entry in the free list */
-		entry->next=pic_queue.free_entry;
-		pic_queue.free_entry=entry;
+	while (next_entry() &&
+	       (next_entry()->index * static_cast<double>(CPU_CycleMax) <= index_nd_f)) {
+		// The entry stays queued until the handler is done, which
+		// may remove or cancel it, or repeat it in place
+		const auto slot  = pic_queue.heap.front();
+		const auto entry = pic_queue.entries[slot];
+		serviced_event   = {slot, entry.generation, entry.pic_event, entry.value};
+
+		srv_lag = entry.index;
+		(entry.pic_event)(entry.value); // call the event handler
+		pic_events.Add();
+
+		if (!is_serviced_entry_queued()) {
+			continue;
+		}
+		auto& queued = pic_queue.entries[slot];
+		if (serviced_event.is_repeated) {
+			// Moving it later only ever takes it down the heap
+			queued.index = serviced_event.repeat_index;
+			queued.order = pic_queue.next_order++;
+			sift_down(queued.heap_pos);
+			repeated_events.Add();
+		} else {
+			remove_at(queued.heap_pos);
+		}
 	}
 	InEventService = false;
 
 	/* Check when to set the new cycle end */
-	if (pic_queue.next_entry) {
+	if (const auto entry = next_entry(); entry) {
 		auto cycles = static_cast<int32_t>(
-		        pic_queue.next_entry->index * static_cast<double>(CPU_CycleMax) -
+		        entry->index * static_cast<double>(CPU_CycleMax) -
 		        index_nd_f);
 		if (!cycles) {
 			cycles = 1;
@@ -605,14 +755,15 @@ void TIMER_AddTickHandler(TIMER_TickHandler handler) {
 void TIMER_AddTick(void) {
 	/* Setup new amount of cycles for PIC */
 	CPU_CycleLeft=CPU_CycleMax;
+	cpu_cycles.Add(static_cast<uint64_t>(CPU_CycleMax));
 	CPU_Cycles=0;
 	PIC_Ticks++;
 	/* Go through the list of scheduled events and lower their index with 1000 */
-	PICEntry * entry=pic_queue.next_entry;
-	while (entry) {
-		entry->index -= 1.0f;
-		entry=entry->next;
+	// Every index moves by the same amount, so the heap stays in order
+	for (const auto slot : pic_queue.heap) {
+		pic_queue.entries[slot].index -= 1.0;
 	}
+	pic_events_pending.Set(static_cast<int64_t>(pic_queue.heap.size()));
 	/* Call our list of ticker handlers */
 	TickerBlock * ticker=firstticker;
 	while (ticker) {
@@ -622,6 +773,95 @@ void TIMER_AddTick(void) {
 	}
 }
 
+// The event queue is stored as its pending events in heap order. Their
+// handlers point into this executable, which stays put for the whole run,
+// and restoring them in the same order rebuilds the same heap.
+struct SavedEvent {
+	double index;
+	uint64_t order;
+	PIC_EventHandler pic_event;
+	uint32_t value;
+};
+
+void PIC_SaveState(SaveStateWriter& out)
+{
+	out.Write(pics);
+	out.Write(PIC_Ticks);
+	out.Write(PIC_IRQCheck);
+
+	// An event being serviced is saved as it will be once it's done:
+	// gone, or moved if its handler has repeated it so far
+	auto next_order = pic_queue.next_order;
+	std::vector<SavedEvent> events = {};
+	for (const auto slot : pic_queue.heap) {
+		const auto& entry = pic_queue.entries[slot];
+		const auto is_serviced = InEventService && slot == serviced_event.slot &&
+		                         is_serviced_entry_queued();
+		if (!is_serviced) {
+			events.push_back(
+			        {entry.index, entry.order, entry.pic_event, entry.value});
+		} else if (serviced_event.is_repeated) {
+			events.push_back({serviced_event.repeat_index,
+			                  next_order++,
+			                  entry.pic_event,
+			                  entry.value});
+		}
+	}
+	out.Write(next_order);
+	out.Write(static_cast<uint32_t>(events.size()));
+	for (const auto& event : events) {
+		out.Write(event);
+	}
+}
+
+bool PIC_LoadState(SaveStateReader& in, const bool apply)
+{
+	if (InEventService) {
+		return in.Fail("cannot restore from inside an event");
+	}
+	PIC_Controller controllers[2] = {};
+	uint32_t ticks      = 0;
+	uint32_t irq_check  = 0;
+	uint64_t next_order = 0;
+	uint32_t num_events = 0;
+	if (!in.Read(controllers) || !in.Read(ticks) || !in.Read(irq_check) ||
+	    !in.Read(next_order) || !in.Read(num_events)) {
+		return false;
+	}
+	std::vector<SavedEvent> events = {};
+	for (uint32_t i = 0; i < num_events; ++i) {
+		SavedEvent event = {};
+		if (!in.Read(event)) {
+			return false;
+		}
+		events.push_back(event);
+	}
+	if (!apply) {
+		return true;
+	}
+
+	// Freeing the current entries also makes any ids handed out for
+	// them stale
+	remove_matching([](const PICEntry&) { return true; });
+	for (const auto& event : events) {
+		const auto slot = allocate_entry();
+		auto& entry     = pic_queue.entries[slot];
+		entry.index     = event.index;
+		entry.order     = event.order;
+		entry.pic_event = event.pic_event;
+		entry.value     = event.value;
+		pic_queue.heap.push_back(slot);
+		sift_up(static_cast<uint32_t>(pic_queue.heap.size() - 1));
+	}
+	pic_queue.next_order = next_order;
+
+	std::copy(std::begin(controllers), std::end(controllers), std::begin(pics));
+	PIC_Ticks    = ticks;
+	PIC_IRQCheck = irq_check;
+	PIC_UpdateAtomicIndex();
+	return true;
+}
+
 /* Use full name to avoid name clash with compile option for position-independent code */
 class PIC_8259A final : public ModuleBase {
 private:
@@ -675,12 +915,7 @@ public:
 		WriteHandler[2].Install(0xa0, write_command, io_width_t::byte);
 		WriteHandler[3].Install(0xa1, write_data, io_width_t::byte);
 		/* Initialize the pic queue */
-		for (i=0;i<PIC_QUEUESIZE-1;i++) {
-			pic_queue.entries[i].next=&pic_queue.entries[i+1];
-		}
-		pic_queue.entries[PIC_QUEUESIZE-1].next=nullptr;
-		pic_queue.free_entry=&pic_queue.entries[0];
-		pic_queue.next_entry=nullptr;
+		pic_queue = {};
 	}
 
 	~PIC_8259A(){
@@ -69,8 +69,19 @@ void PIC_DeActivateIRQ(uint8_t irq);
 void PIC_runIRQs();
 bool PIC_RunQueue();
 
+// Identifies one scheduled event for PIC_CancelEvent; it goes stale once
+// the event has run or been removed
+using PIC_EventId = uint64_t;
+
 //Delay in milliseconds
-void PIC_AddEvent(PIC_EventHandler handler, double delay, uint32_t val = 0);
+PIC_EventId PIC_AddEvent(PIC_EventHandler handler, double delay, uint32_t val = 0);
+void PIC_CancelEvent(PIC_EventId id);
+
+// For an event handler: schedules the event being serviced again 'delay'
+// milliseconds after it was due, like PIC_AddEvent() with its handler and
+// value would, but moves its queue entry rather than adding one, and its
+// id stays valid. Periodic timers call it on every tick.
+void PIC_RepeatEvent(double delay);
 void PIC_RemoveEvents(PIC_EventHandler handler);
 void PIC_RemoveSpecificEvents(PIC_EventHandler handler, uint32_t val);
 
@@ -8,6 +8,8 @@
 #include "dosbox.h"
 
 #include <functional>
+#include <limits>
+#include <vector>
 
 using io_port_t = uint16_t; // DOS only supports 16-bit port addresses
 using io_val_t  = uint32_t; // Handling exists up to a dword (or less)
@@ -55,6 +57,51 @@ void IO_FreeWriteHandler(io_port_t port,
                          io_width_t max_width,
                          io_port_t range = 1);
 
+// Polling hints let the CPU cores skip ahead in emulated time through
+// loops that do nothing but spin on a status port. A port's hint returns
+// the PIC full index up to which the bits of its value under 'mask' keep
+// reading as they do now, unless the guest does some other I/O first, or
+// IO_StableUntilEvent if they only change in a PIC event (or in the host
+// input handlers, which run between time slices). Only ports whose read
+// handler has no side effects after the first of several reads can have a
+// hint. Freeing a port's read handler drops its hint.
+using io_poll_hint_f = std::function<double(io_port_t port, uint8_t mask)>;
+
+constexpr double IO_StableUntilEvent = std::numeric_limits<double>::infinity();
+
+void IO_RegisterPollHint(io_port_t port, io_poll_hint_f hint);
+
+// The port's hint for the bits under 'mask', or 0 if it has none
+double IO_GetPollHint(io_port_t port, uint8_t mask);
+
+// Block reads let REP INS fill guest memory straight from a device's
+// buffer. A port's block reader copies up to 'num' elements of 'width'
+// bytes into 'dst', laid out as in guest memory, exactly as that many
+// reads of the port would have returned them, and returns how many it
+// copied. It can copy fewer, or none, leaving the rest to the port's read
+// handler. Freeing a port's read handler drops its block reader.
+using io_read_block_f = std::function<uint32_t(io_port_t port, io_width_t width,
+                                               uint8_t* dst, uint32_t num)>;
+
+void IO_RegisterBlockReader(io_port_t port, io_read_block_f reader);
+
+bool IO_HasBlockReader(io_port_t port);
+
+// Reads up to 'num' elements through the port's block reader, taking the
+// same I/O delay as reading them one by one. Returns how many it read,
+// which is none if the port has no block reader or the read must go
+// through the regular path, such as in virtual 8086 mode.
+uint32_t IO_ReadBlock(io_port_t port, io_width_t width, uint8_t* dst, uint32_t num);
+
+struct IO_PortAccesses {
+	io_port_t port = 0;
+	uint64_t reads  = 0;
+	uint64_t writes = 0;
+};
+
+// The ports the guest accessed most since startup, busiest first
+std::vector<IO_PortAccesses> IO_GetBusiestPorts(size_t max_ports);
+
 /* Classes to manage the IO objects created by the various devices.
  * The io objects will remove itself on destruction.*/
 class IO_Base{
@@ -9,7 +9,13 @@
 
 #include "misc_util.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
+
+#if defined(NATIVESOCKETS) && !defined(WIN32)
+#include <netinet/tcp.h>
+#endif
 
 #include "hardware/timer.h"
 
@@ -49,6 +55,11 @@ NETClientSocket* NETClientSocket::NETClientFactory(const SocketType socketType,
 	return nullptr;
 }
 
+bool NETClientSocket::SetNoDelay(const bool /*enabled*/)
+{
+	return false;
+}
+
 void NETClientSocket::FlushBuffer()
 {
 	if (sendbufferindex) {
@@ -643,6 +654,14 @@ bool TCPClientSocket::ReceiveArray(uint8_t *data, size_t &n)
 	assertm(n <= static_cast<size_t>(std::numeric_limits<int>::max()),
 	        "SDL_net can't handle more bytes at a time.");
 	assert(data);
+
+	// Whatever byte-wise reads left over comes first
+	if (BufferedBytes() > 0) {
+		n = std::min(n, BufferedBytes());
+		std::memcpy(data, receive_buffer.data() + receive_index, n);
+		receive_index += n;
+		return true;
+	}
 	if (SDLNet_CheckSockets(listensocketset, 0)) {
 		const int result = SDLNet_TCP_Recv(mysock, data, static_cast<int>(n));
 		if(result < 1) {
@@ -659,19 +678,37 @@ bool TCPClientSocket::ReceiveArray(uint8_t *data, size_t &n)
 	}
 }
 
+SocketState TCPClientSocket::FillReceiveBuffer()
+{
+	receive_buffer.resize(ReceiveBufferSize);
+	receive_index = 0;
+
+	if (!SDLNet_CheckSockets(listensocketset, 0)) {
+		receive_buffer.clear();
+		return SocketState::Empty;
+	}
+	const int result = SDLNet_TCP_Recv(mysock,
+	                                   receive_buffer.data(),
+	                                   static_cast<int>(receive_buffer.size()));
+	if (result < 1) {
+		receive_buffer.clear();
+		isopen = false;
+		return SocketState::Closed;
+	}
+	receive_buffer.resize(static_cast<size_t>(result));
+	return SocketState::Good;
+}
+
 SocketState TCPClientSocket::GetcharNonBlock(uint8_t &val)
 {
-	SocketState state = SocketState::Empty;
-	if(SDLNet_CheckSockets(listensocketset,0))
-	{
-		if (SDLNet_TCP_Recv(mysock, &val, 1) == 1)
-			state = SocketState::Good;
-		else {
-			isopen = false;
-			state = SocketState::Closed;
+	if (BufferedBytes() == 0) {
+		const auto state = FillReceiveBuffer();
+		if (state != SocketState::Good) {
+			return state;
 		}
 	}
-	return state;
+	val = receive_buffer[receive_index++];
+	return SocketState::Good;
 }
 
 bool TCPClientSocket::Putchar(uint8_t val)
@@ -692,6 +729,28 @@ bool TCPClientSocket::SendArray(const uint8_t *data, const size_t n)
 	return true;
 }
 
+bool TCPClientSocket::SetNoDelay(const bool enabled)
+{
+#ifdef NATIVESOCKETS
+	// SDL_net doesn't expose the socket, but its TCP sockets are laid out
+	// like ours
+	if (!mysock) {
+		return false;
+	}
+	const auto channel = reinterpret_cast<_TCPsocketX*>(mysock)->channel;
+
+	const int value = enabled ? 1 : 0;
+	return setsockopt(channel,
+	                  IPPROTO_TCP,
+	                  TCP_NODELAY,
+	                  reinterpret_cast<const char*>(&value),
+	                  sizeof(value)) == 0;
+#else
+	(void)enabled;
+	return false;
+#endif
+}
+
 TCPServerSocket::TCPServerSocket(const uint16_t port)
 {
 	isopen = false;
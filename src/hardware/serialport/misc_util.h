@@ -90,6 +90,10 @@ public:
 	virtual bool ReceiveArray(uint8_t *data, size_t &n) = 0;
 	virtual bool GetRemoteAddressString(char *buffer) = 0;
 
+	// Sends small writes at once rather than waiting to coalesce them
+	// with later ones, on protocols that support it
+	virtual bool SetNoDelay(const bool enabled);
+
 	void FlushBuffer();
 	void SetSendBufferSize(size_t n);
 	bool SendByteBuffered(uint8_t val);
@@ -194,8 +198,18 @@ public:
 	bool SendArray(const uint8_t *data, size_t n) override;
 	bool ReceiveArray(uint8_t *data, size_t &n) override;
 	bool GetRemoteAddressString(char *buffer) override;
+	bool SetNoDelay(const bool enabled) override;
 
 private:
+	// Receives whatever the socket has waiting, up to the receive
+	// buffer's size, so reading it byte by byte costs one call per burst
+	// instead of two per byte
+	SocketState FillReceiveBuffer();
+
+	size_t BufferedBytes() const
+	{
+		return receive_buffer.size() - receive_index;
+	}
 
 #ifdef NATIVESOCKETS
 	_TCPsocketX *nativetcpstruct = nullptr;
@@ -203,6 +217,11 @@ private:
 
 	TCPsocket mysock = nullptr;
 	SDLNet_SocketSet listensocketset = nullptr;
+
+	static constexpr size_t ReceiveBufferSize = 4096;
+
+	std::vector<uint8_t> receive_buffer = {};
+	size_t receive_index = 0;
 };
 
 class TCPServerSocket : public NETServerSocket {
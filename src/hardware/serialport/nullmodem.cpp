@@ -65,6 +65,12 @@ CNullModem::CNullModem(const uint8_t port_idx, CommandLine *cmd)
 			tx_gather=12;
 		}
 	}
+	// nodelay: Send each burst of data as soon as the application stops
+	// writing, instead of after txdelay, and disable Nagle's algorithm on
+	// TCP connections (on by default).
+	if (getUintFromString("nodelay:", bool_temp, cmd)) {
+		nodelay = (bool_temp == 1);
+	}
 	// port is for both server and client
 	if (getUintFromString("port:", temptcpport, cmd)) {
 		if (!(temptcpport>0&&temptcpport<65536)) {
@@ -160,6 +166,15 @@ void CNullModem::WriteChar(uint8_t data)
 	}
 }
 
+void CNullModem::FlushTransmitBuffer()
+{
+	if (clientsocket) {
+		clientsocket->FlushBuffer();
+	}
+	removeEvent(SERIAL_TX_REDUCTION);
+	tx_block = false;
+}
+
 SocketState CNullModem::readChar(uint8_t &val)
 {
 	SocketState state = clientsocket->GetcharNonBlock(val);
@@ -197,6 +212,7 @@ bool CNullModem::ClientConnect(NETClientSocket *newsocket)
 		return false;
 	}
 	clientsocket->SetSendBufferSize(256);
+	clientsocket->SetNoDelay(nodelay);
 	clientsocket->GetRemoteAddressString(peernamebuf);
 	// transmit the line status
 	if (!transparent) setRTSDTR(getRTS(), getDTR());
@@ -235,6 +251,7 @@ bool CNullModem::ServerConnect() {
 	        GetPortNumber(), peeripbuf);
 #endif
 	clientsocket->SetSendBufferSize(256);
+	clientsocket->SetNoDelay(nodelay);
 	rx_state=N_RX_IDLE;
 	setEvent(SERIAL_POLLING_EVENT, 1);
 	
@@ -389,6 +406,11 @@ void CNullModem::handleUpperEvent(uint16_t type)
 				}
 			}
 			ByteTransmitted();
+			// Nothing more to send means the burst is over, so send
+			// it now rather than when the gathering time runs out
+			if (nodelay && (LSR & LSR_TX_EMPTY_MASK)) {
+				FlushTransmitBuffer();
+			}
 			break;
 		}
 		case SERIAL_THR_EVENT: {
@@ -597,8 +619,11 @@ void CNullModem::setRTSDTR(bool xrts, bool xdtr) {
 			ctrl_lines[1] |= 2;
 		if (LCR & LCR_BREAK_MASK)
 			ctrl_lines[1] |= 4;
-		if (clientsocket)
+		if (clientsocket) {
+			// The line states follow the data sent before them
+			FlushTransmitBuffer();
 			clientsocket->SendArray(ctrl_lines, 2);
+		}
 	}
 }
 void CNullModem::setRTS(bool val) {
@@ -61,6 +61,7 @@ private:
     void Disconnect();
     SocketState readChar(uint8_t &val);
     void WriteChar(uint8_t data);
+    void FlushTransmitBuffer();
 
 	bool DTR_delta = false; // with dtrrespect, we try to establish a
 	                        // connection whenever DTR switches to 1. This
@@ -85,6 +86,9 @@ private:
 
 	bool telnet = false; // Do Telnet parsing.
 
+	bool nodelay = true; // send each burst as soon as it ends, rather
+	                     // than after tx_gather, and without Nagle
+
     // Telnet's brain
 #define TEL_CLIENT 0
 #define TEL_SERVER 1
@@ -263,15 +263,60 @@ void CSerial::handleEvent(uint16_t type)
 		breakErrors = 0;
 		break;
 
-	case SERIAL_RX_TIMEOUT_EVENT:
+	case SERIAL_RX_TIMEOUT_EVENT: {
+		rx_timeout.is_scheduled = false;
+		if (!rx_timeout.is_running) {
+			break;
+		}
+		// Restarted since the event was scheduled, so wait the rest
+		const auto remaining = rx_timeout.deadline - PIC_FullIndex();
+		if (remaining > 0.0) {
+			rx_timeout.is_scheduled = true;
+			setEvent(SERIAL_RX_TIMEOUT_EVENT, static_cast<float>(remaining));
+			break;
+		}
+		rx_timeout.is_running = false;
 		rise(TIMEOUT_PRIORITY);
 		break;
+	}
 
 	default:
 		handleUpperEvent(type);
 	}
 }
 
+// The character timeout restarts with every byte received and read, so
+// rather than moving its event each time, the pending event checks the
+// latest deadline when it fires and waits again if it moved
+void CSerial::RestartRxTimeout()
+{
+	rx_timeout.deadline   = PIC_FullIndex() + bytetime * 4.0;
+	rx_timeout.is_running = true;
+	if (!rx_timeout.is_scheduled) {
+		rx_timeout.is_scheduled = true;
+		setEvent(SERIAL_RX_TIMEOUT_EVENT, bytetime * 4.0f);
+	}
+}
+
+void CSerial::StopRxTimeout()
+{
+	rx_timeout.is_running = false;
+}
+
+// The modem status lines can't meaningfully change faster than a
+// character takes to transfer, and reading the real lines of a direct
+// serial port is a system call, so polled reads of MSR and ISR refresh
+// them at most once per character time
+void CSerial::updateMSRThrottled()
+{
+	const auto now = PIC_FullIndex();
+	if (now >= last_msr_update && now - last_msr_update < bytetime) {
+		return;
+	}
+	last_msr_update = now;
+	updateMSR();
+}
+
 /*****************************************************************************/
 /* Interrupt control routines                                               **/
 /*****************************************************************************/
@@ -287,7 +332,10 @@ void CSerial::rise(uint8_t priority)
 	if(priority&TIMEOUT_PRIORITY && !(waiting_interrupts&TIMEOUT_PRIORITY))
 		log_ser(dbg_interrupt,"fifo rx timeout interrupt on.");
 #endif
-	
+	// Nothing to recompute if the interrupts were already waiting
+	if ((waiting_interrupts & priority) == priority) {
+		return;
+	}
 	waiting_interrupts |= priority;
 	ComputeInterrupts();
 }
@@ -305,6 +353,11 @@ void CSerial::clear(uint8_t priority)
 	if(priority&ERROR_PRIORITY && (waiting_interrupts&ERROR_PRIORITY))
 		log_ser(dbg_interrupt,"error interrupt off.");
 #endif
+	// Polled drivers clear interrupts that never came with every LSR and
+	// MSR read, so skip recomputing when nothing changes
+	if ((waiting_interrupts & priority) == 0) {
+		return;
+	}
 	waiting_interrupts &= (~priority);
 	ComputeInterrupts();
 }
@@ -360,9 +413,12 @@ void CSerial::receiveByteEx(uint8_t data, uint8_t error)
 		// Overrun error ;o
 		error |= LSR_OVERRUN_ERROR_MASK;
 	}
-	removeEvent(SERIAL_RX_TIMEOUT_EVENT);
-	if(rxfifo->getUsage()==rx_interrupt_threshold) rise (RX_PRIORITY);
-	else setEvent(SERIAL_RX_TIMEOUT_EVENT,bytetime*4.0f);
+	if (rxfifo->getUsage() == rx_interrupt_threshold) {
+		StopRxTimeout();
+		rise(RX_PRIORITY);
+	} else {
+		RestartRxTimeout();
+	}
 
 	if(error) {
 		// A lot of UART chips generate a framing error too when receiving break
@@ -552,8 +608,11 @@ uint32_t CSerial::Read_RHR()
 		clear (TIMEOUT_PRIORITY);
 		// RX int. is cleared if the buffer holds less data than the threshold
 		if(rxfifo->getUsage()<rx_interrupt_threshold)clear(RX_PRIORITY);
-		removeEvent(SERIAL_RX_TIMEOUT_EVENT);
-		if(!rxfifo->isEmpty()) setEvent(SERIAL_RX_TIMEOUT_EVENT,bytetime*4.0f);
+		if (rxfifo->isEmpty()) {
+			StopRxTimeout();
+		} else {
+			RestartRxTimeout();
+		}
 		return data;
 	}
 }
@@ -609,7 +668,7 @@ uint32_t CSerial::Read_ISR()
 	//		000 MSR
 	// 4-7	0
 
-	if(IER&Modem_Status_INT_Enable_MASK) updateMSR();
+	if(IER&Modem_Status_INT_Enable_MASK) updateMSRThrottled();
 	uint8_t retval = ISR;
 
 	// clear changes ISR!! mean..
@@ -854,7 +913,7 @@ uint32_t CSerial::Read_MSR()
 		if (op2) retval |= MSR_CD_MASK;
 
 	} else {
-		updateMSR();
+		updateMSRThrottled();
 		if (cd) retval |= MSR_CD_MASK;
 		if (ri) retval |= MSR_RI_MASK;
 		if (dsr) retval |= MSR_DSR_MASK;
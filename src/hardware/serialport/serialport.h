@@ -301,6 +301,21 @@ private:
 	// clears the pending sub-interrupt
 	void clear(uint8_t priority);
 
+	// (re)starts or stops the FIFO's character timeout
+	void RestartRxTimeout();
+	void StopRxTimeout();
+
+	// calls updateMSR unless it was called within the last character time
+	void updateMSRThrottled();
+
+	struct {
+		double deadline   = 0.0; // [ms, PIC time]
+		bool is_running   = false;
+		bool is_scheduled = false; // its event is in the PIC queue
+	} rx_timeout = {};
+
+	double last_msr_update = -1.0; // [ms, PIC time]
+
 #define ERROR_PRIORITY   4    // overrun, parity error, frame error, break
 #define RX_PRIORITY      1    // a byte has been received
 #define TX_PRIORITY      2    // tx buffer has become empty
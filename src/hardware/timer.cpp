@@ -13,6 +13,7 @@
 #include "hardware/memory.h"
 #include "hardware/pic.h"
 #include "hardware/port.h"
+#include "misc/savestate.h"
 #include "utils/math_utils.h"
 
 const std::chrono::steady_clock::time_point system_start_time =
@@ -180,7 +181,7 @@ static void PIT0_Event(uint32_t /*val*/)
 			update_channel_delay(channel_0);
 			channel_0.update_count = false;
 		}
-		PIC_AddEvent(PIT0_Event, channel_0.delay);
+		PIC_RepeatEvent(channel_0.delay);
 	}
 }
 
@@ -695,6 +696,36 @@ bool TIMER_GetOutput2()
 	return counter_output(channel_2);
 }
 
+// Counter start times are in PIC time, which the PIC section restores
+void TIMER_SaveState(SaveStateWriter& out)
+{
+	out.Write(pit);
+	out.Write(gate2);
+	out.Write(latched_timerstatus);
+	out.Write(latched_timerstatus_locked);
+}
+
+bool TIMER_LoadState(SaveStateReader& in, const bool apply)
+{
+	std::array<PIT_Block, 3> channels = {};
+	bool gate          = false;
+	uint8_t status     = 0;
+	bool status_locked = false;
+	if (!in.Read(channels) || !in.Read(gate) || !in.Read(status) ||
+	    !in.Read(status_locked)) {
+		return false;
+	}
+	if (!apply) {
+		return true;
+	}
+
+	pit                        = channels;
+	gate2                      = gate;
+	latched_timerstatus        = status;
+	latched_timerstatus_locked = status_locked;
+	return true;
+}
+
 class TIMER final : public ModuleBase {
 private:
 	IO_ReadHandleObject ReadHandler[4];
@@ -747,6 +747,10 @@ void plm_frame_to_bgra(plm_frame_t *frame, uint8_t *dest, int stride);
 void plm_frame_to_argb(plm_frame_t *frame, uint8_t *dest, int stride);
 void plm_frame_to_abgr(plm_frame_t *frame, uint8_t *dest, int stride);
 
+// Convert the YCbCr data of a frame into BGRX with the X byte cleared, the
+// pixel layout of the ReelMagic video mixer. The fastest of the conversions.
+void plm_frame_to_bgrx(plm_frame_t *frame, uint8_t *dest, int stride);
+
 
 // -----------------------------------------------------------------------------
 // plm_audio public API
@@ -824,6 +828,8 @@ plm_samples_t *plm_audio_decode(plm_audio_t *self);
 #include <string.h>
 #include <stdlib.h>
 
+#include "mpeg_kernels.h"
+
 #ifndef TRUE
 #define TRUE 1
 #define FALSE 0
@@ -3389,24 +3395,7 @@ void plm_video_process_macroblock(
 		return; // corrupt video
 	}
 
-	#define PLM_MB_CASE(INTERPOLATE, ODD_H, ODD_V, OP) \
-		case ((INTERPOLATE << 2) | (ODD_H << 1) | (ODD_V)): \
-			PLM_BLOCK_SET(d, di, dw, si, dw, block_size, OP); \
-			break
-
-	switch ((interpolate << 2) | (odd_h << 1) | (odd_v)) {
-		PLM_MB_CASE(0, 0, 0, (s[si]));
-		PLM_MB_CASE(0, 0, 1, (s[si] + s[si + dw] + 1) >> 1);
-		PLM_MB_CASE(0, 1, 0, (s[si] + s[si + 1] + 1) >> 1);
-		PLM_MB_CASE(0, 1, 1, (s[si] + s[si + 1] + s[si + dw] + s[si + dw + 1] + 2) >> 2);
-
-		PLM_MB_CASE(1, 0, 0, (d[di] + (s[si]) + 1) >> 1);
-		PLM_MB_CASE(1, 0, 1, (d[di] + ((s[si] + s[si + dw] + 1) >> 1) + 1) >> 1);
-		PLM_MB_CASE(1, 1, 0, (d[di] + ((s[si] + s[si + 1] + 1) >> 1) + 1) >> 1);
-		PLM_MB_CASE(1, 1, 1, (d[di] + ((s[si] + s[si + 1] + s[si + dw] + s[si + dw + 1] + 2) >> 2) + 1) >> 1);
-	}
-
-	#undef PLM_MB_CASE
+	predict_block(d + di, s + si, dw, block_size, odd_h, odd_v, interpolate);
 }
 
 void plm_video_decode_block(plm_video_t *self, int block) {
@@ -3544,7 +3533,7 @@ void plm_video_decode_block(plm_video_t *self, int block) {
 		}
 		else {
 			plm_video_idct(s);
-			PLM_BLOCK_SET(d, di, dw, si, 8, 8, plm_clamp(s[si]));
+			put_block(d + di, dw, s);
 			memset(self->block_data, 0, sizeof(self->block_data));
 		}
 	}
@@ -3557,7 +3546,7 @@ void plm_video_decode_block(plm_video_t *self, int block) {
 		}
 		else {
 			plm_video_idct(s);
-			PLM_BLOCK_SET(d, di, dw, si, 8, 8, plm_clamp(d[di] + s[si]));
+			add_block(d + di, dw, s);
 			memset(self->block_data, 0, sizeof(self->block_data));
 		}
 	}
@@ -3673,6 +3662,15 @@ PLM_DEFINE_FRAME_CONVERT_FUNCTION(plm_frame_to_bgra, 4, 2, 1, 0)
 PLM_DEFINE_FRAME_CONVERT_FUNCTION(plm_frame_to_argb, 4, 1, 2, 3)
 PLM_DEFINE_FRAME_CONVERT_FUNCTION(plm_frame_to_abgr, 4, 3, 2, 1)
 
+void plm_frame_to_bgrx(plm_frame_t *frame, uint8_t *dest, int stride) {
+	const YCbCrPicture picture = {
+		frame->y.data, frame->cb.data, frame->cr.data,
+		(int)frame->y.width, (int)frame->cb.width,
+		(int)frame->width, (int)frame->height
+	};
+	ycbcr_to_bgrx(picture, dest, stride);
+}
+
 
 #undef PLM_PUT_PIXEL
 #undef PLM_DEFINE_FRAME_CONVERT_FUNCTION
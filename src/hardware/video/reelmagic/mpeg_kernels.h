@@ -0,0 +1,471 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_REELMAGIC_MPEG_KERNELS_H
+#define DOSBOX_REELMAGIC_MPEG_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "simde/x86/sse2.h"
+
+// MPEG picture kernels
+// ~~~~~~~~~~~~~~~~~~~~
+// The per-pixel work of playing a ReelMagic video, which is nearly all of
+// the decoder's time:
+//
+//   - Storing each inverse transformed 8x8 block, or adding it to the
+//     predicted one, with the clamping to bytes done by saturating packs.
+//     The transform itself stays scalar: without SSE4.1's 32-bit multiply
+//     and with the transposes a four-lane version measured slower.
+//
+//   - Motion compensation, copying or averaging a 16x16 luma or 8x8 chroma
+//     block from the reference picture a row at a time. Averaging two
+//     samples rounding up is exactly SSE2's byte average; the four-sample
+//     average for half-pel motion in both directions is done on 16 bits.
+//
+//   - YCbCr to BGRX conversion, sixteen pixels of two rows per chroma step.
+//     The decoder's 16.16 fixed-point factors are split into an integer
+//     part and a 16-bit remainder, so 16-bit multiplies give the very same
+//     results.
+//
+//   - The video mixer's overlay of the VGA picture, black being transparent,
+//     four BGRX pixels at a time.
+//
+// Every kernel produces bit-identical output to the decoder's original
+// scalar code. simde maps the SSE2 intrinsics to NEON on ARM hosts. The
+// scalar versions are the references they're tested against, and also
+// handle the pixels at the end of odd-sized rows.
+
+static inline simde__m128i load_unaligned(const void* const src)
+{
+	return simde_mm_loadu_si128(static_cast<const simde__m128i*>(src));
+}
+
+static inline void store_unaligned(void* const dest, const simde__m128i value)
+{
+	simde_mm_storeu_si128(static_cast<simde__m128i*>(dest), value);
+}
+
+static inline simde__m128i load_low_half(const void* const src)
+{
+	return simde_mm_loadl_epi64(static_cast<const simde__m128i*>(src));
+}
+
+static inline void store_low_half(void* const dest, const simde__m128i value)
+{
+	simde_mm_storel_epi64(static_cast<simde__m128i*>(dest), value);
+}
+
+static inline uint8_t clamp_to_byte(const int value)
+{
+	return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Inverse DCT output
+// ------------------
+// Stores the 64 coefficients of an inverse transformed 8x8 block as the
+// pixels of rows 'width' apart, either clamped to bytes or added to the
+// predicted pixels already there and then clamped.
+
+static inline void put_block_scalar(uint8_t* const dest, const int width,
+                                    const int* const block)
+{
+	for (int y = 0; y < 8; ++y) {
+		for (int x = 0; x < 8; ++x) {
+			dest[y * width + x] = clamp_to_byte(block[y * 8 + x]);
+		}
+	}
+}
+
+static inline void add_block_scalar(uint8_t* const dest, const int width,
+                                    const int* const block)
+{
+	for (int y = 0; y < 8; ++y) {
+		const auto d = dest + y * width;
+		for (int x = 0; x < 8; ++x) {
+			d[x] = clamp_to_byte(d[x] + block[y * 8 + x]);
+		}
+	}
+}
+
+// A row of coefficients saturated to 16 bits, which clamps to the same
+// bytes as the full values
+static inline simde__m128i load_coefficients(const int* const block_row)
+{
+	return simde_mm_packs_epi32(load_unaligned(block_row),
+	                            load_unaligned(block_row + 4));
+}
+
+static inline void put_block(uint8_t* const dest, const int width,
+                             const int* const block)
+{
+	for (int y = 0; y < 8; ++y) {
+		const auto row = load_coefficients(block + y * 8);
+		store_low_half(dest + y * width, simde_mm_packus_epi16(row, row));
+	}
+}
+
+static inline void add_block(uint8_t* const dest, const int width,
+                             const int* const block)
+{
+	const auto zero = simde_mm_setzero_si128();
+	for (int y = 0; y < 8; ++y) {
+		const auto d = dest + y * width;
+
+		const auto predicted = simde_mm_unpacklo_epi8(load_low_half(d), zero);
+		const auto residual  = load_coefficients(block + y * 8);
+		const auto sum       = simde_mm_adds_epi16(predicted, residual);
+		store_low_half(d, simde_mm_packus_epi16(sum, sum));
+	}
+}
+
+// Motion compensation
+// -------------------
+// Predicts the block at 'dest' from the one at 'src', both rows 'width'
+// apart, at half-pel offsets 'odd_h' and 'odd_v'. When interpolating (for
+// bidirectional prediction), the prediction is averaged with what 'dest'
+// already holds.
+
+static inline void predict_block_scalar(uint8_t* const dest, const uint8_t* const src,
+                                        const int width, const int block_size,
+                                        const bool odd_h, const bool odd_v,
+                                        const bool interpolate)
+{
+	for (int y = 0; y < block_size; ++y) {
+		const auto s = src + y * width;
+		const auto d = dest + y * width;
+		for (int x = 0; x < block_size; ++x) {
+			int value = s[x];
+			if (odd_h && odd_v) {
+				value = (s[x] + s[x + 1] + s[x + width] +
+				         s[x + width + 1] + 2) >>
+				        2;
+			} else if (odd_h) {
+				value = (s[x] + s[x + 1] + 1) >> 1;
+			} else if (odd_v) {
+				value = (s[x] + s[x + width] + 1) >> 1;
+			}
+			if (interpolate) {
+				value = (d[x] + value + 1) >> 1;
+			}
+			d[x] = static_cast<uint8_t>(value);
+		}
+	}
+}
+
+template <int BlockSize>
+static inline simde__m128i load_block_row(const uint8_t* const src)
+{
+	static_assert(BlockSize == 8 || BlockSize == 16);
+	if constexpr (BlockSize == 16) {
+		return load_unaligned(src);
+	} else {
+		return load_low_half(src);
+	}
+}
+
+template <int BlockSize>
+static inline void store_block_row(uint8_t* const dest, const simde__m128i row)
+{
+	static_assert(BlockSize == 8 || BlockSize == 16);
+	if constexpr (BlockSize == 16) {
+		store_unaligned(dest, row);
+	} else {
+		store_low_half(dest, row);
+	}
+}
+
+// (a + b + c + d + 2) >> 2 of each byte, on 16 bits
+static inline simde__m128i average_of_four(const simde__m128i a, const simde__m128i b,
+                                           const simde__m128i c, const simde__m128i d)
+{
+	const auto zero = simde_mm_setzero_si128();
+	const auto two  = simde_mm_set1_epi16(2);
+
+	const auto sum = [&](const auto unpack) {
+		auto total = simde_mm_add_epi16(unpack(a, zero), unpack(b, zero));
+		total      = simde_mm_add_epi16(total, unpack(c, zero));
+		total      = simde_mm_add_epi16(total, unpack(d, zero));
+		return simde_mm_srli_epi16(simde_mm_add_epi16(total, two), 2);
+	};
+	const auto lo = sum([](const auto x, const auto y) {
+		return simde_mm_unpacklo_epi8(x, y);
+	});
+	const auto hi = sum([](const auto x, const auto y) {
+		return simde_mm_unpackhi_epi8(x, y);
+	});
+	return simde_mm_packus_epi16(lo, hi);
+}
+
+template <int BlockSize>
+static inline void predict_block(uint8_t* const dest, const uint8_t* const src,
+                                 const int width, const bool odd_h, const bool odd_v,
+                                 const bool interpolate)
+{
+	for (int y = 0; y < BlockSize; ++y) {
+		const auto s = src + y * width;
+		const auto d = dest + y * width;
+
+		auto row = load_block_row<BlockSize>(s);
+		if (odd_h && odd_v) {
+			row = average_of_four(row,
+			                      load_block_row<BlockSize>(s + 1),
+			                      load_block_row<BlockSize>(s + width),
+			                      load_block_row<BlockSize>(s + width + 1));
+		} else if (odd_h) {
+			const auto right = load_block_row<BlockSize>(s + 1);
+			row              = simde_mm_avg_epu8(row, right);
+		} else if (odd_v) {
+			const auto below = load_block_row<BlockSize>(s + width);
+			row              = simde_mm_avg_epu8(row, below);
+		}
+		if (interpolate) {
+			row = simde_mm_avg_epu8(load_block_row<BlockSize>(d), row);
+		}
+		store_block_row<BlockSize>(d, row);
+	}
+}
+
+static inline void predict_block(uint8_t* const dest, const uint8_t* const src,
+                                 const int width, const int block_size,
+                                 const bool odd_h, const bool odd_v,
+                                 const bool interpolate)
+{
+	if (block_size == 16) {
+		predict_block<16>(dest, src, width, odd_h, odd_v, interpolate);
+	} else if (block_size == 8) {
+		predict_block<8>(dest, src, width, odd_h, odd_v, interpolate);
+	} else {
+		predict_block_scalar(
+		        dest, src, width, block_size, odd_h, odd_v, interpolate);
+	}
+}
+
+// YCbCr to BGRX conversion
+// ------------------------
+// Converts a 'width' x 'height' picture with 2x2 subsampled chroma; the
+// planes' rows are 'luma_width' and 'chroma_width' samples apart and the
+// destination's 'stride' bytes apart. The X bytes are cleared.
+
+struct YCbCrPicture {
+	const uint8_t* y  = nullptr;
+	const uint8_t* cb = nullptr;
+	const uint8_t* cr = nullptr;
+
+	int luma_width   = 0;
+	int chroma_width = 0;
+
+	int width  = 0;
+	int height = 0;
+};
+
+// Converts the two rows at chroma row 'row', columns 'first_col' onwards
+static inline void ycbcr_to_bgrx_scalar(const YCbCrPicture& picture, uint8_t* const dest,
+                                        const int stride, const int row,
+                                        const int first_col)
+{
+	const auto put_pixel = [](uint8_t* const pixel, const int luma, const int r,
+	                          const int g, const int b) {
+		const auto y = ((luma - 16) * 76309) >> 16;
+		pixel[0]     = clamp_to_byte(y + b);
+		pixel[1]     = clamp_to_byte(y - g);
+		pixel[2]     = clamp_to_byte(y + r);
+		pixel[3]     = 0;
+	};
+
+	const auto cols = picture.width >> 1;
+	for (int col = first_col; col < cols; ++col) {
+		const auto c_index = row * picture.chroma_width + col;
+		const auto y_index = row * 2 * picture.luma_width + col * 2;
+
+		const int cr = picture.cr[c_index] - 128;
+		const int cb = picture.cb[c_index] - 128;
+		const int r  = (cr * 104597) >> 16;
+		const int g  = (cb * 25674 + cr * 53278) >> 16;
+		const int b  = (cb * 132201) >> 16;
+
+		const auto y     = picture.y + y_index;
+		const auto yw    = picture.luma_width;
+		const auto pixel = dest + row * 2 * stride + col * 2 * 4;
+		put_pixel(pixel, y[0], r, g, b);
+		put_pixel(pixel + 4, y[1], r, g, b);
+		put_pixel(pixel + stride, y[yw], r, g, b);
+		put_pixel(pixel + stride + 4, y[yw + 1], r, g, b);
+	}
+}
+
+static inline void ycbcr_to_bgrx_scalar(const YCbCrPicture& picture,
+                                        uint8_t* const dest, const int stride)
+{
+	for (int row = 0; row < (picture.height >> 1); ++row) {
+		ycbcr_to_bgrx_scalar(picture, dest, stride, row, 0);
+	}
+}
+
+// Sixteen pixels of one row, from their luma and the chroma terms of their
+// eight pairs
+static inline void store_bgrx_row(uint8_t* const dest, const uint8_t* const luma,
+                                  const simde__m128i r, const simde__m128i g,
+                                  const simde__m128i b)
+{
+	const auto zero    = simde_mm_setzero_si128();
+	const auto y_bytes = load_unaligned(luma);
+	const auto sixteen = simde_mm_set1_epi16(16);
+	const auto factor  = simde_mm_set1_epi16(10773);
+
+	// ((luma - 16) * 76309) >> 16, with 76309 = 65536 + 10773
+	const auto scale_luma = [&](const simde__m128i y16) {
+		const auto y = simde_mm_sub_epi16(y16, sixteen);
+		return simde_mm_add_epi16(y, simde_mm_mulhi_epi16(y, factor));
+	};
+	const auto y_lo = scale_luma(simde_mm_unpacklo_epi8(y_bytes, zero));
+	const auto y_hi = scale_luma(simde_mm_unpackhi_epi8(y_bytes, zero));
+
+	// Each chroma term covers two neighboring pixels
+	const auto channel = [&](const simde__m128i term, const bool subtract) {
+		const auto lo = simde_mm_unpacklo_epi16(term, term);
+		const auto hi = simde_mm_unpackhi_epi16(term, term);
+		if (subtract) {
+			return simde_mm_packus_epi16(simde_mm_sub_epi16(y_lo, lo),
+			                             simde_mm_sub_epi16(y_hi, hi));
+		}
+		return simde_mm_packus_epi16(simde_mm_add_epi16(y_lo, lo),
+		                             simde_mm_add_epi16(y_hi, hi));
+	};
+	const auto blue  = channel(b, false);
+	const auto green = channel(g, true);
+	const auto red   = channel(r, false);
+
+	const auto bg_lo = simde_mm_unpacklo_epi8(blue, green);
+	const auto bg_hi = simde_mm_unpackhi_epi8(blue, green);
+	const auto rx_lo = simde_mm_unpacklo_epi8(red, zero);
+	const auto rx_hi = simde_mm_unpackhi_epi8(red, zero);
+
+	store_unaligned(dest, simde_mm_unpacklo_epi16(bg_lo, rx_lo));
+	store_unaligned(dest + 16, simde_mm_unpackhi_epi16(bg_lo, rx_lo));
+	store_unaligned(dest + 32, simde_mm_unpacklo_epi16(bg_hi, rx_hi));
+	store_unaligned(dest + 48, simde_mm_unpackhi_epi16(bg_hi, rx_hi));
+}
+
+static inline void ycbcr_to_bgrx(const YCbCrPicture& picture, uint8_t* const dest,
+                                 const int stride)
+{
+	constexpr int ColsPerStep = 8;
+
+	const auto zero     = simde_mm_setzero_si128();
+	const auto offset   = simde_mm_set1_epi16(128);
+	const auto r_factor = simde_mm_set1_epi16(-26475);
+	const auto b_factor = simde_mm_set1_epi16(1129);
+	const auto g_factors = simde_mm_set_epi16(-12258, 25674, -12258, 25674,
+	                                          -12258, 25674, -12258, 25674);
+
+	const auto cols = picture.width >> 1;
+	for (int row = 0; row < (picture.height >> 1); ++row) {
+		int col = 0;
+		for (; col + ColsPerStep <= cols; col += ColsPerStep) {
+			const auto c_index = row * picture.chroma_width + col;
+
+			const auto load_chroma = [&](const uint8_t* const plane) {
+				const auto bytes = load_low_half(plane + c_index);
+				const auto words = simde_mm_unpacklo_epi8(bytes, zero);
+				return simde_mm_sub_epi16(words, offset);
+			};
+			const auto cr = load_chroma(picture.cr);
+			const auto cb = load_chroma(picture.cb);
+
+			// (cr * 104597) >> 16, with 104597 = 2 * 65536 - 26475
+			const auto r_frac = simde_mm_mulhi_epi16(cr, r_factor);
+			const auto r_int  = simde_mm_add_epi16(cr, cr);
+			const auto r      = simde_mm_add_epi16(r_int, r_frac);
+
+			// (cb * 132201) >> 16, with 132201 = 2 * 65536 + 1129
+			const auto b_frac = simde_mm_mulhi_epi16(cb, b_factor);
+			const auto b_int  = simde_mm_add_epi16(cb, cb);
+			const auto b      = simde_mm_add_epi16(b_int, b_frac);
+
+			// (cb * 25674 + cr * 53278) >> 16, with 53278 = 65536 -
+			// 12258; the two products are summed before the shift
+			const auto g_term = [&](const simde__m128i pairs) {
+				const auto sums = simde_mm_madd_epi16(pairs, g_factors);
+				return simde_mm_srai_epi32(sums, 16);
+			};
+			const auto g_lo = g_term(simde_mm_unpacklo_epi16(cb, cr));
+			const auto g_hi = g_term(simde_mm_unpackhi_epi16(cb, cr));
+			const auto g_frac = simde_mm_packs_epi32(g_lo, g_hi);
+			const auto g      = simde_mm_add_epi16(cr, g_frac);
+
+			const auto yw    = picture.luma_width;
+			const auto luma  = picture.y + row * 2 * yw + col * 2;
+			const auto pixel = dest + row * 2 * stride + col * 2 * 4;
+			store_bgrx_row(pixel, luma, r, g, b);
+			store_bgrx_row(pixel + stride, luma + yw, r, g, b);
+		}
+		ycbcr_to_bgrx_scalar(picture, dest, stride, row, col);
+	}
+}
+
+// Video overlay
+// -------------
+// Mixes 'num_pixels' BGRX pixels of the VGA picture over the MPEG picture,
+// where black VGA pixels are transparent. The X bytes are cleared.
+
+static inline void overlay_bgrx_scalar(uint8_t* const out, const uint8_t* const vga,
+                                       const uint8_t* const mpeg,
+                                       const size_t num_pixels)
+{
+	for (size_t i = 0; i < num_pixels * 4; i += 4) {
+		const auto is_transparent = (vga[i] | vga[i + 1] | vga[i + 2]) == 0;
+		const auto src            = is_transparent ? mpeg : vga;
+		out[i]                    = src[i];
+		out[i + 1]                = src[i + 1];
+		out[i + 2]                = src[i + 2];
+		out[i + 3]                = 0;
+	}
+}
+
+static inline void overlay_bgrx(uint8_t* const out, const uint8_t* const vga,
+                                const uint8_t* const mpeg, const size_t num_pixels)
+{
+	const auto mask = simde_mm_set1_epi32(0x00ffffff);
+	const auto zero = simde_mm_setzero_si128();
+
+	size_t i = 0;
+	for (; i + 4 <= num_pixels; i += 4) {
+		const auto v = simde_mm_and_si128(load_unaligned(vga + i * 4), mask);
+		const auto m = simde_mm_and_si128(load_unaligned(mpeg + i * 4), mask);
+
+		const auto is_clear = simde_mm_cmpeq_epi32(v, zero);
+		store_unaligned(out + i * 4,
+		                simde_mm_or_si128(simde_mm_and_si128(is_clear, m),
+		                                  simde_mm_andnot_si128(is_clear, v)));
+	}
+	overlay_bgrx_scalar(out + i * 4, vga + i * 4, mpeg + i * 4, num_pixels - i);
+}
+
+// Copies 'num_pixels' BGRX pixels, clearing the X bytes
+static inline void copy_bgrx_scalar(uint8_t* const out, const uint8_t* const src,
+                                    const size_t num_pixels)
+{
+	for (size_t i = 0; i < num_pixels * 4; i += 4) {
+		out[i]     = src[i];
+		out[i + 1] = src[i + 1];
+		out[i + 2] = src[i + 2];
+		out[i + 3] = 0;
+	}
+}
+
+static inline void copy_bgrx(uint8_t* const out, const uint8_t* const src,
+                             const size_t num_pixels)
+{
+	const auto color_mask = simde_mm_set1_epi32(0x00ffffff);
+
+	size_t i = 0;
+	for (; i + 4 <= num_pixels; i += 4) {
+		const auto pixels = load_unaligned(src + i * 4);
+		store_unaligned(out + i * 4, simde_mm_and_si128(pixels, color_mask));
+	}
+	copy_bgrx_scalar(out + i * 4, src + i * 4, num_pixels - i);
+}
+
+#endif // DOSBOX_REELMAGIC_MPEG_KERNELS_H
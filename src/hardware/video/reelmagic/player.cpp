@@ -468,9 +468,9 @@ public:
 
 		if (_drawNextFrame) {
 			if (_nextFrame) {
-				plm_frame_to_rgb(_nextFrame,
-				                 (uint8_t*)outputBuffer,
-				                 _attrs.PictureSize.Width * 3);
+				plm_frame_to_bgrx(_nextFrame,
+				                  (uint8_t*)outputBuffer,
+				                  _attrs.PictureSize.Width * 4);
 			}
 			_drawNextFrame = false;
 		}
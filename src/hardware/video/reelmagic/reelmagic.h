@@ -17,6 +17,7 @@ struct ReelMagic_PlayerConfiguration;
 struct ReelMagic_PlayerAttributes;
 struct ReelMagic_VideoMixerMPEGProvider {
 	virtual ~ReelMagic_VideoMixerMPEGProvider() {}
+	// The output buffer takes the picture as BGRX pixels
 	virtual void OnVerticalRefresh(void* const outputBuffer, const float fps) = 0;
 	virtual const ReelMagic_PlayerConfiguration& GetConfig() const = 0;
 	virtual const ReelMagic_PlayerAttributes& GetAttrs() const     = 0;
@@ -14,9 +14,11 @@
 #include <cstring>
 #include <exception>
 #include <string>
+#include <type_traits>
 
 #include "config/setup.h"
 #include "gui/render_scalers.h" //SCALER_MAXWIDTH SCALER_MAXHEIGHT
+#include "hardware/video/reelmagic/mpeg_kernels.h"
 #include "misc/video.h"
 #include "utils/checks.h"
 #include "utils/rgb565.h"
@@ -142,10 +144,12 @@ struct VGAOverPalettePixel : VGAPalettePixel {
 	}
 };
 
+// BGRX like the output, so whole lines can be mixed by the MPEG kernels
 struct PlayerPicturePixel {
-	uint8_t red;
-	uint8_t green;
 	uint8_t blue;
+	uint8_t green;
+	uint8_t red;
+	uint8_t alpha;
 	template <typename T>
 	inline void CopyRGBTo(T& out) const
 	{
@@ -158,6 +162,8 @@ struct PlayerPicturePixel {
 		return false;
 	}
 };
+static_assert(sizeof(PlayerPicturePixel) == sizeof(RenderOutputPixel));
+static_assert(sizeof(VGA32bppPixel) == sizeof(RenderOutputPixel));
 } // namespace
 
 //
@@ -243,6 +249,7 @@ static void ClearMpegPictureBuffer()
 	p.red   = 0;
 	p.green = 0;
 	p.blue  = 0;
+	p.alpha = 0;
 	ClearMpegPictureBuffer(p);
 }
 
@@ -352,8 +359,14 @@ static inline void RMR_DrawLine_VGAOnly(const T* src)
 
 	RenderOutputPixel* const out = _finalMixedRenderLineBuffer;
 
-	for (Bitu i = 0; i < lineWidth; ++i) {
-		MixPixel(out[i], src[i]);
+	if constexpr (std::is_base_of_v<VGA32bppPixel, T>) {
+		copy_bgrx(reinterpret_cast<uint8_t*>(out),
+		          reinterpret_cast<const uint8_t*>(src),
+		          lineWidth);
+	} else {
+		for (Bitu i = 0; i < lineWidth; ++i) {
+			MixPixel(out[i], src[i]);
+		}
 	}
 
 	RENDER_DrawLine(_finalMixedRenderLineBuffer);
@@ -367,8 +380,19 @@ static inline void RMR_DrawLine_VGAMPEGSameSize(const T* src)
 
 	RenderOutputPixel* const out = _finalMixedRenderLineBuffer;
 
-	for (Bitu i = 0; i < lineWidth; ++i) {
-		MixPixel(out[i], src[i], _mpegPictureBufferPtr[i]);
+	const auto out_bytes  = reinterpret_cast<uint8_t*>(out);
+	const auto vga_bytes  = reinterpret_cast<const uint8_t*>(src);
+	const auto mpeg_bytes = reinterpret_cast<const uint8_t*>(_mpegPictureBufferPtr);
+
+	// Same-sized 32bpp pictures are mixed a line at a time
+	if constexpr (std::is_same_v<T, VGAOver32bppPixel>) {
+		overlay_bgrx(out_bytes, vga_bytes, mpeg_bytes, lineWidth);
+	} else if constexpr (std::is_same_v<T, VGAUnder32bppPixel>) {
+		copy_bgrx(out_bytes, mpeg_bytes, lineWidth);
+	} else {
+		for (Bitu i = 0; i < lineWidth; ++i) {
+			MixPixel(out[i], src[i], _mpegPictureBufferPtr[i]);
+		}
 	}
 
 	_mpegPictureBufferPtr += _mpegPictureWidth;
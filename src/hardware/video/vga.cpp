@@ -7,11 +7,13 @@
 #include <cstring>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gui/common.h"
 #include "hardware/pic.h"
 #include "ints/int10.h"
 #include "misc/logging.h"
+#include "misc/savestate.h"
 #include "misc/video.h"
 #include "utils/math_utils.h"
 #include "utils/string_utils.h"
@@ -23,12 +25,7 @@ uint32_t CGA_2_Table[16];
 uint32_t CGA_4_Table[256];
 uint32_t CGA_4_HiRes_Table[256];
 int CGA_Composite_Table[1024];
-uint32_t TXT_Font_Table[16];
-uint32_t TXT_FG_Table[16];
-uint32_t TXT_BG_Table[16];
-uint32_t ExpandTable[256];
-uint32_t Expand16Table[4][16];
-uint32_t FillTable[16];
+std::array<uint32_t, 16> TXT_BG_Table = TXT_FG_Table;
 
 void VGA_LogInitialization(const char *adapter_name,
                            const char *ram_type,
@@ -332,54 +329,6 @@ void VGA_Init(Section* sec)
 /* Generate tables */
 	VGA_SetCGA2Table(0,1);
 	VGA_SetCGA4Table(0,1,2,3);
-	Bitu i,j;
-	for (i=0;i<256;i++) {
-		ExpandTable[i]=i | (i << 8)| (i <<16) | (i << 24);
-	}
-	for (i=0;i<16;i++) {
-		TXT_FG_Table[i]=i | (i << 8)| (i <<16) | (i << 24);
-		TXT_BG_Table[i]=i | (i << 8)| (i <<16) | (i << 24);
-#ifdef WORDS_BIGENDIAN
-		FillTable[i]=
-			((i & 1) ? 0xff000000 : 0) |
-			((i & 2) ? 0x00ff0000 : 0) |
-			((i & 4) ? 0x0000ff00 : 0) |
-			((i & 8) ? 0x000000ff : 0) ;
-		TXT_Font_Table[i]=
-			((i & 1) ? 0x000000ff : 0) |
-			((i & 2) ? 0x0000ff00 : 0) |
-			((i & 4) ? 0x00ff0000 : 0) |
-			((i & 8) ? 0xff000000 : 0) ;
-#else 
-		FillTable[i]=
-			((i & 1) ? 0x000000ff : 0) |
-			((i & 2) ? 0x0000ff00 : 0) |
-			((i & 4) ? 0x00ff0000 : 0) |
-			((i & 8) ? 0xff000000 : 0) ;
-		TXT_Font_Table[i]=	
-			((i & 1) ? 0xff000000 : 0) |
-			((i & 2) ? 0x00ff0000 : 0) |
-			((i & 4) ? 0x0000ff00 : 0) |
-			((i & 8) ? 0x000000ff : 0) ;
-#endif
-	}
-	for (j=0;j<4;j++) {
-		for (i=0;i<16;i++) {
-#ifdef WORDS_BIGENDIAN
-			Expand16Table[j][i] =
-				((i & 1) ? 1 << j : 0) |
-				((i & 2) ? 1 << (8 + j) : 0) |
-				((i & 4) ? 1 << (16 + j) : 0) |
-				((i & 8) ? 1 << (24 + j) : 0);
-#else
-			Expand16Table[j][i] =
-				((i & 1) ? 1 << (24 + j) : 0) |
-				((i & 2) ? 1 << (16 + j) : 0) |
-				((i & 4) ? 1 << (8 + j) : 0) |
-				((i & 8) ? 1 << j : 0);
-#endif
-		}
-	}
 }
 
 void SVGA_Setup_Driver(void) {
@@ -421,3 +370,75 @@ const VideoMode& VGA_GetCurrentVideoMode()
 	return vga.draw.image_info.video_mode;
 }
 
+
+// The register blocks and the drawing state are stored whole; the drawing
+// state points into the video memory buffers, which are only reallocated
+// when the machine is reconfigured. Several blocks hold bit_view unions,
+// which have no copy assignment, so all of them are copied as bytes.
+static std::vector<std::pair<void*, size_t>> state_blocks()
+{
+	return {{&vga.mode, sizeof(vga.mode)},
+	        {&vga.misc_output, sizeof(vga.misc_output)},
+	        {&vga.draw, sizeof(vga.draw)},
+	        {&vga.config, sizeof(vga.config)},
+	        {&vga.seq, sizeof(vga.seq)},
+	        {&vga.attr, sizeof(vga.attr)},
+	        {&vga.crtc, sizeof(vga.crtc)},
+	        {&vga.gfx, sizeof(vga.gfx)},
+	        {&vga.dac, sizeof(vga.dac)},
+	        {&vga.latch, sizeof(vga.latch)},
+	        {&vga.s3, sizeof(vga.s3)},
+	        {&vga.svga, sizeof(vga.svga)},
+	        {&vga.herc, sizeof(vga.herc)},
+	        {&vga.tandy, sizeof(vga.tandy)},
+	        {&vga.other, sizeof(vga.other)},
+	        {&vga.vmemwrap, sizeof(vga.vmemwrap)},
+	        {&CurMode, sizeof(CurMode)},
+	        {vga.mem.linear, vga.vmemsize},
+	        {vga.fastmem, vga.vmemsize * 2}};
+}
+
+void VGA_SaveState(SaveStateWriter& out)
+{
+	out.Write(vga.vmemsize);
+	for (const auto& [block, num_bytes] : state_blocks()) {
+		out.WriteBytes(block, num_bytes);
+	}
+}
+
+bool VGA_LoadState(SaveStateReader& in, const bool apply)
+{
+	uint32_t vmemsize = 0;
+	if (!in.Read(vmemsize)) {
+		return false;
+	}
+	if (vmemsize != vga.vmemsize) {
+		return in.Fail("vmemsize differs");
+	}
+
+	const auto blocks = state_blocks();
+	std::vector<const uint8_t*> saved = {};
+	for (const auto& [block, num_bytes] : blocks) {
+		const auto bytes = in.Take(num_bytes);
+		if (!bytes) {
+			return false;
+		}
+		saved.push_back(bytes);
+	}
+	if (!apply) {
+		return true;
+	}
+
+	VGA_DrawPendingLines();
+	for (size_t i = 0; i < blocks.size(); ++i) {
+		std::memcpy(blocks[i].first, saved[i], blocks[i].second);
+	}
+
+	// Rebuild what is derived from the registers: the memory handlers, the
+	// host palette and, right away, the output setup
+	VGA_SetupHandlers();
+	VGA_DACSetEntirePalette();
+	vga.draw.resizing = false;
+	VGA_StartResizeAfter(0);
+	return true;
+}
@@ -7,6 +7,7 @@
 
 #include "dosbox.h"
 
+#include <array>
 #include <string>
 #include <utility>
 
@@ -1095,12 +1096,24 @@ void VGA_SetMonochromeCgaPalette();
 void VGA_SetMode(VGAModes mode);
 void VGA_DetermineMode(void);
 void VGA_SetupHandlers(void);
+
+// Returns whether video memory may have changed since the last call, and
+// starts tracking anew
+bool VGA_TakeMemoryChanged();
+
+// Records a change to video memory made other than through the memory
+// handlers, such as by the S3 accelerator
+void VGA_MarkMemoryChanged();
 const char* to_string(const VGAModes mode);
 
 void VGA_StartResize();
 void VGA_StartResizeAfter(const uint16_t delay_ms);
 
 void VGA_SetupDrawing(uint32_t val);
+
+// Draws the high-resolution lines held back so far in the frame, before
+// something they're drawn from changes
+void VGA_DrawPendingLines();
 void VGA_CheckScanLength(void);
 void VGA_ChangedBank(void);
 
@@ -1217,17 +1230,86 @@ void SVGA_Setup_Driver();
 // Amount of video memory required for a mode, implemented in int10_modes.cpp
 uint32_t VideoModeMemSize(uint16_t mode);
 
-extern uint32_t ExpandTable[256];
-extern uint32_t FillTable[16];
+// The tables that depend on nothing but the byte order are computed at
+// compile time, so they live in read-only memory shared by every instance
+// and the drawing loops can fold lookups with constant indices
+
+// A byte repeated in all four planes
+inline constexpr auto ExpandTable = [] {
+	std::array<uint32_t, 256> table = {};
+	for (uint32_t i = 0; i < table.size(); ++i) {
+		table[i] = i | (i << 8) | (i << 16) | (i << 24);
+	}
+	return table;
+}();
+
+// Each of the low four bits as a full byte in its plane
+inline constexpr auto FillTable = [] {
+	std::array<uint32_t, 16> table = {};
+	for (uint32_t i = 0; i < table.size(); ++i) {
+#ifdef WORDS_BIGENDIAN
+		table[i] = ((i & 1) ? 0xff000000 : 0) | ((i & 2) ? 0x00ff0000 : 0) |
+		           ((i & 4) ? 0x0000ff00 : 0) | ((i & 8) ? 0x000000ff : 0);
+#else
+		table[i] = ((i & 1) ? 0x000000ff : 0) | ((i & 2) ? 0x0000ff00 : 0) |
+		           ((i & 4) ? 0x00ff0000 : 0) | ((i & 8) ? 0xff000000 : 0);
+#endif
+	}
+	return table;
+}();
+
+// Four font bits as byte masks, leftmost pixel first in memory
+inline constexpr auto TXT_Font_Table = [] {
+	std::array<uint32_t, 16> table = {};
+	for (uint32_t i = 0; i < table.size(); ++i) {
+#ifdef WORDS_BIGENDIAN
+		table[i] = ((i & 1) ? 0x000000ff : 0) | ((i & 2) ? 0x0000ff00 : 0) |
+		           ((i & 4) ? 0x00ff0000 : 0) | ((i & 8) ? 0xff000000 : 0);
+#else
+		table[i] = ((i & 1) ? 0xff000000 : 0) | ((i & 2) ? 0x00ff0000 : 0) |
+		           ((i & 4) ? 0x0000ff00 : 0) | ((i & 8) ? 0x000000ff : 0);
+#endif
+	}
+	return table;
+}();
+
+// Text colors repeated across four pixels
+inline constexpr auto TXT_FG_Table = [] {
+	std::array<uint32_t, 16> table = {};
+	for (uint32_t i = 0; i < table.size(); ++i) {
+		table[i] = ExpandTable[i];
+	}
+	return table;
+}();
+
+// Starts out as TXT_FG_Table; blinking rewrites the top half
+extern std::array<uint32_t, 16> TXT_BG_Table;
+
+// Four pixels' bits of plane 'j' placed in bit 'j' of each pixel's byte
+inline constexpr auto Expand16Table = [] {
+	std::array<std::array<uint32_t, 16>, 4> table = {};
+	for (uint32_t j = 0; j < table.size(); ++j) {
+		for (uint32_t i = 0; i < table[j].size(); ++i) {
+#ifdef WORDS_BIGENDIAN
+			table[j][i] = ((i & 1) ? 1u << j : 0) | ((i & 2) ? 1u << (8 + j) : 0) |
+			              ((i & 4) ? 1u << (16 + j) : 0) |
+			              ((i & 8) ? 1u << (24 + j) : 0);
+#else
+			table[j][i] = ((i & 1) ? 1u << (24 + j) : 0) |
+			              ((i & 2) ? 1u << (16 + j) : 0) |
+			              ((i & 4) ? 1u << (8 + j) : 0) | ((i & 8) ? 1u << j : 0);
+#endif
+		}
+	}
+	return table;
+}();
+
+// The CGA tables follow the palette registers, so they're built at runtime
 extern uint32_t CGA_2_Table[16];
 extern uint32_t CGA_4_Table[256];
 extern uint32_t CGA_4_HiRes_Table[256];
 extern uint32_t CGA_16_Table[256];
 extern int CGA_Composite_Table[1024];
-extern uint32_t TXT_Font_Table[16];
-extern uint32_t TXT_FG_Table[16];
-extern uint32_t TXT_BG_Table[16];
-extern uint32_t Expand16Table[4][16];
 extern uint32_t Expand16BigTable[0x10000];
 
 #endif
@@ -159,6 +159,9 @@ static void vga_dac_send_color(const uint8_t palette_idx, const uint8_t color_id
 	const auto g8 = rgb6_to_8_lut(rgb666.green);
 	const auto b8 = rgb6_to_8_lut(rgb666.blue);
 
+	// Lines held back were due with the colour they had
+	VGA_DrawPendingLines();
+
 	// Map the source color into palette's requested index
 	vga.dac.palette_map[palette_idx].Set(b8, g8, r8);
 
@@ -6,9 +6,13 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <climits>
 #include <cmath>
 #include <cstring>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "vga.h"
 
@@ -17,8 +21,13 @@
 #include "gui/render_scalers.h"
 #include "hardware/pic.h"
 #include "hardware/video/reelmagic/reelmagic.h"
+#include "hardware/video/vga_palette_draw.h"
+#include "hardware/video/vga_text_draw.h"
 #include "ints/int10.h"
+#include "misc/perf_counters.h"
+#include "misc/tracy.h"
 #include "misc/video.h"
+#include "textmode_server/textmode_server.h"
 #include "utils/bitops.h"
 #include "utils/math_utils.h"
 #include "utils/mem_unaligned.h"
@@ -262,14 +271,17 @@ static uint8_t *VGA_Draw_CGA4_Composite_Line(Bitu vidstart, Bitu line)
 	return Composite_Process(vga.tandy.color_select & 0x0f, vga.draw.blocks, true);
 }
 
+// What each byte of 16-colour Tandy and PCjr graphics turns into
+static NibblePalette tandy_nibble_palette = {};
+
 static uint8_t * VGA_Draw_4BPP_Line(Bitu vidstart, Bitu line) {
 	const uint8_t *base = vga.tandy.draw_base + ((line & vga.tandy.line_mask) << vga.tandy.line_shift);
+	tandy_nibble_palette.Update(vga.attr.palette);
 	uint8_t* draw=TempLine;
 	Bitu end = vga.draw.blocks*2;
 	while(end) {
-		uint8_t byte = base[vidstart & vga.tandy.addr_mask];
-		*draw++=vga.attr.palette[byte >> 4];
-		*draw++=vga.attr.palette[byte & 0x0f];
+		tandy_nibble_palette.Draw(draw, base[vidstart & vga.tandy.addr_mask]);
+		draw += NibblePalette::BytesPerPair;
 		++vidstart;
 		--end;
 	}
@@ -278,14 +290,12 @@ static uint8_t * VGA_Draw_4BPP_Line(Bitu vidstart, Bitu line) {
 
 static uint8_t * VGA_Draw_4BPP_Line_Double(Bitu vidstart, Bitu line) {
 	const uint8_t *base = vga.tandy.draw_base + ((line & vga.tandy.line_mask) << vga.tandy.line_shift);
+	tandy_nibble_palette.Update(vga.attr.palette);
 	uint8_t* draw=TempLine;
 	Bitu end = vga.draw.blocks;
 	while(end) {
-		uint8_t byte = base[vidstart & vga.tandy.addr_mask];
-		uint8_t data = vga.attr.palette[byte >> 4];
-		*draw++ = data; *draw++ = data;
-		data = vga.attr.palette[byte & 0x0f];
-		*draw++ = data; *draw++ = data;
+		tandy_nibble_palette.DrawDouble(draw, base[vidstart & vga.tandy.addr_mask]);
+		draw += NibblePalette::BytesPerPairDouble;
 		++vidstart;
 		--end;
 	}
@@ -352,8 +362,9 @@ static uint8_t * VGA_Draw_Linear_Line(Bitu vidstart, Bitu /*line*/) {
 	return ret;
 }
 
-static uint8_t* draw_unwrapped_line_from_dac_palette(Bitu vidstart,
-                                                     [[maybe_unused]] const Bitu line = 0)
+// The DAC palette drawers write into the line they're given, so lines can
+// also be drawn away from the line buffer (see "Banded line drawing")
+static void draw_unwrapped_dac_line(uint8_t* line_addr, const Bitu vidstart)
 {
 	// Quick references
 	static constexpr auto palette_map        = vga.dac.palette_map;
@@ -362,52 +373,50 @@ static uint8_t* draw_unwrapped_line_from_dac_palette(Bitu vidstart,
 	const auto linear_addr                   = vga.draw.linear_base;
 
 	// Video mode-specific line variables
-	const auto pixels_in_line = static_cast<uint16_t>(vga.draw.line_length /
-	                                                  bytes_per_pixel);
-	const auto video_end = vidstart + pixels_in_line;
+	size_t pixels_remaining = static_cast<uint16_t>(vga.draw.line_length /
+	                                                bytes_per_pixel);
 
 	// The line address is where the RGB888 palettized pixel is written.
-	// It's incremented forward per pixel.
-	auto line_addr = reinterpret_cast<uint32_t*>(TempLine);
+	// It's incremented forward per run of pixels.
 
+	// This function typically runs on 640+-wide lines and is a rendering
+	// bottleneck, so the line is drawn in runs that don't wrap around
+	// video memory rather than masking every pixel's address.
 	auto linear_pos = vidstart;
+	while (pixels_remaining) {
+		const auto offset = linear_pos & linear_mask;
+		const auto num_pixels = std::min(pixels_remaining,
+		                                 static_cast<size_t>(linear_mask + 1 - offset));
 
-	// Draw in batches of four to let the host pipeline deeper.
-	constexpr auto num_repeats = 4;
-	assert(pixels_in_line % num_repeats == 0);
+		draw_palette_pixels(line_addr, linear_addr + offset, num_pixels, palette_map);
 
-	// This function typically runs on 640+-wide lines and is a rendering
-	// bottleneck.
-	while (linear_pos < video_end) {
-		auto repeats = num_repeats;
-		while (repeats--) {
-			const auto masked_pos    = linear_pos++ & linear_mask;
-			const auto palette_index = *(linear_addr + masked_pos);
-			*line_addr++ = *(palette_map + palette_index);
-		}
+		line_addr += num_pixels * bytes_per_pixel;
+		linear_pos += num_pixels;
+		pixels_remaining -= num_pixels;
 	}
+}
 
+static uint8_t* draw_unwrapped_line_from_dac_palette(Bitu vidstart,
+                                                     [[maybe_unused]] const Bitu line = 0)
+{
+	draw_unwrapped_dac_line(TempLine, vidstart);
 	return TempLine;
 }
 
-static uint8_t* draw_linear_line_from_dac_palette(Bitu vidstart, Bitu /*line*/)
+static void draw_linear_dac_line(uint8_t* line_addr, const Bitu vidstart)
 {
 	const auto offset                 = vidstart & vga.draw.linear_mask;
 	constexpr auto palette_map        = vga.dac.palette_map;
 	constexpr uint8_t bytes_per_pixel = sizeof(palette_map[0]);
 
 	// The line address is where the RGB888 palettized pixel is written.
-	// It's incremented forward per pixel.
-	auto line_addr = TempLine;
 
-	// The palette index iterator is used to lookup the DAC palette colour.
-	// It starts at the current VGA line's offset and is incremented per
-	// pixel.
-	auto palette_index_it = vga.draw.linear_base + offset;
+	// The palette indices of the current VGA line start at its offset
+	const auto palette_indices = vga.draw.linear_base + offset;
 
-	// Pixels remaining starts as the total pixels in this current line and
-	// is decremented per pixel rendered. It acts as a lower-bound cutoff
-	// regardless of how long the wrapped and unwrapped regions are.
+	// Pixels remaining starts as the total pixels in this current line. It
+	// acts as a lower-bound cutoff regardless of how long the wrapped and
+	// unwrapped regions are.
 	auto pixels_remaining = check_cast<uint16_t>(vga.draw.line_length /
 	                                             bytes_per_pixel);
 
@@ -415,7 +424,7 @@ static uint8_t* draw_linear_line_from_dac_palette(Bitu vidstart, Bitu /*line*/)
 	// fades in titles like Alien Carnage.
 	if (vga.seq.clocking_mode.is_screen_disabled) {
 		memset(line_addr, 0, vga.draw.line_length);
-		return TempLine;
+		return;
 	}
 
 	// see VGA_Draw_Linear_Line
@@ -433,37 +442,23 @@ static uint8_t* draw_linear_line_from_dac_palette(Bitu vidstart, Bitu /*line*/)
 		        vga.draw.line_length - wrapped_len);
 
 		// unwrapped chunk: to top of memory block
-		auto palette_index_end = palette_index_it +
-		                         std::min(unwrapped_len, pixels_remaining);
-		while (palette_index_it != palette_index_end) {
-			memcpy(line_addr,
-			       palette_map + *palette_index_it++,
-			       bytes_per_pixel);
-			line_addr += bytes_per_pixel;
-			--pixels_remaining;
-		}
+		const auto num_unwrapped = std::min(unwrapped_len, pixels_remaining);
+		draw_palette_pixels(line_addr, palette_indices, num_unwrapped, palette_map);
+		line_addr += num_unwrapped * bytes_per_pixel;
+		pixels_remaining -= num_unwrapped;
 
 		// wrapped chunk: from the base of the memory block
-		palette_index_it  = vga.draw.linear_base;
-		palette_index_end = palette_index_it +
-		                    std::min(wrapped_len, pixels_remaining);
-		while (palette_index_it != palette_index_end) {
-			memcpy(line_addr,
-			       palette_map + *palette_index_it++,
-			       bytes_per_pixel);
-			line_addr += bytes_per_pixel;
-			--pixels_remaining;
-		}
+		const auto num_wrapped = std::min(wrapped_len, pixels_remaining);
+		draw_palette_pixels(line_addr, vga.draw.linear_base, num_wrapped, palette_map);
 
 	} else {
-		auto palette_index_end = palette_index_it + pixels_remaining;
-		while (palette_index_it != palette_index_end) {
-			memcpy(line_addr,
-			       palette_map + *palette_index_it++,
-			       bytes_per_pixel);
-			line_addr += bytes_per_pixel;
-		}
+		draw_palette_pixels(line_addr, palette_indices, pixels_remaining, palette_map);
 	}
+}
+
+static uint8_t* draw_linear_line_from_dac_palette(Bitu vidstart, Bitu /*line*/)
+{
+	draw_linear_dac_line(TempLine, vidstart);
 	return TempLine;
 }
 
@@ -800,6 +795,14 @@ static uint8_t* draw_text_line_from_dac_palette(Bitu vidstart, Bitu line)
 	// pixel and also per character block.
 	auto draw_idx = draw_idx_start;
 
+	// The same for every character in the line
+	const bool is_nine_dots = !vga.seq.clocking_mode.is_eight_dot_mode;
+	const bool is_line_graphics = vga.attr.mode_control.is_line_graphics_enabled;
+	const bool is_blinking = vga.draw.blinking;
+	const bool is_blink_on = vga.draw.blink;
+	const bool is_underline_row = (vga.crtc.underline_location & 0x1f) == line;
+	const uint16_t pixels_per_cell = is_nine_dots ? 9 : 8;
+
 	while (blocks--) { // for each character in the line
 		const auto chr  = *vidmem++;
 		const auto attr = *vidmem++;
@@ -808,18 +811,17 @@ static uint8_t* draw_text_line_from_dac_palette(Bitu vidstart, Bitu line)
 
 		uint8_t bg_palette_idx = attr >> 4;
 		// if blinking is enabled bit7 is not mapped to attributes
-		if (vga.draw.blinking) {
+		if (is_blinking) {
 			bg_palette_idx &= ~0x8;
 		}
 		// choose foreground color if blinking not set for this cell or
 		// blink on
-		const uint8_t fg_palette_idx = (vga.draw.blink || (attr & 0x80) == 0)
+		const uint8_t fg_palette_idx = (is_blink_on || (attr & 0x80) == 0)
 		                                     ? (attr & 0xf)
 		                                     : bg_palette_idx;
 
 		// underline: all foreground [freevga: 0x77, previous 0x7]
-		if (((attr & 0x77) == 0x01) &&
-		    (vga.crtc.underline_location & 0x1f) == line) {
+		if (((attr & 0x77) == 0x01) && is_underline_row) {
 			bg_palette_idx = fg_palette_idx;
 		}
 
@@ -827,28 +829,20 @@ static uint8_t* draw_text_line_from_dac_palette(Bitu vidstart, Bitu line)
 		const auto fg_colour = palette_map[fg_palette_idx];
 		const auto bg_colour = palette_map[bg_palette_idx];
 
-		if (vga.seq.clocking_mode.is_eight_dot_mode) {
-			for (auto n = 0; n < 8; ++n) {
-				const auto color = (font & 0x80) ? fg_colour
-				                                 : bg_colour;
-				write_unaligned_uint32_at(TempLine, draw_idx++, color);
-				font <<= 1;
-			}
-		} else {
+		if (is_nine_dots) {
 			font <<= 1; // 9 pixels
 			// Extend to the 9th pixel if needed
-			if ((font & 0x2) &&
-			    vga.attr.mode_control.is_line_graphics_enabled &&
-			    (chr >= 0xc0) && (chr <= 0xdf)) {
+			if ((font & 0x2) && is_line_graphics && (chr >= 0xc0) &&
+			    (chr <= 0xdf)) {
 				font |= 1;
 			}
-			for (auto n = 0; n < 9; ++n) {
-				const auto color = (font & 0x100) ? fg_colour
-				                                  : bg_colour;
-				write_unaligned_uint32_at(TempLine, draw_idx++, color);
-				font <<= 1;
-			}
 		}
+		draw_text_cell(TempLine + draw_idx * sizeof(uint32_t),
+		               font,
+		               is_nine_dots,
+		               fg_colour,
+		               bg_colour);
+		draw_idx += pixels_per_cell;
 	}
 	// draw the text mode cursor if needed
 	if (!SkipCursor(vidstart, line)) {
@@ -913,9 +907,13 @@ static void VGA_ProcessSplit()
 	vga.draw.address_line = 0;
 }
 
+static PerfCounter vga_lines_drawn("vga_lines_drawn", "Scanlines drawn by the VGA.");
+
 static uint8_t bg_color_index = 0; // screen-off black index
 static void VGA_DrawSingleLine(uint32_t /*blah*/)
 {
+	ZoneScoped;
+	vga_lines_drawn.Add();
 	if (vga.attr.disabled) {
 		switch(machine) {
 		case MachineType::Pcjr:
@@ -1037,11 +1035,230 @@ static void VGA_DrawEGASingleLine(uint32_t /*blah*/)
 	} else RENDER_EndUpdate(false);
 }
 
+// Banded line drawing
+// ~~~~~~~~~~~~~~~~~~~
+// High-resolution 8-bit modes spend most of their drawing time looking up
+// the DAC palette, which depends only on the line's address and on state
+// that stays put between register changes. So their lines are held back
+// as they come due, then drawn in horizontal bands by a small pool of
+// threads, the emulation thread included, at the end of the visible part
+// of the frame. The drawn lines are handed to the renderer in order.
+//
+// Changing the palette, turning the screen off or the drawing being set
+// up again first draws the lines held back so far, so raster effects
+// still show where they happened. Aborted frames drop them. Like the
+// legacy four-part drawing, lines held back show video memory as it is
+// when they're drawn, rather than when the beam passed them.
+
+// Narrower modes draw fast enough on the emulation thread alone
+constexpr auto MinBandedLineWidth = 1024;
+
+// Too few lines to be worth waking up the threads for
+constexpr size_t MinBandedLines = 32;
+
+constexpr auto MaxBandThreads = 3;
+
+static PerfCounter vga_banded_lines("vga_banded_lines",
+                                    "Scanlines of high-resolution 8-bit modes "
+                                    "drawn in bands after being held back.");
+
+using dac_line_drawer_f = void(uint8_t* line_addr, const Bitu vidstart);
+
+struct BandWorker {
+	BandWorker()
+	        : num_threads(std::clamp(static_cast<int>(
+	                                         std::thread::hardware_concurrency()) - 1,
+	                                 0,
+	                                 MaxBandThreads)),
+	          num_work_units((num_threads + 1) * 2),
+	          threads(num_threads)
+	{}
+
+	~BandWorker()
+	{
+		if (!threads_active.load(std::memory_order_acquire)) {
+			return;
+		}
+		threads_active.store(false, std::memory_order_release);
+		work_index.store(0, std::memory_order_release);
+		work_index.notify_all();
+
+		for (auto& thread : threads) {
+			if (thread.joinable()) {
+				thread.join();
+			}
+		}
+	}
+
+	BandWorker(const BandWorker&)            = delete;
+	BandWorker& operator=(const BandWorker&) = delete;
+
+	const int num_threads    = 0;
+	const int num_work_units = 0;
+
+	// The lines held back, by where they start in video memory, and the
+	// drawer they're for
+	std::vector<Bitu> pending_addresses = {};
+	dac_line_drawer_f* draw_line        = nullptr;
+
+	// Where the held back lines are drawn, one after the other
+	std::vector<uint8_t> lines = {};
+	size_t line_bytes          = 0;
+
+	std::vector<std::thread> threads = {};
+	std::atomic_bool threads_active  = {};
+
+	// Worker threads start working when this gets reset to 0
+	std::atomic<int> work_index = INT_MAX;
+
+	std::atomic<int> done_count = 0;
+};
+
+static BandWorker band_worker;
+
+static void draw_band(const int band)
+{
+	auto& worker = band_worker;
+
+	const auto num_lines  = worker.pending_addresses.size();
+	const auto num_bands  = static_cast<size_t>(worker.num_work_units);
+	const auto first_line = num_lines * static_cast<size_t>(band) / num_bands;
+	const auto last_line = num_lines * static_cast<size_t>(band + 1) / num_bands;
+
+	for (auto i = first_line; i < last_line; ++i) {
+		worker.draw_line(worker.lines.data() + i * worker.line_bytes,
+		                 worker.pending_addresses[i]);
+	}
+}
+
+// Same scheme as the Voodoo's triangle worker
+static int do_band_work()
+{
+	auto& worker = band_worker;
+
+	int i = worker.work_index.load(std::memory_order_acquire);
+	if (i >= worker.num_work_units) {
+		return i;
+	}
+
+	i = worker.work_index.fetch_add(1, std::memory_order_acq_rel);
+	if (i < worker.num_work_units) {
+		draw_band(i);
+		const auto done = worker.done_count.fetch_add(1, std::memory_order_acq_rel) + 1;
+		if (done >= worker.num_work_units) {
+			worker.done_count.notify_all();
+		}
+	}
+	return i + 1;
+}
+
+static void band_worker_thread_func()
+{
+	auto& worker = band_worker;
+	while (worker.threads_active.load(std::memory_order_acquire)) {
+		const auto i = do_band_work();
+		if (i >= worker.num_work_units) {
+			worker.work_index.wait(i, std::memory_order_acquire);
+		}
+	}
+}
+
+static void run_band_worker()
+{
+	auto& worker = band_worker;
+
+	// Only the emulation thread starts the threads, so there's no race
+	if (!worker.threads_active.load(std::memory_order_acquire)) {
+		worker.threads_active.store(true, std::memory_order_release);
+		for (auto& thread : worker.threads) {
+			thread = std::thread(band_worker_thread_func);
+		}
+	}
+
+	worker.done_count.store(0, std::memory_order_release);
+
+	// Resetting this index triggers the worker threads to start working
+	worker.work_index.store(0, std::memory_order_release);
+	worker.work_index.notify_all();
+
+	// The emulation thread draws bands too
+	while (do_band_work() < worker.num_work_units) {
+	}
+
+	int i = 0;
+	while ((i = worker.done_count.load(std::memory_order_acquire)) <
+	       worker.num_work_units) {
+		worker.done_count.wait(i, std::memory_order_acquire);
+	}
+}
+
+// The drawer the current mode's lines can be held back for, if any
+static dac_line_drawer_f* get_banded_line_drawer()
+{
+	if (band_worker.num_threads == 0 ||
+	    vga.draw.line_length / sizeof(vga.dac.palette_map[0]) < MinBandedLineWidth) {
+		return nullptr;
+	}
+	if (VGA_DrawLine == draw_linear_line_from_dac_palette) {
+		return draw_linear_dac_line;
+	}
+	if (VGA_DrawLine == draw_unwrapped_line_from_dac_palette) {
+		return draw_unwrapped_dac_line;
+	}
+	return nullptr;
+}
+
+void VGA_DrawPendingLines()
+{
+	auto& worker = band_worker;
+	if (worker.pending_addresses.empty()) {
+		return;
+	}
+	ZoneScoped;
+
+	const auto num_lines = worker.pending_addresses.size();
+	worker.line_bytes    = vga.draw.line_length;
+	worker.lines.resize(num_lines * worker.line_bytes);
+
+	if (num_lines < MinBandedLines) {
+		for (auto band = 0; band < worker.num_work_units; ++band) {
+			draw_band(band);
+		}
+	} else {
+		run_band_worker();
+	}
+
+	for (size_t i = 0; i < num_lines; ++i) {
+		ReelMagic_RENDER_DrawLine(worker.lines.data() + i * worker.line_bytes);
+	}
+	vga_banded_lines.Add(num_lines);
+	worker.pending_addresses.clear();
+}
+
+static void drop_pending_lines()
+{
+	band_worker.pending_addresses.clear();
+}
+
 static void VGA_DrawPart(uint32_t lines)
 {
+	ZoneScoped;
+	vga_lines_drawn.Add(lines);
+
+	const auto banded_line_drawer = get_banded_line_drawer();
+	if (band_worker.draw_line != banded_line_drawer) {
+		VGA_DrawPendingLines();
+		band_worker.draw_line = banded_line_drawer;
+	}
+
 	while (lines--) {
-		uint8_t * data=VGA_DrawLine( vga.draw.address, vga.draw.address_line );
-		ReelMagic_RENDER_DrawLine(data);
+		if (banded_line_drawer) {
+			band_worker.pending_addresses.push_back(vga.draw.address);
+		} else {
+			uint8_t* data = VGA_DrawLine(vga.draw.address,
+			                             vga.draw.address_line);
+			ReelMagic_RENDER_DrawLine(data);
+		}
 		++vga.draw.address_line;
 		if (vga.draw.address_line>=vga.draw.address_line_total) {
 			vga.draw.address_line=0;
@@ -1067,6 +1284,7 @@ static void VGA_DrawPart(uint32_t lines)
 #ifdef VGA_KEEP_CHANGES
 		VGA_ChangesEnd();
 #endif
+		VGA_DrawPendingLines();
 		RENDER_EndUpdate(false);
 	}
 }
@@ -1142,10 +1360,74 @@ static void VGA_PanningLatch(uint32_t /*val*/)
 	vga.draw.panning = vga.config.pel_panning;
 }
 
+static PerfCounter vga_frames_unchanged("vga_frames_unchanged",
+                                        "Frames not drawn because neither "
+                                        "video memory nor the registers "
+                                        "changed.");
+
+// The registers the last drawn frame was made from, byte for byte
+static std::vector<uint8_t> last_frame_inputs = {};
+
+// Some register types have no copy assignment, so like the save states,
+// everything is compared as bytes
+template <typename T>
+static void add_frame_input(std::vector<uint8_t>& inputs, const T& input)
+{
+	const auto bytes = reinterpret_cast<const uint8_t*>(&input);
+	inputs.insert(inputs.end(), bytes, bytes + sizeof(T));
+}
+
+// Whether the frame about to start would look exactly like the last one
+// drawn, so it can be left on screen. The latch and the draw state are
+// left out as they're either not shown or derived from what's compared;
+// of the latter only the blink and cursor phases count.
+static bool is_frame_unchanged()
+{
+	static std::vector<uint8_t> inputs = {};
+	inputs.clear();
+
+	add_frame_input(inputs, vga.mode);
+	add_frame_input(inputs, vga.misc_output);
+	add_frame_input(inputs, vga.config);
+	add_frame_input(inputs, vga.seq);
+	add_frame_input(inputs, vga.attr);
+	add_frame_input(inputs, vga.crtc);
+	add_frame_input(inputs, vga.gfx);
+	add_frame_input(inputs, vga.dac);
+	add_frame_input(inputs, vga.s3);
+	add_frame_input(inputs, vga.svga);
+	add_frame_input(inputs, vga.herc);
+	add_frame_input(inputs, vga.tandy);
+	add_frame_input(inputs, vga.other);
+	add_frame_input(inputs, vga.composite);
+	add_frame_input(inputs, vga.draw.blinking);
+	add_frame_input(inputs, static_cast<uint8_t>((vga.draw.cursor.count >> 3) & 3));
+
+	// Always take the memory flag, so the next frame has a fresh start
+	const bool is_memory_changed = VGA_TakeMemoryChanged();
+
+	const bool is_unchanged = !is_memory_changed && inputs == last_frame_inputs &&
+	                          !RENDER_IsNextFrameNeeded() &&
+	                          !ReelMagic_IsVideoMixerEnabled();
+	if (!is_unchanged) {
+		last_frame_inputs.swap(inputs);
+	}
+	return is_unchanged;
+}
+
+static PerfCounter vga_frames("vga_frames", "Frames started by the VGA.");
+
 static void VGA_VerticalTimer(uint32_t /*val*/)
 {
+	ZoneScoped;
+
 	vga.draw.delay.framestart = PIC_FullIndex();
 	PIC_AddEvent(VGA_VerticalTimer, vga.draw.delay.vtotal);
+	vga_frames.Add();
+
+	// The previous frame is complete; hand it to the text-mode server
+	// before the new display start address is latched
+	TEXTMODESERVER_OnVerticalRetrace();
 
 	switch(machine) {
 	case MachineType::Pcjr:
@@ -1184,7 +1466,16 @@ static void VGA_VerticalTimer(uint32_t /*val*/)
 	//Check if we can actually render, else skip the rest (frameskip)
 	++vga.draw.cursor.count; // Do this here, else the cursor speed depends
 	                         // on the frameskip
-	if (vga.draw.vga_override || !ReelMagic_RENDER_StartUpdate()) {
+	if (vga.draw.vga_override) {
+		return;
+	}
+	if (is_frame_unchanged()) {
+		vga_frames_unchanged.Add();
+		return;
+	}
+	if (!ReelMagic_RENDER_StartUpdate()) {
+		// Nothing was drawn, so the next frame can't be compared to it
+		last_frame_inputs.clear();
 		return;
 	}
 
@@ -1311,6 +1602,7 @@ static void VGA_VerticalTimer(uint32_t /*val*/)
 		if (vga.draw.parts_left) {
 			LOG(LOG_VGAMISC, LOG_NORMAL)("Parts left: %u", vga.draw.parts_left);
 			PIC_RemoveEvents(VGA_DrawPart);
+			drop_pending_lines();
 			RENDER_EndUpdate(true);
 		}
 		vga.draw.lines_done = 0;
@@ -2936,6 +3228,9 @@ ImageInfo setup_drawing()
 
 void VGA_SetupDrawing(uint32_t /*val*/)
 {
+	// The lines held back are drawn the way they were due
+	VGA_DrawPendingLines();
+
 	if (vga.mode == M_ERROR) {
 		PIC_RemoveEvents(VGA_VerticalTimer);
 		PIC_RemoveEvents(VGA_PanningLatch);
@@ -3007,12 +3302,16 @@ void VGA_SetupDrawing(uint32_t /*val*/)
 			ReelMagic_RENDER_SetSize(image_info, fps);
 		}
 
+		if (previous_video_mode != image_info.video_mode) {
+			TEXTMODESERVER_OnVideoModeChanged(image_info.video_mode);
+		}
 		previous_video_mode = image_info.video_mode;
 	}
 }
 
 void VGA_KillDrawing(void) {
 	PIC_RemoveEvents(VGA_DrawPart);
+	drop_pending_lines();
 	PIC_RemoveEvents(VGA_DrawSingleLine);
 	PIC_RemoveEvents(VGA_DrawEGASingleLine);
 	vga.draw.parts_left = 0;
@@ -4,6 +4,7 @@
 
 #include "dosbox.h"
 
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <vector>
@@ -16,6 +17,8 @@
 #include "hardware/memory.h"
 #include "hardware/pic.h"
 #include "hardware/port.h"
+#include "misc/footprint.h"
+#include "misc/perf_counters.h"
 #include "utils/mem_host.h"
 
 #ifndef C_VGARAM_CHECKED
@@ -113,16 +116,71 @@ static void read_delay()
 	}
 }
 
-static void write_delay()
+// Whether video memory was written since the last frame asked. Every
+// write through the handlers below goes by write_delay(). The direct
+// mappings, used for the banked and linear framebuffers, are write
+// protected at the start of each frame instead: they're linked without a
+// write pointer until the first write of the frame, which the handler
+// takes, and from then on the CPU stores straight through the TLB.
+static bool is_memory_changed      = true;
+static bool are_memory_writes_seen = false;
+
+// Whether the direct mappings handed out write pointers since the last
+// frame asked
+static bool are_direct_writes_linked = false;
+
+bool VGA_TakeMemoryChanged()
+{
+	const bool is_changed = is_memory_changed || !are_memory_writes_seen;
+	is_memory_changed = false;
+
+	// Write protect the direct mappings again
+	if (are_direct_writes_linked) {
+		are_direct_writes_linked = false;
+		PAGING_ClearTLB();
+	}
+	return is_changed;
+}
+
+// Write pointers of the direct mappings, once the frame has seen a write
+static HostPt direct_write_pt(const HostPt host_pt)
+{
+	if (!is_memory_changed) {
+		return nullptr;
+	}
+	are_direct_writes_linked = true;
+	return host_pt;
+}
+
+void VGA_MarkMemoryChanged()
 {
+	is_memory_changed = true;
+}
+
+static void write_delay(const uint32_t num_writes = 1)
+{
+	is_memory_changed = true;
 	if (vga.vmem_delay_ns > 0) {
 		const int32_t delay_cycles = (CPU_CycleMax * vga.vmem_delay_ns * 3) /
-		                             (1000000 * 4);
+		                             (1000000 * 4) *
+		                             static_cast<int32_t>(num_writes);
 		CPU_Cycles -= delay_cycles;
 		CPU_IODelayRemoved += delay_cycles;
 	}
 }
 
+static PerfCounter vga_span_write_bytes("vga_span_write_bytes",
+                                        "Bytes REP string instructions wrote "
+                                        "to planar video memory a span at a time.");
+
+// Planar offset of the first byte of a span write by the unchained
+// handlers, before wrapping around video memory
+static PhysPt unchained_span_start(const PhysPt addr)
+{
+	return (PAGING_GetPhysicalAddress(addr) & vgapages.mask) +
+	       vga.svga.bank_write_full;
+}
+
 class VGA_UnchainedRead_Handler : public PageHandler {
 public:
 	uint8_t readHandler(PhysPt start)
@@ -276,7 +334,9 @@ public:
 class VGA_UnchainedEGA_Handler : public VGA_UnchainedRead_Handler {
 public:
 	void writeHandler(PhysPt start, uint8_t val) {
-		uint32_t data=ModeOperation(val);
+		writePlanes(start, ModeOperation(val));
+	}
+	void writePlanes(PhysPt start, uint32_t data) {
 		/* Update video memory and the pixel buffer */
 		VgaLatch pixels;
 		pixels.d=((uint32_t*)vga.mem.linear)[start];
@@ -340,6 +400,37 @@ public:
 		writeHandler(addr+2,(uint8_t)(val >> 16));
 		writeHandler(addr+3,(uint8_t)(val >> 24));
 	}
+
+	// The write mode only depends on the written value, so a fill
+	// computes the plane data once
+	bool fillb(PhysPt addr, uint8_t val, uint32_t num_bytes,
+	           uint32_t num_writes) override
+	{
+		write_delay(num_writes);
+		const auto start = unchained_span_start(addr);
+		const auto data  = ModeOperation(val);
+		for (uint32_t i = 0; i < num_bytes; ++i) {
+			const auto offset = CHECKED2(start + i);
+			MEM_CHANGED( offset << 3);
+			writePlanes(offset, data);
+		}
+		vga_span_write_bytes.Add(num_bytes);
+		return true;
+	}
+
+	bool writeblock(PhysPt addr, const uint8_t* src, uint32_t num_bytes,
+	                uint32_t num_writes) override
+	{
+		write_delay(num_writes);
+		const auto start = unchained_span_start(addr);
+		for (uint32_t i = 0; i < num_bytes; ++i) {
+			const auto offset = CHECKED2(start + i);
+			MEM_CHANGED( offset << 3);
+			writeHandler(offset, src[i]);
+		}
+		vga_span_write_bytes.Add(num_bytes);
+		return true;
+	}
 };
 
 //Slighly unusual version, will directly write 8,16,32 bits values
@@ -503,7 +594,9 @@ public:
 class VGA_UnchainedVGA_Handler final : public VGA_UnchainedRead_Handler {
 public:
 	void writeHandler( PhysPt addr, uint8_t val ) {
-		uint32_t data=ModeOperation(val);
+		writePlanes(addr, ModeOperation(val));
+	}
+	void writePlanes(PhysPt addr, uint32_t data) {
 		VgaLatch pixels;
 		pixels.d=((uint32_t*)vga.mem.linear)[addr];
 		pixels.d&=vga.config.full_not_map_mask;
@@ -550,6 +643,54 @@ public:
 		writeHandler(addr+2,(uint8_t)(val >> 16));
 		writeHandler(addr+3,(uint8_t)(val >> 24));
 	}
+
+	// Mode X clears and fills. The plane data is the same for every
+	// byte, so when the span doesn't wrap around video memory the loop
+	// is a plain masked store the compiler can vectorise.
+	bool fillb(PhysPt addr, uint8_t val, uint32_t num_bytes,
+	           uint32_t num_writes) override
+	{
+		write_delay(num_writes);
+		const auto start = unchained_span_start(addr);
+		const auto data  = ModeOperation(val) & vga.config.full_map_mask;
+		const auto keep  = vga.config.full_not_map_mask;
+
+		auto planes = reinterpret_cast<uint32_t*>(vga.mem.linear);
+		const auto first = CHECKED2(start);
+		if (CHECKED2(start + num_bytes - 1) == first + num_bytes - 1) {
+			auto span = planes + first;
+			for (uint32_t i = 0; i < num_bytes; ++i) {
+				span[i] = (span[i] & keep) | data;
+			}
+#ifdef VGA_KEEP_CHANGES
+			for (uint32_t i = 0; i < num_bytes; ++i) {
+				MEM_CHANGED( (first + i) << 2);
+			}
+#endif
+		} else {
+			for (uint32_t i = 0; i < num_bytes; ++i) {
+				const auto offset = CHECKED2(start + i);
+				MEM_CHANGED( offset << 2);
+				planes[offset] = (planes[offset] & keep) | data;
+			}
+		}
+		vga_span_write_bytes.Add(num_bytes);
+		return true;
+	}
+
+	bool writeblock(PhysPt addr, const uint8_t* src, uint32_t num_bytes,
+	                uint32_t num_writes) override
+	{
+		write_delay(num_writes);
+		const auto start = unchained_span_start(addr);
+		for (uint32_t i = 0; i < num_bytes; ++i) {
+			const auto offset = CHECKED2(start + i);
+			MEM_CHANGED( offset << 2);
+			writeHandler(offset, src[i]);
+		}
+		vga_span_write_bytes.Add(num_bytes);
+		return true;
+	}
 };
 
 class VGA_TEXT_PageHandler final : public PageHandler {
@@ -593,6 +734,21 @@ public:
 	}
 };
 
+// The first write of a frame to a write protected direct mapping: it
+// marks the memory changed and relinks the page, which now gets its write
+// pointer on the next access
+static HostPt first_write_pt(PageHandler* handler, const PhysPt lin_addr)
+{
+	is_memory_changed = true;
+
+	const auto phys_addr = PAGING_GetPhysicalAddress(lin_addr);
+	PAGING_UnlinkPages(lin_addr / 4096, 1);
+
+	const auto host_pt = handler->GetHostWritePt(phys_addr / 4096);
+	assert(host_pt);
+	return host_pt + (phys_addr % 4096);
+}
+
 class VGA_Map_Handler final : public PageHandler {
 public:
 	VGA_Map_Handler() {
@@ -604,7 +760,27 @@ public:
 	}
 	HostPt GetHostWritePt(Bitu phys_page) override {
  		phys_page-=vgapages.base;
-		return &vga.mem.linear[CHECKED3(vga.svga.bank_write_full+phys_page*4096)];
+		return direct_write_pt(&vga.mem.linear[CHECKED3(
+		        vga.svga.bank_write_full + phys_page * 4096)]);
+	}
+
+	// Only the first write of a frame to each page lands here, see
+	// direct_write_pt()
+	void writeb(PhysPt addr, uint8_t val) override
+	{
+		host_writeb(first_write_pt(this, addr), val);
+	}
+	void writew(PhysPt addr, uint16_t val) override
+	{
+		host_writew(first_write_pt(this, addr), val);
+	}
+	void writed(PhysPt addr, uint32_t val) override
+	{
+		host_writed(first_write_pt(this, addr), val);
+	}
+	void writeq(PhysPt addr, uint64_t val) override
+	{
+		host_writeq(first_write_pt(this, addr), val);
 	}
 };
 
@@ -676,6 +852,17 @@ public:
 	VGA_LIN4_Handler() {
 		flags=PFLAG_NOCODE;
 	}
+
+	// The span writes of the unchained EGA handler use its addressing,
+	// not this one's
+	bool fillb(PhysPt, uint8_t, uint32_t, uint32_t) override
+	{
+		return false;
+	}
+	bool writeblock(PhysPt, const uint8_t*, uint32_t, uint32_t) override
+	{
+		return false;
+	}
 	void writeb(PhysPt addr, uint8_t val) override
 	{
 		write_delay();
@@ -805,7 +992,24 @@ public:
 		return &vga.mem.linear[CHECKED3(phys_page * 4096)];
 	}
 	HostPt GetHostWritePt( Bitu phys_page ) override {
-		return GetHostReadPt( phys_page );
+		return direct_write_pt(GetHostReadPt(phys_page));
+	}
+
+	void writeb(PhysPt addr, uint8_t val) override
+	{
+		host_writeb(first_write_pt(this, addr), val);
+	}
+	void writew(PhysPt addr, uint16_t val) override
+	{
+		host_writew(first_write_pt(this, addr), val);
+	}
+	void writed(PhysPt addr, uint32_t val) override
+	{
+		host_writed(first_write_pt(this, addr), val);
+	}
+	void writeq(PhysPt addr, uint64_t val) override
+	{
+		host_writeq(first_write_pt(this, addr), val);
 	}
 };
 
@@ -861,6 +1065,18 @@ public:
 	}
 };
 
+// Tandy and PCjr video memory can be part of guest RAM, which the CPU
+// then writes directly through the TLB, so the dirty page tracking counts
+// such a page as written once it's linked for writing
+static HostPt tandy_write_pt(const HostPt host_pt)
+{
+	const auto ram_bytes = static_cast<size_t>(MEM_TotalPages()) * MemPageSize;
+	if (host_pt >= MemBase && host_pt < MemBase + ram_bytes) {
+		MEM_MarkRangeDirty(static_cast<PhysPt>(host_pt - MemBase), MemPageSize);
+	}
+	return host_pt;
+}
+
 class VGA_TANDY_PageHandler final : public PageHandler {
 public:
 	VGA_TANDY_PageHandler() {
@@ -876,7 +1092,7 @@ public:
 		return vga.tandy.mem_base + (phys_page * 4096);
 	}
 	HostPt GetHostWritePt(Bitu phys_page) override {
-		return GetHostReadPt( phys_page );
+		return tandy_write_pt(GetHostReadPt(phys_page));
 	}
 };
 
@@ -894,7 +1110,7 @@ public:
 		return vga.tandy.mem_base + (phys_page * 4096);
 	}
 	HostPt GetHostWritePt(Bitu phys_page) override {
-		return GetHostReadPt( phys_page );
+		return tandy_write_pt(GetHostReadPt(phys_page));
 	}
 };
 
@@ -963,6 +1179,9 @@ void VGA_SetupHandlers(void) {
 	vga.svga.bank_read_full = vga.svga.bank_read*vga.svga.bank_size;
 	vga.svga.bank_write_full = vga.svga.bank_write*vga.svga.bank_size;
 
+	is_memory_changed      = true;
+	are_memory_writes_seen = false;
+
 	PageHandler *newHandler;
 	switch (machine) {
 	case MachineType::CgaMono:
@@ -1103,6 +1322,7 @@ void VGA_SetupHandlers(void) {
 	if (svga_type == SvgaType::S3 && (vga.s3.ext_mem_ctrl & 0x10)) {
 		MEM_SetPageHandler(VGA_PAGE_A0, 16, &vgaph.mmio);
 	}
+	are_memory_writes_seen = true;
 range_done:
 	PAGING_ClearTLB();
 }
@@ -1172,6 +1392,10 @@ static uint32_t determine_vmem_delay_ns()
 	}
 }
 
+static FootprintRegion linear_region("vga_memory", "Video memory.");
+static FootprintRegion fastmem_region("vga_fastmem",
+                                      "Video memory unpacked for drawing.");
+
 void VGA_SetupMemory(Section* sec)
 {
 	vga.svga.bank_read = vga.svga.bank_write = 0;
@@ -1185,26 +1409,29 @@ void VGA_SetupMemory(Section* sec)
 	// so this is realistically as strict as we should align the memory for
 	// host operations. However, DOS programs might write read and write to
 	// video memory in 16-byte chunks, so for convenience we align on 16-bytes.
-	constexpr uint8_t vmem_alignment    = 16;
-	using vmem_buffer_t                 = std::unique_ptr<uint8_t[]>;
-	static vmem_buffer_t linear_buffer  = {};
-	static vmem_buffer_t fastmem_buffer = {};
+	// The buffers come page aligned and zeroed straight from the host, which
+	// only commits the pages the modes in use touch; text modes only need
+	// the first few.
+	constexpr uint8_t vmem_alignment      = 16;
+	static FootprintBuffer linear_buffer  = {};
+	static FootprintBuffer fastmem_buffer = {};
 
 	// Allocate and verify alignment of the linear buffer, which includes
 	// one additional scanline worth of memory.
 	const auto num_linear_bytes = std::max(vga_mem_bytes_min, vga.vmemsize) +
 	                              vga_mem_scanline_reserve;
-	std::tie(linear_buffer, vga.mem.linear) =
-	        make_unique_aligned_array<uint8_t>(vmem_alignment, num_linear_bytes);
+	linear_buffer  = FootprintBuffer(num_linear_bytes);
+	vga.mem.linear = linear_buffer.data();
 	assert(reinterpret_cast<uintptr_t>(vga.mem.linear) % vmem_alignment == 0);
+	linear_region.Track(linear_buffer.data(), linear_buffer.size());
 
 	// Allocate and verify alignment of the fast-memory buffer, which is
 	// twice the size of the linear array.
 	const auto num_fastmem_bytes = 2 * num_linear_bytes;
-	std::tie(fastmem_buffer,
-	         vga.fastmem) = make_unique_aligned_array<uint8_t>(vmem_alignment,
-	                                                           num_fastmem_bytes);
+	fastmem_buffer = FootprintBuffer(num_fastmem_bytes);
+	vga.fastmem    = fastmem_buffer.data();
 	assert(reinterpret_cast<uintptr_t>(vga.fastmem) % vmem_alignment == 0);
+	fastmem_region.Track(fastmem_buffer.data(), fastmem_buffer.size());
 
 	// In most cases these values stay the same. Assumptions: vmemwrap is power of 2,
 	// vmemwrap <= vmemsize, fastmem implicitly has mem wrap twice as big
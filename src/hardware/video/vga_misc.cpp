@@ -4,6 +4,7 @@
 
 #include "dosbox.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "vga.h"
@@ -43,6 +44,38 @@ uint8_t vga_read_p3da(io_port_t, io_width_t)
 	return retval;
 }
 
+// When the bits of the status register under the mask next change, for
+// loops waiting on the retrace. Past the end of the display or the
+// retrace, nothing changes until the next frame starts in a PIC event.
+static double vga_poll_hint_p3da(io_port_t, const uint8_t mask)
+{
+	const auto& delay      = vga.draw.delay;
+	const auto timeInFrame = PIC_FullIndex() - delay.framestart;
+
+	auto next_change = IO_StableUntilEvent;
+	if (mask & 8) {
+		if (timeInFrame < delay.vrstart) {
+			next_change = delay.vrstart;
+		} else if (timeInFrame <= delay.vrend) {
+			next_change = delay.vrend;
+		}
+	}
+	if ((mask & 1) && timeInFrame < delay.vdend && delay.htotal > 0) {
+		const auto lineStart  = timeInFrame - fmod(timeInFrame, delay.htotal);
+		const auto timeInLine = timeInFrame - lineStart;
+
+		auto blank_change = lineStart + delay.htotal + delay.hblkstart;
+		if (timeInLine < delay.hblkstart) {
+			blank_change = lineStart + delay.hblkstart;
+		} else if (timeInLine <= delay.hblkend) {
+			blank_change = lineStart + delay.hblkend;
+		}
+		next_change = std::min({next_change, blank_change, delay.vdend});
+	}
+	return next_change == IO_StableUntilEvent ? next_change
+	                                          : delay.framestart + next_change;
+}
+
 static void write_p3c2(io_port_t, io_val_t value, io_width_t)
 {
 	const auto val = check_cast<uint8_t>(value);
@@ -91,6 +124,7 @@ static void write_p3c2(io_port_t, io_val_t value, io_width_t)
 	}
 
 	IO_RegisterReadHandler(active_base + 0xa, vga_read_p3da, io_width_t::byte);
+	IO_RegisterPollHint(active_base + 0xa, vga_poll_hint_p3da);
 	IO_FreeReadHandler(inactive_base + 0xa, io_width_t::byte);
 }
 
@@ -156,5 +190,6 @@ void VGA_SetupMisc()
 		}
 	} else if (is_machine_cga() || is_machine_pcjr_or_tandy()) {
 		IO_RegisterReadHandler(0x3da, vga_read_p3da, io_width_t::byte);
+		IO_RegisterPollHint(0x3da, vga_poll_hint_p3da);
 	}
 }
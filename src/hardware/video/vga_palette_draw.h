@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_VGA_PALETTE_DRAW_H
+#define DOSBOX_VGA_PALETTE_DRAW_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "utils/bgrx8888.h"
+
+// Palette lookups
+// ~~~~~~~~~~~~~~~
+// Turns runs of indexed pixels into colours.
+//
+// 8-bit pixels index the 256 DAC colours. Shuffles only look up 16-entry
+// tables, and neither gathers nor batching beat a plain loop of loads for
+// this, as the BM_DrawPalettePixels benchmarks show, so the drawers share
+// one loop and hand it runs of the line that don't wrap around video memory.
+//
+// 4-bit pixels come two to a byte, highest nibble first. A table of what
+// every byte turns into, rebuilt only when the 16-colour palette changes,
+// makes each byte a single lookup and store.
+
+static inline void draw_palette_pixels(uint8_t* dst, const uint8_t* src,
+                                       const size_t num_pixels,
+                                       const Bgrx8888* const palette)
+{
+	for (size_t i = 0; i < num_pixels; ++i) {
+		std::memcpy(dst + i * sizeof(Bgrx8888), palette + src[i], sizeof(Bgrx8888));
+	}
+}
+
+class NibblePalette {
+public:
+	// One byte per pixel, or two when each pixel is drawn twice
+	static constexpr size_t BytesPerPair       = 2;
+	static constexpr size_t BytesPerPairDouble = 4;
+
+	void Update(const uint8_t* const palette)
+	{
+		if (is_valid && std::memcmp(colours.data(), palette, colours.size()) == 0) {
+			return;
+		}
+		std::memcpy(colours.data(), palette, colours.size());
+		for (size_t byte = 0; byte < pairs.size(); ++byte) {
+			const auto high = colours[byte >> 4];
+			const auto low  = colours[byte & 0x0f];
+			pairs[byte]         = {high, low};
+			doubled_pairs[byte] = {high, high, low, low};
+		}
+		is_valid = true;
+	}
+
+	void Draw(uint8_t* dst, const uint8_t byte) const
+	{
+		std::memcpy(dst, pairs[byte].data(), BytesPerPair);
+	}
+
+	void DrawDouble(uint8_t* dst, const uint8_t byte) const
+	{
+		std::memcpy(dst, doubled_pairs[byte].data(), BytesPerPairDouble);
+	}
+
+private:
+	std::array<uint8_t, 16> colours = {};
+
+	std::array<std::array<uint8_t, BytesPerPair>, 256> pairs = {};
+	std::array<std::array<uint8_t, BytesPerPairDouble>, 256> doubled_pairs = {};
+
+	bool is_valid = false;
+};
+
+#endif // DOSBOX_VGA_PALETTE_DRAW_H
@@ -36,6 +36,8 @@ void write_p3c5(io_port_t, io_val_t value, io_width_t)
 			val = reg.data;
 		}
 		if (val != seq(clocking_mode.data)) {
+			VGA_DrawPendingLines();
+
 			// don't resize if only the screen off bit was changed
 			if ((val & (~0x20)) != (seq(clocking_mode.data) & (~0x20))) {
 				seq(clocking_mode.data) = val;
@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_VGA_TEXT_DRAW_H
+#define DOSBOX_VGA_TEXT_DRAW_H
+
+#include <cstdint>
+
+#include "simde/x86/sse2.h"
+#include "utils/mem_unaligned.h"
+
+// Text cell expansion
+// ~~~~~~~~~~~~~~~~~~~
+// Turns one row of a character cell into 8 or 9 pixels of 32 bits, picking
+// the foreground colour where the font bit is set and the background
+// colour elsewhere. The font's bits are read from the highest one down:
+// bits 7 to 0 for 8-dot cells, and bits 8 to 0 for 9-dot cells.
+//
+// Blink, underline and the cursor only change the colours (or the row's
+// bits) handed over, so they're applied before the expansion.
+//
+// The SSE2 version, which simde maps to NEON on ARM hosts, turns the bits
+// into lane masks and blends both colours four pixels at a time. The
+// scalar version is the reference it's tested against.
+
+static inline void draw_text_cell_scalar(uint8_t* const dst, const uint16_t font,
+                                         const bool is_nine_dots,
+                                         const uint32_t fg_colour,
+                                         const uint32_t bg_colour)
+{
+	const auto num_pixels = is_nine_dots ? 9 : 8;
+	for (auto n = 0; n < num_pixels; ++n) {
+		const auto bit = (font >> (num_pixels - 1 - n)) & 1;
+		write_unaligned_uint32_at(dst, n, bit ? fg_colour : bg_colour);
+	}
+}
+
+static inline void draw_text_cell(uint8_t* const dst, const uint16_t font,
+                                  const bool is_nine_dots, const uint32_t fg_colour,
+                                  const uint32_t bg_colour)
+{
+	const auto fg = simde_mm_set1_epi32(static_cast<int32_t>(fg_colour));
+	const auto bg = simde_mm_set1_epi32(static_cast<int32_t>(bg_colour));
+
+	// The first eight pixels come from the low byte, highest bit first
+	const auto bits = simde_mm_set1_epi32(is_nine_dots ? (font >> 1) : font);
+	const auto first_bits  = simde_mm_set_epi32(0x10, 0x20, 0x40, 0x80);
+	const auto second_bits = simde_mm_set_epi32(0x01, 0x02, 0x04, 0x08);
+
+	const auto first_mask = simde_mm_cmpeq_epi32(simde_mm_and_si128(bits, first_bits),
+	                                             first_bits);
+	const auto second_mask = simde_mm_cmpeq_epi32(simde_mm_and_si128(bits, second_bits),
+	                                              second_bits);
+
+	simde_mm_storeu_si128(reinterpret_cast<simde__m128i*>(dst),
+	                      simde_mm_or_si128(simde_mm_and_si128(first_mask, fg),
+	                                        simde_mm_andnot_si128(first_mask, bg)));
+	simde_mm_storeu_si128(reinterpret_cast<simde__m128i*>(dst + 16),
+	                      simde_mm_or_si128(simde_mm_and_si128(second_mask, fg),
+	                                        simde_mm_andnot_si128(second_mask, bg)));
+
+	if (is_nine_dots) {
+		write_unaligned_uint32_at(dst, 8, (font & 1) ? fg_colour : bg_colour);
+	}
+}
+
+#endif // DOSBOX_VGA_TEXT_DRAW_H
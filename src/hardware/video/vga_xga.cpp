@@ -4,6 +4,8 @@
 
 #include "dosbox.h"
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
@@ -14,6 +16,7 @@
 #include "cpu/callback.h"
 #include "cpu/cpu.h"		// for 0x3da delay
 #include "hardware/port.h"
+#include "misc/perf_counters.h"
 #include "utils/bitops.h"
 
 constexpr auto &XGA_SCREEN_WIDTH = vga.s3.xga_screen_width;
@@ -171,6 +174,7 @@ void XGA_DrawPoint(Bitu x, Bitu y, Bitu c) {
 	        default: break;
 	}
 
+	VGA_MarkMemoryChanged();
 }
 
 static uint32_t get_point_mask()
@@ -270,6 +274,302 @@ static Bitu GetMixResult(uint32_t mixmode, Bitu srcval, Bitu dstdata)
 	return destval;
 }
 
+// Span fast paths
+// ~~~~~~~~~~~~~~~
+// The Windows 3.x S3 drivers fill, copy and pattern-fill rectangles with
+// the accelerator all the time, and drawing those a pixel at a time
+// through XGA_GetPoint(), GetMixResult() and XGA_DrawPoint() costs a mode
+// switch, bounds and scissor checks per pixel. The common cases are drawn
+// here a row at a time instead, with memset, memmove and fills:
+//
+//   - Rectangles filled with the foreground or background colour using a
+//     mix that doesn't read the destination.
+//
+//   - Screen to screen copies using the SRC mix, with no colour compare.
+//
+//   - 8x8 patterns whose mixes don't read the destination.
+//
+// The rectangle is clipped to the scissors up front. Anything else, and
+// any rectangle reaching outside video memory, takes the pixel path, as do
+// 15-bit copies, which have to clear the top bit of each pixel.
+
+static PerfCounter xga_span_commands("xga_span_commands",
+                                     "S3 accelerator commands drawn a row at a time.");
+
+// A clipped rectangle, in ascending screen coordinates
+struct XgaSpanRect {
+	Bits x1 = 0;
+	Bits y1 = 0;
+	Bits x2 = 0;
+	Bits y2 = 0;
+};
+
+static int get_bytes_per_pixel()
+{
+	switch (XGA_COLOR_MODE) {
+	case M_LIN8: return 1;
+	case M_LIN15:
+	case M_LIN16: return 2;
+	case M_LIN32: return 4;
+	default: break;
+	}
+	return 0;
+}
+
+// Whether XGA_DrawPoint() draws anything for the current command
+static bool is_command_drawing()
+{
+	return (xga.curcommand & 0x1) && (xga.curcommand & 0x10);
+}
+
+// Mixes that depend on the source alone
+constexpr bool is_mix_without_destination(const uint32_t mixmode)
+{
+	switch (mixmode & 0xf) {
+	case 0x01: // 0 (false)
+	case 0x02: // 1 (true)
+	case 0x04: // not SRC
+	case 0x07: // SRC
+		return true;
+	default: return false;
+	}
+}
+
+// The rectangle of num_x by num_y pixels starting at (x, y) and stepping
+// by dx and dy, in ascending coordinates and clipped to the scissors
+static XgaSpanRect clip_rect(const Bits x, const Bits y, const Bits dx,
+                             const Bits dy, const Bits num_x, const Bits num_y)
+{
+	XgaSpanRect rect = {};
+
+	rect.x1 = (dx > 0) ? x : x - num_x + 1;
+	rect.y1 = (dy > 0) ? y : y - num_y + 1;
+	rect.x2 = rect.x1 + num_x - 1;
+	rect.y2 = rect.y1 + num_y - 1;
+
+	rect.x1 = std::max(rect.x1, static_cast<Bits>(xga.scissors.x1));
+	rect.y1 = std::max(rect.y1, static_cast<Bits>(xga.scissors.y1));
+	rect.x2 = std::min(rect.x2, static_cast<Bits>(xga.scissors.x2));
+	rect.y2 = std::min(rect.y2, static_cast<Bits>(xga.scissors.y2));
+	return rect;
+}
+
+constexpr bool is_empty(const XgaSpanRect& rect)
+{
+	return rect.x2 < rect.x1 || rect.y2 < rect.y1;
+}
+
+// Whether the rows of the rectangle lie within the screen width and video
+// memory, so they can be drawn through a pointer
+static bool is_in_memory(const XgaSpanRect& rect)
+{
+	const auto width = static_cast<Bits>(XGA_SCREEN_WIDTH);
+	if (rect.x1 < 0 || rect.y1 < 0 || rect.x2 >= width) {
+		return false;
+	}
+	const auto end = (rect.y2 * width + rect.x2 + 1) * get_bytes_per_pixel();
+	return end <= static_cast<Bits>(vga.vmemsize);
+}
+
+static uint8_t* get_span(const Bits x, const Bits y)
+{
+	return vga.mem.linear +
+	       (y * static_cast<Bits>(XGA_SCREEN_WIDTH) + x) * get_bytes_per_pixel();
+}
+
+// Stores a run of one colour the way XGA_DrawPoint() stores a pixel
+static void fill_span(uint8_t* const dst, const Bits num_pixels, const Bitu colour)
+{
+	switch (XGA_COLOR_MODE) {
+	case M_LIN8:
+		std::memset(dst, static_cast<uint8_t>(colour), num_pixels);
+		break;
+	case M_LIN15:
+		std::fill_n(reinterpret_cast<uint16_t*>(dst),
+		            num_pixels,
+		            static_cast<uint16_t>(colour & 0x7fff));
+		break;
+	case M_LIN16:
+		std::fill_n(reinterpret_cast<uint16_t*>(dst),
+		            num_pixels,
+		            static_cast<uint16_t>(colour));
+		break;
+	case M_LIN32:
+		std::fill_n(reinterpret_cast<uint32_t*>(dst),
+		            num_pixels,
+		            static_cast<uint32_t>(colour));
+		break;
+	default: break;
+	}
+}
+
+// The source colour a mix selects, when it isn't pixel data
+static bool get_mix_colour(const uint32_t mixmode, Bitu& colour)
+{
+	switch ((mixmode >> 5) & 0x03) {
+	case 0x00: colour = xga.backcolor; return true;
+	case 0x01: colour = xga.forecolor; return true;
+	default: return false;
+	}
+}
+
+static bool fill_rect_spans(const Bits x, const Bits y, const Bits dx,
+                            const Bits dy, const Bits num_x, const Bits num_y)
+{
+	Bitu srcval = 0;
+	const auto mixselect = (xga.pix_cntl >> 6) & 0x3;
+	if (mixselect != 0x00 || !get_mix_colour(xga.foremix, srcval) ||
+	    !is_mix_without_destination(xga.foremix) || !get_bytes_per_pixel()) {
+		return false;
+	}
+	const auto rect = clip_rect(x, y, dx, dy, num_x, num_y);
+	if (is_empty(rect) || !is_command_drawing()) {
+		return true;
+	}
+	if (!is_in_memory(rect)) {
+		return false;
+	}
+
+	const auto colour = GetMixResult(xga.foremix, srcval, 0);
+	for (auto row = rect.y1; row <= rect.y2; ++row) {
+		fill_span(get_span(rect.x1, row), rect.x2 - rect.x1 + 1, colour);
+	}
+	VGA_MarkMemoryChanged();
+	xga_span_commands.Add();
+	return true;
+}
+
+static bool copy_rect_spans(const Bits dx, const Bits dy)
+{
+	using namespace bit::literals;
+
+	const auto mixselect   = (xga.pix_cntl >> 6) & 0x3;
+	const bool is_src_copy = ((xga.foremix >> 5) & 0x03) == 0x03 &&
+	                         (xga.foremix & 0xf) == 0x07;
+	const bool is_comparing = bit::is(xga.control1, b8);
+
+	// 15-bit copies would need the top bit of each pixel cleared
+	if (mixselect != 0x00 || !is_src_copy || is_comparing ||
+	    XGA_COLOR_MODE == M_LIN15 || !get_bytes_per_pixel()) {
+		return false;
+	}
+
+	const Bits num_x = xga.MAPcount + 1;
+	const Bits num_y = xga.MIPcount + 1;
+
+	const auto rect = clip_rect(xga.destx, xga.desty, dx, dy, num_x, num_y);
+	if (is_empty(rect) || !is_command_drawing()) {
+		return true;
+	}
+
+	// The source moves with the clipped destination
+	const Bits src_x1 = rect.x1 + (xga.curx - xga.destx);
+	const Bits src_y1 = rect.y1 + (xga.cury - xga.desty);
+	const XgaSpanRect src = {src_x1,
+	                         src_y1,
+	                         src_x1 + rect.x2 - rect.x1,
+	                         src_y1 + rect.y2 - rect.y1};
+	if (!is_in_memory(rect) || !is_in_memory(src)) {
+		return false;
+	}
+
+	// Copying the pixels of a row in the opposite order to the one the
+	// command asks for repeats them on the screen when the source and
+	// destination overlap; only the pixel path does that
+	if (src.y1 == rect.y1 && src.x1 != rect.x1 && (src.x1 < rect.x1) == (dx > 0) &&
+	    src.x2 >= rect.x1 && rect.x2 >= src.x1) {
+		return false;
+	}
+
+	// Rows in the order the command asks for, so overlapping copies go
+	// the way the pixel path takes them
+	const auto num_bytes = (rect.x2 - rect.x1 + 1) * get_bytes_per_pixel();
+	const auto num_rows  = rect.y2 - rect.y1 + 1;
+	for (Bits i = 0; i < num_rows; ++i) {
+		const auto row = (dy > 0) ? i : num_rows - 1 - i;
+		std::memmove(get_span(rect.x1, rect.y1 + row),
+		             get_span(src.x1, src.y1 + row),
+		             num_bytes);
+	}
+	VGA_MarkMemoryChanged();
+	xga_span_commands.Add();
+	return true;
+}
+
+static bool fill_pattern_spans(const Bits srcx, const Bits srcy,
+                               const Bits dx, const Bits dy)
+{
+	const auto mixselect = (xga.pix_cntl >> 6) & 0x3;
+	if ((mixselect != 0x00 && mixselect != 0x03) || !get_bytes_per_pixel()) {
+		return false;
+	}
+	// Which mixes the pattern can pick, and whether they need its pixels
+	bool is_using_pattern = false;
+	for (const auto mixmode : {xga.foremix, xga.backmix}) {
+		if (!is_mix_without_destination(mixmode)) {
+			return false;
+		}
+		const auto source = (mixmode >> 5) & 0x03;
+		if (source == 0x02) {
+			return false;
+		}
+		is_using_pattern |= (source == 0x03);
+		if (mixselect == 0x00) {
+			break;
+		}
+	}
+
+	const Bits num_x = xga.MAPcount + 1;
+	const Bits num_y = xga.MIPcount + 1;
+
+	const auto rect = clip_rect(xga.destx, xga.desty, dx, dy, num_x, num_y);
+	if (is_empty(rect) || !is_command_drawing()) {
+		return true;
+	}
+	const XgaSpanRect pattern = {srcx, srcy, srcx + 7, srcy + 7};
+	if (!is_in_memory(rect) || !is_in_memory(pattern)) {
+		return false;
+	}
+
+	// Drawing over the pattern would change it part way through
+	if (is_using_pattern || mixselect == 0x03) {
+		const bool is_overlapping = pattern.x1 <= rect.x2 && rect.x1 <= pattern.x2 &&
+		                            pattern.y1 <= rect.y2 && rect.y1 <= pattern.y2;
+		if (is_overlapping) {
+			return false;
+		}
+	}
+
+	std::array<Bitu, 8> colours = {};
+	for (auto row = rect.y1; row <= rect.y2; ++row) {
+		for (Bits i = 0; i < 8; ++i) {
+			const auto srcdata = XGA_GetPoint(srcx + i, srcy + (row & 0x7));
+
+			auto mixmode = xga.foremix;
+			if (mixselect == 0x03 && (srcdata & xga.readmask) != xga.readmask) {
+				mixmode = xga.backmix;
+			}
+			Bitu srcval = srcdata;
+			get_mix_colour(mixmode, srcval);
+			colours[i] = GetMixResult(mixmode, srcval, 0);
+		}
+
+		const auto dst        = get_span(rect.x1, row);
+		const auto bpp        = get_bytes_per_pixel();
+		const auto num_pixels = rect.x2 - rect.x1 + 1;
+		for (Bits i = 0; i < std::min<Bits>(8, num_pixels); ++i) {
+			fill_span(dst + i * bpp, 1, colours[(rect.x1 + i) & 0x7]);
+		}
+		// Every pixel after those repeats the one eight before it
+		for (Bits i = 8; i < num_pixels; i += 8) {
+			std::memcpy(dst + i * bpp, dst, std::min<Bits>(8, num_pixels - i) * bpp);
+		}
+	}
+	VGA_MarkMemoryChanged();
+	xga_span_commands.Add();
+	return true;
+}
+
 static void XGA_DrawLineVector(const uint32_t val, const bool skip_last_pixel)
 {
 	// No work to do with a zero-length line
@@ -532,6 +832,12 @@ static void XGA_DrawRectangle(const uint32_t val, const bool skip_last_pixel)
 	// one pixel too wide (but don't underflow below zero).
 	const auto xrun = xga.MAPcount - (xga.MAPcount && skip_last_pixel);
 
+	if (fill_rect_spans(xga.curx, srcy, dx, dy, xrun + 1, xga.MIPcount + 1)) {
+		xga.curx = static_cast<uint16_t>(xga.curx + dx * (xrun + 1));
+		xga.cury = static_cast<uint16_t>(srcy + dy * (xga.MIPcount + 1));
+		return;
+	}
+
 	for (auto yat = 0; yat <= xga.MIPcount; ++yat) {
 		srcx = xga.curx;
 		for (auto xat = 0; xat <= xrun; ++xat) {
@@ -825,6 +1131,10 @@ void XGA_BlitRect(Bitu val) {
 	if(((val >> 5) & 0x01) != 0) dx = 1;
 	if(((val >> 7) & 0x01) != 0) dy = 1;
 
+	if (copy_rect_spans(dx, dy)) {
+		return;
+	}
+
 	colorcmpdata = xga.color_compare & get_point_mask();
 
 	Bitu mixselect = (xga.pix_cntl >> 6) & 0x3;
@@ -941,6 +1251,10 @@ void XGA_DrawPattern(Bitu val) {
 
 	tary = xga.desty;
 
+	if (fill_pattern_spans(srcx, srcy, dx, dy)) {
+		return;
+	}
+
 	Bitu mixselect = (xga.pix_cntl >> 6) & 0x3;
 	uint32_t mixmode = 0x67; /* Source is bitmap data, mix mode is src */
 	switch (mixselect) {
@@ -67,6 +67,9 @@
 #include <cstdlib>
 #include <cstring>
 #include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <SDL.h>
 #include <SDL_cpuinfo.h> // for proper SSE defines for MSVC
@@ -82,6 +85,7 @@
 #include "hardware/pci_bus.h"
 #include "hardware/pic.h"
 #include "misc/cross.h"
+#include "misc/perf_counters.h"
 #include "misc/support.h"
 #include "simde/x86/sse2.h"
 #include "utils/bitops.h"
@@ -719,11 +723,52 @@ struct ncc_table
 	int32_t				y[16];					/* Y values */
 	rgb_t *				palette;				/* pointer to associated RGB palette */
 	rgb_t *				palettea;				/* pointer to associated ARGB palette */
+	uint32_t *			lookup_serial;			/* pointer to the TMU's texture cache lookup serial */
 	rgb_t				texel[256];				/* texel lookup */
 };
 
 using mem_buffer_t = std::unique_ptr<uint8_t[]>;
 
+// Converted textures
+// ~~~~~~~~~~~~~~~~~~
+// The rasteriser doesn't decode texels from their guest format on every
+// fetch: each texture is expanded once to ARGB8888, with every LOD at a
+// known offset, so the inner loop only does an indexed load and filter.
+// Textures are keyed by where they start in texture RAM and how they're
+// laid out. One is converted again once the RAM pages it was read from
+// have been written, or the palette or NCC table it went through changed;
+// the least recently used are dropped to stay within the budget.
+struct converted_texture
+{
+	std::vector<rgb_t>	texels;					/* ARGB8888 texels of every LOD */
+	uint32_t			lodoffset[17];			/* texel offset of each LOD; out-of-range LODs past 8 read LOD 8 */
+
+	std::vector<std::pair<uint32_t, uint32_t>> pages;	/* texture RAM pages read, with their serials then */
+	uint32_t			ram_serial;				/* the RAM serial when the pages were last checked */
+	bool				uses_lookup;			/* converted through the palette or an NCC table? */
+	uint32_t			lookup_serial;			/* the lookup serial when converted */
+	uint64_t			last_used;				/* when a triangle last selected it */
+};
+
+struct texture_cache
+{
+	enum { page_shift = 12, max_texels = 4 * 1024 * 1024 };
+
+	std::unordered_map<uint64_t, converted_texture> textures;	/* converted textures by layout */
+	size_t				num_texels;				/* texels held by all of them */
+	uint64_t			clock;					/* counts texture selections */
+
+	std::vector<uint32_t> page_serials;			/* write serial of each texture RAM page */
+	uint32_t			ram_serial;				/* bumped on any texture RAM write */
+	uint32_t			lookup_serial;			/* bumped when the palette or NCC tables change */
+
+	void ram_written(const uint32_t address)
+	{
+		++page_serials[address >> page_shift];
+		++ram_serial;
+	}
+};
+
 struct tmu_state
 {
 	uint8_t*				ram;					/* pointer to aligned RAM */
@@ -764,6 +809,9 @@ struct tmu_state
 
 	rgb_t				palette[256];			/* palette lookup table */
 	rgb_t				palettea[256];			/* palette+alpha lookup table */
+
+	texture_cache		texcache;				/* converted textures */
+	const converted_texture * texture;			/* currently selected converted texture */
 };
 
 struct tmu_shared_state
@@ -892,6 +940,12 @@ struct draw_state {
 	bool screen_update_pending   = false;
 };
 
+struct voodoo_state;
+
+using raster_generic_f = void (*)(const voodoo_state* vs, uint32_t TEXMODE0,
+                                  uint32_t TEXMODE1, void* destbase, int32_t y,
+                                  const poly_extent* extent, stats_block& stats);
+
 struct triangle_worker
 {
 	triangle_worker(const int num_threads_)
@@ -917,6 +971,10 @@ struct triangle_worker
 
 	uint16_t* drawbuf = {};
 
+	raster_generic_f rasteriser = nullptr;
+	uint32_t texmode0           = 0;
+	uint32_t texmode1           = 0;
+
 	poly_vertex v1 = {};
 	poly_vertex v2 = {};
 	poly_vertex v3 = {};
@@ -1917,7 +1975,7 @@ while (0)
  *
  *************************************/
 
-#define TEXTURE_PIPELINE(TT, XX, DITHER4, TEXMODE, COTHER, LOOKUP, LODBASE, ITERS, ITERT, ITERW, RESULT) \
+#define TEXTURE_PIPELINE(TT, XX, DITHER4, TEXMODE, COTHER, TEXTURE, LODBASE, ITERS, ITERT, ITERW, RESULT) \
 do																				\
 {																				\
 	int32_t blendr, blendg, blendb, blenda;										\
@@ -1963,7 +2021,7 @@ do																				\
 		ilod++;																	\
 																				\
 	/* fetch the texture base */												\
-	texbase = (TT)->lodoffset[ilod];											\
+	texbase = (TEXTURE)->lodoffset[ilod];										\
 																				\
 	/* compute the maximum s and t values at this LOD */						\
 	smax = (TT)->wmask >> ilod;													\
@@ -1975,7 +2033,6 @@ do																				\
 	{																			\
 		/* point sampled */														\
 																				\
-		uint32_t texel0;															\
 																				\
 		/* adjust S/T for the LOD and strip off the fractions */				\
 		s >>= ilod + 18;														\
@@ -1990,21 +2047,8 @@ do																				\
 		t &= tmax;																\
 		t *= smax + 1;															\
 																				\
-		/* fetch texel data */													\
-		if (TEXMODE_FORMAT(TEXMODE) < 8)										\
-		{																		\
-			texel0 = (TT)->ram[(texbase + t + s) & (TT)->mask];					\
-			c_local.u = (LOOKUP)[texel0];										\
-		}																		\
-		else																	\
-		{																		\
-			texel0 = *(uint16_t *)&(TT)->ram[(texbase + 2*(t + s)) & (TT)->mask];	\
-			if (TEXMODE_FORMAT(TEXMODE) >= 10 && TEXMODE_FORMAT(TEXMODE) <= 12)	\
-				c_local.u = (LOOKUP)[texel0];									\
-			else																\
-				c_local.u = ((LOOKUP)[texel0 & 0xff] & 0xffffff) |				\
-							((texel0 & 0xff00) << 16);							\
-		}																		\
+		/* fetch the converted texel */											\
+		c_local.u = (TEXTURE)->texels[texbase + t + s];							\
 	}																			\
 	else																		\
 	{																			\
@@ -2051,43 +2095,11 @@ do																				\
 		t *= smax + 1;															\
 		t1 *= smax + 1;															\
 																				\
-		/* fetch texel data */													\
-		if (TEXMODE_FORMAT(TEXMODE) < 8)										\
-		{																		\
-			texel0 = (TT)->ram[(texbase + t + s) & (TT)->mask];					\
-			texel1 = (TT)->ram[(texbase + t + s1) & (TT)->mask];				\
-			texel2 = (TT)->ram[(texbase + t1 + s) & (TT)->mask];				\
-			texel3 = (TT)->ram[(texbase + t1 + s1) & (TT)->mask];				\
-			texel0 = (LOOKUP)[texel0];											\
-			texel1 = (LOOKUP)[texel1];											\
-			texel2 = (LOOKUP)[texel2];											\
-			texel3 = (LOOKUP)[texel3];											\
-		}																		\
-		else																	\
-		{																		\
-			texel0 = *(uint16_t *)&(TT)->ram[(texbase + 2*(t + s)) & (TT)->mask];	\
-			texel1 = *(uint16_t *)&(TT)->ram[(texbase + 2*(t + s1)) & (TT)->mask];\
-			texel2 = *(uint16_t *)&(TT)->ram[(texbase + 2*(t1 + s)) & (TT)->mask];\
-			texel3 = *(uint16_t *)&(TT)->ram[(texbase + 2*(t1 + s1)) & (TT)->mask];\
-			if (TEXMODE_FORMAT(TEXMODE) >= 10 && TEXMODE_FORMAT(TEXMODE) <= 12)	\
-			{																	\
-				texel0 = (LOOKUP)[texel0];										\
-				texel1 = (LOOKUP)[texel1];										\
-				texel2 = (LOOKUP)[texel2];										\
-				texel3 = (LOOKUP)[texel3];										\
-			}																	\
-			else																\
-			{																	\
-				texel0 = ((LOOKUP)[texel0 & 0xff] & 0xffffff) | 				\
-							((texel0 & 0xff00) << 16);							\
-				texel1 = ((LOOKUP)[texel1 & 0xff] & 0xffffff) | 				\
-							((texel1 & 0xff00) << 16);							\
-				texel2 = ((LOOKUP)[texel2 & 0xff] & 0xffffff) | 				\
-							((texel2 & 0xff00) << 16);							\
-				texel3 = ((LOOKUP)[texel3 & 0xff] & 0xffffff) | 				\
-							((texel3 & 0xff00) << 16);							\
-			}																	\
-		}																		\
+		/* fetch the converted texels */										\
+		texel0 = (TEXTURE)->texels[texbase + t + s];							\
+		texel1 = (TEXTURE)->texels[texbase + t + s1];							\
+		texel2 = (TEXTURE)->texels[texbase + t1 + s];							\
+		texel3 = (TEXTURE)->texels[texbase + t1 + s1];							\
 																				\
 		/* weigh in each texel */												\
 		c_local.u = rgba_bilinear_filter(texel0, texel1, texel2, texel3, sfrac, tfrac);\
@@ -3042,13 +3054,87 @@ static double Voodoo_GetHRetracePosition();
     RASTERIZER MANAGEMENT
 ***************************************************************************/
 
-static dither_lut_t dither2_lookup = {};
-static dither_lut_t dither4_lookup = {};
+static constexpr dither_lut_t dither2_lookup = generate_dither_lut(dither_matrix_2x2);
+static constexpr dither_lut_t dither4_lookup = generate_dither_lut(dither_matrix_4x4);
+
+// Specialised rasterisers
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// raster_generic() handles every register combination, so its pixel loop
+// is full of checks on registers that stay put for the whole triangle. It
+// is instantiated once for each combination of the features that gate the
+// largest stages of the pipeline: the number of TMUs, depth buffering,
+// alpha blending and fogging. Within each, those register bits are pinned
+// to constants, so the compiler drops the stages switched off and the
+// checks for them; everything else is still read from the registers.
+//
+// On top of those, the register combinations games use the most get
+// rasterisers with the whole fbzColorPath, fbzMode, alphaMode, fogMode and
+// TMU0 textureMode registers pinned, which folds away every mode check in
+// the loop. Each triangle runs the fully specialised rasteriser matching
+// its registers if there is one, or else the one for its features. MAME's
+// Voodoo keys its rasterisers on register values the same way.
+//
+// The combinations that fall back the most are counted, and listed in the
+// debug log on shutdown in the form the table below takes, to show which
+// ones are worth adding.
+
+constexpr uint32_t RasterKeyTmuMask     = 0b0011;
+constexpr uint32_t RasterKeyDepthBuffer = 0b0100;
+constexpr uint32_t RasterKeyAlphaBlend  = 0b1000;
+constexpr uint32_t RasterKeyFog         = 0b1'0000;
+constexpr uint32_t NumRasterKeys        = 0b10'0000;
+
+static constexpr uint32_t get_raster_key(const uint32_t tmus, const uint32_t r_fbzMode,
+                                         const uint32_t r_alphaMode,
+                                         const uint32_t r_fogMode)
+{
+	auto key = tmus;
+	if (FBZMODE_ENABLE_DEPTHBUF(r_fbzMode)) {
+		key |= RasterKeyDepthBuffer;
+	}
+	if (ALPHAMODE_ALPHABLEND(r_alphaMode)) {
+		key |= RasterKeyAlphaBlend;
+	}
+	if (FOGMODE_ENABLE_FOG(r_fogMode)) {
+		key |= RasterKeyFog;
+	}
+	return key;
+}
 
-static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_t TEXMODE0,
-                                  uint32_t TEXMODE1, void* destbase, int32_t y,
-                                  const poly_extent* extent, stats_block& stats)
+// Sets the register's bits in the mask if the key has the feature, and
+// clears them otherwise
+static constexpr uint32_t pin_register_bits(const uint32_t value, const uint32_t mask,
+                                            const bool is_set)
 {
+	return is_set ? (value | mask) : (value & ~mask);
+}
+
+// The registers a rasteriser can be fully specialised on
+struct RasterModes {
+	uint32_t tmus           = 0;
+	uint32_t fbz_color_path = 0;
+	uint32_t fbz_mode       = 0;
+	uint32_t alpha_mode     = 0;
+	uint32_t fog_mode       = 0;
+	uint32_t tex_mode_0     = 0;
+
+	constexpr bool operator==(const RasterModes&) const = default;
+};
+
+// The rasterisers don't use the draw buffer selection in fbzMode, and read
+// the alpha test reference from the register itself, so these bits can
+// differ between triangles sharing a rasteriser
+constexpr uint32_t RasterFbzModeMask   = ~(3u << 14);
+constexpr uint32_t RasterAlphaModeMask = 0x00ff'ffff;
+
+template <uint32_t RasterKey, bool HasFixedModes = false, RasterModes FixedModes = RasterModes{}>
+static void raster_generic(const voodoo_state* vs, uint32_t TEXMODE0,
+                           uint32_t TEXMODE1, void* destbase, int32_t y,
+                           const poly_extent* extent, stats_block& stats)
+{
+	constexpr uint32_t TMUS = RasterKey & RasterKeyTmuMask;
+	static_assert(TMUS <= 2);
+
 	const uint8_t* dither_lookup = nullptr;
 	const uint8_t* dither4       = nullptr;
 	const uint8_t* dither        = nullptr;
@@ -3063,11 +3149,28 @@ static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_
 	const auto& tmu0 = vs->tmu[0];
 	const auto& tmu1 = vs->tmu[1];
 
-	const uint32_t r_fbzColorPath = regs[fbzColorPath].u;
-	const uint32_t r_fbzMode      = regs[fbzMode].u;
-	const uint32_t r_alphaMode    = regs[alphaMode].u;
-	const uint32_t r_fogMode      = regs[fogMode].u;
-	const uint32_t r_zaColor      = regs[zaColor].u;
+	const uint32_t r_fbzColorPath = HasFixedModes ? FixedModes.fbz_color_path
+	                                              : regs[fbzColorPath].u;
+	const uint32_t r_fbzMode =
+	        HasFixedModes ? FixedModes.fbz_mode | (regs[fbzMode].u & ~RasterFbzModeMask)
+	                      : pin_register_bits(regs[fbzMode].u,
+	                                          1 << 4, // depth buffer
+	                                          RasterKey & RasterKeyDepthBuffer);
+	const uint32_t r_alphaMode =
+	        HasFixedModes
+	                ? FixedModes.alpha_mode | (regs[alphaMode].u & ~RasterAlphaModeMask)
+	                : pin_register_bits(regs[alphaMode].u,
+	                                    1 << 4, // alpha blending
+	                                    RasterKey & RasterKeyAlphaBlend);
+	const uint32_t r_fogMode = HasFixedModes ? FixedModes.fog_mode
+	                                         : pin_register_bits(regs[fogMode].u,
+	                                                             1 << 0, // fog
+	                                                             RasterKey & RasterKeyFog);
+	const uint32_t r_zaColor = regs[zaColor].u;
+
+	if constexpr (HasFixedModes) {
+		TEXMODE0 = FixedModes.tex_mode_0;
+	}
 
 	uint32_t r_stipple = regs[stipple].u;
 
@@ -3168,9 +3271,8 @@ static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_
 
 		if (TMUS >= 2 && vs->tmu[1].lodmin < (8 << 8)) {
 			const tmu_state* const tmus = &vs->tmu[1];
-			const rgb_t* const lookup = tmus->lookup;
 			TEXTURE_PIPELINE(tmus, x, dither4, TEXMODE1, texel,
-								lookup, tmus->lodbasetemp,
+								tmus->texture, tmus->lodbasetemp,
 								iters1, itert1, iterw1, texel);
 		}
 
@@ -3180,9 +3282,8 @@ static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_
 		if (TMUS >= 1 && tmu0.lodmin < (8 << 8)) {
 			if (!vs->send_config) {
 				const tmu_state* const tmus = &tmu0;
-				const rgb_t* const lookup = tmus->lookup;
 				TEXTURE_PIPELINE(tmus, x, dither4, TEXMODE0, texel,
-								lookup, tmus->lodbasetemp,
+								tmus->texture, tmus->lodbasetemp,
 								iters0, itert0, iterw0, texel);
 			} else {	/* send config data to the frame buffer */
 				texel.u=vs->tmu_config;
@@ -3455,6 +3556,133 @@ static inline void raster_generic(const voodoo_state* vs, uint32_t TMUS, uint32_
 	}
 }
 
+template <uint32_t... RasterKeys>
+static constexpr std::array<raster_generic_f, NumRasterKeys> make_rasterisers(
+        std::integer_sequence<uint32_t, RasterKeys...>)
+{
+	// There's no third TMU, so those keys are never looked up; they share
+	// the two-TMU rasterisers rather than adding more
+	return {&raster_generic<std::min(RasterKeys & RasterKeyTmuMask, 2u) |
+	                        (RasterKeys & ~RasterKeyTmuMask)>...};
+}
+
+static constexpr auto rasterisers = make_rasterisers(
+        std::make_integer_sequence<uint32_t, NumRasterKeys>{});
+
+// The table starts out with the setups Glide's combine functions program
+// for plain gouraud shading and for modulated textures. Add to it from the
+// fallbacks listed in the debug log.
+
+// The iterated colour passed through, with subpixel correction on
+constexpr uint32_t ColorPathIterated = (1 << 26);
+
+// Texture colour and alpha scaled by the iterated ones
+constexpr uint32_t ColorPathModulate = (1 << 0) | (1 << 2) |   // other: texture
+                                       (1 << 10) | (1 << 13) | // scale by local colour
+                                       (1 << 19) | (1 << 22) | // scale by local alpha
+                                       (1 << 26) | (1 << 27);  // subpixel, texturing
+
+// Depth tested as less than, dithered, and written to both buffers, with
+// clipping on
+constexpr uint32_t FbzModeDepthLess = (1 << 0) | (1 << 4) | (1 << 5) | (1 << 8) |
+                                     (1 << 9) | (1 << 10);
+constexpr uint32_t FbzModeNoDepth   = (1 << 0) | (1 << 8) | (1 << 9);
+
+// TMU0 passing its own texel through, perspective correct and filtered
+constexpr uint32_t TexModeRgb565   = 0x0000'0007 | (0xa << 8) | (1 << 12) | (1 << 18) |
+                                   (1 << 21) | (1 << 27);
+constexpr uint32_t TexModeArgb4444 = (TexModeRgb565 & ~(0xfu << 8)) | (0xc << 8);
+
+constexpr std::array SpecialisedRasterModes = {
+        RasterModes{0, ColorPathIterated, FbzModeDepthLess, 0, 0, 0},
+        RasterModes{0, ColorPathIterated, FbzModeNoDepth, 0, 0, 0},
+        RasterModes{1, ColorPathModulate, FbzModeDepthLess, 0, 0, TexModeRgb565},
+        RasterModes{2, ColorPathModulate, FbzModeDepthLess, 0, 0, TexModeRgb565},
+        RasterModes{1, ColorPathModulate, FbzModeDepthLess, 0, 0, TexModeArgb4444},
+        RasterModes{2, ColorPathModulate, FbzModeDepthLess, 0, 0, TexModeArgb4444},
+};
+
+template <size_t... Indices>
+static constexpr auto make_specialised_rasterisers(std::index_sequence<Indices...>)
+{
+	constexpr auto& m = SpecialisedRasterModes;
+	return std::array<raster_generic_f, sizeof...(Indices)>{
+	        &raster_generic<get_raster_key(m[Indices].tmus,
+	                                       m[Indices].fbz_mode,
+	                                       m[Indices].alpha_mode,
+	                                       m[Indices].fog_mode),
+	                        true,
+	                        m[Indices]>...};
+}
+
+static constexpr auto specialised_rasterisers = make_specialised_rasterisers(
+        std::make_index_sequence<SpecialisedRasterModes.size()>{});
+
+static PerfCounter voodoo_triangles_specialised(
+        "voodoo_triangles_specialised",
+        "Voodoo triangles drawn by a fully specialised rasteriser.");
+static PerfCounter voodoo_triangles_generic(
+        "voodoo_triangles_generic",
+        "Voodoo triangles drawn by a rasteriser keyed on their features only.");
+
+struct RasterModesHash {
+	size_t operator()(const RasterModes& m) const
+	{
+		auto hash = std::hash<uint32_t>{}(m.tmus);
+		for (const auto value : {m.fbz_color_path, m.fbz_mode, m.alpha_mode, m.fog_mode, m.tex_mode_0}) {
+			hash = hash * 31 + std::hash<uint32_t>{}(value);
+		}
+		return hash;
+	}
+};
+
+// Triangles drawn per combination that fell back to the feature-keyed
+// rasterisers, for up to MaxCountedRasterModes combinations; only the
+// emulation thread touches it
+static std::unordered_map<RasterModes, uint64_t, RasterModesHash> generic_raster_hits = {};
+constexpr size_t MaxCountedRasterModes = 1024;
+
+static raster_generic_f select_rasteriser(const RasterModes& modes)
+{
+	for (size_t i = 0; i < SpecialisedRasterModes.size(); ++i) {
+		if (SpecialisedRasterModes[i] == modes) {
+			voodoo_triangles_specialised.Add();
+			return specialised_rasterisers[i];
+		}
+	}
+	voodoo_triangles_generic.Add();
+	if (const auto it = generic_raster_hits.find(modes); it != generic_raster_hits.end()) {
+		++it->second;
+	} else if (generic_raster_hits.size() < MaxCountedRasterModes) {
+		generic_raster_hits.emplace(modes, 1);
+	}
+
+	return rasterisers[get_raster_key(modes.tmus, modes.fbz_mode, modes.alpha_mode, modes.fog_mode)];
+}
+
+static void log_generic_raster_hits()
+{
+	std::vector<std::pair<RasterModes, uint64_t>> hits(generic_raster_hits.begin(),
+	                                                  generic_raster_hits.end());
+	std::sort(hits.begin(), hits.end(), [](const auto& a, const auto& b) {
+		return a.second > b.second;
+	});
+
+	constexpr size_t MaxLoggedModes = 8;
+	for (size_t i = 0; i < std::min(hits.size(), MaxLoggedModes); ++i) {
+		const auto& [m, triangles] = hits[i];
+		LOG_DEBUG("VOODOO: %llu triangles fell back from RasterModes{%u, 0x%08x, 0x%08x, 0x%08x, 0x%08x, 0x%08x}",
+		          static_cast<unsigned long long>(triangles),
+		          m.tmus,
+		          m.fbz_color_path,
+		          m.fbz_mode,
+		          m.alpha_mode,
+		          m.fog_mode,
+		          m.tex_mode_0);
+	}
+	generic_raster_hits.clear();
+}
+
 #ifdef C_ENABLE_VOODOO_OPENGL
 /*-------------------------------------------------
     add_rasterizer - add a rasterizer to our
@@ -3790,6 +4018,13 @@ static void init_tmu(voodoo_state *vs, tmu_state *t, voodoo_reg *reg, int tmem)
 	/* attach the palette to NCC table 0 */
 	t->ncc[0].palette = t->palette;
 	t->ncc[0].palettea = (vtype >= VOODOO_2) ? t->palettea : nullptr;
+	t->ncc[0].lookup_serial = t->ncc[1].lookup_serial = &t->texcache.lookup_serial;
+
+	/* start without converted textures */
+	t->texcache.textures.clear();
+	t->texcache.num_texels = 0;
+	t->texcache.page_serials.assign((tmem >> texture_cache::page_shift) + 1, 0);
+	t->texture = nullptr;
 
 	///* set up texture address calculations */
 	//t->texaddr_mask = 0x0fffff;
@@ -3969,6 +4204,7 @@ static void ncc_table_write(ncc_table *n, uint32_t regnum, uint32_t data)
 		if (n->palette[index] != palette_entry) {
 			/* set the ARGB for this palette index */
 			n->palette[index] = palette_entry;
+			++*n->lookup_serial;
 #ifdef C_ENABLE_VOODOO_OPENGL
 			v->ogl_palette_changed = true;
 #endif
@@ -3989,7 +4225,11 @@ static void ncc_table_write(ncc_table *n, uint32_t regnum, uint32_t data)
 			const uint32_t b = ((data << 2) & 0xfc) |
 			                   ((data >> 4) & 0x03);
 
-			n->palettea[index] = MAKE_ARGB(a, r, g, b);
+			const rgb_t palettea_entry = MAKE_ARGB(a, r, g, b);
+			if (n->palettea[index] != palettea_entry) {
+				n->palettea[index] = palettea_entry;
+				++*n->lookup_serial;
+			}
 		}
 
 		/* this doesn't dirty the table or go to the registers, so bail */
@@ -4213,6 +4453,155 @@ static void recompute_texture_params(tmu_state *t)
 	//	E_Exit("Separate RGBA filters!"); // voodoo 2 feature not implemented
 }
 
+/*************************************
+ *
+ *  Texture conversion
+ *
+ *************************************/
+
+/* palettised and YIQ formats go through the palette or an NCC table */
+static bool texture_format_uses_lookup(uint32_t format)
+{
+	return format == 1 || format == 5 || format == 6 || format == 9 || format == 14;
+}
+
+/* the layout of the current texture: everything the conversion depends on */
+/* other than the texel data and the lookup contents */
+static uint64_t texture_cache_key(const tmu_state *t)
+{
+	const uint32_t format = TEXMODE_FORMAT(t->reg[textureMode].u);
+	const uint32_t ncc = texture_format_uses_lookup(format)
+	                           ? TEXMODE_NCC_TABLE_SELECT(t->reg[textureMode].u)
+	                           : 0;
+	return (uint64_t)t->lodoffset[0] |
+	       ((uint64_t)format << 32) | ((uint64_t)ncc << 36) |
+	       ((uint64_t)t->wmask << 37) | ((uint64_t)t->hmask << 45) |
+	       ((uint64_t)t->lodmask << 53);
+}
+
+static bool converted_texture_is_current(tmu_state *t, converted_texture *texture)
+{
+	texture_cache &cache = t->texcache;
+
+	if (texture->uses_lookup && texture->lookup_serial != cache.lookup_serial) {
+		return false;
+	}
+	if (texture->ram_serial != cache.ram_serial)
+	{
+		for (const auto &[page, serial] : texture->pages) {
+			if (cache.page_serials[page] != serial) {
+				return false;
+			}
+		}
+		texture->ram_serial = cache.ram_serial;
+	}
+	return true;
+}
+
+/* expands every LOD of the current texture, fetching each texel as the */
+/* texture pipeline would from texture RAM */
+static void convert_texture(tmu_state *t, converted_texture *texture)
+{
+	texture_cache &cache = t->texcache;
+
+	const uint32_t format = TEXMODE_FORMAT(t->reg[textureMode].u);
+	const rgb_t *lookup = t->lookup;
+	const uint8_t *ram = t->ram;
+
+	cache.num_texels -= texture->texels.size();
+	texture->texels.clear();
+	texture->pages.clear();
+
+	for (int lod = 0; lod <= 8; lod++)
+	{
+		const uint32_t width = (t->wmask >> lod) + 1;
+		const uint32_t height = (t->hmask >> lod) + 1;
+		const uint32_t base = t->lodoffset[lod];
+		const uint32_t bpp = (format < 8) ? 1 : 2;
+
+		texture->lodoffset[lod] = (uint32_t)texture->texels.size();
+
+		for (uint32_t i = 0; i < width * height; i++)
+		{
+			const uint32_t address = (base + bpp * i) & t->mask;
+			rgb_t texel = 0;
+			if (lookup == nullptr) {
+				/* no lookup for reserved formats */
+			} else if (format < 8) {
+				texel = lookup[ram[address]];
+			} else {
+				const uint32_t data = *(const uint16_t *)&ram[address];
+				if (format >= 10 && format <= 12) {
+					texel = lookup[data];
+				} else {
+					texel = (lookup[data & 0xff] & 0xffffff) | ((data & 0xff00) << 16);
+				}
+			}
+			texture->texels.push_back(texel);
+		}
+
+		/* note the pages this LOD was read from, wrapping as the fetches do */
+		const uint32_t num_pages = ((base & ((1 << texture_cache::page_shift) - 1)) +
+		                            bpp * width * height - 1) >> texture_cache::page_shift;
+		for (uint32_t page = 0; page <= num_pages; page++)
+		{
+			const uint32_t address = (base + (page << texture_cache::page_shift)) & t->mask;
+			texture->pages.emplace_back(address >> texture_cache::page_shift, 0);
+		}
+	}
+
+	/* the pipeline can step past LOD 8 when the LOD registers are out of range */
+	for (int lod = 9; lod < 17; lod++) {
+		texture->lodoffset[lod] = texture->lodoffset[8];
+	}
+
+	std::sort(texture->pages.begin(), texture->pages.end());
+	texture->pages.erase(std::unique(texture->pages.begin(), texture->pages.end()),
+	                     texture->pages.end());
+	for (auto &[page, serial] : texture->pages) {
+		serial = cache.page_serials[page];
+	}
+	texture->ram_serial = cache.ram_serial;
+	texture->uses_lookup = texture_format_uses_lookup(format);
+	texture->lookup_serial = cache.lookup_serial;
+
+	cache.num_texels += texture->texels.size();
+}
+
+/* drops the least recently used textures, other than 'keep', until the */
+/* cache is within its budget */
+static void trim_texture_cache(texture_cache *cache, const converted_texture *keep)
+{
+	while (cache->num_texels > texture_cache::max_texels && cache->textures.size() > 1)
+	{
+		auto oldest = cache->textures.end();
+		for (auto it = cache->textures.begin(); it != cache->textures.end(); ++it) {
+			if (&it->second != keep &&
+			    (oldest == cache->textures.end() || it->second.last_used < oldest->second.last_used)) {
+				oldest = it;
+			}
+		}
+		cache->num_texels -= oldest->second.texels.size();
+		cache->textures.erase(oldest);
+	}
+}
+
+static void select_texture(tmu_state *t)
+{
+	texture_cache &cache = t->texcache;
+
+	auto [it, inserted] = cache.textures.try_emplace(texture_cache_key(t));
+	converted_texture *texture = &it->second;
+
+	if (inserted || !converted_texture_is_current(t, texture))
+	{
+		convert_texture(t, texture);
+		trim_texture_cache(&cache, texture);
+	}
+	texture->last_used = ++cache.clock;
+	t->texture = texture;
+}
+
 static void prepare_tmu(tmu_state *t)
 {
 	int64_t texdx;
@@ -4231,10 +4620,16 @@ static void prepare_tmu(tmu_state *t)
 			t->texel[1] = t->texel[9] = n->texel;
 			if (n->dirty) {
 				ncc_table_update(n);
+				++t->texcache.lookup_serial;
 			}
 		}
 	}
 
+	/* pick up the converted texture, unless the TMU is disabled */
+	if (t->lodmin < (8 << 8)) {
+		select_texture(t);
+	}
+
 	/* compute (ds^2 + dt^2) in both X and Y as 28.36 numbers */
 	texdx = (t->dsdx >> 14) * (t->dsdx >> 14) + (t->dtdx >> 14) * (t->dtdx >> 14);
 	texdy = (t->dsdy >> 14) * (t->dsdy >> 14) + (t->dtdy >> 14) * (t->dtdy >> 14);
@@ -4321,26 +4716,6 @@ static void update_statistics(voodoo_state *vs, bool accumulate)
 static void triangle_worker_work(const triangle_worker& tworker,
                                  const int32_t work_start, const int32_t work_end)
 {
-	/* determine the number of TMUs involved */
-	uint32_t tmus     = 0;
-	uint32_t texmode0 = 0;
-	uint32_t texmode1 = 0;
-	if (!FBIINIT3_DISABLE_TMUS(v->reg[fbiInit3].u) && FBZCP_TEXTURE_ENABLE(v->reg[fbzColorPath].u))
-	{
-		tmus = 1;
-		texmode0 = v->tmu[0].reg[textureMode].u;
-		if ((v->chipmask & 0x04) != 0)
-		{
-			tmus = 2;
-			texmode1 = v->tmu[1].reg[textureMode].u;
-		}
-		if (tworker.disable_bilinear_filter) //force disable bilinear filter
-		{
-			texmode0 &= ~6;
-			texmode1 &= ~6;
-		}
-	}
-
 	/* compute the slopes for each portion of the triangle */
 	const poly_vertex v1 = tworker.v1;
 	const poly_vertex v2 = tworker.v2;
@@ -4353,6 +4728,9 @@ static void triangle_worker_work(const triangle_worker& tworker,
 	const float dxdy_v2v3 = (v3.y == v2.y) ? 0.0f
 	                                       : (v3.x - v2.x) / (v3.y - v2.y);
 
+	const auto rasteriser = tworker.rasteriser;
+	assert(rasteriser);
+
 	stats_block my_stats = {};
 
 	// The number of workers represents the total work, while the start and
@@ -4405,7 +4783,7 @@ static void triangle_worker_work(const triangle_worker& tworker,
 			extent.stopx -= (sumpix - to);
 		}
 
-		raster_generic(v, tmus, texmode0, texmode1, tworker.drawbuf, curscan, &extent, my_stats);
+		rasteriser(v, tworker.texmode0, tworker.texmode1, tworker.drawbuf, curscan, &extent, my_stats);
 	}
 	sum_statistics(&v->thread_stats[work_start], &my_stats);
 }
@@ -4768,6 +5146,34 @@ static void triangle(voodoo_state *vs)
 	}
 
 	triangle_worker& tworker = vs->tworker;
+
+	/* determine the number of TMUs involved */
+	RasterModes modes = {};
+	uint32_t texmode1 = 0;
+	if (!FBIINIT3_DISABLE_TMUS(regs[fbiInit3].u) && FBZCP_TEXTURE_ENABLE(regs[fbzColorPath].u))
+	{
+		modes.tmus = 1;
+		modes.tex_mode_0 = vs->tmu[0].reg[textureMode].u;
+		if ((vs->chipmask & 0x04) != 0)
+		{
+			modes.tmus = 2;
+			texmode1 = vs->tmu[1].reg[textureMode].u;
+		}
+		if (tworker.disable_bilinear_filter) //force disable bilinear filter
+		{
+			modes.tex_mode_0 &= ~6;
+			texmode1 &= ~6;
+		}
+	}
+	modes.fbz_color_path = regs[fbzColorPath].u;
+	modes.fbz_mode       = regs[fbzMode].u & RasterFbzModeMask;
+	modes.alpha_mode     = regs[alphaMode].u & RasterAlphaModeMask;
+	modes.fog_mode       = regs[fogMode].u;
+
+	tworker.rasteriser = select_rasteriser(modes);
+	tworker.texmode0   = modes.tex_mode_0;
+	tworker.texmode1   = texmode1;
+
 	tworker.v1 = *v1, tworker.v2 = *v2, tworker.v3 = *v3;
 	tworker.drawbuf = drawbuf;
 	tworker.v1y = v1y;
@@ -6739,7 +7145,7 @@ static int32_t texture_w(uint32_t offset, uint32_t data) {
 		dest = t->ram;
 		tbaseaddr &= t->mask;
 
-		[[maybe_unused]] bool changed = false;
+		bool changed = false;
 		if (dest[BYTE4_XOR_LE(tbaseaddr + 0)] != ((data >> 0) & 0xff)) {
 			dest[BYTE4_XOR_LE(tbaseaddr + 0)] = static_cast<uint8_t>((data >> 0) & 0xff);
 			changed = true;
@@ -6756,6 +7162,9 @@ static int32_t texture_w(uint32_t offset, uint32_t data) {
 			dest[BYTE4_XOR_LE(tbaseaddr + 3)] = static_cast<uint8_t>((data >> 24) & 0xff);
 			changed = true;
 		}
+		if (changed) {
+			t->texcache.ram_written(tbaseaddr);
+		}
 
 #ifdef C_ENABLE_VOODOO_OPENGL
 		if (changed && v->ogl && v->active) {
@@ -6801,7 +7210,7 @@ static int32_t texture_w(uint32_t offset, uint32_t data) {
 		tbaseaddr &= t->mask;
 		tbaseaddr >>= 1;
 
-		[[maybe_unused]] bool changed = false;
+		bool changed = false;
 		if (dest[BYTE_XOR_LE(tbaseaddr + 0)] != ((data >> 0) & 0xffff)) {
 			dest[BYTE_XOR_LE(tbaseaddr + 0)] = static_cast<uint16_t>((data >> 0) & 0xffff);
 			changed = true;
@@ -6810,6 +7219,9 @@ static int32_t texture_w(uint32_t offset, uint32_t data) {
 			dest[BYTE_XOR_LE(tbaseaddr + 1)] = static_cast<uint16_t>((data >> 16) & 0xffff);
 			changed = true;
 		}
+		if (changed) {
+			t->texcache.ram_written(tbaseaddr << 1);
+		}
 
 #ifdef C_ENABLE_VOODOO_OPENGL
 		if (changed && v->ogl && v->active) {
@@ -7165,9 +7577,6 @@ static void voodoo_init() {
 			*lut_val++ = static_cast<uint32_t>(log2_of_n);
 		}
 
-		dither2_lookup = generate_dither_lut(dither_matrix_2x2);
-		dither4_lookup = generate_dither_lut(dither_matrix_4x4);
-
 		/* create sse2 scale table for rgba_bilinear_filter */
 		for (int i = 0; i != 256; i++) {
 			sse2_scale_table[i] = simde_mm_setr_epi16(
@@ -7851,6 +8260,7 @@ static void voodoo_shutdown()
 
 	v->active = false;
 	triangle_worker_shutdown(v->tworker);
+	log_generic_raster_hits();
 
 	delete v;
 	v = nullptr;
@@ -7,6 +7,7 @@
 #include "dosbox.h"
 
 #include <optional>
+#include <vector>
 
 #define BIOS_BASE_ADDRESS_COM1          0x400
 #define BIOS_BASE_ADDRESS_COM2          0x402
@@ -121,6 +122,38 @@ void INT13_StartUp(void);
 
 bool BIOS_AddKeyToBuffer(uint16_t code);
 
+// How many keys wait in the BIOS keyboard buffer for a program to read them
+uint16_t BIOS_GetNumBufferedKeys();
+
+// The keyboard buffer word (scan code << 8 | ASCII) that typing 'ch' on a US
+// layout produces, or 0 if no key produces it
+uint16_t BIOS_GetKeyCodeForChar(char ch);
+
+// Whether a program replaced the BIOS IRQ 1 (INT 9) handler. Such programs
+// read the keyboard port themselves and never look at the BIOS buffer.
+bool BIOS_IsKeyboardIrqHooked();
+
+// Empty INT 16h AH=01h/11h keystroke checks allowed in one PIC tick before
+// the program counts as spinning on them
+constexpr uint32_t BIOS_MaxBusyKeystrokeChecksPerTick = 16;
+
+// Counts an empty keystroke check at the given PIC tick. Returns whether
+// the program spins on the check, so the CPU may idle until the next event.
+bool BIOS_NoteEmptyKeystrokeCheck(int64_t tick);
+
+// Queues keyboard buffer words, such as pasted text, to be added to the
+// buffer as fast as programs read it: whatever fits goes in right away, and
+// the rest is topped up every emulated millisecond. Returns false, queueing
+// nothing, if the queue can't take them all.
+bool BIOS_QueueKeys(const std::vector<uint16_t>& codes);
+
+// Adds as many queued keys as the buffer has room for
+void BIOS_FeedQueuedKeys();
+
+size_t BIOS_GetNumQueuedKeys();
+
+void BIOS_ClearQueuedKeys();
+
 void INT10_ReloadRomFonts();
 
 void BIOS_SetComPorts (uint16_t baseaddr[]);
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <cassert>
 #include <utility>
+#include <vector>
 
 #include "cpu/callback.h"
 #include "cpu/registers.h"
@@ -151,19 +152,28 @@ uint8_t imageDisk::Read_Sector(uint32_t head,uint32_t cylinder,uint32_t sector,v
 
 uint8_t imageDisk::Read_AbsoluteSector(uint32_t sectnum, void *data)
 {
-	const auto bytenum = check_cast<cross_off_t>(sectnum) * sector_size;
-
-	if (last_action == WRITE || bytenum != current_fpos) {
-		if (cross_fseeko(diskimg, bytenum, SEEK_SET) != 0) {
-			LOG_ERR("BIOSDISK: Could not seek to sector %u in file '%s': %s",
-			        sectnum, diskname, strerror(errno));
-			return 0xff;
-		}
+	if (!io->Read(sectnum, data)) {
+		LOG_ERR("BIOSDISK: Could not read sector %u in file '%s': %s",
+		        sectnum, diskname, strerror(errno));
+		return 0xff;
 	}
-	size_t ret = fread(data, 1, sector_size, diskimg);
-	current_fpos=bytenum+ret;
-	last_action=READ;
+	return 0x00;
+}
+
+uint8_t imageDisk::Read_Sectors(uint32_t head, uint32_t cylinder, uint32_t sector, uint32_t count, void *data)
+{
+	const uint32_t sectnum = ((cylinder * heads + head) * sectors) + sector - 1L;
 
+	return Read_AbsoluteSectors(sectnum, count, data);
+}
+
+uint8_t imageDisk::Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void *data)
+{
+	if (!io->Read(sectnum, count, data)) {
+		LOG_ERR("BIOSDISK: Could not read %u sectors from sector %u in file '%s': %s",
+		        count, sectnum, diskname, strerror(errno));
+		return 0xff;
+	}
 	return 0x00;
 }
 
@@ -177,25 +187,13 @@ uint8_t imageDisk::Write_Sector(uint32_t head,uint32_t cylinder,uint32_t sector,
 
 
 uint8_t imageDisk::Write_AbsoluteSector(uint32_t sectnum, void *data) {
-	const auto bytenum = check_cast<cross_off_t>(sectnum) * sector_size;
-
-	//LOG_MSG("Writing sectors to %ld at bytenum %d", sectnum, bytenum);
-
-	if (last_action == READ || bytenum != current_fpos) {
-		if (cross_fseeko(diskimg, bytenum, SEEK_SET) != 0) {
-			LOG_ERR("BIOSDISK: Could not seek to byte %lld in file '%s': %s",
-			        static_cast<long long int>(bytenum),
-			        diskname,
-			        strerror(errno));
-			return 0xff;
-		}
-	}
-	size_t ret = fwrite(data, 1, sector_size, diskimg);
-	current_fpos=bytenum+ret;
-	last_action=WRITE;
-
-	return ((ret>0)?0x00:0x05);
+	++num_writes;
+	return io->Write(sectnum, data) ? 0x00 : 0x05;
+}
 
+void imageDisk::Prefetch(uint32_t sectnum, uint32_t count)
+{
+	io->Prefetch(sectnum, count);
 }
 
 imageDisk::imageDisk(FILE *img_file, const char *img_name, uint32_t img_size_k, bool is_hdd)
@@ -206,11 +204,10 @@ imageDisk::imageDisk(FILE *img_file, const char *img_name, uint32_t img_size_k,
           sector_size(512),
           heads(0),
           cylinders(0),
-          sectors(0),
-          current_fpos(0),
-          last_action(NONE)
+          sectors(0)
 {
 	fseek(diskimg,0,SEEK_SET);
+	io = std::make_unique<DiskImageIO>(diskimg, sector_size);
 	memset(diskname,0,512);
 	safe_strcpy(diskname, img_name);
 	if (!is_hdd) {
@@ -244,6 +241,7 @@ void imageDisk::Set_Geometry(uint32_t setHeads, uint32_t setCyl, uint32_t setSec
 	cylinders = setCyl;
 	sectors = setSect;
 	sector_size = setSectSize;
+	io->SetSectorSize(sector_size);
 	active = true;
 }
 
@@ -401,8 +399,11 @@ static Bitu INT13_DiskHandler(void) {
 
 		segat = SegValue(es);
 		bufptr = reg_bx;
-		for (Bitu i = 0; i < reg_al; i++) {
-			last_status = imageDiskList[drivenum]->Read_Sector((uint32_t)reg_dh, (uint32_t)(reg_ch | ((reg_cl & 0xc0)<< 2)), (uint32_t)((reg_cl & 63)+i), sectbuf);
+		{
+			/* the sectors follow each other on the image, so read them in one go */
+			const uint32_t sect_size = imageDiskList[drivenum]->getSectSize();
+			std::vector<uint8_t> sectors(reg_al * std::max(sect_size, 512u));
+			last_status = imageDiskList[drivenum]->Read_Sectors((uint32_t)reg_dh, (uint32_t)(reg_ch | ((reg_cl & 0xc0)<< 2)), (uint32_t)(reg_cl & 63), reg_al, sectors.data());
 			if((last_status != 0x00) || (killRead)) {
 				LOG_MSG("Error in disk read");
 				killRead = false;
@@ -410,9 +411,11 @@ static Bitu INT13_DiskHandler(void) {
 				CALLBACK_SCF(true);
 				return CBRET_NONE;
 			}
-			for(t=0;t<512;t++) {
-				real_writeb(segat,bufptr,sectbuf[t]);
-				bufptr++;
+			for (Bitu i = 0; i < reg_al; i++) {
+				for(t=0;t<512;t++) {
+					real_writeb(segat,bufptr,sectors[i * sect_size + t]);
+					bufptr++;
+				}
 			}
 		}
 		reg_ah = 0x00;
@@ -584,6 +587,7 @@ void BIOS_SetupDisks(void) {
 /* TODO Start the time correctly */
 	call_int13=CALLBACK_Allocate();	
 	CALLBACK_Setup(call_int13,&INT13_DiskHandler,CB_INT13,"Int 13 Bios disk");
+	CALLBACK_SetInline(call_int13, true);
 	RealSetVec(0x13,CALLBACK_RealPointer(call_int13));
 
 	// Clean any the numbered images
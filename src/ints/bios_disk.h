@@ -11,6 +11,7 @@
 #include <memory>
 
 #include "ints/bios.h"
+#include "ints/disk_image_io.h"
 #include "dos/dos_inc.h"
 #include "hardware/memory.h"
 
@@ -32,6 +33,9 @@ public:
 	uint8_t Read_Sector(uint32_t head,uint32_t cylinder,uint32_t sector,void * data);
 	uint8_t Write_Sector(uint32_t head,uint32_t cylinder,uint32_t sector,void * data);
 	uint8_t Read_AbsoluteSector(uint32_t sectnum, void * data);
+	// contiguous runs of sectors, in one go where the image allows
+	uint8_t Read_Sectors(uint32_t head, uint32_t cylinder, uint32_t sector, uint32_t count, void * data);
+	uint8_t Read_AbsoluteSectors(uint32_t sectnum, uint32_t count, void * data);
 	uint8_t Write_AbsoluteSector(uint32_t sectnum, void * data);
 
 	void Set_Geometry(uint32_t setHeads, uint32_t setCyl, uint32_t setSect, uint32_t setSectSize);
@@ -45,10 +49,15 @@ public:
 
 	~imageDisk()
 	{
+		// Writes still cached go to the file before it's closed
+		io.reset();
 		if (diskimg != nullptr)
 			fclose(diskimg);
 	}
 
+	// Hints that an ATA command is about to read these sectors
+	void Prefetch(uint32_t sectnum, uint32_t count);
+
 	bool hardDrive;
 	bool active;
 	FILE *diskimg;
@@ -57,9 +66,12 @@ public:
 
 	uint32_t sector_size;
 	uint32_t heads,cylinders,sectors;
+
+	/* sectors written so far, so users caching what the image holds can
+	   tell that someone else wrote to it */
+	uint64_t num_writes = 0;
 private:
-	cross_off_t current_fpos;
-	enum { NONE,READ,WRITE } last_action;
+	std::unique_ptr<DiskImageIO> io = {};
 };
 
 void updateDPT(void);
@@ -4,11 +4,16 @@
 
 #include "ints/bios.h"
 
+#include <deque>
+
 #include "cpu/callback.h"
+#include "cpu/cpu.h"
 #include "hardware/memory.h"
+#include "hardware/pic.h"
 #include "hardware/input/keyboard.h"
 #include "cpu/registers.h"
 #include "hardware/port.h"
+#include "hardware/timer.h"
 #include "dos/dos_inc.h"
 
 static callback_number_t call_int16 = 0;
@@ -188,6 +193,99 @@ bool BIOS_AddKeyToBuffer(uint16_t code) {
 	return true;
 }
 
+uint16_t BIOS_GetNumBufferedKeys()
+{
+	uint16_t start = 0;
+	uint16_t end   = 0;
+	if (is_machine_pcjr()) {
+		start = 0x1e;
+		end   = 0x3e;
+	} else {
+		start = mem_readw(BIOS_KEYBOARD_BUFFER_START);
+		end   = mem_readw(BIOS_KEYBOARD_BUFFER_END);
+	}
+	const auto head = mem_readw(BIOS_KEYBOARD_BUFFER_HEAD);
+	const auto tail = mem_readw(BIOS_KEYBOARD_BUFFER_TAIL);
+	if (end <= start) {
+		return 0;
+	}
+	const auto size = end - start;
+	return static_cast<uint16_t>(((tail - head + size) % size) / 2);
+}
+
+uint16_t BIOS_GetKeyCodeForChar(const char ch)
+{
+	if (ch == '\n') {
+		return get_key_codes_for(28).normal; // enter
+	}
+	for (uint8_t scan_code = 1; scan_code <= MAX_SCAN_CODE; ++scan_code) {
+		const auto& codes = get_key_codes_for(scan_code);
+		for (const auto code : {codes.normal, codes.shift}) {
+			if (code != none && (code & 0xff) == static_cast<uint8_t>(ch)) {
+				return code;
+			}
+		}
+	}
+	return 0;
+}
+
+bool BIOS_IsKeyboardIrqHooked()
+{
+	return RealGetVec(0x09) != BIOS_DEFAULT_IRQ1_LOCATION;
+}
+
+// Keys waiting for room in the buffer; the tick handler tops the buffer up
+// every emulated millisecond for as long as any are left
+static std::deque<uint16_t> queued_keys = {};
+static bool is_feeding_queued_keys      = false;
+
+constexpr size_t MaxQueuedKeys = 1024 * 1024;
+
+static void feed_queued_keys()
+{
+	BIOS_FeedQueuedKeys();
+	if (queued_keys.empty() && is_feeding_queued_keys) {
+		TIMER_DelTickHandler(feed_queued_keys);
+		is_feeding_queued_keys = false;
+	}
+}
+
+bool BIOS_QueueKeys(const std::vector<uint16_t>& codes)
+{
+	if (queued_keys.size() + codes.size() > MaxQueuedKeys) {
+		return false;
+	}
+	queued_keys.insert(queued_keys.end(), codes.begin(), codes.end());
+
+	BIOS_FeedQueuedKeys();
+	if (!queued_keys.empty() && !is_feeding_queued_keys) {
+		TIMER_AddTickHandler(feed_queued_keys);
+		is_feeding_queued_keys = true;
+	}
+	return true;
+}
+
+void BIOS_FeedQueuedKeys()
+{
+	while (!queued_keys.empty() && BIOS_AddKeyToBuffer(queued_keys.front())) {
+		queued_keys.pop_front();
+	}
+}
+
+size_t BIOS_GetNumQueuedKeys()
+{
+	return queued_keys.size();
+}
+
+void BIOS_ClearQueuedKeys()
+{
+	queued_keys.clear();
+	if (is_feeding_queued_keys) {
+		TIMER_DelTickHandler(feed_queued_keys);
+		is_feeding_queued_keys = false;
+	}
+}
+
 static void add_key(uint16_t code) {
 	if (code!=0) BIOS_AddKeyToBuffer(code);
 }
@@ -518,6 +616,40 @@ static bool IsEnhancedKey(uint16_t &key) {
 	return false;
 }
 
+// Gives up the rest of the current time slice the way HLT does. Emulated
+// time still advances to the next PIC event (the timer tick, or the
+// keyboard IRQ that ends the wait), but the host no longer burns through
+// the cycles in between executing the guest's wait loop.
+static void idle_until_next_event()
+{
+	CPU_IODelayRemoved += CPU_Cycles;
+	CPU_Cycles = 0;
+}
+
+// Programs waiting at a prompt or menu often spin on AH=01h/11h rather than
+// block in AH=00h. A handful of empty polls per emulated millisecond is
+// normal for a game loop checking the keyboard once per frame, so only a
+// burst beyond that is treated as an idle spin.
+bool BIOS_NoteEmptyKeystrokeCheck(const int64_t tick)
+{
+	static int64_t poll_tick   = -1;
+	static uint32_t poll_count = 0;
+
+	if (tick != poll_tick) {
+		poll_tick  = tick;
+		poll_count = 0;
+	}
+	return ++poll_count > BIOS_MaxBusyKeystrokeChecksPerTick;
+}
+
+static void note_empty_keystroke_check()
+{
+	if (CPU_IdleOnKeyboardPolling &&
+	    BIOS_NoteEmptyKeystrokeCheck(static_cast<int64_t>(PIC_Ticks))) {
+		idle_until_next_event();
+	}
+}
+
 static Bitu INT16_Handler(void) {
 	uint16_t temp=0;
 	switch (reg_ah) {
@@ -528,6 +660,7 @@ static Bitu INT16_Handler(void) {
 		} else {
 			/* enter small idle loop to allow for irqs to happen */
 			reg_ip+=1;
+			idle_until_next_event();
 		}
 		break;
 	case 0x10: /* GET KEYSTROKE (enhanced keyboards only) */
@@ -540,6 +673,7 @@ static Bitu INT16_Handler(void) {
 		} else {
 			/* enter small idle loop to allow for irqs to happen */
 			reg_ip+=1;
+			idle_until_next_event();
 		}
 		break;
 	case 0x01: /* CHECK FOR KEYSTROKE */
@@ -556,6 +690,7 @@ static Bitu INT16_Handler(void) {
 				}
 			} else {
 				/* no key available, return key at buffer head anyway */
+				note_empty_keystroke_check();
 				break;
 			}
 //			CALLBACK_Idle();
@@ -570,6 +705,8 @@ static Bitu INT16_Handler(void) {
 				/* special enhanced key, clear low part before returning key */
 				temp&=0xff00;
 			}
+		} else {
+			note_empty_keystroke_check();
 		}
 		reg_ax=temp;
 		break;
@@ -635,10 +772,12 @@ static void InitBiosSegment(void) {
 void BIOS_SetupKeyboard(void) {
 	/* Init the variables */
 	InitBiosSegment();
+	BIOS_ClearQueuedKeys();
 
 	/* Allocate/setup a callback for int 0x16 and for standard IRQ 1 handler */
 	call_int16=CALLBACK_Allocate();	
 	CALLBACK_Setup(call_int16,&INT16_Handler,CB_INT16,"Keyboard");
+	CALLBACK_SetInline(call_int16, true);
 	RealSetVec(0x16,CALLBACK_RealPointer(call_int16));
 
 	call_irq1=CALLBACK_Allocate();	
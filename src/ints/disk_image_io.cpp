@@ -0,0 +1,561 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "ints/disk_image_io.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+
+#include "dosbox.h"
+#include "misc/perf_counters.h"
+
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static PerfCounter disk_cache_hits("disk_cache_hits",
+                                   "Disk image sector reads served from the cache.");
+static PerfCounter disk_cache_misses("disk_cache_misses",
+                                     "Disk image sector reads that went to the file.");
+static PerfCounter disk_sectors_prefetched("disk_sectors_prefetched",
+                                           "Disk image sectors read ahead.");
+static PerfCounter disk_mapped_reads("disk_mapped_reads",
+                                     "Disk image sector reads copied from the mapped image.");
+static PerfCounter disk_sectors_written_back("disk_sectors_written_back",
+                                             "Disk image sectors written back from the cache.");
+
+// Sectors an ATA command transfers at most
+constexpr uint32_t MaxPrefetchSectors = 256;
+
+DiskImageIO::DiskImageIO(FILE* file, const uint32_t sector_size, const bool use_mapping)
+        : file(file),
+          sector_size(sector_size)
+{
+	assert(file);
+	assert(sector_size > 0);
+	if (use_mapping) {
+		Map();
+	}
+	worker = std::thread(&DiskImageIO::Work, this);
+}
+
+DiskImageIO::~DiskImageIO()
+{
+	{
+		const std::lock_guard lock(mutex);
+		is_stopping = true;
+	}
+	wake.notify_all();
+	if (worker.joinable()) {
+		worker.join();
+	}
+	WriteBack();
+	Unmap();
+}
+
+bool DiskImageIO::Read(const uint32_t sector, void* data)
+{
+	if (const auto bytes = MappedSectors(sector, 1)) {
+		std::memcpy(data, bytes, sector_size);
+		disk_mapped_reads.Add();
+		return true;
+	}
+
+	uint32_t count      = 1;
+	uint64_t read_after = 0;
+	{
+		const std::lock_guard lock(mutex);
+
+		sequential_run  = (sector == next_sequential) ? sequential_run + 1 : 0;
+		next_sequential = sector + 1;
+		const auto is_sequential = sequential_run >= 2;
+
+		const auto it = entries.find(sector);
+		if (it != entries.end()) {
+			std::memcpy(data, it->second.data.data(), sector_size);
+			Touch(it->second);
+			++stats.hits;
+			disk_cache_hits.Add();
+
+			// Keep the read-ahead half a run in front of the reads,
+			// starting over if it belongs to a run elsewhere
+			const auto is_behind  = sector + ReadAheadSectors / 2 >= read_ahead_end;
+			const auto is_elsewhere = read_ahead_end > sector + 2 * ReadAheadSectors;
+			if (is_sequential && (is_behind || is_elsewhere)) {
+				const auto start = is_elsewhere
+				                         ? sector + 1
+				                         : std::max(sector + 1, read_ahead_end);
+				requests.push_back({start, ReadAheadSectors});
+				read_ahead_end = start + ReadAheadSectors;
+				wake.notify_one();
+			}
+			return true;
+		}
+		++stats.misses;
+		disk_cache_misses.Add();
+
+		if (is_sequential) {
+			count          = ReadAheadSectors;
+			read_ahead_end = sector + count;
+		}
+		read_after = generation;
+	}
+	return FetchRun(sector, count, read_after, data);
+}
+
+bool DiskImageIO::Read(const uint32_t sector, const uint32_t count, void* data)
+{
+	if (const auto bytes = MappedSectors(sector, count)) {
+		std::memcpy(data, bytes, static_cast<size_t>(count) * sector_size);
+		disk_mapped_reads.Add(count);
+		return true;
+	}
+	auto dest = static_cast<uint8_t*>(data);
+	for (uint32_t i = 0; i < count; ++i) {
+		if (!Read(sector + i, dest)) {
+			return false;
+		}
+		dest += sector_size;
+	}
+	return true;
+}
+
+bool DiskImageIO::Write(const uint32_t sector, const void* data)
+{
+	if (const auto bytes = MappedSectors(sector, 1)) {
+		if (!is_mapped_writable) {
+			return false;
+		}
+		std::memcpy(bytes, data, sector_size);
+
+		const std::lock_guard lock(mutex);
+		if (!is_map_dirty) {
+			is_map_dirty   = true;
+			write_back_due = std::chrono::steady_clock::now() + WriteBackDelay;
+			wake.notify_one();
+		}
+		return true;
+	}
+
+	std::unique_lock lock(mutex);
+	++generation;
+
+	if (!is_write_back) {
+		if (const auto it = entries.find(sector); it != entries.end()) {
+			lru.erase(it->second.lru);
+			entries.erase(it);
+		}
+		const auto offset = static_cast<cross_off_t>(sector) * sector_size;
+		const auto bytes  = sector_size;
+		lock.unlock();
+
+		if (!WriteFile(offset, data, bytes)) {
+			return false;
+		}
+		lock.lock();
+		is_write_back = true;
+		return true;
+	}
+
+	auto it = entries.find(sector);
+	auto& entry = (it != entries.end()) ? it->second : Insert(sector);
+	std::memcpy(entry.data.data(), data, sector_size);
+	if (!entry.is_dirty) {
+		entry.is_dirty = true;
+		if (num_dirty++ == 0) {
+			write_back_due = std::chrono::steady_clock::now() + WriteBackDelay;
+		}
+	}
+	entry.version = ++next_version;
+	Touch(entry);
+	Evict();
+
+	lock.unlock();
+	wake.notify_one();
+	return true;
+}
+
+void DiskImageIO::Prefetch(const uint32_t sector, const uint32_t count)
+{
+	if (count == 0) {
+		return;
+	}
+#if !defined(WIN32)
+	// The kernel reads mapped pages ahead by itself once asked to
+	if (const auto bytes = MappedSectors(sector, 1)) {
+		static const auto page_size = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+
+		const auto mapped_left = mapped_bytes - static_cast<size_t>(bytes - mapped);
+		const auto run = std::min<uint64_t>(uint64_t{std::min(count, MaxPrefetchSectors)} *
+		                                            sector_size,
+		                                    mapped_left);
+
+		const auto first = reinterpret_cast<uintptr_t>(bytes);
+		const auto start = first & ~(page_size - 1);
+		const auto end   = first + static_cast<uintptr_t>(run);
+		madvise(reinterpret_cast<void*>(start), end - start, MADV_WILLNEED);
+		return;
+	}
+#endif
+	{
+		const std::lock_guard lock(mutex);
+		requests.push_back({sector, std::min(count, MaxPrefetchSectors)});
+	}
+	wake.notify_one();
+}
+
+void DiskImageIO::Flush()
+{
+	WriteBack();
+}
+
+void DiskImageIO::SetSectorSize(const uint32_t new_sector_size)
+{
+	assert(new_sector_size > 0);
+	WriteBack();
+
+	const std::lock_guard lock(mutex);
+	if (new_sector_size == sector_size) {
+		return;
+	}
+	// Writes cached since the write-back above are in the old size too
+	if (num_dirty > 0) {
+		LOG_WARNING("BIOSDISK: Sector size changed with %zu writes pending",
+		            num_dirty);
+	}
+	Clear();
+	sector_size = new_sector_size;
+	++generation;
+}
+
+DiskImageIO::Stats DiskImageIO::GetStats() const
+{
+	const std::lock_guard lock(mutex);
+	return stats;
+}
+
+void DiskImageIO::Work()
+{
+	for (;;) {
+		std::unique_lock lock(mutex);
+		wake.wait(lock, [&] {
+			return is_stopping || !requests.empty() || num_dirty > 0 ||
+			       is_map_dirty;
+		});
+		if (is_stopping) {
+			return;
+		}
+
+		if (!requests.empty()) {
+			const auto request = requests.front();
+			requests.erase(requests.begin());
+			const auto read_after = generation;
+			lock.unlock();
+
+			FetchRun(request.sector, request.count, read_after, nullptr);
+			continue;
+		}
+
+		// Give more writes a moment to come so they're written back
+		// together, serving reads meanwhile
+		const auto is_woken = wake.wait_until(lock, write_back_due, [&] {
+			return is_stopping || !requests.empty() ||
+			       num_dirty >= WriteBackThreshold;
+		});
+		if (is_stopping) {
+			return;
+		}
+		if (is_woken && num_dirty < WriteBackThreshold &&
+		    std::chrono::steady_clock::now() < write_back_due) {
+			continue;
+		}
+		lock.unlock();
+		WriteBack();
+	}
+}
+
+bool DiskImageIO::FetchRun(uint32_t sector, uint32_t count,
+                           const uint64_t read_after, void* first)
+{
+	uint32_t size = 0;
+	{
+		const std::lock_guard lock(mutex);
+		if (read_after != generation && !first) {
+			return true;
+		}
+		size = sector_size;
+
+		// Read-ahead only needs what isn't cached yet
+		if (!first) {
+			while (count > 0 && entries.count(sector)) {
+				++sector;
+				--count;
+			}
+			while (count > 0 && entries.count(sector + count - 1)) {
+				--count;
+			}
+			if (count == 0) {
+				return true;
+			}
+		}
+	}
+
+	std::vector<uint8_t> buffer(static_cast<size_t>(count) * size);
+	size_t read = 0;
+	const auto offset = static_cast<cross_off_t>(sector) * size;
+	if (!ReadFile(offset, buffer.data(), buffer.size(), read)) {
+		return false;
+	}
+	if (first) {
+		std::memcpy(first, buffer.data(), std::min<size_t>(read, size));
+	}
+
+	// Sectors past the end of the image aren't cached
+	const auto num_read = static_cast<uint32_t>(read / size);
+
+	const std::lock_guard lock(mutex);
+	if (read_after != generation) {
+		return true;
+	}
+	for (uint32_t i = 0; i < num_read; ++i) {
+		if (entries.count(sector + i)) {
+			continue;
+		}
+		auto& entry = Insert(sector + i);
+		const auto bytes = buffer.data() + static_cast<size_t>(i) * size;
+		std::memcpy(entry.data.data(), bytes, size);
+		if (!first || i > 0) {
+			++stats.prefetched;
+			disk_sectors_prefetched.Add();
+		}
+	}
+	Evict();
+	return true;
+}
+
+void DiskImageIO::WriteBack()
+{
+	const std::lock_guard write_back_lock(write_back_mutex);
+
+#if !defined(WIN32)
+	bool is_sync_due = false;
+	{
+		const std::lock_guard lock(mutex);
+		std::swap(is_sync_due, is_map_dirty);
+	}
+	if (is_sync_due && msync(mapped, mapped_bytes, MS_SYNC) != 0) {
+		LOG_ERR("BIOSDISK: Could not sync the mapped disk image: %s",
+		        strerror(errno));
+	}
+#endif
+
+	struct Pending {
+		uint32_t sector          = 0;
+		uint64_t version         = 0;
+		std::vector<uint8_t> data = {};
+	};
+	std::vector<Pending> pending = {};
+	uint32_t size = 0;
+	{
+		const std::lock_guard lock(mutex);
+		if (num_dirty == 0) {
+			return;
+		}
+		size = sector_size;
+		pending.reserve(num_dirty);
+		for (const auto& [sector, entry] : entries) {
+			if (entry.is_dirty) {
+				pending.push_back({sector, entry.version, entry.data});
+			}
+		}
+	}
+	std::sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+		return a.sector < b.sector;
+	});
+
+	// Every contiguous run of sectors goes out in a single write
+	std::vector<bool> is_written(pending.size(), false);
+	std::vector<uint8_t> run = {};
+	for (size_t start = 0; start < pending.size();) {
+		auto end = start + 1;
+		while (end < pending.size() &&
+		       pending[end].sector == pending[end - 1].sector + 1) {
+			++end;
+		}
+		run.clear();
+		for (auto i = start; i < end; ++i) {
+			run.insert(run.end(), pending[i].data.begin(), pending[i].data.end());
+		}
+		const auto offset = static_cast<cross_off_t>(pending[start].sector) * size;
+		const auto is_ok = WriteFile(offset, run.data(), run.size());
+		if (!is_ok) {
+			LOG_ERR("BIOSDISK: Could not write back %zu sectors from sector %u: %s",
+			        end - start,
+			        pending[start].sector,
+			        strerror(errno));
+		}
+		std::fill(is_written.begin() + static_cast<ptrdiff_t>(start),
+		          is_written.begin() + static_cast<ptrdiff_t>(end),
+		          is_ok);
+		start = end;
+	}
+
+	const std::lock_guard lock(mutex);
+	for (size_t i = 0; i < pending.size(); ++i) {
+		const auto it = entries.find(pending[i].sector);
+		if (it == entries.end() || !it->second.is_dirty ||
+		    it->second.version != pending[i].version) {
+			continue;
+		}
+		if (is_written[i]) {
+			it->second.is_dirty = false;
+			++stats.written;
+			disk_sectors_written_back.Add();
+		} else {
+			// Lost like a failed write to the file always was, and
+			// later reads see what the file holds
+			lru.erase(it->second.lru);
+			entries.erase(it);
+		}
+		--num_dirty;
+	}
+	++generation;
+	Evict();
+}
+
+bool DiskImageIO::ReadFile(const cross_off_t offset, void* data,
+                           const size_t bytes, size_t& read)
+{
+	const std::lock_guard lock(file_mutex);
+
+	if (last_was_write || offset != file_pos) {
+		if (cross_fseeko(file, offset, SEEK_SET) != 0) {
+			file_pos = -1;
+			return false;
+		}
+	}
+	read           = fread(data, 1, bytes, file);
+	file_pos       = offset + static_cast<cross_off_t>(read);
+	last_was_write = false;
+	return true;
+}
+
+bool DiskImageIO::WriteFile(const cross_off_t offset, const void* data,
+                            const size_t bytes)
+{
+	const std::lock_guard lock(file_mutex);
+
+	if (!last_was_write || offset != file_pos) {
+		if (cross_fseeko(file, offset, SEEK_SET) != 0) {
+			file_pos = -1;
+			return false;
+		}
+	}
+	const auto written = fwrite(data, 1, bytes, file);
+	file_pos           = offset + static_cast<cross_off_t>(written);
+	last_was_write     = true;
+	return written == bytes;
+}
+
+void DiskImageIO::Map()
+{
+#if !defined(WIN32)
+	// Pending stdio writes have to reach the file before it's mapped
+	std::fflush(file);
+
+	const auto fd = fileno(file);
+	struct stat info = {};
+	if (fd < 0 || fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) ||
+	    info.st_size <= 0 ||
+	    static_cast<uintmax_t>(info.st_size) > std::numeric_limits<size_t>::max()) {
+		return;
+	}
+	const auto bytes = static_cast<size_t>(info.st_size);
+
+	const auto flags       = fcntl(fd, F_GETFL);
+	const auto is_writable = flags != -1 && (flags & O_ACCMODE) == O_RDWR;
+
+	const auto protection = PROT_READ | (is_writable ? PROT_WRITE : 0);
+	const auto ptr = mmap(nullptr, bytes, protection, MAP_SHARED, fd, 0);
+	if (ptr == MAP_FAILED) {
+		return;
+	}
+	mapped             = static_cast<uint8_t*>(ptr);
+	mapped_bytes       = bytes;
+	is_mapped_writable = is_writable;
+#endif
+}
+
+void DiskImageIO::Unmap()
+{
+#if !defined(WIN32)
+	if (mapped) {
+		munmap(mapped, mapped_bytes);
+	}
+#endif
+	mapped       = nullptr;
+	mapped_bytes = 0;
+}
+
+uint8_t* DiskImageIO::MappedSectors(const uint32_t sector, const uint32_t count) const
+{
+	const auto offset = uint64_t{sector} * sector_size;
+	const auto bytes  = uint64_t{count} * sector_size;
+	if (!mapped || offset + bytes > mapped_bytes) {
+		return nullptr;
+	}
+	return mapped + offset;
+}
+
+DiskImageIO::Entry& DiskImageIO::Insert(const uint32_t sector)
+{
+	auto& entry = entries[sector];
+	entry.data.assign(sector_size, 0);
+	lru.push_front(sector);
+	entry.lru = lru.begin();
+	return entry;
+}
+
+void DiskImageIO::Touch(Entry& entry)
+{
+	lru.splice(lru.begin(), lru, entry.lru);
+}
+
+void DiskImageIO::Evict()
+{
+	// Writes that are still pending stay until they're written back
+	auto it = lru.end();
+	while (entries.size() > MaxEntries() && it != lru.begin()) {
+		--it;
+		const auto found = entries.find(*it);
+		assert(found != entries.end());
+		if (found->second.is_dirty) {
+			continue;
+		}
+		entries.erase(found);
+		it = lru.erase(it);
+	}
+}
+
+void DiskImageIO::Clear()
+{
+	entries.clear();
+	lru.clear();
+	num_dirty       = 0;
+	next_sequential = UINT32_MAX;
+	sequential_run  = 0;
+	read_ahead_end  = 0;
+	requests.clear();
+}
+
+size_t DiskImageIO::MaxEntries() const
+{
+	return std::max<size_t>(1, CacheBytes / sector_size);
+}
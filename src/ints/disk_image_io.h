@@ -0,0 +1,189 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_DISK_IMAGE_IO_H
+#define DOSBOX_DISK_IMAGE_IO_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "misc/cross.h"
+
+// Disk image I/O
+// ~~~~~~~~~~~~~~
+// Sector reads and writes of a disk image file, kept off the emulation
+// thread where possible.
+//
+// Where the platform allows, the image is mapped into memory, read-only
+// or shared for writable mounts, so sectors are copied straight out of
+// and into the mapping. Written pages are synced to the file by a worker
+// thread a tenth of a second after the first write, on Flush() and when
+// the object goes away. Sectors past the mapping, such as those an image
+// grows by, take the path below.
+//
+// Otherwise sectors live in an LRU cache of a few megabytes.
+//
+// Reads that continue a sequential run, and the sectors an ATA read
+// command is about to transfer, are fetched ahead by a worker thread in
+// one large read, while the emulated drive is still busy.
+//
+// Writes go to the cache and are written back by the worker, in
+// contiguous runs, once enough of them pile up or a tenth of a second
+// after the first of them. The first write goes straight to the file, so
+// read-only images still fail writes the way they always did. Anything
+// left is written back on Flush(), on a sector size change and when the
+// object goes away. The file itself stays owned by the caller.
+
+class DiskImageIO {
+public:
+	// Without 'use_mapping' every sector goes through the cache
+	DiskImageIO(FILE* file, uint32_t sector_size, bool use_mapping = true);
+	~DiskImageIO();
+
+	DiskImageIO(const DiskImageIO&)            = delete;
+	DiskImageIO& operator=(const DiskImageIO&) = delete;
+
+	// False if the sector couldn't be read. A sector partly past the
+	// end of the image is read as far as it goes.
+	bool Read(uint32_t sector, void* data);
+
+	// Reads 'count' contiguous sectors, in a single copy when mapped
+	bool Read(uint32_t sector, uint32_t count, void* data);
+
+	// False if the image can't be written to
+	bool Write(uint32_t sector, const void* data);
+
+	// Hints that 'count' sectors from 'sector' are about to be read
+	void Prefetch(uint32_t sector, uint32_t count);
+
+	// Writes back every cached write
+	void Flush();
+
+	void SetSectorSize(uint32_t sector_size);
+
+	bool IsMapped() const
+	{
+		return mapped != nullptr;
+	}
+
+	struct Stats {
+		uint64_t hits       = 0;
+		uint64_t misses     = 0;
+		uint64_t prefetched = 0;
+		uint64_t written    = 0;
+	};
+	Stats GetStats() const;
+
+	// Bytes the cache holds at most
+	static constexpr size_t CacheBytes = 4 * 1024 * 1024;
+
+	// Sectors read at once when reading ahead
+	static constexpr uint32_t ReadAheadSectors = 64;
+
+	// Cached writes that make the worker write back
+	static constexpr size_t WriteBackThreshold = 32;
+
+	// Cached writes wait for more to come at most this long
+	static constexpr std::chrono::milliseconds WriteBackDelay{100};
+
+private:
+	struct Entry {
+		std::vector<uint8_t> data = {};
+		bool is_dirty             = false;
+
+		// Bumped by every write, so a write-back only cleans the
+		// entries that weren't written again meanwhile
+		uint64_t version = 0;
+
+		std::list<uint32_t>::iterator lru = {};
+	};
+
+	struct Request {
+		uint32_t sector = 0;
+		uint32_t count  = 0;
+	};
+
+	void Work();
+
+	// Reads sectors from the file into the cache, skipping those that
+	// are already cached, and copies the first one to 'first' if it's
+	// given. A generation other than the current one by the time the
+	// read is done means the cache or the file changed meanwhile, so
+	// nothing is cached. False if the file couldn't be read.
+	bool FetchRun(uint32_t sector, uint32_t count, uint64_t generation,
+	              void* first);
+
+	void WriteBack();
+
+	void Map();
+	void Unmap();
+
+	// The mapped bytes of the sectors, if they're all mapped
+	uint8_t* MappedSectors(uint32_t sector, uint32_t count) const;
+
+	bool ReadFile(cross_off_t offset, void* data, size_t bytes, size_t& read);
+	bool WriteFile(cross_off_t offset, const void* data, size_t bytes);
+
+	// These expect the cache mutex to be held
+	Entry& Insert(uint32_t sector);
+	void Touch(Entry& entry);
+	void Evict();
+	void Clear();
+	size_t MaxEntries() const;
+
+	FILE* file = nullptr;
+
+	uint8_t* mapped          = nullptr;
+	size_t mapped_bytes      = 0;
+	bool is_mapped_writable  = false;
+
+	// One write-back at a time, so an older one can't overwrite what a
+	// newer one wrote
+	std::mutex write_back_mutex = {};
+
+	// Guards the file and its position
+	std::mutex file_mutex = {};
+	cross_off_t file_pos  = -1;
+	bool last_was_write   = false;
+
+	// Guards everything below
+	mutable std::mutex mutex = {};
+	std::condition_variable wake = {};
+
+	// Only changed by the thread that reads and writes sectors, which
+	// reads it without taking the lock
+	uint32_t sector_size = 0;
+
+	std::unordered_map<uint32_t, Entry> entries = {};
+	std::list<uint32_t> lru = {};
+	size_t num_dirty        = 0;
+	uint64_t generation     = 0;
+	uint64_t next_version   = 0;
+
+	// The oldest pending write is written back by then
+	std::chrono::steady_clock::time_point write_back_due = {};
+
+	// Sequential reads continue from here, and sectors up to the end
+	// of the read-ahead are already requested
+	uint32_t next_sequential = UINT32_MAX;
+	uint32_t sequential_run  = 0;
+	uint32_t read_ahead_end  = 0;
+
+	std::vector<Request> requests = {};
+	bool is_write_back          = false;
+	bool is_map_dirty           = false;
+	bool is_stopping            = false;
+
+	Stats stats = {};
+
+	std::thread worker = {};
+};
+
+#endif // DOSBOX_DISK_IMAGE_IO_H
@@ -19,6 +19,8 @@
 #include "cpu/paging.h"
 #include "cpu/registers.h"
 #include "config/setup.h"
+#include "misc/perf_counters.h"
+#include "misc/savestate.h"
 #include "misc/support.h"
 
 #define EMM_PAGEFRAME	0xE000
@@ -304,6 +306,23 @@ static uint8_t EMM_ReallocatePages(uint16_t handle,uint16_t & pages) {
 	return EMM_NO_ERROR;
 }
 
+static PerfCounter ems_calls("ems_calls", "EMS (INT 67h) calls handled.");
+static PerfCounter ems_page_maps("ems_page_maps", "EMS pages mapped or unmapped.");
+static PerfCounter ems_tlb_flushes("ems_tlb_flushes",
+                                   "EMS mappings that needed a full TLB flush.");
+
+/* Remapping only swaps the page handlers of the affected 4K pages; no data
+   is copied. With paging off, PAGING_MapPage has already reset the TLB
+   entries of those pages, so only once a VCPI client has enabled paging,
+   and other linear pages may alias the frame, is the whole TLB flushed. */
+static void EMM_FinishRemap() {
+	ems_page_maps.Add();
+	if (PAGING_Enabled()) {
+		ems_tlb_flushes.Add();
+		PAGING_ClearTLB();
+	}
+}
+
 static uint8_t EMM_MapPage(Bitu phys_page,uint16_t handle,uint16_t log_page) {
 //	LOG_MSG("EMS MapPage handle %d phys %d log %d",handle,phys_page,log_page);
 	/* Check for too high physical page */
@@ -316,7 +335,7 @@ static uint8_t EMM_MapPage(Bitu phys_page,uint16_t handle,uint16_t log_page) {
 		emm_mappings[phys_page].page=NULL_PAGE;
 		for (Bitu i=0;i<4;i++)
 			PAGING_MapPage(EMM_PAGEFRAME4K+phys_page*4+i,EMM_PAGEFRAME4K+phys_page*4+i);
-		PAGING_ClearTLB();
+		EMM_FinishRemap();
 		return EMM_NO_ERROR;
 	}
 	/* Check for valid handle */
@@ -332,7 +351,7 @@ static uint8_t EMM_MapPage(Bitu phys_page,uint16_t handle,uint16_t log_page) {
 			PAGING_MapPage(EMM_PAGEFRAME4K+phys_page*4+i,memh);
 			memh=MEM_NextHandle(memh);
 		}
-		PAGING_ClearTLB();
+		EMM_FinishRemap();
 		return EMM_NO_ERROR;
 	} else  {
 		/* Illegal logical page it is */
@@ -374,7 +393,7 @@ static uint8_t EMM_MapSegment(Bitu segment,uint16_t handle,uint16_t log_page) {
 			}
 			for (Bitu i=0;i<4;i++)
 				PAGING_MapPage(segment*16/4096+i,segment*16/4096+i);
-			PAGING_ClearTLB();
+			EMM_FinishRemap();
 			return EMM_NO_ERROR;
 		}
 		/* Check for valid handle */
@@ -395,7 +414,7 @@ static uint8_t EMM_MapSegment(Bitu segment,uint16_t handle,uint16_t log_page) {
 				PAGING_MapPage(segment*16/4096+i,memh);
 				memh=MEM_NextHandle(memh);
 			}
-			PAGING_ClearTLB();
+			EMM_FinishRemap();
 			return EMM_NO_ERROR;
 		} else  {
 			/* Illegal logical page it is */
@@ -739,6 +758,7 @@ static uint8_t MemoryRegion()
 }
 
 static Bitu INT67_Handler(void) {
+	ems_calls.Add();
 	Bitu i;
 	switch (reg_ah) {
 	case 0x40:		/* Get Status */
@@ -1372,6 +1392,33 @@ Bitu GetEMSType(SectionProp * section) {
 	return rtype;
 }
 
+// Only the bookkeeping; the page frame mappings themselves live in the
+// paging section's first-megabyte map
+void EMS_SaveState(SaveStateWriter& out)
+{
+	out.Write(emm_handles);
+	out.Write(emm_mappings);
+	out.Write(emm_segmentmappings);
+}
+
+bool EMS_LoadState(SaveStateReader& in, const bool apply)
+{
+	const auto handles         = in.Take(sizeof(emm_handles));
+	const auto mappings        = in.Take(sizeof(emm_mappings));
+	const auto segmentmappings = in.Take(sizeof(emm_segmentmappings));
+	if (!handles || !mappings || !segmentmappings) {
+		return false;
+	}
+	if (!apply) {
+		return true;
+	}
+
+	std::memcpy(emm_handles, handles, sizeof(emm_handles));
+	std::memcpy(emm_mappings, mappings, sizeof(emm_mappings));
+	std::memcpy(emm_segmentmappings, segmentmappings, sizeof(emm_segmentmappings));
+	return true;
+}
+
 class EMS final : public ModuleBase {
 private:
 	uint16_t ems_baseseg = 0;
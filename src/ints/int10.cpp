@@ -926,6 +926,24 @@ static void SetupTandyBios()
 	}
 }
 
+bool INT10_IsVectorHooked()
+{
+	return RealGetVec(0x10) != CALLBACK_RealPointer(call_10);
+}
+
+void INT10_RunRealInt()
+{
+	// While the vector still points at our handler, running the interrupt
+	// would only land back in it, so save the trip through the CPU core
+	// that'd otherwise be made for every character the console writes.
+	// TSRs that hook the vector still get to see the call.
+	if (!INT10_IsVectorHooked()) {
+		INT10_Handler();
+	} else {
+		CALLBACK_RunRealInt(0x10);
+	}
+}
+
 void INT10_Init(Section* /*sec*/)
 {
 	INT10_SetupPalette();
@@ -936,6 +954,7 @@ void INT10_Init(Section* /*sec*/)
 	/* Setup the INT 10 vector */
 	call_10=CALLBACK_Allocate();
 	CALLBACK_Setup(call_10,&INT10_Handler,CB_IRET,"Int 10 video");
+	CALLBACK_SetInline(call_10, true);
 	RealSetVec(0x10,CALLBACK_RealPointer(call_10));
 	//Init the 0x40 segment and init the datastructures in the video rom area
 	INT10_SetupRomMemory();
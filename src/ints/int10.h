@@ -335,6 +335,12 @@ void INT10_GetFuncStateInformation(PhysPt save);
 
 void INT10_SetCursorShape(uint8_t first,uint8_t last);
 
+// Runs the INT 10h function set up in the registers as a real-mode interrupt
+void INT10_RunRealInt();
+
+// Whether a program has pointed the INT 10h vector away from our handler
+bool INT10_IsVectorHooked();
+
 void INT10_SetCursorPos(uint8_t row,uint8_t col,uint8_t page);
 void INT10_SetCursorPosViaInterrupt(const uint8_t row, const uint8_t col,
                                     const uint8_t page);
@@ -343,6 +349,15 @@ void INT10_TeletypeOutput(const uint8_t char_value, const uint8_t attribute);
 void INT10_TeletypeOutputViaInterrupt(const uint8_t char_value,
                                       const uint8_t attribute);
 
+// Teletypes a run of characters that have no control function (anything but
+// BEL, BS, LF and CR) in a text mode, writing each row's worth into video
+// memory in one go and moving the cursor once at the end. The result is the
+// same as teletyping them one at a time through the interrupt. Returns false
+// without writing anything if the run can't be done that way, e.g. because
+// a program has hooked INT 10h.
+bool INT10_TeletypeOutputRun(const uint8_t* chars, const uint16_t num_chars,
+                             const uint8_t attribute, const bool use_attribute);
+
 void INT10_TeletypeOutputAttr(const uint8_t char_value, const uint8_t attribute,
                               const bool use_attribute);
 void INT10_TeletypeOutputAttrViaInterrupt(const uint8_t char_value,
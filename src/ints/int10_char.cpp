@@ -6,6 +6,9 @@
 
 #include "int10.h"
 
+#include <algorithm>
+#include <array>
+
 #include "ints/bios.h"
 #include "cpu/callback.h"
 #include "hardware/port.h"
@@ -169,11 +172,15 @@ static void TEXT_FillRow(uint8_t cleft,uint8_t cright,uint8_t row,PhysPt base,ui
 	/* Do some filing */
 	PhysPt dest;
 	dest=base+(row*CurMode->twidth+cleft)*2;
-	uint16_t fill=(attr<<8)+' ';
-	for (uint8_t x=0;x<(cright-cleft);x++) {
-		mem_writew(dest,fill);
-		dest+=2;
+
+	// Build the row of blanks and write it in one go
+	std::array<uint8_t, UINT8_MAX * 2> cells;
+	const auto num_bytes = static_cast<size_t>(cright - cleft) * 2;
+	for (size_t x = 0; x < num_bytes; x += 2) {
+		cells[x]     = ' ';
+		cells[x + 1] = attr;
 	}
+	MEM_BlockWrite(dest, cells.data(), num_bytes);
 }
 
 uint16_t INT10_GetTextColumns()
@@ -420,7 +427,7 @@ void INT10_SetCursorPosViaInterrupt(const uint8_t row, const uint8_t col,
 	reg_bh = page;
 	reg_dh = row;
 	reg_dl = col;
-	CALLBACK_RunRealInt(0x10);
+	INT10_RunRealInt();
 
 	// Restore regs
 	reg_ax = old_ax;
@@ -651,7 +658,7 @@ static void write_char_via_interrupt(const uint8_t cur_col, const uint8_t cur_ro
 	reg_bl = attribute;
 	reg_bh = page;
 	reg_cx = write_char_cmd;
-	CALLBACK_RunRealInt(0x10);
+	INT10_RunRealInt();
 
 	// Restore regs
 	reg_ax = old_ax;
@@ -807,6 +814,73 @@ static void teletype_output_attr(const uint8_t chr, const uint8_t attr,
 	}
 }
 
+bool INT10_TeletypeOutputRun(const uint8_t* chars, const uint16_t num_chars,
+                             const uint8_t attribute, const bool use_attribute)
+{
+	if (CurMode->type != M_TEXT || INT10_IsVectorHooked()) {
+		return false;
+	}
+
+	BIOS_NCOLS;
+	BIOS_NROWS;
+	const auto page = real_readb(BIOSMEM_SEG, BIOSMEM_CURRENT_PAGE);
+	uint8_t cur_row = CURSOR_POS_ROW(page);
+	uint8_t cur_col = CURSOR_POS_COL(page);
+	if (ncols > UINT8_MAX || cur_row >= nrows || cur_col >= ncols) {
+		return false;
+	}
+
+	const auto page_offset = page * real_readw(BIOSMEM_SEG, BIOSMEM_PAGE_SIZE);
+
+	std::array<uint8_t, UINT8_MAX * 2> cells;
+
+	uint16_t done = 0;
+	while (done < num_chars) {
+		// The part of the run that fits on the cursor's row
+		const auto num_cells = std::min(static_cast<size_t>(num_chars - done),
+		                                static_cast<size_t>(ncols - cur_col));
+		const auto num_bytes = num_cells * 2;
+
+		const auto address = static_cast<uint16_t>(
+		        page_offset + (cur_row * ncols + cur_col) * 2);
+		const PhysPt where = CurMode->pstart + address;
+
+		// Without an attribute, the cells keep the ones they have
+		if (!use_attribute) {
+			MEM_BlockRead(where, cells.data(), num_bytes);
+		}
+		for (size_t i = 0; i < num_cells; ++i) {
+			cells[i * 2] = chars[done + i];
+			if (use_attribute) {
+				cells[i * 2 + 1] = attribute;
+			}
+		}
+		MEM_BlockWrite(where, cells.data(), num_bytes);
+
+		done += static_cast<uint16_t>(num_cells);
+		cur_col += static_cast<uint8_t>(num_cells);
+		if (cur_col == ncols) {
+			cur_col = 0;
+			cur_row++;
+		}
+		// Scroll like the teletype does, filling with the attribute of
+		// the cell that was written last
+		if (cur_row == nrows) {
+			const auto fill = cells[num_bytes - 1];
+			INT10_ScrollWindow(0,
+			                   0,
+			                   static_cast<uint8_t>(nrows - 1),
+			                   static_cast<uint8_t>(ncols - 1),
+			                   -1,
+			                   fill,
+			                   page);
+			cur_row--;
+		}
+	}
+	INT10_SetCursorPos(cur_row, cur_col, page);
+	return true;
+}
+
 void INT10_TeletypeOutputAttr(const uint8_t char_value, const uint8_t attribute,
                               const bool use_attribute)
 {
@@ -846,7 +920,7 @@ void INT10_TeletypeOutputViaInterrupt(const uint8_t char_value, const uint8_t at
 	reg_ah = teletype_cmd;
 	reg_al = char_value;
 	reg_bl = attribute;
-	CALLBACK_RunRealInt(0x10);
+	INT10_RunRealInt();
 
 	// Restore regs
 	reg_ax = old_ax;
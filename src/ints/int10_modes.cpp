@@ -16,6 +16,7 @@
 #include "hardware/pci_bus.h"
 #include "hardware/port.h"
 #include "hardware/video/vga.h"
+#include "misc/footprint.h"
 #include "misc/video.h"
 #include "utils/bitops.h"
 #include "utils/math_utils.h"
@@ -853,8 +854,8 @@ static void finish_set_mode(bool clearmem) {
 		case M_CGA4_COMPOSITE:
 		case M_CGA_TEXT_COMPOSITE:
 			//  Hack we just access the memory directly
-			memset(vga.mem.linear,0,vga.vmemsize);
-			memset(vga.fastmem, 0, vga.vmemsize<<1);
+			FOOTPRINT_ZeroPages(vga.mem.linear, vga.vmemsize);
+			FOOTPRINT_ZeroPages(vga.fastmem, vga.vmemsize << 1);
 			break;
 		case M_ERROR:
 			assert(false);
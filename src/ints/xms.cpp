@@ -15,11 +15,15 @@
 #include "hardware/memory.h"
 #include "cpu/registers.h"
 #include "config/setup.h"
+#include "misc/perf_counters.h"
+#include "misc/savestate.h"
 #include "misc/support.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <iterator>
 
 CHECK_NARROWING();
 
@@ -380,7 +384,10 @@ static Result xms_move_memory(const PhysPt bpt)
 		++a20.num_times_enabled;
 		a20_enable(true);
 
-		mem_memcpy(destpt, srcpt, length);
+		// Copied a page at a time with memmove wherever both sides are
+		// plain RAM; the HMA follows the A20 remap through the TLB and
+		// handler-backed pages still go byte by byte
+		MEM_BlockCopy(destpt, srcpt, length);
 
 		--a20.num_times_enabled;
 		if (!a20_was_enabled) {
@@ -485,9 +492,12 @@ static bool xms_multiplex()
 // Main XMS API handler
 // ***************************************************************************
 
+static PerfCounter xms_calls("xms_calls", "XMS driver calls handled.");
+
 static Bitu XMS_Handler()
 {
 	assert(xms.is_available);
+	xms_calls.Add();
 
 	Result result = Result::OK;
 
@@ -714,6 +724,35 @@ static Bitu XMS_Handler()
 
 Bitu GetEMSType(SectionProp* section);
 
+// ***************************************************************************
+// Save-states
+// ***************************************************************************
+
+void XMS_SaveState(SaveStateWriter& out)
+{
+	out.Write(a20);
+	out.Write(hma);
+	out.Write(xms.handles);
+}
+
+bool XMS_LoadState(SaveStateReader& in, const bool apply)
+{
+	decltype(a20) a20_state = {};
+	decltype(hma) hma_state = {};
+	decltype(xms.handles) handles = {};
+	if (!in.Read(a20_state) || !in.Read(hma_state) || !in.Read(handles)) {
+		return false;
+	}
+	if (!apply) {
+		return true;
+	}
+
+	a20 = a20_state;
+	hma = hma_state;
+	std::copy(std::begin(handles), std::end(handles), std::begin(xms.handles));
+	return true;
+}
+
 class XMS final : public ModuleBase {
 private:
 	CALLBACK_HandlerObject callbackhandler;
@@ -3,6 +3,7 @@
 
 #include "zmbv.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdio>
@@ -26,12 +27,86 @@ constexpr uint8_t Mask_DeltaPalette = 0x02;
 
 // Compression flags
 constexpr uint8_t COMPRESSION_ZLIB     = 1;
-constexpr int ZLIB_COMPRESSION_LEVEL   = 6;          // 0 to 9 (0 = no compression)
 constexpr auto ZLIB_COMPRESSION_METHOD = Z_DEFLATED; // currently the only option
 constexpr int ZLIB_MEM_LEVEL           = 9;          // 1 to 9 (default 8)
 constexpr auto ZLIB_STRATEGY           = Z_FILTERED; // Z_DEFAULT_STRATEGY, Z_FILTERED,
                                                      // Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED
 
+// Smaller frames aren't worth waking the workers for
+constexpr size_t MinParallelBlocks = 1024;
+
+BandWorkers::BandWorkers(const int num_threads)
+{
+	assert(num_threads > 1);
+	for (auto i = 1; i < num_threads; ++i) {
+		threads.emplace_back(&BandWorkers::ThreadLoop, this);
+		set_thread_name(threads.back(), "dosbox:zmbv");
+	}
+}
+
+BandWorkers::~BandWorkers()
+{
+	{
+		std::lock_guard lock(mutex);
+		should_quit = true;
+	}
+	has_work.notify_all();
+	for (auto &thread : threads) {
+		thread.join();
+	}
+}
+
+void BandWorkers::RunBands()
+{
+	for (auto band = next_band.fetch_add(1); band < num_bands;
+	     band = next_band.fetch_add(1)) {
+		(*job)(band);
+	}
+}
+
+void BandWorkers::ThreadLoop()
+{
+	uint64_t last_generation = 0;
+	while (true) {
+		{
+			std::unique_lock lock(mutex);
+			has_work.wait(lock, [&] {
+				return should_quit || generation != last_generation;
+			});
+			if (should_quit) {
+				return;
+			}
+			last_generation = generation;
+		}
+
+		RunBands();
+
+		std::lock_guard lock(mutex);
+		if (--num_busy == 0) {
+			work_done.notify_one();
+		}
+	}
+}
+
+void BandWorkers::Run(const int _num_bands, const std::function<void(int band)> &_job)
+{
+	{
+		std::lock_guard lock(mutex);
+		job       = &_job;
+		num_bands = _num_bands;
+		next_band = 0;
+		num_busy  = static_cast<int>(threads.size());
+		++generation;
+	}
+	has_work.notify_all();
+
+	RunBands();
+
+	std::unique_lock lock(mutex);
+	work_done.wait(lock, [&] { return num_busy == 0; });
+	job = nullptr;
+}
+
 ZMBV_FORMAT BPPFormat(const int bpp)
 {
 	switch (bpp) {
@@ -87,13 +162,13 @@ bool VideoCodec::SetupBuffers(const ZMBV_FORMAT _format, const int blockwidth, c
 	buf2 = std::vector<uint8_t>(buf_sizes, 0);
 	work = std::vector<uint8_t>(buf_sizes, 0);
 
-	auto xblocks = (width / blockwidth);
+	xblocks = (width / blockwidth);
 
 	const auto xleft = width % blockwidth;
 	if (xleft)
 		xblocks++;
 
-	auto yblocks = (height / blockheight);
+	yblocks = (height / blockheight);
 
 	const auto yleft = height % blockheight;
 
@@ -102,6 +177,7 @@ bool VideoCodec::SetupBuffers(const ZMBV_FORMAT _format, const int blockwidth, c
 
 	const auto blocks_needed = check_cast<uint32_t>(xblocks * yblocks);
 	blocks.resize(blocks_needed);
+	matches.resize(blocks_needed);
 
 	size_t i = 0;
 	for (auto y = 0; y < yblocks; ++y) {
@@ -181,14 +257,14 @@ int VideoCodec::CompareBlock(const int vx, const int vy, const FrameBlock & bloc
 }
 
 template <class P>
-void VideoCodec::AddXorBlock(const int vx, const int vy, const FrameBlock & block)
+void VideoCodec::AddXorBlock(const int vx, const int vy, const FrameBlock & block, uint8_t *dest)
 {
 	P *pold = reinterpret_cast<P *>(oldframe) + block.start + (vy * pitch) + vx;
 	P *pnew = reinterpret_cast<P *>(newframe) + block.start;
 	for (auto y = 0; y < block.dy; ++y) {
 		for (auto x = 0; x < block.dx; ++x) {
-			*reinterpret_cast<P *>(&work[workUsed]) = pnew[x] ^ pold[x];
-			workUsed += sizeof(P);
+			*reinterpret_cast<P *>(dest) = pnew[x] ^ pold[x];
+			dest += sizeof(P);
 		}
 		pold += pitch;
 		pnew += pitch;
@@ -200,6 +276,49 @@ void VideoCodec::AlignWork(size_t & offset) {
 	offset = (offset + blocks.size() * 2u + 3u) & ~3u;
 }
 
+template <class P>
+VideoCodec::BlockMatch VideoCodec::FindBestMatch(const FrameBlock & block)
+{
+	BlockMatch best = {};
+	best.change     = CompareBlock<P>(0, 0, block);
+	auto possibles  = 64;
+
+	for (auto v = 0; v < VectorCount && possibles; v++) {
+		if (best.change < 4)
+			break;
+		auto vx = VectorTable[v].x;
+		auto vy = VectorTable[v].y;
+		if (PossibleBlock<P>(vx, vy, block) < 4) {
+			possibles--;
+			// if (!possibles) Msg("Ran out of possibles, at
+			// %d of %d best%d\n",v,VectorCount,bestchange);
+			auto testchange = CompareBlock<P>(vx, vy, block);
+			if (testchange < best.change) {
+				best.change = testchange;
+				best.vx     = check_cast<int8_t>(vx);
+				best.vy     = check_cast<int8_t>(vy);
+			}
+		}
+	}
+	return best;
+}
+
+// Runs the job for each row of blocks, on the workers if the frame is
+// large enough
+void VideoCodec::RunOnBlockRows(const std::function<void(int row)> &job)
+{
+	if (workers && blocks.size() >= MinParallelBlocks) {
+		workers->Run(yblocks, job);
+		return;
+	}
+	for (auto row = 0; row < yblocks; ++row) {
+		job(row);
+	}
+}
+
+// The blocks are independent of each other, so they're matched and XORed
+// in parallel. Only laying out the XORed blocks in the work buffer is done
+// in order, so the output is the same however many threads there are.
 template <class P>
 void VideoCodec::AddXorFrame()
 {
@@ -207,48 +326,66 @@ void VideoCodec::AddXorFrame()
 
 	AlignWork(workUsed);
 
-	size_t b = 0;
-	for (const auto & block : blocks) {
-
-		int8_t bestvx   = 0;
-		int8_t bestvy   = 0;
-		auto bestchange = CompareBlock<P>(0, 0, block);
-		auto possibles  = 64;
-
-		for (auto v = 0; v < VectorCount && possibles; v++) {
-			if (bestchange < 4)
-				break;
-			auto vx = VectorTable[v].x;
-			auto vy = VectorTable[v].y;
-			if (PossibleBlock<P>(vx, vy, block) < 4) {
-				possibles--;
-				// if (!possibles) Msg("Ran out of possibles, at
-				// %d of %d best%d\n",v,VectorCount,bestchange);
-				auto testchange = CompareBlock<P>(vx, vy, block);
-				if (testchange < bestchange) {
-					bestchange = testchange;
-					bestvx     = check_cast<int8_t>(vx);
-					bestvy     = check_cast<int8_t>(vy);
-				}
-			}
+	const auto row_blocks = [&](const int row) {
+		const auto first = static_cast<size_t>(row * xblocks);
+		const auto last  = std::min(first + static_cast<size_t>(xblocks),
+		                            blocks.size());
+		return std::pair(first, last);
+	};
+
+	RunOnBlockRows([&](const int row) {
+		const auto [first, last] = row_blocks(row);
+		for (auto b = first; b < last; ++b) {
+			matches[b] = FindBestMatch<P>(blocks[b]);
 		}
-		vectors[b * 2 + 0] = static_cast<uint8_t>(left_shift_signed(bestvx, 1));
-		vectors[b * 2 + 1] = static_cast<uint8_t>(left_shift_signed(bestvy, 1));
-		if (bestchange) {
+	});
+
+	for (size_t b = 0; b < blocks.size(); ++b) {
+		auto &match = matches[b];
+
+		vectors[b * 2 + 0] = static_cast<uint8_t>(left_shift_signed(match.vx, 1));
+		vectors[b * 2 + 1] = static_cast<uint8_t>(left_shift_signed(match.vy, 1));
+		if (match.change) {
 			vectors[b * 2 + 0] |= 1;
-			AddXorBlock<P>(bestvx, bestvy, block);
+			match.offset = workUsed;
+			workUsed += static_cast<size_t>(blocks[b].dx * blocks[b].dy) *
+			            sizeof(P);
 		}
-		++b;
 	}
+
+	RunOnBlockRows([&](const int row) {
+		const auto [first, last] = row_blocks(row);
+		for (auto b = first; b < last; ++b) {
+			const auto &match = matches[b];
+			if (match.change) {
+				AddXorBlock<P>(match.vx,
+				               match.vy,
+				               blocks[b],
+				               &work[match.offset]);
+			}
+		}
+	});
 }
 
-bool VideoCodec::SetupCompress(const int _width, const int _height)
+bool VideoCodec::SetupCompress(const int _width, const int _height,
+                               const int _compression_level, const int num_threads)
 {
+	assert(_compression_level >= ZMBV_MinCompressionLevel &&
+	       _compression_level <= ZMBV_MaxCompressionLevel);
+
 	width  = _width;
 	height = _height;
 	pitch  = _width + 2 * MAX_VECTOR;
 	format = ZMBV_FORMAT::NONE;
-	if (deflateInit2(&zstream, ZLIB_COMPRESSION_LEVEL, ZLIB_COMPRESSION_METHOD, ZLIB_MEM_LEVEL, ZLIB_MEM_LEVEL, ZLIB_STRATEGY) !=
+
+	compression_level = _compression_level;
+
+	workers = {};
+	if (num_threads > 1) {
+		workers = std::make_unique<BandWorkers>(num_threads);
+	}
+
+	if (deflateInit2(&zstream, compression_level, ZLIB_COMPRESSION_METHOD, ZLIB_MEM_LEVEL, ZLIB_MEM_LEVEL, ZLIB_STRATEGY) !=
 	    Z_OK)
 		return false;
 	return true;
@@ -592,3 +729,5 @@ VideoCodec::VideoCodec()
 	CreateVectorTable();
 	memset(&zstream, 0, sizeof(zstream));
 }
+
+VideoCodec::~VideoCodec() = default;
@@ -4,7 +4,13 @@
 #ifndef DOSBOX_ZMBV_H
 #define DOSBOX_ZMBV_H
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "dosbox_config.h"
@@ -25,6 +31,11 @@
 
 #define CODEC_4CC "ZMBV"
 
+// zlib levels from 1 (fastest) to 9 (smallest)
+constexpr int ZMBV_DefaultCompressionLevel = 6;
+constexpr int ZMBV_MinCompressionLevel     = 1;
+constexpr int ZMBV_MaxCompressionLevel     = 9;
+
 enum class ZMBV_FORMAT : uint8_t {
 	NONE = 0x00,
 	BPP_1 = 0x01,
@@ -39,6 +50,37 @@ enum class ZMBV_FORMAT : uint8_t {
 
 void Msg(const char fmt[], ...);
 
+// Runs a job over a number of bands on a few persistent threads, the
+// calling thread included. Each band is handed to exactly one thread, in
+// no particular order.
+class BandWorkers {
+public:
+	explicit BandWorkers(int num_threads);
+	~BandWorkers();
+
+	BandWorkers(const BandWorkers &) = delete;            // prevent copy
+	BandWorkers &operator=(const BandWorkers &) = delete; // prevent assignment
+
+	void Run(int num_bands, const std::function<void(int band)> &job);
+
+private:
+	void ThreadLoop();
+	void RunBands();
+
+	std::vector<std::thread> threads = {};
+
+	std::mutex mutex                  = {};
+	std::condition_variable has_work  = {};
+	std::condition_variable work_done = {};
+
+	const std::function<void(int)> *job = nullptr;
+	int num_bands                       = 0;
+	std::atomic<int> next_band          = 0;
+	int num_busy                        = 0;
+	uint64_t generation                 = 0;
+	bool should_quit                    = false;
+};
+
 class VideoCodec {
 private:
 	struct FrameBlock {
@@ -60,6 +102,16 @@ private:
 		uint8_t blockheight = 0;
 	};
 
+	struct BlockMatch {
+		int8_t vx = 0;
+		int8_t vy = 0;
+
+		// Pixels that differ after moving by the vector; the block is
+		// XORed into the work buffer at `offset` unless zero
+		int change    = 0;
+		size_t offset = 0;
+	};
+
 	struct Compress {
 		int linesDone = 0;
 		uint32_t writeSize = 0;
@@ -81,6 +133,9 @@ private:
 	uint32_t bufsize = 0;
 
 	std::vector<FrameBlock> blocks = {};
+	std::vector<BlockMatch> matches = {};
+	int xblocks = 0;
+	int yblocks = 0;
 	size_t workUsed = 0;
 	size_t workPos = 0;
 
@@ -95,6 +150,11 @@ private:
 	Compress compress = {};
 	z_stream zstream = {};
 
+	int compression_level = ZMBV_DefaultCompressionLevel;
+
+	// Searches and XORs the blocks of large delta frames in parallel
+	std::unique_ptr<BandWorkers> workers = {};
+
 	// methods
 	void CreateVectorTable();
 	bool SetupBuffers(ZMBV_FORMAT format, int blockwidth, int blockheight);
@@ -104,17 +164,20 @@ private:
 	template <class P>
 	void UnXorFrame();
 	template <class P>
+	BlockMatch FindBestMatch(const FrameBlock & block);
+	template <class P>
 	int PossibleBlock(int vx, int vy, const FrameBlock & block);
 	template <class P>
 	int CompareBlock(int vx, int vy, const FrameBlock & block);
 	template <class P>
-	void AddXorBlock(int vx, int vy, const FrameBlock & block);
+	void AddXorBlock(int vx, int vy, const FrameBlock & block, uint8_t *dest);
 	template <class P>
 	void UnXorBlock(int vx, int vy, const FrameBlock & block);
 	template <class P>
 	void CopyBlock(int vx, int vy, const FrameBlock & block);
 
 	void AlignWork(size_t & offset);
+	void RunOnBlockRows(const std::function<void(int row)> &job);
 
 public:
 	VideoCodec();
@@ -122,7 +185,13 @@ public:
 	VideoCodec(const VideoCodec &) = delete;            // prevent copy
 	VideoCodec &operator=(const VideoCodec &) = delete; // prevent assignment
 
-	bool SetupCompress(int _width, int _height);
+	~VideoCodec();
+
+	// Delta frames use up to `num_threads` threads, the calling one
+	// included
+	bool SetupCompress(int _width, int _height,
+	                   int _compression_level = ZMBV_DefaultCompressionLevel,
+	                   int num_threads = 1);
 	bool SetupDecompress(int _width, int _height);
 	ZMBV_FORMAT BPPFormat(int bpp);
 	int NeededSize(int _width, int _height, ZMBV_FORMAT _format);
@@ -20,6 +20,7 @@
 #include "misc/ansi_code_markup.h"
 #include "misc/cross.h"
 #include "misc/notifications.h"
+#include "misc/perf_counters.h"
 #include "misc/support.h"
 #include "utils/fs_utils.h"
 #include "utils/math_utils.h"
@@ -78,6 +79,7 @@ static dynlib_handle fsynth_lib = {};
 	FSFUNC(fluid_settings_t*, new_fluid_settings, (void)) \
 	FSFUNC(fluid_synth_t*, new_fluid_synth, (fluid_settings_t *settings)) \
 	FSFUNC(fluid_log_function_t, fluid_set_log_function, (int level, fluid_log_function_t fun, void *data)) \
+	FSFUNC(int, fluid_settings_setint, (fluid_settings_t *settings, const char *name, int val)) \
 	FSFUNC(int, fluid_settings_setnum, (fluid_settings_t *settings, const char *name, double val)) \
 	FSFUNC(int, fluid_synth_chorus_on, (fluid_synth_t *synth, int fx_group, int on)) \
 	FSFUNC(int, fluid_synth_set_chorus_group_nr, (fluid_synth_t *synth, int fx_group, int nr)) \
@@ -266,6 +268,21 @@ static void init_fluidsynth_dosbox_settings(SectionProp& secprop)
 	        "      same time. Whether this sounds good depends on the SoundFont and the\n"
 	        "      reverb settings being used.");
 
+	constexpr auto DefaultCpuCores = 1;
+	constexpr auto MinCpuCores     = 1;
+	constexpr auto MaxCpuCores     = 64;
+
+	int_prop = secprop.AddInt("fsynth_cpu_cores", WhenIdle, DefaultCpuCores);
+	int_prop->SetMinMax(MinCpuCores, MaxCpuCores);
+	int_prop->SetHelp(
+	        format_str("Number of CPU cores FluidSynth renders the voices on (%d by default).\n"
+	                   "Songs playing many notes at once with a large SoundFont can be too much\n"
+	                   "for one core; spreading the voices over 2 to 4 cores usually fixes the\n"
+	                   "resulting underruns. The value can range from %d to %d.",
+	                   DefaultCpuCores,
+	                   MinCpuCores,
+	                   MaxCpuCores));
+
 	str_prop = secprop.AddString("fsynth_filter", WhenIdle, "off");
 	assert(str_prop);
 	str_prop->SetHelp(
@@ -763,6 +780,16 @@ MidiDeviceFluidSynth::MidiDeviceFluidSynth()
 	                                  "synth.sample-rate",
 	                                  sample_rate_hz);
 
+	// FluidSynth spreads the voices over its own worker threads, and mixes
+	// them on the thread calling fluid_synth_write_float()
+	const auto cpu_cores = section->GetInt("fsynth_cpu_cores");
+	FluidSynth::fluid_settings_setint(fluid_settings.get(),
+	                                  "synth.cpu-cores",
+	                                  cpu_cores);
+	if (cpu_cores > 1) {
+		LOG_MSG("FSYNTH: Rendering on %d CPU cores", cpu_cores);
+	}
+
 	FluidSynthPtr fluid_synth(FluidSynth::new_fluid_synth(fluid_settings.get()),
 	                          FluidSynth::delete_fluid_synth);
 	if (!fluid_synth) {
@@ -831,7 +858,8 @@ MidiDeviceFluidSynth::MidiDeviceFluidSynth()
 	                                            ChannelFeature::Stereo,
 	                                            ChannelFeature::ReverbSend,
 	                                            ChannelFeature::ChorusSend,
-	                                            ChannelFeature::Synthesizer});
+	                                            ChannelFeature::Synthesizer,
+	                                            ChannelFeature::ParallelRender});
 
 	// FluidSynth renders float audio frames between -1.0f and
 	// +1.0f, so we ask the channel to scale all the samples up to
@@ -856,11 +884,8 @@ MidiDeviceFluidSynth::MidiDeviceFluidSynth()
 		set_section_property_value("fluidsynth", "fsynth_filter", "off");
 	}
 
-	// Double the baseline PCM prebuffer because MIDI is demanding
-	// and bursty. The mixer's default of ~20 ms becomes 40 ms here,
-	// which gives slower systems a better chance to keep up (and
-	// prevent their audio frame FIFO from running dry).
-	const auto render_ahead_ms = MIXER_GetPreBufferMs() * 2;
+	// Render ahead of playback by the configured lookahead
+	const auto render_ahead_ms = MIDI_GetLookaheadMs();
 
 	// Size the out-bound audio frame FIFO
 	assertm(sample_rate_hz >= 8000, "Sample rate must be at least 8 kHz");
@@ -1052,6 +1077,10 @@ void MidiDeviceFluidSynth::ApplySysExMessage(const std::vector<uint8_t>& msg)
 // The callback operates at the audio frame-level, steadily adding
 // samples to the mixer until the requested numbers of audio frames is
 // met.
+static PerfCounter fluidsynth_underruns(
+        "fluidsynth_underruns",
+        "Mixer callbacks that waited for FluidSynth to render.");
+
 void MidiDeviceFluidSynth::MixerCallback(const int requested_audio_frames)
 {
 	assert(mixer_channel);
@@ -1068,6 +1097,11 @@ void MidiDeviceFluidSynth::MixerCallback(const int requested_audio_frames)
 		had_underruns = true;
 	}
 
+	// The FIFO ran dry, so the dequeue below waits for the renderer
+	if (audio_frame_fifo.Size() < static_cast<size_t>(requested_audio_frames)) {
+		fluidsynth_underruns.Add();
+	}
+
 	static std::vector<AudioFrame> audio_frames = {};
 
 	const auto has_dequeued = audio_frame_fifo.BulkDequeue(audio_frames,
@@ -1106,6 +1140,13 @@ void MidiDeviceFluidSynth::RenderAudioFramesToFifo(const int num_audio_frames)
 	audio_frame_fifo.BulkEnqueue(audio_frames, num_audio_frames);
 }
 
+// Tops up the FIFO while there's no MIDI work waiting
+void MidiDeviceFluidSynth::RenderIdleAudioFrames()
+{
+	const auto fifo_room = audio_frame_fifo.MaxCapacity() - audio_frame_fifo.Size();
+	RenderAudioFramesToFifo(get_idle_render_frames(fifo_room));
+}
+
 void MidiDeviceFluidSynth::ProcessWorkFromFifo()
 {
 	const auto work = work_fifo.Dequeue();
@@ -1142,7 +1183,7 @@ void MidiDeviceFluidSynth::ProcessWorkFromFifo()
 void MidiDeviceFluidSynth::Render()
 {
 	while (work_fifo.IsRunning()) {
-		work_fifo.IsEmpty() ? RenderAudioFramesToFifo()
+		work_fifo.IsEmpty() ? RenderIdleAudioFrames()
 		                    : ProcessWorkFromFifo();
 	}
 }
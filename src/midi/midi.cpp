@@ -31,6 +31,7 @@
 #include "private/alsa.h"
 #endif
 
+#include "audio/mixer.h"
 #include "capture/capture.h"
 #include "config/config.h"
 #include "config/setup.h"
@@ -792,6 +793,30 @@ static void midi_init([[maybe_unused]] Section* sec)
 	}
 }
 
+int MIDI_GetLookaheadMs()
+{
+	constexpr auto MinLookaheadMs = 10;
+	constexpr auto MaxLookaheadMs = 1000;
+
+	const auto section = get_midi_section();
+	const auto pref    = section->GetString("midi_lookahead");
+
+	if (pref != "auto") {
+		if (const auto ms = parse_int(pref); ms) {
+			return std::clamp(*ms, MinLookaheadMs, MaxLookaheadMs);
+		}
+		LOG_WARNING("MIDI: Invalid 'midi_lookahead' setting: '%s', using 'auto'",
+		            pref.c_str());
+
+		set_section_property_value("midi", "midi_lookahead", "auto");
+	}
+
+	// Double the mixer's prebuffer because MIDI is demanding and bursty.
+	// The mixer's default of ~20 ms becomes 40 ms here, which gives slower
+	// systems a better chance to keep up.
+	return MIXER_GetPreBufferMs() * 2;
+}
+
 void MIDI_Init()
 {
 	midi_init(get_midi_section());
@@ -911,6 +936,15 @@ void init_midi_dosbox_settings(SectionProp& secprop)
 	str_prop->SetValues({"intelligent", "uart", "none"});
 	str_prop->SetHelp("MPU-401 mode to emulate ('intelligent' by default).");
 
+	str_prop = secprop.AddString("midi_lookahead", WhenIdle, "auto");
+	str_prop->SetHelp(
+	        "How far ahead of playback the internal MIDI synthesizers render, in\n"
+	        "milliseconds ('auto' by default). Possible values:\n"
+	        "  auto:      Twice the mixer's 'prebuffer' setting (default).\n"
+	        "  <number>:  Render this many milliseconds ahead, from 10 to 1000.\n"
+	        "Raise it if FluidSynth, the MT-32 or the Sound Canvas underrun with songs that\n"
+	        "play many notes at once; the MIDI music is delayed by the same amount.");
+
 	auto bool_prop = secprop.AddBool("raw_midi_output", WhenIdle, false);
 	bool_prop->SetHelp(
 	        "Enable raw, unaltered MIDI output ('off' by default).\n"
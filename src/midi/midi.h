@@ -7,8 +7,10 @@
 
 #include "dosbox.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstddef>
 
 #include "config/config.h"
 #include "config/setup.h"
@@ -221,6 +223,24 @@ void MIDI_RawOutByte(const uint8_t data);
 void MIDI_Mute();
 void MIDI_Unmute();
 
+// How far ahead of playback the internal synths render, from the
+// 'midi_lookahead' setting. Their audio frame FIFOs are sized to hold this.
+int MIDI_GetLookaheadMs();
+
+// With no MIDI work pending, the internal synths' renderer threads top up
+// their FIFOs in blocks of up to this many frames rather than one at a time,
+// so the FIFO's lock is taken once per block
+constexpr int MaxMidiIdleRenderFrames = 64;
+
+constexpr int get_idle_render_frames(const size_t fifo_room)
+{
+	// With the FIFO full, render a single frame and wait for room
+	if (fifo_room == 0) {
+		return 1;
+	}
+	return static_cast<int>(std::min<size_t>(fifo_room, MaxMidiIdleRenderFrames));
+}
+
 struct MidiWork {
 	std::vector<uint8_t> message = {};
 	int num_pending_audio_frames = 0;
@@ -25,6 +25,7 @@
 #include "midi.h"
 #include "misc/ansi_code_markup.h"
 #include "misc/cross.h"
+#include "misc/perf_counters.h"
 #include "misc/support.h"
 #include "utils/fs_utils.h"
 #include "utils/math_utils.h"
@@ -700,7 +701,8 @@ MidiDeviceMt32::MidiDeviceMt32()
 	                                      ChannelName::RolandMt32,
 	                                      {ChannelFeature::Sleep,
 	                                       ChannelFeature::Stereo,
-	                                       ChannelFeature::Synthesizer});
+	                                       ChannelFeature::Synthesizer,
+	                                       ChannelFeature::ParallelRender});
 
 	mixer_channel->SetResampleMethod(ResampleMethod::Resample);
 
@@ -725,11 +727,8 @@ MidiDeviceMt32::MidiDeviceMt32()
 		set_section_property_value("mt32", "mt32_filter", "off");
 	}
 
-	// Double the baseline PCM prebuffer because MIDI is demanding and
-	// bursty. The mixer's default of ~20 ms becomes 40 ms here, which gives
-	// slower systems a better chance to keep up (and prevent their audio
-	// frame FIFO from running dry).
-	const auto render_ahead_ms = MIXER_GetPreBufferMs() * 2;
+	// Render ahead of playback by the configured lookahead
+	const auto render_ahead_ms = MIDI_GetLookaheadMs();
 
 	// Size the out-bound audio frame FIFO
 	assertm(sample_rate_hz >= 8000, "Sample rate must be at least 8 kHz");
@@ -846,6 +845,10 @@ void MidiDeviceMt32::SendSysExMessage(uint8_t* sysex, size_t len)
 	work_fifo.Enqueue(std::move(work));
 }
 
+static PerfCounter mt32_underruns(
+        "mt32_underruns",
+        "Mixer callbacks that waited for the MT-32 to render.");
+
 // The callback operates at the audio frame-level, steadily adding samples to
 // the mixer until the requested numbers of audio frames is met.
 void MidiDeviceMt32::MixerCallback(const int requested_audio_frames)
@@ -864,6 +867,11 @@ void MidiDeviceMt32::MixerCallback(const int requested_audio_frames)
 		had_underruns = true;
 	}
 
+	// The FIFO ran dry, so the dequeue below waits for the renderer
+	if (audio_frame_fifo.Size() < static_cast<size_t>(requested_audio_frames)) {
+		mt32_underruns.Add();
+	}
+
 	static std::vector<AudioFrame> audio_frames = {};
 
 	const auto has_dequeued = audio_frame_fifo.BulkDequeue(audio_frames,
@@ -897,6 +905,13 @@ void MidiDeviceMt32::RenderAudioFramesToFifo(const int num_frames)
 	audio_frame_fifo.BulkEnqueue(audio_frames, num_frames);
 }
 
+// Tops up the FIFO while there's no MIDI work waiting
+void MidiDeviceMt32::RenderIdleAudioFrames()
+{
+	const auto fifo_room = audio_frame_fifo.MaxCapacity() - audio_frame_fifo.Size();
+	RenderAudioFramesToFifo(get_idle_render_frames(fifo_room));
+}
+
 // The next MIDI work task is processed, which includes rendering audio frames
 // prior to applying channel and sysex messages to the service
 void MidiDeviceMt32::ProcessWorkFromFifo()
@@ -942,7 +957,7 @@ void MidiDeviceMt32::ProcessWorkFromFifo()
 void MidiDeviceMt32::Render()
 {
 	while (work_fifo.IsRunning()) {
-		work_fifo.IsEmpty() ? RenderAudioFramesToFifo()
+		work_fifo.IsEmpty() ? RenderIdleAudioFrames()
 		                    : ProcessWorkFromFifo();
 	}
 }
@@ -17,6 +17,7 @@
 #include "misc/std_filesystem.h"
 #include "utils/dynlib.h"
 #include "utils/rwqueue.h"
+#include "utils/spsc_queue.h"
 
 namespace FluidSynth {
 
@@ -57,6 +58,7 @@ private:
 
 	int GetNumPendingAudioFrames();
 	void RenderAudioFramesToFifo(const int num_audio_frames = 1);
+	void RenderIdleAudioFrames();
 	void Render();
 
 	using FluidSynthSettingsPtr =
@@ -68,7 +70,7 @@ private:
 	FluidSynthPtr synth{nullptr, FluidSynth::delete_fluid_synth};
 
 	MixerChannelPtr mixer_channel = nullptr;
-	RWQueue<AudioFrame> audio_frame_fifo{1};
+	SpscQueue<AudioFrame> audio_frame_fifo{1};
 	RWQueue<MidiWork> work_fifo{1};
 	std::thread renderer = {};
 
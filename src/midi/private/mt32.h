@@ -23,6 +23,7 @@
 #include "midi/midi.h"
 #include "misc/std_filesystem.h"
 #include "utils/rwqueue.h"
+#include "utils/spsc_queue.h"
 
 // forward declaration
 class LASynthModel;
@@ -65,11 +66,12 @@ private:
 
 	int GetNumPendingAudioFrames();
 	void RenderAudioFramesToFifo(const int num_frames = 1);
+	void RenderIdleAudioFrames();
 	void Render();
 
 	// Managed objects
 	MixerChannelPtr channel = nullptr;
-	RWQueue<AudioFrame> audio_frame_fifo{1};
+	SpscQueue<AudioFrame> audio_frame_fifo{1};
 	RWQueue<MidiWork> work_fifo{1};
 
 	std::mutex service_mutex                  = {};
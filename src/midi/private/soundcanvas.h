@@ -13,6 +13,7 @@
 #include "audio/clap/plugin.h"
 #include "audio/mixer.h"
 #include "utils/rwqueue.h"
+#include "utils/spsc_queue.h"
 
 namespace SoundCanvas {
 
@@ -79,6 +80,7 @@ private:
 
 	int GetNumPendingAudioFrames();
 	void RenderAudioFramesToFifo(const int num_frames = 1);
+	void RenderIdleAudioFrames();
 	void Render();
 	void RenderBacklogged();
 
@@ -86,7 +88,7 @@ private:
 
 	// Managed objects
 	MixerChannelPtr mixer_channel = nullptr;
-	RWQueue<AudioFrame> audio_frame_fifo{1};
+	SpscQueue<AudioFrame> audio_frame_fifo{1};
 	RWQueue<MidiWork> work_fifo{1};
 
 	struct {
@@ -15,6 +15,7 @@
 #include "config/setup.h"
 #include "hardware/pic.h"
 #include "misc/ansi_code_markup.h"
+#include "misc/perf_counters.h"
 #include "misc/std_filesystem.h"
 #include "utils/checks.h"
 #include "utils/string_utils.h"
@@ -373,11 +374,8 @@ MidiDeviceSoundCanvas::MidiDeviceSoundCanvas()
 		set_section_property_value("soundcanvas", "soundcanvas_filter", "off");
 	}
 
-	// Double the baseline PCM prebuffer because MIDI is demanding and
-	// bursty. The mixer's default of ~20 ms becomes 40 ms here, which gives
-	// slower systems a better chance to keep up (and prevent their audio
-	// frame FIFO from running dry).
-	const auto render_ahead_ms = MIXER_GetPreBufferMs() * 2;
+	// Render ahead of playback by the configured lookahead
+	const auto render_ahead_ms = MIDI_GetLookaheadMs();
 
 	// Size the out-bound audio frame FIFO
 	assertm(sample_rate_hz >= 8000, "Sample rate must be at least 8 kHz");
@@ -485,6 +483,10 @@ void MidiDeviceSoundCanvas::SendSysExMessage(uint8_t* sysex, size_t len)
 	work_fifo.Enqueue(std::move(work));
 }
 
+static PerfCounter soundcanvas_underruns(
+        "soundcanvas_underruns",
+        "Mixer callbacks that waited for the Sound Canvas to render.");
+
 // The callback operates at the audio frame-level, steadily adding samples to
 // the mixer until the requested numbers of audio frames is met.
 void MidiDeviceSoundCanvas::MixerCallback(const int requested_audio_frames)
@@ -503,6 +505,11 @@ void MidiDeviceSoundCanvas::MixerCallback(const int requested_audio_frames)
 		had_underruns = true;
 	}
 
+	// The FIFO ran dry, so the dequeue below waits for the renderer
+	if (audio_frame_fifo.Size() < static_cast<size_t>(requested_audio_frames)) {
+		soundcanvas_underruns.Add();
+	}
+
 	static std::vector<AudioFrame> audio_frames = {};
 
 	const auto has_dequeued = audio_frame_fifo.BulkDequeue(audio_frames,
@@ -526,11 +533,14 @@ void MidiDeviceSoundCanvas::RenderAudioFramesToFifo(const int num_audio_frames)
 	static std::vector<float> left  = {};
 	static std::vector<float> right = {};
 
+	static std::vector<AudioFrame> audio_frames = {};
+
 	// Maybe expand the vectors
 	if (check_cast<int>(left.size()) < num_audio_frames) {
 		left.resize(num_audio_frames);
 		right.resize(num_audio_frames);
 	}
+	audio_frames.resize(num_audio_frames);
 
 	float* audio_out[] = {left.data(), right.data()};
 
@@ -538,8 +548,16 @@ void MidiDeviceSoundCanvas::RenderAudioFramesToFifo(const int num_audio_frames)
 	clap.event_list.Clear();
 
 	for (auto i = 0; i < num_audio_frames; ++i) {
-		audio_frame_fifo.Enqueue({left[i], right[i]});
+		audio_frames[i] = {left[i], right[i]};
 	}
+	audio_frame_fifo.BulkEnqueue(audio_frames, num_audio_frames);
+}
+
+// Tops up the FIFO while there's no MIDI work waiting
+void MidiDeviceSoundCanvas::RenderIdleAudioFrames()
+{
+	const auto fifo_room = audio_frame_fifo.MaxCapacity() - audio_frame_fifo.Size();
+	RenderAudioFramesToFifo(get_idle_render_frames(fifo_room));
 }
 
 // The next MIDI work task is processed, which includes rendering audio frames
@@ -668,7 +686,7 @@ void MidiDeviceSoundCanvas::Render()
 		if (is_work_fifo_backlogged) {
 			RenderBacklogged();
 		} else {
-			work_fifo.IsEmpty() ? RenderAudioFramesToFifo()
+			work_fifo.IsEmpty() ? RenderIdleAudioFrames()
 			                    : ProcessWorkFromFifo();
 		}
 	}
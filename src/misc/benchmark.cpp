@@ -0,0 +1,876 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/benchmark.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <optional>
+
+#include "config/config.h"
+#include "cpu/cpu.h"
+#include "dos/dos_system.h"
+#include "dosbox.h"
+#include "misc/perf_counters.h"
+#include "misc/std_filesystem.h"
+#include "utils/checks.h"
+#include "utils/string_utils.h"
+
+CHECK_NARROWING();
+
+namespace {
+
+// Workloads
+// ~~~~~~~~~
+// Listings of the .COM programs at their load address. They only need a
+// 386 with an FPU, the S3's VESA modes, a Sound Blaster at 220h with IRQ 7
+// and DMA 1, and the AdLib ports; each returns exit code 0 when it has
+// done its work.
+
+// 200 passes of 65536 rounds of adds, rotates and multiplies, with a
+// memory read and write each
+const std::vector<uint8_t> IntegerImage = {
+	0xbd, 0xc8, 0x00,       // 0100 mov bp,0xc8
+	0x31, 0xf6,             // 0103 xor si,si
+	0xb8, 0x34, 0x12,       // 0105 mov ax,0x1234
+	0xbb, 0x78, 0x56,       // 0108 mov bx,0x5678
+	0x31, 0xc9,             // 010b xor cx,cx
+	0x01, 0xd8,             // 010d add ax,bx
+	0xc1, 0xc0, 0x03,       // 010f rol ax,0x3
+	0x31, 0xc3,             // 0112 xor bx,ax
+	0xf7, 0xeb,             // 0114 imul bx
+	0x01, 0xd6,             // 0116 add si,dx
+	0x89, 0xf7,             // 0118 mov di,si
+	0x81, 0xe7, 0xfe, 0x0f, // 011a and di,0xffe
+	0x03, 0x9d, 0x00, 0x10, // 011e add bx,word [di+0x1000]
+	0x89, 0x85, 0x00, 0x10, // 0122 mov word [di+0x1000],ax
+	0xe2, 0xe5,             // 0126 loop 0x10d
+	0x4d,                   // 0128 dec bp
+	0x75, 0xe0,             // 0129 jne 0x10b
+	0xb8, 0x00, 0x4c,       // 012b mov ax,0x4c00
+	0xcd, 0x21,             // 012e int 0x21
+};
+
+// 40 passes of 65536 rounds of additions, square roots, multiplications,
+// divisions and sines on the x87 stack
+const std::vector<uint8_t> FpuImage = {
+	0x9b, 0xdb, 0xe3, // 0100 finit
+	0xd9, 0xe8,       // 0103 fld1
+	0xd9, 0xee,       // 0105 fldz
+	0xbd, 0x28, 0x00, // 0107 mov bp,0x28
+	0x31, 0xc9,       // 010a xor cx,cx
+	0xd8, 0xc1,       // 010c fadd st,st(1)
+	0xd9, 0xc0,       // 010e fld st(0)
+	0xd9, 0xfa,       // 0110 fsqrt
+	0xd8, 0xc8,       // 0112 fmul st,st(0)
+	0xd8, 0xf2,       // 0114 fdiv st,st(2)
+	0xd9, 0xfe,       // 0116 fsin
+	0xd8, 0xe1,       // 0118 fsub st,st(1)
+	0xdd, 0xd8,       // 011a fstp st(0)
+	0xe2, 0xee,       // 011c loop 0x10c
+	0x4d,             // 011e dec bp
+	0x75, 0xe9,       // 011f jne 0x10a
+	0x9b, 0xdb, 0xe3, // 0121 finit
+	0xb8, 0x00, 0x4c, // 0124 mov ax,0x4c00
+	0xcd, 0x21,       // 0127 int 0x21
+};
+
+// Mode 13h: 1000 frames drawn into a back buffer in conventional memory,
+// then copied into video memory with REP MOVSW
+const std::vector<uint8_t> Vga13hImage = {
+	0xb8, 0x13, 0x00, // 0100 mov ax,0x13
+	0xcd, 0x10,       // 0103 int 0x10
+	0x8c, 0xc8,       // 0105 mov ax,cs
+	0x05, 0x00, 0x10, // 0107 add ax,0x1000
+	0x8e, 0xc0,       // 010a mov es,ax
+	0xbd, 0xe8, 0x03, // 010c mov bp,0x3e8
+	0x31, 0xff,       // 010f xor di,di
+	0x89, 0xe8,       // 0111 mov ax,bp
+	0xb9, 0x00, 0x7d, // 0113 mov cx,0x7d00
+	0xab,             // 0116 stos word es:[di],ax
+	0x05, 0x01, 0x03, // 0117 add ax,0x301
+	0xe2, 0xfa,       // 011a loop 0x116
+	0x1e,             // 011c push ds
+	0x06,             // 011d push es
+	0x1f,             // 011e pop ds
+	0x31, 0xf6,       // 011f xor si,si
+	0xb8, 0x00, 0xa0, // 0121 mov ax,0xa000
+	0x8e, 0xc0,       // 0124 mov es,ax
+	0x31, 0xff,       // 0126 xor di,di
+	0xb9, 0x00, 0x7d, // 0128 mov cx,0x7d00
+	0xf3, 0xa5,       // 012b rep movs word es:[di],word ds:[si]
+	0x1e,             // 012d push ds
+	0x07,             // 012e pop es
+	0x1f,             // 012f pop ds
+	0x4d,             // 0130 dec bp
+	0x75, 0xdc,       // 0131 jne 0x10f
+	0xb8, 0x03, 0x00, // 0133 mov ax,0x3
+	0xcd, 0x10,       // 0136 int 0x10
+	0xb8, 0x00, 0x4c, // 0138 mov ax,0x4c00
+	0xcd, 0x21,       // 013b int 0x21
+};
+
+// Mode X: 1000 frames of filling each of the four planes, then copying
+// the page through the latches in write mode 1
+const std::vector<uint8_t> ModeXImage = {
+	0xb8, 0x13, 0x00, // 0100 mov ax,0x13
+	0xcd, 0x10,       // 0103 int 0x10
+	0xba, 0xc4, 0x03, // 0105 mov dx,0x3c4
+	0xb8, 0x04, 0x06, // 0108 mov ax,0x604
+	0xef,             // 010b out dx,ax
+	0xba, 0xd4, 0x03, // 010c mov dx,0x3d4
+	0xb8, 0x17, 0xe3, // 010f mov ax,0xe317
+	0xef,             // 0112 out dx,ax
+	0xb8, 0x14, 0x00, // 0113 mov ax,0x14
+	0xef,             // 0116 out dx,ax
+	0xb8, 0x00, 0xa0, // 0117 mov ax,0xa000
+	0x8e, 0xc0,       // 011a mov es,ax
+	0xbd, 0xe8, 0x03, // 011c mov bp,0x3e8
+	0xbb, 0x02, 0x01, // 011f mov bx,0x102
+	0xba, 0xc4, 0x03, // 0122 mov dx,0x3c4
+	0x89, 0xd8,       // 0125 mov ax,bx
+	0xef,             // 0127 out dx,ax
+	0x31, 0xff,       // 0128 xor di,di
+	0x89, 0xe8,       // 012a mov ax,bp
+	0x00, 0xf8,       // 012c add al,bh
+	0x88, 0xc4,       // 012e mov ah,al
+	0xb9, 0x40, 0x1f, // 0130 mov cx,0x1f40
+	0xf3, 0xab,       // 0133 rep stos word es:[di],ax
+	0xd0, 0xe7,       // 0135 shl bh,1
+	0x80, 0xff, 0x10, // 0137 cmp bh,0x10
+	0x75, 0xe6,       // 013a jne 0x122
+	0xb8, 0x02, 0x0f, // 013c mov ax,0xf02
+	0xef,             // 013f out dx,ax
+	0xba, 0xce, 0x03, // 0140 mov dx,0x3ce
+	0xb8, 0x05, 0x41, // 0143 mov ax,0x4105
+	0xef,             // 0146 out dx,ax
+	0x1e,             // 0147 push ds
+	0x06,             // 0148 push es
+	0x1f,             // 0149 pop ds
+	0x31, 0xf6,       // 014a xor si,si
+	0xbf, 0x80, 0x3e, // 014c mov di,0x3e80
+	0xb9, 0x80, 0x3e, // 014f mov cx,0x3e80
+	0xf3, 0xa4,       // 0152 rep movs byte es:[di],byte ds:[si]
+	0x1f,             // 0154 pop ds
+	0xb8, 0x05, 0x40, // 0155 mov ax,0x4005
+	0xef,             // 0158 out dx,ax
+	0x4d,             // 0159 dec bp
+	0x75, 0xc3,       // 015a jne 0x11f
+	0xb8, 0x03, 0x00, // 015c mov ax,0x3
+	0xcd, 0x10,       // 015f int 0x10
+	0xb8, 0x00, 0x4c, // 0161 mov ax,0x4c00
+	0xcd, 0x21,       // 0164 int 0x21
+};
+
+// 300 fills of the linear frame buffer of VESA mode 101h (640x480 in 256
+// colors) with REP STOSD, from flat real mode
+const std::vector<uint8_t> VesaImage = {
+	0x1e,                                           // 0100 push ds
+	0x07,                                           // 0101 pop es
+	0xb8, 0x01, 0x4f,                               // 0102 mov ax,0x4f01
+	0xb9, 0x01, 0x01,                               // 0105 mov cx,0x101
+	0xbf, 0x00, 0x10,                               // 0108 mov di,0x1000
+	0xcd, 0x10,                                     // 010b int 0x10
+	0x83, 0xf8, 0x4f,                               // 010d cmp ax,0x4f
+	0x75, 0x7b,                                     // 0110 jne 0x18d
+	0xf6, 0x06, 0x00, 0x10, 0x80,                   // 0112 test byte ds:0x1000,0x80
+	0x74, 0x74,                                     // 0117 je 0x18d
+	0x66, 0xa1, 0x28, 0x10,                         // 0119 mov eax,ds:0x1028
+	0x66, 0xa3, 0x92, 0x01,                         // 011d mov ds:0x192,eax
+	0xb8, 0x02, 0x4f,                               // 0121 mov ax,0x4f02
+	0xbb, 0x01, 0x41,                               // 0124 mov bx,0x4101
+	0xcd, 0x10,                                     // 0127 int 0x10
+	0x83, 0xf8, 0x4f,                               // 0129 cmp ax,0x4f
+	0x75, 0x5f,                                     // 012c jne 0x18d
+	0xfa,                                           // 012e cli
+	0x66, 0x31, 0xc0,                               // 012f xor eax,eax
+	0x8c, 0xc8,                                     // 0132 mov ax,cs
+	0x66, 0xc1, 0xe0, 0x04,                         // 0134 shl eax,0x4
+	0x66, 0x05, 0x9c, 0x01, 0x00, 0x00,             // 0138 add eax,0x19c
+	0x66, 0xa3, 0x98, 0x01,                         // 013e mov ds:0x198,eax
+	0x0f, 0x01, 0x16, 0x96, 0x01,                   // 0142 lgdtw ds:0x196
+	0x0f, 0x20, 0xc0,                               // 0147 mov eax,cr0
+	0x0c, 0x01,                                     // 014a or al,0x1
+	0x0f, 0x22, 0xc0,                               // 014c mov cr0,eax
+	0xeb, 0x00,                                     // 014f jmp 0x151
+	0xbb, 0x08, 0x00,                               // 0151 mov bx,0x8
+	0x8e, 0xc3,                                     // 0154 mov es,bx
+	0x24, 0xfe,                                     // 0156 and al,0xfe
+	0x0f, 0x22, 0xc0,                               // 0158 mov cr0,eax
+	0xeb, 0x00,                                     // 015b jmp 0x15d
+	0x31, 0xc0,                                     // 015d xor ax,ax
+	0x8e, 0xc0,                                     // 015f mov es,ax
+	0xfb,                                           // 0161 sti
+	0xbd, 0x2c, 0x01,                               // 0162 mov bp,0x12c
+	0x66, 0x8b, 0x3e, 0x92, 0x01,                   // 0165 mov edi,dword ds:0x192
+	0x66, 0xb9, 0x00, 0x2c, 0x01, 0x00,             // 016a mov ecx,0x12c00
+	0x89, 0xe8,                                     // 0170 mov ax,bp
+	0x88, 0xc4,                                     // 0172 mov ah,al
+	0x89, 0xc2,                                     // 0174 mov dx,ax
+	0x66, 0xc1, 0xe0, 0x10,                         // 0176 shl eax,0x10
+	0x89, 0xd0,                                     // 017a mov ax,dx
+	0x67, 0x66, 0xf3, 0xab,                         // 017c rep stos es:[edi],eax
+	0x4d,                                           // 0180 dec bp
+	0x75, 0xe2,                                     // 0181 jne 0x165
+	0xb8, 0x03, 0x00,                               // 0183 mov ax,0x3
+	0xcd, 0x10,                                     // 0186 int 0x10
+	0xb8, 0x00, 0x4c,                               // 0188 mov ax,0x4c00
+	0xcd, 0x21,                                     // 018b int 0x21
+	0xb8, 0x01, 0x4c,                               // 018d mov ax,0x4c01
+	0xcd, 0x21,                                     // 0190 int 0x21
+	0x00, 0x00, 0x00, 0x00,                         // 0192 lfb
+	0x0f, 0x00, 0x00, 0x00, 0x00, 0x00,             // 0196 gdtr
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // 019c gdt
+	0xff, 0xff, 0x00, 0x00, 0x00, 0x92, 0xcf, 0x00,
+};
+
+// About three seconds of auto-init 8-bit Sound Blaster DMA output at 22050
+// Hz, with an OPL voice changing its note every timer tick on top. The
+// CPU waits in HLT meanwhile, so this mostly measures the audio devices
+// and the mixer.
+const std::vector<uint8_t> SoundImage = {
+	0xba, 0x26, 0x02,                               // 0100 mov dx,0x226
+	0xb0, 0x01,                                     // 0103 mov al,0x1
+	0xee,                                           // 0105 out dx,al
+	0xec,                                           // 0106 in al,dx
+	0xec,                                           // 0107 in al,dx
+	0xec,                                           // 0108 in al,dx
+	0x30, 0xc0,                                     // 0109 xor al,al
+	0xee,                                           // 010b out dx,al
+	0xba, 0x2e, 0x02,                               // 010c mov dx,0x22e
+	0xb9, 0x00, 0x10,                               // 010f mov cx,0x1000
+	0xec,                                           // 0112 in al,dx
+	0xa8, 0x80,                                     // 0113 test al,0x80
+	0x75, 0x05,                                     // 0115 jne 0x11c
+	0xe2, 0xf9,                                     // 0117 loop 0x112
+	0xe9, 0x0a, 0x01,                               // 0119 jmp 0x226
+	0xba, 0x2a, 0x02,                               // 011c mov dx,0x22a
+	0xec,                                           // 011f in al,dx
+	0x3c, 0xaa,                                     // 0120 cmp al,0xaa
+	0x0f, 0x85, 0x00, 0x01,                         // 0122 jne 0x226
+	0x66, 0x31, 0xc0,                               // 0126 xor eax,eax
+	0x8c, 0xc8,                                     // 0129 mov ax,cs
+	0x66, 0xc1, 0xe0, 0x04,                         // 012b shl eax,0x4
+	0x66, 0x89, 0xc3,                               // 012f mov ebx,eax
+	0x66, 0x05, 0xff, 0x2f, 0x00, 0x00,             // 0132 add eax,0x2fff
+	0x66, 0x25, 0x00, 0xf0, 0xff, 0xff,             // 0138 and eax,0xfffff000
+	0x66, 0x89, 0xc2,                               // 013e mov edx,eax
+	0x66, 0x29, 0xda,                               // 0141 sub edx,ebx
+	0x89, 0xd7,                                     // 0144 mov di,dx
+	0x66, 0x89, 0xc5,                               // 0146 mov ebp,eax
+	0x1e,                                           // 0149 push ds
+	0x07,                                           // 014a pop es
+	0xb9, 0x00, 0x10,                               // 014b mov cx,0x1000
+	0x30, 0xc0,                                     // 014e xor al,al
+	0xaa,                                           // 0150 stos byte es:[di],al
+	0x04, 0x03,                                     // 0151 add al,0x3
+	0xe2, 0xfb,                                     // 0153 loop 0x150
+	0xb8, 0x0f, 0x35,                               // 0155 mov ax,0x350f
+	0xcd, 0x21,                                     // 0158 int 0x21
+	0x89, 0x1e, 0x5a, 0x02,                         // 015a mov word ds:0x25a,bx
+	0x8c, 0x06, 0x5c, 0x02,                         // 015e mov word ds:0x25c,es
+	0xb8, 0x0f, 0x25,                               // 0162 mov ax,0x250f
+	0xba, 0x4d, 0x02,                               // 0165 mov dx,0x24d
+	0xcd, 0x21,                                     // 0168 int 0x21
+	0xe4, 0x21,                                     // 016a in al,0x21
+	0xa2, 0x5e, 0x02,                               // 016c mov ds:0x25e,al
+	0x24, 0x7f,                                     // 016f and al,0x7f
+	0xe6, 0x21,                                     // 0171 out 0x21,al
+	0x66, 0x89, 0xeb,                               // 0173 mov ebx,ebp
+	0xb0, 0x05,                                     // 0176 mov al,0x5
+	0xe6, 0x0a,                                     // 0178 out 0xa,al
+	0x30, 0xc0,                                     // 017a xor al,al
+	0xe6, 0x0c,                                     // 017c out 0xc,al
+	0xb0, 0x59,                                     // 017e mov al,0x59
+	0xe6, 0x0b,                                     // 0180 out 0xb,al
+	0x88, 0xd8,                                     // 0182 mov al,bl
+	0xe6, 0x02,                                     // 0184 out 0x2,al
+	0x88, 0xf8,                                     // 0186 mov al,bh
+	0xe6, 0x02,                                     // 0188 out 0x2,al
+	0x66, 0xc1, 0xeb, 0x10,                         // 018a shr ebx,0x10
+	0x88, 0xd8,                                     // 018e mov al,bl
+	0xe6, 0x83,                                     // 0190 out 0x83,al
+	0xb0, 0xff,                                     // 0192 mov al,0xff
+	0xe6, 0x03,                                     // 0194 out 0x3,al
+	0xb0, 0x0f,                                     // 0196 mov al,0xf
+	0xe6, 0x03,                                     // 0198 out 0x3,al
+	0xb0, 0x01,                                     // 019a mov al,0x1
+	0xe6, 0x0a,                                     // 019c out 0xa,al
+	0xb0, 0xd1,                                     // 019e mov al,0xd1
+	0xe8, 0x88, 0x00,                               // 01a0 call 0x22b
+	0xb0, 0x40,                                     // 01a3 mov al,0x40
+	0xe8, 0x83, 0x00,                               // 01a5 call 0x22b
+	0xb0, 0xd3,                                     // 01a8 mov al,0xd3
+	0xe8, 0x7e, 0x00,                               // 01aa call 0x22b
+	0xb0, 0x48,                                     // 01ad mov al,0x48
+	0xe8, 0x79, 0x00,                               // 01af call 0x22b
+	0xb0, 0xff,                                     // 01b2 mov al,0xff
+	0xe8, 0x74, 0x00,                               // 01b4 call 0x22b
+	0xb0, 0x07,                                     // 01b7 mov al,0x7
+	0xe8, 0x6f, 0x00,                               // 01b9 call 0x22b
+	0xb0, 0x1c,                                     // 01bc mov al,0x1c
+	0xe8, 0x6a, 0x00,                               // 01be call 0x22b
+	0xbe, 0x5f, 0x02,                               // 01c1 mov si,0x25f
+	0xad,                                           // 01c4 lods ax,word ds:[si]
+	0x85, 0xc0,                                     // 01c5 test ax,ax
+	0x74, 0x05,                                     // 01c7 je 0x1ce
+	0xe8, 0x6b, 0x00,                               // 01c9 call 0x237
+	0xeb, 0xf6,                                     // 01cc jmp 0x1c4
+	0xb8, 0x40, 0x00,                               // 01ce mov ax,0x40
+	0x8e, 0xc0,                                     // 01d1 mov es,ax
+	0xbd, 0x37, 0x00,                               // 01d3 mov bp,0x37
+	0x26, 0x8b, 0x1e, 0x6c, 0x00,                   // 01d6 mov bx,word es:0x6c
+	0xf4,                                           // 01db hlt
+	0x26, 0x3b, 0x1e, 0x6c, 0x00,                   // 01dc cmp bx,word es:0x6c
+	0x74, 0xf8,                                     // 01e1 je 0x1db
+	0x89, 0xe8,                                     // 01e3 mov ax,bp
+	0xc0, 0xe0, 0x03,                               // 01e5 shl al,0x3
+	0x88, 0xc4,                                     // 01e8 mov ah,al
+	0xb0, 0xa0,                                     // 01ea mov al,0xa0
+	0xe8, 0x48, 0x00,                               // 01ec call 0x237
+	0xb8, 0xb0, 0x31,                               // 01ef mov ax,0x31b0
+	0xe8, 0x42, 0x00,                               // 01f2 call 0x237
+	0x4d,                                           // 01f5 dec bp
+	0x75, 0xde,                                     // 01f6 jne 0x1d6
+	0xb8, 0xb0, 0x11,                               // 01f8 mov ax,0x11b0
+	0xe8, 0x39, 0x00,                               // 01fb call 0x237
+	0xb0, 0xda,                                     // 01fe mov al,0xda
+	0xe8, 0x28, 0x00,                               // 0200 call 0x22b
+	0xb0, 0xd0,                                     // 0203 mov al,0xd0
+	0xe8, 0x23, 0x00,                               // 0205 call 0x22b
+	0xb0, 0xd3,                                     // 0208 mov al,0xd3
+	0xe8, 0x1e, 0x00,                               // 020a call 0x22b
+	0xb0, 0x05,                                     // 020d mov al,0x5
+	0xe6, 0x0a,                                     // 020f out 0xa,al
+	0xa0, 0x5e, 0x02,                               // 0211 mov al,ds:0x25e
+	0xe6, 0x21,                                     // 0214 out 0x21,al
+	0x1e,                                           // 0216 push ds
+	0xc5, 0x16, 0x5a, 0x02,                         // 0217 lds dx,dword ds:0x25a
+	0xb8, 0x0f, 0x25,                               // 021b mov ax,0x250f
+	0xcd, 0x21,                                     // 021e int 0x21
+	0x1f,                                           // 0220 pop ds
+	0xb8, 0x00, 0x4c,                               // 0221 mov ax,0x4c00
+	0xcd, 0x21,                                     // 0224 int 0x21
+	0xb8, 0x01, 0x4c,                               // 0226 mov ax,0x4c01
+	0xcd, 0x21,                                     // 0229 int 0x21
+	0x50,                                           // 022b push ax
+	0xba, 0x2c, 0x02,                               // 022c mov dx,0x22c
+	0xec,                                           // 022f in al,dx
+	0xa8, 0x80,                                     // 0230 test al,0x80
+	0x75, 0xfb,                                     // 0232 jne 0x22f
+	0x58,                                           // 0234 pop ax
+	0xee,                                           // 0235 out dx,al
+	0xc3,                                           // 0236 ret
+	0xba, 0x88, 0x03,                               // 0237 mov dx,0x388
+	0xee,                                           // 023a out dx,al
+	0xb9, 0x06, 0x00,                               // 023b mov cx,0x6
+	0xec,                                           // 023e in al,dx
+	0xe2, 0xfd,                                     // 023f loop 0x23e
+	0x42,                                           // 0241 inc dx
+	0x88, 0xe0,                                     // 0242 mov al,ah
+	0xee,                                           // 0244 out dx,al
+	0x4a,                                           // 0245 dec dx
+	0xb9, 0x23, 0x00,                               // 0246 mov cx,0x23
+	0xec,                                           // 0249 in al,dx
+	0xe2, 0xfd,                                     // 024a loop 0x249
+	0xc3,                                           // 024c ret
+	0x50,                                           // 024d push ax
+	0x52,                                           // 024e push dx
+	0xba, 0x2e, 0x02,                               // 024f mov dx,0x22e
+	0xec,                                           // 0252 in al,dx
+	0xb0, 0x20,                                     // 0253 mov al,0x20
+	0xe6, 0x20,                                     // 0255 out 0x20,al
+	0x5a,                                           // 0257 pop dx
+	0x58,                                           // 0258 pop ax
+	0xcf,                                           // 0259 iret
+	0x00, 0x00, 0x00, 0x00,                         // 025a old_irq
+	0x00,                                           // 025e old_mask
+	0x20, 0x01, 0x23, 0x01, 0x40, 0x10, 0x43, 0x00, // 025f voice
+	0x60, 0xf0, 0x63, 0xf0, 0x80, 0x77, 0x83, 0x77,
+	0xc0, 0x00, 0xe0, 0x00, 0xe3, 0x00, 0xa0, 0x98,
+	0xb0, 0x31, 0x00, 0x00,
+};
+
+// 64 rounds of creating a 64 KB file in 1 KB writes, reading it back in
+// 512 byte reads and deleting it again, in the current directory
+const std::vector<uint8_t> FileIoImage = {
+	0xbd, 0x40, 0x00,                               // 0100 mov bp,0x40
+	0xb4, 0x3c,                                     // 0103 mov ah,0x3c
+	0x31, 0xc9,                                     // 0105 xor cx,cx
+	0xba, 0x5e, 0x01,                               // 0107 mov dx,0x15e
+	0xcd, 0x21,                                     // 010a int 0x21
+	0x72, 0x4b,                                     // 010c jb 0x159
+	0x89, 0xc3,                                     // 010e mov bx,ax
+	0xbe, 0x40, 0x00,                               // 0110 mov si,0x40
+	0xb4, 0x40,                                     // 0113 mov ah,0x40
+	0xb9, 0x00, 0x04,                               // 0115 mov cx,0x400
+	0xba, 0x00, 0x10,                               // 0118 mov dx,0x1000
+	0xcd, 0x21,                                     // 011b int 0x21
+	0x72, 0x3a,                                     // 011d jb 0x159
+	0x4e,                                           // 011f dec si
+	0x75, 0xf1,                                     // 0120 jne 0x113
+	0xb8, 0x00, 0x42,                               // 0122 mov ax,0x4200
+	0x31, 0xc9,                                     // 0125 xor cx,cx
+	0x31, 0xd2,                                     // 0127 xor dx,dx
+	0xcd, 0x21,                                     // 0129 int 0x21
+	0x72, 0x2c,                                     // 012b jb 0x159
+	0xbe, 0x80, 0x00,                               // 012d mov si,0x80
+	0xb4, 0x3f,                                     // 0130 mov ah,0x3f
+	0xb9, 0x00, 0x02,                               // 0132 mov cx,0x200
+	0xba, 0x00, 0x10,                               // 0135 mov dx,0x1000
+	0xcd, 0x21,                                     // 0138 int 0x21
+	0x72, 0x1d,                                     // 013a jb 0x159
+	0x3d, 0x00, 0x02,                               // 013c cmp ax,0x200
+	0x75, 0x18,                                     // 013f jne 0x159
+	0x4e,                                           // 0141 dec si
+	0x75, 0xec,                                     // 0142 jne 0x130
+	0xb4, 0x3e,                                     // 0144 mov ah,0x3e
+	0xcd, 0x21,                                     // 0146 int 0x21
+	0xb4, 0x41,                                     // 0148 mov ah,0x41
+	0xba, 0x5e, 0x01,                               // 014a mov dx,0x15e
+	0xcd, 0x21,                                     // 014d int 0x21
+	0x72, 0x08,                                     // 014f jb 0x159
+	0x4d,                                           // 0151 dec bp
+	0x75, 0xaf,                                     // 0152 jne 0x103
+	0xb8, 0x00, 0x4c,                               // 0154 mov ax,0x4c00
+	0xcd, 0x21,                                     // 0157 int 0x21
+	0xb8, 0x01, 0x4c,                               // 0159 mov ax,0x4c01
+	0xcd, 0x21,                                     // 015c int 0x21
+	0x42, 0x45, 0x4e, 0x43, 0x48, 0x2e, 0x44, 0x41, // 015e name
+	0x54, 0x00,
+};
+
+struct Workload {
+	const char* name                 = nullptr;
+	const char* file                 = nullptr;
+	const std::vector<uint8_t>* image = nullptr;
+};
+
+const std::vector<Workload> Workloads = {
+        {"integer", "INTEGER.COM", &IntegerImage},
+        {"fpu", "FPU.COM", &FpuImage},
+        {"vga_13h", "VGA13H.COM", &Vga13hImage},
+        {"vga_mode_x", "MODEX.COM", &ModeXImage},
+        {"vesa_lfb", "VESA.COM", &VesaImage},
+        {"sound", "SOUND.COM", &SoundImage},
+        {"file_io", "FILEIO.COM", &FileIoImage},
+};
+
+struct Suite {
+	const char* name = nullptr;
+	// Indexes into 'Workloads'
+	std::vector<size_t> workloads = {};
+};
+
+const std::vector<Suite> Suites = {
+        {"all", {0, 1, 2, 3, 4, 5, 6}},
+        {"cpu", {0, 1}},
+        {"video", {2, 3, 4}},
+        {"audio", {5}},
+        {"io", {6}},
+};
+
+// Fixed cycles so every run emulates the same time, and the normal core
+// since the dynamic cores don't exist on every host
+const std::vector<std::string> Settings = {
+        "machine=svga_s3",
+        "memsize=16",
+        "ems=false",
+        "core=normal",
+        "cputype=pentium",
+        "cpu_cycles=100000",
+        "cpu_cycles_protected=100000",
+        "cpu_throttle=false",
+        "sblaster sbtype=sb16",
+        "sblaster sbbase=220",
+        "sblaster irq=7",
+        "sblaster dma=1",
+        "sblaster oplmode=opl3",
+        "mididevice=none",
+};
+
+constexpr auto WorkloadDirectory = "BENCH";
+
+// Emulated time a workload may take before the benchmark gives up on it,
+// and the time the shell may take to start the next one
+constexpr uint32_t WorkloadTimeoutMs = 60'000;
+constexpr uint32_t ShellTimeoutMs    = 5'000;
+
+using Counters = std::map<std::string, uint64_t>;
+
+struct Run {
+	size_t workload      = 0;
+	uint16_t psp_segment = 0;
+
+	std::chrono::steady_clock::time_point started = {};
+	uint64_t started_tick = 0;
+
+	Counters counters = {};
+};
+
+struct Benchmark {
+	const Suite* suite = nullptr;
+
+	// Mounted as C:, where the workloads write their files
+	std_fs::path work_directory = {};
+
+	std::optional<Run> run = {};
+
+	// Workloads of the suite that have finished
+	size_t num_finished = 0;
+
+	// DOSBOX_GetLockstepTicks() value the latest grant runs up to
+	uint64_t granted_until = 0;
+
+	bool has_timed_out = false;
+
+	std::vector<BenchmarkResult> results = {};
+};
+
+std::optional<Benchmark> benchmark = {};
+
+Counters sample_counters()
+{
+	Counters counters = {};
+	for (const auto& sample : PERF_Sample()) {
+		if (sample.kind == PerfKind::Counter) {
+			counters[sample.name] = static_cast<uint64_t>(sample.value);
+		}
+	}
+	return counters;
+}
+
+const Suite* find_suite(const std::string& name)
+{
+	for (const auto& suite : Suites) {
+		if (iequals(name, suite.name)) {
+			return &suite;
+		}
+	}
+	return nullptr;
+}
+
+void grant_ticks(const uint32_t num_ticks)
+{
+	assert(benchmark);
+	benchmark->granted_until = DOSBOX_GrantTicks(num_ticks);
+}
+
+// Settings come from the command line, so they may hold anything
+std::string escape_json(const std::string& text)
+{
+	std::string escaped = {};
+	for (const auto c : text) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+	return escaped;
+}
+
+std::string format_ms(const double ms)
+{
+	return format_str("%.1f", ms);
+}
+
+} // namespace
+
+double BenchmarkResult::EmulatedMips() const
+{
+	if (wall_ms <= 0.0) {
+		return 0.0;
+	}
+	const auto cycles = static_cast<double>(emulated_ms) *
+	                    static_cast<double>(cycles_per_ms);
+	return cycles / (wall_ms * 1000.0);
+}
+
+double BenchmarkResult::FramesPerSecond() const
+{
+	if (wall_ms <= 0.0) {
+		return 0.0;
+	}
+	return static_cast<double>(frames) * 1000.0 / wall_ms;
+}
+
+std::string BenchmarkReport::ToJson() const
+{
+	std::string json = {};
+	json += "{\"suite\":\"" + suite + "\"";
+	json += ",\"version\":\"" + escape_json(version) + "\"";
+	json += is_complete ? ",\"complete\":true" : ",\"complete\":false";
+
+	json += ",\"settings\":[";
+	for (size_t i = 0; i < settings.size(); ++i) {
+		json += (i > 0 ? ",\"" : "\"") + escape_json(settings[i]) + "\"";
+	}
+	json += "]";
+
+	BenchmarkResult total = {};
+
+	const auto append_measurements = [&](const BenchmarkResult& result) {
+		json += ",\"wall_ms\":" + format_ms(result.wall_ms);
+		json += ",\"emulated_ms\":" + std::to_string(result.emulated_ms);
+		json += ",\"emulated_mips\":" + format_str("%.1f", result.EmulatedMips());
+		json += ",\"frames\":" + std::to_string(result.frames);
+		json += ",\"frames_per_second\":" +
+		        format_str("%.1f", result.FramesPerSecond());
+		json += ",\"mixer_ms\":" +
+		        format_ms(static_cast<double>(result.mixer_us) / 1000.0);
+	};
+
+	json += ",\"workloads\":[";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const auto& result = results[i];
+		json += (i > 0 ? ",{" : "{");
+		json += "\"name\":\"" + result.name + "\"";
+		json += ",\"exit_code\":" + std::to_string(result.exit_code);
+		append_measurements(result);
+
+		json += ",\"counters\":{";
+		for (size_t j = 0; j < result.counters.size(); ++j) {
+			const auto& [name, value] = result.counters[j];
+			json += (j > 0 ? ",\"" : "\"") + name +
+			        "\":" + std::to_string(value);
+		}
+		json += "}}";
+
+		total.wall_ms += result.wall_ms;
+		total.emulated_ms += result.emulated_ms;
+		total.frames += result.frames;
+		total.mixer_us += result.mixer_us;
+		// Weighted by emulated time, so the total MIPS come out right
+		total.cycles_per_ms += result.cycles_per_ms *
+		                       static_cast<int64_t>(result.emulated_ms);
+	}
+	json += "]";
+
+	if (total.emulated_ms > 0) {
+		total.cycles_per_ms /= static_cast<int64_t>(total.emulated_ms);
+	}
+	json += ",\"total\":{";
+	json += "\"workloads\":" + std::to_string(results.size());
+	append_measurements(total);
+	json += "}}\n";
+	return json;
+}
+
+std::vector<std::string> BENCHMARK_GetSuiteNames()
+{
+	std::vector<std::string> names = {};
+	for (const auto& suite : Suites) {
+		names.emplace_back(suite.name);
+	}
+	return names;
+}
+
+bool BENCHMARK_Select(const std::string& suite_name)
+{
+	const auto suite = find_suite(suite_name);
+	if (!suite) {
+		return false;
+	}
+
+	// The file workloads need a writable drive that starts out empty
+	const auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+
+	std::error_code ec = {};
+	auto directory = std_fs::temp_directory_path(ec) /
+	                 format_str("dosbox-benchmark-%llx",
+	                            static_cast<unsigned long long>(stamp));
+	std_fs::create_directories(directory, ec);
+	if (ec) {
+		LOG_ERR("BENCHMARK: Unable to create a work directory: %s",
+		        ec.message().c_str());
+		return false;
+	}
+
+	benchmark        = Benchmark{};
+	benchmark->suite = suite;
+	benchmark->work_directory = std::move(directory);
+	LOG_MSG("BENCHMARK: Running the '%s' suite", suite->name);
+	return true;
+}
+
+bool BENCHMARK_IsActive()
+{
+	return benchmark.has_value();
+}
+
+std::vector<std::string> BENCHMARK_GetSettings()
+{
+	return Settings;
+}
+
+std::string BENCHMARK_GetWorkDirectory()
+{
+	return benchmark ? benchmark->work_directory.string() : std::string{};
+}
+
+std::vector<std::string> BENCHMARK_GetAutoexecLines()
+{
+	std::vector<std::string> lines = {};
+	if (!benchmark) {
+		return lines;
+	}
+	for (const auto index : benchmark->suite->workloads) {
+		lines.push_back(format_str("@Z:\\%s\\%s",
+		                           WorkloadDirectory,
+		                           Workloads[index].file));
+	}
+	return lines;
+}
+
+void BENCHMARK_MaybeRegisterWorkloads()
+{
+	if (!benchmark) {
+		return;
+	}
+	VFILE_Register(WorkloadDirectory, nullptr, 0, "/");
+
+	const auto directory = format_str("/%s/", WorkloadDirectory);
+	for (const auto& workload : Workloads) {
+		VFILE_Register(workload.file, *workload.image, directory.c_str());
+	}
+}
+
+void BENCHMARK_OnProgramStarted(const uint16_t psp_segment, const char* path)
+{
+	if (!benchmark || benchmark->run) {
+		return;
+	}
+	const auto& suite = *benchmark->suite;
+	if (benchmark->num_finished >= suite.workloads.size()) {
+		return;
+	}
+	const auto index    = suite.workloads[benchmark->num_finished];
+	const auto expected = format_str("Z:\\%s\\%s",
+	                                 WorkloadDirectory,
+	                                 Workloads[index].file);
+	if (!iequals(path, expected)) {
+		return;
+	}
+
+	// From here on, emulated time only passes as it's granted
+	DOSBOX_SetLockstep(true);
+	grant_ticks(WorkloadTimeoutMs);
+
+	Run run          = {};
+	run.workload     = index;
+	run.psp_segment  = psp_segment;
+	run.started_tick = DOSBOX_GetLockstepTicks();
+	run.counters     = sample_counters();
+	run.started      = std::chrono::steady_clock::now();
+
+	benchmark->run = std::move(run);
+}
+
+void BENCHMARK_OnProgramExited(const uint16_t psp_segment, const uint8_t exit_code)
+{
+	if (!benchmark || !benchmark->run || benchmark->run->psp_segment != psp_segment) {
+		return;
+	}
+	using namespace std::chrono;
+
+	const auto& run     = *benchmark->run;
+	const auto elapsed  = steady_clock::now() - run.started;
+	const auto counters = sample_counters();
+
+	BenchmarkResult result = {};
+	result.name            = Workloads[run.workload].name;
+	result.exit_code       = exit_code;
+	result.wall_ms     = duration_cast<duration<double, std::milli>>(elapsed).count();
+	result.emulated_ms = DOSBOX_GetLockstepTicks() - run.started_tick;
+	result.cycles_per_ms = CPU_CycleMax;
+
+	for (const auto& [name, value] : counters) {
+		const auto it = run.counters.find(name);
+		const auto before = (it == run.counters.end()) ? 0 : it->second;
+		if (value > before) {
+			result.counters.emplace_back(name, value - before);
+		}
+	}
+	const auto delta = [&](const char* name) -> uint64_t {
+		const auto it = std::find_if(result.counters.begin(),
+		                             result.counters.end(),
+		                             [&](const auto& counter) {
+			                             return counter.first == name;
+		                             });
+		return (it == result.counters.end()) ? 0 : it->second;
+	};
+	result.frames   = delta("vga_frames");
+	result.mixer_us = delta("mixer_mix_us");
+
+	LOG_MSG("BENCHMARK: '%s' took %.1f ms for %llu emulated ms, exit code %d",
+	        result.name.c_str(),
+	        result.wall_ms,
+	        static_cast<unsigned long long>(result.emulated_ms),
+	        result.exit_code);
+
+	benchmark->results.push_back(std::move(result));
+	benchmark->run.reset();
+	++benchmark->num_finished;
+
+	// Enough for the shell to start the next workload, or to exit
+	grant_ticks(ShellTimeoutMs);
+}
+
+void BENCHMARK_Poll()
+{
+	if (!benchmark || !DOSBOX_IsLockstep() || benchmark->has_timed_out ||
+	    DOSBOX_GetLockstepTicks() < benchmark->granted_until) {
+		return;
+	}
+	if (benchmark->run) {
+		LOG_ERR("BENCHMARK: '%s' didn't finish within %u emulated ms",
+		        Workloads[benchmark->run->workload].name,
+		        WorkloadTimeoutMs);
+	} else if (benchmark->num_finished < benchmark->suite->workloads.size()) {
+		LOG_ERR("BENCHMARK: The next workload didn't start within %u emulated ms",
+		        ShellTimeoutMs);
+	}
+	benchmark->has_timed_out = true;
+	shutdown_requested       = true;
+}
+
+bool BENCHMARK_Finish()
+{
+	if (!benchmark) {
+		return true;
+	}
+
+	BenchmarkReport report = {};
+	report.suite           = benchmark->suite->name;
+	report.version         = DOSBOX_GetDetailedVersion();
+	report.settings        = Settings;
+	if (control) {
+		// Anything set on the command line applies on top
+		const auto& overrides = control->arguments.set;
+		report.settings.insert(report.settings.end(),
+		                       overrides.begin(),
+		                       overrides.end());
+	}
+	report.results     = std::move(benchmark->results);
+	const auto num_workloads = benchmark->suite->workloads.size();
+	report.is_complete = !benchmark->has_timed_out &&
+	                     report.results.size() == num_workloads &&
+	                     std::all_of(report.results.begin(),
+	                                 report.results.end(),
+	                                 [](const BenchmarkResult& result) {
+		                                 return result.exit_code == 0;
+	                                 });
+
+	const auto json = report.ToJson();
+	std::fwrite(json.data(), 1, json.size(), stdout);
+	std::fflush(stdout);
+
+	std::error_code ec = {};
+	std_fs::remove_all(benchmark->work_directory, ec);
+
+	benchmark.reset();
+	return report.is_complete;
+}
@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_BENCHMARK_H
+#define DOSBOX_BENCHMARK_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Benchmark mode
+// ~~~~~~~~~~~~~~
+// 'dosbox --benchmark <suite>' measures how fast this build emulates on
+// this host, in a way that can be compared across builds and hosts. It
+// boots headless with a fixed configuration, runs the suite's workloads
+// from Z:\BENCH\ one after the other in lockstep, prints a JSON report on
+// stdout and exits.
+//
+// The workloads are small DOS programs built into DOSBox. Each does a
+// fixed amount of work, so with the fixed cycles every run emulates the
+// same number of milliseconds and only the wall-clock time differs. The
+// report gives each workload's wall time, emulated MIPS, frames drawn per
+// wall-clock second and time spent mixing audio, plus how much each
+// performance counter (see perf_counters.h) went up while it ran.
+
+struct BenchmarkResult {
+	std::string name = {};
+
+	// -1 if the workload didn't finish
+	int exit_code = -1;
+
+	double wall_ms       = 0.0;
+	uint64_t emulated_ms = 0;
+
+	// Emulated CPU cycles per millisecond during the run
+	int64_t cycles_per_ms = 0;
+
+	uint64_t frames   = 0;
+	uint64_t mixer_us = 0;
+
+	// Counters that went up during the run, by how much, sorted by name
+	std::vector<std::pair<std::string, uint64_t>> counters = {};
+
+	// Millions of emulated cycles per wall-clock second; the normal core
+	// counts about one cycle per instruction
+	double EmulatedMips() const;
+
+	double FramesPerSecond() const;
+};
+
+struct BenchmarkReport {
+	std::string suite                = {};
+	std::string version              = {};
+	std::vector<std::string> settings = {};
+
+	std::vector<BenchmarkResult> results = {};
+
+	// Whether every workload of the suite ran and exited with code 0
+	bool is_complete = false;
+
+	std::string ToJson() const;
+};
+
+// The suites --benchmark accepts, 'all' first
+std::vector<std::string> BENCHMARK_GetSuiteNames();
+
+// Selects the suite to run; returns false if there's no such suite
+bool BENCHMARK_Select(const std::string& suite);
+
+bool BENCHMARK_IsActive();
+
+// The settings the suite runs with, in the form --set takes
+std::vector<std::string> BENCHMARK_GetSettings();
+
+// The host directory the workloads write their files to, which the suite
+// runs in as C:
+std::string BENCHMARK_GetWorkDirectory();
+
+// The AUTOEXEC.BAT lines that run the suite's workloads
+std::vector<std::string> BENCHMARK_GetAutoexecLines();
+
+// Puts the workloads on Z: while a benchmark is selected
+void BENCHMARK_MaybeRegisterWorkloads();
+
+void BENCHMARK_OnProgramStarted(uint16_t psp_segment, const char* path);
+void BENCHMARK_OnProgramExited(uint16_t psp_segment, uint8_t exit_code);
+
+// Gives up on a workload that doesn't finish in time
+void BENCHMARK_Poll();
+
+// Prints the report and cleans up; returns false unless every workload
+// of the suite ran and exited with code 0
+bool BENCHMARK_Finish();
+
+#endif // DOSBOX_BENCHMARK_H
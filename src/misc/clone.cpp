@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/clone.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <SDL.h>
+
+#include "audio/mixer.h"
+#include "capture/capture.h"
+#include "dosbox.h"
+#include "misc/logging.h"
+#include "misc/savestate.h"
+#include "misc/std_filesystem.h"
+
+#if !defined(WIN32)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined(WIN32)
+
+int64_t CLONE_ForkInstance(std::string& error)
+{
+	error = "cloning is not supported on this platform";
+	return -1;
+}
+
+#else
+
+namespace {
+
+// Clones are not waited for anywhere else, so the ones that have exited
+// are collected on every clone to keep zombies from piling up
+std::vector<pid_t> clones = {};
+
+void reap_exited_clones()
+{
+	std::erase_if(clones, [](const pid_t pid) {
+		return waitpid(pid, nullptr, WNOHANG) != 0;
+	});
+}
+
+bool is_headless_video()
+{
+	const char* driver = SDL_GetCurrentVideoDriver();
+	if (!driver) {
+		return true;
+	}
+	return std::strcmp(driver, "dummy") == 0 || std::strcmp(driver, "offscreen") == 0;
+}
+
+// The number of threads in this process, or 0 if the platform can't tell
+size_t count_threads()
+{
+#if defined(LINUX)
+	std::error_code ec = {};
+	size_t count       = 0;
+	for (auto it = std_fs::directory_iterator("/proc/self/task", ec);
+	     !ec && it != std_fs::directory_iterator(); it.increment(ec)) {
+		++count;
+	}
+	return ec ? 0 : count;
+#else
+	return 0;
+#endif
+}
+
+} // namespace
+
+int64_t CLONE_ForkInstance(std::string& error)
+{
+	reap_exited_clones();
+
+	if (!is_headless_video()) {
+		error = "cloning needs the 'dummy' or 'offscreen' SDL video driver";
+		return -1;
+	}
+	if (MIXER_HasAudioDevice()) {
+		error = "cloning needs sound disabled ('output = null' or 'nosound = true')";
+		return -1;
+	}
+	if (CAPTURE_IsCapturingAudio() || CAPTURE_IsCapturingMidi() ||
+	    CAPTURE_IsCapturingVideo()) {
+		error = "cannot clone while capturing";
+		return -1;
+	}
+
+	MIXER_SuspendThread();
+	CAPTURE_SuspendImageSavers();
+	SAVESTATE_SuspendThreads();
+
+	const auto resume = [] {
+		SAVESTATE_ResumeThreads();
+		CAPTURE_ResumeImageSavers();
+		MIXER_ResumeThread();
+		// Neither process should try to catch up on the time the fork took
+		DOSBOX_ResetTickBase();
+	};
+
+	if (const auto num_threads = count_threads(); num_threads > 1) {
+		resume();
+		error = std::to_string(num_threads - 1) +
+		        " other threads are still running";
+		return -1;
+	}
+
+	const auto pid = fork();
+	if (pid < 0) {
+		resume();
+		error = std::string("fork failed: ") + std::strerror(errno);
+		return -1;
+	}
+
+	if (pid == 0) {
+		// Clones of the parent's children are not ours to reap
+		clones.clear();
+		resume();
+		LOG_MSG("CLONE: Running as clone %lld of process %lld",
+		        static_cast<long long>(getpid()),
+		        static_cast<long long>(getppid()));
+		return 0;
+	}
+
+	resume();
+	clones.push_back(pid);
+	LOG_MSG("CLONE: Forked clone %lld", static_cast<long long>(pid));
+	return pid;
+}
+
+#endif
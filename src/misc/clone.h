@@ -0,0 +1,31 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_CLONE_H
+#define DOSBOX_CLONE_H
+
+#include <cstdint>
+#include <string>
+
+// Instance cloning
+// ~~~~~~~~~~~~~~~~
+// Forks the running emulator into an independent child that starts from the
+// exact same machine state. Guest RAM, video memory, and the loaded binary
+// are shared copy-on-write, so a clone of a warmed-up instance costs
+// neither a boot nor its resident memory until the two diverge.
+//
+// fork() only carries the calling thread into the child, so every worker
+// thread (the mixer, the image savers, and the save-state page deflater
+// here, any others through the caller's own hooks) must be parked first,
+// and no thread may hold a lock.
+// Host resources that cannot be shared are refused up front: a real video
+// window and an audio device would be driven by two processes at once.
+// Cloning therefore needs a headless setup: SDL's 'dummy' or 'offscreen'
+// video driver and sound disabled in the mixer.
+
+// Returns the child's process ID in the parent, 0 in the child, and -1 with
+// 'error' set if cloning is not possible right now. Only valid between
+// emulation slices, like the save-state functions.
+int64_t CLONE_ForkInstance(std::string& error);
+
+#endif // DOSBOX_CLONE_H
@@ -0,0 +1,321 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/footprint.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+namespace {
+
+struct Registry {
+	std::mutex mutex                      = {};
+	std::vector<FootprintRegion*> regions = {};
+};
+
+// Never destroyed, so regions with static storage can unregister during
+// shutdown in any order
+Registry& registry()
+{
+	static auto instance = new Registry();
+	return *instance;
+}
+
+std::atomic<MemoryProfile> current_profile = MemoryProfile::Normal;
+
+size_t host_page_size()
+{
+#if defined(WIN32)
+	static const auto page_size = [] {
+		SYSTEM_INFO info = {};
+		GetSystemInfo(&info);
+		return static_cast<size_t>(info.dwPageSize);
+	}();
+#else
+	static const auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+	return page_size;
+}
+
+#if defined(__linux__)
+// The host pages that lie wholly inside the span, as [start, end)
+std::pair<uintptr_t, uintptr_t> inner_pages(const void* base, const size_t num_bytes)
+{
+	const auto page_size = host_page_size();
+	const auto first     = reinterpret_cast<uintptr_t>(base);
+	const auto start     = (first + page_size - 1) / page_size * page_size;
+	const auto end       = (first + num_bytes) / page_size * page_size;
+	return {start, std::max(start, end)};
+}
+#endif
+
+} // namespace
+
+void FOOTPRINT_SetProfile(const MemoryProfile profile)
+{
+	current_profile = profile;
+}
+
+MemoryProfile FOOTPRINT_GetProfile()
+{
+	return current_profile;
+}
+
+const char* FOOTPRINT_GetProfileName()
+{
+	return FOOTPRINT_GetProfile() == MemoryProfile::Low ? "lowmem" : "normal";
+}
+
+FootprintRegion::FootprintRegion(const char* name, const char* help,
+                                 TrimHandler trim_handler)
+        : m_name(name),
+          m_help(help),
+          m_trim_handler(std::move(trim_handler))
+{
+	assert(name && help);
+
+	auto& reg = registry();
+	const std::lock_guard lock(reg.mutex);
+	reg.regions.push_back(this);
+}
+
+FootprintRegion::~FootprintRegion()
+{
+	auto& reg = registry();
+	const std::lock_guard lock(reg.mutex);
+	std::erase(reg.regions, this);
+}
+
+void FootprintRegion::Track(const void* base, const size_t num_bytes)
+{
+	auto& reg = registry();
+	const std::lock_guard lock(reg.mutex);
+	m_base      = num_bytes ? base : nullptr;
+	m_num_bytes = base ? num_bytes : 0;
+}
+
+std::vector<FootprintSample> FOOTPRINT_Sample()
+{
+	std::vector<FootprintSample> samples = {};
+	{
+		auto& reg = registry();
+		const std::lock_guard lock(reg.mutex);
+		samples.reserve(reg.regions.size());
+		for (const auto region : reg.regions) {
+			const auto base      = region->m_base;
+			const auto num_bytes = region->m_num_bytes;
+			samples.push_back({region->m_name,
+			                   region->m_help,
+			                   num_bytes,
+			                   FOOTPRINT_CountResidentBytes(base, num_bytes)});
+		}
+	}
+	std::sort(samples.begin(), samples.end(), [](const auto& a, const auto& b) {
+		return a.name < b.name;
+	});
+	return samples;
+}
+
+std::optional<size_t> FOOTPRINT_GetProcessResidentBytes()
+{
+#if defined(__APPLE__)
+	mach_task_basic_info_data_t info = {};
+	mach_msg_type_number_t count     = MACH_TASK_BASIC_INFO_COUNT;
+	if (task_info(mach_task_self(),
+	              MACH_TASK_BASIC_INFO,
+	              reinterpret_cast<task_info_t>(&info),
+	              &count) != KERN_SUCCESS) {
+		return {};
+	}
+	return static_cast<size_t>(info.resident_size);
+#elif defined(__linux__)
+	// Total program size, then resident set, both in pages
+	std::ifstream statm("/proc/self/statm");
+	size_t total_pages    = 0;
+	size_t resident_pages = 0;
+	if (!(statm >> total_pages >> resident_pages)) {
+		return {};
+	}
+	return resident_pages * host_page_size();
+#else
+	return {};
+#endif
+}
+
+size_t FOOTPRINT_Trim()
+{
+	std::vector<FootprintRegion::TrimHandler> handlers = {};
+	{
+		auto& reg = registry();
+		const std::lock_guard lock(reg.mutex);
+		for (const auto region : reg.regions) {
+			if (region->m_trim_handler) {
+				handlers.push_back(region->m_trim_handler);
+			}
+		}
+	}
+
+	auto count_resident = [] {
+		size_t total = 0;
+		for (const auto& sample : FOOTPRINT_Sample()) {
+			total += sample.resident_bytes;
+		}
+		return total;
+	};
+
+	const auto resident_before = count_resident();
+	for (const auto& handler : handlers) {
+		handler();
+	}
+	const auto resident_after = count_resident();
+	return resident_before > resident_after ? resident_before - resident_after : 0;
+}
+
+size_t FOOTPRINT_CountResidentBytes(const void* base, const size_t num_bytes)
+{
+	if (!base || !num_bytes) {
+		return 0;
+	}
+#if defined(WIN32)
+	return num_bytes;
+#else
+	const auto page_size = host_page_size();
+	const auto first     = reinterpret_cast<uintptr_t>(base) / page_size * page_size;
+	const auto end       = reinterpret_cast<uintptr_t>(base) + num_bytes;
+	const auto num_pages = (end - first + page_size - 1) / page_size;
+
+#if defined(__APPLE__)
+	std::vector<char> residency(num_pages);
+#else
+	std::vector<unsigned char> residency(num_pages);
+#endif
+	if (mincore(reinterpret_cast<void*>(first), num_pages * page_size,
+	            residency.data()) != 0) {
+		return 0;
+	}
+	const auto num_resident = std::count_if(residency.begin(),
+	                                        residency.end(),
+	                                        [](const auto flags) {
+		                                        return (flags & 1) != 0;
+	                                        });
+	return static_cast<size_t>(num_resident) * page_size;
+#endif
+}
+
+bool FOOTPRINT_ReleasePages(void* base, const size_t num_bytes)
+{
+#if defined(__linux__)
+	if (!base || !num_bytes) {
+		return true;
+	}
+	// Private anonymous pages read back as zeros after MADV_DONTNEED;
+	// other hosts only promise that for freshly mapped memory
+	const auto [start, end] = inner_pages(base, num_bytes);
+	if (end > start &&
+	    madvise(reinterpret_cast<void*>(start), end - start, MADV_DONTNEED) != 0) {
+		return false;
+	}
+	const auto first = reinterpret_cast<uintptr_t>(base);
+	const auto last  = first + num_bytes;
+	if (end == start) {
+		std::memset(base, 0, num_bytes);
+	} else {
+		std::memset(base, 0, start - first);
+		std::memset(reinterpret_cast<void*>(end), 0, last - end);
+	}
+	return true;
+#else
+	(void)base;
+	(void)num_bytes;
+	return false;
+#endif
+}
+
+void FOOTPRINT_ZeroPages(void* base, const size_t num_bytes)
+{
+	if (FOOTPRINT_GetProfile() == MemoryProfile::Low &&
+	    FOOTPRINT_ReleasePages(base, num_bytes)) {
+		return;
+	}
+	std::memset(base, 0, num_bytes);
+}
+
+FootprintBuffer::FootprintBuffer(const size_t num_bytes)
+{
+	if (!num_bytes) {
+		return;
+	}
+#if defined(WIN32)
+	// Committed pages are still only backed on first touch
+	const auto block = VirtualAlloc(nullptr,
+	                                num_bytes,
+	                                MEM_RESERVE | MEM_COMMIT,
+	                                PAGE_READWRITE);
+	if (!block) {
+		throw std::bad_alloc();
+	}
+#else
+	const auto block = mmap(nullptr,
+	                        num_bytes,
+	                        PROT_READ | PROT_WRITE,
+	                        MAP_PRIVATE | MAP_ANONYMOUS,
+	                        -1,
+	                        0);
+	if (block == MAP_FAILED) {
+		throw std::bad_alloc();
+	}
+#endif
+	m_data      = static_cast<uint8_t*>(block);
+	m_num_bytes = num_bytes;
+}
+
+FootprintBuffer::~FootprintBuffer()
+{
+	Release();
+}
+
+FootprintBuffer::FootprintBuffer(FootprintBuffer&& other) noexcept
+        : m_data(std::exchange(other.m_data, nullptr)),
+          m_num_bytes(std::exchange(other.m_num_bytes, 0))
+{}
+
+FootprintBuffer& FootprintBuffer::operator=(FootprintBuffer&& other) noexcept
+{
+	if (this != &other) {
+		Release();
+		m_data      = std::exchange(other.m_data, nullptr);
+		m_num_bytes = std::exchange(other.m_num_bytes, 0);
+	}
+	return *this;
+}
+
+void FootprintBuffer::Release()
+{
+	if (!m_data) {
+		return;
+	}
+#if defined(WIN32)
+	VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+	munmap(m_data, m_num_bytes);
+#endif
+	m_data      = nullptr;
+	m_num_bytes = 0;
+}
@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_FOOTPRINT_H
+#define DOSBOX_FOOTPRINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Memory footprint
+// ~~~~~~~~~~~~~~~~
+// A registry of the emulator's large allocations, so the text-mode server's
+// MEMORY reply and 'perf /memory' can tell where the resident set goes.
+// Owners define a region next to the allocation, usually as a file-scope
+// static, and point it at the memory once they have it:
+//
+//   static FootprintRegion tlb_region("paging_tlb", "Paging TLB arrays.");
+//   ...
+//   tlb_region.Track(&paging.tlb, sizeof(paging.tlb));
+//
+// A region reports how many bytes it spans and how many of those the host
+// currently has in memory, counted page by page with mincore(); hosts
+// without it count the whole span as resident.
+//
+// Regions whose contents can be rebuilt pass a trim handler that hands
+// their pages back to the host. FOOTPRINT_Trim() runs them all, so callers
+// that see memory pressure can shrink the emulator without restarting it.
+// Trim handlers change emulator state, so only call it from the emulation
+// thread between CPU slices.
+//
+// The 'memory_profile = lowmem' setting selects MemoryProfile::Low, which
+// trades a few page faults for a smaller footprint: memory the emulator
+// clears in bulk, like the TLB on a paging reset or video memory on a mode
+// change, goes back to the host instead of being overwritten with zeros.
+
+enum class MemoryProfile { Normal, Low };
+
+void FOOTPRINT_SetProfile(MemoryProfile profile);
+MemoryProfile FOOTPRINT_GetProfile();
+
+// "normal" or "lowmem", as the setting spells it
+const char* FOOTPRINT_GetProfileName();
+
+struct FootprintSample {
+	std::string name      = {};
+	std::string help      = {};
+	size_t reserved_bytes = 0;
+	size_t resident_bytes = 0;
+};
+
+class FootprintRegion {
+public:
+	using TrimHandler = std::function<void()>;
+
+	FootprintRegion(const char* name, const char* help,
+	                TrimHandler trim_handler = {});
+	~FootprintRegion();
+
+	FootprintRegion(const FootprintRegion&)            = delete;
+	FootprintRegion& operator=(const FootprintRegion&) = delete;
+
+	// Points the region at the memory it covers, replacing what it
+	// covered before; zero bytes leave it empty
+	void Track(const void* base, size_t num_bytes);
+
+	const char* Name() const
+	{
+		return m_name;
+	}
+
+private:
+	friend std::vector<FootprintSample> FOOTPRINT_Sample();
+	friend size_t FOOTPRINT_Trim();
+
+	const char* m_name = nullptr;
+	const char* m_help = nullptr;
+
+	TrimHandler m_trim_handler = {};
+
+	// Guarded by the registry's mutex
+	const void* m_base = nullptr;
+	size_t m_num_bytes = 0;
+};
+
+// Everything currently registered, sorted by name
+std::vector<FootprintSample> FOOTPRINT_Sample();
+
+// The resident set of the whole process, if the host reports it
+std::optional<size_t> FOOTPRINT_GetProcessResidentBytes();
+
+// Runs every trim handler and returns how many resident bytes the regions
+// gave back
+size_t FOOTPRINT_Trim();
+
+// How many bytes of the span the host has in memory, rounded out to whole
+// host pages
+size_t FOOTPRINT_CountResidentBytes(const void* base, size_t num_bytes);
+
+// Zeroes the bytes and hands the host pages that lie wholly inside them
+// back to the host, which maps in fresh zero pages when they're next
+// touched. Only works on private anonymous memory: the heap, zeroed
+// static storage and FootprintBuffer. Returns false, leaving the bytes
+// untouched, on hosts that can't do this.
+bool FOOTPRINT_ReleasePages(void* base, size_t num_bytes);
+
+// Zeroes the bytes; with the low memory profile, by releasing their pages
+// where the host allows it
+void FOOTPRINT_ZeroPages(void* base, size_t num_bytes);
+
+// Zeroed memory straight from the host, which only commits each page the
+// first time it's touched. Page aligned.
+class FootprintBuffer {
+public:
+	FootprintBuffer() = default;
+	explicit FootprintBuffer(size_t num_bytes);
+	~FootprintBuffer();
+
+	FootprintBuffer(FootprintBuffer&& other) noexcept;
+	FootprintBuffer& operator=(FootprintBuffer&& other) noexcept;
+
+	FootprintBuffer(const FootprintBuffer&)            = delete;
+	FootprintBuffer& operator=(const FootprintBuffer&) = delete;
+
+	uint8_t* data() const
+	{
+		return m_data;
+	}
+	size_t size() const
+	{
+		return m_num_bytes;
+	}
+
+private:
+	void Release();
+
+	uint8_t* m_data    = nullptr;
+	size_t m_num_bytes = 0;
+};
+
+#endif // DOSBOX_FOOTPRINT_H
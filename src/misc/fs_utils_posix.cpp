@@ -13,11 +13,19 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
+#include <vector>
 
 #if defined(HAVE_SYS_XATTR_H)
 #include <sys/xattr.h>
 #endif
 
+#if defined(LINUX)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#elif defined(MACOSX)
+#include <copyfile.h>
+#endif
+
 #include "dos/dos_inc.h"
 #include "misc/logging.h"
 #include "utils/string_utils.h"
@@ -438,6 +446,67 @@ bool truncate_native_file(const NativeFileHandle handle)
 	return ftruncate(handle, current_position) == 0;
 }
 
+bool copy_native_file(const NativeFileHandle src, const NativeFileHandle dst)
+{
+	if (ftruncate(dst, 0) != 0) {
+		return false;
+	}
+
+#if defined(LINUX)
+	// Copy-on-write filesystems (Btrfs, XFS, ...) share the extents, so
+	// nothing is copied at all
+	if (ioctl(dst, FICLONE, src) == 0) {
+		return true;
+	}
+	// Otherwise the kernel copies without going through user space, or
+	// the server does on network filesystems
+	loff_t src_offset = 0;
+	loff_t dst_offset = 0;
+	for (;;) {
+		constexpr size_t MaxBytesAtOnce = 1024 * 1024 * 1024;
+		const auto num_bytes = copy_file_range(
+		        src, &src_offset, dst, &dst_offset, MaxBytesAtOnce, 0);
+		if (num_bytes == 0) {
+			return true;
+		}
+		if (num_bytes < 0) {
+			// Unsupported between these files, so still untouched
+			if (dst_offset == 0 && (errno == EXDEV || errno == EINVAL ||
+			                        errno == ENOSYS || errno == EOPNOTSUPP)) {
+				break;
+			}
+			return false;
+		}
+	}
+#elif defined(MACOSX)
+	if (lseek(src, 0, SEEK_SET) == 0 &&
+	    fcopyfile(src, dst, nullptr, COPYFILE_DATA) == 0) {
+		return true;
+	}
+	if (ftruncate(dst, 0) != 0) {
+		return false;
+	}
+#endif
+
+	if (lseek(src, 0, SEEK_SET) != 0 || lseek(dst, 0, SEEK_SET) != 0) {
+		return false;
+	}
+	std::vector<uint8_t> buffer(1024 * 1024);
+	for (;;) {
+		const auto ret = read_native_file(src, buffer.data(), buffer.size());
+		if (ret.error) {
+			return false;
+		}
+		if (ret.num_bytes == 0) {
+			return true;
+		}
+		const auto written = write_native_file(dst, buffer.data(), ret.num_bytes);
+		if (written.error || written.num_bytes != ret.num_bytes) {
+			return false;
+		}
+	}
+}
+
 DosDateTime get_dos_file_time(const NativeFileHandle handle)
 {
 	// Legal defaults if we're unable to populate them
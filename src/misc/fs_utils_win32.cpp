@@ -9,6 +9,7 @@
 #include <fcntl.h>
 #include <io.h>
 #include <sys/stat.h>
+#include <vector>
 
 #include "misc/compiler.h"
 #include "dos/dos_inc.h"
@@ -202,6 +203,28 @@ bool truncate_native_file(const NativeFileHandle handle)
 	return SetEndOfFile(handle);
 }
 
+bool copy_native_file(const NativeFileHandle src, const NativeFileHandle dst)
+{
+	if (seek_native_file(src, 0, NativeSeek::Set) != 0 ||
+	    seek_native_file(dst, 0, NativeSeek::Set) != 0 || !SetEndOfFile(dst)) {
+		return false;
+	}
+	std::vector<uint8_t> buffer(1024 * 1024);
+	for (;;) {
+		const auto ret = read_native_file(src, buffer.data(), buffer.size());
+		if (ret.error) {
+			return false;
+		}
+		if (ret.num_bytes == 0) {
+			return true;
+		}
+		const auto written = write_native_file(dst, buffer.data(), ret.num_bytes);
+		if (written.error || written.num_bytes != ret.num_bytes) {
+			return false;
+		}
+	}
+}
+
 DosDateTime get_dos_file_time(const NativeFileHandle handle)
 {
 	// Legal defaults if we're unable to populate them
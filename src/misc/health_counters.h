@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_HEALTH_COUNTERS_H
+#define DOSBOX_HEALTH_COUNTERS_H
+
+#include "misc/perf_counters.h"
+
+// Health counters
+// ~~~~~~~~~~~~~~~
+// The performance counters that are read outside the subsystem bumping
+// them (the renderer, the audio callback, the dynamic core's block cache,
+// the paging unit), such as by the Tracy plots. Like every other
+// PerfCounter they're registered, so METRICS, STATS JSON and PERF list
+// them too.
+
+struct HealthCounters {
+	// Frames handed to the display and frames the renderer skipped
+	// because it was still busy or the display refused the update
+	PerfCounter frames_presented = {"frames_presented",
+	                                "Frames handed to the display."};
+	PerfCounter frames_dropped   = {"frames_dropped",
+	                                "Frames the renderer skipped."};
+
+	// Frames not drawn at all because the emulation fell behind real time
+	// with 'auto_frameskip' on
+	PerfCounter frames_skipped = {"frames_skipped",
+	                              "Frames skipped to let the emulation catch up."};
+
+	// Audio callbacks that ran out of mixed frames and padded with silence
+	PerfCounter mixer_underruns = {"mixer_underruns",
+	                               "Audio callbacks padded with silence."};
+
+	// Code blocks the dynamic core translated, and translated blocks
+	// thrown away, by self-modifying code or to make room in the cache
+	PerfCounter dynrec_blocks_compiled = {
+	        "dynrec_blocks_compiled",
+	        "Code blocks translated by the dynamic core."};
+	PerfCounter dynrec_blocks_invalidated = {
+	        "dynrec_blocks_invalidated",
+	        "Translated code blocks discarded by the dynamic core."};
+
+	// Guest writes that hit translated code, i.e. self-modifying code
+	PerfCounter dynrec_code_writes = {
+	        "dynrec_code_writes",
+	        "Guest writes that invalidated translated code."};
+
+	// Linear pages looked up in the page tables because their TLB entry
+	// wasn't initialised yet
+	PerfCounter tlb_misses = {"tlb_misses",
+	                          "Pages looked up in the page tables on a TLB miss."};
+};
+
+inline HealthCounters health_counters = {};
+
+#endif // DOSBOX_HEALTH_COUNTERS_H
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/host_dir_watcher.h"
+
+#include "dosbox.h"
+
+#if defined(LINUX)
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "misc/logging.h"
+
+namespace {
+
+constexpr uint32_t WatchedEvents = IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                                   IN_MOVED_TO | IN_DELETE_SELF |
+                                   IN_MOVE_SELF | IN_ONLYDIR;
+
+} // namespace
+
+HostDirWatcher::HostDirWatcher() : fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC))
+{
+	if (fd < 0) {
+		LOG_WARNING("DIRCACHE: Can't watch host directories: %s",
+		            strerror(errno));
+	}
+}
+
+HostDirWatcher::~HostDirWatcher()
+{
+	if (fd >= 0) {
+		close(fd);
+	}
+}
+
+int HostDirWatcher::Watch(const char* path)
+{
+	if (fd < 0) {
+		return -1;
+	}
+	const auto watch = inotify_add_watch(fd, path, WatchedEvents);
+	if (watch < 0 && errno == ENOSPC) {
+		static bool is_logged = false;
+		if (!is_logged) {
+			LOG_WARNING("DIRCACHE: Out of host directory watches, "
+			            "raise fs.inotify.max_user_watches to watch more");
+			is_logged = true;
+		}
+	}
+	return watch;
+}
+
+void HostDirWatcher::Unwatch(const int watch)
+{
+	if (fd >= 0 && watch >= 0) {
+		inotify_rm_watch(fd, watch);
+	}
+}
+
+std::vector<HostDirWatcher::Change> HostDirWatcher::TakeChanges()
+{
+	std::vector<Change> changes = {};
+	if (fd < 0) {
+		return changes;
+	}
+	alignas(inotify_event) char buffer[16 * 1024];
+	for (;;) {
+		const auto bytes = read(fd, buffer, sizeof(buffer));
+		if (bytes <= 0) {
+			// EAGAIN once everything is read
+			break;
+		}
+		for (auto pos = buffer; pos < buffer + bytes;) {
+			const auto event = reinterpret_cast<const inotify_event*>(pos);
+			pos += sizeof(inotify_event) + event->len;
+
+			Change change = {};
+			change.watch  = event->wd;
+			change.is_dir = (event->mask & IN_ISDIR) != 0;
+			if (event->len > 0) {
+				change.name = event->name;
+			}
+			if (event->mask & IN_Q_OVERFLOW) {
+				change.type = ChangeType::Overflow;
+			} else if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+				change.type = ChangeType::Added;
+			} else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+				change.type = ChangeType::Removed;
+			} else if (event->mask &
+			           (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+				change.type = ChangeType::Gone;
+			} else {
+				continue;
+			}
+			changes.push_back(std::move(change));
+		}
+	}
+	return changes;
+}
+
+#else
+
+HostDirWatcher::HostDirWatcher() = default;
+
+HostDirWatcher::~HostDirWatcher() = default;
+
+int HostDirWatcher::Watch(const char*)
+{
+	return -1;
+}
+
+void HostDirWatcher::Unwatch(const int) {}
+
+std::vector<HostDirWatcher::Change> HostDirWatcher::TakeChanges()
+{
+	return {};
+}
+
+#endif
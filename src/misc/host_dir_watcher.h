@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_HOST_DIR_WATCHER_H
+#define DOSBOX_HOST_DIR_WATCHER_H
+
+#include <string>
+#include <vector>
+
+// Host directory watcher
+// ~~~~~~~~~~~~~~~~~~~~~~
+// Tells when entries are added to or removed from host directories, so
+// listings cached from them can follow along instead of being rescanned.
+//
+// Changes are picked up on the thread that asks for them, without
+// blocking, and include everything the host finished doing before the
+// call. Only Linux hosts (inotify) can watch directories for now;
+// elsewhere nothing is watched and callers keep rescanning.
+
+class HostDirWatcher {
+public:
+	enum class ChangeType {
+		Added,
+		Removed,
+		// The watched directory itself was deleted or moved, and
+		// isn't watched anymore
+		Gone,
+		// Changes were lost, so nothing that's watched can be trusted
+		Overflow,
+	};
+
+	struct Change {
+		int watch       = -1;
+		ChangeType type = ChangeType::Added;
+		std::string name = {};
+		bool is_dir      = false;
+	};
+
+	HostDirWatcher();
+	~HostDirWatcher();
+
+	HostDirWatcher(const HostDirWatcher&)            = delete;
+	HostDirWatcher& operator=(const HostDirWatcher&) = delete;
+
+	bool IsAvailable() const
+	{
+		return fd >= 0;
+	}
+
+	// The id of the watch, or -1 if the directory can't be watched. A
+	// directory that's already watched keeps its id.
+	int Watch(const char* path);
+
+	void Unwatch(int watch);
+
+	// The changes since the last call, in the order they happened
+	std::vector<Change> TakeChanges();
+
+private:
+	int fd = -1;
+};
+
+#endif // DOSBOX_HOST_DIR_WATCHER_H
@@ -0,0 +1,274 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/logging.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "misc/support.h"
+#include "utils/checks.h"
+#include "utils/spsc_queue.h"
+#include "utils/string_utils.h"
+
+CHECK_NARROWING();
+
+// Asynchronous log writer
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// Loguru writes each message to stderr and flushes it on the logging
+// thread, under its own lock. A device logging from the emulation or audio
+// thread thus pays for a system call per message, and every other thread
+// that logs meanwhile waits behind it.
+//
+// Once started, the writer takes over loguru's stderr output: loguru still
+// formats the message on the calling thread (the arguments of a printf-style
+// call can't outlive it), but the finished line is handed to a background
+// thread through a lock-free ring, and that thread writes and flushes whole
+// batches. Loguru calls its callbacks under its lock, so the ring only ever
+// sees one producer at a time.
+//
+// A call site that floods the log is held to a number of messages per
+// second; the rest are counted and summed up once it logs again. If the
+// ring is full the message is dropped and counted rather than stalling the
+// caller. Errors are the exception: the caller waits until they're written,
+// so the last words before a crash or an abort make it out.
+
+namespace {
+
+constexpr auto CallbackId = "dosbox:async_writer";
+
+constexpr size_t QueueCapacity = 4096;
+
+constexpr int MaxMessagesPerSite = 20;
+
+constexpr auto RateLimitWindow = std::chrono::seconds(1);
+
+constexpr auto MaxErrorWait = std::chrono::milliseconds(100);
+
+// Not exported by loguru, but part of its colored output
+constexpr auto TerminalDim = "\x1b[2m";
+
+struct CallSite {
+	const char* filename = nullptr;
+	unsigned line        = 0;
+
+	bool operator==(const CallSite& other) const = default;
+};
+
+struct CallSiteHash {
+	size_t operator()(const CallSite& site) const
+	{
+		return std::hash<const char*>{}(site.filename) ^
+		       (static_cast<size_t>(site.line) << 1);
+	}
+};
+
+struct CallSiteState {
+	std::chrono::steady_clock::time_point window_start = {};
+
+	int num_in_window  = 0;
+	int num_suppressed = 0;
+};
+
+struct AsyncWriter {
+	SpscQueue<std::string> queue{QueueCapacity};
+
+	std::thread thread = {};
+
+	loguru::Verbosity stderr_verbosity = loguru::Verbosity_OFF;
+
+	// Only touched by the producer side, under loguru's lock
+	uint64_t num_queued = 0;
+	int num_dropped     = 0;
+
+	std::unordered_map<CallSite, CallSiteState, CallSiteHash> call_sites = {};
+
+	std::atomic<uint64_t> num_written = 0;
+};
+
+std::unique_ptr<AsyncWriter> writer = {};
+
+std::string format_line(const loguru::Message& message)
+{
+	const auto verbosity = message.verbosity;
+
+	std::string line = {};
+	if (loguru::g_colorlogtostderr && loguru::terminal_has_color()) {
+		line += loguru::terminal_reset();
+		if (verbosity > loguru::Verbosity_WARNING) {
+			line += TerminalDim;
+			line += message.preamble;
+			line += message.indentation;
+			if (verbosity == loguru::Verbosity_INFO) {
+				line += loguru::terminal_reset();
+			}
+		} else {
+			line += (verbosity == loguru::Verbosity_WARNING)
+			              ? loguru::terminal_yellow()
+			              : loguru::terminal_red();
+			line += message.preamble;
+			line += message.indentation;
+		}
+		line += message.prefix;
+		line += message.message;
+		line += loguru::terminal_reset();
+	} else {
+		line += message.preamble;
+		line += message.indentation;
+		line += message.prefix;
+		line += message.message;
+	}
+	line += '\n';
+	return line;
+}
+
+// Producer side; the caller holds loguru's lock
+bool enqueue_line(std::string&& line)
+{
+	if (writer->queue.IsFull()) {
+		++writer->num_dropped;
+		return false;
+	}
+	if (writer->num_dropped > 0) {
+		// Leave room for the note and the line itself
+		if (writer->queue.Size() + 2 > writer->queue.MaxCapacity()) {
+			++writer->num_dropped;
+			return false;
+		}
+		writer->queue.Enqueue(format_str("LOG: Dropped %d messages, "
+		                                 "the log writer fell behind\n",
+		                                 writer->num_dropped));
+		++writer->num_queued;
+		writer->num_dropped = 0;
+	}
+	writer->queue.Enqueue(std::move(line));
+	++writer->num_queued;
+	return true;
+}
+
+void enqueue_suppressed_note(const CallSite& site, const CallSiteState& state)
+{
+	if (state.num_suppressed > 0) {
+		enqueue_line(format_str("LOG: Suppressed %d similar messages "
+		                        "from %s:%u\n",
+		                        state.num_suppressed,
+		                        site.filename,
+		                        site.line));
+	}
+}
+
+// Returns false if the call site has used up its messages for now
+bool is_within_rate_limit(const loguru::Message& message)
+{
+	const auto now = std::chrono::steady_clock::now();
+
+	auto& site = writer->call_sites[{message.filename, message.line}];
+
+	if (now - site.window_start >= RateLimitWindow) {
+		enqueue_suppressed_note({message.filename, message.line}, site);
+		site.window_start   = now;
+		site.num_in_window  = 0;
+		site.num_suppressed = 0;
+	}
+	if (site.num_in_window >= MaxMessagesPerSite) {
+		++site.num_suppressed;
+		return false;
+	}
+	++site.num_in_window;
+	return true;
+}
+
+void log_callback(void*, const loguru::Message& message)
+{
+	assert(writer);
+
+	const auto is_fatal = (message.verbosity == loguru::Verbosity_FATAL);
+	if (!is_fatal && !is_within_rate_limit(message)) {
+		return;
+	}
+	if (!enqueue_line(format_line(message))) {
+		return;
+	}
+	if (message.verbosity > loguru::Verbosity_ERROR) {
+		return;
+	}
+
+	// Errors don't return until they've been written, within reason
+	const auto deadline = std::chrono::steady_clock::now() + MaxErrorWait;
+	while (writer->num_written.load(std::memory_order_acquire) <
+	       writer->num_queued) {
+		if (std::chrono::steady_clock::now() >= deadline) {
+			break;
+		}
+		std::this_thread::yield();
+	}
+}
+
+// Consumer side: writes whatever is queued, and flushes once it runs dry
+void write_lines()
+{
+	while (auto line = writer->queue.Dequeue()) {
+		uint64_t num_lines = 0;
+		do {
+			fwrite(line->data(), 1, line->size(), stderr);
+			++num_lines;
+		} while (!writer->queue.IsEmpty() && (line = writer->queue.Dequeue()));
+
+		fflush(stderr);
+		writer->num_written.fetch_add(num_lines, std::memory_order_release);
+	}
+}
+
+} // namespace
+
+void LOG_StartAsyncWriter()
+{
+	if (writer || loguru::g_stderr_verbosity == loguru::Verbosity_OFF) {
+		return;
+	}
+	writer = std::make_unique<AsyncWriter>();
+
+	writer->queue.Start();
+	writer->thread = std::thread(write_lines);
+	set_thread_name(writer->thread, "dosbox:log");
+
+	// The callback takes over at the same cutoff, so messages below it
+	// still cost a single comparison at the call site
+	writer->stderr_verbosity = loguru::g_stderr_verbosity;
+	loguru::add_callback(CallbackId, log_callback, nullptr, writer->stderr_verbosity);
+	loguru::g_stderr_verbosity = loguru::Verbosity_OFF;
+
+	std::atexit(LOG_StopAsyncWriter);
+}
+
+void LOG_StopAsyncWriter()
+{
+	if (!writer) {
+		return;
+	}
+
+	// Removing the callback takes loguru's lock, so once it returns no
+	// thread can be queueing anymore. Direct output comes back first; at
+	// worst a message logged in between shows up twice.
+	loguru::g_stderr_verbosity = writer->stderr_verbosity;
+	loguru::remove_callback(CallbackId);
+
+	for (const auto& [site, state] : writer->call_sites) {
+		enqueue_suppressed_note(site, state);
+	}
+
+	// The writer drains what's left before it sees the queue stopped
+	writer->queue.Stop();
+	if (writer->thread.joinable()) {
+		writer->thread.join();
+	}
+
+	writer.reset();
+}
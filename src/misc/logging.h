@@ -75,6 +75,12 @@ void GFX_ShowMsg(const char* format, ...)
 
 #endif // C_DEBUGGER
 
+// Moves loguru's stderr output to a background thread, so logging threads
+// don't wait on the terminal; call after loguru::init(). Stopping drains the
+// pending messages and happens at exit regardless.
+void LOG_StartAsyncWriter();
+void LOG_StopAsyncWriter();
+
 #ifdef NDEBUG
 // LOG_DEBUG exists only for messages useful during development, and not to
 // be redirected into internal DOSBox debugger for DOS programs (C_DEBUGGER feature).
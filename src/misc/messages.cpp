@@ -21,6 +21,7 @@
 #include <fstream>
 #include <map>
 #include <set>
+#include <sstream>
 #include <string>
 
 CHECK_NARROWING();
@@ -36,10 +37,12 @@ class Message {
 public:
 	// Note: any message needs to be verified before it can be safely used!
 
-	Message(const std::string& message, const bool is_english);
+	// English messages keep a copy of their text, while translated ones
+	// refer to the text of the loaded translation file
+	Message(const std::string_view message, const bool is_english);
 
 	const std::string& Get();
-	const std::string& GetRaw();
+	std::string_view GetRaw() const;
 
 	bool IsValid() const
 	{
@@ -73,7 +76,8 @@ private:
 	bool is_ok       = true;
 
 	// Original message, UTF-8, can contain DOSBox ANSI markups
-	std::string message_raw = {};
+	std::string message_raw          = {};
+	std::string_view translated_text = {};
 	// Message in DOS encoding, markups converted to ANSI control codes
 	std::string message_dos_ansi = {};
 
@@ -93,10 +97,15 @@ private:
 	std::vector<FormatSpecifier> format_specifiers = {};
 };
 
-Message::Message(const std::string& message, const bool is_english)
-        : is_english(is_english),
-          message_raw(message)
-{}
+Message::Message(const std::string_view message, const bool is_english)
+        : is_english(is_english)
+{
+	if (is_english) {
+		message_raw = message;
+	} else {
+		translated_text = message;
+	}
+}
 
 std::string Message::GetLogStart(const std::string& message_key) const
 {
@@ -107,15 +116,17 @@ std::string Message::GetLogStart(const std::string& message_key) const
 
 const std::string& Message::Get()
 {
-	if (message_raw.empty()) {
-		return message_raw;
+	const auto message = GetRaw();
+	if (message.empty()) {
+		message_dos_ansi.clear();
+		return message_dos_ansi;
 	}
 
 	const auto current_code_page = get_utf8_code_page();
 	if (message_dos_ansi.empty() || code_page != current_code_page) {
 		code_page = current_code_page;
 
-		message_dos_ansi = utf8_to_dos(convert_ansi_markup(message_raw),
+		message_dos_ansi = utf8_to_dos(convert_ansi_markup(std::string(message)),
 		                               DosStringConvertMode::WithControlCodes,
 		                               UnicodeFallback::Box,
 		                               code_page);
@@ -124,9 +135,9 @@ const std::string& Message::Get()
 	return message_dos_ansi;
 }
 
-const std::string& Message::GetRaw()
+std::string_view Message::GetRaw() const
 {
-	return message_raw;
+	return is_english ? std::string_view(message_raw) : translated_text;
 }
 
 void Message::VerifyMessage(const std::string& message_key)
@@ -135,7 +146,7 @@ void Message::VerifyMessage(const std::string& message_key)
 		return;
 	}
 
-	for (const auto item : message_raw) {
+	for (const auto item : GetRaw()) {
 		if (item == '\n' || is_extended_printable_ascii(item)) {
 			continue;
 		}
@@ -157,13 +168,13 @@ void Message::VerifyFormatString(const std::string& message_key)
 	}
 
 	// clang-format off
-	const std::set<char> Flags   = {
+	static const std::set<char> Flags   = {
 		'-', '+', ' ', '#', '0'
 	};
-	const std::set<char> Lengths = {
+	static const std::set<char> Lengths = {
 		'h', 'l', 'j', 'z', 't', 'L'
 	};
-	const std::set<char> Formats = {
+	static const std::set<char> Formats = {
 		'd', 'i', 'u', 'o', 'x', 'X', 'f', 'F', 'e', 'E', 'g', 'G',
 		'a', 'A', 'c', 'C', 's', 'p', 'n'
 	};
@@ -184,8 +195,11 @@ void Message::VerifyFormatString(const std::string& message_key)
 		is_ok = false;
 	};
 
+	// Parsed from a copy, which unlike a view of the text is terminated
+	const std::string message(GetRaw());
+
 	// Look for format specifier
-	for (auto it = message_raw.begin(); it < message_raw.end(); ++it) {
+	for (auto it = message.begin(); it < message.end(); ++it) {
 		if (*it != '%') {
 			// Not a format specifier
 			continue;
@@ -397,9 +411,13 @@ std::string Message::FormatSpecifier::AsString() const
 
 static std::vector<std::string> message_order = {};
 
-static std::map<std::string, Message> dictionary_english    = {};
-static std::map<std::string, Message> dictionary_translated = {};
-static std::optional<Script> translation_script             = {};
+static std::map<std::string, Message> dictionary_english = {};
+static std::optional<Script> translation_script          = {};
+
+// Translated messages and their keys refer to the text of the translation
+// file, which is read whole and kept for as long as they are
+static std::string translation_text = {};
+static std::map<std::string_view, Message, std::less<>> dictionary_translated = {};
 
 // Whether the translation is compatible with the current code page
 static bool is_code_page_compatible = true;
@@ -464,9 +482,43 @@ static bool check_message_exists(const std::string& message_key)
 	return true;
 }
 
+// Messages are verified on first use rather than as they're added, so
+// starting up doesn't pay for checking the thousands it never shows. Debug
+// builds still verify each message as it's added, so mistakes show up at
+// once, and writing a translation file verifies them all.
+static Message& get_verified_english(const std::string& message_key)
+{
+	auto& english = dictionary_english.at(message_key);
+	english.VerifyEnglish(message_key);
+	return english;
+}
+
+static bool is_translation_valid(const std::string& message_key)
+{
+	if (!dictionary_translated.contains(message_key)) {
+		return false;
+	}
+
+	auto& translated = dictionary_translated.at(message_key);
+	if (dictionary_english.contains(message_key)) {
+		translated.VerifyTranslated(message_key,
+		                            get_verified_english(message_key));
+	}
+	return translated.IsValid();
+}
+
+static void verify_all_messages()
+{
+	for (const auto& message_key : message_order) {
+		get_verified_english(message_key);
+		is_translation_valid(message_key);
+	}
+}
+
 static void clear_translated_messages()
 {
 	dictionary_translated.clear();
+	translation_text.clear();
 	translation_script = {};
 }
 
@@ -484,8 +536,33 @@ static bool load_messages_from_path(const std_fs::path& file_path)
 
 	std::ifstream in_file(file_path);
 
-	std::string line = {};
-	int line_number  = -1;
+	std::stringstream file_contents = {};
+	file_contents << in_file.rdbuf();
+	if (in_file.bad()) {
+		LOG_ERR("LOCALE: Translation file '%s' I/O error",
+		        file_path.string().c_str());
+		return false;
+	}
+	translation_text = file_contents.str();
+
+	// Walk the lines in place; the messages and their keys are views of
+	// the text, so there's no copy of each
+	std::string_view remaining_text = translation_text;
+
+	std::string_view line = {};
+	int line_number       = -1;
+
+	auto get_line = [&]() {
+		if (remaining_text.empty()) {
+			return false;
+		}
+		const auto end = remaining_text.find('\n');
+		line           = remaining_text.substr(0, end);
+		remaining_text = (end == std::string_view::npos)
+		                       ? std::string_view{}
+		                       : remaining_text.substr(end + 1);
+		return true;
+	};
 
 	auto problem_generic = [&](const std::string& error) {
 		LOG_ERR("LOCALE: Translation file '%s' error in line %d: %s",
@@ -496,26 +573,26 @@ static bool load_messages_from_path(const std_fs::path& file_path)
 		clear_translated_messages();
 	};
 
-	auto problem_with_message = [&](const std::string& message_key,
+	auto problem_with_message = [&](const std::string_view message_key,
 	                                const std::string& error) {
 		LOG_ERR("LOCALE: Translation file '%s' error in line %d, "
 		        "message '%s': %s",
 		        file_path.string().c_str(),
 		        static_cast<int>(line_number),
-		        message_key.c_str(),
+		        std::string(message_key).c_str(),
 		        error.c_str());
 
 		clear_translated_messages();
 	};
 
 	bool reading_metadata = true;
-	while (std::getline(in_file, line)) {
+	while (get_line()) {
 		++line_number;
 		if (line.empty() || line.starts_with("//")) {
 			continue;
 		}
 
-		auto trimmed_line = line;
+		std::string trimmed_line(line);
 		trim(trimmed_line);
 
 		if (trimmed_line.starts_with(KeyScript)) {
@@ -551,32 +628,31 @@ static bool load_messages_from_path(const std_fs::path& file_path)
 			return false;
 		}
 
-		const std::string message_key = line.substr(1);
+		const auto message_key = line.substr(1);
 
 		if (message_key.empty()) {
 			problem_generic("message message_key is empty");
 			return false;
 		}
 
-		std::string text = {};
+		// The text's lines are contiguous in the file, so it runs from
+		// the start of the first to the end of the last
+		const char* text_start = nullptr;
+		const char* text_end   = nullptr;
 
 		bool is_text_terminated = false;
-		bool is_first_text_line = true;
 
-		while (std::getline(in_file, line)) {
+		while (get_line()) {
 			++line_number;
 			if (line == ".") {
 				is_text_terminated = true;
 				break;
 			}
 
-			if (is_first_text_line) {
-				is_first_text_line = false;
-			} else {
-				text += "\n";
+			if (!text_start) {
+				text_start = line.data();
 			}
-
-			text += line;
+			text_end = line.data() + line.size();
 		}
 
 		if (!is_text_terminated) {
@@ -585,7 +661,7 @@ static bool load_messages_from_path(const std_fs::path& file_path)
 			return false;
 		}
 
-		if (text.empty()) {
+		if (text_start == text_end) {
 			problem_with_message(message_key, "message text is empty");
 			return false;
 		}
@@ -596,23 +672,20 @@ static bool load_messages_from_path(const std_fs::path& file_path)
 			return false;
 		}
 
+		const std::string_view text(text_start,
+		                            static_cast<size_t>(text_end - text_start));
+
 		constexpr bool IsEnglish = false;
 		dictionary_translated.try_emplace(message_key, Message(text, IsEnglish));
 
-		auto& translated = dictionary_translated.at(message_key);
-
-		if (dictionary_english.contains(message_key)) {
-			translated.VerifyTranslated(message_key,
-			                            dictionary_english.at(message_key));
-		}
+#ifndef NDEBUG
+		is_translation_valid(std::string(message_key));
+#endif
 	}
 
 	++line_number;
 
-	if (in_file.bad()) {
-		problem_generic("I/O error");
-		return false;
-	} else if (dictionary_translated.empty()) {
+	if (dictionary_translated.empty()) {
 		problem_generic("file has no content");
 		return false;
 	}
@@ -720,11 +793,10 @@ void MSG_Add(const std::string& message_key, const std::string& message)
 	message_order.push_back(message_key);
 	dictionary_english.try_emplace(message_key, Message(message, IsEnglish));
 
-	auto& english = dictionary_english.at(message_key);
-	english.VerifyEnglish(message_key);
-	if (dictionary_translated.contains(message_key)) {
-		dictionary_translated.at(message_key).VerifyTranslated(message_key, english);
-	}
+#ifndef NDEBUG
+	get_verified_english(message_key);
+	is_translation_valid(message_key);
+#endif
 }
 
 std::string MSG_Get(const std::string& message_key)
@@ -735,17 +807,16 @@ std::string MSG_Get(const std::string& message_key)
 
 	// Try to return the translated message converted to the current DOS
 	// code page and the ANSI tags converted to ANSI sequences
-	if (is_code_page_compatible && dictionary_translated.contains(message_key) &&
-	    dictionary_translated.at(message_key).IsValid()) {
-
+	if (is_code_page_compatible && is_translation_valid(message_key)) {
 		return dictionary_translated.at(message_key).Get();
 	}
 
 	// Fall back to English if any errors
-	if (!dictionary_english.at(message_key).IsValid()) {
+	auto& english = get_verified_english(message_key);
+	if (!english.IsValid()) {
 		return MsgNotValid;
 	}
-	return dictionary_english.at(message_key).Get();
+	return english.Get();
 }
 
 std::string MSG_GetEnglishRaw(const std::string& message_key)
@@ -755,10 +826,11 @@ std::string MSG_GetEnglishRaw(const std::string& message_key)
 	}
 
 	// Return English original in UTF-8 with the ANSI tags intact
-	if (!dictionary_english.at(message_key).IsValid()) {
+	auto& english = get_verified_english(message_key);
+	if (!english.IsValid()) {
 		return MsgNotValid;
 	}
-	return dictionary_english.at(message_key).GetRaw();
+	return std::string(english.GetRaw());
 }
 
 std::string MSG_GetTranslatedRaw(const std::string& message_key)
@@ -768,10 +840,8 @@ std::string MSG_GetTranslatedRaw(const std::string& message_key)
 	}
 
 	// Try to return the translated message in UTF-8 with the ANSI tags intact
-	if (dictionary_translated.contains(message_key) &&
-	    dictionary_translated.at(message_key).IsValid()) {
-
-		return dictionary_translated.at(message_key).GetRaw();
+	if (is_translation_valid(message_key)) {
+		return std::string(dictionary_translated.at(message_key).GetRaw());
 	}
 
 	// Fall back to the English message if any errors
@@ -785,6 +855,9 @@ bool MSG_Exists(const std::string& message_key)
 
 bool MSG_WriteToFile(const std::string& file_name)
 {
+	// Report any problems with the messages being written out
+	verify_all_messages();
+
 	return save_messages_to_path(file_name);
 }
 
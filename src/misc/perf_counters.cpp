@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/perf_counters.h"
+
+#include <algorithm>
+#include <cassert>
+#include <mutex>
+
+namespace {
+
+struct Registry {
+	std::mutex mutex                       = {};
+	std::vector<const PerfMetric*> metrics = {};
+};
+
+// Never destroyed, so counters with static storage can unregister during
+// shutdown in any order
+Registry& registry()
+{
+	static auto instance = new Registry();
+	return *instance;
+}
+
+} // namespace
+
+PerfMetric::PerfMetric(const char* name, const char* help, const PerfKind kind)
+        : m_name(name),
+          m_help(help),
+          m_kind(kind)
+{
+	assert(name && help);
+
+	auto& reg = registry();
+	const std::lock_guard lock(reg.mutex);
+	reg.metrics.push_back(this);
+}
+
+PerfMetric::~PerfMetric()
+{
+	auto& reg = registry();
+	const std::lock_guard lock(reg.mutex);
+	std::erase(reg.metrics, this);
+}
+
+std::vector<PerfSample> PERF_Sample()
+{
+	std::vector<PerfSample> samples = {};
+	{
+		auto& reg = registry();
+		const std::lock_guard lock(reg.mutex);
+		samples.reserve(reg.metrics.size());
+		for (const auto metric : reg.metrics) {
+			samples.push_back(
+			        {metric->Name(), metric->Help(), metric->Kind(), metric->Sample()});
+		}
+	}
+	std::sort(samples.begin(), samples.end(), [](const auto& a, const auto& b) {
+		return a.name < b.name;
+	});
+	return samples;
+}
@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_PERF_COUNTERS_H
+#define DOSBOX_PERF_COUNTERS_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Performance counters
+// ~~~~~~~~~~~~~~~~~~~~
+// A registry of named counters and gauges that subsystems define next to
+// the code that bumps them, usually as a file-scope static:
+//
+//   static PerfCounter pic_events("pic_events", "PIC events serviced.");
+//   ...
+//   pic_events.Add();
+//
+// Constructing one registers it and destroying it takes it out again, so
+// nothing else needs to know the counter exists. Everything registered
+// shows up in the text-mode server's METRICS and STATS JSON replies and in
+// the PERF shell command.
+//
+// Counters only go up. Each thread adds into its own cache-line-sized
+// shard, so an increment is one relaxed atomic add on a line no other
+// thread writes; reading sums the shards. Gauges hold a single value that
+// the owner overwrites.
+//
+// Names must be unique, lower case and use underscores, since they become
+// metric names as is.
+
+enum class PerfKind { Counter, Gauge };
+
+struct PerfSample {
+	std::string name = {};
+	std::string help = {};
+	PerfKind kind    = PerfKind::Counter;
+	int64_t value    = 0;
+};
+
+class PerfMetric {
+public:
+	PerfMetric(const char* name, const char* help, PerfKind kind);
+	virtual ~PerfMetric();
+
+	PerfMetric(const PerfMetric&)            = delete;
+	PerfMetric& operator=(const PerfMetric&) = delete;
+
+	const char* Name() const
+	{
+		return m_name;
+	}
+	const char* Help() const
+	{
+		return m_help;
+	}
+	PerfKind Kind() const
+	{
+		return m_kind;
+	}
+
+	virtual int64_t Sample() const = 0;
+
+private:
+	const char* m_name = nullptr;
+	const char* m_help = nullptr;
+	PerfKind m_kind    = PerfKind::Counter;
+};
+
+class PerfCounter final : public PerfMetric {
+public:
+	PerfCounter(const char* name, const char* help)
+	        : PerfMetric(name, help, PerfKind::Counter)
+	{}
+
+	void Add(const uint64_t amount = 1)
+	{
+		m_shards[ThreadShard()].value.fetch_add(amount,
+		                                        std::memory_order_relaxed);
+	}
+
+	uint64_t Value() const
+	{
+		uint64_t total = 0;
+		for (const auto& shard : m_shards) {
+			total += shard.value.load(std::memory_order_relaxed);
+		}
+		return total;
+	}
+
+	int64_t Sample() const override
+	{
+		return static_cast<int64_t>(Value());
+	}
+
+private:
+	static constexpr size_t NumShards = 8;
+
+	struct alignas(64) Shard {
+		std::atomic<uint64_t> value = 0;
+	};
+
+	// Threads are handed shards round-robin the first time they count
+	static size_t ThreadShard()
+	{
+		static std::atomic<size_t> next_shard = 0;
+		thread_local const size_t shard = next_shard.fetch_add(
+		                                          1, std::memory_order_relaxed) %
+		                                  NumShards;
+		return shard;
+	}
+
+	std::array<Shard, NumShards> m_shards = {};
+};
+
+class PerfGauge final : public PerfMetric {
+public:
+	PerfGauge(const char* name, const char* help)
+	        : PerfMetric(name, help, PerfKind::Gauge)
+	{}
+
+	void Set(const int64_t value)
+	{
+		m_value.store(value, std::memory_order_relaxed);
+	}
+
+	int64_t Sample() const override
+	{
+		return m_value.load(std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<int64_t> m_value = 0;
+};
+
+// Everything currently registered, sorted by name
+std::vector<PerfSample> PERF_Sample();
+
+#endif // DOSBOX_PERF_COUNTERS_H
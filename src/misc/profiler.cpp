@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/profiler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "cpu/callback.h"
+#include "cpu/cpu.h"
+#include "cpu/registers.h"
+#include "dos/dos_inc.h"
+#include "hardware/timer.h"
+#include "misc/perf_counters.h"
+#include "utils/checks.h"
+#include "utils/string_utils.h"
+
+CHECK_NARROWING();
+
+static PerfCounter profiler_samples("profiler_samples",
+                                    "Samples taken by the guest code profiler.");
+
+void SampleHistogram::Add(const std::string& stack)
+{
+	++counts[stack];
+	++num_samples;
+}
+
+void SampleHistogram::Clear()
+{
+	counts.clear();
+	num_samples = 0;
+}
+
+std::string SampleHistogram::ToFolded() const
+{
+	std::vector<std::pair<std::string_view, uint64_t>> sorted(counts.begin(),
+	                                                           counts.end());
+	std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+		return a.second != b.second ? a.second > b.second : a.first < b.first;
+	});
+
+	std::string folded = {};
+	for (const auto& [stack, count] : sorted) {
+		folded.append(stack);
+		folded.push_back(' ');
+		folded.append(std::to_string(count));
+		folded.push_back('\n');
+	}
+	return folded;
+}
+
+static bool is_running = false;
+
+static SampleHistogram samples = {};
+
+static const char* core_name()
+{
+	if (cpudecoder == CPU_Core_Normal_Run || cpudecoder == CPU_Core_Normal_Trap_Run) {
+		return "normal";
+	}
+	if (cpudecoder == CPU_Core_Simple_Run || cpudecoder == CPU_Core_Simple_Trap_Run) {
+		return "simple";
+	}
+	if (cpudecoder == CPU_Core_Prefetch_Run ||
+	    cpudecoder == CPU_Core_Prefetch_Trap_Run) {
+		return "prefetch";
+	}
+	if (cpudecoder == CPU_Core_Full_Run) {
+		return "full";
+	}
+#if C_DYNAMIC_X86
+	if (cpudecoder == CPU_Core_Dyn_X86_Run || cpudecoder == CPU_Core_Dyn_X86_Trap_Run) {
+		return "dynamic";
+	}
+#endif
+#if C_DYNREC
+	if (cpudecoder == CPU_Core_Dynrec_Run || cpudecoder == CPU_Core_Dynrec_Trap_Run) {
+		return "dynamic";
+	}
+#endif
+	return "other";
+}
+
+// Frames are separated by semicolons and the count follows a space, so
+// neither can appear in a program's name
+static std::string frame_name(std::string name)
+{
+	std::replace(name.begin(), name.end(), ';', '_');
+	std::replace(name.begin(), name.end(), ' ', '_');
+	return name.empty() ? "?" : name;
+}
+
+static std::string program_owning(const uint16_t segment)
+{
+	// Never trust the guest's chain to end
+	constexpr auto MaxBlocks = 4096;
+
+	auto mcb_segment = dos.firstMCB;
+	for (auto n = 0; mcb_segment != 0 && n < MaxBlocks; ++n) {
+		DOS_MCB mcb(mcb_segment);
+
+		const auto type = mcb.GetType();
+		if (type != 'M' && type != 'Z') {
+			break;
+		}
+		const auto start = mcb_segment + 1;
+		const auto end   = start + mcb.GetSize();
+		if (segment >= start && segment < end) {
+			const auto psp_segment = mcb.GetPSPSeg();
+			if (psp_segment == 0) {
+				return "free memory";
+			}
+			if (psp_segment == MCB_DOS) {
+				return "DOS";
+			}
+			char name[9] = {};
+			DOS_MCB(static_cast<uint16_t>(psp_segment - 1)).GetFileName(name);
+			return name;
+		}
+		if (type == 'Z' || end > 0xffff) {
+			break;
+		}
+		mcb_segment = static_cast<uint16_t>(end);
+	}
+	return {};
+}
+
+// What the code at the linear address belongs to: a DOSBox callback, the
+// DOS program whose memory block it's in, or an area of memory
+static std::string owner_of(const PhysPt address)
+{
+	const auto callbacks = CALLBACK_GetBase();
+	if (address >= callbacks && address < callbacks + CB_MAX * CB_SIZE) {
+		const auto cb_number = static_cast<callback_number_t>(
+		        (address - callbacks) / CB_SIZE);
+		const auto description = CALLBACK_GetDescription(cb_number);
+		return description ? "callback " + std::string(description)
+		                   : "callback " + std::to_string(cb_number);
+	}
+	if (address >= 0x100000) {
+		return "extended memory";
+	}
+	if (auto program = program_owning(static_cast<uint16_t>(address >> 4));
+	    !program.empty()) {
+		return program;
+	}
+	if (address >= 0xf0000) {
+		return "BIOS";
+	}
+	if (address >= 0xa0000) {
+		return "upper memory";
+	}
+	return "conventional memory";
+}
+
+static void take_sample()
+{
+	const auto address = SegPhys(cs) + reg_eip;
+
+	std::string stack = core_name();
+	stack.push_back(';');
+	stack.append(frame_name(owner_of(address)));
+	stack.append(format_str(";CS=%04X;%04X:%08X", SegValue(cs), SegValue(cs), reg_eip));
+
+	samples.Add(stack);
+	profiler_samples.Add();
+}
+
+bool PROFILER_Start()
+{
+	if (is_running) {
+		return false;
+	}
+	samples.Clear();
+	TIMER_AddTickHandler(take_sample);
+	is_running = true;
+	return true;
+}
+
+bool PROFILER_IsRunning()
+{
+	return is_running;
+}
+
+uint64_t PROFILER_NumSamples()
+{
+	return samples.NumSamples();
+}
+
+std::string PROFILER_Stop()
+{
+	if (!is_running) {
+		return {};
+	}
+	TIMER_DelTickHandler(take_sample);
+	is_running = false;
+
+	auto folded = samples.ToFolded();
+	samples.Clear();
+	return folded;
+}
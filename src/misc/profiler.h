@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_PROFILER_H
+#define DOSBOX_PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+// Sampling profiler of guest code
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// While running, the PIT tick handler samples where the guest is once per
+// emulated millisecond: the CPU core, the code's owner, the code segment
+// and CS:EIP. The owner is the DOS program whose memory block the code is
+// in, the DOSBox callback (INT handler, driver entry point) when the guest
+// is in one of the callback stubs, or the BIOS, upper or extended memory.
+//
+// Stopping returns the samples in the folded-stack format that flamegraph
+// tools take, one "core;owner;segment;address count" line per address,
+// most sampled first:
+//
+//   normal;GAME;CS=1A2B;1A2B:00000345 812
+//
+// Driven by the text-mode server's PROFILE command and the debugger's.
+
+// Counts of samples by their stack of frames, separated by semicolons
+class SampleHistogram {
+public:
+	void Add(const std::string& stack);
+
+	void Clear();
+
+	uint64_t NumSamples() const
+	{
+		return num_samples;
+	}
+
+	// The folded-stack lines, most sampled first and then by stack
+	std::string ToFolded() const;
+
+private:
+	std::unordered_map<std::string, uint64_t> counts = {};
+	uint64_t num_samples = 0;
+};
+
+// Returns false if the profiler is already running
+bool PROFILER_Start();
+
+bool PROFILER_IsRunning();
+
+uint64_t PROFILER_NumSamples();
+
+// Stops the profiler and returns the folded stacks of what it sampled; or
+// nothing if it wasn't running
+std::string PROFILER_Stop();
+
+#endif // DOSBOX_PROFILER_H
@@ -0,0 +1,772 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/savestate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <numeric>
+#include <random>
+
+#include <zlib.h>
+
+#include "dosbox.h"
+#include "hardware/memory.h"
+#include "misc/logging.h"
+
+void SaveStateWriter::WriteBytes(const void* data, const size_t num_bytes)
+{
+	const auto bytes = static_cast<const uint8_t*>(data);
+	m_data.insert(m_data.end(), bytes, bytes + num_bytes);
+}
+
+void SaveStateWriter::WriteString(const std::string& value)
+{
+	Write(static_cast<uint32_t>(value.size()));
+	WriteBytes(value.data(), value.size());
+}
+
+void SaveStateWriter::Fail(const std::string& reason)
+{
+	if (m_error.empty()) {
+		m_error = reason;
+	}
+}
+
+SaveStateReader::SaveStateReader(const uint8_t* data, const size_t num_bytes)
+        : m_data(data),
+          m_size(num_bytes)
+{}
+
+const uint8_t* SaveStateReader::Take(const size_t num_bytes)
+{
+	if (Failed()) {
+		return nullptr;
+	}
+	if (num_bytes > Remaining()) {
+		Fail("section is truncated");
+		return nullptr;
+	}
+	const auto bytes = m_data + m_offset;
+	m_offset += num_bytes;
+	return bytes;
+}
+
+bool SaveStateReader::ReadBytes(void* out, const size_t num_bytes)
+{
+	const auto bytes = Take(num_bytes);
+	if (!bytes) {
+		return false;
+	}
+	std::memcpy(out, bytes, num_bytes);
+	return true;
+}
+
+bool SaveStateReader::ReadString(std::string& value)
+{
+	uint32_t length = 0;
+	if (!Read(length)) {
+		return false;
+	}
+	const auto bytes = Take(length);
+	if (!bytes) {
+		return false;
+	}
+	value.assign(reinterpret_cast<const char*>(bytes), length);
+	return true;
+}
+
+bool SaveStateReader::Fail(const std::string& reason)
+{
+	if (m_error.empty()) {
+		m_error = reason;
+	}
+	return false;
+}
+
+namespace {
+
+constexpr char Magic[4] = {'D', 'B', 'S', 'S'};
+
+// Distinguishes this run from every other, so blobs holding host pointers
+// are never restored into a different address space
+uint64_t session_id()
+{
+	static const uint64_t id = [] {
+		std::random_device device;
+		const auto now = std::chrono::steady_clock::now().time_since_epoch().count();
+		return (static_cast<uint64_t>(device()) << 32) ^ device() ^
+		       static_cast<uint64_t>(now);
+	}();
+	return id;
+}
+
+struct BlobSection {
+	const uint8_t* data = nullptr;
+	size_t size         = 0;
+};
+
+} // namespace
+
+std::vector<uint8_t> SAVESTATE_Encode(const std::vector<SaveStateComponent>& components,
+                                      const uint32_t depth, std::string& error)
+{
+	SaveStateWriter out;
+	out.WriteBytes(Magic, sizeof(Magic));
+	out.Write(SaveStateVersion);
+	out.Write(uint16_t{0});
+	out.Write(session_id());
+	out.Write(depth);
+	out.Write(static_cast<uint32_t>(components.size()));
+
+	for (const auto& component : components) {
+		SaveStateWriter section;
+		component.save(section);
+		if (section.Failed()) {
+			error = component.name + ": " + section.Error();
+			return {};
+		}
+		out.WriteString(component.name);
+		out.Write(static_cast<uint64_t>(section.Data().size()));
+		out.WriteBytes(section.Data().data(), section.Data().size());
+	}
+	return std::move(out.Data());
+}
+
+bool SAVESTATE_Decode(const std::vector<uint8_t>& blob,
+                      const std::vector<SaveStateComponent>& components,
+                      const uint32_t depth, std::string& error)
+{
+	SaveStateReader in(blob.data(), blob.size());
+
+	const auto magic = in.Take(sizeof(Magic));
+	if (!magic || std::memcmp(magic, Magic, sizeof(Magic)) != 0) {
+		error = "not a save-state";
+		return false;
+	}
+	uint16_t version = 0;
+	uint16_t flags   = 0;
+	uint64_t session = 0;
+	uint32_t saved_depth = 0;
+	uint32_t count   = 0;
+	if (!in.Read(version) || !in.Read(flags) || !in.Read(session) ||
+	    !in.Read(saved_depth) || !in.Read(count)) {
+		error = "save-state header is truncated";
+		return false;
+	}
+	if (version != SaveStateVersion) {
+		error = "save-state version " + std::to_string(version) + " is not supported";
+		return false;
+	}
+	if (session != session_id()) {
+		error = "save-state belongs to another session";
+		return false;
+	}
+	if (saved_depth != depth) {
+		error = "save-state was taken in a different host context";
+		return false;
+	}
+
+	std::map<std::string, BlobSection> sections;
+	for (uint32_t i = 0; i < count; ++i) {
+		std::string name = {};
+		uint64_t size    = 0;
+		if (!in.ReadString(name) || !in.Read(size) || size > in.Remaining()) {
+			error = "save-state is truncated";
+			return false;
+		}
+		const auto data = in.Take(static_cast<size_t>(size));
+		if (!sections.emplace(name, BlobSection{data, static_cast<size_t>(size)}).second) {
+			error = "save-state repeats section '" + name + "'";
+			return false;
+		}
+	}
+
+	for (const auto& [name, section] : sections) {
+		const auto known = std::any_of(components.begin(),
+		                               components.end(),
+		                               [&](const auto& c) { return c.name == name; });
+		if (!known) {
+			error = "save-state has unknown section '" + name + "'";
+			return false;
+		}
+	}
+
+	// Every section must pass before anything is applied
+	for (const bool apply : {false, true}) {
+		for (const auto& component : components) {
+			const auto it = sections.find(component.name);
+			if (it == sections.end()) {
+				error = "save-state lacks section '" + component.name + "'";
+				return false;
+			}
+			SaveStateReader reader(it->second.data, it->second.size);
+			if (!component.load(reader, apply)) {
+				error = component.name + ": " +
+				        (reader.Failed() ? reader.Error()
+				                         : std::string("cannot be restored"));
+				return false;
+			}
+			if (reader.Remaining() != 0) {
+				error = component.name + ": section has trailing bytes";
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+namespace {
+
+// 64-bit FNV-1a over the page's words; collisions only cost a comparison
+uint64_t hash_page(const uint8_t* page)
+{
+	constexpr uint64_t FnvOffsetBasis = 0xcbf29ce484222325;
+	constexpr uint64_t FnvPrime       = 0x100000001b3;
+
+	auto hash = FnvOffsetBasis;
+	for (size_t offset = 0; offset < CheckpointPageSize; offset += sizeof(uint64_t)) {
+		uint64_t word = 0;
+		std::memcpy(&word, page + offset, sizeof(word));
+		hash = (hash ^ word) * FnvPrime;
+	}
+	return hash;
+}
+
+bool inflate_page(const std::vector<uint8_t>& deflated, uint8_t* out)
+{
+	auto out_bytes = static_cast<uLongf>(CheckpointPageSize);
+	return uncompress(out, &out_bytes, deflated.data(), deflated.size()) == Z_OK &&
+	       out_bytes == CheckpointPageSize;
+}
+
+constexpr size_t MinSweepAt     = 1024;
+constexpr size_t MaxDeflateJobs = 64;
+
+} // namespace
+
+PageChunkStore::PageChunkStore() : sweep_at(MinSweepAt), jobs(MaxDeflateJobs)
+{
+	deflater = std::thread(&PageChunkStore::DeflateChunks, this);
+}
+
+PageChunkStore::~PageChunkStore()
+{
+	jobs.Stop();
+	if (deflater.joinable()) {
+		deflater.join();
+	}
+}
+
+std::vector<PageChunk> PageChunkStore::Intern(const uint8_t* ram,
+                                              const std::vector<uint32_t>& pages,
+                                              size_t* num_new)
+{
+	std::vector<PageChunk> chunks = {};
+	std::vector<PageChunk> stored = {};
+	chunks.reserve(pages.size());
+	{
+		const std::lock_guard lock(mutex);
+		for (const auto page : pages) {
+			const auto bytes = ram + static_cast<size_t>(page) * CheckpointPageSize;
+			const auto hash  = hash_page(bytes);
+			if (auto held = Find(hash, bytes)) {
+				chunks.push_back(std::move(*held));
+				continue;
+			}
+			auto chunk   = std::make_shared<PageChunkData>();
+			chunk->hash  = hash;
+			chunk->bytes.assign(bytes, bytes + CheckpointPageSize);
+			index.emplace(hash, chunk);
+			chunks.push_back(chunk);
+			stored.push_back(std::move(chunk));
+		}
+		if (index.size() >= sweep_at) {
+			SweepIndex();
+		}
+		if (!stored.empty()) {
+			++pending_jobs;
+		}
+	}
+
+	if (num_new) {
+		*num_new = stored.size();
+	}
+	if (!stored.empty() && !jobs.Enqueue(std::move(stored))) {
+		// Parked; the chunks stay raw until the thread resumes
+		const std::lock_guard lock(mutex);
+		--pending_jobs;
+		jobs_done.notify_all();
+	}
+	return chunks;
+}
+
+std::optional<PageChunk> PageChunkStore::Find(const uint64_t hash, const uint8_t* page) const
+{
+	const auto [first, last] = index.equal_range(hash);
+	for (auto it = first; it != last; ++it) {
+		auto chunk = it->second.lock();
+		if (!chunk) {
+			continue;
+		}
+		if (chunk->is_deflated) {
+			std::vector<uint8_t> inflated(CheckpointPageSize);
+			if (inflate_page(chunk->bytes, inflated.data()) &&
+			    std::memcmp(inflated.data(), page, CheckpointPageSize) == 0) {
+				return chunk;
+			}
+		} else if (std::memcmp(chunk->bytes.data(), page, CheckpointPageSize) == 0) {
+			return chunk;
+		}
+	}
+	return {};
+}
+
+void PageChunkStore::SweepIndex()
+{
+	std::erase_if(index, [](const auto& entry) { return entry.second.expired(); });
+	sweep_at = std::max(MinSweepAt, index.size() * 2);
+}
+
+bool PageChunkStore::Read(const PageChunk& chunk, uint8_t* out) const
+{
+	const std::lock_guard lock(mutex);
+	if (chunk->is_deflated) {
+		return inflate_page(chunk->bytes, out);
+	}
+	if (chunk->bytes.size() != CheckpointPageSize) {
+		return false;
+	}
+	std::memcpy(out, chunk->bytes.data(), CheckpointPageSize);
+	return true;
+}
+
+size_t PageChunkStore::StoredBytes(std::vector<PageChunk> chunks) const
+{
+	std::sort(chunks.begin(), chunks.end());
+	chunks.erase(std::unique(chunks.begin(), chunks.end()), chunks.end());
+
+	const std::lock_guard lock(mutex);
+	size_t num_bytes = 0;
+	for (const auto& chunk : chunks) {
+		num_bytes += chunk->bytes.size();
+	}
+	return num_bytes;
+}
+
+size_t PageChunkStore::NumChunks() const
+{
+	const std::lock_guard lock(mutex);
+	const auto num_held = std::count_if(index.begin(), index.end(), [](const auto& entry) {
+		return !entry.second.expired();
+	});
+	return static_cast<size_t>(num_held);
+}
+
+void PageChunkStore::Flush()
+{
+	std::unique_lock lock(mutex);
+	jobs_done.wait(lock, [this] { return pending_jobs == 0; });
+}
+
+void PageChunkStore::SuspendThread()
+{
+	// The thread drains the queue before it returns
+	jobs.Stop();
+	if (deflater.joinable()) {
+		deflater.join();
+	}
+}
+
+void PageChunkStore::ResumeThread()
+{
+	if (deflater.joinable()) {
+		return;
+	}
+	jobs.Start();
+	deflater = std::thread(&PageChunkStore::DeflateChunks, this);
+
+	// Chunks stored while parked
+	std::vector<PageChunk> raw = {};
+	{
+		const std::lock_guard lock(mutex);
+		for (const auto& [_, entry] : index) {
+			if (auto chunk = entry.lock(); chunk && !chunk->is_deflated) {
+				raw.push_back(std::move(chunk));
+			}
+		}
+		if (raw.empty()) {
+			return;
+		}
+		++pending_jobs;
+	}
+	if (!jobs.Enqueue(std::move(raw))) {
+		const std::lock_guard lock(mutex);
+		--pending_jobs;
+		jobs_done.notify_all();
+	}
+}
+
+void PageChunkStore::DeflateChunks()
+{
+	while (auto job = jobs.Dequeue()) {
+		// Only this thread replaces the bytes, so they can be read
+		// without the lock here
+		std::vector<std::vector<uint8_t>> deflated(job->size());
+		for (size_t i = 0; i < job->size(); ++i) {
+			const auto& chunk = (*job)[i];
+			if (chunk->is_deflated) {
+				continue;
+			}
+			const auto& raw = chunk->bytes;
+			auto out_bytes  = compressBound(static_cast<uLong>(raw.size()));
+			std::vector<uint8_t> out(out_bytes);
+			if (compress2(out.data(), &out_bytes, raw.data(), raw.size(), Z_BEST_SPEED) != Z_OK ||
+			    out_bytes >= raw.size()) {
+				continue;
+			}
+			out.resize(out_bytes);
+			deflated[i] = std::move(out);
+		}
+
+		const std::lock_guard lock(mutex);
+		for (size_t i = 0; i < job->size(); ++i) {
+			if (!deflated[i].empty()) {
+				(*job)[i]->bytes       = std::move(deflated[i]);
+				(*job)[i]->is_deflated = true;
+			}
+		}
+		// Chunks no one else holds any more go now, not with the next job
+		job->clear();
+		--pending_jobs;
+		jobs_done.notify_all();
+	}
+}
+
+CheckpointStore::CheckpointStore(const size_t max_checkpoints,
+                                 std::shared_ptr<PageChunkStore> chunks)
+        : max_checkpoints(max_checkpoints),
+          chunks(chunks ? std::move(chunks) : std::make_shared<PageChunkStore>())
+{}
+
+uint32_t CheckpointStore::Add(std::vector<uint8_t> state, const uint8_t* ram,
+                              const std::vector<uint32_t>& pages, size_t* num_new)
+{
+	Checkpoint checkpoint = {};
+	checkpoint.state      = std::move(state);
+
+	const auto page_chunks = chunks->Intern(ram, pages, num_new);
+	for (size_t i = 0; i < pages.size(); ++i) {
+		checkpoint.pages[pages[i]] = page_chunks[i];
+	}
+
+	const std::lock_guard lock(mutex);
+	checkpoint.id = next_id++;
+
+	if (checkpoints.size() >= max_checkpoints) {
+		// The next checkpoint takes over the pages of the oldest that it
+		// lacks, which are still current for it
+		auto oldest = std::move(checkpoints.front());
+		checkpoints.pop_front();
+		auto& heir = checkpoints.empty() ? checkpoint : checkpoints.front();
+		heir.pages.merge(oldest.pages);
+	}
+	const auto id = checkpoint.id;
+	checkpoints.push_back(std::move(checkpoint));
+	return id;
+}
+
+bool CheckpointStore::Restore(const uint32_t id, const size_t num_pages,
+                              std::vector<uint8_t>& state,
+                              std::vector<uint8_t>& ram, std::string& error) const
+{
+	const std::lock_guard lock(mutex);
+
+	const auto newest = std::find_if(checkpoints.begin(),
+	                                 checkpoints.end(),
+	                                 [=](const auto& c) { return c.id == id; });
+	if (newest == checkpoints.end()) {
+		error = "unknown checkpoint";
+		return false;
+	}
+
+	ram.assign(num_pages * CheckpointPageSize, 0);
+	std::vector<bool> is_filled(num_pages, false);
+	size_t num_filled = 0;
+
+	// Newest first, so every page comes from the last checkpoint that
+	// captured it
+	for (auto it = std::make_reverse_iterator(std::next(newest));
+	     it != checkpoints.rend() && num_filled < num_pages;
+	     ++it) {
+		for (const auto& [page, chunk] : it->pages) {
+			if (page >= num_pages || is_filled[page]) {
+				continue;
+			}
+			const auto out = ram.data() + static_cast<size_t>(page) * CheckpointPageSize;
+			if (!chunks->Read(chunk, out)) {
+				error = "checkpoint page is corrupt";
+				return false;
+			}
+			is_filled[page] = true;
+			++num_filled;
+		}
+	}
+	if (num_filled < num_pages) {
+		error = "checkpoint lacks pages";
+		return false;
+	}
+	state = newest->state;
+	return true;
+}
+
+void CheckpointStore::Clear()
+{
+	const std::lock_guard lock(mutex);
+	checkpoints.clear();
+}
+
+std::vector<uint32_t> CheckpointStore::Ids() const
+{
+	const std::lock_guard lock(mutex);
+	std::vector<uint32_t> ids = {};
+	for (const auto& checkpoint : checkpoints) {
+		ids.push_back(checkpoint.id);
+	}
+	return ids;
+}
+
+size_t CheckpointStore::PageBytes() const
+{
+	std::vector<PageChunk> held = {};
+	{
+		const std::lock_guard lock(mutex);
+		for (const auto& checkpoint : checkpoints) {
+			for (const auto& [page, chunk] : checkpoint.pages) {
+				held.push_back(chunk);
+			}
+		}
+	}
+	return chunks->StoredBytes(std::move(held));
+}
+
+void CheckpointStore::Flush()
+{
+	chunks->Flush();
+}
+
+namespace {
+
+constexpr size_t MaxSlots      = 16;
+constexpr size_t MaxSlotLength = 32;
+
+// The machine without its RAM, and the RAM as chunks
+struct Slot {
+	std::vector<uint8_t> state    = {};
+	std::vector<PageChunk> pages = {};
+};
+
+std::map<std::string, Slot> slots = {};
+
+bool is_valid_slot(const std::string& slot)
+{
+	if (slot.empty() || slot.size() > MaxSlotLength) {
+		return false;
+	}
+	return std::all_of(slot.begin(), slot.end(), [](const char c) {
+		return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') ||
+		       (c >= 'A' && c <= 'Z') || c == '_' || c == '-';
+	});
+}
+
+// Applied in this order: RAM before the paging links that point into it,
+// and the PIC queue before VGA, which may schedule a resize on top of it
+const std::vector<SaveStateComponent>& machine_components()
+{
+	static const std::vector<SaveStateComponent> components = {
+	        {"cpu", CPU_SaveState, CPU_LoadState},
+	        {"memory", MEM_SaveState, MEM_LoadState},
+	        {"paging", PAGING_SaveState, PAGING_LoadState},
+	        {"ems", EMS_SaveState, EMS_LoadState},
+	        {"xms", XMS_SaveState, XMS_LoadState},
+	        {"pic", PIC_SaveState, PIC_LoadState},
+	        {"timer", TIMER_SaveState, TIMER_LoadState},
+	        {"i8042", I8042_SaveState, I8042_LoadState},
+	        {"vga", VGA_SaveState, VGA_LoadState},
+	        {"dos", DOS_SaveState, DOS_LoadState},
+	};
+	return components;
+}
+
+constexpr size_t MaxCheckpoints = 64;
+
+// Created on first use, so no thread runs until a state is taken
+std::shared_ptr<PageChunkStore> shared_chunks = {};
+
+const std::shared_ptr<PageChunkStore>& page_chunks()
+{
+	if (!shared_chunks) {
+		shared_chunks = std::make_shared<PageChunkStore>();
+	}
+	return shared_chunks;
+}
+
+CheckpointStore& checkpoint_store()
+{
+	static CheckpointStore store(MaxCheckpoints, page_chunks());
+	return store;
+}
+
+std::vector<uint32_t> all_pages()
+{
+	std::vector<uint32_t> pages(MEM_TotalPages());
+	std::iota(pages.begin(), pages.end(), 0);
+	return pages;
+}
+
+// The machine's components with the memory section swapped for one that
+// leaves out the page contents, or takes them from 'image' when restoring
+std::vector<SaveStateComponent> checkpoint_components(const std::vector<uint8_t>& image)
+{
+	auto components = machine_components();
+	for (auto& component : components) {
+		if (component.name == "memory") {
+			component.save = MEM_SaveStateWithoutPages;
+			component.load = [&image](SaveStateReader& in, const bool apply) {
+				return MEM_LoadStateWithPages(in, apply, image);
+			};
+		}
+	}
+	return components;
+}
+
+} // namespace
+
+bool SAVESTATE_Checkpoint(CheckpointInfo& info, std::string& error)
+{
+	auto& store = checkpoint_store();
+
+	// Checkpoints from before tracking was (re)started lack the pages
+	// written in between
+	if (!MEM_IsDirtyTrackingEnabled()) {
+		store.Clear();
+		MEM_EnableDirtyTracking(true);
+	}
+
+	const std::vector<uint8_t> no_image = {};
+	auto state = SAVESTATE_Encode(checkpoint_components(no_image),
+	                              DOSBOX_GetRunMachineDepth(),
+	                              error);
+	if (state.empty()) {
+		return false;
+	}
+
+	const auto pages = MEM_TakeDirtyPages();
+
+	size_t num_new = 0;
+	info           = {};
+	info.num_pages = pages.size();
+	info.num_bytes = state.size() + pages.size() * CheckpointPageSize;
+	info.id        = store.Add(std::move(state), GetMemBase(), pages, &num_new);
+
+	LOG_MSG("SAVESTATE: Took checkpoint %u (%zu pages, %zu new, %zu bytes)",
+	        info.id,
+	        info.num_pages,
+	        num_new,
+	        info.num_bytes);
+	return true;
+}
+
+bool SAVESTATE_RestoreCheckpoint(const uint32_t id, std::string& error)
+{
+	std::vector<uint8_t> state = {};
+	std::vector<uint8_t> image = {};
+	if (!checkpoint_store().Restore(id, MEM_TotalPages(), state, image, error)) {
+		return false;
+	}
+	if (!SAVESTATE_Decode(state, checkpoint_components(image), DOSBOX_GetRunMachineDepth(), error)) {
+		LOG_WARNING("SAVESTATE: Unable to restore checkpoint %u: %s", id, error.c_str());
+		return false;
+	}
+	LOG_MSG("SAVESTATE: Restored checkpoint %u", id);
+	return true;
+}
+
+bool SAVESTATE_SaveSlot(const std::string& slot, std::string& error, size_t* num_bytes)
+{
+	if (!is_valid_slot(slot)) {
+		error = "invalid save-state slot";
+		return false;
+	}
+	if (!slots.contains(slot) && slots.size() >= MaxSlots) {
+		error = "too many save-state slots";
+		return false;
+	}
+
+	const std::vector<uint8_t> no_image = {};
+	Slot saved                          = {};
+	saved.state = SAVESTATE_Encode(checkpoint_components(no_image),
+	                               DOSBOX_GetRunMachineDepth(),
+	                               error);
+	if (saved.state.empty()) {
+		return false;
+	}
+	size_t num_new = 0;
+	saved.pages = page_chunks()->Intern(GetMemBase(), all_pages(), &num_new);
+
+	const auto total_bytes = saved.state.size() + saved.pages.size() * CheckpointPageSize;
+	if (num_bytes) {
+		*num_bytes = total_bytes;
+	}
+	LOG_MSG("SAVESTATE: Saved slot '%s' (%zu bytes, %zu new pages)",
+	        slot.c_str(),
+	        total_bytes,
+	        num_new);
+	slots[slot] = std::move(saved);
+	return true;
+}
+
+bool SAVESTATE_LoadSlot(const std::string& slot, std::string& error)
+{
+	const auto it = slots.find(slot);
+	if (it == slots.end()) {
+		error = "unknown save-state slot";
+		return false;
+	}
+	const auto& saved = it->second;
+
+	std::vector<uint8_t> image(saved.pages.size() * CheckpointPageSize);
+	for (size_t page = 0; page < saved.pages.size(); ++page) {
+		const auto out = image.data() + page * CheckpointPageSize;
+		if (!page_chunks()->Read(saved.pages[page], out)) {
+			error = "save-state page is corrupt";
+			return false;
+		}
+	}
+	if (!SAVESTATE_Decode(saved.state,
+	                      checkpoint_components(image),
+	                      DOSBOX_GetRunMachineDepth(),
+	                      error)) {
+		LOG_WARNING("SAVESTATE: Unable to restore slot '%s': %s",
+		            slot.c_str(),
+		            error.c_str());
+		return false;
+	}
+	LOG_MSG("SAVESTATE: Restored slot '%s'", slot.c_str());
+	return true;
+}
+
+void SAVESTATE_SuspendThreads()
+{
+	if (shared_chunks) {
+		shared_chunks->SuspendThread();
+	}
+}
+
+void SAVESTATE_ResumeThreads()
+{
+	if (shared_chunks) {
+		shared_chunks->ResumeThread();
+	}
+}
@@ -0,0 +1,328 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_SAVESTATE_H
+#define DOSBOX_SAVESTATE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "utils/rwqueue.h"
+
+// Machine save-states
+// ~~~~~~~~~~~~~~~~~~~
+// A save-state is one versioned binary blob holding a section per emulated
+// component (CPU, RAM, paging, PIC, PIT, VGA, ...). Several of those
+// sections hold host pointers into tables that live for the whole run (PIC
+// event handlers, page handlers, the CPU decoder), so a blob can only be
+// restored by the process that made it; the header carries a per-process
+// session ID to enforce that.
+//
+// Restoring happens in two passes: every component first validates its
+// section without touching any state, and only if all of them agree is the
+// state applied. A rejected blob therefore leaves the machine as it was.
+
+// Register blocks that are plain bytes underneath (including the bit_view
+// unions the VGA and CRTC registers use) are stored as-is
+template <typename T>
+constexpr bool is_raw_storable_v = std::is_trivially_copyable_v<T> ||
+                                   (std::is_standard_layout_v<T> &&
+                                    std::is_trivially_destructible_v<T>);
+
+class SaveStateWriter {
+public:
+	void WriteBytes(const void* data, size_t num_bytes);
+
+	template <typename T>
+	void Write(const T& value)
+	{
+		static_assert(is_raw_storable_v<T>);
+		WriteBytes(&value, sizeof(T));
+	}
+
+	void WriteString(const std::string& value);
+
+	// Aborts the save; the first reason is kept
+	void Fail(const std::string& reason);
+
+	bool Failed() const
+	{
+		return !m_error.empty();
+	}
+	const std::string& Error() const
+	{
+		return m_error;
+	}
+	std::vector<uint8_t>& Data()
+	{
+		return m_data;
+	}
+
+private:
+	std::vector<uint8_t> m_data = {};
+	std::string m_error         = {};
+};
+
+class SaveStateReader {
+public:
+	SaveStateReader(const uint8_t* data, size_t num_bytes);
+
+	// Points at the next 'num_bytes' of the section without copying, or
+	// returns nullptr (and fails) if the section is shorter than that
+	const uint8_t* Take(size_t num_bytes);
+
+	bool ReadBytes(void* out, size_t num_bytes);
+
+	template <typename T>
+	bool Read(T& value)
+	{
+		static_assert(is_raw_storable_v<T>);
+		const auto bytes = Take(sizeof(T));
+		if (!bytes) {
+			return false;
+		}
+		std::memcpy(static_cast<void*>(&value), bytes, sizeof(T));
+		return true;
+	}
+
+	bool ReadString(std::string& value);
+
+	// Always returns false so loaders can 'return in.Fail(...)'
+	bool Fail(const std::string& reason);
+
+	bool Failed() const
+	{
+		return !m_error.empty();
+	}
+	const std::string& Error() const
+	{
+		return m_error;
+	}
+	size_t Remaining() const
+	{
+		return m_size - m_offset;
+	}
+
+private:
+	const uint8_t* m_data = nullptr;
+	size_t m_size         = 0;
+	size_t m_offset       = 0;
+	std::string m_error   = {};
+};
+
+struct SaveStateComponent {
+	std::string name = {};
+
+	std::function<void(SaveStateWriter&)> save = {};
+
+	// Called twice per restore: with 'apply' false it must only check that
+	// the section can be restored; with 'apply' true it restores it
+	std::function<bool(SaveStateReader&, bool apply)> load = {};
+};
+
+constexpr uint16_t SaveStateVersion = 1;
+
+// Builds a blob from every component, tagged with this process's session
+// and the given host call 'depth'. Returns an empty blob and sets 'error'
+// if any component refuses.
+std::vector<uint8_t> SAVESTATE_Encode(const std::vector<SaveStateComponent>& components,
+                                      uint32_t depth, std::string& error);
+
+// Restores 'blob' into the components, all or nothing
+bool SAVESTATE_Decode(const std::vector<uint8_t>& blob,
+                      const std::vector<SaveStateComponent>& components,
+                      uint32_t depth, std::string& error);
+
+// Saves the whole machine into the named in-memory slot, replacing what
+// was there. Only valid between emulation slices, where the CPU decoder
+// has returned; the text-mode server's command loop is such a point.
+bool SAVESTATE_SaveSlot(const std::string& slot, std::string& error,
+                        size_t* num_bytes = nullptr);
+bool SAVESTATE_LoadSlot(const std::string& slot, std::string& error);
+
+// Page chunks
+// ~~~~~~~~~~~
+// Save-state slots and checkpoints keep guest RAM as 4 KB chunks addressed
+// by their contents. A page that is byte-for-byte the same as one already
+// held, by any slot or checkpoint, shares that chunk instead of being
+// copied again. Booted machines hold many such pages (zeroed memory, the
+// DOS kernel, fonts, loaded programs), so the storage grows with what is
+// unique rather than with the number of states. A background thread
+// deflates each new chunk after it's stored.
+
+constexpr size_t CheckpointPageSize = 4096;
+
+struct PageChunkData {
+	uint64_t hash = 0;
+	// The raw page, or its deflated form once 'is_deflated' is set; both
+	// only change under the store's lock
+	std::vector<uint8_t> bytes = {};
+	bool is_deflated           = false;
+};
+
+// A held page; the chunk is freed along with the last handle to it
+using PageChunk = std::shared_ptr<PageChunkData>;
+
+class PageChunkStore {
+public:
+	PageChunkStore();
+	~PageChunkStore();
+
+	PageChunkStore(const PageChunkStore&)            = delete;
+	PageChunkStore& operator=(const PageChunkStore&) = delete;
+
+	// Chunks for the listed pages of 'ram', in the same order, sharing the
+	// ones already held. 'num_new' is set to how many had to be stored.
+	std::vector<PageChunk> Intern(const uint8_t* ram, const std::vector<uint32_t>& pages,
+	                              size_t* num_new = nullptr);
+
+	// Copies the page out of 'chunk'; fails if it doesn't inflate to a page
+	bool Read(const PageChunk& chunk, uint8_t* out) const;
+
+	// Bytes held for the given chunks, counting each chunk once
+	size_t StoredBytes(std::vector<PageChunk> chunks) const;
+
+	// Chunks still held by someone
+	size_t NumChunks() const;
+
+	// Waits until every chunk stored so far has been deflated
+	void Flush();
+
+	// Finishes the pending deflates and parks the thread, as cloning
+	// needs; chunks stored meanwhile wait for ResumeThread()
+	void SuspendThread();
+	void ResumeThread();
+
+private:
+	std::optional<PageChunk> Find(uint64_t hash, const uint8_t* page) const;
+	void SweepIndex();
+	void DeflateChunks();
+
+	mutable std::mutex mutex          = {};
+	std::condition_variable jobs_done = {};
+	size_t pending_jobs               = 0;
+
+	// Chunks by hash; expired entries are swept out as the index grows
+	std::unordered_multimap<uint64_t, std::weak_ptr<PageChunkData>> index = {};
+	size_t sweep_at = 0;
+
+	RWQueue<std::vector<PageChunk>> jobs;
+	std::thread deflater = {};
+};
+
+// Incremental checkpoints
+// ~~~~~~~~~~~~~~~~~~~~~~~
+// A checkpoint is a save-state that keeps the pages of guest RAM apart,
+// and only those written since the checkpoint before it, so taking one
+// costs about as much as the guest wrote in between rather than all of its
+// RAM. Restoring a checkpoint fills in the pages it lacks from the ones
+// before it. The pages are held as chunks, shared with the slots.
+
+class CheckpointStore {
+public:
+	// Keeps up to 'max_checkpoints', dropping the oldest beyond that. The
+	// pages go into 'chunks', or into a store of its own without one.
+	explicit CheckpointStore(size_t max_checkpoints,
+	                         std::shared_ptr<PageChunkStore> chunks = {});
+
+	CheckpointStore(const CheckpointStore&)            = delete;
+	CheckpointStore& operator=(const CheckpointStore&) = delete;
+
+	// Keeps 'state' with the listed pages of 'ram', and returns the new
+	// checkpoint's ID. A dropped checkpoint hands the pages that weren't
+	// written again on to the next one. 'num_new' is set to how many pages
+	// weren't held already.
+	uint32_t Add(std::vector<uint8_t> state, const uint8_t* ram,
+	             const std::vector<uint32_t>& pages, size_t* num_new = nullptr);
+
+	// The state of checkpoint 'id' and the 'num_pages' of RAM as they were
+	// then. Fails if the ID is unknown or a page was never captured.
+	bool Restore(uint32_t id, size_t num_pages, std::vector<uint8_t>& state,
+	             std::vector<uint8_t>& ram, std::string& error) const;
+
+	void Clear();
+
+	// IDs of the kept checkpoints, oldest first
+	std::vector<uint32_t> Ids() const;
+
+	// Bytes of page contents held, deflated or not yet, counting pages
+	// shared between checkpoints once
+	size_t PageBytes() const;
+
+	// Waits until every page taken so far has been deflated
+	void Flush();
+
+private:
+	struct Checkpoint {
+		uint32_t id                         = 0;
+		std::vector<uint8_t> state          = {};
+		std::map<uint32_t, PageChunk> pages = {};
+	};
+
+	const size_t max_checkpoints = 0;
+
+	const std::shared_ptr<PageChunkStore> chunks;
+
+	mutable std::mutex mutex           = {};
+	std::deque<Checkpoint> checkpoints = {};
+	uint32_t next_id                   = 1;
+};
+
+struct CheckpointInfo {
+	uint32_t id      = 0;
+	size_t num_pages = 0;
+	size_t num_bytes = 0;
+};
+
+// Takes a checkpoint of the whole machine; the first one turns on the
+// dirty page tracking and carries every page. Same calling rules as
+// SAVESTATE_SaveSlot().
+bool SAVESTATE_Checkpoint(CheckpointInfo& info, std::string& error);
+bool SAVESTATE_RestoreCheckpoint(uint32_t id, std::string& error);
+
+// Park and restart the page deflater around a fork
+void SAVESTATE_SuspendThreads();
+void SAVESTATE_ResumeThreads();
+
+// Component hooks, each defined next to the state it covers
+void CPU_SaveState(SaveStateWriter& out);
+bool CPU_LoadState(SaveStateReader& in, bool apply);
+void MEM_SaveState(SaveStateWriter& out);
+bool MEM_LoadState(SaveStateReader& in, bool apply);
+// The memory section without the page contents, which checkpoints keep
+// apart; loading it takes the contents from 'image', all of guest RAM
+void MEM_SaveStateWithoutPages(SaveStateWriter& out);
+bool MEM_LoadStateWithPages(SaveStateReader& in, bool apply,
+                            const std::vector<uint8_t>& image);
+void PAGING_SaveState(SaveStateWriter& out);
+bool PAGING_LoadState(SaveStateReader& in, bool apply);
+void PIC_SaveState(SaveStateWriter& out);
+bool PIC_LoadState(SaveStateReader& in, bool apply);
+void TIMER_SaveState(SaveStateWriter& out);
+bool TIMER_LoadState(SaveStateReader& in, bool apply);
+void I8042_SaveState(SaveStateWriter& out);
+bool I8042_LoadState(SaveStateReader& in, bool apply);
+void VGA_SaveState(SaveStateWriter& out);
+bool VGA_LoadState(SaveStateReader& in, bool apply);
+void EMS_SaveState(SaveStateWriter& out);
+bool EMS_LoadState(SaveStateReader& in, bool apply);
+void XMS_SaveState(SaveStateWriter& out);
+bool XMS_LoadState(SaveStateReader& in, bool apply);
+void DOS_SaveState(SaveStateWriter& out);
+bool DOS_LoadState(SaveStateReader& in, bool apply);
+
+#endif // DOSBOX_SAVESTATE_H
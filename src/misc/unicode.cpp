@@ -4,12 +4,15 @@
 #include "dosbox.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <fstream>
 #include <map>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "utils/checks.h"
@@ -245,6 +248,8 @@ struct config_mapping_entry_t {
 
 using config_mappings_t = std::map<uint16_t, config_mapping_entry_t>;
 
+using dos_to_utf8_table_t = std::array<std::string, 256>;
+
 static const std::string file_name_main          = "MAIN.TXT";
 static const std::string file_name_ascii         = "ASCII.TXT";
 static const std::string file_name_case          = "CAPITAL_SMALL.TXT";
@@ -303,6 +308,16 @@ struct code_page_maps_t {
 	// Mapping to change DOS character casing
 	map_dos_character_case_t uppercase = {};
 	map_dos_character_case_t lowercase = {};
+	// Flat tables for the common cases, so most characters are converted
+	// without a grapheme or map lookup:
+	// - every DOS character, as a screen code, already encoded in UTF-8
+	dos_to_utf8_table_t screen_code_to_utf8 = {};
+	// - the DOS character of each code point on its own (no combining
+	//   marks), indexed by the code point; 0 if the code page lacks it
+	std::vector<uint8_t> code_point_to_dos = {};
+	// - code points the box-optimized fallback might replace
+	uint16_t box_code_point_first = 1;
+	uint16_t box_code_point_last  = 0;
 };
 
 static std::map<uint16_t, code_page_maps_t> per_code_page_mappings = {};
@@ -362,6 +377,11 @@ static bool is_combining_mark(const uint32_t code_point)
 	};
 	// clang-format on
 
+	// Most text is below all the ranges
+	if (code_point < Ranges[0].first) {
+		return false;
+	}
+
 	auto in_range = [code_point](const auto& range) {
 		return code_point >= range.first && code_point <= range.second;
 	};
@@ -807,12 +827,15 @@ static std::string wide_to_dos(const wide_string& str,
 
 	const map_box_code_points_t* box_code_points = nullptr;
 
+	const code_page_maps_t* flat_tables = nullptr;
+
 	// Try to find UTF8 -> code page mapping
 	if (code_page != 0) {
 		const auto it = per_code_page_mappings.find(code_page);
 
 		if (it != per_code_page_mappings.end()) {
 			const auto& mappings = it->second;
+			flat_tables        = &mappings;
 			mapping_normalized = &mappings.dos_to_grapheme_normalized;
 			mapping_decomposed = &mappings.dos_to_grapheme_decomposed;
 			aliases_normalized = &mappings.aliases_normalized;
@@ -968,7 +991,40 @@ static std::string wide_to_dos(const wide_string& str,
 		}
 	};
 
+	// Finds the character in the flat table, if it's a plain 7-bit ASCII
+	// one or a code page character that no fallback mode would replace
+	auto find_flat = [&](const uint16_t code_point) -> std::optional<uint8_t> {
+		if (code_point < DecodeThresholdNonAscii) {
+			if (is_control_code(code_point)) {
+				return {};
+			}
+			return static_cast<uint8_t>(code_point);
+		}
+		if (!flat_tables) {
+			return {};
+		}
+		if (fallback == UnicodeFallback::Box &&
+		    code_point >= flat_tables->box_code_point_first &&
+		    code_point <= flat_tables->box_code_point_last) {
+			return {};
+		}
+		const auto character = flat_tables->code_point_to_dos[code_point];
+		if (character == 0) {
+			return {};
+		}
+		return character;
+	};
+
 	for (size_t i = 0; i < str.size(); ++i) {
+		const auto has_marks = i + 1 < str.size() &&
+		                       is_combining_mark(str[i + 1]);
+		if (!has_marks) {
+			if (const auto character = find_flat(str[i]); character) {
+				str_out.push_back(static_cast<char>(*character));
+				continue;
+			}
+		}
+
 		Grapheme grapheme(str[i]);
 		while (i + 1 < str.size() && is_combining_mark(str[i + 1])) {
 			++i;
@@ -1011,13 +1067,12 @@ static wide_string dos_to_wide(const std::string& str,
 		const auto byte = static_cast<uint8_t>(character);
 		if (byte >= DecodeThresholdNonAscii) {
 			// Take from code page mapping
-			auto& mappings = per_code_page_mappings[code_page];
-
-			if (!per_code_page_mappings.contains(code_page) ||
-			    !mappings.grapheme_to_dos.contains(byte)) {
+			const auto it = per_code_page_mappings.find(code_page);
+			if (it == per_code_page_mappings.end() ||
+			    !it->second.grapheme_to_dos.contains(byte)) {
 				str_out.push_back(UnknownCharacter);
 			} else {
-				mappings.grapheme_to_dos[byte].PushInto(str_out);
+				it->second.grapheme_to_dos.at(byte).PushInto(str_out);
 			}
 		} else if (is_control_code(byte)) {
 			const auto wide = control_code_to_wide(byte, convert_mode);
@@ -1034,6 +1089,30 @@ static wide_string dos_to_wide(const std::string& str,
 	return str_out;
 }
 
+static dos_to_utf8_table_t construct_screen_code_table(const uint16_t code_page)
+{
+	dos_to_utf8_table_t table = {};
+	for (size_t i = 0; i < table.size(); ++i) {
+		const std::string character(1, static_cast<char>(i));
+		table[i] = wide_to_utf8(dos_to_wide(character,
+		                                    DosStringConvertMode::ScreenCodesOnly,
+		                                    code_page));
+	}
+	return table;
+}
+
+static const dos_to_utf8_table_t& get_screen_code_table(const uint16_t code_page)
+{
+	const auto it = per_code_page_mappings.find(code_page);
+	if (it != per_code_page_mappings.end()) {
+		return it->second.screen_code_to_utf8;
+	}
+
+	// Pure 7-bit ASCII, or an unknown code page
+	static const auto table_ascii = construct_screen_code_table(0);
+	return table_ascii;
+}
+
 // ***************************************************************************
 // Read resources from files
 // ***************************************************************************
@@ -1949,6 +2028,25 @@ static void construct_case_mapping(const map_code_point_case_t& map_case_global,
 	}
 }
 
+static void construct_flat_tables(const uint16_t code_page, code_page_maps_t& mappings)
+{
+	mappings.screen_code_to_utf8 = construct_screen_code_table(code_page);
+
+	auto& code_point_to_dos = mappings.code_point_to_dos;
+	code_point_to_dos.assign(UINT16_MAX + 1, 0);
+	for (const auto& [grapheme, character] : mappings.dos_to_grapheme_normalized) {
+		if (!grapheme.HasMark()) {
+			code_point_to_dos[grapheme.GetCodePoint()] = character;
+		}
+	}
+
+	const auto& box_code_points = mappings.box_code_points;
+	if (!box_code_points.empty()) {
+		mappings.box_code_point_first = box_code_points.begin()->first;
+		mappings.box_code_point_last  = box_code_points.rbegin()->first;
+	}
+}
+
 static bool construct_mapping(const uint16_t code_page)
 {
 	// Prevent processing if previous attempt failed;
@@ -2043,6 +2141,7 @@ static bool construct_mapping(const uint16_t code_page)
 	construct_case_mapping(lowercase, mappings.dos_to_grapheme_normalized,
 	                       mappings.lowercase);
 
+	construct_flat_tables(code_page, mappings);
 	return true;
 }
 
@@ -2181,23 +2280,39 @@ std::string utf8_to_dos(const std::string& str,
 	                          get_custom_code_page(code_page));
 }
 
-static std::string dos_to_utf8_common(const std::string& str,
+static std::string dos_to_utf8_common(const std::string_view str,
                                       const DosStringConvertMode convert_mode,
                                       const uint16_t code_page)
 {
 	load_config_if_needed();
 
-	const auto wide = dos_to_wide(str, convert_mode, code_page);
-	return wide_to_utf8(wide);
+	const auto& table = get_screen_code_table(code_page);
+
+	std::string str_out = {};
+	str_out.reserve(str.size());
+
+	for (const auto character : str) {
+		const auto byte = static_cast<uint8_t>(character);
+		if (convert_mode == DosStringConvertMode::ScreenCodesOnly ||
+		    !is_control_code(byte)) {
+			str_out.append(table[byte]);
+			continue;
+		}
+
+		const auto wide = control_code_to_wide(byte, convert_mode);
+		str_out.push_back(static_cast<char>(wide ? *wide : UnknownCharacter));
+	}
+
+	return str_out;
 }
 
-std::string dos_to_utf8(const std::string& str,
+std::string dos_to_utf8(const std::string_view str,
                         const DosStringConvertMode convert_mode)
 {
 	return dos_to_utf8_common(str, convert_mode, get_utf8_code_page());
 }
 
-std::string dos_to_utf8(const std::string& str,
+std::string dos_to_utf8(const std::string_view str,
                         const DosStringConvertMode convert_mode,
                         const uint16_t code_page)
 {
@@ -5,6 +5,7 @@
 #define DOSBOX_UNICODE_H
 
 #include <string>
+#include <string_view>
 
 // Get recommended DOS code page to render the UTF-8 strings to. This
 // might not be the code page set using KEYB command, for example due
@@ -58,10 +59,10 @@ std::string utf8_to_dos(const std::string& str,
                         const UnicodeFallback fallback,
                         const uint16_t code_page);
 
-std::string dos_to_utf8(const std::string& str,
+std::string dos_to_utf8(const std::string_view str,
                         const DosStringConvertMode convert_mode);
 
-std::string dos_to_utf8(const std::string& str,
+std::string dos_to_utf8(const std::string_view str,
                         const DosStringConvertMode convert_mode,
                         const uint16_t code_page);
 
@@ -2,6 +2,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
 #include <map>
 #include <stdexcept>
 
@@ -9,14 +12,43 @@
 #include <sys/socket.h> // AF_INET
 #endif
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "dosbox.h"
 #include "dosbox_config.h"
 #include "utils/dynlib.h"
 #include "ethernet_slirp.h"
 #include "hardware/timer.h"
 #include "config/setup.h"
+#include "misc/perf_counters.h"
+#include "misc/support.h"
 #include "utils/string_utils.h"
 
+static PerfCounter slirp_tx_packets("slirp_tx_packets",
+                                    "Packets the guest sent through Slirp.");
+
+static PerfCounter slirp_rx_packets("slirp_rx_packets",
+                                    "Packets Slirp received for the guest.");
+
+static PerfCounter slirp_tx_dropped(
+        "slirp_tx_dropped",
+        "Packets from the guest dropped because the Slirp thread fell behind.");
+
+static PerfCounter slirp_rx_dropped(
+        "slirp_rx_dropped",
+        "Packets for the guest dropped because the emulation fell behind.");
+
+// The longest the Slirp thread sleeps between rounds. Without a way to
+// wake select() up on Windows, queued packets wait up to this long there.
+#ifdef WIN32
+constexpr uint32_t MaxPollTimeoutMs = 1;
+#else
+constexpr uint32_t MaxPollTimeoutMs = 100;
+#endif
+
 /**
  * Platform specific libslirp shared library name
  */
@@ -190,8 +222,19 @@ SlirpEthernetConnection::SlirpEthernetConnection()
 
 SlirpEthernetConnection::~SlirpEthernetConnection()
 {
+	StopThread();
+
 	if (slirp)
 		LibSlirp::slirp_cleanup(slirp);
+
+#ifndef WIN32
+	for (auto& fd : wake_fds) {
+		if (fd >= 0) {
+			close(fd);
+			fd = -1;
+		}
+	}
+#endif
 }
 
 bool SlirpEthernetConnection::Initialize(Section *dosbox_config)
@@ -266,6 +309,22 @@ bool SlirpEthernetConnection::Initialize(Section *dosbox_config)
 		ClearPortForwards(is_udp, forwarded_udp_ports);
 		forwarded_udp_ports = SetupPortForwards(is_udp, section->GetString("udp_port_forwards"));
 
+#ifndef WIN32
+		if (pipe(wake_fds) != 0) {
+			LOG_WARNING("SLIRP: Failed to create wake-up pipe: %s",
+			            strerror(errno));
+			return false;
+		}
+		for (const auto fd : wake_fds) {
+			fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		}
+#endif
+
+		// From here on, libslirp is only used on its own thread
+		is_running = true;
+		thread = std::thread(&SlirpEthernetConnection::Run, this);
+		set_thread_name(thread, "dosbox:slirp");
+
 		LOG_MSG("SLIRP: Successfully initialized");
 		return true;
 	} else {
@@ -417,19 +476,25 @@ void SlirpEthernetConnection::SendPacket(const uint8_t *packet, int len)
 		            len, GetMTU());
 		return;
 	}
-	LibSlirp::slirp_input(slirp, packet, len);
+	if (!tx_queue.NonblockingEnqueue(std::vector<uint8_t>(packet, packet + len))) {
+		slirp_tx_dropped.Add();
+		return;
+	}
+	slirp_tx_packets.Add();
+	Wake();
 }
 
 void SlirpEthernetConnection::GetPackets(std::function<int(const uint8_t *, int)> callback)
 {
-	get_packet_callback = callback;
-	uint32_t timeout_ms = 0;
-	PollsClear();
-	PollsAddRegistered();
-	LibSlirp::slirp_pollfds_fill(slirp, &timeout_ms, db_slirp_add_poll, this);
-	const bool poll_failed = !PollsPoll(timeout_ms);
-	LibSlirp::slirp_pollfds_poll(slirp, poll_failed, db_slirp_get_revents, this);
-	TimersRun();
+	// Take everything received so far in one go
+	const auto num_packets = rx_queue.Size();
+	if (num_packets == 0)
+		return;
+
+	rx_queue.BulkDequeue(rx_batch, num_packets);
+	for (const auto& packet : rx_batch)
+		callback(packet.data(), check_cast<int>(packet.size()));
+	rx_batch.clear();
 }
 
 int SlirpEthernetConnection::ReceivePacket(const uint8_t *packet, int len)
@@ -442,7 +507,68 @@ int SlirpEthernetConnection::ReceivePacket(const uint8_t *packet, int len)
 		            len, GetMRU());
 		return -1;
 	}
-	return get_packet_callback(packet, len);
+	if (!rx_queue.NonblockingEnqueue(std::vector<uint8_t>(packet, packet + len))) {
+		slirp_rx_dropped.Add();
+		return -1;
+	}
+	slirp_rx_packets.Add();
+	return len;
+}
+
+void SlirpEthernetConnection::Run()
+{
+	while (is_running) {
+		// Pass on what the guest sent since the last round
+		if (const auto num_packets = tx_queue.Size(); num_packets > 0) {
+			tx_queue.BulkDequeue(tx_batch, num_packets);
+			for (const auto& packet : tx_batch)
+				LibSlirp::slirp_input(slirp,
+				                      packet.data(),
+				                      check_cast<int>(packet.size()));
+			tx_batch.clear();
+		}
+
+		// libslirp only ever lowers the timeout
+		uint32_t timeout_ms = TimersGetTimeoutMs(MaxPollTimeoutMs);
+
+		PollsClear();
+#ifndef WIN32
+		const auto wake_idx = PollAdd(wake_fds[0], SLIRP_POLL_IN);
+#endif
+		PollsAddRegistered();
+		LibSlirp::slirp_pollfds_fill(slirp, &timeout_ms, db_slirp_add_poll, this);
+		const bool poll_failed = !PollsPoll(timeout_ms);
+
+#ifndef WIN32
+		if (!poll_failed && (polls[static_cast<size_t>(wake_idx)].revents & POLLIN)) {
+			uint8_t buf[64];
+			while (read(wake_fds[0], buf, sizeof(buf)) > 0) {
+				// drain the wake-ups
+			}
+		}
+#endif
+		LibSlirp::slirp_pollfds_poll(slirp, poll_failed, db_slirp_get_revents, this);
+		TimersRun();
+	}
+}
+
+void SlirpEthernetConnection::StopThread()
+{
+	if (!thread.joinable())
+		return;
+
+	is_running = false;
+	Wake();
+	thread.join();
+}
+
+void SlirpEthernetConnection::Wake()
+{
+#ifndef WIN32
+	// A full pipe already has a wake-up pending
+	const uint8_t byte = 0;
+	[[maybe_unused]] const auto result = write(wake_fds[1], &byte, sizeof(byte));
+#endif
 }
 
 struct slirp_timer *SlirpEthernetConnection::TimerNew(SlirpTimerCb cb, void *cb_opaque)
@@ -479,6 +605,21 @@ void SlirpEthernetConnection::TimersRun()
 	}
 }
 
+uint32_t SlirpEthernetConnection::TimersGetTimeoutMs(const uint32_t max_timeout_ms) const
+{
+	const int64_t now = db_slirp_clock_get_ns(nullptr);
+
+	auto timeout_ms = static_cast<int64_t>(max_timeout_ms);
+	for (const struct slirp_timer *timer : timers) {
+		if (timer->expires_ns) {
+			// Round up, so the timer has expired by the time we wake
+			const auto remaining_ms = (timer->expires_ns - now + 999'999) / 1'000'000;
+			timeout_ms = std::clamp(remaining_ms, int64_t{0}, timeout_ms);
+		}
+	}
+	return static_cast<uint32_t>(timeout_ms);
+}
+
 void SlirpEthernetConnection::TimersClear()
 {
 	for (auto *timer : timers)
@@ -617,6 +758,13 @@ int SlirpEthernetConnection::PollAdd(int fd, int slirp_events)
 
 bool SlirpEthernetConnection::PollsPoll(uint32_t timeout_ms)
 {
+	// select() fails straight away without any sockets to wait on
+	if (readfds.fd_count == 0 && writefds.fd_count == 0 &&
+	    exceptfds.fd_count == 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+		return true;
+	}
+
 	struct timeval timeout;
 	timeout.tv_sec = timeout_ms / 1000;
 	timeout.tv_usec = (timeout_ms % 1000) * 1000;
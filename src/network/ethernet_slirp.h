@@ -6,14 +6,17 @@
 
 #include "dosbox.h"
 
+#include <atomic>
 #include <map>
 #include <deque>
+#include <thread>
 #include <vector>
 
 #include <slirp/libslirp.h>
 
 #include "dosbox_config.h"
 #include "ethernet.h"
+#include "utils/rwqueue.h"
 
 /*
  * libslirp really wants a poll() API, so we'll use that when we're
@@ -44,6 +47,13 @@ struct slirp_timer {
  * This backend uses a virtual Ethernet device. Only TCP, UDP and some ICMP
  * work over this interface. This is because libslirp terminates guest
  * connections during routing and passes them to sockets created in the host.
+ *
+ * libslirp's polling and timers run on a thread of their own, so the host
+ * sockets are serviced as soon as they're ready rather than once per
+ * emulated tick. Packets pass between that thread and the emulation through
+ * a queue in each direction; GetPackets hands over everything received
+ * since the previous call at once. When a queue is full, packets are
+ * dropped like on a congested wire.
  */
 class SlirpEthernetConnection : public EthernetConnection {
 public:
@@ -59,7 +69,7 @@ public:
 	void SendPacket(const uint8_t* packet, int len) override;
 	void GetPackets(std::function<int(const uint8_t*, int)> callback) override;
 
-	/* Called by libslirp when it has a packet for us */
+	/* Called by libslirp when it has a packet for us, on the Slirp thread */
 	int ReceivePacket(const uint8_t* packet, int len);
 
 	// Used in callbacks to bounds-check packet lengths
@@ -84,9 +94,20 @@ public:
 	void PollUnregister(int fd);
 
 private:
+	// Packets waiting in each direction
+	static constexpr auto MaxQueuedPackets = 256;
+
+	/* The Slirp thread's loop */
+	void Run();
+	void StopThread();
+
+	/* Wakes the Slirp thread up from polling */
+	void Wake();
+
 	/* Runs and clears all the timers*/
 	void TimersRun();
 	void TimersClear();
+	uint32_t TimersGetTimeoutMs(const uint32_t max_timeout_ms) const;
 
 	void ClearPortForwards(const bool is_udp, std::map<int, int> &existing_port_forwards);
 	std::map<int, int> SetupPortForwards(const bool is_udp, const std::string &port_forward_rules);
@@ -101,15 +122,15 @@ private:
 	SlirpCb slirp_callbacks = {};  /*!< Callbacks used by libslirp */
 	std::deque<struct slirp_timer *> timers = {}; /*!< Stored timers */
 
-	/** The GetPacket callback
-	 * When libslirp has a new packet for us it calls ReceivePacket,
-	 * but the EthernetConnection interface requires users to poll
-	 * for new packets using GetPackets. We temporarily store the
-	 * callback from GetPackets here for ReceivePacket.
-	 * This might seem racy, but keep in mind we control when
-	 * libslirp sends us packets via our polling system.
-	 */
-	std::function<int(const uint8_t *, int)> get_packet_callback = nullptr;
+	std::thread thread           = {};
+	std::atomic<bool> is_running = false;
+
+	/* From the guest to libslirp, and back */
+	RWQueue<std::vector<uint8_t>> tx_queue{MaxQueuedPackets};
+	RWQueue<std::vector<uint8_t>> rx_queue{MaxQueuedPackets};
+
+	std::vector<std::vector<uint8_t>> tx_batch = {}; /*!< Slirp thread only */
+	std::vector<std::vector<uint8_t>> rx_batch = {}; /*!< GetPackets only */
 
 	std::deque<int> registered_fds = {}; /*!< File descriptors to watch */
 
@@ -119,6 +140,8 @@ private:
 
 #ifndef WIN32
 	std::vector<struct pollfd> polls = {}; /*!< Descriptors for poll() */
+
+	int wake_fds[2] = {-1, -1}; /*!< Pipe for waking the Slirp thread */
 #else
 	fd_set readfds = {};   /*!< Read descriptors for select() */
 	fd_set writefds = {};  /*!< Write descriptors for select() */
@@ -13,6 +13,7 @@
 #include "config/setup.h"
 #include "shell/shell.h"
 #include "utils/string_utils.h"
+#include "misc/benchmark.h"
 #include "misc/unicode.h"
 
 #include <algorithm>
@@ -276,6 +277,17 @@ AutoExecModule::AutoExecModule(Section* configuration)
 		AddLine(Placement::InitialAutogeneratedCommands, CmdMouse + ToNul);
 	}
 
+	// A benchmark runs its workloads and nothing else
+	if (BENCHMARK_IsActive()) {
+		constexpr auto placement = Placement::CommandsAfterAutoexecSection;
+		AutoMountDriveC(BENCHMARK_GetWorkDirectory(), placement);
+		for (const auto& line : BENCHMARK_GetAutoexecLines()) {
+			AddLine(placement, line);
+		}
+		AddLine(placement, "@EXIT");
+		return;
+	}
+
 	// Auto-mount drives (except for DOSBox's Z:) prior to [autoexec]
 	if (sec->GetBool("automount")) {
 		for (char letter = 'a'; letter < 'z'; ++letter) {
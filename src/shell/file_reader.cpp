@@ -3,6 +3,8 @@
 
 #include "file_reader.h"
 
+#include <algorithm>
+
 std::unique_ptr<FileReader> FileReader::GetFileReader(const std::string& filename)
 {
 	auto fullname = DOS_Canonicalize(filename.c_str());
@@ -12,42 +14,65 @@ std::unique_ptr<FileReader> FileReader::GetFileReader(const std::string& filenam
 		return {};
 	}
 	DOS_CloseFile(handle);
-	return std::unique_ptr<FileReader>(new FileReader(std::move(fullname)));
+
+	uint8_t drive = 0;
+	char dos_name[DOS_PATHLENGTH];
+	if (!DOS_MakeName(fullname.c_str(), dos_name, &drive)) {
+		return {};
+	}
+	return std::unique_ptr<FileReader>(
+	        new FileReader(std::move(fullname), drive, dos_name));
 }
 
-FileReader::FileReader(std::string filename)
+FileReader::FileReader(std::string filename, const uint8_t drive, std::string fullname)
         : filename(std::move(filename)),
+          drive(drive),
+          fullname(std::move(fullname)),
+          contents(),
+          change_count(),
+          generation(0),
           cursor(0)
 {}
 
-std::optional<std::string> FileReader::Read()
+void FileReader::Refresh()
 {
+	const auto changes = DOS_GetFileChangeCount(drive, fullname.c_str());
+	if (change_count == changes) {
+		return;
+	}
+	if (change_count) {
+		++generation;
+	}
+	change_count = changes;
+	contents.clear();
+
 	uint16_t entry = {};
 	if (!DOS_OpenFile(filename.c_str(), (DOS_NOT_INHERIT | OPEN_READ), &entry)) {
-		return {};
+		return;
 	}
-	DOS_SeekFile(entry, &cursor, DOS_SEEK_SET);
-
-	uint8_t data           = 0;
-	uint16_t bytes_to_read = 1;
-	std::string line       = {};
-
-	while (data != '\n') {
-		bool result = DOS_ReadFile(entry, &data, &bytes_to_read);
-		if (!result || bytes_to_read == 0) {
+	uint8_t buffer[0x8000];
+	for (;;) {
+		uint16_t bytes_read = sizeof(buffer);
+		if (!DOS_ReadFile(entry, buffer, &bytes_read) || bytes_read == 0) {
 			break;
 		}
-		line += static_cast<char>(data);
+		contents.append(reinterpret_cast<const char*>(buffer), bytes_read);
 	}
-
-	cursor = 0;
-	DOS_SeekFile(entry, &cursor, DOS_SEEK_CUR);
 	DOS_CloseFile(entry);
+}
 
-	if (line.empty()) {
+std::optional<std::string> FileReader::Read()
+{
+	Refresh();
+	if (cursor >= contents.size()) {
 		return {};
 	}
 
+	const auto newline = contents.find('\n', cursor);
+	const auto end = (newline == std::string::npos) ? contents.size() : newline + 1;
+
+	std::string line = contents.substr(cursor, end - cursor);
+	cursor = static_cast<uint32_t>(end);
 	return line;
 }
 
@@ -55,3 +80,19 @@ void FileReader::Reset()
 {
 	cursor = 0;
 }
+
+std::optional<uint32_t> FileReader::GetPosition()
+{
+	return cursor;
+}
+
+void FileReader::SetPosition(const uint32_t position)
+{
+	cursor = position;
+}
+
+uint32_t FileReader::GetGeneration()
+{
+	Refresh();
+	return generation;
+}
@@ -9,6 +9,10 @@
 
 #include "shell/shell.h"
 
+// Reads the lines of a batch file from a copy of it kept in memory. The
+// copy is read again whenever the file is changed through DOS, and the
+// lines continue from the same offset then, like they would when reading
+// the file itself line by line.
 class FileReader final : public LineReader {
 public:
 	static std::unique_ptr<FileReader> GetFileReader(const std::string& file);
@@ -16,6 +20,10 @@ public:
 	void Reset() override;
 	std::optional<std::string> Read() override;
 
+	std::optional<uint32_t> GetPosition() override;
+	void SetPosition(uint32_t position) override;
+	uint32_t GetGeneration() override;
+
 	FileReader(const FileReader&)            = delete;
 	FileReader& operator=(const FileReader&) = delete;
 	FileReader(FileReader&&)                 = default;
@@ -23,9 +31,18 @@ public:
 	~FileReader() override                   = default;
 
 private:
-	explicit FileReader(std::string filename);
+	FileReader(std::string filename, uint8_t drive, std::string fullname);
+
+	// Reads the file again if it was changed since
+	void Refresh();
 
 	std::string filename;
+	uint8_t drive;
+	std::string fullname;
+
+	std::string contents;
+	std::optional<uint32_t> change_count;
+	uint32_t generation;
 	uint32_t cursor;
 };
 
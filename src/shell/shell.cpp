@@ -20,6 +20,7 @@
 #include "hardware/timer.h"
 #include "misc/support.h"
 #include "shell/autoexec.h"
+#include "textmode_server/textmode_server.h"
 #include "utils/fs_utils.h"
 #include "utils/string_utils.h"
 
@@ -421,6 +422,18 @@ void DOS_Shell::RunBatchFile()
 	}
 }
 
+// Tells EVENTS subscribers the shell is back at its prompt
+static void notify_prompt()
+{
+	char dir[DOS_PATHLENGTH];
+	reset_str(dir);
+	DOS_GetCurrentDir(0, dir);
+
+	const auto drive = static_cast<char>(DOS_GetDefaultDrive() + 'A');
+	const auto path  = format_str("%c:\\%s", drive, dir);
+	TEXTMODESERVER_OnShellPrompt(path.c_str());
+}
+
 void DOS_Shell::Run()
 {
 	// COMMAND.COM's /C and /INIT spawn sub-commands. When parsing help, we need
@@ -481,6 +494,7 @@ void DOS_Shell::Run()
 			RunBatchFile();
 		} else {
 			if (echo) ShowPrompt();
+			notify_prompt();
 			InputCommand(input_line);
 			ParseLine(input_line);
 		}
@@ -11,6 +11,7 @@
 #include <optional>
 #include <stack>
 #include <string>
+#include <unordered_map>
 
 #include "cpu/callback.h"
 #include "dos/programs.h"
@@ -28,6 +29,19 @@ public:
 	virtual void Reset()       = 0;
 	virtual std::optional<std::string> Read() = 0;
 
+	// Readers that can return to a line tell where the next Read()
+	// continues, and how often their contents were read again because
+	// they changed; nothing for the others
+	virtual std::optional<uint32_t> GetPosition()
+	{
+		return {};
+	}
+	virtual void SetPosition(uint32_t) {}
+	virtual uint32_t GetGeneration()
+	{
+		return 0;
+	}
+
 	virtual ~LineReader() = default;
 };
 
@@ -51,11 +65,17 @@ public:
 private:
 	[[nodiscard]] std::string ExpandedBatchLine(std::string_view line) const;
 	[[nodiscard]] std::optional<std::string> GetLine();
+	void IndexLabels();
 
 	const Environment& shell;
 	CommandLine cmd;
 	std::unique_ptr<LineReader> reader;
 	bool echo;
+
+	// Where the lines after the first label of each name start, by the
+	// upper-cased name, and the reader generation they were found in
+	std::unordered_map<std::string, uint32_t> labels = {};
+	std::optional<uint32_t> labels_generation        = {};
 };
 
 class AutoexecEditor;
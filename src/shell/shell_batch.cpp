@@ -120,6 +120,22 @@ std::string BatchFile::ExpandedBatchLine(std::string_view line) const
 
 bool BatchFile::Goto(const std::string_view label)
 {
+	// A label without blanks only ever matches the first word of a label
+	// line, so it's looked up in the index of those
+	if (reader->GetPosition() && label.find_first_of("\t\r\n ") == std::string::npos) {
+		if (labels_generation != reader->GetGeneration()) {
+			IndexLabels();
+		}
+		std::string name(label);
+		upcase(name);
+		const auto it = labels.find(name);
+		if (it == labels.end()) {
+			return false;
+		}
+		reader->SetPosition(it->second);
+		return true;
+	}
+
 	reader->Reset();
 
 	while (auto line = GetLine()) {
@@ -131,6 +147,26 @@ bool BatchFile::Goto(const std::string_view label)
 	return false;
 }
 
+void BatchFile::IndexLabels()
+{
+	labels.clear();
+	labels_generation = reader->GetGeneration();
+
+	reader->Reset();
+	while (auto line = GetLine()) {
+		const auto label_start  = line->find_first_not_of("=\t :");
+		const auto label_prefix = std::string_view(*line).substr(0, label_start);
+		if (label_start == std::string::npos ||
+		    std::count(label_prefix.begin(), label_prefix.end(), ':') != 1) {
+			continue;
+		}
+		auto name = line->substr(label_start);
+		name      = name.substr(0, name.find_first_of("\t\r\n "));
+		upcase(name);
+		labels.try_emplace(std::move(name), *reader->GetPosition());
+	}
+}
+
 void BatchFile::Shift()
 {
 	cmd.Shift(1);
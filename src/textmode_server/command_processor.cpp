@@ -5,6 +5,7 @@
 #include "textmode_server/keyboard_processor.h"
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cctype>
 #include <charconv>
@@ -16,6 +17,7 @@
 #include <iomanip>
 #include <limits>
 #include <optional>
+#include <regex>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -24,6 +26,8 @@
 #include <utility>
 #include <vector>
 
+#include "misc/tracy.h"
+
 namespace textmode {
 
 namespace {
@@ -53,6 +57,16 @@ void trace_log(const char* fmt, ...)
 inline void trace_log(const char*, ...) {}
 #endif
 
+std::string_view trim_view(std::string_view str)
+{
+	const auto begin = str.find_first_not_of(" \t\r\n");
+	if (begin == std::string_view::npos) {
+		return {};
+	}
+	const auto end = str.find_last_not_of(" \t\r\n");
+	return str.substr(begin, end - begin + 1);
+}
+
 std::string trim(std::string_view str)
 {
 	const auto begin = str.find_first_not_of(" \t\r\n");
@@ -63,6 +77,32 @@ std::string trim(std::string_view str)
 	return std::string(str.substr(begin, end - begin + 1));
 }
 
+// Whether 'text' equals the upper-case 'upper' with case ignored
+bool equals_upper(std::string_view text, std::string_view upper)
+{
+	return text.size() == upper.size() &&
+	       std::equal(text.begin(), text.end(), upper.begin(), [](const char a, const char b) {
+		       return std::toupper(static_cast<unsigned char>(a)) == b;
+	       });
+}
+
+bool ends_with_upper(std::string_view text, std::string_view upper_suffix)
+{
+	return text.size() > upper_suffix.size() &&
+	       equals_upper(text.substr(text.size() - upper_suffix.size()), upper_suffix);
+}
+
+// Lets the lookup tables be searched with views instead of strings
+struct StringViewHash {
+	using is_transparent = void;
+	size_t operator()(std::string_view text) const
+	{
+		return std::hash<std::string_view>{}(text);
+	}
+};
+
+using CaseLookup = std::unordered_map<std::string, std::string, StringViewHash, std::equal_to<>>;
+
 std::string to_upper(std::string_view str)
 {
 	std::string upper(str);
@@ -75,7 +115,29 @@ std::string to_upper(std::string_view str)
 
 constexpr uint32_t kMaxPeekLength  = 4096;
 constexpr uint32_t kMaxPokeLength  = 4096;
+constexpr size_t kMaxMemoryRegions         = 64;
+constexpr uint32_t kMaxMemoryRegionsLength = 16384;
 constexpr uint32_t kMaxDebugLength = 4096;
+constexpr uint32_t kMaxWatchIntervalMs = 60000;
+// One STEP grants at most an hour of emulated time (or as many frames)
+constexpr uint32_t kMaxStepAmount = 3600000;
+constexpr uint32_t kMaxTurboForMs  = 3600000;
+constexpr size_t kMaxPasteLength   = 65536;
+// Records an EVENTS subscriber holds between polls; a beeping game loop
+// shouldn't grow one without bound
+constexpr uint32_t kMaxPendingEvents = 256;
+
+constexpr size_t kMaxBatchLength     = 256;
+constexpr size_t kMaxMacros          = 256;
+constexpr size_t kMaxMacroNameLength = 32;
+
+constexpr std::array<std::string_view, 6> kEventTypes = {
+        "mode", "beep", "exec", "exit", "critical", "prompt"};
+constexpr uint8_t kMaxImageScale   = 4;
+// Wall-clock limit for TURBO UNTIL; emulation runs many times faster
+constexpr uint32_t kDefaultTurboTimeoutMs = 60000;
+constexpr uint32_t kDefaultWaitForTimeoutMs = 10000;
+constexpr uint32_t kMaxWaitForTimeoutMs     = 600000;
 
 std::optional<uint32_t> parse_unsigned_number(std::string_view text)
 {
@@ -121,6 +183,49 @@ std::optional<uint32_t> parse_unsigned_number(std::string_view text)
 	return value;
 }
 
+// Decimal frame generation as sent back in 'META generation=N'
+std::optional<uint64_t> parse_generation(std::string_view text)
+{
+	while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+		text.remove_prefix(1);
+	}
+	if (text.empty()) {
+		return std::nullopt;
+	}
+
+	uint64_t value = 0;
+	const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+	if (result.ec != std::errc() || result.ptr != text.data() + text.size()) {
+		return std::nullopt;
+	}
+	return value;
+}
+
+// 'row,col,rows,cols' as accepted by WAITFOR
+std::optional<TextRegion> parse_text_region(std::string_view token)
+{
+	std::array<uint16_t, 4> fields = {};
+	size_t start = 0;
+	for (size_t i = 0; i < fields.size(); ++i) {
+		const auto end = (i + 1 < fields.size()) ? token.find(',', start)
+		                                         : token.size();
+		if (end == std::string_view::npos) {
+			return std::nullopt;
+		}
+		const auto* first = token.data() + start;
+		const auto* last  = token.data() + end;
+		const auto result = std::from_chars(first, last, fields[i]);
+		if (first == last || result.ec != std::errc() || result.ptr != last) {
+			return std::nullopt;
+		}
+		start = end + 1;
+	}
+	if (fields[2] == 0 || fields[3] == 0) {
+		return std::nullopt;
+	}
+	return TextRegion{fields[0], fields[1], fields[2], fields[3]};
+}
+
 std::optional<uint32_t> parse_real_mode_address(std::string_view token)
 {
 	const auto colon_pos = token.find(':');
@@ -159,6 +264,104 @@ std::string bytes_to_hex(const std::vector<uint8_t>& bytes)
 	return hex;
 }
 
+// Parses "addr:len[,addr:len...]"; the length follows the last colon so
+// that segment:offset addresses keep working
+std::optional<std::vector<std::pair<uint32_t, uint32_t>>> parse_memory_regions(
+        const std::string_view token)
+{
+	std::vector<std::pair<uint32_t, uint32_t>> regions;
+	uint32_t total_length = 0;
+	std::string_view remaining = token;
+	while (!remaining.empty()) {
+		const auto comma  = remaining.find(',');
+		const auto region = remaining.substr(0, comma);
+		remaining = (comma == std::string_view::npos) ? std::string_view{}
+		                                              : remaining.substr(comma + 1);
+
+		const auto colon = region.rfind(':');
+		if (colon == std::string_view::npos || regions.size() == kMaxMemoryRegions) {
+			return std::nullopt;
+		}
+		const auto offset = parse_real_mode_address(region.substr(0, colon));
+		const auto length = parse_unsigned_number(region.substr(colon + 1));
+		if (!offset || !length || *length == 0 ||
+		    *length > kMaxMemoryRegionsLength - total_length) {
+			return std::nullopt;
+		}
+		total_length += *length;
+		regions.emplace_back(*offset, *length);
+	}
+	if (regions.empty() || token.back() == ',') {
+		return std::nullopt;
+	}
+	return regions;
+}
+
+// Parses '"literal text"' or '/regular expression/', then an optional
+// region and timeout, as taken by WAITFOR and TURBO UNTIL. Returns the error
+// reply, or an empty string once 'plan' is filled in.
+std::string parse_screen_condition(const std::string& argument, const std::string& verb,
+                                   const uint32_t default_timeout_ms, WaitPlan& plan)
+{
+	const auto invalid = "ERR invalid " + verb + " arguments\n";
+	if (argument.size() < 2 || (argument.front() != '"' && argument.front() != '/')) {
+		return invalid;
+	}
+	const char delimiter = argument.front();
+	size_t closing       = std::string::npos;
+	for (size_t pos = argument.find(delimiter, 1); pos != std::string::npos;
+	     pos = argument.find(delimiter, pos + 1)) {
+		if (pos + 1 == argument.size() || argument[pos + 1] == ' ') {
+			closing = pos;
+			break;
+		}
+	}
+	if (closing == std::string::npos || closing == 1) {
+		return invalid;
+	}
+	const auto pattern = argument.substr(1, closing - 1);
+
+	std::optional<TextRegion> region = std::nullopt;
+	uint32_t timeout_ms              = default_timeout_ms;
+	std::istringstream iss(argument.substr(closing + 1));
+	std::string token;
+	while (iss >> token) {
+		if (token.find(',') != std::string::npos) {
+			region = parse_text_region(token);
+			if (!region) {
+				return "ERR invalid " + verb + " region\n";
+			}
+			continue;
+		}
+		const auto value = parse_unsigned_number(token);
+		if (!value || *value > kMaxWaitForTimeoutMs) {
+			return invalid;
+		}
+		timeout_ms = *value;
+	}
+
+	plan.timeout = std::chrono::milliseconds(timeout_ms);
+	if (delimiter == '/') {
+		// Multiline so ^ and $ anchor at each screen row
+		std::regex expression;
+		try {
+			expression = std::regex(pattern,
+			                        std::regex::ECMAScript | std::regex::multiline |
+			                                std::regex::optimize);
+		} catch (const std::regex_error&) {
+			return "ERR invalid " + verb + " pattern\n";
+		}
+		plan.matches = [expression, region](const Snapshot& snapshot) {
+			return std::regex_search(BuildPlainText(snapshot, region), expression);
+		};
+	} else {
+		plan.matches = [pattern, region](const Snapshot& snapshot) {
+			return BuildPlainText(snapshot, region).find(pattern) != std::string::npos;
+		};
+	}
+	return {};
+}
+
 std::string format_memory_payload(const uint32_t address,
                                   const std::vector<uint8_t>& bytes)
 {
@@ -168,6 +371,54 @@ std::string format_memory_payload(const uint32_t address,
 	return oss.str();
 }
 
+std::string format_memory_change(const uint64_t tick, const uint32_t address,
+                                 const std::vector<uint8_t>& old_bytes,
+                                 const std::vector<uint8_t>& new_bytes)
+{
+	std::ostringstream oss;
+	oss << "MEMCHANGE tick=" << tick << " address=0x" << std::hex << std::uppercase
+	    << std::setfill('0') << std::setw(8) << address
+	    << " old=" << bytes_to_hex(old_bytes) << " new=" << bytes_to_hex(new_bytes)
+	    << "\n";
+	return oss.str();
+}
+
+bool is_delay_action(const TypeAction& action)
+{
+	return action.kind == TypeAction::Kind::DelayMs ||
+	       action.kind == TypeAction::Kind::DelayFrames;
+}
+
+// Commands whose replies wait for the emulator to run, which it doesn't
+// while a batch runs
+bool is_waiting_verb(const std::string_view verb)
+{
+	return verb == "WAITFOR" || verb == "STEP" || verb == "TURBO" || verb == "GETIMG";
+}
+
+bool is_valid_macro_name(const std::string_view name)
+{
+	if (name.empty() || name.size() > kMaxMacroNameLength) {
+		return false;
+	}
+	return std::all_of(name.begin(), name.end(), [](const unsigned char ch) {
+		return std::isalnum(ch) || ch == '_' || ch == '-';
+	});
+}
+
+std::string format_event(const uint64_t tick, const std::string_view type,
+                         const std::string_view fields)
+{
+	std::string record = "EVENT tick=" + std::to_string(tick) + " type=";
+	record += type;
+	if (!fields.empty()) {
+		record += ' ';
+		record += fields;
+	}
+	record += '\n';
+	return record;
+}
+
 int hex_digit_value(const char ch)
 {
 	if (ch >= '0' && ch <= '9') {
@@ -209,22 +460,25 @@ std::optional<std::vector<uint8_t>> parse_hex_bytes(std::string_view token)
 	return bytes;
 }
 
-struct TypeToken {
-	std::string text;
-	bool is_quoted = false;
-};
-
-std::vector<TypeToken> tokenize_type_arguments(const std::string& argument)
+// Token texts point into 'scratch', which holds the unescaped arguments;
+// both buffers are reused across commands, so a TYPE that fits the
+// capacity of earlier ones allocates nothing
+void tokenize_type_arguments(std::string_view argument, std::string& scratch,
+                             std::vector<TypeToken>& tokens)
 {
-	std::vector<TypeToken> tokens;
-	std::string current;
+	tokens.clear();
+	scratch.clear();
+	// Unescaping only ever shrinks the text, so the views stay valid
+	scratch.reserve(argument.size());
+
+	size_t start   = 0;
 	bool in_quotes = false;
 
 	const auto flush = [&](bool quoted) {
-		if (!current.empty()) {
-			tokens.push_back({current, quoted});
-			current.clear();
+		if (scratch.size() > start) {
+			tokens.push_back({std::string_view(scratch).substr(start), quoted});
 		}
+		start = scratch.size();
 	};
 
 	for (size_t i = 0; i < argument.size(); ++i) {
@@ -232,12 +486,12 @@ std::vector<TypeToken> tokenize_type_arguments(const std::string& argument)
 		if (in_quotes) {
 			if (ch == '\\' && i + 1 < argument.size()) {
 				const char next = argument[++i];
-				current.push_back(next);
+				scratch.push_back(next);
 			} else if (ch == '"') {
 				flush(true);
 				in_quotes = false;
 			} else {
-				current.push_back(ch);
+				scratch.push_back(ch);
 			}
 		} else {
 			if (std::isspace(static_cast<unsigned char>(ch))) {
@@ -246,26 +500,20 @@ std::vector<TypeToken> tokenize_type_arguments(const std::string& argument)
 				flush(false);
 				in_quotes = true;
 			} else {
-				current.push_back(ch);
+				scratch.push_back(ch);
 			}
 		}
 	}
 
-	if (in_quotes) {
-		flush(true);
-	} else {
-		flush(false);
-	}
-
-	return tokens;
+	flush(in_quotes);
 }
 
-void log_token_warning(const std::string& token, std::string_view reason)
+void log_token_warning(std::string_view token, std::string_view reason)
 {
 	if (!token.empty()) {
 		std::fprintf(stderr,
-		            "TEXTMODE: TYPE token '%s' skipped: %.*s\n",
-		            token.c_str(),
+		            "TEXTMODE: TYPE token '%.*s' skipped: %.*s\n",
+		            static_cast<int>(token.size()), token.data(),
 		            static_cast<int>(reason.size()), reason.data());
 	} else {
 		std::fprintf(stderr,
@@ -274,30 +522,45 @@ void log_token_warning(const std::string& token, std::string_view reason)
 	}
 }
 
-void log_case_warning(const std::string& provided, const std::string& expected)
+void log_case_warning(std::string_view provided, std::string_view expected)
 {
 	std::fprintf(stderr,
-	            "TEXTMODE: TYPE token '%s' skipped: case-sensitive token is '%s'\n",
-	            provided.c_str(), expected.c_str());
+	            "TEXTMODE: TYPE token '%.*s' skipped: case-sensitive token is '%.*s'\n",
+	            static_cast<int>(provided.size()), provided.data(),
+	            static_cast<int>(expected.size()), expected.data());
 }
 
-void log_command_case_warning(const std::string& provided, const std::string& expected)
+void log_command_case_warning(std::string_view provided, std::string_view expected)
 {
 	std::fprintf(stderr,
-	            "TEXTMODE: command '%s' rejected: use '%s'\n",
-	            provided.c_str(), expected.c_str());
+	            "TEXTMODE: command '%.*s' rejected: use '%.*s'\n",
+	            static_cast<int>(provided.size()), provided.data(),
+	            static_cast<int>(expected.size()), expected.data());
 }
 
-const std::unordered_map<std::string, std::string>& command_case_lookup()
+const CaseLookup& command_case_lookup()
 {
-	static const std::unordered_map<std::string, std::string> lookup = {
+	static const CaseLookup lookup = {
 	        {"TYPE", "TYPE"}, {"GET", "GET"}, {"VIEW", "VIEW"},
-	        {"STATS", "STATS"}, {"EXIT", "EXIT"},
-	        {"PEEK", "PEEK"},   {"DEBUG", "DEBUG"}, {"POKE", "POKE"}};
+	        {"STATS", "STATS"}, {"METRICS", "METRICS"}, {"EXIT", "EXIT"},
+	        {"PEEK", "PEEK"},   {"DEBUG", "DEBUG"}, {"POKE", "POKE"},
+	        {"PEEKV", "PEEKV"},
+	        {"DIFF", "DIFF"},   {"WATCH", "WATCH"}, {"UNWATCH", "UNWATCH"},
+	        {"WAITFOR", "WAITFOR"}, {"WATCHMEM", "WATCHMEM"},
+	        {"UNWATCHMEM", "UNWATCHMEM"}, {"EVENTS", "EVENTS"},
+	        {"SAVESTATE", "SAVESTATE"},
+	        {"LOADSTATE", "LOADSTATE"}, {"CHECKPOINT", "CHECKPOINT"},
+	        {"REWIND", "REWIND"}, {"CLONE", "CLONE"},
+	        {"STEP", "STEP"}, {"TURBO", "TURBO"},
+	        {"PASTE", "PASTE"},
+	        {"GETIMG", "GETIMG"}, {"PROFILE", "PROFILE"},
+	        {"MEMORY", "MEMORY"}, {"POOL", "POOL"},
+	        {"SET", "SET"}, {"MACRO", "MACRO"},
+	        {"BATCH", "BATCH"}, {"END", "END"}};
 	return lookup;
 }
 
-std::optional<std::string> suggest_command(const std::string& verb)
+std::optional<std::string> suggest_command(std::string_view verb)
 {
 	const auto upper = to_upper(verb);
 	const auto& lookup = command_case_lookup();
@@ -308,10 +571,10 @@ std::optional<std::string> suggest_command(const std::string& verb)
 	return std::nullopt;
 }
 
-const std::unordered_map<std::string, std::string>& key_case_lookup()
+const CaseLookup& key_case_lookup()
 {
-	static const std::unordered_map<std::string, std::string> lookup = [] {
-		std::unordered_map<std::string, std::string> result;
+	static const CaseLookup lookup = [] {
+		CaseLookup result;
 		for (const auto& name : textmode::KeyboardCommandProcessor::GetKeyNames()) {
 			const auto upper = to_upper(name);
 			result.emplace(upper, name);
@@ -321,7 +584,7 @@ const std::unordered_map<std::string, std::string>& key_case_lookup()
 	return lookup;
 }
 
-std::optional<std::string> suggest_key_token(const std::string& token)
+std::optional<std::string> suggest_key_token(std::string_view token)
 {
 	const auto upper = to_upper(token);
 	const auto& lookup = key_case_lookup();
@@ -355,40 +618,38 @@ bool send_keyboard_command(const std::function<CommandResponse(const std::string
 	return true;
 }
 
-std::optional<std::chrono::milliseconds> parse_delay_token(const std::string& token,
+// A run of decimal digits with no sign, fitting in 'T'
+template <typename T>
+std::optional<T> parse_digits(std::string_view digits)
+{
+	T value              = 0;
+	const auto [end, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+	if (digits.empty() || !std::isdigit(static_cast<unsigned char>(digits.front())) ||
+	    ec != std::errc() || end != digits.data() + digits.size()) {
+		return std::nullopt;
+	}
+	return value;
+}
+
+std::optional<std::chrono::milliseconds> parse_delay_token(std::string_view token,
                                                           bool& case_error)
 {
 	case_error = false;
 	constexpr std::string_view suffix = "ms";
-	if (token.size() > suffix.size() &&
-	    token.compare(token.size() - suffix.size(), suffix.size(), suffix) == 0) {
-		const auto digits = token.substr(0, token.size() - suffix.size());
-		if (!digits.empty() &&
-		    std::all_of(digits.begin(), digits.end(), [](unsigned char c) {
-		        return std::isdigit(c) != 0;
-		    })) {
-			try {
-				const auto value = std::stoul(digits);
-				if (value == 0) {
-					return std::nullopt;
-				}
-				return std::chrono::milliseconds(value);
-			} catch (const std::exception&) {
-				return std::nullopt;
-			}
+	if (token.size() > suffix.size() && token.ends_with(suffix)) {
+		const auto value = parse_digits<unsigned long>(
+		        token.substr(0, token.size() - suffix.size()));
+		if (!value || *value == 0) {
+			return std::nullopt;
 		}
-		return std::nullopt;
+		return std::chrono::milliseconds(*value);
 	}
 
-	const auto upper = to_upper(token);
-	if (upper.size() > suffix.size() &&
-	    upper.compare(upper.size() - suffix.size(), suffix.size(), "MS") == 0) {
-		case_error = true;
-	}
+	case_error = ends_with_upper(token, "MS");
 	return std::nullopt;
 }
 
-std::optional<uint32_t> parse_frames_token(const std::string& token,
+std::optional<uint32_t> parse_frames_token(std::string_view token,
                                            bool& case_error,
                                            std::string& expected)
 {
@@ -398,56 +659,23 @@ std::optional<uint32_t> parse_frames_token(const std::string& token,
 		return std::nullopt;
 	}
 
-	auto parse_digits = [](const std::string& digits) -> std::optional<uint32_t> {
-		if (digits.empty() ||
-		    !std::all_of(digits.begin(), digits.end(), [](unsigned char c) {
-		        return std::isdigit(c) != 0;
-		    })) {
-			return std::nullopt;
-		}
-		try {
-			const auto value = std::stoul(digits);
-			if (value == 0 || value > std::numeric_limits<uint32_t>::max()) {
+	for (const std::string_view suffix : {"frames", "frame"}) {
+		if (token.size() > suffix.size() && token.ends_with(suffix)) {
+			const auto value = parse_digits<uint32_t>(
+			        token.substr(0, token.size() - suffix.size()));
+			if (!value || *value == 0) {
 				return std::nullopt;
 			}
-			return static_cast<uint32_t>(value);
-		} catch (const std::exception&) {
-			return std::nullopt;
+			return value;
 		}
-	};
-
-	constexpr std::string_view suffix_plural = "frames";
-	constexpr std::string_view suffix_single = "frame";
-
-	if (token.size() > suffix_plural.size() &&
-	    token.compare(token.size() - suffix_plural.size(),
-	                 suffix_plural.size(),
-	                 suffix_plural) == 0) {
-		const auto digits = token.substr(0, token.size() - suffix_plural.size());
-		return parse_digits(digits);
-	}
-	if (token.size() > suffix_single.size() &&
-	    token.compare(token.size() - suffix_single.size(),
-	                 suffix_single.size(),
-	                 suffix_single) == 0) {
-		const auto digits = token.substr(0, token.size() - suffix_single.size());
-		return parse_digits(digits);
 	}
 
-	const auto upper = to_upper(token);
-	if (upper.size() > suffix_plural.size() &&
-	    upper.compare(upper.size() - suffix_plural.size(),
-	                 suffix_plural.size(),
-	                 to_upper(std::string(suffix_plural))) == 0) {
-		case_error = true;
-		expected    = token.substr(0, token.size() - suffix_plural.size()) + "frames";
-	}
-	if (upper.size() > suffix_single.size() &&
-	    upper.compare(upper.size() - suffix_single.size(),
-	                 suffix_single.size(),
-	                 to_upper(std::string(suffix_single))) == 0) {
-		case_error = true;
-		expected    = token.substr(0, token.size() - suffix_single.size()) + "frame";
+	for (const std::string_view suffix : {"FRAME", "FRAMES"}) {
+		if (ends_with_upper(token, suffix)) {
+			case_error = true;
+			expected   = std::string(token.substr(0, token.size() - suffix.size()));
+			expected += (suffix.size() == 6) ? "frames" : "frame";
+		}
 	}
 	return std::nullopt;
 }
@@ -566,7 +794,7 @@ void append_character_actions(const CharacterMapping& mapping,
 	}
 }
 
-void append_string_actions(const std::string& text,
+void append_string_actions(std::string_view text,
 	                     const uint32_t interkey_frames,
 	                     std::vector<TypeAction>& actions)
 {
@@ -585,49 +813,122 @@ void append_string_actions(const std::string& text,
 	}
 }
 
-bool append_key_token(const std::string& token, std::vector<TypeAction>& actions)
+// [scale] [raw|png|qoi], in either order
+std::optional<ImageRequest> parse_image_request(const std::string& argument)
+{
+	ImageRequest request = {};
+	bool have_scale      = false;
+	bool have_format     = false;
+	std::istringstream iss(argument);
+	std::string token;
+	while (iss >> token) {
+		const auto upper = to_upper(token);
+		std::optional<ImageFormat> format = {};
+		if (upper == "RAW") {
+			format = ImageFormat::Raw;
+		} else if (upper == "PNG") {
+			format = ImageFormat::Png;
+		} else if (upper == "QOI") {
+			format = ImageFormat::Qoi;
+		}
+		if (format) {
+			if (have_format) {
+				return std::nullopt;
+			}
+			request.format = *format;
+			have_format    = true;
+			continue;
+		}
+		const auto scale = parse_unsigned_number(token);
+		if (have_scale || !scale || *scale < 1 || *scale > kMaxImageScale) {
+			return std::nullopt;
+		}
+		request.scale = static_cast<uint8_t>(*scale);
+		have_scale    = true;
+	}
+	return request;
+}
+
+// One or more double-quoted strings, concatenated. Besides \" and \\ the
+// escapes \n, \r, and \t stand for Enter and Tab, since a command line
+// cannot hold them literally.
+std::optional<std::string> parse_paste_text(std::string_view argument)
+{
+	std::string text;
+	size_t pos = 0;
+	while (true) {
+		while (pos < argument.size() && argument[pos] == ' ') {
+			++pos;
+		}
+		if (pos == argument.size()) {
+			break;
+		}
+		if (argument[pos] != '"') {
+			return std::nullopt;
+		}
+		bool closed = false;
+		for (++pos; pos < argument.size() && !closed; ++pos) {
+			char ch = argument[pos];
+			if (ch == '"') {
+				closed = true;
+				continue;
+			}
+			if (ch == '\\' && pos + 1 < argument.size()) {
+				ch = argument[++pos];
+				if (ch == 'n' || ch == 'r') {
+					ch = '\r';
+				} else if (ch == 't') {
+					ch = '\t';
+				}
+			}
+			text.push_back(ch);
+		}
+		if (!closed || (pos < argument.size() && argument[pos] != ' ')) {
+			return std::nullopt;
+		}
+	}
+	if (text.empty() || text.size() > kMaxPasteLength) {
+		return std::nullopt;
+	}
+	return text;
+}
+
+bool append_key_token(std::string_view token, std::vector<TypeAction>& actions)
 {
 	if (token.empty()) {
 		return false;
 	}
 
-	const auto canonical_backslash = [](const std::string& name) {
-		return name == "\\" ? std::string("Backslash") : name;
+	const auto canonical_backslash = [](std::string_view name) {
+		return name == "\\" ? std::string_view("Backslash") : name;
 	};
 
 	const auto direct_candidate = canonical_backslash(token);
 	if (textmode::KeyboardCommandProcessor::ParseKeyName(direct_candidate)) {
-		actions.push_back(make_key_action(TypeAction::Kind::Press, direct_candidate));
+		actions.push_back(make_key_action(TypeAction::Kind::Press,
+		                                  std::string(direct_candidate)));
 		return true;
 	}
 
-	const auto ends_with = [](const std::string& value, std::string_view suffix) {
-		return value.size() >= suffix.size() &&
-		       value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
-	};
-
-	std::string base = token;
-	bool request_down = false;
-	bool request_up   = false;
+	auto base              = token;
+	bool request_down      = false;
+	bool request_up        = false;
 	bool suffix_case_error = false;
 
-	if (token.size() > 4 && ends_with(token, "Down")) {
+	if (token.size() > 4 && token.ends_with("Down")) {
 		request_down = true;
-		base.resize(base.size() - 4);
-	} else if (token.size() > 2 && ends_with(token, "Up")) {
+		base.remove_suffix(4);
+	} else if (token.size() > 2 && token.ends_with("Up")) {
 		request_up = true;
-		base.resize(base.size() - 2);
-	} else {
-		const auto upper = to_upper(token);
-		if (upper.size() > 4 && ends_with(upper, "DOWN")) {
-			request_down      = true;
-			suffix_case_error = true;
-			base.resize(base.size() - 4);
-		} else if (upper.size() > 2 && ends_with(upper, "UP")) {
-			request_up        = true;
-			suffix_case_error = true;
-			base.resize(base.size() - 2);
-		}
+		base.remove_suffix(2);
+	} else if (ends_with_upper(token, "DOWN")) {
+		request_down      = true;
+		suffix_case_error = true;
+		base.remove_suffix(4);
+	} else if (ends_with_upper(token, "UP")) {
+		request_up        = true;
+		suffix_case_error = true;
+		base.remove_suffix(2);
 	}
 
 	if (base.empty()) {
@@ -648,7 +949,7 @@ bool append_key_token(const std::string& token, std::vector<TypeAction>& actions
 	}
 
 	if (suffix_case_error) {
-		std::string expected = base;
+		std::string expected(base);
 		if (request_down) {
 			expected += "Down";
 		} else if (request_up) {
@@ -666,7 +967,7 @@ bool append_key_token(const std::string& token, std::vector<TypeAction>& actions
 	const auto kind = request_down ? TypeAction::Kind::Down
 	                              : request_up   ? TypeAction::Kind::Up
 	                                             : TypeAction::Kind::Press;
-	actions.push_back(make_key_action(kind, base));
+	actions.push_back(make_key_action(kind, std::string(base)));
 	return true;
 }
 
@@ -736,8 +1037,38 @@ public:
 	}
 };
 
+// One OpenMetrics counter or gauge. Counter samples carry the _total
+// suffix that the TYPE line leaves off.
+template <typename T>
+void append_metric(std::string& out, const std::string_view name,
+                   const std::string_view type, const std::string_view help,
+                   const T value)
+{
+	const bool is_counter = (type == "counter");
+	out.append("# TYPE ").append(name).append(" ").append(type).append("\n");
+	out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+	out.append(name).append(is_counter ? "_total " : " ");
+	out.append(std::to_string(value)).append("\n");
+}
+
+void append_histogram(std::string& out, const std::string_view name,
+                      const std::string_view help, const LatencyHistogram& histogram)
+{
+	out.append("# TYPE ").append(name).append(" histogram\n");
+	out.append("# HELP ").append(name).append(" ").append(help).append("\n");
+	histogram.AppendOpenMetrics(out, name, {});
+}
+
 } // namespace
 
+std::string TagResponse(const CommandOrigin& origin, const std::string& payload)
+{
+	if (!origin.request_id) {
+		return payload;
+	}
+	return "#" + std::to_string(*origin.request_id) + " " + payload;
+}
+
 CommandProcessor::CommandProcessor(std::function<ServiceResult()> provider,
 	                             std::function<CommandResponse(const std::string&)> keyboard_handler,
 	                             std::function<void()> exit_handler,
@@ -752,6 +1083,9 @@ CommandProcessor::CommandProcessor(std::function<ServiceResult()> provider,
           m_memory_writer(std::move(memory_writer)),
           m_type_sink(std::make_shared<ImmediateTypeActionSink>()),
           m_active_origin(),
+          m_baselines(),
+          m_watchers(),
+          m_memory_watches(),
           m_requests(0),
           m_success(0),
           m_failures(0),
@@ -767,8 +1101,24 @@ CommandProcessor::CommandProcessor(std::function<ServiceResult()> provider,
 
 CommandResponse CommandProcessor::HandleCommand(const std::string& command)
 {
-	const auto origin = m_active_origin.value_or(CommandOrigin{});
-	return HandleCommandInternal(command, origin);
+	ZoneScoped;
+	ZoneText(command.data(), command.size());
+
+	const auto origin  = m_active_origin.value_or(CommandOrigin{});
+	const auto started = std::chrono::steady_clock::now();
+	auto response      = HandleCommandInternal(command, origin);
+
+	// Only known verbs get a histogram, so typos cannot grow the map
+	const auto trimmed = trim_view(command);
+	const auto verb    = trimmed.substr(0, trimmed.find(' '));
+	if (command_case_lookup().contains(verb)) {
+		auto it = m_verb_latency.find(verb);
+		if (it == m_verb_latency.end()) {
+			it = m_verb_latency.emplace(std::string(verb), LatencyHistogram{}).first;
+		}
+		it->second.Record(std::chrono::steady_clock::now() - started);
+	}
+	return response;
 }
 
 CommandResponse CommandProcessor::HandleCommand(const std::string& command,
@@ -817,6 +1167,134 @@ CommandResponse CommandProcessor::HandlePeekCommand(const std::string& argument)
 	return {true, format_memory_payload(*offset_opt, result.bytes)};
 }
 
+CommandResponse CommandProcessor::HandlePeekVectorCommand(const std::string& argument)
+{
+	++m_requests;
+	const auto fail = [this](const char* message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	std::istringstream iss(argument);
+	std::string regions_token;
+	std::string format_token;
+	std::string extra;
+	if (!(iss >> regions_token) || (iss >> format_token && format_token != "BIN") ||
+	    (iss >> extra)) {
+		return fail("ERR invalid PEEKV arguments\n");
+	}
+	const bool binary = (format_token == "BIN");
+
+	const auto regions = parse_memory_regions(regions_token);
+	if (!regions) {
+		return fail("ERR invalid PEEKV arguments\n");
+	}
+	uint32_t total_length = 0;
+	for (const auto& region : *regions) {
+		total_length += region.second;
+	}
+
+	if (!m_memory_reader) {
+		return fail("ERR memory access unavailable\n");
+	}
+
+	std::string payload;
+	if (binary) {
+		payload = "PEEKV bytes=" + std::to_string(total_length) + "\n";
+		payload.reserve(payload.size() + total_length);
+	}
+	for (const auto& [offset, length] : *regions) {
+		const auto result = m_memory_reader(offset, length);
+		if (!result.success) {
+			++m_failures;
+			const auto message = result.error.empty() ? "memory read failed"
+			                                          : result.error;
+			return {false, "ERR " + message + "\n"};
+		}
+		if (binary) {
+			payload.append(result.bytes.begin(), result.bytes.end());
+		} else {
+			payload.append(format_memory_payload(offset, result.bytes));
+		}
+	}
+
+	++m_success;
+	return {true, payload};
+}
+
+CommandResponse CommandProcessor::HandleMetricsCommand(const std::string& argument)
+{
+	if (!argument.empty()) {
+		return {false, "ERR invalid METRICS arguments\n"};
+	}
+
+	const auto rejected = m_rejected_clients_provider ? m_rejected_clients_provider()
+	                                                  : 0;
+	const auto queue = m_queue_telemetry_provider ? m_queue_telemetry_provider()
+	                                              : QueueTelemetry{};
+	const auto transport = m_transport_telemetry_provider
+	                             ? m_transport_telemetry_provider()
+	                             : TransportTelemetry{};
+
+	std::string out = {};
+	out.reserve(16 * 1024);
+
+	if (m_emulator_telemetry_provider) {
+		const auto emulator = m_emulator_telemetry_provider();
+		append_metric(out, "dosbox_emulated_milliseconds", "counter",
+		              "Emulated time since startup.", emulator.emulated_ms);
+		append_metric(out, "dosbox_cpu_cycles_per_millisecond", "gauge",
+		              "Cycles the CPU currently runs per emulated millisecond.",
+		              emulator.cycles_per_ms);
+		append_metric(out, "dosbox_ticks_scheduled", "gauge",
+		              "Milliseconds scheduled since the tick base was last reset.",
+		              emulator.ticks_scheduled);
+		append_metric(out, "dosbox_ticks_done", "gauge",
+		              "Milliseconds emulated since the tick base was last reset.",
+		              emulator.ticks_done);
+		for (const auto& counter : emulator.counters) {
+			const bool is_gauge = (counter.kind == PerfKind::Gauge);
+			append_metric(out, "dosbox_" + counter.name,
+			              is_gauge ? "gauge" : "counter",
+			              counter.help, counter.value);
+		}
+	}
+
+	append_metric(out, "textmode_requests", "counter",
+	              "Commands handled.", m_requests);
+	append_metric(out, "textmode_request_failures", "counter",
+	              "Commands that failed.", m_failures);
+	append_metric(out, "textmode_sessions", "gauge",
+	              "Clients connected.", transport.sessions);
+	append_metric(out, "textmode_rejected_clients", "counter",
+	              "Connections refused by max_clients.", rejected);
+	append_metric(out, "textmode_evicted_clients", "counter",
+	              "Clients dropped for staying over the send budget.",
+	              transport.evicted_clients);
+	append_metric(out, "textmode_bytes_sent", "counter",
+	              "Reply bytes handed to the network backend.", transport.bytes_sent);
+	append_metric(out, "textmode_type_queue_pending", "gauge",
+	              "Queued TYPE actions.", queue.pending);
+
+	out.append("# TYPE textmode_command_duration_seconds histogram\n"
+	           "# HELP textmode_command_duration_seconds Time spent handling each verb.\n");
+	for (const auto& [verb, histogram] : m_verb_latency) {
+		histogram.AppendOpenMetrics(out,
+		                            "textmode_command_duration_seconds",
+		                            "verb=\"" + verb + "\"");
+	}
+	append_histogram(out, "textmode_queue_wait_seconds",
+	                 "Queued TYPE requests from enqueue to reply.", queue.wait);
+	append_histogram(out, "textmode_capture_seconds",
+	                 "Frame captures.", m_capture_latency);
+	append_histogram(out, "textmode_encode_seconds",
+	                 "Frame encoding.", m_encode_latency);
+	append_histogram(out, "textmode_send_seconds",
+	                 "Handing replies to the network backend.", transport.send);
+	out.append("# EOF\n");
+	return {true, std::move(out)};
+}
+
 CommandResponse CommandProcessor::HandleDebugCommand()
 {
 	if (!m_debug_enabled || m_debug_length == 0) {
@@ -885,20 +1363,92 @@ CommandResponse CommandProcessor::HandlePokeCommand(const std::string& argument)
 	return {true, "OK\n"};
 }
 
+ServiceResult CommandProcessor::ProvideFrame(const uintptr_t client, const bool diff)
+{
+	if (!m_provider) {
+		return ServiceResult{false, {}, "service unavailable"};
+	}
+
+	return EncodeForClient(client, diff, Capture());
+}
+
+ServiceResult CommandProcessor::ProvideRegionFrame(const TextRegion& region)
+{
+	if (m_region_provider) {
+		ScopedLatency timer(m_capture_latency);
+		return m_region_provider(region);
+	}
+
+	auto result = Capture();
+	if (!result.success) {
+		return result;
+	}
+	if (!result.snapshot) {
+		return ServiceResult{false, {}, "region frames unavailable"};
+	}
+	ScopedLatency timer(m_encode_latency);
+	return BuildRegionResult(*result.snapshot, std::move(result.encoding), region);
+}
+
+ServiceResult CommandProcessor::Capture()
+{
+	ScopedLatency timer(m_capture_latency);
+	return m_provider();
+}
+
+ServiceResult CommandProcessor::EncodeForClient(const uintptr_t client,
+                                                const bool diff,
+                                                ServiceResult result)
+{
+	if (!result.success || !result.snapshot) {
+		// Providers without a raw capture can only serve full frames
+		return result;
+	}
+
+	auto& baseline = m_baselines[client];
+	if (diff) {
+		ScopedLatency timer(m_encode_latency);
+		const bool have_baseline = !baseline.snapshot.cells.empty();
+		result.frame = BuildAnsiDiff(have_baseline ? &baseline : nullptr,
+		                             *result.snapshot,
+		                             result.encoding);
+	}
+	baseline.snapshot  = *result.snapshot;
+	baseline.keys_down = result.encoding.keys_down;
+	return result;
+}
+
 CommandResponse CommandProcessor::HandleCommandInternal(const std::string& raw_command,
 	                                                     const CommandOrigin& origin)
 {
-	const auto trimmed = trim(raw_command);
+	const auto trimmed = trim_view(raw_command);
+
+	// Between BATCH and END lines are only collected; END runs them
+	if (const auto batch = m_batches.find(origin.client);
+	    batch != m_batches.end() && trimmed != "END") {
+		if (trimmed.empty()) {
+			// Nothing to run
+		} else if (batch->second.lines.size() < kMaxBatchLength) {
+			batch->second.lines.emplace_back(trimmed);
+		} else {
+			batch->second.is_overflowed = true;
+		}
+		CommandResponse response{true, ""};
+		response.deferred = true;
+		return response;
+	}
+
 	if (trimmed.empty()) {
 		return {false, "ERR empty command\n"};
 	}
 
-	const auto space_pos = trimmed.find(' ');
+	// Verbs fit the small-string buffer, so only a long argument allocates
+	const auto space_pos  = trimmed.find(' ');
 	const auto verb       = trimmed.substr(0, space_pos);
 	const auto verb_upper = to_upper(verb);
-	const auto argument   = (space_pos == std::string::npos)
-	                               ? std::string()
-	                               : trim(trimmed.substr(space_pos + 1));
+	const auto argument   = (space_pos == std::string_view::npos)
+	                                ? std::string()
+	                                : std::string(trim_view(trimmed.substr(space_pos + 1)));
 
 	if (const auto suggestion = suggest_command(verb); suggestion) {
 		log_command_case_warning(verb, *suggestion);
@@ -906,25 +1456,79 @@ CommandResponse CommandProcessor::HandleCommandInternal(const std::string& raw_c
 	}
 
 	if (verb_upper == "STATS") {
-		std::ostringstream oss;
-		oss << "requests=" << m_requests << ' '
-		    << "success=" << m_success << ' '
-		    << "failures=" << m_failures << ' ';
-		std::string joined;
+		if (!argument.empty() && argument != "JSON") {
+			return {false, "ERR invalid STATS arguments\n"};
+		}
+
+		std::vector<std::string> keys;
 		if (m_keys_down_provider) {
-			auto keys = m_keys_down_provider();
+			keys = m_keys_down_provider();
 			std::sort(keys.begin(), keys.end());
+		}
+		const auto rejected = m_rejected_clients_provider ? m_rejected_clients_provider()
+		                                                  : 0;
+		const auto queue = m_queue_telemetry_provider ? m_queue_telemetry_provider()
+		                                              : QueueTelemetry{};
+		const auto transport = m_transport_telemetry_provider
+		                             ? m_transport_telemetry_provider()
+		                             : TransportTelemetry{};
+
+		std::ostringstream oss;
+		if (argument == "JSON") {
+			oss << "{\"requests\":" << m_requests << ",\"success\":" << m_success
+			    << ",\"failures\":" << m_failures << ",\"rejected\":" << rejected
+			    << ",\"pending\":" << queue.pending
+			    << ",\"peak_pending\":" << queue.peak_pending
+			    << ",\"bytes_sent\":" << transport.bytes_sent
+			    << ",\"evicted\":" << transport.evicted_clients << ",\"keys_down\":[";
 			for (size_t i = 0; i < keys.size(); ++i) {
-				if (i > 0) {
-					joined.push_back(',');
+				oss << (i > 0 ? "," : "") << '"' << keys[i] << '"';
+			}
+			oss << "],\"counters\":{";
+			if (m_emulator_telemetry_provider) {
+				const auto emulator = m_emulator_telemetry_provider();
+				for (size_t i = 0; i < emulator.counters.size(); ++i) {
+					const auto& counter = emulator.counters[i];
+					oss << (i > 0 ? "," : "") << '"' << counter.name
+					    << "\":" << counter.value;
 				}
-				joined.append(keys[i]);
 			}
+			oss << "},\"latency\":{\"verbs\":{";
+			bool first = true;
+			for (const auto& [name, histogram] : m_verb_latency) {
+				oss << (first ? "" : ",") << '"' << name << "\":" << histogram.ToJson();
+				first = false;
+			}
+			oss << "},\"queue_wait\":" << queue.wait.ToJson()
+			    << ",\"capture\":" << m_capture_latency.ToJson()
+			    << ",\"encode\":" << m_encode_latency.ToJson()
+			    << ",\"send\":" << transport.send.ToJson() << "}}\n";
+			return {true, oss.str()};
+		}
+
+		std::string joined;
+		for (size_t i = 0; i < keys.size(); ++i) {
+			if (i > 0) {
+				joined.push_back(',');
+			}
+			joined.append(keys[i]);
 		}
-		oss << "keys_down=" << joined << "\n";
+		oss << "requests=" << m_requests << ' '
+		    << "success=" << m_success << ' '
+		    << "failures=" << m_failures << ' '
+		    << "rejected=" << rejected << ' '
+		    << "pending=" << queue.pending << ' '
+		    << "peak_pending=" << queue.peak_pending << ' '
+		    << "bytes_sent=" << transport.bytes_sent << ' '
+		    << "evicted=" << transport.evicted_clients << ' '
+		    << "keys_down=" << joined << "\n";
 		return {true, oss.str()};
 	}
 
+	if (verb_upper == "METRICS") {
+		return HandleMetricsCommand(argument);
+	}
+
 	if (verb_upper == "EXIT") {
 		++m_requests;
 		if (m_exit_handler) {
@@ -939,6 +1543,10 @@ CommandResponse CommandProcessor::HandleCommandInternal(const std::string& raw_c
 		return HandlePeekCommand(argument);
 	}
 
+	if (verb_upper == "PEEKV") {
+		return HandlePeekVectorCommand(argument);
+	}
+
 	if (verb_upper == "DEBUG") {
 		return HandleDebugCommand();
 	}
@@ -947,235 +1555,1612 @@ CommandResponse CommandProcessor::HandleCommandInternal(const std::string& raw_c
 		return HandlePokeCommand(argument);
 	}
 
-	if (verb_upper == "GET" || verb_upper == "VIEW") {
+	if (verb_upper == "GET" || verb_upper == "VIEW" || verb_upper == "DIFF") {
 		if (!m_provider) {
 			return {false, "ERR service unavailable\n"};
 		}
 
 		++m_requests;
-		bool showspc = false;
+		const bool diff = (verb_upper == "DIFF");
+		bool showspc    = false;
+		bool binary     = false;
+		bool rle        = false;
+		bool gfxtext    = false;
+		std::optional<uint64_t> if_changed = std::nullopt;
+		std::optional<TextRegion> region   = std::nullopt;
 		if (!argument.empty()) {
-			if (argument == "SHOWSPC") {
+			if (verb_upper == "GET" && argument.rfind("IFCHANGED", 0) == 0) {
+				if_changed = parse_generation(argument.substr(9));
+				if (!if_changed) {
+					++m_failures;
+					return {false, "ERR invalid IFCHANGED generation\n"};
+				}
+			} else if (argument == "SHOWSPC") {
 				showspc = true;
 			} else if (to_upper(argument) == "SHOWSPC") {
 				log_case_warning(argument, "SHOWSPC");
 				showspc = true;
+			} else if (!diff && (argument == "BIN" || argument == "RLE")) {
+				binary = true;
+				rle    = (argument == "RLE");
+			} else if (verb_upper == "GET" && argument == "GFXTEXT") {
+				gfxtext = true;
+			} else if (!diff && argument.find(',') != std::string::npos) {
+				region = parse_text_region(argument);
+				if (!region) {
+					++m_failures;
+					return {false, "ERR invalid GET region\n"};
+				}
 			}
 		}
-		const auto result  = m_provider();
-		if (!result.success) {
-			++m_failures;
-			return {false, "ERR " + result.error + "\n"};
+		if (if_changed && m_generation_provider) {
+			const auto current = m_generation_provider();
+			if (current != 0 && current == *if_changed) {
+				++m_success;
+				return {true, "UNCHANGED generation=" + std::to_string(current) + "\n"};
+			}
 		}
 
-		++m_success;
-		return {true, showspc ? show_spaces(result.frame) : result.frame};
+		if (gfxtext) {
+			if (!m_graphics_text_provider) {
+				++m_failures;
+				return {false, "ERR graphics text unavailable\n"};
+			}
+			ScopedLatency timer(m_capture_latency);
+			auto result = m_graphics_text_provider();
+			timer.Stop();
+			if (!result.success) {
+				++m_failures;
+				return {false, "ERR " + result.error + "\n"};
+			}
+			++m_success;
+			return {true, std::move(result.frame)};
+		}
+
+		if (region) {
+			auto result = ProvideRegionFrame(*region);
+			if (!result.success) {
+				++m_failures;
+				return {false, "ERR " + result.error + "\n"};
+			}
+			++m_success;
+			return {true, std::move(result.frame)};
+		}
+
+		auto result = ProvideFrame(origin.client, diff);
+		if (!result.success) {
+			++m_failures;
+			return {false, "ERR " + result.error + "\n"};
+		}
+
+		if (if_changed && result.snapshot) {
+			result.encoding.generation = result.generation;
+			result.frame = BuildAnsiFrame(*result.snapshot, result.encoding);
+		}
+
+		if (binary) {
+			if (!result.snapshot) {
+				++m_failures;
+				return {false, "ERR binary frames unavailable\n"};
+			}
+			ScopedLatency timer(m_encode_latency);
+			auto frame = BuildBinaryFrame(*result.snapshot, result.encoding, rle);
+			timer.Stop();
+			++m_success;
+			return {true, std::move(frame)};
+		}
+
+		++m_success;
+		return {true, showspc ? show_spaces(result.frame) : result.frame};
+	}
+
+	if (verb_upper == "TYPE") {
+		return HandleTypeCommand(argument, origin);
+	}
+
+	if (verb_upper == "MACRO") {
+		return HandleMacroCommand(argument, origin);
+	}
+
+	if (verb_upper == "BATCH" || verb_upper == "END") {
+		return HandleBatchCommand(verb_upper, argument, origin);
+	}
+
+	if (verb_upper == "WATCH") {
+		return HandleWatchCommand(argument, origin);
+	}
+
+	if (verb_upper == "WAITFOR") {
+		return HandleWaitForCommand(argument, origin);
+	}
+
+	if (verb_upper == "UNWATCH") {
+		++m_requests;
+		m_watchers.erase(origin.client);
+		++m_success;
+		return {true, "OK\n"};
+	}
+
+	if (verb_upper == "WATCHMEM") {
+		return HandleWatchMemoryCommand(argument, origin);
+	}
+
+	if (verb_upper == "UNWATCHMEM") {
+		++m_requests;
+		m_memory_watches.erase(origin.client);
+		++m_success;
+		return {true, "OK\n"};
+	}
+
+	if (verb_upper == "EVENTS") {
+		return HandleEventsCommand(argument, origin);
+	}
+
+	if (verb_upper == "SAVESTATE" || verb_upper == "LOADSTATE") {
+		return HandleSaveStateCommand(verb_upper, argument);
+	}
+
+	if (verb_upper == "CHECKPOINT" || verb_upper == "REWIND") {
+		return HandleCheckpointCommand(verb_upper, argument);
+	}
+
+	if (verb_upper == "CLONE") {
+		return HandleCloneCommand(argument);
+	}
+
+	if (verb_upper == "STEP") {
+		return HandleStepCommand(argument, origin);
+	}
+
+	if (verb_upper == "PASTE") {
+		return HandlePasteCommand(argument, origin);
+	}
+
+	if (verb_upper == "TURBO") {
+		return HandleTurboCommand(argument, origin);
+	}
+
+	if (verb_upper == "GETIMG") {
+		return HandleGetImageCommand(argument, origin);
+	}
+
+	if (verb_upper == "PROFILE") {
+		return HandleProfileCommand(argument);
+	}
+
+	if (verb_upper == "MEMORY") {
+		return HandleMemoryCommand(argument);
+	}
+
+	if (verb_upper == "POOL") {
+		return HandlePoolCommand(argument);
+	}
+
+	if (verb_upper == "SET") {
+		return HandleSetCommand(argument);
+	}
+
+	return {false, "ERR unknown command\n"};
+}
+
+CommandResponse CommandProcessor::HandleSaveStateCommand(const std::string& verb,
+                                                         const std::string& argument)
+{
+	++m_requests;
+	const bool save     = (verb == "SAVESTATE");
+	const auto& handler = save ? m_save_state_handler : m_load_state_handler;
+	if (!handler) {
+		++m_failures;
+		return {false, "ERR save-states unavailable\n"};
+	}
+	if (argument.empty() || argument.find(' ') != std::string::npos) {
+		++m_failures;
+		return {false, "ERR invalid " + verb + " arguments\n"};
+	}
+
+	const auto result = handler(argument);
+	if (!result.success) {
+		++m_failures;
+		return {false, "ERR " + result.error + "\n"};
+	}
+	if (!save) {
+		// The restored screen has nothing in common with any client's
+		// baseline, so the next DIFF starts over with a full frame
+		m_baselines.clear();
+	}
+	++m_success;
+	std::string reply = "OK " + verb + " " + argument;
+	if (save) {
+		reply += " bytes=" + std::to_string(result.bytes);
+	}
+	return {true, reply + "\n"};
+}
+
+CommandResponse CommandProcessor::HandleCheckpointCommand(const std::string& verb,
+                                                          const std::string& argument)
+{
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	const bool take = (verb == "CHECKPOINT");
+	if (take ? !m_checkpoint_handler : !m_rewind_handler) {
+		return fail("ERR checkpoints unavailable\n");
+	}
+
+	uint32_t id         = 0;
+	const auto id_end   = argument.data() + argument.size();
+	const auto id_read  = std::from_chars(argument.data(), id_end, id);
+	const auto is_valid = take ? argument.empty()
+	                           : (id_read.ec == std::errc() && id_read.ptr == id_end &&
+	                              !argument.empty());
+	if (!is_valid) {
+		return fail("ERR invalid " + verb + " arguments\n");
+	}
+
+	const auto result = take ? m_checkpoint_handler() : m_rewind_handler(id);
+	if (!result.success) {
+		return fail("ERR " + result.error + "\n");
+	}
+	++m_success;
+	if (!take) {
+		// As after LOADSTATE, no client's baseline matches the screen
+		m_baselines.clear();
+		return {true, "OK REWIND " + std::to_string(id) + "\n"};
+	}
+	return {true,
+	        "OK CHECKPOINT id=" + std::to_string(result.id) +
+	                " pages=" + std::to_string(result.pages) +
+	                " bytes=" + std::to_string(result.bytes) + "\n"};
+}
+
+CommandResponse CommandProcessor::HandleWaitForCommand(const std::string& argument,
+                                                       const CommandOrigin& origin)
+{
+	++m_requests;
+	const auto fail = [this](const char* message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	if (!m_provider) {
+		return fail("ERR service unavailable\n");
+	}
+
+	WaitPlan plan{};
+	const auto error = parse_screen_condition(argument, "WAITFOR", kDefaultWaitForTimeoutMs, plan);
+	if (!error.empty()) {
+		return fail(error.c_str());
+	}
+
+	// Matching frames are not DIFF baselines, so use the raw provider
+	const auto result = Capture();
+	if (result.success && result.snapshot && plan.matches(*result.snapshot)) {
+		++m_success;
+		return {true, result.frame};
+	}
+	if (origin.client == 0) {
+		return fail("ERR WAITFOR requires a connection\n");
+	}
+	if (!m_type_sink) {
+		return fail("ERR WAITFOR unavailable\n");
+	}
+
+	plan.generation = m_generation_provider;
+	return m_type_sink->ExecuteWait(plan, origin, m_provider, [this](const bool success) {
+		if (success) {
+			++m_success;
+		} else {
+			++m_failures;
+		}
+	});
+}
+
+CommandResponse CommandProcessor::HandleWatchCommand(const std::string& argument,
+                                                     const CommandOrigin& origin)
+{
+	++m_requests;
+	if (origin.client == 0) {
+		++m_failures;
+		return {false, "ERR WATCH requires a connection\n"};
+	}
+	if (!m_provider) {
+		++m_failures;
+		return {false, "ERR service unavailable\n"};
+	}
+
+	Watcher watcher{};
+	std::istringstream iss(argument);
+	std::string token;
+	bool have_interval = false;
+	while (iss >> token) {
+		if (token == "DIFF" && !watcher.diff) {
+			watcher.diff = true;
+			continue;
+		}
+		const auto interval = have_interval ? std::nullopt
+		                                    : parse_unsigned_number(token);
+		if (!interval || *interval > kMaxWatchIntervalMs) {
+			++m_failures;
+			return {false, "ERR invalid WATCH arguments\n"};
+		}
+		watcher.min_interval = std::chrono::milliseconds(*interval);
+		have_interval        = true;
+	}
+
+	m_watchers[origin.client] = watcher;
+	++m_success;
+	return {true, "OK\n"};
+}
+
+CommandResponse CommandProcessor::HandleWatchMemoryCommand(const std::string& argument,
+                                                           const CommandOrigin& origin)
+{
+	++m_requests;
+	const auto fail = [this](const char* message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	if (origin.client == 0) {
+		return fail("ERR WATCHMEM requires a connection\n");
+	}
+	std::istringstream iss(argument);
+	std::string regions_token;
+	std::string extra;
+	if (!(iss >> regions_token) || (iss >> extra)) {
+		return fail("ERR invalid WATCHMEM arguments\n");
+	}
+	const auto regions = parse_memory_regions(regions_token);
+	if (!regions) {
+		return fail("ERR invalid WATCHMEM arguments\n");
+	}
+	if (!m_memory_reader) {
+		return fail("ERR memory access unavailable\n");
+	}
+
+	// The first sample is the baseline; only later writes produce events
+	MemoryWatch watch{};
+	for (const auto& [offset, length] : *regions) {
+		auto result = m_memory_reader(offset, length);
+		if (!result.success) {
+			++m_failures;
+			const auto message = result.error.empty() ? "memory read failed"
+			                                          : result.error;
+			return {false, "ERR " + message + "\n"};
+		}
+		watch.ranges.push_back({offset, std::move(result.bytes)});
+	}
+
+	m_memory_watches[origin.client] = std::move(watch);
+	++m_success;
+	return {true, "OK\n"};
+}
+
+CommandResponse CommandProcessor::HandleEventsCommand(const std::string& argument,
+                                                      const CommandOrigin& origin)
+{
+	++m_requests;
+	const auto fail = [this](const char* message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	if (origin.client == 0) {
+		return fail("ERR EVENTS requires a connection\n");
+	}
+	std::istringstream iss(argument);
+	std::string types_token;
+	std::string extra;
+	iss >> types_token;
+	if (iss >> extra) {
+		return fail("ERR invalid EVENTS arguments\n");
+	}
+	if (types_token == "OFF") {
+		m_event_subscriptions.erase(origin.client);
+		++m_success;
+		return {true, "OK\n"};
+	}
+
+	EventSubscription subscription{};
+	std::string_view remaining = types_token;
+	while (!remaining.empty()) {
+		const auto comma = remaining.find(',');
+		const auto type  = remaining.substr(0, comma);
+		remaining = (comma == std::string_view::npos) ? std::string_view{}
+		                                              : remaining.substr(comma + 1);
+		if (std::find(kEventTypes.begin(), kEventTypes.end(), type) ==
+		    kEventTypes.end()) {
+			return fail("ERR invalid EVENTS arguments\n");
+		}
+		subscription.types.emplace_back(type);
+	}
+	if (!types_token.empty() && types_token.back() == ',') {
+		return fail("ERR invalid EVENTS arguments\n");
+	}
+
+	m_event_subscriptions[origin.client] = std::move(subscription);
+	++m_success;
+	return {true, "OK\n"};
+}
+
+bool CommandProcessor::HasEventSubscribers() const
+{
+	return !m_event_subscriptions.empty();
+}
+
+void CommandProcessor::PostEvent(const uint64_t tick, const std::string_view type,
+                                 const std::string_view fields)
+{
+	std::string record = {};
+	for (auto& [client, subscription] : m_event_subscriptions) {
+		const auto& types   = subscription.types;
+		const bool is_wanted = types.empty() ||
+		                       std::find(types.begin(), types.end(), type) !=
+		                               types.end();
+		if (!is_wanted) {
+			continue;
+		}
+		if (subscription.num_pending >= kMaxPendingEvents) {
+			++subscription.num_dropped;
+			subscription.dropped_tick = tick;
+			continue;
+		}
+		if (record.empty()) {
+			record = format_event(tick, type, fields);
+		}
+		subscription.pending += record;
+		++subscription.num_pending;
+	}
+}
+
+void CommandProcessor::SampleMemoryWatches(const uint64_t tick)
+{
+	if (m_memory_watches.empty() || !m_memory_reader) {
+		return;
+	}
+
+	for (auto& [client, watch] : m_memory_watches) {
+		for (auto& range : watch.ranges) {
+			const auto size   = static_cast<uint32_t>(range.last.size());
+			const auto result = m_memory_reader(range.offset, size);
+			if (!result.success || result.bytes == range.last) {
+				continue;
+			}
+
+			// One event per run of consecutive changed bytes
+			for (uint32_t i = 0; i < size;) {
+				if (result.bytes[i] == range.last[i]) {
+					++i;
+					continue;
+				}
+				auto end = i + 1;
+				while (end < size && result.bytes[end] != range.last[end]) {
+					++end;
+				}
+				watch.pending.append(format_memory_change(
+				        tick,
+				        range.offset + i,
+				        {range.last.begin() + i, range.last.begin() + end},
+				        {result.bytes.begin() + i, result.bytes.begin() + end}));
+				i = end;
+			}
+			range.last = result.bytes;
+		}
+	}
+}
+
+std::vector<PushedFrame> CommandProcessor::CollectPushedFrames()
+{
+	PollTurbo();
+	auto pushes = std::exchange(m_deferred_replies, {});
+	if (!m_pending_steps.empty() && m_step_clock) {
+		const auto now = m_step_clock();
+		std::erase_if(m_pending_steps, [&](const PendingStep& step) {
+			if (step.until > now) {
+				return false;
+			}
+			const auto reply = "OK STEP ticks=" + std::to_string(step.ticks) + "\n";
+			pushes.push_back({step.origin.client, TagResponse(step.origin, reply)});
+			return true;
+		});
+	}
+	for (auto& [client, watch] : m_memory_watches) {
+		if (!watch.pending.empty()) {
+			pushes.push_back({client, std::exchange(watch.pending, {})});
+		}
+	}
+	for (auto& [client, subscription] : m_event_subscriptions) {
+		if (subscription.num_dropped > 0) {
+			const auto dropped = subscription.num_dropped;
+			subscription.pending += format_event(subscription.dropped_tick,
+			                                     "dropped",
+			                                     "count=" + std::to_string(dropped));
+			subscription.num_dropped = 0;
+		}
+		if (!subscription.pending.empty()) {
+			auto records = std::exchange(subscription.pending, {});
+			pushes.push_back({client, std::move(records)});
+			subscription.num_pending = 0;
+		}
+	}
+
+	if (m_watchers.empty() || !m_provider) {
+		return pushes;
+	}
+
+	const auto now = std::chrono::steady_clock::now();
+	const auto is_due = [&](const uintptr_t client, const Watcher& watcher) {
+		return watcher.next_push <= now && !m_congested_clients.contains(client);
+	};
+	const bool any_due = std::any_of(m_watchers.begin(),
+	                                 m_watchers.end(),
+	                                 [&](const auto& entry) {
+		                                 return is_due(entry.first, entry.second);
+	                                 });
+	if (!any_due) {
+		return pushes;
+	}
+
+	// One capture is shared by every subscriber that is due this poll
+	const auto capture = Capture();
+	if (!capture.success || !capture.snapshot) {
+		return pushes;
+	}
+
+	// A congested client stays due, so once it catches up it gets one
+	// frame against the baseline it last received; the screens in between
+	// are never encoded for it
+	for (auto& [client, watcher] : m_watchers) {
+		if (!is_due(client, watcher)) {
+			continue;
+		}
+		const auto baseline = m_baselines.find(client);
+		const bool changed  = watcher.force_push ||
+		                     baseline == m_baselines.end() ||
+		                     baseline->second.snapshot != *capture.snapshot ||
+		                     baseline->second.keys_down != capture.encoding.keys_down;
+		if (!changed) {
+			continue;
+		}
+
+		auto result = EncodeForClient(client, watcher.diff, capture);
+		pushes.push_back({client, std::move(result.frame)});
+		watcher.force_push = false;
+		watcher.next_push  = now + watcher.min_interval;
+	}
+	return pushes;
+}
+
+CommandResponse CommandProcessor::HandleTypeCommand(const std::string& argument,
+	                                              const CommandOrigin& origin)
+{
+	++m_requests;
+	if (!m_keyboard_handler) {
+		++m_failures;
+		return {false, "ERR keyboard unavailable\n"};
+	}
+
+	auto plan = ParseTypePlan(argument);
+	FinishTypePlan(plan);
+	return RunTypePlan(plan, origin);
+}
+
+CommandResponse CommandProcessor::HandleBatchCommand(const std::string& verb,
+                                                     const std::string& argument,
+                                                     const CommandOrigin& origin)
+{
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	if (!argument.empty()) {
+		return fail("ERR invalid " + verb + " arguments\n");
+	}
+	if (m_in_batch) {
+		return fail("ERR BATCH cannot nest\n");
+	}
+	if (verb == "BATCH") {
+		if (origin.client == 0) {
+			return fail("ERR BATCH requires a connection\n");
+		}
+		// The reply comes with END
+		m_batches[origin.client] = {};
+		++m_success;
+		CommandResponse response{true, ""};
+		response.deferred = true;
+		return response;
+	}
+
+	const auto it = m_batches.find(origin.client);
+	if (it == m_batches.end()) {
+		return fail("ERR END without BATCH\n");
+	}
+	const auto batch = std::move(it->second);
+	m_batches.erase(it);
+	if (batch.is_overflowed) {
+		return fail("ERR BATCH too long\n");
+	}
+
+	// All in this one call on the emulation thread, so the machine stands
+	// still from the first command to the last
+	m_in_batch = true;
+	std::string replies = {};
+	size_t num_failed   = 0;
+	for (const auto& line : batch.lines) {
+		const auto line_verb = std::string_view(line).substr(0, line.find(' '));
+
+		CommandResponse response = {};
+		if (is_waiting_verb(line_verb)) {
+			++m_requests;
+			++m_failures;
+			response = {false,
+			            "ERR " + std::string(line_verb) +
+			                    " cannot wait in a BATCH\n"};
+		} else {
+			response = HandleCommand(line, origin);
+		}
+		if (!response.ok) {
+			++num_failed;
+		}
+		replies += response.payload;
+	}
+	m_in_batch = false;
+
+	std::string reply = "BATCH commands=" + std::to_string(batch.lines.size()) +
+	                    " failed=" + std::to_string(num_failed) + "\n";
+	reply += replies;
+	reply += "END\n";
+	if (num_failed == 0) {
+		++m_success;
+	} else {
+		++m_failures;
+	}
+	return {num_failed == 0, std::move(reply)};
+}
+
+CommandResponse CommandProcessor::HandleMacroCommand(const std::string& argument,
+                                                     const CommandOrigin& origin)
+{
+	++m_requests;
+	const auto fail = [this](const char* message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	std::string_view remaining = argument;
+	const auto next_word = [&remaining] {
+		const auto space = remaining.find(' ');
+		const auto word  = remaining.substr(0, space);
+		remaining = (space == std::string_view::npos)
+		                  ? std::string_view{}
+		                  : trim_view(remaining.substr(space + 1));
+		return word;
+	};
+	const auto action = next_word();
+	const auto name   = std::string(next_word());
+	if (!is_valid_macro_name(name)) {
+		return fail("ERR invalid MACRO arguments\n");
+	}
+
+	if (action == "DEFINE") {
+		if (remaining.empty()) {
+			return fail("ERR invalid MACRO arguments\n");
+		}
+		if (!m_macros.contains(name) && m_macros.size() >= kMaxMacros) {
+			return fail("ERR too many macros\n");
+		}
+		Macro macro    = {};
+		macro.parsed   = ParseTypePlan(remaining);
+		macro.finished = macro.parsed;
+		FinishTypePlan(macro.finished);
+
+		const auto num_actions = std::to_string(macro.finished.actions.size());
+		m_macros.insert_or_assign(name, std::move(macro));
+		++m_success;
+		return {true, "OK MACRO " + name + " actions=" + num_actions + "\n"};
+	}
+
+	if (action == "DELETE") {
+		if (!remaining.empty()) {
+			return fail("ERR invalid MACRO arguments\n");
+		}
+		if (m_macros.erase(name) == 0) {
+			return fail("ERR unknown macro\n");
+		}
+		++m_success;
+		return {true, "OK\n"};
+	}
+
+	if (action != "RUN") {
+		return fail("ERR invalid MACRO arguments\n");
+	}
+	const auto it = m_macros.find(name);
+	if (it == m_macros.end()) {
+		return fail("ERR unknown macro\n");
+	}
+	if (!m_keyboard_handler) {
+		return fail("ERR keyboard unavailable\n");
+	}
+	if (remaining.empty()) {
+		return RunTypePlan(it->second.finished, origin);
+	}
+
+	// Arguments are TYPE tokens run after the body, in the same plan, so
+	// nothing else is typed in between
+	auto plan        = it->second.parsed;
+	const auto extra = ParseTypePlan(remaining);
+	plan.actions.insert(plan.actions.end(),
+	                    extra.actions.begin(),
+	                    extra.actions.end());
+	plan.request_frame = plan.request_frame || extra.request_frame;
+	plan.request_diff  = plan.request_diff || extra.request_diff;
+	if (extra.region) {
+		plan.region = extra.region;
+	}
+	FinishTypePlan(plan);
+	return RunTypePlan(plan, origin);
+}
+
+TypeCommandPlan CommandProcessor::ParseTypePlan(const std::string_view argument)
+{
+	TypeCommandPlan plan;
+	tokenize_type_arguments(argument, m_type_scratch, m_type_tokens);
+trace_log("type command argument='%.*s' tokens=%zu\n",
+          static_cast<int>(argument.size()), argument.data(), m_type_tokens.size());
+
+	for (const auto& token : m_type_tokens) {
+		if (token.text.empty() && !token.is_quoted) {
+			continue;
+		}
+
+		if (token.is_quoted) {
+trace_log("type token string='%.*s'\n", static_cast<int>(token.text.size()), token.text.data());
+			append_string_actions(token.text, m_macro_interkey_frames, plan.actions);
+			continue;
+		}
+
+trace_log("type token='%.*s'\n", static_cast<int>(token.text.size()), token.text.data());
+		if (token.text == "GET" || token.text == "VIEW") {
+			plan.request_frame = true;
+trace_log("type request_frame enabled by token='%.*s'\n", static_cast<int>(token.text.size()), token.text.data());
+			continue;
+		}
+		if (equals_upper(token.text, "GET") || equals_upper(token.text, "VIEW")) {
+			log_case_warning(token.text, equals_upper(token.text, "GET") ? "GET" : "VIEW");
+			plan.request_frame = true;
+			continue;
+		}
+		if (token.text == "DIFF") {
+			plan.request_frame = true;
+			plan.request_diff  = true;
+			continue;
+		}
+		if (equals_upper(token.text, "DIFF")) {
+			log_case_warning(token.text, "DIFF");
+			plan.request_frame = true;
+			plan.request_diff  = true;
+			continue;
+		}
+
+		if (plan.request_frame && !plan.request_diff && !plan.region) {
+			if (const auto region = parse_text_region(token.text)) {
+				plan.region = region;
+				continue;
+			}
+		}
+
+		bool delay_case_error = false;
+		if (const auto delay = parse_delay_token(token.text, delay_case_error)) {
+			plan.actions.push_back(make_delay_ms_action(*delay));
+trace_log("type delay_ms=%lld\n", static_cast<long long>(delay->count()));
+			continue;
+		}
+		if (delay_case_error) {
+			const auto digits = token.text.substr(0, token.text.size() - 2);
+			log_case_warning(token.text, std::string(digits) + "ms");
+			continue;
+		}
+
+		bool frames_case_error = false;
+		std::string frames_expected;
+		if (const auto frames = parse_frames_token(token.text, frames_case_error, frames_expected)) {
+			plan.actions.push_back(make_delay_frames_action(*frames));
+trace_log("type delay_frames=%u\n", *frames);
+			continue;
+		}
+		if (frames_case_error && !frames_expected.empty()) {
+			log_case_warning(token.text, frames_expected);
+			continue;
+		}
+
+		if (append_key_token(token.text, plan.actions)) {
+trace_log("type key token accepted='%.*s'\n", static_cast<int>(token.text.size()), token.text.data());
+			continue;
+		}
+
+		log_token_warning(token.text, "unrecognised token");
+	}
+	return plan;
+}
+
+void CommandProcessor::FinishTypePlan(TypeCommandPlan& plan) const
+{
+	if (plan.request_frame && !plan.actions.empty()) {
+trace_log("type request_frame with actions=%zu\n", plan.actions.size());
+		const auto last_kind = plan.actions.back().kind;
+		if (last_kind != TypeAction::Kind::DelayMs &&
+		    last_kind != TypeAction::Kind::DelayFrames) {
+			const uint32_t frames_to_wait = (m_macro_interkey_frames > 0)
+			                                        ? m_macro_interkey_frames
+			                                        : 1;
+			plan.actions.push_back(make_delay_frames_action(frames_to_wait));
+trace_log("type appended trailing delay_frames=%u\n", frames_to_wait);
+		}
+	}
+}
+
+CommandResponse CommandProcessor::RunTypePlan(const TypeCommandPlan& plan,
+                                              const CommandOrigin& origin)
+{
+	// The emulator doesn't run during a batch, so there is nothing to wait
+	// for and the keys are typed at once
+	const auto& actions = plan.actions;
+	if (m_in_batch && std::any_of(actions.begin(), actions.end(), is_delay_action)) {
+		auto keys_only = plan;
+		std::erase_if(keys_only.actions, is_delay_action);
+		return RunTypePlan(keys_only, origin);
+	}
+
+	const auto client_id = origin.client;
+	const bool diff      = plan.request_diff;
+	const auto region    = plan.region;
+	ITypeActionSink::FrameProvider frame_provider = {};
+	if (m_provider) {
+		frame_provider = [this, client_id, diff, region] {
+			return region ? ProvideRegionFrame(*region)
+			              : ProvideFrame(client_id, diff);
+		};
+	}
+
+	if (plan.actions.empty()) {
+trace_log("type actions empty request_frame=%s\n", plan.request_frame ? "yes" : "no");
+		if (!plan.request_frame) {
+			++m_success;
+			return {true, "OK\n"};
+		}
+
+		if (!frame_provider) {
+			++m_failures;
+			return {false, "ERR service unavailable\n"};
+		}
+
+		const auto result = frame_provider();
+		if (!result.success) {
+			++m_failures;
+			return {false, "ERR " + result.error + "\n"};
+		}
+
+		++m_success;
+		return {true, result.frame};
+	}
+
+	if (!m_type_sink) {
+		m_type_sink = std::make_shared<ImmediateTypeActionSink>();
+	}
+
+	auto completion = [this](const bool success) {
+		if (success) {
+			++m_success;
+		} else {
+			++m_failures;
+		}
+	};
+
+trace_log("type pre-exec sink=%s origin=%p queue_non_frame=%s allow_deferred=%s request_frame=%s\n",
+          m_type_sink ? "set" : "null",
+          reinterpret_cast<void*>(origin.client),
+          m_queue_non_frame_commands ? "yes" : "no",
+          m_allow_deferred_frames ? "yes" : "no",
+          plan.request_frame ? "yes" : "no");
+
+	bool use_queue = static_cast<bool>(m_type_sink);
+	if (use_queue && origin.client == 0 && m_type_sink_requires_client) {
+		use_queue = false;
+	}
+	if (use_queue && !plan.request_frame && !m_queue_non_frame_commands) {
+		use_queue = false;
+	}
+	if (use_queue && !m_allow_deferred_frames) {
+		use_queue = false;
+	}
+	if (m_in_batch) {
+		use_queue = false;
+	}
+	trace_log("type execution mode queue=%s actions=%zu request_frame=%s\n",
+	          use_queue ? "yes" : "no",
+	          plan.actions.size(),
+	          plan.request_frame ? "yes" : "no");
+
+	auto sink = use_queue ? m_type_sink : std::make_shared<ImmediateTypeActionSink>();
+
+	const auto response = sink->Execute(
+	        plan, origin, m_keyboard_handler, frame_provider, completion);
+
+	if (!response.deferred) {
+		if (response.ok) {
+			++m_success;
+		} else {
+			++m_failures;
+		}
+	}
+
+	return response;
+}
+
+bool CommandProcessor::ConsumeExitRequest()
+{
+	if (!m_exit_requested) {
+		return false;
+	}
+	m_exit_requested = false;
+	return true;
+}
+
+void CommandProcessor::ForgetClient(const uintptr_t client)
+{
+	m_baselines.erase(client);
+	m_watchers.erase(client);
+	m_memory_watches.erase(client);
+	m_event_subscriptions.erase(client);
+	m_batches.erase(client);
+	m_congested_clients.erase(client);
+	std::erase_if(m_pending_steps,
+	              [client](const auto& step) { return step.origin.client == client; });
+	if (m_turbo && m_turbo->origin.client == client) {
+		m_turbo_handler(false);
+		m_turbo.reset();
+	}
+}
+
+void CommandProcessor::SetClientCongested(const uintptr_t client, const bool congested)
+{
+	if (congested) {
+		m_congested_clients.insert(client);
+	} else {
+		m_congested_clients.erase(client);
+	}
+}
+
+void CommandProcessor::SetTypeActionSink(std::shared_ptr<ITypeActionSink> sink)
+{
+	m_type_sink = std::move(sink);
+	if (!m_type_sink) {
+		m_type_sink = std::make_shared<ImmediateTypeActionSink>();
+	}
+	m_type_sink_requires_client = false;
+}
+
+void CommandProcessor::SetMacroInterkeyFrames(const uint32_t frames)
+{
+	m_macro_interkey_frames = frames;
+}
+
+void CommandProcessor::SetTypeSinkRequiresClient(const bool requires_client)
+{
+	m_type_sink_requires_client = requires_client;
+}
+
+void CommandProcessor::SetQueueNonFrameCommands(const bool enable)
+{
+	m_queue_non_frame_commands = enable;
+}
+
+void CommandProcessor::SetAllowDeferredFrames(const bool enable)
+{
+	m_allow_deferred_frames = enable;
+}
+
+void CommandProcessor::SetDebugRegion(const uint32_t offset, const uint32_t length)
+{
+	m_debug_offset  = offset;
+	m_debug_length  = std::min(length, kMaxDebugLength);
+	m_debug_enabled = (m_debug_length > 0);
+}
+
+void CommandProcessor::SetRejectedClientsProvider(std::function<uint64_t()> provider)
+{
+	m_rejected_clients_provider = std::move(provider);
+}
+
+void CommandProcessor::SetQueueTelemetryProvider(std::function<QueueTelemetry()> provider)
+{
+	m_queue_telemetry_provider = std::move(provider);
+}
+
+void CommandProcessor::SetTransportTelemetryProvider(
+        std::function<TransportTelemetry()> provider)
+{
+	m_transport_telemetry_provider = std::move(provider);
+}
+
+void CommandProcessor::SetEmulatorTelemetryProvider(
+        std::function<EmulatorTelemetry()> provider)
+{
+	m_emulator_telemetry_provider = std::move(provider);
+}
+
+void CommandProcessor::SetFrameGenerationProvider(std::function<uint64_t()> provider)
+{
+	m_generation_provider = std::move(provider);
+}
+
+CommandResponse CommandProcessor::HandleCloneCommand(const std::string& argument)
+{
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	if (!m_clone_handler) {
+		return fail("ERR CLONE unavailable\n");
+	}
+
+	CloneRequest request = {};
+	if (argument.rfind("port=", 0) == 0) {
+		const auto text = std::string_view(argument).substr(5);
+		uint32_t port   = 0;
+		const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), port);
+		if (ec != std::errc() || end != text.data() + text.size() || port < 1024 ||
+		    port > 65535) {
+			return fail("ERR invalid CLONE port\n");
+		}
+		request.port = static_cast<uint16_t>(port);
+	} else if (argument.rfind("socket=", 0) == 0 && argument.size() > 7) {
+		request.socket_path = argument.substr(7);
+	} else {
+		return fail("ERR invalid CLONE arguments\n");
+	}
+
+	const auto result = m_clone_handler(request);
+	if (!result.success) {
+		return fail("ERR " + result.error + "\n");
+	}
+	++m_success;
+	// The child's copy of this reply goes nowhere; its clients are the
+	// parent's
+	return {true, "OK CLONE pid=" + std::to_string(result.pid) + "\n"};
+}
+
+CommandResponse CommandProcessor::HandleStepCommand(const std::string& argument,
+                                                   const CommandOrigin& origin)
+{
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	if (!m_step_handler || !m_step_clock) {
+		return fail("ERR lockstep unavailable\n");
+	}
+	if (origin.client == 0) {
+		return fail("ERR STEP requires a connection\n");
+	}
+
+	// The amount and its unit form one token: 100ms, 3frames, 1frame
+	const auto text = std::string_view(argument);
+	StepRequest request = {};
+	const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), request.amount);
+	const auto unit = to_upper(text.substr(static_cast<size_t>(end - text.data())));
+	if (ec != std::errc() || request.amount == 0 || request.amount > kMaxStepAmount) {
+		return fail("ERR invalid STEP arguments\n");
+	}
+	if (unit == "FRAMES" || unit == "FRAME") {
+		request.frames = true;
+	} else if (unit != "MS") {
+		return fail("ERR invalid STEP arguments\n");
+	}
+
+	const auto result = m_step_handler(request);
+	if (!result.success) {
+		return fail("ERR " + result.error + "\n");
 	}
+	m_pending_steps.push_back({origin, result.ticks, result.until});
+	++m_success;
+
+	// Replied to from CollectPushedFrames() once the ticks have run
+	CommandResponse response{true, ""};
+	response.deferred = true;
+	return response;
+}
+
+CommandResponse CommandProcessor::HandleProfileCommand(const std::string& argument)
+{
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
 
-	if (verb_upper == "TYPE") {
-		return HandleTypeCommand(argument, origin);
+	if (!m_profile_start_handler || !m_profile_stop_handler) {
+		return fail("ERR PROFILE unavailable\n");
 	}
-
-	return {false, "ERR unknown command\n"};
+	const auto mode = to_upper(argument);
+	if (mode == "START") {
+		if (!m_profile_start_handler()) {
+			return fail("ERR PROFILE already running\n");
+		}
+		++m_success;
+		return {true, "OK\n"};
+	}
+	if (mode != "STOP") {
+		return fail("ERR invalid PROFILE arguments\n");
+	}
+	const auto report = m_profile_stop_handler();
+	if (!report.success) {
+		return fail("ERR " + report.error + "\n");
+	}
+	++m_success;
+	return {true,
+	        "PROFILE samples=" + std::to_string(report.samples) +
+	                " bytes=" + std::to_string(report.folded.size()) + "\n" +
+	                report.folded};
 }
 
-CommandResponse CommandProcessor::HandleTypeCommand(const std::string& argument,
-	                                              const CommandOrigin& origin)
+CommandResponse CommandProcessor::HandleMemoryCommand(const std::string& argument)
 {
 	++m_requests;
-	if (!m_keyboard_handler) {
+	const auto fail = [this](const std::string& message) -> CommandResponse {
 		++m_failures;
-		return {false, "ERR keyboard unavailable\n"};
+		return {false, message};
+	};
+
+	if (!m_memory_report_handler || !m_memory_trim_handler) {
+		return fail("ERR MEMORY unavailable\n");
+	}
+	const auto mode = to_upper(argument);
+	if (mode == "TRIM") {
+		const auto released = m_memory_trim_handler();
+		++m_success;
+		return {true, "OK TRIM released=" + std::to_string(released) + "\n"};
+	}
+	if (!mode.empty() && mode != "JSON") {
+		return fail("ERR invalid MEMORY arguments\n");
 	}
 
-	TypeCommandPlan plan;
-	const auto tokens = tokenize_type_arguments(argument);
-trace_log("type command argument='%s' tokens=%zu\n", argument.c_str(), tokens.size());
+	const auto report = m_memory_report_handler();
+	uint64_t reserved = 0;
+	uint64_t resident = 0;
+	for (const auto& region : report.regions) {
+		reserved += region.reserved_bytes;
+		resident += region.resident_bytes;
+	}
 
-	for (const auto& token : tokens) {
-		if (token.text.empty() && !token.is_quoted) {
-			continue;
+	std::ostringstream oss;
+	if (mode == "JSON") {
+		oss << "{\"profile\":\"" << report.profile << "\",\"rss\":";
+		if (report.resident_bytes) {
+			oss << *report.resident_bytes;
+		} else {
+			oss << "null";
 		}
-
-		if (token.is_quoted) {
-trace_log("type token string='%s'\n", token.text.c_str());
-			append_string_actions(token.text, m_macro_interkey_frames, plan.actions);
-			continue;
+		oss << ",\"reserved\":" << reserved << ",\"resident\":" << resident
+		    << ",\"regions\":{";
+		for (size_t i = 0; i < report.regions.size(); ++i) {
+			const auto& region = report.regions[i];
+			oss << (i > 0 ? "," : "") << '"' << region.name
+			    << "\":{\"reserved\":" << region.reserved_bytes
+			    << ",\"resident\":" << region.resident_bytes << '}';
 		}
+		oss << "}}\n";
+		++m_success;
+		return {true, oss.str()};
+	}
 
-		auto token_upper = to_upper(token.text);
-trace_log("type token='%s' upper='%s'\n", token.text.c_str(), token_upper.c_str());
-		if (token.text == "GET" || token.text == "VIEW") {
-			plan.request_frame = true;
-trace_log("type request_frame enabled by token='%s'\n", token.text.c_str());
-			continue;
-		}
-		if (token_upper == "GET" || token_upper == "VIEW") {
-			log_case_warning(token.text, token_upper == "GET" ? "GET" : "VIEW");
-			plan.request_frame = true;
-			continue;
-		}
+	// A header line, then one line per region
+	oss << "MEMORY profile=" << report.profile << " rss="
+	    << (report.resident_bytes ? std::to_string(*report.resident_bytes)
+	                              : std::string("unknown"))
+	    << " reserved=" << reserved << " resident=" << resident
+	    << " regions=" << report.regions.size() << "\n";
+	for (const auto& region : report.regions) {
+		oss << region.name << " reserved=" << region.reserved_bytes
+		    << " resident=" << region.resident_bytes << "\n";
+	}
+	++m_success;
+	return {true, oss.str()};
+}
 
-		bool delay_case_error = false;
-		if (const auto delay = parse_delay_token(token.text, delay_case_error)) {
-			plan.actions.push_back(make_delay_ms_action(*delay));
-trace_log("type delay_ms=%lld\n", static_cast<long long>(delay->count()));
-			continue;
-		}
-		if (delay_case_error) {
-			const auto digits = token.text.substr(0, token.text.size() - 2);
-			log_case_warning(token.text, digits + "ms");
-			continue;
-		}
+CommandResponse CommandProcessor::HandlePoolCommand(const std::string& argument)
+{
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
 
-		bool frames_case_error = false;
-		std::string frames_expected;
-		if (const auto frames = parse_frames_token(token.text, frames_case_error, frames_expected)) {
-			plan.actions.push_back(make_delay_frames_action(*frames));
-trace_log("type delay_frames=%u\n", *frames);
-			continue;
-		}
-		if (frames_case_error && !frames_expected.empty()) {
-			log_case_warning(token.text, frames_expected);
-			continue;
+	if (!m_pool_start_handler || !m_pool_stats_handler) {
+		return fail("ERR POOL unavailable\n");
+	}
+	const auto mode = to_upper(argument);
+	if (mode == "START") {
+		const auto result = m_pool_start_handler();
+		if (!result.success) {
+			return fail("ERR " + result.error + "\n");
 		}
+		++m_success;
+		return {true, "OK POOL START size=" + std::to_string(result.size) + "\n"};
+	}
+	if (!mode.empty()) {
+		return fail("ERR invalid POOL arguments\n");
+	}
 
-		if (append_key_token(token.text, plan.actions)) {
-trace_log("type key token accepted='%s'\n", token.text.c_str());
-			continue;
-		}
+	const auto stats = m_pool_stats_handler();
+	if (!stats) {
+		return fail("ERR POOL not running\n");
+	}
+	++m_success;
+	return {true,
+	        "POOL size=" + std::to_string(stats->size) +
+	                " warm=" + std::to_string(stats->warm) +
+	                " busy=" + std::to_string(stats->busy) +
+	                " waiting=" + std::to_string(stats->waiting) +
+	                " launched=" + std::to_string(stats->launched) +
+	                " recycled=" + std::to_string(stats->recycled) +
+	                " failed=" + std::to_string(stats->failed) + "\n"};
+}
 
-		log_token_warning(token.text, "unrecognised token");
+CommandResponse CommandProcessor::HandleSetCommand(const std::string& argument)
+{
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	if (!m_config_handler) {
+		return fail("ERR SET unavailable\n");
+	}
+	const auto equals = argument.find('=');
+	if (equals == std::string::npos) {
+		return fail("ERR invalid SET arguments\n");
+	}
+	const auto name  = trim_view(std::string_view(argument).substr(0, equals));
+	const auto value = trim_view(std::string_view(argument).substr(equals + 1));
+	if (name.empty() || value.empty()) {
+		return fail("ERR invalid SET arguments\n");
 	}
 
-	if (plan.request_frame && !plan.actions.empty()) {
-trace_log("type request_frame with actions=%zu\n", plan.actions.size());
-		const auto last_kind = plan.actions.back().kind;
-		if (last_kind != TypeAction::Kind::DelayMs &&
-		    last_kind != TypeAction::Kind::DelayFrames) {
-			const uint32_t frames_to_wait = (m_macro_interkey_frames > 0)
-			                                        ? m_macro_interkey_frames
-			                                        : 1;
-			plan.actions.push_back(make_delay_frames_action(frames_to_wait));
-trace_log("type appended trailing delay_frames=%u\n", frames_to_wait);
-		}
+	const auto result = m_config_handler(std::string(name), std::string(value));
+	if (!result.success) {
+		return fail("ERR " + result.error + "\n");
 	}
+	++m_success;
+	return {true, "OK SET " + std::string(name) + "=" + result.value + "\n"};
+}
 
-	if (plan.actions.empty()) {
-trace_log("type actions empty request_frame=%s\n", plan.request_frame ? "yes" : "no");
-		if (!plan.request_frame) {
-			++m_success;
-			return {true, "OK\n"};
-		}
+void CommandProcessor::SetStepHandlers(std::function<StepResult(const StepRequest&)> grant,
+                                       std::function<uint64_t()> clock)
+{
+	m_step_handler = std::move(grant);
+	m_step_clock   = std::move(clock);
+}
 
-		if (!m_provider) {
-			++m_failures;
-			return {false, "ERR service unavailable\n"};
-		}
+CommandResponse CommandProcessor::HandlePasteCommand(const std::string& argument,
+                                                    const CommandOrigin& origin)
+{
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
 
-		const auto result = m_provider();
-		if (!result.success) {
-			++m_failures;
-			return {false, "ERR " + result.error + "\n"};
+	if (!m_paste_handler) {
+		return fail("ERR PASTE unavailable\n");
+	}
+	const auto text = parse_paste_text(argument);
+	if (!text) {
+		return fail("ERR invalid PASTE arguments\n");
+	}
+	// Only text both routes can deliver is accepted
+	for (const char ch : *text) {
+		if (!map_character_to_key(ch)) {
+			return fail("ERR PASTE cannot type " + describe_character(ch) + "\n");
 		}
+	}
 
+	const auto result = m_paste_handler(*text);
+	if (!result.success) {
+		return fail("ERR " + result.error + "\n");
+	}
+	const auto reply = "OK PASTE chars=" + std::to_string(text->size());
+	if (!result.use_keystrokes) {
 		++m_success;
-		return {true, result.frame};
+		return {true, reply + " via=buffer\n"};
 	}
 
-	if (!m_type_sink) {
-		m_type_sink = std::make_shared<ImmediateTypeActionSink>();
+	if (!m_keyboard_handler) {
+		return fail("ERR keyboard unavailable\n");
+	}
+	TypeCommandPlan plan;
+	append_string_actions(*text, m_macro_interkey_frames, plan.actions);
+	const bool use_queue = m_type_sink && (origin.client != 0 || !m_type_sink_requires_client);
+	auto sink = use_queue ? m_type_sink : std::make_shared<ImmediateTypeActionSink>();
+	const auto response = sink->Execute(plan, origin, m_keyboard_handler, {}, {});
+	if (!response.ok) {
+		return fail(response.payload);
+	}
+	++m_success;
+	if (response.deferred) {
+		return response;
 	}
+	return {true, reply + " via=keys\n"};
+}
 
-	auto completion = [this](const bool success) {
-		if (success) {
-			++m_success;
-		} else {
-			++m_failures;
-		}
+CommandResponse CommandProcessor::HandleTurboCommand(const std::string& argument,
+                                                    const CommandOrigin& origin)
+{
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
 	};
 
-trace_log("type pre-exec sink=%s origin=%p queue_non_frame=%s allow_deferred=%s request_frame=%s\n",
-          m_type_sink ? "set" : "null",
-          reinterpret_cast<void*>(origin.client),
-          m_queue_non_frame_commands ? "yes" : "no",
-          m_allow_deferred_frames ? "yes" : "no",
-          plan.request_frame ? "yes" : "no");
+	if (!m_turbo_handler || !m_turbo_clock) {
+		return fail("ERR TURBO unavailable\n");
+	}
 
-	bool use_queue = static_cast<bool>(m_type_sink);
-	if (use_queue && origin.client == 0 && m_type_sink_requires_client) {
-		use_queue = false;
+	const auto space = argument.find(' ');
+	const auto mode  = to_upper(std::string_view(argument).substr(0, space));
+	const auto rest  = space == std::string::npos ? std::string{}
+	                                              : trim(argument.substr(space + 1));
+
+	if (mode == "OFF" && rest.empty()) {
+		if (m_turbo) {
+			FinishTurbo("ERR TURBO cancelled\n");
+		}
+		++m_success;
+		return {true, "OK\n"};
 	}
-	if (use_queue && !plan.request_frame && !m_queue_non_frame_commands) {
-		use_queue = false;
+	if (origin.client == 0) {
+		return fail("ERR TURBO requires a connection\n");
 	}
-	if (use_queue && !m_allow_deferred_frames) {
-		use_queue = false;
+	if (m_turbo) {
+		return fail("ERR TURBO already active\n");
 	}
-	trace_log("type execution mode queue=%s actions=%zu request_frame=%s\n",
-	          use_queue ? "yes" : "no",
-	          plan.actions.size(),
-	          plan.request_frame ? "yes" : "no");
 
-	auto sink = use_queue ? m_type_sink : std::make_shared<ImmediateTypeActionSink>();
-
-	const auto response = sink->Execute(
-	        plan, origin, m_keyboard_handler, m_provider, completion);
+	Turbo turbo        = {};
+	turbo.origin       = origin;
+	turbo.started_tick = m_turbo_clock();
+	turbo.deadline     = std::chrono::steady_clock::time_point::max();
 
-	if (!response.deferred) {
-		if (response.ok) {
-			++m_success;
-		} else {
-			++m_failures;
+	if (mode == "FOR") {
+		const auto duration_ms = parse_unsigned_number(rest);
+		if (!duration_ms || *duration_ms == 0 || *duration_ms > kMaxTurboForMs) {
+			return fail("ERR invalid TURBO arguments\n");
 		}
+		turbo.until_tick = turbo.started_tick + *duration_ms;
+	} else if (mode == "UNTIL" && to_upper(std::string_view(rest).substr(0, 4)) == "MEM ") {
+		// mem ADDR==VALUE [ms]; values above 0xFF compare a word, above
+		// 0xFFFF a dword, little-endian like the guest
+		std::istringstream iss(rest.substr(4));
+		std::string comparison;
+		std::string timeout_token;
+		std::string extra;
+		if (!(iss >> comparison) || (iss >> timeout_token && iss >> extra)) {
+			return fail("ERR invalid TURBO arguments\n");
+		}
+		const auto equals = comparison.find("==");
+		if (equals == std::string::npos) {
+			return fail("ERR invalid TURBO arguments\n");
+		}
+		const auto address = parse_real_mode_address(
+		        std::string_view(comparison).substr(0, equals));
+		const auto value = parse_unsigned_number(
+		        std::string_view(comparison).substr(equals + 2));
+		const auto timeout_ms = timeout_token.empty()
+		                              ? std::optional<uint32_t>(kDefaultTurboTimeoutMs)
+		                              : parse_unsigned_number(timeout_token);
+		if (!address || !value || !timeout_ms || *timeout_ms > kMaxWaitForTimeoutMs) {
+			return fail("ERR invalid TURBO arguments\n");
+		}
+		if (!m_memory_reader) {
+			return fail("ERR memory access unavailable\n");
+		}
+		const size_t width = *value > 0xFFFF ? 4 : (*value > 0xFF ? 2 : 1);
+		for (size_t i = 0; i < width; ++i) {
+			turbo.memory_value.push_back(static_cast<uint8_t>(*value >> (8 * i)));
+		}
+		turbo.memory_offset = address;
+		turbo.deadline = std::chrono::steady_clock::now() +
+		                 std::chrono::milliseconds(*timeout_ms);
+	} else if (mode == "UNTIL") {
+		if (!m_provider) {
+			return fail("ERR service unavailable\n");
+		}
+		WaitPlan plan{};
+		const auto error = parse_screen_condition(rest, "TURBO", kDefaultTurboTimeoutMs, plan);
+		if (!error.empty()) {
+			return fail(error);
+		}
+		turbo.screen   = std::move(plan.matches);
+		turbo.deadline = std::chrono::steady_clock::now() + plan.timeout;
+	} else {
+		return fail("ERR invalid TURBO arguments\n");
+	}
+
+	// Nothing to fast-forward through if the condition already holds
+	if (IsTurboConditionMet(turbo, turbo.started_tick)) {
+		++m_success;
+		return {true, "OK TURBO ticks=0\n"};
 	}
+	if (!m_turbo_handler(true)) {
+		return fail("ERR fast-forward unavailable\n");
+	}
+	m_turbo = std::move(turbo);
+	++m_success;
 
+	// Replied to from CollectPushedFrames() once the condition is met
+	CommandResponse response{true, ""};
+	response.deferred = true;
 	return response;
 }
 
-bool CommandProcessor::ConsumeExitRequest()
+bool CommandProcessor::IsTurboConditionMet(Turbo& turbo, const uint64_t tick)
 {
-	if (!m_exit_requested) {
+	if (turbo.until_tick) {
+		return tick >= *turbo.until_tick;
+	}
+	if (turbo.memory_offset) {
+		const auto size   = static_cast<uint32_t>(turbo.memory_value.size());
+		const auto result = m_memory_reader(*turbo.memory_offset, size);
+		return result.success && result.bytes == turbo.memory_value;
+	}
+
+	// The screen only needs re-matching when its content changed
+	const auto generation = m_generation_provider ? m_generation_provider() : 0;
+	if (generation != 0 && generation == turbo.checked_generation) {
 		return false;
 	}
-	m_exit_requested = false;
-	return true;
+	const auto capture = Capture();
+	if (!capture.success || !capture.snapshot) {
+		return false;
+	}
+	turbo.checked_generation = capture.generation;
+	return turbo.screen(*capture.snapshot);
 }
 
-void CommandProcessor::SetTypeActionSink(std::shared_ptr<ITypeActionSink> sink)
+void CommandProcessor::PollTurbo()
 {
-	m_type_sink = std::move(sink);
-	if (!m_type_sink) {
-		m_type_sink = std::make_shared<ImmediateTypeActionSink>();
+	if (!m_turbo || !m_turbo_clock) {
+		return;
+	}
+	const auto tick = m_turbo_clock();
+	if (IsTurboConditionMet(*m_turbo, tick)) {
+		const auto elapsed = tick - std::min(tick, m_turbo->started_tick);
+		FinishTurbo("OK TURBO ticks=" + std::to_string(elapsed) + "\n");
+	} else if (std::chrono::steady_clock::now() >= m_turbo->deadline) {
+		FinishTurbo("ERR TURBO timeout\n");
 	}
-	m_type_sink_requires_client = false;
 }
 
-void CommandProcessor::SetMacroInterkeyFrames(const uint32_t frames)
+void CommandProcessor::FinishTurbo(const std::string& payload)
 {
-	m_macro_interkey_frames = frames;
+	m_turbo_handler(false);
+	m_deferred_replies.push_back(
+	        {m_turbo->origin.client, TagResponse(m_turbo->origin, payload)});
+	m_turbo.reset();
 }
 
-void CommandProcessor::SetTypeSinkRequiresClient(const bool requires_client)
+CommandResponse CommandProcessor::HandleGetImageCommand(const std::string& argument,
+                                                       const CommandOrigin& origin)
 {
-	m_type_sink_requires_client = requires_client;
+	++m_requests;
+	const auto fail = [this](const std::string& message) -> CommandResponse {
+		++m_failures;
+		return {false, message};
+	};
+
+	if (!m_image_handler) {
+		return fail("ERR GETIMG unavailable\n");
+	}
+	if (origin.client == 0) {
+		return fail("ERR GETIMG requires a connection\n");
+	}
+	const auto request = parse_image_request(argument);
+	if (!request) {
+		return fail("ERR invalid GETIMG arguments\n");
+	}
+	const auto result = m_image_handler(origin, *request);
+	if (!result.success) {
+		return fail("ERR " + result.error + "\n");
+	}
+	++m_success;
+	CommandResponse response{true, ""};
+	response.deferred = true;
+	return response;
 }
 
-void CommandProcessor::SetQueueNonFrameCommands(const bool enable)
+void CommandProcessor::SetImageHandler(
+        std::function<ImageResult(const CommandOrigin&, const ImageRequest&)> handler)
 {
-	m_queue_non_frame_commands = enable;
+	m_image_handler = std::move(handler);
 }
 
-void CommandProcessor::SetAllowDeferredFrames(const bool enable)
+void CommandProcessor::SetProfileHandlers(std::function<bool()> start,
+                                          std::function<ProfileReport()> stop)
 {
-	m_allow_deferred_frames = enable;
+	m_profile_start_handler = std::move(start);
+	m_profile_stop_handler  = std::move(stop);
 }
 
-void CommandProcessor::SetDebugRegion(const uint32_t offset, const uint32_t length)
+void CommandProcessor::SetMemoryHandlers(std::function<MemoryReport()> report,
+                                         std::function<uint64_t()> trim)
 {
-	m_debug_offset  = offset;
-	m_debug_length  = std::min(length, kMaxDebugLength);
-	m_debug_enabled = (m_debug_length > 0);
+	m_memory_report_handler = std::move(report);
+	m_memory_trim_handler   = std::move(trim);
+}
+
+void CommandProcessor::SetPoolHandlers(std::function<PoolStartResult()> start,
+                                       std::function<std::optional<PoolStats>()> stats)
+{
+	m_pool_start_handler = std::move(start);
+	m_pool_stats_handler = std::move(stats);
+}
+
+void CommandProcessor::SetConfigHandler(
+        std::function<ConfigResult(const std::string&, const std::string&)> handler)
+{
+	m_config_handler = std::move(handler);
+}
+
+void CommandProcessor::SetPasteHandler(std::function<PasteResult(const std::string&)> handler)
+{
+	m_paste_handler = std::move(handler);
+}
+
+void CommandProcessor::SetTurboHandlers(std::function<bool(bool)> engage,
+                                        std::function<uint64_t()> clock)
+{
+	m_turbo_handler = std::move(engage);
+	m_turbo_clock   = std::move(clock);
+}
+
+void CommandProcessor::SetCloneHandler(std::function<CloneResult(const CloneRequest&)> handler)
+{
+	m_clone_handler = std::move(handler);
+}
+
+void CommandProcessor::SetSaveStateHandlers(
+        std::function<SaveStateResult(const std::string&)> save,
+        std::function<SaveStateResult(const std::string&)> load)
+{
+	m_save_state_handler = std::move(save);
+	m_load_state_handler = std::move(load);
+}
+
+void CommandProcessor::SetCheckpointHandlers(std::function<CheckpointResult()> take,
+                                             std::function<CheckpointResult(uint32_t)> rewind)
+{
+	m_checkpoint_handler = std::move(take);
+	m_rewind_handler     = std::move(rewind);
+}
+
+void CommandProcessor::SetRegionFrameProvider(
+        std::function<ServiceResult(const TextRegion&)> provider)
+{
+	m_region_provider = std::move(provider);
+}
+
+void CommandProcessor::SetGraphicsTextProvider(std::function<ServiceResult()> provider)
+{
+	m_graphics_text_provider = std::move(provider);
 }
 
 } // namespace textmode
@@ -7,13 +7,20 @@
 #include <chrono>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
+#include "misc/footprint.h"
+#include "textmode_server/encoder.h"
 #include "textmode_server/service.h"
 #include "textmode_server/memory_access.h"
+#include "textmode_server/telemetry.h"
 
 namespace textmode {
 
@@ -24,12 +31,27 @@ struct CommandResponse {
 	uint64_t deferred_id = 0;
 };
 
+// An unsolicited frame for a WATCH subscriber
+struct PushedFrame {
+	uintptr_t client    = 0;
+	std::string payload = {};
+};
+
 struct CommandOrigin {
 	CommandOrigin() = default;
 	explicit CommandOrigin(const uintptr_t handle) : client(handle) {}
+	CommandOrigin(const uintptr_t handle, const std::optional<uint64_t> id)
+	        : client(handle),
+	          request_id(id)
+	{}
 	uintptr_t client = 0;
+	// Set when the command line started with "#<id>"; echoed on the reply
+	std::optional<uint64_t> request_id = std::nullopt;
 };
 
+// Prefixes 'payload' with "#<id> " when the command it answers was tagged
+std::string TagResponse(const CommandOrigin& origin, const std::string& payload);
+
 struct TypeAction {
 	enum class Kind { Press, Down, Up, DelayMs, DelayFrames };
 
@@ -39,11 +61,143 @@ struct TypeAction {
 	uint32_t frames = 0;
 };
 
+// One TYPE argument: a bare word or the unescaped text of a quoted string
+struct TypeToken {
+	std::string_view text = {};
+	bool is_quoted        = false;
+};
+
 struct TypeCommandPlan {
-	TypeCommandPlan() : actions(), request_frame(false) {}
+	TypeCommandPlan() : actions(), request_frame(false), request_diff(false) {}
 
 	std::vector<TypeAction> actions;
 	bool request_frame;
+	bool request_diff;
+	// Set by a "row,col,rows,cols" token after GET or VIEW
+	std::optional<TextRegion> region = std::nullopt;
+};
+
+// A WAITFOR request: reply with the first frame 'matches' accepts, or with
+// 'ERR WAITFOR timeout' once 'timeout' has passed
+struct WaitPlan {
+	std::function<bool(const Snapshot&)> matches = {};
+	std::chrono::milliseconds timeout            = {};
+	// Current frame content generation, 0 while there's no frame yet.
+	// Without it, the frame is fetched to learn its generation.
+	std::function<uint64_t()> generation = {};
+};
+
+// Outcome of a SAVESTATE or LOADSTATE request
+struct SaveStateResult {
+	bool success      = false;
+	std::string error = {};
+	// Size of the saved state; unused when loading
+	size_t bytes = 0;
+};
+
+// Outcome of a CHECKPOINT or REWIND request
+struct CheckpointResult {
+	bool success      = false;
+	std::string error = {};
+	// The checkpoint taken, the pages of RAM it copied, and the bytes
+	// copied in all; unused when rewinding
+	uint32_t id  = 0;
+	size_t pages = 0;
+	size_t bytes = 0;
+};
+
+// Where a CLONE child listens: on 'port', or on 'socket_path' when set
+struct CloneRequest {
+	uint16_t port           = 0;
+	std::string socket_path = {};
+};
+
+struct CloneResult {
+	bool success      = false;
+	std::string error = {};
+	// The child's process ID; 0 when returning in the child itself
+	int64_t pid = 0;
+};
+
+struct PasteResult {
+	bool success      = false;
+	std::string error = {};
+	// Set when the guest reads the keyboard port itself, so the text has
+	// to be typed as keystrokes instead
+	bool use_keystrokes = false;
+};
+
+struct StepRequest {
+	uint32_t amount = 0;
+	// Whether 'amount' counts video frames rather than milliseconds
+	bool frames = false;
+};
+
+struct StepResult {
+	bool success      = false;
+	std::string error = {};
+	// Ticks granted, and the lockstep tick count at which they have run
+	uint32_t ticks = 0;
+	uint64_t until = 0;
+};
+
+enum class ImageFormat { Raw, Png, Qoi };
+
+struct ImageRequest {
+	// Integer upscale applied after the frame is grabbed
+	uint8_t scale      = 1;
+	ImageFormat format = ImageFormat::Png;
+};
+
+struct ImageResult {
+	bool success      = false;
+	std::string error = {};
+};
+
+struct ProfileReport {
+	bool success      = false;
+	std::string error = {};
+	uint64_t samples  = 0;
+	// Folded stacks, one "frame;frame;... count" line each
+	std::string folded = {};
+};
+
+struct MemoryReport {
+	// The 'memory_profile' setting in effect
+	std::string profile = {};
+	// The resident set of the whole process, if the host reports it
+	std::optional<uint64_t> resident_bytes = {};
+	std::vector<FootprintSample> regions   = {};
+};
+
+// Outcome of POOL START
+struct PoolStartResult {
+	bool success      = false;
+	std::string error = {};
+	size_t size       = 0;
+};
+
+// How the instance pool is doing; see instance_pool.h
+struct PoolStats {
+	// Instances kept warm, those ready now, and those serving a client
+	size_t size = 0;
+	size_t warm = 0;
+	size_t busy = 0;
+	// Clients waiting for an instance to become ready
+	size_t waiting = 0;
+	// Instances started, discarded after their client left, and starts
+	// that failed
+	uint64_t launched = 0;
+	uint64_t recycled = 0;
+	uint64_t failed   = 0;
+};
+
+// Outcome of a SET request
+struct ConfigResult {
+	bool success      = false;
+	std::string error = {};
+	// The setting's value once applied, which may have been clamped
+	std::string value = {};
 };
 
 class ITypeActionSink {
@@ -58,6 +212,21 @@ public:
 	                                const KeyboardHandler& keyboard_handler,
 	                                const FrameProvider& frame_provider,
 	                                CompletionCallback on_complete) = 0;
+
+	// Only sinks that can send deferred replies support waiting
+	virtual CommandResponse ExecuteWait(const WaitPlan& plan,
+	                                    const CommandOrigin& origin,
+	                                    const FrameProvider& frame_provider,
+	                                    CompletionCallback on_complete)
+	{
+		(void)plan;
+		(void)origin;
+		(void)frame_provider;
+		if (on_complete) {
+			on_complete(false);
+		}
+		return {false, "ERR WAITFOR unavailable\n"};
+	}
 };
 
 class ICommandProcessor {
@@ -71,6 +240,14 @@ public:
 		return HandleCommand(command);
 	}
 	virtual bool ConsumeExitRequest() { return false; }
+	virtual void ForgetClient(const uintptr_t client) { (void)client; }
+	// Set while the client's unsent replies exceed the server's budget
+	virtual void SetClientCongested(const uintptr_t client, const bool congested)
+	{
+		(void)client;
+		(void)congested;
+	}
+	virtual std::vector<PushedFrame> CollectPushedFrames() { return {}; }
 };
 
 class CommandProcessor : public ICommandProcessor {
@@ -86,21 +263,190 @@ public:
 	CommandResponse HandleCommand(const std::string& command,
 	                              const CommandOrigin& origin) override;
 	bool ConsumeExitRequest() override;
+	void ForgetClient(uintptr_t client) override;
+	void SetClientCongested(uintptr_t client, bool congested) override;
+	std::vector<PushedFrame> CollectPushedFrames() override;
 	void SetTypeActionSink(std::shared_ptr<ITypeActionSink> sink);
 	void SetMacroInterkeyFrames(uint32_t frames);
 	void SetTypeSinkRequiresClient(bool requires_client);
 	void SetQueueNonFrameCommands(bool enable);
 	void SetAllowDeferredFrames(bool enable);
 	void SetDebugRegion(uint32_t offset, uint32_t length);
+	void SetRejectedClientsProvider(std::function<uint64_t()> provider);
+	// Current frame content generation (0 when unknown), checked by
+	// GET IFCHANGED before any capture or encoding happens
+	void SetFrameGenerationProvider(std::function<uint64_t()> provider);
+	// Serves GET row,col,rows,cols by encoding only that rectangle. Without
+	// one, region frames are cropped from a full capture.
+	void SetRegionFrameProvider(std::function<ServiceResult(const TextRegion&)> provider);
+	// Serves GET GFXTEXT with the text read off a graphics screen
+	void SetGraphicsTextProvider(std::function<ServiceResult()> provider);
+	// Compares every WATCHMEM range against its previous sample and queues
+	// one event per changed run. Called once per emulated frame, so writes
+	// within a frame coalesce into a single old/new pair.
+	void SampleMemoryWatches(uint64_t tick);
+	// Queues an "EVENT tick=N type=TYPE ..." record, with 'fields' after
+	// the type, for every EVENTS subscriber that takes 'type'
+	void PostEvent(uint64_t tick, std::string_view type, std::string_view fields);
+	// Lets the emulator skip describing events nobody listens to
+	bool HasEventSubscribers() const;
+	void SetQueueTelemetryProvider(std::function<QueueTelemetry()> provider);
+	void SetTransportTelemetryProvider(std::function<TransportTelemetry()> provider);
+	// Adds the emulator's own health to METRICS; without one METRICS
+	// reports only the server
+	void SetEmulatorTelemetryProvider(std::function<EmulatorTelemetry()> provider);
+	// Serve SAVESTATE and LOADSTATE; both take the slot name
+	void SetSaveStateHandlers(std::function<SaveStateResult(const std::string&)> save,
+	                          std::function<SaveStateResult(const std::string&)> load);
+	// Serve CHECKPOINT, which takes one, and REWIND id, which restores it
+	void SetCheckpointHandlers(std::function<CheckpointResult()> take,
+	                           std::function<CheckpointResult(uint32_t)> rewind);
+	// Serves CLONE port=N and CLONE socket=PATH
+	void SetCloneHandler(std::function<CloneResult(const CloneRequest&)> handler);
+	// Serves STEP Nms and STEP Nframes: 'grant' hands the machine the ticks,
+	// and 'clock' reports how many have run so the reply can follow them
+	void SetStepHandlers(std::function<StepResult(const StepRequest&)> grant,
+	                     std::function<uint64_t()> clock);
+	// Serves PASTE by queueing text for the guest's BIOS keyboard buffer
+	void SetPasteHandler(std::function<PasteResult(const std::string&)> handler);
+	// Serves TURBO: 'engage' switches fast-forward on or off and returns
+	// whether that took effect; 'clock' counts emulated milliseconds
+	void SetTurboHandlers(std::function<bool(bool)> engage, std::function<uint64_t()> clock);
+	// Serves GETIMG: the handler arranges for the next rendered frame to be
+	// sent to the origin's client and the command itself replies nothing
+	void SetImageHandler(
+	        std::function<ImageResult(const CommandOrigin&, const ImageRequest&)> handler);
+	// Serve PROFILE START, which returns whether sampling began, and
+	// PROFILE STOP, which ends it and reports the samples
+	void SetProfileHandlers(std::function<bool()> start,
+	                        std::function<ProfileReport()> stop);
+	// Serve MEMORY, which reports where the host memory goes, and MEMORY
+	// TRIM, which shrinks the caches and returns how many bytes that freed
+	void SetMemoryHandlers(std::function<MemoryReport()> report,
+	                       std::function<uint64_t()> trim);
+	// Serve POOL START, which turns this instance into the supervisor of
+	// a pool of warm clones, and POOL, which reports on the pool; 'stats'
+	// returns nothing while no pool is running
+	void SetPoolHandlers(std::function<PoolStartResult()> start,
+	                     std::function<std::optional<PoolStats>()> stats);
+	// Serves SET name=value, where the name is a setting or
+	// section.setting, by changing it in the running config
+	void SetConfigHandler(
+	        std::function<ConfigResult(const std::string&, const std::string&)> handler);
 
 private:
 	CommandResponse HandleCommandInternal(const std::string& command,
 	                                      const CommandOrigin& origin);
 	CommandResponse HandleTypeCommand(const std::string& argument,
 	                                  const CommandOrigin& origin);
+	CommandResponse HandleMacroCommand(const std::string& argument,
+	                                   const CommandOrigin& origin);
+	CommandResponse HandleBatchCommand(const std::string& verb,
+	                                   const std::string& argument,
+	                                   const CommandOrigin& origin);
+	// TYPE in steps, so that a MACRO is parsed once and run many times:
+	// parsing turns the arguments into actions, finishing adds the wait
+	// for the screen to settle before a requested frame
+	TypeCommandPlan ParseTypePlan(std::string_view argument);
+	void FinishTypePlan(TypeCommandPlan& plan) const;
+	CommandResponse RunTypePlan(const TypeCommandPlan& plan,
+	                            const CommandOrigin& origin);
 	CommandResponse HandlePeekCommand(const std::string& argument);
+	CommandResponse HandlePeekVectorCommand(const std::string& argument);
 	CommandResponse HandleDebugCommand();
+	CommandResponse HandleMetricsCommand(const std::string& argument);
 	CommandResponse HandlePokeCommand(const std::string& argument);
+	CommandResponse HandleWatchCommand(const std::string& argument,
+	                                   const CommandOrigin& origin);
+	CommandResponse HandleWaitForCommand(const std::string& argument,
+	                                     const CommandOrigin& origin);
+	CommandResponse HandleWatchMemoryCommand(const std::string& argument,
+	                                         const CommandOrigin& origin);
+	CommandResponse HandleEventsCommand(const std::string& argument,
+	                                    const CommandOrigin& origin);
+	CommandResponse HandleSaveStateCommand(const std::string& verb,
+	                                       const std::string& argument);
+	CommandResponse HandleCheckpointCommand(const std::string& verb,
+	                                        const std::string& argument);
+	CommandResponse HandleCloneCommand(const std::string& argument);
+	CommandResponse HandleStepCommand(const std::string& argument,
+	                                  const CommandOrigin& origin);
+	CommandResponse HandlePasteCommand(const std::string& argument,
+	                                   const CommandOrigin& origin);
+	CommandResponse HandleTurboCommand(const std::string& argument,
+	                                   const CommandOrigin& origin);
+	CommandResponse HandleGetImageCommand(const std::string& argument,
+	                                      const CommandOrigin& origin);
+	CommandResponse HandleProfileCommand(const std::string& argument);
+	CommandResponse HandleMemoryCommand(const std::string& argument);
+	CommandResponse HandlePoolCommand(const std::string& argument);
+	CommandResponse HandleSetCommand(const std::string& argument);
+	void PollTurbo();
+	void FinishTurbo(const std::string& payload);
+	ServiceResult Capture();
+	ServiceResult ProvideFrame(uintptr_t client, bool diff);
+	ServiceResult ProvideRegionFrame(const TextRegion& region);
+	ServiceResult EncodeForClient(uintptr_t client, bool diff, ServiceResult result);
+
+	struct Watcher {
+		std::chrono::milliseconds min_interval = {};
+		bool diff                              = false;
+		bool force_push                        = true;
+		std::chrono::steady_clock::time_point next_push = {};
+	};
+
+	struct MemoryWatch {
+		struct Range {
+			uint32_t offset           = 0;
+			std::vector<uint8_t> last = {};
+		};
+		std::vector<Range> ranges = {};
+		// Change events not yet pushed to the client
+		std::string pending = {};
+	};
+
+	struct EventSubscription {
+		// Empty takes every type
+		std::vector<std::string> types = {};
+		// Records not yet pushed to the client
+		std::string pending   = {};
+		uint32_t num_pending  = 0;
+		uint32_t num_dropped  = 0;
+		uint64_t dropped_tick = 0;
+	};
+
+	// A MACRO DEFINE body as parsed, for RUN arguments to be appended to,
+	// and finished, to run as it stands
+	struct Macro {
+		TypeCommandPlan parsed   = {};
+		TypeCommandPlan finished = {};
+	};
+
+	// The lines a connection sent since BATCH, run when END arrives
+	struct Batch {
+		std::vector<std::string> lines = {};
+		bool is_overflowed             = false;
+	};
+
+	// A STEP whose reply waits for its ticks to run
+	struct PendingStep {
+		CommandOrigin origin = {};
+		uint32_t ticks       = 0;
+		uint64_t until       = 0;
+	};
+
+	// The TURBO in progress; exactly one of its conditions is set
+	struct Turbo {
+		CommandOrigin origin = {};
+		std::function<bool(const Snapshot&)> screen = {};
+		std::optional<uint32_t> memory_offset       = std::nullopt;
+		std::vector<uint8_t> memory_value           = {};
+		std::optional<uint64_t> until_tick          = std::nullopt;
+		uint64_t started_tick                       = 0;
+		uint64_t checked_generation                 = 0;
+		std::chrono::steady_clock::time_point deadline = {};
+	};
+	bool IsTurboConditionMet(Turbo& turbo, uint64_t tick);
 
 	std::function<ServiceResult()> m_provider;
 	std::function<CommandResponse(const std::string&)> m_keyboard_handler;
@@ -108,8 +454,55 @@ private:
 	std::function<std::vector<std::string>()> m_keys_down_provider;
 	std::function<MemoryAccessResult(uint32_t, uint32_t)> m_memory_reader;
 	std::function<MemoryWriteResult(uint32_t, const std::vector<uint8_t>&)> m_memory_writer;
+	std::function<uint64_t()> m_rejected_clients_provider;
+	std::function<uint64_t()> m_generation_provider;
+	std::function<ServiceResult(const TextRegion&)> m_region_provider;
+	std::function<ServiceResult()> m_graphics_text_provider;
+	std::function<QueueTelemetry()> m_queue_telemetry_provider;
+	std::function<TransportTelemetry()> m_transport_telemetry_provider;
+	std::function<EmulatorTelemetry()> m_emulator_telemetry_provider;
+	std::function<SaveStateResult(const std::string&)> m_save_state_handler;
+	std::function<SaveStateResult(const std::string&)> m_load_state_handler;
+	std::function<CheckpointResult()> m_checkpoint_handler;
+	std::function<CheckpointResult(uint32_t)> m_rewind_handler;
+	std::function<CloneResult(const CloneRequest&)> m_clone_handler;
+	std::function<StepResult(const StepRequest&)> m_step_handler;
+	std::function<uint64_t()> m_step_clock;
+	std::function<PasteResult(const std::string&)> m_paste_handler;
+	std::function<bool(bool)> m_turbo_handler;
+	std::function<uint64_t()> m_turbo_clock;
+	std::function<ImageResult(const CommandOrigin&, const ImageRequest&)> m_image_handler;
+	std::function<bool()> m_profile_start_handler;
+	std::function<ProfileReport()> m_profile_stop_handler;
+	std::function<MemoryReport()> m_memory_report_handler;
+	std::function<uint64_t()> m_memory_trim_handler;
+	std::function<PoolStartResult()> m_pool_start_handler;
+	std::function<std::optional<PoolStats>()> m_pool_stats_handler;
+	std::function<ConfigResult(const std::string&, const std::string&)> m_config_handler;
 	std::shared_ptr<ITypeActionSink> m_type_sink;
 	std::optional<CommandOrigin> m_active_origin;
+	std::unordered_map<uintptr_t, FrameBaseline> m_baselines;
+	std::unordered_map<uintptr_t, Watcher> m_watchers;
+	// Watchers whose frames are held back until the client catches up
+	std::unordered_set<uintptr_t> m_congested_clients = {};
+	std::unordered_map<uintptr_t, MemoryWatch> m_memory_watches;
+	std::unordered_map<uintptr_t, EventSubscription> m_event_subscriptions;
+	std::vector<PendingStep> m_pending_steps;
+	// Shared by every connection, so they outlive the one that defined them
+	std::unordered_map<std::string, Macro> m_macros;
+	std::unordered_map<uintptr_t, Batch> m_batches;
+	// Set while END runs a batch, which can't let emulated time pass
+	bool m_in_batch = false;
+	std::optional<Turbo> m_turbo;
+	// Replies to deferred commands, sent with the next pushed frames
+	std::vector<PushedFrame> m_deferred_replies;
+	// Reused by every TYPE; see tokenize_type_arguments()
+	std::string m_type_scratch          = {};
+	std::vector<TypeToken> m_type_tokens = {};
+	// Keyed by verb; ordered so STATS JSON output is stable
+	std::map<std::string, LatencyHistogram, std::less<>> m_verb_latency;
+	LatencyHistogram m_capture_latency = {};
+	LatencyHistogram m_encode_latency  = {};
 	uint64_t m_requests = 0;
 	uint64_t m_success  = 0;
 	uint64_t m_failures = 0;
@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/deflate_stream.h"
+
+#include <array>
+#include <utility>
+
+#include <zlib.h>
+
+namespace textmode {
+
+namespace {
+
+constexpr size_t ChunkSize = 16384;
+
+int signed_window_bits(const DeflateFormat format, const int window_bits)
+{
+	// zlib selects raw streams through negative window sizes
+	return format == DeflateFormat::Raw ? -window_bits : window_bits;
+}
+
+} // namespace
+
+DeflateStream::DeflateStream() = default;
+
+DeflateStream::~DeflateStream()
+{
+	if (m_stream) {
+		deflateEnd(m_stream.get());
+	}
+}
+
+DeflateStream::DeflateStream(DeflateStream&&) noexcept = default;
+
+DeflateStream& DeflateStream::operator=(DeflateStream&& other) noexcept
+{
+	if (this != &other) {
+		if (m_stream) {
+			deflateEnd(m_stream.get());
+		}
+		m_stream = std::move(other.m_stream);
+	}
+	return *this;
+}
+
+bool DeflateStream::Init(const DeflateFormat format, const int window_bits)
+{
+	if (m_stream) {
+		deflateEnd(m_stream.get());
+		m_stream.reset();
+	}
+
+	// Heap allocated because zlib keeps a pointer back to the stream
+	auto stream = std::make_unique<z_stream>();
+	if (deflateInit2(stream.get(),
+	                 Z_DEFAULT_COMPRESSION,
+	                 Z_DEFLATED,
+	                 signed_window_bits(format, window_bits),
+	                 8,
+	                 Z_DEFAULT_STRATEGY) != Z_OK) {
+		return false;
+	}
+	m_stream = std::move(stream);
+	return true;
+}
+
+void DeflateStream::Reset()
+{
+	if (m_stream) {
+		deflateReset(m_stream.get());
+	}
+}
+
+std::string DeflateStream::Compress(const std::string& input)
+{
+	std::string output;
+	if (!m_stream) {
+		return output;
+	}
+
+	std::array<char, ChunkSize> chunk = {};
+	m_stream->next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+	m_stream->avail_in = static_cast<uInt>(input.size());
+	do {
+		m_stream->next_out  = reinterpret_cast<Bytef*>(chunk.data());
+		m_stream->avail_out = static_cast<uInt>(chunk.size());
+		deflate(m_stream.get(), Z_SYNC_FLUSH);
+		output.append(chunk.data(), chunk.size() - m_stream->avail_out);
+	} while (m_stream->avail_out == 0);
+	return output;
+}
+
+InflateStream::InflateStream() = default;
+
+InflateStream::~InflateStream()
+{
+	if (m_stream) {
+		inflateEnd(m_stream.get());
+	}
+}
+
+InflateStream::InflateStream(InflateStream&&) noexcept = default;
+
+InflateStream& InflateStream::operator=(InflateStream&& other) noexcept
+{
+	if (this != &other) {
+		if (m_stream) {
+			inflateEnd(m_stream.get());
+		}
+		m_stream = std::move(other.m_stream);
+	}
+	return *this;
+}
+
+bool InflateStream::Init(const DeflateFormat format, const int window_bits)
+{
+	if (m_stream) {
+		inflateEnd(m_stream.get());
+		m_stream.reset();
+	}
+
+	auto stream = std::make_unique<z_stream>();
+	if (inflateInit2(stream.get(), signed_window_bits(format, window_bits)) != Z_OK) {
+		return false;
+	}
+	m_stream = std::move(stream);
+	return true;
+}
+
+std::optional<std::string> InflateStream::Decompress(const std::string& input,
+                                                     const size_t max_output)
+{
+	if (!m_stream) {
+		return std::nullopt;
+	}
+
+	std::string output;
+	std::array<char, ChunkSize> chunk = {};
+	m_stream->next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+	m_stream->avail_in = static_cast<uInt>(input.size());
+	do {
+		m_stream->next_out  = reinterpret_cast<Bytef*>(chunk.data());
+		m_stream->avail_out = static_cast<uInt>(chunk.size());
+		const auto result   = inflate(m_stream.get(), Z_SYNC_FLUSH);
+		if (result != Z_OK && result != Z_BUF_ERROR) {
+			return std::nullopt;
+		}
+		output.append(chunk.data(), chunk.size() - m_stream->avail_out);
+		if (output.size() > max_output) {
+			return std::nullopt;
+		}
+	} while (m_stream->avail_out == 0);
+	return output;
+}
+
+} // namespace textmode
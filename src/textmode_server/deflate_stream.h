@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEXTMODE_DEFLATE_STREAM_H
+#define DOSBOX_TEXTMODE_DEFLATE_STREAM_H
+
+#include <memory>
+#include <optional>
+#include <string>
+
+struct z_stream_s;
+
+namespace textmode {
+
+enum class DeflateFormat {
+	// Bare deflate data, as permessage-deflate uses
+	Raw,
+	// With the zlib header and checksum (RFC 1950)
+	Zlib,
+};
+
+// Compressor whose history survives between calls, so each message can
+// refer back to earlier ones. Every call ends with a sync flush, so the
+// receiver can decode all the data sent so far.
+class DeflateStream {
+public:
+	DeflateStream();
+	~DeflateStream();
+	DeflateStream(DeflateStream&&) noexcept;
+	DeflateStream& operator=(DeflateStream&&) noexcept;
+
+	bool Init(DeflateFormat format, int window_bits = 15);
+	bool IsReady() const { return m_stream != nullptr; }
+
+	// Forgets the history; the next message is compressed on its own
+	void Reset();
+
+	std::string Compress(const std::string& input);
+
+private:
+	std::unique_ptr<z_stream_s> m_stream;
+};
+
+// Counterpart of DeflateStream; refuses output beyond 'max_output' bytes
+class InflateStream {
+public:
+	InflateStream();
+	~InflateStream();
+	InflateStream(InflateStream&&) noexcept;
+	InflateStream& operator=(InflateStream&&) noexcept;
+
+	bool Init(DeflateFormat format, int window_bits = 15);
+	bool IsReady() const { return m_stream != nullptr; }
+
+	std::optional<std::string> Decompress(const std::string& input, size_t max_output);
+
+private:
+	std::unique_ptr<z_stream_s> m_stream;
+};
+
+} // namespace textmode
+
+#endif // DOSBOX_TEXTMODE_DEFLATE_STREAM_H
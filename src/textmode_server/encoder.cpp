@@ -3,10 +3,15 @@
 
 #include "textmode_server/encoder.h"
 
+#include <algorithm>
 #include <array>
+#include <charconv>
 #include <cstdint>
+#include <cstdlib>
+#include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -77,68 +82,499 @@ const std::string& ensure_sentinel(const EncodingOptions& options)
 	return options.sentinel.empty() ? default_sentinel : options.sentinel;
 }
 
-} // namespace
+// Every byte of a cell maps to a fixed glyph and SGR sequence, so both are
+// converted once and the per-cell loop only appends.
+struct EncodingTables {
+	std::array<std::string, 256> glyphs = {};
+	std::array<std::string, 256> sgr    = {};
+};
 
-std::string BuildAnsiFrame(const Snapshot& snapshot, const EncodingOptions& options)
+const EncodingTables& encoding_tables()
 {
-	std::ostringstream oss;
-	const auto& sentinel = ensure_sentinel(options);
+	static const EncodingTables tables = [] {
+		EncodingTables result{};
+		for (size_t i = 0; i < result.glyphs.size(); ++i) {
+			const auto value = static_cast<uint8_t>(i);
+			result.glyphs[i] = to_utf8_char(value);
+			result.sgr[i]    = build_sgr(value);
+		}
+		return result;
+	}();
+	return tables;
+}
 
-	oss << sentinel << "META cols=" << snapshot.columns << '\n';
-	oss << sentinel << "META rows=" << snapshot.rows << '\n';
-	if (snapshot.cursor.enabled) {
-		oss << sentinel << "META cursor=" << snapshot.cursor.row << ','
-		    << snapshot.cursor.column << " visible="
-		    << (snapshot.cursor.visible ? 1 : 0) << '\n';
+void append_number(std::string& out, const uint64_t value)
+{
+	char digits[20] = {};
+	const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+	out.append(digits, result.ptr);
+}
+
+// Worst case is a 3-byte glyph per cell plus the row resets; attribute
+// changes beyond that are rare enough to let the buffer grow.
+size_t estimate_frame_size(const Snapshot& snapshot)
+{
+	constexpr size_t MetadataAllowance = 256;
+	return MetadataAllowance + snapshot.cells.size() * 3 +
+	       static_cast<size_t>(snapshot.rows) * 10;
+}
+
+void append_meta_line(std::string& out, const std::string& sentinel,
+                      const std::string_view text)
+{
+	out.append(sentinel);
+	out.append(text);
+}
+
+void append_meta_header(std::string& out, const Snapshot& snapshot,
+                        const std::string& sentinel)
+{
+	append_meta_line(out, sentinel, "META cols=");
+	append_number(out, snapshot.columns);
+	out.push_back('\n');
+	append_meta_line(out, sentinel, "META rows=");
+	append_number(out, snapshot.rows);
+	out.push_back('\n');
+}
+
+void append_cursor_meta(std::string& out, const CursorState& cursor,
+                        const std::string& sentinel)
+{
+	if (cursor.enabled) {
+		append_meta_line(out, sentinel, "META cursor=");
+		append_number(out, cursor.row);
+		out.push_back(',');
+		append_number(out, cursor.column);
+		out.append(cursor.visible ? " visible=1\n" : " visible=0\n");
 	} else {
-	oss << sentinel << "META cursor=disabled\n";
+		append_meta_line(out, sentinel, "META cursor=disabled\n");
 	}
-	oss << sentinel << "META attributes="
-	    << (options.show_attributes ? "show" : "hide") << '\n';
-	oss << sentinel << "META keys_down=";
-	for (size_t i = 0; i < options.keys_down.size(); ++i) {
+}
+
+void append_keys_meta(std::string& out,
+                      const std::vector<std::string>& keys_down,
+                      const std::string& sentinel)
+{
+	append_meta_line(out, sentinel, "META keys_down=");
+	for (size_t i = 0; i < keys_down.size(); ++i) {
 		if (i > 0) {
-			oss << ',';
+			out.push_back(',');
 		}
-		oss << options.keys_down[i];
+		out.append(keys_down[i]);
 	}
-	oss << '\n';
-	oss << sentinel << "PAYLOAD\n";
+	out.push_back('\n');
+}
+
+// Encodes the cells [first_col, last_col) of one row, starting from a clean
+// attribute state. The caller is responsible for the trailing reset/newline.
+void append_cells(std::string& out, const Snapshot& snapshot,
+                  const uint16_t row, const uint16_t first_col,
+                  const uint16_t last_col, const EncodingOptions& options)
+{
+	const auto& tables = encoding_tables();
+
+	uint8_t previous_attribute = 0;
+	bool has_previous_attr     = false;
 
 	const auto cols = snapshot.columns;
-	const auto rows = snapshot.rows;
+	for (uint16_t col = first_col; col < last_col; ++col) {
+		const auto& cell = snapshot.cells[row * cols + col];
+		if (options.show_attributes) {
+			if (!has_previous_attr || cell.attribute != previous_attribute) {
+				out.append(tables.sgr[cell.attribute]);
+				previous_attribute = cell.attribute;
+				has_previous_attr  = true;
+			}
+		}
+		out.append(tables.glyphs[cell.character]);
+	}
+}
 
-	if (options.show_attributes) {
-		oss << "\x1b[0m";
+struct CellRun {
+	uint16_t row = 0;
+	uint16_t col = 0;
+	uint16_t len = 0;
+};
+
+// Unchanged gaps shorter than this are folded into the surrounding run; a
+// RUN header costs more than re-sending a few cells.
+constexpr uint16_t RunMergeGap = 4;
+
+bool rows_equal(const Snapshot& previous, const uint16_t previous_row,
+                const Snapshot& current, const uint16_t current_row)
+{
+	const auto cols = static_cast<ptrdiff_t>(current.columns);
+	const auto a    = previous.cells.begin() + previous_row * cols;
+	const auto b    = current.cells.begin() + current_row * cols;
+	return std::equal(a, a + cols, b);
+}
+
+// Rows of 'current' that match the row 'shift' rows further down in
+// 'previous' (further up for negative shifts)
+uint16_t count_shifted_matches(const Snapshot& previous, const Snapshot& current,
+                               const std::vector<uint64_t>& previous_hashes,
+                               const std::vector<uint64_t>& current_hashes,
+                               const int shift)
+{
+	uint16_t matches = 0;
+	for (int row = 0; row < current.rows; ++row) {
+		const int source = row + shift;
+		if (source < 0 || source >= current.rows) {
+			continue;
+		}
+		if (previous_hashes[source] == current_hashes[row] &&
+		    rows_equal(previous,
+		               static_cast<uint16_t>(source),
+		               current,
+		               static_cast<uint16_t>(row))) {
+			++matches;
+		}
 	}
+	return matches;
+}
 
-	uint8_t previous_attribute = 0;
-	bool has_previous_attr     = false;
+std::vector<uint64_t> hash_rows(const Snapshot& snapshot)
+{
+	// FNV-1a; collisions only cost a row comparison
+	std::vector<uint64_t> hashes(snapshot.rows);
+	for (uint16_t row = 0; row < snapshot.rows; ++row) {
+		uint64_t hash   = 0xcbf29ce484222325;
+		const auto base = static_cast<size_t>(row) * snapshot.columns;
+		for (uint16_t col = 0; col < snapshot.columns; ++col) {
+			const auto& cell = snapshot.cells[base + col];
+			hash = (hash ^ cell.character) * 0x100000001b3;
+			hash = (hash ^ cell.attribute) * 0x100000001b3;
+		}
+		hashes[row] = hash;
+	}
+	return hashes;
+}
+
+// The row shift (positive when the text moved up) that lets the most rows
+// of 'current' be reused from 'previous', or 0 when scrolling would not
+// save anything. A change of the CRTC start address by whole rows is tried
+// first, as that is what hardware scrolling looks like.
+int find_scroll(const Snapshot& previous, const Snapshot& current)
+{
+	if (current.rows < 2) {
+		return 0;
+	}
+	const auto previous_hashes = hash_rows(previous);
+	const auto current_hashes  = hash_rows(current);
+	const auto matches_at = [&](const int shift) {
+		return count_shifted_matches(
+		        previous, current, previous_hashes, current_hashes, shift);
+	};
+
+	int best_shift       = 0;
+	uint16_t best_matches = matches_at(0);
+	if (best_matches == current.rows) {
+		return 0;
+	}
+
+	const auto try_shift = [&](const int shift) {
+		if (shift == 0 || std::abs(shift) >= current.rows) {
+			return;
+		}
+		const auto matches = matches_at(shift);
+		if (matches > best_matches) {
+			best_matches = matches;
+			best_shift   = shift;
+		}
+	};
+
+	if (current.row_stride != 0 && current.row_stride == previous.row_stride) {
+		const auto moved = static_cast<int64_t>(current.display_start) -
+		                   static_cast<int64_t>(previous.display_start);
+		if (moved % current.row_stride == 0) {
+			try_shift(static_cast<int>(moved / current.row_stride));
+		}
+	}
+	for (int shift = 1; shift < current.rows; ++shift) {
+		try_shift(shift);
+		try_shift(-shift);
+	}
+	return best_shift;
+}
+
+// Changed runs against 'previous' moved by 'scroll' rows. Rows the scroll
+// exposed have no counterpart and are sent whole.
+std::vector<CellRun> find_changed_runs(const Snapshot& previous,
+                                       const Snapshot& current, const int scroll)
+{
+	std::vector<CellRun> runs;
+	const auto cols = current.columns;
+
+	for (uint16_t row = 0; row < current.rows; ++row) {
+		const int source = row + scroll;
+		if (source < 0 || source >= current.rows) {
+			runs.push_back(CellRun{row, 0, cols});
+			continue;
+		}
+		const size_t previous_base = static_cast<size_t>(source) * cols;
+		const size_t row_base      = static_cast<size_t>(row) * cols;
+		std::optional<CellRun> open_run = std::nullopt;
+		uint16_t last_changed           = 0;
 
-	for (uint16_t row = 0; row < rows; ++row) {
 		for (uint16_t col = 0; col < cols; ++col) {
-			const auto& cell = snapshot.cells[row * cols + col];
-			if (options.show_attributes) {
-				if (!has_previous_attr || cell.attribute != previous_attribute) {
-					oss << build_sgr(cell.attribute);
-					previous_attribute = cell.attribute;
-					has_previous_attr  = true;
+			if (previous.cells[previous_base + col] == current.cells[row_base + col]) {
+				continue;
+			}
+			if (open_run && col - last_changed <= RunMergeGap) {
+				open_run->len = static_cast<uint16_t>(col - open_run->col + 1);
+			} else {
+				if (open_run) {
+					runs.push_back(*open_run);
 				}
+				open_run = CellRun{row, col, 1};
 			}
-			oss << to_utf8_char(cell.character);
+			last_changed = col;
+		}
+		if (open_run) {
+			runs.push_back(*open_run);
+		}
+	}
+	return runs;
+}
+
+void append_le16(std::string& out, const uint16_t value)
+{
+	out.push_back(static_cast<char>(value & 0xff));
+	out.push_back(static_cast<char>((value >> 8) & 0xff));
+}
+
+void append_le32(std::string& out, const uint32_t value)
+{
+	append_le16(out, static_cast<uint16_t>(value & 0xffff));
+	append_le16(out, static_cast<uint16_t>(value >> 16));
+}
+
+std::string build_cell_payload(const Snapshot& snapshot, const bool rle)
+{
+	std::string payload;
+	if (!rle) {
+		payload.reserve(snapshot.cells.size() * 2);
+		for (const auto& cell : snapshot.cells) {
+			payload.push_back(static_cast<char>(cell.character));
+			payload.push_back(static_cast<char>(cell.attribute));
 		}
+		return payload;
+	}
+
+	constexpr size_t MaxRunLength = 255;
+	const auto& cells = snapshot.cells;
+	for (size_t i = 0; i < cells.size();) {
+		size_t run = 1;
+		while (i + run < cells.size() && run < MaxRunLength &&
+		       cells[i + run] == cells[i]) {
+			++run;
+		}
+		payload.push_back(static_cast<char>(run));
+		payload.push_back(static_cast<char>(cells[i].character));
+		payload.push_back(static_cast<char>(cells[i].attribute));
+		i += run;
+	}
+	return payload;
+}
+
+void append_full_frame(std::string& out, const Snapshot& snapshot,
+                       const EncodingOptions& options, const char* diff_mode)
+{
+	const auto& sentinel = ensure_sentinel(options);
+
+	append_meta_header(out, snapshot, sentinel);
+	if (diff_mode) {
+		append_meta_line(out, sentinel, "META diff=");
+		out.append(diff_mode);
+		out.push_back('\n');
+	}
+	append_cursor_meta(out, snapshot.cursor, sentinel);
+	append_meta_line(out,
+	                 sentinel,
+	                 options.show_attributes ? "META attributes=show\n"
+	                                         : "META attributes=hide\n");
+	append_keys_meta(out, options.keys_down, sentinel);
+	if (options.generation) {
+		append_meta_line(out, sentinel, "META generation=");
+		append_number(out, *options.generation);
+		out.push_back('\n');
+	}
+	if (options.region) {
+		append_meta_line(out, sentinel, "META region=");
+		append_number(out, options.region->row);
+		out.push_back(',');
+		append_number(out, options.region->column);
+		out.push_back(',');
+		append_number(out, options.region->rows);
+		out.push_back(',');
+		append_number(out, options.region->columns);
+		out.push_back('\n');
+	}
+	if (options.unmatched_cells) {
+		append_meta_line(out, sentinel, "META unmatched=");
+		append_number(out, *options.unmatched_cells);
+		out.push_back('\n');
+	}
+	append_meta_line(out, sentinel, "PAYLOAD\n");
+
+	const auto cols = snapshot.columns;
+	const auto rows = snapshot.rows;
+
+	if (options.show_attributes) {
+		out.append("\x1b[0m");
+	}
+
+	for (uint16_t row = 0; row < rows; ++row) {
+		append_cells(out, snapshot, row, 0, cols, options);
 		if (options.show_attributes) {
-			oss << "\x1b[0m";
+			out.append("\x1b[0m");
 		}
-		oss << '\n';
+		out.push_back('\n');
 		if (options.show_attributes && row + 1 < rows) {
 			// When attributes are enabled, start the next line from a clean slate
-			has_previous_attr = false;
-			oss << "\x1b[0m";
+			out.append("\x1b[0m");
 		}
 	}
+}
 
-	return oss.str();
+} // namespace
+
+void AppendAnsiFrame(const Snapshot& snapshot, const EncodingOptions& options,
+                     std::string& out)
+{
+	out.reserve(out.size() + estimate_frame_size(snapshot));
+	append_full_frame(out, snapshot, options, nullptr);
+}
+
+std::string BuildAnsiFrame(const Snapshot& snapshot, const EncodingOptions& options)
+{
+	std::string frame;
+	AppendAnsiFrame(snapshot, options, frame);
+	return frame;
+}
+
+std::string BuildPlainText(const Snapshot& snapshot,
+                           const std::optional<TextRegion>& region)
+{
+	const auto area = ClipRegion(region.value_or(TextRegion{0, 0, snapshot.rows, snapshot.columns}),
+	                             snapshot.columns,
+	                             snapshot.rows);
+
+	const auto& glyphs = encoding_tables().glyphs;
+
+	std::string text;
+	text.reserve(static_cast<size_t>(area.rows) * (area.columns * 3 + 1));
+	for (uint16_t row = area.row; row < area.row + area.rows; ++row) {
+		const size_t base = static_cast<size_t>(row) * snapshot.columns;
+		for (uint16_t col = area.column; col < area.column + area.columns; ++col) {
+			text.append(glyphs[snapshot.cells[base + col].character]);
+		}
+		text.push_back('\n');
+	}
+	return text;
+}
+
+std::string BuildBinaryFrame(const Snapshot& snapshot,
+                             const EncodingOptions& options, const bool rle)
+{
+	std::string keys;
+	for (size_t i = 0; i < options.keys_down.size(); ++i) {
+		if (i > 0) {
+			keys.push_back(',');
+		}
+		keys.append(options.keys_down[i]);
+	}
+	if (keys.size() > UINT16_MAX) {
+		keys.resize(UINT16_MAX);
+	}
+
+	const auto payload = build_cell_payload(snapshot, rle);
+
+	uint8_t flags = rle ? BinaryFlagRle : 0;
+	if (snapshot.cursor.enabled) {
+		flags |= BinaryFlagCursorEnabled;
+	}
+	if (snapshot.cursor.visible) {
+		flags |= BinaryFlagCursorVisible;
+	}
+
+	std::string frame;
+	frame.reserve(BinaryFrameHeaderSize + keys.size() + payload.size());
+	frame.append("TMBF");
+	frame.push_back(static_cast<char>(BinaryFrameVersion));
+	frame.push_back(static_cast<char>(flags));
+	append_le16(frame, snapshot.columns);
+	append_le16(frame, snapshot.rows);
+	append_le16(frame, snapshot.cursor.row);
+	append_le16(frame, snapshot.cursor.column);
+	append_le32(frame, static_cast<uint32_t>(payload.size()));
+	append_le16(frame, static_cast<uint16_t>(keys.size()));
+	frame.append(keys);
+	frame.append(payload);
+	return frame;
+}
+
+std::string BuildAnsiDiff(const FrameBaseline* previous, const Snapshot& current,
+                          const EncodingOptions& options)
+{
+	const bool geometry_matches = previous &&
+	                              previous->snapshot.columns == current.columns &&
+	                              previous->snapshot.rows == current.rows &&
+	                              previous->snapshot.cells.size() ==
+	                                      current.cells.size();
+	std::string out;
+	out.reserve(estimate_frame_size(current));
+	if (!geometry_matches) {
+		append_full_frame(out, current, options, "full");
+		return out;
+	}
+
+	const auto scroll    = find_scroll(previous->snapshot, current);
+	const auto runs      = find_changed_runs(previous->snapshot, current, scroll);
+	const auto& sentinel = ensure_sentinel(options);
+
+	append_meta_header(out, current, sentinel);
+	append_meta_line(out, sentinel, "META diff=delta\n");
+	if (previous->snapshot.cursor != current.cursor) {
+		append_cursor_meta(out, current.cursor, sentinel);
+	}
+	if (previous->keys_down != options.keys_down) {
+		append_keys_meta(out, options.keys_down, sentinel);
+	}
+	append_meta_line(out, sentinel, "META runs=");
+	append_number(out, runs.size());
+	out.push_back('\n');
+	append_meta_line(out, sentinel, "PAYLOAD\n");
+
+	if (scroll != 0) {
+		append_meta_line(out, sentinel, "SCROLL ");
+		if (scroll < 0) {
+			out.push_back('-');
+		}
+		append_number(out, static_cast<uint64_t>(std::abs(scroll)));
+		out.push_back('\n');
+	}
+	for (const auto& run : runs) {
+		append_meta_line(out, sentinel, "RUN ");
+		append_number(out, run.row);
+		out.push_back(',');
+		append_number(out, run.col);
+		out.push_back(',');
+		append_number(out, run.len);
+		out.push_back('\n');
+		append_cells(out,
+		             current,
+		             run.row,
+		             run.col,
+		             static_cast<uint16_t>(run.col + run.len),
+		             options);
+		if (options.show_attributes) {
+			out.append("\x1b[0m");
+		}
+		out.push_back('\n');
+	}
+
+	return out;
 }
 
 } // namespace textmode
@@ -6,6 +6,8 @@
 
 #include "textmode_server/snapshot.h"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -15,10 +17,67 @@ struct EncodingOptions {
 	bool show_attributes = true;
 	std::string sentinel = "\xF0\x9F\x96\xB5"; // 🖵
 	std::vector<std::string> keys_down = {};
+	// Emitted as 'META generation=N' when set (GET IFCHANGED replies)
+	std::optional<uint64_t> generation = {};
+	// Emitted as 'META region=row,col,rows,cols' when the frame only
+	// covers part of the screen
+	std::optional<TextRegion> region = {};
+	// Emitted as 'META unmatched=N' for text read off a graphics screen,
+	// counting the cells that matched no glyph
+	std::optional<uint32_t> unmatched_cells = {};
+};
+
+// The last frame delivered to a client, used as the reference for DIFF
+struct FrameBaseline {
+	Snapshot snapshot                  = {};
+	std::vector<std::string> keys_down = {};
 };
 
 std::string BuildAnsiFrame(const Snapshot& snapshot, const EncodingOptions& options);
 
+// Same as BuildAnsiFrame() but appends to 'out', so callers that encode
+// repeatedly can keep one pre-reserved buffer.
+void AppendAnsiFrame(const Snapshot& snapshot, const EncodingOptions& options,
+                     std::string& out);
+
+// The characters of 'region' (or the whole screen) as UTF-8, one line per
+// row with no metadata or attributes. Used for server-side text matching.
+std::string BuildPlainText(const Snapshot& snapshot,
+                           const std::optional<TextRegion>& region = {});
+
+// Encodes only the cells that changed since 'previous'. Falls back to a full
+// frame (tagged 'META diff=full') when there is no baseline or the geometry
+// changed.
+std::string BuildAnsiDiff(const FrameBaseline* previous, const Snapshot& current,
+                          const EncodingOptions& options);
+
+// Binary cell stream, all multi-byte fields little-endian:
+//
+//   offset  size  field
+//   0       4     magic "TMBF"
+//   4       1     version (1)
+//   5       1     flags (BinaryFlag*)
+//   6       2     columns
+//   8       2     rows
+//   10      2     cursor row
+//   12      2     cursor column
+//   14      4     cell payload length in bytes
+//   18      2     keys_down length in bytes
+//   20      ...   keys_down (comma-separated), then the cell payload
+//
+// The raw payload is columns * rows (character, attribute) pairs. With
+// BinaryFlagRle set it is a sequence of (count, character, attribute)
+// triplets with 1 <= count <= 255.
+constexpr uint8_t BinaryFrameVersion  = 1;
+constexpr size_t BinaryFrameHeaderSize = 20;
+
+constexpr uint8_t BinaryFlagCursorEnabled = 1 << 0;
+constexpr uint8_t BinaryFlagCursorVisible = 1 << 1;
+constexpr uint8_t BinaryFlagRle           = 1 << 2;
+
+std::string BuildBinaryFrame(const Snapshot& snapshot,
+                             const EncodingOptions& options, bool rle);
+
 } // namespace textmode
 
 #endif // DOSBOX_TEXTMODE_ENCODER_H
@@ -0,0 +1,219 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/graphics_text.h"
+
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "hardware/memory.h"
+#include "ints/int10.h"
+
+namespace textmode {
+
+namespace {
+
+constexpr uint32_t CellWidth = 8;
+
+// Taller fonts than this aren't used by any BIOS
+constexpr uint8_t MaxGlyphHeight = 32;
+
+// The attribute of text that matched no glyph
+constexpr uint8_t BlankAttribute = 0x07;
+
+// FNV-1a
+uint64_t hash_rows(const uint8_t* rows, const uint8_t height)
+{
+	uint64_t hash = 0xcbf29ce484222325;
+	for (uint8_t i = 0; i < height; ++i) {
+		hash ^= rows[i];
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+// Printable ASCII first, so blanks read as spaces and look-alikes as the
+// letters they look like
+constexpr std::array<uint8_t, 256> make_character_order()
+{
+	std::array<uint8_t, 256> order = {};
+
+	size_t i = 0;
+	for (int c = 0x20; c < 0x7f; ++c) {
+		order[i++] = static_cast<uint8_t>(c);
+	}
+	for (int c = 0x80; c < 0x100; ++c) {
+		order[i++] = static_cast<uint8_t>(c);
+	}
+	for (int c = 0; c < 0x20; ++c) {
+		order[i++] = static_cast<uint8_t>(c);
+	}
+	order[i] = 0x7f;
+	return order;
+}
+
+uint8_t make_attribute(const uint8_t background, const uint8_t foreground)
+{
+	return static_cast<uint8_t>(((background & 0x0f) << 4) | (foreground & 0x0f));
+}
+
+} // namespace
+
+GlyphIndex::GlyphIndex(std::vector<uint8_t> glyphs, const uint8_t height)
+        : m_glyphs(std::move(glyphs)),
+          m_height(height)
+{
+	assert(m_height > 0 && m_height <= MaxGlyphHeight);
+	assert(m_glyphs.size() == 256 * static_cast<size_t>(m_height));
+
+	static constexpr auto CharacterOrder = make_character_order();
+
+	m_characters.reserve(256);
+	for (const auto character : CharacterOrder) {
+		const auto glyph = &m_glyphs[character * static_cast<size_t>(m_height)];
+		m_characters.try_emplace(hash_rows(glyph, m_height), character);
+	}
+}
+
+std::optional<uint8_t> GlyphIndex::Find(const uint8_t* cell) const
+{
+	const auto it = m_characters.find(hash_rows(cell, m_height));
+	if (it == m_characters.end()) {
+		return std::nullopt;
+	}
+	const auto glyph = &m_glyphs[it->second * static_cast<size_t>(m_height)];
+	if (std::memcmp(glyph, cell, m_height) != 0) {
+		return std::nullopt;
+	}
+	return it->second;
+}
+
+GraphicsText ReadGraphicsText(const IndexedFrame& frame, const GlyphIndex& font)
+{
+	const auto height = font.Height();
+
+	GraphicsText text = {};
+
+	auto& snapshot   = text.snapshot;
+	snapshot.columns = static_cast<uint16_t>(frame.width / CellWidth);
+	snapshot.rows    = static_cast<uint16_t>(frame.height / height);
+	snapshot.cells.resize(static_cast<size_t>(snapshot.columns) * snapshot.rows);
+
+	const auto pixel_at = [&](const uint32_t x, const uint32_t y) {
+		auto offset = frame.start + y * frame.stride + x;
+		if (frame.wrap_mask) {
+			offset &= frame.wrap_mask;
+		}
+		return frame.pixels[offset];
+	};
+
+	std::array<uint8_t, MaxGlyphHeight> rows = {};
+
+	for (uint16_t row = 0; row < snapshot.rows; ++row) {
+		for (uint16_t column = 0; column < snapshot.columns; ++column) {
+			const auto x = column * CellWidth;
+			const auto y = row * static_cast<uint32_t>(height);
+
+			// Everything that isn't the top left pixel's color is
+			// taken as the foreground
+			const auto background = pixel_at(x, y);
+			auto foreground       = background;
+			bool is_two_colored   = true;
+
+			for (uint8_t line = 0; line < height && is_two_colored; ++line) {
+				uint8_t bits = 0;
+				for (uint32_t i = 0; i < CellWidth; ++i) {
+					const auto pixel = pixel_at(x + i, y + line);
+					if (pixel == background) {
+						continue;
+					}
+					if (foreground == background) {
+						foreground = pixel;
+					} else if (pixel != foreground) {
+						is_two_colored = false;
+						break;
+					}
+					bits |= static_cast<uint8_t>(0x80 >> i);
+				}
+				rows[line] = bits;
+			}
+
+			auto& cell = snapshot.cells[static_cast<size_t>(row) *
+			                                    snapshot.columns +
+			                            column];
+			if (!is_two_colored) {
+				cell = {' ', BlankAttribute};
+				++text.unmatched_cells;
+				continue;
+			}
+
+			if (const auto character = font.Find(rows.data())) {
+				// A plain cell has no foreground of its own
+				const auto is_plain = (foreground == background);
+				const auto fg = is_plain ? BlankAttribute : foreground;
+				cell = {*character, make_attribute(background, fg)};
+				continue;
+			}
+
+			// Glyphs that fill their top left pixel, such as blocks
+			for (uint8_t line = 0; line < height; ++line) {
+				rows[line] = static_cast<uint8_t>(~rows[line]);
+			}
+			if (const auto character = font.Find(rows.data())) {
+				cell = {*character,
+				        make_attribute(foreground, background)};
+				continue;
+			}
+
+			cell = {' ', BlankAttribute};
+			++text.unmatched_cells;
+		}
+	}
+	return text;
+}
+
+std::optional<GraphicsText> CaptureGraphicsText(const VgaType& state)
+{
+	// The line drawers read these modes from 'linear_base' a byte per
+	// pixel
+	switch (state.mode) {
+	case M_EGA:
+	case M_LIN4:
+	case M_VGA:
+	case M_LIN8: break;
+	default: return std::nullopt;
+	}
+	if (!state.draw.linear_base || !state.draw.address_add) {
+		return std::nullopt;
+	}
+
+	// The BIOS draws graphics mode text with the font INT 43h points to,
+	// which INT 10h function 11h can replace
+	const auto height = real_readb(BIOSMEM_SEG, BIOSMEM_CHAR_HEIGHT);
+	if (height == 0 || height > MaxGlyphHeight) {
+		return std::nullopt;
+	}
+	std::vector<uint8_t> glyphs(256 * static_cast<size_t>(height));
+	MEM_BlockRead(RealToPhysical(RealGetVec(0x43)), glyphs.data(), glyphs.size());
+	const GlyphIndex font(std::move(glyphs), height);
+
+	const auto start = (state.config.real_start + state.draw.bytes_skip) *
+	                   state.draw.byte_panning_shift;
+
+	IndexedFrame frame = {};
+	frame.pixels       = state.draw.linear_base;
+	frame.width        = CurMode->swidth;
+	frame.height       = CurMode->sheight;
+	frame.start        = static_cast<uint32_t>(start);
+	frame.stride       = static_cast<uint32_t>(state.draw.address_add);
+	frame.wrap_mask    = static_cast<uint32_t>(state.draw.linear_mask);
+
+	if (frame.width < CellWidth || frame.height < height) {
+		return std::nullopt;
+	}
+	return ReadGraphicsText(frame, font);
+}
+
+} // namespace textmode
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEXTMODE_GRAPHICS_TEXT_H
+#define DOSBOX_TEXTMODE_GRAPHICS_TEXT_H
+
+#include "hardware/video/vga.h"
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "textmode_server/snapshot.h"
+
+namespace textmode {
+
+// Text drawn in graphics modes
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Installers and game menus often print through the BIOS in a graphics
+// mode, which draws each character as its font glyph on an 8 pixel wide
+// character grid. Reading the screen back cell by cell and looking each
+// cell's pixels up among the font's glyphs recovers that text without
+// rendering an image and running OCR over it.
+//
+// A cell matches when its pixels take at most two colors and the pixels
+// of one of them form a glyph. Text drawn in other fonts, off the grid or
+// over pictures doesn't match and is left blank.
+
+// Recognises the characters of a 256-character bitmap font by their glyphs
+class GlyphIndex {
+public:
+	// 'glyphs' holds 256 glyphs of 'height' rows, one byte per row with
+	// the leftmost pixel in the top bit
+	GlyphIndex(std::vector<uint8_t> glyphs, uint8_t height);
+
+	uint8_t Height() const
+	{
+		return m_height;
+	}
+
+	// The character whose glyph is the 'Height()' rows of 'cell'. Where
+	// several characters share a glyph, printable ASCII wins.
+	std::optional<uint8_t> Find(const uint8_t* cell) const;
+
+private:
+	std::vector<uint8_t> m_glyphs = {};
+	uint8_t m_height              = 0;
+
+	// Keyed by a hash of the glyph's rows, which is checked on lookup
+	std::unordered_map<uint64_t, uint8_t> m_characters = {};
+};
+
+// A graphics screen stored one byte per pixel, as the EGA and VGA line
+// drawers see it
+struct IndexedFrame {
+	const uint8_t* pixels = nullptr;
+	uint32_t width        = 0;
+	uint32_t height       = 0;
+	// Offset of the top left pixel and the distance between rows
+	uint32_t start  = 0;
+	uint32_t stride = 0;
+	// Offsets wrap around at this mask; 0 leaves them unwrapped
+	uint32_t wrap_mask = 0;
+};
+
+struct GraphicsText {
+	Snapshot snapshot = {};
+	// Cells that showed something other than a glyph or a plain color
+	uint32_t unmatched_cells = 0;
+};
+
+// Reads 'frame' as a grid of 8 pixel wide cells as tall as the font's
+// glyphs. A matched cell's attribute holds the low four bits of its
+// background and foreground colors; unmatched cells become blanks.
+GraphicsText ReadGraphicsText(const IndexedFrame& frame, const GlyphIndex& font);
+
+// Reads the current graphics screen with the font the BIOS draws graphics
+// mode text in. Empty unless the adapter shows a 16 or 256-color EGA, VGA
+// or VESA mode.
+std::optional<GraphicsText> CaptureGraphicsText(const VgaType& state);
+
+} // namespace textmode
+
+#endif // DOSBOX_TEXTMODE_GRAPHICS_TEXT_H
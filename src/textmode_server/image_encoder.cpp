@@ -0,0 +1,298 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/image_encoder.h"
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+#include <zlib.h>
+
+namespace textmode {
+
+namespace {
+
+void append_be32(std::string& out, const uint32_t value)
+{
+	out.push_back(static_cast<char>(value >> 24));
+	out.push_back(static_cast<char>(value >> 16));
+	out.push_back(static_cast<char>(value >> 8));
+	out.push_back(static_cast<char>(value));
+}
+
+void append_png_chunk(std::string& out, const char* type, const std::string& data)
+{
+	append_be32(out, static_cast<uint32_t>(data.size()));
+	const auto type_offset = out.size();
+	out.append(type, 4);
+	out.append(data);
+
+	const auto checked = reinterpret_cast<const Bytef*>(out.data() + type_offset);
+	const auto crc     = crc32(crc32(0, Z_NULL, 0),
+                               checked,
+                               static_cast<uInt>(4 + data.size()));
+	append_be32(out, static_cast<uint32_t>(crc));
+}
+
+struct QoiPixel {
+	uint8_t r = 0;
+	uint8_t g = 0;
+	uint8_t b = 0;
+
+	bool operator==(const QoiPixel&) const = default;
+};
+
+QoiPixel pixel_at(const FrameImage& image, const size_t index)
+{
+	if (image.indexed) {
+		const auto entry = static_cast<size_t>(image.pixels[index]) * 3;
+		return {image.palette[entry], image.palette[entry + 1], image.palette[entry + 2]};
+	}
+	return {image.pixels[index * 3], image.pixels[index * 3 + 1], image.pixels[index * 3 + 2]};
+}
+
+} // namespace
+
+FrameImage ScaleImage(const FrameImage& image, const uint8_t factor)
+{
+	if (factor <= 1) {
+		return image;
+	}
+	const size_t bytes_per_pixel = image.indexed ? 1 : 3;
+
+	FrameImage scaled = {};
+	scaled.width      = static_cast<uint16_t>(image.width * factor);
+	scaled.height     = static_cast<uint16_t>(image.height * factor);
+	scaled.indexed    = image.indexed;
+	scaled.palette    = image.palette;
+	scaled.pixels.reserve(static_cast<size_t>(scaled.width) * scaled.height *
+	                      bytes_per_pixel);
+
+	std::vector<uint8_t> row = {};
+	for (uint16_t y = 0; y < image.height; ++y) {
+		row.clear();
+		const auto source = image.pixels.data() +
+		                    static_cast<size_t>(y) * image.width * bytes_per_pixel;
+		for (uint16_t x = 0; x < image.width; ++x) {
+			const auto pixel = source + x * bytes_per_pixel;
+			for (uint8_t i = 0; i < factor; ++i) {
+				row.insert(row.end(), pixel, pixel + bytes_per_pixel);
+			}
+		}
+		for (uint8_t i = 0; i < factor; ++i) {
+			scaled.pixels.insert(scaled.pixels.end(), row.begin(), row.end());
+		}
+	}
+	return scaled;
+}
+
+std::string EncodePng(const FrameImage& image)
+{
+	const size_t bytes_per_pixel = image.indexed ? 1 : 3;
+	const size_t row_bytes       = static_cast<size_t>(image.width) * bytes_per_pixel;
+
+	// Every row gets filter type 0 (none); the fastest deflate level still
+	// collapses the long runs DOS frames are made of
+	std::vector<uint8_t> filtered;
+	filtered.reserve((row_bytes + 1) * image.height);
+	for (uint16_t y = 0; y < image.height; ++y) {
+		filtered.push_back(0);
+		const auto row = image.pixels.begin() + static_cast<ptrdiff_t>(y * row_bytes);
+		filtered.insert(filtered.end(), row, row + static_cast<ptrdiff_t>(row_bytes));
+	}
+
+	auto compressed_size = compressBound(static_cast<uLong>(filtered.size()));
+	std::string compressed(compressed_size, '\0');
+	if (compress2(reinterpret_cast<Bytef*>(compressed.data()),
+	              &compressed_size,
+	              filtered.data(),
+	              static_cast<uLong>(filtered.size()),
+	              Z_BEST_SPEED) != Z_OK) {
+		return {};
+	}
+	compressed.resize(compressed_size);
+
+	std::string header = {};
+	append_be32(header, image.width);
+	append_be32(header, image.height);
+	header.push_back(8);                                       // bit depth
+	header.push_back(static_cast<char>(image.indexed ? 3 : 2)); // colour type
+	header.append(3, '\0'); // compression, filter, and interlace methods
+
+	std::string png = "\x89PNG\r\n\x1a\n";
+	append_png_chunk(png, "IHDR", header);
+	if (image.indexed) {
+		append_png_chunk(png,
+		                 "PLTE",
+		                 std::string(image.palette.begin(), image.palette.end()));
+	}
+	append_png_chunk(png, "IDAT", compressed);
+	append_png_chunk(png, "IEND", {});
+	return png;
+}
+
+std::string EncodeQoi(const FrameImage& image)
+{
+	constexpr uint8_t OpIndex = 0x00;
+	constexpr uint8_t OpDiff  = 0x40;
+	constexpr uint8_t OpLuma  = 0x80;
+	constexpr uint8_t OpRun   = 0xc0;
+	constexpr uint8_t OpRgb   = 0xfe;
+	constexpr uint8_t MaxRun  = 62;
+
+	const auto num_pixels = static_cast<size_t>(image.width) * image.height;
+
+	std::string qoi = "qoif";
+	qoi.reserve(14 + num_pixels + 8);
+	append_be32(qoi, image.width);
+	append_be32(qoi, image.height);
+	qoi.push_back(3); // RGB
+	qoi.push_back(0); // sRGB with linear alpha
+
+	const auto emit = [&qoi](const int byte) { qoi.push_back(static_cast<char>(byte)); };
+
+	// Pixels are opaque, so the alpha the hash includes is always 255
+	std::array<QoiPixel, 64> seen = {};
+	QoiPixel previous             = {};
+	uint8_t run                   = 0;
+	for (size_t i = 0; i < num_pixels; ++i) {
+		const auto pixel = pixel_at(image, i);
+		if (pixel == previous) {
+			++run;
+			if (run == MaxRun || i + 1 == num_pixels) {
+				emit(OpRun | (run - 1));
+				run = 0;
+			}
+			continue;
+		}
+		if (run > 0) {
+			emit(OpRun | (run - 1));
+			run = 0;
+		}
+
+		const auto hash = (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + 255 * 11) % 64;
+		if (seen[hash] == pixel) {
+			emit(OpIndex | hash);
+		} else {
+			seen[hash] = pixel;
+
+			const auto dr   = static_cast<int8_t>(pixel.r - previous.r);
+			const auto dg   = static_cast<int8_t>(pixel.g - previous.g);
+			const auto db   = static_cast<int8_t>(pixel.b - previous.b);
+			const auto dr_g = static_cast<int8_t>(dr - dg);
+			const auto db_g = static_cast<int8_t>(db - dg);
+			if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+				emit(OpDiff | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+			} else if (dg >= -32 && dg <= 31 && dr_g >= -8 && dr_g <= 7 &&
+			           db_g >= -8 && db_g <= 7) {
+				emit(OpLuma | (dg + 32));
+				emit(((dr_g + 8) << 4) | (db_g + 8));
+			} else {
+				emit(OpRgb);
+				emit(pixel.r);
+				emit(pixel.g);
+				emit(pixel.b);
+			}
+		}
+		previous = pixel;
+	}
+
+	qoi.append(7, '\0');
+	qoi.push_back(1);
+	return qoi;
+}
+
+std::string BuildImageReply(const FrameImage& image, const ImageFormat format)
+{
+	std::string data       = {};
+	std::string properties = {};
+	switch (format) {
+	case ImageFormat::Raw:
+		properties = image.indexed ? " format=raw pixels=indexed8"
+		                           : " format=raw pixels=rgb24";
+		if (image.indexed) {
+			data.assign(image.palette.begin(), image.palette.end());
+		}
+		data.append(image.pixels.begin(), image.pixels.end());
+		break;
+	case ImageFormat::Png:
+		properties = " format=png";
+		data       = EncodePng(image);
+		break;
+	case ImageFormat::Qoi:
+		properties = " format=qoi";
+		data       = EncodeQoi(image);
+		break;
+	}
+	if (data.empty()) {
+		return "ERR image encoding failed\n";
+	}
+	return "IMG width=" + std::to_string(image.width) +
+	       " height=" + std::to_string(image.height) + properties +
+	       " bytes=" + std::to_string(data.size()) + "\n" + data;
+}
+
+ImageEncodeQueue::~ImageEncodeQueue()
+{
+	Drain();
+}
+
+void ImageEncodeQueue::Submit(const uintptr_t client, Job job)
+{
+	std::lock_guard lock(m_mutex);
+	m_tasks.push_back({client, std::move(job)});
+	if (m_running) {
+		return;
+	}
+	// A previous worker that ran out of work has returned or is about to
+	if (m_worker.joinable()) {
+		m_worker.join();
+	}
+	m_running = true;
+	m_worker  = std::thread(&ImageEncodeQueue::Run, this);
+}
+
+std::vector<PushedFrame> ImageEncodeQueue::Collect()
+{
+	std::vector<PushedFrame> done = {};
+	bool idle                     = false;
+	{
+		std::lock_guard lock(m_mutex);
+		done = std::exchange(m_done, {});
+		idle = !m_running;
+	}
+	if (idle && m_worker.joinable()) {
+		m_worker.join();
+	}
+	return done;
+}
+
+void ImageEncodeQueue::Drain()
+{
+	if (m_worker.joinable()) {
+		m_worker.join();
+	}
+}
+
+void ImageEncodeQueue::Run()
+{
+	while (true) {
+		Task task = {};
+		{
+			std::lock_guard lock(m_mutex);
+			if (m_tasks.empty()) {
+				m_running = false;
+				return;
+			}
+			task = std::move(m_tasks.front());
+			m_tasks.pop_front();
+		}
+		auto payload = task.job();
+
+		std::lock_guard lock(m_mutex);
+		m_done.push_back({task.client, std::move(payload)});
+	}
+}
+
+} // namespace textmode
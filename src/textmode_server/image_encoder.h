@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEXTMODE_IMAGE_ENCODER_H
+#define DOSBOX_TEXTMODE_IMAGE_ENCODER_H
+
+#include "textmode_server/command_processor.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace textmode {
+
+// A frame as the emulated video card produced it, before host-side scaling
+// or shaders
+struct FrameImage {
+	uint16_t width  = 0;
+	uint16_t height = 0;
+	// Palette indices when set, RGB triplets otherwise
+	bool indexed                = false;
+	std::vector<uint8_t> pixels = {};
+	// 256 RGB triplets when 'indexed'
+	std::vector<uint8_t> palette = {};
+};
+
+// Nearest-neighbour integer upscale
+FrameImage ScaleImage(const FrameImage& image, uint8_t factor);
+
+// PNG written at the fastest zlib level, paletted when the image is
+std::string EncodePng(const FrameImage& image);
+
+// QOI (https://qoiformat.org), always RGB
+std::string EncodeQoi(const FrameImage& image);
+
+// The GETIMG reply: one "IMG width=W height=H format=F bytes=N" line, then
+// N bytes of image data. Raw data is the 768-byte palette followed by one
+// index per pixel for paletted frames (pixels=indexed8), or RGB triplets
+// otherwise (pixels=rgb24).
+std::string BuildImageReply(const FrameImage& image, ImageFormat format);
+
+// Runs encode jobs in submission order on a worker thread. The thread only
+// lives while there is work, so an idle server stays single-threaded and
+// CLONE can still fork it.
+class ImageEncodeQueue {
+public:
+	using Job = std::function<std::string()>;
+
+	ImageEncodeQueue() = default;
+	~ImageEncodeQueue();
+
+	ImageEncodeQueue(const ImageEncodeQueue&)            = delete;
+	ImageEncodeQueue& operator=(const ImageEncodeQueue&) = delete;
+
+	// 'job' returns the reply for 'client'
+	void Submit(uintptr_t client, Job job);
+
+	// Replies of the jobs that finished since the last call
+	std::vector<PushedFrame> Collect();
+
+	// Blocks until every submitted job has finished
+	void Drain();
+
+private:
+	void Run();
+
+	struct Task {
+		uintptr_t client = 0;
+		Job job          = {};
+	};
+
+	std::mutex m_mutex              = {};
+	std::deque<Task> m_tasks        = {};
+	std::vector<PushedFrame> m_done = {};
+	std::thread m_worker            = {};
+	bool m_running                  = false;
+};
+
+} // namespace textmode
+
+#endif // DOSBOX_TEXTMODE_IMAGE_ENCODER_H
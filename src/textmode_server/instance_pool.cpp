@@ -0,0 +1,215 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/instance_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include "misc/logging.h"
+
+namespace textmode {
+
+InstancePool::InstancePool(const size_t size, PoolHooks hooks,
+                           const std::chrono::milliseconds retry_delay)
+        : m_size(std::max<size_t>(size, 1)),
+          m_hooks(std::move(hooks)),
+          m_retry_delay(retry_delay)
+{
+	assert(m_hooks.launch && m_hooks.send && m_hooks.close);
+}
+
+InstancePool::~InstancePool()
+{
+	// Each instance exits once its link closes
+	for (auto& [_, instance] : m_instances) {
+		instance.process.link->Stop();
+	}
+}
+
+void InstancePool::Assign(const ClientHandle client)
+{
+	if (m_abandoned) {
+		return;
+	}
+	for (auto& [pid, instance] : m_instances) {
+		if (!instance.client) {
+			instance.client    = client;
+			m_assigned[client] = pid;
+			return;
+		}
+	}
+	m_waiting.push_back({client});
+}
+
+void InstancePool::Forward(const ClientHandle client, const std::string& data)
+{
+	if (m_abandoned) {
+		return;
+	}
+	if (const auto it = m_assigned.find(client); it != m_assigned.end()) {
+		const auto pid = it->second;
+		if (!SendToInstance(m_instances.at(pid), data)) {
+			m_hooks.close(client);
+			Discard(pid);
+		}
+		return;
+	}
+	for (auto& waiting : m_waiting) {
+		if (waiting.client == client) {
+			waiting.pending += data;
+			return;
+		}
+	}
+}
+
+void InstancePool::Release(const ClientHandle client)
+{
+	if (m_abandoned) {
+		return;
+	}
+	std::erase_if(m_waiting, [client](const WaitingClient& waiting) {
+		return waiting.client == client;
+	});
+	if (const auto it = m_assigned.find(client); it != m_assigned.end()) {
+		const auto pid = it->second;
+		Discard(pid);
+		++m_recycled;
+	}
+}
+
+void InstancePool::Poll()
+{
+	if (m_abandoned) {
+		return;
+	}
+
+	std::vector<int64_t> exited = {};
+	std::vector<int64_t> failed = {};
+	for (auto& [pid, instance] : m_instances) {
+		for (const auto& event : instance.process.link->Poll()) {
+			if (event.type == BackendEvent::Type::Closed) {
+				exited.push_back(pid);
+			} else if (event.type == BackendEvent::Type::Data && instance.client &&
+			           !m_hooks.send(*instance.client, event.data)) {
+				failed.push_back(pid);
+			}
+		}
+	}
+
+	for (const auto pid : exited) {
+		LOG_WARNING("TEXTMODE: Pool instance %lld exited", static_cast<long long>(pid));
+		failed.push_back(pid);
+	}
+	for (const auto pid : failed) {
+		const auto it = m_instances.find(pid);
+		if (it == m_instances.end()) {
+			continue;
+		}
+		if (const auto client = it->second.client) {
+			m_hooks.close(*client);
+		}
+		Discard(pid);
+	}
+
+	Fill();
+}
+
+PoolStats InstancePool::Stats() const
+{
+	PoolStats stats = {};
+	stats.size      = m_size;
+	stats.busy      = m_assigned.size();
+	stats.warm      = m_instances.size() - m_assigned.size();
+	stats.waiting   = m_waiting.size();
+	stats.launched  = m_launched;
+	stats.recycled  = m_recycled;
+	stats.failed    = m_failed;
+	return stats;
+}
+
+void InstancePool::AbandonAfterFork()
+{
+	for (auto& [_, instance] : m_instances) {
+		instance.process.link->AbandonAfterFork();
+	}
+	m_instances.clear();
+	m_waiting.clear();
+	m_assigned.clear();
+	m_abandoned = true;
+}
+
+void InstancePool::Fill()
+{
+	while (!m_abandoned) {
+		auto warm = std::find_if(m_instances.begin(),
+		                         m_instances.end(),
+		                         [](const auto& entry) {
+			                         return !entry.second.client;
+		                         });
+
+		// Clients that found no warm instance get the first ones ready
+		if (warm != m_instances.end() && !m_waiting.empty()) {
+			auto waiting = std::move(m_waiting.front());
+			m_waiting.pop_front();
+
+			auto& [pid, instance] = *warm;
+			instance.client            = waiting.client;
+			m_assigned[waiting.client] = pid;
+			if (!waiting.pending.empty() && !SendToInstance(instance, waiting.pending)) {
+				m_hooks.close(waiting.client);
+				Discard(pid);
+			}
+			continue;
+		}
+
+		if (m_instances.size() - m_assigned.size() >= m_size) {
+			return;
+		}
+		const auto now = std::chrono::steady_clock::now();
+		if (m_retry_at && now < *m_retry_at) {
+			return;
+		}
+
+		std::string error = {};
+		auto launched     = m_hooks.launch(error);
+		if (m_abandoned) {
+			// This is the new instance
+			return;
+		}
+		if (!launched) {
+			LOG_WARNING("TEXTMODE: Unable to start a pool instance: %s",
+			            error.c_str());
+			++m_failed;
+			m_retry_at = now + m_retry_delay;
+			return;
+		}
+		m_retry_at.reset();
+		++m_launched;
+
+		const auto pid   = launched->pid;
+		m_instances[pid] = Instance{std::move(*launched), {}};
+	}
+}
+
+void InstancePool::Discard(const int64_t pid)
+{
+	const auto it = m_instances.find(pid);
+	if (it == m_instances.end()) {
+		return;
+	}
+	if (const auto client = it->second.client) {
+		m_assigned.erase(*client);
+	}
+	it->second.process.link->Stop();
+	m_instances.erase(it);
+}
+
+bool InstancePool::SendToInstance(Instance& instance, const std::string& data)
+{
+	return instance.process.link->Send(ConnectedClient, data);
+}
+
+} // namespace textmode
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEXTMODE_INSTANCE_POOL_H
+#define DOSBOX_TEXTMODE_INSTANCE_POOL_H
+
+#include "textmode_server/command_processor.h"
+#include "textmode_server/server.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace textmode {
+
+// Instance pool
+// ~~~~~~~~~~~~~
+// With 'pool_size' set, the instance becomes a supervisor: once it is
+// ready it stops its own machine and keeps that many clones of it warm.
+// Every client connecting to its listener from then on is handed a
+// dedicated clone. The supervisor forwards the client's bytes to the clone
+// over a socket pair and the replies back, so clients speak the usual
+// protocol. When the client leaves its clone is discarded and a fresh one
+// forked from the stopped machine takes its place; each client therefore
+// starts from the same ready state, as if a snapshot had been restored.
+//
+// The pool only keeps the books. Launching an instance and the front
+// listener are the caller's, so the tests can drive it without forking.
+
+// A running instance, as seen from the supervisor
+struct PoolInstance {
+	int64_t pid = 0;
+	// The supervisor's end of the socket pair, serving the instance as
+	// client ConnectedClient
+	std::unique_ptr<NetworkBackend> link = {};
+};
+
+struct PoolHooks {
+	// Starts an instance, or returns nothing with 'error' set
+	std::function<std::optional<PoolInstance>(std::string& error)> launch = {};
+	// Sends to and disconnects clients of the front listener
+	std::function<bool(ClientHandle, const std::string&)> send = {};
+	std::function<void(ClientHandle)> close                    = {};
+};
+
+constexpr std::chrono::milliseconds DefaultPoolRetryDelay{1000};
+
+class InstancePool {
+public:
+	// Launches are retried no more than once per 'retry_delay' after one
+	// fails, so a pool that can't start doesn't fork on every poll
+	InstancePool(size_t size, PoolHooks hooks,
+	             std::chrono::milliseconds retry_delay = DefaultPoolRetryDelay);
+	~InstancePool();
+
+	InstancePool(const InstancePool&)            = delete;
+	InstancePool& operator=(const InstancePool&) = delete;
+
+	// Claims a new front client for the next warm instance; clients
+	// arriving while none is warm wait for one, with what they send kept
+	void Assign(ClientHandle client);
+	void Forward(ClientHandle client, const std::string& data);
+	// The client left; its instance is discarded
+	void Release(ClientHandle client);
+
+	// Carries replies back to the clients, notices instances that exited,
+	// and tops the pool up to its size
+	void Poll();
+
+	PoolStats Stats() const;
+
+	// In a freshly forked instance: lets go of the other instances'
+	// links without closing them for the supervisor, and stops every
+	// call in progress from doing more
+	void AbandonAfterFork();
+
+private:
+	struct Instance {
+		PoolInstance process = {};
+		// The front client it serves, if any
+		std::optional<ClientHandle> client = {};
+	};
+
+	struct WaitingClient {
+		ClientHandle client = 0;
+		std::string pending = {};
+	};
+
+	void Fill();
+	void Discard(int64_t pid);
+	bool SendToInstance(Instance& instance, const std::string& data);
+
+	const size_t m_size = 0;
+	PoolHooks m_hooks   = {};
+
+	const std::chrono::milliseconds m_retry_delay = {};
+	std::optional<std::chrono::steady_clock::time_point> m_retry_at = {};
+
+	// By process ID, so the iteration order is stable
+	std::map<int64_t, Instance> m_instances = {};
+	std::deque<WaitingClient> m_waiting     = {};
+	std::map<ClientHandle, int64_t> m_assigned = {};
+
+	uint64_t m_launched = 0;
+	uint64_t m_recycled = 0;
+	uint64_t m_failed   = 0;
+
+	bool m_abandoned = false;
+};
+
+} // namespace textmode
+
+#endif // DOSBOX_TEXTMODE_INSTANCE_POOL_H
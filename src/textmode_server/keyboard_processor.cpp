@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <cctype>
+#include <charconv>
 #if defined(ENABLE_TEXTMODE_QUEUE_TRACE)
 #include <cstdio>
 #include <cstdarg>
@@ -14,12 +15,13 @@
 #include <sstream>
 #include <string_view>
 #include <unordered_map>
+#include <utility>
 
 namespace textmode {
 
 namespace {
 
-using KeyMap = std::unordered_map<std::string, KBD_KEYS>;
+using KeyMap = std::unordered_map<std::string_view, KBD_KEYS>;
 
 #if defined(ENABLE_TEXTMODE_QUEUE_TRACE)
 bool trace_enabled()
@@ -188,21 +190,16 @@ std::optional<KBD_KEYS> map_single_character(const char ch)
 	return std::nullopt;
 }
 
-std::optional<KBD_KEYS> map_f_key(const std::string& name)
+std::optional<KBD_KEYS> map_f_key(std::string_view name)
 {
-	if (name.size() < 2 || name.front() != 'F') {
+	if (name.size() < 2 || name.size() > 3 || name.front() != 'F') {
 		return std::nullopt;
 	}
 
-	const auto number_part = name.substr(1);
-	if (!std::all_of(number_part.begin(), number_part.end(), [](unsigned char c) {
-		return std::isdigit(c) != 0;
-	})) {
-		return std::nullopt;
-	}
-
-	const int value = std::stoi(number_part);
-	if (value < 1 || value > 12) {
+	int value             = 0;
+	const auto [end, ec]  = std::from_chars(name.data() + 1, name.data() + name.size(), value);
+	if (ec != std::errc() || end != name.data() + name.size() || value < 1 ||
+	    value > 12) {
 		return std::nullopt;
 	}
 
@@ -214,14 +211,25 @@ CommandResponse ok_response()
 	return {true, "OK\n"};
 }
 
-CommandResponse error_response(const std::string& message)
+CommandResponse error_response(std::string_view message)
+{
+	std::string payload;
+	payload.reserve(message.size() + 5);
+	payload.append("ERR ").append(message).push_back('\n');
+	return {false, std::move(payload)};
+}
+
+bool equals_ignore_case(std::string_view text, std::string_view upper)
 {
-	return {false, "ERR " + message + "\n"};
+	return text.size() == upper.size() &&
+	       std::equal(text.begin(), text.end(), upper.begin(), [](const char a, const char b) {
+		       return std::toupper(static_cast<unsigned char>(a)) == b;
+	       });
 }
 
 } // namespace
 
-std::string format_display_name(const std::string& token)
+std::string format_display_name(std::string_view token)
 {
 	std::string upper(token);
 	std::transform(upper.begin(),
@@ -260,7 +268,7 @@ std::string format_display_name(const std::string& token)
 	    std::all_of(upper.begin() + 1, upper.end(), [](unsigned char c) {
 		    return std::isdigit(c) != 0;
 	    })) {
-		return "F" + upper.substr(1);
+		return upper;
 	}
 	if (upper.size() == 1) {
 		return std::string(1, upper.front());
@@ -291,7 +299,6 @@ std::string format_display_name(const std::string& token)
 
 KeyboardCommandProcessor::KeyboardCommandProcessor(KeySink sink)
         : m_sink(std::move(sink)),
-          m_pressed(),
           m_commands(0),
           m_success(0),
           m_failures(0)
@@ -306,26 +313,31 @@ CommandResponse KeyboardCommandProcessor::HandleCommand(const std::string& raw_c
 		return error_response("empty command");
 	}
 
+	// Views into the command; typed keys arrive here one at a time, so
+	// nothing is copied until a reply is built
 	const auto space_pos = trimmed.find(' ');
 	const auto verb      = trimmed.substr(0, space_pos);
-	const auto verb_upper = ToUpper(verb);
-	const auto args = (space_pos == std::string::npos)
-	                          ? std::string()
-	                          : Trim(trimmed.substr(space_pos + 1));
-	trace_log("kbd command verb=%s args='%s'\n", verb_upper.c_str(), args.c_str());
+	const auto args      = (space_pos == std::string_view::npos)
+	                             ? std::string_view()
+	                             : Trim(trimmed.substr(space_pos + 1));
+	trace_log("kbd command verb=%.*s args='%.*s'\n",
+	          static_cast<int>(verb.size()),
+	          verb.data(),
+	          static_cast<int>(args.size()),
+	          args.data());
 
 	++m_commands;
 
 	CommandResponse response;
-	if (verb_upper == "PRESS") {
+	if (equals_ignore_case(verb, "PRESS")) {
 		response = HandlePress(args);
-	} else if (verb_upper == "DOWN") {
+	} else if (equals_ignore_case(verb, "DOWN")) {
 		response = HandleDown(args);
-	} else if (verb_upper == "UP") {
+	} else if (equals_ignore_case(verb, "UP")) {
 		response = HandleUp(args);
-	} else if (verb_upper == "RESET") {
+	} else if (equals_ignore_case(verb, "RESET")) {
 		response = HandleReset();
-	} else if (verb_upper == "STATS") {
+	} else if (equals_ignore_case(verb, "STATS")) {
 		response = HandleStats();
 	} else {
 		response = error_response("unknown command");
@@ -344,34 +356,45 @@ CommandResponse KeyboardCommandProcessor::HandleCommand(const std::string& raw_c
 
 void KeyboardCommandProcessor::Reset()
 {
-	for (const auto& entry : m_pressed) {
-		trace_log("kbd reset release key=%d\n", static_cast<int>(entry.first));
-		m_sink(entry.first, false);
+	if (m_active_keys.empty()) {
+		return;
+	}
+	for (size_t key = 0; key < m_pressed.size(); ++key) {
+		if (m_pressed[key].empty()) {
+			continue;
+		}
+		trace_log("kbd reset release key=%d\n", static_cast<int>(key));
+		m_sink(static_cast<KBD_KEYS>(key), false);
+		m_pressed[key].clear();
 	}
-	m_pressed.clear();
+	m_active_keys.clear();
 }
 
-CommandResponse KeyboardCommandProcessor::HandlePress(const std::string& args)
+CommandResponse KeyboardCommandProcessor::HandlePress(std::string_view args)
 {
-	trace_log("kbd press args='%s'\n", args.c_str());
-	std::string remainder;
-	const auto token = FirstToken(args, remainder);
+	trace_log("kbd press args='%.*s'\n", static_cast<int>(args.size()), args.data());
+	std::string_view remainder = {};
+	const auto token           = FirstToken(args, remainder);
 	if (!token) {
 		trace_log("kbd press error missing key\n");
 		return error_response("missing key");
 	}
 	if (!remainder.empty()) {
-		trace_log("kbd press error unexpected args='%s'\n", remainder.c_str());
+		trace_log("kbd press error unexpected args='%.*s'\n",
+		          static_cast<int>(remainder.size()),
+		          remainder.data());
 		return error_response("unexpected arguments");
 	}
 
 	const auto key = ParseKeyName(*token);
 	if (!key) {
-		trace_log("kbd press error unknown token='%s'\n", token->c_str());
+		trace_log("kbd press error unknown token='%.*s'\n",
+		          static_cast<int>(token->size()),
+		          token->data());
 		return error_response("unknown key");
 	}
 
-	if (m_pressed.contains(*key)) {
+	if (!m_pressed[*key].empty()) {
 		trace_log("kbd press error already down key=%d\n", static_cast<int>(*key));
 		return error_response("key already down");
 	}
@@ -382,27 +405,31 @@ CommandResponse KeyboardCommandProcessor::HandlePress(const std::string& args)
 	return ok_response();
 }
 
-CommandResponse KeyboardCommandProcessor::HandleDown(const std::string& args)
+CommandResponse KeyboardCommandProcessor::HandleDown(std::string_view args)
 {
-	trace_log("kbd down args='%s'\n", args.c_str());
-	std::string remainder;
-	const auto token = FirstToken(args, remainder);
+	trace_log("kbd down args='%.*s'\n", static_cast<int>(args.size()), args.data());
+	std::string_view remainder = {};
+	const auto token           = FirstToken(args, remainder);
 	if (!token) {
 		trace_log("kbd down error missing key\n");
 		return error_response("missing key");
 	}
 	if (!remainder.empty()) {
-		trace_log("kbd down error unexpected args='%s'\n", remainder.c_str());
+		trace_log("kbd down error unexpected args='%.*s'\n",
+		          static_cast<int>(remainder.size()),
+		          remainder.data());
 		return error_response("unexpected arguments");
 	}
 
 	const auto key = ParseKeyName(*token);
 	if (!key) {
-		trace_log("kbd down error unknown token='%s'\n", token->c_str());
+		trace_log("kbd down error unknown token='%.*s'\n",
+		          static_cast<int>(token->size()),
+		          token->data());
 		return error_response("unknown key");
 	}
 
-	if (m_pressed.contains(*key)) {
+	if (!m_pressed[*key].empty()) {
 		trace_log("kbd down error already down key=%d\n", static_cast<int>(*key));
 		return error_response("key already down");
 	}
@@ -410,38 +437,43 @@ CommandResponse KeyboardCommandProcessor::HandleDown(const std::string& args)
 	trace_log("kbd down sink key=%d\n", static_cast<int>(*key));
 	m_sink(*key, true);
 	m_pressed[*key] = format_display_name(*token);
+	UpdateActiveKeys();
 	return ok_response();
 }
 
-CommandResponse KeyboardCommandProcessor::HandleUp(const std::string& args)
+CommandResponse KeyboardCommandProcessor::HandleUp(std::string_view args)
 {
-	trace_log("kbd up args='%s'\n", args.c_str());
-	std::string remainder;
-	const auto token = FirstToken(args, remainder);
+	trace_log("kbd up args='%.*s'\n", static_cast<int>(args.size()), args.data());
+	std::string_view remainder = {};
+	const auto token           = FirstToken(args, remainder);
 	if (!token) {
 		trace_log("kbd up error missing key\n");
 		return error_response("missing key");
 	}
 	if (!remainder.empty()) {
-		trace_log("kbd up error unexpected args='%s'\n", remainder.c_str());
+		trace_log("kbd up error unexpected args='%.*s'\n",
+		          static_cast<int>(remainder.size()),
+		          remainder.data());
 		return error_response("unexpected arguments");
 	}
 
 	const auto key = ParseKeyName(*token);
 	if (!key) {
-		trace_log("kbd up error unknown token='%s'\n", token->c_str());
+		trace_log("kbd up error unknown token='%.*s'\n",
+		          static_cast<int>(token->size()),
+		          token->data());
 		return error_response("unknown key");
 	}
 
-	const auto it = m_pressed.find(*key);
-	if (it == m_pressed.end()) {
+	if (m_pressed[*key].empty()) {
 		trace_log("kbd up error key not down key=%d\n", static_cast<int>(*key));
 		return error_response("key not down");
 	}
 
 	trace_log("kbd up sink key=%d\n", static_cast<int>(*key));
 	m_sink(*key, false);
-	m_pressed.erase(it);
+	m_pressed[*key].clear();
+	UpdateActiveKeys();
 	return ok_response();
 }
 
@@ -460,7 +492,7 @@ CommandResponse KeyboardCommandProcessor::HandleStats() const
 	return {true, oss.str()};
 }
 
-std::optional<KBD_KEYS> KeyboardCommandProcessor::ParseKeyName(const std::string& name)
+std::optional<KBD_KEYS> KeyboardCommandProcessor::ParseKeyName(const std::string_view name)
 {
 	if (name.empty()) {
 		return std::nullopt;
@@ -488,7 +520,7 @@ const std::vector<std::string>& KeyboardCommandProcessor::GetKeyNames()
 		const auto& map = get_key_map();
 		result.reserve(map.size() + 26 + 10 + 12);
 		for (const auto& entry : map) {
-			result.push_back(entry.first);
+			result.emplace_back(entry.first);
 		}
 		for (int f = 1; f <= 12; ++f) {
 			result.push_back("F" + std::to_string(f));
@@ -512,38 +544,28 @@ const std::vector<std::string>& KeyboardCommandProcessor::GetKeyNames()
 	return names;
 }
 
-std::string KeyboardCommandProcessor::Trim(std::string_view text)
+std::string_view KeyboardCommandProcessor::Trim(std::string_view text)
 {
 	const auto begin = text.find_first_not_of(" \t\r\n");
 	if (begin == std::string_view::npos) {
 		return {};
 	}
 	const auto end = text.find_last_not_of(" \t\r\n");
-	return std::string(text.substr(begin, end - begin + 1));
+	return text.substr(begin, end - begin + 1);
 }
 
-std::string KeyboardCommandProcessor::ToUpper(std::string_view text)
-{
-	std::string result(text);
-	std::transform(result.begin(),
-	               result.end(),
-	               result.begin(),
-	               [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
-	return result;
-}
-
-std::optional<std::string> KeyboardCommandProcessor::FirstToken(const std::string& args,
-                                                                std::string& remainder_out)
+std::optional<std::string_view> KeyboardCommandProcessor::FirstToken(
+        std::string_view args, std::string_view& remainder_out)
 {
 	const auto trimmed = Trim(args);
 	if (trimmed.empty()) {
-		remainder_out.clear();
+		remainder_out = {};
 		return std::nullopt;
 	}
 
 	const auto pos = trimmed.find_first_of(" \t");
-	if (pos == std::string::npos) {
-		remainder_out.clear();
+	if (pos == std::string_view::npos) {
+		remainder_out = {};
 		return trimmed;
 	}
 
@@ -551,15 +573,20 @@ std::optional<std::string> KeyboardCommandProcessor::FirstToken(const std::strin
 	return trimmed.substr(0, pos);
 }
 
-std::vector<std::string> KeyboardCommandProcessor::ActiveKeys() const
+void KeyboardCommandProcessor::UpdateActiveKeys()
 {
-	std::vector<std::string> keys;
-	keys.reserve(m_pressed.size());
-	for (const auto& entry : m_pressed) {
-		keys.push_back(entry.second);
+	m_active_keys.clear();
+	for (const auto& name : m_pressed) {
+		if (!name.empty()) {
+			m_active_keys.push_back(name);
+		}
 	}
-	std::sort(keys.begin(), keys.end());
-	return keys;
+	std::sort(m_active_keys.begin(), m_active_keys.end());
+}
+
+const std::vector<std::string>& KeyboardCommandProcessor::ActiveKeys() const
+{
+	return m_active_keys;
 }
 
 } // namespace textmode
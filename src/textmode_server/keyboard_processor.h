@@ -8,12 +8,12 @@
 
 #include "hardware/input/keyboard.h"
 
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
-#include <unordered_map>
 #include <vector>
 
 namespace textmode {
@@ -26,24 +26,28 @@ public:
 
 	CommandResponse HandleCommand(const std::string& command) override;
 	void Reset();
-		static std::optional<KBD_KEYS> ParseKeyName(const std::string& name);
-	 	static const std::vector<std::string>& GetKeyNames();
-		std::vector<std::string> ActiveKeys() const;
+	static std::optional<KBD_KEYS> ParseKeyName(std::string_view name);
+	static const std::vector<std::string>& GetKeyNames();
+	// Display names of the held keys, sorted; only rebuilt when a key goes
+	// down or up, so per-frame callers don't allocate
+	const std::vector<std::string>& ActiveKeys() const;
 
 private:
-	CommandResponse HandlePress(const std::string& args);
-	CommandResponse HandleDown(const std::string& args);
-	CommandResponse HandleUp(const std::string& args);
+	CommandResponse HandlePress(std::string_view args);
+	CommandResponse HandleDown(std::string_view args);
+	CommandResponse HandleUp(std::string_view args);
 	CommandResponse HandleReset();
 	CommandResponse HandleStats() const;
 
-	static std::string Trim(std::string_view text);
-	static std::string ToUpper(std::string_view text);
-	static std::optional<std::string> FirstToken(const std::string& args,
-	                                             std::string& remainder_out);
+	static std::string_view Trim(std::string_view text);
+	static std::optional<std::string_view> FirstToken(std::string_view args,
+	                                                  std::string_view& remainder_out);
+	void UpdateActiveKeys();
 
-		KeySink m_sink;
-		std::unordered_map<KBD_KEYS, std::string> m_pressed;
+	KeySink m_sink;
+	// Indexed by KBD_KEYS; empty for keys that are up
+	std::array<std::string, KBD_LAST> m_pressed = {};
+	std::vector<std::string> m_active_keys      = {};
 	uint64_t m_commands = 0;
 	uint64_t m_success  = 0;
 	uint64_t m_failures = 0;
@@ -4,6 +4,7 @@
 #include "textmode_server/memory_access.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <string>
 #include <vector>
@@ -49,15 +50,28 @@ MemoryAccessResult PeekMemoryRegion(const uint32_t offset, const uint32_t length
 	}
 
 	result.bytes.resize(length);
-	for (uint32_t i = 0; i < length; ++i) {
-		uint8_t value = 0;
-		if (mem_readb_checked(static_cast<PhysPt>(offset + i), &value)) {
-			result.error.clear();
-			result.error = "memory read failed";
-			result.bytes.clear();
-			return result;
+	uint32_t copied = 0;
+	while (copied < length) {
+		const auto address = static_cast<PhysPt>(offset + copied);
+		const auto chunk   = std::min(length - copied, PageSize - (address % PageSize));
+
+		// Directly mapped pages are copied straight from host memory; only
+		// handler-backed pages such as VGA memory go byte by byte.
+		if (const auto host = get_tlb_read(address); host) {
+			std::memcpy(result.bytes.data() + copied, host + address, chunk);
+			copied += chunk;
+			continue;
+		}
+		for (uint32_t i = 0; i < chunk; ++i) {
+			uint8_t value = 0;
+			if (mem_readb_checked(address + i, &value)) {
+				result.error = "memory read failed";
+				result.bytes.clear();
+				return result;
+			}
+			result.bytes[copied + i] = value;
 		}
-		result.bytes[i] = value;
+		copied += chunk;
 	}
 
 	result.success = true;
@@ -0,0 +1,646 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dosbox.h"
+#include "misc/logging.h"
+
+#if defined(WIN32)
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <afunix.h>
+#else
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#if defined(LINUX)
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+#endif
+
+namespace textmode {
+
+namespace {
+
+#if defined(WIN32)
+using NativeSocket                  = SOCKET;
+constexpr NativeSocket InvalidSocket = INVALID_SOCKET;
+
+void close_socket(const NativeSocket socket)
+{
+	closesocket(socket);
+}
+
+bool set_non_blocking(const NativeSocket socket)
+{
+	u_long enable = 1;
+	return ioctlsocket(socket, FIONBIO, &enable) == 0;
+}
+
+bool last_call_would_block()
+{
+	return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+
+constexpr int SendFlags = 0;
+#else
+using NativeSocket                  = int;
+constexpr NativeSocket InvalidSocket = -1;
+
+void close_socket(const NativeSocket socket)
+{
+	::close(socket);
+}
+
+bool set_non_blocking(const NativeSocket socket)
+{
+	const int flags = fcntl(socket, F_GETFL, 0);
+	return flags >= 0 && fcntl(socket, F_SETFL, flags | O_NONBLOCK) == 0;
+}
+
+bool last_call_would_block()
+{
+	return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+}
+
+#if defined(MSG_NOSIGNAL)
+constexpr int SendFlags = MSG_NOSIGNAL;
+#else
+constexpr int SendFlags = 0;
+#endif
+#endif
+
+// A socket file left behind by an earlier run would make bind() fail. Only
+// sockets are removed, so a mistyped path cannot delete a regular file.
+void remove_stale_socket(const std::string& path)
+{
+#if defined(WIN32)
+	// AF_UNIX socket files are reparse points on Windows
+	const auto attributes = GetFileAttributesA(path.c_str());
+	if (attributes != INVALID_FILE_ATTRIBUTES &&
+	    (attributes & FILE_ATTRIBUTE_REPARSE_POINT) != 0) {
+		DeleteFileA(path.c_str());
+	}
+#else
+	struct stat info = {};
+	if (lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+		::unlink(path.c_str());
+	}
+#endif
+}
+
+constexpr size_t ReceiveChunkSize = 4096;
+
+// Replies that a client has not read yet are buffered up to this size; a
+// client that falls further behind is disconnected instead of stalling the
+// emulation thread.
+constexpr size_t MaxOutboundBytes = 4 * 1024 * 1024;
+
+struct Readiness {
+	ClientHandle handle = 0; // 0 is the listener
+	bool readable       = false;
+	bool writable       = false;
+	bool failed         = false;
+};
+
+class NativeNetBackend final : public NetworkBackend {
+public:
+	// A non-empty 'socket_path' listens on that Unix domain socket instead
+	// of a TCP port, and a 'connected' socket is served without listening
+	explicit NativeNetBackend(std::string socket_path   = {},
+	                          const NativeSocket connected = InvalidSocket)
+	        : m_socket_path(std::move(socket_path)),
+	          m_connected(connected)
+	{}
+	NativeNetBackend(const NativeNetBackend&)            = delete;
+	NativeNetBackend& operator=(const NativeNetBackend&) = delete;
+
+	~NativeNetBackend() override { Stop(); }
+
+	bool Start(const uint16_t port) override
+	{
+		const auto connected = std::exchange(m_connected, InvalidSocket);
+		Stop();
+
+#if defined(WIN32)
+		WSADATA wsa_data = {};
+		if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+			LOG_WARNING("TEXTMODE: WSAStartup failed");
+			return false;
+		}
+		m_wsa_started = true;
+#endif
+
+		if (connected != InvalidSocket) {
+			m_next_handle = ConnectedClient;
+			if (!open_poller() || !add_client(connected, false)) {
+				close_socket(connected);
+				Stop();
+				return false;
+			}
+			m_announce_connected = true;
+			return true;
+		}
+
+		const bool listening = m_socket_path.empty() ? open_listener(port)
+		                                             : open_local_listener();
+		if (!listening || !open_poller()) {
+			Stop();
+			return false;
+		}
+
+		if (m_socket_path.empty()) {
+			LOG_INFO("TEXTMODE: Listening on port %u (native backend)",
+			         static_cast<unsigned>(port));
+		} else {
+			LOG_INFO("TEXTMODE: Listening on socket '%s'", m_socket_path.c_str());
+		}
+		return true;
+	}
+
+	void Stop() override
+	{
+		std::vector<ClientHandle> handles;
+		handles.reserve(m_clients.size());
+		for (const auto& [handle, _] : m_clients) {
+			handles.push_back(handle);
+		}
+		for (const auto handle : handles) {
+			Close(handle);
+		}
+		if (m_connected != InvalidSocket) {
+			close_socket(m_connected);
+			m_connected = InvalidSocket;
+		}
+		m_announce_connected = false;
+
+		if (m_listener != InvalidSocket) {
+			close_socket(m_listener);
+			m_listener = InvalidSocket;
+			if (!m_socket_path.empty()) {
+				std::remove(m_socket_path.c_str());
+			}
+		}
+
+#if defined(LINUX)
+		if (m_epoll >= 0) {
+			::close(m_epoll);
+			m_epoll = -1;
+		}
+#endif
+
+#if defined(WIN32)
+		if (m_wsa_started) {
+			WSACleanup();
+			m_wsa_started = false;
+		}
+#endif
+	}
+
+	void AbandonAfterFork() override
+	{
+		// Plain closes: deregistering from the epoll instance, shared
+		// with the parent, would stop the parent's notifications too
+		for (const auto& [_, client] : m_clients) {
+			close_socket(client.socket);
+		}
+		m_clients.clear();
+		if (m_connected != InvalidSocket) {
+			close_socket(m_connected);
+			m_connected = InvalidSocket;
+		}
+		m_announce_connected = false;
+
+		if (m_listener != InvalidSocket) {
+			close_socket(m_listener);
+			m_listener = InvalidSocket;
+		}
+#if defined(LINUX)
+		if (m_epoll >= 0) {
+			::close(m_epoll);
+			m_epoll = -1;
+		}
+#endif
+	}
+
+	std::vector<BackendEvent> Poll() override
+	{
+		std::vector<BackendEvent> events;
+		if (m_listener == InvalidSocket && m_clients.empty()) {
+			return events;
+		}
+		if (std::exchange(m_announce_connected, false)) {
+			events.emplace_back(BackendEvent::Connected(ConnectedClient));
+		}
+
+		std::vector<ClientHandle> closed_clients;
+		for (const auto& ready : wait_for_readiness()) {
+			if (ready.handle == 0) {
+				accept_pending(events);
+				continue;
+			}
+
+			auto it = m_clients.find(ready.handle);
+			if (it == m_clients.end()) {
+				continue;
+			}
+			auto& client = it->second;
+
+			bool alive = !ready.failed || ready.readable;
+			if (alive && ready.writable) {
+				alive = flush(ready.handle, client);
+			}
+			if (alive && ready.readable) {
+				alive = receive(ready.handle, client, events);
+			}
+			if (!alive) {
+				closed_clients.push_back(ready.handle);
+			}
+		}
+
+		for (const auto handle : closed_clients) {
+			Close(handle);
+			events.emplace_back(BackendEvent::Closed(handle));
+		}
+
+		return events;
+	}
+
+	bool Send(const ClientHandle handle, const std::string& payload) override
+	{
+		auto it = m_clients.find(handle);
+		if (it == m_clients.end()) {
+			return false;
+		}
+		auto& client = it->second;
+
+		if (client.pending() + payload.size() > MaxOutboundBytes) {
+			LOG_WARNING("TEXTMODE: Client exceeded the %zu byte send queue",
+			            MaxOutboundBytes);
+			return false;
+		}
+
+		client.outbound.append(payload);
+		return flush(handle, client);
+	}
+
+	void SetMaxClients(const size_t max_clients) override
+	{
+		m_max_clients = std::max<size_t>(max_clients, 1);
+	}
+
+	uint64_t RejectedClients() const override { return m_rejected_clients; }
+
+	size_t QueuedBytes(const ClientHandle handle) const override
+	{
+		const auto it = m_clients.find(handle);
+		return it == m_clients.end() ? 0 : it->second.pending();
+	}
+
+	void Close(const ClientHandle handle) override
+	{
+		auto it = m_clients.find(handle);
+		if (it == m_clients.end()) {
+			return;
+		}
+
+#if defined(LINUX)
+		if (m_epoll >= 0) {
+			epoll_ctl(m_epoll, EPOLL_CTL_DEL, it->second.socket, nullptr);
+		}
+#endif
+		close_socket(it->second.socket);
+		m_clients.erase(it);
+	}
+
+private:
+	struct Client {
+		NativeSocket socket   = InvalidSocket;
+		std::string outbound  = {};
+		size_t outbound_sent  = 0;
+		bool watching_writes  = false;
+
+		size_t pending() const { return outbound.size() - outbound_sent; }
+	};
+
+	bool open_listener(const uint16_t port)
+	{
+		m_listener = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+		if (m_listener == InvalidSocket) {
+			LOG_WARNING("TEXTMODE: socket() failed: %s", std::strerror(errno));
+			return false;
+		}
+
+		const int reuse = 1;
+		setsockopt(m_listener,
+		           SOL_SOCKET,
+		           SO_REUSEADDR,
+		           reinterpret_cast<const char*>(&reuse),
+		           sizeof(reuse));
+
+		sockaddr_in address     = {};
+		address.sin_family      = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+		address.sin_port        = htons(port);
+
+		if (bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+		    listen(m_listener, SOMAXCONN) != 0 || !set_non_blocking(m_listener)) {
+			LOG_WARNING("TEXTMODE: Unable to listen on port %u: %s",
+			            static_cast<unsigned>(port),
+			            std::strerror(errno));
+			return false;
+		}
+		return true;
+	}
+
+	bool open_local_listener()
+	{
+		sockaddr_un address = {};
+		address.sun_family  = AF_UNIX;
+		if (m_socket_path.size() >= sizeof(address.sun_path)) {
+			LOG_WARNING("TEXTMODE: Socket path '%s' is too long", m_socket_path.c_str());
+			return false;
+		}
+		std::memcpy(address.sun_path, m_socket_path.data(), m_socket_path.size());
+
+		m_listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (m_listener == InvalidSocket) {
+			LOG_WARNING("TEXTMODE: socket() failed: %s", std::strerror(errno));
+			return false;
+		}
+
+		remove_stale_socket(m_socket_path);
+
+		if (bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+		    listen(m_listener, SOMAXCONN) != 0 || !set_non_blocking(m_listener)) {
+			LOG_WARNING("TEXTMODE: Unable to listen on socket '%s': %s",
+			            m_socket_path.c_str(),
+			            std::strerror(errno));
+			return false;
+		}
+		return true;
+	}
+
+	bool open_poller()
+	{
+#if defined(LINUX)
+		m_epoll = epoll_create1(EPOLL_CLOEXEC);
+		if (m_epoll < 0) {
+			LOG_WARNING("TEXTMODE: epoll_create1 failed: %s", std::strerror(errno));
+			return false;
+		}
+		if (m_listener == InvalidSocket) {
+			return true;
+		}
+		epoll_event event = {};
+		event.events      = EPOLLIN;
+		event.data.u64    = 0;
+		return epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_listener, &event) == 0;
+#else
+		return true;
+#endif
+	}
+
+	void watch_writes(const ClientHandle handle, Client& client, const bool enable)
+	{
+		if (client.watching_writes == enable) {
+			return;
+		}
+		client.watching_writes = enable;
+#if defined(LINUX)
+		epoll_event event = {};
+		event.events      = EPOLLIN | EPOLLRDHUP;
+		if (enable) {
+			event.events |= EPOLLOUT;
+		}
+		event.data.u64    = handle;
+		epoll_ctl(m_epoll, EPOLL_CTL_MOD, client.socket, &event);
+#else
+		(void)handle;
+#endif
+	}
+
+	std::vector<Readiness> wait_for_readiness()
+	{
+		std::vector<Readiness> ready;
+#if defined(LINUX)
+		// Only ready sockets are returned, so idle subscribers cost nothing
+		auto& events = m_epoll_events;
+		events.resize(m_clients.size() + 1);
+		const int count = epoll_wait(m_epoll,
+		                             events.data(),
+		                             static_cast<int>(events.size()),
+		                             0);
+		for (int i = 0; i < count; ++i) {
+			const auto flags = events[i].events;
+			ready.push_back({static_cast<ClientHandle>(events[i].data.u64),
+			                 (flags & (EPOLLIN | EPOLLRDHUP)) != 0,
+			                 (flags & EPOLLOUT) != 0,
+			                 (flags & (EPOLLERR | EPOLLHUP)) != 0});
+		}
+#else
+#if defined(WIN32)
+		using PollEntry = WSAPOLLFD;
+#else
+		using PollEntry = pollfd;
+#endif
+		std::vector<PollEntry> entries;
+		std::vector<ClientHandle> handles;
+		entries.reserve(m_clients.size() + 1);
+		handles.reserve(m_clients.size() + 1);
+
+		if (m_listener != InvalidSocket) {
+			entries.push_back({m_listener, POLLIN, 0});
+			handles.push_back(0);
+		}
+		for (const auto& [handle, client] : m_clients) {
+			const short interest = client.watching_writes ? (POLLIN | POLLOUT)
+			                                              : POLLIN;
+			entries.push_back({client.socket, interest, 0});
+			handles.push_back(handle);
+		}
+
+#if defined(WIN32)
+		const int count = WSAPoll(entries.data(), static_cast<ULONG>(entries.size()), 0);
+#else
+		const int count = poll(entries.data(), static_cast<nfds_t>(entries.size()), 0);
+#endif
+		if (count <= 0) {
+			return ready;
+		}
+		for (size_t i = 0; i < entries.size(); ++i) {
+			const auto flags = entries[i].revents;
+			if (flags == 0) {
+				continue;
+			}
+			ready.push_back({handles[i],
+			                 (flags & POLLIN) != 0,
+			                 (flags & POLLOUT) != 0,
+			                 (flags & (POLLERR | POLLHUP | POLLNVAL)) != 0});
+		}
+#endif
+		return ready;
+	}
+
+	void accept_pending(std::vector<BackendEvent>& events)
+	{
+		while (true) {
+			const NativeSocket socket = accept(m_listener, nullptr, nullptr);
+			if (socket == InvalidSocket) {
+				break;
+			}
+
+			if (m_clients.size() >= m_max_clients) {
+				LOG_WARNING("TEXTMODE: Rejecting client, limit of %zu reached",
+				            m_max_clients);
+				++m_rejected_clients;
+				close_socket(socket);
+				continue;
+			}
+
+			if (const auto handle = add_client(socket, m_socket_path.empty())) {
+				events.emplace_back(BackendEvent::Connected(*handle));
+			} else {
+				close_socket(socket);
+			}
+		}
+	}
+
+	std::optional<ClientHandle> add_client(const NativeSocket socket, const bool is_tcp)
+	{
+		if (!set_non_blocking(socket)) {
+			return {};
+		}
+
+		if (is_tcp) {
+			const int no_delay = 1;
+			setsockopt(socket,
+			           IPPROTO_TCP,
+			           TCP_NODELAY,
+			           reinterpret_cast<const char*>(&no_delay),
+			           sizeof(no_delay));
+		}
+#if defined(SO_NOSIGPIPE)
+		const int no_sigpipe = 1;
+		setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+
+		const auto handle = m_next_handle++;
+#if defined(LINUX)
+		epoll_event event = {};
+		event.events      = EPOLLIN | EPOLLRDHUP;
+		event.data.u64    = handle;
+		if (epoll_ctl(m_epoll, EPOLL_CTL_ADD, socket, &event) != 0) {
+			return {};
+		}
+#endif
+		m_clients.emplace(handle, Client{socket});
+		return handle;
+	}
+
+	// Returns false when the connection is closed or failed
+	bool receive(const ClientHandle handle, Client& client,
+	             std::vector<BackendEvent>& events)
+	{
+		std::string data;
+		char buffer[ReceiveChunkSize];
+		while (true) {
+			const auto received = recv(client.socket, buffer, sizeof(buffer), 0);
+			if (received > 0) {
+				data.append(buffer, static_cast<size_t>(received));
+				continue;
+			}
+			const bool open = received < 0 && last_call_would_block();
+			if (!data.empty()) {
+				events.emplace_back(BackendEvent::Data(handle, std::move(data)));
+			}
+			return open;
+		}
+	}
+
+	// Writes as much of the queue as the socket accepts without blocking and
+	// resumes from the same offset on the next writable notification.
+	bool flush(const ClientHandle handle, Client& client)
+	{
+		while (client.pending() > 0) {
+			const auto remaining = client.pending();
+			const auto sent = send(client.socket,
+			                       client.outbound.data() + client.outbound_sent,
+			                       static_cast<int>(remaining),
+			                       SendFlags);
+			if (sent > 0) {
+				client.outbound_sent += static_cast<size_t>(sent);
+				continue;
+			}
+			if (sent < 0 && last_call_would_block()) {
+				break;
+			}
+			return false;
+		}
+
+		if (client.pending() == 0) {
+			client.outbound.clear();
+			client.outbound_sent = 0;
+		} else if (client.outbound_sent > client.outbound.size() / 2) {
+			client.outbound.erase(0, client.outbound_sent);
+			client.outbound_sent = 0;
+		}
+
+		watch_writes(handle, client, client.pending() > 0);
+		return true;
+	}
+
+	std::string m_socket_path = {};
+	NativeSocket m_listener   = InvalidSocket;
+	// Handed over to the client list by Start()
+	NativeSocket m_connected  = InvalidSocket;
+	bool m_announce_connected = false;
+#if defined(LINUX)
+	int m_epoll = -1;
+	std::vector<epoll_event> m_epoll_events = {};
+#endif
+#if defined(WIN32)
+	bool m_wsa_started = false;
+#endif
+	ClientHandle m_next_handle = 1;
+	std::map<ClientHandle, Client> m_clients = {};
+	size_t m_max_clients        = DefaultMaxClients;
+	uint64_t m_rejected_clients = 0;
+};
+
+} // namespace
+
+std::unique_ptr<NetworkBackend> MakeNativeNetBackend()
+{
+	return std::make_unique<NativeNetBackend>();
+}
+
+std::unique_ptr<NetworkBackend> MakeLocalSocketBackend(const std::string& path)
+{
+	return std::make_unique<NativeNetBackend>(path);
+}
+
+std::unique_ptr<NetworkBackend> MakeConnectedSocketBackend(const intptr_t socket)
+{
+	return std::make_unique<NativeNetBackend>(std::string{},
+	                                          static_cast<NativeSocket>(socket));
+}
+
+} // namespace textmode
@@ -74,6 +74,10 @@ bool is_delay_action(const TypeAction::Kind kind)
 	return kind == TypeAction::Kind::DelayFrames || kind == TypeAction::Kind::DelayMs;
 }
 
+// Programs that mask the keyboard or never read it would otherwise stall
+// the request for good
+constexpr uint32_t MaxKeyboardReadyPolls = 500;
+
 } // namespace
 
 QueuedTypeActionSink::QueuedTypeActionSink(SendCallback send_cb,
@@ -83,7 +87,7 @@ QueuedTypeActionSink::QueuedTypeActionSink(SendCallback send_cb,
           m_close_after_response(false),
           m_token_frame_spacing(0),
           m_next_id(1),
-          m_pending()
+          m_queues()
 {}
 
 CommandResponse QueuedTypeActionSink::Execute(const TypeCommandPlan& plan,
@@ -119,6 +123,7 @@ CommandResponse QueuedTypeActionSink::Execute(const TypeCommandPlan& plan,
 	request.keyboard_handler = keyboard_handler;
 	request.frame_provider   = frame_provider;
 	request.on_complete      = std::move(on_complete);
+	request.enqueued_at      = std::chrono::steady_clock::now();
 
 	const bool defer_response = plan.request_frame || m_close_after_response;
 	request.notify_completion = defer_response;
@@ -127,9 +132,17 @@ CommandResponse QueuedTypeActionSink::Execute(const TypeCommandPlan& plan,
 		request.response_payload = "OK\n";
 	}
 
-	m_pending.push_back(std::move(request));
+	for (size_t i = 0; i < plan.actions.size(); ++i) {
+		if (!is_delay_action(plan.actions[i].kind)) {
+			request.last_key_action = i;
+		}
+	}
+
+	const auto id = request.id;
+	m_queues[origin.client].push_back(std::move(request));
+	m_peak_pending = std::max(m_peak_pending, num_pending());
 trace_log("enqueue id=%llu client=%p deferred=%s frame=%s actions=%zu\n",
-          static_cast<unsigned long long>(m_pending.back().id),
+          static_cast<unsigned long long>(id),
           reinterpret_cast<void*>(origin.client),
           defer_response ? "yes" : "no",
           plan.request_frame ? "yes" : "no",
@@ -138,29 +151,198 @@ trace_log("enqueue id=%llu client=%p deferred=%s frame=%s actions=%zu\n",
 	if (defer_response) {
 		CommandResponse response{true, ""};
 		response.deferred    = true;
-		response.deferred_id = m_pending.back().id;
+		response.deferred_id = id;
 		return response;
 	}
 
 return {true, "OK\n"};
 }
 
+CommandResponse QueuedTypeActionSink::ExecuteWait(const WaitPlan& plan,
+                                                  const CommandOrigin& origin,
+                                                  const FrameProvider& frame_provider,
+                                                  CompletionCallback on_complete)
+{
+	if (!plan.matches || !frame_provider) {
+		if (on_complete) {
+			on_complete(false);
+		}
+		return {false, "ERR service unavailable\n"};
+	}
+
+	PendingWait wait;
+	wait.id             = m_next_id++;
+	wait.origin         = origin;
+	wait.plan           = plan;
+	wait.frame_provider = frame_provider;
+	wait.on_complete    = std::move(on_complete);
+	wait.deadline       = std::chrono::steady_clock::now() + plan.timeout;
+	m_waits.push_back(std::move(wait));
+trace_log("wait enqueue id=%llu client=%p timeout_ms=%lld\n",
+          static_cast<unsigned long long>(m_waits.back().id),
+          reinterpret_cast<void*>(origin.client),
+          static_cast<long long>(plan.timeout.count()));
+
+	CommandResponse response{true, ""};
+	response.deferred    = true;
+	response.deferred_id = m_waits.back().id;
+	return response;
+}
+
+void QueuedTypeActionSink::poll_waits(const std::chrono::steady_clock::time_point now)
+{
+	for (auto it = m_waits.begin(); it != m_waits.end();) {
+		auto& wait = *it;
+
+		// Frames are only fetched and matched once their content has
+		// changed; generation 0 means there's no frame to match yet
+		std::optional<ServiceResult> result = {};
+		uint64_t generation                 = 0;
+		if (wait.plan.generation) {
+			generation = wait.plan.generation();
+		} else {
+			result     = wait.frame_provider();
+			generation = result->generation;
+		}
+		if (generation != 0 && generation != wait.checked_generation) {
+			if (!result) {
+				result = wait.frame_provider();
+			}
+			wait.checked_generation = generation;
+			if (result->success && result->snapshot &&
+			    wait.plan.matches(*result->snapshot)) {
+				finish_wait(wait, true, result->frame);
+				it = m_waits.erase(it);
+				continue;
+			}
+		}
+
+		if (now >= wait.deadline) {
+			finish_wait(wait, false, "ERR WAITFOR timeout\n");
+			it = m_waits.erase(it);
+			continue;
+		}
+		++it;
+	}
+}
+
+void QueuedTypeActionSink::finish_wait(const PendingWait& wait, const bool success,
+                                       const std::string& payload)
+{
+trace_log("wait complete id=%llu success=%s\n",
+          static_cast<unsigned long long>(wait.id),
+          success ? "yes" : "no");
+	bool ok = success;
+	if (m_send && !m_send(wait.origin.client, TagResponse(wait.origin, payload))) {
+		ok = false;
+	}
+	if (m_close_after_response && m_close) {
+		m_close(wait.origin.client);
+	}
+	if (wait.on_complete) {
+		wait.on_complete(ok);
+	}
+}
+
 void QueuedTypeActionSink::SetCloseAfterResponse(const bool enable)
 {
 	m_close_after_response = enable;
 }
 
+size_t QueuedTypeActionSink::num_pending() const
+{
+	size_t pending = 0;
+	for (const auto& [client, queue] : m_queues) {
+		pending += queue.size();
+	}
+	return pending;
+}
+
+QueueTelemetry QueuedTypeActionSink::Telemetry() const
+{
+	return {num_pending(), m_peak_pending, m_wait_latency};
+}
+
 void QueuedTypeActionSink::SetInterTokenFrameDelay(const uint32_t frames)
 {
 	m_token_frame_spacing = frames;
 }
 
+void QueuedTypeActionSink::SetKeyboardReadyProbe(std::function<bool()> probe)
+{
+	m_keyboard_ready = std::move(probe);
+}
+
 void QueuedTypeActionSink::Poll()
+{
+	poll_waits(std::chrono::steady_clock::now());
+
+	// Clients take turns in the order their current requests arrived, so
+	// the keyboard goes to whoever has waited longest
+	std::vector<std::pair<uint64_t, uintptr_t>> turns;
+	turns.reserve(m_queues.size());
+	for (const auto& [client, queue] : m_queues) {
+		turns.emplace_back(queue.front().id, client);
+	}
+	std::sort(turns.begin(), turns.end());
+
+	for (const auto& turn : turns) {
+		poll_client(turn.second);
+	}
+}
+
+void QueuedTypeActionSink::poll_client(const uintptr_t client)
 {
 	auto now = std::chrono::steady_clock::now();
 
-	while (!m_pending.empty()) {
-		auto& request = m_pending.front();
+	for (;;) {
+		const auto queue = m_queues.find(client);
+		if (queue == m_queues.end()) {
+			return;
+		}
+		auto& request = queue->second.front();
+		if (!advance_request(request, now)) {
+			return;
+		}
+
+		const bool success = finalize_request(request);
+		if (request.notify_completion && request.on_complete) {
+			request.on_complete(success);
+		}
+		release_keyboard(request);
+
+		m_wait_latency.Record(std::chrono::steady_clock::now() - request.enqueued_at);
+trace_log("dequeue id=%llu success=%s\n",
+          static_cast<unsigned long long>(request.id),
+          success ? "yes" : "no");
+		queue->second.pop_front();
+		if (queue->second.empty()) {
+			m_queues.erase(queue);
+		}
+		now = std::chrono::steady_clock::now();
+	}
+}
+
+bool QueuedTypeActionSink::acquire_keyboard(const PendingRequest& request)
+{
+	if (m_keyboard_owner != 0 && m_keyboard_owner != request.id) {
+		return false;
+	}
+	m_keyboard_owner = request.id;
+	return true;
+}
+
+void QueuedTypeActionSink::release_keyboard(const PendingRequest& request)
+{
+	if (m_keyboard_owner == request.id) {
+		m_keyboard_owner = 0;
+	}
+}
+
+bool QueuedTypeActionSink::advance_request(PendingRequest& request,
+                                           const std::chrono::steady_clock::time_point now)
+{
+	for (;;) {
 trace_log("poll id=%llu next=%zu frames=%u resume=%s client=%p\n",
           static_cast<unsigned long long>(request.id),
           request.next_action,
@@ -174,57 +356,74 @@ trace_log("poll id=%llu next=%zu frames=%u resume=%s client=%p\n",
 trace_log("wait id=%llu frames_remaining=%u\n",
           static_cast<unsigned long long>(request.id),
           request.frames_remaining);
-				break;
+				return false;
 			}
 		}
 
+		if (request.awaiting_keyboard_ready) {
+			if (!m_keyboard_ready() &&
+			    ++request.keyboard_ready_polls < MaxKeyboardReadyPolls) {
+				return false;
+			}
+trace_log("keyboard ready id=%llu polls=%u\n",
+          static_cast<unsigned long long>(request.id),
+          request.keyboard_ready_polls);
+			request.awaiting_keyboard_ready = false;
+			request.keyboard_ready_polls    = 0;
+		}
+
 		if (request.resume_at.has_value()) {
 			if (now < *request.resume_at) {
 trace_log("wait id=%llu resume_pending\n",
           static_cast<unsigned long long>(request.id));
-				break;
+				return false;
 			}
 			request.resume_at.reset();
 		}
 
-		bool advanced = false;
 		while (request.next_action < request.plan.actions.size()) {
 			const auto& action = request.plan.actions[request.next_action];
 
 			if (action.kind == TypeAction::Kind::DelayFrames && action.frames == 0) {
 				++request.next_action;
-				advanced = true;
 				continue;
 			}
 			if (action.kind == TypeAction::Kind::DelayMs && action.delay_ms.count() <= 0) {
 				++request.next_action;
-				advanced = true;
 				continue;
 			}
 
 			switch (action.kind) {
 			case TypeAction::Kind::Press:
-				request.saw_key_action = true;
-#if defined(__clang__) || defined(__GNUC__)
-				[[fallthrough]];
-#endif
 			case TypeAction::Kind::Down:
 			case TypeAction::Kind::Up: {
+				if (!acquire_keyboard(request)) {
+trace_log("action id=%llu waiting for keyboard owner=%llu\n",
+          static_cast<unsigned long long>(request.id),
+          static_cast<unsigned long long>(m_keyboard_owner));
+					return false;
+				}
+				if (action.kind == TypeAction::Kind::Press) {
+					request.saw_key_action = true;
+				}
 				send_keyboard_action(request.keyboard_handler, action.kind, action.key);
 trace_log("action id=%llu kind=%d key=%s\n",
           static_cast<unsigned long long>(request.id),
           static_cast<int>(action.kind),
           action.key.c_str());
 				++request.next_action;
-				advanced = true;
+				if (request.next_action > request.last_key_action) {
+					release_keyboard(request);
+				}
 				const bool next_is_delay = (request.next_action < request.plan.actions.size() &&
 				                          is_delay_action(request.plan.actions[request.next_action].kind));
-				if (!next_is_delay && m_token_frame_spacing > 0) {
+				if (!next_is_delay && m_keyboard_ready) {
+					request.awaiting_keyboard_ready = true;
+				} else if (!next_is_delay && m_token_frame_spacing > 0) {
 					request.frames_remaining = m_token_frame_spacing;
 trace_log("action id=%llu inserted inter-token frames=%u\n",
           static_cast<unsigned long long>(request.id),
           m_token_frame_spacing);
-					break;
 				}
 				break;
 			}
@@ -234,7 +433,6 @@ trace_log("delay id=%llu ms=%lld\n",
           static_cast<unsigned long long>(request.id),
           static_cast<long long>(action.delay_ms.count()));
 				++request.next_action;
-				advanced = true;
 				break;
 			case TypeAction::Kind::DelayFrames:
 				request.frames_remaining = action.frames;
@@ -242,125 +440,111 @@ trace_log("delay id=%llu frames=%u\n",
           static_cast<unsigned long long>(request.id),
           action.frames);
 				++request.next_action;
-				advanced = true;
-				break;
-			}
-
-			if (action.kind != TypeAction::Kind::Press &&
-			    action.kind != TypeAction::Kind::Down &&
-			    action.kind != TypeAction::Kind::Up) {
-				break;
-			}
-
-			if (request.frames_remaining > 0 || request.resume_at.has_value()) {
 				break;
 			}
 
-			// only process one key action per poll
+			// only process one key action or delay per poll
 			break;
 		}
 
-		if (request.next_action >= request.plan.actions.size() &&
-		    request.frames_remaining == 0 &&
-		    !request.resume_at.has_value()) {
-			if (request.saw_key_action && !request.final_frame_wait_inserted) {
-				const uint32_t wait_frames = std::max<uint32_t>(1, m_token_frame_spacing);
-				request.frames_remaining        = wait_frames;
-				request.final_frame_wait_inserted = true;
+		if (request.next_action < request.plan.actions.size() ||
+		    request.frames_remaining > 0 || request.resume_at.has_value() ||
+		    request.awaiting_keyboard_ready) {
+			return false;
+		}
+
+		if (request.saw_key_action && !request.final_frame_wait_inserted) {
+			const uint32_t wait_frames = std::max<uint32_t>(1, m_token_frame_spacing);
+			request.final_frame_wait_inserted = true;
+			if (m_keyboard_ready) {
+				request.awaiting_keyboard_ready = true;
+				continue;
+			}
+			request.frames_remaining = wait_frames;
 trace_log("final-wait id=%llu frames=%u\n",
           static_cast<unsigned long long>(request.id),
           wait_frames);
-				continue;
-			}
+			continue;
+		}
+		return true;
+	}
+}
 
-			const bool success = [&] {
+bool QueuedTypeActionSink::finalize_request(const PendingRequest& request)
+{
 trace_log("complete id=%llu frame=%s send_response=%s\n",
           static_cast<unsigned long long>(request.id),
           request.plan.request_frame ? "yes" : "no",
           request.send_response ? "yes" : "no");
-				bool ok = true;
-
-				if (request.plan.request_frame) {
-					std::string payload;
-					if (!request.frame_provider) {
-						payload = "ERR service unavailable\n";
-						ok      = false;
-					} else {
-						const auto result = request.frame_provider();
-						if (!result.success) {
-							payload = "ERR " + result.error + "\n";
-							ok      = false;
-						} else {
-							payload = result.frame;
-						}
-					}
-
-					if (m_send) {
-						if (!m_send(request.origin.client, payload)) {
-							ok = false;
-						}
-					}
-
-					if (m_close_after_response && m_close) {
-						m_close(request.origin.client);
-trace_log("close id=%llu client=%p\n",
-          static_cast<unsigned long long>(request.id),
-          reinterpret_cast<void*>(request.origin.client));
-					}
+	bool ok = true;
 
-					return ok;
-				}
-
-				if (request.send_response) {
-					if (m_send) {
-						if (!m_send(request.origin.client, request.response_payload)) {
-							ok = false;
-						}
-					}
-					if (m_close_after_response && m_close) {
-						m_close(request.origin.client);
-					}
-				}
-
-				return ok;
-			}();
+	if (request.plan.request_frame) {
+		std::string payload;
+		if (!request.frame_provider) {
+			payload = "ERR service unavailable\n";
+			ok      = false;
+		} else {
+			const auto result = request.frame_provider();
+			if (!result.success) {
+				payload = "ERR " + result.error + "\n";
+				ok      = false;
+			} else {
+				payload = result.frame;
+			}
+		}
 
-			if (request.notify_completion && request.on_complete) {
-				request.on_complete(success);
+		if (m_send) {
+			if (!m_send(request.origin.client, TagResponse(request.origin, payload))) {
+				ok = false;
 			}
+		}
 
-			m_pending.pop_front();
-trace_log("dequeue id=%llu success=%s\n",
+		if (m_close_after_response && m_close) {
+			m_close(request.origin.client);
+trace_log("close id=%llu client=%p\n",
           static_cast<unsigned long long>(request.id),
-          success ? "yes" : "no");
-			now = std::chrono::steady_clock::now();
-			continue;
+          reinterpret_cast<void*>(request.origin.client));
 		}
 
-		if (!advanced) {
-			break;
-		}
+		return ok;
+	}
 
-		if (request.frames_remaining > 0 || request.resume_at.has_value()) {
-			break;
+	if (request.send_response) {
+		if (m_send) {
+			if (!m_send(request.origin.client,
+			            TagResponse(request.origin, request.response_payload))) {
+				ok = false;
+			}
+		}
+		if (m_close_after_response && m_close) {
+			m_close(request.origin.client);
 		}
-
-		// processed a key action without delay; allow next poll to continue
-		break;
 	}
+
+	return ok;
 }
 
 void QueuedTypeActionSink::CancelClient(const uintptr_t client)
 {
-	for (auto it = m_pending.begin(); it != m_pending.end();) {
-		if (it->origin.client == client) {
+	if (const auto queue = m_queues.find(client); queue != m_queues.end()) {
+		for (const auto& request : queue->second) {
 trace_log("cancel id=%llu client=%p\n",
-          static_cast<unsigned long long>(it->id),
+          static_cast<unsigned long long>(request.id),
           reinterpret_cast<void*>(client));
-			if (it->notify_completion && it->on_complete) {
+			if (request.notify_completion && request.on_complete) {
+				request.on_complete(false);
+			}
+			release_keyboard(request);
+		}
+		m_queues.erase(queue);
+	}
+
+	for (auto it = m_waits.begin(); it != m_waits.end();) {
+		if (it->origin.client == client) {
+			if (it->on_complete) {
 				it->on_complete(false);
 			}
-			it = m_pending.erase(it);
+			it = m_waits.erase(it);
 		} else {
 			++it;
 		}
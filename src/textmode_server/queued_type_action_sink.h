@@ -5,11 +5,13 @@
 #define DOSBOX_TEXTMODE_QUEUED_TYPE_ACTION_SINK_H
 
 #include "textmode_server/command_processor.h"
+#include "textmode_server/telemetry.h"
 
 #include <chrono>
 #include <cstdint>
 #include <deque>
 #include <functional>
+#include <map>
 #include <optional>
 #include <string>
 #include <vector>
@@ -30,10 +32,20 @@ public:
 	                        const FrameProvider& frame_provider,
 	                        CompletionCallback on_complete) override;
 
+	CommandResponse ExecuteWait(const WaitPlan& plan,
+	                            const CommandOrigin& origin,
+	                            const FrameProvider& frame_provider,
+	                            CompletionCallback on_complete) override;
+
 	void SetCloseAfterResponse(bool enable);
 	void SetInterTokenFrameDelay(uint32_t frames);
+	// Paces key actions by the guest instead of the inter-token delay:
+	// after each one the request waits until 'probe' reports the guest has
+	// taken the key, however long or short that is
+	void SetKeyboardReadyProbe(std::function<bool()> probe);
 	void Poll();
 	void CancelClient(uintptr_t client);
+	QueueTelemetry Telemetry() const;
 
 private:
 	struct PendingRequest {
@@ -53,12 +65,40 @@ private:
 		std::string response_payload{};
 		bool saw_key_action = false;
 		bool final_frame_wait_inserted = false;
+		// Waiting for the keyboard ready probe, for this many polls so far
+		bool awaiting_keyboard_ready = false;
+		uint32_t keyboard_ready_polls = 0;
+		// Index of the plan's last key action; the request holds the
+		// keyboard until it's past it
+		size_t last_key_action = 0;
+		std::chrono::steady_clock::time_point enqueued_at{};
+	};
+
+	// Waits are checked independently of the TYPE queue so a long WAITFOR
+	// never holds up other clients' keystrokes
+	struct PendingWait {
+		uint64_t id = 0;
+		CommandOrigin origin{};
+		WaitPlan plan{};
+		FrameProvider frame_provider{};
+		CompletionCallback on_complete{};
+		std::chrono::steady_clock::time_point deadline{};
+		uint64_t checked_generation = 0;
 	};
 
-	void finalize_request(const PendingRequest& request,
-	                     bool success,
-	                     const std::string& payload);
-	void complete_front(bool success, const std::string& payload);
+	void poll_waits(std::chrono::steady_clock::time_point now);
+	void finish_wait(const PendingWait& wait, bool success, const std::string& payload);
+
+	void poll_client(uintptr_t client);
+	// Runs the request's actions that are due; returns true once it has
+	// none left and is ready to be finalized
+	bool advance_request(PendingRequest& request,
+	                     std::chrono::steady_clock::time_point now);
+	// Sends the reply; returns whether that succeeded
+	bool finalize_request(const PendingRequest& request);
+	bool acquire_keyboard(const PendingRequest& request);
+	void release_keyboard(const PendingRequest& request);
+	size_t num_pending() const;
 	static bool send_action(const KeyboardHandler& handler,
 	                       TypeAction::Kind kind,
 	                       const std::string& key);
@@ -66,9 +106,18 @@ private:
 	SendCallback m_send;
 	CloseCallback m_close;
 	bool m_close_after_response = false;
- 	uint32_t m_token_frame_spacing = 0;
- 	uint64_t m_next_id = 1;
- 	std::deque<PendingRequest> m_pending;
+	uint32_t m_token_frame_spacing = 0;
+	std::function<bool()> m_keyboard_ready = {};
+	uint64_t m_next_id = 1;
+	// Each client's TYPE requests run in order, but clients don't wait for
+	// each other except to take turns at the keyboard
+	std::map<uintptr_t, std::deque<PendingRequest>> m_queues;
+	// Request that is typing, so key sequences from different clients
+	// never interleave; 0 when the keyboard is free
+	uint64_t m_keyboard_owner = 0;
+	std::vector<PendingWait> m_waits;
+	size_t m_peak_pending = 0;
+	LatencyHistogram m_wait_latency = {};
 };
 
 } // namespace textmode
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <charconv>
 #include <cstdio>
 #include <cstring>
 #include <deque>
@@ -23,7 +24,6 @@ namespace textmode {
 
 namespace {
 
-constexpr size_t MaxClients = 8;
 constexpr size_t ReceiveBufferSize = 4096;
 constexpr char AuthOkResponse[]    = "Auth OK\n";
 constexpr char AuthErrorResponse[] = "ERR unauthorised\n";
@@ -48,6 +48,65 @@ std::string ToUpperCopy(std::string_view text)
 	return result;
 }
 
+constexpr char InvalidRequestIdResponse[] = "ERR invalid request id\n";
+
+// Removes a leading "#<id> " tag from 'line'. Returns false when the line
+// starts with '#' but the tag is not a decimal number followed by a space.
+bool StripRequestTag(std::string& line, std::optional<uint64_t>& request_id)
+{
+	request_id.reset();
+	if (line.empty() || line.front() != '#') {
+		return true;
+	}
+
+	const auto space_pos = line.find(' ');
+	const auto* first    = line.data() + 1;
+	const auto* last     = line.data() + std::min(space_pos, line.size());
+	uint64_t id          = 0;
+	const auto result    = std::from_chars(first, last, id);
+	if (space_pos == std::string::npos || first == last ||
+	    result.ec != std::errc() || result.ptr != last) {
+		return false;
+	}
+
+	request_id = id;
+	line.erase(0, space_pos + 1);
+	return true;
+}
+
+// Handles "COMPRESS <codec>". On success 'compressor' is ready and takes
+// over once the reply has gone out uncompressed.
+CommandResponse StartCompression(std::string_view arguments, const bool active,
+                                 DeflateStream& compressor)
+{
+	const auto codec = ToUpperCopy(TrimWhitespace(arguments));
+	if (codec != "ZLIB") {
+		return {false, "ERR invalid COMPRESS arguments\n"};
+	}
+	if (active) {
+		return {false, "ERR compression already enabled\n"};
+	}
+	if (!compressor.Init(DeflateFormat::Zlib)) {
+		return {false, "ERR compression unavailable\n"};
+	}
+	return {true, "OK COMPRESS zlib\n"};
+}
+
+// Each compressed reply is a 4-byte big-endian length followed by that
+// many bytes of the session's zlib stream
+std::string FrameCompressedBlock(const std::string& block)
+{
+	const auto size = static_cast<uint32_t>(block.size());
+	std::string framed;
+	framed.reserve(block.size() + 4);
+	framed.push_back(static_cast<char>(size >> 24));
+	framed.push_back(static_cast<char>((size >> 16) & 0xff));
+	framed.push_back(static_cast<char>((size >> 8) & 0xff));
+	framed.push_back(static_cast<char>(size & 0xff));
+	framed += block;
+	return framed;
+}
+
 ClientHandle ToHandle(TCPsocket socket)
 {
 	return reinterpret_cast<ClientHandle>(socket);
@@ -119,8 +178,14 @@ public:
 			return events;
 		}
 
+		// SDL_net only reports readiness per socket, so stop scanning
+		// once every ready socket has been serviced
+		auto remaining = ready_count;
 		std::vector<ClientHandle> closed_clients;
 		for (const auto handle : list_clients()) {
+			if (remaining <= 0) {
+				break;
+			}
 			auto* socket = FromHandle(handle);
 			if (!socket) {
 				continue;
@@ -129,6 +194,7 @@ public:
 			if (!SDLNet_SocketReady(socket)) {
 				continue;
 			}
+			--remaining;
 
 			char buffer[ReceiveBufferSize] = {};
 			const auto received = SDLNet_TCP_Recv(socket, buffer, sizeof(buffer));
@@ -174,6 +240,13 @@ public:
 		return true;
 	}
 
+	void SetMaxClients(const size_t max_clients) override
+	{
+		m_max_clients = std::max<size_t>(max_clients, 1);
+	}
+
+	uint64_t RejectedClients() const override { return m_rejected_clients; }
+
 	void Close(const ClientHandle client) override
 	{
 		auto* socket = FromHandle(client);
@@ -210,7 +283,7 @@ private:
 
 	bool allocate_socket_set()
 	{
-		m_socket_set = SDLNet_AllocSocketSet(static_cast<int>(MaxClients));
+		m_socket_set = SDLNet_AllocSocketSet(static_cast<int>(m_max_clients));
 		if (!m_socket_set) {
 			LOG_WARNING("TEXTMODE: SDLNet_AllocSocketSet failed: %s", SDLNet_GetError());
 			return false;
@@ -230,8 +303,10 @@ private:
 				break;
 			}
 
-			if (m_clients.size() >= MaxClients) {
-				LOG_WARNING("TEXTMODE: Rejecting client, limit reached");
+			if (m_clients.size() >= m_max_clients) {
+				LOG_WARNING("TEXTMODE: Rejecting client, limit of %zu reached",
+				            m_max_clients);
+				++m_rejected_clients;
 				SDLNet_TCP_Close(client);
 				continue;
 			}
@@ -261,6 +336,8 @@ private:
 	TCPsocket m_listener    = nullptr;
 	SDLNet_SocketSet m_socket_set = nullptr;
 	std::map<ClientHandle, TCPsocket> m_clients = {};
+	size_t m_max_clients        = DefaultMaxClients;
+	uint64_t m_rejected_clients = 0;
 };
 
 } // namespace
@@ -293,6 +370,25 @@ void TextModeServer::SetAuthToken(std::string token)
 	}
 }
 
+void TextModeServer::SetMaxClients(const size_t max_clients)
+{
+	if (m_backend) {
+		m_backend->SetMaxClients(max_clients);
+	}
+}
+
+uint64_t TextModeServer::RejectedClients() const
+{
+	return m_backend ? m_backend->RejectedClients() : 0;
+}
+
+void TextModeServer::SetOutboundBudget(const size_t max_bytes,
+                                       const std::chrono::milliseconds stall_timeout)
+{
+	m_outbound_budget = max_bytes;
+	m_stall_timeout   = stall_timeout;
+}
+
 bool TextModeServer::Start(const uint16_t port, ICommandProcessor& processor)
 {
 	if (!m_backend) {
@@ -333,12 +429,53 @@ void TextModeServer::Stop()
 	m_port      = 0;
 }
 
+void TextModeServer::SuspendForFork()
+{
+	if (m_backend) {
+		m_backend->SuspendForFork();
+	}
+}
+
+void TextModeServer::ResumeAfterFork()
+{
+	if (m_backend) {
+		m_backend->ResumeAfterFork();
+	}
+}
+
+void TextModeServer::AbandonAfterFork()
+{
+	// Sessions are dropped as their sends fail; clearing them here could
+	// pull one out from under the command being handled
+	if (m_backend) {
+		m_backend->AbandonAfterFork();
+	}
+	m_running = false;
+}
+
 bool TextModeServer::Send(const ClientHandle client, const std::string& payload)
 {
 	if (!m_backend) {
 		return false;
 	}
-	return m_backend->Send(client, payload);
+	ScopedLatency timer(m_telemetry.send);
+
+	const auto session = m_sessions.find(client);
+	if (session != m_sessions.end() && session->second.compressor.IsReady()) {
+		const auto framed = FrameCompressedBlock(
+		        session->second.compressor.Compress(payload));
+		const bool sent = m_backend->Send(client, framed);
+		if (sent) {
+			m_telemetry.bytes_sent += framed.size();
+		}
+		return sent;
+	}
+
+	const bool sent = m_backend->Send(client, payload);
+	if (sent) {
+		m_telemetry.bytes_sent += payload.size();
+	}
+	return sent;
 }
 
 void TextModeServer::Close(const ClientHandle client)
@@ -348,6 +485,9 @@ void TextModeServer::Close(const ClientHandle client)
 	}
 	m_backend->Close(client);
 	m_sessions.erase(client);
+	if (m_processor) {
+		m_processor->ForgetClient(client);
+	}
 }
 
 void TextModeServer::Poll()
@@ -364,17 +504,38 @@ void TextModeServer::Poll()
 			if (inserted) {
 				session_it->second.authenticated  = m_auth_token.empty();
 				session_it->second.attempted_auth = false;
+				session_it->second.forwarded = m_claim_client &&
+				                               m_claim_client(event.client);
 			}
 			break;
 		}
-		case BackendEvent::Type::Data:
-			HandleData(event.client, event.data);
+		case BackendEvent::Type::Data: {
+			const auto session_it = m_sessions.find(event.client);
+			if (session_it != m_sessions.end() && session_it->second.forwarded) {
+				m_forward_client(event.client, event.data);
+			} else {
+				HandleData(event.client, event.data);
+			}
 			break;
+		}
 		case BackendEvent::Type::Closed:
 			Drop(event.client);
 			break;
 		}
 	}
+
+	if (!m_processor) {
+		return;
+	}
+	CheckBackpressure();
+	for (const auto& push : m_processor->CollectPushedFrames()) {
+		if (m_sessions.find(push.client) == m_sessions.end()) {
+			continue;
+		}
+		if (!Send(push.client, push.payload)) {
+			Drop(push.client);
+		}
+	}
 }
 
 void TextModeServer::HandleData(const ClientHandle client, const std::string& data)
@@ -401,11 +562,21 @@ void TextModeServer::HandleData(const ClientHandle client, const std::string& da
 			line.pop_back();
 		}
 
+		std::optional<uint64_t> request_id = std::nullopt;
+		if (!StripRequestTag(line, request_id)) {
+			if (!Send(client, InvalidRequestIdResponse)) {
+				Drop(client);
+				break;
+			}
+			continue;
+		}
+		const CommandOrigin origin{client, request_id};
+
 		auto& session = it->second;
 		if (require_auth && !session.authenticated) {
 			const auto trimmed = TrimWhitespace(line);
 			if (trimmed.empty()) {
-				if (!m_backend->Send(client, AuthErrorResponse)) {
+				if (!Send(client, TagResponse(origin, AuthErrorResponse))) {
 					Drop(client);
 					break;
 				}
@@ -417,7 +588,7 @@ void TextModeServer::HandleData(const ClientHandle client, const std::string& da
 			const auto verb_upper = ToUpperCopy(verb);
 
 			if (verb_upper != "AUTH" || session.attempted_auth) {
-				if (!m_backend->Send(client, AuthErrorResponse)) {
+				if (!Send(client, TagResponse(origin, AuthErrorResponse))) {
 					Drop(client);
 					break;
 				}
@@ -432,7 +603,7 @@ void TextModeServer::HandleData(const ClientHandle client, const std::string& da
 
 			if (!provided.empty() && provided == m_auth_token) {
 				session.authenticated = true;
-				if (!m_backend->Send(client, AuthOkResponse)) {
+				if (!Send(client, TagResponse(origin, AuthOkResponse))) {
 					Drop(client);
 					break;
 				}
@@ -442,7 +613,7 @@ void TextModeServer::HandleData(const ClientHandle client, const std::string& da
 			std::fprintf(stderr,
 			            "TEXTMODE: AUTH failed for client %p\n",
 			            reinterpret_cast<void*>(client));
-			if (!m_backend->Send(client, AuthErrorResponse)) {
+			if (!Send(client, TagResponse(origin, AuthErrorResponse))) {
 				Drop(client);
 				break;
 			}
@@ -450,9 +621,30 @@ void TextModeServer::HandleData(const ClientHandle client, const std::string& da
 			break;
 		}
 
-		const auto response = m_processor->HandleCommand(line, CommandOrigin{client});
+		// Compression is a property of the session, like AUTH
+		if (const auto trimmed = TrimWhitespace(line);
+		    ToUpperCopy(trimmed.substr(0, trimmed.find(' '))) == "COMPRESS") {
+			const auto space_pos = trimmed.find(' ');
+			const auto arguments = space_pos == std::string::npos
+			                             ? std::string_view{}
+			                             : std::string_view(trimmed).substr(space_pos);
+			DeflateStream compressor = {};
+			const auto response = StartCompression(arguments,
+			                                       session.compressor.IsReady(),
+			                                       compressor);
+			if (!Send(client, TagResponse(origin, response.payload))) {
+				Drop(client);
+				break;
+			}
+			if (compressor.IsReady()) {
+				session.compressor = std::move(compressor);
+			}
+			continue;
+		}
+
+		const auto response = m_processor->HandleCommand(line, origin);
 		if (!response.deferred) {
-			if (!m_backend->Send(client, response.payload)) {
+			if (!Send(client, TagResponse(origin, response.payload))) {
 				Drop(client);
 				break;
 			}
@@ -470,9 +662,54 @@ void TextModeServer::HandleData(const ClientHandle client, const std::string& da
 	}
 }
 
+// Clients over the outbound budget get no WATCH frames until they catch
+// up, so they skip straight to the newest screen; those that stay over it
+// for the stall timeout are let go before their backlog grows further
+void TextModeServer::CheckBackpressure()
+{
+	if (m_outbound_budget == 0) {
+		return;
+	}
+	const auto now = std::chrono::steady_clock::now();
+
+	std::vector<ClientHandle> stalled = {};
+	for (auto& [client, session] : m_sessions) {
+		// Forwarded clients get no WATCH frames from this processor;
+		// only the backend's send queue bounds them
+		if (session.forwarded) {
+			continue;
+		}
+		const bool congested = m_backend->QueuedBytes(client) > m_outbound_budget;
+		if (congested == session.congested_since.has_value()) {
+			if (congested && now - *session.congested_since >= m_stall_timeout) {
+				stalled.push_back(client);
+			}
+			continue;
+		}
+		if (congested) {
+			session.congested_since = now;
+		} else {
+			session.congested_since.reset();
+		}
+		m_processor->SetClientCongested(client, congested);
+	}
+
+	for (const auto client : stalled) {
+		LOG_WARNING("TEXTMODE: Disconnecting client %p, over the %zu byte send budget for %lld ms",
+		            reinterpret_cast<void*>(client),
+		            m_outbound_budget,
+		            static_cast<long long>(m_stall_timeout.count()));
+		++m_telemetry.evicted_clients;
+		Drop(client);
+	}
+}
+
 void TextModeServer::Drop(const ClientHandle client)
 {
 	m_sessions.erase(client);
+	if (m_processor) {
+		m_processor->ForgetClient(client);
+	}
 	if (m_backend) {
 		m_backend->Close(client);
 	}
@@ -5,10 +5,15 @@
 #define DOSBOX_TEXTMODE_SERVER_TCP_H
 
 #include "textmode_server/command_processor.h"
+#include "textmode_server/deflate_stream.h"
+#include "textmode_server/telemetry.h"
 
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -18,6 +23,13 @@ namespace textmode {
 
 using ClientHandle = uintptr_t;
 
+constexpr size_t DefaultMaxClients = 32;
+
+// A client with more unsent reply bytes than this is congested; one that
+// stays congested for the stall timeout is disconnected
+constexpr size_t DefaultOutboundBudget = 1024 * 1024;
+constexpr std::chrono::milliseconds DefaultStallTimeout{10000};
+
 struct BackendEvent {
 	enum class Type {
 		Connected,
@@ -59,6 +71,29 @@ public:
 	virtual std::vector<BackendEvent> Poll()                 = 0;
 	virtual bool Send(ClientHandle client, const std::string& payload) = 0;
 	virtual void Close(ClientHandle client)                  = 0;
+
+	// Applies to connections accepted after the next Start()
+	virtual void SetMaxClients(size_t max_clients) { (void)max_clients; }
+	virtual uint64_t RejectedClients() const { return 0; }
+
+	// Bytes accepted by Send() that have not been written to the socket.
+	// Backends whose Send() blocks until the peer has read everything
+	// leave this at 0.
+	virtual size_t QueuedBytes(ClientHandle client) const
+	{
+		(void)client;
+		return 0;
+	}
+
+	// Around fork(): SuspendForFork() parks any worker thread so none holds
+	// a lock while forking, and ResumeAfterFork() restarts it in the
+	// parent. The child calls AbandonAfterFork() instead, which releases
+	// the inherited sockets without telling the peers or removing the
+	// socket file; both still belong to the parent. Sends and closes on
+	// abandoned clients fail quietly.
+	virtual void SuspendForFork() {}
+	virtual void ResumeAfterFork() {}
+	virtual void AbandonAfterFork() { Stop(); }
 };
 
 class TextModeServer {
@@ -73,24 +108,56 @@ public:
 	void Poll();
 	void SetCloseAfterResponse(bool enable) { m_close_after_response = enable; }
 	void SetAuthToken(std::string token);
+	void SetMaxClients(size_t max_clients);
+	uint64_t RejectedClients() const;
+	// A 'max_bytes' of 0 disables the budget
+	void SetOutboundBudget(size_t max_bytes, std::chrono::milliseconds stall_timeout);
 	void SetClientCloseCallback(std::function<void(ClientHandle)> callback)
 	{
 		m_client_close_callback = std::move(callback);
 	}
+	// Clients 'claim' takes when they connect bypass the command
+	// processor: whatever they send goes to 'forward' as it arrives, and
+	// replies reach them through Send(). The instance pool uses this to
+	// hand connections to its instances.
+	void SetForwarder(std::function<bool(ClientHandle)> claim,
+	                  std::function<void(ClientHandle, const std::string&)> forward)
+	{
+		m_claim_client   = std::move(claim);
+		m_forward_client = std::move(forward);
+	}
 
 	bool IsRunning() const { return m_running; }
 	uint16_t Port() const { return m_port; }
 	bool Send(ClientHandle client, const std::string& payload);
 	void Close(ClientHandle client);
+	TransportTelemetry Telemetry() const
+	{
+		auto telemetry     = m_telemetry;
+		telemetry.sessions = m_sessions.size();
+		return telemetry;
+	}
+
+	// See NetworkBackend; safe to call while a command is being handled
+	void SuspendForFork();
+	void ResumeAfterFork();
+	void AbandonAfterFork();
 
 private:
 	struct Session {
 		std::string buffer;
 		bool authenticated = false;
 		bool attempted_auth = false;
+		// Set by COMPRESS; every later reply is sent compressed
+		DeflateStream compressor = {};
+		// Since when its unsent replies have exceeded the outbound budget
+		std::optional<std::chrono::steady_clock::time_point> congested_since = {};
+		// Claimed by the forwarder
+		bool forwarded = false;
 	};
 
 	void HandleData(ClientHandle client, const std::string& data);
+	void CheckBackpressure();
 	void Drop(ClientHandle client);
 
 	std::unique_ptr<NetworkBackend> m_backend;
@@ -100,10 +167,26 @@ private:
 	uint16_t m_port  = 0;
 	bool m_close_after_response = false;
 	std::string m_auth_token;
+	size_t m_outbound_budget = DefaultOutboundBudget;
+	std::chrono::milliseconds m_stall_timeout = DefaultStallTimeout;
 	std::function<void(ClientHandle)> m_client_close_callback;
+	std::function<bool(ClientHandle)> m_claim_client;
+	std::function<void(ClientHandle, const std::string&)> m_forward_client;
+	TransportTelemetry m_telemetry = {};
 };
 
 std::unique_ptr<NetworkBackend> MakeSdlNetBackend();
+std::unique_ptr<NetworkBackend> MakeNativeNetBackend();
+// Listens on a Unix domain socket at 'path' (AF_UNIX on Windows 10 and
+// later); the port passed to Start() is ignored
+std::unique_ptr<NetworkBackend> MakeLocalSocketBackend(const std::string& path);
+
+// Serves one socket that is already connected, such as an end of a
+// socketpair(), as client ConnectedClient instead of listening; the port
+// passed to Start() is ignored. The backend owns the socket and closes it
+// on Stop(). Its peer hanging up is the usual Closed event.
+constexpr ClientHandle ConnectedClient = 1;
+std::unique_ptr<NetworkBackend> MakeConnectedSocketBackend(intptr_t socket);
 
 } // namespace textmode
 
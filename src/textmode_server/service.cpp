@@ -8,6 +8,7 @@
 
 #include "hardware/video/vga.h"
 #include "textmode_server/encoder.h"
+#include "textmode_server/graphics_text.h"
 
 namespace textmode {
 
@@ -31,7 +32,24 @@ ServiceResult Success(std::string frame)
 
 } // namespace
 
-ServiceResult TextModeService::GetFrame() const
+ServiceResult BuildRegionResult(const Snapshot& screen, EncodingOptions encoding,
+                                const TextRegion& region)
+{
+	const auto clipped = ClipRegion(region, screen.columns, screen.rows);
+	if (clipped.rows == 0 || clipped.columns == 0) {
+		return Failure("region outside screen");
+	}
+
+	auto cropped    = CropSnapshot(screen, clipped);
+	encoding.region = clipped;
+	auto result     = Success(BuildAnsiFrame(cropped, encoding));
+	result.snapshot = std::move(cropped);
+	result.encoding = std::move(encoding);
+	return result;
+}
+
+ServiceResult TextModeService::Prepare(std::optional<Snapshot>& snapshot,
+                                       EncodingOptions& encoding) const
 {
 	if (!m_config.enable) {
 		return Failure("text-mode server disabled");
@@ -41,18 +59,66 @@ ServiceResult TextModeService::GetFrame() const
 		return Failure("video adapter not in text mode");
 	}
 
-	const auto snapshot = CaptureSnapshot(vga);
+	snapshot = m_latched ? std::optional<Snapshot>(*m_latched) : CaptureSnapshot(vga);
 	if (!snapshot.has_value()) {
 		return Failure("unable to capture text snapshot");
 	}
 
-	EncodingOptions encoding{};
+	SetEncoding(encoding);
+	return Success({});
+}
+
+void TextModeService::SetEncoding(EncodingOptions& encoding) const
+{
 	encoding.show_attributes = m_config.show_attributes;
 	encoding.sentinel        = m_config.sentinel;
 	encoding.keys_down       = m_keys_down;
 	std::sort(encoding.keys_down.begin(), encoding.keys_down.end());
+}
+
+ServiceResult TextModeService::GetFrame() const
+{
+	std::optional<Snapshot> snapshot = {};
+	EncodingOptions encoding         = {};
+	if (auto failure = Prepare(snapshot, encoding); !failure.success) {
+		return failure;
+	}
 
-	return Success(BuildAnsiFrame(*snapshot, encoding));
+	auto result     = Success(BuildAnsiFrame(*snapshot, encoding));
+	result.snapshot = std::move(snapshot);
+	result.encoding = std::move(encoding);
+	return result;
+}
+
+ServiceResult TextModeService::GetRegion(const TextRegion& region) const
+{
+	std::optional<Snapshot> snapshot = {};
+	EncodingOptions encoding         = {};
+	if (auto failure = Prepare(snapshot, encoding); !failure.success) {
+		return failure;
+	}
+	return BuildRegionResult(*snapshot, std::move(encoding), region);
+}
+
+ServiceResult TextModeService::GetGraphicsText() const
+{
+	if (!m_config.enable) {
+		return Failure("text-mode server disabled");
+	}
+
+	auto text = CaptureGraphicsText(vga);
+	if (!text) {
+		return Failure("video adapter not in a supported graphics mode");
+	}
+
+	EncodingOptions encoding = {};
+	SetEncoding(encoding);
+	encoding.unmatched_cells = text->unmatched_cells;
+
+	auto result     = Success(BuildAnsiFrame(text->snapshot, encoding));
+	result.snapshot = std::move(text->snapshot);
+	result.encoding = std::move(encoding);
+	return result;
 }
 
 } // namespace textmode
@@ -5,10 +5,12 @@
 #define DOSBOX_TEXTMODE_SERVICE_H
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 #include <utility>
 
+#include "textmode_server/encoder.h"
 #include "textmode_server/snapshot.h"
 
 namespace textmode {
@@ -21,28 +23,77 @@ struct ServiceConfig {
 	bool close_after_response = false;
 	uint32_t macro_interkey_frames = 1;
 	uint32_t inter_token_frame_delay = 1;
+	// Space TYPE key actions by how fast the guest reads them instead of
+	// the two frame delays above
+	bool guest_paced_typing = false;
 	std::string auth_token;
 	uint32_t debug_segment = 0;
 	uint32_t debug_offset  = 0;
 	uint32_t debug_length  = 0;
+	std::string network_backend = "sdl";
+	uint32_t max_clients = 32;
+	// Per-client unsent reply budget (0 disables) and how long a client may
+	// stay over it
+	uint32_t send_budget_kb = 1024;
+	uint32_t slow_client_ms = 10000;
+	bool io_thread = true;
+	std::string socket_path = {};
+	std::string shm_name    = {};
+	bool websocket          = false;
+	bool lockstep           = false;
+	// Session journal paths; see session_journal.h
+	std::string record_journal = {};
+	std::string replay_journal = {};
+	// Supervise this many warm clones once ready; see instance_pool.h
+	uint32_t pool_size = 0;
+	// Wait for POOL START rather than the first shell prompt
+	bool pool_waits_for_command = false;
+	// Serve this connected socket instead of listening, and exit once it
+	// closes; set in pool instances
+	intptr_t connected_socket = -1;
 };
 
 struct ServiceResult {
 	bool success      = false;
 	std::string frame = {};
 	std::string error = {};
+	// Capture and encoding behind 'frame', used to build DIFF replies
+	std::optional<Snapshot> snapshot = {};
+	EncodingOptions encoding         = {};
+	// Content generation of the latched frame behind 'snapshot', 0 if unknown
+	uint64_t generation = 0;
 };
 
+// Crops 'screen' to 'region' and encodes just that part, tagged with its
+// clipped 'META region'. Fails when the region lies outside the screen.
+ServiceResult BuildRegionResult(const Snapshot& screen, EncodingOptions encoding,
+                                const TextRegion& region);
+
 class TextModeService {
 public:
-	TextModeService(ServiceConfig config, std::vector<std::string> keys_down = {})
-	        : m_config(std::move(config)), m_keys_down(std::move(keys_down)) {}
+	// A 'latched' snapshot, when given, is encoded instead of capturing
+	// video memory again
+	TextModeService(ServiceConfig config, std::vector<std::string> keys_down = {},
+	                const Snapshot* latched = nullptr)
+	        : m_config(std::move(config)),
+	          m_keys_down(std::move(keys_down)),
+	          m_latched(latched)
+	{}
 
 	ServiceResult GetFrame() const;
+	// Encodes only 'region' of the screen
+	ServiceResult GetRegion(const TextRegion& region) const;
+	// Encodes the text of a graphics screen; see graphics_text.h
+	ServiceResult GetGraphicsText() const;
 
 private:
+	ServiceResult Prepare(std::optional<Snapshot>& snapshot,
+	                      EncodingOptions& encoding) const;
+	void SetEncoding(EncodingOptions& encoding) const;
+
 	ServiceConfig m_config;
 	std::vector<std::string> m_keys_down;
+	const Snapshot* m_latched = nullptr;
 };
 
 } // namespace textmode
@@ -0,0 +1,172 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/session_journal.h"
+
+namespace textmode {
+
+namespace {
+
+constexpr std::string_view Magic = "DBXJ";
+// Key names are short; anything longer is not a journal written here
+constexpr size_t MaxKeyLength = 64;
+
+void append_varint(std::string& out, uint64_t value)
+{
+	while (value >= 0x80) {
+		out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+std::optional<uint64_t> read_varint(std::string_view data, size_t& offset)
+{
+	uint64_t value = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (offset >= data.size()) {
+			return std::nullopt;
+		}
+		const auto byte = static_cast<uint8_t>(data[offset++]);
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0) {
+			return value;
+		}
+	}
+	return std::nullopt;
+}
+
+constexpr std::string_view verb_for(const JournalEntry::Kind kind)
+{
+	switch (kind) {
+	case JournalEntry::Kind::Press: return "PRESS";
+	case JournalEntry::Kind::Down: return "DOWN";
+	case JournalEntry::Kind::Up: return "UP";
+	case JournalEntry::Kind::Frame: break;
+	}
+	return {};
+}
+
+} // namespace
+
+uint64_t HashFrame(const std::string_view frame)
+{
+	uint64_t hash = 0xcbf29ce484222325;
+	for (const auto ch : frame) {
+		hash ^= static_cast<uint8_t>(ch);
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+std::string EncodeJournal(const std::vector<JournalEntry>& entries)
+{
+	std::string out(Magic);
+	out.push_back(static_cast<char>(SessionJournalVersion));
+
+	uint64_t previous_tick = 0;
+	for (const auto& entry : entries) {
+		append_varint(out, entry.tick - previous_tick);
+		previous_tick = entry.tick;
+		out.push_back(static_cast<char>(entry.kind));
+		if (entry.kind == JournalEntry::Kind::Frame) {
+			for (int i = 0; i < 8; ++i) {
+				out.push_back(static_cast<char>(entry.hash >> (8 * i)));
+			}
+		} else {
+			out.push_back(static_cast<char>(entry.key.size()));
+			out.append(entry.key);
+		}
+	}
+	return out;
+}
+
+std::optional<std::vector<JournalEntry>> DecodeJournal(const std::string_view data,
+                                                       std::string& error)
+{
+	if (!data.starts_with(Magic) || data.size() <= Magic.size()) {
+		error = "not a session journal";
+		return std::nullopt;
+	}
+	if (static_cast<uint8_t>(data[Magic.size()]) != SessionJournalVersion) {
+		error = "session journal version is not supported";
+		return std::nullopt;
+	}
+
+	std::vector<JournalEntry> entries = {};
+	uint64_t tick                     = 0;
+	size_t offset                     = Magic.size() + 1;
+	while (offset < data.size()) {
+		const auto delta = read_varint(data, offset);
+		if (!delta || offset >= data.size()) {
+			error = "session journal is truncated";
+			return std::nullopt;
+		}
+		tick += *delta;
+
+		JournalEntry entry = {};
+		entry.tick         = tick;
+		const auto kind    = static_cast<uint8_t>(data[offset++]);
+		if (kind > static_cast<uint8_t>(JournalEntry::Kind::Frame)) {
+			error = "session journal has an unknown entry";
+			return std::nullopt;
+		}
+		entry.kind = static_cast<JournalEntry::Kind>(kind);
+
+		if (entry.kind == JournalEntry::Kind::Frame) {
+			if (data.size() - offset < 8) {
+				error = "session journal is truncated";
+				return std::nullopt;
+			}
+			for (int i = 0; i < 8; ++i) {
+				entry.hash |= static_cast<uint64_t>(static_cast<uint8_t>(data[offset++]))
+				           << (8 * i);
+			}
+		} else {
+			const auto length = offset < data.size()
+			                          ? static_cast<uint8_t>(data[offset++])
+			                          : size_t{0};
+			if (length == 0 || length > MaxKeyLength || data.size() - offset < length) {
+				error = "session journal is truncated";
+				return std::nullopt;
+			}
+			entry.key = std::string(data.substr(offset, length));
+			offset += length;
+		}
+		entries.push_back(std::move(entry));
+	}
+	return entries;
+}
+
+std::optional<JournalEntry> ParseKeyCommand(const std::string_view command,
+                                            const uint64_t tick)
+{
+	const auto space = command.find(' ');
+	if (space == std::string_view::npos) {
+		return std::nullopt;
+	}
+	const auto verb = command.substr(0, space);
+	const auto key  = command.substr(space + 1);
+	if (key.empty() || key.size() > MaxKeyLength) {
+		return std::nullopt;
+	}
+
+	for (const auto kind : {JournalEntry::Kind::Press,
+	                        JournalEntry::Kind::Down,
+	                        JournalEntry::Kind::Up}) {
+		if (verb == verb_for(kind)) {
+			return JournalEntry{tick, kind, std::string(key), 0};
+		}
+	}
+	return std::nullopt;
+}
+
+std::string FormatKeyCommand(const JournalEntry& entry)
+{
+	std::string command(verb_for(entry.kind));
+	command.push_back(' ');
+	command.append(entry.key);
+	return command;
+}
+
+} // namespace textmode
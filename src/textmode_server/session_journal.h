@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEXTMODE_SESSION_JOURNAL_H
+#define DOSBOX_TEXTMODE_SESSION_JOURNAL_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace textmode {
+
+// Session journals
+// ~~~~~~~~~~~~~~~~
+// A journal holds every key action a session applied and a hash of every
+// distinct frame it served, each stamped with the emulated millisecond it
+// happened at. Replaying one feeds the key actions back at the same ticks
+// under lockstep timing and checks that the frames come out the same.
+//
+// On disk it's the magic "DBXJ" and a version byte, then one record per
+// entry: the tick as an unsigned LEB128 delta to the previous entry, a kind
+// byte, and either a length-prefixed key name or the 64-bit frame hash in
+// little-endian order.
+
+struct JournalEntry {
+	enum class Kind : uint8_t { Press = 0, Down = 1, Up = 2, Frame = 3 };
+
+	uint64_t tick = 0;
+	Kind kind     = Kind::Frame;
+	// Key name for the key actions
+	std::string key = {};
+	// Content hash for frames
+	uint64_t hash = 0;
+};
+
+constexpr uint8_t SessionJournalVersion = 1;
+
+// FNV-1a over the frame as it was sent
+uint64_t HashFrame(std::string_view frame);
+
+std::string EncodeJournal(const std::vector<JournalEntry>& entries);
+
+// Fails with 'error' set on foreign or truncated data
+std::optional<std::vector<JournalEntry>> DecodeJournal(std::string_view data,
+                                                       std::string& error);
+
+// Maps a keyboard command ("PRESS Enter") to its journal entry and back
+std::optional<JournalEntry> ParseKeyCommand(std::string_view command, uint64_t tick);
+std::string FormatKeyCommand(const JournalEntry& entry);
+
+} // namespace textmode
+
+#endif // DOSBOX_TEXTMODE_SESSION_JOURNAL_H
@@ -0,0 +1,221 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/shared_frame.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "dosbox.h"
+#include "misc/logging.h"
+
+#if defined(WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace textmode {
+
+namespace {
+
+uint8_t* cell_area(SharedFrameHeader* header)
+{
+	return reinterpret_cast<uint8_t*>(header) + sizeof(SharedFrameHeader);
+}
+
+const uint8_t* cell_area(const SharedFrameHeader* header)
+{
+	return reinterpret_cast<const uint8_t*>(header) + sizeof(SharedFrameHeader);
+}
+
+constexpr int MaxReadAttempts = 64;
+
+} // namespace
+
+bool SharedFrameExport::Open(const std::string& name)
+{
+	Close();
+	if (name.empty()) {
+		return false;
+	}
+
+	void* segment = nullptr;
+#if defined(WIN32)
+	const auto mapping_name = "Local\\" + name;
+	m_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE,
+	                               nullptr,
+	                               PAGE_READWRITE,
+	                               0,
+	                               static_cast<DWORD>(SharedFrameSize),
+	                               mapping_name.c_str());
+	if (!m_mapping) {
+		LOG_WARNING("TEXTMODE: Unable to create shared frame '%s'", name.c_str());
+		return false;
+	}
+	segment = MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, SharedFrameSize);
+	if (!segment) {
+		CloseHandle(m_mapping);
+		m_mapping = nullptr;
+		LOG_WARNING("TEXTMODE: Unable to map shared frame '%s'", name.c_str());
+		return false;
+	}
+	m_name = name;
+#else
+	// POSIX object names need exactly one leading slash
+	m_name = (name.front() == '/') ? name : "/" + name;
+	const int fd = shm_open(m_name.c_str(), O_CREAT | O_RDWR, 0600);
+	if (fd < 0) {
+		LOG_WARNING("TEXTMODE: shm_open('%s') failed: %s",
+		            m_name.c_str(),
+		            std::strerror(errno));
+		m_name.clear();
+		return false;
+	}
+	if (ftruncate(fd, static_cast<off_t>(SharedFrameSize)) != 0) {
+		LOG_WARNING("TEXTMODE: Unable to size shared frame '%s': %s",
+		            m_name.c_str(),
+		            std::strerror(errno));
+		::close(fd);
+		shm_unlink(m_name.c_str());
+		m_name.clear();
+		return false;
+	}
+	segment = mmap(nullptr, SharedFrameSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+	if (segment == MAP_FAILED) {
+		LOG_WARNING("TEXTMODE: Unable to map shared frame '%s': %s",
+		            m_name.c_str(),
+		            std::strerror(errno));
+		shm_unlink(m_name.c_str());
+		m_name.clear();
+		return false;
+	}
+#endif
+
+	std::memset(segment, 0, SharedFrameSize);
+	m_header = new (segment) SharedFrameHeader();
+	LOG_INFO("TEXTMODE: Publishing frames to shared memory '%s'", m_name.c_str());
+	return true;
+}
+
+void SharedFrameExport::Close()
+{
+	if (!m_header) {
+		return;
+	}
+#if defined(WIN32)
+	UnmapViewOfFile(m_header);
+	CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#else
+	munmap(m_header, SharedFrameSize);
+	shm_unlink(m_name.c_str());
+#endif
+	m_header = nullptr;
+	m_name.clear();
+}
+
+void SharedFrameExport::Abandon()
+{
+	if (!m_header) {
+		return;
+	}
+#if defined(WIN32)
+	UnmapViewOfFile(m_header);
+	CloseHandle(m_mapping);
+	m_mapping = nullptr;
+#else
+	munmap(m_header, SharedFrameSize);
+#endif
+	m_header = nullptr;
+	m_name.clear();
+}
+
+void SharedFrameExport::Publish(const Snapshot* snapshot, const uint64_t generation)
+{
+	if (!m_header) {
+		return;
+	}
+
+	// Frames too large for the segment are published as empty rather than
+	// truncated mid-row
+	const bool fits = snapshot && snapshot->cells.size() <= SharedFrameMaxCells;
+
+	auto& header       = *m_header;
+	const auto started = header.sequence.load(std::memory_order_relaxed) + 1;
+	header.sequence.store(started, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	header.generation = generation;
+	if (fits) {
+		header.columns        = snapshot->columns;
+		header.rows           = snapshot->rows;
+		header.cursor_row     = snapshot->cursor.row;
+		header.cursor_column  = snapshot->cursor.column;
+		header.cursor_enabled = snapshot->cursor.enabled ? 1 : 0;
+		header.cursor_visible = snapshot->cursor.visible ? 1 : 0;
+		header.cell_bytes     = static_cast<uint32_t>(snapshot->cells.size() * 2);
+
+		auto* out = cell_area(m_header);
+		for (const auto& cell : snapshot->cells) {
+			*out++ = cell.character;
+			*out++ = cell.attribute;
+		}
+	} else {
+		header.columns        = 0;
+		header.rows           = 0;
+		header.cursor_row     = 0;
+		header.cursor_column  = 0;
+		header.cursor_enabled = 0;
+		header.cursor_visible = 0;
+		header.cell_bytes     = 0;
+	}
+
+	header.sequence.store(started + 1, std::memory_order_release);
+}
+
+bool ReadSharedFrame(const void* segment, Snapshot& snapshot, uint64_t& generation)
+{
+	const auto* header = static_cast<const SharedFrameHeader*>(segment);
+	if (!header || header->magic != SharedFrameMagic ||
+	    header->version != SharedFrameVersion) {
+		return false;
+	}
+
+	for (int attempt = 0; attempt < MaxReadAttempts; ++attempt) {
+		const auto before = header->sequence.load(std::memory_order_acquire);
+		if (before & 1) {
+			continue;
+		}
+
+		const auto cell_bytes = std::min<uint32_t>(header->cell_bytes,
+		                                           SharedFrameMaxCells * 2);
+		snapshot.columns        = header->columns;
+		snapshot.rows           = header->rows;
+		snapshot.cursor.row     = header->cursor_row;
+		snapshot.cursor.column  = header->cursor_column;
+		snapshot.cursor.enabled = header->cursor_enabled != 0;
+		snapshot.cursor.visible = header->cursor_visible != 0;
+		generation              = header->generation;
+
+		snapshot.cells.resize(cell_bytes / 2);
+		const auto* in = cell_area(header);
+		for (auto& cell : snapshot.cells) {
+			cell.character = *in++;
+			cell.attribute = *in++;
+		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		if (header->sequence.load(std::memory_order_relaxed) == before) {
+			return true;
+		}
+	}
+	return false;
+}
+
+} // namespace textmode
@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEXTMODE_SHARED_FRAME_H
+#define DOSBOX_TEXTMODE_SHARED_FRAME_H
+
+#include "textmode_server/snapshot.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace textmode {
+
+constexpr uint32_t SharedFrameMagic   = 0x48534D54; // "TMSH" little-endian
+constexpr uint32_t SharedFrameVersion = 1;
+constexpr uint32_t SharedFrameMaxCells = 16384;
+
+// Layout of the shared segment. 'sequence' is a seqlock: it is odd while a
+// frame is being written, so readers copy the frame, re-read 'sequence',
+// and retry when it changed or was odd. Cells follow as (character,
+// attribute) byte pairs in row-major order. 'columns' and 'rows' are zero
+// while the adapter is not in a text mode.
+struct SharedFrameHeader {
+	uint32_t magic      = SharedFrameMagic;
+	uint32_t version    = SharedFrameVersion;
+	std::atomic<uint64_t> sequence = 0;
+	uint64_t generation = 0;
+	uint16_t columns    = 0;
+	uint16_t rows       = 0;
+	uint16_t cursor_row    = 0;
+	uint16_t cursor_column = 0;
+	uint8_t cursor_enabled = 0;
+	uint8_t cursor_visible = 0;
+	uint16_t reserved      = 0;
+	uint32_t cell_bytes    = 0;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the seqlock counter must be lock-free to live in shared memory");
+
+constexpr size_t SharedFrameSize = sizeof(SharedFrameHeader) + SharedFrameMaxCells * 2;
+
+// Publishes latched frames into a named POSIX shared-memory object (a named
+// file mapping on Windows) for readers that map it directly.
+class SharedFrameExport {
+public:
+	SharedFrameExport() = default;
+	SharedFrameExport(const SharedFrameExport&)            = delete;
+	SharedFrameExport& operator=(const SharedFrameExport&) = delete;
+	~SharedFrameExport() { Close(); }
+
+	bool Open(const std::string& name);
+	void Close();
+	// Unmaps the segment but leaves its name in place, for a forked child
+	// whose parent keeps publishing to it
+	void Abandon();
+	bool IsOpen() const { return m_header != nullptr; }
+
+	// A null 'snapshot' publishes an empty frame (not in text mode)
+	void Publish(const Snapshot* snapshot, uint64_t generation);
+
+	const void* Data() const { return m_header; }
+
+private:
+	SharedFrameHeader* m_header = nullptr;
+	std::string m_name          = {};
+#if defined(WIN32)
+	void* m_mapping = nullptr;
+#endif
+};
+
+// Reference reader: copies the frame at 'segment' into 'snapshot'. Returns
+// false when no consistent copy was obtained within a few attempts or the
+// segment is not a shared frame.
+bool ReadSharedFrame(const void* segment, Snapshot& snapshot, uint64_t& generation);
+
+} // namespace textmode
+
+#endif // DOSBOX_TEXTMODE_SHARED_FRAME_H
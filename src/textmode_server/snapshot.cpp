@@ -4,6 +4,7 @@
 #include "textmode_server/snapshot.h"
 
 #include <algorithm>
+#include <cstring>
 
 namespace textmode {
 
@@ -55,20 +56,66 @@ const uint8_t* resolve_text_memory(const VgaType& state)
 
 } // namespace
 
+TextRegion ClipRegion(const TextRegion& region, const uint16_t columns, const uint16_t rows)
+{
+	TextRegion clipped = {};
+	clipped.row        = std::min(region.row, rows);
+	clipped.column     = std::min(region.column, columns);
+	clipped.rows       = std::min<uint16_t>(region.rows, rows - clipped.row);
+	clipped.columns    = std::min<uint16_t>(region.columns, columns - clipped.column);
+	return clipped;
+}
+
+Snapshot CropSnapshot(const Snapshot& snapshot, const TextRegion& region)
+{
+	Snapshot cropped = {};
+	cropped.columns  = region.columns;
+	cropped.rows     = region.rows;
+	cropped.cells.reserve(static_cast<size_t>(region.columns) * region.rows);
+	for (uint16_t row = 0; row < region.rows; ++row) {
+		const auto first = snapshot.cells.begin() +
+		                   static_cast<ptrdiff_t>(region.row + row) * snapshot.columns +
+		                   region.column;
+		cropped.cells.insert(cropped.cells.end(), first, first + region.columns);
+	}
+
+	const auto& cursor  = snapshot.cursor;
+	const bool inside   = cursor.row >= region.row &&
+	                    cursor.row < region.row + region.rows &&
+	                    cursor.column >= region.column &&
+	                    cursor.column < region.column + region.columns;
+	cropped.cursor.enabled = cursor.enabled;
+	if (inside) {
+		cropped.cursor.row     = static_cast<uint16_t>(cursor.row - region.row);
+		cropped.cursor.column  = static_cast<uint16_t>(cursor.column - region.column);
+		cropped.cursor.visible = cursor.visible;
+	}
+	return cropped;
+}
+
 std::optional<Snapshot> CaptureSnapshot(const VgaType& state)
 {
-	if (state.mode != M_TEXT) {
+	Snapshot snapshot{};
+	if (!CaptureSnapshotInto(state, snapshot)) {
 		return std::nullopt;
 	}
+	return snapshot;
+}
+
+bool CaptureSnapshotInto(const VgaType& state, Snapshot& snapshot)
+{
+	if (state.mode != M_TEXT) {
+		return false;
+	}
 
 	const auto* text_mem = resolve_text_memory(state);
 	if (!text_mem) {
-		return std::nullopt;
+		return false;
 	}
 
 	const uint16_t columns = static_cast<uint16_t>(state.draw.blocks);
 	if (columns == 0) {
-		return std::nullopt;
+		return false;
 	}
 
 	const uint32_t char_height = state.draw.address_line_total ? state.draw.address_line_total : 16;
@@ -77,10 +124,9 @@ std::optional<Snapshot> CaptureSnapshot(const VgaType& state)
 	                             ? static_cast<uint16_t>(total_lines / char_height)
 	                             : 25;
 	if (rows == 0) {
-		return std::nullopt;
+		return false;
 	}
 
-	Snapshot snapshot{};
 	snapshot.columns = columns;
 	snapshot.rows    = rows;
 	snapshot.cells.resize(static_cast<size_t>(columns) * rows);
@@ -93,15 +139,28 @@ std::optional<Snapshot> CaptureSnapshot(const VgaType& state)
 	start_byte                        = wrap_address(start_byte, memory_size);
 
 	const uint32_t row_stride = state.draw.address_add ? state.draw.address_add : static_cast<uint32_t>(columns) * 2;
+	snapshot.display_start    = start_byte;
+	snapshot.row_stride       = row_stride;
+
+	// A cell is stored as its character byte followed by its attribute byte,
+	// the same order the text plane interleaves them in, so every stretch of
+	// a row that doesn't cross the end of video memory is one plain copy
+	static_assert(sizeof(TextCell) == 2);
+	const size_t row_bytes = static_cast<size_t>(columns) * 2;
+	auto* cells            = snapshot.cells.data();
 
 	for (uint16_t row = 0; row < rows; ++row) {
 		const uint32_t row_base = wrap_address(start_byte + row * row_stride, memory_size);
+		auto* row_cells         = cells + static_cast<size_t>(row) * columns;
+		if (memory_size == 0 || row_base + row_bytes <= memory_size) {
+			std::memcpy(row_cells, text_mem + row_base, row_bytes);
+			continue;
+		}
 		for (uint16_t col = 0; col < columns; ++col) {
 			const uint32_t char_addr = wrap_address(row_base + col * 2, memory_size);
 			const uint32_t attr_addr = wrap_address(char_addr + 1, memory_size);
-			const size_t cell_index  = static_cast<size_t>(row) * columns + col;
-			snapshot.cells[cell_index].character = text_mem[char_addr];
-			snapshot.cells[cell_index].attribute = text_mem[attr_addr];
+			row_cells[col].character = text_mem[char_addr];
+			row_cells[col].attribute = text_mem[attr_addr];
 		}
 	}
 
@@ -124,7 +183,31 @@ std::optional<Snapshot> CaptureSnapshot(const VgaType& state)
 	}
 
 	snapshot.cursor = cursor;
-	return snapshot;
+	return true;
+}
+
+void SnapshotLatch::Latch(const VgaType& state)
+{
+	const size_t back    = 1 - m_front;
+	const bool was_valid = m_valid;
+	m_valid = CaptureSnapshotInto(state, m_buffers[back]);
+
+	// Comparing against the previous latch is a few kilobytes of memcmp,
+	// far cheaper than encoding and sending an unchanged frame
+	const bool changed = (m_valid != was_valid) ||
+	                     (m_valid && m_buffers[back] != m_buffers[m_front]);
+	if (m_valid) {
+		m_front = back;
+	}
+	if (changed) {
+		++m_content_generation;
+	}
+	++m_generation;
+}
+
+void SnapshotLatch::Reset()
+{
+	m_valid = false;
 }
 
 } // namespace textmode
@@ -6,6 +6,8 @@
 
 #include "hardware/video/vga.h"
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 #include <vector>
@@ -15,6 +17,8 @@ namespace textmode {
 struct TextCell {
 	uint8_t character = 0;
 	uint8_t attribute = 0;
+
+	bool operator==(const TextCell&) const = default;
 };
 
 struct CursorState {
@@ -22,6 +26,8 @@ struct CursorState {
 	bool visible = false;
 	uint16_t row = 0;
 	uint16_t column = 0;
+
+	bool operator==(const CursorState&) const = default;
 };
 
 struct Snapshot {
@@ -29,10 +35,69 @@ struct Snapshot {
 	uint16_t rows    = 0;
 	std::vector<TextCell> cells = {};
 	CursorState cursor          = {};
+	// Where the CRTC started scanning out (vga.config.real_start, in bytes
+	// into the text plane) and the distance between rows. Lets the diff
+	// encoder recognise hardware scrolling.
+	uint32_t display_start = 0;
+	uint32_t row_stride    = 0;
+
+	bool operator==(const Snapshot&) const = default;
 };
 
+// Rectangle of cells; clipped to the snapshot when applied
+struct TextRegion {
+	uint16_t row     = 0;
+	uint16_t column  = 0;
+	uint16_t rows    = 0;
+	uint16_t columns = 0;
+
+	bool operator==(const TextRegion&) const = default;
+};
+
+// The part of 'region' inside a columns x rows screen; empty when the
+// region lies entirely outside it
+TextRegion ClipRegion(const TextRegion& region, uint16_t columns, uint16_t rows);
+
+// Copies only the cells of 'region' (already clipped). The cursor becomes
+// relative to the region and is hidden when it lies outside.
+Snapshot CropSnapshot(const Snapshot& snapshot, const TextRegion& region);
+
 std::optional<Snapshot> CaptureSnapshot(const VgaType& state);
 
+// Captures into an existing snapshot, reusing its cell storage. Returns false
+// (leaving the snapshot unspecified) when the adapter is not showing text.
+bool CaptureSnapshotInto(const VgaType& state, Snapshot& snapshot);
+
+// Double-buffered capture of the visible text plane, refreshed once per
+// vertical retrace. Readers get the last complete frame without walking
+// video memory again, and all requests within one refresh share it.
+class SnapshotLatch {
+public:
+	void Latch(const VgaType& state);
+	void Reset();
+
+	// Null when the last retrace was not showing a text mode
+	const Snapshot* Latest() const
+	{
+		return m_valid ? &m_buffers[m_front] : nullptr;
+	}
+
+	// Incremented by every Latch() call
+	uint64_t Generation() const { return m_generation; }
+
+	// Incremented only when a latch differs from the previous one: cells,
+	// cursor, geometry or switching in/out of text mode. Zero until the
+	// first text frame is latched.
+	uint64_t ContentGeneration() const { return m_content_generation; }
+
+private:
+	std::array<Snapshot, 2> m_buffers = {};
+	size_t m_front        = 0;
+	bool m_valid          = false;
+	uint64_t m_generation = 0;
+	uint64_t m_content_generation = 0;
+};
+
 } // namespace textmode
 
 #endif // DOSBOX_TEXTMODE_SNAPSHOT_H
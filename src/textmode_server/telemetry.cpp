@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/telemetry.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <sstream>
+
+namespace textmode {
+
+namespace {
+
+uint64_t bucket_upper_bound_us(const size_t bucket)
+{
+	return uint64_t{1} << bucket;
+}
+
+// Exact decimal seconds without trailing zeros: 1 -> "0.000001"
+std::string micros_as_seconds(const uint64_t micros)
+{
+	auto text = std::to_string(micros / 1000000);
+	if (const auto fraction = micros % 1000000; fraction != 0) {
+		auto digits = std::to_string(fraction);
+		digits.insert(0, 6 - digits.size(), '0');
+		digits.erase(digits.find_last_not_of('0') + 1);
+		text.append(".").append(digits);
+	}
+	return text;
+}
+
+} // namespace
+
+void LatencyHistogram::Record(const std::chrono::steady_clock::duration elapsed)
+{
+	const auto micros = static_cast<uint64_t>(std::max<int64_t>(
+	        0, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+
+	const auto bucket = std::min<size_t>(std::bit_width(micros), BucketCount - 1);
+	++m_buckets[bucket];
+	++m_count;
+	m_total_us += micros;
+	m_max_us = std::max(m_max_us, micros);
+}
+
+uint64_t LatencyHistogram::PercentileMicros(const double percentile) const
+{
+	if (m_count == 0) {
+		return 0;
+	}
+
+	const auto clamped = std::clamp(percentile, 0.0, 100.0);
+	const auto target  = std::max<uint64_t>(
+	        1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * m_count)));
+
+	uint64_t seen = 0;
+	for (size_t bucket = 0; bucket < BucketCount; ++bucket) {
+		seen += m_buckets[bucket];
+		if (seen >= target) {
+			// The open-ended bucket has no upper bound, so report the max
+			return (bucket == BucketCount - 1)
+			             ? m_max_us
+			             : std::min(bucket_upper_bound_us(bucket), m_max_us);
+		}
+	}
+	return m_max_us;
+}
+
+std::string LatencyHistogram::ToJson() const
+{
+	std::ostringstream oss;
+	oss << "{\"count\":" << m_count << ",\"total_us\":" << m_total_us
+	    << ",\"max_us\":" << m_max_us << ",\"p50_us\":" << PercentileMicros(50)
+	    << ",\"p99_us\":" << PercentileMicros(99) << ",\"buckets\":[";
+	for (size_t bucket = 0; bucket < BucketCount; ++bucket) {
+		if (bucket > 0) {
+			oss << ',';
+		}
+		oss << m_buckets[bucket];
+	}
+	oss << "]}";
+	return oss.str();
+}
+
+void LatencyHistogram::AppendOpenMetrics(std::string& out, const std::string_view name,
+                                         const std::string_view labels) const
+{
+	const auto sample = [&](const std::string_view suffix, const std::string_view le) {
+		out.append(name).append(suffix);
+		if (!labels.empty() || !le.empty()) {
+			out.push_back('{');
+			out.append(labels);
+			if (!le.empty()) {
+				out.append(labels.empty() ? "" : ",").append("le=\"");
+				out.append(le).append("\"");
+			}
+			out.push_back('}');
+		}
+		out.push_back(' ');
+	};
+
+	// The last bucket is open-ended and only shows up in +Inf
+	uint64_t cumulative = 0;
+	for (size_t bucket = 0; bucket + 1 < BucketCount; ++bucket) {
+		cumulative += m_buckets[bucket];
+		sample("_bucket", micros_as_seconds(bucket_upper_bound_us(bucket)));
+		out.append(std::to_string(cumulative)).push_back('\n');
+	}
+	sample("_bucket", "+Inf");
+	out.append(std::to_string(m_count)).push_back('\n');
+	sample("_count", {});
+	out.append(std::to_string(m_count)).push_back('\n');
+	sample("_sum", {});
+	out.append(micros_as_seconds(m_total_us)).push_back('\n');
+}
+
+} // namespace textmode
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEXTMODE_TELEMETRY_H
+#define DOSBOX_TEXTMODE_TELEMETRY_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "misc/perf_counters.h"
+
+namespace textmode {
+
+// Latency histogram with power-of-two microsecond buckets. Bucket 0 counts
+// samples under 1 us, bucket i counts [2^(i-1), 2^i) us, and the last
+// bucket is open-ended (about 4 s and above).
+class LatencyHistogram {
+public:
+	static constexpr size_t BucketCount = 24;
+
+	void Record(std::chrono::steady_clock::duration elapsed);
+
+	uint64_t Count() const { return m_count; }
+	uint64_t TotalMicros() const { return m_total_us; }
+	uint64_t MaxMicros() const { return m_max_us; }
+	const std::array<uint64_t, BucketCount>& Buckets() const { return m_buckets; }
+
+	// Upper bound of the bucket holding the given percentile (0-100)
+	uint64_t PercentileMicros(double percentile) const;
+
+	// {"count":N,"total_us":N,"max_us":N,"p50_us":N,"p99_us":N,"buckets":[...]}
+	std::string ToJson() const;
+
+	// Appends the histogram as OpenMetrics samples in seconds:
+	// <name>_bucket{<labels>,le="..."}, <name>_count and <name>_sum.
+	// 'labels' is either empty or 'key="value"' pairs without braces.
+	void AppendOpenMetrics(std::string& out, std::string_view name,
+	                       std::string_view labels) const;
+
+private:
+	std::array<uint64_t, BucketCount> m_buckets = {};
+	uint64_t m_count    = 0;
+	uint64_t m_total_us = 0;
+	uint64_t m_max_us   = 0;
+};
+
+// Measures from construction until Stop() or destruction
+class ScopedLatency {
+public:
+	explicit ScopedLatency(LatencyHistogram& histogram)
+	        : m_histogram(&histogram),
+	          m_started(std::chrono::steady_clock::now())
+	{}
+	ScopedLatency(const ScopedLatency&)            = delete;
+	ScopedLatency& operator=(const ScopedLatency&) = delete;
+	~ScopedLatency() { Stop(); }
+
+	void Stop()
+	{
+		if (m_histogram) {
+			m_histogram->Record(std::chrono::steady_clock::now() - m_started);
+			m_histogram = nullptr;
+		}
+	}
+
+private:
+	LatencyHistogram* m_histogram;
+	std::chrono::steady_clock::time_point m_started;
+};
+
+// Reported by QueuedTypeActionSink
+struct QueueTelemetry {
+	size_t pending      = 0;
+	size_t peak_pending = 0;
+	// Enqueue to reply for deferred TYPE requests
+	LatencyHistogram wait = {};
+};
+
+// Reported by TextModeServer
+struct TransportTelemetry {
+	uint64_t bytes_sent = 0;
+	// Clients disconnected for staying over the outbound budget
+	uint64_t evicted_clients = 0;
+	// Clients connected right now
+	uint64_t sessions = 0;
+	// Time spent handing replies to the network backend
+	LatencyHistogram send = {};
+};
+
+// Emulator health sampled for METRICS and STATS JSON
+struct EmulatorTelemetry {
+	// Emulated milliseconds since startup (PIC_Ticks)
+	uint64_t emulated_ms = 0;
+	// Current cycles per emulated millisecond
+	int64_t cycles_per_ms = 0;
+	// Milliseconds the scheduler handed out versus ran since the last
+	// tick base reset; the gap is how far emulation lags the host clock
+	int64_t ticks_scheduled = 0;
+	int64_t ticks_done      = 0;
+	// Everything in the performance counter registry (PERF_Sample)
+	std::vector<PerfSample> counters = {};
+};
+
+} // namespace textmode
+
+#endif // DOSBOX_TEXTMODE_TELEMETRY_H
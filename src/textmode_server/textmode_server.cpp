@@ -5,19 +5,50 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <optional>
 #include <vector>
 
 #include "dosbox.h"
+#include "capture/image/image_decoder.h"
+#include "config/setup.h"
+#include "cpu/cpu.h"
+#include "gui/render.h"
+#include "misc/clone.h"
+#include "misc/footprint.h"
+#include "misc/perf_counters.h"
+#include "misc/profiler.h"
 #include "misc/logging.h"
+#include "misc/savestate.h"
+#include "misc/tracy.h"
+#include "textmode_server/image_encoder.h"
+#include "textmode_server/instance_pool.h"
 #include "textmode_server/keyboard_processor.h"
 #include "textmode_server/memory_access.h"
 #include "textmode_server/queued_type_action_sink.h"
 #include "textmode_server/server.h"
+#include "textmode_server/session_journal.h"
+#include "textmode_server/shared_frame.h"
+#include "textmode_server/threaded_backend.h"
+#include "textmode_server/websocket_backend.h"
+#include "utils/string_utils.h"
 #include "hardware/input/keyboard.h"
+#include "ints/bios.h"
+#include "hardware/pic.h"
+#include "hardware/video/vga.h"
+
+#if !defined(WIN32)
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 
 namespace {
 
@@ -27,6 +58,294 @@ bool g_close_after_response = false;
 std::unique_ptr<textmode::TextModeServer> g_server = nullptr;
 std::unique_ptr<textmode::KeyboardCommandProcessor> g_keyboard_processor = nullptr;
 std::shared_ptr<textmode::QueuedTypeActionSink> g_queued_sink = nullptr;
+textmode::SnapshotLatch g_retrace_latch = {};
+textmode::SharedFrameExport g_shared_frame = {};
+std::optional<uint64_t> g_shared_frame_generation = std::nullopt;
+
+// Frame reply shared by every request made while the latched content is
+// unchanged
+struct CachedFrame {
+	uint64_t generation = 0;
+	std::vector<std::string> keys_down = {};
+	textmode::ServiceResult result = {};
+};
+std::optional<CachedFrame> g_cached_frame = std::nullopt;
+
+// GETIMG requests waiting for the next rendered frame
+struct PendingImage {
+	textmode::CommandOrigin origin = {};
+	textmode::ImageRequest request = {};
+	// In emulated milliseconds
+	uint64_t deadline = 0;
+};
+std::vector<PendingImage> g_pending_images = {};
+textmode::ImageEncodeQueue g_image_queue   = {};
+constexpr size_t MaxPendingImages          = 16;
+constexpr uint64_t ImageTimeoutMs          = 1000;
+
+// Undoes baked-in double scanning and pixel doubling the same way raw
+// screenshots do, so the frame has the video mode's own dimensions
+textmode::FrameImage DecodeRenderedImage(const RenderedImage& image)
+{
+	const auto& src = image.params;
+
+	const uint8_t row_skip_count   = src.rendered_double_scan ? 1 : 0;
+	const uint8_t pixel_skip_count = src.rendered_pixel_doubling ? 1 : 0;
+
+	textmode::FrameImage frame = {};
+	frame.width   = static_cast<uint16_t>(src.width / (pixel_skip_count + 1));
+	frame.height  = static_cast<uint16_t>(src.height / (row_skip_count + 1));
+	frame.indexed = image.is_paletted();
+
+	ImageDecoder decoder = {};
+	decoder.Init(image, row_skip_count, pixel_skip_count);
+
+	const auto num_pixels = static_cast<size_t>(frame.width) * frame.height;
+	frame.pixels.reserve(frame.indexed ? num_pixels : num_pixels * 3);
+	for (uint16_t y = 0; y < frame.height; ++y) {
+		for (uint16_t x = 0; x < frame.width; ++x) {
+			if (frame.indexed) {
+				frame.pixels.push_back(decoder.GetNextIndexed8Pixel());
+			} else {
+				const auto pixel = decoder.GetNextPixelAsRgb888();
+				frame.pixels.push_back(pixel.red);
+				frame.pixels.push_back(pixel.green);
+				frame.pixels.push_back(pixel.blue);
+			}
+		}
+		decoder.AdvanceRow();
+	}
+
+	if (frame.indexed) {
+		// The renderer's palette has a padding byte after each entry
+		frame.palette.reserve(256 * 3);
+		for (size_t i = 0; i < 256; ++i) {
+			const auto entry = image.palette_data + i * 4;
+			frame.palette.insert(frame.palette.end(), entry, entry + 3);
+		}
+	}
+	return frame;
+}
+
+void SendEncodedImages()
+{
+	for (const auto& [client, payload] : g_image_queue.Collect()) {
+		if (g_server) {
+			g_server->Send(client, payload);
+		}
+	}
+	if (g_pending_images.empty()) {
+		return;
+	}
+	// The video card has stopped presenting frames, or never started
+	const uint64_t now = PIC_Ticks;
+	std::erase_if(g_pending_images, [now](const PendingImage& pending) {
+		if (now < pending.deadline) {
+			return false;
+		}
+		if (g_server) {
+			g_server->Send(pending.origin.client,
+			               textmode::TagResponse(pending.origin,
+			                                     "ERR GETIMG no frame rendered\n"));
+		}
+		return true;
+	});
+}
+
+// Session being recorded to ServiceConfig::record_journal; written out on
+// shutdown
+std::vector<textmode::JournalEntry> g_journal = {};
+std::optional<uint64_t> g_journal_frame_hash = std::nullopt;
+
+bool IsRecording()
+{
+	return g_active_config && g_active_config->enable &&
+	       !g_active_config->record_journal.empty();
+}
+
+void RecordKeyCommand(const std::string& command)
+{
+	if (auto entry = textmode::ParseKeyCommand(command, PIC_Ticks)) {
+		g_journal.push_back(std::move(*entry));
+	}
+}
+
+void RecordFrame(const textmode::ServiceResult& result)
+{
+	const auto hash = textmode::HashFrame(result.frame);
+	if (g_journal_frame_hash == hash) {
+		return;
+	}
+	g_journal_frame_hash = hash;
+
+	textmode::JournalEntry entry = {};
+	entry.tick = PIC_Ticks;
+	entry.kind = textmode::JournalEntry::Kind::Frame;
+	entry.hash = hash;
+	g_journal.push_back(std::move(entry));
+}
+
+void WriteJournal(const std::string& path)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	const auto data = textmode::EncodeJournal(g_journal);
+	if (!file.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+		LOG_WARNING("TEXTMODE: Unable to write session journal '%s'", path.c_str());
+		return;
+	}
+	LOG_MSG("TEXTMODE: Recorded %zu journal entries to '%s'",
+	        g_journal.size(),
+	        path.c_str());
+}
+
+// Session journal being replayed from the --replay command-line option
+struct Replay {
+	std::vector<textmode::JournalEntry> entries = {};
+	size_t next = 0;
+	// DOSBOX_GetLockstepTicks() value the latest grant runs up to
+	uint64_t granted_until = 0;
+	size_t frames_checked  = 0;
+	size_t mismatches      = 0;
+};
+std::optional<Replay> g_replay = std::nullopt;
+// Outlives Shutdown() so the exit code can report it
+bool g_replay_failed = false;
+
+bool LoadReplay(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file) {
+		LOG_ERR("TEXTMODE: Unable to open session journal '%s'", path.c_str());
+		return false;
+	}
+	const std::string data((std::istreambuf_iterator<char>(file)),
+	                       std::istreambuf_iterator<char>());
+
+	std::string error = {};
+	auto entries      = textmode::DecodeJournal(data, error);
+	if (!entries) {
+		LOG_ERR("TEXTMODE: Unable to replay '%s': %s", path.c_str(), error.c_str());
+		return false;
+	}
+	LOG_MSG("TEXTMODE: Replaying %zu journal entries from '%s'",
+	        entries->size(),
+	        path.c_str());
+	g_replay = Replay{std::move(*entries)};
+	return true;
+}
+
+// Set in a fresh clone; applied once the CLONE command has unwound, since
+// the server and processor handling it are replaced
+std::optional<textmode::ServiceConfig> g_pending_clone_config = std::nullopt;
+
+// Set while this instance supervises a pool
+std::unique_ptr<textmode::InstancePool> g_pool = nullptr;
+
+// In a fresh clone: lets go of the parent's clients, listener, pool
+// instances, and shared frame, then queues 'config' for the next poll
+void BecomeClone(textmode::ServiceConfig config)
+{
+	if (g_server) {
+		g_server->AbandonAfterFork();
+	}
+	if (g_pool) {
+		g_pool->AbandonAfterFork();
+	}
+	g_shared_frame.Abandon();
+	config.shm_name.clear();
+	config.record_journal.clear();
+	config.replay_journal.clear();
+	config.pool_size = 0;
+	g_pending_clone_config = std::move(config);
+}
+
+#if !defined(WIN32)
+// Forks a pool instance that serves one end of a socket pair
+std::optional<textmode::PoolInstance> LaunchPoolInstance(std::string& error)
+{
+	int sockets[2] = {-1, -1};
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+		error = std::string("socketpair failed: ") + std::strerror(errno);
+		return {};
+	}
+
+	if (g_server) {
+		g_server->SuspendForFork();
+	}
+	const auto pid = CLONE_ForkInstance(error);
+	if (pid != 0) {
+		if (g_server) {
+			g_server->ResumeAfterFork();
+		}
+		::close(sockets[1]);
+		if (pid < 0) {
+			::close(sockets[0]);
+			return {};
+		}
+		// Should this fail, the instance sees its socket close and exits
+		auto link = textmode::MakeConnectedSocketBackend(sockets[0]);
+		if (!link->Start(0)) {
+			error = "unable to serve the instance's socket";
+			return {};
+		}
+		return textmode::PoolInstance{pid, std::move(link)};
+	}
+
+	::close(sockets[0]);
+	auto config = g_active_config.value_or(textmode::ServiceConfig{});
+	config.socket_path.clear();
+	config.websocket        = false;
+	config.connected_socket = sockets[1];
+	BecomeClone(std::move(config));
+	return {};
+}
+#endif
+
+// Turns this instance into the supervisor of a pool of warm clones of its
+// machine, which stops here for good so they all start from this point
+textmode::PoolStartResult StartPool()
+{
+	textmode::PoolStartResult result = {};
+
+	const auto config = g_active_config.value_or(textmode::ServiceConfig{});
+	if (config.pool_size == 0) {
+		result.error = "POOL needs 'pool_size'";
+		return result;
+	}
+	if (g_pool) {
+		result.error = "POOL already running";
+		return result;
+	}
+	if (config.websocket) {
+		result.error = "POOL can't forward WebSocket clients";
+		return result;
+	}
+#if defined(WIN32)
+	result.error = "pools are not supported on this platform";
+	return result;
+#else
+	textmode::PoolHooks hooks = {};
+	hooks.launch              = LaunchPoolInstance;
+	hooks.send = [](const textmode::ClientHandle client, const std::string& data) {
+		return g_server && g_server->Send(client, data);
+	};
+	hooks.close = [](const textmode::ClientHandle client) {
+		if (g_server) {
+			g_server->Close(client);
+		}
+	};
+	g_pool = std::make_unique<textmode::InstancePool>(config.pool_size,
+	                                                  std::move(hooks));
+
+	// Only granted time runs in lockstep, and none is granted from here on
+	DOSBOX_SetLockstep(true);
+	LOG_MSG("TEXTMODE: Supervising a pool of %u instances", config.pool_size);
+
+	result.success = true;
+	result.size    = config.pool_size;
+	return result;
+#endif
+}
 
 std::string ExpandEnv(const std::string& value)
 {
@@ -66,16 +385,51 @@ uint32_t CombineSegmentOffset(const uint32_t segment, const uint32_t offset)
 	return static_cast<uint32_t>(address);
 }
 
-void EnsureServer()
+void EnsureServer(const textmode::ServiceConfig& config)
 {
 	if (!g_server) {
-		g_server = std::make_unique<textmode::TextModeServer>(textmode::MakeSdlNetBackend());
+		std::unique_ptr<textmode::NetworkBackend> backend;
+		if (!config.socket_path.empty()) {
+			backend = textmode::MakeLocalSocketBackend(config.socket_path);
+		} else if (config.network_backend == "native") {
+			backend = textmode::MakeNativeNetBackend();
+		} else {
+			backend = textmode::MakeSdlNetBackend();
+		}
+		if (config.connected_socket >= 0) {
+			backend = textmode::MakeConnectedSocketBackend(config.connected_socket);
+		}
+		if (config.websocket) {
+			backend = textmode::MakeWebSocketBackend(std::move(backend));
+		}
+		if (config.io_thread) {
+			backend = textmode::MakeThreadedBackend(std::move(backend));
+		}
+		g_server = std::make_unique<textmode::TextModeServer>(std::move(backend));
 		if (g_server) {
 			g_server->SetClientCloseCallback([](textmode::ClientHandle client) {
 				if (g_queued_sink) {
 					g_queued_sink->CancelClient(client);
 				}
+				if (g_pool) {
+					g_pool->Release(client);
+				}
+				// A pool instance has served its one client
+				if (g_active_config && g_active_config->connected_socket >= 0) {
+					shutdown_requested = true;
+				}
 			});
+			g_server->SetForwarder(
+			        [](textmode::ClientHandle client) {
+				        if (!g_pool) {
+					        return false;
+				        }
+				        g_pool->Assign(client);
+				        return true;
+			        },
+			        [](textmode::ClientHandle client, const std::string& data) {
+				        g_pool->Forward(client, data);
+			        });
 		}
 	}
 }
@@ -90,13 +444,185 @@ void EnsureKeyboard()
 
 textmode::ServiceResult ProvideFrame()
 {
+	static const std::vector<std::string> NoKeys = {};
+	const auto& keys_down = g_keyboard_processor ? g_keyboard_processor->ActiveKeys()
+	                                             : NoKeys;
+
+	// Keyed on content, so idle screens reuse one encoding across refreshes
+	const auto* latched    = g_retrace_latch.Latest();
+	const auto generation  = g_retrace_latch.ContentGeneration();
+	if (latched && g_cached_frame && g_cached_frame->generation == generation &&
+	    g_cached_frame->keys_down == keys_down) {
+		if (IsRecording()) {
+			RecordFrame(g_cached_frame->result);
+		}
+		return g_cached_frame->result;
+	}
+
 	const auto config = g_active_config.value_or(textmode::ServiceConfig{});
-	std::vector<std::string> keys_down;
-	if (g_keyboard_processor) {
-		keys_down = g_keyboard_processor->ActiveKeys();
+	textmode::TextModeService service(config, keys_down, latched);
+	auto result = service.GetFrame();
+	if (latched) {
+		result.generation = generation;
+		g_cached_frame = CachedFrame{generation, keys_down, result};
+	}
+	if (IsRecording() && result.success) {
+		RecordFrame(result);
+	}
+	return result;
+}
+
+// Applies the journal entries due at the current tick, then grants the
+// machine the ticks up to the next one. Entries are only applied while the
+// machine idles between grants, so each lands on the exact tick it was
+// recorded at.
+void PollReplay()
+{
+	if (!g_replay || DOSBOX_GetLockstepTicks() < g_replay->granted_until) {
+		return;
+	}
+	auto& replay       = *g_replay;
+	const uint64_t now = PIC_Ticks;
+	while (replay.next < replay.entries.size() && replay.entries[replay.next].tick <= now) {
+		const auto& entry = replay.entries[replay.next++];
+		if (entry.kind != textmode::JournalEntry::Kind::Frame) {
+			if (g_keyboard_processor) {
+				g_keyboard_processor->HandleCommand(textmode::FormatKeyCommand(entry));
+			}
+			continue;
+		}
+		++replay.frames_checked;
+		if (textmode::HashFrame(ProvideFrame().frame) != entry.hash) {
+			++replay.mismatches;
+			LOG_WARNING("TEXTMODE: Replayed frame at tick %llu differs from the recording",
+			            static_cast<unsigned long long>(entry.tick));
+		}
+	}
+
+	if (replay.next < replay.entries.size()) {
+		const auto wait = std::min<uint64_t>(replay.entries[replay.next].tick - now,
+		                                     std::numeric_limits<uint32_t>::max());
+		replay.granted_until = DOSBOX_GrantTicks(static_cast<uint32_t>(wait));
+		return;
 	}
-	textmode::TextModeService service(config, std::move(keys_down));
-	return service.GetFrame();
+
+	LOG_MSG("TEXTMODE: Replay finished, %zu of %zu frames matched",
+	        replay.frames_checked - replay.mismatches,
+	        replay.frames_checked);
+	g_replay_failed    = replay.mismatches > 0;
+	shutdown_requested = true;
+	g_replay.reset();
+}
+
+// Applies the settings that can change while the server runs. Both CONFIG
+// and SET change them on the emulation thread between commands, so there
+// is no TYPE action or reply in flight to disturb.
+void ApplyRuntimeSettings(const textmode::ServiceConfig& config)
+{
+	g_close_after_response = config.close_after_response;
+
+	if (g_processor) {
+		g_processor->SetMacroInterkeyFrames(
+		        config.guest_paced_typing ? 0 : config.macro_interkey_frames);
+		g_processor->SetDebugRegion(CombineSegmentOffset(config.debug_segment,
+		                                                 config.debug_offset),
+		                            config.debug_length);
+	}
+
+	if (g_server) {
+		g_server->SetOutboundBudget(static_cast<size_t>(config.send_budget_kb) * 1024,
+		                            std::chrono::milliseconds(config.slow_client_ms));
+		g_server->SetCloseAfterResponse(g_close_after_response);
+	}
+
+	if (g_queued_sink) {
+		g_queued_sink->SetCloseAfterResponse(g_close_after_response);
+		g_queued_sink->SetInterTokenFrameDelay(config.inter_token_frame_delay);
+		if (config.guest_paced_typing) {
+			g_queued_sink->SetKeyboardReadyProbe([] {
+				// A few keys of type-ahead keep DOS and its programs busy
+				// without risking the 15-key BIOS buffer overflowing
+				constexpr uint16_t MaxBufferedKeys = 4;
+				return KEYBOARD_IsIdle() &&
+				       (BIOS_IsKeyboardIrqHooked() ||
+				        BIOS_GetNumBufferedKeys() < MaxBufferedKeys);
+			});
+		} else {
+			g_queued_sink->SetKeyboardReadyProbe({});
+		}
+	}
+}
+
+// Takes over the settings changed at runtime; the ones that can only change
+// at startup keep their values, as CONFIG only queues those
+void UpdateRuntimeSettings(const textmode::ServiceConfig& config)
+{
+	assert(g_active_config);
+	auto& active = *g_active_config;
+
+	if (active.auth_token != config.auth_token && g_server) {
+		// Every client has to authenticate again with the new token
+		g_server->SetAuthToken(config.auth_token);
+	}
+
+	active.show_attributes         = config.show_attributes;
+	active.sentinel                = config.sentinel;
+	active.close_after_response    = config.close_after_response;
+	active.macro_interkey_frames   = config.macro_interkey_frames;
+	active.inter_token_frame_delay = config.inter_token_frame_delay;
+	active.guest_paced_typing      = config.guest_paced_typing;
+	active.debug_segment           = config.debug_segment;
+	active.debug_offset            = config.debug_offset;
+	active.debug_length            = config.debug_length;
+	active.auth_token              = config.auth_token;
+	active.send_budget_kb          = config.send_budget_kb;
+	active.slow_client_ms          = config.slow_client_ms;
+
+	// The cached reply may be encoded with the old attributes or sentinel
+	g_cached_frame.reset();
+
+	ApplyRuntimeSettings(active);
+}
+
+// Serves SET: changes a setting the way CONFIG -set does, which re-runs
+// its section's runtime init and so applies it right away
+textmode::ConfigResult ChangeSetting(const std::string& name, const std::string& value)
+{
+	textmode::ConfigResult result = {};
+	if (!control) {
+		result.error = "config unavailable";
+		return result;
+	}
+
+	const auto dot         = name.find('.');
+	const auto has_section = (dot != std::string::npos);
+	const auto prop_name   = has_section ? name.substr(dot + 1) : name;
+
+	auto* section = dynamic_cast<SectionProp*>(
+	        has_section ? control->GetSection(name.substr(0, dot))
+	                    : control->GetSectionFromProperty(prop_name.c_str()));
+
+	auto* property = section ? section->GetProperty(prop_name) : nullptr;
+	if (!property || property->IsDeprecated()) {
+		result.error = "unknown setting '" + name + "'";
+		return result;
+	}
+	if (property->GetChange() == Property::Changeable::OnlyAtStart) {
+		result.error = "'" + name + "' can only be set at startup";
+		return result;
+	}
+
+	section->ExecuteDestroy(false);
+	const auto is_valid = property->SetValue(value);
+	section->ExecuteInit(false);
+
+	if (!is_valid) {
+		result.error = "invalid value for '" + name + "'";
+		return result;
+	}
+	result.success = true;
+	result.value   = property->GetValue().ToString();
+	return result;
 }
 
 void ApplyConfigSection(Section* section)
@@ -116,6 +642,7 @@ void ApplyConfigSection(Section* section)
 	        std::max(0, props->GetInt("macro_interkey_frames")));
 	config.inter_token_frame_delay = static_cast<uint32_t>(
 	        std::max(0, props->GetInt("inter_token_frame_delay")));
+	config.guest_paced_typing = (props->GetString("type_pacing") == "guest");
 	config.debug_segment = static_cast<uint32_t>(props->GetHex("debug_segment"));
 	config.debug_offset  = static_cast<uint32_t>(props->GetHex("debug_offset"));
 	config.debug_length  = static_cast<uint32_t>(std::max(0, props->GetInt("debug_length")));
@@ -129,6 +656,36 @@ void ApplyConfigSection(Section* section)
 		}
 	}
 	config.auth_token = std::move(auth_token);
+	config.network_backend = props->GetString("network_backend");
+	config.max_clients     = static_cast<uint32_t>(std::max(1, props->GetInt("max_clients")));
+	config.send_budget_kb  = static_cast<uint32_t>(std::max(0, props->GetInt("send_budget_kb")));
+	config.slow_client_ms  = static_cast<uint32_t>(std::max(1, props->GetInt("slow_client_ms")));
+	config.io_thread       = props->GetBool("io_thread");
+	config.socket_path     = ExpandEnv(props->GetString("socket_path"));
+	config.shm_name        = ExpandEnv(props->GetString("shm_name"));
+	config.websocket       = props->GetBool("websocket");
+	config.lockstep        = props->GetBool("lockstep");
+	config.record_journal  = ExpandEnv(props->GetString("record_journal"));
+	config.pool_size       = static_cast<uint32_t>(std::max(0, props->GetInt("pool_size")));
+	config.pool_waits_for_command = (props->GetString("pool_start") == "command");
+
+	if (g_active_config) {
+		UpdateRuntimeSettings(config);
+		return;
+	}
+
+	// A replay drives the server itself, so it must be listening for frames
+	// and in charge of emulated time
+	config.replay_journal = control ? control->arguments.replay : std::string{};
+	if (!config.replay_journal.empty()) {
+		config.enable   = true;
+		config.lockstep = true;
+		config.record_journal.clear();
+		if (!g_replay && !LoadReplay(config.replay_journal)) {
+			g_replay_failed    = true;
+			shutdown_requested = true;
+		}
+	}
 
 	textmode::Configure(config);
 }
@@ -140,8 +697,13 @@ void TEXTMODESERVER_AddConfigSection(const ConfigPtr& conf)
 	assert(conf);
 
 	constexpr auto only_at_start = Property::Changeable::OnlyAtStart;
+	constexpr auto always        = Property::Changeable::Always;
 
-	auto* section = conf->AddSectionProp("textmode_server", &ApplyConfigSection);
+	constexpr auto changeable_at_runtime = true;
+
+	auto* section = conf->AddSectionProp("textmode_server",
+	                                     &ApplyConfigSection,
+	                                     changeable_at_runtime);
 	assert(section);
 
 	auto* enable = section->AddBool("enable", only_at_start, false);
@@ -152,52 +714,148 @@ void TEXTMODESERVER_AddConfigSection(const ConfigPtr& conf)
 	port->SetHelp(
 	        "TCP port used by the server (6000 by default). Valid range is 1024-65535.");
 
-	auto* show_attributes = section->AddBool("show_attributes", only_at_start, true);
+	auto* show_attributes = section->AddBool("show_attributes", always, true);
 	show_attributes->SetHelp(
 	        "Emit ANSI colour escape sequences when true; emit plain text when false.");
 
 	static constexpr char sentinel_default[] = "\xF0\x9F\x96\xB5";
-	auto* sentinel = section->AddString("sentinel", only_at_start, sentinel_default);
+	auto* sentinel = section->AddString("sentinel", always, sentinel_default);
 	sentinel->SetHelp(
 	        "UTF-8 sentinel glyph used to delimit metadata and payload lines (default 🖵).");
 
 	auto* close_after_response = section->AddBool("close_after_response",
-	                                             only_at_start,
+	                                             always,
 	                                             false);
 	close_after_response->SetHelp(
 	        "Close the TCP connection after each command response (off by default).");
 
 	auto* macro_interkey_frames = section->AddInt("macro_interkey_frames",
-	                                             only_at_start,
+	                                             always,
 	                                             1);
 	macro_interkey_frames->SetMinMax(0, 60);
 	macro_interkey_frames->SetHelp(
 	        "Frames inserted between characters when expanding quoted TYPE strings (default 1).");
 
 	auto* inter_token_frames = section->AddInt("inter_token_frame_delay",
-	                                         only_at_start,
+	                                         always,
 	                                         1);
 	inter_token_frames->SetMinMax(0, 60);
 	inter_token_frames->SetHelp(
 	        "Frames to wait between TYPE tokens when processing queued actions (default 1).");
 
-	auto* debug_segment = section->AddHex("debug_segment", only_at_start, 0);
+	auto* type_pacing = section->AddString("type_pacing", always, "frames");
+	type_pacing->SetValues({"frames", "guest"});
+	type_pacing->SetHelp(
+	        "How TYPE spaces key actions ('frames' by default):\n"
+	        "  frames:  Wait 'macro_interkey_frames' and 'inter_token_frame_delay'.\n"
+	        "  guest:   Send the next key once the guest has read the previous one\n"
+	        "           from the keyboard controller and the BIOS keyboard buffer\n"
+	        "           isn't backing up, so typing runs as fast as programs read.");
+
+	auto* debug_segment = section->AddHex("debug_segment", always, 0);
 	debug_segment->SetHelp(
 	        "Real-mode segment used as the base for DEBUG responses (default 0).");
 
-	auto* debug_offset = section->AddHex("debug_offset", only_at_start, 0);
+	auto* debug_offset = section->AddHex("debug_offset", always, 0);
 	debug_offset->SetHelp(
 	        "Offset added to the segment base for DEBUG responses (default 0).");
 
-	auto* debug_length = section->AddInt("debug_length", only_at_start, 0);
+	auto* debug_length = section->AddInt("debug_length", always, 0);
 	debug_length->SetMinMax(0, 4096);
 	debug_length->SetHelp(
 	        "Number of bytes returned by DEBUG (default 0 disables the region).");
 
-	auto* auth_token = section->AddString("auth_token", only_at_start, "");
+	auto* auth_token = section->AddString("auth_token", always, "");
 	auth_token->SetHelp(
 	        "Shared secret required by AUTH. Supports ${ENV} expansion. Leave empty to disable.");
 
+	auto* max_clients = section->AddInt("max_clients", only_at_start, 32);
+	max_clients->SetMinMax(1, 1024);
+	max_clients->SetHelp(
+	        "Maximum number of simultaneous client connections (32 by default).\n"
+	        "Further connections are refused and counted as 'rejected' in STATS.");
+
+	auto* send_budget_kb = section->AddInt("send_budget_kb", always, 1024);
+	send_budget_kb->SetMinMax(0, 1024 * 1024);
+	send_budget_kb->SetHelp(
+	        "Unsent reply data in KiB a client may have queued before it counts as\n"
+	        "slow (1024 by default, 0 disables). WATCH frames for a slow client are\n"
+	        "held back and it gets the newest screen once it catches up. Needs the\n"
+	        "'native' backend or 'io_thread', since 'sdl' sends block instead.");
+
+	auto* slow_client_ms = section->AddInt("slow_client_ms", always, 10000);
+	slow_client_ms->SetMinMax(1, 3600 * 1000);
+	slow_client_ms->SetHelp(
+	        "Disconnect a client that stays over 'send_budget_kb' for this many\n"
+	        "milliseconds (10000 by default). Evictions are counted in STATS.");
+
+	auto* network_backend = section->AddString("network_backend", only_at_start, "sdl");
+	network_backend->SetValues({"sdl", "native"});
+	network_backend->SetHelp(
+	        "Socket implementation used by the server ('sdl' by default):\n"
+	        "  sdl:     SDL_net sockets; sends block until the client has read the reply.\n"
+	        "  native:  Non-blocking OS sockets (epoll on Linux, poll elsewhere) with a\n"
+	        "           bounded per-client send queue, so slow clients never stall\n"
+	        "           the emulator.");
+
+	auto* io_thread = section->AddBool("io_thread", only_at_start, true);
+	io_thread->SetHelp(
+	        "Run socket I/O on a dedicated thread so accepting, receiving and sending\n"
+	        "never take time from the emulation thread (enabled by default). Commands\n"
+	        "are still executed on the emulation thread once per frame.");
+
+	auto* socket_path = section->AddString("socket_path", only_at_start, "");
+	socket_path->SetHelp(
+	        "Listen on a Unix domain socket at this path instead of the TCP port\n"
+	        "(empty by default). Co-located clients skip the loopback TCP stack, and\n"
+	        "many instances can share a host without port collisions. Supports\n"
+	        "${ENV} expansion. On Windows this needs Windows 10 1803 or later.");
+
+	auto* shm_name = section->AddString("shm_name", only_at_start, "");
+	shm_name->SetHelp(
+	        "Publish every latched text frame to a named shared-memory object (empty\n"
+	        "by default). Local readers map it and copy frames without a request or\n"
+	        "socket round-trip; a sequence counter tells them when a copy was torn.\n"
+	        "Created as /<name> under POSIX and Local\\<name> on Windows. Supports\n"
+	        "${ENV} expansion.");
+
+	auto* websocket = section->AddBool("websocket", only_at_start, false);
+	websocket->SetHelp(
+	        "Also accept WebSocket (RFC 6455) clients on the listener (disabled by\n"
+	        "default), so browser dashboards can connect without a proxy. Each\n"
+	        "message carries one command and each reply is sent as one message.\n"
+	        "permessage-deflate is used when the browser offers it.");
+
+	auto* lockstep = section->AddBool("lockstep", only_at_start, false);
+	lockstep->SetHelp(
+	        "Decouple emulated time from the host clock (disabled by default). The\n"
+	        "machine then only runs the milliseconds clients grant with STEP, as fast\n"
+	        "as the host allows, and idles in between. This makes test runs\n"
+	        "reproducible and lets CPU-bound steps finish faster than real time.");
+
+	auto* record_journal = section->AddString("record_journal", only_at_start, "");
+	record_journal->SetHelp(
+	        "Record the session to this file on exit (empty by default): every key\n"
+	        "action with the emulated millisecond it was applied at, and a hash of\n"
+	        "every distinct frame served. Run 'dosbox --replay <file>' to play it back\n"
+	        "in lockstep and check the frames; this needs fixed 'cpu_cycles' to hold.\n"
+	        "Supports ${ENV} expansion.");
+
+	auto* pool_size = section->AddInt("pool_size", only_at_start, 0);
+	pool_size->SetMinMax(0, 256);
+	pool_size->SetHelp(
+	        "Supervise a pool of this many warm instances (0 by default, disabled).\n"
+	        "Once ready, this machine stops and is cloned that many times. Each client\n"
+	        "connecting from then on is served by a clone of its own, which a fresh one\n"
+	        "replaces when the client leaves. Needs a headless setup, as CLONE does.");
+
+	auto* pool_start = section->AddString("pool_start", only_at_start, "prompt");
+	pool_start->SetValues({"prompt", "command"});
+	pool_start->SetHelp(
+	        "When the pool's machine is ready ('prompt' by default):\n"
+	        "  prompt:   At the first shell prompt, once AUTOEXEC has run.\n"
+	        "  command:  When a client sends POOL START, so it can set the machine up\n"
+	        "            first.");
 }
 
 namespace textmode {
@@ -205,13 +863,25 @@ namespace textmode {
 void Configure(const ServiceConfig& config)
 {
 	g_active_config = config;
-	g_close_after_response = config.close_after_response;
+	DOSBOX_SetLockstep(config.enable && config.lockstep);
 	EnsureKeyboard();
+	if (config.enable && !config.shm_name.empty()) {
+		if (!g_shared_frame.IsOpen()) {
+			g_shared_frame.Open(config.shm_name);
+			g_shared_frame_generation.reset();
+		}
+	} else {
+		g_shared_frame.Close();
+	}
 	auto keyboard_handler = [](const std::string& command) -> CommandResponse {
 		if (!g_keyboard_processor) {
 			return {false, "ERR keyboard unavailable\n"};
 		}
-		return g_keyboard_processor->HandleCommand(command);
+		auto response = g_keyboard_processor->HandleCommand(command);
+		if (response.ok && IsRecording()) {
+			RecordKeyCommand(command);
+		}
+		return response;
 	};
 
 	auto exit_handler = [] { shutdown_requested = true; };
@@ -221,8 +891,6 @@ void Configure(const ServiceConfig& config)
 		}
 		return g_keyboard_processor->ActiveKeys();
 	};
-	const auto debug_address = CombineSegmentOffset(config.debug_segment,
-	                                               config.debug_offset);
 	auto memory_reader = [](uint32_t offset, uint32_t length) {
 		return textmode::PeekMemoryRegion(offset, length);
 	};
@@ -236,14 +904,206 @@ void Configure(const ServiceConfig& config)
 	                   memory_reader,
 	                   memory_writer);
 	if (g_processor) {
-		g_processor->SetMacroInterkeyFrames(config.macro_interkey_frames);
-		g_processor->SetDebugRegion(debug_address, config.debug_length);
+		g_processor->SetFrameGenerationProvider([] {
+			return g_retrace_latch.Latest() ? g_retrace_latch.ContentGeneration()
+			                                : uint64_t{0};
+		});
+		g_processor->SetRegionFrameProvider([](const textmode::TextRegion& region) {
+			const auto config = g_active_config.value_or(textmode::ServiceConfig{});
+			std::vector<std::string> keys_down;
+			if (g_keyboard_processor) {
+				keys_down = g_keyboard_processor->ActiveKeys();
+			}
+			textmode::TextModeService service(config,
+			                                  std::move(keys_down),
+			                                  g_retrace_latch.Latest());
+			return service.GetRegion(region);
+		});
+		g_processor->SetGraphicsTextProvider([] {
+			const auto config = g_active_config.value_or(textmode::ServiceConfig{});
+			std::vector<std::string> keys_down;
+			if (g_keyboard_processor) {
+				keys_down = g_keyboard_processor->ActiveKeys();
+			}
+			textmode::TextModeService service(config, std::move(keys_down));
+			return service.GetGraphicsText();
+		});
+		g_processor->SetRejectedClientsProvider([] {
+			return g_server ? g_server->RejectedClients() : uint64_t{0};
+		});
+		g_processor->SetQueueTelemetryProvider([] {
+			return g_queued_sink ? g_queued_sink->Telemetry()
+			                     : textmode::QueueTelemetry{};
+		});
+		g_processor->SetTransportTelemetryProvider([] {
+			return g_server ? g_server->Telemetry() : textmode::TransportTelemetry{};
+		});
+		g_processor->SetEmulatorTelemetryProvider([] {
+			textmode::EmulatorTelemetry telemetry = {};
+			telemetry.emulated_ms     = static_cast<uint64_t>(PIC_Ticks);
+			telemetry.cycles_per_ms   = CPU_CycleMax;
+			telemetry.ticks_scheduled = DOSBOX_GetTicksScheduled();
+			telemetry.ticks_done      = DOSBOX_GetTicksDone();
+			telemetry.counters        = PERF_Sample();
+			return telemetry;
+		});
+		g_processor->SetSaveStateHandlers(
+		        [](const std::string& slot) {
+			        textmode::SaveStateResult result = {};
+			        result.success = SAVESTATE_SaveSlot(slot, result.error, &result.bytes);
+			        return result;
+		        },
+		        [](const std::string& slot) {
+			        textmode::SaveStateResult result = {};
+			        result.success = SAVESTATE_LoadSlot(slot, result.error);
+			        if (result.success) {
+				        // Serve the restored screen right away rather than
+				        // the frame latched before the restore
+				        g_cached_frame.reset();
+				        g_retrace_latch.Latch(vga);
+			        }
+			        return result;
+		        });
+		g_processor->SetCheckpointHandlers(
+		        [] {
+			        textmode::CheckpointResult result = {};
+			        CheckpointInfo info               = {};
+			        result.success = SAVESTATE_Checkpoint(info, result.error);
+			        result.id      = info.id;
+			        result.pages   = info.num_pages;
+			        result.bytes   = info.num_bytes;
+			        return result;
+		        },
+		        [](const uint32_t id) {
+			        textmode::CheckpointResult result = {};
+			        result.success = SAVESTATE_RestoreCheckpoint(id, result.error);
+			        if (result.success) {
+				        g_cached_frame.reset();
+				        g_retrace_latch.Latch(vga);
+			        }
+			        return result;
+		        });
+		g_processor->SetCloneHandler([](const textmode::CloneRequest& request) {
+			textmode::CloneResult result = {};
+			if (g_server) {
+				g_server->SuspendForFork();
+			}
+			const auto pid = CLONE_ForkInstance(result.error);
+			if (pid != 0) {
+				if (g_server) {
+					g_server->ResumeAfterFork();
+				}
+				result.success = (pid > 0);
+				result.pid     = pid;
+				return result;
+			}
+
+			// In the clone, which listens anew on the requested address
+			auto clone_config = g_active_config.value_or(textmode::ServiceConfig{});
+			if (request.socket_path.empty()) {
+				clone_config.port = request.port;
+			}
+			clone_config.socket_path = request.socket_path;
+			BecomeClone(std::move(clone_config));
+			result.success = true;
+			return result;
+		});
+		g_processor->SetStepHandlers(
+		        [](const textmode::StepRequest& request) {
+			        textmode::StepResult result = {};
+			        if (g_pool) {
+				        result.error = "the pool supervisor's machine is stopped";
+				        return result;
+			        }
+			        if (!DOSBOX_IsLockstep()) {
+				        result.error = "lockstep disabled";
+				        return result;
+			        }
+			        // Frames follow the current mode's refresh rate
+			        constexpr double DefaultFramePeriodMs = 1000.0 / 70.0;
+			        const auto frame_ms = vga.draw.delay.vtotal > 0.0
+			                                    ? vga.draw.delay.vtotal
+			                                    : DefaultFramePeriodMs;
+			        result.ticks = request.frames
+			                             ? static_cast<uint32_t>(std::ceil(
+			                                       request.amount * frame_ms))
+			                             : request.amount;
+			        result.until   = DOSBOX_GrantTicks(result.ticks);
+			        result.success = true;
+			        return result;
+		        },
+		        [] { return DOSBOX_GetLockstepTicks(); });
+		g_processor->SetPasteHandler([](const std::string& text) {
+			textmode::PasteResult result = {};
+			if (BIOS_IsKeyboardIrqHooked()) {
+				result.success        = true;
+				result.use_keystrokes = true;
+				return result;
+			}
+			std::vector<uint16_t> codes = {};
+			codes.reserve(text.size());
+			for (const char ch : text) {
+				if (const auto code = BIOS_GetKeyCodeForChar(ch); code != 0) {
+					codes.push_back(code);
+				}
+			}
+			if (!BIOS_QueueKeys(codes)) {
+				result.error = "PASTE queue full";
+				return result;
+			}
+			result.success = true;
+			return result;
+		});
+		g_processor->SetTurboHandlers([](const bool engage) {
+			return DOSBOX_SetFastForward(engage);
+		}, [] { return static_cast<uint64_t>(PIC_Ticks); });
+		g_processor->SetConfigHandler(ChangeSetting);
+		g_processor->SetProfileHandlers(PROFILER_Start, [] {
+			textmode::ProfileReport report = {};
+			if (!PROFILER_IsRunning()) {
+				report.error = "PROFILE not running";
+				return report;
+			}
+			report.samples = PROFILER_NumSamples();
+			report.folded  = PROFILER_Stop();
+			report.success = true;
+			return report;
+		});
+		g_processor->SetMemoryHandlers(
+		        [] {
+			        textmode::MemoryReport report = {};
+			        report.profile = FOOTPRINT_GetProfileName();
+			        report.regions = FOOTPRINT_Sample();
+			        if (const auto rss = FOOTPRINT_GetProcessResidentBytes()) {
+				        report.resident_bytes = *rss;
+			        }
+			        return report;
+		        },
+		        [] { return static_cast<uint64_t>(FOOTPRINT_Trim()); });
+		g_processor->SetPoolHandlers(StartPool, []() -> std::optional<textmode::PoolStats> {
+			if (!g_pool) {
+				return {};
+			}
+			return g_pool->Stats();
+		});
+		g_processor->SetImageHandler([](const textmode::CommandOrigin& origin,
+		                                const textmode::ImageRequest& request) {
+			textmode::ImageResult result = {};
+			if (g_pending_images.size() >= MaxPendingImages) {
+				result.error = "GETIMG queue full";
+				return result;
+			}
+			g_pending_images.push_back(
+			        {origin, request, static_cast<uint64_t>(PIC_Ticks) + ImageTimeoutMs});
+			result.success = true;
+			return result;
+		});
 	}
 
-	EnsureServer();
+	EnsureServer(config);
 	if (g_server) {
 		g_server->SetAuthToken(config.auth_token);
-		g_server->SetCloseAfterResponse(g_close_after_response);
+		g_server->SetMaxClients(config.max_clients);
 	}
 
 	if (!g_queued_sink) {
@@ -262,10 +1122,7 @@ void Configure(const ServiceConfig& config)
 		});
 	}
 
-	if (g_queued_sink) {
-		g_queued_sink->SetCloseAfterResponse(g_close_after_response);
-		g_queued_sink->SetInterTokenFrameDelay(config.inter_token_frame_delay);
-	}
+	ApplyRuntimeSettings(config);
 
 	if (g_processor) {
 		g_processor->SetTypeActionSink(g_queued_sink);
@@ -302,16 +1159,41 @@ CommandResponse HandleCommand(const std::string& command)
 
 void Poll()
 {
+	ZoneScoped;
+
 	if (g_server) {
 		g_server->Poll();
 	}
+	if (g_pool) {
+		g_pool->Poll();
+	}
+	if (g_pending_clone_config) {
+		const auto config = std::move(*g_pending_clone_config);
+		g_pending_clone_config.reset();
+		g_server.reset();
+		g_pool.reset();
+		g_queued_sink.reset();
+		g_cached_frame.reset();
+		g_pending_images.clear();
+		g_journal.clear();
+		g_replay.reset();
+		Configure(config);
+	}
 	if (g_queued_sink) {
 		g_queued_sink->Poll();
 	}
+	// The guest drains the buffer between polls, so refill it each time
+	BIOS_FeedQueuedKeys();
+	SendEncodedImages();
+	PollReplay();
 }
 
 void Shutdown()
 {
+	if (IsRecording()) {
+		WriteJournal(g_active_config->record_journal);
+	}
+	g_pool.reset();
 	if (g_server) {
 		g_server->Stop();
 	}
@@ -323,6 +1205,17 @@ void Shutdown()
 	g_keyboard_processor.reset();
 	g_active_config.reset();
 	g_queued_sink.reset();
+	g_retrace_latch.Reset();
+	g_cached_frame.reset();
+	g_shared_frame.Close();
+	g_shared_frame_generation.reset();
+	BIOS_ClearQueuedKeys();
+	g_pending_images.clear();
+	g_image_queue.Drain();
+	g_image_queue.Collect();
+	g_journal.clear();
+	g_journal_frame_hash.reset();
+	g_replay.reset();
 }
 
 } // namespace textmode
@@ -332,3 +1225,151 @@ std::string TEXTMODESERVER_HandleCommand(const std::string& command)
 	const auto response = textmode::HandleCommand(command);
 	return response.payload;
 }
+
+void TEXTMODESERVER_OnVerticalRetrace()
+{
+	if (!g_active_config || !g_active_config->enable) {
+		return;
+	}
+	ZoneScoped;
+
+	g_retrace_latch.Latch(vga);
+	if (g_shared_frame.IsOpen()) {
+		const auto generation = g_retrace_latch.ContentGeneration();
+		if (g_shared_frame_generation != generation) {
+			g_shared_frame.Publish(g_retrace_latch.Latest(), generation);
+			g_shared_frame_generation = generation;
+		}
+	}
+	if (g_processor) {
+		g_processor->SampleMemoryWatches(PIC_Ticks);
+	}
+}
+
+bool TEXTMODESERVER_IsRenderedFrameRequested()
+{
+	return !g_pending_images.empty();
+}
+
+static PerfCounter rendered_frames("textmode_rendered_frames",
+                                   "Rendered frames taken for image requests.");
+
+void TEXTMODESERVER_OnRenderedFrame(const SharedRenderedImage& frame)
+{
+	if (g_pending_images.empty() || !frame) {
+		return;
+	}
+	ZoneScoped;
+	rendered_frames.Add();
+
+	// The renderer's one shared copy of the frame serves every request
+	// that was waiting for it; converting and encoding happen off the
+	// emulation thread
+	for (const auto& pending : std::exchange(g_pending_images, {})) {
+		g_image_queue.Submit(pending.origin.client, [frame, pending] {
+			const auto decoded = DecodeRenderedImage(*frame);
+			const auto scaled  = textmode::ScaleImage(decoded, pending.request.scale);
+			return textmode::TagResponse(pending.origin,
+			                             textmode::BuildImageReply(scaled,
+			                                                       pending.request.format));
+		});
+	}
+}
+
+// Emulator events
+// ~~~~~~~~~~~~~~~
+// The hooks run on the emulation thread, as the command processor does,
+// and describe nothing while no client has subscribed with EVENTS. Ticks
+// are emulated milliseconds, like the MEMCHANGE ones.
+
+static bool is_posting_events()
+{
+	return g_processor && g_processor->HasEventSubscribers();
+}
+
+static void post_event(const std::string_view type, const std::string& fields)
+{
+	g_processor->PostEvent(PIC_Ticks, type, fields);
+}
+
+void TEXTMODESERVER_OnVideoModeChanged(const VideoMode& mode)
+{
+	if (!is_posting_events()) {
+		return;
+	}
+	post_event("mode",
+	           format_str("mode=0x%02x width=%d height=%d graphics=%d",
+	                      mode.bios_mode_number,
+	                      mode.width,
+	                      mode.height,
+	                      mode.is_graphics_mode ? 1 : 0));
+}
+
+void TEXTMODESERVER_OnBeep(const int frequency_hz)
+{
+	if (!is_posting_events()) {
+		return;
+	}
+	post_event("beep", format_str("frequency=%d", frequency_hz));
+}
+
+void TEXTMODESERVER_OnProgramStarted(const uint16_t psp_segment, const char* path)
+{
+	if (!is_posting_events()) {
+		return;
+	}
+	post_event("exec", format_str("psp=0x%04x path=%s", psp_segment, path));
+}
+
+void TEXTMODESERVER_OnProgramExited(const uint16_t psp_segment, const char* name,
+                                    const uint8_t exit_code, const bool is_tsr)
+{
+	if (!is_posting_events()) {
+		return;
+	}
+	post_event("exit",
+	           format_str("psp=0x%04x name=%s code=%u tsr=%d",
+	                      psp_segment,
+	                      name,
+	                      exit_code,
+	                      is_tsr ? 1 : 0));
+}
+
+void TEXTMODESERVER_OnDosError(const uint16_t code)
+{
+	// Write protected through general failure, and the sharing and lock
+	// violations: the errors real DOS hands to the INT 24h handler. The
+	// emulated DOS returns them to the caller instead.
+	constexpr uint16_t FirstCriticalError = 0x13;
+	constexpr uint16_t LastCriticalError  = 0x21;
+
+	if (code < FirstCriticalError || code > LastCriticalError ||
+	    !is_posting_events()) {
+		return;
+	}
+	post_event("critical", format_str("code=0x%02x", code));
+}
+
+void TEXTMODESERVER_OnShellPrompt(const char* path)
+{
+	// The first prompt, once AUTOEXEC has run, is where the pool starts
+	static bool is_first_prompt = true;
+	if (std::exchange(is_first_prompt, false) && g_active_config &&
+	    g_active_config->enable && g_active_config->pool_size > 0 &&
+	    !g_active_config->pool_waits_for_command) {
+		if (const auto result = StartPool(); !result.success) {
+			LOG_WARNING("TEXTMODE: Unable to start the pool: %s",
+			            result.error.c_str());
+		}
+	}
+
+	if (!is_posting_events()) {
+		return;
+	}
+	post_event("prompt", format_str("path=%s", path));
+}
+
+bool TEXTMODESERVER_ReplayFailed()
+{
+	return g_replay_failed;
+}
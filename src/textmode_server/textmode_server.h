@@ -4,11 +4,17 @@
 #ifndef DOSBOX_TEXTMODE_SERVER_H
 #define DOSBOX_TEXTMODE_SERVER_H
 
+#include <cstdint>
+#include <memory>
+
 #include "config/config.h"
 
 #include "textmode_server/command_processor.h"
 #include "textmode_server/service.h"
 
+struct RenderedImage;
+struct VideoMode;
+
 void TEXTMODESERVER_AddConfigSection(const ConfigPtr& conf);
 
 namespace textmode {
@@ -22,4 +28,39 @@ void Shutdown();
 
 std::string TEXTMODESERVER_HandleCommand(const std::string& command);
 
+// Latches the visible text plane; called once per vertical retrace
+void TEXTMODESERVER_OnVerticalRetrace();
+
+// Whether a GETIMG request is waiting, so the renderer keeps the next frame
+bool TEXTMODESERVER_IsRenderedFrameRequested();
+
+// Hands the frame the renderer just finished to waiting GETIMG requests,
+// which hold on to it until they're encoded
+void TEXTMODESERVER_OnRenderedFrame(
+        const std::shared_ptr<const RenderedImage>& image);
+
+// Emulator events pushed to EVENTS subscribers. Each returns at once
+// while nobody is subscribed.
+
+// The video mode the VGA draws changed
+void TEXTMODESERVER_OnVideoModeChanged(const VideoMode& mode);
+
+// The PC speaker started sounding the PIT's tone
+void TEXTMODESERVER_OnBeep(int frequency_hz);
+
+// DOS started a program, or one it started exited
+void TEXTMODESERVER_OnProgramStarted(uint16_t psp_segment, const char* path);
+void TEXTMODESERVER_OnProgramExited(uint16_t psp_segment, const char* name,
+                                    uint8_t exit_code, bool is_tsr);
+
+// DOS is returning an error code; only those real DOS raises INT 24h for
+// become events
+void TEXTMODESERVER_OnDosError(uint16_t code);
+
+// The shell is waiting for a command at its prompt in 'path'
+void TEXTMODESERVER_OnShellPrompt(const char* path);
+
+// Whether a --replay run could not load its journal or saw a frame differ
+bool TEXTMODESERVER_ReplayFailed();
+
 #endif // DOSBOX_TEXTMODE_SERVER_H
@@ -0,0 +1,324 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/threaded_backend.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "misc/support.h"
+#include "utils/rwqueue_impl.h"
+
+namespace textmode {
+
+namespace {
+
+constexpr size_t EventQueueCapacity   = 4096;
+constexpr size_t RequestQueueCapacity = 4096;
+
+// How long the network thread sleeps when a pass found no work
+constexpr auto IdleSleep = std::chrono::milliseconds(1);
+
+// Drains whatever is queued without blocking; only valid for the sole
+// consumer of the queue.
+template <typename T>
+void drain(RWQueue<T>& queue, std::vector<T>& into)
+{
+	into.clear();
+	if (const auto available = queue.Size(); available > 0) {
+		queue.BulkDequeue(into, available);
+	}
+}
+
+class ThreadedBackend final : public NetworkBackend {
+public:
+	explicit ThreadedBackend(std::unique_ptr<NetworkBackend> inner)
+	        : m_inner(std::move(inner))
+	{
+		assert(m_inner);
+	}
+
+	ThreadedBackend(const ThreadedBackend&)            = delete;
+	ThreadedBackend& operator=(const ThreadedBackend&) = delete;
+
+	~ThreadedBackend() override { Stop(); }
+
+	bool Start(const uint16_t port) override
+	{
+		Stop();
+
+		m_inner->SetMaxClients(m_max_clients);
+		if (!m_inner->Start(port)) {
+			return false;
+		}
+
+		m_events.Start();
+		m_requests.Start();
+		m_running = true;
+		m_thread  = std::thread(&ThreadedBackend::Run, this);
+		set_thread_name(m_thread, "dosbox:textmode");
+		return true;
+	}
+
+	void Stop() override
+	{
+		if (!m_thread.joinable()) {
+			return;
+		}
+
+		m_running = false;
+		m_events.Stop();
+		m_requests.Stop();
+		m_thread.join();
+
+		m_inner->Stop();
+		m_events.Clear();
+		m_requests.Clear();
+		m_open_clients.clear();
+		m_pending_closes.clear();
+		m_flushing.clear();
+		ClearBacklog();
+	}
+
+	std::vector<BackendEvent> Poll() override
+	{
+		std::erase_if(m_pending_closes,
+		              [&](const ClientHandle client) { return QueueClose(client); });
+
+		drain(m_events, m_incoming);
+
+		std::vector<BackendEvent> events;
+		events.reserve(m_incoming.size());
+		for (auto& event : m_incoming) {
+			// Events can still arrive for clients this side already closed
+			if (event.type == BackendEvent::Type::Connected) {
+				m_open_clients.insert(event.client);
+			} else if (!m_open_clients.contains(event.client)) {
+				continue;
+			} else if (event.type == BackendEvent::Type::Closed) {
+				m_open_clients.erase(event.client);
+			}
+			events.emplace_back(std::move(event));
+		}
+		return events;
+	}
+
+	bool Send(const ClientHandle client, const std::string& payload) override
+	{
+		if (!m_open_clients.contains(client)) {
+			return false;
+		}
+		// Counted first, so the network thread never settles bytes that
+		// were not counted yet
+		const auto size = payload.size();
+		{
+			std::lock_guard lock(m_backlog_mutex);
+			m_backlog[client].requested += size;
+		}
+		// A full queue means the network thread has fallen far behind;
+		// failing the send drops the client rather than stalling emulation.
+		if (!m_requests.NonblockingEnqueue(
+		            BackendRequest{BackendRequest::Type::Send, client, payload})) {
+			Settle(client, size);
+			return false;
+		}
+		return true;
+	}
+
+	void Close(const ClientHandle client) override
+	{
+		if (m_open_clients.erase(client) == 0) {
+			return;
+		}
+		{
+			std::lock_guard lock(m_backlog_mutex);
+			m_backlog.erase(client);
+		}
+		// Like Send(), this never waits on a full queue, which would stall
+		// emulation and never end while the network thread is suspended;
+		// Poll() retries until the close goes through
+		if (!QueueClose(client)) {
+			m_pending_closes.push_back(client);
+		}
+	}
+
+	void SetMaxClients(const size_t max_clients) override
+	{
+		m_max_clients = max_clients;
+	}
+
+	uint64_t RejectedClients() const override { return m_rejected_clients; }
+
+	size_t QueuedBytes(const ClientHandle client) const override
+	{
+		std::lock_guard lock(m_backlog_mutex);
+		const auto it = m_backlog.find(client);
+		return it == m_backlog.end() ? 0 : it->second.requested + it->second.inner;
+	}
+
+	void SuspendForFork() override
+	{
+		if (!m_thread.joinable()) {
+			return;
+		}
+
+		// Unlike Stop(), the queues keep running so nothing the thread
+		// is handing over is lost; requests wait for ResumeAfterFork()
+		m_running = false;
+		m_thread.join();
+		m_is_suspended = true;
+	}
+
+	void ResumeAfterFork() override
+	{
+		if (!m_is_suspended) {
+			return;
+		}
+		m_is_suspended = false;
+
+		m_running = true;
+		m_thread  = std::thread(&ThreadedBackend::Run, this);
+		set_thread_name(m_thread, "dosbox:textmode");
+	}
+
+	void AbandonAfterFork() override
+	{
+		m_is_suspended = false;
+		m_inner->AbandonAfterFork();
+		m_events.Clear();
+		m_requests.Clear();
+		m_incoming.clear();
+		m_open_clients.clear();
+		m_pending_closes.clear();
+		m_flushing.clear();
+		ClearBacklog();
+	}
+
+private:
+	bool QueueClose(const ClientHandle client)
+	{
+		return m_requests.NonblockingEnqueue(
+		        BackendRequest{BackendRequest::Type::Close, client});
+	}
+
+	void Run()
+	{
+		std::vector<BackendRequest> requests;
+		std::vector<BackendEvent> failures;
+
+		while (m_running) {
+			drain(m_requests, requests);
+			for (auto& request : requests) {
+				if (request.type == BackendRequest::Type::Close) {
+					m_inner->Close(request.client);
+					m_flushing.erase(request.client);
+				} else if (!m_inner->Send(request.client, request.payload)) {
+					m_inner->Close(request.client);
+					failures.emplace_back(BackendEvent::Closed(request.client));
+				} else {
+					m_flushing.insert(request.client);
+				}
+				if (request.type == BackendRequest::Type::Send) {
+					Settle(request.client, request.payload.size());
+				}
+			}
+
+			auto events = m_inner->Poll();
+			m_rejected_clients = m_inner->RejectedClients();
+			PublishInnerBacklog();
+
+			const bool idle = requests.empty() && events.empty() &&
+			                  failures.empty();
+			if (!failures.empty()) {
+				m_events.BulkEnqueue(failures);
+			}
+			if (!events.empty()) {
+				m_events.BulkEnqueue(events);
+			}
+			if (idle) {
+				std::this_thread::sleep_for(IdleSleep);
+			}
+		}
+	}
+
+	// Hands 'size' bytes of a Send() request over to the inner backend
+	void Settle(const ClientHandle client, const size_t size)
+	{
+		std::lock_guard lock(m_backlog_mutex);
+		if (const auto it = m_backlog.find(client); it != m_backlog.end()) {
+			it->second.requested -= std::min(it->second.requested, size);
+		}
+	}
+
+	// Refreshes what the inner backend still holds for the clients sent
+	// to since their queue last drained
+	void PublishInnerBacklog()
+	{
+		if (m_flushing.empty()) {
+			return;
+		}
+		std::lock_guard lock(m_backlog_mutex);
+		for (auto it = m_flushing.begin(); it != m_flushing.end();) {
+			const auto queued = m_inner->QueuedBytes(*it);
+			if (const auto entry = m_backlog.find(*it); entry != m_backlog.end()) {
+				entry->second.inner = queued;
+			}
+			it = queued == 0 ? m_flushing.erase(it) : std::next(it);
+		}
+	}
+
+	void ClearBacklog()
+	{
+		std::lock_guard lock(m_backlog_mutex);
+		m_backlog.clear();
+	}
+
+	std::unique_ptr<NetworkBackend> m_inner;
+	std::thread m_thread = {};
+	std::atomic<bool> m_running = false;
+	bool m_is_suspended         = false;
+	std::atomic<uint64_t> m_rejected_clients = 0;
+	size_t m_max_clients = DefaultMaxClients;
+
+	RWQueue<BackendEvent> m_events{EventQueueCapacity};
+	RWQueue<BackendRequest> m_requests{RequestQueueCapacity};
+
+	// Unsent bytes per client: those still in the request queue, and those
+	// the inner backend reported holding after the network thread's last
+	// pass
+	struct Backlog {
+		size_t requested = 0;
+		size_t inner     = 0;
+	};
+	mutable std::mutex m_backlog_mutex = {};
+	std::unordered_map<ClientHandle, Backlog> m_backlog = {};
+
+	// Owned by the polling thread
+	std::vector<BackendEvent> m_incoming = {};
+	std::unordered_set<ClientHandle> m_open_clients = {};
+	std::vector<ClientHandle> m_pending_closes = {};
+
+	// Owned by the network thread
+	std::unordered_set<ClientHandle> m_flushing = {};
+};
+
+} // namespace
+
+std::unique_ptr<NetworkBackend> MakeThreadedBackend(std::unique_ptr<NetworkBackend> inner)
+{
+	return std::make_unique<ThreadedBackend>(std::move(inner));
+}
+
+} // namespace textmode
+
+template class RWQueue<textmode::BackendEvent>;
+template class RWQueue<textmode::BackendRequest>;
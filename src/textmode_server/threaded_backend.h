@@ -0,0 +1,35 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEXTMODE_THREADED_BACKEND_H
+#define DOSBOX_TEXTMODE_THREADED_BACKEND_H
+
+#include "textmode_server/server.h"
+
+#include <memory>
+#include <string>
+
+namespace textmode {
+
+// Work handed from the emulation thread to the network thread
+struct BackendRequest {
+	enum class Type {
+		Send,
+		Close,
+	};
+
+	Type type              = Type::Close;
+	ClientHandle client    = 0;
+	std::string payload    = {};
+};
+
+// Runs the wrapped backend's accept/recv/send loop on a dedicated thread.
+// Poll(), Send() and Close() only exchange queued events and requests with
+// that thread, so they never block the caller on socket I/O. Commands are
+// still dispatched on the thread calling Poll() because they touch emulated
+// state.
+std::unique_ptr<NetworkBackend> MakeThreadedBackend(std::unique_ptr<NetworkBackend> inner);
+
+} // namespace textmode
+
+#endif // DOSBOX_TEXTMODE_THREADED_BACKEND_H
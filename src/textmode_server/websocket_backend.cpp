@@ -0,0 +1,734 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/websocket_backend.h"
+
+#include "textmode_server/deflate_stream.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cctype>
+#include <cstdlib>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace textmode {
+
+namespace {
+
+constexpr std::string_view UpgradePrefix = "GET /";
+constexpr std::string_view WebSocketGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+// Upper bound for the request line plus headers of an upgrade request
+constexpr size_t MaxHandshakeBytes = 8192;
+
+// Upper bound for one incoming message, before and after inflating
+constexpr size_t MaxMessageBytes = 1024 * 1024;
+
+constexpr int MaxWindowBits = 15;
+
+// The trailer a sync flush leaves, which permessage-deflate strips
+constexpr std::string_view DeflateTrailer = {"\x00\x00\xff\xff", 4};
+
+enum Opcode : uint8_t {
+	Continuation = 0x0,
+	Text         = 0x1,
+	Binary       = 0x2,
+	CloseFrame   = 0x8,
+	Ping         = 0x9,
+	Pong         = 0xA,
+};
+
+enum CloseCode : uint16_t {
+	NormalClosure   = 1000,
+	ProtocolError   = 1002,
+	InvalidPayload  = 1007,
+	MessageTooBig   = 1009,
+};
+
+std::array<uint8_t, 20> sha1(const std::string& input)
+{
+	std::array<uint32_t, 5> state = {
+	        0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+	std::string data = input;
+	const uint64_t bit_length = static_cast<uint64_t>(input.size()) * 8;
+	data.push_back('\x80');
+	while (data.size() % 64 != 56) {
+		data.push_back('\0');
+	}
+	for (int shift = 56; shift >= 0; shift -= 8) {
+		data.push_back(static_cast<char>((bit_length >> shift) & 0xff));
+	}
+
+	for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+		std::array<uint32_t, 80> words = {};
+		for (size_t i = 0; i < 16; ++i) {
+			const auto* bytes = reinterpret_cast<const uint8_t*>(
+			        data.data() + chunk + i * 4);
+			words[i] = (uint32_t{bytes[0]} << 24) | (uint32_t{bytes[1]} << 16) |
+			           (uint32_t{bytes[2]} << 8) | uint32_t{bytes[3]};
+		}
+		for (size_t i = 16; i < 80; ++i) {
+			words[i] = std::rotl(words[i - 3] ^ words[i - 8] ^
+			                             words[i - 14] ^ words[i - 16],
+			                     1);
+		}
+
+		auto [a, b, c, d, e] = state;
+		for (size_t i = 0; i < 80; ++i) {
+			uint32_t f = 0;
+			uint32_t k = 0;
+			if (i < 20) {
+				f = (b & c) | (~b & d);
+				k = 0x5A827999;
+			} else if (i < 40) {
+				f = b ^ c ^ d;
+				k = 0x6ED9EBA1;
+			} else if (i < 60) {
+				f = (b & c) | (b & d) | (c & d);
+				k = 0x8F1BBCDC;
+			} else {
+				f = b ^ c ^ d;
+				k = 0xCA62C1D6;
+			}
+			const auto next = std::rotl(a, 5) + f + e + k + words[i];
+			e = d;
+			d = c;
+			c = std::rotl(b, 30);
+			b = a;
+			a = next;
+		}
+		state[0] += a;
+		state[1] += b;
+		state[2] += c;
+		state[3] += d;
+		state[4] += e;
+	}
+
+	std::array<uint8_t, 20> digest = {};
+	for (size_t i = 0; i < digest.size(); ++i) {
+		digest[i] = static_cast<uint8_t>(state[i / 4] >> (24 - (i % 4) * 8));
+	}
+	return digest;
+}
+
+template <size_t N>
+std::string base64(const std::array<uint8_t, N>& bytes)
+{
+	constexpr std::string_view alphabet =
+	        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	std::string encoded;
+	for (size_t i = 0; i < N; i += 3) {
+		const auto remaining = N - i;
+		uint32_t group       = uint32_t{bytes[i]} << 16;
+		if (remaining > 1) {
+			group |= uint32_t{bytes[i + 1]} << 8;
+		}
+		if (remaining > 2) {
+			group |= bytes[i + 2];
+		}
+		encoded.push_back(alphabet[(group >> 18) & 0x3f]);
+		encoded.push_back(alphabet[(group >> 12) & 0x3f]);
+		encoded.push_back(remaining > 1 ? alphabet[(group >> 6) & 0x3f] : '=');
+		encoded.push_back(remaining > 2 ? alphabet[group & 0x3f] : '=');
+	}
+	return encoded;
+}
+
+bool is_valid_utf8(const std::string& text)
+{
+	size_t i = 0;
+	while (i < text.size()) {
+		const auto lead = static_cast<uint8_t>(text[i]);
+		if (lead < 0x80) {
+			++i;
+			continue;
+		}
+
+		size_t extra      = 0;
+		uint32_t code     = 0;
+		uint32_t smallest = 0;
+		if ((lead & 0xE0) == 0xC0) {
+			extra    = 1;
+			code     = lead & 0x1F;
+			smallest = 0x80;
+		} else if ((lead & 0xF0) == 0xE0) {
+			extra    = 2;
+			code     = lead & 0x0F;
+			smallest = 0x800;
+		} else if ((lead & 0xF8) == 0xF0) {
+			extra    = 3;
+			code     = lead & 0x07;
+			smallest = 0x10000;
+		} else {
+			return false;
+		}
+		if (i + extra >= text.size()) {
+			return false;
+		}
+		for (size_t k = 1; k <= extra; ++k) {
+			const auto next = static_cast<uint8_t>(text[i + k]);
+			if ((next & 0xC0) != 0x80) {
+				return false;
+			}
+			code = (code << 6) | (next & 0x3F);
+		}
+		if (code < smallest || code > 0x10FFFF ||
+		    (code >= 0xD800 && code <= 0xDFFF)) {
+			return false;
+		}
+		i += extra + 1;
+	}
+	return true;
+}
+
+std::string make_frame(const uint8_t opcode, const std::string& payload,
+                       const bool compressed = false)
+{
+	std::string frame;
+	frame.reserve(payload.size() + 10);
+	frame.push_back(static_cast<char>(0x80 | (compressed ? 0x40 : 0) | opcode));
+
+	const auto size = static_cast<uint64_t>(payload.size());
+	if (size < 126) {
+		frame.push_back(static_cast<char>(size));
+	} else if (size <= 0xffff) {
+		frame.push_back(static_cast<char>(126));
+		frame.push_back(static_cast<char>(size >> 8));
+		frame.push_back(static_cast<char>(size & 0xff));
+	} else {
+		frame.push_back(static_cast<char>(127));
+		for (int shift = 56; shift >= 0; shift -= 8) {
+			frame.push_back(static_cast<char>((size >> shift) & 0xff));
+		}
+	}
+	frame += payload;
+	return frame;
+}
+
+std::string make_close_frame(const uint16_t code)
+{
+	const std::string payload = {static_cast<char>(code >> 8),
+	                             static_cast<char>(code & 0xff)};
+	return make_frame(CloseFrame, payload);
+}
+
+std::string to_lower(std::string text)
+{
+	std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) {
+		return static_cast<char>(std::tolower(c));
+	});
+	return text;
+}
+
+std::string trim(const std::string& text)
+{
+	const auto first = text.find_first_not_of(" \t");
+	if (first == std::string::npos) {
+		return {};
+	}
+	const auto last = text.find_last_not_of(" \t");
+	return text.substr(first, last - first + 1);
+}
+
+std::vector<std::string> split(const std::string& text, const char separator)
+{
+	std::vector<std::string> parts;
+	size_t start = 0;
+	while (true) {
+		const auto end = text.find(separator, start);
+		parts.emplace_back(trim(text.substr(start, end - start)));
+		if (end == std::string::npos) {
+			return parts;
+		}
+		start = end + 1;
+	}
+}
+
+struct DeflateOffer {
+	bool server_no_context_takeover = false;
+	bool client_no_context_takeover = false;
+	std::optional<int> server_max_window_bits = std::nullopt;
+};
+
+// Picks the first permessage-deflate offer whose parameters we can honour
+std::optional<DeflateOffer> choose_deflate_offer(const std::string& header)
+{
+	for (const auto& offer : split(header, ',')) {
+		const auto params = split(offer, ';');
+		if (to_lower(params.front()) != "permessage-deflate") {
+			continue;
+		}
+
+		DeflateOffer chosen = {};
+		bool usable         = true;
+		for (size_t i = 1; i < params.size() && usable; ++i) {
+			const auto equals = params[i].find('=');
+			const auto name   = to_lower(trim(params[i].substr(0, equals)));
+			auto value        = equals == std::string::npos
+			                          ? std::string{}
+			                          : trim(params[i].substr(equals + 1));
+			if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+				value = value.substr(1, value.size() - 2);
+			}
+
+			if (name == "server_no_context_takeover") {
+				chosen.server_no_context_takeover = true;
+			} else if (name == "client_no_context_takeover") {
+				chosen.client_no_context_takeover = true;
+			} else if (name == "server_max_window_bits") {
+				// zlib cannot produce raw streams with an 8-bit window
+				const int bits = std::atoi(value.c_str());
+				usable = bits >= 9 && bits <= MaxWindowBits;
+				chosen.server_max_window_bits = bits;
+			} else if (name == "client_max_window_bits") {
+				// Only a hint; we may leave it out of the response
+			} else {
+				usable = false;
+			}
+		}
+		if (usable) {
+			return chosen;
+		}
+	}
+	return std::nullopt;
+}
+
+class WebSocketBackend final : public NetworkBackend {
+public:
+	explicit WebSocketBackend(std::unique_ptr<NetworkBackend> inner)
+	        : m_inner(std::move(inner))
+	{
+		assert(m_inner);
+	}
+
+	WebSocketBackend(const WebSocketBackend&)            = delete;
+	WebSocketBackend& operator=(const WebSocketBackend&) = delete;
+
+	~WebSocketBackend() override { Stop(); }
+
+	bool Start(const uint16_t port) override
+	{
+		m_connections.clear();
+		return m_inner->Start(port);
+	}
+
+	void Stop() override
+	{
+		m_inner->Stop();
+		m_connections.clear();
+	}
+
+	std::vector<BackendEvent> Poll() override
+	{
+		std::vector<BackendEvent> events;
+		for (auto& event : m_inner->Poll()) {
+			switch (event.type) {
+			case BackendEvent::Type::Connected:
+				m_connections[event.client] = Connection{};
+				break;
+			case BackendEvent::Type::Data: {
+				auto it = m_connections.find(event.client);
+				if (it == m_connections.end()) {
+					break;
+				}
+				if (!Receive(event.client, it->second, event.data, events)) {
+					m_connections.erase(it);
+				}
+				break;
+			}
+			case BackendEvent::Type::Closed: {
+				auto it = m_connections.find(event.client);
+				if (it == m_connections.end()) {
+					break;
+				}
+				// Clients still being identified were never announced
+				if (it->second.announced) {
+					events.emplace_back(BackendEvent::Closed(event.client));
+				}
+				m_connections.erase(it);
+				break;
+			}
+			}
+		}
+		return events;
+	}
+
+	bool Send(const ClientHandle client, const std::string& payload) override
+	{
+		auto it = m_connections.find(client);
+		if (it == m_connections.end() || !it->second.announced) {
+			return false;
+		}
+		auto& connection = it->second;
+		if (connection.mode == Mode::Raw) {
+			return m_inner->Send(client, payload);
+		}
+
+		// Text messages must be valid UTF-8; binary PEEKV replies are not
+		const uint8_t opcode = is_valid_utf8(payload) ? Text : Binary;
+		if (!connection.deflater.IsReady()) {
+			return m_inner->Send(client, make_frame(opcode, payload));
+		}
+		auto compressed = connection.deflater.Compress(payload);
+		if (compressed.ends_with(DeflateTrailer)) {
+			compressed.resize(compressed.size() - DeflateTrailer.size());
+		}
+		if (connection.reset_deflater) {
+			connection.deflater.Reset();
+		}
+		return m_inner->Send(client, make_frame(opcode, compressed, true));
+	}
+
+	void Close(const ClientHandle client) override
+	{
+		auto it = m_connections.find(client);
+		if (it == m_connections.end()) {
+			return;
+		}
+		if (it->second.mode == Mode::WebSocket) {
+			m_inner->Send(client, make_close_frame(NormalClosure));
+		}
+		m_inner->Close(client);
+		m_connections.erase(it);
+	}
+
+	void SetMaxClients(const size_t max_clients) override
+	{
+		m_inner->SetMaxClients(max_clients);
+	}
+
+	uint64_t RejectedClients() const override
+	{
+		return m_inner->RejectedClients();
+	}
+
+	size_t QueuedBytes(const ClientHandle client) const override
+	{
+		return m_inner->QueuedBytes(client);
+	}
+
+	void SuspendForFork() override
+	{
+		m_inner->SuspendForFork();
+	}
+
+	void ResumeAfterFork() override
+	{
+		m_inner->ResumeAfterFork();
+	}
+
+	void AbandonAfterFork() override
+	{
+		m_inner->AbandonAfterFork();
+		m_connections.clear();
+	}
+
+private:
+	enum class Mode {
+		Sniffing,
+		Handshake,
+		Raw,
+		WebSocket,
+	};
+
+	struct Connection {
+		Mode mode      = Mode::Sniffing;
+		bool announced = false;
+		std::string buffer = {};
+
+		// Data message being reassembled from fragments
+		bool in_message         = false;
+		bool message_compressed = false;
+		std::string message     = {};
+
+		// Ready once permessage-deflate was negotiated
+		DeflateStream deflater = {};
+		InflateStream inflater = {};
+		bool reset_deflater    = false;
+	};
+
+	// Returns false once the connection is gone
+	bool Receive(const ClientHandle client, Connection& connection,
+	             const std::string& data, std::vector<BackendEvent>& events)
+	{
+		if (connection.mode == Mode::Raw) {
+			events.emplace_back(BackendEvent::Data(client, data));
+			return true;
+		}
+		connection.buffer += data;
+
+		if (connection.mode == Mode::Sniffing) {
+			const auto compared = std::min(connection.buffer.size(),
+			                               UpgradePrefix.size());
+			if (connection.buffer.compare(0, compared, UpgradePrefix, 0, compared) != 0) {
+				connection.mode      = Mode::Raw;
+				connection.announced = true;
+				events.emplace_back(BackendEvent::Connected(client));
+				events.emplace_back(BackendEvent::Data(
+				        client, std::exchange(connection.buffer, {})));
+				return true;
+			}
+			if (compared < UpgradePrefix.size()) {
+				return true;
+			}
+			connection.mode = Mode::Handshake;
+		}
+
+		if (connection.mode == Mode::Handshake) {
+			const auto end = connection.buffer.find("\r\n\r\n");
+			if (end == std::string::npos) {
+				if (connection.buffer.size() > MaxHandshakeBytes) {
+					Reject(client);
+					return false;
+				}
+				return true;
+			}
+			if (!Upgrade(client, connection, connection.buffer.substr(0, end))) {
+				Reject(client);
+				return false;
+			}
+			connection.buffer.erase(0, end + 4);
+			connection.mode      = Mode::WebSocket;
+			connection.announced = true;
+			events.emplace_back(BackendEvent::Connected(client));
+		}
+
+		return ReadFrames(client, connection, events);
+	}
+
+	void Reject(const ClientHandle client)
+	{
+		m_inner->Send(client,
+		              "HTTP/1.1 400 Bad Request\r\n"
+		              "Connection: close\r\n"
+		              "Content-Length: 0\r\n\r\n");
+		m_inner->Close(client);
+	}
+
+	bool Upgrade(const ClientHandle client, Connection& connection,
+	             const std::string& request)
+	{
+		const auto lines = split(request, '\n');
+		if (lines.empty() || lines.front().find(" HTTP/1.1") == std::string::npos) {
+			return false;
+		}
+
+		std::unordered_map<std::string, std::string> headers;
+		for (size_t i = 1; i < lines.size(); ++i) {
+			auto line = lines[i];
+			if (!line.empty() && line.back() == '\r') {
+				line.pop_back();
+			}
+			const auto colon = line.find(':');
+			if (colon == std::string::npos) {
+				continue;
+			}
+			auto& value = headers[to_lower(trim(line.substr(0, colon)))];
+			if (!value.empty()) {
+				value += ", ";
+			}
+			value += trim(line.substr(colon + 1));
+		}
+
+		const auto upgrade = to_lower(headers["upgrade"]);
+		const auto key     = headers["sec-websocket-key"];
+		if (upgrade.find("websocket") == std::string::npos || key.empty() ||
+		    headers["sec-websocket-version"] != "13") {
+			return false;
+		}
+
+		std::string response =
+		        "HTTP/1.1 101 Switching Protocols\r\n"
+		        "Upgrade: websocket\r\n"
+		        "Connection: Upgrade\r\n"
+		        "Sec-WebSocket-Accept: " +
+		        WebSocketAcceptKey(key) + "\r\n";
+
+		if (const auto offer = choose_deflate_offer(headers["sec-websocket-extensions"])) {
+			const int window_bits = offer->server_max_window_bits.value_or(MaxWindowBits);
+			DeflateStream deflater = {};
+			InflateStream inflater = {};
+			// The inflater accepts every window size a client may pick
+			if (deflater.Init(DeflateFormat::Raw, window_bits) &&
+			    inflater.Init(DeflateFormat::Raw, MaxWindowBits)) {
+				response += "Sec-WebSocket-Extensions: permessage-deflate";
+				if (offer->server_no_context_takeover) {
+					response += "; server_no_context_takeover";
+				}
+				if (offer->client_no_context_takeover) {
+					response += "; client_no_context_takeover";
+				}
+				if (offer->server_max_window_bits) {
+					response += "; server_max_window_bits=" +
+					            std::to_string(window_bits);
+				}
+				response += "\r\n";
+				connection.deflater = std::move(deflater);
+				connection.inflater = std::move(inflater);
+				connection.reset_deflater = offer->server_no_context_takeover;
+			}
+		}
+		response += "\r\n";
+		return m_inner->Send(client, response);
+	}
+
+	bool ReadFrames(const ClientHandle client, Connection& connection,
+	                std::vector<BackendEvent>& events)
+	{
+		const auto& buffer = connection.buffer;
+		size_t offset      = 0;
+
+		while (buffer.size() - offset >= 2) {
+			const auto* bytes = reinterpret_cast<const uint8_t*>(buffer.data()) + offset;
+			const auto available = buffer.size() - offset;
+
+			const bool fin      = (bytes[0] & 0x80) != 0;
+			const bool rsv1     = (bytes[0] & 0x40) != 0;
+			const uint8_t opcode = bytes[0] & 0x0f;
+			const bool masked   = (bytes[1] & 0x80) != 0;
+			uint64_t length     = bytes[1] & 0x7f;
+
+			const bool control = (opcode & 0x08) != 0;
+			// Clients must mask, and only the first frame of a data message
+			// may carry the compression bit
+			if (!masked || (bytes[0] & 0x30) != 0 ||
+			    (rsv1 && (!connection.inflater.IsReady() || control || opcode == Continuation)) ||
+			    (control && (!fin || length > 125))) {
+				return Fail(client, ProtocolError, events);
+			}
+
+			size_t header = 2;
+			if (length == 126) {
+				header = 4;
+			} else if (length == 127) {
+				header = 10;
+			}
+			if (available < header + 4) {
+				break;
+			}
+			if (length == 126) {
+				length = (uint64_t{bytes[2]} << 8) | bytes[3];
+			} else if (length == 127) {
+				length = 0;
+				for (size_t i = 2; i < 10; ++i) {
+					length = (length << 8) | bytes[i];
+				}
+			}
+
+			if (length > MaxMessageBytes) {
+				return Fail(client, MessageTooBig, events);
+			}
+			if (available < header + 4 + length) {
+				break;
+			}
+
+			const auto* mask = bytes + header;
+			std::string payload(reinterpret_cast<const char*>(mask + 4),
+			                    static_cast<size_t>(length));
+			for (size_t i = 0; i < payload.size(); ++i) {
+				payload[i] = static_cast<char>(payload[i] ^ mask[i % 4]);
+			}
+			offset += header + 4 + static_cast<size_t>(length);
+
+			if (!HandleFrame(client, connection, fin, rsv1, opcode, std::move(payload), events)) {
+				return false;
+			}
+		}
+
+		connection.buffer.erase(0, offset);
+		return true;
+	}
+
+	bool HandleFrame(const ClientHandle client, Connection& connection,
+	                 const bool fin, const bool compressed, const uint8_t opcode,
+	                 std::string payload, std::vector<BackendEvent>& events)
+	{
+		switch (opcode) {
+		case CloseFrame:
+			// Echo the status code, as RFC 6455 section 5.5.1 suggests
+			m_inner->Send(client, make_frame(CloseFrame, payload.substr(0, 2)));
+			m_inner->Close(client);
+			events.emplace_back(BackendEvent::Closed(client));
+			return false;
+		case Ping: m_inner->Send(client, make_frame(Pong, payload)); return true;
+		case Pong: return true;
+		case Text:
+		case Binary:
+			if (connection.in_message) {
+				return Fail(client, ProtocolError, events);
+			}
+			connection.in_message         = true;
+			connection.message_compressed = compressed;
+			connection.message            = std::move(payload);
+			break;
+		case Continuation:
+			if (!connection.in_message) {
+				return Fail(client, ProtocolError, events);
+			}
+			connection.message += payload;
+			break;
+		default: return Fail(client, ProtocolError, events);
+		}
+
+		if (connection.message.size() > MaxMessageBytes) {
+			return Fail(client, MessageTooBig, events);
+		}
+		if (!fin) {
+			return true;
+		}
+
+		connection.in_message = false;
+		auto message          = std::exchange(connection.message, {});
+		if (connection.message_compressed) {
+			message.append(DeflateTrailer);
+			auto inflated = connection.inflater.Decompress(message, MaxMessageBytes);
+			if (!inflated) {
+				return Fail(client, InvalidPayload, events);
+			}
+			message = std::move(*inflated);
+		}
+		if (message.empty()) {
+			return true;
+		}
+		// Browsers send one command per message, usually without a newline
+		if (message.back() != '\n') {
+			message.push_back('\n');
+		}
+		events.emplace_back(BackendEvent::Data(client, std::move(message)));
+		return true;
+	}
+
+	bool Fail(const ClientHandle client, const uint16_t code,
+	          std::vector<BackendEvent>& events)
+	{
+		m_inner->Send(client, make_close_frame(code));
+		m_inner->Close(client);
+		events.emplace_back(BackendEvent::Closed(client));
+		return false;
+	}
+
+	std::unique_ptr<NetworkBackend> m_inner;
+	std::unordered_map<ClientHandle, Connection> m_connections = {};
+};
+
+} // namespace
+
+std::string WebSocketAcceptKey(const std::string& client_key)
+{
+	return base64(sha1(client_key + std::string(WebSocketGuid)));
+}
+
+std::unique_ptr<NetworkBackend> MakeWebSocketBackend(std::unique_ptr<NetworkBackend> inner)
+{
+	return std::make_unique<WebSocketBackend>(std::move(inner));
+}
+
+} // namespace textmode
@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_TEXTMODE_WEBSOCKET_BACKEND_H
+#define DOSBOX_TEXTMODE_WEBSOCKET_BACKEND_H
+
+#include "textmode_server/server.h"
+
+#include <memory>
+#include <string>
+
+namespace textmode {
+
+// Accepts RFC 6455 WebSocket clients next to raw ones on the wrapped
+// backend's listener. A connection whose first line is an HTTP upgrade
+// request ("GET /... HTTP/1.1") is handshaken and from then on each
+// incoming message is delivered as one command line and each reply is sent
+// as one message; every other connection passes through unchanged.
+// permessage-deflate is negotiated when the client offers it, keeping the
+// compressor context across messages so repeated frames stay cheap.
+std::unique_ptr<NetworkBackend> MakeWebSocketBackend(std::unique_ptr<NetworkBackend> inner);
+
+// The Sec-WebSocket-Accept value answering 'client_key'
+std::string WebSocketAcceptKey(const std::string& client_key);
+
+} // namespace textmode
+
+#endif // DOSBOX_TEXTMODE_WEBSOCKET_BACKEND_H
@@ -207,6 +207,11 @@ void close_native_file(const NativeFileHandle handle);
 // Sets the file size to be equal to the current file position
 bool truncate_native_file(const NativeFileHandle handle);
 
+// Replaces the contents of 'dst' with all of 'src', sharing or copying the
+// data in the host kernel where the platform and filesystem allow. File
+// positions are unspecified afterwards.
+bool copy_native_file(const NativeFileHandle src, const NativeFileHandle dst);
+
 DosDateTime get_dos_file_time(const NativeFileHandle handle);
 void set_dos_file_time(const NativeFileHandle handle, const uint16_t date, const uint16_t time);
 
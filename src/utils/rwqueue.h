@@ -42,6 +42,10 @@ public:
 	RWQueue<T>& operator=(const RWQueue<T>& other) = delete;
 
 	RWQueue(size_t queue_capacity);
+
+	// Safe while the queue is in use. Shrinking it below the queued items
+	// holds producers back until the consumer drains it below the new
+	// capacity.
 	void Resize(size_t queue_capacity);
 
 	// non-blocking call
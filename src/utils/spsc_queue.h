@@ -0,0 +1,297 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#ifndef DOSBOX_SPSC_QUEUE_H
+#define DOSBOX_SPSC_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// SPSC (single-producer, single-consumer) queue
+// ---------------------------------------------
+// A fixed-size ring with the same blocking behavior as RWQueue for the case
+// of exactly one producer thread and one consumer thread, such as a MIDI
+// renderer feeding the mixer. Neither side takes a lock: each owns its own
+// position in the ring and publishes it with a release store, and a batch
+// of items costs two atomic stores however many items it holds.
+//
+// A side that has to wait (for room or for items) sleeps on an atomic
+// counter with C++20's atomic wait, which is a futex on Linux and the
+// equivalent elsewhere. The other side bumps it after a batch only when
+// someone is waiting. Stop() always bumps it, and may be called from any
+// thread.
+//
+// Resize() and Clear() aren't thread-safe; call them only while neither
+// side is using the queue. Every other call is safe from its own side, and
+// the non-blocking queries from either.
+
+template <typename T>
+class SpscQueue {
+public:
+	SpscQueue()                            = delete;
+	SpscQueue(const SpscQueue&)            = delete;
+	SpscQueue& operator=(const SpscQueue&) = delete;
+
+	explicit SpscQueue(const size_t queue_capacity)
+	{
+		Resize(queue_capacity);
+	}
+
+	void Resize(const size_t queue_capacity)
+	{
+		assert(queue_capacity > 0);
+		slots = std::vector<T>(queue_capacity);
+		Clear();
+	}
+
+	void Clear()
+	{
+		read_pos.store(0, std::memory_order_relaxed);
+		write_pos.store(0, std::memory_order_relaxed);
+		wake_other_side();
+	}
+
+	void Start()
+	{
+		is_running.store(true, std::memory_order_release);
+	}
+
+	void Stop()
+	{
+		if (is_running.exchange(false, std::memory_order_acq_rel)) {
+			wake_other_side();
+		}
+	}
+
+	bool IsRunning() const
+	{
+		return is_running.load(std::memory_order_acquire);
+	}
+
+	size_t Size() const
+	{
+		const auto read  = read_pos.load(std::memory_order_acquire);
+		const auto write = write_pos.load(std::memory_order_acquire);
+		return static_cast<size_t>(write - read);
+	}
+
+	bool IsEmpty() const
+	{
+		return Size() == 0;
+	}
+
+	bool IsFull() const
+	{
+		return Size() >= slots.size();
+	}
+
+	size_t MaxCapacity() const
+	{
+		return slots.size();
+	}
+
+	float GetPercentFull() const
+	{
+		return (100.0f * static_cast<float>(Size())) /
+		       static_cast<float>(slots.size());
+	}
+
+	// Producer side. Potentially blocks until there's room; returns false
+	// without queueing the item if the queue is stopped.
+	bool Enqueue(T&& item)
+	{
+		if (!wait_for_room(1)) {
+			return false;
+		}
+		const auto write = write_pos.load(std::memory_order_relaxed);
+		slots[write % slots.size()] = std::move(item);
+		publish(write_pos, write + 1);
+		return true;
+	}
+
+	// Producer side. Moves the items in, potentially blocking until each
+	// chunk of them fits; the request can exceed the capacity. Returns how
+	// many were queued, which is fewer if the queue was stopped.
+	size_t BulkEnqueue(T* const from_source, const size_t num_requested)
+	{
+		assert(from_source);
+		size_t num_done = 0;
+		while (num_done < num_requested) {
+			// Waiting for room for the whole chunk rather than any room
+			// at all keeps the two sides from trading single items. It
+			// can't stall: an empty queue has room for any chunk.
+			const auto num_wanted = std::min(num_requested - num_done,
+			                                 slots.size());
+			const auto num_free = wait_for_room(num_wanted);
+			if (!num_free) {
+				break;
+			}
+			const auto num_items = std::min(num_free,
+			                                num_requested - num_done);
+			const auto write = write_pos.load(std::memory_order_relaxed);
+			for_each_slot(write, num_items, [&](T& slot, const size_t i) {
+				slot = std::move(from_source[num_done + i]);
+			});
+			publish(write_pos, write + num_items);
+			num_done += num_items;
+		}
+		return num_done;
+	}
+
+	// Like RWQueue's: moves the first 'num_requested' items in and leaves
+	// the source vector empty
+	size_t BulkEnqueue(std::vector<T>& from_source, const size_t num_requested)
+	{
+		assert(num_requested <= from_source.size());
+		const auto num_done = BulkEnqueue(from_source.data(), num_requested);
+		from_source.clear();
+		return num_done;
+	}
+
+	size_t BulkEnqueue(std::vector<T>& from_source)
+	{
+		return BulkEnqueue(from_source, from_source.size());
+	}
+
+	// Consumer side. Potentially blocks until there's an item. Once the
+	// queue is stopped, drains what's left and then returns nothing.
+	std::optional<T> Dequeue()
+	{
+		if (!wait_for_items(1)) {
+			return {};
+		}
+		const auto read = read_pos.load(std::memory_order_relaxed);
+		std::optional<T> item = std::move(slots[read % slots.size()]);
+		publish(read_pos, read + 1);
+		return item;
+	}
+
+	// Consumer side. Potentially blocks until all the requested items are
+	// dequeued; returns fewer if the queue was stopped and has run dry.
+	size_t BulkDequeue(T* const into_target, const size_t num_requested)
+	{
+		assert(into_target);
+		size_t num_done = 0;
+		while (num_done < num_requested) {
+			// Takes whatever is there; only the producer holds out for
+			// a whole chunk, so the two can never wait on each other
+			const auto num_queued = wait_for_items(1);
+			if (!num_queued) {
+				break;
+			}
+			const auto num_items = std::min(num_queued,
+			                                num_requested - num_done);
+			const auto read = read_pos.load(std::memory_order_relaxed);
+			for_each_slot(read, num_items, [&](T& slot, const size_t i) {
+				into_target[num_done + i] = std::move(slot);
+			});
+			publish(read_pos, read + num_items);
+			num_done += num_items;
+		}
+		return num_done;
+	}
+
+	// The target vector is sized to the number dequeued
+	size_t BulkDequeue(std::vector<T>& into_target, const size_t num_requested)
+	{
+		if (into_target.size() < num_requested) {
+			into_target.resize(num_requested);
+		}
+		const auto num_done = BulkDequeue(into_target.data(), num_requested);
+		into_target.resize(num_done);
+		return num_done;
+	}
+
+private:
+	// Returns the free room once there's at least 'min_items' of it, or 0
+	// if the queue is stopped
+	size_t wait_for_room(const size_t min_items)
+	{
+		size_t room = 0;
+		wait_until([&] {
+			room = IsRunning() ? slots.size() - Size() : 0;
+			return room >= min_items || !IsRunning();
+		});
+		return room;
+	}
+
+	// Returns the number of queued items once there are at least
+	// 'min_items', or what's left (possibly 0) if the queue is stopped
+	size_t wait_for_items(const size_t min_items)
+	{
+		size_t queued = 0;
+		wait_until([&] {
+			const auto running = IsRunning();
+			queued             = Size();
+			return queued >= min_items || !running;
+		});
+		return queued;
+	}
+
+	// Only a side that's about to sleep announces itself, so the other side
+	// skips the shared counter and the wake-up call while nobody waits. The
+	// fences pair with the one in publish(): either the waiter sees the new
+	// position, or the publisher sees the waiter.
+	template <typename Predicate>
+	void wait_until(Predicate is_ready)
+	{
+		while (!is_ready()) {
+			num_waiting.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const auto seen = signal.load(std::memory_order_acquire);
+			if (!is_ready()) {
+				signal.wait(seen, std::memory_order_acquire);
+			}
+			num_waiting.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	// Calls 'func' with each of the 'num_items' slots from 'position' on,
+	// in at most two runs so there's only one division per batch
+	template <typename Func>
+	void for_each_slot(const uint64_t position, const size_t num_items, Func func)
+	{
+		const auto start     = static_cast<size_t>(position % slots.size());
+		const auto first_run = std::min(num_items, slots.size() - start);
+		for (size_t i = 0; i < first_run; ++i) {
+			func(slots[start + i], i);
+		}
+		for (size_t i = first_run; i < num_items; ++i) {
+			func(slots[i - first_run], i);
+		}
+	}
+
+	void publish(std::atomic<uint64_t>& position, const uint64_t value)
+	{
+		position.store(value, std::memory_order_release);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (num_waiting.load(std::memory_order_relaxed) > 0) {
+			wake_other_side();
+		}
+	}
+
+	void wake_other_side()
+	{
+		signal.fetch_add(1, std::memory_order_release);
+		signal.notify_all();
+	}
+
+	std::vector<T> slots = {};
+
+	// Each position only ever grows (64 bits never wrap in practice), so
+	// their difference is the number of queued items. They live on their
+	// own cache lines so the two sides don't contend for one.
+	alignas(64) std::atomic<uint64_t> write_pos = 0;
+	alignas(64) std::atomic<uint64_t> read_pos  = 0;
+
+	alignas(64) std::atomic<uint32_t> signal      = 0;
+	std::atomic<uint32_t> num_waiting            = 0;
+	std::atomic<bool> is_running                 = true;
+};
+
+#endif // DOSBOX_SPSC_QUEUE_H
@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/atapi_read_worker.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr auto SectorSize = AtapiReadWorker::BytesPerSector;
+
+// A disc whose every sector is filled with the low byte of its LBA, and
+// which keeps a log of which reads reached it
+class FakeDisc {
+public:
+	AtapiReadWorker::ReadFunction Reader()
+	{
+		return [this](uint8_t* buffer, const uint32_t lba, const uint32_t num_sectors) {
+			if (gate.valid()) {
+				gate.wait();
+			}
+			{
+				std::lock_guard lock(mutex);
+				reads.emplace_back(lba, num_sectors);
+			}
+			if (lba + num_sectors > num_sectors_on_disc) {
+				return false;
+			}
+			for (uint32_t i = 0; i < num_sectors; ++i) {
+				std::fill_n(buffer + i * SectorSize,
+				            SectorSize,
+				            static_cast<uint8_t>(lba + i));
+			}
+			return true;
+		};
+	}
+
+	std::vector<std::pair<uint32_t, uint32_t>> Reads()
+	{
+		std::lock_guard lock(mutex);
+		return reads;
+	}
+
+	uint32_t num_sectors_on_disc = 1000;
+
+	// Holds reads back until it's set
+	std::shared_future<void> gate = {};
+
+private:
+	std::mutex mutex                                 = {};
+	std::vector<std::pair<uint32_t, uint32_t>> reads = {};
+};
+
+bool HoldsSectors(const std::vector<uint8_t>& buffer, const uint32_t lba)
+{
+	for (size_t i = 0; i < buffer.size(); ++i) {
+		if (buffer[i] != static_cast<uint8_t>(lba + i / SectorSize)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST(AtapiReadWorker, ReadsInTheBackground)
+{
+	FakeDisc disc;
+	std::promise<void> open_gate;
+	disc.gate = open_gate.get_future().share();
+
+	AtapiReadWorker worker;
+	EXPECT_FALSE(worker.Submit(&disc, disc.Reader(), 16, 4));
+	EXPECT_FALSE(worker.IsDone());
+
+	open_gate.set_value();
+	std::vector<uint8_t> buffer(4 * SectorSize);
+	EXPECT_TRUE(worker.Take(buffer.data()));
+	EXPECT_TRUE(HoldsSectors(buffer, 16));
+	EXPECT_TRUE(worker.IsDone());
+}
+
+TEST(AtapiReadWorker, AnswersSequentialReadsFromReadAhead)
+{
+	FakeDisc disc;
+	AtapiReadWorker worker;
+	std::vector<uint8_t> buffer(8 * SectorSize);
+
+	worker.Submit(&disc, disc.Reader(), 100, 8);
+	ASSERT_TRUE(worker.Take(buffer.data()));
+
+	// The follow-up read comes from what was read ahead, whether or not
+	// it has finished yet
+	worker.Submit(&disc, disc.Reader(), 108, 8);
+	ASSERT_TRUE(worker.Take(buffer.data()));
+	EXPECT_TRUE(HoldsSectors(buffer, 108));
+
+	worker.Finish();
+	const auto reads = disc.Reads();
+	ASSERT_GE(reads.size(), 2u);
+	EXPECT_EQ(reads[0], std::make_pair(100u, 8u));
+	EXPECT_EQ(reads[1], std::make_pair(108u, 8u));
+}
+
+TEST(AtapiReadWorker, ReportsFailedReads)
+{
+	FakeDisc disc;
+	disc.num_sectors_on_disc = 50;
+
+	AtapiReadWorker worker;
+	std::vector<uint8_t> buffer(8 * SectorSize);
+
+	worker.Submit(&disc, disc.Reader(), 60, 8);
+	EXPECT_FALSE(worker.Take(buffer.data()));
+
+	// Reading ahead past the end of the disc doesn't fail the read that
+	// ends there
+	worker.Submit(&disc, disc.Reader(), 42, 8);
+	EXPECT_TRUE(worker.Take(buffer.data()));
+	worker.Submit(&disc, disc.Reader(), 50, 8);
+	EXPECT_FALSE(worker.Take(buffer.data()));
+}
+
+TEST(AtapiReadWorker, ForgetsReadAheadOfAnotherDisc)
+{
+	FakeDisc first;
+	FakeDisc second;
+	AtapiReadWorker worker;
+	std::vector<uint8_t> buffer(4 * SectorSize);
+
+	worker.Submit(&first, first.Reader(), 0, 4);
+	ASSERT_TRUE(worker.Take(buffer.data()));
+	worker.Finish();
+
+	EXPECT_FALSE(worker.Submit(&second, second.Reader(), 4, 4));
+	ASSERT_TRUE(worker.Take(buffer.data()));
+	EXPECT_TRUE(HoldsSectors(buffer, 4));
+	worker.Finish();
+
+	ASSERT_FALSE(second.Reads().empty());
+	EXPECT_EQ(second.Reads()[0], std::make_pair(4u, 4u));
+}
+
+TEST(AtapiReadWorker, TakesNothingWhenNothingWasSubmitted)
+{
+	AtapiReadWorker worker;
+	uint8_t byte = 0;
+	EXPECT_TRUE(worker.IsDone());
+	EXPECT_FALSE(worker.Take(&byte));
+}
+
+} // namespace
@@ -37,6 +37,49 @@ private:
 	decltype(contents)::size_type index = 0;
 };
 
+// Tells positions like the batch file reader, so labels are indexed
+class FakeIndexedReader final : public LineReader {
+public:
+	void Reset() override
+	{
+		index = 0;
+	}
+	std::optional<std::string> Read() override
+	{
+		if (index >= contents.size()) {
+			return {};
+		}
+		return contents[index++];
+	}
+	std::optional<uint32_t> GetPosition() override
+	{
+		return index;
+	}
+	void SetPosition(const uint32_t position) override
+	{
+		index = position;
+	}
+	uint32_t GetGeneration() override
+	{
+		return generation;
+	}
+
+	void Change(const std::string& str)
+	{
+		contents = split(str, "\n");
+		++generation;
+	}
+
+	explicit FakeIndexedReader(const std::string& str)
+	        : contents(split(str, "\n"))
+	{}
+
+private:
+	std::vector<std::string> contents = {};
+	uint32_t index                    = 0;
+	uint32_t generation               = 0;
+};
+
 class FakeShell final : public Environment {
 public:
 	std::optional<std::string> GetEnvironmentValue(std::string_view entry) const override
@@ -200,3 +243,59 @@ TEST(BatchFileGoto, SkipLines)
 	batchfile.ReadLine(line);
 	ASSERT_STREQ(line, "after");
 }
+
+TEST(BatchFileGoto, IndexedLabels)
+{
+	const auto shell = FakeShell({});
+	auto batchfile   = BatchFile(shell,
+                                   std::make_unique<FakeIndexedReader>(
+                                           "before\n:LOOP extra\nafter\n::comment\n=:other\nend\n:loop\nlast"),
+                                   "",
+                                   "",
+                                   true);
+	char line[CMD_MAXLINE];
+
+	ASSERT_TRUE(batchfile.Goto("loop"));
+	batchfile.ReadLine(line);
+	ASSERT_STREQ(line, "after");
+
+	ASSERT_TRUE(batchfile.Goto("Other"));
+	batchfile.ReadLine(line);
+	ASSERT_STREQ(line, "end");
+
+	ASSERT_FALSE(batchfile.Goto("comment"));
+	ASSERT_FALSE(batchfile.Goto("missing"));
+}
+
+TEST(BatchFileGoto, IndexedLabelsFollowChanges)
+{
+	const auto shell = FakeShell({});
+	auto reader      = std::make_unique<FakeIndexedReader>(":one\nfirst");
+	auto changes     = reader.get();
+	auto batchfile   = BatchFile(shell, std::move(reader), "", "", true);
+	char line[CMD_MAXLINE];
+
+	ASSERT_TRUE(batchfile.Goto("one"));
+	ASSERT_FALSE(batchfile.Goto("two"));
+
+	changes->Change("x\n:two\nsecond");
+	ASSERT_TRUE(batchfile.Goto("two"));
+	batchfile.ReadLine(line);
+	ASSERT_STREQ(line, "second");
+}
+
+TEST(BatchFileGoto, IndexedReaderLabelWithBlanks)
+{
+	const auto shell = FakeShell({});
+	auto batchfile   = BatchFile(shell,
+                                   std::make_unique<FakeIndexedReader>(
+                                           ":the end\nafter"),
+                                   "",
+                                   "",
+                                   true);
+	char line[CMD_MAXLINE];
+
+	ASSERT_TRUE(batchfile.Goto("the end"));
+	batchfile.ReadLine(line);
+	ASSERT_STREQ(line, "after");
+}
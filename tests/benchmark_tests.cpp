@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/benchmark.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+BenchmarkResult make_result()
+{
+	BenchmarkResult result = {};
+	result.name            = "integer";
+	result.exit_code       = 0;
+	result.wall_ms         = 500.0;
+	result.emulated_ms     = 1000;
+	result.cycles_per_ms   = 100000;
+	result.frames          = 70;
+	result.mixer_us        = 2500;
+	result.counters        = {{"mixer_mix_us", 2500}, {"vga_frames", 70}};
+	return result;
+}
+
+TEST(BenchmarkResult, RatesAreByWallClockTime)
+{
+	const auto result = make_result();
+
+	// 100 million cycles in half a second
+	EXPECT_DOUBLE_EQ(result.EmulatedMips(), 200.0);
+	EXPECT_DOUBLE_EQ(result.FramesPerSecond(), 140.0);
+
+	EXPECT_DOUBLE_EQ(BenchmarkResult{}.EmulatedMips(), 0.0);
+	EXPECT_DOUBLE_EQ(BenchmarkResult{}.FramesPerSecond(), 0.0);
+}
+
+TEST(BenchmarkReport, ToJson)
+{
+	BenchmarkReport report = {};
+	report.suite           = "cpu";
+	report.version         = "1.0";
+	report.settings        = {"core=normal", "say \"hi\""};
+	report.results         = {make_result()};
+	report.is_complete     = true;
+
+	auto fpu        = make_result();
+	fpu.name        = "fpu";
+	fpu.wall_ms     = 1500.0;
+	fpu.emulated_ms = 3000;
+	fpu.frames      = 210;
+	fpu.counters    = {};
+	report.results.push_back(fpu);
+
+	EXPECT_EQ(report.ToJson(),
+	          "{\"suite\":\"cpu\",\"version\":\"1.0\",\"complete\":true,"
+	          "\"settings\":[\"core=normal\",\"say \\\"hi\\\"\"],"
+	          "\"workloads\":["
+	          "{\"name\":\"integer\",\"exit_code\":0,\"wall_ms\":500.0,"
+	          "\"emulated_ms\":1000,\"emulated_mips\":200.0,\"frames\":70,"
+	          "\"frames_per_second\":140.0,\"mixer_ms\":2.5,"
+	          "\"counters\":{\"mixer_mix_us\":2500,\"vga_frames\":70}},"
+	          "{\"name\":\"fpu\",\"exit_code\":0,\"wall_ms\":1500.0,"
+	          "\"emulated_ms\":3000,\"emulated_mips\":200.0,\"frames\":210,"
+	          "\"frames_per_second\":140.0,\"mixer_ms\":2.5,\"counters\":{}}],"
+	          "\"total\":{\"workloads\":2,\"wall_ms\":2000.0,"
+	          "\"emulated_ms\":4000,\"emulated_mips\":200.0,\"frames\":280,"
+	          "\"frames_per_second\":140.0,\"mixer_ms\":5.0}}\n");
+}
+
+TEST(Benchmark, SelectsKnownSuitesOnly)
+{
+	const auto names = BENCHMARK_GetSuiteNames();
+	ASSERT_FALSE(names.empty());
+	EXPECT_EQ(names.front(), "all");
+
+	EXPECT_FALSE(BENCHMARK_Select("no-such-suite"));
+	EXPECT_FALSE(BENCHMARK_IsActive());
+	EXPECT_TRUE(BENCHMARK_GetAutoexecLines().empty());
+
+	ASSERT_TRUE(BENCHMARK_Select("CPU"));
+	EXPECT_TRUE(BENCHMARK_IsActive());
+	EXPECT_EQ(BENCHMARK_GetAutoexecLines(),
+	          (std::vector<std::string>{"@Z:\\BENCH\\INTEGER.COM",
+	                                    "@Z:\\BENCH\\FPU.COM"}));
+	EXPECT_FALSE(BENCHMARK_GetWorkDirectory().empty());
+
+	// Nothing ran, so the report is incomplete
+	testing::internal::CaptureStdout();
+	EXPECT_FALSE(BENCHMARK_Finish());
+	const auto json = testing::internal::GetCapturedStdout();
+	EXPECT_NE(json.find("\"suite\":\"cpu\""), std::string::npos);
+	EXPECT_NE(json.find("\"complete\":false"), std::string::npos);
+	EXPECT_FALSE(BENCHMARK_IsActive());
+}
+
+} // namespace
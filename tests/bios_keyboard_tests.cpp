@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "ints/bios.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// Each test polls on ticks of its own, as the count carries over between
+// calls on the same tick
+
+TEST(BiosKeystrokeCheck, SpinsOnlyPastTheThreshold)
+{
+	constexpr int64_t Tick = 1000;
+
+	for (uint32_t i = 1; i <= BIOS_MaxBusyKeystrokeChecksPerTick; ++i) {
+		EXPECT_FALSE(BIOS_NoteEmptyKeystrokeCheck(Tick)) << "check " << i;
+	}
+	EXPECT_TRUE(BIOS_NoteEmptyKeystrokeCheck(Tick));
+	EXPECT_TRUE(BIOS_NoteEmptyKeystrokeCheck(Tick));
+}
+
+TEST(BiosKeystrokeCheck, NextTickStartsCountingAgain)
+{
+	constexpr int64_t Tick = 2000;
+
+	for (uint32_t i = 0; i <= BIOS_MaxBusyKeystrokeChecksPerTick; ++i) {
+		BIOS_NoteEmptyKeystrokeCheck(Tick);
+	}
+	ASSERT_TRUE(BIOS_NoteEmptyKeystrokeCheck(Tick));
+
+	EXPECT_FALSE(BIOS_NoteEmptyKeystrokeCheck(Tick + 1));
+}
+
+TEST(BiosKeystrokeCheck, OncePerTickNeverSpins)
+{
+	// A game checking the keyboard once per frame
+	for (int64_t tick = 3000; tick < 3100; ++tick) {
+		EXPECT_FALSE(BIOS_NoteEmptyKeystrokeCheck(tick)) << "tick " << tick;
+	}
+}
+
+} // namespace
@@ -0,0 +1,135 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "debugger/breakpoint_condition.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <map>
+#include <string>
+
+namespace {
+
+using Register = BreakpointCondition::Register;
+
+class FakeMachine final : public BreakpointCondition::Machine {
+public:
+	uint32_t ReadRegister(const Register reg) const override
+	{
+		return registers[static_cast<size_t>(reg)];
+	}
+
+	uint32_t ReadMemory(const uint16_t seg, const uint32_t offset,
+	                    const int num_bytes) const override
+	{
+		uint32_t value = 0;
+		for (int i = num_bytes - 1; i >= 0; --i) {
+			const auto address = (seg << 4) + offset + static_cast<uint32_t>(i);
+			const auto it      = memory.find(address);
+			value = (value << 8) | (it == memory.end() ? 0 : it->second);
+		}
+		return value;
+	}
+
+	void Set(const Register reg, const uint32_t value)
+	{
+		registers[static_cast<size_t>(reg)] = value;
+	}
+
+	std::array<uint32_t, 16> registers = {};
+	std::map<uint32_t, uint8_t> memory = {};
+};
+
+bool evaluate(const std::string& text, const FakeMachine& machine)
+{
+	std::string error = {};
+	const auto condition = BreakpointCondition::Compile(text, error);
+	EXPECT_TRUE(condition) << text << ": " << error;
+	return condition && condition->Evaluate(machine);
+}
+
+bool compiles(const std::string& text)
+{
+	std::string error = {};
+	return BreakpointCondition::Compile(text, error).has_value();
+}
+
+TEST(BreakpointCondition, Registers)
+{
+	FakeMachine machine = {};
+	machine.Set(Register::Eax, 0x1234'5678);
+	machine.Set(Register::Esi, 0x0000'0010);
+
+	EXPECT_TRUE(evaluate("EAX==12345678", machine));
+	EXPECT_TRUE(evaluate("AX==5678", machine));
+	EXPECT_TRUE(evaluate("AL==78", machine));
+	EXPECT_TRUE(evaluate("AH==0x56", machine));
+	EXPECT_TRUE(evaluate("si == 10", machine));
+	EXPECT_FALSE(evaluate("AX==3", machine));
+}
+
+TEST(BreakpointCondition, Memory)
+{
+	FakeMachine machine = {};
+	machine.Set(Register::Ds, 0x1000);
+	machine.Set(Register::Es, 0x2000);
+	machine.Set(Register::Esi, 0x0004);
+	machine.memory[0x10004] = 0x42;
+	machine.memory[0x10005] = 0x43;
+	machine.memory[0x20000] = 0x99;
+
+	EXPECT_TRUE(evaluate("[DS:SI]==0x42", machine));
+	EXPECT_TRUE(evaluate("[SI]==42", machine));
+	EXPECT_TRUE(evaluate("W[DS:SI]==4342", machine));
+	EXPECT_TRUE(evaluate("D[DS:SI]==4342", machine));
+	EXPECT_TRUE(evaluate("[ES:SI-4]==99", machine));
+	EXPECT_TRUE(evaluate("[DS:[DS:SI]-3E]==42", machine));
+}
+
+TEST(BreakpointCondition, Precedence)
+{
+	FakeMachine machine = {};
+	machine.Set(Register::Eax, 3);
+	machine.Set(Register::Ebx, 5);
+
+	EXPECT_TRUE(evaluate("AX==3 && BX==5", machine));
+	EXPECT_TRUE(evaluate("AX==4 || BX==5", machine));
+	EXPECT_FALSE(evaluate("AX==4 || BX==5 && AX==4", machine));
+	EXPECT_TRUE(evaluate("AX+BX==8", machine));
+	EXPECT_FALSE(evaluate("(AX|BX)==6", machine));
+	EXPECT_TRUE(evaluate("(AX|BX)==7", machine));
+	EXPECT_TRUE(evaluate("AX&1 && !(BX&2)", machine));
+	EXPECT_TRUE(evaluate("AX<BX && BX>=5 && AX<=3 && BX>AX", machine));
+	EXPECT_TRUE(evaluate("AX-BX==-2", machine));
+	EXPECT_TRUE(evaluate("~AX==FFFFFFFC", machine));
+	EXPECT_TRUE(evaluate("(AX^BX)==6", machine));
+	EXPECT_TRUE(evaluate("AX!=BX", machine));
+}
+
+TEST(BreakpointCondition, Invalid)
+{
+	EXPECT_FALSE(compiles(""));
+	EXPECT_FALSE(compiles("AX=="));
+	EXPECT_FALSE(compiles("AX=3"));
+	EXPECT_FALSE(compiles("(AX==3"));
+	EXPECT_FALSE(compiles("[DS:SI"));
+	EXPECT_FALSE(compiles("QX==1"));
+	EXPECT_FALSE(compiles("123456789"));
+	EXPECT_TRUE(compiles(std::string(40, '(') + "1" + std::string(40, ')')));
+
+	std::string deep = "1";
+	for (int i = 0; i < 40; ++i) {
+		deep = "1+(" + deep + ")";
+	}
+	EXPECT_FALSE(compiles(deep));
+}
+
+TEST(BreakpointCondition, ErrorMessage)
+{
+	std::string error = {};
+	EXPECT_FALSE(BreakpointCondition::Compile("AX==QX", error));
+	EXPECT_EQ(error, "Invalid value 'QX' at column 5");
+}
+
+} // namespace
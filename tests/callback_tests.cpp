@@ -0,0 +1,287 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cpu/callback.h"
+
+#include "cpu/cpu.h"
+#include "cpu/registers.h"
+#include "hardware/memory.h"
+#include "hardware/pic.h"
+
+#include "dosbox_test_fixture.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if C_DYNREC
+void CPU_Core_Dynrec_Cache_Init(bool enable_cache);
+#endif
+
+namespace {
+
+// In-line callbacks against the main-loop path: the same guest code runs
+// once with the test callback's handler called from the main loop and once
+// with it called from the core, and must leave the CPU the same way.
+
+constexpr uint16_t CodeSegment  = 0x1000;
+constexpr uint16_t OtherSegment = 0x1100;
+constexpr uint16_t IsrSegment   = 0x1200;
+constexpr uint16_t StackSegment = 0x3000;
+
+constexpr uint8_t TestIrq       = 5;
+constexpr uint8_t TestIrqVector = 0x08 + TestIrq;
+
+constexpr int CyclesPerSlice = 1000;
+constexpr int MaxSlices      = 100;
+
+struct Outcome {
+	uint16_t ax = 0;
+	uint16_t bx = 0;
+	uint16_t cx = 0;
+	uint16_t cs = 0;
+	bool pmode  = false;
+
+	bool handled_in_pmode = false;
+
+	bool operator==(const Outcome&) const = default;
+};
+
+void PrintTo(const Outcome& outcome, std::ostream* os)
+{
+	*os << "ax=" << outcome.ax << " bx=" << outcome.bx << " cx=" << outcome.cx
+	    << " cs=" << outcome.cs << " pmode=" << outcome.pmode
+	    << " handled_in_pmode=" << outcome.handled_in_pmode;
+}
+
+bool stopped          = false;
+bool handled_in_pmode = false;
+
+Bitu stop_handler()
+{
+	stopped = true;
+	return CBRET_STOP;
+}
+
+Bitu jump_handler()
+{
+	SegSet16(cs, OtherSegment);
+	reg_eip = 0;
+	return CBRET_NONE;
+}
+
+Bitu enter_pmode_handler()
+{
+	CPU_SET_CRX(0, cpu.cr0 | CR0_PROTECTION);
+	return CBRET_NONE;
+}
+
+Bitu leave_pmode_handler()
+{
+	handled_in_pmode = cpu.pmode;
+	CPU_SET_CRX(0, cpu.cr0 & ~CR0_PROTECTION);
+	return CBRET_NONE;
+}
+
+Bitu raise_irq_handler()
+{
+	SETFLAGBIT(IF, true);
+	PIC_ActivateIRQ(TestIrq);
+	return CBRET_NONE;
+}
+
+std::vector<uint8_t> callback_opcode(const CALLBACK_HandlerObject& callback)
+{
+	const auto number = callback.Get_callback();
+	return {0xfe, 0x38, static_cast<uint8_t>(number), static_cast<uint8_t>(number >> 8)};
+}
+
+// Through the page handlers, so the dynamic core drops any code it
+// translated from an earlier program at the same address
+void write_code(const uint16_t segment, const std::vector<uint8_t>& code)
+{
+	for (size_t i = 0; i < code.size(); ++i) {
+		mem_writeb(PhysicalMake(segment, static_cast<uint16_t>(i)), code[i]);
+	}
+}
+
+std::vector<std::pair<std::string, CPU_Decoder*>> decoders()
+{
+	return {{"normal", &CPU_Core_Normal_Run},
+#if C_DYNREC
+	        {"dynrec", &CPU_Core_Dynrec_Run},
+#endif
+	};
+}
+
+class InlineCallbackTest : public DOSBoxTestFixture {
+protected:
+	void SetUp() override
+	{
+		DOSBoxTestFixture::SetUp();
+		saved_decoder = cpudecoder;
+
+		stop.Allocate(&stop_handler, "Test stop");
+		jump.Allocate(&jump_handler, "Test jump");
+		enter_pmode.Allocate(&enter_pmode_handler, "Test enter pmode");
+		leave_pmode.Allocate(&leave_pmode_handler, "Test leave pmode");
+		raise_irq.Allocate(&raise_irq_handler, "Test raise IRQ");
+
+		// The handler records BX, then acknowledges the interrupt
+		write_code(IsrSegment,
+		           {0x89, 0xd9, // mov cx,bx
+		            0xb0, 0x20, // mov al,0x20
+		            0xe6, 0x20, // out 0x20,al
+		            0xcf});     // iret
+		RealSetVec(TestIrqVector, RealMake(IsrSegment, 0), saved_vector);
+		PIC_SetIRQMask(TestIrq, false);
+	}
+
+	void TearDown() override
+	{
+		PIC_SetIRQMask(TestIrq, true);
+		RealSetVec(TestIrqVector, saved_vector);
+		CPU_SET_CRX(0, cpu.cr0 & ~CR0_PROTECTION);
+		cpudecoder = saved_decoder;
+
+		DOSBoxTestFixture::TearDown();
+	}
+
+	// Lays out the code at CodeSegment:0, followed by the stop callback
+	void Load(std::vector<uint8_t> code)
+	{
+		const auto stop_opcode = callback_opcode(stop);
+		code.insert(code.end(), stop_opcode.begin(), stop_opcode.end());
+		write_code(CodeSegment, code);
+	}
+
+	// Runs the loaded code with the test callbacks in-line or not, on
+	// the given core, until the stop callback
+	Outcome Run(CPU_Decoder* decoder, const bool in_line)
+	{
+		for (auto callback : {&jump, &enter_pmode, &leave_pmode, &raise_irq}) {
+			callback->SetInline(in_line);
+		}
+#if C_DYNREC
+		if (decoder == &CPU_Core_Dynrec_Run) {
+			CPU_Core_Dynrec_Cache_Init(true);
+		}
+#endif
+		cpudecoder = decoder;
+
+		SegSet16(cs, CodeSegment);
+		SegSet16(ds, CodeSegment);
+		SegSet16(ss, StackSegment);
+		reg_eip = 0;
+		reg_esp = 0xfffe;
+		reg_ax  = 0;
+		reg_bx  = 0;
+		reg_cx  = 0xffff;
+		SETFLAGBIT(IF, false);
+		SETFLAGBIT(TF, false);
+
+		stopped          = false;
+		handled_in_pmode = false;
+		RunUntilStopped();
+		EXPECT_TRUE(stopped);
+
+		return {reg_ax, reg_bx, reg_cx, SegValue(cs), cpu.pmode, handled_in_pmode};
+	}
+
+	CALLBACK_HandlerObject stop        = {};
+	CALLBACK_HandlerObject jump        = {};
+	CALLBACK_HandlerObject enter_pmode = {};
+	CALLBACK_HandlerObject leave_pmode = {};
+	CALLBACK_HandlerObject raise_irq   = {};
+
+private:
+	// The part of the main loop that matters here: start a due
+	// interrupt, run the core, and run the handler of a callback it
+	// hands back
+	void RunUntilStopped()
+	{
+		for (int slice = 0; slice < MaxSlices && !stopped; ++slice) {
+			CPU_Cycles    = CyclesPerSlice;
+			CPU_CycleLeft = 0;
+			PIC_runIRQs();
+
+			const auto ret = (*cpudecoder)();
+			if (ret > 0 && ret < CB_MAX) {
+				Callback_Handlers[ret]();
+			}
+		}
+	}
+
+	CPU_Decoder* saved_decoder = nullptr;
+	RealPt saved_vector        = 0;
+};
+
+std::vector<uint8_t> concat(std::initializer_list<std::vector<uint8_t>> parts)
+{
+	std::vector<uint8_t> code = {};
+	for (const auto& part : parts) {
+		code.insert(code.end(), part.begin(), part.end());
+	}
+	return code;
+}
+
+TEST_F(InlineCallbackTest, HandlerChangingCsIp)
+{
+	const auto stop_opcode = callback_opcode(stop);
+	write_code(OtherSegment,
+	           concat({{0xb8, 0x34, 0x12}, // mov ax,0x1234
+	                   stop_opcode}));
+
+	// The INC must not run: the handler carries on elsewhere
+	Load(concat({callback_opcode(jump), {0x43}})); // inc bx
+
+	for (const auto& [name, decoder] : decoders()) {
+		const auto main_loop = Run(decoder, false);
+		const auto in_line   = Run(decoder, true);
+		EXPECT_EQ(in_line, main_loop) << name;
+		EXPECT_EQ(in_line.ax, 0x1234) << name;
+		EXPECT_EQ(in_line.bx, 0) << name;
+		EXPECT_EQ(in_line.cs, OtherSegment) << name;
+	}
+}
+
+TEST_F(InlineCallbackTest, HandlerSwitchingMode)
+{
+	// The INC runs once in protected mode, on the real mode segment
+	// cache, between the two switches
+	Load(concat({callback_opcode(enter_pmode),
+	             {0x43}, // inc bx
+	             callback_opcode(leave_pmode)}));
+
+	for (const auto& [name, decoder] : decoders()) {
+		const auto main_loop = Run(decoder, false);
+		const auto in_line   = Run(decoder, true);
+		EXPECT_EQ(in_line, main_loop) << name;
+		EXPECT_EQ(in_line.bx, 1) << name;
+		EXPECT_TRUE(in_line.handled_in_pmode) << name;
+		EXPECT_FALSE(in_line.pmode) << name;
+	}
+}
+
+TEST_F(InlineCallbackTest, HandlerSettingIfWithIrqPending)
+{
+	// The interrupt handler records BX, so it must run before the INC
+	Load(concat({callback_opcode(raise_irq),
+	             {0x43,    // inc bx
+	              0xfa}})); // cli
+
+	for (const auto& [name, decoder] : decoders()) {
+		const auto main_loop = Run(decoder, false);
+		const auto in_line   = Run(decoder, true);
+		EXPECT_EQ(in_line, main_loop) << name;
+		EXPECT_EQ(in_line.cx, 0) << name;
+		EXPECT_EQ(in_line.bx, 1) << name;
+	}
+}
+
+} // namespace
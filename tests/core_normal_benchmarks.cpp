@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "dosbox.h"
+
+#include "cpu/cpu.h"
+#include "cpu/registers.h"
+#include "hardware/memory.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t CodeSegment  = 0x1000;
+constexpr uint16_t DataSegment  = 0x2000;
+constexpr uint16_t StackSegment = 0x3000;
+
+// Instructions handed to the core per call, about what it gets per
+// emulated millisecond at a few hundred MIPS
+constexpr int CyclesPerSlice = 100'000;
+
+// Wraps a loop body in 'start: mov cx,1000; inner: <body> loop inner; jmp
+// start', so LOOP runs it 1000 times per pass
+std::vector<uint8_t> make_program(const std::vector<uint8_t>& body)
+{
+	std::vector<uint8_t> code = {0xb9, 0xe8, 0x03}; // mov cx,1000
+	constexpr size_t InnerOffset = 3;
+
+	code.insert(code.end(), body.begin(), body.end());
+	code.insert(code.end(), {0xe2, 0x00, 0xeb, 0x00}); // loop inner; jmp start
+
+	// Patch the LOOP and JMP displacements, relative to the next
+	// instruction
+	const auto loop_end   = code.size() - 2;
+	code[loop_end - 1]    = static_cast<uint8_t>(InnerOffset - loop_end);
+	code[code.size() - 1] = static_cast<uint8_t>(0 - code.size());
+	return code;
+}
+
+// A mix of common integer instructions: register and memory ALU ops,
+// push/pop, shifts, a 0x66-prefixed op and a two-byte 0x0f jump; 14
+// instructions with LOOP
+const std::vector<uint8_t> MixedBody = {
+        0x8b, 0x04,             // inner: mov ax,[si]
+        0x01, 0xd8,             //        add ax,bx
+        0x31, 0xc2,             //        xor dx,ax
+        0x50,                   //        push ax
+        0x5b,                   //        pop bx
+        0x46,                   //        inc si
+        0x81, 0xe6, 0xfe, 0x0f, //        and si,0x0ffe
+        0x66, 0x01, 0xdb,       //        add ebx,ebx
+        0x89, 0x05,             //        mov [di],ax
+        0xd1, 0xe0,             //        shl ax,1
+        0x39, 0xd0,             //        cmp ax,dx
+        0x0f, 0x85, 0x00, 0x00, //        jne next (taken or not)
+        0x47,                   // next:  inc di
+};
+
+// Conditional jumps, SETcc, ADC and SBB after arithmetic, which spend
+// their time evaluating lazy flags; 14 instructions with LOOP, and every
+// jump lands on the next instruction whether it's taken or not
+const std::vector<uint8_t> FlagTestsBody = {
+        0x01, 0xd8,       // add ax,bx
+        0x83, 0xd2, 0x00, // adc dx,0
+        0x39, 0xd0,       // cmp ax,dx
+        0x7c, 0x00,       // jl
+        0xa8, 0x01,       // test al,1
+        0x74, 0x00,       // jz
+        0x29, 0xcb,       // sub bx,cx
+        0x76, 0x00,       // jbe
+        0x46,             // inc si
+        0x7f, 0x00,       // jg
+        0x19, 0xf7,       // sbb di,si
+        0x0f, 0x92, 0xc0, // setc al
+        0x78, 0x00,       // js
+};
+
+void load_program(const std::vector<uint8_t>& body)
+{
+	const auto program = make_program(body);
+	MEM_BlockWrite(CodeSegment << 4, program.data(), program.size());
+
+	for (uint32_t offset = 0; offset < 0x1000; ++offset) {
+		phys_writeb((DataSegment << 4) + offset, static_cast<uint8_t>(offset * 7));
+	}
+
+	SegSet16(cs, CodeSegment);
+	SegSet16(ds, DataSegment);
+	SegSet16(es, DataSegment);
+	SegSet16(ss, StackSegment);
+	reg_eip = 0;
+	reg_esp = 0xfffe;
+	reg_esi = 0;
+	reg_edi = 0x800;
+
+	// No interrupts or traps while the core runs
+	SETFLAGBIT(IF, false);
+	SETFLAGBIT(TF, false);
+}
+
+// Instructions the core actually executed, which can fall a little short
+// of a slice if it ends early
+int64_t run_slice()
+{
+	CPU_Cycles    = CyclesPerSlice;
+	CPU_CycleLeft = 0;
+	CPU_Core_Normal_Run();
+	return CyclesPerSlice - std::max(CPU_Cycles, 0);
+}
+
+// Real-mode loops through CPU_Core_Normal_Run. The dispatch method is
+// fixed at build time; compare the two by building once with the
+// 'threaded_core' (meson) or OPT_THREADED_CORE (CMake) option on and once
+// with it off.
+void BM_CoreNormal(benchmark::State& state, const std::vector<uint8_t>* body)
+{
+	load_program(*body);
+
+	// Warm up the caches and branch predictors before measuring
+	run_slice();
+
+	int64_t executed = 0;
+	for (auto _ : state) {
+		executed += run_slice();
+	}
+	state.SetItemsProcessed(executed);
+	state.SetLabel(C_CORE_THREADED ? "threaded" : "switch");
+}
+BENCHMARK_CAPTURE(BM_CoreNormal, mixed, &MixedBody);
+BENCHMARK_CAPTURE(BM_CoreNormal, flag_tests, &FlagTestsBody);
+
+} // namespace
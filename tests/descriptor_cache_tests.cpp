@@ -0,0 +1,220 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cpu/cpu.h"
+
+#include "cpu/paging.h"
+#include "hardware/memory.h"
+#include "misc/perf_counters.h"
+#include "misc/savestate.h"
+
+#include "dosbox_test_fixture.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using RawDescriptor = std::array<uint32_t, 2>;
+
+// The tables sit on pages of their own in conventional memory
+constexpr PhysPt GdtBase = 0x60000;
+constexpr PhysPt LdtBase = 0x61000;
+
+// GDT: null, the LDT, a data segment. LDT: null, a data segment.
+constexpr Bitu LdtSelector     = 0x08;
+constexpr Bitu GdtDataSelector = 0x10;
+constexpr Bitu LdtDataSelector = 0x0c;
+
+constexpr Bitu GdtLimit = 3 * 8 - 1;
+
+// Present, ring 0, and a 64 KB limit
+RawDescriptor make_descriptor(const uint32_t base, const uint8_t access)
+{
+	return {(base << 16) | 0xffff,
+	        (base & 0xff000000) | ((base >> 16) & 0xff) |
+	                (uint32_t{access} << 8)};
+}
+
+RawDescriptor data_descriptor(const uint32_t base)
+{
+	return make_descriptor(base, 0x92);
+}
+
+// Through the TLB, as the guest writes
+void guest_write(const PhysPt address, const RawDescriptor& raw)
+{
+	mem_writed(address, raw[0]);
+	mem_writed(address + 4, raw[1]);
+}
+
+// Behind the write watches' back, so only the event under test can empty
+// the cache
+void write_unwatched(const PhysPt address, const RawDescriptor& raw)
+{
+	host_writed(MemBase + address, raw[0]);
+	host_writed(MemBase + address + 4, raw[1]);
+}
+
+RawDescriptor fetch(const Bitu selector)
+{
+	Descriptor desc;
+	EXPECT_TRUE(cpu.gdt.GetDescriptor(selector, desc));
+	return {desc.saved.fill[0], desc.saved.fill[1]};
+}
+
+int64_t perf_value(const std::string_view name)
+{
+	for (const auto& sample : PERF_Sample()) {
+		if (sample.name == name) {
+			return sample.value;
+		}
+	}
+	return 0;
+}
+
+class DescriptorCacheTest : public DOSBoxTestFixture {
+protected:
+	void SetUp() override
+	{
+		DOSBoxTestFixture::SetUp();
+
+		saved_gdt_base  = CPU_SGDT_base();
+		saved_gdt_limit = CPU_SGDT_limit();
+
+		write_unwatched(GdtBase, {0, 0});
+		write_unwatched(GdtBase + LdtSelector,
+		                make_descriptor(LdtBase, 0x80 | DESC_LDT));
+		write_unwatched(GdtBase + GdtDataSelector, data_descriptor(0x100000));
+		write_unwatched(LdtBase, {0, 0});
+		write_unwatched(LdtBase + (LdtDataSelector & ~7), data_descriptor(0x200000));
+
+		CPU_LGDT(GdtLimit, GdtBase);
+		ASSERT_TRUE(cpu.gdt.LLDT(LdtSelector));
+	}
+
+	void TearDown() override
+	{
+		cpu.gdt.LLDT(0);
+		CPU_LGDT(saved_gdt_limit, saved_gdt_base);
+		MEM_DropWriteWatches();
+
+		DOSBoxTestFixture::TearDown();
+	}
+
+	// Fetches twice, so the descriptor is known to be served from the
+	// cache before the event under test
+	void FillCache(const Bitu selector)
+	{
+		fetch(selector);
+		const auto hits = perf_value("descriptor_cache_hits");
+		fetch(selector);
+		ASSERT_EQ(perf_value("descriptor_cache_hits"), hits + 1);
+	}
+
+private:
+	Bitu saved_gdt_base  = 0;
+	Bitu saved_gdt_limit = 0;
+};
+
+TEST_F(DescriptorCacheTest, ServesRepeatFetchesFromCache)
+{
+	FillCache(GdtDataSelector);
+	FillCache(LdtDataSelector);
+
+	EXPECT_EQ(fetch(GdtDataSelector), data_descriptor(0x100000));
+	EXPECT_EQ(fetch(LdtDataSelector), data_descriptor(0x200000));
+}
+
+TEST_F(DescriptorCacheTest, GuestWriteToGdtRefetches)
+{
+	FillCache(GdtDataSelector);
+
+	const auto changed = data_descriptor(0x110000);
+	guest_write(GdtBase + GdtDataSelector, changed);
+	EXPECT_EQ(fetch(GdtDataSelector), changed);
+}
+
+TEST_F(DescriptorCacheTest, GuestWriteToLdtRefetches)
+{
+	FillCache(LdtDataSelector);
+
+	const auto changed = data_descriptor(0x210000);
+	guest_write(LdtBase + (LdtDataSelector & ~7), changed);
+	EXPECT_EQ(fetch(LdtDataSelector), changed);
+}
+
+TEST_F(DescriptorCacheTest, GuestWriteElsewhereKeepsCache)
+{
+	FillCache(GdtDataSelector);
+
+	mem_writed(0x62000, 0x12345678);
+	const auto hits = perf_value("descriptor_cache_hits");
+	EXPECT_EQ(fetch(GdtDataSelector), data_descriptor(0x100000));
+	EXPECT_EQ(perf_value("descriptor_cache_hits"), hits + 1);
+}
+
+TEST_F(DescriptorCacheTest, ClearTlbRefetches)
+{
+	FillCache(GdtDataSelector);
+
+	const auto changed = data_descriptor(0x120000);
+	write_unwatched(GdtBase + GdtDataSelector, changed);
+	PAGING_ClearTLB();
+	EXPECT_EQ(fetch(GdtDataSelector), changed);
+}
+
+TEST_F(DescriptorCacheTest, InvalidatePageRefetches)
+{
+	FillCache(LdtDataSelector);
+
+	const auto changed = data_descriptor(0x220000);
+	write_unwatched(LdtBase + (LdtDataSelector & ~7), changed);
+	PAGING_InvalidatePage(LdtBase);
+	EXPECT_EQ(fetch(LdtDataSelector), changed);
+}
+
+TEST_F(DescriptorCacheTest, LgdtRefetches)
+{
+	FillCache(GdtDataSelector);
+
+	const auto changed = data_descriptor(0x130000);
+	write_unwatched(GdtBase + GdtDataSelector, changed);
+	CPU_LGDT(GdtLimit, GdtBase);
+	EXPECT_EQ(fetch(GdtDataSelector), changed);
+}
+
+TEST_F(DescriptorCacheTest, LldtRefetches)
+{
+	FillCache(LdtDataSelector);
+
+	const auto changed = data_descriptor(0x230000);
+	write_unwatched(LdtBase + (LdtDataSelector & ~7), changed);
+	ASSERT_TRUE(cpu.gdt.LLDT(LdtSelector));
+	EXPECT_EQ(fetch(LdtDataSelector), changed);
+}
+
+TEST_F(DescriptorCacheTest, StateLoadRefetches)
+{
+	const std::vector<SaveStateComponent> components = {
+	        {"cpu", CPU_SaveState, CPU_LoadState}};
+
+	std::string error = {};
+	const auto state  = SAVESTATE_Encode(components, 0, error);
+	ASSERT_FALSE(state.empty()) << error;
+
+	FillCache(GdtDataSelector);
+
+	// A state load restores memory the watches never saw written
+	const auto changed = data_descriptor(0x140000);
+	write_unwatched(GdtBase + GdtDataSelector, changed);
+	ASSERT_TRUE(SAVESTATE_Decode(state, components, 0, error)) << error;
+	EXPECT_EQ(fetch(GdtDataSelector), changed);
+}
+
+} // namespace
@@ -0,0 +1,241 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "ints/disk_image_io.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+constexpr uint32_t SectorSize = 512;
+constexpr uint32_t NumSectors = 1024;
+
+// Every sector holds its own number in every byte pair
+std::vector<uint8_t> sector_pattern(const uint32_t sector, const uint8_t salt = 0)
+{
+	std::vector<uint8_t> data(SectorSize);
+	for (size_t i = 0; i < data.size(); i += 2) {
+		data[i]     = static_cast<uint8_t>(sector);
+		data[i + 1] = static_cast<uint8_t>((sector >> 8) ^ salt);
+	}
+	return data;
+}
+
+class DiskImageIOTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		file = std::tmpfile();
+		ASSERT_NE(file, nullptr);
+		for (uint32_t sector = 0; sector < NumSectors; ++sector) {
+			const auto data = sector_pattern(sector);
+			ASSERT_EQ(std::fwrite(data.data(), 1, data.size(), file), data.size());
+		}
+		std::fflush(file);
+	}
+
+	void TearDown() override
+	{
+		if (file) {
+			std::fclose(file);
+		}
+	}
+
+	// What the file holds, once nothing else uses it
+	std::vector<uint8_t> file_sector(const uint32_t sector)
+	{
+		std::vector<uint8_t> data(SectorSize);
+		std::fseek(file, static_cast<long>(sector * SectorSize), SEEK_SET);
+		EXPECT_EQ(std::fread(data.data(), 1, data.size(), file), data.size());
+		return data;
+	}
+
+	FILE* file = nullptr;
+};
+
+TEST_F(DiskImageIOTest, ReadsWhatTheFileHolds)
+{
+	DiskImageIO io(file, SectorSize, false);
+
+	std::vector<uint8_t> data(SectorSize);
+	for (const uint32_t sector : {7u, 3u, 900u, 3u, 0u, 1023u}) {
+		ASSERT_TRUE(io.Read(sector, data.data()));
+		EXPECT_EQ(data, sector_pattern(sector));
+	}
+	EXPECT_EQ(io.GetStats().hits, 1u);
+}
+
+TEST_F(DiskImageIOTest, SequentialReadsAreReadAhead)
+{
+	DiskImageIO io(file, SectorSize, false);
+
+	std::vector<uint8_t> data(SectorSize);
+	for (uint32_t sector = 0; sector < 512; ++sector) {
+		ASSERT_TRUE(io.Read(sector, data.data()));
+		ASSERT_EQ(data, sector_pattern(sector));
+	}
+	const auto stats = io.GetStats();
+	EXPECT_GT(stats.prefetched, 0u);
+	EXPECT_LT(stats.misses, 512u / 4);
+}
+
+TEST_F(DiskImageIOTest, PrefetchedSectorsAreCached)
+{
+	DiskImageIO io(file, SectorSize, false);
+	io.Prefetch(100, 16);
+
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (io.GetStats().prefetched < 16 && std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_EQ(io.GetStats().prefetched, 16u);
+
+	std::vector<uint8_t> data(SectorSize);
+	for (uint32_t sector = 100; sector < 116; ++sector) {
+		ASSERT_TRUE(io.Read(sector, data.data()));
+		EXPECT_EQ(data, sector_pattern(sector));
+	}
+	EXPECT_EQ(io.GetStats().hits, 16u);
+	EXPECT_EQ(io.GetStats().misses, 0u);
+}
+
+TEST_F(DiskImageIOTest, WritesAreReadBackAndWrittenOut)
+{
+	{
+		DiskImageIO io(file, SectorSize, false);
+		for (uint32_t sector = 10; sector < 50; ++sector) {
+			ASSERT_TRUE(io.Write(sector, sector_pattern(sector, 0xa5).data()));
+		}
+		ASSERT_TRUE(io.Write(500, sector_pattern(500, 0x5a).data()));
+
+		std::vector<uint8_t> data(SectorSize);
+		ASSERT_TRUE(io.Read(20, data.data()));
+		EXPECT_EQ(data, sector_pattern(20, 0xa5));
+
+		io.Flush();
+		ASSERT_TRUE(io.Read(500, data.data()));
+		EXPECT_EQ(data, sector_pattern(500, 0x5a));
+	}
+
+	EXPECT_EQ(file_sector(9), sector_pattern(9));
+	for (uint32_t sector = 10; sector < 50; ++sector) {
+		EXPECT_EQ(file_sector(sector), sector_pattern(sector, 0xa5));
+	}
+	EXPECT_EQ(file_sector(50), sector_pattern(50));
+	EXPECT_EQ(file_sector(500), sector_pattern(500, 0x5a));
+}
+
+TEST_F(DiskImageIOTest, PendingWritesAreWrittenOutOnDestruction)
+{
+	{
+		DiskImageIO io(file, SectorSize, false);
+		for (uint32_t sector = 0; sector < 4; ++sector) {
+			ASSERT_TRUE(io.Write(sector * 3, sector_pattern(sector, 0x11).data()));
+		}
+	}
+	for (uint32_t sector = 0; sector < 4; ++sector) {
+		EXPECT_EQ(file_sector(sector * 3), sector_pattern(sector, 0x11));
+	}
+}
+
+TEST_F(DiskImageIOTest, SectorSizeChangeKeepsWrites)
+{
+	{
+		DiskImageIO io(file, SectorSize, false);
+		ASSERT_TRUE(io.Write(1, sector_pattern(1, 0x22).data()));
+		ASSERT_TRUE(io.Write(2, sector_pattern(2, 0x22).data()));
+
+		io.SetSectorSize(SectorSize * 2);
+		std::vector<uint8_t> data(SectorSize * 2);
+		ASSERT_TRUE(io.Read(1, data.data()));
+
+		const auto first  = sector_pattern(2, 0x22);
+		const auto second = sector_pattern(3);
+		EXPECT_TRUE(std::equal(first.begin(), first.end(), data.begin()));
+		EXPECT_TRUE(std::equal(second.begin(), second.end(), data.begin() + SectorSize));
+	}
+	EXPECT_EQ(file_sector(1), sector_pattern(1, 0x22));
+}
+
+TEST_F(DiskImageIOTest, FailsWritesToReadOnlyImages)
+{
+	const auto path = std::filesystem::temp_directory_path() /
+	                  "disk_image_io_read_only.img";
+	const auto name = path.string();
+	{
+		const auto writable = std::fopen(name.c_str(), "wb");
+		ASSERT_NE(writable, nullptr);
+		const auto data = sector_pattern(0);
+		std::fwrite(data.data(), 1, data.size(), writable);
+		std::fclose(writable);
+	}
+	const auto read_only = std::fopen(name.c_str(), "rb");
+	ASSERT_NE(read_only, nullptr);
+	{
+		DiskImageIO io(read_only, SectorSize, false);
+		EXPECT_FALSE(io.Write(0, sector_pattern(0, 0x33).data()));
+
+		std::vector<uint8_t> data(SectorSize);
+		ASSERT_TRUE(io.Read(0, data.data()));
+		EXPECT_EQ(data, sector_pattern(0));
+	}
+	std::fclose(read_only);
+	std::filesystem::remove(path);
+}
+
+#if !defined(WIN32)
+TEST_F(DiskImageIOTest, MappedImagesAreReadAndWritten)
+{
+	{
+		DiskImageIO io(file, SectorSize);
+		ASSERT_TRUE(io.IsMapped());
+
+		std::vector<uint8_t> data(SectorSize * 4);
+		ASSERT_TRUE(io.Read(200, 4, data.data()));
+		for (uint32_t i = 0; i < 4; ++i) {
+			const auto expected = sector_pattern(200 + i);
+			EXPECT_TRUE(std::equal(expected.begin(),
+			                       expected.end(),
+			                       data.begin() + i * SectorSize));
+		}
+
+		ASSERT_TRUE(io.Write(201, sector_pattern(201, 0x44).data()));
+		ASSERT_TRUE(io.Read(201, data.data()));
+		EXPECT_TRUE(std::equal(data.begin(), data.begin() + SectorSize,
+		                       sector_pattern(201, 0x44).begin()));
+
+		// Past the end of the mapping the image grows as before
+		ASSERT_TRUE(io.Write(NumSectors, sector_pattern(NumSectors, 0x55).data()));
+		ASSERT_TRUE(io.Read(NumSectors, data.data()));
+		EXPECT_TRUE(std::equal(data.begin(), data.begin() + SectorSize,
+		                       sector_pattern(NumSectors, 0x55).begin()));
+	}
+	EXPECT_EQ(file_sector(201), sector_pattern(201, 0x44));
+	EXPECT_EQ(file_sector(NumSectors), sector_pattern(NumSectors, 0x55));
+}
+#endif
+
+TEST_F(DiskImageIOTest, MultiSectorReadsGoThroughTheCache)
+{
+	DiskImageIO io(file, SectorSize, false);
+
+	std::vector<uint8_t> data(SectorSize * 3);
+	ASSERT_TRUE(io.Read(40, 3, data.data()));
+	for (uint32_t i = 0; i < 3; ++i) {
+		const auto expected = sector_pattern(40 + i);
+		EXPECT_TRUE(std::equal(expected.begin(),
+		                       expected.end(),
+		                       data.begin() + i * SectorSize));
+	}
+}
+
+} // namespace
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+// Component micro-benchmarks.
+//
+// Runs the Google Benchmark cases of the *_benchmarks.cpp files: the hot
+// parts of the emulator that work in isolation. The memory, paging, PIC,
+// I/O port and CPU core cases need the emulated machine, so it's brought
+// up first with the same sections and configuration as the unit tests.
+//
+//   dosbox_benchmarks [--benchmark_filter=REGEX] [--benchmark_out=FILE
+//                     --benchmark_out_format=json] [--screen=FILE]...
+//
+// Each --screen adds text-mode server cases for a captured screen: a raw
+// dump of the text plane as character and attribute byte pairs, 80
+// columns wide, as written by the debugger's "MEMDUMPBIN B800:0000 FA0".
+//
+// Run it from the source root, like the unit tests, so it finds the test
+// configuration. Timings only compare on the same host, so no baseline is
+// kept in the tree; record one from a release build before a change.
+
+#define SDL_MAIN_HANDLED
+
+#include "dosbox.h"
+
+#include "config/config.h"
+#include "misc/cross.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Adds the text-mode server cases for a captured screen, from
+// textmode_benchmarks.cpp
+bool RegisterTextModeServerScreen(const std::string& path);
+
+namespace {
+
+class Emulator {
+public:
+	Emulator()
+	        : argv{arg_c_str},
+	          com_line(1, argv)
+	{
+		control = std::make_unique<Config>(&com_line);
+		InitConfigDir();
+		control->ParseConfigFiles(GetConfigDir());
+		DOSBOX_InitAllModuleConfigsAndMessages();
+		for (const auto name : sections) {
+			control->GetSection(name)->ExecuteInit();
+		}
+	}
+
+	~Emulator()
+	{
+		for (auto it = sections.rbegin(); it != sections.rend(); ++it) {
+			control->GetSection(*it)->ExecuteDestroy();
+		}
+	}
+
+	Emulator(const Emulator&)            = delete;
+	Emulator& operator=(const Emulator&) = delete;
+
+private:
+	const char* arg_c_str = "-conf tests/files/dosbox-staging-tests.conf\0";
+	const char* argv[1]   = {};
+	CommandLine com_line;
+
+	// The same sections the unit tests bring up
+	const std::vector<const char*> sections = {"dosbox", "cpu",
+	                                           "mixer",  "midi",
+	                                           "sblaster", "speaker",
+	                                           "serial", "dos"};
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+	benchmark::Initialize(&argc, argv);
+
+	// Google Benchmark leaves the arguments it doesn't know
+	constexpr std::string_view ScreenFlag = "--screen=";
+	for (int i = 1; i < argc; ++i) {
+		const std::string_view arg = argv[i];
+		if (arg.substr(0, ScreenFlag.size()) != ScreenFlag) {
+			std::fprintf(stderr, "%s: unrecognized argument '%s'\n", argv[0], argv[i]);
+			return 2;
+		}
+		const std::string path(arg.substr(ScreenFlag.size()));
+		if (!RegisterTextModeServerScreen(path)) {
+			std::fprintf(stderr, "%s: not a text plane dump\n", path.c_str());
+			return 1;
+		}
+	}
+
+	Emulator emulator = {};
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,263 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "dos/drives.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+namespace {
+
+// Writes a ZIP archive of the given files, deflating those asked to
+class ZipWriter {
+public:
+	void Add(const std::string& name, const std::vector<uint8_t>& data,
+	         const bool deflate)
+	{
+		std::vector<uint8_t> stored = data;
+		if (deflate) {
+			stored.resize(compressBound(static_cast<uLong>(data.size())) + 64);
+			z_stream stream = {};
+			// zlib selects raw streams through negative window sizes
+			deflateInit2(&stream, 6, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+			stream.next_in   = const_cast<uint8_t*>(data.data());
+			stream.avail_in  = static_cast<uInt>(data.size());
+			stream.next_out  = stored.data();
+			stream.avail_out = static_cast<uInt>(stored.size());
+			deflate_all(stream);
+			stored.resize(stream.total_out);
+			deflateEnd(&stream);
+		}
+		const auto crc = crc32(0, data.data(), static_cast<uInt>(data.size()));
+		const uint16_t method = deflate ? 8 : 0;
+
+		const auto offset = static_cast<uint32_t>(archive.size());
+		put32(archive, 0x04034b50);
+		put16(archive, 20);
+		put16(archive, 0);
+		put16(archive, method);
+		put16(archive, 0x6000); // 12:00
+		put16(archive, 0x5a21); // 2025-01-01
+		put32(archive, crc);
+		put32(archive, static_cast<uint32_t>(stored.size()));
+		put32(archive, static_cast<uint32_t>(data.size()));
+		put16(archive, static_cast<uint16_t>(name.size()));
+		put16(archive, 0);
+		archive.insert(archive.end(), name.begin(), name.end());
+		archive.insert(archive.end(), stored.begin(), stored.end());
+
+		put32(central, 0x02014b50);
+		put16(central, 20);
+		put16(central, 20);
+		put16(central, 0);
+		put16(central, method);
+		put16(central, 0x6000);
+		put16(central, 0x5a21);
+		put32(central, crc);
+		put32(central, static_cast<uint32_t>(stored.size()));
+		put32(central, static_cast<uint32_t>(data.size()));
+		put16(central, static_cast<uint16_t>(name.size()));
+		put16(central, 0);
+		put16(central, 0);
+		put16(central, 0);
+		put16(central, 0);
+		put32(central, 0);
+		put32(central, offset);
+		central.insert(central.end(), name.begin(), name.end());
+		++num_entries;
+	}
+
+	void Write(const std::filesystem::path& path)
+	{
+		auto output = archive;
+		const auto dir_offset = static_cast<uint32_t>(output.size());
+		output.insert(output.end(), central.begin(), central.end());
+		put32(output, 0x06054b50);
+		put16(output, 0);
+		put16(output, 0);
+		put16(output, num_entries);
+		put16(output, num_entries);
+		put32(output, static_cast<uint32_t>(central.size()));
+		put32(output, dir_offset);
+		put16(output, 0);
+
+		std::ofstream file(path, std::ios::binary);
+		file.write(reinterpret_cast<const char*>(output.data()),
+		           static_cast<std::streamsize>(output.size()));
+	}
+
+private:
+	static void deflate_all(z_stream& stream)
+	{
+		while (deflate(&stream, Z_FINISH) == Z_OK) {
+		}
+	}
+
+	static void put16(std::vector<uint8_t>& out, const uint16_t value)
+	{
+		out.push_back(static_cast<uint8_t>(value));
+		out.push_back(static_cast<uint8_t>(value >> 8));
+	}
+
+	static void put32(std::vector<uint8_t>& out, const uint32_t value)
+	{
+		put16(out, static_cast<uint16_t>(value));
+		put16(out, static_cast<uint16_t>(value >> 16));
+	}
+
+	std::vector<uint8_t> archive = {};
+	std::vector<uint8_t> central = {};
+	uint16_t num_entries         = 0;
+};
+
+// Compressible data that still differs from block to block
+std::vector<uint8_t> make_data(const size_t size, const uint32_t seed)
+{
+	std::vector<uint8_t> data(size);
+	uint32_t state = seed;
+	for (size_t i = 0; i < size; ++i) {
+		state   = state * 1'664'525 + 1'013'904'223;
+		data[i] = static_cast<uint8_t>((i / 7) ^ (state >> 28));
+	}
+	return data;
+}
+
+std::vector<uint8_t> read_file(DOS_File& file, const size_t size)
+{
+	std::vector<uint8_t> data = {};
+	std::vector<uint8_t> chunk(4096);
+	while (data.size() < size) {
+		uint16_t count = static_cast<uint16_t>(chunk.size());
+		if (!file.Read(chunk.data(), &count) || count == 0) {
+			break;
+		}
+		data.insert(data.end(), chunk.begin(), chunk.begin() + count);
+	}
+	return data;
+}
+
+class ZipDriveTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		ZipWriter writer = {};
+		writer.Add("README.TXT", text, false);
+		writer.Add("game/data/level1.dat", level, true);
+		writer.Add("game/Long File Name.txt", text, true);
+		writer.Add("game/Long File Name 2.txt", text, false);
+		writer.Add("game/empty/", {}, false);
+		writer.Write(path);
+
+		bool is_error = true;
+		drive = std::make_shared<zipDrive>(path.string().c_str(), 0xf8, is_error);
+		ASSERT_FALSE(is_error);
+	}
+
+	void TearDown() override
+	{
+		drive.reset();
+		std::filesystem::remove(path);
+	}
+
+	const std::filesystem::path path = std::filesystem::temp_directory_path() /
+	                                   "drive_zip_tests.zip";
+
+	const std::vector<uint8_t> text  = make_data(1000, 1);
+	const std::vector<uint8_t> level = make_data(300'000, 2);
+
+	std::shared_ptr<zipDrive> drive = nullptr;
+};
+
+TEST_F(ZipDriveTest, IndexesTheArchive)
+{
+	EXPECT_TRUE(drive->FileExists("README.TXT"));
+	EXPECT_TRUE(drive->FileExists("readme.txt"));
+	EXPECT_TRUE(drive->TestDir("GAME"));
+	EXPECT_TRUE(drive->TestDir("GAME\\DATA"));
+	EXPECT_TRUE(drive->TestDir("GAME\\EMPTY"));
+	EXPECT_TRUE(drive->FileExists("GAME\\DATA\\LEVEL1.DAT"));
+	EXPECT_FALSE(drive->FileExists("GAME\\DATA"));
+	EXPECT_FALSE(drive->FileExists("MISSING.TXT"));
+
+	FatAttributeFlags attr = {};
+	ASSERT_TRUE(drive->GetFileAttr("GAME", &attr));
+	EXPECT_TRUE(attr.directory);
+	ASSERT_TRUE(drive->GetFileAttr("README.TXT", &attr));
+	EXPECT_TRUE(attr.read_only);
+	EXPECT_FALSE(attr.directory);
+}
+
+TEST_F(ZipDriveTest, GivesLongNamesShortNames)
+{
+	EXPECT_TRUE(drive->FileExists("GAME\\LONGFI~1.TXT"));
+	EXPECT_TRUE(drive->FileExists("GAME\\LONGFI~2.TXT"));
+}
+
+TEST_F(ZipDriveTest, ReadsStoredAndDeflatedEntries)
+{
+	auto stored = drive->FileOpen("README.TXT", OPEN_READ);
+	ASSERT_NE(stored, nullptr);
+	EXPECT_EQ(read_file(*stored, text.size() + 1), text);
+
+	auto deflated = drive->FileOpen("GAME\\DATA\\LEVEL1.DAT", OPEN_READ);
+	ASSERT_NE(deflated, nullptr);
+	EXPECT_EQ(read_file(*deflated, level.size() + 1), level);
+}
+
+TEST_F(ZipDriveTest, SeeksWithinDeflatedEntries)
+{
+	auto file = drive->FileOpen("GAME\\DATA\\LEVEL1.DAT", OPEN_READ);
+	ASSERT_NE(file, nullptr);
+
+	for (const uint32_t offset : {250'000u, 10u, 131'000u, 65'535u, 299'990u}) {
+		uint32_t pos = offset;
+		ASSERT_TRUE(file->Seek(&pos, DOS_SEEK_SET));
+		const auto data = read_file(*file, 100);
+		const auto expected_size = std::min<size_t>(100, level.size() - offset);
+		ASSERT_GE(data.size(), expected_size);
+		EXPECT_TRUE(std::equal(level.begin() + offset,
+		                       level.begin() + offset + expected_size,
+		                       data.begin()));
+	}
+
+	// Another handle to the same entry is served from the shared cache
+	auto other = drive->FileOpen("GAME\\DATA\\LEVEL1.DAT", OPEN_READ);
+	ASSERT_NE(other, nullptr);
+	EXPECT_EQ(read_file(*other, level.size()), level);
+}
+
+TEST_F(ZipDriveTest, RefusesWrites)
+{
+	EXPECT_EQ(drive->FileOpen("README.TXT", OPEN_READWRITE), nullptr);
+	EXPECT_EQ(drive->FileCreate("NEW.TXT", {}), nullptr);
+	EXPECT_FALSE(drive->FileUnlink("README.TXT"));
+	EXPECT_FALSE(drive->MakeDir("NEWDIR"));
+	EXPECT_TRUE(drive->IsReadOnly());
+}
+
+TEST(ZipDrive, FailsOnOtherFiles)
+{
+	const auto path = std::filesystem::temp_directory_path() /
+	                  "drive_zip_tests_not_a.zip";
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << "This is not an archive, only text that is long enough.";
+	}
+	bool is_error = false;
+	zipDrive drive(path.string().c_str(), 0xf8, is_error);
+	EXPECT_TRUE(is_error);
+	std::filesystem::remove(path);
+
+	EXPECT_TRUE(zipDrive::IsArchive("GAMES/DOOM.ZIP"));
+	EXPECT_FALSE(zipDrive::IsArchive("GAMES/DOOM.ISO"));
+}
+
+} // namespace
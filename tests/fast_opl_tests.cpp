@@ -0,0 +1,252 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/audio/private/fast_opl.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "nuked/opl3.h"
+
+namespace {
+
+constexpr auto OplRateHz = 49716;
+
+struct RegWrite {
+	uint16_t reg = 0;
+	uint8_t val  = 0;
+};
+
+// A two-operator voice on channel 0 with a silent modulator, so the carrier
+// plays a plain sine, decaying to `sustain_level` and holding there
+std::vector<RegWrite> sine_voice(const uint16_t fnum, const uint8_t block,
+                                 const uint8_t sustain_level = 0x20)
+{
+	return {{0x20, 0x21},
+	        {0x23, 0x21},
+	        {0x40, 0x3f},
+	        {0x43, 0x00},
+	        {0x60, 0xf4},
+	        {0x63, 0xf4},
+	        {0x80, static_cast<uint8_t>(sustain_level | 0x07)},
+	        {0x83, static_cast<uint8_t>(sustain_level | 0x07)},
+	        {0xa0, static_cast<uint8_t>(fnum & 0xff)},
+	        {0xc0, 0x00},
+	        {0xb0, static_cast<uint8_t>(0x20 | (block << 2) | (fnum >> 8))}};
+}
+
+// A feedback-heavy FM voice on several channels
+std::vector<RegWrite> fm_chord()
+{
+	std::vector<RegWrite> writes = {};
+	for (uint8_t ch = 0; ch < 6; ++ch) {
+		const auto off  = static_cast<uint16_t>((ch % 3) + (ch / 3) * 8);
+		const auto fnum = static_cast<uint16_t>(0x244 + ch * 21);
+
+		writes.push_back({static_cast<uint16_t>(0x20 + off), 0x01});
+		writes.push_back({static_cast<uint16_t>(0x23 + off), 0x01});
+		writes.push_back({static_cast<uint16_t>(0x40 + off), 0x10});
+		writes.push_back({static_cast<uint16_t>(0x43 + off), 0x00});
+		writes.push_back({static_cast<uint16_t>(0x60 + off), 0xf4});
+		writes.push_back({static_cast<uint16_t>(0x63 + off), 0xf4});
+		writes.push_back({static_cast<uint16_t>(0x80 + off), 0x25});
+		writes.push_back({static_cast<uint16_t>(0x83 + off), 0x25});
+		writes.push_back({static_cast<uint16_t>(0xa0 + ch),
+		                  static_cast<uint8_t>(fnum & 0xff)});
+		writes.push_back({static_cast<uint16_t>(0xc0 + ch), 0x0e});
+		writes.push_back({static_cast<uint16_t>(0xb0 + ch),
+		                  static_cast<uint8_t>(0x30 | (fnum >> 8))});
+	}
+	return writes;
+}
+
+// All five rhythm section voices, struck together
+std::vector<RegWrite> drum_hit()
+{
+	std::vector<RegWrite> writes = {};
+	for (const uint16_t off : {0x10, 0x11, 0x12, 0x13, 0x14, 0x15}) {
+		writes.push_back({static_cast<uint16_t>(0x20 + off), 0x01});
+		writes.push_back({static_cast<uint16_t>(0x40 + off), 0x04});
+		writes.push_back({static_cast<uint16_t>(0x60 + off), 0xf6});
+		writes.push_back({static_cast<uint16_t>(0x80 + off), 0x46});
+	}
+	for (const uint16_t ch : {6, 7, 8}) {
+		writes.push_back({static_cast<uint16_t>(0xa0 + ch), 0x57});
+		writes.push_back({static_cast<uint16_t>(0xb0 + ch), 0x09});
+	}
+	writes.push_back({0xbd, 0x3f});
+	return writes;
+}
+
+std::vector<int16_t> render_fast(const std::vector<RegWrite>& writes,
+                                 const size_t num_frames)
+{
+	FastOpl chip = {};
+	for (const auto& w : writes) {
+		chip.WriteReg(w.reg, w.val);
+	}
+	std::vector<int16_t> frames(num_frames * 2);
+	chip.Generate(frames.data(), num_frames);
+	return frames;
+}
+
+std::vector<int16_t> render_nuked(const std::vector<RegWrite>& writes,
+                                  const size_t num_frames)
+{
+	opl3_chip chip = {};
+	OPL3_Reset(&chip, OplRateHz);
+	for (const auto& w : writes) {
+		OPL3_WriteReg(&chip, w.reg, w.val);
+	}
+	std::vector<int16_t> frames(num_frames * 2);
+	OPL3_GenerateStream(&chip, frames.data(), static_cast<uint32_t>(num_frames));
+	return frames;
+}
+
+double rms(const std::vector<int16_t>& frames, const size_t start, const size_t end)
+{
+	double sum = 0.0;
+	for (auto i = start; i < end; ++i) {
+		sum += static_cast<double>(frames[i * 2]) * frames[i * 2];
+	}
+	return std::sqrt(sum / static_cast<double>(end - start));
+}
+
+int count_zero_crossings(const std::vector<int16_t>& frames, const size_t start,
+                         const size_t end)
+{
+	auto crossings = 0;
+	for (auto i = start + 1; i < end; ++i) {
+		if ((frames[i * 2 - 2] < 0) != (frames[i * 2] < 0)) {
+			++crossings;
+		}
+	}
+	return crossings;
+}
+
+TEST(FastOpl, SilentAfterReset)
+{
+	const auto frames = render_fast({}, 1000);
+	for (const auto sample : frames) {
+		ASSERT_EQ(sample, 0);
+	}
+}
+
+TEST(FastOpl, PlaysTheProgrammedPitch)
+{
+	// One cycle is 2^19 phase units of (fnum << block) / 2 per frame
+	constexpr uint16_t Fnum = 0x244;
+	constexpr uint8_t Block = 4;
+
+	const auto expected_hz = OplRateHz * ((Fnum << Block) >> 1) / double(1 << 19);
+
+	const auto frames = render_fast(sine_voice(Fnum, Block), OplRateHz);
+
+	const auto crossings = count_zero_crossings(frames, 0, OplRateHz);
+	EXPECT_NEAR(crossings / 2.0, expected_hz, 2.0);
+}
+
+TEST(FastOpl, TracksNukedLevels)
+{
+	for (const auto& writes : {sine_voice(0x244, 4), fm_chord()}) {
+		const auto num_frames = static_cast<size_t>(OplRateHz);
+
+		const auto fast  = render_fast(writes, num_frames);
+		const auto nuked = render_nuked(writes, num_frames);
+
+		// The attack, the decay and the sustained part should match
+		// within half a decibel
+		constexpr size_t NumWindows = 8;
+		const auto window_size      = num_frames / NumWindows;
+
+		for (size_t window = 0; window < NumWindows; ++window) {
+			const auto start     = window * window_size;
+			const auto end       = start + window_size;
+			const auto fast_rms  = rms(fast, start, end);
+			const auto nuked_rms = rms(nuked, start, end);
+
+			ASSERT_GT(nuked_rms, 10.0);
+			EXPECT_NEAR(20.0 * std::log10(fast_rms / nuked_rms), 0.0, 0.5)
+			        << "at frame " << start;
+		}
+	}
+}
+
+TEST(FastOpl, TracksNukedDrumLevels)
+{
+	// The noisy voices don't match sample for sample, but the hit's
+	// loudness should, within a decibel
+	constexpr size_t NumFrames = OplRateHz / 8;
+
+	const auto fast  = render_fast(drum_hit(), NumFrames);
+	const auto nuked = render_nuked(drum_hit(), NumFrames);
+
+	const auto fast_rms  = rms(fast, 0, NumFrames);
+	const auto nuked_rms = rms(nuked, 0, NumFrames);
+
+	ASSERT_GT(nuked_rms, 100.0);
+	EXPECT_NEAR(20.0 * std::log10(fast_rms / nuked_rms), 0.0, 1.0);
+}
+
+TEST(FastOpl, ReleasesToSilence)
+{
+	FastOpl chip = {};
+	for (const auto& w : sine_voice(0x244, 4)) {
+		chip.WriteReg(w.reg, w.val);
+	}
+	std::vector<int16_t> frames(OplRateHz / 10 * 2);
+	chip.Generate(frames.data(), OplRateHz / 10);
+
+	// Key off, and give the release rate of 7 two seconds
+	chip.WriteReg(0xb0, 0x12);
+	frames.resize(OplRateHz * 2 * 2);
+	chip.Generate(frames.data(), OplRateHz * 2);
+
+	for (auto i = frames.size() - 2000; i < frames.size(); ++i) {
+		ASSERT_EQ(frames[i], 0);
+	}
+}
+
+TEST(FastOpl, BlockSizeDoesNotChangeTheOutput)
+{
+	constexpr size_t NumFrames = 5000;
+
+	const auto whole = render_fast(fm_chord(), NumFrames);
+
+	FastOpl chip = {};
+	for (const auto& w : fm_chord()) {
+		chip.WriteReg(w.reg, w.val);
+	}
+	std::vector<int16_t> pieces(NumFrames * 2);
+	for (size_t pos = 0; pos < NumFrames;) {
+		const auto n = std::min<size_t>(1 + pos % 37, NumFrames - pos);
+		chip.Generate(&pieces[pos * 2], n);
+		pos += n;
+	}
+	EXPECT_EQ(whole, pieces);
+}
+
+TEST(FastOpl, Opl3PansChannels)
+{
+	auto writes = sine_voice(0x244, 4);
+
+	// OPL3 mode, channel 0 to the left output only
+	writes.insert(writes.begin(), {0x105, 0x01});
+	writes.push_back({0xc0, 0x10});
+
+	const auto frames = render_fast(writes, 2000);
+
+	auto left_peak  = 0;
+	auto right_peak = 0;
+	for (size_t i = 0; i < frames.size(); i += 2) {
+		left_peak  = std::max(left_peak, std::abs(frames[i]));
+		right_peak = std::max(right_peak, std::abs(frames[i + 1]));
+	}
+	EXPECT_GT(left_peak, 1000);
+	EXPECT_EQ(right_peak, 0);
+}
+
+} // namespace
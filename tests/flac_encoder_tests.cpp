@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "capture/audio/flac_encoder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <numbers>
+#include <vector>
+
+#include "decoders/dr_flac.h"
+
+namespace {
+
+constexpr uint32_t SampleRateHz = 48000;
+
+constexpr auto TwoPi = 2 * std::numbers::pi;
+
+using Samples = std::vector<int16_t>;
+
+int16_t to_int16(const double value)
+{
+	return static_cast<int16_t>(std::lround(std::clamp(value, -32768.0, 32767.0)));
+}
+
+// Tones, silence, a constant offset, full-scale noise, and a stretch with
+// the channels swapped, so every subframe type and channel pairing is used
+Samples make_audio(const size_t num_frames)
+{
+	Samples samples = {};
+	uint32_t seed   = 1;
+	for (size_t i = 0; i < num_frames; ++i) {
+		const auto t    = static_cast<double>(i) / SampleRateHz;
+		const auto part = i / 20'000 % 5;
+
+		int16_t left  = 0;
+		int16_t right = 0;
+		if (part == 0) {
+			left  = to_int16(20000 * std::sin(TwoPi * 440 * t));
+			right = to_int16(12000 * std::sin(TwoPi * 660 * t));
+		} else if (part == 1) {
+			left  = 0;
+			right = -1234;
+		} else if (part == 2) {
+			seed  = seed * 1'664'525 + 1'013'904'223;
+			left  = static_cast<int16_t>(seed >> 16);
+			right = static_cast<int16_t>(seed);
+		} else if (part == 3) {
+			left  = to_int16(32767 * std::sin(TwoPi * 110 * t));
+			right = -left;
+		} else {
+			left  = to_int16(8000 * std::sin(TwoPi * 220 * t));
+			right = to_int16(left * 0.9);
+		}
+		samples.push_back(left);
+		samples.push_back(right);
+	}
+	return samples;
+}
+
+std::vector<uint8_t> encode(const Samples& samples)
+{
+	std::unique_ptr<FILE, decltype(&fclose)> fp(tmpfile(), fclose);
+	EXPECT_TRUE(fp);
+
+	FlacEncoder encoder = {};
+	EXPECT_TRUE(encoder.Init(fp.get(), SampleRateHz));
+
+	// In uneven chunks, like the capture delivers them
+	constexpr size_t ChunkFrames = 1000;
+	for (size_t i = 0; i < samples.size() / 2; i += ChunkFrames) {
+		const auto n = std::min(ChunkFrames, samples.size() / 2 - i);
+		encoder.AddFrames(samples.data() + i * 2, n);
+	}
+	encoder.Finalise();
+
+	std::vector<uint8_t> file(static_cast<size_t>(ftell(fp.get())));
+	rewind(fp.get());
+	EXPECT_EQ(fread(file.data(), 1, file.size(), fp.get()), file.size());
+	return file;
+}
+
+Samples decode(const std::vector<uint8_t>& file, uint32_t& sample_rate_hz)
+{
+	unsigned int channels    = 0;
+	unsigned int rate        = 0;
+	drflac_uint64 num_frames = 0;
+
+	auto decoded = drflac_open_memory_and_read_pcm_frames_s16(
+	        file.data(), file.size(), &channels, &rate, &num_frames, nullptr);
+	if (!decoded) {
+		return {};
+	}
+	EXPECT_EQ(channels, 2);
+	sample_rate_hz = rate;
+
+	Samples samples(decoded, decoded + num_frames * channels);
+	drflac_free(decoded, nullptr);
+	return samples;
+}
+
+TEST(FlacEncoder, RoundTripsLosslessly)
+{
+	// Several full blocks and a short one, and more than 128 blocks so
+	// frame numbers take more than one byte
+	const auto audio = make_audio(FlacEncoder::BlockSize * 150 + 1000);
+	const auto file  = encode(audio);
+
+	uint32_t sample_rate_hz = 0;
+	EXPECT_EQ(decode(file, sample_rate_hz), audio);
+	EXPECT_EQ(sample_rate_hz, SampleRateHz);
+}
+
+TEST(FlacEncoder, IsSmallerThanWav)
+{
+	const auto audio = make_audio(FlacEncoder::BlockSize * 100);
+	const auto file  = encode(audio);
+
+	const auto wav_size = audio.size() * sizeof(int16_t);
+	EXPECT_LT(file.size(), wav_size * 3 / 4);
+}
+
+TEST(FlacEncoder, ShortStream)
+{
+	const Samples audio = {1, -1, 2, -2, 3, -3};
+	const auto file     = encode(audio);
+
+	uint32_t sample_rate_hz = 0;
+	EXPECT_EQ(decode(file, sample_rate_hz), audio);
+}
+
+TEST(FlacEncoder, EmptyStream)
+{
+	const auto file = encode({});
+
+	// The magic and the stream info block
+	EXPECT_EQ(file.size(), 4 + 4 + 34);
+}
+
+} // namespace
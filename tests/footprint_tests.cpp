@@ -0,0 +1,187 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/footprint.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+#if !defined(WIN32)
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t BufferBytes = 64 * 4096;
+
+std::optional<FootprintSample> find_sample(const std::string& name)
+{
+	for (const auto& sample : FOOTPRINT_Sample()) {
+		if (sample.name == name) {
+			return sample;
+		}
+	}
+	return {};
+}
+
+TEST(Footprint, RegistersForItsLifetime)
+{
+	{
+		FootprintRegion region("test_lifetime", "Tracked in a test.");
+
+		const auto sample = find_sample("test_lifetime");
+		ASSERT_TRUE(sample);
+		EXPECT_EQ(sample->help, "Tracked in a test.");
+		EXPECT_EQ(sample->reserved_bytes, 0);
+		EXPECT_EQ(sample->resident_bytes, 0);
+	}
+	EXPECT_FALSE(find_sample("test_lifetime"));
+}
+
+TEST(Footprint, SamplesAreSortedByName)
+{
+	FootprintRegion second("test_sort_b", "Second.");
+	FootprintRegion first("test_sort_a", "First.");
+
+	const auto samples = FOOTPRINT_Sample();
+	EXPECT_TRUE(std::is_sorted(samples.begin(),
+	                           samples.end(),
+	                           [](const auto& a, const auto& b) {
+		                           return a.name < b.name;
+	                           }));
+}
+
+TEST(Footprint, BuffersStartZeroed)
+{
+	const FootprintBuffer buffer(BufferBytes);
+	ASSERT_NE(buffer.data(), nullptr);
+	EXPECT_EQ(buffer.size(), BufferBytes);
+	EXPECT_TRUE(std::all_of(buffer.data(),
+	                        buffer.data() + buffer.size(),
+	                        [](const auto byte) { return byte == 0; }));
+}
+
+TEST(Footprint, BuffersMove)
+{
+	FootprintBuffer buffer(BufferBytes);
+	const auto data = buffer.data();
+
+	FootprintBuffer moved = std::move(buffer);
+	EXPECT_EQ(moved.data(), data);
+	EXPECT_EQ(moved.size(), BufferBytes);
+	EXPECT_EQ(buffer.data(), nullptr);
+	EXPECT_EQ(buffer.size(), 0);
+}
+
+TEST(Footprint, TracksReservedBytes)
+{
+	const FootprintBuffer buffer(BufferBytes);
+	FootprintRegion region("test_reserved", "Tracked in a test.");
+	region.Track(buffer.data(), buffer.size());
+
+	const auto sample = find_sample("test_reserved");
+	ASSERT_TRUE(sample);
+	EXPECT_EQ(sample->reserved_bytes, BufferBytes);
+	EXPECT_LE(sample->resident_bytes, BufferBytes);
+
+	region.Track(nullptr, 0);
+	EXPECT_EQ(find_sample("test_reserved")->reserved_bytes, 0);
+}
+
+#if !defined(WIN32)
+size_t page_size()
+{
+	return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+TEST(Footprint, CountsTouchedPages)
+{
+	FootprintBuffer buffer(BufferBytes);
+	EXPECT_EQ(FOOTPRINT_CountResidentBytes(buffer.data(), buffer.size()), 0);
+
+	buffer.data()[0]                     = 1;
+	buffer.data()[2 * page_size() + 100] = 1;
+	EXPECT_EQ(FOOTPRINT_CountResidentBytes(buffer.data(), buffer.size()),
+	          2 * page_size());
+}
+#endif
+
+#if defined(__linux__)
+TEST(Footprint, ReleasedPagesReadBackAsZeros)
+{
+	FootprintBuffer buffer(BufferBytes);
+	std::memset(buffer.data(), 0xaa, buffer.size());
+
+	// Leave partial pages at either end
+	ASSERT_TRUE(FOOTPRINT_ReleasePages(buffer.data() + 10, buffer.size() - 20));
+
+	// Only the two partial pages stay resident, until reading the rest
+	// maps in zero pages
+	EXPECT_EQ(FOOTPRINT_CountResidentBytes(buffer.data(), buffer.size()),
+	          2 * page_size());
+
+	EXPECT_EQ(buffer.data()[9], 0xaa);
+	EXPECT_EQ(buffer.data()[buffer.size() - 10], 0xaa);
+	EXPECT_TRUE(std::all_of(buffer.data() + 10,
+	                        buffer.data() + buffer.size() - 10,
+	                        [](const auto byte) { return byte == 0; }));
+}
+
+TEST(Footprint, ReportsProcessResidentSet)
+{
+	const auto rss = FOOTPRINT_GetProcessResidentBytes();
+	ASSERT_TRUE(rss);
+	EXPECT_GT(*rss, 0);
+}
+#endif
+
+TEST(Footprint, ZeroPagesInEitherProfile)
+{
+	std::vector<uint8_t> bytes(3 * 4096 + 5, 0x55);
+
+	for (const auto profile : {MemoryProfile::Normal, MemoryProfile::Low}) {
+		FOOTPRINT_SetProfile(profile);
+		std::fill(bytes.begin(), bytes.end(), 0x55);
+		FOOTPRINT_ZeroPages(bytes.data(), bytes.size());
+		EXPECT_TRUE(std::all_of(bytes.begin(), bytes.end(), [](const auto byte) {
+			return byte == 0;
+		}));
+	}
+	FOOTPRINT_SetProfile(MemoryProfile::Normal);
+}
+
+TEST(Footprint, ProfileNames)
+{
+	FOOTPRINT_SetProfile(MemoryProfile::Low);
+	EXPECT_STREQ(FOOTPRINT_GetProfileName(), "lowmem");
+	FOOTPRINT_SetProfile(MemoryProfile::Normal);
+	EXPECT_STREQ(FOOTPRINT_GetProfileName(), "normal");
+}
+
+TEST(Footprint, TrimRunsTheHandlers)
+{
+	FootprintBuffer buffer(BufferBytes);
+	int num_trims = 0;
+
+	FootprintRegion region("test_trim", "Trimmed in a test.", [&] {
+		++num_trims;
+		FOOTPRINT_ReleasePages(buffer.data(), buffer.size());
+	});
+	region.Track(buffer.data(), buffer.size());
+	std::memset(buffer.data(), 1, buffer.size());
+
+	const auto released = FOOTPRINT_Trim();
+	EXPECT_EQ(num_trims, 1);
+#if defined(__linux__)
+	EXPECT_GE(released, BufferBytes);
+	EXPECT_EQ(find_sample("test_trim")->resident_bytes, 0);
+#else
+	(void)released;
+#endif
+}
+
+} // namespace
@@ -6,7 +6,10 @@
 #include <gtest/gtest.h>
 
 #include <cerrno>
+#include <cstdint>
+#include <fstream>
 #include <string>
+#include <vector>
 
 namespace {
 
@@ -123,4 +126,43 @@ TEST_F(CreateDirTest, FailDueToFileExisting2)
 	EXPECT_EQ(errno, EEXIST);
 }
 
+TEST(CopyNativeFile, ReplacesContents)
+{
+	const auto src_path = std_fs::temp_directory_path() / "copy_native_file_src.bin";
+	const auto dst_path = std_fs::temp_directory_path() / "copy_native_file_dst.bin";
+
+	// Bigger than any single buffered copy
+	std::vector<uint8_t> data(3 * 1024 * 1024 + 17);
+	for (size_t i = 0; i < data.size(); ++i) {
+		data[i] = static_cast<uint8_t>(i * 31 + (i >> 12));
+	}
+	const std::vector<uint8_t> stale(4 * 1024 * 1024, 0xee);
+
+	std::ofstream(src_path).close();
+	std::ofstream(dst_path).close();
+	const auto src = open_native_file(src_path, true);
+	const auto dst = open_native_file(dst_path, true);
+	ASSERT_NE(src, InvalidNativeFileHandle);
+	ASSERT_NE(dst, InvalidNativeFileHandle);
+	ASSERT_EQ(write_native_file(src, data.data(), data.size()).num_bytes,
+	          static_cast<int64_t>(data.size()));
+	ASSERT_EQ(write_native_file(dst, stale.data(), stale.size()).num_bytes,
+	          static_cast<int64_t>(stale.size()));
+
+	ASSERT_TRUE(copy_native_file(src, dst));
+
+	EXPECT_EQ(seek_native_file(dst, 0, NativeSeek::End),
+	          static_cast<int64_t>(data.size()));
+	std::vector<uint8_t> copy(data.size());
+	ASSERT_EQ(seek_native_file(dst, 0, NativeSeek::Set), 0);
+	EXPECT_EQ(read_native_file(dst, copy.data(), copy.size()).num_bytes,
+	          static_cast<int64_t>(copy.size()));
+	EXPECT_EQ(copy, data);
+
+	close_native_file(src);
+	close_native_file(dst);
+	delete_native_file(src_path);
+	delete_native_file(dst_path);
+}
+
 } // namespace
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/audio/private/gus.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// About the number of frames per mixer block at the 32-voice rate
+constexpr size_t BlockSize = 256;
+
+// Voice control bits, as in Voice::CTRL
+constexpr uint8_t Stopped       = 0x02;
+constexpr uint8_t Bit16         = 0x04;
+constexpr uint8_t Loop          = 0x08;
+constexpr uint8_t Bidirectional = 0x10;
+
+struct Tables {
+	ram_array_t ram                 = ram_array_t(RAM_SIZE);
+	vol_scalars_array_t vol_scalars = {};
+	pan_scalars_array_t pan_scalars = {};
+
+	Tables()
+	{
+		uint32_t seed = 1;
+		for (auto& byte : ram) {
+			seed = seed * 1'664'525 + 1'013'904'223;
+			byte = static_cast<uint8_t>(seed >> 24);
+		}
+		for (size_t i = 0; i < vol_scalars.size(); ++i) {
+			vol_scalars[i] = static_cast<float>(i) / (VOLUME_LEVELS - 1);
+		}
+		for (size_t i = 0; i < pan_scalars.size(); ++i) {
+			const auto right = static_cast<float>(i) / (PAN_POSITIONS - 1);
+			pan_scalars[i]   = {1.0f - right, right};
+		}
+	}
+};
+
+// Voices looping over their own samples, the way tracker music does, with
+// a mix of 8 and 16-bit samples, interpolated pitches and ramping volumes
+std::vector<std::unique_ptr<Voice>> make_voices(const int num_voices, VoiceIrq& irq)
+{
+	std::vector<std::unique_ptr<Voice>> voices = {};
+	for (int i = 0; i < num_voices; ++i) {
+		auto voice = std::make_unique<Voice>(static_cast<uint8_t>(i), irq);
+
+		const auto sample_start = i * 32 * 1024;
+		const auto is_16bit     = (i % 3 == 0);
+		const auto loop_length  = 2000 + i * 300;
+
+		voice->UpdateWaveState(Loop | (is_16bit ? Bit16 : 0));
+		voice->wave_ctrl.start = (is_16bit ? sample_start / 2 : sample_start) *
+		                         WAVE_WIDTH;
+		voice->wave_ctrl.end = voice->wave_ctrl.start + loop_length * WAVE_WIDTH;
+		voice->wave_ctrl.pos = voice->wave_ctrl.start;
+		voice->WriteWaveRate(static_cast<uint16_t>(300 + i * 57));
+
+		if (i % 4 == 0) {
+			voice->UpdateVolState(Loop | Bidirectional);
+			voice->vol_ctrl.start = 0x80 * 16 * VOLUME_INC_SCALAR;
+			voice->vol_ctrl.end   = 0xf0 * 16 * VOLUME_INC_SCALAR;
+			voice->vol_ctrl.pos   = voice->vol_ctrl.start;
+			voice->WriteVolRate(0x48);
+		} else {
+			voice->UpdateVolState(Stopped);
+			voice->vol_ctrl.pos = (3600 + i * 10) * VOLUME_INC_SCALAR;
+		}
+		voice->WritePanPot(static_cast<uint8_t>(i % PAN_POSITIONS));
+
+		voices.push_back(std::move(voice));
+	}
+	return voices;
+}
+
+using RenderFn = void (Voice::*)(const ram_array_t&, const vol_scalars_array_t&,
+                                 const pan_scalars_array_t&,
+                                 std::vector<AudioFrame>&);
+
+// Every voice rendered into one block, like Gus::RenderFrames, either run
+// by run as the emulation does or through the frame-at-a-time reference
+void BM_GusRenderFrames(benchmark::State& state, const RenderFn render)
+{
+	const auto tables = std::make_unique<Tables>();
+
+	VoiceIrq irq = {};
+	auto voices  = make_voices(static_cast<int>(state.range(0)), irq);
+
+	std::vector<AudioFrame> frames(BlockSize);
+	for (auto _ : state) {
+		frames.assign(BlockSize, {});
+		for (auto& voice : voices) {
+			(voice.get()->*render)(tables->ram,
+			                       tables->vol_scalars,
+			                       tables->pan_scalars,
+			                       frames);
+		}
+		benchmark::DoNotOptimize(frames.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(BlockSize));
+}
+BENCHMARK_CAPTURE(BM_GusRenderFrames, runs, &Voice::RenderFrames)
+        ->Arg(14)
+        ->Arg(MAX_VOICES);
+BENCHMARK_CAPTURE(BM_GusRenderFrames, reference, &Voice::RenderFramesScalar)
+        ->Arg(14)
+        ->Arg(MAX_VOICES);
+
+} // namespace
@@ -0,0 +1,208 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/audio/private/gus.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+// Voice control bits, as in Voice::CTRL
+constexpr uint8_t Stopped       = 0x02;
+constexpr uint8_t Bit16         = 0x04;
+constexpr uint8_t Loop          = 0x08;
+constexpr uint8_t Bidirectional = 0x10;
+constexpr uint8_t RaiseIrq      = 0x20;
+constexpr uint8_t Decreasing    = 0x40;
+
+struct VoiceSetup {
+	uint8_t wave_state = 0;
+	int32_t wave_start = 0;
+	int32_t wave_end   = 0;
+	int32_t wave_pos   = 0;
+	uint16_t wave_rate = 0;
+
+	uint8_t vol_state = Stopped;
+	int32_t vol_start = 0;
+	int32_t vol_end   = 0;
+	int32_t vol_pos   = 0;
+	uint16_t vol_rate = 0;
+
+	uint8_t pan = PAN_DEFAULT_POSITION;
+};
+
+class GusVoiceTest : public testing::Test {
+protected:
+	GusVoiceTest()
+	{
+		std::mt19937 rng(1234);
+		std::uniform_int_distribution<int> byte(0, 255);
+		for (auto& b : ram) {
+			b = static_cast<uint8_t>(byte(rng));
+		}
+		for (size_t i = 0; i < vol_scalars.size(); ++i) {
+			vol_scalars[i] = static_cast<float>(i) / (VOLUME_LEVELS - 1);
+		}
+		for (size_t i = 0; i < pan_scalars.size(); ++i) {
+			const auto right = static_cast<float>(i) / (PAN_POSITIONS - 1);
+			pan_scalars[i]   = {1.0f - right * 0.7f, 0.3f + right * 0.7f};
+		}
+	}
+
+	static void Program(Voice& voice, const VoiceSetup& setup)
+	{
+		voice.UpdateWaveState(setup.wave_state);
+		voice.wave_ctrl.start = setup.wave_start;
+		voice.wave_ctrl.end   = setup.wave_end;
+		voice.wave_ctrl.pos   = setup.wave_pos;
+		voice.WriteWaveRate(setup.wave_rate);
+
+		voice.UpdateVolState(setup.vol_state);
+		voice.vol_ctrl.start = setup.vol_start;
+		voice.vol_ctrl.end   = setup.vol_end;
+		voice.vol_ctrl.pos   = setup.vol_pos;
+		voice.WriteVolRate(setup.vol_rate);
+
+		voice.WritePanPot(setup.pan);
+	}
+
+	// Renders the voice in uneven blocks both ways, checking the frames
+	// and the voice's state after each block
+	void ExpectSameAsReference(const VoiceSetup& setup)
+	{
+		VoiceIrq irq           = {};
+		VoiceIrq reference_irq = {};
+
+		Voice voice(3, irq);
+		Voice reference(3, reference_irq);
+		Program(voice, setup);
+		Program(reference, setup);
+
+		for (size_t block = 0; block < 40; ++block) {
+			const auto num_frames = 1 + (block * 37) % 300;
+
+			std::vector<AudioFrame> frames(num_frames, {1.0f, -2.0f});
+			std::vector<AudioFrame> reference_frames(num_frames, {1.0f, -2.0f});
+
+			voice.RenderFrames(ram, vol_scalars, pan_scalars, frames);
+			reference.RenderFramesScalar(ram,
+			                             vol_scalars,
+			                             pan_scalars,
+			                             reference_frames);
+
+			for (size_t i = 0; i < num_frames; ++i) {
+				ASSERT_EQ(frames[i].left, reference_frames[i].left)
+				        << "block " << block << ", frame " << i;
+				ASSERT_EQ(frames[i].right, reference_frames[i].right)
+				        << "block " << block << ", frame " << i;
+			}
+			ASSERT_EQ(voice.wave_ctrl.pos, reference.wave_ctrl.pos);
+			ASSERT_EQ(voice.vol_ctrl.pos, reference.vol_ctrl.pos);
+			ASSERT_EQ(voice.ReadWaveState(), reference.ReadWaveState());
+			ASSERT_EQ(voice.ReadVolState(), reference.ReadVolState());
+		}
+	}
+
+	ram_array_t ram                 = ram_array_t(RAM_SIZE);
+	vol_scalars_array_t vol_scalars = {};
+	pan_scalars_array_t pan_scalars = {};
+};
+
+// Wave positions carry 9 fractional bits
+constexpr int32_t Addr(const int32_t sample)
+{
+	return sample * WAVE_WIDTH;
+}
+
+TEST_F(GusVoiceTest, ForwardLoop8Bit)
+{
+	ExpectSameAsReference({.wave_state = Loop | RaiseIrq,
+	                       .wave_start = Addr(1000),
+	                       .wave_end   = Addr(1700),
+	                       .wave_pos   = Addr(1000),
+	                       .wave_rate  = 700,
+	                       .vol_pos    = 4000 * VOLUME_INC_SCALAR,
+	                       .pan        = 3});
+}
+
+TEST_F(GusVoiceTest, BidirectionalLoop16Bit)
+{
+	ExpectSameAsReference({.wave_state = Bit16 | Loop | Bidirectional,
+	                       .wave_start = Addr(20000),
+	                       .wave_end   = Addr(20333),
+	                       .wave_pos   = Addr(20100) + 77,
+	                       .wave_rate  = 1500,
+	                       .vol_pos    = 3500 * VOLUME_INC_SCALAR,
+	                       .pan        = 12});
+}
+
+TEST_F(GusVoiceTest, VolumeRampsWhileLooping)
+{
+	ExpectSameAsReference({.wave_state = Loop,
+	                       .wave_start = Addr(5000),
+	                       .wave_end   = Addr(5100),
+	                       .wave_pos   = Addr(5000),
+	                       .wave_rate  = 333,
+	                       .vol_state  = Loop | Bidirectional | RaiseIrq,
+	                       .vol_start  = 0x40 * 16 * VOLUME_INC_SCALAR,
+	                       .vol_end    = 0xf0 * 16 * VOLUME_INC_SCALAR,
+	                       .vol_pos    = 0x40 * 16 * VOLUME_INC_SCALAR,
+	                       .vol_rate   = 0x3f});
+}
+
+TEST_F(GusVoiceTest, StopsAtTheEnd)
+{
+	ExpectSameAsReference({.wave_state = RaiseIrq,
+	                       .wave_start = Addr(100),
+	                       .wave_end   = Addr(1500),
+	                       .wave_pos   = Addr(100),
+	                       .wave_rate  = 1024,
+	                       .vol_state  = 0,
+	                       .vol_start  = 0x10 * 16 * VOLUME_INC_SCALAR,
+	                       .vol_end    = 0xfe * 16 * VOLUME_INC_SCALAR,
+	                       .vol_pos    = 0xfe * 16 * VOLUME_INC_SCALAR,
+	                       .vol_rate   = 0x41});
+}
+
+TEST_F(GusVoiceTest, PlaysBackwards)
+{
+	ExpectSameAsReference({.wave_state = Decreasing | Loop,
+	                       .wave_start = Addr(300000),
+	                       .wave_end   = Addr(302000),
+	                       .wave_pos   = Addr(301999),
+	                       .wave_rate  = 2047,
+	                       .vol_pos    = 4095 * VOLUME_INC_SCALAR});
+}
+
+TEST_F(GusVoiceTest, RollsOverPastTheEnd)
+{
+	// 16-bit volume control without looping turns on the wave rollover
+	ExpectSameAsReference({.wave_state = RaiseIrq,
+	                       .wave_start = Addr(9000),
+	                       .wave_end   = Addr(9800),
+	                       .wave_pos   = Addr(9000),
+	                       .wave_rate  = 512,
+	                       .vol_state  = Stopped | Bit16,
+	                       .vol_pos    = 3000 * VOLUME_INC_SCALAR});
+}
+
+TEST_F(GusVoiceTest, StoppedVoiceAddsNothing)
+{
+	VoiceIrq irq = {};
+	Voice voice(0, irq);
+	Program(voice,
+	        {.wave_state = Stopped | 0x01, .vol_state = Stopped | 0x01});
+
+	std::vector<AudioFrame> frames(64, {0.5f, 0.25f});
+	voice.RenderFrames(ram, vol_scalars, pan_scalars, frames);
+
+	for (const auto& frame : frames) {
+		EXPECT_EQ(frame.left, 0.5f);
+		EXPECT_EQ(frame.right, 0.25f);
+	}
+}
+
+} // namespace
@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/host_dir_watcher.h"
+
+#include "dosbox.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+#if defined(LINUX)
+
+using ChangeType = HostDirWatcher::ChangeType;
+
+class HostDirWatcherTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		dir = std::filesystem::temp_directory_path() / "host_dir_watcher_test";
+		std::filesystem::remove_all(dir);
+		ASSERT_TRUE(std::filesystem::create_directory(dir));
+	}
+
+	void TearDown() override
+	{
+		std::filesystem::remove_all(dir);
+	}
+
+	void create_file(const std::string& name)
+	{
+		std::ofstream(dir / name) << "test";
+	}
+
+	std::filesystem::path dir = {};
+};
+
+TEST_F(HostDirWatcherTest, ReportsAddedAndRemovedEntries)
+{
+	HostDirWatcher watcher = {};
+	ASSERT_TRUE(watcher.IsAvailable());
+
+	const auto watch = watcher.Watch(dir.string().c_str());
+	ASSERT_GE(watch, 0);
+	EXPECT_TRUE(watcher.TakeChanges().empty());
+
+	create_file("input.txt");
+	std::filesystem::create_directory(dir / "subdir");
+	std::filesystem::rename(dir / "input.txt", dir / "renamed.txt");
+	std::filesystem::remove(dir / "subdir");
+
+	const auto changes = watcher.TakeChanges();
+	ASSERT_EQ(changes.size(), 5u);
+
+	EXPECT_EQ(changes[0].type, ChangeType::Added);
+	EXPECT_EQ(changes[0].name, "input.txt");
+	EXPECT_FALSE(changes[0].is_dir);
+
+	EXPECT_EQ(changes[1].type, ChangeType::Added);
+	EXPECT_EQ(changes[1].name, "subdir");
+	EXPECT_TRUE(changes[1].is_dir);
+
+	EXPECT_EQ(changes[2].type, ChangeType::Removed);
+	EXPECT_EQ(changes[2].name, "input.txt");
+	EXPECT_EQ(changes[3].type, ChangeType::Added);
+	EXPECT_EQ(changes[3].name, "renamed.txt");
+
+	EXPECT_EQ(changes[4].type, ChangeType::Removed);
+	EXPECT_EQ(changes[4].name, "subdir");
+	EXPECT_TRUE(changes[4].is_dir);
+
+	for (const auto& change : changes) {
+		EXPECT_EQ(change.watch, watch);
+	}
+	EXPECT_TRUE(watcher.TakeChanges().empty());
+}
+
+TEST_F(HostDirWatcherTest, ReportsWatchedDirectoryGone)
+{
+	std::filesystem::create_directory(dir / "subdir");
+
+	HostDirWatcher watcher = {};
+	const auto watch = watcher.Watch((dir / "subdir").string().c_str());
+	ASSERT_GE(watch, 0);
+	EXPECT_EQ(watcher.Watch((dir / "subdir").string().c_str()), watch);
+
+	std::filesystem::remove(dir / "subdir");
+
+	const auto changes = watcher.TakeChanges();
+	ASSERT_FALSE(changes.empty());
+	for (const auto& change : changes) {
+		EXPECT_EQ(change.watch, watch);
+		EXPECT_EQ(change.type, ChangeType::Gone);
+	}
+}
+
+TEST_F(HostDirWatcherTest, UnwatchedDirectoriesAreQuiet)
+{
+	HostDirWatcher watcher = {};
+	const auto watch = watcher.Watch(dir.string().c_str());
+	ASSERT_GE(watch, 0);
+	watcher.Unwatch(watch);
+
+	// Only the end of the watch itself is reported
+	create_file("input.txt");
+	for (const auto& change : watcher.TakeChanges()) {
+		EXPECT_EQ(change.type, ChangeType::Gone);
+	}
+}
+
+TEST_F(HostDirWatcherTest, FilesCantBeWatched)
+{
+	create_file("input.txt");
+
+	HostDirWatcher watcher = {};
+	EXPECT_LT(watcher.Watch((dir / "input.txt").string().c_str()), 0);
+	EXPECT_LT(watcher.Watch((dir / "missing").string().c_str()), 0);
+}
+
+#else
+
+TEST(HostDirWatcher, NothingIsWatched)
+{
+	HostDirWatcher watcher = {};
+	EXPECT_FALSE(watcher.IsAvailable());
+	EXPECT_LT(watcher.Watch("."), 0);
+	EXPECT_TRUE(watcher.TakeChanges().empty());
+}
+
+#endif
+
+} // namespace
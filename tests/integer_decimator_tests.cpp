@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "audio/integer_decimator.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace {
+
+constexpr auto InputRateHz = 224000.0;
+
+std::vector<float> make_sine(const size_t num_frames, const double freq_hz)
+{
+	std::vector<float> samples(num_frames);
+	for (size_t i = 0; i < num_frames; ++i) {
+		const auto phase = 2.0 * std::numbers::pi * freq_hz *
+		                   static_cast<double>(i) / InputRateHz;
+		samples[i] = static_cast<float>(10000.0 * std::sin(phase));
+	}
+	return samples;
+}
+
+// The peak output level past the filter's delay, relative to the input's
+double decimated_gain(const int ratio, const double freq_hz)
+{
+	IntegerDecimator<float> decimator = {};
+	decimator.Configure(ratio);
+
+	const auto in = make_sine(16384, freq_hz);
+	std::vector<float> out = {};
+	decimator.Process(in.data(), in.size(), out);
+
+	const auto settled = out.begin() + static_cast<ptrdiff_t>(out.size() / 4);
+	const auto peak    = std::max(*std::max_element(settled, out.end()),
+                                   -*std::min_element(settled, out.end()));
+	return peak / 10000.0;
+}
+
+TEST(IntegerDecimator, OneOutputFramePerRatioInputFrames)
+{
+	for (const auto ratio : {2, 3, 4, 8}) {
+		IntegerDecimator<float> decimator = {};
+		decimator.Configure(ratio);
+
+		std::vector<float> in(100, 1.0f);
+		std::vector<float> out = {};
+
+		// Part of a ratio's frames carries over to the next call
+		decimator.Process(in.data(), 5, out);
+		EXPECT_EQ(out.size(), 5u / ratio) << "ratio " << ratio;
+
+		const auto num_in = decimator.GetInputFramesFor(10);
+		decimator.Process(in.data(), num_in, out);
+		EXPECT_EQ(out.size(), 5u / ratio + 10) << "ratio " << ratio;
+		EXPECT_EQ(decimator.GetInputFramesFor(1), static_cast<size_t>(ratio));
+	}
+}
+
+TEST(IntegerDecimator, ConstantInputPassesAtUnityGain)
+{
+	IntegerDecimator<float> decimator = {};
+	decimator.Configure(4);
+
+	const std::vector<float> in(1024, 1000.0f);
+	std::vector<float> out = {};
+	decimator.Process(in.data(), in.size(), out);
+
+	// Once the history has filled
+	for (size_t i = 32; i < out.size(); ++i) {
+		EXPECT_NEAR(out[i], 1000.0f, 0.01f);
+	}
+}
+
+TEST(IntegerDecimator, PassesAudioAndRejectsAliases)
+{
+	// Decimating 224 kHz by 4 to 56 kHz, whose Nyquist frequency is 28 kHz
+	EXPECT_NEAR(decimated_gain(4, 1000.0), 1.0, 0.01);
+	EXPECT_NEAR(decimated_gain(4, 10000.0), 1.0, 0.02);
+
+	// Would alias to 16 kHz and 6 kHz
+	EXPECT_LT(decimated_gain(4, 40000.0), 0.001);
+	EXPECT_LT(decimated_gain(4, 62000.0), 0.001);
+}
+
+TEST(IntegerDecimator, StereoMatchesMono)
+{
+	const auto left  = make_sine(1000, 3000.0);
+	const auto right = make_sine(1000, 45000.0);
+
+	std::vector<AudioFrame> stereo_in(left.size());
+	for (size_t i = 0; i < left.size(); ++i) {
+		stereo_in[i] = {left[i], right[i]};
+	}
+
+	IntegerDecimator<AudioFrame> stereo = {};
+	IntegerDecimator<float> mono_left   = {};
+	IntegerDecimator<float> mono_right  = {};
+	stereo.Configure(4);
+	mono_left.Configure(4);
+	mono_right.Configure(4);
+
+	std::vector<AudioFrame> stereo_out = {};
+	std::vector<float> left_out        = {};
+	std::vector<float> right_out       = {};
+	stereo.Process(stereo_in.data(), stereo_in.size(), stereo_out);
+	mono_left.Process(left.data(), left.size(), left_out);
+	mono_right.Process(right.data(), right.size(), right_out);
+
+	ASSERT_EQ(stereo_out.size(), left_out.size());
+	for (size_t i = 0; i < stereo_out.size(); ++i) {
+		EXPECT_EQ(stereo_out[i].left, left_out[i]);
+		EXPECT_EQ(stereo_out[i].right, right_out[i]);
+	}
+}
+
+} // namespace
@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "audio/private/integer_upsampler.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <vector>
+
+namespace {
+
+constexpr auto AllQualities = {ResampleQuality::Low,
+                               ResampleQuality::Medium,
+                               ResampleQuality::High};
+
+std::vector<AudioFrame> make_sine(const size_t num_frames, const double freq,
+                                  const double rate_hz)
+{
+	std::vector<AudioFrame> frames(num_frames);
+	for (size_t i = 0; i < num_frames; ++i) {
+		const auto phase = 2.0 * std::numbers::pi * freq * static_cast<double>(i) /
+		                   rate_hz;
+		frames[i] = {static_cast<float>(10000.0 * std::sin(phase)),
+		             static_cast<float>(-5000.0 * std::cos(phase))};
+	}
+	return frames;
+}
+
+TEST(IntegerUpsampler, OnlyExactRatiosAreUpsampled)
+{
+	EXPECT_TRUE(IntegerUpsampler::CanUpsample(22050, 44100));
+	EXPECT_TRUE(IntegerUpsampler::CanUpsample(24000, 48000));
+	EXPECT_TRUE(IntegerUpsampler::CanUpsample(16000, 48000));
+	EXPECT_TRUE(IntegerUpsampler::CanUpsample(6000, 48000));
+
+	EXPECT_FALSE(IntegerUpsampler::CanUpsample(48000, 48000));
+	EXPECT_FALSE(IntegerUpsampler::CanUpsample(22050, 48000));
+	EXPECT_FALSE(IntegerUpsampler::CanUpsample(49716, 48000));
+	EXPECT_FALSE(IntegerUpsampler::CanUpsample(5000, 45000));
+	EXPECT_FALSE(IntegerUpsampler::CanUpsample(0, 48000));
+}
+
+TEST(IntegerUpsampler, MatchesTheReference)
+{
+	const auto in = make_sine(301, 1000.0, 24000.0);
+
+	for (const auto quality : AllQualities) {
+		for (auto ratio = 2; ratio <= IntegerUpsampler::MaxRatio; ++ratio) {
+			IntegerUpsampler simd = {};
+			IntegerUpsampler reference = {};
+			simd.Configure(ratio, quality);
+			reference.Configure(ratio, quality);
+
+			std::vector<AudioFrame> expected = {};
+			std::vector<AudioFrame> actual = {};
+
+			// In uneven chunks, as channels add their samples
+			for (size_t pos = 0; pos < in.size();) {
+				const auto n = std::min(in.size() - pos, pos % 7 + 1);
+				reference.ProcessScalar(in.data() + pos, n, expected);
+				simd.Process(in.data() + pos, n, actual);
+				pos += n;
+			}
+			ASSERT_EQ(actual.size(), expected.size());
+			EXPECT_EQ(std::memcmp(actual.data(),
+			                      expected.data(),
+			                      actual.size() * sizeof(AudioFrame)),
+			          0)
+			        << "ratio " << ratio;
+		}
+	}
+}
+
+TEST(IntegerUpsampler, SkipsTheFilterDelay)
+{
+	for (const auto quality : AllQualities) {
+		for (auto ratio = 2; ratio <= IntegerUpsampler::MaxRatio; ++ratio) {
+			IntegerUpsampler upsampler = {};
+			upsampler.Configure(ratio, quality);
+
+			const auto in = make_sine(1000, 500.0, 16000.0);
+			std::vector<AudioFrame> out = {};
+			upsampler.Process(in.data(), in.size(), out);
+
+			const auto delay = static_cast<size_t>(
+			        upsampler.GetTapsPerPhase() * ratio / 2 - 1);
+			ASSERT_EQ(out.size(), in.size() * ratio - delay);
+
+			// Past the start-up, every ratio-th output frame is the
+			// input frame it lines up with
+			const auto settled = static_cast<size_t>(upsampler.GetTapsPerPhase());
+			for (size_t i = settled; i < in.size() - settled; ++i) {
+				const auto& frame = out[i * static_cast<size_t>(ratio)];
+				ASSERT_NEAR(frame.left, in[i].left, 10.0f) << i;
+				ASSERT_NEAR(frame.right, in[i].right, 10.0f) << i;
+			}
+
+			// And starts over after a reset
+			upsampler.Reset();
+			out.clear();
+			upsampler.Process(in.data(), in.size(), out);
+			EXPECT_EQ(out.size(), in.size() * ratio - delay);
+		}
+	}
+}
+
+TEST(IntegerUpsampler, ConstantInputGivesConstantOutput)
+{
+	IntegerUpsampler upsampler = {};
+	upsampler.Configure(3, ResampleQuality::Low);
+
+	const std::vector<AudioFrame> in(500, AudioFrame(1000.0f, -1000.0f));
+	std::vector<AudioFrame> out = {};
+	upsampler.Process(in.data(), in.size(), out);
+
+	for (size_t i = out.size() / 2; i < out.size(); ++i) {
+		ASSERT_NEAR(out[i].left, 1000.0f, 0.05f);
+		ASSERT_NEAR(out[i].right, -1000.0f, 0.05f);
+	}
+}
+
+TEST(IntegerUpsampler, KeepsPassbandAndRemovesImages)
+{
+	// A 1 kHz tone at 24 kHz upsampled to 48 kHz leaves an image at
+	// 23 kHz, which the filter must remove
+	constexpr auto InRateHz  = 24000.0;
+	constexpr auto OutRateHz = 48000.0;
+
+	IntegerUpsampler upsampler = {};
+	upsampler.Configure(2, ResampleQuality::Medium);
+
+	const auto in = make_sine(4800, 1000.0, InRateHz);
+	std::vector<AudioFrame> out = {};
+	upsampler.Process(in.data(), in.size(), out);
+
+	// Correlate a settled stretch with the wanted tone and its image
+	const auto power_at = [&](const double freq) {
+		double re = 0.0;
+		double im = 0.0;
+		for (size_t i = 1000; i < 9000; ++i) {
+			const auto phase = 2.0 * std::numbers::pi * freq *
+			                   static_cast<double>(i) / OutRateHz;
+			re += out[i].left * std::cos(phase);
+			im += out[i].left * std::sin(phase);
+		}
+		return std::sqrt(re * re + im * im) / 4000.0;
+	};
+
+	EXPECT_NEAR(power_at(1000.0), 10000.0, 100.0);
+	EXPECT_LT(power_at(23000.0), 10000.0 * 0.001);
+}
+
+} // namespace
@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/port.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+namespace {
+
+// Nothing in the emulated machine listens here
+constexpr io_port_t HandledPort   = 0x1230;
+constexpr io_port_t UnhandledPort = 0x1238;
+
+// A register that reads back what was written, like most device latches
+uint8_t latch = 0;
+
+void register_latch()
+{
+	IO_RegisterReadHandler(
+	        HandledPort,
+	        [](io_port_t, io_width_t) -> uint8_t { return latch; },
+	        io_width_t::byte);
+	IO_RegisterWriteHandler(
+	        HandledPort,
+	        [](io_port_t, io_val_t val, io_width_t) {
+		        latch = static_cast<uint8_t>(val);
+	        },
+	        io_width_t::byte);
+}
+
+void free_latch()
+{
+	IO_FreeReadHandler(HandledPort, io_width_t::byte);
+	IO_FreeWriteHandler(HandledPort, io_width_t::byte);
+}
+
+void BM_IoReadB(benchmark::State& state)
+{
+	register_latch();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(IO_ReadB(HandledPort));
+	}
+	state.SetItemsProcessed(state.iterations());
+	free_latch();
+}
+BENCHMARK(BM_IoReadB);
+
+void BM_IoWriteB(benchmark::State& state)
+{
+	register_latch();
+	uint8_t val = 0;
+	for (auto _ : state) {
+		IO_WriteB(HandledPort, val++);
+	}
+	state.SetItemsProcessed(state.iterations());
+	free_latch();
+}
+BENCHMARK(BM_IoWriteB);
+
+// Word accesses to a byte-wide port are split into two byte accesses
+void BM_IoReadWSplit(benchmark::State& state)
+{
+	register_latch();
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(IO_ReadW(HandledPort));
+	}
+	state.SetItemsProcessed(state.iterations());
+	free_latch();
+}
+BENCHMARK(BM_IoReadWSplit);
+
+// Probes of empty ports, as hardware detection does
+void BM_IoReadBUnhandled(benchmark::State& state)
+{
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(IO_ReadB(UnhandledPort));
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IoReadBUnhandled);
+
+} // namespace
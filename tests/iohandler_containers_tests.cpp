@@ -3,6 +3,7 @@
 
 #include "hardware/iohandler_containers.cpp"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 
@@ -122,6 +123,78 @@ TEST(iohandler_containers, empty_writes)
 	write_byte_to_port(unregistered, 0);
 }
 
+TEST(iohandler_containers, freed_range)
+{
+	// A range crossing a page of the handler tables, in a part of the
+	// port space the other tests don't use
+	constexpr uint16_t first = 0xf0fe;
+	constexpr uint16_t range = 4;
+
+	IO_HandlerTable<io_read_f> table = {};
+	for (uint16_t port = first; port < first + range; ++port) {
+		table.Set(port, read_byte_new);
+	}
+	EXPECT_EQ(table.size(), range);
+	EXPECT_NE(table.Find(first + range - 1), nullptr);
+	EXPECT_EQ(table.Find(first + range), nullptr);
+
+	table.Erase(first);
+	table.Erase(first);
+	EXPECT_EQ(table.size(), range - 1);
+	EXPECT_EQ(table.Find(first), nullptr);
+
+	byte_val_new = 0x12;
+	IO_RegisterReadHandler(first, read_byte_new, io_width_t::byte, range);
+	EXPECT_EQ(read_byte_from_port(first + range - 1), 0x12);
+
+	IO_FreeReadHandler(first, io_width_t::byte, range);
+	EXPECT_EQ(read_byte_from_port(first + range - 1), 0xff);
+}
+
+TEST(iohandler_containers, poll_hint_freed_with_reader)
+{
+	constexpr uint16_t port = 0xf1f0;
+
+	EXPECT_EQ(IO_GetPollHint(port, 0xff), 0.0);
+
+	IO_RegisterReadHandler(port, read_byte_new, io_width_t::byte);
+	IO_RegisterPollHint(port, [](io_port_t, const uint8_t mask) {
+		return mask == 8 ? 12.5 : IO_StableUntilEvent;
+	});
+	EXPECT_EQ(IO_GetPollHint(port, 8), 12.5);
+	EXPECT_EQ(IO_GetPollHint(port, 1), IO_StableUntilEvent);
+
+	IO_FreeReadHandler(port, io_width_t::byte);
+	EXPECT_EQ(IO_GetPollHint(port, 8), 0.0);
+}
+
+TEST(iohandler_containers, block_reader_freed_with_reader)
+{
+	constexpr uint16_t port = 0xf2f0;
+
+	uint8_t buf[8] = {};
+	EXPECT_FALSE(IO_HasBlockReader(port));
+	EXPECT_EQ(read_block_from_port(port, io_width_t::word, buf, 4), 0);
+
+	IO_RegisterReadHandler(port, read_word_new, io_width_t::word);
+	IO_RegisterBlockReader(port,
+	                       [](io_port_t, io_width_t, uint8_t* dst, uint32_t num) {
+		                       const auto num_read = std::min(num, 3u);
+		                       for (uint32_t i = 0; i < num_read * 2; ++i) {
+			                       dst[i] = static_cast<uint8_t>(i + 1);
+		                       }
+		                       return num_read;
+	                       });
+	EXPECT_TRUE(IO_HasBlockReader(port));
+	EXPECT_EQ(read_block_from_port(port, io_width_t::word, buf, 4), 3);
+	EXPECT_EQ(buf[0], 1);
+	EXPECT_EQ(buf[5], 6);
+	EXPECT_EQ(buf[6], 0);
+
+	IO_FreeReadHandler(port, io_width_t::word);
+	EXPECT_FALSE(IO_HasBlockReader(port));
+}
+
 // The following tests are temporarily disabled as they
 // are currently failing on all platforms.
 // Investigations have revealed the test cases rely on 
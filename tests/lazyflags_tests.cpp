@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cpu/lazyflags.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+
+namespace {
+
+// The conditions as the cores tested them before they had fused evaluators
+bool test_with_flag_getters(const FlagCondition condition)
+{
+	const auto sf_is_not_of = (get_SF() != 0) != (get_OF() != 0);
+	switch (condition) {
+	case FlagCondition::O: return get_OF();
+	case FlagCondition::NO: return !get_OF();
+	case FlagCondition::B: return get_CF();
+	case FlagCondition::NB: return !get_CF();
+	case FlagCondition::Z: return get_ZF();
+	case FlagCondition::NZ: return !get_ZF();
+	case FlagCondition::BE: return get_CF() || get_ZF();
+	case FlagCondition::NBE: return !get_CF() && !get_ZF();
+	case FlagCondition::S: return get_SF();
+	case FlagCondition::NS: return !get_SF();
+	case FlagCondition::P: return get_PF();
+	case FlagCondition::NP: return !get_PF();
+	case FlagCondition::L: return sf_is_not_of;
+	case FlagCondition::NL: return !sf_is_not_of;
+	case FlagCondition::LE: return get_ZF() || sf_is_not_of;
+	case FlagCondition::NLE: return !get_ZF() && !sf_is_not_of;
+	}
+	return false;
+}
+
+class LazyFlagsTest : public testing::Test {
+protected:
+	void SetUp() override
+	{
+		saved_flags = reg_flags;
+		saved_lflags = lflags;
+	}
+
+	void TearDown() override
+	{
+		reg_flags = saved_flags;
+		lflags    = saved_lflags;
+	}
+
+	// Random operands and results, with the shift counts kept in range
+	void randomize(const uint_fast8_t type)
+	{
+		lflags.var1.dword[DW_INDEX] = rng();
+		lflags.var2.dword[DW_INDEX] = rng();
+		lflags.res.dword[DW_INDEX]  = rng();
+		lf_var2b     = static_cast<uint8_t>(1 + rng() % 8);
+		lflags.oldcf = rng() & 1;
+		lflags.type  = type;
+		reg_flags    = rng() & FMASK_TEST;
+	}
+
+	std::mt19937 rng{1234};
+
+private:
+	uint32_t saved_flags    = 0;
+	LazyFlags saved_lflags = {};
+};
+
+// The rotates aren't here as they leave the flags in 'reg_flags'
+bool is_rotate(const uint_fast8_t type)
+{
+	return type >= t_ROLb && type <= t_RCRd;
+}
+
+TEST_F(LazyFlagsTest, FusedConditionsMatchTheFlagGetters)
+{
+	for (uint_fast8_t type = t_UNKNOWN; type < t_NOTDONE; ++type) {
+		if (is_rotate(type)) {
+			continue;
+		}
+		for (int i = 0; i < 200; ++i) {
+			randomize(type);
+			for (size_t c = 0; c < NumFlagConditions; ++c) {
+				const auto condition = static_cast<FlagCondition>(c);
+				EXPECT_EQ(TestFlagCondition(condition),
+				          test_with_flag_getters(condition))
+				        << "type " << static_cast<int>(type)
+				        << ", condition " << c;
+			}
+		}
+	}
+}
+
+TEST_F(LazyFlagsTest, ConditionsOfACompare)
+{
+	// cmp ax,bx with ax=1 and bx=2
+	lf_var1w    = 1;
+	lf_var2w    = 2;
+	lf_resw     = static_cast<uint16_t>(lf_var1w - lf_var2w);
+	lflags.type = t_CMPw;
+
+	EXPECT_TRUE(TFLG_B);
+	EXPECT_TRUE(TFLG_BE);
+	EXPECT_TRUE(TFLG_L);
+	EXPECT_TRUE(TFLG_LE);
+	EXPECT_TRUE(TFLG_NZ);
+	EXPECT_TRUE(TFLG_S);
+	EXPECT_FALSE(TFLG_Z);
+	EXPECT_FALSE(TFLG_NBE);
+	EXPECT_FALSE(TFLG_NL);
+	EXPECT_FALSE(TFLG_O);
+}
+
+TEST_F(LazyFlagsTest, FillFlagsMatchesTheFlagGetters)
+{
+	for (const auto type : {t_ADDb, t_ADCw, t_SBBd, t_SUBb, t_CMPw, t_ANDd,
+	                        t_ORb, t_XORw, t_TESTd, t_INCb, t_DECw}) {
+		for (int i = 0; i < 200; ++i) {
+			randomize(static_cast<uint_fast8_t>(type));
+			const auto cf = get_CF() != 0;
+			const auto zf = get_ZF() != 0;
+			const auto sf = get_SF() != 0;
+			const auto pf = get_PF() != 0;
+
+			const auto flags = FillFlags();
+			EXPECT_EQ(lflags.type, t_UNKNOWN);
+			EXPECT_EQ((flags & FLAG_CF) != 0, cf) << "type " << type;
+			EXPECT_EQ((flags & FLAG_ZF) != 0, zf) << "type " << type;
+			EXPECT_EQ((flags & FLAG_SF) != 0, sf) << "type " << type;
+			EXPECT_EQ((flags & FLAG_PF) != 0, pf) << "type " << type;
+		}
+	}
+}
+
+} // namespace
@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/memory.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Extended memory, clear of DOS and the BIOS
+constexpr PhysPt BlockAddress = 2 * 1024 * 1024;
+
+// Sizes of a disk sector, a page, a DMA transfer and a whole segment; the
+// odd offset makes every block straddle a page boundary
+void block_args(benchmark::internal::Benchmark* b)
+{
+	b->ArgsProduct({{512, 4096, 16384, 65536}, {0, 1}});
+}
+
+PhysPt block_address(const benchmark::State& state)
+{
+	return BlockAddress + (state.range(1) ? 4095 : 0);
+}
+
+void BM_MemBlockRead(benchmark::State& state)
+{
+	const auto size = static_cast<size_t>(state.range(0));
+	std::vector<uint8_t> data(size);
+	for (auto _ : state) {
+		MEM_BlockRead(block_address(state), data.data(), size);
+		benchmark::DoNotOptimize(data.data());
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MemBlockRead)->Apply(block_args);
+
+// The byte-at-a-time path MEM_BlockRead replaces, as a baseline
+void BM_MemReadBytes(benchmark::State& state)
+{
+	const auto size    = static_cast<size_t>(state.range(0));
+	const auto address = block_address(state);
+	std::vector<uint8_t> data(size);
+	for (auto _ : state) {
+		for (size_t i = 0; i < size; ++i) {
+			data[i] = mem_readb(address + static_cast<PhysPt>(i));
+		}
+		benchmark::DoNotOptimize(data.data());
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MemReadBytes)->Apply(block_args);
+
+void BM_MemBlockWrite(benchmark::State& state)
+{
+	const auto size = static_cast<size_t>(state.range(0));
+	std::vector<uint8_t> data(size, 0xa5);
+	for (auto _ : state) {
+		MEM_BlockWrite(block_address(state), data.data(), size);
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MemBlockWrite)->Apply(block_args);
+
+} // namespace
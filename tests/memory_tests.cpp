@@ -0,0 +1,188 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/memory.h"
+
+#include "cpu/paging.h"
+
+#include "dosbox_test_fixture.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+class MemoryTest : public DOSBoxTestFixture {};
+
+std::vector<uint8_t> read_bytes(const PhysPt pt, const size_t size)
+{
+	std::vector<uint8_t> bytes(size);
+	for (size_t i = 0; i < size; ++i) {
+		bytes[i] = mem_readb(pt + static_cast<PhysPt>(i));
+	}
+	return bytes;
+}
+
+std::vector<uint8_t> random_bytes(std::mt19937& rng, const size_t size)
+{
+	std::vector<uint8_t> bytes(size);
+	for (auto& byte : bytes) {
+		byte = static_cast<uint8_t>(rng());
+	}
+	return bytes;
+}
+
+struct Span {
+	PhysPt pt   = 0;
+	size_t size = 0;
+};
+
+// Within a page, across several, and from the end of RAM into what's
+// behind it
+std::vector<Span> test_spans()
+{
+	const auto ram_end = MEM_TotalPages() * MemPageSize;
+	return {{0x10010, 100},
+	        {0x10ffd, 3 * MemPageSize + 7},
+	        {0x23000, 2 * MemPageSize},
+	        {ram_end - 100, 300}};
+}
+
+TEST_F(MemoryTest, BlockReadMatchesBytePath)
+{
+	std::mt19937 rng(1234);
+	for (const auto& span : test_spans()) {
+		const auto data = random_bytes(rng, span.size);
+		for (size_t i = 0; i < span.size; ++i) {
+			mem_writeb(span.pt + static_cast<PhysPt>(i), data[i]);
+		}
+
+		std::vector<uint8_t> actual(span.size);
+		MEM_BlockRead(span.pt, actual.data(), span.size);
+		EXPECT_EQ(actual, read_bytes(span.pt, span.size))
+		        << "at " << span.pt << ", " << span.size << " bytes";
+	}
+}
+
+TEST_F(MemoryTest, BlockWriteMatchesBytePath)
+{
+	std::mt19937 rng(5678);
+	for (const auto& span : test_spans()) {
+		const auto data = random_bytes(rng, span.size);
+		MEM_BlockWrite(span.pt, data.data(), span.size);
+		const auto actual = read_bytes(span.pt, span.size);
+
+		for (size_t i = 0; i < span.size; ++i) {
+			mem_writeb(span.pt + static_cast<PhysPt>(i), data[i]);
+		}
+		EXPECT_EQ(actual, read_bytes(span.pt, span.size))
+		        << "at " << span.pt << ", " << span.size << " bytes";
+	}
+}
+
+TEST_F(MemoryTest, MemcpyRepeatsOverlappingSource)
+{
+	std::mt19937 rng(9012);
+	constexpr PhysPt Source = 0x30ff0;
+	constexpr size_t Size   = 2 * MemPageSize;
+
+	for (const PhysPt distance : {1u, 3u, 16u, 5000u}) {
+		const auto data = random_bytes(rng, Size + distance);
+		MEM_BlockWrite(Source, data.data(), data.size());
+
+		// Forwards, a byte at a time
+		auto expected = data;
+		for (size_t i = 0; i < Size; ++i) {
+			expected[i + distance] = expected[i];
+		}
+
+		mem_memcpy(Source + distance, Source, Size);
+		EXPECT_EQ(read_bytes(Source, data.size()), expected)
+		        << "overlapping by " << distance;
+	}
+}
+
+TEST_F(MemoryTest, HostSpansCoverMappedPages)
+{
+	constexpr PhysPt Start = 0x40ff0;
+	constexpr size_t Size  = 2 * MemPageSize;
+
+	const auto host_span = MEM_GetHostWriteSpan(Start, Size);
+	ASSERT_NE(host_span, nullptr);
+	EXPECT_EQ(MEM_GetHostReadSpan(Start, Size), host_span);
+
+	std::mt19937 rng(3456);
+	const auto data = random_bytes(rng, Size);
+	std::copy(data.begin(), data.end(), host_span);
+	EXPECT_EQ(read_bytes(Start, Size), data);
+
+	// Nothing maps what's past the end of RAM straight to host memory
+	const auto ram_end = MEM_TotalPages() * MemPageSize;
+	EXPECT_EQ(MEM_GetHostReadSpan(ram_end - 100, 300), nullptr);
+	EXPECT_EQ(MEM_GetHostWriteSpan(ram_end - 100, 300), nullptr);
+	EXPECT_EQ(MEM_GetHostReadSpan(Start, 0), nullptr);
+}
+
+TEST_F(MemoryTest, AllocatesAndReleasesPages)
+{
+	const auto free_before    = MEM_FreeTotal();
+	const auto largest_before = MEM_FreeLargest();
+	ASSERT_GE(largest_before, 8u);
+
+	auto handle = MEM_AllocatePages(4, true);
+	ASSERT_GT(handle, 0);
+	EXPECT_EQ(MEM_AllocatedPages(handle), 4u);
+	EXPECT_EQ(MEM_FreeTotal(), free_before - 4);
+	for (int page = 0; page < 3; ++page) {
+		EXPECT_EQ(MEM_NextHandleAt(handle, page + 1), handle + page + 1);
+	}
+
+	// Grows in place while the pages behind it are free
+	ASSERT_TRUE(MEM_ReAllocatePages(handle, 6, true));
+	EXPECT_EQ(MEM_NextHandleAt(handle, 5), handle + 5);
+	ASSERT_TRUE(MEM_ReAllocatePages(handle, 2, true));
+	EXPECT_EQ(MEM_FreeTotal(), free_before - 2);
+
+	const auto scattered = MEM_AllocatePages(3, false);
+	ASSERT_GT(scattered, 0);
+	EXPECT_EQ(MEM_AllocatedPages(scattered), 3u);
+
+	MEM_ReleasePages(scattered);
+	MEM_ReleasePages(handle);
+	EXPECT_EQ(MEM_FreeTotal(), free_before);
+	EXPECT_EQ(MEM_FreeLargest(), largest_before);
+}
+
+TEST_F(MemoryTest, FirstWriteToWatchedPageDropsWatches)
+{
+	constexpr PhysPt Watched = 0x50000;
+	constexpr PhysPt Other   = 0x51000;
+	const auto watched_page  = Watched / MemPageSize;
+
+	// A linked page loses its direct write pointer while watched
+	mem_writed(Watched, 1);
+	ASSERT_TRUE(MEM_WatchPageWrites(watched_page));
+	EXPECT_TRUE(MEM_IsPageWatched(watched_page));
+	mem_readd(Watched);
+	EXPECT_EQ(get_tlb_write(Watched), nullptr);
+
+	const auto generation = mem_write_watches.generation;
+	mem_writed(Other, 2);
+	EXPECT_TRUE(MEM_IsPageWatched(watched_page));
+	EXPECT_EQ(mem_write_watches.generation, generation);
+
+	mem_writed(Watched, 3);
+	EXPECT_FALSE(MEM_IsPageWatched(watched_page));
+	EXPECT_EQ(mem_write_watches.generation, generation + 1);
+	EXPECT_EQ(mem_readd(Watched), 3u);
+
+	// Nothing but plain RAM can be watched
+	EXPECT_FALSE(MEM_WatchPageWrites(MEM_TotalPages()));
+	EXPECT_FALSE(MEM_WatchPageWrites(0xa0));
+}
+
+} // namespace
@@ -0,0 +1,139 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "audio/private/mix_kernels.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// Block lengths around the kernels' 2-frame steps
+constexpr std::array<size_t, 8> BlockLengths = {0, 1, 2, 3, 4, 7, 8, 33};
+
+std::vector<AudioFrame> make_frames(const size_t num_frames, uint32_t seed)
+{
+	std::vector<AudioFrame> frames(num_frames);
+	for (auto& frame : frames) {
+		seed        = seed * 1'664'525 + 1'013'904'223;
+		frame.left  = static_cast<float>(static_cast<int32_t>(seed)) / 65536.0f;
+		seed        = seed * 1'664'525 + 1'013'904'223;
+		frame.right = static_cast<float>(static_cast<int32_t>(seed)) / 65536.0f;
+	}
+	return frames;
+}
+
+// Compares the bits, so a kernel that rounds differently is caught
+void expect_identical(const std::vector<AudioFrame>& actual,
+                      const std::vector<AudioFrame>& expected)
+{
+	ASSERT_EQ(actual.size(), expected.size());
+	EXPECT_EQ(std::memcmp(actual.data(),
+	                      expected.data(),
+	                      actual.size() * sizeof(AudioFrame)),
+	          0);
+}
+
+TEST(MixKernels, MixingMatchesTheReference)
+{
+	for (const auto num_frames : BlockLengths) {
+		// Offset by one frame so the loads are unaligned, with a guard
+		// frame past the end
+		const auto src = make_frames(num_frames + 2, 1);
+		auto expected  = make_frames(num_frames + 2, 2);
+		auto actual    = expected;
+
+		mix_frames_scalar(expected.data() + 1, src.data() + 1, num_frames);
+		mix_frames(actual.data() + 1, src.data() + 1, num_frames);
+		expect_identical(actual, expected);
+	}
+}
+
+TEST(MixKernels, ScaledMixingMatchesTheReference)
+{
+	for (const auto gain : {0.0f, 0.125f, 0.7071f, 1.0f, 3.3f}) {
+		for (const auto num_frames : BlockLengths) {
+			const auto src = make_frames(num_frames + 2, 3);
+			auto expected  = make_frames(num_frames + 2, 4);
+			auto actual    = expected;
+
+			mix_scaled_frames_scalar(expected.data() + 1,
+			                         src.data() + 1,
+			                         num_frames,
+			                         gain);
+			mix_scaled_frames(actual.data() + 1, src.data() + 1, num_frames, gain);
+			expect_identical(actual, expected);
+		}
+	}
+}
+
+TEST(MixKernels, ScalingKeepsTheSidesApart)
+{
+	const AudioFrame gain = {0.5f, -2.0f};
+	for (const auto num_frames : BlockLengths) {
+		auto expected = make_frames(num_frames + 2, 5);
+		auto actual   = expected;
+
+		scale_frames_scalar(expected.data() + 1, num_frames, gain);
+		scale_frames(actual.data() + 1, num_frames, gain);
+		expect_identical(actual, expected);
+	}
+
+	std::vector<AudioFrame> frames(3, AudioFrame(4.0f, 4.0f));
+	scale_frames(frames.data(), frames.size(), gain);
+	for (const auto& frame : frames) {
+		EXPECT_EQ(frame, AudioFrame(2.0f, -8.0f));
+	}
+}
+
+TEST(MixKernels, NormalizingByReciprocalIsExact)
+{
+	// The mixer normalizes by multiplying with 1/32768 rather than
+	// dividing, which is only safe as the divisor is a power of two
+	auto frames = make_frames(64, 6);
+	frames.push_back({32767.0f, -32768.0f});
+	frames.push_back({1e-40f, -3.0e38f});
+
+	auto normalized = frames;
+	scale_frames(normalized.data(),
+	             normalized.size(),
+	             AudioFrame(1.0f / 32768.0f, 1.0f / 32768.0f));
+
+	for (size_t i = 0; i < frames.size(); ++i) {
+		EXPECT_EQ(normalized[i].left, frames[i].left / 32768.0f);
+		EXPECT_EQ(normalized[i].right, frames[i].right / 32768.0f);
+	}
+}
+
+TEST(MixKernels, PeakMatchesTheReference)
+{
+	for (const auto num_frames : BlockLengths) {
+		auto frames = make_frames(num_frames, 7);
+		EXPECT_EQ(peak_frames(frames.data(), num_frames),
+		          peak_frames_scalar(frames.data(), num_frames));
+
+		// Put the peak on each side of each frame in turn, negative
+		// so the sign has to be dropped
+		for (size_t i = 0; i < num_frames * 2; ++i) {
+			auto with_peak = frames;
+			auto& sample   = (i % 2 == 0) ? with_peak[i / 2].left
+			                              : with_peak[i / 2].right;
+			sample         = -40000.0f;
+
+			EXPECT_EQ(peak_frames(with_peak.data(), num_frames), 40000.0f);
+		}
+	}
+}
+
+TEST(MixKernels, PeakOfSilenceIsZero)
+{
+	const std::vector<AudioFrame> frames(9, AudioFrame(-0.0f, 0.0f));
+	EXPECT_EQ(peak_frames(frames.data(), frames.size()), 0.0f);
+	EXPECT_EQ(peak_frames(frames.data(), 0), 0.0f);
+}
+
+} // namespace
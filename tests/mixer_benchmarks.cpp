@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "audio/private/mix_kernels.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// The mixer's default block size outside Windows
+constexpr size_t BlockSize = 512;
+
+struct Kernels {
+	void (*mix)(AudioFrame*, const AudioFrame*, size_t);
+	void (*mix_scaled)(AudioFrame*, const AudioFrame*, size_t, float);
+	void (*scale)(AudioFrame*, size_t, AudioFrame);
+};
+
+constexpr Kernels MixKernels = {mix_frames, mix_scaled_frames, scale_frames};
+
+// One frame at a time, like the mixer's old loops
+constexpr Kernels ScalarKernels = {mix_frames_scalar,
+                                   mix_scaled_frames_scalar,
+                                   scale_frames_scalar};
+
+// Accumulates every channel into the master output and the reverb and
+// chorus aux buffers, then applies the master gain and the final
+// normalization, the way the mixer thread does for every block
+void BM_MixMasterBus(benchmark::State& state, const Kernels kernels)
+{
+	std::vector<std::vector<AudioFrame>> channels(
+	        static_cast<size_t>(state.range(0)));
+	uint32_t seed = 1;
+	for (auto& frames : channels) {
+		frames.resize(BlockSize);
+		for (auto& frame : frames) {
+			seed        = seed * 1'664'525 + 1'013'904'223;
+			frame.left  = static_cast<float>(static_cast<int16_t>(seed >> 16));
+			frame.right = static_cast<float>(static_cast<int16_t>(seed));
+		}
+	}
+
+	std::vector<AudioFrame> output(BlockSize);
+	std::vector<AudioFrame> reverb_aux(BlockSize);
+	std::vector<AudioFrame> chorus_aux(BlockSize);
+
+	constexpr AudioFrame MasterGain = {0.5f, 0.5f};
+	constexpr AudioFrame Normalize  = {1.0f / 32768.0f, 1.0f / 32768.0f};
+
+	for (auto _ : state) {
+		output.assign(BlockSize, {});
+		reverb_aux.assign(BlockSize, {});
+		chorus_aux.assign(BlockSize, {});
+
+		for (const auto& frames : channels) {
+			kernels.mix(output.data(), frames.data(), BlockSize);
+			kernels.mix_scaled(reverb_aux.data(), frames.data(), BlockSize, 0.3f);
+			kernels.mix_scaled(chorus_aux.data(), frames.data(), BlockSize, 0.2f);
+		}
+		kernels.mix(output.data(), reverb_aux.data(), BlockSize);
+		kernels.mix(output.data(), chorus_aux.data(), BlockSize);
+		kernels.scale(output.data(), BlockSize, MasterGain);
+		kernels.scale(output.data(), BlockSize, Normalize);
+
+		benchmark::DoNotOptimize(output.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(BlockSize));
+}
+BENCHMARK_CAPTURE(BM_MixMasterBus, kernel, MixKernels)->Arg(8);
+BENCHMARK_CAPTURE(BM_MixMasterBus, reference, ScalarKernels)->Arg(8);
+
+} // namespace
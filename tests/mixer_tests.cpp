@@ -64,4 +64,26 @@ TEST(MixerConfigureFadeOut, OutOfBounds)
 	ASSERT_FALSE(channel.ConfigureFadeOut("3001 10000"));
 }
 
+TEST(MixerWakeUp, WakesSleepingChannel)
+{
+	MixerChannel channel(callback, ChannelName, {ChannelFeature::Sleep});
+	ASSERT_FALSE(channel.is_enabled);
+
+	EXPECT_TRUE(channel.WakeUp());
+	EXPECT_TRUE(channel.is_enabled);
+}
+
+TEST(MixerWakeUp, AwakeChannelOnlyTakesRequest)
+{
+	MixerChannel channel(callback, ChannelName, {ChannelFeature::Sleep});
+	channel.Enable(true);
+
+	EXPECT_FALSE(channel.WakeUp());
+	EXPECT_TRUE(channel.is_enabled);
+
+	// The mixer thread applies the request once
+	EXPECT_TRUE(channel.sleeper.TakeWakeUpRequest());
+	EXPECT_FALSE(channel.sleeper.TakeWakeUpRequest());
+}
+
 } // namespace
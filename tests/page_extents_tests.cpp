@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/page_extents.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t FirstPage = 0x110;
+constexpr uint32_t EndPage   = 0x200;
+
+TEST(FreePageExtents, StartsAsOneRun)
+{
+	FreePageExtents extents;
+	extents.Reset(FirstPage, EndPage);
+
+	EXPECT_EQ(extents.Total(), EndPage - FirstPage);
+	EXPECT_EQ(extents.Largest(), EndPage - FirstPage);
+	EXPECT_EQ(extents.RunAt(FirstPage), EndPage - FirstPage);
+	EXPECT_EQ(extents.BestFit(1), FirstPage);
+	EXPECT_EQ(extents.BestFit(EndPage - FirstPage + 1), 0u);
+
+	extents.Reset(EndPage, FirstPage);
+	EXPECT_EQ(extents.Total(), 0u);
+	EXPECT_EQ(extents.BestFit(1), 0u);
+}
+
+TEST(FreePageExtents, FitsTheSmallestRunFirst)
+{
+	FreePageExtents extents;
+	extents.Reset(FirstPage, EndPage);
+
+	// Free runs of 4, 2, 2, and the rest
+	extents.Allocate(FirstPage + 4, 1);
+	extents.Allocate(FirstPage + 7, 1);
+	extents.Allocate(FirstPage + 10, 1);
+
+	EXPECT_EQ(extents.BestFit(2), FirstPage + 5);
+	EXPECT_EQ(extents.BestFit(3), FirstPage);
+	EXPECT_EQ(extents.BestFit(5), FirstPage + 11);
+	EXPECT_EQ(extents.Largest(), EndPage - FirstPage - 11);
+	EXPECT_EQ(extents.Total(), EndPage - FirstPage - 3);
+}
+
+TEST(FreePageExtents, JoinsFreedPages)
+{
+	FreePageExtents extents;
+	extents.Reset(FirstPage, EndPage);
+	extents.Allocate(FirstPage, 10);
+
+	extents.Free(FirstPage + 3);
+	EXPECT_EQ(extents.RunAt(FirstPage + 3), 1u);
+	extents.Free(FirstPage + 5, 5);
+	EXPECT_EQ(extents.RunAt(FirstPage + 5), EndPage - FirstPage - 5);
+	extents.Free(FirstPage + 4);
+	EXPECT_EQ(extents.RunAt(FirstPage + 3), EndPage - FirstPage - 3);
+	EXPECT_EQ(extents.RunAt(FirstPage + 5), 0u);
+
+	extents.Free(FirstPage, 3);
+	EXPECT_EQ(extents.RunAt(FirstPage), EndPage - FirstPage);
+	EXPECT_EQ(extents.Total(), EndPage - FirstPage);
+}
+
+// Checks the index against a plain table of which pages are in use
+TEST(FreePageExtents, MatchesALinearScan)
+{
+	std::vector<bool> in_use(EndPage, false);
+
+	auto scan_best_fit = [&](const uint32_t size) {
+		uint32_t best      = 0;
+		uint32_t best_size = 0;
+		uint32_t page      = FirstPage;
+		while (page < EndPage) {
+			if (in_use[page]) {
+				++page;
+				continue;
+			}
+			const auto first = page;
+			while (page < EndPage && !in_use[page]) {
+				++page;
+			}
+			const auto run = page - first;
+			if (run >= size && (!best || run < best_size)) {
+				best      = first;
+				best_size = run;
+			}
+		}
+		return best;
+	};
+
+	FreePageExtents extents;
+	extents.Reset(FirstPage, EndPage);
+
+	std::mt19937 rng(42);
+	for (int i = 0; i < 2000; ++i) {
+		const auto size = static_cast<uint32_t>(rng() % 8 + 1);
+		if (rng() % 2) {
+			const auto start = extents.BestFit(size);
+			ASSERT_EQ(start, scan_best_fit(size));
+			if (start) {
+				extents.Allocate(start, size);
+				for (uint32_t page = start; page < start + size; ++page) {
+					in_use[page] = true;
+				}
+			}
+		} else {
+			const auto offset = rng() % (EndPage - FirstPage);
+			const auto page   = FirstPage + static_cast<uint32_t>(offset);
+			if (in_use[page]) {
+				extents.Free(page);
+				in_use[page] = false;
+			}
+		}
+	}
+
+	uint32_t num_free = 0;
+	for (auto page = FirstPage; page < EndPage; ++page) {
+		num_free += in_use[page] ? 0 : 1;
+	}
+	EXPECT_EQ(extents.Total(), num_free);
+}
+
+} // namespace
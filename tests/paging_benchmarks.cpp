@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "cpu/paging.h"
+
+#include "hardware/memory.h"
+#include "misc/health_counters.h"
+#include "misc/perf_counters.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <string_view>
+
+namespace {
+
+constexpr int NumAddressSpaces = 16;
+constexpr int PagesPerTable    = 1024;
+
+// Page directories and tables go above the first megabyte, and the
+// mapped pages come out of the 256 pages after that
+constexpr PhysPt DirectoriesBase   = 0x200000;
+constexpr PhysPt TablesBase        = 0x280000;
+constexpr uint32_t FirstMappedPage = 0x100;
+constexpr uint32_t NumMappedPages  = 256;
+
+// Present, writable and user accessible
+constexpr uint32_t EntryFlags = 0x7;
+
+// The linear range the working set lives in, one page table's worth
+constexpr PhysPt WorkingSetBase = 0x40000000;
+
+// Pages touched after every invalidation
+constexpr int WorkingSetPages = 64;
+
+PhysPt directory_address(const int space)
+{
+	return DirectoriesBase + static_cast<PhysPt>(space) * MemPageSize;
+}
+
+// Every address space maps the working set range with its own page
+// table, each onto a different rotation of the mapped pages
+void build_address_spaces()
+{
+	const auto directory_index = WorkingSetBase >> 22;
+
+	for (int space = 0; space < NumAddressSpaces; ++space) {
+		const auto directory = directory_address(space);
+		const auto table = TablesBase + static_cast<PhysPt>(space) * MemPageSize;
+
+		for (uint32_t i = 0; i < PagesPerTable; ++i) {
+			phys_writed(directory + i * 4, 0);
+		}
+		phys_writed(directory + directory_index * 4, table | EntryFlags);
+
+		for (uint32_t i = 0; i < PagesPerTable; ++i) {
+			const auto page = FirstMappedPage +
+			                  (i + static_cast<uint32_t>(space) * 37) % NumMappedPages;
+			phys_writed(table + i * 4, (page << 12) | EntryFlags);
+		}
+	}
+}
+
+void touch_pages()
+{
+	for (int i = 0; i < WorkingSetPages; ++i) {
+		mem_readd(WorkingSetBase + static_cast<PhysPt>(i) * MemPageSize);
+	}
+}
+
+// The paging unit keeps its flush counters to itself
+int64_t perf_value(const std::string_view name)
+{
+	for (const auto& sample : PERF_Sample()) {
+		if (sample.name == name) {
+			return sample.value;
+		}
+	}
+	return 0;
+}
+
+// What paging-heavy guests do to the TLB: each round invalidates some or
+// all of it and then touches the working set again
+template <typename Invalidate>
+void run_rounds(benchmark::State& state, Invalidate invalidate)
+{
+	build_address_spaces();
+	PAGING_SetDirBase(directory_address(0));
+	PAGING_Enable(true);
+	touch_pages();
+
+	const auto misses_before  = health_counters.tlb_misses.Value();
+	const auto flushes_before = perf_value("tlb_flushes");
+
+	int round = 0;
+	for (auto _ : state) {
+		invalidate(round++);
+		touch_pages();
+	}
+
+	const auto misses  = health_counters.tlb_misses.Value() - misses_before;
+	const auto flushes = perf_value("tlb_flushes") - flushes_before;
+
+	state.SetItemsProcessed(state.iterations() * WorkingSetPages);
+	state.counters["misses"] = benchmark::Counter(static_cast<double>(misses),
+	                                              benchmark::Counter::kAvgIterations);
+	state.counters["flushes"] = benchmark::Counter(static_cast<double>(flushes),
+	                                               benchmark::Counter::kAvgIterations);
+
+	PAGING_Enable(false);
+}
+
+// A task switch: every round runs in the next address space
+void BM_PagingCr3Reload(benchmark::State& state)
+{
+	run_rounds(state, [](const int round) {
+		PAGING_SetDirBase(directory_address((round + 1) % NumAddressSpaces));
+	});
+}
+BENCHMARK(BM_PagingCr3Reload);
+
+// Page table updates in one address space, invalidated page by page as an
+// OS would
+void BM_PagingInvalidatePage(benchmark::State& state)
+{
+	run_rounds(state, [](const int round) {
+		for (int i = 0; i < 4; ++i) {
+			const auto page = (round * 4 + i) % WorkingSetPages;
+			PAGING_InvalidatePage(WorkingSetBase +
+			                      static_cast<PhysPt>(page) * MemPageSize);
+		}
+	});
+}
+BENCHMARK(BM_PagingInvalidatePage);
+
+// The same with the whole TLB flushed instead
+void BM_PagingClearTlb(benchmark::State& state)
+{
+	run_rounds(state, [](const int) { PAGING_ClearTLB(); });
+}
+BENCHMARK(BM_PagingClearTlb);
+
+} // namespace
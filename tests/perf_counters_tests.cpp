@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/perf_counters.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::optional<PerfSample> find_sample(const std::string& name)
+{
+	for (const auto& sample : PERF_Sample()) {
+		if (sample.name == name) {
+			return sample;
+		}
+	}
+	return {};
+}
+
+TEST(PerfCounters, RegistersForItsLifetime)
+{
+	{
+		PerfCounter counter("test_lifetime", "Counted in a test.");
+		counter.Add();
+		counter.Add(4);
+
+		const auto sample = find_sample("test_lifetime");
+		ASSERT_TRUE(sample);
+		EXPECT_EQ(sample->help, "Counted in a test.");
+		EXPECT_EQ(sample->kind, PerfKind::Counter);
+		EXPECT_EQ(sample->value, 5);
+	}
+	EXPECT_FALSE(find_sample("test_lifetime"));
+}
+
+TEST(PerfCounters, GaugesHoldTheLastValue)
+{
+	PerfGauge gauge("test_gauge", "Set in a test.");
+	gauge.Set(10);
+	gauge.Set(-3);
+
+	const auto sample = find_sample("test_gauge");
+	ASSERT_TRUE(sample);
+	EXPECT_EQ(sample->kind, PerfKind::Gauge);
+	EXPECT_EQ(sample->value, -3);
+}
+
+TEST(PerfCounters, SamplesAreSortedByName)
+{
+	PerfCounter second("test_sort_b", "Second.");
+	PerfCounter first("test_sort_a", "First.");
+
+	const auto samples = PERF_Sample();
+	EXPECT_TRUE(std::is_sorted(samples.begin(),
+	                           samples.end(),
+	                           [](const auto& a, const auto& b) {
+		                           return a.name < b.name;
+	                           }));
+}
+
+TEST(PerfCounters, SumsIncrementsFromEveryThread)
+{
+	constexpr int Threads    = 12;
+	constexpr int Increments = 10000;
+
+	PerfCounter counter("test_threads", "Counted from many threads.");
+
+	std::vector<std::thread> threads = {};
+	for (int i = 0; i < Threads; ++i) {
+		threads.emplace_back([&counter] {
+			for (int j = 0; j < Increments; ++j) {
+				counter.Add();
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	EXPECT_EQ(counter.Value(), static_cast<uint64_t>(Threads * Increments));
+}
+
+} // namespace
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/pic.h"
+
+#include "cpu/cpu.h"
+#include "hardware/timer.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+int64_t events_serviced = 0;
+
+// Delays between a tenth of a millisecond and two milliseconds, spread so
+// that events interleave rather than run in the order they were added
+double next_delay(const uint32_t val)
+{
+	static uint32_t seed = 1;
+	seed = seed * 1'664'525 + 1'013'904'223 + val;
+	return 0.1 + static_cast<double>(seed >> 8 & 0xfff) * (1.9 / 4096.0);
+}
+
+// Reschedules itself like the device timers do
+void periodic_event(const uint32_t val)
+{
+	++events_serviced;
+	PIC_AddEvent(periodic_event, next_delay(val), val);
+}
+
+// Reschedules itself in place with PIC_RepeatEvent
+void repeating_event(const uint32_t val)
+{
+	++events_serviced;
+	PIC_RepeatEvent(next_delay(val));
+}
+
+void idle_event(const uint32_t) {}
+
+// An emulated millisecond with the CPU doing nothing but running events
+void run_tick()
+{
+	TIMER_AddTick();
+	do {
+		CPU_Cycles = 0;
+	} while (PIC_RunQueue());
+}
+
+// Keeps the given number of events pending through emulated milliseconds,
+// each rescheduling itself a short, varying delay after it runs
+void BM_PicRunQueue(benchmark::State& state, const PIC_EventHandler handler)
+{
+	for (uint32_t val = 0; val < static_cast<uint32_t>(state.range(0)); ++val) {
+		PIC_AddEvent(handler, next_delay(val), val);
+	}
+	run_tick();
+
+	events_serviced = 0;
+	for (auto _ : state) {
+		run_tick();
+	}
+	state.SetItemsProcessed(events_serviced);
+
+	PIC_RemoveEvents(handler);
+}
+BENCHMARK_CAPTURE(BM_PicRunQueue, periodic, periodic_event)->Arg(16)->Arg(256);
+BENCHMARK_CAPTURE(BM_PicRunQueue, repeating, repeating_event)->Arg(16)->Arg(256);
+
+// Schedules a batch of events and cancels them by the ids PIC_AddEvent
+// returns, before any of them is due
+void BM_PicAddCancel(benchmark::State& state)
+{
+	std::vector<PIC_EventId> ids(static_cast<size_t>(state.range(0)));
+	for (auto _ : state) {
+		for (uint32_t val = 0; val < ids.size(); ++val) {
+			ids[val] = PIC_AddEvent(idle_event, next_delay(val) + 10.0, val);
+		}
+		for (const auto id : ids) {
+			PIC_CancelEvent(id);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PicAddCancel)->Arg(16)->Arg(256);
+
+// The same, but taken out by handler and value as most devices do
+void BM_PicAddRemove(benchmark::State& state)
+{
+	const auto num_events = static_cast<uint32_t>(state.range(0));
+	for (auto _ : state) {
+		for (uint32_t val = 0; val < num_events; ++val) {
+			PIC_AddEvent(idle_event, next_delay(val) + 10.0, val);
+		}
+		for (uint32_t val = 0; val < num_events; ++val) {
+			PIC_RemoveSpecificEvents(idle_event, val);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PicAddRemove)->Arg(16)->Arg(256);
+
+} // namespace
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/profiler.h"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+TEST(SampleHistogram, FoldsMostSampledFirst)
+{
+	SampleHistogram histogram = {};
+	histogram.Add("normal;GAME;CS=1000;1000:00000010");
+	histogram.Add("normal;DOS;CS=0070;0070:00000100");
+	histogram.Add("normal;GAME;CS=1000;1000:00000010");
+	histogram.Add("normal;BIOS;CS=F000;F000:0000E000");
+	histogram.Add("normal;GAME;CS=1000;1000:00000010");
+	histogram.Add("normal;DOS;CS=0070;0070:00000100");
+
+	EXPECT_EQ(histogram.NumSamples(), 6u);
+	EXPECT_EQ(histogram.ToFolded(),
+	          "normal;GAME;CS=1000;1000:00000010 3\n"
+	          "normal;DOS;CS=0070;0070:00000100 2\n"
+	          "normal;BIOS;CS=F000;F000:0000E000 1\n");
+}
+
+TEST(SampleHistogram, TiesAreOrderedByStack)
+{
+	SampleHistogram histogram = {};
+	histogram.Add("b");
+	histogram.Add("c");
+	histogram.Add("a");
+
+	EXPECT_EQ(histogram.ToFolded(), "a 1\nb 1\nc 1\n");
+}
+
+TEST(SampleHistogram, Clear)
+{
+	SampleHistogram histogram = {};
+	histogram.Add("a");
+	histogram.Clear();
+
+	EXPECT_EQ(histogram.NumSamples(), 0u);
+	EXPECT_EQ(histogram.ToFolded(), "");
+}
+
+} // namespace
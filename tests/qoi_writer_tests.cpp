@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "capture/image/qoi_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t Width  = 320;
+constexpr uint16_t Height = 200;
+
+using Bytes = std::vector<uint8_t>;
+
+// A minimal decoder following the specification, independent of the
+// encoder's implementation
+Bytes decode_qoi(const Bytes& file, uint32_t& width, uint32_t& height)
+{
+	auto read_u32_be = [&](const size_t pos) {
+		return static_cast<uint32_t>(file[pos] << 24 | file[pos + 1] << 16 |
+		                             file[pos + 2] << 8 | file[pos + 3]);
+	};
+	width  = read_u32_be(4);
+	height = read_u32_be(8);
+
+	Bytes pixels = {};
+
+	uint8_t r = 0, g = 0, b = 0;
+	uint8_t seen[64][3] = {};
+
+	constexpr size_t HeaderSize = 14;
+	constexpr size_t EndSize    = 8;
+
+	size_t pos = HeaderSize;
+	while (pixels.size() < size_t{width} * height * 3 &&
+	       pos < file.size() - EndSize) {
+		const uint8_t tag = file[pos++];
+		int run           = 1;
+
+		if (tag == 0xfe) {
+			r = file[pos++];
+			g = file[pos++];
+			b = file[pos++];
+		} else if ((tag & 0xc0) == 0x00) {
+			r = seen[tag][0];
+			g = seen[tag][1];
+			b = seen[tag][2];
+		} else if ((tag & 0xc0) == 0x40) {
+			r = static_cast<uint8_t>(r + ((tag >> 4) & 3) - 2);
+			g = static_cast<uint8_t>(g + ((tag >> 2) & 3) - 2);
+			b = static_cast<uint8_t>(b + (tag & 3) - 2);
+		} else if ((tag & 0xc0) == 0x80) {
+			const int dg       = (tag & 0x3f) - 32;
+			const uint8_t next = file[pos++];
+			r = static_cast<uint8_t>(r + dg + (next >> 4) - 8);
+			g = static_cast<uint8_t>(g + dg);
+			b = static_cast<uint8_t>(b + dg + (next & 0x0f) - 8);
+		} else {
+			run = (tag & 0x3f) + 1;
+		}
+
+		const auto hash = (r * 3 + g * 5 + b * 7 + 255 * 11) % 64;
+		seen[hash][0]   = r;
+		seen[hash][1]   = g;
+		seen[hash][2]   = b;
+
+		while (run--) {
+			pixels.insert(pixels.end(), {r, g, b});
+		}
+	}
+	return pixels;
+}
+
+Bytes read_file(FILE* fp)
+{
+	Bytes contents(static_cast<size_t>(ftell(fp)));
+	rewind(fp);
+	EXPECT_EQ(fread(contents.data(), 1, contents.size(), fp), contents.size());
+	return contents;
+}
+
+// Flat areas, gradients, and noise, so every chunk type is used
+Bytes make_rgb_image()
+{
+	Bytes image   = {};
+	uint32_t seed = 1;
+	for (auto y = 0; y < Height; ++y) {
+		for (auto x = 0; x < Width; ++x) {
+			if (y < 50) {
+				image.insert(image.end(), {0x00, 0x00, 0xaa});
+			} else if (y < 100) {
+				image.insert(image.end(),
+				             {static_cast<uint8_t>(x),
+				              static_cast<uint8_t>(x + y / 4),
+				              static_cast<uint8_t>(y)});
+			} else if (y < 150) {
+				const uint8_t c = (x / 8 % 2) ? 0xff : 0x55;
+				image.insert(image.end(), {c, c, 0x55});
+			} else {
+				seed = seed * 1'664'525 + 1'013'904'223;
+				image.insert(image.end(),
+				             {static_cast<uint8_t>(seed >> 24),
+				              static_cast<uint8_t>(seed >> 16),
+				              static_cast<uint8_t>(seed >> 8)});
+			}
+		}
+	}
+	return image;
+}
+
+Bytes write_image(const Bytes& image, const uint8_t* palette_data = nullptr)
+{
+	std::unique_ptr<FILE, decltype(&fclose)> fp(tmpfile(), fclose);
+	EXPECT_TRUE(fp);
+
+	{
+		QoiWriter writer = {};
+
+		const auto row_size = palette_data ? Width : Width * 3;
+		if (palette_data) {
+			EXPECT_TRUE(writer.InitIndexed8(
+			        fp.get(), Width, Height, {}, {}, palette_data));
+		} else {
+			EXPECT_TRUE(writer.InitRgb888(fp.get(), Width, Height, {}, {}));
+		}
+		for (auto y = 0; y < Height; ++y) {
+			writer.WriteRow(image.begin() + y * row_size);
+		}
+	}
+	return read_file(fp.get());
+}
+
+TEST(QoiWriter, WritesTheHeaderAndEndMarker)
+{
+	const auto file = write_image(make_rgb_image());
+
+	ASSERT_GT(file.size(), 22);
+
+	const Bytes header(file.begin(), file.begin() + 14);
+	const Bytes expected_header = {
+	        'q', 'o', 'i', 'f', 0, 0, 0x01, 0x40, 0, 0, 0, 0xc8, 3, 0};
+	EXPECT_EQ(header, expected_header);
+
+	const Bytes end(file.end() - 8, file.end());
+	const Bytes expected_end = {0, 0, 0, 0, 0, 0, 0, 1};
+	EXPECT_EQ(end, expected_end);
+}
+
+TEST(QoiWriter, RgbImagesRoundTrip)
+{
+	const auto image = make_rgb_image();
+	const auto file  = write_image(image);
+
+	uint32_t width = 0, height = 0;
+	EXPECT_EQ(decode_qoi(file, width, height), image);
+	EXPECT_EQ(width, Width);
+	EXPECT_EQ(height, Height);
+
+	// The flat and repeating areas compress well
+	EXPECT_LT(file.size(), image.size() * 2 / 3);
+}
+
+TEST(QoiWriter, PalettedImagesAreExpandedToRgb)
+{
+	uint8_t palette[256 * 4] = {};
+	for (auto i = 0; i < 256; ++i) {
+		palette[i * 4 + 0] = static_cast<uint8_t>(i);
+		palette[i * 4 + 1] = static_cast<uint8_t>(255 - i);
+		palette[i * 4 + 2] = static_cast<uint8_t>(i * 7);
+	}
+
+	Bytes indexed  = {};
+	Bytes expected = {};
+	for (auto y = 0; y < Height; ++y) {
+		for (auto x = 0; x < Width; ++x) {
+			const auto index = static_cast<uint8_t>((x / 3) ^ y);
+			indexed.push_back(index);
+			expected.insert(expected.end(),
+			                {palette[index * 4 + 0],
+			                 palette[index * 4 + 1],
+			                 palette[index * 4 + 2]});
+		}
+	}
+
+	uint32_t width = 0, height = 0;
+	EXPECT_EQ(decode_qoi(write_image(indexed, palette), width, height),
+	          expected);
+}
+
+} // namespace
@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/video/reelmagic/mpeg_kernels.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<uint8_t> random_bytes(std::mt19937& rng, const size_t num_bytes)
+{
+	std::vector<uint8_t> bytes(num_bytes);
+	for (auto& byte : bytes) {
+		byte = static_cast<uint8_t>(rng());
+	}
+	return bytes;
+}
+
+TEST(ReelMagicKernels, BlockOutputMatchesReference)
+{
+	std::mt19937 rng(1234);
+
+	constexpr int Width = 24;
+	const auto initial  = random_bytes(rng, Width * 10);
+
+	// Residuals in and well beyond the byte range, past 16 bits too
+	for (const auto range : {64, 512, 100000}) {
+		std::array<int, 64> block = {};
+		for (auto& coefficient : block) {
+			const auto value = static_cast<int>(rng() % (range * 2));
+			coefficient      = value - range;
+		}
+
+		auto expected = initial;
+		auto actual   = initial;
+		put_block_scalar(expected.data() + Width + 3, Width, block.data());
+		put_block(actual.data() + Width + 3, Width, block.data());
+		EXPECT_EQ(actual, expected) << "put within " << range;
+
+		add_block_scalar(expected.data() + Width + 3, Width, block.data());
+		add_block(actual.data() + Width + 3, Width, block.data());
+		EXPECT_EQ(actual, expected) << "add within " << range;
+	}
+}
+
+TEST(ReelMagicKernels, PredictionMatchesReference)
+{
+	std::mt19937 rng(5678);
+
+	constexpr int Width = 64;
+	const auto src      = random_bytes(rng, Width * 20);
+	const auto initial  = random_bytes(rng, Width * 20);
+
+	for (const auto block_size : {8, 16}) {
+		for (int mode = 0; mode < 8; ++mode) {
+			const auto odd_h       = (mode & 1) != 0;
+			const auto odd_v       = (mode & 2) != 0;
+			const auto interpolate = (mode & 4) != 0;
+
+			// Unaligned, and leaving the neighbors alone
+			auto expected = initial;
+			auto actual   = initial;
+			predict_block_scalar(expected.data() + Width + 3,
+			                     src.data() + 5,
+			                     Width,
+			                     block_size,
+			                     odd_h,
+			                     odd_v,
+			                     interpolate);
+			predict_block(actual.data() + Width + 3,
+			              src.data() + 5,
+			              Width,
+			              block_size,
+			              odd_h,
+			              odd_v,
+			              interpolate);
+			EXPECT_EQ(actual, expected)
+			        << "block size " << block_size << ", mode " << mode;
+		}
+	}
+}
+
+TEST(ReelMagicKernels, ColorConversionMatchesReference)
+{
+	std::mt19937 rng(9012);
+
+	// Widths around the kernel's 16-pixel step
+	for (const auto width : {2, 14, 16, 18, 32, 46, 320}) {
+		constexpr int Height = 6;
+		const auto luma_width   = width + 4;
+		const auto chroma_width = luma_width / 2;
+
+		const auto y  = random_bytes(rng, luma_width * Height);
+		const auto cb = random_bytes(rng, chroma_width * Height / 2);
+		auto cr       = random_bytes(rng, chroma_width * Height / 2);
+
+		// The extremes of chroma, which saturate every channel
+		cr[0] = 0;
+		cr[1] = 255;
+
+		const YCbCrPicture picture = {y.data(),
+		                              cb.data(),
+		                              cr.data(),
+		                              luma_width,
+		                              chroma_width,
+		                              width,
+		                              Height};
+
+		const auto stride = width * 4 + 8;
+		std::vector<uint8_t> expected(stride * Height, 0xcc);
+		std::vector<uint8_t> actual(stride * Height, 0xcc);
+		ycbcr_to_bgrx_scalar(picture, expected.data(), stride);
+		ycbcr_to_bgrx(picture, actual.data(), stride);
+		EXPECT_EQ(actual, expected) << "width " << width;
+	}
+}
+
+TEST(ReelMagicKernels, ColorConversionOfKnownColors)
+{
+	// Black, white and pure red in studio range
+	const std::array<uint8_t, 16> y = {16, 16, 235, 235, 81, 81, 0, 0,
+	                                   16, 16, 235, 235, 81, 81, 0, 0};
+	const std::array<uint8_t, 4> cb = {128, 128, 90, 0};
+	const std::array<uint8_t, 4> cr = {128, 128, 240, 0};
+
+	const YCbCrPicture picture = {y.data(), cb.data(), cr.data(), 8, 4, 8, 2};
+
+	std::array<uint8_t, 8 * 2 * 4> pixels = {};
+	ycbcr_to_bgrx_scalar(picture, pixels.data(), 8 * 4);
+
+	const auto pixel = [&](const int x) {
+		const auto p = pixels.data() + x * 4;
+		return std::array<uint8_t, 4>{p[0], p[1], p[2], p[3]};
+	};
+	EXPECT_EQ(pixel(0), (std::array<uint8_t, 4>{0, 0, 0, 0}));
+
+	// The fixed-point factors land a shade short of full white
+	EXPECT_EQ(pixel(2), (std::array<uint8_t, 4>{254, 254, 254, 0}));
+
+	const auto red = pixel(4);
+	EXPECT_LT(red[0], 8);
+	EXPECT_LT(red[1], 8);
+	EXPECT_GT(red[2], 248);
+	EXPECT_EQ(red[3], 0);
+}
+
+TEST(ReelMagicKernels, OverlayMatchesReference)
+{
+	std::mt19937 rng(3456);
+
+	for (const size_t num_pixels : {0, 1, 3, 4, 5, 8, 31, 640}) {
+		auto vga        = random_bytes(rng, num_pixels * 4 + 1);
+		const auto mpeg = random_bytes(rng, num_pixels * 4 + 1);
+
+		// Every other VGA pixel black, some with their X byte set
+		for (size_t i = 0; i < num_pixels; i += 2) {
+			vga[1 + i * 4 + 0] = 0;
+			vga[1 + i * 4 + 1] = 0;
+			vga[1 + i * 4 + 2] = 0;
+		}
+
+		std::vector<uint8_t> expected(num_pixels * 4 + 2, 0xcc);
+		std::vector<uint8_t> actual(num_pixels * 4 + 2, 0xcc);
+		const auto v = vga.data() + 1;
+		const auto m = mpeg.data() + 1;
+
+		overlay_bgrx_scalar(expected.data() + 1, v, m, num_pixels);
+		overlay_bgrx(actual.data() + 1, v, m, num_pixels);
+		EXPECT_EQ(actual, expected) << "run of " << num_pixels;
+
+		copy_bgrx_scalar(expected.data() + 1, m, num_pixels);
+		copy_bgrx(actual.data() + 1, m, num_pixels);
+		EXPECT_EQ(actual, expected) << "copy of " << num_pixels;
+	}
+}
+
+} // namespace
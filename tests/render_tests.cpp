@@ -0,0 +1,95 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gui/render.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+constexpr uint16_t Width  = 16;
+constexpr uint16_t Height = 4;
+
+RenderedImage make_image(std::vector<uint8_t>& pixels, std::vector<uint8_t>& palette)
+{
+	pixels.resize(Width * Height);
+	std::iota(pixels.begin(), pixels.end(), uint8_t{0});
+
+	palette.resize(256 * 4);
+	std::iota(palette.begin(), palette.end(), uint8_t{7});
+
+	RenderedImage image             = {};
+	image.params.width              = Width;
+	image.params.height             = Height;
+	image.params.pixel_format       = PixelFormat::Indexed8;
+	image.params.pixel_aspect_ratio = {1};
+
+	image.pitch        = Width;
+	image.image_data   = pixels.data();
+	image.palette_data = palette.data();
+	return image;
+}
+
+TEST(RenderSharedImage, CopiesPixelsAndPalette)
+{
+	std::vector<uint8_t> pixels  = {};
+	std::vector<uint8_t> palette = {};
+	const auto image             = make_image(pixels, palette);
+
+	const auto shared = RENDER_ShareImage(image);
+	ASSERT_TRUE(shared);
+	EXPECT_NE(shared->image_data, image.image_data);
+	EXPECT_NE(shared->palette_data, image.palette_data);
+
+	// The renderer overwrites its buffers with the next frame
+	pixels.assign(pixels.size(), 0xff);
+	palette.assign(palette.size(), 0xff);
+
+	for (size_t i = 0; i < Width * Height; ++i) {
+		EXPECT_EQ(shared->image_data[i], static_cast<uint8_t>(i));
+	}
+	for (size_t i = 0; i < 256 * 4; ++i) {
+		EXPECT_EQ(shared->palette_data[i], static_cast<uint8_t>(i + 7));
+	}
+	EXPECT_EQ(shared->params.width, Width);
+	EXPECT_EQ(shared->pitch, Width);
+}
+
+TEST(RenderSharedImage, RecyclesReleasedBuffers)
+{
+	std::vector<uint8_t> pixels  = {};
+	std::vector<uint8_t> palette = {};
+	const auto image             = make_image(pixels, palette);
+
+	auto first                 = RENDER_ShareImage(image);
+	const auto first_pixels_pt = first->image_data;
+
+	// Every holder shares the one copy
+	auto second_holder = first;
+	first.reset();
+	EXPECT_EQ(second_holder->image_data, first_pixels_pt);
+
+	// Only the last holder letting go returns the buffer
+	second_holder.reset();
+	const auto next = RENDER_ShareImage(image);
+	EXPECT_EQ(next->image_data, first_pixels_pt);
+}
+
+TEST(RenderSharedImage, SharesImagesWithoutPalette)
+{
+	std::vector<uint8_t> pixels  = {};
+	std::vector<uint8_t> palette = {};
+	auto image                   = make_image(pixels, palette);
+	image.palette_data           = nullptr;
+
+	const auto shared = RENDER_ShareImage(image);
+	EXPECT_EQ(shared->palette_data, nullptr);
+	EXPECT_EQ(shared->image_data[Width * Height - 1],
+	          static_cast<uint8_t>(Width * Height - 1));
+}
+
+} // namespace
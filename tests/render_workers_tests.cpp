@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "audio/private/render_workers.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int NumThreads = 3;
+
+TEST(RenderWorkers, RendersEveryItemOnce)
+{
+	RenderWorkers workers(NumThreads, "test:render");
+
+	for (const size_t num_items : {0u, 1u, 15u, 16u, 17u, 100u}) {
+		std::vector<std::atomic<int>> renders(num_items);
+		int own_work_runs = 0;
+
+		workers.Run(
+		        num_items,
+		        [&](const size_t item) { renders[item].fetch_add(1); },
+		        [&] { ++own_work_runs; });
+
+		EXPECT_EQ(own_work_runs, 1);
+		for (size_t i = 0; i < num_items; ++i) {
+			EXPECT_EQ(renders[i].load(), 1) << "item " << i << " of " << num_items;
+		}
+	}
+}
+
+TEST(RenderWorkers, HandsOffBatchAfterBatch)
+{
+	RenderWorkers workers(NumThreads, "test:render");
+
+	constexpr size_t NumItems = 40;
+	std::vector<int> last_batch(NumItems, -1);
+
+	for (int batch = 0; batch < 2000; ++batch) {
+		// Items are distinct, so plain writes must not race
+		workers.Run(
+		        NumItems,
+		        [&](const size_t item) { last_batch[item] = batch; },
+		        [] {});
+
+		for (size_t i = 0; i < NumItems; ++i) {
+			ASSERT_EQ(last_batch[i], batch) << "item " << i;
+		}
+	}
+}
+
+TEST(RenderWorkers, RendersOnSeveralThreads)
+{
+	RenderWorkers workers(NumThreads, "test:render");
+
+	// Items 0 and 1 are in different work units, so whichever thread takes
+	// item 0 only moves on once another thread has started item 1
+	std::atomic_bool second_started = false;
+	std::atomic_bool overlapped     = false;
+
+	workers.Run(
+	        2,
+	        [&](const size_t item) {
+		        if (item == 1) {
+			        second_started = true;
+			        return;
+		        }
+		        const auto deadline = std::chrono::steady_clock::now() +
+		                              std::chrono::seconds(10);
+		        while (!second_started &&
+		               std::chrono::steady_clock::now() < deadline) {
+			        std::this_thread::yield();
+		        }
+		        overlapped = second_started.load();
+	        },
+	        [] {});
+
+	EXPECT_TRUE(overlapped);
+}
+
+TEST(RenderWorkers, RestartsAfterStopping)
+{
+	RenderWorkers workers(NumThreads, "test:render");
+
+	std::atomic<int> renders = 0;
+	const auto render_batch  = [&] {
+		workers.Run(
+		        32, [&](const size_t) { renders.fetch_add(1); }, [] {});
+	};
+
+	render_batch();
+	workers.StopThreads();
+	workers.StopThreads();
+	render_batch();
+	EXPECT_EQ(renders.load(), 64);
+}
+
+} // namespace
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "audio/integer_decimator.h"
+#include "audio/private/integer_upsampler.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// About a mixer block's worth of input at the usual channel rates
+constexpr size_t BlockSize = 512;
+
+std::vector<AudioFrame> make_tone()
+{
+	std::vector<AudioFrame> frames(BlockSize);
+	for (size_t i = 0; i < frames.size(); ++i) {
+		const auto phase = static_cast<float>(i) * 0.05f;
+		frames[i] = {std::sin(phase) * 16000.0f, std::cos(phase) * 16000.0f};
+	}
+	return frames;
+}
+
+// 22050 Hz channels into a 44100 Hz mixer, 11025 Hz ones and 8000 Hz
+// into 48000 Hz, at each quality
+void BM_IntegerUpsampler(benchmark::State& state)
+{
+	const auto in = make_tone();
+
+	IntegerUpsampler upsampler = {};
+	upsampler.Configure(static_cast<int>(state.range(0)),
+	                    static_cast<ResampleQuality>(state.range(1)));
+
+	std::vector<AudioFrame> out = {};
+	for (auto _ : state) {
+		out.clear();
+		upsampler.Process(in.data(), in.size(), out);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(BlockSize));
+}
+BENCHMARK(BM_IntegerUpsampler)->ArgsProduct({{2, 4, 6}, {0, 1, 2}});
+
+// The PSG and CMS chips, rendered at a few hundred kHz
+void BM_IntegerDecimator(benchmark::State& state)
+{
+	const auto in = make_tone();
+
+	IntegerDecimator<AudioFrame> decimator = {};
+	decimator.Configure(static_cast<int>(state.range(0)));
+
+	std::vector<AudioFrame> out = {};
+	for (auto _ : state) {
+		out.clear();
+		decimator.Process(in.data(), in.size(), out);
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(BlockSize));
+}
+BENCHMARK(BM_IntegerDecimator)->Arg(2)->Arg(4)->Arg(8);
+
+} // namespace
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "utils/rwqueue.h"
+#include "utils/spsc_queue.h"
+
+#include "audio/audio_frame.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Single items, as the MIDI and capture queues pass them
+void BM_RwQueueItems(benchmark::State& state)
+{
+	RWQueue<int> queue(1024);
+	int item = 0;
+	for (auto _ : state) {
+		queue.Enqueue(item++);
+		benchmark::DoNotOptimize(queue.Dequeue());
+	}
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RwQueueItems);
+
+// Blocks of frames in and out on one thread: the cost of the queue alone
+void BM_RwQueueBulk(benchmark::State& state)
+{
+	const auto block_size = static_cast<size_t>(state.range(0));
+
+	RWQueue<AudioFrame> queue(block_size * 4);
+	std::vector<AudioFrame> source = {};
+	std::vector<AudioFrame> target = {};
+	for (auto _ : state) {
+		source.assign(block_size, {0.25f, -0.25f});
+		queue.BulkEnqueue(source);
+		queue.BulkDequeue(target, block_size);
+		benchmark::DoNotOptimize(target.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_RwQueueBulk)->Arg(64)->Arg(512);
+
+// A device thread producing blocks for a consumer draining them, like the
+// mixer and the audio callback; measured in wall-clock time. The MIDI
+// synths' FIFOs use the lock-free SpscQueue instead of RWQueue.
+template <typename Queue>
+void BM_QueueThreaded(benchmark::State& state)
+{
+	const auto block_size = static_cast<size_t>(state.range(0));
+
+	Queue queue(block_size * 4);
+
+	std::thread producer([&] {
+		std::vector<AudioFrame> source = {};
+		while (queue.IsRunning()) {
+			source.assign(block_size, {0.25f, -0.25f});
+			queue.BulkEnqueue(source);
+		}
+	});
+
+	std::vector<AudioFrame> target = {};
+	for (auto _ : state) {
+		queue.BulkDequeue(target, block_size);
+		benchmark::DoNotOptimize(target.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+
+	queue.Stop();
+	producer.join();
+}
+BENCHMARK_TEMPLATE(BM_QueueThreaded, RWQueue<AudioFrame>)
+        ->Arg(64)
+        ->Arg(512)
+        ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_QueueThreaded, SpscQueue<AudioFrame>)
+        ->Arg(64)
+        ->Arg(512)
+        ->UseRealTime();
+
+} // namespace
@@ -2,11 +2,14 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include "utils/rwqueue.h"
+#include "utils/spsc_queue.h"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 
 
+#include <chrono>
+#include <numeric>
 #include <thread>
 #include <tuple>
 #include <vector>
@@ -302,6 +305,29 @@ TEST(RWQueue, AsyncBulkIOSOverSized)
 	}
 }
 
+TEST(RWQueue, ShrinkBelowQueuedItems)
+{
+	RWQueue<int> q(8);
+	std::vector<int> items(8, 1);
+	q.BulkEnqueue(items);
+
+	q.Resize(4);
+	EXPECT_EQ(q.Size(), 8);
+
+	std::vector<int> more = {2, 2};
+	EXPECT_EQ(q.NonblockingBulkEnqueue(more), 0);
+
+	// The producer waits until the queue has drained below the new capacity
+	std::thread writer([&] { q.BulkEnqueue(more); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	EXPECT_EQ(q.Size(), 8);
+
+	std::vector<int> taken = {};
+	q.BulkDequeue(taken, 6);
+	writer.join();
+	EXPECT_EQ(q.Size(), 4);
+}
+
 using container_t = std::vector<int16_t>;
 
 TEST(RWQueue,ContainerSerial)
@@ -541,4 +567,102 @@ TEST(RWQueue, StopBulkMidway)
 	EXPECT_TRUE(items.empty());
 }
 
+TEST(SpscQueue, Serial)
+{
+	SpscQueue<int> q(5);
+	for (int round = 0; round != 10; ++round) { // wraps around the ring
+		EXPECT_TRUE(q.IsEmpty());
+		for (int i = 0; i != 5; ++i) {
+			EXPECT_TRUE(q.Enqueue(round + i));
+		}
+		EXPECT_TRUE(q.IsFull());
+		EXPECT_EQ(q.Size(), 5u);
+		EXPECT_FLOAT_EQ(q.GetPercentFull(), 100.0f);
+
+		for (int i = 0; i != 5; ++i) {
+			EXPECT_EQ(*q.Dequeue(), round + i);
+		}
+	}
+	EXPECT_EQ(q.MaxCapacity(), 5u);
+}
+
+TEST(SpscQueue, AsyncBulkIO)
+{
+	for (const auto& [queue_capacity,
+	                  num_per_bulk_enqueue,
+	                  num_per_bulk_dequeue,
+	                  total_to_queue] : {bulk_params_t{1, 1, 1, 50},
+	                                     bulk_params_t{10, 50, 50, 500},
+	                                     bulk_params_t{50, 7, 13, 1000},
+	                                     bulk_params_t{64, 100, 3, 1000}}) {
+		SpscQueue<int> q(queue_capacity);
+
+		std::thread writer([&, n = num_per_bulk_enqueue, total = total_to_queue] {
+			std::vector<int> items = {};
+			for (size_t sent = 0; sent < total;) {
+				const auto num_items = std::min(n, total - sent);
+				items.resize(num_items);
+				std::iota(items.begin(),
+				          items.end(),
+				          static_cast<int>(sent));
+				EXPECT_EQ(q.BulkEnqueue(items), num_items);
+				sent += num_items;
+			}
+		});
+
+		std::vector<int> items = {};
+		int expected           = 0;
+		for (size_t received = 0; received < total_to_queue;) {
+			const auto num_items = std::min(num_per_bulk_dequeue,
+			                                total_to_queue - received);
+			ASSERT_EQ(q.BulkDequeue(items, num_items), num_items);
+			for (const auto item : items) {
+				EXPECT_EQ(item, expected++);
+			}
+			received += num_items;
+		}
+		writer.join();
+		EXPECT_TRUE(q.IsEmpty());
+	}
+}
+
+TEST(SpscQueue, StopWakesBlockedSides)
+{
+	SpscQueue<int> full(1);
+	full.Enqueue(1);
+	std::thread producer([&] { EXPECT_FALSE(full.Enqueue(2)); });
+
+	SpscQueue<int> empty(1);
+	std::thread consumer([&] { EXPECT_FALSE(empty.Dequeue().has_value()); });
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	full.Stop();
+	empty.Stop();
+	producer.join();
+	consumer.join();
+
+	// What was queued before stopping still drains
+	EXPECT_EQ(*full.Dequeue(), 1);
+	EXPECT_FALSE(full.Dequeue().has_value());
+}
+
+TEST(SpscQueue, StopBulkMidway)
+{
+	SpscQueue<int> q(8);
+
+	std::vector<int> items = {1, 2, 3, 4, 5};
+	EXPECT_EQ(q.BulkEnqueue(items), 5u);
+	EXPECT_TRUE(items.empty());
+
+	q.Stop();
+	items = {6, 7};
+	EXPECT_EQ(q.BulkEnqueue(items), 0u);
+	EXPECT_EQ(q.Size(), 5u);
+
+	// Over-requesting returns what's left
+	EXPECT_EQ(q.BulkDequeue(items, 10), 5u);
+	EXPECT_EQ(items, (std::vector<int>{1, 2, 3, 4, 5}));
+	EXPECT_EQ(q.BulkDequeue(items, 10), 0u);
+}
+
 } // namespace
@@ -0,0 +1,338 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "misc/savestate.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct FakeDevice {
+	uint32_t counter = 0;
+	std::string name = {};
+
+	int num_applies = 0;
+	bool refuse     = false;
+
+	SaveStateComponent Component(const std::string& section)
+	{
+		return {section,
+		        [this](SaveStateWriter& out) {
+			        out.Write(counter);
+			        out.WriteString(name);
+		        },
+		        [this](SaveStateReader& in, const bool apply) {
+			        uint32_t saved_counter = 0;
+			        std::string saved_name = {};
+			        if (!in.Read(saved_counter) || !in.ReadString(saved_name)) {
+				        return false;
+			        }
+			        if (refuse) {
+				        return in.Fail("refused");
+			        }
+			        if (apply) {
+				        counter = saved_counter;
+				        name    = saved_name;
+				        ++num_applies;
+			        }
+			        return true;
+		        }};
+	}
+};
+
+class SaveStateTest : public ::testing::Test {
+protected:
+	std::vector<SaveStateComponent> Components()
+	{
+		return {first.Component("first"), second.Component("second")};
+	}
+
+	std::vector<uint8_t> Save()
+	{
+		std::string error = {};
+		auto blob         = SAVESTATE_Encode(Components(), 1, error);
+		EXPECT_TRUE(error.empty());
+		return blob;
+	}
+
+	FakeDevice first  = {7, "alpha"};
+	FakeDevice second = {9, "beta"};
+};
+
+TEST_F(SaveStateTest, RoundTripsEveryComponent)
+{
+	const auto blob = Save();
+	ASSERT_FALSE(blob.empty());
+
+	first.counter = 100;
+	second.name   = "changed";
+
+	std::string error = {};
+	ASSERT_TRUE(SAVESTATE_Decode(blob, Components(), 1, error)) << error;
+	EXPECT_EQ(first.counter, 7u);
+	EXPECT_EQ(second.name, "beta");
+	EXPECT_EQ(first.num_applies, 1);
+	EXPECT_EQ(second.num_applies, 1);
+}
+
+TEST_F(SaveStateTest, RejectsForeignBlobs)
+{
+	auto blob = Save();
+
+	std::string error = {};
+	EXPECT_FALSE(SAVESTATE_Decode(blob, Components(), 2, error));
+	EXPECT_EQ(error, "save-state was taken in a different host context");
+
+	// Session ID follows the magic, version, and flags
+	blob[8] ^= 0xff;
+	EXPECT_FALSE(SAVESTATE_Decode(blob, Components(), 1, error));
+	EXPECT_EQ(error, "save-state belongs to another session");
+
+	blob[0] = 'X';
+	EXPECT_FALSE(SAVESTATE_Decode(blob, Components(), 1, error));
+	EXPECT_EQ(error, "not a save-state");
+
+	EXPECT_FALSE(SAVESTATE_Decode({}, Components(), 1, error));
+	EXPECT_EQ(error, "not a save-state");
+}
+
+TEST_F(SaveStateTest, RequiresTheSameSections)
+{
+	std::string error = {};
+	const auto blob   = SAVESTATE_Encode({first.Component("first")}, 1, error);
+
+	EXPECT_FALSE(SAVESTATE_Decode(blob, Components(), 1, error));
+	EXPECT_EQ(error, "save-state lacks section 'second'");
+
+	EXPECT_FALSE(SAVESTATE_Decode(Save(), {first.Component("first")}, 1, error));
+	EXPECT_EQ(error, "save-state has unknown section 'second'");
+}
+
+TEST_F(SaveStateTest, AppliesNothingIfAnySectionIsRefused)
+{
+	const auto blob = Save();
+	first.counter   = 100;
+	second.refuse   = true;
+
+	std::string error = {};
+	EXPECT_FALSE(SAVESTATE_Decode(blob, Components(), 1, error));
+	EXPECT_EQ(error, "second: refused");
+	EXPECT_EQ(first.counter, 100u);
+	EXPECT_EQ(first.num_applies, 0);
+}
+
+TEST_F(SaveStateTest, RejectsTruncatedAndOversizedSections)
+{
+	const auto blob = Save();
+
+	SaveStateComponent shorter = {"second",
+	                              [](SaveStateWriter&) {},
+	                              [](SaveStateReader& in, bool) {
+		                              uint32_t value = 0;
+		                              return in.Read(value);
+	                              }};
+	std::string error = {};
+	EXPECT_FALSE(SAVESTATE_Decode(blob, {first.Component("first"), shorter}, 1, error));
+	EXPECT_EQ(error, "second: section has trailing bytes");
+
+	auto truncated = blob;
+	truncated.resize(truncated.size() - 2);
+	EXPECT_FALSE(SAVESTATE_Decode(truncated, Components(), 1, error));
+	EXPECT_EQ(error, "save-state is truncated");
+}
+
+TEST_F(SaveStateTest, ComponentsCanRefuseToSave)
+{
+	SaveStateComponent unsupported = {"second",
+	                                  [](SaveStateWriter& out) {
+		                                  out.Fail("not supported");
+	                                  },
+	                                  [](SaveStateReader&, bool) { return true; }};
+	std::string error = {};
+	EXPECT_TRUE(SAVESTATE_Encode({first.Component("first"), unsupported}, 1, error)
+	                    .empty());
+	EXPECT_EQ(error, "second: not supported");
+}
+
+class CheckpointStoreTest : public ::testing::Test {
+protected:
+	static constexpr size_t NumPages = 4;
+
+	// Fills a page with a pattern that deflates well
+	void Write(const uint32_t page, const uint8_t value)
+	{
+		std::fill_n(ram.begin() + page * CheckpointPageSize, CheckpointPageSize, value);
+	}
+
+	std::vector<uint8_t> Restore(CheckpointStore& store, const uint32_t id)
+	{
+		std::vector<uint8_t> state = {};
+		std::vector<uint8_t> image = {};
+		std::string error          = {};
+		EXPECT_TRUE(store.Restore(id, NumPages, state, image, error)) << error;
+		return image;
+	}
+
+	static std::vector<uint32_t> AllPages()
+	{
+		std::vector<uint32_t> pages(NumPages);
+		std::iota(pages.begin(), pages.end(), 0);
+		return pages;
+	}
+
+	std::vector<uint8_t> ram = std::vector<uint8_t>(NumPages * CheckpointPageSize, 0);
+};
+
+TEST_F(CheckpointStoreTest, RestoresPagesFromEarlierCheckpoints)
+{
+	CheckpointStore store(8);
+
+	Write(0, 1);
+	Write(1, 2);
+	const auto first = store.Add({0xaa}, ram.data(), AllPages());
+	const auto first_ram = ram;
+
+	Write(1, 3);
+	const auto second = store.Add({0xbb}, ram.data(), {1});
+
+	EXPECT_EQ(Restore(store, second), ram);
+	EXPECT_EQ(Restore(store, first), first_ram);
+
+	std::vector<uint8_t> state = {};
+	std::vector<uint8_t> image = {};
+	std::string error          = {};
+	ASSERT_TRUE(store.Restore(second, NumPages, state, image, error));
+	EXPECT_EQ(state, std::vector<uint8_t>{0xbb});
+
+	EXPECT_FALSE(store.Restore(second + 1, NumPages, state, image, error));
+	EXPECT_EQ(error, "unknown checkpoint");
+}
+
+TEST_F(CheckpointStoreTest, DroppedCheckpointsHandTheirPagesOn)
+{
+	CheckpointStore store(2);
+
+	Write(0, 1);
+	const auto first = store.Add({}, ram.data(), AllPages());
+	Write(2, 5);
+	store.Add({}, ram.data(), {2});
+	Write(3, 7);
+	const auto third = store.Add({}, ram.data(), {3});
+
+	const std::vector<uint32_t> kept = {first + 1, third};
+	EXPECT_EQ(store.Ids(), kept);
+	EXPECT_EQ(Restore(store, third), ram);
+}
+
+TEST_F(CheckpointStoreTest, DeflatesPagesInTheBackground)
+{
+	CheckpointStore store(4);
+
+	Write(0, 9);
+	const auto id = store.Add({}, ram.data(), AllPages());
+	store.Flush();
+
+	EXPECT_LT(store.PageBytes(), NumPages * CheckpointPageSize);
+	EXPECT_EQ(Restore(store, id), ram);
+}
+
+TEST_F(CheckpointStoreTest, SharesIdenticalPages)
+{
+	CheckpointStore store(4);
+
+	// Pages 1 to 3 are all zeros, like much of a booted machine's RAM
+	Write(0, 1);
+	const auto first = store.Add({}, ram.data(), AllPages());
+	store.Flush();
+	const auto first_bytes = store.PageBytes();
+
+	// Nothing new is stored for pages the store already holds
+	size_t num_new = 0;
+	const auto second = store.Add({}, ram.data(), AllPages(), &num_new);
+	EXPECT_EQ(num_new, 0u);
+	EXPECT_EQ(store.PageBytes(), first_bytes);
+
+	Write(2, 1);
+	Write(3, 6);
+	store.Add({}, ram.data(), {2, 3}, &num_new);
+	EXPECT_EQ(num_new, 1u);
+
+	EXPECT_EQ(Restore(store, first), Restore(store, second));
+	EXPECT_EQ(Restore(store, second + 1), ram);
+}
+
+TEST(PageChunkStore, InternsPagesByContent)
+{
+	std::vector<uint8_t> ram(3 * CheckpointPageSize, 0);
+	std::fill_n(ram.begin(), CheckpointPageSize, 4);
+	std::fill_n(ram.begin() + 2 * CheckpointPageSize, CheckpointPageSize, 4);
+
+	PageChunkStore store;
+	size_t num_new    = 0;
+	const auto chunks = store.Intern(ram.data(), {0, 1, 2}, &num_new);
+	ASSERT_EQ(chunks.size(), 3u);
+	EXPECT_EQ(num_new, 2u);
+	EXPECT_EQ(chunks[0], chunks[2]);
+	EXPECT_NE(chunks[0], chunks[1]);
+	EXPECT_EQ(store.NumChunks(), 2u);
+
+	// Still found once deflated
+	store.Flush();
+	EXPECT_TRUE(chunks[0]->is_deflated);
+	EXPECT_EQ(store.Intern(ram.data(), {2}, &num_new)[0], chunks[0]);
+	EXPECT_EQ(num_new, 0u);
+
+	std::vector<uint8_t> page(CheckpointPageSize);
+	ASSERT_TRUE(store.Read(chunks[2], page.data()));
+	EXPECT_TRUE(std::equal(page.begin(), page.end(), ram.begin()));
+}
+
+TEST(PageChunkStore, DropsUnheldChunks)
+{
+	std::vector<uint8_t> ram(CheckpointPageSize, 8);
+
+	PageChunkStore store;
+	store.Intern(ram.data(), {0});
+	// The deflater lets go of it once done
+	store.Flush();
+	EXPECT_EQ(store.NumChunks(), 0u);
+
+	size_t num_new = 0;
+	store.Intern(ram.data(), {0}, &num_new);
+	EXPECT_EQ(num_new, 1u);
+}
+
+TEST(PageChunkStore, DeflatesChunksStoredWhileParked)
+{
+	std::vector<uint8_t> ram(CheckpointPageSize, 3);
+
+	PageChunkStore store;
+	store.SuspendThread();
+	const auto chunks = store.Intern(ram.data(), {0});
+	store.Flush();
+	EXPECT_FALSE(chunks[0]->is_deflated);
+
+	store.ResumeThread();
+	store.Flush();
+	EXPECT_TRUE(chunks[0]->is_deflated);
+}
+
+TEST_F(CheckpointStoreTest, RequiresEveryPage)
+{
+	CheckpointStore store(4);
+	const auto id = store.Add({}, ram.data(), {0, 1});
+
+	std::vector<uint8_t> state = {};
+	std::vector<uint8_t> image = {};
+	std::string error          = {};
+	EXPECT_FALSE(store.Restore(id, NumPages, state, image, error));
+	EXPECT_EQ(error, "checkpoint lacks pages");
+}
+
+} // namespace
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gui/private/scaler_pixels.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr size_t Width = 640;
+
+// The scalers hand the kernels the runs of a line that changed
+constexpr size_t RunSize = 32;
+
+template <typename Src, typename Draw>
+void scale_lines(benchmark::State& state, const std::vector<Src>& src,
+                 const int scale, Draw draw)
+{
+	const auto pixel_bytes = static_cast<size_t>(scale) * sizeof(uint32_t);
+
+	std::vector<uint8_t> line_out(Width * pixel_bytes);
+	for (auto _ : state) {
+		for (size_t x = 0; x < Width; x += RunSize) {
+			draw(line_out.data() + x * pixel_bytes,
+			     src.data() + x,
+			     RunSize);
+		}
+		benchmark::DoNotOptimize(line_out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(Width));
+}
+
+struct Lines {
+	std::vector<uint32_t> palette = std::vector<uint32_t>(256);
+	std::vector<uint8_t> indexed  = std::vector<uint8_t>(Width);
+	std::vector<uint16_t> packed  = std::vector<uint16_t>(Width);
+	std::vector<uint32_t> rgb888  = std::vector<uint32_t>(Width);
+
+	Lines()
+	{
+		for (size_t i = 0; i < palette.size(); ++i) {
+			palette[i] = static_cast<uint32_t>(i * 0x010101);
+		}
+		uint32_t seed = 1;
+		for (size_t i = 0; i < Width; ++i) {
+			seed       = seed * 1'664'525 + 1'013'904'223;
+			indexed[i] = static_cast<uint8_t>(seed >> 24);
+			packed[i]  = static_cast<uint16_t>(seed >> 16);
+			rgb888[i]  = seed;
+		}
+	}
+};
+
+// Each is drawn either by the kernels the scalers use or by the scalar
+// references, which draw a pixel at a time like the PMAKE loop did
+template <int Scale, bool Reference>
+void BM_ScaleIndexed(benchmark::State& state)
+{
+	const Lines lines = {};
+	scale_lines(state, lines.indexed, Scale, [&](auto dst, auto src, auto n) {
+		if constexpr (Reference) {
+			scale_indexed_to_32_scalar<Scale>(dst, src, n, lines.palette.data());
+		} else {
+			scale_indexed_to_32<Scale>(dst, src, n, lines.palette.data());
+		}
+	});
+}
+BENCHMARK(BM_ScaleIndexed<1, false>);
+BENCHMARK(BM_ScaleIndexed<2, false>);
+BENCHMARK(BM_ScaleIndexed<1, true>);
+BENCHMARK(BM_ScaleIndexed<2, true>);
+
+template <int Scale, bool Rgb565, bool Reference>
+void scale_packed16_lines(benchmark::State& state)
+{
+	const Lines lines = {};
+	if constexpr (Reference) {
+		scale_lines(state,
+		            lines.packed,
+		            Scale,
+		            scale_packed16_to_32_scalar<Scale, Rgb565>);
+	} else {
+		scale_lines(state, lines.packed, Scale, scale_packed16_to_32<Scale, Rgb565>);
+	}
+}
+template <int Scale, bool Reference>
+void BM_ScaleRgb555(benchmark::State& state)
+{
+	scale_packed16_lines<Scale, false, Reference>(state);
+}
+BENCHMARK(BM_ScaleRgb555<1, false>);
+BENCHMARK(BM_ScaleRgb555<2, false>);
+BENCHMARK(BM_ScaleRgb555<1, true>);
+BENCHMARK(BM_ScaleRgb555<2, true>);
+
+template <int Scale, bool Reference>
+void BM_ScaleRgb565(benchmark::State& state)
+{
+	scale_packed16_lines<Scale, true, Reference>(state);
+}
+BENCHMARK(BM_ScaleRgb565<1, false>);
+BENCHMARK(BM_ScaleRgb565<2, false>);
+BENCHMARK(BM_ScaleRgb565<1, true>);
+BENCHMARK(BM_ScaleRgb565<2, true>);
+
+template <int Scale, bool Reference>
+void BM_ScaleRgb888(benchmark::State& state)
+{
+	const Lines lines = {};
+	if constexpr (Reference) {
+		scale_lines(state, lines.rgb888, Scale, scale_32_to_32_scalar<Scale>);
+	} else {
+		scale_lines(state, lines.rgb888, Scale, scale_32_to_32<Scale>);
+	}
+}
+BENCHMARK(BM_ScaleRgb888<1, false>);
+BENCHMARK(BM_ScaleRgb888<2, false>);
+BENCHMARK(BM_ScaleRgb888<1, true>);
+BENCHMARK(BM_ScaleRgb888<2, true>);
+
+} // namespace
@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "gui/private/scaler_pixels.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Run lengths around the kernels' 4 and 8-pixel steps, up to the scalers'
+// 32-pixel runs
+constexpr std::array<size_t, 9> RunLengths = {0, 1, 3, 4, 7, 8, 9, 31, 32};
+
+template <int Width, typename Src, typename Draw, typename Reference>
+void expect_same_as_reference(const std::vector<Src>& src, Draw draw,
+                              Reference reference)
+{
+	for (const auto num_pixels : RunLengths) {
+		// Unaligned, with a guard pixel past the end
+		const auto num_bytes = (num_pixels * Width + 1) * sizeof(uint32_t) + 1;
+		std::vector<uint8_t> expected(num_bytes, 0xcc);
+		std::vector<uint8_t> actual(num_bytes, 0xcc);
+
+		reference(expected.data() + 1, src.data() + 1, num_pixels);
+		draw(actual.data() + 1, src.data() + 1, num_pixels);
+		EXPECT_EQ(actual, expected) << "run of " << num_pixels;
+	}
+}
+
+TEST(ScalerPixels, IndexedPixelsAreLookedUpAndDoubled)
+{
+	std::array<uint32_t, 256> palette = {};
+	for (size_t i = 0; i < palette.size(); ++i) {
+		palette[i] = static_cast<uint32_t>(i * 0x010203 + 0x40);
+	}
+	std::vector<uint8_t> src(40);
+	for (size_t i = 0; i < src.size(); ++i) {
+		src[i] = static_cast<uint8_t>(i * 37);
+	}
+
+	expect_same_as_reference<1>(
+	        src,
+	        [&](auto dst, auto s, auto n) {
+		        scale_indexed_to_32<1>(dst, s, n, palette.data());
+	        },
+	        [&](auto dst, auto s, auto n) {
+		        scale_indexed_to_32_scalar<1>(dst, s, n, palette.data());
+	        });
+	expect_same_as_reference<2>(
+	        src,
+	        [&](auto dst, auto s, auto n) {
+		        scale_indexed_to_32<2>(dst, s, n, palette.data());
+	        },
+	        [&](auto dst, auto s, auto n) {
+		        scale_indexed_to_32_scalar<2>(dst, s, n, palette.data());
+	        });
+}
+
+TEST(ScalerPixels, PackedPixelsWidenLikeTheScalers)
+{
+	// Every 16-bit value, in runs of eight
+	for (uint32_t value = 0; value < 0x10000; value += 8) {
+		std::array<uint16_t, 8> src = {};
+		for (size_t i = 0; i < src.size(); ++i) {
+			src[i] = static_cast<uint16_t>(value + i);
+		}
+		std::array<uint32_t, 8> rgb555 = {};
+		std::array<uint32_t, 8> rgb565 = {};
+		scale_packed16_to_32<1, false>(reinterpret_cast<uint8_t*>(rgb555.data()),
+		                               src.data(),
+		                               src.size());
+		scale_packed16_to_32<1, true>(reinterpret_cast<uint8_t*>(rgb565.data()),
+		                              src.data(),
+		                              src.size());
+
+		for (size_t i = 0; i < src.size(); ++i) {
+			const uint32_t v = src[i];
+
+			// The scalers' PMAKE for 15 and 16-bit sources to 32-bit
+			ASSERT_EQ(rgb555[i],
+			          (((v & (31 << 10)) << 9) | ((v & (31 << 5)) << 6) |
+			           ((v & 31) << 3) | ((v & (7 << 12)) << 4) |
+			           ((v & (7 << 7)) << 1) | ((v & (7 << 2)) >> 2)));
+			ASSERT_EQ(rgb565[i],
+			          (((v & (31 << 11)) << 8) | ((v & (63 << 5)) << 5) |
+			           ((v & 0xE01F) << 3) | ((v & (3 << 9)) >> 1) |
+			           ((v & (7 << 2)) >> 2)));
+		}
+	}
+}
+
+TEST(ScalerPixels, PackedRunsMatchTheReference)
+{
+	std::vector<uint16_t> src(40);
+	for (size_t i = 0; i < src.size(); ++i) {
+		src[i] = static_cast<uint16_t>(i * 0x1357 + 0x8001);
+	}
+
+	expect_same_as_reference<1>(src,
+	                            scale_packed16_to_32<1, true>,
+	                            scale_packed16_to_32_scalar<1, true>);
+	expect_same_as_reference<2>(src,
+	                            scale_packed16_to_32<2, true>,
+	                            scale_packed16_to_32_scalar<2, true>);
+	expect_same_as_reference<1>(src,
+	                            scale_packed16_to_32<1, false>,
+	                            scale_packed16_to_32_scalar<1, false>);
+	expect_same_as_reference<2>(src,
+	                            scale_packed16_to_32<2, false>,
+	                            scale_packed16_to_32_scalar<2, false>);
+}
+
+TEST(ScalerPixels, TrueColourRunsAreCopiedAndDoubled)
+{
+	std::vector<uint32_t> src(40);
+	for (size_t i = 0; i < src.size(); ++i) {
+		src[i] = static_cast<uint32_t>(i * 0x01020304 + 5);
+	}
+
+	expect_same_as_reference<1>(src, scale_32_to_32<1>, scale_32_to_32_scalar<1>);
+	expect_same_as_reference<2>(src, scale_32_to_32<2>, scale_32_to_32_scalar<2>);
+}
+
+} // namespace
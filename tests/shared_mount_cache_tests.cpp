@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "dos/shared_mount_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+class SharedMountCacheTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		std_fs::remove_all(root);
+		std_fs::create_directories(game);
+		DOS_SetSharedMountCache((root / "cache").string());
+		ASSERT_TRUE(DOS_IsSharedMountCacheEnabled());
+	}
+
+	void TearDown() override
+	{
+		DOS_SetSharedMountCache("");
+		std_fs::remove_all(root);
+	}
+
+	static void write_file(const std_fs::path& path, const size_t size, const char fill)
+	{
+		std::ofstream file(path, std::ios::binary);
+		const std::string data(size, fill);
+		file.write(data.data(), static_cast<std::streamsize>(data.size()));
+	}
+
+	const std_fs::path root = std_fs::temp_directory_path() / "shared_mount_cache_tests";
+	const std_fs::path game = root / "game";
+};
+
+TEST_F(SharedMountCacheTest, ListingsAreStoredAndLoaded)
+{
+	EXPECT_FALSE(DOS_LoadSharedDirListing(game));
+
+	const std::vector<SharedDirEntry> entries = {{"GAME.EXE", false},
+	                                             {"data", true}};
+	DOS_StoreSharedDirListing(game, entries);
+
+	const auto listing = DOS_LoadSharedDirListing(game);
+	ASSERT_TRUE(listing);
+	ASSERT_EQ(listing->size(), 2u);
+	EXPECT_EQ((*listing)[0].name, "GAME.EXE");
+	EXPECT_FALSE((*listing)[0].is_directory);
+	EXPECT_EQ((*listing)[1].name, "data");
+	EXPECT_TRUE((*listing)[1].is_directory);
+}
+
+TEST_F(SharedMountCacheTest, ChangedDirectoriesAreReadAgain)
+{
+	DOS_StoreSharedDirListing(game, {{"GAME.EXE", false}});
+	ASSERT_TRUE(DOS_LoadSharedDirListing(game));
+
+	const auto later = std_fs::last_write_time(game) + std::chrono::seconds(10);
+	std_fs::last_write_time(game, later);
+	EXPECT_FALSE(DOS_LoadSharedDirListing(game));
+}
+
+TEST_F(SharedMountCacheTest, IdenticalContentsShareTheirMapping)
+{
+	write_file(game / "A.DAT", SharedFileMinSize * 2, 'a');
+	write_file(game / "COPY.DAT", SharedFileMinSize * 2, 'a');
+	write_file(game / "B.DAT", SharedFileMinSize * 2, 'b');
+
+	const auto a    = DOS_MapSharedFile(game / "A.DAT");
+	const auto copy = DOS_MapSharedFile(game / "COPY.DAT");
+	const auto b    = DOS_MapSharedFile(game / "B.DAT");
+#if defined(WIN32)
+	EXPECT_EQ(a, nullptr);
+#else
+	ASSERT_NE(a, nullptr);
+	ASSERT_NE(b, nullptr);
+	EXPECT_EQ(a, copy);
+	EXPECT_NE(a, b);
+	ASSERT_EQ(a->Size(), SharedFileMinSize * 2);
+	EXPECT_TRUE(std::all_of(a->Data(), a->Data() + a->Size(), [](const uint8_t c) {
+		return c == 'a';
+	}));
+	EXPECT_EQ(b->Data()[0], 'b');
+#endif
+}
+
+TEST_F(SharedMountCacheTest, SmallFilesAreNotMapped)
+{
+	write_file(game / "SMALL.TXT", 100, 's');
+	EXPECT_EQ(DOS_MapSharedFile(game / "SMALL.TXT"), nullptr);
+}
+
+TEST_F(SharedMountCacheTest, NothingIsSharedWhileDisabled)
+{
+	write_file(game / "A.DAT", SharedFileMinSize, 'a');
+	DOS_SetSharedMountCache("");
+	EXPECT_FALSE(DOS_IsSharedMountCacheEnabled());
+	EXPECT_EQ(DOS_MapSharedFile(game / "A.DAT"), nullptr);
+	DOS_StoreSharedDirListing(game, {{"A.DAT", false}});
+	EXPECT_FALSE(DOS_LoadSharedDirListing(game));
+}
+
+} // namespace
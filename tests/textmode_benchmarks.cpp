@@ -0,0 +1,647 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/encoder.h"
+#include "textmode_server/snapshot.h"
+
+#include "hardware/video/vga.h"
+#include "textmode_server/command_processor.h"
+#include "textmode_server/keyboard_processor.h"
+#include "textmode_server/queued_type_action_sink.h"
+#include "textmode_server/server.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if !defined(WIN32)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using textmode::BackendEvent;
+using textmode::ClientHandle;
+using textmode::EncodingOptions;
+using textmode::FrameBaseline;
+using textmode::NetworkBackend;
+using textmode::Snapshot;
+
+constexpr uint32_t CharHeight = 16;
+
+// Text in a handful of colors, similar to a directory listing
+Snapshot make_screen(const uint16_t columns, const uint16_t rows)
+{
+	Snapshot snapshot = {};
+	snapshot.columns  = columns;
+	snapshot.rows     = rows;
+	snapshot.cells.resize(static_cast<size_t>(columns) * rows);
+
+	uint32_t seed = 1;
+	for (auto& cell : snapshot.cells) {
+		seed = seed * 1103515245 + 12345;
+		const auto roll = (seed >> 16) % 100;
+		cell.character = static_cast<uint8_t>(roll < 20 ? ' ' : 'A' + roll % 26);
+		cell.attribute = static_cast<uint8_t>(roll < 80 ? 0x07
+		                                                : 0x10 | (roll % 15 + 1));
+	}
+	snapshot.cursor = {true, true, 1, 2};
+	return snapshot;
+}
+
+void screen_args(benchmark::internal::Benchmark* b)
+{
+	b->Args({80, 25})->Args({80, 50})->Args({132, 60});
+}
+
+void set_cells_processed(benchmark::State& state)
+{
+	state.SetItemsProcessed(state.iterations() * state.range(0) * state.range(1));
+}
+
+void BM_AnsiFrame(benchmark::State& state)
+{
+	const auto snapshot = make_screen(static_cast<uint16_t>(state.range(0)),
+	                                  static_cast<uint16_t>(state.range(1)));
+	const EncodingOptions options = {};
+
+	std::string out = {};
+	for (auto _ : state) {
+		out.clear();
+		textmode::AppendAnsiFrame(snapshot, options, out);
+		benchmark::DoNotOptimize(out.data());
+	}
+	set_cells_processed(state);
+}
+BENCHMARK(BM_AnsiFrame)->Apply(screen_args);
+
+// Every cell in another color, with the attribute markup on: the worst
+// case for the SGR sequences
+void BM_AnsiFrameColorful(benchmark::State& state)
+{
+	auto snapshot = make_screen(static_cast<uint16_t>(state.range(0)),
+	                            static_cast<uint16_t>(state.range(1)));
+	for (size_t i = 0; i < snapshot.cells.size(); ++i) {
+		snapshot.cells[i] = {static_cast<uint8_t>(i * 7),
+		                     static_cast<uint8_t>(i / 3)};
+	}
+	EncodingOptions options = {};
+	options.show_attributes = true;
+
+	std::string out = {};
+	int64_t bytes   = 0;
+	for (auto _ : state) {
+		out.clear();
+		textmode::AppendAnsiFrame(snapshot, options, out);
+		bytes += static_cast<int64_t>(out.size());
+		benchmark::DoNotOptimize(out.data());
+	}
+	set_cells_processed(state);
+	state.SetBytesProcessed(bytes);
+}
+BENCHMARK(BM_AnsiFrameColorful)->Apply(screen_args);
+
+// A few cells change between frames, like a clock or a progress bar
+void BM_AnsiDiff(benchmark::State& state)
+{
+	auto snapshot = make_screen(static_cast<uint16_t>(state.range(0)),
+	                            static_cast<uint16_t>(state.range(1)));
+	const FrameBaseline baseline  = {snapshot, {}};
+	const EncodingOptions options = {};
+
+	for (size_t i = 0; i < 8; ++i) {
+		snapshot.cells[i * 37 % snapshot.cells.size()].character = '#';
+	}
+	for (auto _ : state) {
+		auto diff = textmode::BuildAnsiDiff(&baseline, snapshot, options);
+		benchmark::DoNotOptimize(diff.data());
+	}
+	set_cells_processed(state);
+}
+BENCHMARK(BM_AnsiDiff)->Apply(screen_args);
+
+void BM_BinaryFrame(benchmark::State& state)
+{
+	const auto snapshot = make_screen(static_cast<uint16_t>(state.range(0)),
+	                                  static_cast<uint16_t>(state.range(1)));
+	const EncodingOptions options = {};
+	const auto rle                = state.range(2) != 0;
+
+	for (auto _ : state) {
+		auto frame = textmode::BuildBinaryFrame(snapshot, options, rle);
+		benchmark::DoNotOptimize(frame.data());
+	}
+	set_cells_processed(state);
+}
+BENCHMARK(BM_BinaryFrame)->ArgsProduct({{80}, {25, 50}, {0, 1}});
+
+// Reads the text plane the way the server does on every vertical retrace
+void BM_CaptureSnapshot(benchmark::State& state)
+{
+	const auto columns       = static_cast<uint16_t>(state.range(0));
+	const auto rows          = static_cast<uint16_t>(state.range(1));
+	const auto bytes_per_row = static_cast<uint32_t>(columns) * 2;
+
+	std::vector<uint8_t> vram(64 * 1024);
+	uint32_t seed = 1;
+	for (auto& byte : vram) {
+		seed = seed * 1103515245 + 12345;
+		byte = static_cast<uint8_t>(seed >> 16);
+	}
+
+	VgaType vga = {};
+
+	vga.mode                    = M_TEXT;
+	vga.mem.linear              = vram.data();
+	vga.tandy.draw_base         = vram.data();
+	vga.vmemwrap                = static_cast<uint32_t>(vram.size());
+	vga.draw.linear_mask        = vga.vmemwrap - 1;
+	vga.draw.blocks             = columns;
+	vga.draw.address_line_total = CharHeight;
+	vga.draw.lines_total        = rows * CharHeight;
+	vga.draw.address_add        = bytes_per_row;
+	vga.draw.byte_panning_shift = 2;
+	vga.draw.cursor.enabled     = true;
+	vga.draw.cursor.address     = bytes_per_row + 4;
+
+	Snapshot snapshot = {};
+	for (auto _ : state) {
+		const auto is_text = textmode::CaptureSnapshotInto(vga, snapshot);
+		benchmark::DoNotOptimize(is_text);
+		benchmark::DoNotOptimize(snapshot.cells.data());
+	}
+	set_cells_processed(state);
+}
+BENCHMARK(BM_CaptureSnapshot)->Apply(screen_args);
+
+// One round of a scripting client's usual commands through the command
+// processor and the keyboard processor, without any server or transport
+void BM_CommandProcessor(benchmark::State& state)
+{
+	textmode::KeyboardCommandProcessor keyboard([](KBD_KEYS, bool) {});
+	textmode::CommandProcessor processor(
+	        [] { return textmode::ServiceResult{true, "frame-raw\n", ""}; },
+	        [&](const std::string& command) {
+		        return keyboard.HandleCommand(command);
+	        },
+	        {},
+	        [&] { return keyboard.ActiveKeys(); });
+
+	const std::vector<std::string> commands = {
+	        "TYPE \"dir /w\" Enter",
+	        "TYPE ShiftDown F1 ShiftUp",
+	        "GET",
+	        "STATS",
+	};
+
+	int64_t handled = 0;
+	for (auto _ : state) {
+		for (const auto& command : commands) {
+			const auto response = processor.HandleCommand(command);
+			benchmark::DoNotOptimize(response);
+			handled += response.ok ? 1 : 0;
+		}
+	}
+	if (handled != state.iterations() * static_cast<int64_t>(commands.size())) {
+		state.SkipWithError("a command failed");
+	}
+	state.SetItemsProcessed(handled);
+}
+BENCHMARK(BM_CommandProcessor);
+
+// Text-mode server throughput
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Drives TextModeServer with closed-loop clients, each keeping one request
+// in flight, over an in-process loopback backend and over real loopback
+// TCP sockets. Every iteration is one reply per client; the counters give
+// p50 and p99 latency and bytes per reply.
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint16_t ScreenColumns  = 80;
+constexpr uint16_t FirstBenchPort = 36200;
+constexpr uint16_t LastBenchPort  = 36299;
+
+struct Screen {
+	std::string name  = {};
+	Snapshot snapshot = {};
+	// Rewrites one cell before every request so each GET encodes anew
+	bool animate = false;
+};
+
+// Hands every event straight to the server and every reply straight back
+class LoopbackBackend final : public NetworkBackend {
+public:
+	bool Start(uint16_t) override { return true; }
+	void Stop() override {}
+
+	std::vector<BackendEvent> Poll() override
+	{
+		return std::exchange(m_events, {});
+	}
+
+	bool Send(const ClientHandle client, const std::string& payload) override
+	{
+		m_replies.push_back({client, payload.size()});
+		return true;
+	}
+
+	void Close(ClientHandle) override {}
+
+	void Deliver(BackendEvent event) { m_events.push_back(std::move(event)); }
+
+	struct Reply {
+		ClientHandle client = 0;
+		size_t bytes        = 0;
+	};
+	std::vector<Reply> TakeReplies() { return std::exchange(m_replies, {}); }
+
+private:
+	std::vector<BackendEvent> m_events = {};
+	std::vector<Reply> m_replies       = {};
+};
+
+// Passes through to a real backend, remembering the order clients connect
+// in and how many reply bytes each one is owed
+class CountingBackend final : public NetworkBackend {
+public:
+	explicit CountingBackend(std::unique_ptr<NetworkBackend> inner)
+	        : m_inner(std::move(inner))
+	{}
+
+	bool Start(const uint16_t port) override { return m_inner->Start(port); }
+	void Stop() override { m_inner->Stop(); }
+	void SetMaxClients(const size_t max_clients) override
+	{
+		m_inner->SetMaxClients(max_clients);
+	}
+
+	std::vector<BackendEvent> Poll() override
+	{
+		auto events = m_inner->Poll();
+		for (const auto& event : events) {
+			if (event.type == BackendEvent::Type::Connected) {
+				connected.push_back(event.client);
+			}
+		}
+		return events;
+	}
+
+	bool Send(const ClientHandle client, const std::string& payload) override
+	{
+		owed[client] += payload.size();
+		return m_inner->Send(client, payload);
+	}
+
+	void Close(const ClientHandle client) override { m_inner->Close(client); }
+
+	std::vector<ClientHandle> connected             = {};
+	std::unordered_map<ClientHandle, uint64_t> owed = {};
+
+private:
+	std::unique_ptr<NetworkBackend> m_inner;
+};
+
+// The server, processor, and TYPE queue one benchmark run talks to
+class Rig {
+public:
+	Rig(Screen& screen, std::unique_ptr<NetworkBackend> backend)
+	        : m_screen(screen),
+	          m_processor([this] { return ProvideFrame(); },
+	                      [](const std::string&) {
+		                      return textmode::CommandResponse{true, "OK\n"};
+	                      }),
+	          m_server(std::move(backend))
+	{
+		m_sink = std::make_shared<textmode::QueuedTypeActionSink>(
+		        [this](const uintptr_t client, const std::string& payload) {
+			        return m_server.Send(client, payload);
+		        },
+		        [this](const uintptr_t client) { m_server.Close(client); });
+		m_sink->SetInterTokenFrameDelay(0);
+		m_processor.SetMacroInterkeyFrames(0);
+		m_processor.SetTypeActionSink(m_sink);
+		m_processor.SetTypeSinkRequiresClient(true);
+		m_processor.SetAllowDeferredFrames(true);
+		m_server.SetMaxClients(1024);
+	}
+
+	bool Start(const uint16_t port) { return m_server.Start(port, m_processor); }
+	void Stop() { m_server.Stop(); }
+
+	void Poll()
+	{
+		m_server.Poll();
+		m_sink->Poll();
+	}
+
+private:
+	textmode::ServiceResult ProvideFrame()
+	{
+		auto& snapshot = m_screen.snapshot;
+		if (m_screen.animate) {
+			auto& cell = snapshot.cells[m_frames % snapshot.cells.size()];
+			cell.character = static_cast<uint8_t>('0' + m_frames % 10);
+		}
+		++m_frames;
+
+		textmode::ServiceResult result = {};
+		result.success  = true;
+		result.frame    = textmode::BuildAnsiFrame(snapshot, m_encoding);
+		result.snapshot = snapshot;
+		result.encoding = m_encoding;
+		return result;
+	}
+
+	Screen& m_screen;
+	EncodingOptions m_encoding = {};
+	uint64_t m_frames          = 0;
+	textmode::CommandProcessor m_processor;
+	std::shared_ptr<textmode::QueuedTypeActionSink> m_sink = {};
+	textmode::TextModeServer m_server;
+};
+
+struct Completion {
+	size_t client = 0;
+	size_t bytes  = 0;
+};
+
+class LoopbackTransport {
+public:
+	LoopbackTransport(Screen& screen, const size_t clients)
+	{
+		auto backend = std::make_unique<LoopbackBackend>();
+		m_backend    = backend.get();
+		m_rig        = std::make_unique<Rig>(screen, std::move(backend));
+		m_rig->Start(0);
+		for (size_t i = 0; i < clients; ++i) {
+			m_backend->Deliver(BackendEvent::Connected(Handle(i)));
+		}
+		m_rig->Poll();
+	}
+
+	~LoopbackTransport() { m_rig->Stop(); }
+
+	bool IsReady(size_t) const { return true; }
+
+	void Send(const size_t client, const std::string& request)
+	{
+		m_backend->Deliver(BackendEvent::Data(Handle(client), request));
+	}
+
+	void Pump() { m_rig->Poll(); }
+
+	std::vector<Completion> Completed()
+	{
+		std::vector<Completion> done = {};
+		for (const auto& reply : m_backend->TakeReplies()) {
+			done.push_back({static_cast<size_t>(reply.client - 1), reply.bytes});
+		}
+		return done;
+	}
+
+private:
+	static ClientHandle Handle(const size_t client) { return client + 1; }
+
+	LoopbackBackend* m_backend = nullptr;
+	std::unique_ptr<Rig> m_rig = {};
+};
+
+#if !defined(WIN32)
+
+class TcpTransport {
+public:
+	TcpTransport(Screen& screen, const size_t clients)
+	{
+		auto backend = std::make_unique<CountingBackend>(
+		        textmode::MakeNativeNetBackend());
+		m_backend = backend.get();
+		m_rig     = std::make_unique<Rig>(screen, std::move(backend));
+		for (auto candidate = FirstBenchPort; candidate <= LastBenchPort; ++candidate) {
+			if (m_rig->Start(candidate)) {
+				m_port = candidate;
+				break;
+			}
+		}
+		if (m_port == 0) {
+			return;
+		}
+
+		// One at a time, so the accept order maps handles to sockets
+		for (size_t i = 0; i < clients; ++i) {
+			const int peer = Connect();
+			if (peer < 0) {
+				return;
+			}
+			const auto deadline = Clock::now() + std::chrono::seconds(2);
+			while (m_backend->connected.size() <= i && Clock::now() < deadline) {
+				m_rig->Poll();
+			}
+			if (m_backend->connected.size() <= i) {
+				::close(peer);
+				return;
+			}
+			m_peers.push_back({peer, m_backend->connected[i], 0});
+		}
+	}
+
+	~TcpTransport()
+	{
+		for (const auto& peer : m_peers) {
+			::close(peer.fd);
+		}
+		m_rig->Stop();
+	}
+
+	bool IsReady(const size_t clients) const { return m_peers.size() == clients; }
+
+	void Send(const size_t client, const std::string& request)
+	{
+		const auto sent = ::send(m_peers[client].fd, request.data(), request.size(), 0);
+		(void)sent;
+	}
+
+	void Pump()
+	{
+		m_rig->Poll();
+		char buffer[65536];
+		m_done.clear();
+		for (size_t i = 0; i < m_peers.size(); ++i) {
+			auto& peer       = m_peers[i];
+			ssize_t received = 0;
+			while ((received = ::recv(peer.fd, buffer, sizeof(buffer), 0)) > 0) {
+				peer.received += static_cast<uint64_t>(received);
+			}
+			const auto owed = m_backend->owed[peer.handle];
+			if (owed > 0 && peer.received >= owed) {
+				m_done.push_back({i, static_cast<size_t>(owed)});
+				peer.received -= owed;
+				m_backend->owed[peer.handle] = 0;
+			}
+		}
+	}
+
+	std::vector<Completion> Completed() { return m_done; }
+
+private:
+	int Connect() const
+	{
+		const int peer          = ::socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in address     = {};
+		address.sin_family      = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port        = htons(m_port);
+		if (::connect(peer, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+			::close(peer);
+			return -1;
+		}
+		int enable = 1;
+		::setsockopt(peer, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+		::fcntl(peer, F_SETFL, ::fcntl(peer, F_GETFL, 0) | O_NONBLOCK);
+		return peer;
+	}
+
+	struct Peer {
+		int fd              = -1;
+		ClientHandle handle = 0;
+		uint64_t received   = 0;
+	};
+
+	CountingBackend* m_backend     = nullptr;
+	std::unique_ptr<Rig> m_rig     = {};
+	uint16_t m_port                = 0;
+	std::vector<Peer> m_peers      = {};
+	std::vector<Completion> m_done = {};
+};
+
+#endif
+
+double percentile(std::vector<uint32_t>& values, const double fraction)
+{
+	if (values.empty()) {
+		return 0.0;
+	}
+	const auto index = static_cast<size_t>(fraction *
+	                                       static_cast<double>(values.size() - 1));
+	std::nth_element(values.begin(),
+	                 values.begin() + static_cast<ptrdiff_t>(index),
+	                 values.end());
+	return values[index];
+}
+
+// Each client sends 'request' again as soon as the reply to its previous
+// one has arrived
+template <typename Transport>
+void BM_TextModeServer(benchmark::State& state, Screen* screen, const std::string request)
+{
+	const auto clients = static_cast<size_t>(state.range(0));
+
+	Transport transport(*screen, clients);
+	if (!transport.IsReady(clients)) {
+		state.SkipWithError("unable to connect the clients");
+		return;
+	}
+
+	std::vector<Clock::time_point> sent_at(clients, Clock::now());
+	for (size_t i = 0; i < clients; ++i) {
+		transport.Send(i, request);
+	}
+
+	std::vector<uint32_t> latencies_us = {};
+	int64_t replies = 0;
+	int64_t bytes   = 0;
+	for (auto _ : state) {
+		const auto target = replies + static_cast<int64_t>(clients);
+		while (replies < target) {
+			transport.Pump();
+			const auto now = Clock::now();
+			for (const auto& [client, size] : transport.Completed()) {
+				++replies;
+				bytes += static_cast<int64_t>(size);
+				latencies_us.push_back(static_cast<uint32_t>(
+				        std::chrono::duration_cast<std::chrono::microseconds>(
+				                now - sent_at[client])
+				                .count()));
+				sent_at[client] = now;
+				transport.Send(client, request);
+			}
+		}
+	}
+
+	state.SetItemsProcessed(replies);
+	state.counters["p50_us"] = percentile(latencies_us, 0.50);
+	state.counters["p99_us"] = percentile(latencies_us, 0.99);
+	state.counters["bytes"]  = static_cast<double>(bytes) /
+	                          static_cast<double>(std::max<int64_t>(replies, 1));
+}
+
+// Screens stay put for the benchmarks that point at them
+std::deque<Screen> server_screens = {};
+
+void register_server_benchmarks(Screen screen)
+{
+	auto& stored = server_screens.emplace_back(std::move(screen));
+
+	const auto add = [&](const char* transport, auto function) {
+		for (const auto& [verb, request] :
+		     {std::pair{"GET", "GET\n"}, std::pair{"TYPE", "TYPE \"dir\" Enter\n"}}) {
+			const auto name = std::string("BM_TextModeServer/") + transport +
+			                  "/" + verb + "/" + stored.name;
+			benchmark::RegisterBenchmark(name.c_str(), function, &stored, request)
+			        ->RangeMultiplier(4)
+			        ->Range(1, 256)
+			        ->UseRealTime()
+			        ->MeasureProcessCPUTime();
+		}
+	};
+	add("loopback", BM_TextModeServer<LoopbackTransport>);
+#if !defined(WIN32)
+	add("tcp", BM_TextModeServer<TcpTransport>);
+#endif
+}
+
+// A synthetic 80x25 screen that changes on every request
+const bool synthetic_screen_registered = [] {
+	register_server_benchmarks({"synthetic", make_screen(ScreenColumns, 25), true});
+	return true;
+}();
+
+} // namespace
+
+bool RegisterTextModeServerScreen(const std::string& path)
+{
+	std::ifstream file(path, std::ios::binary);
+	const std::string data((std::istreambuf_iterator<char>(file)),
+	                       std::istreambuf_iterator<char>());
+	const size_t row_bytes = ScreenColumns * 2;
+	if (data.size() < row_bytes) {
+		return false;
+	}
+
+	Screen screen    = {path, {}, false};
+	auto& snapshot   = screen.snapshot;
+	snapshot.columns = ScreenColumns;
+	snapshot.rows    = static_cast<uint16_t>(data.size() / row_bytes);
+	snapshot.cells.reserve(static_cast<size_t>(snapshot.columns) * snapshot.rows);
+	for (size_t i = 0; i + 1 < static_cast<size_t>(snapshot.rows) * row_bytes; i += 2) {
+		snapshot.cells.push_back({static_cast<uint8_t>(data[i]),
+		                          static_cast<uint8_t>(data[i + 1])});
+	}
+	register_server_benchmarks(std::move(screen));
+	return true;
+}
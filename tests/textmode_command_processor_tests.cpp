@@ -5,7 +5,10 @@
 #include "textmode_server/keyboard_processor.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -122,7 +125,110 @@ TEST_F(TextModeCommandProcessorTest, ProducesStats)
 
 	ASSERT_TRUE(response.ok);
 	EXPECT_EQ(response.payload,
-	          "requests=2 success=1 failures=1 keys_down=\n");
+	          "requests=2 success=1 failures=1 rejected=0 "
+	          "pending=0 peak_pending=0 bytes_sent=0 evicted=0 keys_down=\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, StatsReportsRejectedClients)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+	processor.SetRejectedClientsProvider([] { return uint64_t{3}; });
+
+	const auto response = processor.HandleCommand("STATS");
+
+	ASSERT_TRUE(response.ok);
+	EXPECT_NE(response.payload.find("rejected=3 "), std::string::npos);
+}
+
+TEST_F(TextModeCommandProcessorTest, StatsReportsQueueAndTransportTelemetry)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+	processor.SetQueueTelemetryProvider([] {
+		textmode::QueueTelemetry queue{};
+		queue.pending      = 2;
+		queue.peak_pending = 5;
+		return queue;
+	});
+	processor.SetTransportTelemetryProvider([] {
+		textmode::TransportTelemetry transport{};
+		transport.bytes_sent = 1234;
+		return transport;
+	});
+
+	ASSERT_TRUE(processor.HandleCommand("GET").ok);
+	const auto text = processor.HandleCommand("STATS");
+	ASSERT_TRUE(text.ok);
+	EXPECT_NE(text.payload.find("pending=2 peak_pending=5 bytes_sent=1234 "),
+	          std::string::npos)
+	        << text.payload;
+
+	const auto json = processor.HandleCommand("STATS JSON");
+	ASSERT_TRUE(json.ok);
+	EXPECT_EQ(json.payload.rfind("{\"requests\":1,", 0), 0u) << json.payload;
+	EXPECT_NE(json.payload.find("\"peak_pending\":5"), std::string::npos);
+	EXPECT_NE(json.payload.find("\"verbs\":{\"GET\":{\"count\":1,"), std::string::npos)
+	        << json.payload;
+	EXPECT_NE(json.payload.find("\"capture\":{\"count\":1,"), std::string::npos);
+	EXPECT_EQ(json.payload.back(), '\n');
+
+	EXPECT_EQ(processor.HandleCommand("STATS XML").payload,
+	          "ERR invalid STATS arguments\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, MetricsUsesOpenMetricsExposition)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+	processor.SetTransportTelemetryProvider([] {
+		textmode::TransportTelemetry transport{};
+		transport.bytes_sent = 1234;
+		transport.sessions   = 2;
+		return transport;
+	});
+
+	ASSERT_TRUE(processor.HandleCommand("GET").ok);
+	auto metrics = processor.HandleCommand("METRICS");
+	ASSERT_TRUE(metrics.ok);
+	EXPECT_NE(metrics.payload.find("# TYPE textmode_requests counter\n"), std::string::npos);
+	EXPECT_NE(metrics.payload.find("\ntextmode_requests_total 1\n"), std::string::npos);
+	EXPECT_NE(metrics.payload.find("\ntextmode_sessions 2\n"), std::string::npos);
+	EXPECT_NE(metrics.payload.find("\ntextmode_bytes_sent_total 1234\n"), std::string::npos);
+	EXPECT_NE(metrics.payload.find(
+	                  "textmode_command_duration_seconds_count{verb=\"GET\"} 1\n"),
+	          std::string::npos)
+	        << metrics.payload;
+	// Emulator health only shows up once something provides it
+	EXPECT_EQ(metrics.payload.find("dosbox_"), std::string::npos);
+	EXPECT_TRUE(metrics.payload.ends_with("\n# EOF\n"));
+
+	processor.SetEmulatorTelemetryProvider([] {
+		textmode::EmulatorTelemetry emulator{};
+		emulator.cycles_per_ms   = 3000;
+		emulator.ticks_scheduled = 510;
+		emulator.ticks_done      = 500;
+		emulator.counters        = {
+		        {"frames_dropped", "Frames the renderer skipped.", PerfKind::Counter, 7},
+		        {"mixer_queue_frames", "Mixed frames queued.", PerfKind::Gauge, 96},
+		};
+		return emulator;
+	});
+	metrics = processor.HandleCommand("METRICS");
+	EXPECT_NE(metrics.payload.find("\ndosbox_cpu_cycles_per_millisecond 3000\n"),
+	          std::string::npos);
+	EXPECT_NE(metrics.payload.find("\ndosbox_ticks_scheduled 510\n"), std::string::npos);
+	EXPECT_NE(metrics.payload.find("\ndosbox_ticks_done 500\n"), std::string::npos);
+	EXPECT_NE(metrics.payload.find("\ndosbox_frames_dropped_total 7\n"), std::string::npos);
+	EXPECT_NE(metrics.payload.find("# TYPE dosbox_mixer_queue_frames gauge\n"),
+	          std::string::npos);
+	EXPECT_NE(metrics.payload.find("\ndosbox_mixer_queue_frames 96\n"), std::string::npos);
+
+	// STATS JSON carries the same registry
+	EXPECT_NE(processor.HandleCommand("STATS JSON")
+	                  .payload.find("\"counters\":{\"frames_dropped\":7,"
+	                                "\"mixer_queue_frames\":96}"),
+	          std::string::npos);
+
+	EXPECT_EQ(processor.HandleCommand("METRICS JSON").payload,
+	          "ERR invalid METRICS arguments\n");
 }
 
 TEST_F(TextModeCommandProcessorTest, TypeFailsWithoutKeyboardHandler)
@@ -189,6 +295,82 @@ TEST_F(TextModeCommandProcessorTest, TypeDelegatesToActionSink)
 	EXPECT_EQ(sink_ptr->plan.actions[0].kind, TypeAction::Kind::Press);
 }
 
+TEST_F(TextModeCommandProcessorTest, MacroRunsTheStoredPlan)
+{
+	CommandProcessor processor([] { return MakeSuccess(); },
+	                          [](const std::string&) {
+		return CommandResponse{true, "OK\n"};
+	});
+	auto sink = std::make_unique<RecordingSink>();
+	auto* sink_ptr = sink.get();
+	processor.SetTypeActionSink(std::move(sink));
+
+	const auto keys_of = [](const TypeCommandPlan& plan) {
+		std::vector<std::string> keys;
+		for (const auto& action : plan.actions) {
+			keys.push_back(action.key);
+		}
+		return keys;
+	};
+
+	processor.HandleCommand("TYPE Enter \"ab\" 100ms Esc");
+	const auto typed = sink_ptr->plan;
+
+	const auto defined = processor.HandleCommand(
+	        "MACRO DEFINE login Enter \"ab\" 100ms Esc");
+	ASSERT_TRUE(defined.ok) << defined.payload;
+	EXPECT_EQ(defined.payload, "OK MACRO login actions=5\n");
+	sink_ptr->executed = false;
+
+	// Macros belong to the server, not the connection that defined them
+	ASSERT_TRUE(processor.HandleCommand("MACRO RUN login", CommandOrigin{7}).ok);
+	ASSERT_TRUE(sink_ptr->executed);
+	EXPECT_EQ(keys_of(sink_ptr->plan), keys_of(typed));
+	EXPECT_FALSE(sink_ptr->plan.request_frame);
+	EXPECT_EQ(sink_ptr->origin.client, 7u);
+
+	// Arguments are typed after the body, in the same plan
+	processor.HandleCommand("MACRO RUN login Tab GET 0,0,1,10");
+	auto expected = keys_of(typed);
+	expected.push_back("Tab");
+	expected.push_back("");
+	EXPECT_EQ(keys_of(sink_ptr->plan), expected);
+	EXPECT_TRUE(sink_ptr->plan.request_frame);
+	EXPECT_EQ(sink_ptr->plan.actions.back().kind, TypeAction::Kind::DelayFrames);
+	ASSERT_TRUE(sink_ptr->plan.region);
+	EXPECT_EQ(*sink_ptr->plan.region, (textmode::TextRegion{0, 0, 1, 10}));
+
+	// Redefining replaces the body
+	processor.HandleCommand("MACRO DEFINE login F1");
+	processor.HandleCommand("MACRO RUN login");
+	EXPECT_EQ(keys_of(sink_ptr->plan), std::vector<std::string>{"F1"});
+
+	ASSERT_TRUE(processor.HandleCommand("MACRO DELETE login").ok);
+	EXPECT_EQ(processor.HandleCommand("MACRO RUN login").payload,
+	          "ERR unknown macro\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, MacroRejectsBadArguments)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+
+	EXPECT_EQ(processor.HandleCommand("MACRO").payload,
+	          "ERR invalid MACRO arguments\n");
+	EXPECT_EQ(processor.HandleCommand("MACRO DEFINE menu").payload,
+	          "ERR invalid MACRO arguments\n");
+	EXPECT_EQ(processor.HandleCommand("MACRO DEFINE bad/name A").payload,
+	          "ERR invalid MACRO arguments\n");
+	EXPECT_EQ(processor.HandleCommand("MACRO define menu A").payload,
+	          "ERR invalid MACRO arguments\n");
+	EXPECT_EQ(processor.HandleCommand("MACRO DELETE menu").payload,
+	          "ERR unknown macro\n");
+
+	// Defining needs no keyboard, running does
+	ASSERT_TRUE(processor.HandleCommand("MACRO DEFINE menu A").ok);
+	EXPECT_EQ(processor.HandleCommand("MACRO RUN menu").payload,
+	          "ERR keyboard unavailable\n");
+}
+
 TEST_F(TextModeCommandProcessorTest, TypeRecognisesFrameDelayToken)
 {
 	CommandProcessor processor([] { return MakeSuccess(); },
@@ -503,6 +685,183 @@ TEST_F(TextModeCommandProcessorTest, PeekRejectsInvalidArguments)
 	EXPECT_EQ(response.payload, "ERR invalid PEEK arguments\n");
 }
 
+TEST_F(TextModeCommandProcessorTest, PeekVectorReadsAllRegionsInOneReply)
+{
+	std::vector<std::pair<uint32_t, uint32_t>> reads;
+	CommandProcessor processor([] { return MakeSuccess(); },
+	                          {},
+	                          {},
+	                          {},
+	                          [&](uint32_t offset, uint32_t length) {
+		                          reads.emplace_back(offset, length);
+		                          return textmode::MemoryAccessResult{
+		                                  true, std::vector<uint8_t>(length, 0xAB), ""};
+	                          });
+
+	const auto text = processor.HandleCommand("PEEKV 0x400:2,C000:0x10:1");
+	ASSERT_TRUE(text.ok) << text.payload;
+	EXPECT_EQ(text.payload,
+	          "address=0x00000400 data=ABAB\n"
+	          "address=0x000C0010 data=AB\n");
+	ASSERT_EQ(reads.size(), 2u);
+	EXPECT_EQ(reads[1], std::make_pair(0xC0010u, 1u));
+
+	const auto binary = processor.HandleCommand("PEEKV 0x400:2,0x500:1 BIN");
+	ASSERT_TRUE(binary.ok);
+	EXPECT_EQ(binary.payload, "PEEKV bytes=3\n\xAB\xAB\xAB");
+}
+
+TEST_F(TextModeCommandProcessorTest, PeekVectorRejectsInvalidArguments)
+{
+	CommandProcessor processor([] { return MakeSuccess(); },
+	                          {},
+	                          {},
+	                          {},
+	                          [](uint32_t, uint32_t length) {
+		                          return textmode::MemoryAccessResult{
+		                                  true, std::vector<uint8_t>(length, 0), ""};
+	                          });
+
+	for (const char* command : {"PEEKV",
+	                            "PEEKV 0x400",
+	                            "PEEKV 0x400:0",
+	                            "PEEKV 0x400:2,",
+	                            "PEEKV 0x400:2 HEX",
+	                            "PEEKV 0x0:16384,0x4000:1"}) {
+		const auto response = processor.HandleCommand(command);
+		EXPECT_FALSE(response.ok) << command;
+		EXPECT_EQ(response.payload, "ERR invalid PEEKV arguments\n") << command;
+	}
+}
+
+TEST_F(TextModeCommandProcessorTest, WatchMemoryPushesCoalescedChanges)
+{
+	std::vector<uint8_t> memory(0x20, 0x00);
+	CommandProcessor processor([] { return MakeSuccess(); },
+	                          {},
+	                          {},
+	                          {},
+	                          [&](uint32_t offset, uint32_t length) {
+		                          return textmode::MemoryAccessResult{
+		                                  true,
+		                                  {memory.begin() + offset,
+		                                   memory.begin() + offset + length},
+		                                  ""};
+	                          });
+
+	const CommandOrigin client{9};
+	ASSERT_TRUE(processor.HandleCommand("WATCHMEM 0x10:8,0x4:1", client).ok);
+
+	processor.SampleMemoryWatches(100);
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+
+	// Two writes to the same byte within one frame report only the net change
+	memory[0x11] = 0x05;
+	memory[0x11] = 0x07;
+	memory[0x12] = 0x08;
+	memory[0x15] = 0xFF;
+	memory[0x00] = 0x01; // not watched
+	processor.SampleMemoryWatches(116);
+
+	const auto pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_EQ(pushes[0].client, 9u);
+	EXPECT_EQ(pushes[0].payload,
+	          "MEMCHANGE tick=116 address=0x00000011 old=0000 new=0708\n"
+	          "MEMCHANGE tick=116 address=0x00000015 old=00 new=FF\n");
+
+	ASSERT_TRUE(processor.HandleCommand("UNWATCHMEM", client).ok);
+	memory[0x04] = 0x02;
+	processor.SampleMemoryWatches(132);
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+}
+
+TEST_F(TextModeCommandProcessorTest, WatchMemoryRejectsBadArguments)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+
+	EXPECT_EQ(processor.HandleCommand("WATCHMEM 0x10:8").payload,
+	          "ERR WATCHMEM requires a connection\n");
+	EXPECT_EQ(processor.HandleCommand("WATCHMEM 0x10", CommandOrigin{9}).payload,
+	          "ERR invalid WATCHMEM arguments\n");
+	EXPECT_EQ(processor.HandleCommand("WATCHMEM 0x10:8", CommandOrigin{9}).payload,
+	          "ERR memory access unavailable\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, EventsPushesSubscribedTypes)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+	EXPECT_FALSE(processor.HasEventSubscribers());
+
+	const CommandOrigin all{9};
+	const CommandOrigin programs{10};
+	ASSERT_TRUE(processor.HandleCommand("EVENTS", all).ok);
+	ASSERT_TRUE(processor.HandleCommand("EVENTS exec,exit", programs).ok);
+	EXPECT_TRUE(processor.HasEventSubscribers());
+
+	processor.PostEvent(100, "mode", "mode=0x13 width=320 height=200 graphics=1");
+	processor.PostEvent(120, "exec", "psp=0x0192 path=C:\\GAME.EXE");
+	processor.PostEvent(130, "prompt", "");
+
+	auto pushes = processor.CollectPushedFrames();
+	std::sort(pushes.begin(), pushes.end(), [](const auto& a, const auto& b) {
+		return a.client < b.client;
+	});
+	ASSERT_EQ(pushes.size(), 2u);
+	EXPECT_EQ(pushes[0].client, 9u);
+	EXPECT_EQ(pushes[0].payload,
+	          "EVENT tick=100 type=mode mode=0x13 width=320 height=200 graphics=1\n"
+	          "EVENT tick=120 type=exec psp=0x0192 path=C:\\GAME.EXE\n"
+	          "EVENT tick=130 type=prompt\n");
+	EXPECT_EQ(pushes[1].client, 10u);
+	EXPECT_EQ(pushes[1].payload,
+	          "EVENT tick=120 type=exec psp=0x0192 path=C:\\GAME.EXE\n");
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+
+	ASSERT_TRUE(processor.HandleCommand("EVENTS OFF", all).ok);
+	processor.ForgetClient(programs.client);
+	EXPECT_FALSE(processor.HasEventSubscribers());
+	processor.PostEvent(140, "exit", "psp=0x0192 name=GAME code=0 tsr=0");
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+}
+
+TEST_F(TextModeCommandProcessorTest, EventsCountsRecordsDroppedBetweenPolls)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+	ASSERT_TRUE(processor.HandleCommand("EVENTS beep", CommandOrigin{9}).ok);
+
+	for (uint64_t tick = 0; tick < 300; ++tick) {
+		processor.PostEvent(tick, "beep", "frequency=440");
+	}
+	const auto pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_EQ(std::count(pushes[0].payload.begin(), pushes[0].payload.end(), '\n'),
+	          257);
+	EXPECT_TRUE(pushes[0].payload.ends_with("EVENT tick=299 type=dropped count=44\n"))
+	        << pushes[0].payload;
+
+	// The allowance starts over once the records are sent
+	processor.PostEvent(300, "beep", "frequency=440");
+	const auto next = processor.CollectPushedFrames();
+	ASSERT_EQ(next.size(), 1u);
+	EXPECT_EQ(next[0].payload, "EVENT tick=300 type=beep frequency=440\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, EventsRejectsBadArguments)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+
+	EXPECT_EQ(processor.HandleCommand("EVENTS").payload,
+	          "ERR EVENTS requires a connection\n");
+	EXPECT_EQ(processor.HandleCommand("EVENTS frame", CommandOrigin{9}).payload,
+	          "ERR invalid EVENTS arguments\n");
+	EXPECT_EQ(processor.HandleCommand("EVENTS mode,", CommandOrigin{9}).payload,
+	          "ERR invalid EVENTS arguments\n");
+	EXPECT_EQ(processor.HandleCommand("EVENTS mode beep", CommandOrigin{9}).payload,
+	          "ERR invalid EVENTS arguments\n");
+	EXPECT_FALSE(processor.HasEventSubscribers());
+}
+
 TEST_F(TextModeCommandProcessorTest, DebugReadsConfiguredRegion)
 {
 	CommandProcessor processor([] { return MakeSuccess(); },
@@ -558,6 +917,95 @@ TEST_F(TextModeCommandProcessorTest, PokeWritesBytes)
 	EXPECT_EQ(observed, expected);
 }
 
+TEST_F(TextModeCommandProcessorTest, BatchRunsCommandsTogetherAtEnd)
+{
+	std::vector<std::string> events;
+	CommandProcessor processor(
+	        [&] {
+		        events.push_back("capture");
+		        return MakeSuccess();
+	        },
+	        [&](const std::string& command) {
+		        events.push_back(command);
+		        return CommandResponse{true, "OK\n"};
+	        },
+	        {},
+	        {},
+	        {},
+	        [&](uint32_t offset, const std::vector<uint8_t>& data) {
+		        events.push_back("poke " + std::to_string(offset));
+		        return textmode::MemoryWriteResult{true, data.size(), ""};
+	        });
+	auto sink = std::make_unique<RecordingSink>();
+	auto* sink_ptr = sink.get();
+	processor.SetTypeActionSink(std::move(sink));
+
+	const CommandOrigin client{9};
+	const auto begin = processor.HandleCommand("BATCH", client);
+	EXPECT_TRUE(begin.deferred);
+	for (const auto* line :
+	     {"POKE 0x2000 01", "TYPE A 100ms B", "", "GET", "STEP 5ms"}) {
+		const auto buffered = processor.HandleCommand(line, client);
+		EXPECT_TRUE(buffered.deferred) << line;
+		EXPECT_TRUE(buffered.payload.empty()) << line;
+	}
+	EXPECT_TRUE(events.empty());
+
+	// Another connection isn't held up
+	EXPECT_EQ(processor.HandleCommand("GET", CommandOrigin{10}).payload,
+	          "frame-raw\n");
+	events.clear();
+
+	const auto end = processor.HandleCommand("END", client);
+	EXPECT_FALSE(end.ok);
+	EXPECT_FALSE(end.deferred);
+	EXPECT_EQ(end.payload,
+	          "BATCH commands=4 failed=1\n"
+	          "OK\n"
+	          "OK\n"
+	          "frame-raw\n"
+	          "ERR STEP cannot wait in a BATCH\n"
+	          "END\n");
+
+	// Keys are typed at once, without going through the queue
+	EXPECT_FALSE(sink_ptr->executed);
+	const std::vector<std::string> expected = {
+	        "poke 8192", "PRESS A", "PRESS B", "capture"};
+	EXPECT_EQ(events, expected);
+
+	// The batch is over
+	EXPECT_EQ(processor.HandleCommand("GET", client).payload, "frame-raw\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, BatchRejectsMisuse)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+	const CommandOrigin client{9};
+
+	EXPECT_EQ(processor.HandleCommand("BATCH").payload,
+	          "ERR BATCH requires a connection\n");
+	EXPECT_EQ(processor.HandleCommand("END", client).payload,
+	          "ERR END without BATCH\n");
+	EXPECT_EQ(processor.HandleCommand("BATCH now", client).payload,
+	          "ERR invalid BATCH arguments\n");
+
+	processor.HandleCommand("BATCH", client);
+	processor.HandleCommand("BATCH", client);
+	EXPECT_EQ(processor.HandleCommand("END", client).payload,
+	          "BATCH commands=1 failed=1\nERR BATCH cannot nest\nEND\n");
+
+	processor.HandleCommand("BATCH", client);
+	for (int i = 0; i < 300; ++i) {
+		processor.HandleCommand("GET", client);
+	}
+	EXPECT_EQ(processor.HandleCommand("END", client).payload, "ERR BATCH too long\n");
+
+	// A connection that goes away takes its open batch with it
+	processor.HandleCommand("BATCH", client);
+	processor.ForgetClient(client.client);
+	EXPECT_EQ(processor.HandleCommand("GET", client).payload, "frame-raw\n");
+}
+
 TEST_F(TextModeCommandProcessorTest, PokeValidatesHexInput)
 {
 	CommandProcessor processor([] { return MakeSuccess(); });
@@ -567,4 +1015,805 @@ TEST_F(TextModeCommandProcessorTest, PokeValidatesHexInput)
 	EXPECT_EQ(response.payload, "ERR invalid POKE data\n");
 }
 
+ServiceResult MakeSnapshotResult(const char first_char)
+{
+	textmode::Snapshot snapshot{};
+	snapshot.columns = 2;
+	snapshot.rows    = 1;
+	snapshot.cells   = {textmode::TextCell{static_cast<uint8_t>(first_char), 0x07},
+	                    textmode::TextCell{static_cast<uint8_t>('x'), 0x07}};
+
+	ServiceResult result{true, "full-frame\n", ""};
+	result.snapshot                 = snapshot;
+	result.encoding.show_attributes = false;
+	result.encoding.sentinel        = "s";
+	return result;
+}
+
+TEST_F(TextModeCommandProcessorTest, DiffSendsDeltaAgainstPreviousFrame)
+{
+	char first_char = 'a';
+	CommandProcessor processor([&] { return MakeSnapshotResult(first_char); });
+
+	const CommandOrigin client{42};
+	const auto initial = processor.HandleCommand("DIFF", client);
+	ASSERT_TRUE(initial.ok);
+	EXPECT_NE(initial.payload.find("sMETA diff=full\n"), std::string::npos);
+
+	const auto unchanged = processor.HandleCommand("DIFF", client);
+	ASSERT_TRUE(unchanged.ok);
+	EXPECT_NE(unchanged.payload.find("sMETA runs=0\n"), std::string::npos);
+
+	first_char = 'b';
+	const auto changed = processor.HandleCommand("DIFF", client);
+	ASSERT_TRUE(changed.ok);
+	EXPECT_NE(changed.payload.find("sRUN 0,0,1\nb\n"), std::string::npos)
+	        << changed.payload;
+}
+
+TEST_F(TextModeCommandProcessorTest, DiffBaselinesArePerClient)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+
+	processor.HandleCommand("GET", CommandOrigin{1});
+	const auto other = processor.HandleCommand("DIFF", CommandOrigin{2});
+	EXPECT_NE(other.payload.find("sMETA diff=full\n"), std::string::npos);
+
+	const auto same = processor.HandleCommand("DIFF", CommandOrigin{1});
+	EXPECT_NE(same.payload.find("sMETA diff=delta\n"), std::string::npos);
+
+	processor.ForgetClient(1);
+	const auto forgotten = processor.HandleCommand("DIFF", CommandOrigin{1});
+	EXPECT_NE(forgotten.payload.find("sMETA diff=full\n"), std::string::npos);
+}
+
+TEST_F(TextModeCommandProcessorTest, TypeRecognisesDiffToken)
+{
+	CommandProcessor processor([] { return MakeSuccess(); },
+	                          [](const std::string&) {
+		return CommandResponse{true, "OK\n"};
+	});
+	auto sink = std::make_unique<RecordingSink>();
+	auto* sink_ptr = sink.get();
+	processor.SetTypeActionSink(std::move(sink));
+
+	processor.HandleCommand("TYPE A DIFF");
+
+	ASSERT_TRUE(sink_ptr->executed);
+	EXPECT_TRUE(sink_ptr->plan.request_frame);
+	EXPECT_TRUE(sink_ptr->plan.request_diff);
+}
+
+TEST_F(TextModeCommandProcessorTest, WatchRequiresConnectionAndValidInterval)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+
+	const auto local = processor.HandleCommand("WATCH");
+	EXPECT_FALSE(local.ok);
+	EXPECT_EQ(local.payload, "ERR WATCH requires a connection\n");
+
+	const auto invalid = processor.HandleCommand("WATCH soon", CommandOrigin{3});
+	EXPECT_FALSE(invalid.ok);
+	EXPECT_EQ(invalid.payload, "ERR invalid WATCH arguments\n");
+
+	const auto ok = processor.HandleCommand("WATCH 250 DIFF", CommandOrigin{3});
+	ASSERT_TRUE(ok.ok);
+	EXPECT_EQ(ok.payload, "OK\n");
+
+	const auto pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_EQ(pushes[0].client, 3u);
+	EXPECT_NE(pushes[0].payload.find("sMETA diff=full\n"), std::string::npos);
+
+	// Rate limited: nothing else is due within the interval
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+}
+
+TEST_F(TextModeCommandProcessorTest, CongestedWatchersSkipToTheNewestFrame)
+{
+	char first_char = 'a';
+	CommandProcessor processor([&] { return MakeSnapshotResult(first_char); });
+
+	ASSERT_TRUE(processor.HandleCommand("WATCH 0 DIFF", CommandOrigin{3}).ok);
+	ASSERT_EQ(processor.CollectPushedFrames().size(), 1u);
+
+	processor.SetClientCongested(3, true);
+	first_char = 'b';
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+	first_char = 'c';
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+
+	// One delta from the last frame the client received to the newest
+	processor.SetClientCongested(3, false);
+	const auto pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_NE(pushes[0].payload.find("sMETA diff=delta\n"), std::string::npos);
+	EXPECT_NE(pushes[0].payload.find("sRUN 0,0,1\nc\n"), std::string::npos)
+	        << pushes[0].payload;
+}
+
+TEST_F(TextModeCommandProcessorTest, GetBinReturnsBinaryFrame)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+
+	const auto response = processor.HandleCommand("GET BIN");
+	ASSERT_TRUE(response.ok);
+	ASSERT_EQ(response.payload.size(), textmode::BinaryFrameHeaderSize + 4);
+	EXPECT_EQ(response.payload.substr(0, 4), "TMBF");
+	EXPECT_EQ(response.payload.substr(textmode::BinaryFrameHeaderSize), "a\x07x\x07");
+
+	CommandProcessor raw_only([] { return MakeSuccess(); });
+	const auto unavailable = raw_only.HandleCommand("GET RLE");
+	EXPECT_FALSE(unavailable.ok);
+	EXPECT_EQ(unavailable.payload, "ERR binary frames unavailable\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, GetRegionEncodesOnlyThatRectangle)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+
+	const auto response = processor.HandleCommand("GET 0,1,1,5");
+	ASSERT_TRUE(response.ok);
+	EXPECT_NE(response.payload.find("sMETA cols=1\n"), std::string::npos)
+	        << response.payload;
+	EXPECT_NE(response.payload.find("sMETA region=0,1,1,1\n"), std::string::npos);
+	EXPECT_TRUE(response.payload.ends_with("sPAYLOAD\nx\n")) << response.payload;
+
+	const auto outside = processor.HandleCommand("GET 1,0,1,1");
+	EXPECT_FALSE(outside.ok);
+	EXPECT_EQ(outside.payload, "ERR region outside screen\n");
+
+	const auto invalid = processor.HandleCommand("GET 0,x,1,1");
+	EXPECT_FALSE(invalid.ok);
+	EXPECT_EQ(invalid.payload, "ERR invalid GET region\n");
+
+	// A region request leaves the DIFF baseline untouched
+	const auto diff = processor.HandleCommand("DIFF");
+	EXPECT_NE(diff.payload.find("sMETA diff=full\n"), std::string::npos);
+}
+
+TEST_F(TextModeCommandProcessorTest, GetGfxTextUsesGraphicsTextProvider)
+{
+	CommandProcessor processor([] { return MakeSuccess(); });
+
+	const auto unavailable = processor.HandleCommand("GET GFXTEXT");
+	EXPECT_FALSE(unavailable.ok);
+	EXPECT_EQ(unavailable.payload, "ERR graphics text unavailable\n");
+
+	processor.SetGraphicsTextProvider(
+	        [] { return ServiceResult{true, "graphics-text\n", ""}; });
+	const auto response = processor.HandleCommand("GET GFXTEXT");
+	ASSERT_TRUE(response.ok);
+	EXPECT_EQ(response.payload, "graphics-text\n");
+
+	processor.SetGraphicsTextProvider([] { return MakeFailure(); });
+	const auto failure = processor.HandleCommand("GET GFXTEXT");
+	EXPECT_FALSE(failure.ok);
+	EXPECT_EQ(failure.payload, "ERR boom\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, TypeAcceptsRegionAfterGet)
+{
+	CommandProcessor processor([] { return MakeSuccess(); },
+	                          [](const std::string&) {
+		return CommandResponse{true, "OK\n"};
+	});
+	auto sink = std::make_unique<RecordingSink>();
+	auto* sink_ptr = sink.get();
+	processor.SetTypeActionSink(std::move(sink));
+
+	processor.HandleCommand("TYPE A GET 24,0,1,80");
+
+	ASSERT_TRUE(sink_ptr->executed);
+	EXPECT_TRUE(sink_ptr->plan.request_frame);
+	ASSERT_TRUE(sink_ptr->plan.region);
+	EXPECT_EQ(*sink_ptr->plan.region, (textmode::TextRegion{24, 0, 1, 80}));
+}
+
+TEST_F(TextModeCommandProcessorTest, GetIfChangedSkipsUnchangedFrames)
+{
+	int captures        = 0;
+	uint64_t generation = 7;
+	CommandProcessor processor([&] {
+		++captures;
+		auto result       = MakeSnapshotResult('a');
+		result.generation = generation;
+		return result;
+	});
+	processor.SetFrameGenerationProvider([&] { return generation; });
+
+	const auto unchanged = processor.HandleCommand("GET IFCHANGED 7");
+	ASSERT_TRUE(unchanged.ok);
+	EXPECT_EQ(unchanged.payload, "UNCHANGED generation=7\n");
+	EXPECT_EQ(captures, 0);
+
+	generation = 8;
+	const auto changed = processor.HandleCommand("GET IFCHANGED 7");
+	ASSERT_TRUE(changed.ok);
+	EXPECT_EQ(captures, 1);
+	EXPECT_NE(changed.payload.find("sMETA generation=8\n"), std::string::npos);
+	EXPECT_NE(changed.payload.find("sPAYLOAD\nax\n"), std::string::npos);
+}
+
+class RecordingWaitSink : public textmode::ITypeActionSink {
+public:
+	CommandResponse Execute(const textmode::TypeCommandPlan&, const CommandOrigin&,
+	                        const KeyboardHandler&, const FrameProvider&,
+	                        CompletionCallback) override
+	{
+		return {true, "OK\n"};
+	}
+
+	CommandResponse ExecuteWait(const textmode::WaitPlan& wait_plan,
+	                            const CommandOrigin&, const FrameProvider&,
+	                            CompletionCallback) override
+	{
+		plan = wait_plan;
+		CommandResponse response{true, ""};
+		response.deferred = true;
+		return response;
+	}
+
+	std::optional<textmode::WaitPlan> plan = {};
+};
+
+TEST_F(TextModeCommandProcessorTest, WaitForRepliesImmediatelyWhenMatched)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('C'); });
+
+	const auto literal = processor.HandleCommand("WAITFOR \"Cx\"", CommandOrigin{3});
+	ASSERT_TRUE(literal.ok);
+	EXPECT_EQ(literal.payload, "full-frame\n");
+
+	const auto regex = processor.HandleCommand("WAITFOR /^C.$/ 0,0,1,2 500",
+	                                           CommandOrigin{3});
+	ASSERT_TRUE(regex.ok);
+	EXPECT_EQ(regex.payload, "full-frame\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, WaitForDefersUntilMatch)
+{
+	char first_char = 'a';
+	CommandProcessor processor([&] { return MakeSnapshotResult(first_char); });
+	auto sink = std::make_shared<RecordingWaitSink>();
+	processor.SetTypeActionSink(sink);
+
+	const auto response = processor.HandleCommand("WAITFOR \"C:\\>\" 0,0,1,1 2500",
+	                                              CommandOrigin{3});
+	ASSERT_TRUE(response.deferred);
+	ASSERT_TRUE(sink->plan.has_value());
+	EXPECT_EQ(sink->plan->timeout, std::chrono::milliseconds(2500));
+
+	const auto plain = processor.HandleCommand("WAITFOR \"b\" 0,0,1,1", CommandOrigin{3});
+	ASSERT_TRUE(plain.deferred);
+	first_char = 'b';
+	EXPECT_TRUE(sink->plan->matches(*MakeSnapshotResult(first_char).snapshot));
+	// Region limits the match to the first cell
+	EXPECT_FALSE(sink->plan->matches(*MakeSnapshotResult('x').snapshot));
+}
+
+TEST_F(TextModeCommandProcessorTest, WaitForRejectsBadArguments)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+
+	EXPECT_EQ(processor.HandleCommand("WAITFOR", CommandOrigin{3}).payload,
+	          "ERR invalid WAITFOR arguments\n");
+	EXPECT_EQ(processor.HandleCommand("WAITFOR \"open", CommandOrigin{3}).payload,
+	          "ERR invalid WAITFOR arguments\n");
+	EXPECT_EQ(processor.HandleCommand("WAITFOR /(/", CommandOrigin{3}).payload,
+	          "ERR invalid WAITFOR pattern\n");
+	EXPECT_EQ(processor.HandleCommand("WAITFOR \"z\" 1,2", CommandOrigin{3}).payload,
+	          "ERR invalid WAITFOR region\n");
+	EXPECT_EQ(processor.HandleCommand("WAITFOR \"z\" 700000", CommandOrigin{3}).payload,
+	          "ERR invalid WAITFOR arguments\n");
+	EXPECT_EQ(processor.HandleCommand("WAITFOR \"z\"").payload,
+	          "ERR WAITFOR requires a connection\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, GetIfChangedRejectsBadGeneration)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+
+	for (const auto* command : {"GET IFCHANGED", "GET IFCHANGED x", "GET IFCHANGED -1"}) {
+		const auto response = processor.HandleCommand(command);
+		EXPECT_FALSE(response.ok) << command;
+		EXPECT_EQ(response.payload, "ERR invalid IFCHANGED generation\n");
+	}
+}
+
+TEST_F(TextModeCommandProcessorTest, SaveStateVerbsUseHandlers)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+
+	EXPECT_EQ(processor.HandleCommand("SAVESTATE one").payload,
+	          "ERR save-states unavailable\n");
+
+	std::vector<std::string> saved;
+	processor.SetSaveStateHandlers(
+	        [&](const std::string& slot) {
+		        saved.push_back(slot);
+		        return textmode::SaveStateResult{true, "", 1234};
+	        },
+	        [&](const std::string& slot) {
+		        const bool known = std::find(saved.begin(), saved.end(), slot) !=
+		                           saved.end();
+		        return textmode::SaveStateResult{known, known ? "" : "unknown save-state slot"};
+	        });
+
+	const auto save = processor.HandleCommand("SAVESTATE one");
+	ASSERT_TRUE(save.ok);
+	EXPECT_EQ(save.payload, "OK SAVESTATE one bytes=1234\n");
+	EXPECT_EQ(saved, std::vector<std::string>{"one"});
+
+	EXPECT_EQ(processor.HandleCommand("SAVESTATE").payload,
+	          "ERR invalid SAVESTATE arguments\n");
+	EXPECT_EQ(processor.HandleCommand("LOADSTATE two").payload,
+	          "ERR unknown save-state slot\n");
+
+	// A restore invalidates every DIFF baseline
+	const CommandOrigin client{5};
+	processor.HandleCommand("DIFF", client);
+	const auto load = processor.HandleCommand("LOADSTATE one");
+	ASSERT_TRUE(load.ok);
+	EXPECT_EQ(load.payload, "OK LOADSTATE one\n");
+	const auto diff = processor.HandleCommand("DIFF", client);
+	EXPECT_NE(diff.payload.find("sMETA diff=full\n"), std::string::npos);
+}
+
+TEST_F(TextModeCommandProcessorTest, CheckpointVerbsUseHandlers)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+
+	EXPECT_EQ(processor.HandleCommand("CHECKPOINT").payload,
+	          "ERR checkpoints unavailable\n");
+
+	uint32_t rewound_to = 0;
+	processor.SetCheckpointHandlers(
+	        [] { return textmode::CheckpointResult{true, "", 3, 12, 53248}; },
+	        [&](const uint32_t id) {
+		        rewound_to = id;
+		        return textmode::CheckpointResult{id == 3, id == 3 ? "" : "unknown checkpoint"};
+	        });
+
+	const auto take = processor.HandleCommand("CHECKPOINT");
+	ASSERT_TRUE(take.ok);
+	EXPECT_EQ(take.payload, "OK CHECKPOINT id=3 pages=12 bytes=53248\n");
+
+	EXPECT_EQ(processor.HandleCommand("CHECKPOINT now").payload,
+	          "ERR invalid CHECKPOINT arguments\n");
+	EXPECT_EQ(processor.HandleCommand("REWIND").payload,
+	          "ERR invalid REWIND arguments\n");
+	EXPECT_EQ(processor.HandleCommand("REWIND 3x").payload,
+	          "ERR invalid REWIND arguments\n");
+	EXPECT_EQ(processor.HandleCommand("REWIND 4").payload, "ERR unknown checkpoint\n");
+
+	// Like a restore, a rewind invalidates every DIFF baseline
+	const CommandOrigin client{5};
+	processor.HandleCommand("DIFF", client);
+	const auto rewind = processor.HandleCommand("REWIND 3");
+	ASSERT_TRUE(rewind.ok);
+	EXPECT_EQ(rewind.payload, "OK REWIND 3\n");
+	EXPECT_EQ(rewound_to, 3u);
+	const auto diff = processor.HandleCommand("DIFF", client);
+	EXPECT_NE(diff.payload.find("sMETA diff=full\n"), std::string::npos);
+}
+
+TEST_F(TextModeCommandProcessorTest, ClonePassesListenAddress)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+
+	EXPECT_EQ(processor.HandleCommand("CLONE port=6001").payload,
+	          "ERR CLONE unavailable\n");
+
+	std::vector<textmode::CloneRequest> requests;
+	processor.SetCloneHandler([&](const textmode::CloneRequest& request) {
+		requests.push_back(request);
+		if (request.port == 6002) {
+			return textmode::CloneResult{false, "fork failed", -1};
+		}
+		return textmode::CloneResult{true, "", 4321};
+	});
+
+	EXPECT_EQ(processor.HandleCommand("CLONE port=6001").payload,
+	          "OK CLONE pid=4321\n");
+	EXPECT_EQ(processor.HandleCommand("CLONE socket=/tmp/clone.sock").payload,
+	          "OK CLONE pid=4321\n");
+	EXPECT_EQ(processor.HandleCommand("CLONE port=6002").payload,
+	          "ERR fork failed\n");
+	ASSERT_EQ(requests.size(), 3u);
+	EXPECT_EQ(requests[0].port, 6001);
+	EXPECT_TRUE(requests[0].socket_path.empty());
+	EXPECT_EQ(requests[1].socket_path, "/tmp/clone.sock");
+
+	for (const auto* command : {"CLONE", "CLONE port=80", "CLONE port=x", "CLONE socket="}) {
+		EXPECT_FALSE(processor.HandleCommand(command).ok) << command;
+	}
+	EXPECT_EQ(requests.size(), 3u);
+}
+
+TEST_F(TextModeCommandProcessorTest, StepRepliesOnceGrantedTicksHaveRun)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); });
+	const CommandOrigin origin{7, 3};
+
+	EXPECT_EQ(processor.HandleCommand("STEP 10ms", origin).payload,
+	          "ERR lockstep unavailable\n");
+
+	uint64_t clock = 100;
+	uint64_t owed  = 100;
+	std::vector<textmode::StepRequest> requests;
+	processor.SetStepHandlers(
+	        [&](const textmode::StepRequest& request) {
+		        requests.push_back(request);
+		        const auto ticks = request.frames ? request.amount * 14 : request.amount;
+		        owed += ticks;
+		        return textmode::StepResult{true, "", ticks, owed};
+	        },
+	        [&] { return clock; });
+
+	const auto response = processor.HandleCommand("STEP 10ms", origin);
+	EXPECT_TRUE(response.ok);
+	EXPECT_TRUE(response.deferred);
+	EXPECT_TRUE(processor.HandleCommand("STEP 2Frames", origin).deferred);
+	ASSERT_EQ(requests.size(), 2u);
+	EXPECT_FALSE(requests[0].frames);
+	EXPECT_TRUE(requests[1].frames);
+	EXPECT_EQ(requests[1].amount, 2u);
+
+	clock = 109;
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+
+	clock = 110;
+	auto pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_EQ(pushes[0].client, 7u);
+	EXPECT_EQ(pushes[0].payload, "#3 OK STEP ticks=10\n");
+
+	clock  = 200;
+	pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_EQ(pushes[0].payload, "#3 OK STEP ticks=28\n");
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+
+	for (const auto* command : {"STEP", "STEP 0ms", "STEP 10", "STEP 10s", "STEP -1ms",
+	                            "STEP 10ms 5", "STEP 3600001ms"}) {
+		EXPECT_FALSE(processor.HandleCommand(command, origin).ok) << command;
+	}
+	EXPECT_EQ(processor.HandleCommand("STEP 10ms").payload,
+	          "ERR STEP requires a connection\n");
+	EXPECT_EQ(requests.size(), 2u);
+
+	// Steps of a client that left are dropped rather than replied to
+	EXPECT_TRUE(processor.HandleCommand("STEP 5ms", origin).deferred);
+	processor.ForgetClient(7);
+	clock = 1000;
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+}
+
+TEST_F(TextModeCommandProcessorTest, TurboDisengagesOnceTheScreenMatches)
+{
+	char first_char = 'a';
+	CommandProcessor processor([&] { return MakeSnapshotResult(first_char); });
+	const CommandOrigin origin{5};
+
+	uint64_t clock = 1000;
+	std::vector<bool> engaged;
+	processor.SetTurboHandlers(
+	        [&](const bool engage) {
+		        engaged.push_back(engage);
+		        return true;
+	        },
+	        [&] { return clock; });
+
+	EXPECT_EQ(processor.HandleCommand("TURBO UNTIL \"ax\"", origin).payload,
+	          "OK TURBO ticks=0\n");
+	EXPECT_TRUE(engaged.empty());
+
+	ASSERT_TRUE(processor.HandleCommand("TURBO UNTIL /^C/ 0,0,1,1", origin).deferred);
+	EXPECT_EQ(processor.HandleCommand("TURBO FOR 10", CommandOrigin{6}).payload,
+	          "ERR TURBO already active\n");
+	ASSERT_EQ(engaged, std::vector<bool>{true});
+
+	clock = 1500;
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+
+	first_char = 'C';
+	clock      = 4000;
+	auto pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_EQ(pushes[0].client, 5u);
+	EXPECT_EQ(pushes[0].payload, "OK TURBO ticks=3000\n");
+	EXPECT_EQ(engaged, (std::vector<bool>{true, false}));
+
+	ASSERT_TRUE(processor.HandleCommand("TURBO FOR 250", CommandOrigin{6, 9}).deferred);
+	clock  = 4250;
+	pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_EQ(pushes[0].payload, "#9 OK TURBO ticks=250\n");
+
+	ASSERT_TRUE(processor.HandleCommand("TURBO FOR 250", origin).deferred);
+	EXPECT_EQ(processor.HandleCommand("TURBO OFF", CommandOrigin{6}).payload, "OK\n");
+	pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_EQ(pushes[0].payload, "ERR TURBO cancelled\n");
+	EXPECT_FALSE(engaged.back());
+}
+
+TEST_F(TextModeCommandProcessorTest, TurboWatchesMemoryValues)
+{
+	std::vector<uint8_t> memory(0x20);
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); },
+	                           {},
+	                           {},
+	                           {},
+	                           [&](uint32_t offset, uint32_t length) {
+		                           return textmode::MemoryAccessResult{
+		                                   true,
+		                                   {memory.begin() + offset,
+		                                    memory.begin() + offset + length},
+		                                   ""};
+	                           });
+	EXPECT_EQ(processor.HandleCommand("TURBO FOR 10", CommandOrigin{5}).payload,
+	          "ERR TURBO unavailable\n");
+
+	bool engaged = false;
+	processor.SetTurboHandlers(
+	        [&](const bool engage) {
+		        engaged = engage;
+		        return true;
+	        },
+	        [] { return uint64_t{0}; });
+
+	// A value above 0xFF compares a little-endian word
+	ASSERT_TRUE(processor.HandleCommand("TURBO UNTIL mem 1:0==0x1234", CommandOrigin{5}).deferred);
+	EXPECT_TRUE(engaged);
+	memory[0x10] = 0x34;
+	EXPECT_TRUE(processor.CollectPushedFrames().empty());
+	memory[0x11] = 0x12;
+	const auto pushes = processor.CollectPushedFrames();
+	ASSERT_EQ(pushes.size(), 1u);
+	EXPECT_EQ(pushes[0].payload, "OK TURBO ticks=0\n");
+	EXPECT_FALSE(engaged);
+
+	// A client that leaves takes its TURBO with it
+	ASSERT_TRUE(processor.HandleCommand("TURBO UNTIL mem 0x12==7", CommandOrigin{5}).deferred);
+	processor.ForgetClient(5);
+	EXPECT_FALSE(engaged);
+
+	for (const auto* command : {"TURBO", "TURBO FOR", "TURBO FOR 0", "TURBO FOR x",
+	                            "TURBO UNTIL mem 0x10", "TURBO UNTIL mem 0x10==",
+	                            "TURBO UNTIL mem 0x10==1 5 6", "TURBO UNTIL \"open",
+	                            "TURBO SOMETIMES"}) {
+		EXPECT_FALSE(processor.HandleCommand(command, CommandOrigin{5}).ok) << command;
+	}
+	EXPECT_EQ(processor.HandleCommand("TURBO FOR 10").payload,
+	          "ERR TURBO requires a connection\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, PasteQueuesTextOrFallsBackToKeystrokes)
+{
+	std::vector<std::string> keys;
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); },
+	                           [&](const std::string& command) {
+		                           keys.push_back(command);
+		                           return textmode::CommandResponse{true, "OK\n"};
+	                           });
+	EXPECT_EQ(processor.HandleCommand("PASTE \"dir\"").payload, "ERR PASTE unavailable\n");
+
+	std::vector<std::string> pasted;
+	bool hooked = false;
+	processor.SetPasteHandler([&](const std::string& text) {
+		pasted.push_back(text);
+		return textmode::PasteResult{true, "", hooked};
+	});
+
+	EXPECT_EQ(processor.HandleCommand("PASTE \"dir /w\\n\" \"echo \\\"hi\\\"\\t\"").payload,
+	          "OK PASTE chars=17 via=buffer\n");
+	ASSERT_EQ(pasted.size(), 1u);
+	EXPECT_EQ(pasted[0], "dir /w\recho \"hi\"\t");
+	EXPECT_TRUE(keys.empty());
+
+	// A program with its own INT 9 handler only sees real keystrokes
+	hooked = true;
+	EXPECT_EQ(processor.HandleCommand("PASTE \"Ab\"").payload,
+	          "OK PASTE chars=2 via=keys\n");
+	EXPECT_FALSE(keys.empty());
+
+	for (const auto* command : {"PASTE", "PASTE dir", "PASTE \"open", "PASTE \"\"",
+	                            "PASTE \"a\"b", "PASTE \"\x01\""}) {
+		EXPECT_FALSE(processor.HandleCommand(command).ok) << command;
+	}
+	EXPECT_EQ(pasted.size(), 2u);
+}
+
+TEST_F(TextModeCommandProcessorTest, GetImageDefersToTheFrameHandler)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); },
+	                           [](const std::string&) {
+		                           return textmode::CommandResponse{true, "OK\n"};
+	                           });
+	const textmode::CommandOrigin origin{9};
+	EXPECT_EQ(processor.HandleCommand("GETIMG", origin).payload,
+	          "ERR GETIMG unavailable\n");
+
+	std::vector<textmode::ImageRequest> requests;
+	processor.SetImageHandler([&](const textmode::CommandOrigin& from,
+	                              const textmode::ImageRequest& request) {
+		EXPECT_EQ(from.client, 9u);
+		requests.push_back(request);
+		return textmode::ImageResult{true, ""};
+	});
+
+	const auto response = processor.HandleCommand("GETIMG", origin);
+	EXPECT_TRUE(response.ok);
+	EXPECT_TRUE(response.deferred);
+	EXPECT_TRUE(processor.HandleCommand("GETIMG qoi 3", origin).deferred);
+	ASSERT_EQ(requests.size(), 2u);
+	EXPECT_EQ(requests[0].scale, 1);
+	EXPECT_EQ(requests[0].format, textmode::ImageFormat::Png);
+	EXPECT_EQ(requests[1].scale, 3);
+	EXPECT_EQ(requests[1].format, textmode::ImageFormat::Qoi);
+
+	EXPECT_EQ(processor.HandleCommand("GETIMG").payload,
+	          "ERR GETIMG requires a connection\n");
+	for (const auto* command : {"GETIMG 0", "GETIMG 5", "GETIMG 2 2", "GETIMG raw png",
+	                            "GETIMG bmp"}) {
+		EXPECT_EQ(processor.HandleCommand(command, origin).payload,
+		          "ERR invalid GETIMG arguments\n")
+		        << command;
+	}
+	EXPECT_EQ(requests.size(), 2u);
+}
+
+TEST_F(TextModeCommandProcessorTest, ProfileReturnsFoldedStacks)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); },
+	                           [](const std::string&) {
+		                           return textmode::CommandResponse{true, "OK\n"};
+	                           });
+	EXPECT_EQ(processor.HandleCommand("PROFILE START").payload,
+	          "ERR PROFILE unavailable\n");
+
+	bool running = false;
+	processor.SetProfileHandlers(
+	        [&] { return !std::exchange(running, true); },
+	        [&] {
+		        textmode::ProfileReport report = {};
+		        if (!std::exchange(running, false)) {
+			        report.error = "PROFILE not running";
+			        return report;
+		        }
+		        report.success = true;
+		        report.samples = 3;
+		        report.folded  = "normal;GAME;CS=1000;1000:00000010 3\n";
+		        return report;
+	        });
+
+	EXPECT_EQ(processor.HandleCommand("PROFILE START").payload, "OK\n");
+	EXPECT_EQ(processor.HandleCommand("PROFILE START").payload,
+	          "ERR PROFILE already running\n");
+	EXPECT_EQ(processor.HandleCommand("PROFILE STOP").payload,
+	          "PROFILE samples=3 bytes=36\n"
+	          "normal;GAME;CS=1000;1000:00000010 3\n");
+	EXPECT_EQ(processor.HandleCommand("PROFILE STOP").payload,
+	          "ERR PROFILE not running\n");
+	EXPECT_EQ(processor.HandleCommand("PROFILE").payload,
+	          "ERR invalid PROFILE arguments\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, MemoryReportsRegions)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); },
+	                           [](const std::string&) {
+		                           return textmode::CommandResponse{true, "OK\n"};
+	                           });
+	EXPECT_EQ(processor.HandleCommand("MEMORY").payload, "ERR MEMORY unavailable\n");
+
+	std::optional<uint64_t> rss = 4096000;
+	int num_trims               = 0;
+	processor.SetMemoryHandlers(
+	        [&] {
+		        textmode::MemoryReport report = {};
+		        report.profile                = "lowmem";
+		        report.resident_bytes         = rss;
+		        report.regions = {{"guest_ram", "Guest RAM.", 16384, 8192},
+		                          {"paging_tlb", "Paging TLB.", 4096, 0}};
+		        return report;
+	        },
+	        [&] {
+		        ++num_trims;
+		        return uint64_t{8192};
+	        });
+
+	EXPECT_EQ(processor.HandleCommand("MEMORY").payload,
+	          "MEMORY profile=lowmem rss=4096000 reserved=20480 resident=8192 "
+	          "regions=2\n"
+	          "guest_ram reserved=16384 resident=8192\n"
+	          "paging_tlb reserved=4096 resident=0\n");
+	EXPECT_EQ(processor.HandleCommand("MEMORY JSON").payload,
+	          "{\"profile\":\"lowmem\",\"rss\":4096000,\"reserved\":20480,"
+	          "\"resident\":8192,\"regions\":{"
+	          "\"guest_ram\":{\"reserved\":16384,\"resident\":8192},"
+	          "\"paging_tlb\":{\"reserved\":4096,\"resident\":0}}}\n");
+
+	rss.reset();
+	EXPECT_TRUE(processor.HandleCommand("MEMORY").payload.starts_with(
+	        "MEMORY profile=lowmem rss=unknown "));
+	EXPECT_TRUE(processor.HandleCommand("MEMORY JSON").payload.starts_with(
+	        "{\"profile\":\"lowmem\",\"rss\":null,"));
+
+	EXPECT_EQ(processor.HandleCommand("MEMORY TRIM").payload,
+	          "OK TRIM released=8192\n");
+	EXPECT_EQ(num_trims, 1);
+	EXPECT_EQ(processor.HandleCommand("MEMORY FREE").payload,
+	          "ERR invalid MEMORY arguments\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, PoolStartsAndReports)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); },
+	                           [](const std::string&) {
+		                           return textmode::CommandResponse{true, "OK\n"};
+	                           });
+	EXPECT_EQ(processor.HandleCommand("POOL").payload, "ERR POOL unavailable\n");
+
+	std::optional<textmode::PoolStats> stats = {};
+	textmode::PoolStartResult start          = {false, "POOL needs 'pool_size'", 0};
+	processor.SetPoolHandlers([&] { return start; }, [&] { return stats; });
+
+	EXPECT_EQ(processor.HandleCommand("POOL").payload, "ERR POOL not running\n");
+	EXPECT_EQ(processor.HandleCommand("POOL START").payload,
+	          "ERR POOL needs 'pool_size'\n");
+
+	start = {true, "", 4};
+	EXPECT_EQ(processor.HandleCommand("POOL START").payload, "OK POOL START size=4\n");
+
+	stats = textmode::PoolStats{4, 3, 1, 0, 6, 2, 1};
+	EXPECT_EQ(processor.HandleCommand("POOL").payload,
+	          "POOL size=4 warm=3 busy=1 waiting=0 launched=6 recycled=2 failed=1\n");
+	EXPECT_EQ(processor.HandleCommand("POOL STOP").payload,
+	          "ERR invalid POOL arguments\n");
+}
+
+TEST_F(TextModeCommandProcessorTest, SetChangesSettings)
+{
+	CommandProcessor processor([] { return MakeSnapshotResult('a'); },
+	                           [](const std::string&) {
+		                           return textmode::CommandResponse{true, "OK\n"};
+	                           });
+	EXPECT_EQ(processor.HandleCommand("SET prebuffer=10").payload,
+	          "ERR SET unavailable\n");
+
+	std::vector<std::pair<std::string, std::string>> changes = {};
+	processor.SetConfigHandler([&](const std::string& name, const std::string& value) {
+		textmode::ConfigResult result = {};
+		if (name == "port") {
+			result.error = "'port' can only be set at startup";
+			return result;
+		}
+		changes.emplace_back(name, value);
+		result.success = true;
+		result.value   = (value == "99") ? "60" : value;
+		return result;
+	});
+
+	EXPECT_EQ(processor.HandleCommand("SET macro_interkey_frames = 2").payload,
+	          "OK SET macro_interkey_frames=2\n");
+	EXPECT_EQ(processor.HandleCommand("SET mixer.prebuffer=99").payload,
+	          "OK SET mixer.prebuffer=60\n");
+	EXPECT_EQ(processor.HandleCommand("SET port=7000").payload,
+	          "ERR 'port' can only be set at startup\n");
+	for (const auto* command : {"SET", "SET port", "SET =1", "SET port="}) {
+		EXPECT_EQ(processor.HandleCommand(command).payload,
+		          "ERR invalid SET arguments\n")
+		        << command;
+	}
+
+	const std::vector<std::pair<std::string, std::string>> expected = {
+	        {"macro_interkey_frames", "2"},
+	        {"mixer.prebuffer", "99"},
+	};
+	EXPECT_EQ(changes, expected);
+}
+
 } // namespace
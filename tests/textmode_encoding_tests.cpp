@@ -13,6 +13,7 @@
 namespace {
 
 using textmode::EncodingOptions;
+using textmode::FrameBaseline;
 using textmode::Snapshot;
 using textmode::TextCell;
 using textmode::TextCell;
@@ -97,6 +98,227 @@ TEST(TextModeEncodingTest, ConvertsControlGlyphsToUnicode)
 	        << frame;
 }
 
+TEST(TextModeEncodingTest, DiffWithoutBaselineSendsFullFrame)
+{
+	auto snapshot = make_snapshot(2, 1);
+	snapshot.cells[0] = TextCell{static_cast<uint8_t>('C'), 0x07};
+	snapshot.cells[1] = TextCell{static_cast<uint8_t>('D'), 0x07};
+
+	EncodingOptions options{};
+	options.show_attributes = false;
+	options.sentinel        = "s";
+
+	const auto frame = textmode::BuildAnsiDiff(nullptr, snapshot, options);
+
+	const std::string expected =
+	        "sMETA cols=2\n"
+	        "sMETA rows=1\n"
+	        "sMETA diff=full\n"
+	        "sMETA cursor=disabled\n"
+	        "sMETA attributes=hide\n"
+	        "sMETA keys_down=\n"
+	        "sPAYLOAD\nCD\n";
+
+	EXPECT_EQ(frame, expected);
+}
+
+TEST(TextModeEncodingTest, DiffEmitsOnlyChangedRuns)
+{
+	FrameBaseline baseline{};
+	baseline.snapshot = make_snapshot(10, 2);
+	for (auto& cell : baseline.snapshot.cells) {
+		cell = TextCell{static_cast<uint8_t>('.'), 0x07};
+	}
+
+	auto current = baseline.snapshot;
+	current.cells[1]      = TextCell{static_cast<uint8_t>('A'), 0x07};
+	current.cells[3]      = TextCell{static_cast<uint8_t>('B'), 0x07};
+	current.cells[10 + 9] = TextCell{static_cast<uint8_t>('Z'), 0x07};
+
+	EncodingOptions options{};
+	options.show_attributes = false;
+	options.sentinel        = "s";
+
+	const auto frame = textmode::BuildAnsiDiff(&baseline, current, options);
+
+	const std::string expected =
+	        "sMETA cols=10\n"
+	        "sMETA rows=2\n"
+	        "sMETA diff=delta\n"
+	        "sMETA runs=2\n"
+	        "sPAYLOAD\n"
+	        "sRUN 0,1,3\nA.B\n"
+	        "sRUN 1,9,1\nZ\n";
+
+	EXPECT_EQ(frame, expected);
+}
+
+TEST(TextModeEncodingTest, DiffReportsCursorAndKeyChanges)
+{
+	FrameBaseline baseline{};
+	baseline.snapshot = make_snapshot(2, 1);
+
+	auto current           = baseline.snapshot;
+	current.cursor.enabled = true;
+	current.cursor.visible = true;
+	current.cursor.column  = 1;
+
+	EncodingOptions options{};
+	options.show_attributes = true;
+	options.sentinel        = "s";
+	options.keys_down       = {"Shift"};
+
+	const auto frame = textmode::BuildAnsiDiff(&baseline, current, options);
+
+	const std::string expected =
+	        "sMETA cols=2\n"
+	        "sMETA rows=1\n"
+	        "sMETA diff=delta\n"
+	        "sMETA cursor=0,1 visible=1\n"
+	        "sMETA keys_down=Shift\n"
+	        "sMETA runs=0\n"
+	        "sPAYLOAD\n";
+
+	EXPECT_EQ(frame, expected);
+}
+
+TEST(TextModeEncodingTest, DiffFallsBackToFullFrameOnGeometryChange)
+{
+	FrameBaseline baseline{};
+	baseline.snapshot = make_snapshot(2, 1);
+
+	const auto current = make_snapshot(3, 1);
+
+	EncodingOptions options{};
+	options.show_attributes = false;
+	options.sentinel        = "s";
+
+	const auto frame = textmode::BuildAnsiDiff(&baseline, current, options);
+
+	EXPECT_NE(frame.find("sMETA diff=full\n"), std::string::npos) << frame;
+	EXPECT_NE(frame.find("sMETA cols=3\n"), std::string::npos) << frame;
+}
+
+Snapshot make_lines(const std::string& first_chars, const uint16_t cols)
+{
+	auto snapshot = make_snapshot(cols, static_cast<uint16_t>(first_chars.size()));
+	for (size_t row = 0; row < first_chars.size(); ++row) {
+		for (uint16_t col = 0; col < cols; ++col) {
+			snapshot.cells[row * cols + col] = TextCell{
+			        static_cast<uint8_t>(first_chars[row] + col), 0x07};
+		}
+	}
+	snapshot.row_stride = cols * 2;
+	return snapshot;
+}
+
+TEST(TextModeEncodingTest, DiffSendsScrollAndExposedRows)
+{
+	FrameBaseline baseline{};
+	baseline.snapshot = make_lines("AEIMQ", 3);
+	const auto current = make_lines("EIMQU", 3);
+
+	EncodingOptions options{};
+	options.show_attributes = false;
+	options.sentinel        = "s";
+
+	const auto frame = textmode::BuildAnsiDiff(&baseline, current, options);
+
+	const std::string expected =
+	        "sMETA cols=3\n"
+	        "sMETA rows=5\n"
+	        "sMETA diff=delta\n"
+	        "sMETA runs=1\n"
+	        "sPAYLOAD\n"
+	        "sSCROLL 1\n"
+	        "sRUN 4,0,3\nUVW\n";
+
+	EXPECT_EQ(frame, expected);
+}
+
+TEST(TextModeEncodingTest, DiffRecognisesHardwareScrollDown)
+{
+	FrameBaseline baseline{};
+	baseline.snapshot               = make_lines("EIMQU", 3);
+	baseline.snapshot.display_start = 160;
+
+	// The CRTC start moved back one row; the old top row is now second and
+	// one cell of the bottom row changed as well
+	auto current          = make_lines("AEIMQ", 3);
+	current.display_start = 154;
+	current.cells[14]     = TextCell{static_cast<uint8_t>('!'), 0x07};
+
+	EncodingOptions options{};
+	options.show_attributes = false;
+	options.sentinel        = "s";
+
+	const auto frame = textmode::BuildAnsiDiff(&baseline, current, options);
+
+	EXPECT_NE(frame.find("sMETA runs=2\n"), std::string::npos) << frame;
+	EXPECT_NE(frame.find("sPAYLOAD\nsSCROLL -1\nsRUN 0,0,3\nABC\nsRUN 4,2,1\n!\n"),
+	          std::string::npos)
+	        << frame;
+}
+
+TEST(TextModeEncodingTest, DiffSkipsScrollWhenRowsAlreadyMatch)
+{
+	FrameBaseline baseline{};
+	baseline.snapshot = make_lines("AAAA", 2);
+
+	auto current     = baseline.snapshot;
+	current.cells[0] = TextCell{static_cast<uint8_t>('x'), 0x07};
+
+	EncodingOptions options{};
+	options.show_attributes = false;
+	options.sentinel        = "s";
+
+	const auto frame = textmode::BuildAnsiDiff(&baseline, current, options);
+
+	EXPECT_EQ(frame.find("SCROLL"), std::string::npos) << frame;
+	EXPECT_NE(frame.find("sRUN 0,0,1\nx\n"), std::string::npos) << frame;
+}
+
+TEST(TextModeEncodingTest, EncodesRawBinaryFrame)
+{
+	auto snapshot = make_snapshot(2, 1);
+	snapshot.cells[0]       = TextCell{static_cast<uint8_t>('A'), 0x1E};
+	snapshot.cells[1]       = TextCell{0xB0, 0x07};
+	snapshot.cursor.enabled = true;
+	snapshot.cursor.visible = true;
+	snapshot.cursor.column  = 1;
+
+	EncodingOptions options{};
+	options.keys_down = {"A", "Shift"};
+
+	const auto frame = textmode::BuildBinaryFrame(snapshot, options, false);
+
+	const std::string expected("TMBF\x01\x03"
+	                           "\x02\x00\x01\x00"
+	                           "\x00\x00\x01\x00"
+	                           "\x04\x00\x00\x00"
+	                           "\x07\x00"
+	                           "A,Shift"
+	                           "A\x1E\xB0\x07",
+	                           textmode::BinaryFrameHeaderSize + 7 + 4);
+	EXPECT_EQ(frame, expected);
+}
+
+TEST(TextModeEncodingTest, EncodesRunLengthBinaryFrame)
+{
+	auto snapshot = make_snapshot(300, 1);
+	for (auto& cell : snapshot.cells) {
+		cell = TextCell{static_cast<uint8_t>(' '), 0x07};
+	}
+	snapshot.cells.back() = TextCell{static_cast<uint8_t>('X'), 0x4F};
+
+	const auto frame = textmode::BuildBinaryFrame(snapshot, EncodingOptions{}, true);
+
+	ASSERT_EQ(frame.size(), textmode::BinaryFrameHeaderSize + 9);
+	EXPECT_EQ(static_cast<uint8_t>(frame[5]), textmode::BinaryFlagRle);
+	const std::string payload = frame.substr(textmode::BinaryFrameHeaderSize);
+	EXPECT_EQ(payload, std::string("\xFF \x07" "\x2C \x07" "\x01X\x4F", 9));
+}
+
 std::string EncodeCodePoint(uint32_t code_point)
 {
 	std::string output;
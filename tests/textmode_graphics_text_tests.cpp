@@ -0,0 +1,199 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/graphics_text.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "ints/int10.h"
+
+namespace {
+
+using textmode::GlyphIndex;
+using textmode::IndexedFrame;
+using textmode::ReadGraphicsText;
+
+constexpr uint8_t FontHeight = 16;
+
+GlyphIndex make_font()
+{
+	return GlyphIndex({int10_font_16, int10_font_16 + sizeof(int10_font_16)},
+	                  FontHeight);
+}
+
+// A screen of 'columns' by 'rows' cells, a byte per pixel
+struct Screen {
+	uint32_t columns            = 0;
+	uint32_t rows               = 0;
+	std::vector<uint8_t> pixels = {};
+
+	Screen(const uint32_t columns_in, const uint32_t rows_in, const uint8_t color)
+	        : columns(columns_in),
+	          rows(rows_in),
+	          pixels(static_cast<size_t>(Width()) * rows * FontHeight, color)
+	{}
+
+	uint32_t Width() const
+	{
+		return columns * 8;
+	}
+
+	void Draw(const uint32_t row, const uint32_t column, const std::string& text,
+	          const uint8_t foreground, const uint8_t background)
+	{
+		for (size_t i = 0; i < text.size(); ++i) {
+			const auto glyph = &int10_font_16[static_cast<uint8_t>(text[i]) *
+			                                  FontHeight];
+			for (uint32_t line = 0; line < FontHeight; ++line) {
+				for (uint32_t x = 0; x < 8; ++x) {
+					const auto is_set = glyph[line] & (0x80 >> x);
+					At((column + static_cast<uint32_t>(i)) * 8 + x,
+					   row * FontHeight + line) = is_set ? foreground
+					                                     : background;
+				}
+			}
+		}
+	}
+
+	uint8_t& At(const uint32_t x, const uint32_t y)
+	{
+		return pixels[static_cast<size_t>(y) * Width() + x];
+	}
+
+	IndexedFrame Frame() const
+	{
+		IndexedFrame frame = {};
+		frame.pixels       = pixels.data();
+		frame.width        = Width();
+		frame.height       = rows * FontHeight;
+		frame.stride       = Width();
+		return frame;
+	}
+};
+
+std::string read_row(const textmode::Snapshot& snapshot, const uint16_t row,
+                     const uint16_t column, const size_t length)
+{
+	std::string text = {};
+	for (size_t i = 0; i < length; ++i) {
+		text += static_cast<char>(
+		        snapshot.cells[static_cast<size_t>(row) * snapshot.columns +
+		                       column + i]
+		                .character);
+	}
+	return text;
+}
+
+TEST(TextModeGraphicsText, ReadsTextDrawnInTheFont)
+{
+	Screen screen(40, 3, 1);
+	screen.Draw(1, 3, "Hello, World!", 14, 1);
+
+	const auto text = ReadGraphicsText(screen.Frame(), make_font());
+
+	ASSERT_EQ(text.snapshot.columns, 40);
+	ASSERT_EQ(text.snapshot.rows, 3);
+	EXPECT_EQ(text.unmatched_cells, 0u);
+	EXPECT_EQ(read_row(text.snapshot, 1, 3, 13), "Hello, World!");
+	EXPECT_EQ(text.snapshot.cells[40 + 3].attribute, 0x1e);
+	EXPECT_EQ(text.snapshot.cells[40 + 8].attribute, 0x1e);
+
+	// Plain background reads as spaces
+	EXPECT_EQ(read_row(text.snapshot, 0, 0, 4), "    ");
+	EXPECT_EQ(text.snapshot.cells[0].attribute, 0x17);
+}
+
+TEST(TextModeGraphicsText, ReadsBackEveryGlyph)
+{
+	Screen screen(32, 8, 0);
+	for (int c = 0; c < 256; ++c) {
+		const auto character = std::string(1, static_cast<char>(c));
+		screen.Draw(static_cast<uint32_t>(c / 32),
+		            static_cast<uint32_t>(c % 32),
+		            character,
+		            15,
+		            4);
+	}
+
+	const auto text = ReadGraphicsText(screen.Frame(), make_font());
+	EXPECT_EQ(text.unmatched_cells, 0u);
+
+	// Characters that share a glyph, or whose glyph is another's inverse,
+	// may read as the other one; drawing what was read must show the same
+	Screen redrawn(32, 8, 0);
+	for (uint16_t i = 0; i < 256; ++i) {
+		const auto& cell = text.snapshot.cells[i];
+		redrawn.Draw(i / 32u,
+		             i % 32u,
+		             std::string(1, static_cast<char>(cell.character)),
+		             cell.attribute & 0x0f,
+		             static_cast<uint8_t>(cell.attribute >> 4));
+	}
+	for (int c = 0; c < 256; ++c) {
+		const auto x = static_cast<uint32_t>(c % 32) * 8;
+		const auto y = static_cast<uint32_t>(c / 32) * FontHeight;
+		for (uint32_t line = 0; line < FontHeight; ++line) {
+			for (uint32_t i = 0; i < 8; ++i) {
+				ASSERT_EQ(redrawn.At(x + i, y + line),
+				          screen.At(x + i, y + line))
+				        << "character " << c;
+			}
+		}
+	}
+	EXPECT_EQ(read_row(text.snapshot, 2, 1, 3), "ABC");
+}
+
+TEST(TextModeGraphicsText, CountsCellsThatAreNotGlyphs)
+{
+	Screen screen(10, 1, 0);
+	screen.Draw(0, 0, "OK", 7, 0);
+
+	// A third color in a cell
+	screen.Draw(0, 2, "X", 7, 0);
+	screen.At(2 * 8 + 7, 15) = 9;
+
+	// Two colors, but no glyph
+	screen.At(4 * 8 + 3, 5) = 7;
+
+	const auto text = ReadGraphicsText(screen.Frame(), make_font());
+	EXPECT_EQ(text.unmatched_cells, 2u);
+	EXPECT_EQ(read_row(text.snapshot, 0, 0, 5), "OK   ");
+	EXPECT_EQ(text.snapshot.cells[2].attribute, 0x07);
+}
+
+TEST(TextModeGraphicsText, FollowsStartStrideAndWrap)
+{
+	// The visible screen starts partway into a wider, wrapping buffer
+	constexpr uint32_t Stride = 256;
+	constexpr uint32_t Size   = 8192;
+	constexpr uint32_t Start  = Size - 2 * Stride + 16;
+
+	std::vector<uint8_t> buffer(Size, 0);
+
+	Screen screen(4, 1, 0);
+	screen.Draw(0, 0, "Wrap", 2, 0);
+	for (uint32_t y = 0; y < FontHeight; ++y) {
+		for (uint32_t x = 0; x < screen.Width(); ++x) {
+			buffer[(Start + y * Stride + x) & (Size - 1)] = screen.At(x, y);
+		}
+	}
+
+	IndexedFrame frame = {};
+	frame.pixels       = buffer.data();
+	frame.width        = screen.Width();
+	frame.height       = FontHeight;
+	frame.start        = Start;
+	frame.stride       = Stride;
+	frame.wrap_mask    = Size - 1;
+
+	const auto text = ReadGraphicsText(frame, make_font());
+	EXPECT_EQ(text.unmatched_cells, 0u);
+	EXPECT_EQ(read_row(text.snapshot, 0, 0, 4), "Wrap");
+	EXPECT_EQ(text.snapshot.cells[0].attribute, 0x02);
+}
+
+} // namespace
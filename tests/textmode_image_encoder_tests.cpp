@@ -0,0 +1,211 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/image_encoder.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <zlib.h>
+
+namespace {
+
+using textmode::FrameImage;
+using textmode::ImageEncodeQueue;
+using textmode::ImageFormat;
+
+FrameImage make_indexed_image()
+{
+	FrameImage image = {};
+	image.width      = 4;
+	image.height     = 2;
+	image.indexed    = true;
+	image.pixels     = {0, 0, 1, 1, 2, 2, 2, 0};
+	image.palette.assign(256 * 3, 0);
+	// 1 is red, 2 is a grey one step away from black
+	image.palette[3] = 255;
+	image.palette[6] = 1;
+	image.palette[7] = 1;
+	image.palette[8] = 1;
+	return image;
+}
+
+uint32_t read_be32(const std::string& data, const size_t offset)
+{
+	return (static_cast<uint32_t>(static_cast<uint8_t>(data[offset])) << 24) |
+	       (static_cast<uint32_t>(static_cast<uint8_t>(data[offset + 1])) << 16) |
+	       (static_cast<uint32_t>(static_cast<uint8_t>(data[offset + 2])) << 8) |
+	       static_cast<uint32_t>(static_cast<uint8_t>(data[offset + 3]));
+}
+
+// Minimal QOI decoder covering the ops the encoder emits
+std::vector<uint8_t> decode_qoi(const std::string& data, uint32_t& width, uint32_t& height)
+{
+	width  = read_be32(data, 4);
+	height = read_be32(data, 8);
+
+	std::vector<uint8_t> rgb = {};
+	std::vector<std::array<uint8_t, 3>> seen(64, std::array<uint8_t, 3>{0, 0, 0});
+	std::array<uint8_t, 3> pixel = {0, 0, 0};
+
+	const auto remember = [&] {
+		const auto hash = (pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + 255 * 11) % 64;
+		seen[hash]      = pixel;
+	};
+
+	size_t offset = 14;
+	while (rgb.size() < static_cast<size_t>(width) * height * 3) {
+		const auto op = static_cast<uint8_t>(data[offset++]);
+		if (op == 0xfe) {
+			pixel = {static_cast<uint8_t>(data[offset]),
+			         static_cast<uint8_t>(data[offset + 1]),
+			         static_cast<uint8_t>(data[offset + 2])};
+			offset += 3;
+			remember();
+		} else if ((op & 0xc0) == 0x00) {
+			pixel = seen[op];
+		} else if ((op & 0xc0) == 0x40) {
+			pixel[0] = static_cast<uint8_t>(pixel[0] + ((op >> 4) & 3) - 2);
+			pixel[1] = static_cast<uint8_t>(pixel[1] + ((op >> 2) & 3) - 2);
+			pixel[2] = static_cast<uint8_t>(pixel[2] + (op & 3) - 2);
+			remember();
+		} else if ((op & 0xc0) == 0x80) {
+			const auto dg   = (op & 0x3f) - 32;
+			const auto next = static_cast<uint8_t>(data[offset++]);
+			pixel[0] = static_cast<uint8_t>(pixel[0] + dg + ((next >> 4) & 0x0f) - 8);
+			pixel[1] = static_cast<uint8_t>(pixel[1] + dg);
+			pixel[2] = static_cast<uint8_t>(pixel[2] + dg + (next & 0x0f) - 8);
+			remember();
+		} else {
+			for (int i = 0; i < (op & 0x3f); ++i) {
+				rgb.insert(rgb.end(), pixel.begin(), pixel.end());
+			}
+		}
+		rgb.insert(rgb.end(), pixel.begin(), pixel.end());
+	}
+	return rgb;
+}
+
+TEST(TextModeImageEncoder, PngCarriesPaletteAndInflatesToRows)
+{
+	const auto png = textmode::EncodePng(make_indexed_image());
+	ASSERT_GT(png.size(), 8u);
+	EXPECT_EQ(png.substr(0, 8), std::string("\x89PNG\r\n\x1a\n"));
+
+	std::string idat = {};
+	bool have_palette = false;
+	size_t offset     = 8;
+	while (offset + 12 <= png.size()) {
+		const auto length = read_be32(png, offset);
+		const auto type   = png.substr(offset + 4, 4);
+		const auto data   = png.substr(offset + 8, length);
+
+		const auto crc = crc32(crc32(0, Z_NULL, 0),
+		                       reinterpret_cast<const Bytef*>(png.data() + offset + 4),
+		                       length + 4);
+		EXPECT_EQ(read_be32(png, offset + 8 + length), static_cast<uint32_t>(crc)) << type;
+
+		if (type == "IHDR") {
+			EXPECT_EQ(read_be32(data, 0), 4u);
+			EXPECT_EQ(read_be32(data, 4), 2u);
+			EXPECT_EQ(data[9], 3); // paletted
+		} else if (type == "PLTE") {
+			EXPECT_EQ(length, 768u);
+			have_palette = true;
+		} else if (type == "IDAT") {
+			idat += data;
+		}
+		offset += 12 + length;
+	}
+	EXPECT_EQ(offset, png.size());
+	EXPECT_TRUE(have_palette);
+
+	std::vector<uint8_t> rows(10);
+	auto rows_size = static_cast<uLongf>(rows.size());
+	ASSERT_EQ(uncompress(rows.data(),
+	                     &rows_size,
+	                     reinterpret_cast<const Bytef*>(idat.data()),
+	                     static_cast<uLong>(idat.size())),
+	          Z_OK);
+	EXPECT_EQ(rows, (std::vector<uint8_t>{0, 0, 0, 1, 1, 0, 2, 2, 2, 0}));
+}
+
+TEST(TextModeImageEncoder, QoiRoundTripsPalettedPixels)
+{
+	const auto image = make_indexed_image();
+	const auto qoi   = textmode::EncodeQoi(image);
+	ASSERT_EQ(qoi.substr(0, 4), "qoif");
+	EXPECT_EQ(qoi.substr(qoi.size() - 8), std::string("\0\0\0\0\0\0\0\1", 8));
+
+	uint32_t width  = 0;
+	uint32_t height = 0;
+	const auto rgb  = decode_qoi(qoi, width, height);
+	EXPECT_EQ(width, 4u);
+	EXPECT_EQ(height, 2u);
+
+	std::vector<uint8_t> expected = {};
+	for (const auto index : image.pixels) {
+		const auto entry = image.palette.begin() + index * 3;
+		expected.insert(expected.end(), entry, entry + 3);
+	}
+	EXPECT_EQ(rgb, expected);
+}
+
+TEST(TextModeImageEncoder, ScalesAndFramesRawReplies)
+{
+	FrameImage image = {};
+	image.width      = 2;
+	image.height     = 1;
+	image.pixels     = {1, 2, 3, 4, 5, 6};
+
+	const auto scaled = textmode::ScaleImage(image, 2);
+	EXPECT_EQ(scaled.width, 4);
+	EXPECT_EQ(scaled.height, 2);
+	EXPECT_EQ(scaled.pixels,
+	          (std::vector<uint8_t>{1, 2, 3, 1, 2, 3, 4, 5, 6, 4, 5, 6,
+	                                1, 2, 3, 1, 2, 3, 4, 5, 6, 4, 5, 6}));
+
+	const auto reply = textmode::BuildImageReply(image, ImageFormat::Raw);
+	EXPECT_EQ(reply,
+	          std::string("IMG width=2 height=1 format=raw pixels=rgb24 bytes=6\n"
+	                      "\1\2\3\4\5\6"));
+
+	const auto indexed = textmode::BuildImageReply(make_indexed_image(), ImageFormat::Raw);
+	EXPECT_EQ(indexed.substr(0, indexed.find('\n')),
+	          "IMG width=4 height=2 format=raw pixels=indexed8 bytes=776");
+}
+
+TEST(TextModeImageEncoder, QueueRunsJobsInOrderOffThread)
+{
+	ImageEncodeQueue queue;
+	const auto caller = std::this_thread::get_id();
+
+	std::thread::id worker = {};
+	queue.Submit(3, [&] {
+		worker = std::this_thread::get_id();
+		return std::string("first");
+	});
+	queue.Submit(4, [] { return std::string("second"); });
+	queue.Drain();
+
+	const auto done = queue.Collect();
+	ASSERT_EQ(done.size(), 2u);
+	EXPECT_EQ(done[0].client, 3u);
+	EXPECT_EQ(done[0].payload, "first");
+	EXPECT_EQ(done[1].client, 4u);
+	EXPECT_EQ(done[1].payload, "second");
+	EXPECT_NE(worker, caller);
+	EXPECT_TRUE(queue.Collect().empty());
+
+	// The worker is restarted for work that arrives after it went idle
+	queue.Submit(5, [] { return std::string("third"); });
+	queue.Drain();
+	ASSERT_EQ(queue.Collect().size(), 1u);
+}
+
+} // namespace
@@ -0,0 +1,257 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/instance_pool.h"
+
+#include <gtest/gtest.h>
+
+#if !defined(WIN32)
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+using textmode::ClientHandle;
+using textmode::InstancePool;
+using textmode::PoolHooks;
+using textmode::PoolInstance;
+
+constexpr std::chrono::milliseconds NoRetryDelay{0};
+
+// Stands in for forking: each instance is a socket pair whose far end the
+// test reads and writes as the instance would
+class InstancePoolTest : public ::testing::Test {
+protected:
+	void TearDown() override
+	{
+		for (const auto& [_, socket] : instances) {
+			::close(socket);
+		}
+	}
+
+	PoolHooks MakeHooks()
+	{
+		PoolHooks hooks = {};
+		hooks.launch    = [this](std::string& error) -> std::optional<PoolInstance> {
+			if (fail_launches) {
+				error = "no room";
+				return {};
+			}
+			int sockets[2] = {-1, -1};
+			if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+				error = "socketpair failed";
+				return {};
+			}
+			const auto pid = next_pid++;
+			instances[pid] = sockets[1];
+
+			auto link = textmode::MakeConnectedSocketBackend(sockets[0]);
+			EXPECT_TRUE(link->Start(0));
+			return PoolInstance{pid, std::move(link)};
+		};
+		hooks.send = [this](const ClientHandle client, const std::string& data) {
+			replies[client] += data;
+			return true;
+		};
+		hooks.close = [this](const ClientHandle client) {
+			closed_clients.push_back(client);
+		};
+		return hooks;
+	}
+
+	// What the instance has been sent, waiting up to a second for it
+	std::string ReadInstance(const int64_t pid, const size_t expected)
+	{
+		std::string received = {};
+		char buffer[256];
+		const auto deadline = std::chrono::steady_clock::now() +
+		                      std::chrono::seconds(1);
+		while (received.size() < expected &&
+		       std::chrono::steady_clock::now() < deadline) {
+			pollfd entry = {instances.at(pid), POLLIN, 0};
+			if (poll(&entry, 1, 10) <= 0) {
+				continue;
+			}
+			const auto count = recv(instances.at(pid), buffer, sizeof(buffer), 0);
+			if (count <= 0) {
+				break;
+			}
+			received.append(buffer, static_cast<size_t>(count));
+		}
+		return received;
+	}
+
+	bool HasHungUp(const int64_t pid)
+	{
+		pollfd entry = {instances.at(pid), POLLIN, 0};
+		char byte    = 0;
+		return poll(&entry, 1, 1000) == 1 && recv(instances.at(pid), &byte, 1, 0) == 0;
+	}
+
+	// Polls the pool until 'done' holds, for up to a second
+	template <typename Predicate>
+	bool PollUntil(InstancePool& pool, Predicate done)
+	{
+		const auto deadline = std::chrono::steady_clock::now() +
+		                      std::chrono::seconds(1);
+		while (std::chrono::steady_clock::now() < deadline) {
+			pool.Poll();
+			if (done()) {
+				return true;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+
+	int64_t next_pid   = 100;
+	bool fail_launches = false;
+
+	// The instances' ends of their socket pairs, by process ID
+	std::map<int64_t, int> instances            = {};
+	std::map<ClientHandle, std::string> replies = {};
+	std::vector<ClientHandle> closed_clients    = {};
+};
+
+TEST_F(InstancePoolTest, KeepsInstancesWarm)
+{
+	InstancePool pool(2, MakeHooks(), NoRetryDelay);
+	pool.Poll();
+
+	const auto stats = pool.Stats();
+	EXPECT_EQ(stats.size, 2u);
+	EXPECT_EQ(stats.warm, 2u);
+	EXPECT_EQ(stats.busy, 0u);
+	EXPECT_EQ(stats.launched, 2u);
+
+	// Already full
+	pool.Poll();
+	EXPECT_EQ(pool.Stats().launched, 2u);
+}
+
+TEST_F(InstancePoolTest, ForwardsBetweenClientAndInstance)
+{
+	InstancePool pool(1, MakeHooks(), NoRetryDelay);
+	pool.Poll();
+
+	pool.Assign(7);
+	pool.Forward(7, "GET\n");
+	EXPECT_EQ(ReadInstance(100, 4), "GET\n");
+
+	ASSERT_EQ(send(instances.at(100), "FRAME\n", 6, 0), 6);
+	EXPECT_TRUE(PollUntil(pool, [&] { return replies[7] == "FRAME\n"; }));
+
+	// A replacement is warmed while the first instance is busy
+	const auto stats = pool.Stats();
+	EXPECT_EQ(stats.busy, 1u);
+	EXPECT_EQ(stats.warm, 1u);
+	EXPECT_EQ(stats.launched, 2u);
+}
+
+TEST_F(InstancePoolTest, RecyclesInstancesWhenClientsLeave)
+{
+	InstancePool pool(1, MakeHooks(), NoRetryDelay);
+	pool.Poll();
+
+	pool.Assign(7);
+	pool.Poll();
+	pool.Release(7);
+	EXPECT_TRUE(HasHungUp(100));
+
+	// The next client gets an instance that never served anyone
+	pool.Assign(8);
+	pool.Forward(8, "GET\n");
+	EXPECT_EQ(ReadInstance(101, 4), "GET\n");
+
+	const auto stats = pool.Stats();
+	EXPECT_EQ(stats.recycled, 1u);
+	EXPECT_EQ(stats.busy, 1u);
+	EXPECT_TRUE(closed_clients.empty());
+}
+
+TEST_F(InstancePoolTest, ClientsWaitForAnInstance)
+{
+	fail_launches = true;
+	InstancePool pool(1, MakeHooks(), NoRetryDelay);
+	pool.Poll();
+	EXPECT_EQ(pool.Stats().failed, 1u);
+
+	pool.Assign(7);
+	pool.Forward(7, "GET\n");
+	pool.Forward(7, "STATS\n");
+	EXPECT_EQ(pool.Stats().waiting, 1u);
+
+	fail_launches = false;
+	pool.Poll();
+	EXPECT_EQ(ReadInstance(100, 10), "GET\nSTATS\n");
+
+	const auto stats = pool.Stats();
+	EXPECT_EQ(stats.waiting, 0u);
+	EXPECT_EQ(stats.busy, 1u);
+	EXPECT_EQ(stats.warm, 1u);
+}
+
+TEST_F(InstancePoolTest, RetriesFailedLaunchesAfterTheDelay)
+{
+	fail_launches = true;
+	InstancePool pool(1, MakeHooks(), std::chrono::hours(1));
+	pool.Poll();
+	pool.Poll();
+	EXPECT_EQ(pool.Stats().failed, 1u);
+}
+
+TEST_F(InstancePoolTest, ClosesClientsOfInstancesThatExit)
+{
+	InstancePool pool(1, MakeHooks(), NoRetryDelay);
+	pool.Poll();
+	pool.Assign(7);
+
+	::close(instances.at(100));
+	instances.erase(100);
+	EXPECT_TRUE(PollUntil(pool, [&] { return !closed_clients.empty(); }));
+	EXPECT_EQ(closed_clients, std::vector<ClientHandle>{7});
+
+	const auto stats = pool.Stats();
+	EXPECT_EQ(stats.busy, 0u);
+	EXPECT_EQ(stats.warm, 1u);
+}
+
+TEST_F(InstancePoolTest, StopsInTheForkedInstance)
+{
+	std::optional<InstancePool> pool = {};
+
+	auto hooks   = MakeHooks();
+	auto launch  = hooks.launch;
+	hooks.launch = [&](std::string& error) -> std::optional<PoolInstance> {
+		if (instances.empty()) {
+			return launch(error);
+		}
+		// As the new instance would, right after the fork
+		pool->AbandonAfterFork();
+		return {};
+	};
+	pool.emplace(3, std::move(hooks), NoRetryDelay);
+	pool->Poll();
+
+	// Nothing more is launched from the new instance
+	EXPECT_EQ(instances.size(), 1u);
+
+	const auto stats = pool->Stats();
+	EXPECT_EQ(stats.launched, 1u);
+	EXPECT_EQ(stats.failed, 0u);
+	EXPECT_EQ(stats.warm, 0u);
+}
+
+} // namespace
+
+#endif // !WIN32
@@ -0,0 +1,257 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/server.h"
+
+#include <gtest/gtest.h>
+
+#if !defined(WIN32)
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+using textmode::BackendEvent;
+using textmode::ClientHandle;
+using textmode::NetworkBackend;
+
+constexpr uint16_t FirstTestPort = 36100;
+constexpr uint16_t LastTestPort  = 36199;
+
+class NativeBackendTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		backend = textmode::MakeNativeNetBackend();
+		for (uint16_t candidate = FirstTestPort; candidate <= LastTestPort; ++candidate) {
+			if (backend->Start(candidate)) {
+				port = candidate;
+				break;
+			}
+		}
+		ASSERT_NE(port, 0);
+	}
+
+	void TearDown() override
+	{
+		for (const int peer : peers) {
+			::close(peer);
+		}
+		backend->Stop();
+	}
+
+	int Connect()
+	{
+		const int peer = socket(AF_INET, SOCK_STREAM, 0);
+		sockaddr_in address     = {};
+		address.sin_family      = AF_INET;
+		address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		address.sin_port        = htons(port);
+		EXPECT_EQ(connect(peer, reinterpret_cast<sockaddr*>(&address), sizeof(address)),
+		          0);
+		peers.push_back(peer);
+		return peer;
+	}
+
+	// Polls the backend until an event of the given type arrives
+	BackendEvent WaitFor(const BackendEvent::Type type)
+	{
+		const auto deadline = std::chrono::steady_clock::now() +
+		                      std::chrono::seconds(2);
+		while (std::chrono::steady_clock::now() < deadline) {
+			for (auto& event : backend->Poll()) {
+				if (event.type == type) {
+					return event;
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		ADD_FAILURE() << "Timed out waiting for backend event";
+		return {};
+	}
+
+	// Reads from the peer, polling the backend so it can flush its queue
+	std::string ReadFromPeer(const int peer, const size_t expected)
+	{
+		std::string received;
+		char buffer[65536];
+		const auto deadline = std::chrono::steady_clock::now() +
+		                      std::chrono::seconds(5);
+		while (received.size() < expected &&
+		       std::chrono::steady_clock::now() < deadline) {
+			backend->Poll();
+			pollfd entry = {peer, POLLIN, 0};
+			if (poll(&entry, 1, 1) <= 0) {
+				continue;
+			}
+			const auto count = recv(peer, buffer, sizeof(buffer), 0);
+			if (count <= 0) {
+				break;
+			}
+			received.append(buffer, static_cast<size_t>(count));
+		}
+		return received;
+	}
+
+	std::unique_ptr<NetworkBackend> backend = {};
+	uint16_t port                           = 0;
+	std::vector<int> peers                  = {};
+};
+
+TEST_F(NativeBackendTest, DeliversConnectAndData)
+{
+	const int peer = Connect();
+	const auto connected = WaitFor(BackendEvent::Type::Connected);
+	EXPECT_NE(connected.client, ClientHandle{0});
+
+	ASSERT_EQ(send(peer, "GET\n", 4, 0), 4);
+	const auto data = WaitFor(BackendEvent::Type::Data);
+	EXPECT_EQ(data.client, connected.client);
+	EXPECT_EQ(data.data, "GET\n");
+
+	ASSERT_TRUE(backend->Send(connected.client, "OK\n"));
+	EXPECT_EQ(ReadFromPeer(peer, 3), "OK\n");
+}
+
+TEST_F(NativeBackendTest, QueuesLargeRepliesWithoutBlocking)
+{
+	const int peer = Connect();
+	const auto client = WaitFor(BackendEvent::Type::Connected).client;
+
+	// Far more than the kernel buffers hold while the peer is not reading
+	const std::string payload(3 * 1024 * 1024, 'x');
+	const auto started = std::chrono::steady_clock::now();
+	ASSERT_TRUE(backend->Send(client, payload));
+	EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(1));
+	EXPECT_LE(backend->QueuedBytes(client), payload.size());
+
+	EXPECT_EQ(ReadFromPeer(peer, payload.size()).size(), payload.size());
+	EXPECT_EQ(backend->QueuedBytes(client), 0u);
+}
+
+TEST_F(NativeBackendTest, RejectsRepliesBeyondQueueLimit)
+{
+	Connect();
+	const auto client = WaitFor(BackendEvent::Type::Connected).client;
+
+	const std::string payload(5 * 1024 * 1024, 'x');
+	EXPECT_FALSE(backend->Send(client, payload));
+}
+
+TEST_F(NativeBackendTest, RejectsClientsBeyondLimit)
+{
+	backend->SetMaxClients(1);
+	ASSERT_TRUE(backend->Start(port));
+
+	Connect();
+	WaitFor(BackendEvent::Type::Connected);
+	const int rejected = Connect();
+
+	char byte = 0;
+	pollfd entry = {rejected, POLLIN, 0};
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+	while (backend->RejectedClients() == 0 &&
+	       std::chrono::steady_clock::now() < deadline) {
+		backend->Poll();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	EXPECT_EQ(backend->RejectedClients(), 1u);
+	ASSERT_EQ(poll(&entry, 1, 1000), 1);
+	EXPECT_LE(recv(rejected, &byte, 1, 0), 0);
+}
+
+TEST(LocalSocketBackendTest, ServesClientsOverUnixSocket)
+{
+	const auto path = "/tmp/dosbox-textmode-test-" + std::to_string(getpid()) + ".sock";
+	auto backend    = textmode::MakeLocalSocketBackend(path);
+	ASSERT_TRUE(backend->Start(0));
+
+	const int peer = socket(AF_UNIX, SOCK_STREAM, 0);
+	sockaddr_un address = {};
+	address.sun_family  = AF_UNIX;
+	std::snprintf(address.sun_path, sizeof(address.sun_path), "%s", path.c_str());
+	ASSERT_EQ(connect(peer, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+	ASSERT_EQ(send(peer, "GET\n", 4, 0), 4);
+
+	std::vector<BackendEvent> events;
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+	while (events.size() < 2 && std::chrono::steady_clock::now() < deadline) {
+		for (auto& event : backend->Poll()) {
+			events.push_back(std::move(event));
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_EQ(events.size(), 2u);
+	EXPECT_EQ(events[0].type, BackendEvent::Type::Connected);
+	EXPECT_EQ(events[1].data, "GET\n");
+
+	ASSERT_TRUE(backend->Send(events[0].client, "OK\n"));
+	char reply[4] = {};
+	EXPECT_EQ(recv(peer, reply, 3, 0), 3);
+	EXPECT_STREQ(reply, "OK\n");
+
+	::close(peer);
+	backend->Stop();
+	EXPECT_NE(access(path.c_str(), F_OK), 0);
+}
+
+TEST_F(NativeBackendTest, ReportsClosedPeers)
+{
+	const int peer = Connect();
+	const auto client = WaitFor(BackendEvent::Type::Connected).client;
+
+	::close(peer);
+	peers.clear();
+	EXPECT_EQ(WaitFor(BackendEvent::Type::Closed).client, client);
+	EXPECT_FALSE(backend->Send(client, "late\n"));
+}
+
+TEST(ConnectedSocketBackendTest, ServesOneEndOfASocketPair)
+{
+	int sockets[2] = {-1, -1};
+	ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+	auto backend = textmode::MakeConnectedSocketBackend(sockets[0]);
+	ASSERT_TRUE(backend->Start(0));
+	const int peer = sockets[1];
+
+	ASSERT_EQ(send(peer, "GET\n", 4, 0), 4);
+
+	std::vector<BackendEvent> events;
+	const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+	while (events.size() < 2 && std::chrono::steady_clock::now() < deadline) {
+		for (auto& event : backend->Poll()) {
+			events.push_back(std::move(event));
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_EQ(events.size(), 2u);
+	EXPECT_EQ(events[0].type, BackendEvent::Type::Connected);
+	EXPECT_EQ(events[0].client, textmode::ConnectedClient);
+	EXPECT_EQ(events[1].data, "GET\n");
+
+	ASSERT_TRUE(backend->Send(textmode::ConnectedClient, "OK\n"));
+	char reply[4] = {};
+	EXPECT_EQ(recv(peer, reply, 3, 0), 3);
+	EXPECT_STREQ(reply, "OK\n");
+
+	// Stopping closes the backend's end
+	backend->Stop();
+	EXPECT_EQ(recv(peer, reply, 1, 0), 0);
+	::close(peer);
+}
+
+} // namespace
+
+#endif // !WIN32
@@ -8,7 +8,9 @@
 
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <deque>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -57,6 +59,12 @@ public:
 		closed_clients.push_back(client);
 	}
 
+	size_t QueuedBytes(const ClientHandle client) const override
+	{
+		const auto it = queued_bytes.find(client);
+		return it == queued_bytes.end() ? 0 : it->second;
+	}
+
 	void QueueEvents(std::vector<BackendEvent> events)
 	{
 		pending_events.emplace_back(std::move(events));
@@ -70,6 +78,7 @@ public:
 	std::deque<std::vector<BackendEvent>> pending_events = {};
 	std::vector<std::pair<ClientHandle, std::string>> sent = {};
 	std::vector<ClientHandle> closed_clients               = {};
+	std::map<ClientHandle, size_t> queued_bytes            = {};
 };
 
 class TextModeServerTcpTest : public ::testing::Test {
@@ -83,6 +92,18 @@ protected:
 	{
 		return ServiceResult{false, {}, "no frame"};
 	}
+
+	ServiceResult MakeCapture(const char ch)
+	{
+		textmode::Snapshot snapshot{};
+		snapshot.columns = 1;
+		snapshot.rows    = 1;
+		snapshot.cells   = {textmode::TextCell{static_cast<uint8_t>(ch), 0x07}};
+
+		ServiceResult result{true, std::string("FRAME ") + ch + "\n", {}};
+		result.snapshot = snapshot;
+		return result;
+	}
 };
 
 TEST_F(TextModeServerTcpTest, RequiresAuthenticationBeforeCommands)
@@ -189,7 +210,73 @@ TEST_F(TextModeServerTcpTest, DispatchesCommands)
 	EXPECT_EQ(backend_ptr->sent[0].first, client);
 	EXPECT_EQ(backend_ptr->sent[0].second, "FRAME\n");
 	EXPECT_EQ(backend_ptr->sent[1].second,
-	          "requests=1 success=1 failures=0 keys_down=\n");
+	          "requests=1 success=1 failures=0 rejected=0 "
+	          "pending=0 peak_pending=0 bytes_sent=0 evicted=0 keys_down=\n");
+}
+
+TEST_F(TextModeServerTcpTest, EchoesRequestIds)
+{
+	auto backend = std::make_unique<FakeBackend>();
+	FakeBackend* backend_ptr = backend.get();
+
+	CommandProcessor processor([&] { return MakeSuccess(); });
+
+	TextModeServer server(std::move(backend));
+	ASSERT_TRUE(server.Start(6000, processor));
+
+	const ClientHandle client = 3;
+	backend_ptr->QueueEvents({BackendEvent::Connected(client)});
+	server.Poll();
+
+	backend_ptr->QueueEvents(
+	        {BackendEvent::Data(client, "#42 GET\n#7 BOGUS\nGET\n#x GET\n#9GET\n")});
+	server.Poll();
+
+	ASSERT_EQ(backend_ptr->sent.size(), 5u);
+	EXPECT_EQ(backend_ptr->sent[0].second, "#42 FRAME\n");
+	EXPECT_EQ(backend_ptr->sent[1].second, "#7 ERR unknown command\n");
+	EXPECT_EQ(backend_ptr->sent[2].second, "FRAME\n");
+	EXPECT_EQ(backend_ptr->sent[3].second, "ERR invalid request id\n");
+	EXPECT_EQ(backend_ptr->sent[4].second, "ERR invalid request id\n");
+}
+
+TEST_F(TextModeServerTcpTest, CompressesRepliesAfterCompressCommand)
+{
+	auto backend = std::make_unique<FakeBackend>();
+	FakeBackend* backend_ptr = backend.get();
+
+	CommandProcessor processor([&] { return MakeSuccess(); });
+
+	TextModeServer server(std::move(backend));
+	ASSERT_TRUE(server.Start(6000, processor));
+
+	const ClientHandle client = 4;
+	backend_ptr->QueueEvents({BackendEvent::Connected(client)});
+	server.Poll();
+
+	backend_ptr->QueueEvents({BackendEvent::Data(
+	        client, "COMPRESS lz4\nCOMPRESS zstd\n#1 COMPRESS zlib\nGET\nGET\n")});
+	server.Poll();
+
+	ASSERT_EQ(backend_ptr->sent.size(), 5u);
+	EXPECT_EQ(backend_ptr->sent[0].second, "ERR invalid COMPRESS arguments\n");
+	EXPECT_EQ(backend_ptr->sent[1].second, "ERR invalid COMPRESS arguments\n");
+	EXPECT_EQ(backend_ptr->sent[2].second, "#1 OK COMPRESS zlib\n");
+
+	// One zlib stream spans every block, each prefixed by its length
+	textmode::InflateStream inflater = {};
+	ASSERT_TRUE(inflater.Init(textmode::DeflateFormat::Zlib));
+	for (size_t i = 3; i < 5; ++i) {
+		const auto& block = backend_ptr->sent[i].second;
+		ASSERT_GE(block.size(), 4u);
+		const auto length = (static_cast<uint32_t>(static_cast<uint8_t>(block[0])) << 24) |
+		                    (static_cast<uint32_t>(static_cast<uint8_t>(block[1])) << 16) |
+		                    (static_cast<uint32_t>(static_cast<uint8_t>(block[2])) << 8) |
+		                    static_cast<uint32_t>(static_cast<uint8_t>(block[3]));
+		ASSERT_EQ(length, block.size() - 4);
+		EXPECT_EQ(inflater.Decompress(block.substr(4), 1024), "FRAME\n");
+	}
+	EXPECT_LT(backend_ptr->sent[4].second.size(), backend_ptr->sent[3].second.size());
 }
 
 TEST_F(TextModeServerTcpTest, HandlesPartialLines)
@@ -293,4 +380,152 @@ TEST_F(TextModeServerTcpTest, ExitCommandSignalsShutdown)
 	EXPECT_EQ(backend_ptr->sent[0].second, "OK\n");
 }
 
+TEST_F(TextModeServerTcpTest, WatchPushesFramesOnlyWhenScreenChanges)
+{
+	auto backend = std::make_unique<FakeBackend>();
+	FakeBackend* backend_ptr = backend.get();
+
+	char screen = 'a';
+	CommandProcessor processor([&] { return MakeCapture(screen); });
+
+	TextModeServer server(std::move(backend));
+	ASSERT_TRUE(server.Start(6000, processor));
+
+	const ClientHandle client = 21;
+	backend_ptr->QueueEvents({BackendEvent::Connected(client)});
+	server.Poll();
+
+	backend_ptr->QueueEvents({BackendEvent::Data(client, "WATCH\n")});
+	server.Poll();
+
+	ASSERT_EQ(backend_ptr->sent.size(), 2u);
+	EXPECT_EQ(backend_ptr->sent[0].second, "OK\n");
+	EXPECT_EQ(backend_ptr->sent[1].second, "FRAME a\n");
+
+	server.Poll();
+	server.Poll();
+	EXPECT_EQ(backend_ptr->sent.size(), 2u);
+
+	screen = 'b';
+	server.Poll();
+	ASSERT_EQ(backend_ptr->sent.size(), 3u);
+	EXPECT_EQ(backend_ptr->sent[2].first, client);
+	EXPECT_EQ(backend_ptr->sent[2].second, "FRAME b\n");
+
+	backend_ptr->QueueEvents({BackendEvent::Data(client, "UNWATCH\n")});
+	server.Poll();
+	screen = 'c';
+	server.Poll();
+	ASSERT_EQ(backend_ptr->sent.size(), 4u);
+	EXPECT_EQ(backend_ptr->sent[3].second, "OK\n");
+}
+
+TEST_F(TextModeServerTcpTest, WatchStopsWhenClientDisconnects)
+{
+	auto backend = std::make_unique<FakeBackend>();
+	FakeBackend* backend_ptr = backend.get();
+
+	int captures = 0;
+	CommandProcessor processor([&] {
+		++captures;
+		return MakeCapture('a');
+	});
+
+	TextModeServer server(std::move(backend));
+	ASSERT_TRUE(server.Start(6000, processor));
+
+	const ClientHandle client = 22;
+	backend_ptr->QueueEvents({BackendEvent::Connected(client),
+	                          BackendEvent::Data(client, "WATCH 10 DIFF\n")});
+	server.Poll();
+	ASSERT_EQ(backend_ptr->sent.size(), 2u);
+	EXPECT_NE(backend_ptr->sent[1].second.find("META diff=full"), std::string::npos);
+
+	backend_ptr->QueueEvents({BackendEvent::Closed(client)});
+	server.Poll();
+	const auto captures_after_close = captures;
+	server.Poll();
+	EXPECT_EQ(captures, captures_after_close);
+}
+
+TEST_F(TextModeServerTcpTest, SlowWatchersCoalesceThenGetEvicted)
+{
+	auto backend = std::make_unique<FakeBackend>();
+	FakeBackend* backend_ptr = backend.get();
+
+	char screen = 'a';
+	CommandProcessor processor([&] { return MakeCapture(screen); });
+
+	TextModeServer server(std::move(backend));
+	server.SetOutboundBudget(100, std::chrono::hours(1));
+	ASSERT_TRUE(server.Start(6000, processor));
+
+	const ClientHandle client = 23;
+	backend_ptr->QueueEvents({BackendEvent::Connected(client),
+	                          BackendEvent::Data(client, "WATCH\n")});
+	server.Poll();
+	ASSERT_EQ(backend_ptr->sent.size(), 2u);
+
+	// Over budget: the screens in between are skipped
+	backend_ptr->queued_bytes[client] = 101;
+	screen = 'b';
+	server.Poll();
+	screen = 'c';
+	server.Poll();
+	EXPECT_EQ(backend_ptr->sent.size(), 2u);
+
+	backend_ptr->queued_bytes[client] = 0;
+	server.Poll();
+	ASSERT_EQ(backend_ptr->sent.size(), 3u);
+	EXPECT_EQ(backend_ptr->sent[2].second, "FRAME c\n");
+	EXPECT_EQ(server.Telemetry().evicted_clients, 0u);
+
+	// Staying over budget past the stall timeout disconnects the client
+	server.SetOutboundBudget(100, std::chrono::milliseconds(0));
+	backend_ptr->queued_bytes[client] = 101;
+	server.Poll();
+	server.Poll();
+	ASSERT_EQ(backend_ptr->closed_clients.size(), 1u);
+	EXPECT_EQ(backend_ptr->closed_clients[0], client);
+	EXPECT_EQ(server.Telemetry().evicted_clients, 1u);
+}
+
+TEST_F(TextModeServerTcpTest, ForwardsClaimedClients)
+{
+	auto backend = std::make_unique<FakeBackend>();
+	FakeBackend* backend_ptr = backend.get();
+
+	int request_count = 0;
+	CommandProcessor processor([&] {
+		++request_count;
+		return MakeSuccess();
+	});
+
+	TextModeServer server(std::move(backend));
+	std::vector<std::pair<ClientHandle, std::string>> forwarded = {};
+	server.SetForwarder([](const ClientHandle client) { return client == 2; },
+	                    [&](const ClientHandle client, const std::string& data) {
+		                    forwarded.emplace_back(client, data);
+	                    });
+	ASSERT_TRUE(server.Start(6000, processor));
+
+	backend_ptr->QueueEvents({BackendEvent::Connected(1),
+	                          BackendEvent::Connected(2),
+	                          BackendEvent::Data(1, "GET\n"),
+	                          BackendEvent::Data(2, "GET\nTY")});
+	server.Poll();
+
+	// Forwarded bytes arrive as they were received, lines or not
+	EXPECT_EQ(request_count, 1);
+	ASSERT_EQ(forwarded.size(), 1u);
+	EXPECT_EQ(forwarded[0].first, ClientHandle{2});
+	EXPECT_EQ(forwarded[0].second, "GET\nTY");
+	ASSERT_EQ(backend_ptr->sent.size(), 1u);
+	EXPECT_EQ(backend_ptr->sent[0].first, ClientHandle{1});
+
+	ASSERT_TRUE(server.Send(2, "FRAME\n"));
+	EXPECT_EQ(backend_ptr->sent.back().first, ClientHandle{2});
+	EXPECT_EQ(backend_ptr->sent.back().second, "FRAME\n");
+}
+
 } // namespace
@@ -151,4 +151,30 @@ TEST_F(TextModeServiceTest, BuildsFrameWhenEnabled)
 	          "*PAYLOAD\nEF\n");
 }
 
+TEST_F(TextModeServiceTest, EncodesLatchedSnapshot)
+{
+	vga.mode = M_TEXT;
+
+	textmode::Snapshot latched{};
+	latched.columns = 1;
+	latched.rows    = 1;
+	latched.cells   = {{'L', 0x07}};
+
+	const textmode::ServiceConfig config{
+	        .enable          = true,
+	        .port            = 6000,
+	        .show_attributes = false,
+	        .sentinel        = "*",
+	        .auth_token      = "",
+	};
+
+	textmode::TextModeService service(config, {}, &latched);
+	const auto result = service.GetFrame();
+
+	ASSERT_TRUE(result.success) << result.error;
+	EXPECT_NE(result.frame.find("*PAYLOAD\nL\n"), std::string::npos);
+	ASSERT_TRUE(result.snapshot.has_value());
+	EXPECT_EQ(*result.snapshot, latched);
+}
+
 } // namespace
@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/session_journal.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using textmode::JournalEntry;
+
+std::vector<JournalEntry> make_session()
+{
+	return {
+	        {0, JournalEntry::Kind::Frame, "", textmode::HashFrame("C:\\>")},
+	        {120, JournalEntry::Kind::Press, "D", 0},
+	        {120, JournalEntry::Kind::Down, "LeftShift", 0},
+	        {185, JournalEntry::Kind::Up, "LeftShift", 0},
+	        {100000, JournalEntry::Kind::Frame, "", 0xfedcba9876543210},
+	};
+}
+
+TEST(TextModeSessionJournal, RoundTripsEntries)
+{
+	const auto session = make_session();
+	const auto data    = textmode::EncodeJournal(session);
+	EXPECT_EQ(data.substr(0, 5), std::string("DBXJ\1"));
+
+	std::string error = {};
+	const auto decoded = textmode::DecodeJournal(data, error);
+	ASSERT_TRUE(decoded) << error;
+	ASSERT_EQ(decoded->size(), session.size());
+	for (size_t i = 0; i < session.size(); ++i) {
+		EXPECT_EQ((*decoded)[i].tick, session[i].tick);
+		EXPECT_EQ((*decoded)[i].kind, session[i].kind);
+		EXPECT_EQ((*decoded)[i].key, session[i].key);
+		EXPECT_EQ((*decoded)[i].hash, session[i].hash);
+	}
+}
+
+TEST(TextModeSessionJournal, RejectsForeignAndTruncatedData)
+{
+	std::string error = {};
+	EXPECT_FALSE(textmode::DecodeJournal("", error));
+	EXPECT_FALSE(textmode::DecodeJournal("PNG\1\0\0", error));
+	EXPECT_EQ(error, "not a session journal");
+	EXPECT_FALSE(textmode::DecodeJournal(std::string("DBXJ\2", 5), error));
+
+	const auto data = textmode::EncodeJournal(make_session());
+	// Cut inside the first frame hash, after the second entry's tick, inside
+	// its key, and inside the last hash
+	for (const size_t length : {size_t{10}, size_t{16}, size_t{18}, data.size() - 1}) {
+		EXPECT_FALSE(textmode::DecodeJournal(data.substr(0, length), error)) << length;
+		EXPECT_EQ(error, "session journal is truncated");
+	}
+
+	// A header without entries is an empty session
+	const auto empty = textmode::DecodeJournal(data.substr(0, 5), error);
+	ASSERT_TRUE(empty);
+	EXPECT_TRUE(empty->empty());
+}
+
+TEST(TextModeSessionJournal, MapsKeyboardCommands)
+{
+	const auto entry = textmode::ParseKeyCommand("DOWN LeftCtrl", 42);
+	ASSERT_TRUE(entry);
+	EXPECT_EQ(entry->tick, 42u);
+	EXPECT_EQ(entry->kind, JournalEntry::Kind::Down);
+	EXPECT_EQ(entry->key, "LeftCtrl");
+	EXPECT_EQ(textmode::FormatKeyCommand(*entry), "DOWN LeftCtrl");
+
+	EXPECT_FALSE(textmode::ParseKeyCommand("PRESS", 0));
+	EXPECT_FALSE(textmode::ParseKeyCommand("TYPE abc", 0));
+}
+
+TEST(TextModeSessionJournal, FrameHashIsStable)
+{
+	// FNV-1a reference values
+	EXPECT_EQ(textmode::HashFrame(""), 0xcbf29ce484222325u);
+	EXPECT_EQ(textmode::HashFrame("a"), 0xaf63dc4c8601ec8cu);
+	EXPECT_NE(textmode::HashFrame("C:\\>"), textmode::HashFrame("C:\\> "));
+}
+
+} // namespace
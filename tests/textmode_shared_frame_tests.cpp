@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/shared_frame.h"
+
+#include <gtest/gtest.h>
+
+#if !defined(WIN32)
+
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+using textmode::SharedFrameExport;
+using textmode::Snapshot;
+
+std::string unique_name(const char* suffix)
+{
+	return "dosbox-textmode-test-" + std::to_string(getpid()) + "-" + suffix;
+}
+
+Snapshot make_snapshot()
+{
+	Snapshot snapshot       = {};
+	snapshot.columns        = 4;
+	snapshot.rows           = 2;
+	snapshot.cursor.row     = 1;
+	snapshot.cursor.column  = 3;
+	snapshot.cursor.enabled = true;
+	snapshot.cursor.visible = true;
+	snapshot.cells.resize(8);
+	for (size_t i = 0; i < snapshot.cells.size(); ++i) {
+		snapshot.cells[i].character = static_cast<uint8_t>('A' + i);
+		snapshot.cells[i].attribute = static_cast<uint8_t>(0x10 + i);
+	}
+	return snapshot;
+}
+
+TEST(SharedFrameExportTest, PublishedFrameRoundTrips)
+{
+	SharedFrameExport shared = {};
+	ASSERT_TRUE(shared.Open(unique_name("roundtrip")));
+
+	const auto published = make_snapshot();
+	shared.Publish(&published, 7);
+
+	Snapshot copy       = {};
+	uint64_t generation = 0;
+	ASSERT_TRUE(textmode::ReadSharedFrame(shared.Data(), copy, generation));
+	EXPECT_EQ(generation, 7u);
+	EXPECT_EQ(copy.columns, 4);
+	EXPECT_EQ(copy.rows, 2);
+	EXPECT_EQ(copy.cursor.row, 1);
+	EXPECT_EQ(copy.cursor.column, 3);
+	EXPECT_TRUE(copy.cursor.enabled);
+	EXPECT_TRUE(copy.cursor.visible);
+	ASSERT_EQ(copy.cells.size(), published.cells.size());
+	for (size_t i = 0; i < copy.cells.size(); ++i) {
+		EXPECT_EQ(copy.cells[i].character, published.cells[i].character);
+		EXPECT_EQ(copy.cells[i].attribute, published.cells[i].attribute);
+	}
+
+	const auto* header = static_cast<const textmode::SharedFrameHeader*>(
+	        shared.Data());
+	EXPECT_EQ(header->sequence.load() % 2, 0u);
+}
+
+TEST(SharedFrameExportTest, NonTextFramesArePublishedEmpty)
+{
+	SharedFrameExport shared = {};
+	ASSERT_TRUE(shared.Open(unique_name("empty")));
+
+	const auto published = make_snapshot();
+	shared.Publish(&published, 1);
+	shared.Publish(nullptr, 2);
+
+	Snapshot copy       = {};
+	uint64_t generation = 0;
+	ASSERT_TRUE(textmode::ReadSharedFrame(shared.Data(), copy, generation));
+	EXPECT_EQ(generation, 2u);
+	EXPECT_EQ(copy.columns, 0);
+	EXPECT_EQ(copy.rows, 0);
+	EXPECT_TRUE(copy.cells.empty());
+}
+
+TEST(SharedFrameExportTest, SegmentIsVisibleToOtherMappings)
+{
+	const auto name          = unique_name("mapping");
+	SharedFrameExport shared = {};
+	ASSERT_TRUE(shared.Open(name));
+
+	const auto published = make_snapshot();
+	shared.Publish(&published, 3);
+
+	const auto path = "/" + name;
+	const int fd    = shm_open(path.c_str(), O_RDONLY, 0);
+	ASSERT_GE(fd, 0);
+	void* segment = mmap(nullptr, textmode::SharedFrameSize, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	ASSERT_NE(segment, MAP_FAILED);
+
+	Snapshot copy       = {};
+	uint64_t generation = 0;
+	EXPECT_TRUE(textmode::ReadSharedFrame(segment, copy, generation));
+	EXPECT_EQ(generation, 3u);
+	EXPECT_EQ(copy.cells.size(), published.cells.size());
+	munmap(segment, textmode::SharedFrameSize);
+
+	shared.Close();
+	EXPECT_LT(shm_open(path.c_str(), O_RDONLY, 0), 0);
+}
+
+TEST(SharedFrameExportTest, RejectsForeignSegments)
+{
+	std::vector<uint8_t> bogus(textmode::SharedFrameSize, 0);
+	Snapshot copy       = {};
+	uint64_t generation = 0;
+	EXPECT_FALSE(textmode::ReadSharedFrame(bogus.data(), copy, generation));
+}
+
+} // namespace
+
+#endif // !WIN32
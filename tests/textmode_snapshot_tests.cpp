@@ -122,4 +122,154 @@ const auto snapshot = CaptureSnapshot(state);
 	EXPECT_EQ(snapshot->cells[1].attribute, 0xBB);
 }
 
+TEST_F(TextModeSnapshotTest, WrapsRowsInsideNonPowerOfTwoMemory)
+{
+	constexpr uint16_t columns       = 4;
+	constexpr uint16_t rows          = 3;
+	constexpr uint32_t char_height   = 16;
+	constexpr uint32_t bytes_per_row = 10;
+	constexpr uint32_t memory_size   = 100;
+
+	std::vector<uint8_t> vram(memory_size);
+	for (uint32_t i = 0; i < memory_size; ++i) {
+		vram[i] = static_cast<uint8_t>(i);
+	}
+
+	VgaType state{};
+	state.mode                    = M_TEXT;
+	state.mem.linear              = vram.data();
+	state.vmemwrap                = memory_size;
+	state.draw.blocks             = columns;
+	state.draw.address_line_total = char_height;
+	state.draw.lines_total        = rows * char_height;
+	state.draw.address_add        = bytes_per_row;
+	state.draw.byte_panning_shift = 2;
+	// Row 0 fits before the end, row 1 crosses it, row 2 starts past it
+	state.config.real_start = 44;
+
+	const auto snapshot = CaptureSnapshot(state);
+	ASSERT_TRUE(snapshot.has_value());
+	EXPECT_EQ(snapshot->display_start, 88u);
+	for (uint16_t row = 0; row < rows; ++row) {
+		const uint32_t base = 88 + row * bytes_per_row;
+		for (uint16_t col = 0; col < columns; ++col) {
+			const auto& cell = snapshot->cells[row * columns + col];
+			EXPECT_EQ(cell.character, (base + col * 2) % memory_size) << row << "," << col;
+			EXPECT_EQ(cell.attribute, (base + col * 2 + 1) % memory_size) << row << "," << col;
+		}
+	}
+}
+
+TEST_F(TextModeSnapshotTest, LatchKeepsLastCompleteFrame)
+{
+	constexpr uint16_t columns     = 2;
+	constexpr uint16_t rows        = 1;
+	constexpr uint32_t char_height = 16;
+
+	std::vector<uint8_t> vram(32);
+	vram[0] = 'A';
+	vram[2] = 'B';
+
+	VgaType state{};
+	state.mode                    = M_TEXT;
+	state.mem.linear              = vram.data();
+	state.tandy.draw_base         = vram.data();
+	state.vmemwrap                = static_cast<uint32_t>(vram.size());
+	state.draw.blocks             = columns;
+	state.draw.address_line_total = char_height;
+	state.draw.lines_total        = rows * char_height;
+	state.draw.address_add        = columns * 2;
+	state.draw.byte_panning_shift = 2;
+
+	textmode::SnapshotLatch latch;
+	EXPECT_EQ(latch.Latest(), nullptr);
+
+	latch.Latch(state);
+	ASSERT_NE(latch.Latest(), nullptr);
+	EXPECT_EQ(latch.Generation(), 1u);
+	EXPECT_EQ(latch.Latest()->cells[0].character, 'A');
+
+	// Writes between retraces are not visible until the next latch
+	vram[0] = 'C';
+	EXPECT_EQ(latch.Latest()->cells[0].character, 'A');
+
+	latch.Latch(state);
+	EXPECT_EQ(latch.Generation(), 2u);
+	EXPECT_EQ(latch.Latest()->cells[0].character, 'C');
+	EXPECT_EQ(latch.Latest()->cells[1].character, 'B');
+
+	state.mode = M_VGA;
+	latch.Latch(state);
+	EXPECT_EQ(latch.Latest(), nullptr);
+}
+
+TEST_F(TextModeSnapshotTest, LatchContentGenerationTracksChanges)
+{
+	std::vector<uint8_t> vram(32);
+
+	VgaType state{};
+	state.mode                    = M_TEXT;
+	state.mem.linear              = vram.data();
+	state.tandy.draw_base         = vram.data();
+	state.vmemwrap                = static_cast<uint32_t>(vram.size());
+	state.draw.blocks             = 2;
+	state.draw.address_line_total = 16;
+	state.draw.lines_total        = 16;
+	state.draw.address_add        = 4;
+	state.draw.byte_panning_shift = 2;
+
+	textmode::SnapshotLatch latch;
+	EXPECT_EQ(latch.ContentGeneration(), 0u);
+
+	latch.Latch(state);
+	EXPECT_EQ(latch.ContentGeneration(), 1u);
+	latch.Latch(state);
+	latch.Latch(state);
+	EXPECT_EQ(latch.ContentGeneration(), 1u);
+	EXPECT_EQ(latch.Generation(), 3u);
+
+	vram[3] = 0x1E;
+	latch.Latch(state);
+	EXPECT_EQ(latch.ContentGeneration(), 2u);
+
+	state.mode = M_VGA;
+	latch.Latch(state);
+	EXPECT_EQ(latch.ContentGeneration(), 3u);
+	latch.Latch(state);
+	EXPECT_EQ(latch.ContentGeneration(), 3u);
+}
+
+TEST_F(TextModeSnapshotTest, CropsRegionAndRebasesCursor)
+{
+	Snapshot screen = {};
+	screen.columns  = 4;
+	screen.rows     = 3;
+	for (uint8_t i = 0; i < 12; ++i) {
+		screen.cells.push_back({static_cast<uint8_t>('A' + i), 0x07});
+	}
+	screen.cursor = {true, true, 2, 2};
+
+	const auto region = textmode::ClipRegion({1, 1, 5, 2}, screen.columns, screen.rows);
+	EXPECT_EQ(region, (textmode::TextRegion{1, 1, 2, 2}));
+
+	const auto cropped = textmode::CropSnapshot(screen, region);
+	EXPECT_EQ(cropped.columns, 2);
+	EXPECT_EQ(cropped.rows, 2);
+	ASSERT_EQ(cropped.cells.size(), 4u);
+	EXPECT_EQ(cropped.cells[0].character, 'F');
+	EXPECT_EQ(cropped.cells[1].character, 'G');
+	EXPECT_EQ(cropped.cells[2].character, 'J');
+	EXPECT_EQ(cropped.cells[3].character, 'K');
+	EXPECT_TRUE(cropped.cursor.visible);
+	EXPECT_EQ(cropped.cursor.row, 1);
+	EXPECT_EQ(cropped.cursor.column, 1);
+
+	const auto outside = textmode::CropSnapshot(screen, {0, 0, 1, 4});
+	EXPECT_TRUE(outside.cursor.enabled);
+	EXPECT_FALSE(outside.cursor.visible);
+
+	const auto empty = textmode::ClipRegion({3, 0, 1, 1}, screen.columns, screen.rows);
+	EXPECT_EQ(empty.rows, 0);
+}
+
 } // namespace
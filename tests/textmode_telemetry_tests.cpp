@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/telemetry.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+namespace {
+
+using namespace std::chrono_literals;
+using textmode::LatencyHistogram;
+
+TEST(LatencyHistogramTest, BucketsByPowerOfTwoMicroseconds)
+{
+	LatencyHistogram histogram;
+	histogram.Record(0us);
+	histogram.Record(1us);
+	histogram.Record(3us);
+	histogram.Record(1500us);
+
+	const auto& buckets = histogram.Buckets();
+	EXPECT_EQ(buckets[0], 1u);
+	EXPECT_EQ(buckets[1], 1u);
+	EXPECT_EQ(buckets[2], 1u);
+	EXPECT_EQ(buckets[11], 1u);
+	EXPECT_EQ(histogram.Count(), 4u);
+	EXPECT_EQ(histogram.TotalMicros(), 1504u);
+	EXPECT_EQ(histogram.MaxMicros(), 1500u);
+}
+
+TEST(LatencyHistogramTest, ReportsPercentileBucketBounds)
+{
+	LatencyHistogram histogram;
+	EXPECT_EQ(histogram.PercentileMicros(50), 0u);
+
+	for (int i = 0; i < 99; ++i) {
+		histogram.Record(10us);
+	}
+	histogram.Record(100s);
+
+	EXPECT_EQ(histogram.PercentileMicros(50), 16u);
+	EXPECT_EQ(histogram.PercentileMicros(99), 16u);
+	EXPECT_EQ(histogram.PercentileMicros(100), 100'000'000u);
+}
+
+TEST(LatencyHistogramTest, SerialisesToJson)
+{
+	LatencyHistogram histogram;
+	histogram.Record(2us);
+
+	EXPECT_EQ(histogram.ToJson(),
+	          "{\"count\":1,\"total_us\":2,\"max_us\":2,\"p50_us\":2,\"p99_us\":2,"
+	          "\"buckets\":[0,0,1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0]}");
+}
+
+TEST(LatencyHistogramTest, SerialisesToOpenMetrics)
+{
+	LatencyHistogram histogram;
+	histogram.Record(2us);
+	histogram.Record(1500us);
+	histogram.Record(100s);
+
+	std::string out = {};
+	histogram.AppendOpenMetrics(out, "latency_seconds", "verb=\"GET\"");
+
+	// Buckets are cumulative and bounded in seconds
+	EXPECT_NE(out.find("latency_seconds_bucket{verb=\"GET\",le=\"0.000002\"} 0\n"),
+	          std::string::npos);
+	EXPECT_NE(out.find("latency_seconds_bucket{verb=\"GET\",le=\"0.000004\"} 1\n"),
+	          std::string::npos);
+	EXPECT_NE(out.find("latency_seconds_bucket{verb=\"GET\",le=\"0.002048\"} 2\n"),
+	          std::string::npos);
+	EXPECT_NE(out.find("latency_seconds_bucket{verb=\"GET\",le=\"4.194304\"} 2\n"),
+	          std::string::npos);
+	EXPECT_NE(out.find("latency_seconds_bucket{verb=\"GET\",le=\"+Inf\"} 3\n"),
+	          std::string::npos);
+	EXPECT_NE(out.find("latency_seconds_count{verb=\"GET\"} 3\n"), std::string::npos);
+	EXPECT_NE(out.find("latency_seconds_sum{verb=\"GET\"} 100.001502\n"),
+	          std::string::npos);
+
+	out.clear();
+	LatencyHistogram{}.AppendOpenMetrics(out, "idle_seconds", {});
+	EXPECT_NE(out.find("idle_seconds_bucket{le=\"0.000001\"} 0\n"), std::string::npos);
+	EXPECT_NE(out.find("idle_seconds_sum 0\n"), std::string::npos);
+}
+
+} // namespace
@@ -0,0 +1,301 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/threaded_backend.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using textmode::BackendEvent;
+using textmode::ClientHandle;
+using textmode::NetworkBackend;
+
+struct SentPayload {
+	ClientHandle client = 0;
+	std::string payload = {};
+	std::thread::id thread = {};
+};
+
+// Shared with the test body, so every member is guarded by 'mutex'
+struct FakeState {
+	std::mutex mutex = {};
+	std::vector<BackendEvent> pending = {};
+	std::vector<SentPayload> sent = {};
+	std::vector<ClientHandle> closed = {};
+	bool fail_sends = false;
+	size_t max_clients = 0;
+	// Reported as every client's unsent bytes
+	size_t queued_bytes = 0;
+};
+
+class FakeBackend : public NetworkBackend {
+public:
+	explicit FakeBackend(std::shared_ptr<FakeState> state)
+	        : m_state(std::move(state))
+	{}
+
+	bool Start(uint16_t) override { return true; }
+	void Stop() override {}
+
+	std::vector<BackendEvent> Poll() override
+	{
+		std::lock_guard lock(m_state->mutex);
+		return std::exchange(m_state->pending, {});
+	}
+
+	bool Send(const ClientHandle client, const std::string& payload) override
+	{
+		std::lock_guard lock(m_state->mutex);
+		m_state->sent.push_back({client, payload, std::this_thread::get_id()});
+		return !m_state->fail_sends;
+	}
+
+	void Close(const ClientHandle client) override
+	{
+		std::lock_guard lock(m_state->mutex);
+		m_state->closed.push_back(client);
+	}
+
+	void SetMaxClients(const size_t max_clients) override
+	{
+		std::lock_guard lock(m_state->mutex);
+		m_state->max_clients = max_clients;
+	}
+
+	size_t QueuedBytes(ClientHandle) const override
+	{
+		std::lock_guard lock(m_state->mutex);
+		return m_state->queued_bytes;
+	}
+
+private:
+	std::shared_ptr<FakeState> m_state;
+};
+
+class ThreadedBackendTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		state   = std::make_shared<FakeState>();
+		backend = textmode::MakeThreadedBackend(std::make_unique<FakeBackend>(state));
+		backend->SetMaxClients(5);
+		ASSERT_TRUE(backend->Start(6000));
+	}
+
+	void TearDown() override { backend->Stop(); }
+
+	void Queue(BackendEvent event)
+	{
+		std::lock_guard lock(state->mutex);
+		state->pending.push_back(std::move(event));
+	}
+
+	// Polls until 'count' events arrived or the deadline passes
+	std::vector<BackendEvent> PollFor(const size_t count)
+	{
+		std::vector<BackendEvent> received;
+		const auto deadline = std::chrono::steady_clock::now() +
+		                      std::chrono::seconds(2);
+		while (received.size() < count &&
+		       std::chrono::steady_clock::now() < deadline) {
+			for (auto& event : backend->Poll()) {
+				received.push_back(std::move(event));
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return received;
+	}
+
+	bool WaitUntil(const std::function<bool(const FakeState&)>& predicate)
+	{
+		const auto deadline = std::chrono::steady_clock::now() +
+		                      std::chrono::seconds(2);
+		while (std::chrono::steady_clock::now() < deadline) {
+			{
+				std::lock_guard lock(state->mutex);
+				if (predicate(*state)) {
+					return true;
+				}
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return false;
+	}
+
+	std::shared_ptr<FakeState> state = {};
+	std::unique_ptr<NetworkBackend> backend = {};
+};
+
+TEST_F(ThreadedBackendTest, ForwardsClientLimitOnStart)
+{
+	std::lock_guard lock(state->mutex);
+	EXPECT_EQ(state->max_clients, 5u);
+}
+
+TEST_F(ThreadedBackendTest, DeliversEventsThroughPoll)
+{
+	Queue(BackendEvent::Connected(7));
+	Queue(BackendEvent::Data(7, "GET\n"));
+
+	const auto events = PollFor(2);
+	ASSERT_EQ(events.size(), 2u);
+	EXPECT_EQ(events[0].type, BackendEvent::Type::Connected);
+	EXPECT_EQ(events[1].type, BackendEvent::Type::Data);
+	EXPECT_EQ(events[1].data, "GET\n");
+}
+
+TEST_F(ThreadedBackendTest, SendsOnNetworkThread)
+{
+	Queue(BackendEvent::Connected(7));
+	ASSERT_EQ(PollFor(1).size(), 1u);
+
+	ASSERT_TRUE(backend->Send(7, "OK\n"));
+	ASSERT_TRUE(WaitUntil([](const FakeState& s) { return !s.sent.empty(); }));
+
+	std::lock_guard lock(state->mutex);
+	EXPECT_EQ(state->sent[0].payload, "OK\n");
+	EXPECT_NE(state->sent[0].thread, std::this_thread::get_id());
+}
+
+TEST_F(ThreadedBackendTest, ReportsBytesTheInnerBackendHolds)
+{
+	Queue(BackendEvent::Connected(7));
+	ASSERT_EQ(PollFor(1).size(), 1u);
+	{
+		std::lock_guard lock(state->mutex);
+		state->queued_bytes = 500;
+	}
+
+	ASSERT_TRUE(backend->Send(7, "OK\n"));
+	const auto reported = [&](const size_t bytes) {
+		const auto deadline = std::chrono::steady_clock::now() +
+		                      std::chrono::seconds(2);
+		while (backend->QueuedBytes(7) != bytes) {
+			if (std::chrono::steady_clock::now() >= deadline) {
+				return false;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		return true;
+	};
+	EXPECT_TRUE(reported(500));
+
+	{
+		std::lock_guard lock(state->mutex);
+		state->queued_bytes = 0;
+	}
+	EXPECT_TRUE(reported(0));
+
+	backend->Close(7);
+	EXPECT_EQ(backend->QueuedBytes(7), 0u);
+}
+
+TEST_F(ThreadedBackendTest, RejectsSendsToUnknownClients)
+{
+	EXPECT_FALSE(backend->Send(9, "OK\n"));
+}
+
+TEST_F(ThreadedBackendTest, ReportsFailedSendsAsClosed)
+{
+	{
+		std::lock_guard lock(state->mutex);
+		state->fail_sends = true;
+	}
+	Queue(BackendEvent::Connected(7));
+	ASSERT_EQ(PollFor(1).size(), 1u);
+
+	ASSERT_TRUE(backend->Send(7, "OK\n"));
+	const auto events = PollFor(1);
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_EQ(events[0].type, BackendEvent::Type::Closed);
+	EXPECT_EQ(events[0].client, 7u);
+	EXPECT_FALSE(backend->Send(7, "again\n"));
+}
+
+TEST_F(ThreadedBackendTest, DropsEventsForClosedClients)
+{
+	Queue(BackendEvent::Connected(7));
+	ASSERT_EQ(PollFor(1).size(), 1u);
+
+	backend->Close(7);
+	ASSERT_TRUE(WaitUntil([](const FakeState& s) { return !s.closed.empty(); }));
+
+	Queue(BackendEvent::Data(7, "late\n"));
+	Queue(BackendEvent::Connected(8));
+	const auto events = PollFor(1);
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_EQ(events[0].client, 8u);
+}
+
+TEST_F(ThreadedBackendTest, ParksSendsWhileSuspendedForFork)
+{
+	Queue(BackendEvent::Connected(7));
+	ASSERT_EQ(PollFor(1).size(), 1u);
+
+	backend->SuspendForFork();
+	ASSERT_TRUE(backend->Send(7, "OK\n"));
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	{
+		std::lock_guard lock(state->mutex);
+		EXPECT_TRUE(state->sent.empty());
+	}
+
+	backend->ResumeAfterFork();
+	ASSERT_TRUE(WaitUntil([](const FakeState& s) { return !s.sent.empty(); }));
+}
+
+TEST_F(ThreadedBackendTest, ClosesWithoutWaitingOnAFullQueue)
+{
+	Queue(BackendEvent::Connected(7));
+	Queue(BackendEvent::Connected(8));
+	ASSERT_EQ(PollFor(2).size(), 2u);
+
+	// Nothing drains the requests while suspended
+	backend->SuspendForFork();
+	while (backend->Send(7, "x")) {
+	}
+	backend->Close(8);
+	backend->ResumeAfterFork();
+
+	// Polling hands the close over once the network thread made room
+	const auto deadline = std::chrono::steady_clock::now() +
+	                      std::chrono::seconds(2);
+	bool closed = false;
+	while (!closed && std::chrono::steady_clock::now() < deadline) {
+		backend->Poll();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+		std::lock_guard lock(state->mutex);
+		closed = std::find(state->closed.begin(), state->closed.end(), 8u) !=
+		         state->closed.end();
+	}
+	EXPECT_TRUE(closed);
+}
+
+TEST_F(ThreadedBackendTest, AbandonForgetsClientsQuietly)
+{
+	Queue(BackendEvent::Connected(7));
+	ASSERT_EQ(PollFor(1).size(), 1u);
+
+	backend->SuspendForFork();
+	backend->AbandonAfterFork();
+	EXPECT_FALSE(backend->Send(7, "OK\n"));
+	backend->Close(7);
+
+	std::lock_guard lock(state->mutex);
+	EXPECT_TRUE(state->sent.empty());
+	EXPECT_TRUE(state->closed.empty());
+}
+
+} // namespace
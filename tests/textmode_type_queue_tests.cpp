@@ -5,6 +5,8 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
 #include <string>
 #include <vector>
 
@@ -149,4 +151,279 @@ TEST(QueuedTypeActionSinkTest, CancelsPendingRequestOnClientClose)
 	EXPECT_EQ(sink_backend.closed.front(), 7u);
 }
 
+textmode::ServiceResult MakeTextResult(const char character, const uint64_t generation)
+{
+	textmode::ServiceResult result{true, std::string("FRAME ") + character + "\n", ""};
+	textmode::Snapshot snapshot{};
+	snapshot.columns  = 1;
+	snapshot.rows     = 1;
+	snapshot.cells    = {textmode::TextCell{static_cast<uint8_t>(character), 0x07}};
+	result.snapshot   = snapshot;
+	result.generation = generation;
+	return result;
+}
+
+TEST(QueuedTypeActionSinkTest, WaitRepliesOnceFrameMatches)
+{
+	FakeResponseSink sink_backend;
+	QueuedTypeActionSink sink(
+	        [&](uintptr_t client, const std::string& payload) {
+		return sink_backend.Send(client, payload);
+	},
+	        [&](uintptr_t client) { sink_backend.Close(client); });
+
+	char character = 'a';
+	uint64_t generation = 1;
+	int matches = 0;
+	textmode::WaitPlan plan{};
+	plan.timeout = std::chrono::seconds(60);
+	plan.matches = [&](const textmode::Snapshot& snapshot) {
+		++matches;
+		return snapshot.cells[0].character == 'b';
+	};
+
+	bool completion_success = false;
+	const auto response = sink.ExecuteWait(plan,
+	                                       CommandOrigin(5),
+	                                       [&] { return MakeTextResult(character, generation); },
+	                                       [&](bool success) { completion_success = success; });
+	EXPECT_TRUE(response.deferred);
+
+	sink.Poll();
+	sink.Poll(); // same generation, so not matched again
+	EXPECT_EQ(matches, 1);
+	EXPECT_TRUE(sink_backend.events.empty());
+
+	character  = 'b';
+	generation = 2;
+	sink.Poll();
+	ASSERT_EQ(sink_backend.events.size(), 1u);
+	EXPECT_EQ(sink_backend.events[0].client, 5u);
+	EXPECT_EQ(sink_backend.events[0].payload, "FRAME b\n");
+	EXPECT_TRUE(completion_success);
+
+	sink.Poll();
+	EXPECT_EQ(sink_backend.events.size(), 1u);
+}
+
+TEST(QueuedTypeActionSinkTest, WaitFetchesFramesOnlyWhenTheGenerationChanges)
+{
+	FakeResponseSink sink_backend;
+	QueuedTypeActionSink sink(
+	        [&](uintptr_t client, const std::string& payload) {
+		return sink_backend.Send(client, payload);
+	},
+	        [&](uintptr_t client) { sink_backend.Close(client); });
+
+	char character      = 'a';
+	uint64_t generation = 0;
+	int fetches         = 0;
+	textmode::WaitPlan plan{};
+	plan.timeout    = std::chrono::seconds(60);
+	plan.matches    = [&](const textmode::Snapshot& snapshot) {
+		return snapshot.cells[0].character == 'b';
+	};
+	plan.generation = [&] { return generation; };
+
+	sink.ExecuteWait(plan,
+	                 CommandOrigin(5),
+	                 [&] {
+		                 ++fetches;
+		                 return MakeTextResult(character, generation);
+	                 },
+	                 {});
+
+	sink.Poll(); // no frame yet
+	EXPECT_EQ(fetches, 0);
+
+	generation = 1;
+	sink.Poll();
+	sink.Poll();
+	EXPECT_EQ(fetches, 1);
+	EXPECT_TRUE(sink_backend.events.empty());
+
+	character  = 'b';
+	generation = 2;
+	sink.Poll();
+	EXPECT_EQ(fetches, 2);
+	ASSERT_EQ(sink_backend.events.size(), 1u);
+	EXPECT_EQ(sink_backend.events[0].payload, "FRAME b\n");
+}
+
+TEST(QueuedTypeActionSinkTest, DeferredRepliesCarryRequestId)
+{
+	FakeResponseSink sink_backend;
+	QueuedTypeActionSink sink(
+	        [&](uintptr_t client, const std::string& payload) {
+		return sink_backend.Send(client, payload);
+	},
+	        [&](uintptr_t client) { sink_backend.Close(client); });
+
+	textmode::WaitPlan plan{};
+	plan.timeout = std::chrono::seconds(60);
+	plan.matches = [](const textmode::Snapshot&) { return true; };
+
+	sink.ExecuteWait(plan,
+	                 CommandOrigin(5, 12),
+	                 [] { return MakeTextResult('a', 1); },
+	                 {});
+	sink.Poll();
+
+	ASSERT_EQ(sink_backend.events.size(), 1u);
+	EXPECT_EQ(sink_backend.events[0].payload, "#12 FRAME a\n");
+}
+
+TEST(QueuedTypeActionSinkTest, WaitTimesOut)
+{
+	FakeResponseSink sink_backend;
+	QueuedTypeActionSink sink(
+	        [&](uintptr_t client, const std::string& payload) {
+		return sink_backend.Send(client, payload);
+	},
+	        [&](uintptr_t client) { sink_backend.Close(client); });
+
+	textmode::WaitPlan plan{};
+	plan.timeout = std::chrono::milliseconds(0);
+	plan.matches = [](const textmode::Snapshot&) { return false; };
+
+	bool completion_called = false;
+	bool completion_success = true;
+	sink.ExecuteWait(plan,
+	                 CommandOrigin(5),
+	                 [] { return MakeTextResult('a', 1); },
+	                 [&](bool success) {
+		completion_called  = true;
+		completion_success = success;
+	});
+
+	sink.Poll();
+	ASSERT_EQ(sink_backend.events.size(), 1u);
+	EXPECT_EQ(sink_backend.events[0].payload, "ERR WAITFOR timeout\n");
+	EXPECT_TRUE(completion_called);
+	EXPECT_FALSE(completion_success);
+}
+
+TEST(QueuedTypeActionSinkTest, ClientsOnlyWaitForEachOtherAtTheKeyboard)
+{
+	FakeResponseSink sink_backend;
+	QueuedTypeActionSink sink(
+	        [&](uintptr_t client, const std::string& payload) {
+		return sink_backend.Send(client, payload);
+	},
+	        [&](uintptr_t client) { sink_backend.Close(client); });
+
+	std::vector<std::string> keyboard_commands;
+	const auto keyboard_handler = [&](const std::string& cmd) {
+		keyboard_commands.push_back(cmd);
+		return CommandResponse{true, "OK\n"};
+	};
+	const auto frame_provider = [] {
+		return textmode::ServiceResult{true, "FRAME\n", ""};
+	};
+	const auto make_action = [](const TypeAction::Kind kind, const std::string& key,
+	                            const uint32_t frames = 0) {
+		TypeAction action{};
+		action.kind   = kind;
+		action.key    = key;
+		action.frames = frames;
+		return action;
+	};
+
+	// A long chord from the first client...
+	TypeCommandPlan chord;
+	chord.actions.push_back(make_action(TypeAction::Kind::Down, "LeftShift"));
+	chord.actions.push_back(make_action(TypeAction::Kind::DelayFrames, "", 5));
+	chord.actions.push_back(make_action(TypeAction::Kind::Up, "LeftShift"));
+	chord.request_frame = true;
+	sink.Execute(chord, CommandOrigin(1), keyboard_handler, frame_provider, {});
+
+	// ...doesn't hold up a frame-only request from the second...
+	TypeCommandPlan view;
+	view.actions.push_back(make_action(TypeAction::Kind::DelayFrames, "", 1));
+	view.request_frame = true;
+	sink.Execute(view, CommandOrigin(2), keyboard_handler, frame_provider, {});
+
+	// ...while keystrokes from the third wait until the chord is released
+	TypeCommandPlan press;
+	press.actions.push_back(make_action(TypeAction::Kind::Press, "A"));
+	press.request_frame = true;
+	sink.Execute(press, CommandOrigin(3), keyboard_handler, frame_provider, {});
+
+	EXPECT_EQ(sink.Telemetry().pending, 3u);
+
+	auto replied = [&](const uintptr_t client) {
+		return std::any_of(sink_backend.events.begin(),
+		                   sink_backend.events.end(),
+		                   [&](const auto& event) { return event.client == client; });
+	};
+
+	for (int poll = 0; poll < 3; ++poll) {
+		sink.Poll();
+	}
+	EXPECT_TRUE(replied(2));
+	EXPECT_FALSE(replied(1));
+	EXPECT_EQ(keyboard_commands, std::vector<std::string>{"DOWN LeftShift"});
+
+	for (int poll = 0; poll < 20; ++poll) {
+		sink.Poll();
+	}
+	EXPECT_TRUE(replied(1));
+	EXPECT_TRUE(replied(3));
+	EXPECT_EQ(keyboard_commands,
+	          (std::vector<std::string>{"DOWN LeftShift", "UP LeftShift", "PRESS A"}));
+	EXPECT_EQ(sink.Telemetry().pending, 0u);
+}
+
+TEST(QueuedTypeActionSinkTest, GuestPacedTypingWaitsForTheKeyToBeRead)
+{
+	FakeResponseSink sink_backend;
+	QueuedTypeActionSink sink(
+	        [&](uintptr_t client, const std::string& payload) {
+		return sink_backend.Send(client, payload);
+	},
+	        [&](uintptr_t client) { sink_backend.Close(client); });
+	sink.SetInterTokenFrameDelay(10);
+
+	bool keyboard_ready = false;
+	sink.SetKeyboardReadyProbe([&] { return keyboard_ready; });
+
+	std::vector<std::string> keyboard_commands;
+	const auto keyboard_handler = [&](const std::string& cmd) {
+		keyboard_commands.push_back(cmd);
+		return CommandResponse{true, "OK\n"};
+	};
+
+	TypeCommandPlan plan;
+	for (const auto* key : {"A", "B", "C"}) {
+		TypeAction press{};
+		press.kind = TypeAction::Kind::Press;
+		press.key  = key;
+		plan.actions.push_back(press);
+	}
+	plan.request_frame = true;
+	sink.Execute(plan,
+	             CommandOrigin(1),
+	             keyboard_handler,
+	             [] { return textmode::ServiceResult{true, "FRAME\n", ""}; },
+	             {});
+
+	// Nothing more is typed until the guest has read the key...
+	for (int poll = 0; poll < 5; ++poll) {
+		sink.Poll();
+	}
+	EXPECT_EQ(keyboard_commands, std::vector<std::string>{"PRESS A"});
+
+	// ...and then the next key follows straight away rather than after
+	// the inter-token delay
+	keyboard_ready = true;
+	sink.Poll();
+	sink.Poll();
+	EXPECT_EQ(keyboard_commands,
+	          (std::vector<std::string>{"PRESS A", "PRESS B", "PRESS C"}));
+
+	sink.Poll();
+	ASSERT_EQ(sink_backend.events.size(), 1u);
+	EXPECT_EQ(sink_backend.events[0].payload, "FRAME\n");
+}
+
 } // namespace
@@ -0,0 +1,277 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "textmode_server/websocket_backend.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <zlib.h>
+
+namespace {
+
+using textmode::BackendEvent;
+using textmode::ClientHandle;
+using textmode::NetworkBackend;
+
+constexpr ClientHandle Client = 7;
+
+struct FakeState {
+	std::vector<BackendEvent> pending = {};
+	std::vector<std::string> sent     = {};
+	std::vector<ClientHandle> closed  = {};
+};
+
+class FakeBackend : public NetworkBackend {
+public:
+	explicit FakeBackend(std::shared_ptr<FakeState> state)
+	        : m_state(std::move(state))
+	{}
+
+	bool Start(uint16_t) override { return true; }
+	void Stop() override {}
+
+	std::vector<BackendEvent> Poll() override
+	{
+		return std::exchange(m_state->pending, {});
+	}
+
+	bool Send(ClientHandle, const std::string& payload) override
+	{
+		m_state->sent.push_back(payload);
+		return true;
+	}
+
+	void Close(const ClientHandle client) override
+	{
+		m_state->closed.push_back(client);
+	}
+
+private:
+	std::shared_ptr<FakeState> m_state;
+};
+
+// Frames as a browser would send them: always masked
+std::string client_frame(const uint8_t opcode, const std::string& payload,
+                         const bool compressed = false, const bool masked = true)
+{
+	constexpr std::array<uint8_t, 4> mask = {0x12, 0x34, 0x56, 0x78};
+
+	std::string frame;
+	frame.push_back(static_cast<char>(0x80 | (compressed ? 0x40 : 0) | opcode));
+	frame.push_back(static_cast<char>((masked ? 0x80 : 0) | payload.size()));
+	if (masked) {
+		frame.append(reinterpret_cast<const char*>(mask.data()), mask.size());
+	}
+	for (size_t i = 0; i < payload.size(); ++i) {
+		frame.push_back(masked ? static_cast<char>(payload[i] ^ mask[i % 4])
+		                       : payload[i]);
+	}
+	return frame;
+}
+
+struct ServerFrame {
+	uint8_t first_byte  = 0;
+	std::string payload = {};
+};
+
+ServerFrame parse_server_frame(const std::string& frame)
+{
+	const auto* bytes = reinterpret_cast<const uint8_t*>(frame.data());
+	size_t length     = bytes[1] & 0x7f;
+	size_t header     = 2;
+	if (length == 126) {
+		length = (size_t{bytes[2]} << 8) | bytes[3];
+		header = 4;
+	}
+	return {bytes[0], frame.substr(header, length)};
+}
+
+std::string raw_deflate(const std::string& input)
+{
+	z_stream stream = {};
+	deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+	std::string output(input.size() + 64, '\0');
+	stream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+	stream.avail_in  = static_cast<uInt>(input.size());
+	stream.next_out  = reinterpret_cast<Bytef*>(output.data());
+	stream.avail_out = static_cast<uInt>(output.size());
+	deflate(&stream, Z_SYNC_FLUSH);
+	output.resize(output.size() - stream.avail_out - 4);
+	deflateEnd(&stream);
+	return output;
+}
+
+class WebSocketBackendTest : public ::testing::Test {
+protected:
+	void SetUp() override
+	{
+		state   = std::make_shared<FakeState>();
+		backend = textmode::MakeWebSocketBackend(std::make_unique<FakeBackend>(state));
+		ASSERT_TRUE(backend->Start(6000));
+	}
+
+	std::vector<BackendEvent> Deliver(std::vector<BackendEvent> events)
+	{
+		state->pending = std::move(events);
+		return backend->Poll();
+	}
+
+	void Handshake(const std::string& extensions = {})
+	{
+		std::string request =
+		        "GET /textmode HTTP/1.1\r\n"
+		        "Host: localhost\r\n"
+		        "Upgrade: websocket\r\n"
+		        "Connection: Upgrade\r\n"
+		        "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+		        "Sec-WebSocket-Version: 13\r\n";
+		if (!extensions.empty()) {
+			request += "Sec-WebSocket-Extensions: " + extensions + "\r\n";
+		}
+		request += "\r\n";
+
+		const auto events = Deliver({BackendEvent::Connected(Client),
+		                             BackendEvent::Data(Client, request)});
+		ASSERT_EQ(events.size(), 1u);
+		EXPECT_EQ(events[0].type, BackendEvent::Type::Connected);
+		ASSERT_EQ(state->sent.size(), 1u);
+		EXPECT_EQ(state->sent[0].rfind("HTTP/1.1 101 Switching Protocols\r\n", 0), 0u);
+		EXPECT_NE(state->sent[0].find(
+		                  "Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=\r\n"),
+		          std::string::npos);
+	}
+
+	std::shared_ptr<FakeState> state;
+	std::unique_ptr<NetworkBackend> backend;
+};
+
+TEST(WebSocketAcceptKeyTest, MatchesRfcExample)
+{
+	EXPECT_EQ(textmode::WebSocketAcceptKey("dGhlIHNhbXBsZSBub25jZQ=="),
+	          "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=");
+}
+
+TEST_F(WebSocketBackendTest, RawClientsPassThrough)
+{
+	const auto events = Deliver({BackendEvent::Connected(Client),
+	                             BackendEvent::Data(Client, "GET\n")});
+	ASSERT_EQ(events.size(), 2u);
+	EXPECT_EQ(events[0].type, BackendEvent::Type::Connected);
+	EXPECT_EQ(events[1].data, "GET\n");
+
+	ASSERT_TRUE(backend->Send(Client, "frame\n"));
+	ASSERT_EQ(state->sent.size(), 1u);
+	EXPECT_EQ(state->sent[0], "frame\n");
+}
+
+TEST_F(WebSocketBackendTest, MessagesBecomeCommandLines)
+{
+	Handshake();
+	EXPECT_EQ(state->sent[0].find("permessage-deflate"), std::string::npos);
+
+	// Split across reads and without a trailing newline
+	const auto frame = client_frame(0x1, "STATS");
+	EXPECT_TRUE(Deliver({BackendEvent::Data(Client, frame.substr(0, 3))}).empty());
+	const auto events = Deliver({BackendEvent::Data(Client, frame.substr(3))});
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_EQ(events[0].data, "STATS\n");
+
+	ASSERT_TRUE(backend->Send(Client, "requests=1\n"));
+	const auto reply = parse_server_frame(state->sent.back());
+	EXPECT_EQ(reply.first_byte, 0x81);
+	EXPECT_EQ(reply.payload, "requests=1\n");
+
+	// Invalid UTF-8 goes out as a binary message
+	ASSERT_TRUE(backend->Send(Client, std::string("\xff\x00", 2)));
+	EXPECT_EQ(parse_server_frame(state->sent.back()).first_byte, 0x82);
+}
+
+TEST_F(WebSocketBackendTest, NegotiatesPermessageDeflate)
+{
+	Handshake("permessage-deflate; client_max_window_bits");
+	EXPECT_NE(state->sent[0].find("Sec-WebSocket-Extensions: permessage-deflate\r\n"),
+	          std::string::npos);
+
+	const auto events = Deliver(
+	        {BackendEvent::Data(Client, client_frame(0x1, raw_deflate("GET"), true))});
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_EQ(events[0].data, "GET\n");
+
+	std::string frame_text;
+	for (int row = 0; row < 25; ++row) {
+		frame_text += "\x1b[37;44m" + std::string(80, ' ') + "\n";
+	}
+	ASSERT_TRUE(backend->Send(Client, frame_text));
+	ASSERT_TRUE(backend->Send(Client, frame_text));
+	const auto first  = parse_server_frame(state->sent[1]);
+	const auto second = parse_server_frame(state->sent[2]);
+	EXPECT_EQ(first.first_byte, 0xC1);
+	EXPECT_LT(first.payload.size(), frame_text.size() / 10);
+	// The shared context makes the repeated frame nearly free
+	EXPECT_LT(second.payload.size(), first.payload.size());
+
+	z_stream stream = {};
+	ASSERT_EQ(inflateInit2(&stream, -MAX_WBITS), Z_OK);
+	for (const auto* message : {&first, &second}) {
+		auto input = message->payload + std::string("\x00\x00\xff\xff", 4);
+		std::string output(frame_text.size() + 64, '\0');
+		stream.next_in   = reinterpret_cast<Bytef*>(input.data());
+		stream.avail_in  = static_cast<uInt>(input.size());
+		stream.next_out  = reinterpret_cast<Bytef*>(output.data());
+		stream.avail_out = static_cast<uInt>(output.size());
+		inflate(&stream, Z_SYNC_FLUSH);
+		output.resize(output.size() - stream.avail_out);
+		EXPECT_EQ(output, frame_text);
+	}
+	inflateEnd(&stream);
+}
+
+TEST_F(WebSocketBackendTest, AnswersPingsAndCloses)
+{
+	Handshake();
+
+	EXPECT_TRUE(Deliver({BackendEvent::Data(Client, client_frame(0x9, "hi"))}).empty());
+	const auto pong = parse_server_frame(state->sent.back());
+	EXPECT_EQ(pong.first_byte, 0x8A);
+	EXPECT_EQ(pong.payload, "hi");
+
+	const auto events = Deliver(
+	        {BackendEvent::Data(Client, client_frame(0x8, std::string("\x03\xe8", 2)))});
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_EQ(events[0].type, BackendEvent::Type::Closed);
+	EXPECT_EQ(parse_server_frame(state->sent.back()).first_byte, 0x88);
+	EXPECT_EQ(state->closed, std::vector<ClientHandle>{Client});
+	EXPECT_FALSE(backend->Send(Client, "late\n"));
+}
+
+TEST_F(WebSocketBackendTest, RejectsUnmaskedFrames)
+{
+	Handshake();
+
+	const auto events = Deliver(
+	        {BackendEvent::Data(Client, client_frame(0x1, "GET", false, false))});
+	ASSERT_EQ(events.size(), 1u);
+	EXPECT_EQ(events[0].type, BackendEvent::Type::Closed);
+	const auto close = parse_server_frame(state->sent.back());
+	EXPECT_EQ(close.first_byte, 0x88);
+	EXPECT_EQ(close.payload, std::string("\x03\xea", 2));
+}
+
+TEST_F(WebSocketBackendTest, RejectsIncompleteUpgrades)
+{
+	const auto events = Deliver(
+	        {BackendEvent::Connected(Client),
+	         BackendEvent::Data(Client, "GET / HTTP/1.1\r\nHost: x\r\n\r\n")});
+	EXPECT_TRUE(events.empty());
+	ASSERT_EQ(state->sent.size(), 1u);
+	EXPECT_EQ(state->sent[0].rfind("HTTP/1.1 400", 0), 0u);
+	EXPECT_EQ(state->closed, std::vector<ClientHandle>{Client});
+}
+
+} // namespace
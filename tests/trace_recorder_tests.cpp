@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "debugger/trace_recorder.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <zlib.h>
+
+namespace {
+
+using Record = TraceRecorder::Record;
+using Bytes  = std::vector<uint8_t>;
+
+// A minimal reader following the format description, independent of the
+// recorder's implementation
+std::vector<Record> read_trace(const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	const Bytes file((std::istreambuf_iterator<char>(in)),
+	                 std::istreambuf_iterator<char>());
+
+	EXPECT_GE(file.size(), 8u);
+	EXPECT_EQ(std::string(file.begin(), file.begin() + 8), "DBXTRC01");
+
+	auto read_u32 = [&](const size_t pos) {
+		return static_cast<uint32_t>(file[pos] | file[pos + 1] << 8 |
+		                             file[pos + 2] << 16 | file[pos + 3] << 24);
+	};
+
+	std::vector<Record> records = {};
+
+	size_t pos = 8;
+	while (pos + 8 <= file.size()) {
+		const auto raw_size        = read_u32(pos);
+		const auto compressed_size = read_u32(pos + 4);
+		pos += 8;
+
+		Bytes raw(raw_size);
+		uLongf size = raw_size;
+		EXPECT_EQ(uncompress(raw.data(), &size, file.data() + pos, compressed_size),
+		          Z_OK);
+		EXPECT_EQ(size, raw_size);
+		pos += compressed_size;
+
+		size_t i = 0;
+		auto read_varint = [&] {
+			uint32_t value = 0;
+			for (int shift = 0;; shift += 7) {
+				const auto byte = raw[i++];
+				value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+				if (!(byte & 0x80)) {
+					return value;
+				}
+			}
+		};
+
+		Record previous = {};
+		while (i < raw.size()) {
+			const auto changed = read_varint();
+			Record record      = previous;
+			for (size_t f = 0; f < TraceRecorder::NumFields; ++f) {
+				if (!(changed & (1u << f))) {
+					continue;
+				}
+				if (f == TraceRecorder::Eip) {
+					const auto zigzag = read_varint();
+					const auto delta  = (zigzag >> 1) ^ (0 - (zigzag & 1));
+					record[f]         = previous[f] + delta;
+				} else if (f == TraceRecorder::Code) {
+					record[f] = static_cast<uint32_t>(raw[i] | raw[i + 1] << 8 |
+					                                  raw[i + 2] << 16 |
+					                                  raw[i + 3] << 24);
+					i += 4;
+				} else {
+					record[f] = previous[f] ^ read_varint();
+				}
+			}
+			records.push_back(record);
+			previous = record;
+		}
+	}
+	EXPECT_EQ(pos, file.size());
+	return records;
+}
+
+std::string temp_trace_path()
+{
+	return (std::filesystem::temp_directory_path() / "trace_recorder_test.trc")
+	        .string();
+}
+
+TEST(TraceRecorder, RoundTrip)
+{
+	const auto path = temp_trace_path();
+
+	std::vector<Record> records = {};
+
+	Record record = {};
+	record[TraceRecorder::Cs] = 0x1234;
+	for (uint32_t n = 0; n < 1000; ++n) {
+		// Mostly forwards with the odd jump back, as code runs
+		record[TraceRecorder::Eip] = (n % 10 == 9) ? record[TraceRecorder::Eip] - 40
+		                                           : record[TraceRecorder::Eip] + 3;
+		record[TraceRecorder::Code]  = 0x9090'0000 | n;
+		record[TraceRecorder::Eax]   = n;
+		record[TraceRecorder::Flags] = (n & 1) ? 0x202 : 0x246;
+		records.push_back(record);
+	}
+
+	TraceRecorder recorder = {};
+	ASSERT_TRUE(recorder.Open(path));
+	for (const auto& r : records) {
+		recorder.Add(r);
+	}
+	EXPECT_EQ(recorder.NumRecords(), records.size());
+	recorder.Close();
+
+	EXPECT_EQ(read_trace(path), records);
+	std::filesystem::remove(path);
+}
+
+TEST(TraceRecorder, SpansBlocks)
+{
+	const auto path = temp_trace_path();
+
+	// Records with every field changing, enough to fill several blocks
+	std::vector<Record> records = {};
+	uint32_t seed = 1;
+	while (records.size() * 50 < TraceRecorder::BlockSize * 3) {
+		Record record = {};
+		for (auto& value : record) {
+			seed  = seed * 1664525 + 1013904223;
+			value = seed;
+		}
+		records.push_back(record);
+	}
+
+	TraceRecorder recorder = {};
+	ASSERT_TRUE(recorder.Open(path));
+	for (const auto& r : records) {
+		recorder.Add(r);
+	}
+	recorder.Close();
+
+	EXPECT_EQ(read_trace(path), records);
+	std::filesystem::remove(path);
+}
+
+TEST(TraceRecorder, Empty)
+{
+	const auto path = temp_trace_path();
+
+	TraceRecorder recorder = {};
+	ASSERT_TRUE(recorder.Open(path));
+	recorder.Close();
+
+	EXPECT_TRUE(read_trace(path).empty());
+	std::filesystem::remove(path);
+}
+
+} // namespace
@@ -0,0 +1,109 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/video/vga_palette_draw.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// 64 KiB of pixels, wrapping around like video memory, so each line reads
+// different ones
+constexpr size_t VideoMemorySize = 64 * 1024;
+
+// 8-bit lines at the widths of Mode 13h, Mode X and the 8-bit VESA modes,
+// either split into runs as the drawers do or one pixel at a time with
+// every address masked against the wrap-around of video memory
+void BM_DrawPalettePixels(benchmark::State& state, const bool masked)
+{
+	const auto width = static_cast<size_t>(state.range(0));
+
+	std::vector<Bgrx8888> palette(256);
+	for (size_t i = 0; i < palette.size(); ++i) {
+		const auto c = static_cast<uint8_t>(i);
+		palette[i]   = Bgrx8888(c,
+		                       static_cast<uint8_t>(c * 3),
+		                       static_cast<uint8_t>(~c));
+	}
+	std::vector<uint8_t> indices(VideoMemorySize + width);
+	uint32_t seed = 1;
+	for (auto& index : indices) {
+		seed  = seed * 1'664'525 + 1'013'904'223;
+		index = static_cast<uint8_t>(seed >> 24);
+	}
+	std::vector<uint8_t> line_out(width * sizeof(Bgrx8888));
+
+	constexpr auto LinearMask = VideoMemorySize - 1;
+
+	size_t line = 0;
+	for (auto _ : state) {
+		const auto start = (line++ * width) & LinearMask;
+		if (masked) {
+			auto pos  = start;
+			auto draw = line_out.data();
+			for (size_t i = 0; i < width; ++i) {
+				std::memcpy(draw,
+				            &palette[indices[pos++ & LinearMask]],
+				            sizeof(Bgrx8888));
+				draw += sizeof(Bgrx8888);
+			}
+		} else {
+			draw_palette_pixels(line_out.data(),
+			                    indices.data() + start,
+			                    width,
+			                    palette.data());
+		}
+		benchmark::DoNotOptimize(line_out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+void palette_widths(benchmark::internal::Benchmark* b)
+{
+	b->Arg(320)->Arg(360)->Arg(640)->Arg(800)->Arg(1024);
+}
+BENCHMARK_CAPTURE(BM_DrawPalettePixels, runs, false)->Apply(palette_widths);
+BENCHMARK_CAPTURE(BM_DrawPalettePixels, masked, true)->Apply(palette_widths);
+
+// 16-color Tandy and PCjr lines, two pixels to a byte, either through the
+// nibble pair table or looked up a nibble at a time
+void BM_DrawNibblePixels(benchmark::State& state, const bool reference)
+{
+	const auto width = static_cast<size_t>(state.range(0));
+
+	std::vector<uint8_t> colors(16);
+	for (size_t i = 0; i < colors.size(); ++i) {
+		colors[i] = static_cast<uint8_t>(15 - i);
+	}
+	std::vector<uint8_t> bytes(width / 2);
+	for (size_t i = 0; i < bytes.size(); ++i) {
+		bytes[i] = static_cast<uint8_t>(i * 37);
+	}
+	std::vector<uint8_t> line_out(width);
+
+	NibblePalette nibble_palette = {};
+	for (auto _ : state) {
+		auto draw = line_out.data();
+		if (reference) {
+			for (const auto byte : bytes) {
+				*draw++ = colors[byte >> 4];
+				*draw++ = colors[byte & 0x0f];
+			}
+		} else {
+			nibble_palette.Update(colors.data());
+			for (const auto byte : bytes) {
+				nibble_palette.Draw(draw, byte);
+				draw += NibblePalette::BytesPerPair;
+			}
+		}
+		benchmark::DoNotOptimize(line_out.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK_CAPTURE(BM_DrawNibblePixels, table, false)->Arg(320)->Arg(640);
+BENCHMARK_CAPTURE(BM_DrawNibblePixels, reference, true)->Arg(320)->Arg(640);
+
+} // namespace
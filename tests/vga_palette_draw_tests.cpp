@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/video/vga_palette_draw.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+std::array<Bgrx8888, 256> make_palette()
+{
+	std::array<Bgrx8888, 256> palette = {};
+	for (size_t i = 0; i < palette.size(); ++i) {
+		const auto index = static_cast<uint8_t>(i);
+		palette[i] = Bgrx8888(index, static_cast<uint8_t>(index ^ 0x5a),
+		                      static_cast<uint8_t>(255 - index));
+	}
+	return palette;
+}
+
+TEST(VgaPaletteDraw, PixelsAreLookedUpInThePalette)
+{
+	const auto palette = make_palette();
+
+	std::vector<uint8_t> indices(1100);
+	for (size_t i = 0; i < indices.size(); ++i) {
+		indices[i] = static_cast<uint8_t>(i * 7 + 3);
+	}
+
+	// Mode 13h, Mode X and VESA widths, at an unaligned offset too
+	for (const size_t num_pixels : {0, 1, 320, 360, 640, 803, 1024}) {
+		for (const size_t offset : {0, 3}) {
+			std::vector<uint8_t> line(4 * 1100 + 8, 0xcc);
+			draw_palette_pixels(line.data() + offset,
+			                    indices.data() + offset,
+			                    num_pixels,
+			                    palette.data());
+
+			for (size_t i = 0; i < num_pixels; ++i) {
+				const auto pixel  = line.data() + offset + i * 4;
+				const auto colour = palette[indices[offset + i]];
+				ASSERT_EQ(pixel[0], colour.Blue8());
+				ASSERT_EQ(pixel[1], colour.Green8());
+				ASSERT_EQ(pixel[2], colour.Red8());
+			}
+			EXPECT_EQ(line[offset + num_pixels * 4], 0xcc);
+		}
+	}
+}
+
+TEST(VgaPaletteDraw, NibblesAreDrawnHighestFirst)
+{
+	std::array<uint8_t, 16> colours = {};
+	for (size_t i = 0; i < colours.size(); ++i) {
+		colours[i] = static_cast<uint8_t>(0xf0 | (15 - i));
+	}
+	NibblePalette nibble_palette = {};
+	nibble_palette.Update(colours.data());
+
+	for (uint16_t byte = 0; byte < 0x100; ++byte) {
+		std::array<uint8_t, 4> pair    = {};
+		std::array<uint8_t, 4> doubled = {};
+		nibble_palette.Draw(pair.data(), static_cast<uint8_t>(byte));
+		nibble_palette.DrawDouble(doubled.data(), static_cast<uint8_t>(byte));
+
+		const auto high = colours[byte >> 4];
+		const auto low  = colours[byte & 0x0f];
+		EXPECT_EQ(pair, (std::array<uint8_t, 4>{high, low, 0, 0}));
+		EXPECT_EQ(doubled, (std::array<uint8_t, 4>{high, high, low, low}));
+	}
+}
+
+TEST(VgaPaletteDraw, NibbleTableFollowsThePalette)
+{
+	std::array<uint8_t, 16> colours = {};
+	NibblePalette nibble_palette    = {};
+	nibble_palette.Update(colours.data());
+
+	colours[1] = 9;
+	nibble_palette.Update(colours.data());
+
+	std::array<uint8_t, 2> pair = {};
+	nibble_palette.Draw(pair.data(), 0x10);
+	EXPECT_EQ(pair, (std::array<uint8_t, 2>{9, 0}));
+}
+
+} // namespace
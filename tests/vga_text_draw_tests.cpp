@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "hardware/video/vga_text_draw.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+
+namespace {
+
+constexpr uint32_t Foreground = 0xffaa'5501;
+constexpr uint32_t Background = 0x0012'34fe;
+
+// Room for a cell at an unaligned offset, with guard bytes after it
+using Line = std::array<uint8_t, 48>;
+
+void expect_same_cells(const uint16_t font, const bool is_nine_dots, const size_t offset)
+{
+	Line expected = {};
+	Line actual   = {};
+	expected.fill(0xcc);
+	actual.fill(0xcc);
+
+	draw_text_cell_scalar(expected.data() + offset, font, is_nine_dots, Foreground, Background);
+	draw_text_cell(actual.data() + offset, font, is_nine_dots, Foreground, Background);
+
+	EXPECT_EQ(actual, expected) << "font " << font << (is_nine_dots ? " 9-dot" : " 8-dot");
+}
+
+TEST(VgaTextDraw, EightDotCellsMatchTheReference)
+{
+	for (uint16_t font = 0; font < 0x100; ++font) {
+		expect_same_cells(font, false, 0);
+		expect_same_cells(font, false, 5);
+	}
+}
+
+TEST(VgaTextDraw, NineDotCellsMatchTheReference)
+{
+	for (uint16_t font = 0; font < 0x200; ++font) {
+		expect_same_cells(font, true, 0);
+		expect_same_cells(font, true, 3);
+	}
+}
+
+TEST(VgaTextDraw, HighestBitIsTheFirstPixel)
+{
+	Line line = {};
+	draw_text_cell(line.data(), 0x80, false, Foreground, Background);
+	EXPECT_EQ(read_unaligned_uint32_at(line.data(), 0), Foreground);
+	for (auto n = 1; n < 8; ++n) {
+		EXPECT_EQ(read_unaligned_uint32_at(line.data(), n), Background);
+	}
+
+	draw_text_cell(line.data(), 0x101, true, Foreground, Background);
+	EXPECT_EQ(read_unaligned_uint32_at(line.data(), 0), Foreground);
+	EXPECT_EQ(read_unaligned_uint32_at(line.data(), 4), Background);
+	EXPECT_EQ(read_unaligned_uint32_at(line.data(), 8), Foreground);
+}
+
+} // namespace
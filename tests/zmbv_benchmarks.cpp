@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "zmbv/zmbv.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr int Width  = 640;
+constexpr int Height = 480;
+
+constexpr auto Format = ZMBV_FORMAT::BPP_32;
+
+using Frame = std::vector<uint32_t>;
+
+// A gradient with a sprite moving across it and a patch of noise that
+// changes every frame, so the delta frames have still, moved and changed
+// blocks
+Frame make_frame(const int n)
+{
+	Frame frame(Width * Height);
+	for (auto y = 0; y < Height; ++y) {
+		for (auto x = 0; x < Width; ++x) {
+			frame[y * Width + x] = static_cast<uint32_t>((x << 8) | y);
+		}
+	}
+	for (auto y = 100; y < 200; ++y) {
+		for (auto x = 0; x < 80; ++x) {
+			frame[y * Width + x + n * 3] = 0x00ff0000 |
+			                               static_cast<uint32_t>(x * y);
+		}
+	}
+	uint32_t seed = static_cast<uint32_t>(n) + 1;
+	for (auto y = 300; y < 400; ++y) {
+		for (auto x = 400; x < 500; ++x) {
+			seed = seed * 1'664'525 + 1'013'904'223;
+			frame[y * Width + x] = seed >> 8;
+		}
+	}
+	return frame;
+}
+
+// Encodes frames the way video capture does, one line at a time; every
+// frame a keyframe or all but the first a delta frame
+void BM_ZmbvCompress(benchmark::State& state)
+{
+	const auto is_keyframe = state.range(0) != 0;
+	const auto num_threads = static_cast<int>(state.range(1));
+
+	std::vector<Frame> frames = {};
+	for (auto n = 0; n < 8; ++n) {
+		frames.push_back(make_frame(n));
+	}
+
+	VideoCodec codec = {};
+	codec.SetupCompress(Width, Height, ZMBV_DefaultCompressionLevel, num_threads);
+	const auto buffer_size = codec.NeededSize(Width, Height, Format);
+	std::vector<uint8_t> buffer(static_cast<size_t>(buffer_size));
+
+	size_t n = 0;
+	for (auto _ : state) {
+		const auto& frame = frames[n % frames.size()];
+		const auto flags  = (is_keyframe || n == 0) ? 1 : 0;
+		codec.PrepareCompressFrame(flags,
+		                           Format,
+		                           nullptr,
+		                           buffer.data(),
+		                           static_cast<uint32_t>(buffer.size()));
+		for (auto y = 0; y < Height; ++y) {
+			const auto pixels  = &frame[static_cast<size_t>(y) * Width];
+			const uint8_t* row = reinterpret_cast<const uint8_t*>(pixels);
+			codec.CompressLines(1, &row);
+		}
+		benchmark::DoNotOptimize(codec.FinishCompressFrame());
+		++n;
+	}
+	codec.FinishVideo();
+	state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ZmbvCompress)->ArgsProduct({{1, 0}, {1, 4}})->UseRealTime();
+
+} // namespace
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText:  2025 The DOSBox Staging Team
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "zmbv/zmbv.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+constexpr int Width  = 1024;
+constexpr int Height = 768;
+
+constexpr auto Format        = ZMBV_FORMAT::BPP_32;
+constexpr int BytesPerPixel = 4;
+
+using Frame = std::vector<uint32_t>;
+
+// A gradient with a sprite moving across it and a patch of noise that
+// changes every frame, so the delta frames have still, moved and changed
+// blocks
+Frame make_frame(const int n)
+{
+	Frame frame(Width * Height);
+	for (auto y = 0; y < Height; ++y) {
+		for (auto x = 0; x < Width; ++x) {
+			frame[y * Width + x] = static_cast<uint32_t>((x << 8) | y);
+		}
+	}
+	for (auto y = 100; y < 200; ++y) {
+		for (auto x = 0; x < 80; ++x) {
+			frame[y * Width + x + n * 3] = 0x00ff0000 | static_cast<uint32_t>(x * y);
+		}
+	}
+	uint32_t seed = static_cast<uint32_t>(n) + 1;
+	for (auto y = 500; y < 600; ++y) {
+		for (auto x = 600; x < 700; ++x) {
+			seed = seed * 1'664'525 + 1'013'904'223;
+			frame[y * Width + x] = seed >> 8;
+		}
+	}
+	return frame;
+}
+
+std::vector<std::vector<uint8_t>> encode(const std::vector<Frame>& frames,
+                                         const int level, const int num_threads)
+{
+	VideoCodec codec = {};
+	EXPECT_TRUE(codec.SetupCompress(Width, Height, level, num_threads));
+
+	std::vector<uint8_t> buffer(static_cast<size_t>(codec.NeededSize(Width, Height, Format)));
+
+	std::vector<std::vector<uint8_t>> encoded = {};
+	for (size_t n = 0; n < frames.size(); ++n) {
+		const auto flags = (n == 0) ? 1 : 0;
+		EXPECT_TRUE(codec.PrepareCompressFrame(flags,
+		                                       Format,
+		                                       nullptr,
+		                                       buffer.data(),
+		                                       static_cast<uint32_t>(buffer.size())));
+		for (auto y = 0; y < Height; ++y) {
+			const uint8_t* row = reinterpret_cast<const uint8_t*>(
+			        &frames[n][y * Width]);
+			codec.CompressLines(1, &row);
+		}
+		const auto written = codec.FinishCompressFrame();
+		EXPECT_GT(written, 0);
+		encoded.emplace_back(buffer.begin(), buffer.begin() + written);
+	}
+	codec.FinishVideo();
+	return encoded;
+}
+
+std::vector<Frame> make_frames()
+{
+	std::vector<Frame> frames = {};
+	for (auto n = 0; n < 6; ++n) {
+		frames.push_back(make_frame(n));
+	}
+	return frames;
+}
+
+TEST(Zmbv, ThreadsDoNotChangeTheOutput)
+{
+	const auto frames = make_frames();
+
+	const auto single = encode(frames, ZMBV_DefaultCompressionLevel, 1);
+	for (const auto num_threads : {2, 3, 4}) {
+		EXPECT_EQ(encode(frames, ZMBV_DefaultCompressionLevel, num_threads),
+		          single)
+		        << num_threads << " threads";
+	}
+}
+
+TEST(Zmbv, DeltaFramesAreSmallerThanKeyframes)
+{
+	const auto encoded = encode(make_frames(), ZMBV_DefaultCompressionLevel, 4);
+	for (size_t n = 1; n < encoded.size(); ++n) {
+		EXPECT_LT(encoded[n].size() * 4, encoded[0].size()) << "frame " << n;
+	}
+}
+
+TEST(Zmbv, EveryLevelCompresses)
+{
+	const auto frames   = make_frames();
+	const auto raw_size = static_cast<size_t>(Width * Height * BytesPerPixel);
+
+	for (auto level = ZMBV_MinCompressionLevel; level <= ZMBV_MaxCompressionLevel;
+	     ++level) {
+		const auto encoded = encode(frames, level, 4);
+		EXPECT_LT(encoded[0].size() * 2, raw_size) << "level " << level;
+		EXPECT_EQ(encoded, encode(frames, level, 1)) << "level " << level;
+	}
+}
+
+} // namespace